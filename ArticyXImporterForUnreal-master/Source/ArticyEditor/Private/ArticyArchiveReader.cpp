@@ -4,9 +4,52 @@
 
 #include "ArticyArchiveReader.h"
 #include "ArticyEditorModule.h"
+#include "ArticyImportStats.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeLock.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Hash/CityHash.h"
+
+/**
+ * Takes a buffer out of the pool, or a new one if none is free.
+ *
+ * @return The buffer, empty but possibly with capacity.
+ */
+TArray<uint8> FArticyDecodeBufferPool::Acquire()
+{
+	FScopeLock ScopeLock(&Lock);
+	if (FreeBuffers.Num() > 0)
+		return FreeBuffers.Pop();
+	return TArray<uint8>();
+}
+
+/**
+ * Returns a buffer to the pool, it is freed if the pool is full.
+ *
+ * @param Buffer The buffer to return.
+ */
+void FArticyDecodeBufferPool::Release(TArray<uint8>&& Buffer)
+{
+	Buffer.Reset();
+
+	FScopeLock ScopeLock(&Lock);
+	if (FreeBuffers.Num() < MaxBuffers)
+		FreeBuffers.Add(MoveTemp(Buffer));
+}
+
+/**
+ * Frees all buffers in the pool.
+ */
+void FArticyDecodeBufferPool::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	FreeBuffers.Empty();
+}
 
 /**
  * Opens an archive file for reading.
@@ -16,6 +59,7 @@
  */
 bool UArticyArchiveReader::OpenArchive(const FString& InArchiveFileName)
 {
+	CloseArchive();
 	ArchiveFileName = InArchiveFileName;
 
 	if (!ReadHeader())
@@ -30,6 +74,153 @@ bool UArticyArchiveReader::OpenArchive(const FString& InArchiveFileName)
 		return false;
 	}
 
+	if (!MapArchive())
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not map archive %s."), *ArchiveFileName);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Releases the archive's mapping, views returned by ReadFileBytes are invalid afterwards.
+ */
+void UArticyArchiveReader::CloseArchive()
+{
+	{
+		FScopeLock ScopeLock(&DecodeLock);
+		DecodedFiles.Empty();
+		PrefetchedFiles.Empty();
+		ParsedFiles.Empty();
+		FileHashes.Empty();
+	}
+	DecodeBuffers.Empty();
+
+	ArchiveBytes = TArrayView<const uint8>();
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	LoadedArchive.Empty();
+}
+
+void UArticyArchiveReader::BeginDestroy()
+{
+	CloseArchive();
+	Super::BeginDestroy();
+}
+
+/**
+ * Maps the archive file into memory, or loads it if the platform cannot map it.
+ *
+ * @return True if the archive's bytes are available; otherwise, false.
+ */
+bool UArticyArchiveReader::MapArchive()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	MappedFile.Reset(PlatformFile.OpenMapped(*ArchiveFileName));
+	if (MappedFile)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	if (MappedRegion)
+	{
+		ArchiveBytes = TArrayView<const uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+		return true;
+	}
+
+	// Not every platform file supports mapping, keep the whole archive in memory instead
+	MappedFile.Reset();
+	if (!FFileHelper::LoadFileToArray(LoadedArchive, *ArchiveFileName))
+	{
+		return false;
+	}
+	ArchiveBytes = LoadedArchive;
+	return true;
+}
+
+/**
+ * Finds a file's entry and its packed bytes in the archive.
+ *
+ * @param Filename The name of the file.
+ * @param OutEntry The entry of the file.
+ * @param OutPacked The view that will receive the file's packed bytes.
+ * @return True if the file was found and is within the archive; otherwise, false.
+ */
+bool UArticyArchiveReader::FindPackedFile(const FString& Filename, const FArticyArchiveFileData*& OutEntry, TArrayView<const uint8>& OutPacked) const
+{
+	OutEntry = FileDictionary.Find(Filename);
+	if (!OutEntry)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("File %s is not in archive %s."), *Filename, *ArchiveFileName);
+		return false;
+	}
+
+	if (OutEntry->PackedLength < 0 || OutEntry->FileStartPos + OutEntry->PackedLength > static_cast<uint64>(ArchiveBytes.Num()))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not read file %s from archive %s."), *Filename, *ArchiveFileName);
+		return false;
+	}
+
+	OutPacked = ArchiveBytes.Slice(static_cast<int32>(OutEntry->FileStartPos), static_cast<int32>(OutEntry->PackedLength));
+	FArticyImportStats::Get().Add(FArticyImportStats::ECounter::BytesRead, OutPacked.Num());
+	return true;
+}
+
+/**
+ * Inflates a compressed file.
+ *
+ * @param FileEntry The entry of the file.
+ * @param Packed The file's packed bytes.
+ * @param OutBytes The buffer that will receive the unpacked bytes, its capacity is reused.
+ * @return True if the file was decoded; otherwise, false.
+ */
+bool UArticyArchiveReader::DecompressFile(const FArticyArchiveFileData& FileEntry, TArrayView<const uint8> Packed, TArray<uint8>& OutBytes)
+{
+	if (FileEntry.UnpackedLength < 0 || FileEntry.UnpackedLength > MAX_int32)
+		return false;
+
+	OutBytes.Reset();
+	OutBytes.AddUninitialized(static_cast<int32>(FileEntry.UnpackedLength));
+	return FCompression::UncompressMemory(NAME_Zlib, OutBytes.GetData(), OutBytes.Num(), Packed.GetData(), Packed.Num());
+}
+
+/**
+ * Gets the bytes of a file in the archive without copying them.
+ *
+ * @param Filename The name of the file to read from the archive.
+ * @param OutBytes The view that will receive the file's UTF-8 content.
+ * @return True if the file was found in the archive; otherwise, false.
+ */
+bool UArticyArchiveReader::ReadFileBytes(const FString& Filename, TArrayView<const uint8>& OutBytes) const
+{
+	const FArticyArchiveFileData* FileEntry = nullptr;
+	TArrayView<const uint8> Packed;
+	if (!FindPackedFile(Filename, FileEntry, Packed))
+		return false;
+
+	if (!(FileEntry->Flags & EArticyArchiveFileFlags::Compressed))
+	{
+		OutBytes = Packed;
+		return true;
+	}
+
+	// Decoded files are kept so the view stays valid
+	FScopeLock ScopeLock(&DecodeLock);
+	const TArray<uint8>* Decoded = DecodedFiles.Find(Filename);
+	if (!Decoded)
+	{
+		TArray<uint8> Bytes;
+		if (!DecompressFile(*FileEntry, Packed, Bytes))
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Could not decompress file %s from archive %s."), *Filename, *ArchiveFileName);
+			return false;
+		}
+		Decoded = &DecodedFiles.Add(Filename, MoveTemp(Bytes));
+	}
+
+	OutBytes = *Decoded;
 	return true;
 }
 
@@ -42,30 +233,242 @@ bool UArticyArchiveReader::OpenArchive(const FString& InArchiveFileName)
  */
 bool UArticyArchiveReader::ReadFile(const FString& Filename, FString& OutResult) const
 {
-	IPlatformFile& PlatformFile = FPlatformFileManager().GetPlatformFile();
+	{
+		FScopeLock ScopeLock(&DecodeLock);
+		if (const FString* Prefetched = PrefetchedFiles.Find(Filename))
+		{
+			OutResult = *Prefetched;
+			return true;
+		}
+	}
 
-	if (IFileHandle* FileHandle = PlatformFile.OpenRead(*ArchiveFileName))
+	const FArticyArchiveFileData* FileEntry = nullptr;
+	TArrayView<const uint8> Packed;
+	if (!FindPackedFile(Filename, FileEntry, Packed))
+		return false;
+
+	if (!(FileEntry->Flags & EArticyArchiveFileFlags::Compressed))
+	{
+		OutResult = ArchiveBytesToString(Packed.GetData(), Packed.Num());
+		return true;
+	}
+
+	// Only the string is needed, decode into a pooled buffer
+	TArray<uint8> Buffer = DecodeBuffers.Acquire();
+	const bool bDecoded = DecompressFile(*FileEntry, Packed, Buffer);
+	if (bDecoded)
+		OutResult = ArchiveBytesToString(Buffer.GetData(), Buffer.Num());
+	else
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not decompress file %s from archive %s."), *Filename, *ArchiveFileName);
+	DecodeBuffers.Release(MoveTemp(Buffer));
+
+	return bDecoded;
+}
+
+/**
+ * Collects the values of all FileName fields in a JSON object and its children.
+ *
+ * @param Json The JSON object to search.
+ * @param OutFilenames The array that receives the file names.
+ */
+static void GatherArchiveFilenames(const TSharedPtr<FJsonObject>& Json, TArray<FString>& OutFilenames)
+{
+	if (!Json.IsValid())
+		return;
+
+	for (const auto& Field : Json->Values)
 	{
-		const FArticyArchiveFileData& FileEntry = FileDictionary[Filename];
-		uint8* FileBytes = new uint8[FileEntry.PackedLength];
+		if (!Field.Value.IsValid())
+			continue;
 
-		// Read file data
-		FileHandle->Seek(FileEntry.FileStartPos);
-		if (!FileHandle->Read(FileBytes, FileEntry.PackedLength))
+		if (Field.Value->Type == EJson::String && Field.Key.Equals(TEXT("FileName")))
 		{
-			UE_LOG(LogArticyEditor, Error, TEXT("Could not read file %s from archive %s."), *Filename, *ArchiveFileName);
-			delete FileHandle;
-			return false;
+			OutFilenames.AddUnique(Field.Value->AsString());
+		}
+		else if (Field.Value->Type == EJson::Object)
+		{
+			GatherArchiveFilenames(Field.Value->AsObject(), OutFilenames);
+		}
+		else if (Field.Value->Type == EJson::Array)
+		{
+			for (const auto& Element : Field.Value->AsArray())
+			{
+				if (Element.IsValid() && Element->Type == EJson::Object)
+					GatherArchiveFilenames(Element->AsObject(), OutFilenames);
+			}
 		}
+	}
+}
 
-		// TODO: Handle decompression
-		OutResult = ArchiveBytesToString(FileBytes, FileEntry.PackedLength);
-		delete FileHandle;
+/**
+ * Hashes the bytes a file is stored with in the archive, without decoding them.
+ *
+ * @param Filename The name of the file to hash.
+ * @param OutHash The string that will receive the hash.
+ * @return True if the file was found in the archive; otherwise, false.
+ */
+bool UArticyArchiveReader::HashFile(const FString& Filename, FString& OutHash) const
+{
+	{
+		FScopeLock ScopeLock(&DecodeLock);
+		if (const FString* Hash = FileHashes.Find(Filename))
+		{
+			OutHash = *Hash;
+			return true;
+		}
 	}
 
+	const FArticyArchiveFileData* FileEntry = nullptr;
+	TArrayView<const uint8> Packed;
+	if (!FindPackedFile(Filename, FileEntry, Packed))
+		return false;
+
+	// Packed bytes only change with the file's content, the unpacked length tells compressed and stored files apart
+	const uint64 Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Packed.GetData()), Packed.Num(), static_cast<uint64>(FileEntry->UnpackedLength));
+	OutHash = FString::Printf(TEXT("%016llx"), Hash);
+
+	FScopeLock ScopeLock(&DecodeLock);
+	FileHashes.Add(Filename, OutHash);
 	return true;
 }
 
+/**
+ * Decodes the compressed files referenced by FileName fields anywhere in a manifest, in parallel.
+ *
+ * @param JsonRoot The manifest to collect file names from.
+ * @param UnchangedHashes Hashes of files the import will not read again, files with one of them are skipped.
+ */
+void UArticyArchiveReader::PrefetchFiles(const TSharedPtr<FJsonObject>& JsonRoot, const TSet<FString>& UnchangedHashes) const
+{
+	TArray<FString> Filenames;
+	GatherArchiveFilenames(JsonRoot, Filenames);
+
+	if (UnchangedHashes.Num() > 0)
+	{
+		Filenames.RemoveAll([&](const FString& Filename)
+		{
+			FString Hash;
+			return HashFile(Filename, Hash) && UnchangedHashes.Contains(Hash);
+		});
+	}
+
+	PrefetchFiles(Filenames);
+}
+
+/**
+ * Decodes compressed files of the archive in parallel through the task graph.
+ *
+ * @param Filenames The names of the files to decode, uncompressed ones are skipped.
+ */
+void UArticyArchiveReader::PrefetchFiles(const TArray<FString>& Filenames) const
+{
+	TArray<const FArticyArchiveFileData*> Entries;
+	TArray<TArrayView<const uint8>> PackedFiles;
+	{
+		FScopeLock ScopeLock(&DecodeLock);
+		for (const FString& Filename : Filenames)
+		{
+			const FArticyArchiveFileData* FileEntry = FileDictionary.Find(Filename);
+			if (!FileEntry || !(FileEntry->Flags & EArticyArchiveFileFlags::Compressed) || PrefetchedFiles.Contains(Filename))
+				continue;
+
+			TArrayView<const uint8> Packed;
+			if (FindPackedFile(Filename, FileEntry, Packed))
+			{
+				Entries.Add(FileEntry);
+				PackedFiles.Add(Packed);
+			}
+		}
+	}
+
+	if (Entries.Num() == 0)
+		return;
+
+	// One task per pooled buffer bounds the memory in flight, tasks pull files until all are decoded
+	TArray<FString> Results;
+	Results.SetNum(Entries.Num());
+	TArray<bool> Decoded;
+	Decoded.SetNumZeroed(Entries.Num());
+	FThreadSafeCounter NextFile;
+
+	const int32 NumTasks = FMath::Min(Entries.Num(), DecodeBuffers.GetMaxBuffers());
+	ParallelFor(NumTasks, [&](int32)
+	{
+		TArray<uint8> Buffer = DecodeBuffers.Acquire();
+		for (int32 Index = NextFile.Increment() - 1; Index < Entries.Num(); Index = NextFile.Increment() - 1)
+		{
+			if (DecompressFile(*Entries[Index], PackedFiles[Index], Buffer))
+			{
+				Results[Index] = ArchiveBytesToString(Buffer.GetData(), Buffer.Num());
+				Decoded[Index] = true;
+			}
+		}
+		DecodeBuffers.Release(MoveTemp(Buffer));
+	});
+
+	// Files that failed are decoded again and reported when they are read
+	FScopeLock ScopeLock(&DecodeLock);
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		if (Decoded[Index])
+			PrefetchedFiles.Add(Entries[Index]->Filename, MoveTemp(Results[Index]));
+	}
+}
+
+/**
+ * Decodes and parses the changed files referenced by FileName fields anywhere in a manifest, in parallel.
+ *
+ * @param JsonRoot The manifest to collect file names from.
+ * @param UnchangedHashes Hashes of files the import will not read again, files with one of them are skipped.
+ * @return The number of files that changed.
+ */
+int32 UArticyArchiveReader::ParseFiles(const TSharedPtr<FJsonObject>& JsonRoot, const TSet<FString>& UnchangedHashes) const
+{
+	TArray<FString> Filenames;
+	GatherArchiveFilenames(JsonRoot, Filenames);
+
+	Filenames.RemoveAll([&](const FString& Filename)
+	{
+		FString Hash;
+		return HashFile(Filename, Hash) && UnchangedHashes.Contains(Hash);
+	});
+
+	PrefetchFiles(Filenames);
+
+	TArray<TSharedPtr<FJsonObject>> Results;
+	Results.SetNum(Filenames.Num());
+	ParallelFor(Filenames.Num(), [&](int32 Index)
+	{
+		FString Json;
+		if (!ReadFile(Filenames[Index], Json))
+			return;
+
+		const TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(Json);
+		FJsonSerializer::Deserialize(JsonReader, Results[Index]);
+	});
+
+	// The decoded strings are not read again once parsed, files that failed are read and reported by FetchJson
+	FScopeLock ScopeLock(&DecodeLock);
+	for (int32 Index = 0; Index < Filenames.Num(); ++Index)
+	{
+		PrefetchedFiles.Remove(Filenames[Index]);
+		if (Results[Index].IsValid())
+			ParsedFiles.Add(Filenames[Index], MoveTemp(Results[Index]));
+	}
+
+	return Filenames.Num();
+}
+
+/**
+ * Frees the strings decoded by PrefetchFiles and the objects parsed by ParseFiles.
+ */
+void UArticyArchiveReader::ReleasePrefetchedFiles() const
+{
+	FScopeLock ScopeLock(&DecodeLock);
+	PrefetchedFiles.Empty();
+	ParsedFiles.Empty();
+}
+
 /**
  * Reads the header from the archive file.
  *
@@ -266,7 +669,7 @@ FString UArticyArchiveReader::ArchiveBytesToString(const uint8* In, int32 Count)
  *
  * @param JsonRoot The root JSON object to search within.
  * @param FieldName The field name containing the desired JSON object.
- * @param Hash The hash value to check against.
+ * @param Hash The hash of the file's last import, updated if the file changed.
  * @param OutJsonObject The resulting JSON object, if found and changed.
  * @return True if the JSON object was successfully fetched and changed; otherwise, false.
  */
@@ -282,14 +685,29 @@ bool UArticyArchiveReader::FetchJson(
 	}
 
 	const TSharedPtr<FJsonObject> FileInfo = JsonRoot->GetObjectField(FieldName);
-	const FString& NewHash = FileInfo->GetStringField(TEXT("Hash"));
+	const FString& FileName = FileInfo->GetStringField(TEXT("FileName"));
+
+	// The file's bytes are compared instead of the manifest's hash, hashing them is far cheaper than parsing
+	FString NewHash;
+	if (!HashFile(FileName, NewHash))
+	{
+		return false;
+	}
 	if (Hash.Equals(NewHash))
 	{
+		FArticyImportStats::Get().Add(FArticyImportStats::ECounter::FilesUnchanged, 1);
 		return false;
 	}
 	Hash = NewHash;
 
-	const FString& FileName = FileInfo->GetStringField(TEXT("FileName"));
+	{
+		FScopeLock ScopeLock(&DecodeLock);
+		if (const TSharedPtr<FJsonObject>* Parsed = ParsedFiles.Find(FileName))
+		{
+			OutJsonObject = *Parsed;
+			return true;
+		}
+	}
 
 	FString Result;
 	if (!ReadFile(FileName, Result))
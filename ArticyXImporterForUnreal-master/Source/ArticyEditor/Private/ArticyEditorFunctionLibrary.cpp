@@ -7,6 +7,7 @@
 #include "ArticyEditorModule.h"
 #include "ArticyJSONFactory.h"
 #include "CodeGeneration/CodeGenerator.h"
+#include "ArticyImportStats.h"
 #include "ObjectTools.h"
 #include "FileHelpers.h"
 #include "HAL/FileManager.h"
@@ -36,6 +37,7 @@ int32 FArticyEditorFunctionLibrary::ForceCompleteReimport(UArticyImportData* Imp
 	ImportData->Settings.ObjectDefinitionsHash.Reset();
 	ImportData->Settings.ObjectDefinitionsTextHash.Reset();
 	ImportData->Settings.ScriptFragmentsHash.Reset();
+	ImportData->Settings.ManifestHash.Reset();
 	ImportData->PackageDefs.ResetPackages();
 	return ReimportChanges(ImportData);
 }
@@ -88,7 +90,9 @@ int32 FArticyEditorFunctionLibrary::RegenerateAssets(UArticyImportData* ImportDa
 		return -1;
 	}
 
+	FArticyImportStats::Get().Reset();
 	CodeGenerator::GenerateAssets(ImportData);
+	FArticyImportStats::Get().LogSummary();
 
 	return -1;
 }
@@ -137,6 +141,23 @@ EImportDataEnsureResult FArticyEditorFunctionLibrary::EnsureImportDataAsset(UArt
 	return Result;
 }
 
+/**
+ * Gets the Articy directory of the plugin settings as an absolute path.
+ *
+ * @return The absolute path of the Articy directory.
+ */
+FString FArticyEditorFunctionLibrary::GetAbsoluteArticyDirectory()
+{
+	// path is virtual in the beginning
+	const FString ArticyDirectory = GetDefault<UArticyPluginSettings>()->ArticyDirectory.Path;
+	// remove /Game/ so that the non-virtual part remains
+	FString ArticyDirectoryNonVirtual = ArticyDirectory;
+	ArticyDirectoryNonVirtual.RemoveFromStart(TEXT("/Game"));
+	ArticyDirectoryNonVirtual.RemoveFromStart(TEXT("/"));
+	// attach the non-virtual path to the content directory, then convert it to absolute
+	return IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*(FPaths::ProjectContentDir() + ArticyDirectoryNonVirtual));
+}
+
 /**
  * Generates a new Articy import data asset.
  * Searches for an existing .articyue file in the specified directory and imports it.
@@ -150,14 +171,8 @@ UArticyImportData* FArticyEditorFunctionLibrary::GenerateImportDataAsset()
 	UArticyJSONFactory* Factory = NewObject<UArticyJSONFactory>();
 
 	TArray<FString> ArticyImportFiles;
-	// path is virtual in the beginning
 	const FString ArticyDirectory = GetDefault<UArticyPluginSettings>()->ArticyDirectory.Path;
-	// remove /Game/ so that the non-virtual part remains
-	FString ArticyDirectoryNonVirtual = ArticyDirectory;
-	ArticyDirectoryNonVirtual.RemoveFromStart(TEXT("/Game"));
-	ArticyDirectoryNonVirtual.RemoveFromStart(TEXT("/"));
-	// attach the non-virtual path to the content directory, then convert it to absolute
-	const FString AbsoluteDirectoryPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*(FPaths::ProjectContentDir() + ArticyDirectoryNonVirtual));
+	const FString AbsoluteDirectoryPath = GetAbsoluteArticyDirectory();
 	IFileManager::Get().FindFiles(ArticyImportFiles, *AbsoluteDirectoryPath, TEXT("articyue"));
 	if (ArticyImportFiles.Num() == 0)
 	{
@@ -8,6 +8,8 @@
 #include "ArticyEditorFunctionLibrary.h"
 #include "ArticyEditorStyle.h"
 #include "ArticyFlowClasses.h"
+#include "ArticyImporterHelpers.h"
+#include "ArticyJSONFactory.h"
 #include "CodeGeneration/CodeGenerator.h"
 #include "Customizations/ArticyIdPropertyWidgetCustomizations/DefaultArticyIdPropertyWidgetCustomizations.h"
 #include "Developer/Settings/Public/ISettingsModule.h"
@@ -35,6 +37,8 @@
 #if ENGINE_MAJOR_VERSION >= 5
 // In UE5, you use the ToolMenus API to extend the UI
 #include "ToolMenus.h"
+#include "ArticyPackage.h"
+#include "Engine/AssetManager.h"
 #else
 // Otherwise, we have to jack into the level editor module and build a new button in
 #include "LevelEditor.h"
@@ -59,11 +63,14 @@ void FArticyEditorModule::StartupModule()
 	RegisterDefaultArticyIdPropertyWidgetExtensions();
 	RegisterDetailCustomizations();
 	RegisterGraphPinFactory();
+	RegisterPackageChunkRules();
 	RegisterPluginSettings();
 	RegisterPluginCommands();
 	RegisterArticyToolbar();
 	// directory watcher has to be changed or removed as the results aren't quite deterministic
 	//RegisterDirectoryWatcher();
+	RegisterExportWatcher();
+	OnImportFinished.AddRaw(this, &FArticyEditorModule::RegisterExportWatcher);
 	RegisterToolTabs();
 
 	FArticyEditorStyle::Initialize();
@@ -74,6 +81,14 @@ void FArticyEditorModule::StartupModule()
  */
 void FArticyEditorModule::ShutdownModule()
 {
+	if (ExportReimportHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(ExportReimportHandle);
+		ExportReimportHandle.Reset();
+	}
+	UnregisterExportWatcher();
+	PackageQuery.Reset();
+
 	if (UObjectInitialized())
 	{
 		GetCustomizationManager()->Shutdown();
@@ -96,6 +111,75 @@ void FArticyEditorModule::RegisterDirectoryWatcher()
 	DirectoryWatcherModule.Get()->RegisterDirectoryChangedCallback_Handle(CodeGenerator::GetSourceFolder(), IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FArticyEditorModule::OnGeneratedCodeChanged), GeneratedCodeWatcherHandle);
 }
 
+/**
+ * Register a directory watcher on the Articy directory, so changes of the export can be reimported in the background.
+ */
+void FArticyEditorModule::RegisterExportWatcher()
+{
+	const FString ExportDirectory = FArticyEditorFunctionLibrary::GetAbsoluteArticyDirectory();
+	if (ExportWatcherHandle.IsValid() && ExportDirectory.Equals(WatchedExportDirectory))
+	{
+		return;
+	}
+
+	UnregisterExportWatcher();
+	if (!IFileManager::Get().DirectoryExists(*ExportDirectory))
+	{
+		return;
+	}
+
+	FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>("DirectoryWatcher");
+	WatchedExportDirectory = ExportDirectory;
+	DirectoryWatcherModule.Get()->RegisterDirectoryChangedCallback_Handle(ExportDirectory, IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FArticyEditorModule::OnExportChanged), ExportWatcherHandle);
+}
+
+/**
+ * Unregister the directory watcher of the Articy directory.
+ */
+void FArticyEditorModule::UnregisterExportWatcher()
+{
+	if (ExportWatcherHandle.IsValid())
+	{
+		if (FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>("DirectoryWatcher"))
+		{
+			DirectoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(WatchedExportDirectory, ExportWatcherHandle);
+		}
+		ExportWatcherHandle.Reset();
+	}
+	WatchedExportDirectory.Empty();
+}
+
+/**
+ * Assign Articy packages to the chunks of the plugin settings once the asset manager exists.
+ */
+void FArticyEditorModule::RegisterPackageChunkRules() const
+{
+	UAssetManager::CallOrRegister_OnAssetManagerCreated(FSimpleMulticastDelegate::FDelegate::CreateLambda([]()
+	{
+		const TMap<FString, int32>& ChunkIds = GetDefault<UArticyPluginSettings>()->PackageChunkIds;
+		if (ChunkIds.Num() == 0)
+			return;
+
+		// The packages become primary assets so the cook assigns them and what only they reference to their chunks
+		const FPrimaryAssetType PackageType(TEXT("ArticyPackage"));
+		UAssetManager& AssetManager = UAssetManager::Get();
+		AssetManager.ScanPathsForPrimaryAssets(PackageType, { GetDefault<UArticyPluginSettings>()->ArticyDirectory.Path }, UArticyPackage::StaticClass(), false);
+
+		TArray<FAssetData> Packages;
+		AssetManager.GetPrimaryAssetDataList(PackageType, Packages);
+		for (const FAssetData& Package : Packages)
+		{
+			const int32* ChunkId = ChunkIds.Find(Package.GetTagValueRef<FString>(GET_MEMBER_NAME_CHECKED(UArticyPackage, Name)));
+			if (!ChunkId)
+				continue;
+
+			FPrimaryAssetRules Rules;
+			Rules.ChunkId = *ChunkId;
+			AssetManager.SetPrimaryAssetRules(FPrimaryAssetId(PackageType, Package.AssetName), Rules);
+		}
+	}));
+}
+
 /**
  * Register a custom graph pin factory for Articy references.
  */
@@ -154,20 +238,36 @@ TArray<UArticyPackage*> FArticyEditorModule::GetPackagesSlow()
 	TArray<FAssetData> PackageData;
 
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-	AssetRegistryModule.Get().GetAssetsByClass(UArticyGlobalVariables::StaticClass()->GetClassPathName(), PackageData);
+	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), PackageData);
 #else
 	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), PackageData);
 #endif	
 
 	TArray<UArticyPackage*> Packages;
+	Packages.Reserve(PackageData.Num());
 	for (const FAssetData& Data : PackageData)
 	{
-		Packages.Add(Cast<UArticyPackage>(Data.GetAsset()));
+		if (UArticyPackage* Package = Cast<UArticyPackage>(Data.GetAsset()))
+			Packages.Add(Package);
 	}
 
 	return Packages;
 }
 
+/**
+ * Get the query answering questions about the packages from their asset registry tags, created on first use.
+ *
+ * @return Reference to the package query.
+ */
+FArticyPackageQuery& FArticyEditorModule::GetPackageQuery()
+{
+	if (!PackageQuery)
+	{
+		PackageQuery = MakeUnique<FArticyPackageQuery>();
+	}
+	return *PackageQuery;
+}
+
 /**
  * Register the Articy toolbar, adding custom buttons for Articy utilities.
  */
@@ -431,6 +531,96 @@ void FArticyEditorModule::OnGeneratedCodeChanged(const TArray<FFileChangeData>&
 	}
 }
 
+/**
+ * Schedule a reimport if the export changed and reimporting on changes is enabled.
+ *
+ * @param FileChanges Array of file change data.
+ */
+void FArticyEditorModule::OnExportChanged(const TArray<FFileChangeData>& FileChanges)
+{
+	if (!GetDefault<UArticyPluginSettings>()->bReimportOnExportChange)
+	{
+		return;
+	}
+
+	const bool bExportChanged = FileChanges.ContainsByPredicate([](const FFileChangeData& Change)
+	{
+		return Change.Action != FFileChangeData::FCA_Removed && FPaths::GetExtension(Change.Filename).Equals(TEXT("articyue"), ESearchCase::IgnoreCase);
+	});
+
+	if (bExportChanged)
+	{
+		ScheduleExportReimport();
+	}
+}
+
+/**
+ * Reimport the export once it did not change for the delay of the plugin settings.
+ * articy:draft writes an export in several steps, every step restarts the delay, so a burst causes one reimport.
+ */
+void FArticyEditorModule::ScheduleExportReimport()
+{
+	LastExportChangeTime = FPlatformTime::Seconds();
+	if (!ExportReimportHandle.IsValid())
+	{
+		ExportReimportHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FArticyEditorModule::TickExportReimport), 0.25f);
+	}
+}
+
+/**
+ * Start the scheduled reimport once the export did not change for the delay and no import is running.
+ *
+ * @param DeltaTime Time since the last tick.
+ * @return True while the reimport is still waiting.
+ */
+bool FArticyEditorModule::TickExportReimport(float DeltaTime)
+{
+	// Changes while a reimport runs or during play are reimported afterwards
+	if (bIsBackgroundReimportRunning || bIsImportQueued || ArticyImporterHelpers::IsPlayInEditor())
+	{
+		return true;
+	}
+
+	if (FPlatformTime::Seconds() - LastExportChangeTime < GetDefault<UArticyPluginSettings>()->ExportChangeDelay)
+	{
+		return true;
+	}
+
+	ExportReimportHandle.Reset();
+	StartBackgroundReimport();
+	return false;
+}
+
+/**
+ * Reimport the changes of the export, reading and parsing it in the background.
+ */
+void FArticyEditorModule::StartBackgroundReimport()
+{
+	UArticyImportData* ImportData = nullptr;
+	const EImportDataEnsureResult Result = FArticyEditorFunctionLibrary::EnsureImportDataAsset(&ImportData);
+	// if we generated the import data asset it was fully imported already
+	if (Result == EImportDataEnsureResult::Generation || Result == EImportDataEnsureResult::Failure)
+	{
+		return;
+	}
+
+	bIsBackgroundReimportRunning = true;
+	UArticyJSONFactory::ReimportInBackground(ImportData, [this](EReimportResult::Type ReimportResult)
+	{
+		bIsBackgroundReimportRunning = false;
+
+		if (ReimportResult == EReimportResult::Cancelled)
+		{
+			ScheduleExportReimport();
+		}
+		else if (ReimportResult == EReimportResult::Failed)
+		{
+			// Most likely articy:draft is still writing the export, its next write schedules another reimport
+			UE_LOG(LogArticyEditor, Warning, TEXT("Could not reimport the changed export, it will be reimported with its next change."));
+		}
+	});
+}
+
 /**
  * Unqueue a pending import operation.
  */
@@ -0,0 +1,184 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyExpressoBenchmarkCommandlet.h"
+#include "ArticyEditorModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "ArticyRandomStream.h"
+#include "Interfaces/ArticyObjectWithDisplayName.h"
+#include "HAL/MallocBase.h"
+#include <atomic>
+
+namespace
+{
+    /** Forwards to the real allocator and counts allocations while installed as GMalloc. */
+    class FCountingMalloc final : public FMalloc
+    {
+    public:
+        explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+        virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+        {
+            Allocations.fetch_add(1, std::memory_order_relaxed);
+            return Inner->Malloc(Count, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            Allocations.fetch_add(1, std::memory_order_relaxed);
+            return Inner->Realloc(Original, Count, Alignment);
+        }
+
+        virtual void Free(void* Original) override { Inner->Free(Original); }
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+        virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+        virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+        virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+        virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+        virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+        virtual const TCHAR* GetDescriptiveName() override { return TEXT("ArticyExpressoBenchmark"); }
+
+        uint64 GetAllocations() const { return Allocations.load(std::memory_order_relaxed); }
+
+    private:
+        FMalloc* Inner;
+        std::atomic<uint64> Allocations{ 0 };
+    };
+
+    /** Keeps the compiler from dropping the results of the measured operations. */
+    volatile int64 Sink = 0;
+
+    /**
+     * @brief Runs an operation Iterations times and logs its cost per operation.
+     *
+     * @param Counter The allocator counting the allocations.
+     * @param Name The name of the operation.
+     * @param Iterations The number of times to run the operation.
+     * @param Operation The operation, returns a value that is folded into Sink.
+     */
+    template<typename Lambda>
+    void Measure(const FCountingMalloc& Counter, const TCHAR* Name, int32 Iterations, Lambda Operation)
+    {
+        // One round to warm up caches and interned strings
+        Sink += Operation();
+
+        int64 Accumulator = 0;
+        const uint64 AllocationsBefore = Counter.GetAllocations();
+        const uint64 CyclesBefore = FPlatformTime::Cycles64();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+            Accumulator += Operation();
+        const uint64 Cycles = FPlatformTime::Cycles64() - CyclesBefore;
+        const uint64 Allocations = Counter.GetAllocations() - AllocationsBefore;
+        Sink += Accumulator;
+
+        UE_LOG(LogArticyEditor, Display, TEXT("%-28s cycles/op=%8.2f ns/op=%8.2f allocs/op=%.2f"),
+            Name, (double)Cycles / Iterations, FPlatformTime::ToMilliseconds64(Cycles) * 1000000.0 / Iterations,
+            (double)Allocations / Iterations);
+    }
+}
+
+/**
+ * Main function executed by the commandlet.
+ *
+ * @param Params Command line parameters passed to the commandlet.
+ * @return 0 once the benchmark ran, 1 if the object to read properties of was not found.
+ */
+int32 UArticyExpressoBenchmarkCommandlet::Main(const FString& Params)
+{
+    const TCHAR* Cmd = *Params;
+
+    int32 Iterations = 1000000;
+    FString ObjectName;
+    FString PropertyName = TEXT("DisplayName");
+    FParse::Value(Cmd, TEXT("Iterations="), Iterations);
+    FParse::Value(Cmd, TEXT("Object="), ObjectName);
+    FParse::Value(Cmd, TEXT("Property="), PropertyName);
+    Iterations = FMath::Max(Iterations, 1);
+
+    // Property reads need a loaded object
+    UArticyObject* Object = nullptr;
+    const TWeakObjectPtr<UArticyDatabase> Database = UArticyDatabase::GetMutableOriginal();
+    if (Database.IsValid())
+    {
+        Database->LoadAllPackages(true);
+        if (!ObjectName.IsEmpty())
+        {
+            Object = Database->GetObjectByName(FName(*ObjectName));
+        }
+        else
+        {
+            for (UArticyObject* Candidate : Database->GetAllObjects())
+            {
+                if (Cast<IArticyObjectWithDisplayName>(Candidate))
+                {
+                    Object = Candidate;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!ObjectName.IsEmpty() && !Object)
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Expresso benchmark: object %s does not exist."), *ObjectName);
+        return 1;
+    }
+
+    UArticyExpressoBenchmarkScripts* Scripts = NewObject<UArticyExpressoBenchmarkScripts>();
+    Scripts->AddToRoot();
+    FArticyRandomStream RandomStream(1);
+    FArticyExpressoEvaluationScope Scope(Scripts, nullptr, nullptr, &RandomStream);
+
+    const ExpressoType IntA(int64(42));
+    const ExpressoType IntB(int64(17));
+    const ExpressoType FloatA(2.5);
+    const ExpressoType BoolA(true);
+    const ExpressoType BoolB(false);
+    const ExpressoType StringA(FString(TEXT("The quick brown fox")));
+    const ExpressoType StringB(FString(TEXT("The quick brown cat")));
+    const ExpressoType StringNumber(FString(TEXT("1234")));
+
+    FMalloc* PreviousMalloc = GMalloc;
+    FCountingMalloc* Counter = new FCountingMalloc(PreviousMalloc);
+    GMalloc = Counter;
+
+    UE_LOG(LogArticyEditor, Display, TEXT("Expresso benchmark: %d iterations per operation."), Iterations);
+
+    Measure(*Counter, TEXT("int + int"), Iterations, [&]() { return (int64)(IntA + IntB); });
+    Measure(*Counter, TEXT("int + float"), Iterations, [&]() { return (int64)(IntA + FloatA); });
+    Measure(*Counter, TEXT("float * int"), Iterations, [&]() { return (int64)(FloatA * IntB); });
+    Measure(*Counter, TEXT("int < float"), Iterations, [&]() { return (int64)(IntA < FloatA); });
+    Measure(*Counter, TEXT("int == int"), Iterations, [&]() { return (int64)(IntA == IntB); });
+    Measure(*Counter, TEXT("bool && bool"), Iterations, [&]() { return (int64)(bool)(BoolA && BoolB); });
+    Measure(*Counter, TEXT("bool || bool"), Iterations, [&]() { return (int64)(bool)(BoolA || BoolB); });
+    Measure(*Counter, TEXT("string == string"), Iterations, [&]() { return (int64)(StringA == StringB); });
+    Measure(*Counter, TEXT("string < string"), Iterations, [&]() { return (int64)(StringA < StringB); });
+    Measure(*Counter, TEXT("string == literal"), Iterations, [&]() { return (int64)(StringA == TEXT("The quick brown fox")); });
+    Measure(*Counter, TEXT("string + string"), Iterations, [&]() { return (int64)((FString)(StringA + StringB)).Len(); });
+    Measure(*Counter, TEXT("string + int"), Iterations, [&]() { return (int64)((FString)(StringA + IntA)).Len(); });
+    Measure(*Counter, TEXT("(int64) int"), Iterations, [&]() { return (int64)IntA; });
+    Measure(*Counter, TEXT("(int64) string"), Iterations, [&]() { return (int64)StringNumber; });
+    Measure(*Counter, TEXT("(double) int"), Iterations, [&]() { return (int64)(double)IntA; });
+    Measure(*Counter, TEXT("(FString) int"), Iterations, [&]() { return (int64)((FString)IntA).Len(); });
+    Measure(*Counter, TEXT("(FString) string"), Iterations, [&]() { return (int64)((FString)StringA).Len(); });
+    Measure(*Counter, TEXT("copy string"), Iterations, [&]() { const ExpressoType Copy(StringA); return (int64)Copy.GetString().Len(); });
+    Measure(*Counter, TEXT("random(0, 100)"), Iterations, [&]() { return (int64)Scripts->random(0, 100); });
+    Measure(*Counter, TEXT("random(1.0, 2.0)"), Iterations, [&]() { return (int64)(Scripts->random(1.0f, 2.0f) * 1000.0f); });
+
+    if (Object)
+    {
+        FArticyExpressoPropertyPath Path(*PropertyName);
+        Measure(*Counter, TEXT("read property by name"), Iterations, [&]() { return (int64)ExpressoType(Object, PropertyName).Type; });
+        Measure(*Counter, TEXT("read property by path"), Iterations, [&]() { return (int64)ExpressoType(Object, Path).Type; });
+    }
+    else
+    {
+        UE_LOG(LogArticyEditor, Display, TEXT("Expresso benchmark: no loaded object has a DisplayName, property reads are skipped."));
+    }
+
+    GMalloc = PreviousMalloc;
+    Scripts->RemoveFromRoot();
+    return 0;
+}
@@ -0,0 +1,259 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowTraceCommandlet.h"
+#include "ArticyEditorModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Trace/Analysis.h"
+#include "Trace/Analyzer.h"
+#include "Trace/DataStream.h"
+
+namespace
+{
+    /** An event of the ArticyFlow channel, in the order it was traced. */
+    struct FFlowTraceEvent
+    {
+        double Time = 0.0;
+        uint32 PlayerId = 0;
+        int32 ShadowLevel = 0;
+        FString Type;
+        FString Description;
+        TSharedPtr<FJsonObject> Json;
+    };
+
+    /**
+     * Collects the events of the ArticyFlow channel, keeping track of the shadow level of each player.
+     */
+    class FArticyFlowAnalyzer : public UE::Trace::IAnalyzer
+    {
+    public:
+        TArray<FFlowTraceEvent> Events;
+        TMap<uint32, FString> PlayerNames;
+
+        virtual void OnAnalysisBegin(const FOnAnalysisContext& Context) override
+        {
+            FInterfaceBuilder& Builder = Context.InterfaceBuilder;
+            Builder.RouteEvent(RouteId_FlowPlayer, "ArticyFlow", "FlowPlayer");
+            Builder.RouteEvent(RouteId_CursorMove, "ArticyFlow", "CursorMove");
+            Builder.RouteEvent(RouteId_BranchState, "ArticyFlow", "BranchState");
+            Builder.RouteEvent(RouteId_ConditionResult, "ArticyFlow", "ConditionResult");
+            Builder.RouteEvent(RouteId_VariableWrite, "ArticyFlow", "VariableWrite");
+            Builder.RouteEvent(RouteId_ShadowState, "ArticyFlow", "ShadowState");
+        }
+
+        virtual bool OnEvent(uint16 RouteId, EStyle Style, const FOnEventContext& Context) override
+        {
+            const FEventData& EventData = Context.EventData;
+            const double Time = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("Cycle"));
+
+            switch (RouteId)
+            {
+            case RouteId_FlowPlayer:
+            {
+                FString Name;
+                EventData.GetString("Name", Name);
+                PlayerNames.Add(EventData.GetValue<uint32>("PlayerId"), Name);
+                break;
+            }
+            case RouteId_CursorMove:
+            {
+                const uint64 ObjectId = EventData.GetValue<uint64>("ObjectId");
+                FFlowTraceEvent& Event = AddEvent(Time, EventData.GetValue<uint32>("PlayerId"), TEXT("cursor"));
+                Event.Description = FString::Printf(TEXT("paused at %s"), *DescribeObject(ObjectId));
+                Event.Json->SetStringField(TEXT("object"), FArticyId(ObjectId).ToString());
+                break;
+            }
+            case RouteId_BranchState:
+            {
+                const int32 Index = EventData.GetValue<int32>("Index");
+                const bool bValid = EventData.GetValue<bool>("Valid");
+                const uint64 TargetId = EventData.GetValue<uint64>("TargetId");
+                FFlowTraceEvent& Event = AddEvent(Time, EventData.GetValue<uint32>("PlayerId"), TEXT("branch"));
+                Event.Description = FString::Printf(TEXT("branch %d to %s%s"), Index, *DescribeObject(TargetId), bValid ? TEXT("") : TEXT(" (invalid)"));
+                Event.Json->SetNumberField(TEXT("index"), Index);
+                Event.Json->SetBoolField(TEXT("valid"), bValid);
+                Event.Json->SetStringField(TEXT("target"), FArticyId(TargetId).ToString());
+                break;
+            }
+            case RouteId_ConditionResult:
+            {
+                // Conditions are evaluated by the player currently exploring, the one of the last shadow push
+                const uint64 ObjectId = EventData.GetValue<uint64>("ObjectId");
+                const bool bResult = EventData.GetValue<bool>("Result");
+                FFlowTraceEvent& Event = AddEvent(Time, ActivePlayerId, TEXT("condition"));
+                Event.Description = FString::Printf(TEXT("condition %s is %s"), *DescribeObject(ObjectId), bResult ? TEXT("true") : TEXT("false"));
+                Event.Json->SetStringField(TEXT("object"), FArticyId(ObjectId).ToString());
+                Event.Json->SetBoolField(TEXT("result"), bResult);
+                break;
+            }
+            case RouteId_VariableWrite:
+            {
+                FString Name, Value;
+                EventData.GetString("Name", Name);
+                EventData.GetString("Value", Value);
+                FFlowTraceEvent& Event = AddEvent(Time, ActivePlayerId, TEXT("variable"));
+                Event.Description = FString::Printf(TEXT("%s = %s"), *Name, *Value);
+                Event.Json->SetStringField(TEXT("name"), Name);
+                Event.Json->SetStringField(TEXT("value"), Value);
+                break;
+            }
+            case RouteId_ShadowState:
+            {
+                const uint32 PlayerId = EventData.GetValue<uint32>("PlayerId");
+                const int32 Level = EventData.GetValue<int32>("Level");
+                const bool bPushed = EventData.GetValue<bool>("Pushed");
+                if (bPushed)
+                {
+                    ShadowLevels.Add(PlayerId, Level);
+                    ActivePlayerId = PlayerId;
+                }
+                FFlowTraceEvent& Event = AddEvent(Time, PlayerId, TEXT("shadow"));
+                Event.Description = FString::Printf(TEXT("%s shadow level %d"), bPushed ? TEXT("enter") : TEXT("leave"), Level);
+                Event.Json->SetNumberField(TEXT("level"), Level);
+                Event.Json->SetBoolField(TEXT("pushed"), bPushed);
+                if (!bPushed)
+                    ShadowLevels.Add(PlayerId, Level - 1);
+                break;
+            }
+            default:
+                break;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Gets the name of a flow player, its ID if the trace did not name it.
+         *
+         * @param PlayerId The unique ID of the player.
+         * @return The name of the player.
+         */
+        FString GetPlayerName(uint32 PlayerId) const
+        {
+            const FString* Name = PlayerNames.Find(PlayerId);
+            return Name ? *Name : FString::Printf(TEXT("Player %u"), PlayerId);
+        }
+
+    private:
+        enum : uint16
+        {
+            RouteId_FlowPlayer,
+            RouteId_CursorMove,
+            RouteId_BranchState,
+            RouteId_ConditionResult,
+            RouteId_VariableWrite,
+            RouteId_ShadowState,
+        };
+
+        /**
+         * @brief Appends an event at the current shadow level of its player.
+         *
+         * @param Time The time of the event in seconds.
+         * @param PlayerId The player the event belongs to.
+         * @param Type The type of the event as written to the JSON file.
+         * @return The new event.
+         */
+        FFlowTraceEvent& AddEvent(double Time, uint32 PlayerId, const TCHAR* Type)
+        {
+            FFlowTraceEvent& Event = Events.AddDefaulted_GetRef();
+            Event.Time = Time;
+            Event.PlayerId = PlayerId;
+            Event.ShadowLevel = ShadowLevels.FindRef(PlayerId);
+            Event.Type = Type;
+            Event.Json = MakeShared<FJsonObject>();
+            return Event;
+        }
+
+        /**
+         * @brief Describes an object by its technical name if the imported database knows it.
+         *
+         * @param Id The articy ID of the object.
+         * @return The technical name and ID, or only the ID.
+         */
+        static FString DescribeObject(uint64 Id)
+        {
+            const FArticyId ArticyId{ Id };
+            const UArticyDatabase* Database = UArticyDatabase::GetMutableOriginal().Get();
+            const UArticyObject* Object = Database ? Database->GetObject<UArticyObject>(ArticyId) : nullptr;
+            return Object ? FString::Printf(TEXT("%s [%s]"), *Object->GetTechnicalName().ToString(), *ArticyId.ToString()) : ArticyId.ToString();
+        }
+
+        TMap<uint32, int32> ShadowLevels;
+        uint32 ActivePlayerId = 0;
+    };
+}
+
+/**
+ * Main function executed by the commandlet.
+ *
+ * @param Params Command line parameters passed to the commandlet.
+ * @return 0 if the timeline was written, 1 otherwise.
+ */
+int32 UArticyFlowTraceCommandlet::Main(const FString& Params)
+{
+    const TCHAR* Cmd = *Params;
+
+    FString TracePath;
+    if (!FParse::Value(Cmd, TEXT("Trace="), TracePath))
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Flow trace: pass the trace to analyze with -Trace=<File.utrace>."));
+        return 1;
+    }
+
+    FString OutPath = FPaths::ProjectSavedDir() / (FPaths::GetBaseFilename(TracePath) + TEXT(".flow.json"));
+    FParse::Value(Cmd, TEXT("Out="), OutPath);
+
+    UE::Trace::FFileDataStream DataStream;
+    if (!DataStream.Open(*TracePath))
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Flow trace: failed to open %s."), *TracePath);
+        return 1;
+    }
+
+    // Resolves object IDs to technical names, the timeline is written with IDs only without it
+    if (UArticyDatabase* Database = UArticyDatabase::GetMutableOriginal().Get())
+        Database->LoadAllPackages();
+
+    FArticyFlowAnalyzer Analyzer;
+    {
+        UE::Trace::FAnalysisContext Context;
+        Context.AddAnalyzer(Analyzer);
+        Context.Process(DataStream).Wait();
+    }
+
+    if (Analyzer.Events.Num() == 0)
+        UE_LOG(LogArticyEditor, Warning, TEXT("Flow trace: %s has no ArticyFlow events, was it recorded with -trace=ArticyFlow?"), *TracePath);
+
+    TArray<TSharedPtr<FJsonValue>> EventsJson;
+    EventsJson.Reserve(Analyzer.Events.Num());
+    for (const FFlowTraceEvent& Event : Analyzer.Events)
+    {
+        const FString PlayerName = Analyzer.GetPlayerName(Event.PlayerId);
+        UE_LOG(LogArticyEditor, Display, TEXT("%10.6f %-24s %s%s"), Event.Time, *PlayerName, *FString::ChrN(Event.ShadowLevel * 2, TEXT(' ')), *Event.Description);
+
+        Event.Json->SetNumberField(TEXT("time"), Event.Time);
+        Event.Json->SetStringField(TEXT("player"), PlayerName);
+        Event.Json->SetNumberField(TEXT("shadowLevel"), Event.ShadowLevel);
+        Event.Json->SetStringField(TEXT("type"), Event.Type);
+        EventsJson.Add(MakeShared<FJsonValueObject>(Event.Json));
+    }
+
+    TSharedRef<FJsonObject> TimelineJson = MakeShared<FJsonObject>();
+    TimelineJson->SetStringField(TEXT("trace"), TracePath);
+    TimelineJson->SetArrayField(TEXT("events"), EventsJson);
+
+    FString TimelineString;
+    FJsonSerializer::Serialize(TimelineJson, TJsonWriterFactory<>::Create(&TimelineString));
+    if (!FFileHelper::SaveStringToFile(TimelineString, *OutPath))
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Flow trace: failed to write the timeline to %s."), *OutPath);
+        return 1;
+    }
+    UE_LOG(LogArticyEditor, Display, TEXT("Flow trace: %d events written to %s."), Analyzer.Events.Num(), *OutPath);
+    return 0;
+}
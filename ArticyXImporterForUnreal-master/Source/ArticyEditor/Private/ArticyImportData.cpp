@@ -8,6 +8,8 @@
 #include "ArticyPluginSettings.h"
 #include "Internationalization/Regex.h"
 #include "ArticyEditorModule.h"
+#include "ArticyImportStats.h"
+#include "ArticyHelpers.h"
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 24
 #include "Dialogs/Dialogs.h"
 #else
@@ -24,6 +26,14 @@
 #include "Misc/FileHelper.h"
 #include "Factories/SoundFactory.h"
 #include "UObject/SavePackage.h"
+#include "Async/ParallelFor.h"
+#include "Misc/SecureHash.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
 
 #define LOCTEXT_NAMESPACE "ArticyImportData"
 
@@ -599,6 +609,8 @@ void UArticyImportData::PostImport()
 	FArticyEditorModule& ArticyEditorModule = FModuleManager::Get().GetModuleChecked<FArticyEditorModule>(
 		"ArticyEditor");
 	ArticyEditorModule.OnImportFinished.Broadcast();
+
+	FArticyImportStats::Get().LogSummary();
 }
 
 /**
@@ -617,7 +629,22 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 	// Record old script fragments hash
 	const FString& OldScriptFragmentsHash = Settings.ScriptFragmentsHash;
 
+	// The manifest holds the settings and languages, if neither it nor any file changed the generated assets are kept
+	FString ManifestHash;
+	Archive.HashFile(TEXT("manifest.json"), ManifestHash);
+	bool bExportChanged = ManifestHash.IsEmpty() || !ManifestHash.Equals(Settings.ManifestHash);
+	Settings.ManifestHash = ManifestHash;
+
+	TSet<FString> OldCultures;
+	for (const auto& Language : Languages.Languages)
+		OldCultures.Add(Language.Key);
+
+	// Sections are imported into this object one after the other, so the import cannot be cancelled half way
+	FScopedSlowTask SlowTask(6.f, LOCTEXT("ImportingArticyData", "Importing articy:draft data"));
+	SlowTask.MakeDialogDelayed(0.5f);
+
 	// import the main sections
+	SlowTask.EnterProgressFrame(1.f, LOCTEXT("ImportingPackages", "Reading packages"));
 	Settings.ImportFromJson(RootObject->GetObjectField(JSON_SECTION_SETTINGS));
 
 	if (Settings.set_IncludedNodes.Contains(TEXT("Project")))
@@ -626,7 +653,10 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 	Languages.ImportFromJson(RootObject);
 
 	if (Settings.set_IncludedNodes.Contains(TEXT("Packages")))
-		PackageDefs.ImportFromJson(Archive, &RootObject->GetArrayField(JSON_SECTION_PACKAGES), Settings);
+	{
+		ARTICY_IMPORT_STAGE(ParsePackages);
+		bExportChanged |= PackageDefs.ImportFromJson(Archive, &RootObject->GetArrayField(JSON_SECTION_PACKAGES), Settings);
+	}
 
 	if (Settings.set_IncludedNodes.Contains(TEXT("Hierarchy")))
 	{
@@ -639,6 +669,7 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 				HierarchyObject))
 		{
 			Hierarchy.ImportFromJson(this, HierarchyObject);
+			bExportChanged = true;
 		}
 	}
 
@@ -652,11 +683,15 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 	{
 		UserMethods.ImportFromJson(&UserMethodsObject->GetArrayField(JSON_SECTION_SCRIPTMEETHODS));
 		Settings.SetScriptFragmentsNeedRebuild();
+		bExportChanged = true;
 	}
 
 	bool bNeedsCodeGeneration = false;
 
-	ParentChildrenCache.Empty();
+	// Ends after the object definitions' texts are gathered
+	TOptional<FArticyImportStats::FStageScope> DefinitionsStage;
+	DefinitionsStage.Emplace(TEXT("ParseDefinitions"));
+	SlowTask.EnterProgressFrame(1.f, LOCTEXT("ImportingDefinitions", "Reading global variables and object definitions"));
 
 	TSharedPtr<FJsonObject> GvObject;
 	if (Archive.FetchJson(
@@ -668,6 +703,7 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 		GlobalVariables.ImportFromJson(&GvObject->GetArrayField(JSON_SECTION_GLOBALVARS), this);
 		Settings.SetObjectDefinitionsNeedRebuild();
 		bNeedsCodeGeneration = true;
+		bExportChanged = true;
 	}
 
 	const TSharedPtr<FJsonObject> ObjectDefs = RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS);
@@ -678,9 +714,14 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 		Settings.ObjectDefinitionsHash,
 		ObjTypes))
 	{
-		ObjectDefinitions.ImportFromJson(&ObjTypes->GetArrayField(JSON_SECTION_OBJECTDEFS), this);
-		Settings.SetObjectDefinitionsNeedRebuild();
-		bNeedsCodeGeneration = true;
+		bExportChanged = true;
+
+		// The types file changes as a whole, the generated types only need to change with the definitions in it
+		if (ObjectDefinitions.ImportFromJson(&ObjTypes->GetArrayField(JSON_SECTION_OBJECTDEFS), this))
+		{
+			Settings.SetObjectDefinitionsNeedRebuild();
+			bNeedsCodeGeneration = true;
+		}
 	}
 
 	const FString OldObjectDefintionsTextHash = Settings.ObjectDefinitionsTextHash;
@@ -691,11 +732,13 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 		Settings.ObjectDefinitionsTextHash,
 		ObjTexts))
 	{
+		// Only the ARTICY string table is made from these, the generated code does not change with them
 		ObjectDefinitions.GatherText(ObjTexts);
-		Settings.SetObjectDefinitionsNeedRebuild();
-		bNeedsCodeGeneration = true;
+		bExportChanged = true;
 	}
 
+	DefinitionsStage.Reset();
+
 	if (Settings.ScriptFragmentsHash.IsEmpty() || !Settings.ScriptFragmentsHash.Equals(OldScriptFragmentsHash))
 	{
 		Settings.SetScriptFragmentsNeedRebuild();
@@ -703,6 +746,8 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 
 	if (Settings.DidScriptFragmentsChange() && this->GetSettings().set_UseScriptSupport)
 	{
+		ARTICY_IMPORT_STAGE(GatherScripts);
+		SlowTask.EnterProgressFrame(1.f, LOCTEXT("GatheringScripts", "Gathering script fragments"));
 		this->GatherScripts();
 		bNeedsCodeGeneration = true;
 	}
@@ -748,23 +793,36 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 		Languages.Languages.Add(TEXT(""), Elem.Value);
 	}
 
-	// Create string tables
-	if (!OldObjectDefintionsTextHash.Equals(Settings.ObjectDefinitionsTextHash))
+	// Tables of packages whose texts did not change are only rewritten for new languages
+	bool bLanguagesChanged = OldCultures.Num() != Languages.Languages.Num();
+	for (const auto& Language : Languages.Languages)
+		bLanguagesChanged |= !OldCultures.Contains(Language.Key);
+	bExportChanged |= bLanguagesChanged;
+
+	// Gather the string tables to create
+	struct FStringTableJob
+	{
+		FString TableName;
+		const TMap<FString, FArticyTexts>* Texts;
+		const TPair<FString, FArticyLanguageDef>* Language;
+	};
+	TArray<FStringTableJob> StringTables;
+
+	if (bLanguagesChanged || !OldObjectDefintionsTextHash.Equals(Settings.ObjectDefinitionsTextHash))
 	{
 		const auto& ObjectDefsText = GetObjectDefs().GetTexts();
 		for (const auto& Language : Languages.Languages)
 		{
-			StringTableGenerator(TEXT("ARTICY"), Language.Key, [&](StringTableGenerator* CsvOutput)
-				{
-					return ProcessStrings(CsvOutput, ObjectDefsText, Language);
-				});
+			StringTables.Add({ TEXT("ARTICY"), &ObjectDefsText, &Language });
 		}
 	}
 
+	// The jobs point into this copy, GetPackages returns by value
+	const TArray<FArticyPackageDef> PackageDefsCopy = GetPackageDefs().GetPackages();
 	for (const auto& Language : Languages.Languages)
 	{
 		// Handle packages
-		for (const auto& Package : GetPackageDefs().GetPackages())
+		for (const auto& Package : PackageDefsCopy)
 		{
 			const FString PackageName = Package.GetName();
 			const FString StringTableFileName = PackageName.Replace(TEXT(" "), TEXT("_"));
@@ -814,25 +872,58 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 				}
 			}
 
-			if (!Package.GetIsIncluded())
+			if (!Package.GetIsIncluded() || !(bLanguagesChanged || Package.DidTextsChange()))
 				continue;
 
-			StringTableGenerator(StringTableFileName, Language.Key,
-				[&](StringTableGenerator* CsvOutput)
-				{
-					return ProcessStrings(CsvOutput, Package.GetTexts(), Language);
-				});
+			StringTables.Add({ StringTableFileName, &Package.GetTexts(), &Language });
 		}
 	}
 
+	// Tables are independent, stream them all in parallel and replace the changed ones on the game thread
+	TOptional<FArticyImportStats::FStageScope> StringTablesStage;
+	StringTablesStage.Emplace(TEXT("StringTables"));
+	SlowTask.EnterProgressFrame(1.f, LOCTEXT("GeneratingStringTables", "Generating string tables"));
+	TArray<TUniquePtr<StringTableGenerator>> Generators;
+	Generators.SetNum(StringTables.Num());
+	ParallelFor(StringTables.Num(), [&](int32 Index)
+	{
+		const FStringTableJob& Job = StringTables[Index];
+		Generators[Index] = MakeUnique<StringTableGenerator>(Job.TableName, Job.Language->Key,
+			[&](StringTableGenerator* CsvOutput)
+			{
+				return ProcessStrings(CsvOutput, *Job.Texts, *Job.Language);
+			}, false);
+	});
+
+	for (const auto& Generator : Generators)
+		Generator->Commit();
+	Generators.Empty();
+	StringTablesStage.Reset();
+
 	// Import Unreal audio assets
-	FString AssetBaseDirectory = FPaths::ProjectContentDir() + TEXT("ArticyContent/Resources/Assets/");
-	ImportAudioAssets(AssetBaseDirectory);
+	{
+		ARTICY_IMPORT_STAGE(AudioAssets);
+		SlowTask.EnterProgressFrame(1.f, LOCTEXT("ImportingAudio", "Importing audio assets"));
+		FString AssetBaseDirectory = FPaths::ProjectContentDir() + TEXT("ArticyContent/Resources/Assets/");
+		ImportAudioAssets(AssetBaseDirectory);
+	}
+
+	if (!bExportChanged && !bNeedsCodeGeneration)
+	{
+		// The generated code and assets are still those of the last import
+		UE_LOG(LogArticyEditor, Log, TEXT("Nothing changed since the last import, keeping the generated assets."));
+		PostImport();
+		return true;
+	}
+
+	ParentChildrenCache.Empty();
 
 	// if we are generating code, generate and compile it; after it has finished, generate assets and perform post import logic
+	bool bAnyCodeGenerated = false;
 	if (bNeedsCodeGeneration)
 	{
-		const bool bAnyCodeGenerated = CodeGenerator::GenerateCode(this);
+		SlowTask.EnterProgressFrame(1.f, LOCTEXT("GeneratingCode", "Generating code"));
+		bAnyCodeGenerated = CodeGenerator::GenerateCode(this);
 
 		if (bAnyCodeGenerated)
 		{
@@ -856,8 +947,8 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 			CodeGenerator::Recompile(this);
 		}
 	}
-	// if we are importing but no code needed to be generated, generate assets immediately and perform post import
-	else
+	// if we are importing but no generated code changed, generate assets immediately and perform post import
+	if (!bAnyCodeGenerated)
 	{
 		BuildCachedVersion();
 		CodeGenerator::GenerateAssets(this);
@@ -867,6 +958,22 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 	return true;
 }
 
+/**
+ * Adds the hashes of the files the last import read, files of a new export with one of them are not read again.
+ *
+ * @param OutHashes The set that receives the hashes.
+ */
+void UArticyImportData::GatherImportedFileHashes(TSet<FString>& OutHashes) const
+{
+	for (const FString* Hash : { &Settings.GlobalVariablesHash, &Settings.ObjectDefinitionsHash, &Settings.ObjectDefinitionsTextHash,
+		&Settings.HierarchyHash, &Settings.ScriptMethodsHash })
+	{
+		if (!Hash->IsEmpty())
+			OutHashes.Add(*Hash);
+	}
+	PackageDefs.GatherFileHashes(OutHashes);
+}
+
 /**
  * Processes strings and writes them to a CSV output.
  *
@@ -875,7 +982,7 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
  * @param Language The language information.
  * @return The number of processed strings.
  */
-int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language)
+int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language) const
 {
 	int Counter = 0;
 
@@ -914,6 +1021,7 @@ int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMa
 
 /**
  * Imports audio assets from a directory.
+ * Files whose size, timestamp or contents did not change since their last import are skipped.
  *
  * @param BaseContentDir The base content directory.
  */
@@ -926,16 +1034,75 @@ void UArticyImportData::ImportAudioAssets(const FString& BaseContentDir)
     FileManager.FindFilesRecursive(FilesToImport, *BaseContentDir, TEXT("*.wav"), true, false, false);
     FileManager.FindFilesRecursive(FilesToImport, *BaseContentDir, TEXT("*.ogg"), true, false, false);
 
+    struct FAudioFileState
+    {
+        FString RelativePath;
+        FArticyAudioAssetRecord Record;
+        bool bNeedsImport = false;
+    };
+
+    TArray<FAudioFileState> FileStates;
+    FileStates.SetNum(FilesToImport.Num());
+
+    // Stat and, where needed, hash all files in parallel; only reads the manifest
+    ParallelFor(FilesToImport.Num(), [&](int32 Index)
+    {
+        const FString& FilePath = FilesToImport[Index];
+        FAudioFileState& State = FileStates[Index];
+
+        State.RelativePath = FilePath;
+        FPaths::MakePathRelativeTo(State.RelativePath, *BaseContentDir);
+
+        const FFileStatData StatData = FileManager.GetStatData(*FilePath);
+        State.Record.Size = StatData.FileSize;
+        State.Record.Timestamp = StatData.ModificationTime;
+
+        const FArticyAudioAssetRecord* Existing = AudioAssetManifest.Find(State.RelativePath);
+        if (Existing)
+        {
+            // The generated asset may have been deleted outside of the importer
+            const FString AssetFileName = FPackageName::LongPackageNameToFilename(Existing->SoundWave.GetLongPackageName(), FPackageName::GetAssetPackageExtension());
+            if (Existing->SoundWave.IsNull() || !FPaths::FileExists(AssetFileName))
+                Existing = nullptr;
+        }
+
+        if (Existing && Existing->Size == State.Record.Size && Existing->Timestamp == State.Record.Timestamp)
+        {
+            State.Record = *Existing;
+            return;
+        }
+
+        State.Record.Hash = LexToString(FMD5Hash::HashFile(*FilePath));
+        if (Existing && Existing->Size == State.Record.Size && Existing->Hash == State.Record.Hash)
+        {
+            // Touched but unchanged
+            State.Record.SoundWave = Existing->SoundWave;
+            return;
+        }
+
+        State.bNeedsImport = true;
+    });
+
+    // Files that are gone no longer have a record, their assets are left alone
+    AudioAssetManifest.Reset();
+
     IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+    USoundFactory* Factory = nullptr;
+    int32 NumImported = 0;
 
-    for (const FString& FilePath : FilesToImport)
+    for (int32 Index = 0; Index < FilesToImport.Num(); ++Index)
     {
-        // Calculate the relative path from the base directory
-        FString RelativePath = FilePath;
-        FPaths::MakePathRelativeTo(RelativePath, *BaseContentDir);
+        const FString& FilePath = FilesToImport[Index];
+        FAudioFileState& State = FileStates[Index];
+
+        if (!State.bNeedsImport)
+        {
+            AudioAssetManifest.Add(State.RelativePath, State.Record);
+            continue;
+        }
 
         // Determine the package path based on the relative path
-        FString PackagePath = TEXT("/Game/ArticyContent/Resources/Assets/") + FPaths::GetPath(RelativePath);
+        FString PackagePath = TEXT("/Game/ArticyContent/Resources/Assets/") + FPaths::GetPath(State.RelativePath);
         FString FileName = FPaths::GetBaseFilename(FilePath);
         FString PackageFileName = FPaths::Combine(PackagePath, FileName + TEXT(".uasset"));
 
@@ -978,17 +1145,20 @@ void UArticyImportData::ImportAudioAssets(const FString& BaseContentDir)
             continue;
         }
 
-        // Import the sound file
+        // Import the sound file, one factory serves all files
         bool bCancelled = false;
-        USoundFactory* Factory = NewObject<USoundFactory>();
         if (!Factory)
         {
-            UE_LOG(LogArticyEditor, Error, TEXT("Failed to create USoundFactory for: %s"), *FileName);
-            continue;
-        }
+            Factory = NewObject<USoundFactory>();
+            if (!Factory)
+            {
+                UE_LOG(LogArticyEditor, Error, TEXT("Failed to create USoundFactory for: %s"), *FileName);
+                continue;
+            }
 
-        Factory->SuppressImportDialogs(); // Suppress overwrite prompts
-        Factory->bAutoCreateCue = false;
+            Factory->SuppressImportDialogs(); // Suppress overwrite prompts
+            Factory->bAutoCreateCue = false;
+        }
 
         UObject* ImportedAsset = Factory->ImportObject(NewSoundWave->GetClass(), Package, FName(*FileName), RF_Public | RF_Standalone, FilePath, nullptr, bCancelled);
         if (!ImportedAsset || bCancelled)
@@ -1019,8 +1189,16 @@ void UArticyImportData::ImportAudioAssets(const FString& BaseContentDir)
             continue;
         }
 
+        // Only successful imports get a record so failed ones are retried next time
+        State.Record.SoundWave = FSoftObjectPath(ImportedAsset);
+        AudioAssetManifest.Add(State.RelativePath, State.Record);
+        ++NumImported;
+        FArticyImportStats::Get().Add(FArticyImportStats::ECounter::AssetsSaved, 1);
+
         UE_LOG(LogArticyEditor, Log, TEXT("Successfully imported and saved sound asset: %s"), *FileName);
     }
+
+    UE_LOG(LogArticyEditor, Log, TEXT("Imported %d of %d audio files, the others are unchanged"), NumImported, FilesToImport.Num());
 }
 
 /**
@@ -1093,6 +1271,186 @@ void UArticyImportData::GatherScripts()
 {
 	ScriptFragments.Empty();
 	PackageDefs.GatherScripts(this);
+	ScriptFragmentPackage.Empty();
+	ScriptFragmentsByCode.Empty();
+}
+
+/**
+ * Reduces a parsed fragment to the code it compiles to, without comments and with whitespace collapsed outside of string literals.
+ *
+ * @param ParsedFragment The parsed fragment.
+ * @return The code of the fragment, empty if it has none.
+ */
+static FString GetFragmentCode(const FString& ParsedFragment)
+{
+	FString code;
+	code.Reserve(ParsedFragment.Len());
+
+	bool bInLiteral = false;
+	bool bPendingSpace = false;
+	for (int32 i = 0; i < ParsedFragment.Len(); ++i)
+	{
+		const TCHAR c = ParsedFragment[i];
+		if (bInLiteral)
+		{
+			code.AppendChar(c);
+			if (c == TEXT('\\') && i + 1 < ParsedFragment.Len())
+				code.AppendChar(ParsedFragment[++i]);
+			else if (c == TEXT('"'))
+				bInLiteral = false;
+			continue;
+		}
+
+		// comments were moved to their own lines by AddScriptFragment
+		if (c == TEXT('/') && i + 1 < ParsedFragment.Len() && ParsedFragment[i + 1] == TEXT('/'))
+		{
+			while (i < ParsedFragment.Len() && ParsedFragment[i] != TEXT('\n'))
+				++i;
+			bPendingSpace = true;
+			continue;
+		}
+
+		if (FChar::IsWhitespace(c))
+		{
+			bPendingSpace = true;
+			continue;
+		}
+
+		if (bPendingSpace && code.Len() > 0)
+			code.AppendChar(TEXT(' '));
+		bPendingSpace = false;
+
+		code.AppendChar(c);
+		bInLiteral = c == TEXT('"');
+	}
+	return code;
+}
+
+/**
+ * Replaces object IDs and property names passed as literals to getObj, getProp and setProp with values
+ * resolved when the scripts are generated, so they are not parsed again on every evaluation.
+ * Expects the literals of the statement to be wrapped in FString(TEXT(...)) already.
+ *
+ * @param Line The statement to change.
+ */
+static void PrecompileObjectAccess(FString& Line)
+{
+	const TCHAR* literalPrefix = TEXT("FString(TEXT(\"");
+	const TCHAR* literalSuffix = TEXT("\"))");
+	const int32 literalPrefixLen = FCString::Strlen(literalPrefix);
+	const int32 literalSuffixLen = FCString::Strlen(literalSuffix);
+
+	// reads the wrapped literal at Start, returns the end of the wrapping or INDEX_NONE if there is none
+	auto readLiteral = [&](int32 Start, FString& OutLiteral) -> int32
+	{
+		while (Start < Line.Len() && FChar::IsWhitespace(Line[Start]))
+			++Start;
+
+		if (FCString::Strncmp(*Line + Start, literalPrefix, literalPrefixLen) != 0)
+			return INDEX_NONE;
+
+		const int32 textStart = Start + literalPrefixLen;
+		for (int32 i = textStart; i < Line.Len(); ++i)
+		{
+			// literals with escapes are left to the runtime
+			if (Line[i] == TEXT('\\'))
+				return INDEX_NONE;
+
+			if (Line[i] == TEXT('"'))
+			{
+				if (FCString::Strncmp(*Line + i, literalSuffix, literalSuffixLen) != 0)
+					return INDEX_NONE;
+
+				OutLiteral = Line.Mid(textStart, i - textStart);
+				return i + literalSuffixLen;
+			}
+		}
+		return INDEX_NONE;
+	};
+
+	// finds the comma or closing parenthesis ending the call argument at Start
+	auto findArgumentEnd = [&](int32 Start) -> int32
+	{
+		int32 depth = 0;
+		bool bInLiteral = false;
+		for (int32 i = Start; i < Line.Len(); ++i)
+		{
+			const TCHAR c = Line[i];
+			if (bInLiteral)
+			{
+				if (c == TEXT('\\'))
+					++i;
+				else if (c == TEXT('"'))
+					bInLiteral = false;
+			}
+			else if (c == TEXT('"'))
+				bInLiteral = true;
+			else if (c == TEXT('(') || c == TEXT('['))
+				++depth;
+			else if ((c == TEXT(')') || c == TEXT(']')) && depth-- == 0)
+				return i;
+			else if (c == TEXT(',') && depth == 0)
+				return i;
+		}
+		return INDEX_NONE;
+	};
+
+	bool bInLiteral = false;
+	for (int32 i = 0; i < Line.Len(); ++i)
+	{
+		const TCHAR c = Line[i];
+		if (bInLiteral)
+		{
+			if (c == TEXT('\\'))
+				++i;
+			else if (c == TEXT('"'))
+				bInLiteral = false;
+			continue;
+		}
+
+		if (c == TEXT('"'))
+		{
+			bInLiteral = true;
+			continue;
+		}
+
+		// only calls, not identifiers ending in the function names
+		if (i > 0 && FChar::IsIdentifier(Line[i - 1]))
+			continue;
+
+		const TCHAR* call = *Line + i;
+		if (FCString::Strncmp(call, TEXT("getObj("), 7) == 0)
+		{
+			FString literal;
+			const int32 end = readLiteral(i + 7, literal);
+			if (end == INDEX_NONE || !literal.StartsWith(TEXT("0x")) || literal.Len() < 3 || literal.Len() > 18)
+				continue;
+
+			bool bIsHex = true;
+			for (int32 j = 2; j < literal.Len() && bIsHex; ++j)
+				bIsHex = FChar::IsHexDigit(literal[j]);
+			if (!bIsHex)
+				continue;
+
+			const FString id = FString::Printf(TEXT("getObj(FArticyId{ %sull }"), *literal);
+			Line = Line.Left(i) + id + Line.Mid(end);
+			i += id.Len() - 1;
+		}
+		else if (FCString::Strncmp(call, TEXT("getProp("), 8) == 0 || FCString::Strncmp(call, TEXT("setProp("), 8) == 0)
+		{
+			// the property name is the second argument, the object argument is scanned after it was replaced
+			const int32 comma = findArgumentEnd(i + 8);
+			if (comma == INDEX_NONE || Line[comma] != TEXT(','))
+				continue;
+
+			FString literal;
+			const int32 end = readLiteral(comma + 1, literal);
+			if (end == INDEX_NONE)
+				continue;
+
+			Line = Line.Left(comma + 1) + FString::Printf(TEXT(" ARTICY_PROPERTY_PATH(TEXT(\"%s\"))"), *literal) + Line.Mid(end);
+		}
+	}
 }
 
 /**
@@ -1103,6 +1461,27 @@ void UArticyImportData::GatherScripts()
  */
 void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bIsInstruction)
 {
+	FArticyImportStats::Get().Add(FArticyImportStats::ECounter::FragmentsGathered, 1);
+
+	FArticyExpressoFragment frag;
+	frag.bIsInstruction = bIsInstruction;
+	frag.OriginalFragment = *Fragment;
+
+	// The same text is found on many pins, only the first one needs to be parsed.
+	// Keep the first package a shared fragment was found in, so its generated file stays put
+	if (ScriptFragments.Contains(frag))
+		return;
+
+	// Fragments doing the same in any state need no code, they are registered with their result
+	frag.bIsConstant = ArticyHelpers::FoldConstantScript(Fragment, bIsInstruction, frag.bConstantResult);
+	if (frag.bIsConstant)
+	{
+		FArticyImportStats::Get().Add(FArticyImportStats::ECounter::FragmentsFolded, 1);
+		frag.PackageName = ScriptFragmentPackage;
+		ScriptFragments.Add(frag);
+		return;
+	}
+
 	//match any group of two words separated by a dot, that does not start with a double quote
 	// (?<!["a-zA-Z])(\w+\.\w+)
 	//NOTE: static is no good here! crashes on application quit...
@@ -1186,9 +1565,10 @@ void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bI
 
 			offset = 0;
 
-			//replace all remaining Namespace.Variable with *Namespace->Variable
+			//replace all remaining Namespace.Variable with Globals->Get<Slots::Namespace::Variable>()
 			//note: if the variable appears to the right of an assignment operator,
-			//write Namespace->Variable->Get() instead
+			//write Globals->Get<Slots::Namespace::Variable>().Get() instead
+			const FString slotsNamespace = CodeGenerator::GetGVSlotsNamespace(this);
 			while (gvAccess.FindNext())
 			{
 				auto start = gvAccess.GetMatchBeginning() + offset;
@@ -1212,21 +1592,15 @@ void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bI
 				if (!inLiteral)
 				{
 					// only to GV replacement if we are not within a literal string
+					FString access = FString::Printf(TEXT("Globals->Get<%s::%s>()"), *slotsNamespace,
+						*line.Mid(start, end - start).Replace(TEXT("."), TEXT("::")));
+
+					//there is an assignment operator to the left of this, thus get the raw value
 					if (lastAssignment < start)
-					{
-						//there is an assignment operator to the left of this, thus get the raw value
-						line = line.Left(start) + line.Mid(start, end - start).Replace(TEXT("."), TEXT("->")) +
-							TEXT("->Get()") + line.Mid(end);
+						access += TEXT(".Get()");
 
-						offset += strlen(">") + strlen("->Get()");
-					}
-					else
-					{
-						//get the dereferenced variable
-						line = line.Left(start) + TEXT("(*") + line.Mid(start, end - start).Replace(
-							TEXT("."), TEXT("->")) + ")" + line.Mid(end);
-						offset += strlen(".") + strlen(">") + strlen("()");
-					}
+					line = line.Left(start) + access + line.Mid(end);
+					offset += access.Len() - (end - start);
 				} // !inLiteral
 			} // GV matching
 
@@ -1264,6 +1638,8 @@ void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bI
 				offset += strlen("getSeenCounter()") - (end - start);
 			}
 
+			PrecompileObjectAccess(line);
+
 			//re-compose the string
 			string += line;
 
@@ -1277,10 +1653,20 @@ void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bI
 		}
 	}
 
-	FArticyExpressoFragment frag;
-	frag.bIsInstruction = bIsInstruction;
-	frag.OriginalFragment = *Fragment;
 	frag.ParsedFragment = string;
+	frag.PackageName = ScriptFragmentPackage;
+
+	// Texts that only differ in whitespace or comments compile to the same code, they share the function of the first one
+	const FString code = GetFragmentCode(string);
+	if (!code.IsEmpty())
+	{
+		const FString codeKey = (bIsInstruction ? TEXT("I:") : TEXT("C:")) + code;
+		if (const FString* sharedFragment = ScriptFragmentsByCode.Find(codeKey))
+			frag.SharedFragment = *sharedFragment;
+		else
+			ScriptFragmentsByCode.Add(codeKey, frag.OriginalFragment);
+	}
+
 	ScriptFragments.Add(frag);
 }
 
@@ -1298,44 +1684,213 @@ void UArticyImportData::AddChildToParentCache(const FArticyId Parent, const FArt
 	childrenRef.Values.AddUnique(Child);
 }
 
+namespace
+{
+	/** The first bytes of a cached version file, "AIDC" */
+	constexpr uint32 CachedVersionMagic = 0x43444941;
+	constexpr uint32 CachedVersionFormat = 1;
+
+	/** One property of FArticyImportDataStruct in the cached version file. */
+	struct FCachedVersionSection
+	{
+		FString Name;
+		/** Hash of the unpacked bytes, unchanged sections keep their packed bytes when the file is rewritten. */
+		uint32 Hash = 0;
+		int32 UnpackedSize = 0;
+		TArray<uint8> Packed;
+
+		friend FArchive& operator<<(FArchive& Ar, FCachedVersionSection& Section)
+		{
+			return Ar << Section.Name << Section.Hash << Section.UnpackedSize << Section.Packed;
+		}
+	};
+
+	/**
+	 * @brief Reads the sections of a cached version file.
+	 *
+	 * @param Filename The file to read.
+	 * @param OutSections Receives the sections, still packed.
+	 * @return False if the file does not exist or was written in another format.
+	 */
+	bool ReadCachedVersionSections(const FString& Filename, TArray<FCachedVersionSection>& OutSections)
+	{
+		TArray<uint8> Bytes;
+		if (!FFileHelper::LoadFileToArray(Bytes, *Filename, FILEREAD_Silent))
+			return false;
+
+		FMemoryReader Reader(Bytes);
+		uint32 Magic = 0;
+		uint32 Format = 0;
+		Reader << Magic << Format;
+		if (Magic != CachedVersionMagic || Format != CachedVersionFormat)
+			return false;
+
+		Reader << OutSections;
+		return !Reader.IsError();
+	}
+
+	/**
+	 * @brief Serializes a property of the import data, writing names and object paths as strings.
+	 *
+	 * @param Property The property to serialize.
+	 * @param Container The object or struct holding the property.
+	 * @param Ar The archive to serialize with.
+	 */
+	void SerializeCachedVersionSection(FProperty* Property, void* Container, FArchive& Ar)
+	{
+		FObjectAndNameAsStringProxyArchive Proxy(Ar, false);
+		FStructuredArchiveFromArchive Adapter(Proxy);
+		Property->SerializeItem(Adapter.GetSlot(), Property->ContainerPtrToValuePtr<void>(Container), nullptr);
+	}
+}
+
+/**
+ * Gets the file the last working import is cached in.
+ *
+ * @return The cached version file of this import asset.
+ */
+FString UArticyImportData::GetCachedVersionFilename() const
+{
+	return FPaths::ProjectIntermediateDir() / TEXT("ArticyImporter") / GetName() + TEXT(".aidcache");
+}
+
+/**
+ * Checks whether a previous import can be restored.
+ *
+ * @return True if an import worked and its cached version file exists.
+ */
+bool UArticyImportData::HasCachedVersion() const
+{
+	return bHasCachedVersion && IFileManager::Get().FileExists(*GetCachedVersionFilename());
+}
+
 /**
  * Builds a cached version of the import data.
+ *
+ * Every property of FArticyImportDataStruct is serialized from the import data into its own compressed section
+ * of the cached version file. Sections whose bytes hash the same as in the file already keep their packed bytes.
  */
 void UArticyImportData::BuildCachedVersion()
 {
-	CachedData.Settings = this->Settings;
-	CachedData.Project = this->Project;
-	CachedData.GlobalVariables = this->GlobalVariables;
-	CachedData.ObjectDefinitions = this->ObjectDefinitions;
-	CachedData.PackageDefs = this->PackageDefs;
-	CachedData.UserMethods = this->UserMethods;
-	CachedData.Hierarchy = this->Hierarchy;
-	CachedData.Languages = this->Languages;
-	CachedData.ScriptFragments = this->ScriptFragments;
-	CachedData.ImportedPackages = this->ImportedPackages;
-	CachedData.ParentChildrenCache = this->ParentChildrenCache;
+	const FString Filename = GetCachedVersionFilename();
+
+	TMap<FString, FCachedVersionSection> PreviousSections;
+	{
+		TArray<FCachedVersionSection> Sections;
+		if (ReadCachedVersionSections(Filename, Sections))
+		{
+			for (FCachedVersionSection& Section : Sections)
+				PreviousSections.Add(Section.Name, MoveTemp(Section));
+		}
+	}
+
+	TArray<FCachedVersionSection> Sections;
+	TArray<uint8> Unpacked;
+	int32 NumReused = 0;
+	for (TFieldIterator<FProperty> It(FArticyImportDataStruct::StaticStruct()); It; ++It)
+	{
+		FProperty* Property = FindFProperty<FProperty>(GetClass(), It->GetFName());
+		if (!ensure(Property && Property->SameType(*It)))
+			continue;
+
+		Unpacked.Reset();
+		FMemoryWriter Writer(Unpacked);
+		SerializeCachedVersionSection(Property, this, Writer);
+
+		FCachedVersionSection& Section = Sections.AddDefaulted_GetRef();
+		Section.Name = It->GetName();
+		Section.Hash = FCrc::MemCrc32(Unpacked.GetData(), Unpacked.Num());
+		Section.UnpackedSize = Unpacked.Num();
+
+		FCachedVersionSection* Previous = PreviousSections.Find(Section.Name);
+		if (Previous && Previous->Hash == Section.Hash && Previous->UnpackedSize == Section.UnpackedSize)
+		{
+			Section.Packed = MoveTemp(Previous->Packed);
+			++NumReused;
+			continue;
+		}
+
+		int32 PackedSize = FCompression::CompressMemoryBound(NAME_Zlib, Unpacked.Num());
+		Section.Packed.SetNumUninitialized(PackedSize);
+		if (!FCompression::CompressMemory(NAME_Zlib, Section.Packed.GetData(), PackedSize, Unpacked.GetData(), Unpacked.Num()))
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Could not compress the cached version of %s."), *Section.Name);
+			return;
+		}
+		Section.Packed.SetNum(PackedSize);
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	uint32 Magic = CachedVersionMagic;
+	uint32 Format = CachedVersionFormat;
+	Writer << Magic << Format << Sections;
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Filename))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not write the cached version of the import data to %s."), *Filename);
+		return;
+	}
+
+	UE_LOG(LogArticyEditor, Verbose, TEXT("Cached the import data in %s, %d bytes, %d of %d sections unchanged."), *Filename, Bytes.Num(), NumReused, Sections.Num());
 }
 
 /**
  * Resolves the cached version of the import data.
+ *
+ * All sections are decoded before any of them is applied, so the import data stays as it is if the file is broken.
+ *
+ * @return True if the import data was restored from the cached version file.
  */
-void UArticyImportData::ResolveCachedVersion()
+bool UArticyImportData::ResolveCachedVersion()
 {
 	ensure(HasCachedVersion());
 
-	this->Settings = CachedData.Settings;
-	this->Project = CachedData.Project;
-	this->GlobalVariables = CachedData.GlobalVariables;
-	this->ObjectDefinitions = CachedData.ObjectDefinitions;
-	this->PackageDefs = CachedData.PackageDefs;
-	this->UserMethods = CachedData.UserMethods;
-	this->Hierarchy = CachedData.Hierarchy;
-	this->Languages = CachedData.Languages;
-	this->ScriptFragments = CachedData.ScriptFragments;
-	this->ImportedPackages = CachedData.ImportedPackages;
-	this->ParentChildrenCache = CachedData.ParentChildrenCache;
-	this->CachedData = FArticyImportDataStruct();
+	TArray<FCachedVersionSection> Sections;
+	if (!ReadCachedVersionSections(GetCachedVersionFilename(), Sections))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not read the cached version of the import data from %s."), *GetCachedVersionFilename());
+		return false;
+	}
+
+	FArticyImportDataStruct CachedData;
+	TArray<uint8> Unpacked;
+	for (const FCachedVersionSection& Section : Sections)
+	{
+		FProperty* Property = FindFProperty<FProperty>(FArticyImportDataStruct::StaticStruct(), *Section.Name);
+		if (!Property)
+			continue;
+
+		Unpacked.SetNumUninitialized(Section.UnpackedSize);
+		if (!FCompression::UncompressMemory(NAME_Zlib, Unpacked.GetData(), Unpacked.Num(), Section.Packed.GetData(), Section.Packed.Num()))
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("The cached version of %s is broken."), *Section.Name);
+			return false;
+		}
+
+		FMemoryReader Reader(Unpacked);
+		SerializeCachedVersionSection(Property, &CachedData, Reader);
+		if (Reader.IsError())
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("The cached version of %s could not be read."), *Section.Name);
+			return false;
+		}
+	}
+
+	this->Settings = MoveTemp(CachedData.Settings);
+	this->Project = MoveTemp(CachedData.Project);
+	this->GlobalVariables = MoveTemp(CachedData.GlobalVariables);
+	this->ObjectDefinitions = MoveTemp(CachedData.ObjectDefinitions);
+	this->PackageDefs = MoveTemp(CachedData.PackageDefs);
+	this->UserMethods = MoveTemp(CachedData.UserMethods);
+	this->Hierarchy = MoveTemp(CachedData.Hierarchy);
+	this->Languages = MoveTemp(CachedData.Languages);
+	this->ScriptFragments = MoveTemp(CachedData.ScriptFragments);
+	this->ImportedPackages = MoveTemp(CachedData.ImportedPackages);
+	this->ParentChildrenCache = MoveTemp(CachedData.ParentChildrenCache);
 	this->bHasCachedVersion = false;
+	IFileManager::Get().Delete(*GetCachedVersionFilename());
+	return true;
 }
 
 #undef LOCTEXT_NAMESPACE
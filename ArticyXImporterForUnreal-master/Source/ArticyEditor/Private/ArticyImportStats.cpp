@@ -0,0 +1,183 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyImportStats.h"
+#include "ArticyEditorModule.h"
+#include "HAL/PlatformTime.h"
+
+#if ARTICY_IMPORT_TRACE
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(ArticyImportChannel);
+
+TRACE_DECLARE_INT_COUNTER(ArticyImportObjectsParsed, TEXT("ArticyImport/ObjectsParsed"));
+TRACE_DECLARE_MEMORY_COUNTER(ArticyImportBytesRead, TEXT("ArticyImport/BytesRead"));
+TRACE_DECLARE_INT_COUNTER(ArticyImportFilesUnchanged, TEXT("ArticyImport/FilesUnchanged"));
+TRACE_DECLARE_INT_COUNTER(ArticyImportFragmentsGathered, TEXT("ArticyImport/FragmentsGathered"));
+TRACE_DECLARE_INT_COUNTER(ArticyImportFragmentsFolded, TEXT("ArticyImport/FragmentsFolded"));
+TRACE_DECLARE_INT_COUNTER(ArticyImportAssetsSaved, TEXT("ArticyImport/AssetsSaved"));
+#endif
+
+/**
+ * Gets the stats of the running import.
+ *
+ * @return The import stats.
+ */
+FArticyImportStats& FArticyImportStats::Get()
+{
+	static FArticyImportStats Stats;
+	return Stats;
+}
+
+/**
+ * Clears all stages and counters.
+ */
+void FArticyImportStats::Reset()
+{
+	check(IsInGameThread());
+
+	Stages.Reset();
+	PendingStages.Reset();
+	ImportStartTime = FPlatformTime::Seconds();
+	for (std::atomic<int64>& Counter : Counters)
+		Counter.store(0, std::memory_order_relaxed);
+
+	TraceCounters();
+}
+
+/**
+ * Adds to a counter.
+ *
+ * @param Counter The counter to add to.
+ * @param Delta The amount to add.
+ */
+void FArticyImportStats::Add(ECounter Counter, int64 Delta)
+{
+	Counters[(int32)Counter].fetch_add(Delta, std::memory_order_relaxed);
+}
+
+/**
+ * Adds time to a stage.
+ *
+ * @param Stage The name of the stage.
+ * @param Seconds The time spent in the stage.
+ */
+void FArticyImportStats::AddStage(const TCHAR* Stage, double Seconds)
+{
+	check(IsInGameThread());
+
+	FStage* Found = Stages.FindByPredicate([Stage](const FStage& Existing) { return Existing.Name == Stage; });
+	if (!Found)
+	{
+		Found = &Stages.AddDefaulted_GetRef();
+		Found->Name = Stage;
+	}
+
+	Found->Seconds += Seconds;
+	++Found->Count;
+
+	TraceCounters();
+}
+
+/**
+ * Starts timing a stage that ends in another call stack.
+ *
+ * @param Stage The name of the stage.
+ */
+void FArticyImportStats::BeginStage(const TCHAR* Stage)
+{
+	PendingStages.Add(Stage, FPlatformTime::Seconds());
+#if ARTICY_IMPORT_TRACE
+	TRACE_BOOKMARK(TEXT("ArticyImport: %s started"), Stage);
+#endif
+}
+
+/**
+ * Ends a stage started with BeginStage.
+ *
+ * @param Stage The name of the stage.
+ */
+void FArticyImportStats::EndStage(const TCHAR* Stage)
+{
+	double StartTime;
+	if (PendingStages.RemoveAndCopyValue(Stage, StartTime))
+	{
+		AddStage(Stage, FPlatformTime::Seconds() - StartTime);
+#if ARTICY_IMPORT_TRACE
+		TRACE_BOOKMARK(TEXT("ArticyImport: %s finished"), Stage);
+#endif
+	}
+}
+
+/**
+ * Logs the stage timings and counters of the import.
+ */
+void FArticyImportStats::LogSummary() const
+{
+	UE_LOG(LogArticyEditor, Log, TEXT("Articy import finished after %.3fs:"), FPlatformTime::Seconds() - ImportStartTime);
+	for (const FStage& Stage : Stages)
+	{
+		UE_LOG(LogArticyEditor, Log, TEXT("    %-24s %8.3fs x%d"), *Stage.Name, Stage.Seconds, Stage.Count);
+	}
+
+	for (int32 Index = 0; Index < (int32)ECounter::Num; ++Index)
+	{
+		UE_LOG(LogArticyEditor, Log, TEXT("    %-24s %lld"), GetCounterName((ECounter)Index),
+			Counters[Index].load(std::memory_order_relaxed));
+	}
+}
+
+/**
+ * Publishes the counters to the trace.
+ */
+void FArticyImportStats::TraceCounters() const
+{
+#if ARTICY_IMPORT_TRACE
+	TRACE_COUNTER_SET(ArticyImportObjectsParsed, Counters[(int32)ECounter::ObjectsParsed].load(std::memory_order_relaxed));
+	TRACE_COUNTER_SET(ArticyImportBytesRead, Counters[(int32)ECounter::BytesRead].load(std::memory_order_relaxed));
+	TRACE_COUNTER_SET(ArticyImportFilesUnchanged, Counters[(int32)ECounter::FilesUnchanged].load(std::memory_order_relaxed));
+	TRACE_COUNTER_SET(ArticyImportFragmentsGathered, Counters[(int32)ECounter::FragmentsGathered].load(std::memory_order_relaxed));
+	TRACE_COUNTER_SET(ArticyImportFragmentsFolded, Counters[(int32)ECounter::FragmentsFolded].load(std::memory_order_relaxed));
+	TRACE_COUNTER_SET(ArticyImportAssetsSaved, Counters[(int32)ECounter::AssetsSaved].load(std::memory_order_relaxed));
+#endif
+}
+
+/**
+ * Gets the display name of a counter.
+ *
+ * @param Counter The counter.
+ * @return The name used in the summary.
+ */
+const TCHAR* FArticyImportStats::GetCounterName(ECounter Counter)
+{
+	switch (Counter)
+	{
+	case ECounter::ObjectsParsed:
+		return TEXT("Objects parsed");
+	case ECounter::BytesRead:
+		return TEXT("Bytes read");
+	case ECounter::FilesUnchanged:
+		return TEXT("Files unchanged");
+	case ECounter::FragmentsGathered:
+		return TEXT("Fragments gathered");
+	case ECounter::FragmentsFolded:
+		return TEXT("Fragments folded");
+	case ECounter::AssetsSaved:
+		return TEXT("Assets saved");
+	default:
+		return TEXT("");
+	}
+}
+
+FArticyImportStats::FStageScope::FStageScope(const TCHAR* InStage)
+	: Stage(InStage)
+	, StartTime(FPlatformTime::Seconds())
+{
+}
+
+FArticyImportStats::FStageScope::~FStageScope()
+{
+	Get().AddStage(Stage, FPlatformTime::Seconds() - StartTime);
+}
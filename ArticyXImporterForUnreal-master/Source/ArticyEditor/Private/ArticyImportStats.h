@@ -0,0 +1,134 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Trace channels and counters are only available from 4.26 on
+#define ARTICY_IMPORT_TRACE (ENGINE_MAJOR_VERSION >= 5 || ENGINE_MINOR_VERSION >= 26)
+
+#if ARTICY_IMPORT_TRACE
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+UE_TRACE_CHANNEL_EXTERN(ArticyImportChannel);
+
+#define ARTICY_IMPORT_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ArticyImport_##Name, ArticyImportChannel)
+#else
+#define ARTICY_IMPORT_TRACE_SCOPE(Name)
+#endif
+
+/**
+ * Times a stage of the import, both in Unreal Insights (ArticyImport channel) and in the import summary.
+ * Stages must be entered on the game thread.
+ */
+#define ARTICY_IMPORT_STAGE(Name) \
+	ARTICY_IMPORT_TRACE_SCOPE(Name) \
+	FArticyImportStats::FStageScope PREPROCESSOR_JOIN(ArticyImportStage, __LINE__)(TEXT(#Name))
+
+/**
+ * @struct FArticyImportStats
+ * @brief Stage timings and counters of the running import, logged as a summary once it finished.
+ *
+ * An import spans code generation, an asynchronous compile and asset generation,
+ * so the stats of the one import that can run at a time are kept globally.
+ */
+struct FArticyImportStats
+{
+	enum class ECounter : uint8
+	{
+		ObjectsParsed,
+		BytesRead,
+		FilesUnchanged,
+		FragmentsGathered,
+		FragmentsFolded,
+		AssetsSaved,
+		Num
+	};
+
+	/**
+	 * @brief Gets the stats of the running import.
+	 */
+	static FArticyImportStats& Get();
+
+	/**
+	 * @brief Clears all stages and counters, called when an import starts.
+	 */
+	void Reset();
+
+	/**
+	 * @brief Adds to a counter, safe to call from any thread.
+	 *
+	 * @param Counter The counter to add to.
+	 * @param Delta The amount to add.
+	 */
+	void Add(ECounter Counter, int64 Delta);
+
+	/**
+	 * @brief Adds time to a stage, entering it for the first time appends it to the summary.
+	 *
+	 * @param Stage The name of the stage.
+	 * @param Seconds The time spent in the stage.
+	 */
+	void AddStage(const TCHAR* Stage, double Seconds);
+
+	/**
+	 * @brief Starts timing a stage that ends in another call stack, like the asynchronous compile.
+	 *
+	 * @param Stage The name of the stage.
+	 */
+	void BeginStage(const TCHAR* Stage);
+
+	/**
+	 * @brief Ends a stage started with BeginStage, does nothing if it was not started.
+	 *
+	 * @param Stage The name of the stage.
+	 */
+	void EndStage(const TCHAR* Stage);
+
+	/**
+	 * @brief Logs the stage timings and counters of the import.
+	 */
+	void LogSummary() const;
+
+	/**
+	 * @class FStageScope
+	 * @brief Adds the time of its scope to a stage, see ARTICY_IMPORT_STAGE.
+	 */
+	class FStageScope
+	{
+	public:
+		explicit FStageScope(const TCHAR* InStage);
+		~FStageScope();
+
+	private:
+		const TCHAR* Stage;
+		double StartTime;
+	};
+
+private:
+	struct FStage
+	{
+		FString Name;
+		double Seconds = 0.0;
+		int32 Count = 0;
+	};
+
+	/** Publish the counters to the trace, only done on the game thread at stage boundaries */
+	void TraceCounters() const;
+
+	static const TCHAR* GetCounterName(ECounter Counter);
+
+	/** Stages in the order they were first entered */
+	TArray<FStage> Stages;
+
+	/** Start times of the stages begun with BeginStage */
+	TMap<FString, double> PendingStages;
+
+	double ImportStartTime = 0.0;
+
+	std::atomic<int64> Counters[(int32)ECounter::Num] = {};
+};
@@ -6,18 +6,65 @@
 #include "CoreMinimal.h"
 #include "ArticyArchiveReader.h"
 #include "ArticyImportData.h"
+#include "ArticyImportStats.h"
 #include "Editor.h"
 #include "ArticyEditorModule.h"
 #include "ArticyImporterHelpers.h"
+#include "Async/Async.h"
 #include "Misc/FileHelper.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "Runtime/Launch/Resources/Version.h"
 #include "EditorFramework/AssetImportData.h"
 #include "Misc/ConfigCacheIni.h"
+#include "UObject/StrongObjectPtr.h"
 
 #define LOCTEXT_NAMESPACE "ArticyJSONFactory"
 
+/**
+ * Gets the export file an asset was imported from.
+ *
+ * @param Asset The Articy import data object.
+ * @return The file name, empty if the asset has no source file.
+ */
+static FString GetImportFilename(UArticyImportData* Asset)
+{
+    if (!Asset->ImportData)
+        return FString();
+
+    // Don't look for old .articyue4 files
+    if (Asset->ImportData->SourceData.SourceFiles.Num() > 0)
+        Asset->ImportData->SourceData.SourceFiles[0].RelativeFilename.RemoveFromEnd(TEXT("4"));
+
+    return Asset->ImportData->GetFirstFilename();
+}
+
+/**
+ * Reads and parses the manifest of an opened archive.
+ *
+ * @param Archive The archive to read from.
+ * @param FileName The name of the archive, for the error message.
+ * @param OutManifest The manifest, invalid if it could not be parsed.
+ * @return false if the archive has no manifest, true otherwise.
+ */
+static bool ReadManifest(const UArticyArchiveReader& Archive, const FString& FileName, TSharedPtr<FJsonObject>& OutManifest)
+{
+    // Load file as text file
+    FString JSON;
+    if (!Archive.ReadFile(TEXT("manifest.json"), JSON))
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Failed to load file '%s' to string"), *FileName);
+        return false;
+    }
+
+    // Parse outermost JSON object
+    const TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(JSON);
+    if (!FJsonSerializer::Deserialize(JsonReader, OutManifest))
+        OutManifest.Reset();
+
+    return true;
+}
+
 /**
  * Constructor for UArticyJSONFactory.
  * Initializes the factory to import Articy JSON files.
@@ -170,14 +217,7 @@ EReimportResult::Type UArticyJSONFactory::Reimport(UObject* Obj)
     auto Asset = Cast<UArticyImportData>(Obj);
     if (Asset)
     {
-        if (!Asset->ImportData)
-            return EReimportResult::Failed;
-
-        // Don't look for old .articyue4 files
-        if (Asset->ImportData->SourceData.SourceFiles.Num() > 0)
-            Asset->ImportData->SourceData.SourceFiles[0].RelativeFilename.RemoveFromEnd(TEXT("4"));
-
-        const FString ImportFilename = Asset->ImportData->GetFirstFilename();
+        const FString ImportFilename = GetImportFilename(Asset);
 
         if (ImportFilename.Len() == 0)
             return EReimportResult::Failed;
@@ -198,28 +238,105 @@ EReimportResult::Type UArticyJSONFactory::Reimport(UObject* Obj)
  */
 bool UArticyJSONFactory::ImportFromFile(const FString& FileName, UArticyImportData* Asset) const
 {
-    UArticyArchiveReader* Archive = NewObject<UArticyArchiveReader>();
-    Archive->OpenArchive(*FileName);
+    FArticyImportStats::Get().Reset();
 
-    // Load file as text file
-    FString JSON;
-    if (!Archive->ReadFile(TEXT("manifest.json"), JSON))
+    UArticyArchiveReader* Archive = NewObject<UArticyArchiveReader>();
     {
-        UE_LOG(LogArticyEditor, Error, TEXT("Failed to load file '%s' to string"), *FileName);
-        return false;
+        ARTICY_IMPORT_STAGE(OpenArchive);
+        Archive->OpenArchive(*FileName);
     }
 
-    // Parse outermost JSON object
     TSharedPtr<FJsonObject> JsonParsed;
-    const TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(JSON);
-    if (FJsonSerializer::Deserialize(JsonReader, JsonParsed))
+    if (!ReadManifest(*Archive, FileName, JsonParsed))
+        return false;
+
+    if (JsonParsed.IsValid())
     {
+        // Decode compressed files up front in parallel, the import reads them one at a time and skips the unchanged ones
+        {
+            ARTICY_IMPORT_STAGE(PrefetchFiles);
+            TSet<FString> ImportedFileHashes;
+            Asset->GatherImportedFileHashes(ImportedFileHashes);
+            Archive->PrefetchFiles(JsonParsed, ImportedFileHashes);
+        }
         Asset->ImportFromJson(*Archive, JsonParsed);
+        Archive->ReleasePrefetchedFiles();
     }
 
     return true;
 }
 
+/**
+ * Reimports the changes of an asset's export without blocking the editor.
+ *
+ * @param Asset The Articy import data object to reimport.
+ * @param OnFinished Called on the game thread with the result of the reimport.
+ */
+void UArticyJSONFactory::ReimportInBackground(UArticyImportData* Asset, TFunction<void(EReimportResult::Type)> OnFinished)
+{
+    const FString FileName = Asset ? GetImportFilename(Asset) : FString();
+    if (FileName.Len() == 0)
+    {
+        OnFinished(EReimportResult::Failed);
+        return;
+    }
+
+    // The hashes are taken now, the import compares them again when it applies the changes
+    TSet<FString> ImportedFileHashes;
+    Asset->GatherImportedFileHashes(ImportedFileHashes);
+    const FString ImportedManifestHash = Asset->GetSettings().ManifestHash;
+
+    // Readers must be created on the game thread, the strong pointer keeps this one alive while a worker uses it
+    TStrongObjectPtr<UArticyArchiveReader> Archive(NewObject<UArticyArchiveReader>());
+    TWeakObjectPtr<UArticyImportData> WeakAsset(Asset);
+
+    Async(EAsyncExecution::ThreadPool, [WeakAsset, FileName, Archive = MoveTemp(Archive), ImportedFileHashes = MoveTemp(ImportedFileHashes),
+        ImportedManifestHash, OnFinished = MoveTemp(OnFinished)]() mutable
+    {
+        const double StartTime = FPlatformTime::Seconds();
+
+        // The hash diff, decoding and parsing only read the archive
+        TSharedPtr<FJsonObject> Manifest;
+        bool bChanged = false;
+        if (Archive->OpenArchive(FileName) && ReadManifest(*Archive, FileName, Manifest) && Manifest.IsValid())
+        {
+            FString ManifestHash;
+            Archive->HashFile(TEXT("manifest.json"), ManifestHash);
+            bChanged = Archive->ParseFiles(Manifest, ImportedFileHashes) > 0 || !ManifestHash.Equals(ImportedManifestHash);
+        }
+
+        const double PrepareSeconds = FPlatformTime::Seconds() - StartTime;
+
+        AsyncTask(ENamedThreads::GameThread, [WeakAsset, Archive = MoveTemp(Archive), Manifest = MoveTemp(Manifest), bChanged, PrepareSeconds,
+            OnFinished = MoveTemp(OnFinished)]() mutable
+        {
+            EReimportResult::Type Result = EReimportResult::Succeeded;
+
+            UArticyImportData* Asset = WeakAsset.Get();
+            if (!Manifest.IsValid())
+            {
+                Result = EReimportResult::Failed;
+            }
+            else if (!Asset || ArticyImporterHelpers::IsPlayInEditor())
+            {
+                Result = EReimportResult::Cancelled;
+            }
+            else if (bChanged)
+            {
+                FArticyImportStats::Get().Reset();
+                FArticyImportStats::Get().AddStage(TEXT("PrepareInBackground"), PrepareSeconds);
+                Asset->ImportFromJson(*Archive, Manifest);
+            }
+
+            // Closing the archive right away releases the export file for articy:draft's next write
+            Archive->CloseArchive();
+            Archive.Reset();
+
+            OnFinished(Result);
+        });
+    });
+}
+
 /**
  * Handles the case where an import is attempted during play mode.
  *
@@ -0,0 +1,63 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyLineExportCommandlet.h"
+#include "ArticyLineExporter.h"
+#include "ArticyEditorModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "Misc/Paths.h"
+
+/**
+ * Main function executed by the commandlet.
+ *
+ * @param Params Command line parameters passed to the commandlet.
+ * @return 0 if the CSV was written, 1 otherwise.
+ */
+int32 UArticyLineExportCommandlet::Main(const FString& Params)
+{
+    const TCHAR* Cmd = *Params;
+
+    FString OutPath = FPaths::ProjectSavedDir() / TEXT("ArticyLines.csv");
+    FParse::Value(Cmd, TEXT("Out="), OutPath);
+
+    FString StartList;
+    FParse::Value(Cmd, TEXT("Start="), StartList, false);
+
+    const TWeakObjectPtr<UArticyDatabase> Database = UArticyDatabase::GetMutableOriginal();
+    if (!Database.IsValid())
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Line export: no articy database was imported."));
+        return 1;
+    }
+    Database->LoadAllPackages(FParse::Param(Cmd, TEXT("DefaultPackagesOnly")));
+
+    // Start objects are given by ID or technical name
+    TArray<FString> StartNames;
+    StartList.ParseIntoArray(StartNames, TEXT(","));
+    TArray<FArticyId> StartIds;
+    for (const FString& StartName : StartNames)
+    {
+        const UArticyObject* Object = StartName.StartsWith(TEXT("0x"))
+            ? Database->GetObject(FArticyId(FCString::Strtoui64(*StartName + 2, nullptr, 16)))
+            : Database->GetObjectByName(FName(*StartName));
+        if (!Object)
+        {
+            UE_LOG(LogArticyEditor, Error, TEXT("Line export: start object %s does not exist."), *StartName);
+            return 1;
+        }
+        StartIds.Add(Object->GetId());
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    FArticyLineExporter Exporter;
+    Exporter.Bake(Database.Get());
+    const bool bSuccess = Exporter.ExportCsv(OutPath, StartIds);
+
+    UE_LOG(LogArticyEditor, Display, TEXT("Line export: %d lines and hubs from %d nodes and pins in %.2f s."),
+        Exporter.GetNumRows(), Exporter.GetNumVertices(), FPlatformTime::Seconds() - StartTime);
+
+    return bSuccess ? 0 : 1;
+}
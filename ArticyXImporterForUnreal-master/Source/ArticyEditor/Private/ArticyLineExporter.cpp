@@ -0,0 +1,369 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyLineExporter.h"
+#include "ArticyEditorModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyPins.h"
+#include "ArticyBuiltinTypes.h"
+#include "Interfaces/ArticyInputPinsProvider.h"
+#include "Interfaces/ArticyOutputPinsProvider.h"
+#include "Interfaces/ArticyObjectWithDisplayName.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithStageDirections.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	/** Quotes a CSV field, doubling the quotes in it. */
+	void AppendCsvField(FString& Line, const FString& Field)
+	{
+		Line += TEXT("\"");
+		Line += Field.Replace(TEXT("\""), TEXT("\"\""));
+		Line += TEXT("\"");
+	}
+
+	FString ArticyIdToString(const FArticyId& Id)
+	{
+		return FString::Printf(TEXT("0x%016llX"), Id.Get());
+	}
+
+	FString GetSpeakerName(const UArticyObject* Speaker)
+	{
+		if (!Speaker)
+			return FString();
+
+		if (const IArticyObjectWithDisplayName* WithDisplayName = Cast<IArticyObjectWithDisplayName>(Speaker))
+		{
+			const FString DisplayName = WithDisplayName->GetDisplayName().ToString();
+			if (!DisplayName.IsEmpty())
+				return DisplayName;
+		}
+		return Speaker->GetTechnicalName().ToString();
+	}
+}
+
+/**
+ * @brief Bakes the flow of all objects the database has loaded.
+ *
+ * Nodes and their pins become vertices, the flow's rules become successor lists: a node continues at its
+ * output pins, a jump at its target pin, an input pin submerges into its connections or continues at its
+ * node, and an output pin follows its connections.
+ *
+ * @param Database The database whose loaded packages are exported.
+ */
+void FArticyLineExporter::Bake(const UArticyDatabase* Database)
+{
+	check(IsInGameThread());
+
+	Vertices.Reset();
+	Successors.Reset();
+	Rows.Reset();
+	NodeVertices.Reset();
+	SubmergeVertices.Reset();
+
+	if (!Database)
+		return;
+
+	TArray<UArticyObject*> Nodes;
+	TMap<const UObject*, int32> VertexOf;
+	TArray<const UObject*> VertexObjects;
+	TArray<int32> PinOwners;
+
+	for (UArticyObject* Object : Database->GetAllObjects())
+	{
+		IArticyFlowObject* FlowObject = Cast<IArticyFlowObject>(Object);
+		if (!FlowObject || VertexOf.Contains(Object))
+			continue;
+
+		const int32 NodeVertex = VertexObjects.Add(Object);
+		PinOwners.Add(INDEX_NONE);
+		VertexOf.Add(Object, NodeVertex);
+		NodeVertices.Add(Object->GetId(), NodeVertex);
+		Nodes.Add(Object);
+
+		auto AddPins = [&](const auto* Pins)
+		{
+			if (!Pins)
+				return;
+
+			for (const UArticyFlowPin* Pin : *Pins)
+			{
+				if (Pin && !VertexOf.Contains(Pin))
+				{
+					VertexOf.Add(Pin, VertexObjects.Add(Pin));
+					PinOwners.Add(NodeVertex);
+				}
+			}
+		};
+		if (const IArticyInputPinsProvider* InputPins = Cast<IArticyInputPinsProvider>(Object))
+			AddPins(InputPins->GetInputPinsPtr());
+		if (const IArticyOutputPinsProvider* OutputPins = Cast<IArticyOutputPinsProvider>(Object))
+			AddPins(OutputPins->GetOutputPinsPtr());
+
+		const EArticyPausableType Type = FlowObject->GetType();
+		if (Type == EArticyPausableType::DialogueFragment || Type == EArticyPausableType::Hub)
+		{
+			FRow& Row = Rows.AddDefaulted_GetRef();
+			Row.Vertex = NodeVertex;
+			Row.Id = Object->GetId();
+			Row.TechnicalName = Object->GetTechnicalName().ToString();
+			Row.Type = Type == EArticyPausableType::Hub ? TEXT("Hub") : TEXT("DialogueFragment");
+
+			if (const IArticyObjectWithSpeaker* WithSpeaker = Cast<IArticyObjectWithSpeaker>(Object))
+				Row.Speaker = GetSpeakerName(WithSpeaker->GetSpeaker());
+			if (const IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Object))
+				Row.Text = WithText->GetText().ToString();
+			if (const IArticyObjectWithStageDirections* WithStageDirections = Cast<IArticyObjectWithStageDirections>(Object))
+				Row.StageDirections = WithStageDirections->GetStageDirections().ToString();
+		}
+	}
+
+	Vertices.SetNum(VertexObjects.Num());
+	for (int32 RowIndex = 0; RowIndex < Rows.Num(); ++RowIndex)
+		Vertices[Rows[RowIndex].Vertex].Row = RowIndex;
+
+	auto AddSuccessor = [&](const UObject* Target)
+	{
+		if (const int32* TargetVertex = Target ? VertexOf.Find(Target) : nullptr)
+			Successors.Add(*TargetVertex);
+	};
+
+	for (int32 VertexIndex = 0; VertexIndex < VertexObjects.Num(); ++VertexIndex)
+	{
+		const UObject* Object = VertexObjects[VertexIndex];
+		FVertex& Vertex = Vertices[VertexIndex];
+		Vertex.FirstSuccessor = Successors.Num();
+
+		if (const UArticyFlowPin* Pin = Cast<UArticyFlowPin>(Object))
+		{
+			for (const FArticyPinConnection& Connection : Pin->OutgoingConnections)
+				AddSuccessor(Connection.GetTargetPin(Database));
+
+			// An input pin without connections continues at its node
+			if (Pin->IsA<UArticyInputPin>() && Pin->OutgoingConnections.Num() == 0)
+				Successors.Add(PinOwners[VertexIndex]);
+		}
+		else if (const UArticyJump* Jump = Cast<UArticyJump>(Object))
+		{
+			AddSuccessor(Jump->GetTargetPin());
+		}
+		else if (const IArticyOutputPinsProvider* OutputPins = Cast<IArticyOutputPinsProvider>(Object))
+		{
+			if (const TArray<UArticyOutputPin*>* Pins = OutputPins->GetOutputPinsPtr())
+			{
+				for (const UArticyOutputPin* OutputPin : *Pins)
+					AddSuccessor(OutputPin);
+			}
+		}
+
+		Vertex.NumSuccessors = Successors.Num() - Vertex.FirstSuccessor;
+	}
+
+	// Starting at a node with connected input pins submerges into them instead of leaving the node
+	for (const UArticyObject* Node : Nodes)
+	{
+		const IArticyInputPinsProvider* InputPins = Cast<IArticyInputPinsProvider>(Node);
+		const TArray<UArticyInputPin*>* Pins = InputPins ? InputPins->GetInputPinsPtr() : nullptr;
+		if (!Pins)
+			continue;
+
+		TArray<int32> Submerge;
+		for (const UArticyInputPin* Pin : *Pins)
+		{
+			if (Pin && Pin->OutgoingConnections.Num() > 0)
+				Submerge.Add(VertexOf[Pin]);
+		}
+		if (Submerge.Num() > 0)
+			SubmergeVertices.Add(Node->GetId(), MoveTemp(Submerge));
+	}
+
+	UE_LOG(LogArticyEditor, Log, TEXT("Line export: baked %d nodes and pins, %d lines and hubs."), Vertices.Num(), Rows.Num());
+}
+
+/**
+ * @brief Collects the rows reached first from a vertex, walking through all vertices that are no row.
+ *
+ * Only touches the baked arrays, so the rows of many vertices can be collected in parallel.
+ *
+ * @param Vertex The vertex to start at, it is not collected itself.
+ * @param OutRows Receives the rows in the order they are reached.
+ */
+void FArticyLineExporter::CollectNextRows(int32 Vertex, TArray<int32>& OutRows) const
+{
+	TSet<int32> Visited;
+	TArray<int32> Stack;
+
+	auto PushSuccessors = [&](int32 From)
+	{
+		const FVertex& FromVertex = Vertices[From];
+
+		// Reversed, so the first successor is walked first
+		for (int32 Index = FromVertex.NumSuccessors - 1; Index >= 0; --Index)
+			Stack.Push(Successors[FromVertex.FirstSuccessor + Index]);
+	};
+
+	// The vertex is not marked visited, a loop back to it lists it as its own next row
+	PushSuccessors(Vertex);
+	while (Stack.Num() > 0)
+	{
+		const int32 Current = Stack.Pop(false);
+		bool bAlreadyVisited = false;
+		Visited.Add(Current, &bAlreadyVisited);
+		if (bAlreadyVisited)
+			continue;
+
+		if (Vertices[Current].Row != INDEX_NONE)
+			OutRows.Add(Vertices[Current].Row);
+		else
+			PushSuccessors(Current);
+	}
+}
+
+/**
+ * @brief Writes the rows to a CSV file in play order, streaming them through a small buffer.
+ *
+ * @param Filename The CSV file to write.
+ * @param StartIds Objects play starts at, the rows no other row leads to if empty.
+ * @return False if the file could not be written.
+ */
+bool FArticyLineExporter::ExportCsv(const FString& Filename, TConstArrayView<FArticyId> StartIds)
+{
+	// Every row's walk ends at the next rows, so the walks are independent and together visit the graph about once
+	ParallelFor(Rows.Num(), [this](int32 RowIndex)
+	{
+		FRow& Row = Rows[RowIndex];
+		Row.Next.Reset();
+		CollectNextRows(Row.Vertex, Row.Next);
+	});
+
+	TArray<int32> Roots;
+	if (StartIds.Num() > 0)
+	{
+		for (const FArticyId& StartId : StartIds)
+		{
+			const int32* StartVertex = NodeVertices.Find(StartId);
+			if (!StartVertex)
+			{
+				UE_LOG(LogArticyEditor, Warning, TEXT("Line export: start object %s is not loaded."), *ArticyIdToString(StartId));
+				continue;
+			}
+
+			if (Vertices[*StartVertex].Row != INDEX_NONE)
+			{
+				Roots.Add(Vertices[*StartVertex].Row);
+			}
+			else if (const TArray<int32>* Submerge = SubmergeVertices.Find(StartId))
+			{
+				for (int32 PinVertex : *Submerge)
+					CollectNextRows(PinVertex, Roots);
+			}
+			else
+			{
+				CollectNextRows(*StartVertex, Roots);
+			}
+		}
+	}
+	else
+	{
+		TBitArray<> HasPredecessor(false, Rows.Num());
+		for (const FRow& Row : Rows)
+		{
+			for (int32 Next : Row.Next)
+				HasPredecessor[Next] = true;
+		}
+		for (int32 RowIndex = 0; RowIndex < Rows.Num(); ++RowIndex)
+		{
+			if (!HasPredecessor[RowIndex])
+				Roots.Add(RowIndex);
+		}
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Line export: failed to write %s."), *Filename);
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	auto WriteLine = [&Writer, &Buffer](const FString& Line)
+	{
+		const FTCHARToUTF8 Utf8(*Line, Line.Len());
+		Buffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+		if (Buffer.Num() >= 64 * 1024)
+		{
+			Writer->Serialize(Buffer.GetData(), Buffer.Num());
+			Buffer.Reset();
+		}
+	};
+	WriteLine(TEXT("Order,Id,TechnicalName,Type,Speaker,Text,StageDirections,Next\n"));
+
+	// Play order: depth first from the roots, each row written when first reached
+	TBitArray<> Written(false, Rows.Num());
+	TArray<int32> Stack;
+	int32 Order = 0;
+	auto Visit = [&](int32 Root)
+	{
+		Stack.Push(Root);
+		while (Stack.Num() > 0)
+		{
+			const int32 RowIndex = Stack.Pop(false);
+			if (Written[RowIndex])
+				continue;
+			Written[RowIndex] = true;
+
+			const FRow& Row = Rows[RowIndex];
+			FString Next;
+			for (int32 NextRow : Row.Next)
+			{
+				if (!Next.IsEmpty())
+					Next += TEXT(" ");
+				Next += ArticyIdToString(Rows[NextRow].Id);
+			}
+
+			FString Line = FString::Printf(TEXT("%d,\"%s\","), Order++, *ArticyIdToString(Row.Id));
+			AppendCsvField(Line, Row.TechnicalName);
+			Line += TEXT(",");
+			AppendCsvField(Line, Row.Type);
+			Line += TEXT(",");
+			AppendCsvField(Line, Row.Speaker);
+			Line += TEXT(",");
+			AppendCsvField(Line, Row.Text);
+			Line += TEXT(",");
+			AppendCsvField(Line, Row.StageDirections);
+			Line += TEXT(",");
+			AppendCsvField(Line, Next);
+			Line += TEXT("\n");
+			WriteLine(Line);
+
+			for (int32 Index = Row.Next.Num() - 1; Index >= 0; --Index)
+				Stack.Push(Row.Next[Index]);
+		}
+	};
+
+	for (int32 Root : Roots)
+		Visit(Root);
+
+	// Rows only reachable from loops without a first row come last, unless play was restricted to start objects
+	if (StartIds.Num() == 0)
+	{
+		for (int32 RowIndex = 0; RowIndex < Rows.Num(); ++RowIndex)
+			Visit(RowIndex);
+	}
+
+	if (Buffer.Num() > 0)
+		Writer->Serialize(Buffer.GetData(), Buffer.Num());
+
+	const bool bSuccess = Writer->Close() && !Writer->IsError();
+	if (!bSuccess)
+		UE_LOG(LogArticyEditor, Error, TEXT("Line export: failed to write %s."), *Filename);
+
+	UE_LOG(LogArticyEditor, Log, TEXT("Line export: wrote %d of %d lines and hubs to %s."), Order, Rows.Num(), *Filename);
+	return bSuccess;
+}
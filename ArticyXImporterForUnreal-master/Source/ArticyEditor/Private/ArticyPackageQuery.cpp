@@ -0,0 +1,287 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPackageQuery.h"
+#include "ArticyEditorModule.h"
+#include "ArticyObject.h"
+#include "ArticyPackage.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+
+/**
+ * @brief Binds to the asset registry events to parse the tags again after articy packages changed.
+ */
+FArticyPackageQuery::FArticyPackageQuery()
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	AddedHandle = AssetRegistry.OnAssetAdded().AddRaw(this, &FArticyPackageQuery::OnAssetChanged);
+	RemovedHandle = AssetRegistry.OnAssetRemoved().AddRaw(this, &FArticyPackageQuery::OnAssetChanged);
+	UpdatedHandle = AssetRegistry.OnAssetUpdated().AddRaw(this, &FArticyPackageQuery::OnAssetChanged);
+	RenamedHandle = AssetRegistry.OnAssetRenamed().AddRaw(this, &FArticyPackageQuery::OnAssetRenamed);
+}
+
+/**
+ * @brief Unbinds from the asset registry events, if the asset registry is still loaded.
+ */
+FArticyPackageQuery::~FArticyPackageQuery()
+{
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>("AssetRegistry"))
+	{
+		IAssetRegistry& AssetRegistry = AssetRegistryModule->Get();
+		AssetRegistry.OnAssetAdded().Remove(AddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(RemovedHandle);
+		AssetRegistry.OnAssetUpdated().Remove(UpdatedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(RenamedHandle);
+	}
+}
+
+/**
+ * @brief Gets the query of the editor module.
+ */
+FArticyPackageQuery& FArticyPackageQuery::Get()
+{
+	return FArticyEditorModule::Get().GetPackageQuery();
+}
+
+/**
+ * @brief Finds the packages with objects spoken by a character.
+ *
+ * @param SpeakerId The ID of the speaking entity.
+ * @return The packages, in no particular order.
+ */
+TArray<FAssetData> FArticyPackageQuery::FindPackagesWithSpeaker(const FArticyId& SpeakerId)
+{
+	Update();
+
+	TArray<int32> Indices;
+	PackagesBySpeaker.MultiFind(SpeakerId, Indices);
+
+	TArray<FAssetData> Result;
+	Result.Reserve(Indices.Num());
+	for (const int32 Index : Indices)
+		Result.Add(Packages[Index]);
+	return Result;
+}
+
+/**
+ * @brief Finds the package containing an object.
+ *
+ * @param Id The ID of the object.
+ * @return The package, invalid if no package contains the object.
+ */
+FAssetData FArticyPackageQuery::FindPackageWithObject(const FArticyId& Id)
+{
+	Update();
+
+	const int32* Index = PackageByObject.Find(Id);
+	return Index ? Packages[*Index] : FAssetData();
+}
+
+/**
+ * @brief Finds the packages whose connections or jumps lead into a package.
+ *
+ * @param PackageName The name of the package the articy package asset is in.
+ * @return The referencing packages.
+ */
+TArray<FAssetData> FArticyPackageQuery::FindReferencingPackages(FName PackageName)
+{
+	Update();
+
+	TArray<FAssetData> Result;
+	const int32* Target = PackageByName.Find(PackageName);
+	if (!Target)
+		return Result;
+
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		bool bReferences = false;
+		ForEachId(Packages[Index], ArticyPackageTags::ExternalTargets, [this, Target, &bReferences](const FArticyId& Id)
+		{
+			const int32* TargetPackage = PackageByObject.Find(Id);
+			bReferences |= TargetPackage && *TargetPackage == *Target;
+		});
+
+		if (bReferences && Index != *Target)
+			Result.Add(Packages[Index]);
+	}
+	return Result;
+}
+
+/**
+ * @brief Finds the packages the connections and jumps of a package lead into.
+ *
+ * @param PackageName The name of the package the articy package asset is in.
+ * @return The referenced packages.
+ */
+TArray<FAssetData> FArticyPackageQuery::FindReferencedPackages(FName PackageName)
+{
+	Update();
+
+	TArray<FAssetData> Result;
+	const int32* Source = PackageByName.Find(PackageName);
+	if (!Source)
+		return Result;
+
+	TSet<int32> Referenced;
+	ForEachId(Packages[*Source], ArticyPackageTags::ExternalTargets, [this, &Referenced](const FArticyId& Id)
+	{
+		if (const int32* TargetPackage = PackageByObject.Find(Id))
+			Referenced.Add(*TargetPackage);
+	});
+	Referenced.Remove(*Source);
+
+	for (const int32 Index : Referenced)
+		Result.Add(Packages[Index]);
+	return Result;
+}
+
+/**
+ * @brief Gets the articy packages known to the asset registry.
+ */
+const TArray<FAssetData>& FArticyPackageQuery::GetPackages()
+{
+	Update();
+	return Packages;
+}
+
+/**
+ * @brief Gets the value of a numerical tag such as ArticyPackageTags::NumObjects.
+ *
+ * @param Package The articy package asset.
+ * @param Tag The name of the tag.
+ * @return The value, INDEX_NONE if the package was saved without the tag.
+ */
+int64 FArticyPackageQuery::GetCount(const FAssetData& Package, const TCHAR* Tag)
+{
+	int64 Value = INDEX_NONE;
+	Package.GetTagValue(FName(Tag), Value);
+	return Value;
+}
+
+/**
+ * @brief Gets the number of objects by class path of a package.
+ *
+ * @param Package The articy package asset.
+ * @param OutCounts Receives the counts by class path.
+ * @return False if the package was saved without the tag.
+ */
+bool FArticyPackageQuery::GetClassCounts(const FAssetData& Package, TMap<FString, int32>& OutCounts)
+{
+	OutCounts.Reset();
+
+	FString Value;
+	if (!Package.GetTagValue(FName(ArticyPackageTags::ObjectClasses), Value))
+		return false;
+
+	TArray<FString> Entries;
+	Value.ParseIntoArray(Entries, TEXT(" "));
+	for (const FString& Entry : Entries)
+	{
+		FString ClassPath, Count;
+		if (Entry.Split(TEXT("="), &ClassPath, &Count, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+			OutCounts.Add(ClassPath, FCString::Atoi(*Count));
+	}
+	return true;
+}
+
+/**
+ * @brief Checks whether a package may contain objects of a class, without loading it.
+ *
+ * Classes of the tag that are not loaded are assumed to match, they can't be checked without loading them.
+ *
+ * @param Package The articy package asset.
+ * @param Class The class to look for, any object matches if null.
+ * @param bExactClass Whether objects of subclasses do not match.
+ * @return False only if the tags of the package show it contains no such object.
+ */
+bool FArticyPackageQuery::MayContainClass(const FAssetData& Package, const UClass* Class, bool bExactClass)
+{
+	if (GetCount(Package, ArticyPackageTags::NumObjects) == 0)
+		return false;
+
+	TMap<FString, int32> Counts;
+	if (!Class || !GetClassCounts(Package, Counts))
+		return true;
+
+	for (const TPair<FString, int32>& Count : Counts)
+	{
+		const UClass* ObjectClass = FindObject<UClass>(nullptr, *Count.Key);
+		if (!ObjectClass || ObjectClass == Class || (!bExactClass && ObjectClass->IsChildOf(Class)))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Calls a function for every ID of a list tag such as ArticyPackageTags::Speakers.
+ *
+ * @param Package The articy package asset.
+ * @param Tag The name of the tag.
+ * @param Function The function to call.
+ */
+void FArticyPackageQuery::ForEachId(const FAssetData& Package, const TCHAR* Tag, TFunctionRef<void(const FArticyId&)> Function)
+{
+	FString Value;
+	if (!Package.GetTagValue(FName(Tag), Value))
+		return;
+
+	FStringView Remaining(Value);
+	while (!Remaining.IsEmpty())
+	{
+		int32 Separator = INDEX_NONE;
+		if (!Remaining.FindChar(TEXT(' '), Separator))
+			Separator = Remaining.Len();
+
+		const uint64 Id = ArticyHelpers::HexToUint64(Remaining.Left(Separator));
+		if (Id != 0)
+			Function(FArticyId(Id));
+		Remaining.RightChopInline(Separator + 1);
+	}
+}
+
+/**
+ * @brief Parses the tags of all packages, if they changed since the last query.
+ */
+void FArticyPackageQuery::Update()
+{
+	if (!bDirty)
+		return;
+	bDirty = false;
+
+	Packages.Reset();
+	PackageByObject.Reset();
+	PackagesBySpeaker.Reset();
+	PackageByName.Reset();
+
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), Packages);
+#else
+	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), Packages);
+#endif
+
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		PackageByName.Add(Packages[Index].PackageName, Index);
+
+		ForEachId(Packages[Index], ArticyPackageTags::ObjectIds, [this, Index](const FArticyId& Id)
+		{
+			PackageByObject.Add(Id, Index);
+		});
+		ForEachId(Packages[Index], ArticyPackageTags::Speakers, [this, Index](const FArticyId& Id)
+		{
+			PackagesBySpeaker.Add(Id, Index);
+		});
+	}
+}
+
+void FArticyPackageQuery::OnAssetChanged(const FAssetData& Asset)
+{
+	if (UArticyObject::IsPackageAsset(Asset))
+		bDirty = true;
+}
+
+void FArticyPackageQuery::OnAssetRenamed(const FAssetData& Asset, const FString& OldObjectPath)
+{
+	OnAssetChanged(Asset);
+}
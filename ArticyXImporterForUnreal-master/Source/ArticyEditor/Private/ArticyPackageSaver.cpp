@@ -0,0 +1,164 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPackageSaver.h"
+#include "ArticyEditorModule.h"
+#include "Async/Async.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "FileHelpers.h"
+#include "ISourceControlModule.h"
+#include "ISourceControlProvider.h"
+#include "Misc/PackageName.h"
+#include "UObject/GarbageCollection.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectHash.h"
+#if ENGINE_MAJOR_VERSION >= 5
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+/**
+ * @brief Decides whether the packages are saved as they are handed over or all by Finish.
+ */
+FArticyPackageSaver::FArticyPackageSaver()
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	// Checking out one package at a time would cost a source control round trip per package
+	bDeferSaves = ISourceControlModule::Get().GetProvider().IsEnabled();
+#else
+	// Concurrent saves need the save context of Unreal Engine 5
+	bDeferSaves = true;
+#endif
+}
+
+/**
+ * @brief Waits for the saves that are still running.
+ */
+FArticyPackageSaver::~FArticyPackageSaver()
+{
+	WaitForSaves(0);
+}
+
+/**
+ * @brief Starts saving a package, must be called on the game thread.
+ *
+ * @param Package The package to save, nothing may write to it until Finish returns.
+ */
+void FArticyPackageSaver::Save(UPackage* Package)
+{
+	if (!Package || StartedPackages.Contains(Package))
+		return;
+
+	StartedPackages.Add(Package);
+	Package->SetDirtyFlag(true);
+
+	if (bDeferSaves)
+		DeferredPackages.Add(Package);
+	else
+		StartSave(Package);
+}
+
+/**
+ * @brief Waits for all saves, the asset registry is told about the written files once.
+ *
+ * @return The number of packages saved since the last call.
+ */
+int32 FArticyPackageSaver::Finish()
+{
+	TArray<UPackage*> Packages = MoveTemp(DeferredPackages);
+	DeferredPackages.Reset();
+
+	// Check out all the packages left to save, if source control is enabled
+	ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
+	if (Packages.Num() > 0 && SourceControlProvider.IsEnabled())
+	{
+		TArray<UPackage*> CheckedOutPackages;
+		FEditorFileUtils::CheckoutPackages(Packages, &CheckedOutPackages, false);
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5
+	for (UPackage* Package : Packages)
+		StartSave(Package);
+	WaitForSaves(0);
+
+	TArray<FString> SavedFilenames;
+	for (FSave& Save : Saves)
+	{
+		if (Save.Result.Get())
+		{
+			Save.Package->SetDirtyFlag(false);
+			SavedFilenames.Add(Save.Filename);
+		}
+		else
+			UE_LOG(LogArticyEditor, Error, TEXT("Failed to save package %s."), *Save.Package->GetName());
+	}
+	Saves.Reset();
+
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+	AssetRegistryModule.Get().ScanModifiedAssetFiles(SavedFilenames);
+	return SavedFilenames.Num();
+#else
+	return UEditorLoadingAndSavingUtils::SavePackages(Packages, true) ? Packages.Num() : 0;
+#endif
+}
+
+/**
+ * @brief Runs PreSave and launches the save of a package on a worker.
+ *
+ * @param Package The package to save.
+ */
+void FArticyPackageSaver::StartSave(UPackage* Package)
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+	// Concurrent saves do not route PreSave, it may only be called on the game thread
+	FObjectSaveContextData SaveContext(Package, nullptr, *Filename, SAVE_Concurrent);
+	ForEachObjectWithPackage(Package, [&SaveContext](UObject* Object)
+	{
+		Object->PreSave(FObjectPreSaveContext(SaveContext));
+		return true;
+	});
+
+	WaitForSaves(MaxConcurrentSaves - 1);
+
+	FSave& Save = Saves.AddDefaulted_GetRef();
+	Save.Package = Package;
+	Save.Filename = Filename;
+	Save.Result = Async(EAsyncExecution::ThreadPool, [Package, Filename]()
+	{
+		// No garbage may be collected while the package is serialized
+		FGCScopeGuard GCGuard;
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.SaveFlags = SAVE_Concurrent | SAVE_NoError;
+		return UPackage::Save(Package, Package->FindAssetInPackage(), *Filename, SaveArgs).Result == ESavePackageResult::Success;
+	});
+#endif
+}
+
+/**
+ * @brief Waits for the oldest saves until no more than a number of them run.
+ *
+ * @param MaxRunning The number of saves that may keep running.
+ */
+void FArticyPackageSaver::WaitForSaves(int32 MaxRunning)
+{
+	int32 NumRunning = 0;
+	for (const FSave& Save : Saves)
+		NumRunning += Save.Result.IsReady() ? 0 : 1;
+
+	for (FSave& Save : Saves)
+	{
+		if (NumRunning <= MaxRunning)
+			break;
+
+		if (!Save.Result.IsReady())
+		{
+			Save.Result.Wait();
+			--NumRunning;
+		}
+	}
+}
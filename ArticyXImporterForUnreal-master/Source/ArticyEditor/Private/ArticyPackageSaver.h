@@ -0,0 +1,89 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class UPackage;
+
+/**
+ * @class FArticyPackageSaver
+ * @brief Saves generated packages on worker threads while the game thread goes on generating.
+ *
+ * A package is handed over once nothing later in the import writes to it, its save then overlaps the generation of
+ * the packages after it. At most MaxConcurrentSaves run at a time, so the serialized packages held in memory stay
+ * bounded however many packages an import has. With source control, and before Unreal Engine 5, all packages are
+ * saved by Finish, source control checks them out together.
+ */
+class FArticyPackageSaver
+{
+public:
+	FArticyPackageSaver();
+
+	/**
+	 * @brief Waits for the saves that are still running.
+	 */
+	~FArticyPackageSaver();
+
+	/**
+	 * @brief Starts saving a package, must be called on the game thread.
+	 *
+	 * PreSave runs right away, the save on a worker. Waits for a save to finish while MaxConcurrentSaves run.
+	 * Packages that were handed over before are ignored.
+	 *
+	 * @param Package The package to save, nothing may write to it until Finish returns.
+	 */
+	void Save(UPackage* Package);
+
+	/**
+	 * @brief Checks whether a package was handed over to Save.
+	 *
+	 * @param Package The package to check.
+	 * @return True if the package is saved or being saved.
+	 */
+	bool IsSaving(const UPackage* Package) const { return StartedPackages.Contains(Package); }
+
+	/**
+	 * @brief Waits for all saves, the asset registry is told about the written files once.
+	 *
+	 * @return The number of packages saved since the last call.
+	 */
+	int32 Finish();
+
+	/** Most packages saved at the same time, each save holds a serialized package in memory. */
+	static constexpr int32 MaxConcurrentSaves = 8;
+
+private:
+	struct FSave
+	{
+		UPackage* Package = nullptr;
+		FString Filename;
+		TFuture<bool> Result;
+	};
+
+	/**
+	 * @brief Runs PreSave and launches the save of a package on a worker.
+	 *
+	 * @param Package The package to save.
+	 */
+	void StartSave(UPackage* Package);
+
+	/**
+	 * @brief Waits for the oldest saves until no more than a number of them run.
+	 *
+	 * @param MaxRunning The number of saves that may keep running.
+	 */
+	void WaitForSaves(int32 MaxRunning);
+
+	TArray<FSave> Saves;
+
+	/** Packages saved by Finish, together with source control or before Unreal Engine 5. */
+	TArray<UPackage*> DeferredPackages;
+
+	TSet<const UPackage*> StartedPackages;
+
+	bool bDeferSaves = false;
+};
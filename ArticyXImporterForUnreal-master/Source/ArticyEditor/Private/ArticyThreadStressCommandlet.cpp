@@ -0,0 +1,154 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyThreadStressCommandlet.h"
+#include "ArticyEditorModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "ArticyTextExtension.h"
+#include "Interfaces/ArticyObjectWithMenuText.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/**
+ * Main function executed by the commandlet.
+ *
+ * @param Params Command line parameters passed to the commandlet.
+ * @return 0 if every prepared text matched its reference, 1 otherwise.
+ */
+int32 UArticyThreadStressCommandlet::Main(const FString& Params)
+{
+    const TCHAR* Cmd = *Params;
+
+    int32 MaxRequests = 32;
+    int32 Rounds = 4;
+    FString ReportPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("ArticyThreadStress-%s.json"), *FDateTime::Now().ToString());
+    FParse::Value(Cmd, TEXT("MaxRequests="), MaxRequests);
+    FParse::Value(Cmd, TEXT("Rounds="), Rounds);
+    FParse::Value(Cmd, TEXT("Report="), ReportPath);
+    MaxRequests = FMath::Max(MaxRequests, 1);
+    Rounds = FMath::Max(Rounds, 1);
+
+    const TWeakObjectPtr<UArticyDatabase> Database = UArticyDatabase::GetMutableOriginal();
+    if (!Database.IsValid())
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Thread stress: no articy database was imported."));
+        return 1;
+    }
+    Database->LoadAllPackages(FParse::Param(Cmd, TEXT("DefaultPackagesOnly")));
+
+    // The reference is what the text getters resolve on the game thread
+    static const FName TextName = TEXT("Text");
+    static const FName MenuTextName = TEXT("MenuText");
+    static const FText MenuBackupText = FText::FromString(TEXT("..."));
+    TArray<FArticyTextToPrepare> Texts;
+    TArray<FString> References;
+    for (UArticyObject* Object : Database->GetAllObjects())
+    {
+        IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Object);
+        if (const FText* Text = WithText ? WithText->GetPropPtr<FText>(TextName) : nullptr)
+        {
+            Texts.Add(FArticyTextToPrepare{ Object, *Text });
+            References.Add(WithText->GetText().ToString());
+        }
+
+        IArticyObjectWithMenuText* WithMenuText = Cast<IArticyObjectWithMenuText>(Object);
+        if (const FText* MenuText = WithMenuText ? WithMenuText->GetPropPtr<FText>(MenuTextName) : nullptr)
+        {
+            Texts.Add(FArticyTextToPrepare{ Object, *MenuText, MenuBackupText });
+            References.Add(WithMenuText->GetMenuText().ToString());
+        }
+    }
+
+    if (Texts.Num() == 0)
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Thread stress: the loaded packages have no texts."));
+        return 1;
+    }
+
+    TArray<int32> RequestCounts;
+    for (int32 NumRequests = 1; NumRequests < MaxRequests; NumRequests *= 2)
+        RequestCounts.Add(NumRequests);
+    RequestCounts.Add(MaxRequests);
+
+    UE_LOG(LogArticyEditor, Display, TEXT("Thread stress: preparing %d texts %d times with 1 to %d concurrent requests, %d worker threads."),
+        Texts.Num(), Rounds, MaxRequests, FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+    UArticyTextExtension* TextExtension = UArticyTextExtension::Get();
+    int32 NumMismatches = 0;
+    double SingleRequestRate = 0.0;
+    TArray<TSharedPtr<FJsonValue>> RunsJson;
+    for (const int32 NumRequests : RequestCounts)
+    {
+        int32 Pending = 0;
+        int32 RunMismatches = 0;
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Round = 0; Round < Rounds; ++Round)
+        {
+            // All requests of a round are in flight at once, their results arrive on the game thread
+            for (int32 Request = 0; Request < NumRequests; ++Request)
+            {
+                ++Pending;
+                TextExtension->PrepareTexts(Texts, [&Pending, &RunMismatches, &References](TArray<FText>&& Prepared)
+                {
+                    for (int32 Index = 0; Index < References.Num(); ++Index)
+                    {
+                        if (!Prepared.IsValidIndex(Index) || !Prepared[Index].ToString().Equals(References[Index], ESearchCase::CaseSensitive))
+                            ++RunMismatches;
+                    }
+                    --Pending;
+                });
+            }
+
+            while (Pending > 0)
+            {
+                FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+                FPlatformProcess::SleepNoStats(0.0f);
+            }
+        }
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+        const double TextsPerSecond = Seconds > 0.0 ? (double)Texts.Num() * NumRequests * Rounds / Seconds : 0.0;
+        if (NumRequests == 1)
+            SingleRequestRate = TextsPerSecond;
+        NumMismatches += RunMismatches;
+
+        UE_LOG(LogArticyEditor, Display, TEXT("Thread stress: %2d requests, %.0f texts/s (x%.2f), %d mismatches."),
+            NumRequests, TextsPerSecond, SingleRequestRate > 0.0 ? TextsPerSecond / SingleRequestRate : 0.0, RunMismatches);
+
+        TSharedRef<FJsonObject> RunJson = MakeShared<FJsonObject>();
+        RunJson->SetNumberField(TEXT("requests"), NumRequests);
+        RunJson->SetNumberField(TEXT("seconds"), Seconds);
+        RunJson->SetNumberField(TEXT("textsPerSecond"), TextsPerSecond);
+        RunJson->SetNumberField(TEXT("mismatches"), RunMismatches);
+        RunsJson.Add(MakeShared<FJsonValueObject>(RunJson));
+    }
+
+    TSharedRef<FJsonObject> ReportJson = MakeShared<FJsonObject>();
+    ReportJson->SetNumberField(TEXT("texts"), Texts.Num());
+    ReportJson->SetNumberField(TEXT("rounds"), Rounds);
+    ReportJson->SetNumberField(TEXT("workerThreads"), FTaskGraphInterface::Get().GetNumWorkerThreads());
+    ReportJson->SetNumberField(TEXT("mismatches"), NumMismatches);
+    ReportJson->SetArrayField(TEXT("runs"), RunsJson);
+
+    FString ReportString;
+    FJsonSerializer::Serialize(ReportJson, TJsonWriterFactory<>::Create(&ReportString));
+    if (!FFileHelper::SaveStringToFile(ReportString, *ReportPath))
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Thread stress: failed to write the report to %s."), *ReportPath);
+        return 1;
+    }
+    UE_LOG(LogArticyEditor, Display, TEXT("Thread stress: report written to %s."), *ReportPath);
+
+    if (NumMismatches > 0)
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Thread stress: %d prepared texts differ from the texts resolved on the game thread."), NumMismatches);
+        return 1;
+    }
+    return 0;
+}
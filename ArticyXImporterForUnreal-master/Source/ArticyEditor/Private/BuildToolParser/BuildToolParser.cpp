@@ -4,6 +4,21 @@
 
 #include "BuildToolParser.h"
 #include "ArticyEditorModule.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+    /** Result of verifying a build file, valid as long as the file keeps its timestamp and size */
+    struct FVerifiedBuildFile
+    {
+        FDateTime TimeStamp;
+        int64 Size = 0;
+        bool bHasArticyRuntimeRef = false;
+    };
+
+    /** Verified build files by path, so repeated imports don't parse unchanged files again */
+    TMap<FString, FVerifiedBuildFile> VerifiedBuildFiles;
+}
 
 /**
  * @brief Constructs a BuildToolParser object and sets the file path.
@@ -24,6 +39,15 @@ BuildToolParser::BuildToolParser(const FString& filePath)
  */
 bool BuildToolParser::VerifyArticyRuntimeRef()
 {
+    // Reuse the last result if the file wasn't touched since
+    const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*Path);
+    const int64 Size = IFileManager::Get().FileSize(*Path);
+    if (const FVerifiedBuildFile* Verified = VerifiedBuildFiles.Find(Path))
+    {
+        if (Verified->TimeStamp == TimeStamp && Verified->Size == Size)
+            return Verified->bHasArticyRuntimeRef;
+    }
+
     // Open the Path file and read its content as one line string
     FString fileString;
     if (!FFileHelper::LoadFileToString(fileString, *Path))
@@ -34,7 +58,10 @@ bool BuildToolParser::VerifyArticyRuntimeRef()
 
     // Extract PublicDependencyModuleNames C# code lines
     FString UncommentedString = RemoveComments(fileString);
-    return CheckReferences(UncommentedString);
+    const bool bHasArticyRuntimeRef = CheckReferences(UncommentedString);
+
+    VerifiedBuildFiles.Add(Path, FVerifiedBuildFile{ TimeStamp, Size, bHasArticyRuntimeRef });
+    return bHasArticyRuntimeRef;
 }
 
 /**
@@ -74,6 +101,7 @@ void BuildToolParser::AddArticyRuntimmeRef()
     }
 
     FFileHelper::SaveStringToFile(fileString, *Path);
+    VerifiedBuildFiles.Remove(Path);
 }
 
 /**
@@ -42,9 +42,9 @@ void ArticyLocalizerGenerator::GenerateCode(const UArticyImportData* Data, FStri
 
                     header->Method("void", "Reload", "", [&]
                         {
-                            // Add listener for language/locale change events
+                            // Add listener for language/locale change events, the tables are switched asynchronously
                             header->Line(TEXT("if (!bListenerSet) {"));
-                            header->Line(FString::Printf(TEXT("FInternationalization::Get().OnCultureChanged().AddUObject(this, &%s::Reload);"), *type), true, true, 1);
+                            header->Line(TEXT("FInternationalization::Get().OnCultureChanged().AddUObject(this, &UArticyLocalizerSystem::SwitchCulture);"), true, true, 1);
                             header->Line(TEXT("bListenerSet = true;"), true, true, 1);
                             header->Line(TEXT("}"));
 
@@ -52,12 +52,16 @@ void ArticyLocalizerGenerator::GenerateCode(const UArticyImportData* Data, FStri
                             header->Line(TEXT("FString LocaleName = FInternationalization::Get().GetCurrentCulture()->GetName();"));
                             header->Line(TEXT("FString LangName = FInternationalization::Get().GetCurrentCulture()->GetTwoLetterISOLanguageName();"));
 
+                            // Only the files of the current culture are known, the tables are loaded when they are used
+                            header->Line(TEXT("ResetStringTables();"), true);
+
                             // Fallback to default generated string tables if no localization is found
                             IterateStringTables(header, FPaths::ProjectContentDir() / "ArticyContent/Generated");
 
-                            // Generate code to load the string tables for all available languages and locales.
+                            // Generate code to select the string tables of the current language or locale.
                             IterateLocalizationDirectories(header, FPaths::ProjectContentDir() / "L10N");
 
+                            header->Line(TEXT("LoadStringTables();"), true);
                             header->Line(TEXT("bDataLoaded = true;"), true);
                         });
                 });
@@ -151,8 +155,7 @@ void ArticyLocalizerGenerator::IterateStringTables(CodeFileGenerator* Header, co
         for (const FString& FilePath : FoundFiles)
         {
             FString StringTable = FPaths::GetBaseFilename(*FilePath, true);
-            Header->Line(FString::Printf(TEXT("FStringTableRegistry::Get().UnregisterStringTable(FName(\"%s\"));"), *StringTable), true, Indent, IndentOffset);
-            Header->Line(FString::Printf(TEXT("LOCTABLE_FROMFILE_GAME(\"%s\", \"%s\", \"%s/%s.csv\");"), *StringTable, *StringTable, *RelPath, *StringTable), true, Indent, IndentOffset);
+            Header->Line(FString::Printf(TEXT("AddStringTable(FName(TEXT(\"%s\")), TEXT(\"%s/%s.csv\"));"), *StringTable, *RelPath, *StringTable), true, Indent, IndentOffset);
         }
     }
 }
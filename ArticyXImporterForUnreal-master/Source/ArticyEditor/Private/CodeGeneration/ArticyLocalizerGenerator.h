@@ -50,7 +50,7 @@ private:
      * @brief Iterates through string tables in a given directory and generates code for each.
      *
      * This function finds CSV files in the specified directory and generates
-     * code to register and load these string tables.
+     * code to add these string tables, they are loaded when they are first used.
      *
      * @param Header The code file generator used to output the generated code.
      * @param DirectoryPath The path to the directory containing string table CSV files.
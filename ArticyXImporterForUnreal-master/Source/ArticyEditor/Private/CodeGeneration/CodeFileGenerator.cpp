@@ -10,17 +10,112 @@
 #include "ISourceControlProvider.h"
 #include "HAL/PlatformFileManager.h"
 #include "SourceControlHelpers.h"
+#include "Misc/SecureHash.h"
+#include "Containers/StringConv.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+namespace
+{
+	/** A changed file queued while writes are deferred. */
+	struct FDeferredWrite
+	{
+		FString Path;
+		TArray<uint8> Content;
+		bool bFileExisted = false;
+	};
+
+	std::atomic<bool> bDeferWrites{ false };
+	FCriticalSection DeferredWritesLock;
+	TArray<FDeferredWrite> DeferredWrites;
+
+	/**
+	 * @brief Writes a generated file, checking it out or marking it for add in source control.
+	 *
+	 * @param Path The path of the file.
+	 * @param bFileExisted Whether the file existed before, it is checked out then.
+	 * @param WriteContent Writes the encoded content to the file archive.
+	 */
+	void CommitFile(const FString& Path, const bool bFileExisted, TFunctionRef<void(FArchive&)> WriteContent)
+	{
+		check(IsInGameThread());
+
+		ISourceControlModule& SCModule = ISourceControlModule::Get();
+
+		bool bCheckOutEnabled = false;
+		if(SCModule.IsEnabled())
+		{
+			bCheckOutEnabled = ISourceControlModule::Get().GetProvider().UsesCheckout();
+		}
+
+		// try check out the file if it existed
+		if(bFileExisted && bCheckOutEnabled)
+		{
+			USourceControlHelpers::CheckOutFile(*Path);
+		}
+
+		bool bFileWritten = false;
+		if(FArchive* Writer = IFileManager::Get().CreateFileWriter(*Path))
+		{
+			WriteContent(*Writer);
+			bFileWritten = Writer->Close();
+			delete Writer;
+		}
+
+		if(!bFileWritten)
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Failed to write generated code file %s"), *Path);
+		}
+
+		// mark the file for add if it's the first time we've written it
+		if(!bFileExisted && bFileWritten && SCModule.IsEnabled())
+		{
+			USourceControlHelpers::MarkFileForAdd(*Path);
+		}
+	}
+}
 
 void CodeFileGenerator::Line(const FString& Line, const bool bSemicolon, const bool bIndent, const int IndentOffset)
 {
 	if(bIndent)
 	{
 		//add indenting tabs
-		for(int i = 0; i < IndentCount + IndentOffset; ++i)
-			FileContent += TEXT("\t");
+		Append(GetIndent(IndentCount + IndentOffset));
 	}
 
-	FileContent += Line + (bSemicolon ? TEXT(";") : TEXT("")) + TEXT("\n");
+	Append(Line);
+	if(bSemicolon)
+		Append(TEXT(";"), 1);
+	Append(TEXT("\n"), 1);
+}
+
+void CodeFileGenerator::Append(const TCHAR* Chars, int32 Count)
+{
+	if(Count <= 0)
+		return;
+
+	if(FileContent.Num() == 0 || FileContent.Last().Len() + Count > ChunkSize)
+		FileContent.AddDefaulted_GetRef().Reserve(FMath::Max(ChunkSize, Count));
+
+	FileContent.Last().AppendChars(Chars, Count);
+	ContentLength += Count;
+}
+
+const FString& CodeFileGenerator::GetIndent(int32 Level)
+{
+	Level = FMath::Max(0, Level);
+	while(IndentPrefixes.Num() <= Level)
+		IndentPrefixes.Add(FString::ChrN(IndentPrefixes.Num(), TEXT('\t')));
+
+	return IndentPrefixes[Level];
+}
+
+void CodeFileGenerator::ReserveForExistingFile()
+{
+	// the file is mostly regenerated with a similar size, in UTF-8 bytes which are at least as many as characters
+	const int64 ExistingSize = IFileManager::Get().FileSize(*Path);
+	if(ExistingSize > 0)
+		FileContent.Reserve(int32(ExistingSize / ChunkSize) + 1);
 }
 
 void CodeFileGenerator::Comment(const FString& Text)
@@ -149,48 +244,118 @@ FString CodeFileGenerator::GetExportMacro()
 
 void CodeFileGenerator::WriteToFile() const
 {
-	if(FileContent.IsEmpty())
+	if(ContentLength == 0)
 		return;
 
 	if(BlockCount > 0)
 		UE_LOG(LogArticyEditor, Warning, TEXT("Block count is %d when writing to file!"), BlockCount);
 
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	ISourceControlModule& SCModule = ISourceControlModule::Get();
 
 	bool bFileExisted = false;
 	if(PlatformFile.FileExists(*Path))
 	{
-		// If the content won't change, don't write the file
-		FString OldContent;
-		FFileHelper::LoadFileToString(OldContent, *Path);
-		if (FileContent.Equals(OldContent))
+		bFileExisted = true;
+
+		// If the content won't change, don't write the file; the sizes are compared first so most changed files aren't read
+		int64 NewSize = 0;
+		FSHA1 NewHash;
+		VisitEncodedContent([&NewSize, &NewHash](const uint8* Bytes, int64 Count)
+		{
+			NewSize += Count;
+			NewHash.Update(Bytes, Count);
+		});
+		NewHash.Final();
+
+		if(PlatformFile.FileSize(*Path) == NewSize)
 		{
-			return;
+			TArray<uint8> OldContent;
+			FFileHelper::LoadFileToArray(OldContent, *Path);
+
+			FSHAHash OldHash;
+			FSHA1::HashBuffer(OldContent.GetData(), OldContent.Num(), OldHash.Hash);
+
+			FSHAHash NewHashValue;
+			NewHash.GetHash(NewHashValue.Hash);
+			if(OldHash == NewHashValue)
+			{
+				return;
+			}
 		}
 	}
-	
-	bool bCheckOutEnabled = false;
-	if(SCModule.IsEnabled())
+
+	// generators running on workers keep the encoded file until the game thread commits it
+	if(bDeferWrites)
 	{
-		bCheckOutEnabled = ISourceControlModule::Get().GetProvider().UsesCheckout();
+		FDeferredWrite Write;
+		Write.Path = Path;
+		Write.bFileExisted = bFileExisted;
+		VisitEncodedContent([&Write](const uint8* Bytes, int64 Count)
+		{
+			Write.Content.Append(Bytes, Count);
+		});
+
+		FScopeLock Lock(&DeferredWritesLock);
+		DeferredWrites.Add(MoveTemp(Write));
+		return;
 	}
-	
-	// try check out the file if it existed
-	if(bFileExisted && bCheckOutEnabled)
+
+	// write the chunks straight to disk instead of joining them first
+	CommitFile(Path, bFileExisted, [this](FArchive& Writer)
+	{
+		VisitEncodedContent([&Writer](const uint8* Bytes, int64 Count)
+		{
+			Writer.Serialize(const_cast<uint8*>(Bytes), Count);
+		});
+	});
+}
+
+void CodeFileGenerator::BeginDeferredWrites()
+{
+	check(IsInGameThread());
+	bDeferWrites = true;
+}
+
+void CodeFileGenerator::CommitDeferredWrites()
+{
+	check(IsInGameThread());
+	bDeferWrites = false;
+
+	TArray<FDeferredWrite> Writes;
 	{
-		USourceControlHelpers::CheckOutFile(*Path);
+		FScopeLock Lock(&DeferredWritesLock);
+		Writes = MoveTemp(DeferredWrites);
+		DeferredWrites.Reset();
 	}
-	
-	const bool bFileWritten = FFileHelper::SaveStringToFile(FileContent, *Path, FFileHelper::EEncodingOptions::ForceUTF8);
 
-	// mark the file for add if it's the first time we've written it
-	if(!bFileExisted && bFileWritten && SCModule.IsEnabled())
+	for(FDeferredWrite& Write : Writes)
 	{
-		USourceControlHelpers::MarkFileForAdd(*Path);
+		CommitFile(Write.Path, Write.bFileExisted, [&Write](FArchive& Writer)
+		{
+			Writer.Serialize(Write.Content.GetData(), Write.Content.Num());
+		});
 	}
 }
 
+void CodeFileGenerator::VisitEncodedContent(TFunctionRef<void(const uint8*, int64)> Visitor) const
+{
+	// UTF-8 with a byte order mark, as FFileHelper::EEncodingOptions::ForceUTF8 wrote it before
+	static const uint8 UTF8BOM[] = { 0xEF, 0xBB, 0xBF };
+	Visitor(UTF8BOM, UE_ARRAY_COUNT(UTF8BOM));
+
+	for(const FString& Chunk : FileContent)
+	{
+		FTCHARToUTF8 Converted(*Chunk, Chunk.Len());
+		Visitor(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	}
+}
+
+bool CodeFileGenerator::HasDeferredWrites()
+{
+	FScopeLock Lock(&DeferredWritesLock);
+	return DeferredWrites.Num() > 0;
+}
+
 FString CodeFileGenerator::SplitName(const FString& Name)
 {
 	FString Result;
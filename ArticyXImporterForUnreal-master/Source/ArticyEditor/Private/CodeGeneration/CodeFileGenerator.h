@@ -40,6 +40,25 @@ public:
 	template<typename Lambda>
 	CodeFileGenerator(const FString& Path, const bool bHeader, Lambda ContentGenerator);
 
+	/**
+	 * @brief Makes WriteToFile queue changed files instead of writing them, until CommitDeferredWrites is called.
+	 *
+	 * Generators can run on worker threads in between, since only writing talks to source control.
+	 */
+	static void BeginDeferredWrites();
+
+	/**
+	 * @brief Writes the files queued since BeginDeferredWrites, on the game thread.
+	 */
+	static void CommitDeferredWrites();
+
+	/**
+	 * @brief Checks whether any changed file is queued since BeginDeferredWrites.
+	 *
+	 * @return true if a file will be written by CommitDeferredWrites.
+	 */
+	static bool HasDeferredWrites();
+
 	/**
 	 * @brief Adds a line to the file content.
 	 *
@@ -177,11 +196,46 @@ public:
 private:
 
 	const FString Path; ///< The path to the generated file.
-	FString FileContent = ""; ///< The content of the generated file.
+
+	/// The content of the generated file, in chunks of at most ChunkSize characters so large files are never copied to grow.
+	TArray<FString> FileContent;
+	int64 ContentLength = 0; ///< The number of characters in all chunks.
+
+	static constexpr int32 ChunkSize = 1 << 20; ///< Characters per content chunk.
+
+	TArray<FString> IndentPrefixes; ///< Tab strings by indentation level, built once per level.
 
 	int IndentCount = 0; ///< The current indentation level.
 	uint8 BlockCount = 0; ///< The current block count.
 
+	/**
+	 * @brief Appends characters to the content, starting a new chunk if the current one is full.
+	 *
+	 * @param Chars The characters to append.
+	 * @param Count The number of characters.
+	 */
+	void Append(const TCHAR* Chars, int32 Count);
+
+	/**
+	 * @brief Appends a string to the content.
+	 *
+	 * @param String The string to append.
+	 */
+	void Append(const FString& String) { Append(*String, String.Len()); }
+
+	/**
+	 * @brief Gets the tabs of an indentation level.
+	 *
+	 * @param Level The indentation level.
+	 * @return A string of Level tabs.
+	 */
+	const FString& GetIndent(int32 Level);
+
+	/**
+	 * @brief Reserves the content chunks for a file about as large as the one it replaces.
+	 */
+	void ReserveForExistingFile();
+
 	/**
 	 * @brief Increases the indentation level.
 	 */
@@ -263,9 +317,18 @@ private:
 
 	/**
 	 * @brief Writes the content to the specified file path.
+	 *
+	 * The file is left untouched if its content hashes the same, so its timestamp doesn't trigger a rebuild.
 	 */
 	void WriteToFile() const;
 
+	/**
+	 * @brief Converts the content to the bytes written to disk, chunk by chunk.
+	 *
+	 * @param Visitor Receives the bytes of the byte order mark and of each chunk.
+	 */
+	void VisitEncodedContent(TFunctionRef<void(const uint8*, int64)> Visitor) const;
+
 	/**
 	 * @brief Splits a camel-case property name into a human-readable format.
 	 *
@@ -302,6 +365,8 @@ inline void CodeFileGenerator::SafeExecute(nullptr_t Lamb)
 template <typename Lambda>
 CodeFileGenerator::CodeFileGenerator(const FString& Path, const bool bHeader, Lambda ContentGenerator) : Path(CodeGenerator::GetSourceFolder() / Path)
 {
+	ReserveForExistingFile();
+
 	Line("// articy Software GmbH & Co. KG");
 	Comment("This code file was generated by ArticyImporter. Changes to this file will get lost once the code is regenerated.");
 
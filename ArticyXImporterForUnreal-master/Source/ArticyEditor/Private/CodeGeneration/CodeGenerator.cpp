@@ -16,9 +16,13 @@
 #include "FileHelpers.h"
 #include "GenericPlatform/GenericPlatformMisc.h"
 #include "ArticyEditorModule.h"
+#include "ArticyImportStats.h"
 #include "ArticyPluginSettings.h"
 #include "ArticyTypeGenerator.h"
 #include "ArticyLocalizerGenerator.h"
+#include "CodeFileGenerator.h"
+#include "ArticyPackageSaver.h"
+#include "Async/ParallelFor.h"
 #include "AssetToolsModule.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Misc/FileHelper.h"
@@ -28,6 +32,7 @@
 #include "Misc/MessageDialog.h"
 #include "Dialogs/Dialogs.h"
 #include "ISourceControlModule.h"
+#include "Misc/PackageName.h"
 #if WITH_LIVE_CODING && ENGINE_MAJOR_VERSION == 4
 #include "Windows/LiveCoding/Public/ILiveCodingModule.h"
 #endif
@@ -97,6 +102,17 @@ FString CodeGenerator::GetGVNamespaceClassname(const UArticyImportData* Data, co
 	return "U" + Data->GetProject().TechnicalName + Namespace + "Variables";
 }
 
+/**
+ * @brief Gets the C++ namespace of the global variable slots based on import data.
+ *
+ * @param Data The import data containing project details.
+ * @return The namespace containing a slot per global variable.
+ */
+FString CodeGenerator::GetGVSlotsNamespace(const UArticyImportData* Data)
+{
+	return Data->GetProject().TechnicalName + "GlobalVariableSlots";
+}
+
 /**
  * @brief Gets the class name for the database based on import data.
  *
@@ -187,68 +203,50 @@ bool CodeGenerator::DeleteGeneratedCode(const FString& Filename)
 }
 
 /**
- * @brief Deletes extra generated code files that are not in the provided list.
- *
- * Iterates through the source folder and deletes files not matching any prefix from the generated files list.
+ * @brief Finds generated code files that are not in the provided list.
  *
  * @param GeneratedFiles A list of prefixes for the generated files to keep.
- * @return true if all non-matching files were successfully deleted, false otherwise.
+ * @param OutExtraFiles Receives the paths of the header files not matching any prefix.
  */
-bool CodeGenerator::DeleteExtraCode(const TArray<FString>& GeneratedFiles)
+void CodeGenerator::FindExtraCode(const TArray<FString>& GeneratedFiles, TArray<FString>& OutExtraFiles)
 {
 	const auto& SourceFolder = GetSourceFolder();
-	IFileManager& FileManager = IFileManager::Get();
 
-	// Create a directory visitor class
-	class FDirectoryVisitor : public IPlatformFile::FDirectoryVisitor
-	{
-	public:
-		TArray<FString> const& GeneratedFiles;
-		IFileManager& FileManager;
-
-		FDirectoryVisitor(TArray<FString> const& InGeneratedFiles, IFileManager& InFileManager)
-			: GeneratedFiles(InGeneratedFiles), FileManager(InFileManager) {}
+	// Only applies to .h files - though there should not be anything else
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *SourceFolder, TEXT("h"));
 
-		virtual bool Visit(const TCHAR* FilenameOrDirectory, bool bIsDirectory) override
+	for (const FString& FileName : FileNames)
+	{
+		// Check if the filename starts with any of the strings from the generated files
+		const bool bShouldKeep = GeneratedFiles.ContainsByPredicate([&FileName](const FString& Prefix)
 		{
-			if (bIsDirectory)
-			{
-				// Continue searching
-				return true;
-			}
-
-			FString FilePath(FilenameOrDirectory);
-			FString FileName = FPaths::GetCleanFilename(FilePath);
+			return FileName.StartsWith(Prefix);
+		});
 
-			// Only applies to .h files - though there should not be anything else
-			if (FileName.EndsWith(TEXT(".h")))
-			{
-				// Check if the filename starts with any of the strings from the generated files
-				bool bShouldKeep = false;
-				for (const FString& Prefix : GeneratedFiles)
-				{
-					if (FileName.StartsWith(Prefix))
-					{
-						bShouldKeep = true;
-						break;
-					}
-				}
+		if (!bShouldKeep)
+			OutExtraFiles.Add(SourceFolder / FileName);
+	}
+}
 
-				// Delete file if it does not match any prefix
-				if (!bShouldKeep)
-				{
-					return FileManager.Delete(*FilePath);
-				}
-			}
+/**
+ * @brief Deletes extra generated code files that are not in the provided list.
+ *
+ * Iterates through the source folder and deletes files not matching any prefix from the generated files list.
+ *
+ * @param GeneratedFiles A list of prefixes for the generated files to keep.
+ * @return true if all non-matching files were successfully deleted, false otherwise.
+ */
+bool CodeGenerator::DeleteExtraCode(const TArray<FString>& GeneratedFiles)
+{
+	TArray<FString> ExtraFiles;
+	FindExtraCode(GeneratedFiles, ExtraFiles);
 
-			// Continue searching
-			return true;
-		}
-	};
+	bool bAllDeleted = true;
+	for (const FString& ExtraFile : ExtraFiles)
+		bAllDeleted &= IFileManager::Get().Delete(*ExtraFile);
 
-	// Use the directory visitor to iterate through the files in the source folder
-	FDirectoryVisitor Visitor(GeneratedFiles, FileManager);
-	return FileManager.IterateDirectory(*SourceFolder, Visitor);
+	return bAllDeleted;
 }
 
 /**
@@ -258,6 +256,8 @@ bool CodeGenerator::DeleteExtraCode(const TArray<FString>& GeneratedFiles)
  */
 void CodeGenerator::CacheCodeFiles()
 {
+	CachedFiles.Reset();
+
 	TArray<FString> FileNames;
 	IFileManager::Get().FindFiles(FileNames, *GetSourceFolder());
 	TArray<FString> FileContents;
@@ -281,51 +281,71 @@ void CodeGenerator::CacheCodeFiles()
  * This function manages the code generation process for various components such as global variables, databases, and scripts.
  *
  * @param Data The import data used for code generation.
- * @return true if code was generated successfully, false otherwise.
+ * @return true if any generated file changed and the code needs to be compiled, false otherwise.
  */
 bool CodeGenerator::GenerateCode(UArticyImportData* Data)
 {
 	if (!Data)
 		return false;
 
-	bool bCodeGenerated = false;
+	ARTICY_IMPORT_STAGE(GenerateCode);
+
+	// Files are only queued if their content differs from the one on disk, so nothing is written before we know whether anything changed
+	CodeFileGenerator::BeginDeferredWrites();
 
-	CacheCodeFiles();
+	TArray<FString> OutFiles;
+	TArray<FString> ExtraFiles;
 
 	// Generate all files if ObjectDefs or GVs changed
 	if (Data->GetSettings().DidObjectDefsOrGVsChange())
 	{
-		TArray<FString> OutFiles;
-		FString OutFile;
-
-		GlobalVarsGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		DatabaseGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		InterfacesGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		ObjectDefinitionsGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
 		/* Generate scripts as well due to them including the generated global variables
 		 * if we remove a GV set but don't regenerate expresso scripts, the resulting class won't compile */
-		ExpressoScriptsGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		ArticyTypeGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
+		using FGenerator = void(*)(const UArticyImportData*, FString&);
+		static const FGenerator ParallelGenerators[] =
+		{
+			&GlobalVarsGenerator::GenerateCode,
+			&DatabaseGenerator::GenerateCode,
+			&InterfacesGenerator::GenerateCode,
+			&ObjectDefinitionsGenerator::GenerateCode,
+			&ExpressoScriptsGenerator::GenerateCode,
+			&ArticyTypeGenerator::GenerateCode,
+		};
+
+		// The generators only read the import data and write their own files, so they run side by side;
+		// the files are written once all are done, since source control may only be used on the game thread
+		OutFiles.SetNum(UE_ARRAY_COUNT(ParallelGenerators));
+		ParallelFor(OutFiles.Num(), [&](int32 Index)
+		{
+			ParallelGenerators[Index](Data, OutFiles[Index]);
+		});
+
+		// The localizer also adds cook directories to the project config, which stays on the game thread
+		FString OutFile;
 		ArticyLocalizerGenerator::GenerateCode(Data, OutFile);
 		OutFiles.Add(OutFile);
 
-		bCodeGenerated = true;
-		DeleteExtraCode(OutFiles);
+		FindExtraCode(OutFiles, ExtraFiles);
 	}
 	// If object defs or GVs didn't change, but scripts changed, regenerate only expresso scripts
 	else if (Data->GetSettings().DidScriptFragmentsChange())
 	{
 		FString OutFile;
 		ExpressoScriptsGenerator::GenerateCode(Data, OutFile);
-		bCodeGenerated = true;
 	}
 
+	// If every generated file is byte-identical to the compiled one the code doesn't need to be compiled again
+	const bool bCodeGenerated = CodeFileGenerator::HasDeferredWrites() || ExtraFiles.Num() > 0;
+	if (bCodeGenerated)
+	{
+		// Still the previous code, kept to restore it if compiling the new one fails
+		CacheCodeFiles();
+	}
+
+	CodeFileGenerator::CommitDeferredWrites();
+	if (ExtraFiles.Num() > 0)
+		DeleteExtraCode(OutFiles);
+
 	return bCodeGenerated;
 }
 
@@ -336,6 +356,8 @@ bool CodeGenerator::GenerateCode(UArticyImportData* Data)
  */
 void CodeGenerator::Recompile(UArticyImportData* Data)
 {
+	// Compiling is asynchronous, the stage ends in OnCompiled
+	FArticyImportStats::Get().BeginStage(TEXT("Compile"));
 	Compile(Data);
 }
 
@@ -343,6 +365,8 @@ void CodeGenerator::Recompile(UArticyImportData* Data)
  * @brief Deletes generated assets based on package definitions.
  *
  * Removes assets not included in the import, handling invalid assets appropriately.
+ * All assets are deleted by one call each for loadable and invalid assets, so references and
+ * the asset registry are processed once for the whole batch instead of once per asset.
  *
  * @param PackageDefs The package definitions used to determine which assets to delete.
  * @return true if all invalid assets were successfully deleted, false otherwise.
@@ -353,8 +377,17 @@ bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs)
 	TArray<FAssetData> OutAssets;
 	AssetRegistry.Get().GetAssetsByPath(FName(*ArticyHelpers::GetArticyGeneratedFolder()), OutAssets, true, false);
 
+	// Don't delete package assets that are not included in the import
+	TSet<FString> ExcludedPackages;
+	for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
+	{
+		if (!PackageDef.GetIsIncluded())
+			ExcludedPackages.Add(PackageDef.GetName());
+	}
+
 	TArray<UObject*> ExistingAssets;
 	TArray<FAssetData> InvalidAssets;
+	ExistingAssets.Reserve(OutAssets.Num());
 	for (const FAssetData& Data : OutAssets)
 	{
 		if (Data.IsValid())
@@ -367,20 +400,8 @@ bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs)
 				continue;
 			}
 
-			bool ExcludeAsset = false;
-			if (const UArticyPackage* PackageAsset = Cast<UArticyPackage>(Asset))
-			{
-				for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
-				{
-					// Don't delete package assets that are not included in the import
-					if (!PackageDef.GetIsIncluded() && PackageAsset->Name.Equals(PackageDef.GetName()))
-					{
-						ExcludeAsset = true;
-					}
-				}
-			}
-
-			if (!ExcludeAsset)
+			const UArticyPackage* PackageAsset = Cast<UArticyPackage>(Asset);
+			if (!PackageAsset || !ExcludedPackages.Contains(PackageAsset->Name))
 			{
 				ExistingAssets.Add(Asset);
 			}
@@ -406,62 +427,67 @@ bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs)
  * @brief Renames generated assets based on package definitions.
  *
  * This function handles renaming of package assets when their names have changed.
+ * Only package assets are looked up and loaded, and all of them are renamed by a single
+ * RenameAssets call, which notifies the asset registry and fixes up redirectors once.
  *
  * @param PackageDefs The package definitions containing the new asset names.
  * @return true if all renaming operations succeeded, false otherwise.
  */
 bool CodeGenerator::RenameGeneratedAssets(const FArticyPackageDefs& PackageDefs)
 {
+	// New names of the packages not included in the import by their previous name - we delete included ones anyway
+	TMap<FString, const FArticyPackageDef*> RenamedPackages;
+	for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
+	{
+		if (!PackageDef.GetIsIncluded() && !PackageDef.GetName().Equals(PackageDef.GetPreviousName()))
+			RenamedPackages.Add(PackageDef.GetPreviousName(), &PackageDef);
+	}
+
+	if (RenamedPackages.Num() == 0)
+		return true;
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add(FName(*ArticyHelpers::GetArticyGeneratedFolder()));
+	Filter.bRecursivePaths = true;
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
+	Filter.ClassPaths.Add(UArticyPackage::StaticClass()->GetClassPathName());
+#else
+	Filter.ClassNames.Add(UArticyPackage::StaticClass()->GetFName());
+#endif
+
 	const FAssetRegistryModule& AssetRegistry = FModuleManager::Get().GetModuleChecked<FAssetRegistryModule>("AssetRegistry");
 	TArray<FAssetData> OutAssets;
-	AssetRegistry.Get().GetAssetsByPath(FName(*ArticyHelpers::GetArticyGeneratedFolder()), OutAssets, true, false);
+	AssetRegistry.Get().GetAssets(Filter, OutAssets);
 
+	TArray<FAssetRenameData> AssetsAndNames;
+	TArray<UArticyPackage*> RenamedAssets;
 	for (const FAssetData& Data : OutAssets)
 	{
-		if (Data.IsValid())
-		{
-			UObject* Asset = Data.GetAsset();
-
-			// Skip invalid assets
-			if (!Asset)
-			{
-				continue;
-			}
+		UArticyPackage* PackageAsset = Cast<UArticyPackage>(Data.GetAsset());
 
-			if (UArticyPackage* PackageAsset = Cast<UArticyPackage>(Asset))
-			{
-				for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
-				{
-					// Skip included packages - we delete them anyway
-					if (PackageDef.GetIsIncluded())
-					{
-						continue;
-					}
+		// Skip invalid assets
+		if (!PackageAsset)
+			continue;
 
-					// Only check packages with name changes
-					if (PackageDef.GetName().Equals(PackageDef.GetPreviousName()))
-					{
-						continue;
-					}
+		const FArticyPackageDef* const* PackageDef = RenamedPackages.Find(PackageAsset->Name);
+		if (!PackageDef)
+			continue;
 
-					// Rename the asset
-					FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
-					TArray<FAssetRenameData> AssetsAndNames;
-					const FString OldName = PackageAsset->GetName();
-					const FString PackagePath = FPackageName::GetLongPackagePath(PackageAsset->GetOutermost()->GetName());
-					new(AssetsAndNames)FAssetRenameData(PackageAsset, PackagePath, PackageDef.GetName());
-					AssetToolsModule.Get().RenameAssets(AssetsAndNames);
-
-					FAssetRegistryModule::AssetRenamed(PackageAsset, PackagePath / OldName);
-					PackageAsset->MarkPackageDirty();
-					PackageAsset->GetOuter()->MarkPackageDirty();
-				}
-			}
-		}
+		const FString PackagePath = FPackageName::GetLongPackagePath(PackageAsset->GetOutermost()->GetName());
+		AssetsAndNames.Emplace(PackageAsset, PackagePath, FPaths::GetBaseFilename((*PackageDef)->GetFolder()));
+		RenamedAssets.Add(PackageAsset);
 	}
 
-	// Returns true if there are no failures
-	return true;
+	if (AssetsAndNames.Num() == 0)
+		return true;
+
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+	const bool bRenamed = AssetToolsModule.Get().RenameAssets(AssetsAndNames);
+
+	for (UArticyPackage* PackageAsset : RenamedAssets)
+		PackageAsset->MarkPackageDirty();
+
+	return bRenamed;
 }
 
 /**
@@ -593,28 +619,36 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 			UE_LOG(LogArticyEditor, Error, TEXT("Could not find generated global variables class after compile!"));
 	}
 
-	if (!ensureAlwaysMsgf(RenameGeneratedAssets(Data->GetPackageDefs()),
-		TEXT("RenameGeneratedAssets() has failed. The Articy X Importer can not proceed without\n"
-			"being able to rename previously generated assets for packages with new names.\n"
-			"Please make sure the Generated folder in ArticyContent is editable.")))
 	{
-		// Failed to rename generated assets. We can't continue
-		return;
+		ARTICY_IMPORT_STAGE(CleanGeneratedAssets);
+
+		if (!ensureAlwaysMsgf(RenameGeneratedAssets(Data->GetPackageDefs()),
+			TEXT("RenameGeneratedAssets() has failed. The Articy X Importer can not proceed without\n"
+				"being able to rename previously generated assets for packages with new names.\n"
+				"Please make sure the Generated folder in ArticyContent is editable.")))
+		{
+			// Failed to rename generated assets. We can't continue
+			return;
+		}
+
+		if (!ensureAlwaysMsgf(DeleteGeneratedAssets(Data->GetPackageDefs()),
+			TEXT("DeletedGeneratedAssets() has failed. The Articy X Importer can not proceed without\n"
+				"being able to delete the previously generated assets to replace them with new ones.\n"
+				"Please make sure the Generated folder in ArticyContent is editable.")))
+		{
+			// Failed to delete generated assets. We can't continue
+			return;
+		}
 	}
 
-	if (!ensureAlwaysMsgf(DeleteGeneratedAssets(Data->GetPackageDefs()),
-		TEXT("DeletedGeneratedAssets() has failed. The Articy X Importer can not proceed without\n"
-			"being able to delete the previously generated assets to replace them with new ones.\n"
-			"Please make sure the Generated folder in ArticyContent is editable.")))
+	UArticyDatabase* ArticyDatabase;
 	{
-		// Failed to delete generated assets. We can't continue
-		return;
+		ARTICY_IMPORT_STAGE(GenerateDatabase);
+		// Generate the global variables asset
+		GlobalVarsGenerator::GenerateAsset(Data);
+		// Generate the database asset
+		ArticyDatabase = DatabaseGenerator::GenerateAsset(Data);
 	}
-
-	// Generate the global variables asset
-	GlobalVarsGenerator::GenerateAsset(Data);
-	// Generate the database asset
-	UArticyDatabase* ArticyDatabase = DatabaseGenerator::GenerateAsset(Data);
 	if (!ensureAlwaysMsgf(ArticyDatabase != nullptr, TEXT("Could not create ArticyDatabase asset!")))
 	{
 		// Somehow, we failed to load the database. We just need to stop right here and right now.
@@ -622,10 +656,16 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 		//  have to settle with the ensures.
 		return;
 	}
-	ArticyTypeGenerator::GenerateAsset(Data);
+
+	// Packages are saved while the ones after them are generated, the other assets are saved with the rest below
+	FArticyPackageSaver Saver;
 
 	// Generate assets for all the imported objects
-	PackagesGenerator::GenerateAssets(Data);
+	{
+		ARTICY_IMPORT_STAGE(GeneratePackages);
+		ArticyTypeGenerator::GenerateAsset(Data);
+		PackagesGenerator::GenerateAssets(Data, &Saver);
+	}
 	ArticyDatabase->SetLoadedPackages(Data->GetPackagesDirect());
 
 	// Gather all Articy assets to save them
@@ -638,22 +678,19 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 	PackagesToSave.Add(Data->GetOutermost());
 	for (const FAssetData& AssetData : GeneratedAssets)
 	{
-		PackagesToSave.Add(AssetData.GetAsset()->GetOutermost());
-	}
-
-	// Check out all the assets we want to save (if source control is enabled)
-	ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
-	if (SourceControlProvider.IsEnabled())
-	{
-		TArray<UPackage*> CheckedOutPackages;
-		FEditorFileUtils::CheckoutPackages(PackagesToSave, &CheckedOutPackages, false);
+		PackagesToSave.AddUnique(AssetData.GetAsset()->GetOutermost());
 	}
 
-	// Save the packages to disk
-	for (auto Package : PackagesToSave) { Package->SetDirtyFlag(true); }
-	if (!UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true))
+	// Save the packages to disk, the saver checks them out if source control is enabled
 	{
-		UE_LOG(LogArticyEditor, Error, TEXT("Failed to save packages. Make sure to save before submitting in Perforce."));
+		ARTICY_IMPORT_STAGE(SavePackages);
+		for (auto Package : PackagesToSave) { Saver.Save(Package); }
+		const int32 NumSaved = Saver.Finish();
+		FArticyImportStats::Get().Add(FArticyImportStats::ECounter::AssetsSaved, NumSaved);
+		if (NumSaved != PackagesToSave.Num())
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Failed to save packages. Make sure to save before submitting in Perforce."));
+		}
 	}
 
 	FArticyEditorModule::Get().OnAssetsGenerated.Broadcast();
@@ -672,6 +709,8 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
  */
 void CodeGenerator::OnCompiled(UArticyImportData* Data)
 {
+	FArticyImportStats::Get().EndStage(TEXT("Compile"));
+
 	Data->GetSettings().SetObjectDefinitionsRebuilt();
 	Data->GetSettings().SetScriptFragmentsRebuilt();
 	// Broadcast that compilation has finished. ArticyImportData will then generate the assets and perform post import operations
@@ -721,7 +760,8 @@ bool CodeGenerator::RestorePreviousImport(UArticyImportData* Data, const bool& b
 	const FText ArticyImportErrorText = FText::FromString(TEXT("Articy import error"));
 	FText ReasonForRestoreText = FText::FromString(ECompilationResult::ToString(Reason));
 
-	if (!Data->HasCachedVersion())
+	// Transfer the cached data into the current one, the cached version file is only read here
+	if (!Data->HasCachedVersion() || !Data->ResolveCachedVersion())
 	{
 		const FText CacheNotAvailableText = FText::Format(LOCTEXT("NoCacheAvailable", "Aborting import process. No cache available to restore. Deleting import asset but leaving generated code intact. Please delete manually in Source/ArticyGenerated if necessary and rebuild. Reason: {0}."), ReasonForRestoreText);
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 24
@@ -736,9 +776,6 @@ bool CodeGenerator::RestorePreviousImport(UArticyImportData* Data, const bool& b
 		return false;
 	}
 
-	// Transfer the cached data into the current one
-	Data->ResolveCachedVersion();
-
 	// Attempt to restore all generated files
 	const bool bFilesRestored = RestoreCachedFiles();
 
@@ -822,6 +859,18 @@ bool CodeGenerator::RestoreCachedFiles()
 		bFilesRestored = bFilesRestored && FFileHelper::SaveStringToFile(CachedFile.Value, *CachedFile.Key);
 	}
 
+	// Files the failed import added, e.g. scripts of new packages, would not compile against the restored ones
+	if (bFilesRestored)
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *GetSourceFolder());
+		for (const auto& FileName : FileNames)
+		{
+			if (!CachedFiles.Contains(GetSourceFolder() / FileName))
+				IFileManager::Get().Delete(*(GetSourceFolder() / FileName));
+		}
+	}
+
 	return bFilesRestored;
 }
 
@@ -22,7 +22,7 @@ public:
 	 * @brief Generates code files based on the provided import data.
 	 *
 	 * @param Data The import data used for code generation.
-	 * @return true if code was generated successfully, false otherwise.
+	 * @return true if any generated file changed and the code needs to be compiled, false otherwise.
 	 */
 	static bool GenerateCode(UArticyImportData* Data);
 
@@ -73,6 +73,7 @@ public:
 	static FString GetGeneratedTypeInformationFilename(const UArticyImportData* Data);
 	static FString GetGlobalVarsClassname(const UArticyImportData* Data, const bool bOmittPrefix = false);
 	static FString GetGVNamespaceClassname(const UArticyImportData* Data, const FString& Namespace);
+	static FString GetGVSlotsNamespace(const UArticyImportData* Data);
 	static FString GetDatabaseClassname(const UArticyImportData* Data, const bool bOmittPrefix = false);
 	static FString GetArticyTypeClassname(const UArticyImportData* Data, const bool bOmittPrefix = false);
 	static FString GetArticyLocalizerClassname(const UArticyImportData* Data, const bool bOmittPrefix = false);
@@ -98,6 +99,14 @@ public:
 	 */
 	static bool DeleteExtraCode(const TArray<FString>& GeneratedFiles);
 
+	/**
+	 * @brief Finds generated code files that are not in the provided list.
+	 *
+	 * @param GeneratedFiles A list of prefixes for the generated files to keep.
+	 * @param OutExtraFiles Receives the paths of the header files not matching any prefix.
+	 */
+	static void FindExtraCode(const TArray<FString>& GeneratedFiles, TArray<FString>& OutExtraFiles);
+
 	/**
 	 * @brief Deletes generated assets based on package definitions.
 	 *
@@ -5,6 +5,8 @@
 #include "ExpressoScriptsGenerator.h"
 #include "CodeFileGenerator.h"
 #include "ArticyPluginSettings.h"
+#include "HAL/FileManager.h"
+#include "Internationalization/Regex.h"
 
 /**
  * @brief Generates a method interface for Articy user methods.
@@ -80,7 +82,11 @@ void GenerateUserMethods(CodeFileGenerator* header, const UArticyImportData* Dat
 					{
 						args = FString::Printf(TEXT(", %s"), *method.GetArguments());
 					}
-					header->Line(FString::Printf(TEXT("%s%s::Execute_%s(methodProvider%s);"), *returnOrEmpty, *iClass, *method.BlueprintName, *args));
+					// Native providers are called directly, only Blueprint ones need the reflection thunk
+					header->Line(FString::Printf(TEXT("if(auto nativeProvider = GetNativeUserMethodsProvider<%s>(methodProvider)) %snativeProvider->%s_Implementation(%s);"), *iClass, *returnOrEmpty, *method.BlueprintName, *method.GetArguments()));
+					if (bIsVoid)
+						header->Line("else");
+					header->Line(FString::Printf(TEXT("%s%s%s::Execute_%s(methodProvider%s);"), bIsVoid ? TEXT("\t") : TEXT(""), *returnOrEmpty, *iClass, *method.BlueprintName, *args));
 				}
 				else
 					header->Line(FString::Printf(TEXT("%sCast<%s>(methodProvider)->%s(%s);"), *returnOrEmpty, *iClass, *method.Name, *method.GetArguments()));
@@ -96,23 +102,27 @@ void GenerateUserMethods(CodeFileGenerator* header, const UArticyImportData* Dat
  *
  * @param header The code file generator for creating the expresso scripts.
  * @param Data The import data containing script fragments.
+ * @param Files The fragments of each package source file by file suffix.
  */
-void GenerateExpressoScripts(CodeFileGenerator* header, const UArticyImportData* Data)
+void GenerateExpressoScripts(CodeFileGenerator* header, const UArticyImportData* Data, const TMap<FString, TArray<const FArticyExpressoFragment*>>& Files)
 {
 	header->Line("private:", false, true, -1);
 	header->Line();
 
 	/**
-	 * We define all the GV namespaces as (anonymous) structs again here,
-	 * so expresso scripts can just write things like:
+	 * Expresso scripts write things like
 	 *
 	 *   Namespace.Variable = value;
 	 *
-	 * See declaration of GlobalVariableRef for details.
+	 * which the import turns into Globals->Get<<Project>GlobalVariableSlots::Namespace::Variable>(),
+	 * a single load from the slot table of the global variables.
+	 * The namespaces are kept for fragments generated before the slots existed.
+	 * SetGV is called again whenever the bound global variables change, so plain pointers suffice.
 	 */
 	auto gvTypeName = CodeGenerator::GetGlobalVarsClassname(Data);
 	for (const auto& ns : Data->GetGlobalVars().Namespaces)
-		header->Variable("mutable TWeakObjectPtr<" + ns.CppTypename + ">", ns.Namespace, "nullptr");
+		header->Variable("mutable " + ns.CppTypename + "*", ns.Namespace, "nullptr");
+	header->Variable("mutable " + gvTypeName + "*", "Globals", "nullptr");
 	header->Variable("mutable TWeakObjectPtr<" + gvTypeName + ">", "ActiveGlobals", "nullptr");
 
 	header->Line();
@@ -124,6 +134,7 @@ void GenerateExpressoScripts(CodeFileGenerator* header, const UArticyImportData*
 				header->Line(FString::Printf(TEXT("%s = gv ? gv->%s : nullptr;"), *ns.Namespace, *ns.Namespace));
 
 			header->Comment("Store GVs");
+			header->Line("Globals = gv;");
 			header->Line("ActiveGlobals = gv;");
 		}, "", false, "", "const override");
 
@@ -141,57 +152,202 @@ void GenerateExpressoScripts(CodeFileGenerator* header, const UArticyImportData*
 			header->Line(FString::Printf(TEXT("return %s::StaticClass();"), *CodeGenerator::GetMethodsProviderClassname(Data)));
 		}, "", false, "", "override");
 
+	// Every fragment becomes a specialization of these member templates, defined in the source file of its package
+	// together with a function registering plain function pointers to them in the jump tables of the base class.
+	// The header only changes when packages come and go, so an edit to one package recompiles one source file
+	header->Line();
+	header->Line("template<uint32 Hash>");
+	header->Method("bool", "Condition", "", nullptr);
+	header->Line("template<uint32 Hash>");
+	header->Method("void", "Instruction", "", nullptr);
+
+	header->Line();
+	for (const auto& file : Files)
+		header->Method("void", "RegisterScripts_" + file.Key, "", nullptr);
+
 	header->Line();
 	header->Line("public:", false, true, -1);
 
 	header->Line();
-	// Disable "optimization cannot be applied due to function size" compile error. This error is caused by the huge constructor when all expresso
-	// scripts are added to the collection and this pragma disables the optimizations. 
-	header->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
-	header->Line("#pragma warning(push)");
-	header->Line("#pragma warning(disable: 4883) //<disable \"optimization cannot be applied due to function size\" compile error.");
-	header->Line("#endif");
-	header->Method("", CodeGenerator::GetExpressoScriptsClassname(Data), "", [&]
+	const auto className = CodeGenerator::GetExpressoScriptsClassname(Data);
+	header->Method("", className, "", [&]
+		{
+			for (const auto& file : Files)
+				header->Line(FString::Printf(TEXT("RegisterScripts_%s();"), *file.Key));
+		});
+}
+
+/**
+ * @brief Checks if a fragment refers to the object it runs on, so the exploration has to bind it first.
+ *
+ * Besides self and speaker, the seen counter helpers default to self. A match inside a string literal only
+ * costs the binding, a missed reference would read a stale object, so the check errs on the side of binding.
+ *
+ * @param ParsedFragment The parsed code of the fragment.
+ * @return True if the fragment needs self and speaker bound.
+ */
+bool UsesCurrentObject(const FString& ParsedFragment)
+{
+	static const FRegexPattern currentObjectPattern(TEXT("\\b(self|speaker|getSeenCounter|setSeenCounter)\\b"));
+	FRegexMatcher matcher(currentObjectPattern, ParsedFragment);
+	return matcher.FindNext();
+}
+
+/**
+ * @brief Generates the source file with the script fragments of one package.
+ *
+ * @param Data The import data containing script fragments.
+ * @param Suffix The suffix of the file and its registration function.
+ * @param Fragments The fragments of the package, sorted by hash.
+ * @return The filename of the generated source file.
+ */
+FString GenerateExpressoScriptsFile(const UArticyImportData* Data, const FString& Suffix, const TArray<const FArticyExpressoFragment*>& Fragments)
+{
+	const auto className = CodeGenerator::GetExpressoScriptsClassname(Data);
+	const FString filename = CodeGenerator::GetExpressoScriptsClassname(Data, true) + "_" + Suffix + ".cpp";
+
+	CodeFileGenerator(filename, false, [&](CodeFileGenerator* source)
 		{
-			const auto& fragments = Data->GetScriptFragments();
-			for (auto& script : fragments)
+			source->Line("#include \"" + ExpressoScriptsGenerator::GetFilename(Data) + "\"");
+
+			for (const auto* script : Fragments)
 			{
-				if (script.OriginalFragment.IsEmpty())
+				// Shared fragments only get registered, under the function of the fragment with the same code, constant ones with their result
+				if (!script->SharedFragment.IsEmpty() || script->bIsConstant)
 					continue;
 
+				const uint32 cleanScriptHash = GetTypeHash(script->OriginalFragment);
 
-				int cleanScriptHash = GetTypeHash(script.OriginalFragment);
-
-				if (script.bIsInstruction)
+				source->Line();
+				if (script->bIsInstruction)
 				{
-					header->Line(FString::Printf(TEXT("Instructions.Add(%d, [&]"), cleanScriptHash));
-					header->Line("{");
-					{
-						header->Line(script.ParsedFragment, false, true, 1);
-					}
-					header->Line("});");
+					source->Line("template<>");
+					source->Method("void", FString::Printf(TEXT("%s::Instruction<%uu>"), *className, cleanScriptHash), "", [&]
+						{
+							source->Line(script->ParsedFragment, false, true, 0);
+						});
 				}
 				else
 				{
-					header->Line(FString::Printf(TEXT("Conditions.Add(%d, [&]"), cleanScriptHash));
-					header->Line("{");
-					{
-						// The fragment might be empty or contain only a comment, so we need to wrap it in
-						// the ConditionOrTrue method
-						header->Line("return ConditionOrTrue(", false, true, 1);
-						// Now comes the fragment (in next line and indented)
-						header->Line(script.ParsedFragment, false, true, 2);
-						// Make sure there is a final semicolon
-						// We put it into the next line, since the fragment might contain a line-comment
-						header->Line(");", false, true, 1);
-					}
-					header->Line("});");
+					source->Line("template<>");
+					source->Method("bool", FString::Printf(TEXT("%s::Condition<%uu>"), *className, cleanScriptHash), "", [&]
+						{
+							// The fragment might be empty or contain only a comment, so we need to wrap it in
+							// the ConditionOrTrue method
+							source->Line("return ConditionOrTrue(");
+							// Now comes the fragment (in next line and indented)
+							source->Line(script->ParsedFragment, false, true, 1);
+							// Make sure there is a final semicolon
+							// We put it into the next line, since the fragment might contain a line-comment
+							source->Line(");");
+						});
 				}
 			}
+
+			source->Line();
+			// Disable "optimization cannot be applied due to function size" compile error, caused by packages with many scripts
+			source->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
+			source->Line("#pragma warning(push)");
+			source->Line("#pragma warning(disable: 4883) //<disable \"optimization cannot be applied due to function size\" compile error.");
+			source->Line("#endif");
+			source->Method("void", className + "::RegisterScripts_" + Suffix, "", [&]
+				{
+					for (const auto* script : Fragments)
+					{
+						const uint32 cleanScriptHash = GetTypeHash(script->OriginalFragment);
+
+						if (!script->SharedFragment.IsEmpty())
+						{
+							// The other fragment may be registered by another file, so it is resolved on lookup
+							source->Line(FString::Printf(TEXT("%s(%d, %d);"), script->bIsInstruction ? TEXT("AddInstructionAlias") : TEXT("AddConditionAlias"),
+								static_cast<int32>(cleanScriptHash), static_cast<int32>(GetTypeHash(script->SharedFragment))));
+						}
+						else if (script->bIsConstant)
+						{
+							source->Line(script->bIsInstruction
+								? FString::Printf(TEXT("AddInstruction(%d, [](UArticyExpressoScripts*) {}, false);"), static_cast<int32>(cleanScriptHash))
+								: FString::Printf(TEXT("AddCondition(%d, [](UArticyExpressoScripts*) { return %s; }, false);"), static_cast<int32>(cleanScriptHash),
+									script->bConstantResult ? TEXT("true") : TEXT("false")));
+						}
+						else if (script->bIsInstruction)
+						{
+							source->Line(FString::Printf(TEXT("AddInstruction(%d, [](UArticyExpressoScripts* Scripts) { static_cast<%s*>(Scripts)->Instruction<%uu>(); }, %s);"),
+								static_cast<int32>(cleanScriptHash), *className, cleanScriptHash, UsesCurrentObject(script->ParsedFragment) ? TEXT("true") : TEXT("false")));
+						}
+						else
+						{
+							source->Line(FString::Printf(TEXT("AddCondition(%d, [](UArticyExpressoScripts* Scripts) { return static_cast<%s*>(Scripts)->Condition<%uu>(); }, %s);"),
+								static_cast<int32>(cleanScriptHash), *className, cleanScriptHash, UsesCurrentObject(script->ParsedFragment) ? TEXT("true") : TEXT("false")));
+						}
+					}
+				});
+			source->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
+			source->Line("#pragma warning(pop)");
+			source->Line("#endif");
 		});
-	header->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
-	header->Line("#pragma warning(pop)");
-	header->Line("#endif");
+
+	return filename;
+}
+
+/**
+ * @brief Groups the script fragments by the package they were gathered from, splitting big packages into shards.
+ *
+ * @param Data The import data containing script fragments.
+ * @return The fragments of each source file by file suffix, sorted by hash so files only change with their scripts.
+ */
+TMap<FString, TArray<const FArticyExpressoFragment*>> GroupExpressoScripts(const UArticyImportData* Data)
+{
+	TMap<FString, TArray<const FArticyExpressoFragment*>> files;
+	if (!Data->GetSettings().set_UseScriptSupport)
+		return files;
+
+	for (const auto& script : Data->GetScriptFragments())
+	{
+		if (script.OriginalFragment.IsEmpty())
+			continue;
+
+		// A valid identifier for the registration function
+		FString suffix = script.PackageName.IsEmpty() ? TEXT("Shared") : script.PackageName;
+		for (TCHAR& c : suffix)
+		{
+			if (!FChar::IsAlnum(c) && c != TEXT('_'))
+				c = TEXT('_');
+		}
+		files.FindOrAdd(suffix).Add(&script);
+	}
+
+	// Split big packages into shards by hash, so a new fragment only changes the shard it falls into
+	const int32 maxFragmentsPerFile = FMath::Max(1, UArticyPluginSettings::Get()->MaxScriptFragmentsPerFile);
+	TMap<FString, TArray<const FArticyExpressoFragment*>> shardedFiles;
+	for (auto& file : files)
+	{
+		if (file.Value.Num() <= maxFragmentsPerFile)
+		{
+			shardedFiles.Add(file.Key, MoveTemp(file.Value));
+			continue;
+		}
+
+		const uint32 numShards = FMath::RoundUpToPowerOfTwo(FMath::DivideAndRoundUp(file.Value.Num(), maxFragmentsPerFile));
+		for (const auto* script : file.Value)
+		{
+			const uint32 shard = GetTypeHash(script->OriginalFragment) & (numShards - 1);
+			shardedFiles.FindOrAdd(FString::Printf(TEXT("%s_%u"), *file.Key, shard)).Add(script);
+		}
+	}
+	files = MoveTemp(shardedFiles);
+
+	for (auto& file : files)
+	{
+		file.Value.Sort([](const FArticyExpressoFragment& A, const FArticyExpressoFragment& B)
+			{
+				const uint32 hashA = GetTypeHash(A.OriginalFragment);
+				const uint32 hashB = GetTypeHash(B.OriginalFragment);
+				return hashA != hashB ? hashA < hashB : A.bIsInstruction < B.bIsInstruction;
+			});
+	}
+	files.KeySort(TLess<FString>());
+
+	return files;
 }
 
 /**
@@ -208,6 +364,8 @@ void ExpressoScriptsGenerator::GenerateCode(const UArticyImportData* Data, FStri
 	// (if true, we use a different naming to allow something like overloaded functions)
 	bool bCreateBlueprintableUserMethods = UArticyPluginSettings::Get()->bCreateBlueprintTypeForScriptMethods;
 
+	const auto files = GroupExpressoScripts(Data);
+
 	const auto& filename = GetFilename(Data);
 	CodeFileGenerator(filename, true, [&](CodeFileGenerator* header)
 		{
@@ -234,14 +392,40 @@ void ExpressoScriptsGenerator::GenerateCode(const UArticyImportData* Data, FStri
 
 						header->Line();
 
-						GenerateExpressoScripts(header, Data);
+						GenerateExpressoScripts(header, Data, files);
 					}
 
 				}, "BlueprintType, Blueprintable");
 		});
+
+	// Files are only written if their content changed, so unchanged packages don't recompile
+	TSet<FString> sourceFiles;
+	for (const auto& file : files)
+		sourceFiles.Add(GenerateExpressoScriptsFile(Data, file.Key, file.Value));
+	DeleteStaleFiles(Data, sourceFiles);
+
 	OutFile = filename.Replace(TEXT(".h"), TEXT(""));
 }
 
+/**
+ * @brief Deletes the source files of packages that no longer have scripts.
+ *
+ * @param Data The import data used for filename generation.
+ * @param SourceFiles The source files generated on this import.
+ */
+void ExpressoScriptsGenerator::DeleteStaleFiles(const UArticyImportData* Data, const TSet<FString>& SourceFiles)
+{
+	const FString prefix = CodeGenerator::GetExpressoScriptsClassname(Data, true) + "_";
+
+	TArray<FString> existingFiles;
+	IFileManager::Get().FindFiles(existingFiles, *(CodeGenerator::GetSourceFolder() / (prefix + "*.cpp")), true, false);
+	for (const auto& existingFile : existingFiles)
+	{
+		if (!SourceFiles.Contains(existingFile))
+			CodeGenerator::DeleteGeneratedCode(existingFile);
+	}
+}
+
 /**
  * @brief Returns the filename of the generated expresso scripts class (with extension).
  *
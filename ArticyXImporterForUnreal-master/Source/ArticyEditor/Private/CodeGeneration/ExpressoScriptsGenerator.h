@@ -17,6 +17,7 @@ public:
 	 * @brief Generates code for the Articy expresso scripts class.
 	 *
 	 * Manages the code generation process for the expresso scripts, including user methods and global variables.
+	 * The script fragments of each package go into a source file of their own.
 	 *
 	 * @param Data The import data used for code generation.
 	 * @param OutFile The output filename for the generated code.
@@ -32,4 +33,13 @@ public:
 	 * @return The filename of the generated expresso scripts class.
 	 */
 	static FString GetFilename(const UArticyImportData* Data);
+
+private:
+	/**
+	 * @brief Deletes the source files of packages that no longer have scripts.
+	 *
+	 * @param Data The import data used for filename generation.
+	 * @param SourceFiles The source files generated on this import.
+	 */
+	static void DeleteStaleFiles(const UArticyImportData* Data, const TSet<FString>& SourceFiles);
 };
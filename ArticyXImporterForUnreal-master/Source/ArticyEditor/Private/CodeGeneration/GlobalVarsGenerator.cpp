@@ -71,12 +71,35 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 									header->Line(FString::Printf(TEXT("%s->Init<%s>(this, Store, TEXT(\"%s.%s\"), %s);"), *var.Variable, *var.GetCPPTypeString(), *ns.Namespace, *var.Variable, *var.GetCPPValueString()));
 									header->Line(FString::Printf(TEXT("this->Variables.Add(%s);"), *var.Variable));
 								}
+
+								header->Line();
+								header->Line(TEXT("IndexVariables();"));
 							});
 					});
 			}
 
 			header->Line();
 
+			// Generate a slot per variable, its index in the slot table of the UArticyGlobalVariables class.
+			// Slots are aliases instead of structs, so variables may be named like their namespace
+			int32 numSlots = 0;
+			header->Comment(TEXT("Global variable slots for compile time access, e.g. GV->Get<Namespace::Variable>()"));
+			header->Line(TEXT("namespace ") + CodeGenerator::GetGVSlotsNamespace(Data));
+			header->Block(true, [&]
+				{
+					for (const auto& ns : Data->GetGlobalVars().Namespaces)
+					{
+						header->Line(TEXT("namespace ") + ns.Namespace);
+						header->Block(true, [&]
+							{
+								for (const FArticyGVar& var : ns.Variables)
+									header->Line(FString::Printf(TEXT("using %s = TArticyGvSlot<%s, %d>;"), *var.Variable, *var.GetCPPTypeString(), numSlots++));
+							});
+					}
+				});
+
+			header->Line();
+
 			// Now generate the UArticyGlobalVariables class
 			const auto& type = CodeGenerator::GetGlobalVarsClassname(Data, false);
 			header->Class(type + " : public UArticyGlobalVariables", TEXT("Global Articy Variables"), true, [&]
@@ -93,6 +116,16 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 					//---------------------------------------------------------------------------//
 					header->Line();
 
+					header->Comment(TEXT("Get the variable of a slot in ") + CodeGenerator::GetGVSlotsNamespace(Data) + TEXT(", without looking up its namespace."));
+					header->Line(TEXT("template<typename Slot>"));
+					header->Method(TEXT("FORCEINLINE typename Slot::VariableType&"), TEXT("Get"), TEXT(""), [&]
+						{
+							header->Line(TEXT("return *static_cast<typename Slot::VariableType*>(SlotVariables[Slot::Index]);"));
+						}, TEXT(""), false, TEXT(""), TEXT("const"));
+
+					//---------------------------------------------------------------------------//
+					header->Line();
+
 					header->Method(TEXT(""), type, TEXT(""), [&]
 						{
 							header->Comment(TEXT("create the namespaces"));
@@ -114,6 +147,15 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 								header->Line(FString::Printf(TEXT("%s->Init(this);"), *ns.Namespace));
 								header->Line(FString::Printf(TEXT("this->VariableSets.Add(%s);"), *ns.Namespace));
 							}
+
+							header->Line();
+							header->Comment(TEXT("fill the slot table, in the order of GetAllVariables"));
+							int32 slot = 0;
+							for (const auto& ns : Data->GetGlobalVars().Namespaces)
+							{
+								for (const auto& var : ns.Variables)
+									header->Line(FString::Printf(TEXT("SlotVariables[%d] = %s->%s;"), slot++, *ns.Namespace, *var.Variable));
+							}
 						});
 
 					//---------------------------------------------------------------------------//
@@ -124,6 +166,13 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 							header->Line(TEXT("return static_cast<") + type + TEXT("*>(UArticyGlobalVariables::GetDefault(WorldContext));"));
 						}, TEXT("Get the default GlobalVariables (a copy of the asset)."), true,
 							TEXT("BlueprintPure, Category=\"ArticyGlobalVariables\", meta=(HidePin=\"WorldContext\", DefaultToSelf=\"WorldContext\", DisplayName=\"GetArticyGV\", keywords=\"global variables\")"));
+
+					//---------------------------------------------------------------------------//
+					header->Line();
+
+					// The variables are kept alive by their namespaces, by slot for Get
+					header->Line("private:", false, true, -1);
+					header->Variable(TEXT("UArticyVariable*"), FString::Printf(TEXT("SlotVariables[%d]"), FMath::Max(numSlots, 1)), TEXT("{}"));
 				});
 
 			header->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
@@ -13,12 +13,13 @@
  * This function creates new Articy package objects based on the definitions in the import data.
  *
  * @param Data The import data used for asset generation.
+ * @param Saver Saves each package once it is finished, the packages are saved with the other assets if null.
  */
-void PackagesGenerator::GenerateAssets(UArticyImportData* Data)
+void PackagesGenerator::GenerateAssets(UArticyImportData* Data, FArticyPackageSaver* Saver)
 {
 	// Generate new Articy objects
 	const auto& ArticyPackageDefs = Data->GetPackageDefs();
-	ArticyPackageDefs.GenerateAssets(Data);
+	ArticyPackageDefs.GenerateAssets(Data, Saver);
 }
 
 #undef LOCTEXT_NAMESPACE
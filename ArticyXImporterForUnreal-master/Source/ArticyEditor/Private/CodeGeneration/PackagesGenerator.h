@@ -17,8 +17,9 @@ public:
 	 * Creates new Articy package objects based on the definitions in the import data.
 	 *
 	 * @param Data The import data used for asset generation.
+	 * @param Saver Saves each package once it is finished, the packages are saved with the other assets if null.
 	 */
-	static void GenerateAssets(class UArticyImportData* Data);
+	static void GenerateAssets(class UArticyImportData* Data, class FArticyPackageSaver* Saver = nullptr);
 
 private:
 	PackagesGenerator() {}
@@ -10,6 +10,7 @@
 #include "ArticyEditorModule.h"
 #include "DetailLayoutBuilder.h"
 #include "Widgets/Layout/SSplitter.h"
+#include "Widgets/Layout/SBox.h"
 #include "Slate/GV/SArticyGlobalVariablesDebugger.h"
 #include "Runtime/Launch/Resources/Version.h"
 
@@ -50,9 +51,14 @@ void FArticyGVCustomization::CustomizeDetails(IDetailLayoutBuilder& DetailBuilde
 	}
 
 	FDetailWidgetRow& Row = CategoryBuilder.AddCustomRow(FText::FromString(TEXT("Articy")));
+	// the variables are a virtualized tree, which needs a bounded height within the details panel
 	Row.WholeRowWidget
 		[
-			SNew(SArticyGlobalVariables, GV).bInitiallyCollapsed(true)
+			SNew(SBox)
+				.MaxDesiredHeight(600.f)
+				[
+					SNew(SArticyGlobalVariables, GV).bInitiallyCollapsed(true)
+				]
 		];
 
 	//// retrieve the propertyhandles for the properties in the class (which are variablesets), and create widgets for them
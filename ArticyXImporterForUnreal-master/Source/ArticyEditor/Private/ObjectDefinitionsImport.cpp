@@ -13,6 +13,9 @@
 #include "ArticyScriptFragment.h"
 #include "ArticyEntity.h"
 #include "JsonObjectConverter.h"
+#include "Hash/CityHash.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonSerializer.h"
 #include "UObject/ConstructorHelpers.h"
 
 //---------------------------------------------------------------------------//
@@ -85,24 +88,19 @@ void FArticyTemplateDef::GatherScripts(const TSharedPtr<FJsonObject> Values, UAr
 }
 
 /**
- * Initializes a model with data from JSON values.
+ * Bakes the steps creating the template's features on models.
  *
- * @param Model A pointer to the UArticyPrimitive object.
- * @param Path The path of the model.
- * @param Values A shared pointer to the JSON object containing the values.
+ * @param Step The step of the definition owning the template.
  * @param Data A pointer to the UArticyImportData object.
- * @param PackageName The name of the package.
  */
-void FArticyTemplateDef::InitializeModel(UArticyPrimitive* Model, const FString& Path, const TSharedPtr<FJsonObject> Values, const UArticyImportData* Data, const FString& PackageName) const
+void FArticyTemplateDef::BakeInitializerSteps(FArticyModelInitializer::FDefinitionStep& Step, const UArticyImportData* Data) const
 {
+    Step.Features.Reset(Features.Num());
     for (const auto& feat : Features)
-    {
-        static const TSharedPtr<FJsonObject>* featureJson;
-        if (Values->TryGetObjectField(feat.GetTechnicalName(), featureJson))
-            feat.InitializeModel(Model, Path, *featureJson, Data, PackageName);
-    }
+        Step.Features.Add(feat.BakeInitializerStep(Data));
 
-    Model->ArticyType.MergeChild(ArticyType);
+    Step.bHasTemplate = !DisplayName.IsEmpty();
+    Step.TemplateType = &ArticyType;
 }
 
 //---------------------------------------------------------------------------//
@@ -267,18 +265,12 @@ void FArticyObjectDef::GatherScripts(const FArticyModelDef& Vals, UArticyImportD
 }
 
 /**
- * Initializes a model with data from the model definition.
+ * Bakes the steps of this definition and its parents, parents first.
  *
- * @param Model A pointer to the UArticyPrimitive object.
- * @param Vals The model definition containing the values.
+ * @param Initializer The initializer to add the steps to.
  * @param Data A pointer to the UArticyImportData object.
- * @param PackageName The name of the package.
  */
-void FArticyObjectDef::InitializeModel(
-    UArticyPrimitive* Model,
-    const FArticyModelDef& Vals,
-    const UArticyImportData* Data,
-    const FString& PackageName) const
+void FArticyObjectDef::BakeInitializer(FArticyModelInitializer& Initializer, const UArticyImportData* Data) const
 {
     if (DefType == EObjectDefType::Enum)
     {
@@ -292,33 +284,20 @@ void FArticyObjectDef::InitializeModel(
         //initialize parent-class data first
         auto parentDef = Data->GetObjectDefs().GetTypes().Find(Class);
         if (parentDef)
-            parentDef->InitializeModel(Model, Vals, Data, PackageName);
+            parentDef->BakeInitializer(Initializer, Data);
     }
 
+    auto& step = Initializer.Definitions.AddDefaulted_GetRef();
+    step.Properties.Reserve(Properties.Num());
+    for (const auto& prop : Properties)
     {
-        //try setting the "meta" data (not stored in the properties array)
-        const auto& AssetRef = FName{ TEXT("AssetRef") };
-        const auto& Category = FName{ TEXT("Category") };
-        Model->SetProp(AssetRef, Vals.GetAssetRef());
-        Model->SetProp(Category, Vals.GetAssetCat());
+        FArticyModelInitializer::FPropertyStep propStep;
+        if (prop.BakeInitializerStep(propStep))
+            step.Properties.Add(MoveTemp(propStep));
     }
 
-    const auto& nameAndId = Vals.GetNameAndId();
-
-    //set all properties
-    auto propertiesJson = Vals.GetPropertiesJson();
-    //then set the rest of the properties
-    for (const auto& prop : Properties)
-        prop.InitializeModel(Model, nameAndId, propertiesJson, Data, PackageName);
-
-    //set the features (if this is a template)
-    auto featuresJson = Vals.GetTemplatesJson();
-    if (featuresJson.IsValid())
-        Template.InitializeModel(Model, nameAndId, featuresJson, Data, PackageName);
-    else
-        ensure(Template.GetDisplayName().IsEmpty());
-
-    Model->ArticyType.MergeChild(ArticyType);
+    Template.BakeInitializerSteps(step, Data);
+    step.ArticyType = &ArticyType;
 }
 
 /**
@@ -537,30 +516,25 @@ void FArticyPropertyDef::GatherScript(const TSharedPtr<FJsonObject>& JsonObject,
 }
 
 /**
- * Initializes a model with data from JSON.
+ * Bakes the step setting this property on models.
  *
- * @param Model A pointer to the UArticyBaseObject.
- * @param Path The path of the model.
- * @param JsonObject A shared pointer to the JSON object containing the data.
- * @param Data A pointer to the UArticyImportData object.
- * @param PackageName The name of the package.
+ * @param OutStep The step to fill.
+ * @return False if the property's type has no setter.
  */
-void FArticyPropertyDef::InitializeModel(
-    UArticyBaseObject* Model,
-    const FString& Path,
-    const TSharedPtr<FJsonObject>& JsonObject,
-    const UArticyImportData* Data,
-    const FString& PackageName) const
+bool FArticyPropertyDef::BakeInitializerStep(FArticyModelInitializer::FPropertyStep& OutStep) const
 {
-    auto jsonValue = JsonObject.IsValid() ? JsonObject->TryGetField(Property.ToString()) : nullptr;
-
-    //property may not be contained in values
-    if (!jsonValue.IsValid() || jsonValue->IsNull())
-        return;
-
-    FArticyObjectDefinitions::SetProp(ItemType.IsNone() ? Type : ItemType, GetPropetyName(), Model, Path + "." + Property.ToString(), jsonValue, PackageName);
-
-    Model->ArticyType.MergeParent(ArticyType);
+    auto typePtr = FArticyPredefTypes::Get().Find(ItemType.IsNone() ? Type : ItemType);
+    //if it's not a predefined type, it must be an enum - or an error ;)
+    auto type = typePtr ? *typePtr : FArticyPredefTypes::GetEnum();
+    if (!ensure(type))
+        return false;
+
+    OutStep.Key = Property.ToString();
+    OutStep.PathSuffix = TEXT(".") + OutStep.Key;
+    OutStep.Property = GetPropetyName();
+    OutStep.Setter = type;
+    OutStep.ArticyType = &ArticyType;
+    return true;
 }
 
 /**
@@ -720,30 +694,29 @@ void FArticyTemplateFeatureDef::GatherScripts(const TSharedPtr<FJsonObject>& Jso
 }
 
 /**
- * Initializes a model with data from JSON.
+ * Bakes the step creating this feature on models and setting its properties.
  *
- * @param Model A pointer to the UArticyPrimitive object.
- * @param Path The path of the model.
- * @param Json A shared pointer to the JSON object containing the data.
  * @param Data A pointer to the UArticyImportData object.
- * @param PackageName The name of the package.
+ * @return The baked step.
  */
-void FArticyTemplateFeatureDef::InitializeModel(
-    UArticyPrimitive* Model,
-    const FString& Path,
-    const TSharedPtr<FJsonObject>& Json,
-    const UArticyImportData* Data,
-    const FString& PackageName) const
+FArticyModelInitializer::FFeatureStep FArticyTemplateFeatureDef::BakeInitializerStep(const UArticyImportData* Data) const
 {
-    //create new instance of the feature
-    auto feature = NewObject<UArticyBaseFeature>(Model, GetUClass(Data));
-    Model->SetProp(*TechnicalName, feature);
-
-    const auto& path = Path + "." + *TechnicalName;
+    FArticyModelInitializer::FFeatureStep step;
+    step.TechnicalName = TechnicalName;
+    step.PathSuffix = TEXT(".") + TechnicalName;
+    step.Property = *TechnicalName;
+    step.Class = GetUClass(Data);
+    step.ArticyType = &ArticyType;
+
+    step.Properties.Reserve(Properties.Num());
     for (const auto& prop : Properties)
-        prop.InitializeModel(feature, path, Json, Data, PackageName);
+    {
+        FArticyModelInitializer::FPropertyStep propStep;
+        if (prop.BakeInitializerStep(propStep))
+            step.Properties.Add(MoveTemp(propStep));
+    }
 
-    Model->ArticyType.MergeChild(ArticyType);
+    return step;
 }
 
 /**
@@ -782,23 +755,45 @@ FString FArticyTemplateFeatureDef::GetCppType(const UArticyImportData* Data, boo
  * @param Json A pointer to the array of JSON values containing the object definitions.
  * @param Data A pointer to the UArticyImportData object.
  */
-void FArticyObjectDefinitions::ImportFromJson(const TArray<TSharedPtr<FJsonValue>>* Json, const UArticyImportData* Data)
+bool FArticyObjectDefinitions::ImportFromJson(const TArray<TSharedPtr<FJsonValue>>* Json, const UArticyImportData* Data)
 {
+    // Definitions are taken over from here if their JSON did not change
+    TMap<FName, FArticyObjectDef> PreviousTypes = MoveTemp(Types);
     Types.Reset();
     FeatureTypes.Reset();
     FeatureDefs.Reset();
 
     if (!Json)
-        return;
+        return PreviousTypes.Num() > 0;
 
+    bool bChanged = false;
+    int32 NumKept = 0;
     for (const auto& type : *Json)
     {
         const auto& obj = type->AsObject();
         if (!obj.IsValid())
             continue;
 
+        FString json;
+        const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&json);
+        FJsonSerializer::Serialize(obj.ToSharedRef(), writer);
+        // The generated C++ types are named after the project as well
+        json += Data->GetProject().TechnicalName;
+        const FString hash = FString::Printf(TEXT("%016llx"), CityHash64(reinterpret_cast<const char*>(*json), json.Len() * sizeof(TCHAR)));
+
         FArticyObjectDef def;
-        def.ImportFromJson(obj, Data);
+        FArticyObjectDef* previous = PreviousTypes.Find(FName(*obj->GetStringField(TEXT("Type"))));
+        if (previous && previous->GetDefinitionHash() == hash)
+        {
+            def = MoveTemp(*previous);
+            ++NumKept;
+        }
+        else
+        {
+            def.ImportFromJson(obj, Data);
+            def.SetDefinitionHash(hash);
+            bChanged = true;
+        }
         Types.Add(def.GetOriginalType(), def);
 
         for (auto& feature : def.GetFeatures())
@@ -808,6 +803,12 @@ void FArticyObjectDefinitions::ImportFromJson(const TArray<TSharedPtr<FJsonValue
                 FeatureDefs.Add(key, feature);
         }
     }
+
+    // Every previous definition that was not kept was changed or removed
+    bChanged |= NumKept != PreviousTypes.Num();
+
+    UE_LOG(LogArticyEditor, Log, TEXT("Imported %d object definitions, kept %d unchanged ones."), Types.Num() - NumKept, NumKept);
+    return bChanged;
 }
 
 /**
@@ -859,15 +860,146 @@ void FArticyObjectDefinitions::InitializeModel(
     const UArticyImportData* Data,
     const FString& PackageName) const
 {
-    auto def = Types.Find(Values.GetType());
-    if (ensure(def))
-        def->InitializeModel(Model, Values, Data, PackageName);
+    auto initializer = GetModelInitializer(Values.GetType(), Data);
+    if (ensure(initializer))
+        initializer->Initialize(Model, Values, PackageName);
     else
     {
         UE_LOG(LogArticyEditor, Error, TEXT("Model type %s for Model %s not found in definitions!"), *Values.GetType().ToString(), *Values.GetTechnicalName());
     }
 }
 
+/**
+ * Returns the initializer of a type's models, baking it on first use.
+ *
+ * @param OriginalType The type of the models.
+ * @param Data A pointer to the UArticyImportData object.
+ * @return The initializer, null if the type is not defined.
+ */
+const FArticyModelInitializer* FArticyObjectDefinitions::GetModelInitializer(const FName& OriginalType, const UArticyImportData* Data) const
+{
+    if (const auto* baked = ModelInitializers.Find(OriginalType))
+        return baked->Get();
+
+    // Undefined types are remembered too, so they are only looked up once
+    auto& initializer = ModelInitializers.Add(OriginalType);
+    auto def = Types.Find(OriginalType);
+    if (!def)
+        return nullptr;
+
+    initializer = MakeShared<FArticyModelInitializer>();
+    def->BakeInitializer(*initializer, Data);
+
+    // The class is found by taking the CPP name and removing the first character
+    initializer->ClassName = GetCppType(OriginalType, Data, false);
+    initializer->ClassName.RemoveAt(0);
+    auto fullClassName = FString::Printf(TEXT("Class'/Script/%s.%s'"), FApp::GetProjectName(), *initializer->ClassName);
+    initializer->Class = ConstructorHelpersInternal::FindOrLoadClass(fullClassName, UArticyObject::StaticClass());
+
+    return initializer.Get();
+}
+
+/**
+ * Frees the baked initializers, they point into the definitions and the generated classes, which change with the next import.
+ */
+void FArticyObjectDefinitions::ResetModelInitializers() const
+{
+    ModelInitializers.Empty();
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Initializes a model with data from the model definition.
+ *
+ * @param Model A pointer to the UArticyPrimitive object.
+ * @param Values The model definition containing the values.
+ * @param PackageName The name of the package.
+ */
+void FArticyModelInitializer::Initialize(UArticyPrimitive* Model, const FArticyModelDef& Values, const FString& PackageName) const
+{
+    if (Definitions.Num() == 0)
+        return;
+
+    {
+        //try setting the "meta" data (not stored in the properties array)
+        static const FName AssetRef = TEXT("AssetRef");
+        static const FName Category = TEXT("Category");
+        Model->SetProp(AssetRef, Values.GetAssetRef());
+        Model->SetProp(Category, Values.GetAssetCat());
+    }
+
+    const auto& nameAndId = Values.GetNameAndId();
+    const auto propertiesJson = Values.GetPropertiesJson();
+    const auto featuresJson = Values.GetTemplatesJson();
+
+    for (const auto& definition : Definitions)
+    {
+        SetProperties(Model, definition.Properties, nameAndId, propertiesJson, PackageName);
+
+        //set the features (if this is a template)
+        if (featuresJson.IsValid())
+        {
+            for (const auto& feature : definition.Features)
+            {
+                const TSharedPtr<FJsonObject>* featureJson;
+                if (!feature.Class || !featuresJson->TryGetObjectField(feature.TechnicalName, featureJson))
+                    continue;
+
+                //create new instance of the feature
+                auto instance = NewObject<UArticyBaseFeature>(Model, feature.Class);
+                Model->SetProp(feature.Property, instance);
+                SetProperties(instance, feature.Properties, nameAndId + feature.PathSuffix, *featureJson, PackageName);
+
+                Model->ArticyType.MergeChild(*feature.ArticyType);
+            }
+
+            Model->ArticyType.MergeChild(*definition.TemplateType);
+        }
+        else
+            ensure(!definition.bHasTemplate);
+
+        Model->ArticyType.MergeChild(*definition.ArticyType);
+    }
+}
+
+/**
+ * Sets the properties that have a value in a JSON object.
+ *
+ * @param Model A pointer to the model or feature.
+ * @param Properties The steps of the properties to set.
+ * @param Path The path of the model or feature.
+ * @param Json A shared pointer to the JSON object containing the values.
+ * @param PackageName The name of the package.
+ */
+void FArticyModelInitializer::SetProperties(UArticyBaseObject* Model, TConstArrayView<FPropertyStep> Properties, const FString& Path, const TSharedPtr<FJsonObject>& Json, const FString& PackageName)
+{
+    if (!Json.IsValid())
+        return;
+
+    FString propertyPath;
+    for (const auto& step : Properties)
+    {
+        auto jsonValue = Json->TryGetField(step.Key);
+
+        //property may not be contained in values
+        if (!jsonValue.IsValid() || jsonValue->IsNull())
+            continue;
+
+        propertyPath.Reset(Path.Len() + step.PathSuffix.Len());
+        propertyPath += Path;
+        propertyPath += step.PathSuffix;
+
+        const TArray<TSharedPtr<FJsonValue>>* jArray;
+        if (jsonValue->TryGetArray(jArray))
+            step.Setter->SetArray(step.Property, Model, propertyPath, *jArray, PackageName);
+        else
+            step.Setter->SetProp(step.Property, Model, propertyPath, jsonValue, PackageName);
+
+        Model->ArticyType.MergeParent(*step.ArticyType);
+    }
+}
+
 /**
  * Returns the C++ type of an object definition.
  *
@@ -6,6 +6,7 @@
 #include "ArticyEditorModule.h"
 #include "ArticyImporterHelpers.h"
 #include "ArticyImportData.h"
+#include "ArticyImportStats.h"
 #include "CodeGeneration/CodeGenerator.h"
 #include "ArticyObject.h"
 #include "Policies/CondensedJsonPrintPolicy.h"
@@ -14,9 +15,11 @@
 #include "Misc/Paths.h"
 #include "Misc/App.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Async/ParallelFor.h"
 #include <string>
 
 #include "ArticyArchiveReader.h"
+#include "ArticyPackageSaver.h"
 #include "ArticyPluginSettings.h"
 
 #define STRINGIFY(x) #x
@@ -84,21 +87,16 @@ void FArticyModelDef::GatherScripts(UArticyImportData* Data) const
  */
 UArticyObject* FArticyModelDef::GenerateSubAsset(const UArticyImportData* Data, UObject* Outer) const
 {
-	// The class is found by taking the CPP name and removing the first character
-	auto className = Data->GetObjectDefs().GetCppType(Type, Data, false);
-	className.RemoveAt(0);
-
-	// Generate the asset
-	auto fullClassName = FString::Printf(TEXT("Class'/Script/%s.%s'"), FApp::GetProjectName(), *className);
-	auto uclass = ConstructorHelpersInternal::FindOrLoadClass(fullClassName, UArticyObject::StaticClass());
-	if (uclass)
+	// The class and the initialization steps are found once per type
+	const FArticyModelInitializer* initializer = Data->GetObjectDefs().GetModelInitializer(Type, Data);
+	if (initializer && initializer->Class)
 	{
-		auto obj = ArticyImporterHelpers::GenerateSubAsset<UArticyObject>(*className, FApp::GetProjectName(), GetNameAndId(), Outer);
-		FAssetRegistryModule::AssetCreated(Cast<UObject>(obj));
+		// Generate the asset
+		auto obj = ArticyImporterHelpers::GenerateSubAsset<UArticyObject>(initializer->Class, GetNameAndId().IsEmpty() ? initializer->ClassName : GetNameAndId(), Outer);
 		if (ensure(obj))
 		{
 			obj->Initialize();
-			Data->GetObjectDefs().InitializeModel(obj, *this, Data, Outer->GetName());
+			initializer->Initialize(obj, *this, Outer->GetName());
 
 			// SAVE!!
 			obj->MarkPackageDirty();
@@ -174,13 +172,7 @@ EArticyAssetCategory FArticyModelDef::GetAssetCategoryFromString(const FString C
  */
 void FArticyPackageDef::ImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject>& JsonPackage)
 {
-	if (!JsonPackage.IsValid())
-		return;
-
-	JSON_TRY_HEX_ID(JsonPackage, Id);
-	JSON_TRY_BOOL(JsonPackage, IsIncluded);
-
-	if (!IsIncluded)
+	if (!ImportInfoFromJson(JsonPackage))
 		return;
 
 	JSON_TRY_STRING(JsonPackage, Name);
@@ -188,45 +180,66 @@ void FArticyPackageDef::ImportFromJson(const UArticyArchiveReader& Archive, cons
 	JSON_TRY_BOOL(JsonPackage, IsDefaultPackage);
 	JSON_TRY_STRING(JsonPackage, ScriptFragmentHash);
 
+	bObjectsChanged = false;
+	bTextsChanged = false;
+
+	// Objects and texts change independently, each file keeps what the last import read from it if unchanged
 	TSharedPtr<FJsonObject> Files;
 	JSON_TRY_OBJECT(JsonPackage, Files, {
 		TSharedPtr<FJsonObject> Objects;
-		if (!Archive.FetchJson(
+		if (Archive.FetchJson(
 			*obj,
 			JSON_SUBSECTION_OBJECTS,
 			PackageObjectsHash,
 			Objects))
 		{
-			return;
-		}
-
-		Models.Reset();
-		JSON_TRY_ARRAY(Objects, Objects,
-		{
-			auto innerObj = item->AsObject();
-			if (innerObj.IsValid())
+			bObjectsChanged = true;
+			Models.Reset();
+			JSON_TRY_ARRAY(Objects, Objects,
 			{
-				FArticyModelDef model;
-				model.ImportFromJson(innerObj);
-				Models.Add(model);
-			}
-		});
+				auto innerObj = item->AsObject();
+				if (innerObj.IsValid())
+				{
+					FArticyModelDef model;
+					model.ImportFromJson(innerObj);
+					Models.Add(model);
+				}
+			});
+			FArticyImportStats::Get().Add(FArticyImportStats::ECounter::ObjectsParsed, Models.Num());
+		}
 
 		TSharedPtr<FJsonObject> TextData;
-		if (!Archive.FetchJson(
+		if (Archive.FetchJson(
 			*obj,
 			JSON_SUBSECTION_TEXTS,
 			PackageTextsHash,
 			TextData))
 		{
-			return;
+			bTextsChanged = true;
+			Texts.Reset();
+			GatherText(TextData);
 		}
-
-		Texts.Reset();
-		GatherText(TextData);
 		});
 }
 
+/**
+ * Imports only the ID, name and inclusion state of a package, without fetching its files.
+ *
+ * @param JsonPackage A shared pointer to the JSON object containing the package definition.
+ * @return True if the package's data is included in the export, false otherwise.
+ */
+bool FArticyPackageDef::ImportInfoFromJson(const TSharedPtr<FJsonObject>& JsonPackage)
+{
+	if (!JsonPackage.IsValid())
+		return false;
+
+	JSON_TRY_HEX_ID(JsonPackage, Id);
+	JSON_TRY_STRING(JsonPackage, Name);
+	JSON_TRY_BOOL(JsonPackage, IsIncluded);
+
+	return IsIncluded;
+}
+
 /**
  * Gathers scripts from the package definition and adds them to the ArticyImportData.
  *
@@ -234,6 +247,7 @@ void FArticyPackageDef::ImportFromJson(const UArticyArchiveReader& Archive, cons
  */
 void FArticyPackageDef::GatherScripts(UArticyImportData* Data) const
 {
+	Data->SetScriptFragmentPackage(Name);
 	for (const auto& model : Models)
 		Data->GetObjectDefs().GatherScripts(model, Data);
 }
@@ -383,14 +397,46 @@ bool FArticyPackageDef::GetIsIncluded() const
  * @param Archive A reference to the ArticyArchiveReader object.
  * @param Json A pointer to the JSON array containing the package definitions.
  * @param Settings A reference to the FADISettings object.
+ * @return True if a package was added, removed or renamed, or one of its files changed.
  */
-void FArticyPackageDefs::ImportFromJson(
+bool FArticyPackageDefs::ImportFromJson(
 	const UArticyArchiveReader& Archive,
 	const TArray<TSharedPtr<FJsonValue>>* Json,
 	FAdiSettings& Settings)
 {
 	if (!Json)
-		return;
+		return false;
+
+	TArray<TSharedPtr<FJsonObject>> JsonPackages;
+	for (const auto& pack : *Json)
+	{
+		const auto& obj = pack->AsObject();
+		if (obj.IsValid())
+			JsonPackages.Add(obj);
+	}
+
+	// Package files are independent, fetch and parse them concurrently and merge them in export order below
+	TArray<FArticyPackageDef> ImportedPackages;
+	ImportedPackages.SetNum(JsonPackages.Num());
+
+	// Packages start from their last import, so the hashes of their files are known and unchanged files are not parsed again
+	TMap<FArticyId, const FArticyPackageDef*> PreviousPackages;
+	PreviousPackages.Reserve(Packages.Num());
+	for (const auto& ExistingPackage : Packages)
+		PreviousPackages.Add(ExistingPackage.GetId(), &ExistingPackage);
+
+	ParallelFor(JsonPackages.Num(), [&](int32 Index)
+	{
+		FArticyPackageDef& Package = ImportedPackages[Index];
+		if (Package.ImportInfoFromJson(JsonPackages[Index]))
+		{
+			if (const FArticyPackageDef* const* PreviousPackage = PreviousPackages.Find(Package.GetId()))
+				Package = **PreviousPackage;
+		}
+		Package.ImportFromJson(Archive, JsonPackages[Index]);
+	});
+
+	bool bPackagesChanged = false;
 
 	TSet<FString> OldPackageScriptHashes;
 	TArray<FArticyPackageDef> PackagesToRemove;
@@ -403,15 +449,8 @@ void FArticyPackageDefs::ImportFromJson(
 		bool bExistingPackageFound = false;
 
 		// Iterate over new package list
-		for (const auto& pack : *Json)
+		for (const auto& package : ImportedPackages)
 		{
-			const auto& obj = pack->AsObject();
-			if (!obj.IsValid())
-				continue;
-
-			FArticyPackageDef package;
-			package.ImportFromJson(Archive, obj);
-
 			// If package with the same Id is found
 			if (ExistingPackage.GetId() == package.GetId())
 			{
@@ -423,6 +462,7 @@ void FArticyPackageDefs::ImportFromJson(
 				// If IsIncluded is set on the new package, replace the existing package
 				if (package.GetIsIncluded())
 				{
+					bPackagesChanged |= package.DidObjectsChange() || package.DidTextsChange();
 					ExistingPackage = package;
 
 					// Useful if we ever decide to rename included packages 
@@ -433,6 +473,7 @@ void FArticyPackageDefs::ImportFromJson(
 				{
 					// Name has changed
 					ExistingPackage.SetName(NewName);
+					bPackagesChanged = true;
 				}
 
 				break;
@@ -450,18 +491,12 @@ void FArticyPackageDefs::ImportFromJson(
 	for (const auto& PackageToRemove : PackagesToRemove)
 	{
 		Packages.RemoveSingle(PackageToRemove);
+		bPackagesChanged = true;
 	}
 
 	// Iterate over new package list
-	for (const auto& pack : *Json)
+	for (auto& package : ImportedPackages)
 	{
-		const auto& obj = pack->AsObject();
-		if (!obj.IsValid())
-			continue;
-
-		FArticyPackageDef package;
-		package.ImportFromJson(Archive, obj);
-
 		bool bExistingPackageFound = false;
 
 		// Check if package already exists in the Packages array
@@ -477,7 +512,8 @@ void FArticyPackageDefs::ImportFromJson(
 		// If package doesn't exist, add it to the Packages array
 		if (!bExistingPackageFound)
 		{
-			Packages.Add(package);
+			Packages.Add(MoveTemp(package));
+			bPackagesChanged = true;
 		}
 	}
 
@@ -498,15 +534,19 @@ void FArticyPackageDefs::ImportFromJson(
 		if (!bScriptFragmentsChanged)
 		{
 			// Skip rebuilding script fragments - they are the same
-			return;
+			return bPackagesChanged;
 		}
 	}
 
 	Settings.SetScriptFragmentsNeedRebuild();
+	return bPackagesChanged;
 }
 
 /**
  * Validates the import of package definitions from a JSON array.
+ * Every package must have its data either in the new export or in the previous import.
+ *
+ * Only the package infos are read, the package files are fetched on import. All packages without data are logged, sorted by name.
  *
  * @param Archive A reference to the ArticyArchiveReader object.
  * @param Json A pointer to the JSON array containing the package definitions.
@@ -519,46 +559,8 @@ bool FArticyPackageDefs::ValidateImport(
 	if (!Json)
 		return false;
 
-	// Iterate over existing packages
-	for (auto& ExistingPackage : Packages)
-	{
-		// Old package has data
-		if (ExistingPackage.GetIsIncluded())
-			continue;
-
-		bool bPackageDataFound = false;
-
-		// Iterate over new package list
-		for (const auto& pack : *Json)
-		{
-			const auto& obj = pack->AsObject();
-			if (!obj.IsValid())
-				continue;
-
-			FArticyPackageDef package;
-			package.ImportFromJson(Archive, obj);
-
-			// If package with the same Id is found
-			if (ExistingPackage.GetId() == package.GetId())
-			{
-				// If IsIncluded is set on the new package, we are safe to continue
-				if (package.GetIsIncluded())
-				{
-					bPackageDataFound = true;
-				}
-
-				break;
-			}
-		}
-
-		if (!bPackageDataFound)
-		{
-			UE_LOG(LogArticyEditor, Error, TEXT("No data for package %s"), *ExistingPackage.GetName());
-			return false;
-		}
-	}
-
-	// Iterate over new package list
+	TMap<FArticyId, FArticyPackageDef> NewPackages;
+	NewPackages.Reserve(Json->Num());
 	for (const auto& pack : *Json)
 	{
 		const auto& obj = pack->AsObject();
@@ -566,37 +568,45 @@ bool FArticyPackageDefs::ValidateImport(
 			continue;
 
 		FArticyPackageDef package;
-		package.ImportFromJson(Archive, obj);
+		package.ImportInfoFromJson(obj);
+		NewPackages.Add(package.GetId(), MoveTemp(package));
+	}
 
-		// New package has data
-		if (package.GetIsIncluded())
+	TMap<FArticyId, const FArticyPackageDef*> ExistingPackages;
+	ExistingPackages.Reserve(Packages.Num());
+	for (const auto& ExistingPackage : Packages)
+		ExistingPackages.Add(ExistingPackage.GetId(), &ExistingPackage);
+
+	TArray<FString> PackagesWithoutData;
+
+	// Old packages without data need it in the new export
+	for (const auto& ExistingPackage : Packages)
+	{
+		if (ExistingPackage.GetIsIncluded())
 			continue;
 
-		bool bPackageDataFound = false;
+		const FArticyPackageDef* package = NewPackages.Find(ExistingPackage.GetId());
+		if (!package || !package->GetIsIncluded())
+			PackagesWithoutData.AddUnique(ExistingPackage.GetName());
+	}
 
-		// Check if package already exists in the Packages array
-		for (const auto& ExistingPackage : Packages)
-		{
-			if (ExistingPackage.GetId() == package.GetId())
-			{
-				// Old package has data
-				if (ExistingPackage.GetIsIncluded())
-				{
-					bPackageDataFound = true;
-				}
-				break;
-			}
-		}
+	// New packages without data need it from the previous import
+	for (const auto& package : NewPackages)
+	{
+		if (package.Value.GetIsIncluded())
+			continue;
 
-		if (!bPackageDataFound)
-		{
-			UE_LOG(LogArticyEditor, Error, TEXT("No data for package %s"), *package.GetName());
-			return false;
-		}
+		const FArticyPackageDef* const* ExistingPackage = ExistingPackages.Find(package.Key);
+		if (!ExistingPackage || !(*ExistingPackage)->GetIsIncluded())
+			PackagesWithoutData.AddUnique(package.Value.GetName());
 	}
 
+	PackagesWithoutData.Sort();
+	for (const auto& PackageName : PackagesWithoutData)
+		UE_LOG(LogArticyEditor, Error, TEXT("No data for package %s"), *PackageName);
+
 	// All checks passed - safe to import
-	return true;
+	return PackagesWithoutData.Num() == 0;
 }
 
 /**
@@ -633,7 +643,7 @@ void FArticyPackageDef::GatherText(const TSharedPtr<FJsonObject>& Json)
  *
  * @return A map of text data.
  */
-TMap<FString, FArticyTexts> FArticyPackageDef::GetTexts() const
+const TMap<FString, FArticyTexts>& FArticyPackageDef::GetTexts() const
 {
 	return Texts;
 }
@@ -649,43 +659,96 @@ TMap<FString, FArticyTexts> FArticyPackageDefs::GetTexts(const FArticyPackageDef
 	return Package.GetTexts();
 }
 
+/**
+ * Stores the gathered information about who has which children in the objects of a generated package, then starts saving it.
+ *
+ * @param Data A pointer to the UArticyImportData object holding the children of every object.
+ * @param Package The generated package, the packages holding the children of its objects must be generated.
+ * @param Saver The saver to start saving the package with, the package is not saved if null.
+ */
+static void FinishPackageAsset(const UArticyImportData* Data, UArticyPackage* Package, FArticyPackageSaver* Saver)
+{
+	if (!Package)
+		return;
+
+	const auto& parentChildrenCache = Data->GetParentChildrenCache();
+	const auto& childrenProp = FName{ TEXT("Children") };
+	for (auto obj : Package->GetAssets())
+	{
+		if (auto articyObj = Cast<UArticyObject>(obj))
+		{
+			if (auto children = parentChildrenCache.Find(articyObj->GetId()))
+			{
+				FArticyIdArray SortedChildren = *children;
+
+				// If the setting is enabled, try to sort. Will only work with exported position properties.
+				if (GetDefault<UArticyPluginSettings>()->bSortChildrenAtGeneration)
+				{
+					SortedChildren.Values.Sort(ArticyImporterHelpers::FCompareArticyNodeXLocation());
+				}
+				articyObj->SetProp(childrenProp, SortedChildren.Values);
+			}
+		}
+	}
+
+	if (Saver)
+		Saver->Save(Package->GetOutermost());
+}
+
 /**
  * Generates assets for all package definitions and stores them in the ArticyImportData.
  *
+ * A package is finished as soon as the packages holding the children of its objects are generated, and handed
+ * to the saver, so it is saved while the packages after it are generated.
+ *
  * @param Data A pointer to the UArticyImportData object.
+ * @param Saver Saves each package once it is finished, the packages are only generated if null.
  */
-void FArticyPackageDefs::GenerateAssets(UArticyImportData* Data) const
+void FArticyPackageDefs::GenerateAssets(UArticyImportData* Data, FArticyPackageSaver* Saver) const
 {
 	auto& ArticyPackages = Data->GetPackages();
 
 	ArticyPackages.Reset(Packages.Num());
 
-	for (auto pack : Packages)
+	// Children are sorted by the positions of their objects, so a package waits for the last package holding children of its objects
+	TMap<FArticyId, int32> PackageByObject;
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
 	{
-		ArticyPackages.Add(pack.GeneratePackageAsset(Data));
+		for (const auto& model : Packages[Index].GetModels())
+			PackageByObject.Add(model.GetId(), Index);
 	}
 
-	// Store gathered information about who has which children in generated assets
-	auto parentChildrenCache = Data->GetParentChildrenCache();
-	const auto& childrenProp = FName{ TEXT("Children") };
-	for (auto& pack : ArticyPackages)
+	TArray<int32> LastDependency;
+	LastDependency.SetNumUninitialized(Packages.Num());
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+		LastDependency[Index] = Index;
+
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
 	{
-		for (auto obj : pack->GetAssets())
+		for (const auto& model : Packages[Index].GetModels())
 		{
-			if (auto articyObj = Cast<UArticyObject>(obj))
-			{
-				if (auto children = parentChildrenCache.Find(articyObj->GetId()))
-				{
-					// If the setting is enabled, try to sort. Will only work with exported position properties.
-					if (GetDefault<UArticyPluginSettings>()->bSortChildrenAtGeneration)
-					{
-						children->Values.Sort(ArticyImporterHelpers::FCompareArticyNodeXLocation());
-					}
-					articyObj->SetProp(childrenProp, children->Values);
-				}
-			}
+			if (const int32* ParentPackage = PackageByObject.Find(model.GetParent()))
+				LastDependency[*ParentPackage] = FMath::Max(LastDependency[*ParentPackage], Index);
 		}
 	}
+
+	// The packages finished once a package is generated, in export order
+	TArray<TArray<int32>> FinishedPackages;
+	FinishedPackages.SetNum(Packages.Num());
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+		FinishedPackages[LastDependency[Index]].Add(Index);
+	PackageByObject.Empty();
+
+	// Models are initialized by steps baked per type, which hold classes of this compile
+	Data->GetObjectDefs().ResetModelInitializers();
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		ArticyPackages.Add(Packages[Index].GeneratePackageAsset(Data));
+
+		for (const int32 Finished : FinishedPackages[Index])
+			FinishPackageAsset(Data, ArticyPackages[Finished].Get(), Saver);
+	}
+	Data->GetObjectDefs().ResetModelInitializers();
 }
 
 /**
@@ -722,6 +785,17 @@ void FArticyPackageDefs::ResetPackages()
 	Packages.Empty();
 }
 
+/**
+ * Adds the hashes of all packages' files as of the last import.
+ *
+ * @param OutHashes The set that receives the hashes.
+ */
+void FArticyPackageDefs::GatherFileHashes(TSet<FString>& OutHashes) const
+{
+	for (const auto& Package : Packages)
+		Package.GatherFileHashes(OutHashes);
+}
+
 /**
  * Gets the script fragment hash for the package definition.
  *
@@ -731,3 +805,16 @@ FString FArticyPackageDef::GetScriptFragmentHash() const
 {
 	return ScriptFragmentHash;
 }
+
+/**
+ * Adds the hashes of the package's files as of the last import.
+ *
+ * @param OutHashes The set that receives the hashes.
+ */
+void FArticyPackageDef::GatherFileHashes(TSet<FString>& OutHashes) const
+{
+	if (!PackageObjectsHash.IsEmpty())
+		OutHashes.Add(PackageObjectsHash);
+	if (!PackageTextsHash.IsEmpty())
+		OutHashes.Add(PackageTextsHash);
+}
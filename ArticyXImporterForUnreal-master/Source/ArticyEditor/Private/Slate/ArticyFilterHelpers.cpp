@@ -8,6 +8,7 @@
 #include "Interfaces/ArticyObjectWithText.h"
 #include "Interfaces/ArticyObjectWithSpeaker.h"
 #include "ArticyEditorModule.h"
+#include "UObject/ObjectKey.h"
 
 #define LOCTEXT_NAMESPACE "ArticyObjectSearchBoxHelpers"
 
@@ -41,12 +42,14 @@ public:
 	void SetAsset(FArticyObjectFilterTypePtr InAsset)
 	{
 		AssetPtr = InAsset;
+		CurrentStrings = nullptr;
 	}
 
 	/** Clears the current asset from the context. */
 	void ClearAsset()
 	{
 		AssetPtr = nullptr;
+		CurrentStrings = nullptr;
 	}
 
 	/**
@@ -78,42 +81,33 @@ public:
 	 */
 	virtual bool TestBasicStringExpression(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const override
 	{
-		// Cast the asset pointer to UArticyObject type.
-		UArticyObject* ArticyObject = Cast<UArticyObject>(AssetPtr->GetAsset());
-
-		// Check the asset's display name, technical name, text, and speaker display name.
-		if (CheckDisplayName(InValue, InTextComparisonMode) ||
-			CheckTechnicalName(InValue, InTextComparisonMode) ||
-			CheckTextOfArticyObject(InValue, InTextComparisonMode) ||
-			CheckSpeakerDisplayName(InValue, InTextComparisonMode))
-		{
-			return true;
-		}
-
-		// Compare asset name.
-		const FTextFilterString AssetName(AssetPtr->AssetName);
-		if (AssetName.CompareText(InValue, InTextComparisonMode))
+		const FSearchableStrings& Strings = GetSearchableStrings();
+
+		// Check the asset's display name, technical name, text, speaker display name and asset name.
+		if (CompareIfNotEmpty(Strings.DisplayName, InValue, InTextComparisonMode) ||
+			CompareIfNotEmpty(Strings.TechnicalName, InValue, InTextComparisonMode) ||
+			CompareIfNotEmpty(Strings.Text, InValue, InTextComparisonMode) ||
+			CompareIfNotEmpty(Strings.SpeakerDisplayName, InValue, InTextComparisonMode) ||
+			Strings.AssetName.CompareText(InValue, InTextComparisonMode))
 		{
 			return true;
 		}
 
 		// Optionally include class name in the filter.
-		if (bIncludeClassName)
+		if (bIncludeClassName && Strings.AssetClass.CompareText(InValue, InTextComparisonMode))
 		{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
-			const FTextFilterString AssetClassFilter(AssetPtr->AssetClassPath.ToString());
-#else
-			const FTextFilterString AssetClassFilter(AssetPtr->AssetClass);
-#endif
-			if (AssetClassFilter.CompareText(InValue, InTextComparisonMode))
-			{
-				return true;
-			}
+			return true;
 		}
 
 		return false;
 	}
 
+	/** Forgets the strings of all objects, e.g. after they were imported again. */
+	void ClearSearchableStrings()
+	{
+		SearchableStrings.Empty();
+	}
+
 	/**
 	 * Tests the asset against a complex expression.
 	 *
@@ -224,127 +218,110 @@ private:
 	const FName TypeKeyName;
 	const FName TagKeyName;
 
-	/**
-	 * Checks if the display name of the asset matches the filter value.
-	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the display name matches, false otherwise.
-	 */
-	bool CheckDisplayName(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
-	{
-		// Check if the asset implements IArticyObjectWithDisplayName
-		IArticyObjectWithDisplayName* ArticyObjectWithDisplayName = Cast<IArticyObjectWithDisplayName>(AssetPtr->GetAsset());
-
-		if (ArticyObjectWithDisplayName)
-		{
-			// Get the display name and compare it with the filter value.
-			const FTextFilterString TextToCompare(ArticyObjectWithDisplayName->GetDisplayName().ToString());
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
+	typedef FSoftObjectPath FAssetKey;
+#else
+	typedef FName FAssetKey;
+#endif
 
-			if (TextToCompare.IsEmpty())
-			{
-				return false;
-			}
+	/** The strings of an object that basic expressions are tested against, converted for comparison once per object */
+	struct FSearchableStrings
+	{
+		FTextFilterString DisplayName;
+		FTextFilterString TechnicalName;
+		FTextFilterString Text;
+		FTextFilterString SpeakerDisplayName;
+		FTextFilterString AssetName;
+		FTextFilterString AssetClass;
+	};
 
-			return TextToCompare.CompareText(InValue, InTextComparisonMode);
-		}
+	/** Searchable strings of the objects tested so far, by object path */
+	mutable TMap<FAssetKey, FSearchableStrings> SearchableStrings;
 
-		return false;
-	}
+	/** Strings of the asset currently being filtered, looked up on its first test */
+	mutable const FSearchableStrings* CurrentStrings = nullptr;
 
 	/**
-	 * Checks if the text of the Articy object matches the filter value.
+	 * Compares a cached string against the filter value, empty strings never match.
 	 *
+	 * @param String The cached string.
 	 * @param InValue The filter value to compare against.
 	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the text matches, false otherwise.
+	 * @return True if the string is not empty and matches.
 	 */
-	bool CheckTextOfArticyObject(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
+	static bool CompareIfNotEmpty(const FTextFilterString& String, const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode)
 	{
-		// Check if the asset implements IArticyObjectWithText
-		IArticyObjectWithText* ArticyObjectWithText = Cast<IArticyObjectWithText>(AssetPtr->GetAsset());
-
-		if (ArticyObjectWithText)
-		{
-			// Get the text and compare it with the filter value.
-			const FText Text = ArticyObjectWithText->GetText();
-			const FTextFilterString FilterString(Text.ToString());
-
-			const bool bTextIsEmptyOrWhitespace = Text.IsEmptyOrWhitespace();
-
-			if (!bTextIsEmptyOrWhitespace && FilterString.CompareText(InValue, InTextComparisonMode))
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return !String.IsEmpty() && String.CompareText(InValue, InTextComparisonMode);
 	}
 
 	/**
-	 * Checks if the technical name of the Articy object matches the filter value.
+	 * Gets the searchable strings of the current asset, gathering them on its first test.
 	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the technical name matches, false otherwise.
+	 * @return The strings of the current asset.
 	 */
-	bool CheckTechnicalName(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
+	const FSearchableStrings& GetSearchableStrings() const
 	{
-		// Cast the asset pointer to UArticyObject
-		UArticyObject* ArticyObject = Cast<UArticyObject>(AssetPtr->GetAsset());
-
-		if (ArticyObject)
+		if (CurrentStrings)
 		{
-			// Get the technical name and compare it with the filter value.
-			const FTextFilterString TextToCompare(ArticyObject->GetTechnicalName());
-
-			if (TextToCompare.IsEmpty())
-			{
-				return false;
-			}
+			return *CurrentStrings;
+		}
 
-			return TextToCompare.CompareText(InValue, InTextComparisonMode);
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
+		const FAssetKey Key = AssetPtr->GetSoftObjectPath();
+#else
+		const FAssetKey Key = AssetPtr->ObjectPath;
+#endif
+		if (const FSearchableStrings* Cached = SearchableStrings.Find(Key))
+		{
+			CurrentStrings = Cached;
+			return *Cached;
 		}
 
-		return false;
-	}
+		FSearchableStrings& Strings = SearchableStrings.Add(Key);
+		Strings.AssetName = FTextFilterString(AssetPtr->AssetName);
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
+		Strings.AssetClass = FTextFilterString(AssetPtr->AssetClassPath.ToString());
+#else
+		Strings.AssetClass = FTextFilterString(AssetPtr->AssetClass);
+#endif
 
-	/**
-	 * Checks if the speaker display name of the Articy object matches the filter value.
-	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the speaker display name matches, false otherwise.
-	 */
-	bool CheckSpeakerDisplayName(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
-	{
-		// Check if the asset implements IArticyObjectWithSpeaker
-		IArticyObjectWithSpeaker* ArticyObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(AssetPtr->GetAsset());
+		UObject* Asset = AssetPtr->GetAsset();
+
+		if (const IArticyObjectWithDisplayName* ArticyObjectWithDisplayName = Cast<IArticyObjectWithDisplayName>(Asset))
+		{
+			Strings.DisplayName = FTextFilterString(ArticyObjectWithDisplayName->GetDisplayName().ToString());
+		}
 
-		if (ArticyObjectWithSpeaker)
+		if (const UArticyObject* ArticyObject = Cast<UArticyObject>(Asset))
 		{
-			// Find the speaker asset and check its display name.
-			IArticyObjectWithDisplayName* SpeakerDisplayName = Cast<IArticyObjectWithDisplayName>(UArticyObject::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId()));
+			Strings.TechnicalName = FTextFilterString(ArticyObject->GetTechnicalName());
+		}
 
-			if (!SpeakerDisplayName)
+		if (const IArticyObjectWithText* ArticyObjectWithText = Cast<IArticyObjectWithText>(Asset))
+		{
+			const FText Text = ArticyObjectWithText->GetText();
+			if (!Text.IsEmptyOrWhitespace())
 			{
-				UE_LOG(LogArticyEditor, Error, TEXT("Articy filter: Speaker object does not exist"));
-				return false;
+				Strings.Text = FTextFilterString(Text.ToString());
 			}
+		}
 
-			// Compare the speaker's display name with the filter value.
-			const FText& SpeakerName = SpeakerDisplayName->GetDisplayName();
-			const FTextFilterString TextToCompare(SpeakerName.ToString());
-
-			if (TextToCompare.IsEmpty())
+		if (const IArticyObjectWithSpeaker* ArticyObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(Asset))
+		{
+			// Find the speaker asset and use its display name.
+			const IArticyObjectWithDisplayName* SpeakerDisplayName = Cast<IArticyObjectWithDisplayName>(UArticyObject::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId()));
+			if (SpeakerDisplayName)
 			{
-				return false;
+				Strings.SpeakerDisplayName = FTextFilterString(SpeakerDisplayName->GetDisplayName().ToString());
+			}
+			else
+			{
+				UE_LOG(LogArticyEditor, Error, TEXT("Articy filter: Speaker object does not exist"));
 			}
-
-			return TextToCompare.CompareText(InValue, InTextComparisonMode);
 		}
 
-		return false;
+		CurrentStrings = &Strings;
+		return Strings;
 	}
 };
 
@@ -353,12 +330,20 @@ FFrontendFilter_ArticyObject::FFrontendFilter_ArticyObject() :
 	TextFilterExpressionContext(MakeShareable(new FFrontendFilter_ArticyObjectFilterExpressionContext()))
 	, TextFilterExpressionEvaluator(ETextFilterExpressionEvaluatorMode::Complex)
 {
+	// the cached strings of the objects are outdated once they are imported again
+	ImportFinishedHandle = FArticyEditorModule::Get().OnImportFinished.AddLambda([Context = TextFilterExpressionContext]()
+	{
+		Context->ClearSearchableStrings();
+	});
 }
 
 /** Destructor for FFrontendFilter_ArticyObject. */
 FFrontendFilter_ArticyObject::~FFrontendFilter_ArticyObject()
 {
-
+	if (FArticyEditorModule* EditorModule = FModuleManager::GetModulePtr<FArticyEditorModule>(TEXT("ArticyEditor")))
+	{
+		EditorModule->OnImportFinished.Remove(ImportFinishedHandle);
+	}
 }
 
 /**
@@ -472,12 +457,14 @@ public:
 	void SetVariable(FArticyVariableFilterTypePtr InVariable)
 	{
 		VariablePtr = InVariable;
+		CurrentStrings = nullptr;
 	}
 
 	/** Clears the current variable from the context. */
 	void ClearVariable()
 	{
 		VariablePtr = nullptr;
+		CurrentStrings = nullptr;
 	}
 
 	/**
@@ -503,7 +490,27 @@ public:
 
 private:
 
+	/** The variable and set name of a variable, converted for comparison once per variable */
+	struct FSearchableStrings
+	{
+		FTextFilterString VariableName;
+		FTextFilterString SetName;
+	};
+
+	/**
+	 * Gets the searchable strings of the current variable, gathering them on its first test.
+	 *
+	 * @return The strings of the current variable.
+	 */
+	const FSearchableStrings& GetSearchableStrings() const;
+
 	FArticyVariableFilterTypePtr VariablePtr;
+
+	/** Searchable strings of the variables tested so far, the names of variables don't change */
+	mutable TMap<FObjectKey, FSearchableStrings> SearchableStrings;
+
+	/** Strings of the variable currently being filtered, looked up on its first test */
+	mutable const FSearchableStrings* CurrentStrings = nullptr;
 };
 
 /**
@@ -515,22 +522,32 @@ private:
  */
 bool FFrontendFilter_ArticyGVFilterExpressionContext::TestBasicStringExpression(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
 {
-	// Retrieve the variable name and set name, and compare them against the filter value.
-	const UArticyVariable* Variable = VariablePtr;
-
-	const FTextFilterString VarNameToCompare(Variable->GetName());
-	if (VarNameToCompare.CompareText(InValue, InTextComparisonMode))
-	{
-		return true;
-	}
+	// Compare the variable name and set name against the filter value.
+	const FSearchableStrings& Strings = GetSearchableStrings();
+	return Strings.VariableName.CompareText(InValue, InTextComparisonMode) || Strings.SetName.CompareText(InValue, InTextComparisonMode);
+}
 
-	const FTextFilterString VarSetNameToCompare = Variable->GetOuter()->GetName();
-	if (VarSetNameToCompare.CompareText(InValue, InTextComparisonMode))
+/**
+ * Gets the searchable strings of the current variable, gathering them on its first test.
+ *
+ * @return The strings of the current variable.
+ */
+const FFrontendFilter_ArticyGVFilterExpressionContext::FSearchableStrings& FFrontendFilter_ArticyGVFilterExpressionContext::GetSearchableStrings() const
+{
+	if (!CurrentStrings)
 	{
-		return true;
+		const UArticyVariable* Variable = VariablePtr;
+		CurrentStrings = SearchableStrings.Find(Variable);
+		if (!CurrentStrings)
+		{
+			FSearchableStrings& Strings = SearchableStrings.Add(Variable);
+			Strings.VariableName = FTextFilterString(Variable->GetName());
+			Strings.SetName = FTextFilterString(Variable->GetOuter()->GetName());
+			CurrentStrings = &Strings;
+		}
 	}
 
-	return false;
+	return *CurrentStrings;
 }
 
 /**
@@ -0,0 +1,201 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "Slate/AssetPicker/ArticyObjectPreviewCache.h"
+#include "ArticyObject.h"
+#include "ArticyAsset.h"
+#include "ArticyEditorModule.h"
+#include "Engine/Texture2D.h"
+#include "Interfaces/ArticyObjectWithDisplayName.h"
+#include "Interfaces/ArticyObjectWithPreviewImage.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Slate/UserInterfaceHelperFunctions.h"
+
+#define LOCTEXT_NAMESPACE "ArticyObjectPreviewCache"
+
+namespace
+{
+	/** A few screens of tiles in the largest pickers */
+	constexpr int32 MaxCachedEntries = 2048;
+
+	/**
+	 * @brief Gets the path of the preview image of an object without loading it.
+	 *
+	 * @param Object The object, may be nullptr.
+	 * @return The path of the preview image texture, null if there is none.
+	 */
+	FSoftObjectPath GetPreviewImagePath(const UArticyObject* Object)
+	{
+		const IArticyObjectWithPreviewImage* ObjectWithPreviewImage = Cast<IArticyObjectWithPreviewImage>(Object);
+		if (!ObjectWithPreviewImage || !ObjectWithPreviewImage->GetPreviewImage())
+			return FSoftObjectPath();
+
+		const UArticyAsset* Asset = Cast<UArticyAsset>(UArticyObject::FindAsset(ObjectWithPreviewImage->GetPreviewImage()->Asset));
+		return Asset ? Asset->GetAssetPath() : FSoftObjectPath();
+	}
+}
+
+/**
+ * @brief Gets the cache shared by all pickers.
+ *
+ * @return The shared cache.
+ */
+FArticyObjectPreviewCache& FArticyObjectPreviewCache::Get()
+{
+	check(IsInGameThread());
+
+	// never destroyed, its streaming handles must not be released after the engine shut down
+	static FArticyObjectPreviewCache* Cache = new FArticyObjectPreviewCache();
+	return *Cache;
+}
+
+FArticyObjectPreviewCache::FArticyObjectPreviewCache()
+	: Entries(MaxCachedEntries)
+{
+	FArticyEditorModule::Get().OnImportFinished.AddRaw(this, &FArticyObjectPreviewCache::Invalidate);
+}
+
+/**
+ * @brief Gets the entry of an object, gathering it if it isn't cached.
+ *
+ * @param Id The id of the object.
+ * @return The entry, or nullptr if there is no object with that id.
+ */
+TSharedPtr<const FArticyObjectPreviewCache::FEntry> FArticyObjectPreviewCache::Find(const FArticyId& Id)
+{
+	if (Id.IsNull())
+		return nullptr;
+
+	if (const TSharedRef<FEntry>* Cached = Entries.FindAndTouch(Id))
+	{
+		if (IsCurrent(**Cached))
+			return *Cached;
+		Entries.Remove(Id);
+	}
+
+	if (MissingIds.Contains(Id))
+		return nullptr;
+
+	UArticyObject* Object = UArticyObject::FindAsset(Id);
+	if (!Object)
+	{
+		MissingIds.Add(Id);
+		return nullptr;
+	}
+
+	TSharedRef<FEntry> Entry = CreateEntry(Object);
+	Entries.Add(Id, Entry);
+	return Entry;
+}
+
+/**
+ * @brief Drops all entries, e.g. after an import changed the objects.
+ */
+void FArticyObjectPreviewCache::Invalidate()
+{
+	Entries.Empty(MaxCachedEntries);
+	MissingIds.Empty();
+	++Generation;
+}
+
+/**
+ * @brief Gathers the entry of an object, starting to load its images.
+ *
+ * @param Object The object to gather.
+ * @return The new entry.
+ */
+TSharedRef<FArticyObjectPreviewCache::FEntry> FArticyObjectPreviewCache::CreateEntry(UArticyObject* Object)
+{
+	TSharedRef<FEntry> Entry = MakeShared<FEntry>();
+	Entry->Object = Object;
+	Entry->Generation = Generation;
+
+	Entry->DisplayName = FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(Object));
+	Entry->Color = UserInterfaceHelperFunctions::GetColor(Object);
+	Entry->TypeImageLarge = UserInterfaceHelperFunctions::GetArticyTypeImage(Object, UserInterfaceHelperFunctions::Large);
+	Entry->TypeImageMedium = UserInterfaceHelperFunctions::GetArticyTypeImage(Object, UserInterfaceHelperFunctions::Medium);
+
+	Entry->AssetName = FText::FromString(Object->GetName());
+	Entry->ClassText = FText::Format(LOCTEXT("ClassName", "({0})"), FText::FromString(Object->UObject::GetClass()->GetName()));
+
+	// use the asset name by default, overwrite with the display name where it makes sense
+	Entry->NameText = Entry->AssetName;
+	if (const IArticyObjectWithDisplayName* ObjectWithDisplayName = Cast<IArticyObjectWithDisplayName>(Object))
+	{
+		const FText DisplayName = ObjectWithDisplayName->GetDisplayName();
+		if (!DisplayName.IsEmpty())
+		{
+			Entry->NameText = DisplayName;
+			Entry->bUsingDisplayName = true;
+		}
+	}
+
+	UArticyObject* Speaker = nullptr;
+	if (const IArticyObjectWithSpeaker* ObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(Object))
+	{
+		Entry->bHasSpeaker = true;
+		Speaker = UArticyObject::FindAsset(ObjectWithSpeaker->GetSpeakerId());
+		// Speaker can be nullptr in case a speaker that does not exist as an entity was specified, i.e. in the scriptwriting documents
+		if (const IArticyObjectWithDisplayName* SpeakerWithDisplayName = Cast<IArticyObjectWithDisplayName>(Speaker))
+			Entry->SpeakerName = SpeakerWithDisplayName->GetDisplayName();
+	}
+
+	if (const IArticyObjectWithText* ObjectWithText = Cast<IArticyObjectWithText>(Object))
+	{
+		const FText& Text = ObjectWithText->GetText();
+		if (!Text.IsEmpty())
+			Entry->Text = FText::FromString(FString("\"").Append(Text.ToString()).Append("\""));
+	}
+
+	// the display name of the target, if our object has one
+	if (const FArticyId* TargetID = UserInterfaceHelperFunctions::GetTargetID(Object))
+	{
+		if (const UArticyObject* TargetObject = UArticyObject::FindAsset(*TargetID))
+			Entry->TargetName = FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(TargetObject));
+	}
+
+	Entry->PreviewPath = GetPreviewImagePath(Object);
+	Entry->SpeakerPreviewPath = GetPreviewImagePath(Speaker);
+	RequestImage(Entry, Entry->PreviewPath, false);
+	RequestImage(Entry, Entry->SpeakerPreviewPath, true);
+
+	return Entry;
+}
+
+/**
+ * @brief Starts loading an image of an entry, or takes it right away if it is already loaded.
+ *
+ * @param Entry The entry the image belongs to.
+ * @param Path The path of the texture.
+ * @param bSpeaker Whether it is the speaker preview image rather than the object's own.
+ */
+void FArticyObjectPreviewCache::RequestImage(const TSharedRef<FEntry>& Entry, const FSoftObjectPath& Path, bool bSpeaker)
+{
+	if (Path.IsNull())
+		return;
+
+	TWeakObjectPtr<UTexture2D>& Image = bSpeaker ? Entry->SpeakerPreviewImage : Entry->PreviewImage;
+	if (UTexture2D* Loaded = Cast<UTexture2D>(Path.ResolveObject()))
+	{
+		Image = Loaded;
+		++Entry->ImageRevision;
+		return;
+	}
+
+	// the entry is only held weakly, so evicted entries don't keep their images loading
+	TWeakPtr<FEntry> WeakEntry = Entry;
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(Path, FStreamableDelegate::CreateLambda([WeakEntry, Path, bSpeaker]()
+	{
+		const TSharedPtr<FEntry> LoadedEntry = WeakEntry.Pin();
+		if (!LoadedEntry.IsValid())
+			return;
+
+		(bSpeaker ? LoadedEntry->SpeakerPreviewImage : LoadedEntry->PreviewImage) = Cast<UTexture2D>(Path.ResolveObject());
+		++LoadedEntry->ImageRevision;
+	}));
+	(bSpeaker ? Entry->SpeakerPreviewHandle : Entry->PreviewHandle) = Handle;
+}
+
+#undef LOCTEXT_NAMESPACE
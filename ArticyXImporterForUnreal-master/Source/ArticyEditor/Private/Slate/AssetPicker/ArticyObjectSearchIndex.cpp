@@ -0,0 +1,291 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "Slate/AssetPicker/ArticyObjectSearchIndex.h"
+#include "ArticyObject.h"
+#include "ArticyPackage.h"
+#include "ArticyEditorModule.h"
+#include "Interfaces/ArticyObjectWithDisplayName.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/Async.h"
+
+namespace
+{
+	/** Entries a search tests between checking for cancellation and handing out matches */
+	constexpr int32 SearchChunkSize = 4096;
+
+	TSharedPtr<FArticyObjectSearchIndex, ESPMode::ThreadSafe> SharedIndex;
+
+	/**
+	 * @brief Appends a lowercased string to a haystack, separated from the previous one.
+	 *
+	 * @param Haystack The haystack to extend.
+	 * @param Value The string to add.
+	 */
+	void AppendToHaystack(FString& Haystack, const FString& Value)
+	{
+		if (Value.IsEmpty())
+			return;
+
+		// A separator no query word contains, so words don't match across two strings
+		if (!Haystack.IsEmpty())
+			Haystack.AppendChar(TEXT('\n'));
+		Haystack += Value.ToLower();
+	}
+}
+
+/**
+ * @brief Gets the shared index, starting a new one if the objects were imported again.
+ *
+ * @return The shared index, possibly not complete yet.
+ */
+TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe> FArticyObjectSearchIndex::Get()
+{
+	check(IsInGameThread());
+
+	static bool bBoundToImport = false;
+	if (!bBoundToImport)
+	{
+		FArticyEditorModule::Get().OnImportFinished.AddStatic(&FArticyObjectSearchIndex::Invalidate);
+		bBoundToImport = true;
+	}
+
+	if (!SharedIndex.IsValid())
+		SharedIndex = MakeShared<FArticyObjectSearchIndex, ESPMode::ThreadSafe>();
+	return SharedIndex.ToSharedRef();
+}
+
+/**
+ * @brief Drops the shared index; searches running on it keep their copy.
+ */
+void FArticyObjectSearchIndex::Invalidate()
+{
+	SharedIndex.Reset();
+}
+
+/**
+ * @brief Gathers more objects into the index on the game thread.
+ *
+ * @param TimeBudgetSeconds Time to spend gathering before returning.
+ * @return True once the index is complete.
+ */
+bool FArticyObjectSearchIndex::Update(double TimeBudgetSeconds)
+{
+	if (bComplete)
+		return true;
+
+	if (!bPackagesListed)
+	{
+		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), PackageAssets);
+#else
+		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), PackageAssets);
+#endif
+		bPackagesListed = true;
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + TimeBudgetSeconds;
+	for (; NextPackage < PackageAssets.Num(); ++NextPackage, NextObject = 0)
+	{
+		const UArticyPackage* Package = Cast<UArticyPackage>(PackageAssets[NextPackage].GetAsset());
+		if (!Package)
+			continue;
+
+		const TArray<UArticyObject*>& Assets = Package->GetAssets();
+		for (; NextObject < Assets.Num(); ++NextObject)
+		{
+			// Checking the time every object would cost more than indexing most of them
+			if ((NextObject & 63) == 0 && FPlatformTime::Seconds() > EndTime)
+				return false;
+
+			UArticyObject* Object = Assets[NextObject];
+			if (!Object)
+				continue;
+
+			FEntry& Entry = Entries.AddDefaulted_GetRef();
+			Entry.Object = Object;
+			Entry.Class = Object->GetClass();
+
+			AppendToHaystack(Entry.Haystack, Object->GetTechnicalName().ToString());
+			if (const IArticyObjectWithDisplayName* WithDisplayName = Cast<IArticyObjectWithDisplayName>(Object))
+				AppendToHaystack(Entry.Haystack, WithDisplayName->GetDisplayName().ToString());
+			if (const IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Object))
+				AppendToHaystack(Entry.Haystack, WithText->GetText().ToString());
+			if (const IArticyObjectWithSpeaker* WithSpeaker = Cast<IArticyObjectWithSpeaker>(Object))
+			{
+				const IArticyObjectWithDisplayName* Speaker = Cast<IArticyObjectWithDisplayName>(UArticyObject::FindAsset(WithSpeaker->GetSpeakerId()));
+				if (Speaker)
+					AppendToHaystack(Entry.Haystack, Speaker->GetDisplayName().ToString());
+			}
+			AppendToHaystack(Entry.Haystack, Object->GetName());
+			AppendToHaystack(Entry.Haystack, Entry.Class->GetPathName());
+		}
+	}
+
+	PackageAssets.Empty();
+	Entries.Shrink();
+	bComplete = true;
+	return true;
+}
+
+/**
+ * @brief Splits a query into lowercased words that must all be found in an entry's haystack.
+ *
+ * @param Query The search box text.
+ * @param OutTokens The words of the query.
+ * @return False if the query uses the filter expression syntax (keys, operators, quotes) the index can't answer.
+ */
+bool FArticyObjectSearchIndex::TokenizeQuery(const FString& Query, TArray<FString>& OutTokens)
+{
+	OutTokens.Reset();
+
+	static const TCHAR* const ExpressionChars = TEXT("=<>!\"'&|()");
+	for (const TCHAR Char : Query)
+	{
+		if (FCString::Strchr(ExpressionChars, Char))
+			return false;
+	}
+
+	TArray<FString> Words;
+	Query.ParseIntoArrayWS(Words);
+	for (FString& Word : Words)
+	{
+		if (Word.StartsWith(TEXT("-")) || Word.StartsWith(TEXT("+")) ||
+			Word.Equals(TEXT("AND"), ESearchCase::IgnoreCase) || Word.Equals(TEXT("OR"), ESearchCase::IgnoreCase) || Word.Equals(TEXT("NOT"), ESearchCase::IgnoreCase))
+		{
+			return false;
+		}
+		OutTokens.Add(Word.ToLower());
+	}
+	return true;
+}
+
+/**
+ * @brief Constructs a search, started with Start.
+ *
+ * @param InIndex The complete index to search.
+ * @param InTokens Lowercased words all of which must be found, see FArticyObjectSearchIndex::TokenizeQuery.
+ * @param InAllowedClass Class the objects must be of.
+ * @param bInExactClass Whether subclasses of InAllowedClass are left out.
+ * @param InCandidates Entry indices to search instead of all entries, e.g. the matches of a broader query.
+ */
+FArticyObjectSearch::FArticyObjectSearch(TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe> InIndex, TArray<FString> InTokens,
+	const UClass* InAllowedClass, bool bInExactClass, TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe> InCandidates)
+	: Index(MoveTemp(InIndex))
+	, Tokens(MoveTemp(InTokens))
+	, AllowedClass(InAllowedClass)
+	, bExactClass(bInExactClass)
+	, Candidates(MoveTemp(InCandidates))
+	, AllMatches(MakeShared<TArray<int32>, ESPMode::ThreadSafe>())
+{
+}
+
+/**
+ * @brief Starts searching on a worker thread.
+ */
+void FArticyObjectSearch::Start()
+{
+	check(Index->IsComplete());
+
+	Async(EAsyncExecution::ThreadPool, [Self = AsShared()]()
+	{
+		Self->Run();
+	});
+}
+
+/**
+ * @brief Moves the matches found since the last call.
+ *
+ * @param OutMatches Receives the entry indices of the new matches, in index order.
+ * @return True once the search is done and all matches were consumed.
+ */
+bool FArticyObjectSearch::ConsumeMatches(TArray<int32>& OutMatches)
+{
+	// Read before taking the matches, so none handed out after it was set are missed
+	const bool bWasDone = bDone;
+
+	FScopeLock ScopeLock(&Lock);
+	OutMatches = MoveTemp(PendingMatches);
+	PendingMatches.Reset();
+	return bWasDone;
+}
+
+/**
+ * @brief Checks whether a query only narrows this one down, so its matches are among the ones of this search.
+ *
+ * @param InTokens The words of the new query.
+ * @param InAllowedClass Class of the new query.
+ * @param bInExactClass Exact class setting of the new query.
+ * @return True if every word of this search is part of a word of the new one, for the same class restriction.
+ */
+bool FArticyObjectSearch::IsNarrowedBy(const TArray<FString>& InTokens, const UClass* InAllowedClass, bool bInExactClass) const
+{
+	if (InAllowedClass != AllowedClass || bInExactClass != bExactClass)
+		return false;
+
+	for (const FString& Token : Tokens)
+	{
+		const bool bContained = InTokens.ContainsByPredicate([&Token](const FString& NewToken)
+		{
+			return NewToken.Contains(Token, ESearchCase::CaseSensitive);
+		});
+		if (!bContained)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Runs the search on the worker.
+ */
+void FArticyObjectSearch::Run()
+{
+	const TArray<FArticyObjectSearchIndex::FEntry>& Entries = Index->GetEntries();
+	const int32 Num = Candidates.IsValid() ? Candidates->Num() : Entries.Num();
+
+	TArray<int32> ChunkMatches;
+	for (int32 ChunkStart = 0; ChunkStart < Num && !bCancelled; ChunkStart += SearchChunkSize)
+	{
+		const int32 ChunkEnd = FMath::Min(ChunkStart + SearchChunkSize, Num);
+		for (int32 i = ChunkStart; i < ChunkEnd; ++i)
+		{
+			const int32 EntryIndex = Candidates.IsValid() ? (*Candidates)[i] : i;
+			if (Matches(Entries[EntryIndex]))
+				ChunkMatches.Add(EntryIndex);
+		}
+
+		if (ChunkMatches.Num() > 0)
+		{
+			AllMatches->Append(ChunkMatches);
+
+			FScopeLock ScopeLock(&Lock);
+			PendingMatches.Append(ChunkMatches);
+			ChunkMatches.Reset();
+		}
+	}
+
+	bDone = true;
+}
+
+/**
+ * @brief Tests one entry against the words and the class restriction.
+ *
+ * @param Entry The entry to test.
+ * @return True if the entry is of the allowed class and contains all words.
+ */
+bool FArticyObjectSearch::Matches(const FArticyObjectSearchIndex::FEntry& Entry) const
+{
+	if (bExactClass ? Entry.Class != AllowedClass : !Entry.Class->IsChildOf(AllowedClass))
+		return false;
+
+	for (const FString& Token : Tokens)
+	{
+		if (!Entry.Haystack.Contains(Token, ESearchCase::CaseSensitive))
+			return false;
+	}
+	return true;
+}
@@ -29,6 +29,7 @@
  */
 SArticyObjectAssetPicker::~SArticyObjectAssetPicker()
 {
+	CancelIndexedSearch();
 }
 
 /**
@@ -122,6 +123,8 @@ void SArticyObjectAssetPicker::Tick(const FGeometry& AllottedGeometry, const dou
 		RefreshSourceItems();
 		bSlowFullListRefreshRequested = false;
 	}
+
+	UpdateIndexedSearch();
 }
 
 /**
@@ -340,13 +343,100 @@ void SArticyObjectAssetPicker::OnClear() const
 /**
  * @brief Refreshes the source items for the asset picker.
  *
- * This method retrieves and filters Articy package assets to display in the asset picker.
+ * Plain search words are answered from the shared search index on a worker thread, the matches are added
+ * to the list as they are found. Filter expressions fall back to testing every object against the frontend filters.
  */
 void SArticyObjectAssetPicker::RefreshSourceItems()
 {
-	ArticyPackageDataAssets.Reset();
+	CancelIndexedSearch();
 	FilteredObjects.Reset();
 
+	if (!FArticyObjectSearchIndex::TokenizeQuery(ArticyObjectFilter->GetRawFilterText().ToString(), PendingSearchTokens))
+	{
+		RefreshSourceItemsWithFilters();
+		return;
+	}
+
+	SearchIndex = FArticyObjectSearchIndex::Get();
+	bSearchPending = true;
+	UpdateIndexedSearch();
+	AssetView->RequestListRefresh();
+}
+
+/**
+ * @brief Advances the indexed search.
+ *
+ * Gathers more objects into the index until it is complete, then starts the search, only among the matches of the
+ * last search if the query extends it, and adds the matches found since the last tick to the list.
+ */
+void SArticyObjectAssetPicker::UpdateIndexedSearch()
+{
+	if (bSearchPending)
+	{
+		if (!SearchIndex->Update(FArticyObjectAssetPicketConstants::IndexTimeBudgetSeconds))
+			return;
+
+		UClass* AllowedClass = ClassFilter->GetAllowedClass();
+		const bool bExact = ClassFilter->IsExactClass();
+
+		TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe> Candidates;
+		if (LastCompletedSearch.IsValid() && &LastCompletedSearch->GetIndex().Get() == SearchIndex.Get() &&
+			LastCompletedSearch->IsNarrowedBy(PendingSearchTokens, AllowedClass, bExact))
+		{
+			Candidates = LastCompletedSearch->GetAllMatches();
+		}
+
+		ActiveSearch = MakeShared<FArticyObjectSearch, ESPMode::ThreadSafe>(SearchIndex.ToSharedRef(), MoveTemp(PendingSearchTokens), AllowedClass, bExact, Candidates);
+		ActiveSearch->Start();
+		PendingSearchTokens.Reset();
+		bSearchPending = false;
+	}
+
+	if (!ActiveSearch.IsValid())
+		return;
+
+	TArray<int32> Matches;
+	const bool bDone = ActiveSearch->ConsumeMatches(Matches);
+
+	const TArray<FArticyObjectSearchIndex::FEntry>& Entries = SearchIndex->GetEntries();
+	for (const int32 Match : Matches)
+	{
+		if (Entries[Match].Object.IsValid())
+			FilteredObjects.Add(Entries[Match].Object);
+	}
+
+	if (Matches.Num() > 0)
+		AssetView->RequestListRefresh();
+
+	if (bDone)
+	{
+		LastCompletedSearch = ActiveSearch;
+		ActiveSearch.Reset();
+	}
+}
+
+/**
+ * @brief Stops the indexed search in progress, if any.
+ */
+void SArticyObjectAssetPicker::CancelIndexedSearch()
+{
+	if (ActiveSearch.IsValid())
+	{
+		ActiveSearch->Cancel();
+		ActiveSearch.Reset();
+	}
+	bSearchPending = false;
+}
+
+/**
+ * @brief Refreshes the source items by running every object through the frontend filters.
+ *
+ * This method retrieves and filters Articy package assets to display in the asset picker.
+ */
+void SArticyObjectAssetPicker::RefreshSourceItemsWithFilters()
+{
+	ArticyPackageDataAssets.Reset();
+
 	// Load the asset registry module
 	static const FName AssetRegistryName(TEXT("AssetRegistry"));
 	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(
@@ -360,9 +450,16 @@ void SArticyObjectAssetPicker::RefreshSourceItems()
 	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), ArticyPackageDataAssets);
 #endif
 
+	UClass* AllowedClass = ClassFilter->GetAllowedClass();
+	const bool bExact = ClassFilter->IsExactClass();
+
 	// test the contained articy objects against the frontend filters
 	for (const FAssetData& ArticyPackageAssetData : ArticyPackageDataAssets)
 	{
+		// skip packages whose tags show they contain no object of the class, without loading them
+		if (!FArticyPackageQuery::MayContainClass(ArticyPackageAssetData, AllowedClass, bExact))
+			continue;
+
 		UArticyPackage* ArticyPackage = Cast<UArticyPackage>(ArticyPackageAssetData.GetAsset());
 
 		for (const TWeakObjectPtr<UArticyObject> ArticyObject : ArticyPackage->GetAssets())
@@ -22,14 +22,16 @@
 /**
  * @brief Updates the widget with a new Articy ID.
  *
- * This method updates the cached Articy ID and object and refreshes the widget's display.
+ * This method looks up the shared preview data of the object and refreshes the widget's display.
+ * Ids of missing objects are looked up again only after the next import.
  *
  * @param NewArticyId The new Articy ID to display.
  */
 void SArticyObjectTileView::Update(const FArticyId& NewArticyId)
 {
 	CachedArticyId = NewArticyId;
-	CachedArticyObject = UArticyObject::FindAsset(CachedArticyId);
+	CachedEntry = FArticyObjectPreviewCache::Get().Find(CachedArticyId);
+	ResolvedGeneration = FArticyObjectPreviewCache::Get().GetGeneration();
 
 	UpdateWidget();
 }
@@ -37,18 +39,26 @@ void SArticyObjectTileView::Update(const FArticyId& NewArticyId)
 /**
  * @brief Updates the widget's display elements.
  *
- * This method refreshes the preview image and type image based on the current Articy object.
+ * This method refreshes the preview image and type image from the cached preview data.
+ * The large type image stands in for a preview image that is still loading.
  */
 void SArticyObjectTileView::UpdateWidget()
 {
-	bHasPreviewImage = UserInterfaceHelperFunctions::RetrievePreviewImage(CachedArticyObject.Get(), PreviewBrush);
+	UTexture2D* Preview = CachedEntry.IsValid() ? CachedEntry->GetPreviewImage() : nullptr;
+	CachedImageRevision = CachedEntry.IsValid() ? CachedEntry->GetImageRevision() : 0;
+
+	bHasPreviewImage = Preview != nullptr;
+	if (bHasPreviewImage)
+	{
+		PreviewBrush.SetResourceObject(Preview);
+	}
 	// if we failed getting a preview image, use the default type image instead
-	if (!bHasPreviewImage)
+	else
 	{
-		PreviewBrush = *UserInterfaceHelperFunctions::GetArticyTypeImage(CachedArticyObject.Get(), UserInterfaceHelperFunctions::Large);
+		PreviewBrush = CachedEntry.IsValid() ? *CachedEntry->TypeImageLarge : *UserInterfaceHelperFunctions::GetArticyTypeImage(nullptr, UserInterfaceHelperFunctions::Large);
 	}
 
-	TypeImage = UserInterfaceHelperFunctions::GetArticyTypeImage(CachedArticyObject.Get(), UserInterfaceHelperFunctions::Medium);
+	TypeImage = CachedEntry.IsValid() ? CachedEntry->TypeImageMedium : UserInterfaceHelperFunctions::GetArticyTypeImage(nullptr, UserInterfaceHelperFunctions::Medium);
 }
 
 /**
@@ -90,7 +100,9 @@ void SArticyObjectTileView::Construct(const FArguments& InArgs)
 		.TextStyle(EntityNameTextStyle.Get())
 		.Justification(ETextJustify::Center);
 
-	Update(ArticyIdToDisplay.Get(FArticyId()));
+	// the object is looked up on the first tick, so widgets that are never painted, e.g. array entries scrolled out of view, never look it up
+	CachedArticyId = ArticyIdToDisplay.Get(FArticyId());
+	UpdateWidget();
 
 	SetToolTip(SNew(SArticyObjectToolTip).ObjectToDisplay(ArticyIdToDisplay));
 
@@ -169,7 +181,7 @@ void SArticyObjectTileView::Construct(const FArguments& InArgs)
 /**
  * @brief Ticks the widget for updates.
  *
- * This method is called each frame and updates the widget if the Articy ID has changed.
+ * This method is called each frame the widget is painted and updates it if the Articy ID has changed or its lookup is outdated.
  *
  * @param AllottedGeometry The geometry of the widget.
  * @param InCurrentTime The current time.
@@ -177,11 +189,16 @@ void SArticyObjectTileView::Construct(const FArguments& InArgs)
  */
 void SArticyObjectTileView::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
 {
-	// if the Id is different from the cached Id, update the widget
-	if (CachedArticyId != ArticyIdToDisplay.Get() || (!CachedArticyObject.IsValid() && !CachedArticyId.IsNull()))
+	// if the Id is different from the cached Id or the object was imported again, update the widget
+	if (CachedArticyId != ArticyIdToDisplay.Get() || !FArticyObjectPreviewCache::Get().IsResolved(CachedEntry, ResolvedGeneration))
 	{
 		Update(ArticyIdToDisplay.Get());
 	}
+	// a preview image finished loading
+	else if (CachedEntry.IsValid() && CachedEntry->GetImageRevision() != CachedImageRevision)
+	{
+		UpdateWidget();
+	}
 }
 
 /**
@@ -191,7 +208,7 @@ void SArticyObjectTileView::Tick(const FGeometry& AllottedGeometry, const double
  */
 FText SArticyObjectTileView::OnGetEntityName() const
 {
-	return FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(CachedArticyObject.Get()));
+	return CachedEntry.IsValid() ? CachedEntry->DisplayName : FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(nullptr));
 }
 
 /**
@@ -226,7 +243,7 @@ EVisibility SArticyObjectTileView::OnHasPreviewImage() const
  */
 FSlateColor SArticyObjectTileView::OnGetArticyObjectColor() const
 {
-	return UserInterfaceHelperFunctions::GetColor(CachedArticyObject.Get());
+	return CachedEntry.IsValid() ? CachedEntry->Color : FSlateColor(UserInterfaceHelperFunctions::GetColor(nullptr));
 }
 
 /**
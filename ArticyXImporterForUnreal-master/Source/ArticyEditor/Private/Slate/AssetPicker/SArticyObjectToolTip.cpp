@@ -39,15 +39,6 @@ void SArticyObjectToolTip::Construct(const FArguments& InArgs)
 
 void SArticyObjectToolTip::OnOpening()
 {
-	if (CachedArticyObject.IsValid())
-	{
-		SetContentWidget(CreateToolTipContent());
-	}
-	else
-	{
-		SetContentWidget(CreateContentForEmpty());
-	}
-
 	UpdateWidget();
 }
 
@@ -146,110 +137,55 @@ TSharedRef<SWidget> SArticyObjectToolTip::CreateTooltipWidget(FText NameText, TS
 
 TSharedRef<SWidget> SArticyObjectToolTip::CreateToolTipContent()
 {
-	// use the preview image if available
-	const bool bHasPreviewImage = UserInterfaceHelperFunctions::RetrievePreviewImage(CachedArticyObject.Get(), TooltipBrush);
-
-	// if there is no preview image, use the preview image of the speaker, if available
-	if (!bHasPreviewImage)
-	{
-		const bool bHasSpeakerPreviewImage = UserInterfaceHelperFunctions::RetrieveSpeakerPreviewImage(CachedArticyObject.Get(), TooltipBrush);
-
-		// if there is no speaker preview image, use the type image instead
-		if (!bHasSpeakerPreviewImage)
-		{
-			TooltipBrush = *UserInterfaceHelperFunctions::GetArticyTypeImage(CachedArticyObject.Get(), UserInterfaceHelperFunctions::Large);
-		}
-	}
-
-	const FString AssetName = CachedArticyObject.Get()->GetName();
-	const UClass* ClassOfObject = CachedArticyObject.Get()->UObject::GetClass();
-
-	// The tooltip contains the name, class, path, and asset registry tags
-	// Use asset name by default, overwrite with display name where it makes sense
-	FText NameText = FText::FromString(AssetName);
-	const FText ClassText = FText::Format(LOCTEXT("ClassName", "({0})"), FText::FromString(ClassOfObject->GetName()));
+	// use the preview image if available, the speaker's or the type image otherwise
+	UpdateTooltipBrush();
 
 	// Create a box to hold every line of info in the body of the tooltip
 	TSharedRef<SVerticalBox> InfoBox = SNew(SVerticalBox);
 
-	// overwrite the asset name with the display name
-	bool bUsingDisplayName = false;
-	IArticyObjectWithDisplayName* ArticyObjectWithDisplayName = Cast<IArticyObjectWithDisplayName>(CachedArticyObject);
-	if (ArticyObjectWithDisplayName)
+	if (CachedEntry->bHasSpeaker)
 	{
-		const FText DisplayName = ArticyObjectWithDisplayName->GetDisplayName();
-		if (!DisplayName.IsEmpty())
+		if (!CachedEntry->SpeakerName.IsEmpty())
 		{
-			NameText = DisplayName;
-			bUsingDisplayName = true;
-		}
-	}
-
-	IArticyObjectWithSpeaker* ArticyObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(CachedArticyObject);
-	if (ArticyObjectWithSpeaker)
-	{
-		const UArticyObject* Speaker = UArticyObject::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId());
-		// Speaker can be nullptr in case a speaker that does not exist as an entity was specified, i.e. in the scriptwriting documents
-		if (Speaker)
-		{
-			const IArticyObjectWithDisplayName* DisplayNameOfSpeaker = Cast<IArticyObjectWithDisplayName>(Speaker);
-			const FText DisplayName = DisplayNameOfSpeaker->GetDisplayName();
-			AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipSpeaker", "Speaker"),
-				DisplayName, true);
+			AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipSpeaker", "Speaker"), CachedEntry->SpeakerName, true);
 		}
 		else
 		{
 			UE_LOG(LogArticyEditor, Error, TEXT("Articy tooltip: Speaker object does not exist"))
 		}
-
 	}
 
 	// add the text to the tooltip body if possible
-	IArticyObjectWithText* ArticyObjectWithText = Cast<IArticyObjectWithText>(CachedArticyObject);
-	if (ArticyObjectWithText)
+	if (!CachedEntry->Text.IsEmpty())
 	{
-		const FText& Text = ArticyObjectWithText->GetText();
-		if (Text.IsEmpty())
-		{
-			// if there is empty text, add no text at all - maybe "..." or "Empty"?
-		}
-		else
-		{
-			AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipText", "Text"), FText::FromString(FString("\"").Append(Text.ToString()).Append("\"")), true);
-		}
+		AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipText", "Text"), CachedEntry->Text, true);
 	}
 
-
 	// if we overwrote the asset name with the display name, attach the asset name in the tooltip body
-	if (bUsingDisplayName)
+	if (CachedEntry->bUsingDisplayName)
 	{
-		AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipAssetName", "Asset Name"), FText::FromString(AssetName), false);
+		AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipAssetName", "Asset Name"), CachedEntry->AssetName, false);
 	}
 
 	// if our object has a target, add the display name of the target to the tooltip
-	const FArticyId* TargetID = UserInterfaceHelperFunctions::GetTargetID(CachedArticyObject.Get());
-	if (TargetID)
+	if (!CachedEntry->TargetName.IsEmpty())
 	{
-		UArticyObject* TargetObject = UArticyObject::FindAsset(*TargetID);
-		if (TargetObject)
-		{
-			AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipTarget", "Target"), FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(TargetObject)), false);
-		}
+		AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipTarget", "Target"), CachedEntry->TargetName, false);
 	}
 
 	// add class name
-	AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipClass", "Class"), ClassText, false);
+	AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipClass", "Class"), CachedEntry->ClassText, false);
 
 	const FText ArticyIdText = FText::FromString(ArticyIdAttribute.Get().ToString());
 	// add id
 	AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyId", "Id"), ArticyIdText, true);
 
-	return CreateTooltipWidget(NameText, InfoBox);
+	return CreateTooltipWidget(CachedEntry->NameText, InfoBox);
 }
 
 TSharedRef<SWidget> SArticyObjectToolTip::CreateContentForEmpty()
 {
-	check(!CachedArticyObject.IsValid());
+	check(!CachedEntry.IsValid());
 
 	// will result in the "empty" image
 	TooltipBrush = *UserInterfaceHelperFunctions::GetArticyTypeImage(nullptr, UserInterfaceHelperFunctions::Large);
@@ -303,9 +239,9 @@ void SArticyObjectToolTip::AddToToolTipInfoBox(const TSharedRef<SVerticalBox>& I
 void SArticyObjectToolTip::UpdateWidget()
 {
 	CachedArticyId = ArticyIdAttribute.Get();
-	CachedArticyObject = UArticyObject::FindAsset(CachedArticyId);
+	CachedEntry = FArticyObjectPreviewCache::Get().Find(CachedArticyId);
 
-	if (CachedArticyObject.IsValid())
+	if (CachedEntry.IsValid())
 	{
 		SetContentWidget(CreateToolTipContent());
 	}
@@ -315,8 +251,34 @@ void SArticyObjectToolTip::UpdateWidget()
 	}
 }
 
+void SArticyObjectToolTip::UpdateTooltipBrush() const
+{
+	CachedImageRevision = CachedEntry->GetImageRevision();
+
+	if (UTexture2D* PreviewImage = CachedEntry->GetPreviewImage())
+	{
+		TooltipBrush.SetResourceObject(PreviewImage);
+	}
+	// if there is no preview image, use the preview image of the speaker, if available
+	else if (UTexture2D* SpeakerPreviewImage = CachedEntry->GetSpeakerPreviewImage())
+	{
+		TooltipBrush.SetResourceObject(SpeakerPreviewImage);
+	}
+	// if there is no speaker preview image, or it is still loading, use the type image instead
+	else
+	{
+		TooltipBrush = *CachedEntry->TypeImageLarge;
+	}
+}
+
 const FSlateBrush* SArticyObjectToolTip::GetTooltipImage() const
 {
+	// a preview image finished loading while the tooltip is open
+	if (CachedEntry.IsValid() && CachedEntry->GetImageRevision() != CachedImageRevision)
+	{
+		UpdateTooltipBrush();
+	}
+
 	return &TooltipBrush;
 }
 
@@ -8,8 +8,8 @@
 #include "Widgets/Input/SNumericEntryBox.h"
 #include "Widgets/Input/SSearchBox.h"
 #include "Widgets/Input/SCheckBox.h"
-#include "Widgets/Layout/SScrollBox.h"
 #include "Widgets/Layout/SBox.h"
+#include "Widgets/Views/STableRow.h"
 #include "Editor.h"
 #include "ScopedTransaction.h"
 
@@ -17,234 +17,10 @@
 
 #if ENGINE_MAJOR_VERSION >= 5
 using SplitterSlotType = SSplitter::FScopedWidgetSlotArguments;
-using HorizontalBoxSlotType = SHorizontalBox::FScopedWidgetSlotArguments;
 #else
 using SplitterSlotType = SSplitter::FSlot&;
-using HorizontalBoxSlotType = SHorizontalBox::FSlot&;
 #endif
 
-void SArticyVariableSet::Construct(const FArguments& Args, TWeakObjectPtr<UArticyBaseVariableSet> InVariableSet)
-{
-	VariableSet = InVariableSet;
-
-	ensure(VariableSet.IsValid());
-
-	SizeData = Args._SizeData;
-
-	VariableContainer = SNew(SVerticalBox);
-
-	NamespaceExpansion = SNew(SExpandableArea)
-		.InitiallyCollapsed(Args._bInitiallyCollapsed)
-		.BorderBackgroundColor(FLinearColor(0.7f, 0.7f, 0.7f))
-		.HeaderContent()
-		[
-			SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-				.FillWidth(1.f)
-				[
-					SNew(STextBlock)
-						.Text(FText::FromString(VariableSet->GetName()))
-						.TextStyle(FArticyEditorStyle::Get(), TEXT("ArticyImporter.GlobalVariables.Namespace"))
-				]
-		]
-		.BodyContent()
-		[
-			VariableContainer.ToSharedRef()
-		];
-
-	BuildVariableWidgets();
-
-	ChildSlot
-		[
-			NamespaceExpansion.ToSharedRef()
-		];
-}
-
-void SArticyVariableSet::SetExpanded(bool bInExpanded) const
-{
-	NamespaceExpansion->SetExpanded(bInExpanded);
-}
-
-bool SArticyVariableSet::IsExpanded() const
-{
-	return NamespaceExpansion->IsExpanded();
-}
-
-void SArticyVariableSet::BuildVariableWidgets()
-{
-	if (bVariableWidgetsBuilt)
-	{
-		return;
-	}
-
-	TArray<UArticyVariable*> SortedVars = VariableSet->Variables;
-	SortedVars.Sort([](const UArticyVariable& LHS, const UArticyVariable& RHS)
-		{
-			return LHS.GetName().Compare(RHS.GetName(), ESearchCase::IgnoreCase) < 0 ? true : false;
-		});
-
-	for (UArticyVariable* Var : SortedVars)
-	{
-		TSharedRef<SSplitter> LocalSplitter = SNew(SSplitter);
-
-		// left variable slot
-		LocalSplitter->AddSlot()
-			.Value(SizeData->LeftColumnWidth)
-			.OnSlotResized(SizeData->OnWidthChanged)
-			[
-				SNew(STextBlock).Text_Lambda([Var]()
-					{
-						return FText::FromString(Var->GetName());
-					})
-			];
-
-		// right variable slot
-		SplitterSlotType RightVariableSlot = LocalSplitter->AddSlot();
-		RightVariableSlot.Value(SizeData->RightColumnWidth);
-		RightVariableSlot.OnSlotResized(SizeData->OnWidthChanged);
-
-		TSharedRef<SHorizontalBox> ConstrainBox = SNew(SHorizontalBox);
-		HorizontalBoxSlotType InnerVarSlot = ConstrainBox->AddSlot();
-		InnerVarSlot.AutoWidth();
-
-		RightVariableSlot
-			[
-				SNew(SBox)
-					.MinDesiredWidth(150.f)
-					.MaxDesiredWidth(300.f)
-					[
-						ConstrainBox
-					]
-			];
-
-		if (Var->GetClass() == UArticyString::StaticClass())
-		{
-			UArticyString* StringVar = Cast<UArticyString>(Var);
-			InnerVarSlot
-				[
-					SNew(SEditableTextBox)
-						.MinDesiredWidth(30.f)
-						.Text_Lambda([StringVar]()
-							{
-								return FText::FromString(StringVar->Get());
-							})
-						.OnTextCommitted_Lambda([StringVar](const FText& Text, ETextCommit::Type CommitType)
-							{
-								if (StringVar->Get().Equals(Text.ToString()))
-								{
-									return;
-								}
-
-								const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
-								StringVar->Modify();
-								*StringVar = Text.ToString();
-							})
-				];
-		}
-		else if (Var->GetClass() == UArticyInt::StaticClass())
-		{
-			UArticyInt* IntVar = Cast<UArticyInt>(Var);
-			InnerVarSlot
-				[
-					SNew(SNumericEntryBox<int32>)
-						.AllowSpin(true)
-						.MaxSliderValue(TOptional<int32>())
-						.MinSliderValue(TOptional<int32>())
-						.MinDesiredValueWidth(80.f)
-#if __cplusplus >= 202002L
-						.OnBeginSliderMovement_Lambda([=, this]()
-#else
-							.OnBeginSliderMovement_Lambda([=]()
-#endif
-								{
-									bSliderMoving = true;
-									GEditor->BeginTransaction(TEXT("Articy GV"), FText::FromString(TEXT("Modify Articy GV by Slider")), IntVar);
-								})
-#if __cplusplus >= 202002L
-							.OnEndSliderMovement_Lambda([=, this](int32 Value)
-#else
-								.OnEndSliderMovement_Lambda([=](int32 Value)
-#endif
-									{
-										bSliderMoving = false;
-										IntVar->Modify();
-										*IntVar = Value;
-										GEditor->EndTransaction();
-									})
-								.Value_Lambda([IntVar]()
-									{
-										return IntVar->Get();
-									})
-										// on value changed is only used for slider value updates
-										.OnValueChanged(this, &SArticyVariableSet::OnValueChanged, IntVar)
-#if __cplusplus >= 202002L
-										.OnValueCommitted_Lambda([=, this](int32 Value, ETextCommit::Type Type)
-#else
-											.OnValueCommitted_Lambda([=](int32 Value, ETextCommit::Type Type)
-#endif
-												{
-													if (bSliderMoving || Value == IntVar->Get())
-													{
-														return;
-													}
-
-													const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
-													IntVar->Modify();
-													*IntVar = Value;
-												})
-				];
-		}
-		else if (Var->GetClass() == UArticyBool::StaticClass())
-		{
-			UArticyBool* BoolVar = Cast<UArticyBool>(Var);
-			InnerVarSlot
-				[
-					SNew(SCheckBox)
-						.IsChecked_Lambda([BoolVar]()
-							{
-								return BoolVar->Get() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
-							})
-						.OnCheckStateChanged_Lambda([BoolVar](const ECheckBoxState& State)
-							{
-								if (*BoolVar == (State == ECheckBoxState::Checked))
-								{
-									return;
-								}
-
-								const FScopedTransaction Transaction(TEXT("ArticyGV"), LOCTEXT("ModifyGV", "Modified GV"), BoolVar);
-								bool bSavedInTranactionBuffer = BoolVar->Modify();
-								*BoolVar = State == ECheckBoxState::Checked;
-							})
-				];
-		}
-
-		VariableWidgetMapping.Add(Var, LocalSplitter);
-
-		VariableContainer->AddSlot()
-			.AutoHeight()
-			.Padding(25.f, 5.f, 5.f, 5.f)
-			[
-				LocalSplitter
-			];
-	}
-
-	bVariableWidgetsBuilt = true;
-}
-
-void SArticyVariableSet::UpdateVisibility(const UArticyVariable* Variable, EVisibility InVisibility)
-{
-	if (VariableWidgetMapping.Contains(Variable))
-	{
-		TWeakPtr<SWidget> VarWidget = VariableWidgetMapping[Variable];
-		VarWidget.Pin()->SetVisibility(InVisibility);
-	}
-}
-
-TArray<UArticyVariable*> SArticyVariableSet::GetVariables()
-{
-	return VariableSet->GetVariables();
-}
-
 void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UArticyGlobalVariables> GV)
 {
 	VariableFilter = MakeShareable(new FFrontendFilter_ArticyVariable);
@@ -260,13 +36,13 @@ void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UA
 	bInitiallyCollapsed = Args._bInitiallyCollapsed;
 
 	TSharedRef<SVerticalBox> ParentWidget = SNew(SVerticalBox);
-	SetContainer = SNew(SVerticalBox);
 
-	TSharedRef<SScrollBox> ScrollBox = SNew(SScrollBox).ScrollBarAlwaysVisible(true)
-		+ SScrollBox::Slot()
-		[
-			SetContainer.ToSharedRef()
-		];
+	// only the rows in view exist, so large sets don't create a widget for every variable
+	VariableTree = SNew(STreeView<FArticyGVTreeItemPtr>)
+		.TreeItemsSource(&FilteredSetItems)
+		.OnGenerateRow(this, &SArticyGlobalVariables::OnGenerateRow)
+		.OnGetChildren(this, &SArticyGlobalVariables::OnGetChildren)
+		.SelectionMode(ESelectionMode::None);
 
 	if (GlobalVariables.IsValid())
 	{
@@ -279,7 +55,7 @@ void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UA
 		.DelayChangeNotificationsWhileTyping(true);
 
 	ParentWidget->AddSlot().AutoHeight()[SearchBox];
-	ParentWidget->AddSlot().FillHeight(1.f)[ScrollBox];
+	ParentWidget->AddSlot().FillHeight(1.f)[VariableTree.ToSharedRef()];
 
 	ChildSlot
 		[
@@ -291,32 +67,53 @@ void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UA
 
 void SArticyGlobalVariables::UpdateDisplayedGlobalVariables(TWeakObjectPtr<UArticyGlobalVariables> InGV)
 {
-	VariableSetWidgets.Empty();
-	SetContainer->ClearChildren();
-
-	if (!InGV.IsValid())
+	// keep the expansion of sets that are shown again, e.g. for the next play session
+	TMap<FString, bool> PreviousExpansion;
+	for (const FArticyGVTreeItemPtr& SetItem : SetItems)
 	{
-		return;
+		if (SetItem->Set.IsValid())
+		{
+			PreviousExpansion.Add(SetItem->Set->GetName(), VariableTree->IsItemExpanded(SetItem));
+		}
 	}
 
-	TArray<UArticyBaseVariableSet*> SortedSets = InGV->GetVariableSets();
-	SortedSets.Sort([](const UArticyBaseVariableSet& LHS, const UArticyBaseVariableSet& RHS)
-		{
-			return LHS.GetName().Compare(RHS.GetName(), ESearchCase::IgnoreCase) < 0 ? true : false;
-		});
+	SetItems.Empty();
+	FilteredSetItems.Empty();
+	VariableTree->ClearExpandedItems();
 
-	for (UArticyBaseVariableSet* Set : SortedSets)
+	if (InGV.IsValid())
 	{
-		TSharedRef<SArticyVariableSet> VarSetWidget = SNew(SArticyVariableSet, Set)
-			.bInitiallyCollapsed(bInitiallyCollapsed)
-			.SizeData(&SizeData);
+		TArray<UArticyBaseVariableSet*> SortedSets = InGV->GetVariableSets();
+		SortedSets.Sort([](const UArticyBaseVariableSet& LHS, const UArticyBaseVariableSet& RHS)
+			{
+				return LHS.GetName().Compare(RHS.GetName(), ESearchCase::IgnoreCase) < 0 ? true : false;
+			});
 
-		VariableSetWidgets.Add(VarSetWidget);
+		for (UArticyBaseVariableSet* Set : SortedSets)
+		{
+			FArticyGVTreeItemPtr SetItem = MakeShared<FArticyGVTreeItem>();
+			SetItem->Set = Set;
 
-		SetContainer->AddSlot().AutoHeight()
-			[
-				VarSetWidget
-			];
+			TArray<UArticyVariable*> SortedVars = Set->Variables;
+			SortedVars.Sort([](const UArticyVariable& LHS, const UArticyVariable& RHS)
+				{
+					return LHS.GetName().Compare(RHS.GetName(), ESearchCase::IgnoreCase) < 0 ? true : false;
+				});
+
+			SetItem->Children.Reserve(SortedVars.Num());
+			for (UArticyVariable* Var : SortedVars)
+			{
+				FArticyGVTreeItemPtr VarItem = MakeShared<FArticyGVTreeItem>();
+				VarItem->Set = Set;
+				VarItem->Variable = Var;
+				SetItem->Children.Add(VarItem);
+			}
+
+			const bool* bWasExpanded = PreviousExpansion.Find(Set->GetName());
+			VariableTree->SetItemExpansion(SetItem, bWasExpanded ? *bWasExpanded : !bInitiallyCollapsed);
+
+			SetItems.Add(SetItem);
+		}
 	}
 
 	// retrigger the currently active filters
@@ -365,39 +162,30 @@ void SArticyGlobalVariables::OnFrontendFiltersChanged()
 		bShouldForceExpand = false;
 	}
 
-	for (TSharedPtr<SArticyVariableSet> SetWidget : VariableSetWidgets)
+	FilteredSetItems.Reset();
+	for (const FArticyGVTreeItemPtr& SetItem : SetItems)
 	{
-		uint32 NumVisible = 0;
-		TArray<UArticyVariable*> Vars = SetWidget->GetVariables();
-
-		for (UArticyVariable* Var : Vars)
+		SetItem->FilteredChildren.Reset();
+		for (const FArticyGVTreeItemPtr& VarItem : SetItem->Children)
 		{
-			const UArticyVariable* VarTmp = Var;
-			if (TestAgainstFrontendFilters(Var))
-			{
-				SetWidget->UpdateVisibility(VarTmp, EVisibility::Visible);
-				NumVisible++;
-			}
-			else
+			if (VarItem->Variable.IsValid() && TestAgainstFrontendFilters(VarItem->Variable.Get()))
 			{
-				SetWidget->UpdateVisibility(VarTmp, EVisibility::Collapsed);
+				SetItem->FilteredChildren.Add(VarItem);
 			}
 		}
 
-		if (NumVisible > 0)
+		if (SetItem->FilteredChildren.Num() > 0)
 		{
 			if (bShouldForceExpand)
 			{
-				SetWidget->SetExpanded(true);
+				VariableTree->SetItemExpansion(SetItem, true);
 			}
 
-			SetWidget->SetVisibility(EVisibility::Visible);
-		}
-		else
-		{
-			SetWidget->SetVisibility(EVisibility::Collapsed);
+			FilteredSetItems.Add(SetItem);
 		}
 	}
+
+	VariableTree->RequestTreeRefresh();
 }
 
 bool SArticyGlobalVariables::TestAgainstFrontendFilters(const UArticyVariable* Item) const
@@ -412,19 +200,180 @@ bool SArticyGlobalVariables::TestAgainstFrontendFilters(const UArticyVariable* I
 
 void SArticyGlobalVariables::CacheExpansionStates()
 {
-	for (TSharedPtr<SArticyVariableSet>& SetWidget : VariableSetWidgets)
+	for (const FArticyGVTreeItemPtr& SetItem : SetItems)
 	{
-		ExpansionCache.Add(SetWidget, SetWidget->IsExpanded());
+		if (SetItem->Set.IsValid())
+		{
+			ExpansionCache.Add(SetItem->Set->GetName(), VariableTree->IsItemExpanded(SetItem));
+		}
 	}
 }
 
 void SArticyGlobalVariables::RestoreExpansionStates()
 {
 	// restore the previous expansion state from the forced expansion
-	for (auto It = ExpansionCache.CreateIterator(); It; ++It)
+	for (const FArticyGVTreeItemPtr& SetItem : SetItems)
+	{
+		const bool* bWasExpanded = SetItem->Set.IsValid() ? ExpansionCache.Find(SetItem->Set->GetName()) : nullptr;
+		if (bWasExpanded)
+		{
+			VariableTree->SetItemExpansion(SetItem, *bWasExpanded);
+		}
+	}
+}
+
+TSharedRef<SWidget> SArticyGlobalVariables::CreateValueWidget(UArticyVariable* Var)
+{
+	if (Var->GetClass() == UArticyString::StaticClass())
+	{
+		UArticyString* StringVar = Cast<UArticyString>(Var);
+		return SNew(SEditableTextBox)
+			.MinDesiredWidth(30.f)
+			.Text_Lambda([StringVar]()
+				{
+					return FText::FromString(StringVar->Get());
+				})
+			.OnTextCommitted_Lambda([StringVar](const FText& Text, ETextCommit::Type CommitType)
+				{
+					if (StringVar->Get().Equals(Text.ToString()))
+					{
+						return;
+					}
+
+					const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
+					StringVar->Modify();
+					*StringVar = Text.ToString();
+				});
+	}
+
+	if (Var->GetClass() == UArticyInt::StaticClass())
+	{
+		UArticyInt* IntVar = Cast<UArticyInt>(Var);
+		return SNew(SNumericEntryBox<int32>)
+			.AllowSpin(true)
+			.MaxSliderValue(TOptional<int32>())
+			.MinSliderValue(TOptional<int32>())
+			.MinDesiredValueWidth(80.f)
+#if __cplusplus >= 202002L
+			.OnBeginSliderMovement_Lambda([=, this]()
+#else
+			.OnBeginSliderMovement_Lambda([=]()
+#endif
+				{
+					bSliderMoving = true;
+					GEditor->BeginTransaction(TEXT("Articy GV"), FText::FromString(TEXT("Modify Articy GV by Slider")), IntVar);
+				})
+#if __cplusplus >= 202002L
+			.OnEndSliderMovement_Lambda([=, this](int32 Value)
+#else
+			.OnEndSliderMovement_Lambda([=](int32 Value)
+#endif
+				{
+					bSliderMoving = false;
+					IntVar->Modify();
+					*IntVar = Value;
+					GEditor->EndTransaction();
+				})
+			.Value_Lambda([IntVar]()
+				{
+					return IntVar->Get();
+				})
+			// on value changed is only used for slider value updates
+			.OnValueChanged(this, &SArticyGlobalVariables::OnValueChanged, IntVar)
+#if __cplusplus >= 202002L
+			.OnValueCommitted_Lambda([=, this](int32 Value, ETextCommit::Type Type)
+#else
+			.OnValueCommitted_Lambda([=](int32 Value, ETextCommit::Type Type)
+#endif
+				{
+					if (bSliderMoving || Value == IntVar->Get())
+					{
+						return;
+					}
+
+					const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
+					IntVar->Modify();
+					*IntVar = Value;
+				});
+	}
+
+	if (Var->GetClass() == UArticyBool::StaticClass())
 	{
-		It.Key()->SetExpanded(It.Value());
+		UArticyBool* BoolVar = Cast<UArticyBool>(Var);
+		return SNew(SCheckBox)
+			.IsChecked_Lambda([BoolVar]()
+				{
+					return BoolVar->Get() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+				})
+			.OnCheckStateChanged_Lambda([BoolVar](const ECheckBoxState& State)
+				{
+					if (*BoolVar == (State == ECheckBoxState::Checked))
+					{
+						return;
+					}
+
+					const FScopedTransaction Transaction(TEXT("ArticyGV"), LOCTEXT("ModifyGV", "Modified GV"), BoolVar);
+					bool bSavedInTranactionBuffer = BoolVar->Modify();
+					*BoolVar = State == ECheckBoxState::Checked;
+				});
 	}
+
+	return SNullWidget::NullWidget;
+}
+
+TSharedRef<ITableRow> SArticyGlobalVariables::OnGenerateRow(FArticyGVTreeItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	if (!Item->IsVariable())
+	{
+		return SNew(STableRow<FArticyGVTreeItemPtr>, OwnerTable)
+			.Padding(FMargin(0.f, 4.f))
+			[
+				SNew(STextBlock)
+					.Text(FText::FromString(Item->Set.IsValid() ? Item->Set->GetName() : FString()))
+					.TextStyle(FArticyEditorStyle::Get(), TEXT("ArticyImporter.GlobalVariables.Namespace"))
+			];
+	}
+
+	UArticyVariable* Var = Item->Variable.Get();
+	TSharedRef<SSplitter> LocalSplitter = SNew(SSplitter);
+
+	// left variable slot
+	LocalSplitter->AddSlot()
+		.Value(SizeData.LeftColumnWidth)
+		.OnSlotResized(SizeData.OnWidthChanged)
+		[
+			SNew(STextBlock).Text(FText::FromString(Var->GetName()))
+		];
+
+	// right variable slot
+	SplitterSlotType RightVariableSlot = LocalSplitter->AddSlot();
+	RightVariableSlot.Value(SizeData.RightColumnWidth);
+	RightVariableSlot.OnSlotResized(SizeData.OnWidthChanged);
+	RightVariableSlot
+		[
+			SNew(SBox)
+				.MinDesiredWidth(150.f)
+				.MaxDesiredWidth(300.f)
+				[
+					SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						[
+							CreateValueWidget(Var)
+						]
+				]
+		];
+
+	return SNew(STableRow<FArticyGVTreeItemPtr>, OwnerTable)
+		.Padding(FMargin(5.f))
+		[
+			LocalSplitter
+		];
+}
+
+void SArticyGlobalVariables::OnGetChildren(FArticyGVTreeItemPtr Item, TArray<FArticyGVTreeItemPtr>& OutChildren) const
+{
+	OutChildren = Item->FilteredChildren;
 }
 
 #undef LOCTEXT_NAMESPACE
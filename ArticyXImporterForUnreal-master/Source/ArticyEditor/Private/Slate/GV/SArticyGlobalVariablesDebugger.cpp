@@ -75,24 +75,63 @@ void SArticyGlobalVariablesRuntimeDebugger::Construct(const FArguments& Args)
 		[
 			RuntimeSwitcher.ToSharedRef()
 		];
+
+	RuntimeSwitchHandles.Add(FEditorDelegates::PostPIEStarted.AddSP(this, &SArticyGlobalVariablesRuntimeDebugger::OnPIEStarted));
+	RuntimeSwitchHandles.Add(FEditorDelegates::EndPIE.AddSP(this, &SArticyGlobalVariablesRuntimeDebugger::OnPIEEnded));
+	RuntimeSwitchHandles.Add(FWorldDelegates::OnPostWorldInitialization.AddSP(this, &SArticyGlobalVariablesRuntimeDebugger::OnPostWorldInitialization));
+
+	// the debugger may be opened while a session is already running
+	if (GEditor->GetPIEWorldContext())
+	{
+		OnPIEStarted(false);
+	}
 }
 
 /**
- * Updates the state of the widget every frame.
+ * Unbinds from the PIE and world events.
+ */
+SArticyGlobalVariablesRuntimeDebugger::~SArticyGlobalVariablesRuntimeDebugger()
+{
+	FEditorDelegates::PostPIEStarted.Remove(RuntimeSwitchHandles[0]);
+	FEditorDelegates::EndPIE.Remove(RuntimeSwitchHandles[1]);
+	FWorldDelegates::OnPostWorldInitialization.Remove(RuntimeSwitchHandles[2]);
+}
+
+/**
+ * Shows the Global Variables of the PIE world once play started.
  *
- * @param AllottedGeometry The geometry of the widget.
- * @param InCurrentTime The current time.
- * @param InDeltaTime The time since the last tick.
+ * @param bIsSimulating Whether the session is simulating.
  */
-void SArticyGlobalVariablesRuntimeDebugger::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+void SArticyGlobalVariablesRuntimeDebugger::OnPIEStarted(bool bIsSimulating)
 {
-	if (!CurrentGlobalVariables.IsValid() && GEditor->GetPIEWorldContext())
+	const FWorldContext* PIEWorldContext = GEditor->GetPIEWorldContext();
+	if (PIEWorldContext && PIEWorldContext->World())
 	{
-		UpdateGVInstance(UArticyGlobalVariables::GetDefault(GEditor->GetPIEWorldContext()->World()));
+		UpdateGVInstance(UArticyGlobalVariables::GetDefault(PIEWorldContext->World()));
 	}
-	else if (CurrentGlobalVariables.IsValid() && !GEditor->GetPIEWorldContext())
+}
+
+/**
+ * Clears the displayed Global Variables once play ended.
+ *
+ * @param bIsSimulating Whether the session was simulating.
+ */
+void SArticyGlobalVariablesRuntimeDebugger::OnPIEEnded(bool bIsSimulating)
+{
+	UpdateGVInstance(nullptr);
+}
+
+/**
+ * Picks up the Global Variables of a world that was loaded during play, if the shown instance went away with the previous one.
+ *
+ * @param World The world that was initialized.
+ * @param IVS The initialization values of the world.
+ */
+void SArticyGlobalVariablesRuntimeDebugger::OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS)
+{
+	if (!CurrentGlobalVariables.IsValid() && World && World->WorldType == EWorldType::PIE)
 	{
-		UpdateGVInstance(nullptr);
+		UpdateGVInstance(UArticyGlobalVariables::GetDefault(World));
 	}
 }
 
@@ -155,7 +194,7 @@ void SArticyGlobalVariablesRuntimeDebugger::BuildGVPickerContent(FMenuBuilder& M
  */
 void SArticyGlobalVariablesRuntimeDebugger::OnSelectGVs(TWeakObjectPtr<UArticyGlobalVariables> InVars)
 {
-	CurrentGlobalVariables = InVars;
+	UpdateGVInstance(InVars);
 }
 
 /**
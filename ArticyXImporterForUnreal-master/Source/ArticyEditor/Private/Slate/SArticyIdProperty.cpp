@@ -71,13 +71,12 @@ void SArticyIdProperty::Construct(const FArguments& InArgs)
 
 	SetCursor(EMouseCursor::Hand);
 
+	// the object and the customizations are resolved on the first tick, details panels only tick the rows in view
 	CachedArticyId = ArticyIdToDisplay.Get(FArticyId());
-	CachedArticyObject = !CachedArticyId.IsNull() ? UArticyObject::FindAsset(CachedArticyId) : nullptr;
+	CachedDisplayName = FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(nullptr));
 
 	CreateInternalWidgets();
 
-	UpdateWidget();
-
 	this->ChildSlot
 		[
 			ChildBox.ToSharedRef()
@@ -85,7 +84,7 @@ void SArticyIdProperty::Construct(const FArguments& InArgs)
 }
 
 /**
- * Ticks the SArticyIdProperty widget, updating it if necessary.
+ * Ticks the SArticyIdProperty widget, updating it if the id changed or its lookup is outdated.
  *
  * @param AllottedGeometry The allotted geometry of the widget.
  * @param InCurrentTime The current time.
@@ -94,7 +93,7 @@ void SArticyIdProperty::Construct(const FArguments& InArgs)
 void SArticyIdProperty::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
 {
 	const FArticyId CurrentRefId = ArticyIdToDisplay.Get() ? ArticyIdToDisplay.Get() : FArticyId();
-	if (CurrentRefId != CachedArticyId || (!CurrentRefId.IsNull() && !CachedArticyObject.IsValid()))
+	if (CurrentRefId != CachedArticyId || !FArticyObjectPreviewCache::Get().IsResolved(CachedEntry, ResolvedGeneration))
 	{
 		Update(CurrentRefId);
 	}
@@ -217,7 +216,10 @@ void SArticyIdProperty::Update(const FArticyId& NewId)
 {
 	// the actual update. This will be forwarded into the tile view and will cause an update
 	CachedArticyId = NewId;
-	CachedArticyObject = !CachedArticyId.IsNull() ? UArticyObject::FindAsset(CachedArticyId) : nullptr;
+	CachedEntry = FArticyObjectPreviewCache::Get().Find(CachedArticyId);
+	ResolvedGeneration = FArticyObjectPreviewCache::Get().GetGeneration();
+	CachedArticyObject = CachedEntry.IsValid() ? CachedEntry->Object.Get() : nullptr;
+	CachedDisplayName = CachedEntry.IsValid() ? CachedEntry->DisplayName : FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(nullptr));
 
 	UpdateWidget();
 }
@@ -363,14 +365,13 @@ FReply SArticyIdProperty::OnAssetThumbnailDoubleClick(const FGeometry& InMyGeome
 }
 
 /**
- * Gets the display name of the current Articy object.
+ * Gets the display name of the current Articy object, as the shared preview cache holds it.
  *
  * @return The display name as text.
  */
 FText SArticyIdProperty::OnGetArticyObjectDisplayName() const
 {
-	const FString DisplayName = UserInterfaceHelperFunctions::GetDisplayName(CachedArticyObject.Get());
-	return FText::FromString(DisplayName);
+	return CachedDisplayName;
 }
 
 /**
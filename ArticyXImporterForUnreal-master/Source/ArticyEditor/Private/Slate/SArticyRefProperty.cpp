@@ -60,7 +60,8 @@ void SArticyRefProperty::Construct(const FArguments& InArgs)
 void SArticyRefProperty::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
 {
 	const FArticyRef& CurrentRef = ArticyRefToDisplay.IsBound() || ArticyRefToDisplay.IsSet() ? ArticyRefToDisplay.Get() : FArticyRef();
-	if (CurrentRef != CachedArticyRef || (!CurrentRef.GetId().IsNull() && !CachedArticyObject.IsValid()))
+	// the object is resolved by the id widget, through the shared preview cache
+	if (CurrentRef != CachedArticyRef)
 	{
 		Update(CurrentRef);
 	}
@@ -243,7 +244,6 @@ void SArticyRefProperty::CreateAdditionalRefWidgets(FToolBarBuilder& Builder)
 void SArticyRefProperty::Update(const FArticyRef& NewRef)
 {
 	CachedArticyRef = NewRef;
-	CachedArticyObject = !CachedArticyRef.GetId().IsNull() ? UArticyObject::FindAsset(CachedArticyRef.GetId()) : nullptr;
 
 	UpdateWidget();
 }
@@ -8,17 +8,113 @@
 #include "ISourceControlModule.h"
 #include "ISourceControlProvider.h"
 #include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
 #include "SourceControlHelpers.h"
 
+namespace
+{
+    /** Bytes buffered before they are written to the temporary file */
+    constexpr int32 StringTableBufferSize = 64 * 1024;
+
+    /**
+     * Hashes a file a chunk at a time.
+     *
+     * @param Filename The file to hash.
+     * @param OutDigest The MD5 digest of the file.
+     * @return True if the file could be read, false otherwise.
+     */
+    bool HashFile(const FString& Filename, uint8 (&OutDigest)[16])
+    {
+        const TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename));
+        if (!Reader)
+            return false;
+
+        FMD5 FileHash;
+        TArray<uint8> Chunk;
+        Chunk.SetNumUninitialized(StringTableBufferSize);
+        const int64 TotalSize = Reader->TotalSize();
+        for (int64 Offset = 0; Offset < TotalSize; Offset += StringTableBufferSize)
+        {
+            const int32 ChunkSize = static_cast<int32>(FMath::Min<int64>(TotalSize - Offset, StringTableBufferSize));
+            Reader->Serialize(Chunk.GetData(), ChunkSize);
+            FileHash.Update(Chunk.GetData(), ChunkSize);
+        }
+        FileHash.Final(OutDigest);
+        return !Reader->IsError();
+    }
+}
+
+StringTableGenerator::~StringTableGenerator()
+{
+    Writer.Reset();
+    if (!TempPath.IsEmpty())
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+}
+
 void StringTableGenerator::Line(const FString& Key, const FString& SourceString)
 {
-    FileContent += TEXT("\"") + Key.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\",\"") + SourceString.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\",\"") + TEXT("\"\n");
+    LineBuffer.Reset();
+    LineBuffer += TEXT("\"");
+    LineBuffer += Key.Replace(TEXT("\""), TEXT("\"\""));
+    LineBuffer += TEXT("\",\"");
+    LineBuffer += SourceString.Replace(TEXT("\""), TEXT("\"\""));
+    LineBuffer += TEXT("\",\"\"\n");
+
+    const FTCHARToUTF8 Utf8(*LineBuffer, LineBuffer.Len());
+    Buffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+    if (Buffer.Num() >= StringTableBufferSize)
+        Flush();
+}
+
+void StringTableGenerator::BeginFile()
+{
+    TempPath = Path + TEXT(".tmp");
+    Writer.Reset(IFileManager::Get().CreateFileWriter(*TempPath));
+    Buffer.Reserve(StringTableBufferSize + 1024);
+
+    // Same encoding as FFileHelper::SaveStringToFile with ForceUTF8, so unchanged tables compare equal
+    static const uint8 Bom[] = { 0xEF, 0xBB, 0xBF };
+    Buffer.Append(Bom, UE_ARRAY_COUNT(Bom));
+}
+
+void StringTableGenerator::Flush()
+{
+    if (Writer && Buffer.Num() > 0)
+    {
+        Writer->Serialize(Buffer.GetData(), Buffer.Num());
+        Hash.Update(Buffer.GetData(), Buffer.Num());
+        Size += Buffer.Num();
+    }
+    Buffer.Reset();
+}
+
+void StringTableGenerator::EndFile(bool bContentWritten)
+{
+    Flush();
+
+    const bool bWriteFailed = !Writer || !Writer->Close();
+    Writer.Reset();
+
+    bChanged = bContentWritten && !bWriteFailed;
+    if (!bChanged)
+        return;
+
+    // Keep the existing file if it has the same bytes
+    if (IFileManager::Get().FileSize(*Path) == Size)
+    {
+        uint8 Digest[16];
+        uint8 ExistingDigest[16];
+        Hash.Final(Digest);
+        if (HashFile(Path, ExistingDigest) && FMemory::Memcmp(Digest, ExistingDigest, sizeof(Digest)) == 0)
+            bChanged = false;
+    }
 }
 
-void StringTableGenerator::WriteToFile() const
+void StringTableGenerator::Commit()
 {
-    if (FileContent.IsEmpty())
+    if (!bChanged)
         return;
+    bChanged = false;
 
     IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
     ISourceControlModule& SCModule = ISourceControlModule::Get();
@@ -37,7 +133,9 @@ void StringTableGenerator::WriteToFile() const
         bFileExisted = true;
     }
 
-    const bool bFileWritten = FFileHelper::SaveStringToFile(FileContent, *Path, FFileHelper::EEncodingOptions::ForceUTF8);
+    const bool bFileWritten = IFileManager::Get().Move(*Path, *TempPath, true, true);
+    if (bFileWritten)
+        TempPath.Empty();
 
     // Mark the file for addition if it is newly created
     if (!bFileExisted && bFileWritten && SCModule.IsEnabled())
@@ -6,14 +6,21 @@
 
 #include "Containers/UnrealString.h"
 #include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/Archive.h"
+#include "Templates/UniquePtr.h"
 
 /**
  * @class StringTableGenerator
  * @brief A class to generate and manage string tables in CSV format.
  *
- * This class holds a content string that can be written to a CSV file.
- * It is used for generating string tables for localization purposes, where each
+ * This class streams the CSV to a temporary file through a small UTF-8 buffer, so a table is never
+ * held in memory as a whole. It is used for generating string tables for localization purposes, where each
  * entry consists of a key and its corresponding source string.
+ *
+ * The table only replaces the existing file if its content differs, so unchanged tables are neither
+ * written nor checked out. Generators for different tables can run in parallel if they don't commit,
+ * Commit is then called on the game thread since it talks to source control.
  */
 class StringTableGenerator
 {
@@ -41,9 +48,20 @@ public:
      * @param TableName The name of the string table.
      * @param Culture The culture/language code for localization.
      * @param ContentGenerator A lambda function to generate the content of the string table.
+     * @param bCommit Whether to replace the existing table right away, otherwise Commit must be called.
      */
     template<typename Lambda>
-    StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator);
+    StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator, const bool bCommit = true);
+
+    /** Deletes the temporary file if the table was never committed. */
+    ~StringTableGenerator();
+
+    /**
+     * @brief Replaces the existing table with the generated one if it changed.
+     *
+     * Checks out or marks the file for add in source control, so it must be called on the game thread.
+     */
+    void Commit();
 
     /**
      * @brief Adds a line to the content string.
@@ -58,15 +76,39 @@ private:
     /** The file path where the CSV will be saved. */
     FString Path;
 
-    /** The accumulated content of the CSV file. */
-    FString FileContent = "";
+    /** The temporary file the CSV is streamed to. */
+    FString TempPath;
+
+    /** The writer of the temporary file. */
+    TUniquePtr<FArchive> Writer;
+
+    /** UTF-8 bytes not yet written to the temporary file. */
+    TArray<uint8> Buffer;
+
+    /** The line being escaped, kept to reuse its memory. */
+    FString LineBuffer;
+
+    /** Hash of the bytes written so far. */
+    FMD5 Hash;
+
+    /** Number of bytes written so far. */
+    int64 Size = 0;
+
+    /** Whether the generated table differs from the existing one. */
+    bool bChanged = false;
+
+    /** Opens the temporary file and writes the byte order mark. */
+    void BeginFile();
+
+    /** Writes the buffered bytes to the temporary file. */
+    void Flush();
 
     /**
-     * @brief Writes the content to a file.
+     * @brief Closes the temporary file and compares it with the existing table.
      *
-     * This method saves the accumulated file content to the specified file path.
+     * @param bContentWritten Whether the content generator produced any entries.
      */
-    void WriteToFile() const;
+    void EndFile(bool bContentWritten);
 };
 
 //---------------------------------------------------------------------------//
@@ -85,7 +127,7 @@ inline void StringTableGenerator::SafeExecute(nullptr_t Lamb)
 }
 
 template <typename Lambda>
-StringTableGenerator::StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator)
+StringTableGenerator::StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator, const bool bCommit)
 {
     const FString FilePath = TEXT("ArticyContent/Generated") / TableName;
     if (Culture.IsEmpty())
@@ -98,11 +140,13 @@ StringTableGenerator::StringTableGenerator(const FString& TableName, const FStri
     }
     Path += TEXT(".csv");
 
+    BeginFile();
     Line("Key", "SourceString");
     bool bContentWritten = false;
     if (ensure(!std::is_null_pointer<Lambda>::value))
         bContentWritten = ContentGenerator(this) != 0;
 
-    if (bContentWritten)
-        WriteToFile();
+    EndFile(bContentWritten);
+    if (bCommit)
+        Commit();
 }
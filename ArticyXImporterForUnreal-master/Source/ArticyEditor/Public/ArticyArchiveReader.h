@@ -7,6 +7,7 @@
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
 #include "Dom/JsonObject.h"
+#include "Async/MappedFileHandle.h"
 #include "ArticyArchiveReader.generated.h"
 
 /**
@@ -31,6 +32,19 @@ struct ARTICYEDITOR_API FArticyArchiveHeader
 	uint64 FileDictionaryPos;
 };
 
+/**
+ * Flags of a file within an Articy archive.
+ */
+namespace EArticyArchiveFileFlags
+{
+	enum Type : int16
+	{
+		None = 0,
+		/** The file is stored zlib compressed, PackedLength bytes inflate to UnpackedLength bytes. */
+		Compressed = 1 << 0,
+	};
+}
+
 /**
  * Structure that represents metadata for a file within an Articy archive.
  */
@@ -51,6 +65,43 @@ struct ARTICYEDITOR_API FArticyArchiveFileData
 	FString Filename;
 };
 
+/**
+ * A bounded pool of buffers that compressed archive files are decoded into, reused across decodes.
+ */
+class ARTICYEDITOR_API FArticyDecodeBufferPool
+{
+public:
+	/**
+	 * @param InMaxBuffers The number of buffers kept for reuse, also the number of parallel decodes.
+	 */
+	explicit FArticyDecodeBufferPool(int32 InMaxBuffers = 8) : MaxBuffers(FMath::Max(1, InMaxBuffers)) {}
+
+	/**
+	 * Takes a buffer out of the pool, or a new one if none is free.
+	 *
+	 * @return The buffer, empty but possibly with capacity.
+	 */
+	TArray<uint8> Acquire();
+
+	/**
+	 * Returns a buffer to the pool, it is freed if the pool is full.
+	 *
+	 * @param Buffer The buffer to return.
+	 */
+	void Release(TArray<uint8>&& Buffer);
+
+	/** Frees all buffers in the pool. */
+	void Empty();
+
+	/** Gets the number of buffers kept for reuse. */
+	int32 GetMaxBuffers() const { return MaxBuffers; }
+
+private:
+	FCriticalSection Lock;
+	TArray<TArray<uint8>> FreeBuffers;
+	int32 MaxBuffers;
+};
+
 /**
  * Class responsible for reading and processing Articy archives.
  */
@@ -69,7 +120,25 @@ public:
 	bool OpenArchive(const FString& InArchiveFileName);
 
 	/**
-	 * Reads a file from the archive.
+	 * Releases the archive's mapping, views returned by ReadFileBytes are invalid afterwards.
+	 */
+	void CloseArchive();
+
+	virtual void BeginDestroy() override;
+
+	/**
+	 * Gets the bytes of a file in the archive without copying them.
+	 * The view points into the mapped archive, or into the decoded file for compressed ones,
+	 * and stays valid until the archive is closed.
+	 *
+	 * @param Filename The name of the file to read from the archive.
+	 * @param OutBytes The view that will receive the file's UTF-8 content.
+	 * @return True if the file was found in the archive; otherwise, false.
+	 */
+	bool ReadFileBytes(const FString& Filename, TArrayView<const uint8>& OutBytes) const;
+
+	/**
+	 * Reads a file from the archive, converting it to a string.
 	 *
 	 * @param Filename The name of the file to read from the archive.
 	 * @param OutResult The string that will receive the file's content.
@@ -86,12 +155,54 @@ public:
 	 */
 	static FString ArchiveBytesToString(const uint8* In, int32 Count);
 
+	/**
+	 * Hashes the bytes a file is stored with in the archive, without decoding them.
+	 *
+	 * @param Filename The name of the file to hash.
+	 * @param OutHash The string that will receive the hash.
+	 * @return True if the file was found in the archive; otherwise, false.
+	 */
+	bool HashFile(const FString& Filename, FString& OutHash) const;
+
+	/**
+	 * Decodes the compressed files referenced by FileName fields anywhere in a manifest, in parallel.
+	 * ReadFile returns the decoded strings until ReleasePrefetchedFiles is called.
+	 *
+	 * @param JsonRoot The manifest to collect file names from.
+	 * @param UnchangedHashes Hashes of files the import will not read again, files with one of them are skipped.
+	 */
+	void PrefetchFiles(const TSharedPtr<FJsonObject>& JsonRoot, const TSet<FString>& UnchangedHashes = TSet<FString>()) const;
+
+	/**
+	 * Decodes compressed files of the archive in parallel through the task graph.
+	 *
+	 * @param Filenames The names of the files to decode, uncompressed ones are skipped.
+	 */
+	void PrefetchFiles(const TArray<FString>& Filenames) const;
+
+	/**
+	 * Decodes and parses the changed files referenced by FileName fields anywhere in a manifest, in parallel.
+	 * Only reads the archive, so it can run off the game thread. FetchJson returns the parsed objects
+	 * until ReleasePrefetchedFiles is called.
+	 *
+	 * @param JsonRoot The manifest to collect file names from.
+	 * @param UnchangedHashes Hashes of files the import will not read again, files with one of them are skipped.
+	 * @return The number of files that changed.
+	 */
+	int32 ParseFiles(const TSharedPtr<FJsonObject>& JsonRoot, const TSet<FString>& UnchangedHashes = TSet<FString>()) const;
+
+	/**
+	 * Frees the strings decoded by PrefetchFiles and the objects parsed by ParseFiles.
+	 */
+	void ReleasePrefetchedFiles() const;
+
 	/**
 	 * Fetches a JSON object from the archive, verifying the hash for changes.
+	 * The file's bytes in the archive are hashed, so unchanged files are neither decoded nor parsed.
 	 *
 	 * @param JsonRoot The root JSON object to search within.
 	 * @param FieldName The field name containing the desired JSON object.
-	 * @param Hash The hash value to check against.
+	 * @param Hash The hash of the file's last import, updated if the file changed.
 	 * @param OutJsonObject The resulting JSON object, if found and changed.
 	 * @return True if the JSON object was successfully fetched and changed; otherwise, false.
 	 */
@@ -116,10 +227,59 @@ protected:
 	 */
 	bool ReadFileData();
 
+	/**
+	 * Maps the archive file into memory, or loads it if the platform cannot map it.
+	 *
+	 * @return True if the archive's bytes are available; otherwise, false.
+	 */
+	bool MapArchive();
+
+	/**
+	 * Finds a file's entry and its packed bytes in the archive.
+	 *
+	 * @param Filename The name of the file.
+	 * @param OutEntry The entry of the file.
+	 * @param OutPacked The view that will receive the file's packed bytes.
+	 * @return True if the file was found and is within the archive; otherwise, false.
+	 */
+	bool FindPackedFile(const FString& Filename, const FArticyArchiveFileData*& OutEntry, TArrayView<const uint8>& OutPacked) const;
+
+	/**
+	 * Inflates a compressed file.
+	 *
+	 * @param FileEntry The entry of the file.
+	 * @param Packed The file's packed bytes.
+	 * @param OutBytes The buffer that will receive the unpacked bytes, its capacity is reused.
+	 * @return True if the file was decoded; otherwise, false.
+	 */
+	static bool DecompressFile(const FArticyArchiveFileData& FileEntry, TArrayView<const uint8> Packed, TArray<uint8>& OutBytes);
+
 	/** The name of the archive file. */
 	FString ArchiveFileName;
 	/** The header information of the archive. */
 	FArticyArchiveHeader Header;
 	/** The dictionary of files contained in the archive. */
 	TMap<FString, FArticyArchiveFileData> FileDictionary;
+
+	/** The archive mapping, kept open for the reader's lifetime. */
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	/** The mapped view of the whole archive. */
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	/** The archive's bytes if it could not be mapped. */
+	TArray<uint8> LoadedArchive;
+	/** The archive's bytes, either mapped or loaded. */
+	TArrayView<const uint8> ArchiveBytes;
+
+	/** Guards the decoded and prefetched files. */
+	mutable FCriticalSection DecodeLock;
+	/** Compressed files decoded for ReadFileBytes, kept until the archive is closed. */
+	mutable TMap<FString, TArray<uint8>> DecodedFiles;
+	/** Compressed files decoded to strings by PrefetchFiles. */
+	mutable TMap<FString, FString> PrefetchedFiles;
+	/** Files parsed by ParseFiles. */
+	mutable TMap<FString, TSharedPtr<FJsonObject>> ParsedFiles;
+	/** Hashes of the files HashFile was called for, the archive's bytes do not change while it is open. */
+	mutable TMap<FString, FString> FileHashes;
+	/** The buffers for decoding compressed files. */
+	mutable FArticyDecodeBufferPool DecodeBuffers;
 };
@@ -62,6 +62,13 @@ public:
 	 */
 	static EImportDataEnsureResult EnsureImportDataAsset(UArticyImportData**);
 
+	/**
+	 * Gets the Articy directory of the plugin settings as an absolute path, the directory the .articyue file is looked for in.
+	 *
+	 * @return The absolute path of the Articy directory.
+	 */
+	static FString GetAbsoluteArticyDirectory();
+
 private:
 	/**
 	 * Generates a new Articy import data asset.
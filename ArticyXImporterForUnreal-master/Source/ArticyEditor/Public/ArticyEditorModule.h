@@ -7,10 +7,12 @@
 #include "Modules/ModuleInterface.h"
 #include "Modules/ModuleManager.h"
 #include "Delegates/IDelegateInstance.h"
+#include "Containers/Ticker.h"
 #include "ArticyEditorConsoleCommands.h"
 #include "Customizations/ArticyEditorCustomizationManager.h"
 #include "Framework/Commands/UICommandList.h"
 #include "Slate/SArticyIdProperty.h"
+#include "ArticyPackageQuery.h"
 
 
 DECLARE_LOG_CATEGORY_EXTERN(LogArticyEditor, Log, All)
@@ -65,6 +67,13 @@ public:
 	 */
 	TArray<UArticyPackage*> ARTICYEDITOR_API GetPackagesSlow();
 
+	/**
+	 * Get the query answering questions about the packages from their asset registry tags, created on first use.
+	 *
+	 * @return Reference to the package query.
+	 */
+	FArticyPackageQuery& ARTICYEDITOR_API GetPackageQuery();
+
 	void RegisterArticyToolbar();
 	void RegisterAssetTypeActions();
 	void RegisterConsoleCommands();
@@ -72,7 +81,10 @@ public:
 	void RegisterDefaultArticyIdPropertyWidgetExtensions() const;
 	void RegisterDetailCustomizations() const;
 	void RegisterDirectoryWatcher();
+	/** Watches the Articy directory for new exports, registered again if an import moved the directory */
+	void RegisterExportWatcher();
 	void RegisterGraphPinFactory() const;
+	void RegisterPackageChunkRules() const;
 	void RegisterPluginCommands();
 	void RegisterPluginSettings() const;
 	void RegisterToolTabs();
@@ -94,6 +106,13 @@ private:
 	EImportStatusValidity CheckImportStatusValidity() const;
 	void OnGeneratedCodeChanged(const TArray<struct FFileChangeData>& FileChanges) const;
 
+	void UnregisterExportWatcher();
+	void OnExportChanged(const TArray<struct FFileChangeData>& FileChanges);
+	/** Reimports the export once it did not change for the delay of the plugin settings */
+	void ScheduleExportReimport();
+	bool TickExportReimport(float DeltaTime);
+	void StartBackgroundReimport();
+
 	void UnqueueImport();
 	void TriggerQueuedImport(bool b);
 
@@ -110,11 +129,19 @@ private:
 	bool bIsImportQueued = false;
 	FDelegateHandle QueuedImportHandle;
 	FDelegateHandle GeneratedCodeWatcherHandle;
+	FDelegateHandle ExportWatcherHandle;
+	FString WatchedExportDirectory;
+	FTSTicker::FDelegateHandle ExportReimportHandle;
+	/** Time of the last change to the export, every change of a burst restarts the delay */
+	double LastExportChangeTime = 0.0;
+	bool bIsBackgroundReimportRunning = false;
 	FArticyEditorConsoleCommands* ConsoleCommands = nullptr;
 	TSharedPtr<FUICommandList> PluginCommands;
 	/** The CustomizationManager registers and owns all customization factories */
 	TSharedPtr<FArticyEditorCustomizationManager> CustomizationManager = nullptr;
 
+	TUniquePtr<FArticyPackageQuery> PackageQuery;
+
 	/** The CustomizationManager has ownership of the factories. These here are cached for removal at shutdown */
 	TArray<const IArticyIdPropertyWidgetCustomizationFactory*> DefaultArticyRefWidgetCustomizationFactories;
 };
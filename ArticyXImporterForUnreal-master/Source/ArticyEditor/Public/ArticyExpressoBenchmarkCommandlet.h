@@ -0,0 +1,43 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ArticyExpressoScripts.h"
+#include "ArticyExpressoBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the ExpressoType operators, conversions and property reads generated conditions and instructions
+ * are made of, with the time and allocations of each operation.
+ *
+ * UnrealEditor-Cmd <Project> -run=ArticyExpressoBenchmark [-Iterations=1000000] [-Object=<TechnicalName>] [-Property=<Name>]
+ *
+ * Property reads use the DisplayName of the first loaded object that has one unless -Object and -Property are given.
+ */
+UCLASS()
+class UArticyExpressoBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+    /**
+     * Runs every operation Iterations times and logs its cycles, nanoseconds and allocations per operation.
+     *
+     * @param Params Command line parameters passed to the commandlet.
+     * @return 0 once the benchmark ran, 1 if the object to read properties of was not found.
+     */
+    virtual int32 Main(const FString& Params) override;
+};
+
+/**
+ * Exposes the script methods generated scripts call to the benchmark.
+ */
+UCLASS(Transient)
+class UArticyExpressoBenchmarkScripts : public UArticyExpressoScripts
+{
+    GENERATED_BODY()
+
+public:
+    using UArticyExpressoScripts::random;
+};
@@ -0,0 +1,31 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ArticyFlowTraceCommandlet.generated.h"
+
+/**
+ * Rebuilds the flow timeline from the ArticyFlow channel of a trace, e.g. one recorded on a devkit with
+ * -trace=ArticyFlow, and writes it as a log and a JSON file.
+ *
+ * UnrealEditor-Cmd <Project> -run=ArticyFlowTrace -Trace=<File.utrace> [-Out=<File.json>]
+ *
+ * Each event is listed with its time and flow player, indented by the shadow level the player was at.
+ * Object IDs are resolved to technical names if the articy database of the trace is imported.
+ */
+UCLASS()
+class UArticyFlowTraceCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+    /**
+     * Analyzes the trace and writes its timeline.
+     *
+     * @param Params Command line parameters passed to the commandlet.
+     * @return 0 if the timeline was written, 1 otherwise.
+     */
+    virtual int32 Main(const FString& Params) override;
+};
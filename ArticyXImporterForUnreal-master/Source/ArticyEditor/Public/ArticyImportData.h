@@ -57,6 +57,9 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "Settings")
 	FString ScriptMethodsHash = "";
 
+	UPROPERTY(VisibleAnywhere, Category = "Settings")
+	FString ManifestHash = "";
+
 	void ImportFromJson(const TSharedPtr<FJsonObject> JsonRoot);
 
 	bool DidObjectDefsOrGVsChange() const { return bObjectDefsOrGVsChanged; }
@@ -356,6 +359,17 @@ public:
 	FString ParsedFragment = "";
 	UPROPERTY(VisibleAnywhere, Category = "Script")
 	bool bIsInstruction = false;
+	/** The first package the fragment was gathered from, its code is generated into that package's file. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	FString PackageName = "";
+	/** The fragment whose generated function this one shares, because both compile to the same code. Empty if it has its own. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	FString SharedFragment = "";
+	/** The fragment does the same in any state, it is registered with ConstantResult instead of generated code. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bIsConstant = false;
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bConstantResult = true;
 
 	bool operator==(const FArticyExpressoFragment& Other) const
 	{
@@ -369,7 +383,28 @@ inline uint32 GetTypeHash(const FArticyExpressoFragment& A)
 }
 
 /**
- * Structure for Articy import data.
+ * State of an imported audio source file, used to skip files that did not change since their last import.
+ */
+USTRUCT()
+struct FArticyAudioAssetRecord
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = "Audio")
+	int64 Size = -1;
+	UPROPERTY(VisibleAnywhere, Category = "Audio")
+	FDateTime Timestamp;
+	/** MD5 of the file contents, only computed when size or timestamp changed. */
+	UPROPERTY(VisibleAnywhere, Category = "Audio")
+	FString Hash;
+	UPROPERTY(VisibleAnywhere, Category = "Audio")
+	FSoftObjectPath SoundWave;
+};
+
+/**
+ * The parts of the import data a previous import is restored from, each property is one section.
+ * They are written to the cached version file instead of the import asset, see UArticyImportData::BuildCachedVersion.
  */
 USTRUCT()
 struct ARTICYEDITOR_API FArticyImportDataStruct
@@ -423,6 +458,9 @@ public:
 
 	bool ImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject> RootObject);
 
+	/** Adds the hashes of the files the last import read, files of a new export with one of them are not read again. */
+	void GatherImportedFileHashes(TSet<FString>& OutHashes) const;
+
 	const static TWeakObjectPtr<UArticyImportData> GetImportData();
 	const FAdiSettings& GetSettings() const { return Settings; }
 	FAdiSettings& GetSettings() { return Settings; }
@@ -441,13 +479,19 @@ public:
 	void GatherScripts();
 	void AddScriptFragment(const FString& Fragment, const bool bIsInstruction);
 	const TSet<FArticyExpressoFragment>& GetScriptFragments() const { return ScriptFragments; }
+	/** Sets the package that fragments added from now on are attributed to. */
+	void SetScriptFragmentPackage(const FString& PackageName) { ScriptFragmentPackage = PackageName; }
 
 	void AddChildToParentCache(FArticyId Parent, FArticyId Child);
 	const TMap<FArticyId, FArticyIdArray>& GetParentChildrenCache() const { return ParentChildrenCache; }
 
+	/** Writes the current import to the cached version file, compressed, rewriting only the sections that changed. */
 	void BuildCachedVersion();
-	void ResolveCachedVersion();
-	bool HasCachedVersion() const { return bHasCachedVersion; }
+	/** Loads the cached version file back into the import data, false if it could not be read. */
+	bool ResolveCachedVersion();
+	bool HasCachedVersion() const;
+	/** The compressed copy of the last working import, next to the project's intermediate files. */
+	FString GetCachedVersionFilename() const;
 
 	void SetInitialImportComplete() { bHasCachedVersion = true; }
 
@@ -456,9 +500,6 @@ public:
 
 protected:
 
-	UPROPERTY(VisibleAnywhere, Category = "Articy")
-	FArticyImportDataStruct CachedData;
-
 	// indicates whether we've had at least one working import. Used to determine if we want to re
 	UPROPERTY()
 	bool bHasCachedVersion = false;
@@ -491,6 +532,16 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Imported")
 	TMap<FArticyId, FArticyIdArray> ParentChildrenCache;
 
+	/** The package whose scripts are being gathered. */
+	FString ScriptFragmentPackage;
+
+	/** The first fragment gathered for each piece of generated code, only used while gathering. */
+	TMap<FString, FString> ScriptFragmentsByCode;
+
+	/** Audio source files relative to the asset directory, mapped to the state they were last imported with. */
+	UPROPERTY(VisibleAnywhere, Category = "Imported")
+	TMap<FString, FArticyAudioAssetRecord> AudioAssetManifest;
+
 	void ImportAudioAssets(const FString& BaseContentDir);
-	int ProcessStrings(StringTableGenerator* CsvOutput, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language);
+	int ProcessStrings(StringTableGenerator* CsvOutput, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language) const;
 };
@@ -181,26 +181,42 @@ namespace ArticyImporterHelpers
 
 		auto FullClassName = FString::Printf(TEXT("Class'/Script/%s.%s'"), ModuleName, ClassName);
 		if (auto UClass = ConstructorHelpersInternal::FindOrLoadClass(FullClassName, AssetType::StaticClass()))
-		{
-			// only public, not standalone, since the assets are bound to their outers
-			EObjectFlags Flags = RF_Public;
-			AssetType* CreatedAsset = NewObject<AssetType>(Outer, UClass, FName(*ActualAssetName), Flags);
-
-			// if we successfully created the asset, notify the asset registry and mark it dirty
-			if (CreatedAsset)
-			{
-				// Notify the asset registry
-				FAssetRegistryModule::AssetCreated(Cast<UObject>(CreatedAsset));
-			}
-
-			return CreatedAsset;
-		}
+			return GenerateSubAsset<AssetType>(UClass, ActualAssetName, Outer);
 
 		//UE_LOG(LogArticyEditor, Error, TEXT("ArticyImporter: Could not find class %s!"), ClassName);
 
 		return nullptr;
 	}
 
+	/**
+	 * @brief Generates a sub-asset of a class that was already found.
+	 *
+	 * @tparam AssetType The type of sub-asset to generate.
+	 * @param Class The class of the sub-asset, derived from AssetType.
+	 * @param AssetName The name of the sub-asset to generate.
+	 * @param Outer The outer object that will own the sub-asset.
+	 * @return A pointer to the generated sub-asset, or nullptr on failure.
+	 */
+	template <typename AssetType>
+	AssetType* GenerateSubAsset(UClass* Class, const FString& AssetName, UObject* Outer)
+	{
+		if (!Outer || !Class)
+			return nullptr;
+
+		// only public, not standalone, since the assets are bound to their outers
+		EObjectFlags Flags = RF_Public;
+		AssetType* CreatedAsset = NewObject<AssetType>(Outer, Class, FName(*AssetName), Flags);
+
+		// if we successfully created the asset, notify the asset registry and mark it dirty
+		if (CreatedAsset)
+		{
+			// Notify the asset registry
+			FAssetRegistryModule::AssetCreated(Cast<UObject>(CreatedAsset));
+		}
+
+		return CreatedAsset;
+	}
+
 	/**
 	 * @brief Checks if the engine is running in Play In Editor (PIE) mode.
 	 *
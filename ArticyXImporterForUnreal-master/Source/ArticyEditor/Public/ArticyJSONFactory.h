@@ -84,6 +84,17 @@ public:
     virtual EReimportResult::Type Reimport(UObject* Obj) override;
     //~FReimportHandler
 
+    /**
+     * Reimports the changes of an asset's export without blocking the editor.
+     * The archive is opened, compared with the last import and its changed files are parsed on a worker thread,
+     * then the changes are applied through the regular incremental import on the game thread.
+     *
+     * @param Asset The Articy import data object to reimport.
+     * @param OnFinished Called on the game thread with Succeeded if the changes were applied or there were none,
+     * Cancelled if play mode was entered or the asset was deleted meanwhile, Failed if the export could not be read.
+     */
+    static void ReimportInBackground(UArticyImportData* Asset, TFunction<void(EReimportResult::Type)> OnFinished);
+
 private:
     /**
      * Performs the actual import task, converting the JSON data into UArticyImportData.
@@ -0,0 +1,28 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ArticyLineExportCommandlet.generated.h"
+
+/**
+ * Exports every reachable dialogue line with its speaker to a CSV file for localization and voice-over scripts,
+ * see FArticyLineExporter.
+ *
+ * UnrealEditor-Cmd <Project> -run=ArticyLineExport [-Out=<Path.csv>] [-Start=<IdOrTechnicalName>[,...]] [-DefaultPackagesOnly]
+ */
+UCLASS()
+class UArticyLineExportCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+    /**
+     * Loads the packages, bakes their flow and writes the CSV.
+     *
+     * @param Params Command line parameters passed to the commandlet.
+     * @return 0 if the CSV was written, 1 otherwise.
+     */
+    virtual int32 Main(const FString& Params) override;
+};
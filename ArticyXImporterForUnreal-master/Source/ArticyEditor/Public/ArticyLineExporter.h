@@ -0,0 +1,93 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+
+class UArticyDatabase;
+
+/**
+ * @brief Exports every reachable dialogue line with its speaker for localization and voice-over scripts.
+ *
+ * Instead of driving a flow player through every branch, the flow of the loaded objects is baked once into
+ * index arrays and walked as a graph. Each line and hub becomes one row listing the rows that can follow it,
+ * so the suffixes shared by many paths are written once and the export grows with the graph, not with the
+ * number of paths. Conditions are ignored, every line any branch can reach is exported.
+ */
+class ARTICYEDITOR_API FArticyLineExporter
+{
+public:
+	/**
+	 * @brief Bakes the flow of all objects the database has loaded.
+	 *
+	 * Reads the objects' pins, connections and texts, so it must be called on the game thread.
+	 *
+	 * @param Database The database whose loaded packages are exported.
+	 */
+	void Bake(const UArticyDatabase* Database);
+
+	/**
+	 * @brief Writes the rows to a CSV file in play order, streaming them through a small buffer.
+	 *
+	 * The rows following each row are found in parallel. Columns are Order, Id, TechnicalName, Type, Speaker,
+	 * Text, StageDirections and Next, the IDs of the following rows separated by spaces.
+	 *
+	 * @param Filename The CSV file to write.
+	 * @param StartIds Objects play starts at, the rows no other row leads to if empty.
+	 * @return False if the file could not be written.
+	 */
+	bool ExportCsv(const FString& Filename, TConstArrayView<FArticyId> StartIds = {});
+
+	/** Number of dialogue lines and hubs baked. */
+	int32 GetNumRows() const { return Rows.Num(); }
+
+	/** Number of nodes and pins baked. */
+	int32 GetNumVertices() const { return Vertices.Num(); }
+
+private:
+	/** A node or pin of the baked flow. */
+	struct FVertex
+	{
+		/** Vertices the flow continues at, in Successors. */
+		int32 FirstSuccessor = 0;
+		int32 NumSuccessors = 0;
+
+		/** Row of a line or hub, INDEX_NONE for the vertices the flow only passes through. */
+		int32 Row = INDEX_NONE;
+	};
+
+	struct FRow
+	{
+		int32 Vertex = INDEX_NONE;
+		FArticyId Id;
+		FString TechnicalName;
+		FString Type;
+		FString Speaker;
+		FString Text;
+		FString StageDirections;
+
+		/** Rows that can follow this one, found by ExportCsv. */
+		TArray<int32> Next;
+	};
+
+	/**
+	 * @brief Collects the rows reached first from a vertex, walking through all vertices that are no row.
+	 *
+	 * @param Vertex The vertex to start at, it is not collected itself.
+	 * @param OutRows Receives the rows in the order they are reached.
+	 */
+	void CollectNextRows(int32 Vertex, TArray<int32>& OutRows) const;
+
+	TArray<FVertex> Vertices;
+	TArray<int32> Successors;
+	TArray<FRow> Rows;
+
+	/** Vertex of every baked node by ID. */
+	TMap<FArticyId, int32> NodeVertices;
+
+	/** Connected input pins of the nodes play submerges into when starting at them, by node ID. */
+	TMap<FArticyId, TArray<int32>> SubmergeVertices;
+};
@@ -0,0 +1,127 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "ArticyBaseTypes.h"
+
+/**
+ * @brief Answers questions about articy packages from the tags they save to the asset registry, see ArticyPackageTags.
+ *
+ * Tools need not load every package to find out which ones contain an object or speaker. The tags are parsed on the
+ * first query and again after the asset registry reported a change to an articy package. Packages saved before
+ * they had the tags are only found once they are imported again.
+ */
+class ARTICYEDITOR_API FArticyPackageQuery
+{
+public:
+	FArticyPackageQuery();
+	~FArticyPackageQuery();
+
+	/**
+	 * @brief Gets the query of the editor module.
+	 */
+	static FArticyPackageQuery& Get();
+
+	/**
+	 * @brief Finds the packages with objects spoken by a character.
+	 *
+	 * @param SpeakerId The ID of the speaking entity.
+	 * @return The packages, in no particular order.
+	 */
+	TArray<FAssetData> FindPackagesWithSpeaker(const FArticyId& SpeakerId);
+
+	/**
+	 * @brief Finds the package containing an object.
+	 *
+	 * @param Id The ID of the object.
+	 * @return The package, invalid if no package contains the object.
+	 */
+	FAssetData FindPackageWithObject(const FArticyId& Id);
+
+	/**
+	 * @brief Finds the packages whose connections or jumps lead into a package.
+	 *
+	 * @param PackageName The name of the package the articy package asset is in.
+	 * @return The referencing packages.
+	 */
+	TArray<FAssetData> FindReferencingPackages(FName PackageName);
+
+	/**
+	 * @brief Finds the packages the connections and jumps of a package lead into.
+	 *
+	 * @param PackageName The name of the package the articy package asset is in.
+	 * @return The referenced packages.
+	 */
+	TArray<FAssetData> FindReferencedPackages(FName PackageName);
+
+	/**
+	 * @brief Gets the articy packages known to the asset registry.
+	 */
+	const TArray<FAssetData>& GetPackages();
+
+	/**
+	 * @brief Gets the value of a numerical tag such as ArticyPackageTags::NumObjects.
+	 *
+	 * @param Package The articy package asset.
+	 * @param Tag The name of the tag.
+	 * @return The value, INDEX_NONE if the package was saved without the tag.
+	 */
+	static int64 GetCount(const FAssetData& Package, const TCHAR* Tag);
+
+	/**
+	 * @brief Gets the number of objects by class path of a package.
+	 *
+	 * @param Package The articy package asset.
+	 * @param OutCounts Receives the counts by class path.
+	 * @return False if the package was saved without the tag.
+	 */
+	static bool GetClassCounts(const FAssetData& Package, TMap<FString, int32>& OutCounts);
+
+	/**
+	 * @brief Checks whether a package may contain objects of a class, without loading it.
+	 *
+	 * @param Package The articy package asset.
+	 * @param Class The class to look for, any object matches if null.
+	 * @param bExactClass Whether objects of subclasses do not match.
+	 * @return False only if the tags of the package show it contains no such object.
+	 */
+	static bool MayContainClass(const FAssetData& Package, const UClass* Class, bool bExactClass);
+
+	/**
+	 * @brief Calls a function for every ID of a list tag such as ArticyPackageTags::Speakers.
+	 *
+	 * @param Package The articy package asset.
+	 * @param Tag The name of the tag.
+	 * @param Function The function to call.
+	 */
+	static void ForEachId(const FAssetData& Package, const TCHAR* Tag, TFunctionRef<void(const FArticyId&)> Function);
+
+private:
+	/** Parses the tags of all packages, if they changed since the last query. */
+	void Update();
+
+	void OnAssetChanged(const FAssetData& Asset);
+	void OnAssetRenamed(const FAssetData& Asset, const FString& OldObjectPath);
+
+	TArray<FAssetData> Packages;
+
+	/** The index in Packages of the package of every object. */
+	TMap<FArticyId, int32> PackageByObject;
+
+	/** The indices in Packages of the packages with objects of every speaker. */
+	TMultiMap<FArticyId, int32> PackagesBySpeaker;
+
+	/** The index in Packages by package name. */
+	TMap<FName, int32> PackageByName;
+
+	bool bDirty = true;
+
+	FDelegateHandle AddedHandle;
+	FDelegateHandle RemovedHandle;
+	FDelegateHandle UpdatedHandle;
+	FDelegateHandle RenamedHandle;
+};
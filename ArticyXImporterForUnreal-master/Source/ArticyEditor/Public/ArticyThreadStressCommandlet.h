@@ -0,0 +1,32 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ArticyThreadStressCommandlet.generated.h"
+
+/**
+ * Checks that texts prepared on worker threads match the texts resolved on the game thread, and measures how
+ * preparation scales with the number of concurrent requests, see UArticyTextExtension::PrepareTexts.
+ *
+ * UnrealEditor-Cmd <Project> -run=ArticyThreadStress [-MaxRequests=32] [-Rounds=4] [-DefaultPackagesOnly] [-Report=<Path.json>]
+ *
+ * Each concurrent request prepares the texts and menu texts of all loaded objects, as that many flow players
+ * calling PrepareBranchTexts at once would. Flow player components themselves only run on the game thread.
+ * Build the editor with -EnableTSan or -EnableASan to run the commandlet under a sanitizer.
+ */
+UCLASS()
+class UArticyThreadStressCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+    /**
+     * Resolves the reference texts, then prepares them with 1 to MaxRequests concurrent requests.
+     *
+     * @param Params Command line parameters passed to the commandlet.
+     * @return 0 if every prepared text matched its reference, 1 otherwise.
+     */
+    virtual int32 Main(const FString& Params) override;
+};
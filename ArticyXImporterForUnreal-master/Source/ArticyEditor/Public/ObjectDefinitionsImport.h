@@ -16,6 +16,65 @@ struct FArticyModelDef;
 class CodeFileGenerator;
 struct FArticyObjectDefinitions;
 
+/**
+ * The steps of initializing models of one type, baked from its definition, its parents and their templates once per
+ * asset generation. Models are then initialized without looking up definitions, property setters and classes by name.
+ */
+struct FArticyModelInitializer
+{
+    /** Sets a property from the model's JSON if it has a value there. */
+    struct FPropertyStep
+    {
+        /** Name of the value in the JSON. */
+        FString Key;
+        /** Appended to the path of the model or feature, "." and the key. */
+        FString PathSuffix;
+        FName Property;
+        FArticyPredefinedTypeBase* Setter = nullptr;
+        const FArticyType* ArticyType = nullptr;
+    };
+
+    /** Creates a feature of the model's template and sets its properties. */
+    struct FFeatureStep
+    {
+        FString TechnicalName;
+        FString PathSuffix;
+        FName Property;
+        UClass* Class = nullptr;
+        TArray<FPropertyStep> Properties;
+        const FArticyType* ArticyType = nullptr;
+    };
+
+    /** The steps of one definition of the type's class chain. */
+    struct FDefinitionStep
+    {
+        TArray<FPropertyStep> Properties;
+        TArray<FFeatureStep> Features;
+        bool bHasTemplate = false;
+        const FArticyType* TemplateType = nullptr;
+        const FArticyType* ArticyType = nullptr;
+    };
+
+    /** The generated class of the models, null if it was not found. */
+    UClass* Class = nullptr;
+    FString ClassName;
+
+    /** Steps of the definitions, parents first. */
+    TArray<FDefinitionStep> Definitions;
+
+    /**
+     * Initializes a model with data from the model definition.
+     *
+     * @param Model A pointer to the UArticyPrimitive object.
+     * @param Values The model definition containing the values.
+     * @param PackageName The name of the package.
+     */
+    void Initialize(UArticyPrimitive* Model, const FArticyModelDef& Values, const FString& PackageName) const;
+
+private:
+    static void SetProperties(UArticyBaseObject* Model, TConstArrayView<FPropertyStep> Properties, const FString& Path, const TSharedPtr<FJsonObject>& Json, const FString& PackageName);
+};
+
 /**
  * Represents a template constraint in Articy.
  */
@@ -77,20 +136,12 @@ public:
     void GatherScript(const TSharedPtr<FJsonObject>& JsonValue, UArticyImportData* Data) const;
 
     /**
-     * Initializes a model with data from JSON.
+     * Bakes the step setting this property on models.
      *
-     * @param Model A pointer to the UArticyBaseObject.
-     * @param Path The path of the model.
-     * @param JsonValue A shared pointer to the JSON object containing the data.
-     * @param Data A pointer to the UArticyImportData object.
-     * @param PackageName The name of the package.
+     * @param OutStep The step to fill.
+     * @return False if the property's type has no setter.
      */
-    void InitializeModel(
-        UArticyBaseObject* Model,
-        const FString& Path,
-        const TSharedPtr<FJsonObject>& JsonValue,
-        const UArticyImportData* Data,
-        const FString& PackageName) const;
+    bool BakeInitializerStep(FArticyModelInitializer::FPropertyStep& OutStep) const;
 
     /**
      * Returns the name of the property.
@@ -204,20 +255,12 @@ public:
     void GatherScripts(const TSharedPtr<FJsonObject>& Json, UArticyImportData* Data) const;
 
     /**
-     * Initializes a model with data from JSON.
+     * Bakes the step creating this feature on models and setting its properties.
      *
-     * @param Model A pointer to the UArticyPrimitive object.
-     * @param Path The path of the model.
-     * @param Json A shared pointer to the JSON object containing the data.
      * @param Data A pointer to the UArticyImportData object.
-     * @param PackageName The name of the package.
+     * @return The baked step.
      */
-    void InitializeModel(
-        UArticyPrimitive* Model,
-        const FString& Path,
-        const TSharedPtr<FJsonObject>& Json,
-        const UArticyImportData* Data,
-        const FString& PackageName) const;
+    FArticyModelInitializer::FFeatureStep BakeInitializerStep(const UArticyImportData* Data) const;
 
     /**
      * Returns the C++ type of the template feature.
@@ -308,20 +351,12 @@ public:
     void GatherScripts(const TSharedPtr<FJsonObject> Values, UArticyImportData* Data) const;
 
     /**
-     * Initializes a model with data from JSON values.
+     * Bakes the steps creating the template's features on models.
      *
-     * @param Model A pointer to the UArticyPrimitive object.
-     * @param Path The path of the model.
-     * @param Values A shared pointer to the JSON object containing the values.
+     * @param Step The step of the definition owning the template.
      * @param Data A pointer to the UArticyImportData object.
-     * @param PackageName The name of the package.
      */
-    void InitializeModel(
-        UArticyPrimitive* Model,
-        const FString& Path,
-        const TSharedPtr<FJsonObject> Values,
-        const UArticyImportData* Data,
-        const FString& PackageName) const;
+    void BakeInitializerSteps(FArticyModelInitializer::FDefinitionStep& Step, const UArticyImportData* Data) const;
 
     /**
      * Returns the display name of the template.
@@ -407,18 +442,12 @@ public:
     void GatherScripts(const FArticyModelDef& Values, UArticyImportData* Data) const;
 
     /**
-     * Initializes a model with data from the model definition.
+     * Bakes the steps of this definition and its parents, parents first.
      *
-     * @param Model A pointer to the UArticyPrimitive object.
-     * @param Values The model definition containing the values.
+     * @param Initializer The initializer to add the steps to.
      * @param Data A pointer to the UArticyImportData object.
-     * @param PackageName The name of the package.
      */
-    void InitializeModel(
-        UArticyPrimitive* Model,
-        const FArticyModelDef& Values,
-        const UArticyImportData* Data,
-        const FString& PackageName) const;
+    void BakeInitializer(FArticyModelInitializer& Initializer, const UArticyImportData* Data) const;
 
     /**
      * Returns the C++ type of the object definition.
@@ -451,6 +480,20 @@ public:
      */
     const TArray<FArticyTemplateFeatureDef>& GetFeatures() const;
 
+    /**
+     * Returns the hash of the JSON the definition was imported from.
+     *
+     * @return The hash, empty if the definition was imported before definitions were hashed.
+     */
+    const FString& GetDefinitionHash() const { return DefinitionHash; }
+
+    /**
+     * Sets the hash of the JSON the definition was imported from.
+     *
+     * @param Hash The hash of the definition.
+     */
+    void SetDefinitionHash(const FString& Hash) { DefinitionHash = Hash; }
+
     UPROPERTY(VisibleAnywhere, Category = "ObjectDef")
     FArticyType ArticyType;
 
@@ -475,6 +518,10 @@ private:
     /** Only for enums. */
     UPROPERTY(VisibleAnywhere, Category = "ObjectDef")
     TArray<FArticyEnumValue> Values;
+
+    /** Hash of the JSON the definition was imported from, unchanged definitions are not imported again. */
+    UPROPERTY(VisibleAnywhere, Category = "ObjectDef")
+    FString DefinitionHash;
 };
 
 /**
@@ -488,11 +535,13 @@ struct FArticyObjectDefinitions
 public:
     /**
      * Imports object definitions from a JSON array.
+     * Definitions whose JSON did not change since the previous import are kept instead of being imported again.
      *
      * @param Json A pointer to the array of JSON values containing the object definitions.
      * @param Data A pointer to the UArticyImportData object.
+     * @return True if any definition was added, changed or removed, i.e. the generated types need to be generated again.
      */
-    void ImportFromJson(const TArray<TSharedPtr<FJsonValue>>* Json, const UArticyImportData* Data);
+    bool ImportFromJson(const TArray<TSharedPtr<FJsonValue>>* Json, const UArticyImportData* Data);
 
     /**
      * Gather scripts from model definition and adds them to the UArticyImportData.
@@ -519,6 +568,20 @@ public:
      */
     void InitializeModel(UArticyPrimitive* Model, const FArticyModelDef& Values, const UArticyImportData* Data, const FString& PackageName) const;
 
+    /**
+     * Returns the initializer of a type's models, baking it on first use.
+     *
+     * @param OriginalType The type of the models.
+     * @param Data A pointer to the UArticyImportData object.
+     * @return The initializer, null if the type is not defined.
+     */
+    const FArticyModelInitializer* GetModelInitializer(const FName& OriginalType, const UArticyImportData* Data) const;
+
+    /**
+     * Frees the baked initializers, they point into the definitions and the generated classes, which change with the next import.
+     */
+    void ResetModelInitializers() const;
+
     /**
      * Returns the C++ type of an object definition.
      *
@@ -639,4 +702,7 @@ private:
 
     UPROPERTY(VisibleAnywhere, Category = "ObjectDefinitions")
     TMap<FName, FArticyTemplateFeatureDef> FeatureDefs;
+
+    /** Initializers baked by GetModelInitializer during an asset generation, null for undefined types. */
+    mutable TMap<FName, TSharedPtr<FArticyModelInitializer>> ModelInitializers;
 };
@@ -14,6 +14,7 @@
 
 
 class UArticyImportData;
+class FArticyPackageSaver;
 struct FAdiSettings;
 
 /**
@@ -177,6 +178,14 @@ public:
 	 */
 	void ImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject>& JsonPackage);
 
+	/**
+	 * Imports only the ID, name and inclusion state of a package, without fetching its files.
+	 *
+	 * @param JsonPackage A shared pointer to the JSON object containing the package definition.
+	 * @return True if the package's data is included in the export, false otherwise.
+	 */
+	bool ImportInfoFromJson(const TSharedPtr<FJsonObject>& JsonPackage);
+
 	/**
 	 * Gathers scripts from the package definition and adds them to the ArticyImportData.
 	 *
@@ -204,7 +213,7 @@ public:
 	 *
 	 * @return A map of text data.
 	 */
-	TMap<FString, FArticyTexts> GetTexts() const;
+	const TMap<FString, FArticyTexts>& GetTexts() const;
 
 	/**
 	 * Gets the folder path for the package.
@@ -262,6 +271,34 @@ public:
 	 */
 	FString GetScriptFragmentHash() const;
 
+	/**
+	 * Gets the object definitions of the package.
+	 *
+	 * @return The object definitions, in export order.
+	 */
+	const TArray<FArticyModelDef>& GetModels() const { return Models; }
+
+	/**
+	 * Checks if the package's objects were parsed by the running import, unchanged objects are kept from the last one.
+	 *
+	 * @return True if the objects file changed, false otherwise.
+	 */
+	bool DidObjectsChange() const { return bObjectsChanged; }
+
+	/**
+	 * Checks if the package's texts were parsed by the running import, unchanged texts are kept from the last one.
+	 *
+	 * @return True if the texts file changed, false otherwise.
+	 */
+	bool DidTextsChange() const { return bTextsChanged; }
+
+	/**
+	 * Adds the hashes of the package's files as of the last import.
+	 *
+	 * @param OutHashes The set that receives the hashes.
+	 */
+	void GatherFileHashes(TSet<FString>& OutHashes) const;
+
 	/**
 	 * Equality operator for package definitions based on ID.
 	 *
@@ -302,6 +339,9 @@ private:
 
 	bool IsIncluded = false;
 	FString PreviousName = TEXT("");
+
+	bool bObjectsChanged = false;
+	bool bTextsChanged = false;
 };
 
 /**
@@ -320,8 +360,9 @@ public:
 	 * @param Archive A reference to the ArticyArchiveReader object.
 	 * @param Json A pointer to the JSON array containing the package definitions.
 	 * @param Settings A reference to the FADISettings object.
+	 * @return True if a package was added, removed or renamed, or one of its files changed.
 	 */
-	void ImportFromJson(const UArticyArchiveReader& Archive, const TArray<TSharedPtr<FJsonValue>>* Json, FAdiSettings& Settings);
+	bool ImportFromJson(const UArticyArchiveReader& Archive, const TArray<TSharedPtr<FJsonValue>>* Json, FAdiSettings& Settings);
 
 	/**
 	 * Validates the import of package definitions from a JSON array.
@@ -342,9 +383,13 @@ public:
 	/**
 	 * Generates assets for all package definitions and stores them in the ArticyImportData.
 	 *
+	 * A package is finished as soon as the packages holding the children of its objects are generated, and handed
+	 * to the saver, so it is saved while the packages after it are generated.
+	 *
 	 * @param Data A pointer to the UArticyImportData object.
+	 * @param Saver Saves each package once it is finished, the packages are only generated if null.
 	 */
-	void GenerateAssets(UArticyImportData* Data) const;//MM_CHANGE
+	void GenerateAssets(UArticyImportData* Data, FArticyPackageSaver* Saver = nullptr) const;//MM_CHANGE
 
 	/**
 	 * Gets the texts map from a specific package definition.
@@ -368,6 +413,13 @@ public:
 	 */
 	TArray<FArticyPackageDef> GetPackages() const;
 
+	/**
+	 * Adds the hashes of all packages' files as of the last import.
+	 *
+	 * @param OutHashes The set that receives the hashes.
+	 */
+	void GatherFileHashes(TSet<FString>& OutHashes) const;
+
 	/**
 	 * Resets the packages array, clearing all package definitions.
 	 */
@@ -93,6 +93,9 @@ private:
 
 	/** Expression evaluator that can be used to perform complex text filter queries */
 	FTextFilterExpressionEvaluator TextFilterExpressionEvaluator;
+
+	/** Clears the strings cached by the expression context after an import */
+	FDelegateHandle ImportFinishedHandle;
 };
 
 /**
@@ -118,6 +121,16 @@ public:
 	 * @param bNewExactClass Whether the class restriction is exact.
 	 */
 	void UpdateExactClass(bool bNewExactClass) { bExactClass = bNewExactClass; OnChanged().Broadcast(); }
+	/** Gets the class allowed by the filter.
+	 *
+	 * @return The allowed class.
+	 */
+	UClass* GetAllowedClass() const { return AllowedClass.Get(); }
+	/** Gets whether the class restriction is exact.
+	 *
+	 * @return True if subclasses are not allowed.
+	 */
+	bool IsExactClass() const { return bExactClass; }
 	// IFilter implementation
 	/** Determines if the given item passes the class restriction filter.
 	 *
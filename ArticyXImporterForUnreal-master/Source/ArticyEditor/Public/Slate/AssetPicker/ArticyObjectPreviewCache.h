@@ -0,0 +1,160 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "Containers/LruCache.h"
+#include "Engine/StreamableManager.h"
+#include "Styling/SlateColor.h"
+
+class UArticyObject;
+class UTexture2D;
+struct FSlateBrush;
+
+/**
+ * @brief What the tile views, tooltips and property widgets show of an Articy object.
+ *
+ * Gathered once per object and shared, so scrolling through tiles or details panels does not look up
+ * display names, colors, speakers and targets again for every widget and every paint. Ids without an
+ * object are remembered as well until the next import. Preview images are streamed in asynchronously,
+ * the type image is shown in their place until they are loaded.
+ */
+class ARTICYEDITOR_API FArticyObjectPreviewCache
+{
+public:
+	/**
+	 * @brief The cached data of one object.
+	 */
+	struct FEntry
+	{
+		TWeakObjectPtr<UArticyObject> Object;
+
+		/** Import the entry was gathered after, see IsCurrent */
+		uint32 Generation = 0;
+
+		/** Tile label and border color */
+		FText DisplayName;
+		FSlateColor Color;
+
+		/** Type images, the large one is the placeholder for a missing preview image */
+		const FSlateBrush* TypeImageLarge = nullptr;
+		const FSlateBrush* TypeImageMedium = nullptr;
+
+		/** Tooltip title, the display name if there is one, the asset name otherwise */
+		FText NameText;
+		bool bUsingDisplayName = false;
+		FText AssetName;
+		FText ClassText;
+
+		/** Empty if the object has no such field or it could not be resolved */
+		FText SpeakerName;
+		FText Text;
+		FText TargetName;
+		bool bHasSpeaker = false;
+
+		/**
+		 * @brief Gets the preview image of the object, once it is loaded.
+		 *
+		 * @return The loaded preview image, or nullptr.
+		 */
+		UTexture2D* GetPreviewImage() const { return PreviewImage.Get(); }
+
+		/**
+		 * @brief Gets the preview image of the speaker of the object, once it is loaded.
+		 *
+		 * @return The loaded speaker preview image, or nullptr.
+		 */
+		UTexture2D* GetSpeakerPreviewImage() const { return SpeakerPreviewImage.Get(); }
+
+		/**
+		 * @brief Checks whether the object has a preview image, loaded or not.
+		 *
+		 * @return True if there is a preview image to wait for.
+		 */
+		bool HasPreviewImage() const { return !PreviewPath.IsNull(); }
+
+		/**
+		 * @brief Counts the images that finished loading, widgets compare it to update their brushes.
+		 *
+		 * @return The number of loaded images.
+		 */
+		uint32 GetImageRevision() const { return ImageRevision; }
+
+	private:
+		friend class FArticyObjectPreviewCache;
+
+		FSoftObjectPath PreviewPath;
+		FSoftObjectPath SpeakerPreviewPath;
+		TWeakObjectPtr<UTexture2D> PreviewImage;
+		TWeakObjectPtr<UTexture2D> SpeakerPreviewImage;
+
+		/** Keep the images loaded as long as the entry is cached */
+		TSharedPtr<FStreamableHandle> PreviewHandle;
+		TSharedPtr<FStreamableHandle> SpeakerPreviewHandle;
+
+		uint32 ImageRevision = 0;
+	};
+
+	/**
+	 * @brief Gets the cache shared by all pickers.
+	 *
+	 * @return The shared cache.
+	 */
+	static FArticyObjectPreviewCache& Get();
+
+	/**
+	 * @brief Gets the entry of an object, gathering it if it isn't cached.
+	 *
+	 * @param Id The id of the object.
+	 * @return The entry, or nullptr if there is no object with that id.
+	 */
+	TSharedPtr<const FEntry> Find(const FArticyId& Id);
+
+	/**
+	 * @brief Checks whether an entry still describes its object, it is gathered again otherwise.
+	 *
+	 * @param Entry The entry a widget holds on to.
+	 * @return True if the entry is from the last import and its object still exists.
+	 */
+	bool IsCurrent(const FEntry& Entry) const { return Entry.Generation == Generation && Entry.Object.IsValid(); }
+
+	/**
+	 * @brief Checks whether a widget's lookup of an id is still valid, so it needn't call Find again.
+	 *
+	 * @param Entry The entry Find returned, nullptr if there was no object.
+	 * @param ResolvedGeneration The generation when the widget called Find, 0 if it never did.
+	 * @return True if the widget still shows what Find would return.
+	 */
+	bool IsResolved(const TSharedPtr<const FEntry>& Entry, uint32 ResolvedGeneration) const { return Entry.IsValid() ? IsCurrent(*Entry) : ResolvedGeneration == Generation; }
+
+	/** Incremented with every import, never 0. */
+	uint32 GetGeneration() const { return Generation; }
+
+	/**
+	 * @brief Drops all entries, e.g. after an import changed the objects.
+	 */
+	void Invalidate();
+
+private:
+	FArticyObjectPreviewCache();
+
+	/** Gathers the entry of an object, starting to load its images */
+	TSharedRef<FEntry> CreateEntry(UArticyObject* Object);
+
+	/** Starts loading an image of an entry, or takes it right away if it is already loaded */
+	void RequestImage(const TSharedRef<FEntry>& Entry, const FSoftObjectPath& Path, bool bSpeaker);
+
+	/** Objects most recently shown are kept, the least recently shown ones are dropped once the cache is full */
+	TLruCache<FArticyId, TSharedRef<FEntry>> Entries;
+
+	/** Ids without an object found since the last import, so widgets showing them don't search the assets again */
+	TSet<FArticyId> MissingIds;
+
+	FStreamableManager StreamableManager;
+
+	/** Incremented with every import */
+	uint32 Generation = 1;
+};
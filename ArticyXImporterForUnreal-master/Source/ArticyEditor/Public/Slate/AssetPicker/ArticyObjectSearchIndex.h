@@ -0,0 +1,174 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
+
+class UArticyObject;
+
+/**
+ * @brief Searchable strings of all Articy objects, for the asset picker.
+ *
+ * Objects are gathered on the game thread a few at a time, since their texts can only be read there.
+ * Once complete, the index does not change and can be searched from any thread. It is shared by all
+ * pickers and gathered again after the next import.
+ */
+class ARTICYEDITOR_API FArticyObjectSearchIndex
+{
+public:
+	/**
+	 * @brief An indexed object.
+	 */
+	struct FEntry
+	{
+		TWeakObjectPtr<UArticyObject> Object;
+		const UClass* Class = nullptr;
+
+		/** Technical name, display name, text, speaker name, asset name and class of the object, lowercased */
+		FString Haystack;
+	};
+
+	/**
+	 * @brief Gets the shared index, starting a new one if the objects were imported again.
+	 *
+	 * @return The shared index, possibly not complete yet.
+	 */
+	static TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe> Get();
+
+	/**
+	 * @brief Drops the shared index; searches running on it keep their copy.
+	 */
+	static void Invalidate();
+
+	/**
+	 * @brief Gathers more objects into the index on the game thread.
+	 *
+	 * @param TimeBudgetSeconds Time to spend gathering before returning.
+	 * @return True once the index is complete.
+	 */
+	bool Update(double TimeBudgetSeconds);
+
+	/**
+	 * @brief Checks whether all objects are gathered, the index no longer changes then.
+	 *
+	 * @return True if the index is complete.
+	 */
+	bool IsComplete() const { return bComplete; }
+
+	/**
+	 * @brief Gets the indexed objects, only read from other threads once complete.
+	 *
+	 * @return The entries of the index.
+	 */
+	const TArray<FEntry>& GetEntries() const { return Entries; }
+
+	/**
+	 * @brief Splits a query into lowercased words that must all be found in an entry's haystack.
+	 *
+	 * @param Query The search box text.
+	 * @param OutTokens The words of the query.
+	 * @return False if the query uses the filter expression syntax (keys, operators, quotes) the index can't answer.
+	 */
+	static bool TokenizeQuery(const FString& Query, TArray<FString>& OutTokens);
+
+private:
+	/** Packages left to gather and the position within the current one */
+	TArray<FAssetData> PackageAssets;
+	int32 NextPackage = 0;
+	int32 NextObject = 0;
+	bool bPackagesListed = false;
+	bool bComplete = false;
+
+	TArray<FEntry> Entries;
+};
+
+/**
+ * @brief A query answered from a complete search index on a worker thread.
+ *
+ * Matches are collected in chunks, so the first results can be shown while the rest is still being searched.
+ */
+class ARTICYEDITOR_API FArticyObjectSearch : public TSharedFromThis<FArticyObjectSearch, ESPMode::ThreadSafe>
+{
+public:
+	/**
+	 * @brief Constructs a search, started with Start.
+	 *
+	 * @param InIndex The complete index to search.
+	 * @param InTokens Lowercased words all of which must be found, see FArticyObjectSearchIndex::TokenizeQuery.
+	 * @param InAllowedClass Class the objects must be of.
+	 * @param bInExactClass Whether subclasses of InAllowedClass are left out.
+	 * @param InCandidates Entry indices to search instead of all entries, e.g. the matches of a broader query.
+	 */
+	FArticyObjectSearch(TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe> InIndex, TArray<FString> InTokens,
+		const UClass* InAllowedClass, bool bInExactClass, TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe> InCandidates);
+
+	/**
+	 * @brief Starts searching on a worker thread.
+	 */
+	void Start();
+
+	/**
+	 * @brief Stops the worker at its next chunk, no more matches are collected.
+	 */
+	void Cancel() { bCancelled = true; }
+
+	/**
+	 * @brief Moves the matches found since the last call.
+	 *
+	 * @param OutMatches Receives the entry indices of the new matches, in index order.
+	 * @return True once the search is done and all matches were consumed.
+	 */
+	bool ConsumeMatches(TArray<int32>& OutMatches);
+
+	/**
+	 * @brief Checks whether a query only narrows this one down, so its matches are among the ones of this search.
+	 *
+	 * @param InTokens The words of the new query.
+	 * @param InAllowedClass Class of the new query.
+	 * @param bInExactClass Exact class setting of the new query.
+	 * @return True if every word of this search is part of a word of the new one, for the same class restriction.
+	 */
+	bool IsNarrowedBy(const TArray<FString>& InTokens, const UClass* InAllowedClass, bool bInExactClass) const;
+
+	/**
+	 * @brief Gets all matches of a finished search.
+	 *
+	 * @return The entry indices of all matches, in index order.
+	 */
+	TSharedRef<const TArray<int32>, ESPMode::ThreadSafe> GetAllMatches() const { return AllMatches; }
+
+	/**
+	 * @brief Gets the searched index.
+	 *
+	 * @return The index this search runs on.
+	 */
+	const TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe>& GetIndex() const { return Index; }
+
+private:
+	/** Runs on the worker */
+	void Run();
+
+	/** Tests one entry against the words and the class restriction */
+	bool Matches(const FArticyObjectSearchIndex::FEntry& Entry) const;
+
+	TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe> Index;
+	TArray<FString> Tokens;
+	const UClass* AllowedClass = nullptr;
+	bool bExactClass = false;
+	TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe> Candidates;
+
+	/** Matches not consumed yet, guarded by Lock */
+	FCriticalSection Lock;
+	TArray<int32> PendingMatches;
+
+	/** All matches, written by the worker only; complete once bDone is set */
+	TSharedRef<TArray<int32>, ESPMode::ThreadSafe> AllMatches;
+
+	std::atomic<bool> bCancelled{ false };
+	std::atomic<bool> bDone{ false };
+};
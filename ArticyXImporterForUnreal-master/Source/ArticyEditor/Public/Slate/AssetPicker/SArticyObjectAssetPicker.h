@@ -16,6 +16,7 @@
 #include <Misc/TextFilterExpressionEvaluator.h>
 #include "Widgets/Input/SComboButton.h"
 #include "Slate/ArticyFilterHelpers.h"
+#include "Slate/AssetPicker/ArticyObjectSearchIndex.h"
 #include "ClassViewerModule.h"
 
 #define LOCTEXT_NAMESPACE "ArticyObjectAssetPicker"
@@ -28,6 +29,9 @@ namespace FArticyObjectAssetPicketConstants {
 	const FVector2D TileSize(96.f, 96.f);
 	const int32 ThumbnailPadding = 2;
 
+	/** Time per tick spent gathering the objects into the search index */
+	const double IndexTimeBudgetSeconds = 0.01;
+
 }
 
 /**
@@ -174,6 +178,21 @@ private:
 	 */
 	void RefreshSourceItems();
 
+	/**
+	 * @brief Refreshes the source items by running every object through the frontend filters, for filter expressions.
+	 */
+	void RefreshSourceItemsWithFilters();
+
+	/**
+	 * @brief Advances the indexed search: gathers the index, starts the search once it is complete and adds the matches found so far.
+	 */
+	void UpdateIndexedSearch();
+
+	/**
+	 * @brief Stops the indexed search in progress, if any.
+	 */
+	void CancelIndexedSearch();
+
 	/**
 	 * @brief Sets the search box text for filtering assets.
 	 *
@@ -227,6 +246,12 @@ private: // Internal Data
 	TArray<FAssetData> ArticyPackageDataAssets; //!< Array of asset data for Articy packages.
 	TArray<TWeakObjectPtr<UArticyObject>> FilteredObjects; //!< Array of filtered Articy objects.
 	bool bSlowFullListRefreshRequested = false; //!< Flag indicating whether a slow full list refresh is requested.
+
+	TSharedPtr<FArticyObjectSearchIndex, ESPMode::ThreadSafe> SearchIndex; //!< Index the pending or running search uses.
+	TArray<FString> PendingSearchTokens; //!< Words of the search to start once the index is complete.
+	bool bSearchPending = false; //!< Flag indicating whether a search waits for the index.
+	TSharedPtr<FArticyObjectSearch, ESPMode::ThreadSafe> ActiveSearch; //!< Search whose matches stream into FilteredObjects.
+	TSharedPtr<FArticyObjectSearch, ESPMode::ThreadSafe> LastCompletedSearch; //!< Last finished search, queries extending it only search its matches.
 };
 
 #undef LOCTEXT_NAMESPACE
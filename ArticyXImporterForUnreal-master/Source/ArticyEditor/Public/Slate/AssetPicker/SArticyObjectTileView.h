@@ -11,6 +11,7 @@
 #include "Widgets/Images/SImage.h"
 #include "Widgets/Text/STextBlock.h"
 #include "Framework/Commands/UIAction.h"
+#include "Slate/AssetPicker/ArticyObjectPreviewCache.h"
 
 DECLARE_DELEGATE_OneParam(FOnArticyIdChanged, const FArticyId&);
 
@@ -82,7 +83,9 @@ private:
 	FUIAction PasteAction; //!< Action for pasting the Articy ID.
 
 	mutable FArticyId CachedArticyId; //!< Cached Articy ID for the widget.
-	mutable TWeakObjectPtr<UArticyObject> CachedArticyObject; //!< Cached Articy object pointer.
+	TSharedPtr<const FArticyObjectPreviewCache::FEntry> CachedEntry; //!< Shared preview data of the displayed object.
+	uint32 CachedImageRevision = 0; //!< Image revision of the entry the preview brush was set up with.
+	uint32 ResolvedGeneration = 0; //!< Preview cache generation CachedEntry was looked up in, 0 until the first tick.
 
 	TSharedPtr<SImage> PreviewImage; //!< Shared pointer to the preview image widget.
 	TSharedPtr<STextBlock> DisplayNameTextBlock; //!< Shared pointer to the display name text block.
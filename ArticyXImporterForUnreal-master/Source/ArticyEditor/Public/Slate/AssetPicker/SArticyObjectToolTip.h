@@ -8,6 +8,7 @@
 #include <Widgets/SToolTip.h>
 #include "Widgets/SBoxPanel.h"
 #include "ArticyObject.h"
+#include "Slate/AssetPicker/ArticyObjectPreviewCache.h"
 
 // Reference: AssetViewWidgets.h: CreateToolTipWidget
 
@@ -47,11 +48,17 @@ protected:
 	/** Cached Articy ID for the current object. */
 	mutable FArticyId CachedArticyId;
 
-	/** Cached Articy object pointer. */
-	mutable TWeakObjectPtr<UArticyObject> CachedArticyObject;
+	/** Shared preview data of the current object, shared with the tile views. */
+	TSharedPtr<const FArticyObjectPreviewCache::FEntry> CachedEntry;
 
-	/** Brush for displaying the tooltip image. */
-	FSlateBrush TooltipBrush;
+	/** Brush for displaying the tooltip image, updated once a preview image finished loading. */
+	mutable FSlateBrush TooltipBrush;
+
+	/** Image revision of the entry the brush was set up with. */
+	mutable uint32 CachedImageRevision = 0;
+
+	/** Sets up the tooltip brush from the preview images of the entry, or its type image while they are loading. */
+	void UpdateTooltipBrush() const;
 
 	/**
 	 * Creates the tooltip widget with the specified content.
@@ -10,9 +10,9 @@
 #include "Misc/TextFilterExpressionEvaluator.h"
 #include "Slate/ArticyFilterHelpers.h"
 #include "Widgets/SCompoundWidget.h"
-#include "Widgets/Layout/SExpandableArea.h"
 #include "Widgets/Layout/SSplitter.h"
 #include "Widgets/SBoxPanel.h"
+#include "Widgets/Views/STreeView.h"
 
 /** ref: detailcategorygroupnode.cpp */
 struct FGlobalVariablesSizeData
@@ -25,111 +25,27 @@ struct FGlobalVariablesSizeData
 };
 
 /**
- * A widget representing a set of Articy variables within an expandable area.
+ * An item of the global variables tree, either a variable set or a variable within one.
  */
-class SArticyVariableSet : public SCompoundWidget
+struct FArticyGVTreeItem
 {
-	SLATE_BEGIN_ARGS(SArticyVariableSet) :
-		_bInitiallyCollapsed(true),
-		_SizeData(nullptr)
-		{}
-
-		/** Whether the variable set should be initially collapsed. */
-		SLATE_ARGUMENT(bool, bInitiallyCollapsed)
+	/** The set of the item, also set for variables. */
+	TWeakObjectPtr<UArticyBaseVariableSet> Set;
 
-		/** Pointer to size data for controlling column widths. */
-		SLATE_ARGUMENT(const FGlobalVariablesSizeData*, SizeData)
+	/** The variable, null for set items. */
+	TWeakObjectPtr<UArticyVariable> Variable;
 
-	SLATE_END_ARGS()
-
-	/**
-	 * Constructs the variable set widget.
-	 *
-	 * @param Args The widget arguments.
-	 * @param VariableSet The variable set to represent.
-	 */
-	void Construct(const FArguments& Args, TWeakObjectPtr<UArticyBaseVariableSet> VariableSet);
+	/** The variables of a set item, sorted by name. */
+	TArray<TSharedPtr<FArticyGVTreeItem>> Children;
 
-	/**
-	 * Sets the expanded state of the variable set.
-	 *
-	 * @param bInExpanded Whether to expand or collapse the variable set.
-	 */
-	void SetExpanded(bool bInExpanded) const;
+	/** The variables of a set item that pass the current filters. */
+	TArray<TSharedPtr<FArticyGVTreeItem>> FilteredChildren;
 
-	/**
-	 * Checks if the variable set is expanded.
-	 *
-	 * @return True if expanded, false otherwise.
-	 */
-	bool IsExpanded() const;
-
-	/**
-	 * Updates the visibility of a specific variable.
-	 *
-	 * @param Variable The variable to update visibility for.
-	 * @param InVisibility The desired visibility.
-	 */
-	void UpdateVisibility(const UArticyVariable* Variable, EVisibility InVisibility);
-
-	/**
-	 * Retrieves the variables in the set.
-	 *
-	 * @return An array of variables.
-	 */
-	TArray<UArticyVariable*> GetVariables();
-
-private:
-	/** Builds the widgets for the variables in the set. */
-	void BuildVariableWidgets();
-
-private:
-	/** Flag indicating whether the variable widgets have been built. */
-	bool bVariableWidgetsBuilt = false;
-
-	/** Flag indicating whether a slider is currently being moved. */
-	bool bSliderMoving = false;
-
-	/** The variable set being represented. */
-	TWeakObjectPtr<UArticyBaseVariableSet> VariableSet;
-
-	/** Mapping of variables to their corresponding widgets. */
-	TMap<UArticyVariable*, TWeakPtr<SWidget>> VariableWidgetMapping;
-
-	/** Container for the variable widgets. */
-	TSharedPtr<SVerticalBox> VariableContainer;
-
-	/** Expandable area for the namespace. */
-	TSharedPtr<SExpandableArea> NamespaceExpansion;
-
-	/** Pointer to size data for controlling column widths. */
-	const FGlobalVariablesSizeData* SizeData = nullptr;
-
-	/**
-	 * Handles value changes for variables.
-	 *
-	 * @tparam T The type of the variable value.
-	 * @tparam T2 The type of the variable.
-	 * @param Value The new value.
-	 * @param Var The variable being changed.
-	 */
-	template<typename T, typename T2>
-	void OnValueChanged(T Value, T2* Var);
+	/** Whether this is a variable item. */
+	bool IsVariable() const { return Variable.IsValid(); }
 };
 
-template <typename T, typename T2>
-void SArticyVariableSet::OnValueChanged(T Value, T2* Var)
-{
-	if (bSliderMoving)
-	{
-		if (Var->Get() == Value)
-		{
-			return;
-		}
-		Var->Modify();
-		*Var = Value;
-	}
-}
+using FArticyGVTreeItemPtr = TSharedPtr<FArticyGVTreeItem>;
 
 /**
  * A widget for displaying and managing Articy global variables.
@@ -204,18 +120,44 @@ private:
 	/** Restores the expansion states of variable sets. */
 	void RestoreExpansionStates();
 
+	/** Generates the row of a set or variable once it scrolls into view. */
+	TSharedRef<ITableRow> OnGenerateRow(FArticyGVTreeItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable);
+
+	/** Gets the variables of a set that pass the filters. */
+	void OnGetChildren(FArticyGVTreeItemPtr Item, TArray<FArticyGVTreeItemPtr>& OutChildren) const;
+
+	/** Creates the editable value of a variable row. */
+	TSharedRef<SWidget> CreateValueWidget(UArticyVariable* Var);
+
+	/**
+	 * Handles value changes for variables.
+	 *
+	 * @tparam T The type of the variable value.
+	 * @tparam T2 The type of the variable.
+	 * @param Value The new value.
+	 * @param Var The variable being changed.
+	 */
+	template<typename T, typename T2>
+	void OnValueChanged(T Value, T2* Var);
+
 private:
-	/** Container for the variable set widgets. */
-	TSharedPtr<SVerticalBox> SetContainer;
+	/** Tree of the variable sets and their variables, only the rows in view are created. */
+	TSharedPtr<STreeView<FArticyGVTreeItemPtr>> VariableTree;
+
+	/** All set items, sorted by name. */
+	TArray<FArticyGVTreeItemPtr> SetItems;
 
-	/** Array of variable set widgets. */
-	TArray<TSharedPtr<SArticyVariableSet>> VariableSetWidgets;
+	/** The set items with variables that pass the filters, the roots of the tree. */
+	TArray<FArticyGVTreeItemPtr> FilteredSetItems;
 
 	/** Flag indicating whether sets should be force expanded. */
 	bool bShouldForceExpand = false;
 
-	/** Cache for the expansion states of variable sets. */
-	TMap<TSharedPtr<SArticyVariableSet>, bool> ExpansionCache;
+	/** Flag indicating whether a slider is currently being moved. */
+	bool bSliderMoving = false;
+
+	/** Cache for the expansion states of variable sets, by set name so it carries over to other instances. */
+	TMap<FString, bool> ExpansionCache;
 
 	/** Filter for variable names. */
 	TSharedPtr<FFrontendFilter_ArticyVariable> VariableFilter;
@@ -223,3 +165,17 @@ private:
 	/** Collection of frontend filters. */
 	TSharedPtr<FArticyVariableFilterCollectionType> FrontendFilters;
 };
+
+template <typename T, typename T2>
+void SArticyGlobalVariables::OnValueChanged(T Value, T2* Var)
+{
+	if (bSliderMoving)
+	{
+		if (Var->Get() == Value)
+		{
+			return;
+		}
+		Var->Modify();
+		*Var = Value;
+	}
+}
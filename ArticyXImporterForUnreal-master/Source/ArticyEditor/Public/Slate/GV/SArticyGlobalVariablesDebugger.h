@@ -12,6 +12,7 @@
 #include "Misc/TextFilterExpressionEvaluator.h"
 #include "Widgets/Layout/SExpandableArea.h"
 #include "Widgets/Layout/SWidgetSwitcher.h"
+#include "Engine/World.h"
 
 /**
  * A widget for debugging Articy Global Variables at runtime.
@@ -32,16 +33,32 @@ class SArticyGlobalVariablesRuntimeDebugger : public SCompoundWidget
 	 */
 	void Construct(const FArguments& Args);
 
+	/** Unbinds from the PIE and world events. */
+	virtual ~SArticyGlobalVariablesRuntimeDebugger();
+
+private:
 	/**
-	 * Updates the state of the widget every frame.
+	 * Shows the Global Variables of the PIE world once play started.
 	 *
-	 * @param AllottedGeometry The geometry of the widget.
-	 * @param InCurrentTime The current time.
-	 * @param InDeltaTime The time since the last tick.
+	 * @param bIsSimulating Whether the session is simulating.
 	 */
-	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	void OnPIEStarted(bool bIsSimulating);
+
+	/**
+	 * Clears the displayed Global Variables once play ended.
+	 *
+	 * @param bIsSimulating Whether the session was simulating.
+	 */
+	void OnPIEEnded(bool bIsSimulating);
+
+	/**
+	 * Picks up the Global Variables of a world that was loaded during play, if the shown instance went away with the previous one.
+	 *
+	 * @param World The world that was initialized.
+	 * @param IVS The initialization values of the world.
+	 */
+	void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS);
 
-private:
 	/**
 	 * Updates the current Global Variables instance.
 	 *
@@ -94,7 +111,7 @@ private:
 	/** Flag indicating whether the debugger is active. */
 	bool bIsActive = false;
 
-	/** Handles for the PIE (Play In Editor) events. */
+	/** Handles for the PIE (Play In Editor) and world events, the debugger updates from them instead of polling every tick. */
 	TArray<FDelegateHandle> RuntimeSwitchHandles;
 };
 
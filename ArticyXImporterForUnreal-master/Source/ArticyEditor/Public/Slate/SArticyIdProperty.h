@@ -95,6 +95,11 @@ private:
 	TWeakObjectPtr<UArticyObject> CachedArticyObject = nullptr;
 	mutable FArticyId CachedArticyId = FArticyId();
 
+	/** Shared display data of the object, looked up on the first tick so widgets scrolled out of view never resolve it */
+	TSharedPtr<const FArticyObjectPreviewCache::FEntry> CachedEntry;
+	uint32 ResolvedGeneration = 0;
+	FText CachedDisplayName;
+
 	TSharedPtr<SHorizontalBox> ChildBox;
 	TSharedPtr<SArticyObjectTileView> TileView;
 	TSharedPtr<SBox> TileContainer;
@@ -82,8 +82,6 @@ private:
 	 */
 	FArticyId GetArticyIdToDisplay() const;
 
-	// the articy object this widget currently represents
-	TWeakObjectPtr<UArticyObject> CachedArticyObject = nullptr;
 	mutable FArticyRef CachedArticyRef = FArticyRef();
 
 	TSharedPtr<SArticyIdProperty> ArticyIdProperty;
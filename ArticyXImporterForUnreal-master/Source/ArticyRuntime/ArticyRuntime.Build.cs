@@ -33,7 +33,8 @@ public class ArticyRuntime : ModuleRules
 				// ... add other public dependencies that you statically link with here ...
                 "MediaAssets",
 				"Json",
-				"UMG"
+				"UMG",
+				"NetCore"
 			}
 			);
 			
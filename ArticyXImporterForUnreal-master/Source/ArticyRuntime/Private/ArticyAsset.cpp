@@ -13,7 +13,7 @@
  */
 UObject* UArticyAsset::LoadAsset() const
 {
-	//if(!Asset.IsValid())
+	if(!Asset.IsValid())
 	{
 		/*static TArray<FAssetData> assets;
 
@@ -83,3 +83,20 @@ UFileMediaSource* UArticyAsset::LoadAsFileMediaSource() const
 {
 	return Cast<UFileMediaSource>(LoadAsset());
 }
+
+/**
+ * Gets the path of the referenced asset without loading it, e.g. to stream it in asynchronously.
+ *
+ * @return The soft object path of the referenced asset, null if there is no reference.
+ */
+FSoftObjectPath UArticyAsset::GetAssetPath() const
+{
+	if (AssetRef.IsEmpty())
+		return FSoftObjectPath();
+
+	const auto& folder = FPaths::GetPath(AssetRef);
+	const auto& filename = FPaths::GetBaseFilename(AssetRef);
+
+	//package path plus the object name, which matches the file name
+	return FSoftObjectPath(ArticyHelpers::GetArticyResourcesFolder() / folder / filename + TEXT(".") + filename);
+}
@@ -0,0 +1,165 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyAssetPrefetcher.h"
+#include "ArticyAsset.h"
+#include "ArticyBuiltinTypes.h"
+#include "ArticyDatabase.h"
+#include "ArticyPluginSettings.h"
+#include "Interfaces/ArticyFlowObject.h"
+#include "Interfaces/ArticyObjectWithPreviewImage.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+void UArticyAssetPrefetcher::Deinitialize()
+{
+	ReleaseAll();
+	Super::Deinitialize();
+}
+
+/**
+ * Gets the prefetcher of the world of a context object.
+ *
+ * @param WorldContext The context object.
+ * @return The prefetcher, or nullptr if there is no world.
+ */
+UArticyAssetPrefetcher* UArticyAssetPrefetcher::Get(const UObject* WorldContext)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UArticyAssetPrefetcher>() : nullptr;
+}
+
+/**
+ * Starts loading the assets of nodes: the voice-over of their text, their preview image and the
+ * preview image of their speaker.
+ *
+ * @param Nodes The nodes to prefetch for.
+ */
+void UArticyAssetPrefetcher::PrefetchNodes(const TArray<TScriptInterface<IArticyFlowObject>>& Nodes)
+{
+	++CurrentRequest;
+
+	for (const auto& Node : Nodes)
+	{
+		UObject* Object = Node.GetObject();
+		if (!Object)
+			continue;
+
+		if (auto* WithText = Cast<IArticyObjectWithText>(Object))
+			PrefetchAssetId(WithText->GetVOAssetId(this));
+
+		if (auto* WithPreviewImage = Cast<IArticyObjectWithPreviewImage>(Object))
+		{
+			if (const UArticyPreviewImage* PreviewImage = WithPreviewImage->GetPreviewImage())
+				PrefetchAssetId(PreviewImage->Asset);
+		}
+
+		if (auto* WithSpeaker = Cast<IArticyObjectWithSpeaker>(Object))
+		{
+			auto* SpeakerWithPreviewImage = Cast<IArticyObjectWithPreviewImage>(WithSpeaker->GetSpeaker());
+			if (const UArticyPreviewImage* PreviewImage = SpeakerWithPreviewImage ? SpeakerWithPreviewImage->GetPreviewImage() : nullptr)
+				PrefetchAssetId(PreviewImage->Asset);
+		}
+	}
+
+	EnforceBudget();
+}
+
+/**
+ * Starts loading an asset, as a request of its own.
+ *
+ * @param Asset The asset to load.
+ */
+void UArticyAssetPrefetcher::PrefetchAsset(const UArticyAsset* Asset)
+{
+	++CurrentRequest;
+	RequestAsset(Asset);
+	EnforceBudget();
+}
+
+void UArticyAssetPrefetcher::PrefetchAssetId(const FArticyId& Id)
+{
+	if (Id.IsNull())
+		return;
+
+	const UArticyDatabase* Database = UArticyDatabase::Get(this);
+	if (Database)
+		RequestAsset(Database->GetObject<UArticyAsset>(Id));
+}
+
+void UArticyAssetPrefetcher::RequestAsset(const UArticyAsset* Asset)
+{
+	const FSoftObjectPath Path = Asset ? Asset->GetAssetPath() : FSoftObjectPath();
+	if (Path.IsNull())
+		return;
+
+	if (FPrefetchedAsset* Existing = Prefetched.Find(Path))
+	{
+		Existing->LastRequest = CurrentRequest;
+		return;
+	}
+
+	// assets that are already loaded complete on the next tick, so the entry is not looked up from within this call
+	FPrefetchedAsset& Entry = Prefetched.Add(Path);
+	Entry.LastRequest = CurrentRequest;
+	Entry.Handle = StreamableManager.RequestAsyncLoad(Path,
+		FStreamableDelegate::CreateUObject(this, &UArticyAssetPrefetcher::OnAssetLoaded, Path));
+}
+
+void UArticyAssetPrefetcher::OnAssetLoaded(FSoftObjectPath Path)
+{
+	FPrefetchedAsset* Entry = Prefetched.Find(Path);
+	if (!Entry)
+		return;
+
+	UObject* Loaded = Path.ResolveObject();
+	Entry->Bytes = Loaded ? FMath::Max<int64>(Loaded->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal), 1) : 0;
+	PrefetchedBytes += Entry->Bytes;
+
+	EnforceBudget();
+}
+
+void UArticyAssetPrefetcher::EnforceBudget()
+{
+	const int64 Budget = int64(UArticyPluginSettings::Get()->PrefetchMemoryBudgetMB) * 1024 * 1024;
+	while (PrefetchedBytes > Budget)
+	{
+		// the least recently requested loaded asset that is not part of the current request
+		const FSoftObjectPath* Oldest = nullptr;
+		uint64 OldestRequest = CurrentRequest;
+		for (const auto& Pair : Prefetched)
+		{
+			if (Pair.Value.Bytes > 0 && Pair.Value.LastRequest < OldestRequest)
+			{
+				Oldest = &Pair.Key;
+				OldestRequest = Pair.Value.LastRequest;
+			}
+		}
+
+		if (!Oldest)
+			break;
+
+		FPrefetchedAsset Evicted;
+		Prefetched.RemoveAndCopyValue(*Oldest, Evicted);
+		PrefetchedBytes -= Evicted.Bytes;
+		if (Evicted.Handle.IsValid())
+			Evicted.Handle->ReleaseHandle();
+	}
+}
+
+/**
+ * Releases all prefetched assets, they unload with the next garbage collection unless used elsewhere.
+ */
+void UArticyAssetPrefetcher::ReleaseAll()
+{
+	for (auto& Pair : Prefetched)
+	{
+		if (Pair.Value.Handle.IsValid())
+			Pair.Value.Handle->CancelHandle();
+	}
+	Prefetched.Reset();
+	PrefetchedBytes = 0;
+}
@@ -7,18 +7,6 @@
 #include "ArticyTypeSystem.h"
 #include "ArticyHelpers.h"
 
-/**
- * Retrieves a subobject of this Articy object using its unique identifier.
- *
- * @param Id The unique identifier of the subobject to retrieve.
- * @return A pointer to the UArticyPrimitive subobject if found, otherwise nullptr.
- */
-UArticyPrimitive* UArticyBaseObject::GetSubobject(FArticyId Id) const
-{
-	auto obj = Subobjects.Find(Id);
-	return obj ? *obj : nullptr;
-}
-
 /**
  * Adds a subobject to this Articy object.
  *
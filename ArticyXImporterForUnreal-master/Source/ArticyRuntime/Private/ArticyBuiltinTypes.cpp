@@ -35,24 +35,24 @@ void UArticyConnection::InitFromJson(TSharedPtr<FJsonValue> Json)
 	Color = ArticyHelpers::ParseColorFromJson(obj->TryGetField(TEXT("Color")));
 }
 
-UArticyPrimitive* UArticyOutgoingConnection::GetTarget() const
+UArticyPrimitive* UArticyOutgoingConnection::GetTarget(const UArticyDatabase* Database) const
 {
 	if(!TargetObj)
 	{
-		auto db = UArticyDatabase::Get(this);
+		auto db = Database ? Database : UArticyDatabase::Get(this);
 		TargetObj = db ? db->GetObject(Target) : nullptr;
 	}
 
 	return TargetObj;
 }
 
-UArticyFlowPin* UArticyOutgoingConnection::GetTargetPin() const
+UArticyFlowPin* UArticyOutgoingConnection::GetTargetPin(const UArticyDatabase* Database) const
 {
 	if(!TargetPinObj)
 	{
-		auto target = GetTarget();
+		auto target = GetTarget(Database);
 		if(target)
-			TargetPinObj = Cast<UArticyFlowPin>(target->GetSubobject(TargetPin));
+			TargetPinObj = target->GetSubobject<UArticyFlowPin>(TargetPin);
 	}
 
 	return TargetPinObj;
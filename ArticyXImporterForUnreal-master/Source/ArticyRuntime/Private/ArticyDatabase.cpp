@@ -8,7 +8,10 @@
 #include "ArticyGlobalVariables.h"
 #include "ArticyPluginSettings.h"
 #include "ArticyExpressoScripts.h"
+#include "ArticyLocalizerSystem.h"
+#include "ArticyRuntimeStats.h"
 #include "Misc/Paths.h"
+#include "Async/ParallelFor.h"
 
 /**
  * Gets the underlying Articy object.
@@ -26,124 +29,21 @@ UArticyObject* FArticyObjectShadow::GetObject()
  * @param Outer The outer object context for the shadowable object.
  */
 FArticyShadowableObject::FArticyShadowableObject(UArticyObject* Object, int32 CloneId, UObject* Outer)
+	: Original(0, Object, CloneId, Outer)
 {
 	Object->SetCloneID(CloneId);
-	ShadowCopies.Add(FArticyObjectShadow(0, Object, CloneId, Outer));
 }
 
 /**
- * Retrieves the shadowed Articy object based on the shadow manager and clone state.
+ * Retrieves the Articy object.
+ * Shadowed operations do not copy the object, the properties written by them are restored when they end.
  * @param ShadowManager The manager for shadow states.
  * @param bForceUnshadowed Force retrieval of the unshadowed version.
- * @return A pointer to the shadowed or unshadowed UArticyObject.
+ * @return A pointer to the UArticyObject.
  */
 UArticyObject* FArticyShadowableObject::Get(const IShadowStateManager* ShadowManager, bool bForceUnshadowed) const
 {
-	if (bForceUnshadowed)
-		return ShadowCopies[0].GetObject();
-
-	const auto& ShadowLvl = ShadowManager->GetShadowLevel();
-	FArticyObjectShadow* info = ShadowCopies.FindByPredicate([&](const FArticyObjectShadow& item)
-		{
-			return item.ShadowLevel == ShadowLvl;
-		});
-
-	if (info)
-		return info->GetObject();
-
-	if (!ensureMsgf(ShadowLvl > 0 && ShadowCopies.Num() > 0, TEXT("Cannot get shadow level %d of FArticyShadowableObject!"), ShadowLvl))
-		return nullptr;
-
-	//create a new shadow copy
-	auto& mostRecentShadow = ShadowCopies.Last();
-	auto SourceObject = mostRecentShadow.GetObject();
-	auto obj = DuplicateObject(SourceObject, SourceObject);
-	ShadowCopies.Add(FArticyObjectShadow(ShadowLvl, obj, mostRecentShadow.GetCloneId()));
-
-#if __cplusplus >= 202002L
-	const_cast<IShadowStateManager*>(ShadowManager)->RegisterOnPopState([=, this]
-#else
-	const_cast<IShadowStateManager*>(ShadowManager)->RegisterOnPopState([=]
-#endif
-		{
-			//when the state is popped, remove the shadow copy again
-			//it is destroyed automatically, unless there is an owning reference to it
-			ensure(ShadowCopies.Last().ShadowLevel == ShadowLvl);
-			ShadowCopies.RemoveAt(ShadowCopies.Num() - 1);
-		});
-
-	//return the new shadow copy
-	return obj;
-}
-
-/**
- * Retrieves a clone of the Articy object based on clone ID and shadow state.
- * @param ShadowManager The manager for shadow states.
- * @param CloneId The ID of the clone to retrieve.
- * @param bForceUnshadowed Force retrieval of the unshadowed version.
- * @return A pointer to the shadowed or unshadowed UArticyObject clone.
- */
-UArticyObject* UArticyCloneableObject::Get(const IShadowStateManager* ShadowManager, int32 CloneId,
-	bool bForceUnshadowed) const
-{
-	auto info = Clones.Find(CloneId);
-	return info ? info->Get(ShadowManager, bForceUnshadowed) : nullptr;
-}
-
-/**
- * Clones the Articy object, creating a new instance with the specified clone ID.
- * @param ShadowManager The manager for shadow states.
- * @param CloneId The ID for the new clone.
- * @param bFailIfExists Fails if the clone already exists.
- * @return A pointer to the newly created or existing clone, or nullptr if creation failed.
- */
-UArticyObject* UArticyCloneableObject::Clone(const IShadowStateManager* ShadowManager, int32 CloneId,
-	bool bFailIfExists)
-{
-	auto clone = Get(ShadowManager, CloneId);
-
-	if (bFailIfExists && clone)
-		return nullptr;
-
-	if (!clone)
-	{
-		//get the original object (clone 0)
-		auto original = Get(ShadowManager);
-		if (ensure(original))
-		{
-			//create the clone
-			clone = DuplicateObject(original, original);
-			AddClone(clone, CloneId);
-		}
-	}
-
-	return clone;
-}
-
-/**
- * Adds a clone to the clone map with a specified clone ID.
- * @param Clone The clone to add.
- * @param CloneId The ID for the clone.
- */
-void UArticyCloneableObject::AddClone(UArticyObject* Clone, int32 CloneId)
-{
-	if (!ensure(Clone))
-		return;
-
-	if (CloneId == -1)
-	{
-		//find the first free clone id
-		for (int i = 0; i != -1; ++i)
-		{
-			if (!Clones.Find(i))
-			{
-				CloneId = i;
-				break;
-			}
-		}
-	}
-
-	Clones.Add(CloneId, FArticyShadowableObject{ Clone, CloneId });
+	return Original.GetObject();
 }
 
 //---------------------------------------------------------------------------//
@@ -238,6 +138,7 @@ UArticyDatabase* UArticyDatabase::Get(const UObject* WorldContext)
 	if (!clone.IsValid())
 	{
 		//clone not valid, create a new one
+		LLM_SCOPE_BYTAG(Articy_Database);
 		UE_LOG(LogArticyRuntime, Log, TEXT("Cloning ArticyDatabase."))
 
 			//get the original asset to clone from
@@ -258,9 +159,17 @@ UArticyDatabase* UArticyDatabase::Get(const UObject* WorldContext)
 			clone = DuplicateObject((UArticyDatabase*)asset, world);
 		}
 
+		FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::ObjectsDuplicated);
+
 		//make the clone load its default packages
 		if (clone.IsValid())
+		{
+			// The index only refers to the package assets, all clones can share it
+			asset->GetObjectIndex();
+			clone->ObjectIndex = asset->ObjectIndex;
 			clone->Init();
+			BumpGeneration();
+		}
 	}
 
 	return clone.Get();
@@ -284,6 +193,7 @@ void UArticyDatabase::UnloadDatabase()
 		(*dbPtr)->RemoveFromRoot();
 		(*dbPtr)->ConditionalBeginDestroy();
 		*dbPtr = NULL;
+		BumpGeneration();
 	}
 }
 
@@ -371,6 +281,7 @@ void UArticyDatabase::SetLoadedPackages(const TArray<UArticyPackage*> Packages)
 {
 	ImportedPackages.Reset();
 	UnloadAllPackages();
+	ObjectIndex.Reset();
 
 	for (auto pkg : Packages)
 	{
@@ -411,6 +322,9 @@ void UArticyDatabase::LoadAllPackages(bool bDefaultOnly)
  */
 void UArticyDatabase::LoadPackage(FString PackageName)
 {
+	ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyLoadPackage);
+	LLM_SCOPE_BYTAG(Articy_Packages);
+
 	if (LoadedPackages.Contains(PackageName))
 	{
 		UE_LOG(LogArticyRuntime, Log, TEXT("Package %s already loaded."), *PackageName);
@@ -436,26 +350,41 @@ void UArticyDatabase::LoadPackage(FString PackageName)
 	//load the package, to make sure all the contained objects are available
 	pkgFile->FullyLoad();*/
 
-	for (auto ArticyObject : Package->GetAssets())// MM_CHANGE
-	{
-		auto id = FArticyId(ArticyObject->GetId());
+	const TArray<UArticyObject*>& Assets = Package->GetAssets();
 
-		if (!ensureMsgf(!LoadedObjectsById.Contains(id), TEXT("Object with id [%d,%d] already in list!"), id.High, id.Low))
-			continue;
+	// Reading the IDs touches every asset, so large packages gather them with their hashes in parallel first
+	struct FAssetKey
+	{
+		FArticyId Id;
+		uint32 Hash;
+	};
+	TArray<FAssetKey> Keys;
+	Keys.SetNumUninitialized(Assets.Num());
+	ParallelFor(Assets.Num(), [&](int32 Index)
+	{
+		const FArticyId Id = Assets[Index]->GetId();
+		Keys[Index] = { Id, GetTypeHash(Id) };
+	}, Assets.Num() < MinParallelLoadAssets ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
 
-		auto CloneContainer = NewObject<UArticyCloneableObject>(this);
-		UArticyObject* InitialClone = DuplicateObject<UArticyObject>(ArticyObject, this);
-		CloneContainer->Init(InitialClone);
+	// Runtime copies of the objects are only made when they are requested
+	LoadedObjects.Reserve(LoadedObjects.Num() + Assets.Num());
+	for (int32 Index = 0; Index < Assets.Num(); ++Index)
+	{
+		FLoadedObject& LoadedObject = LoadedObjects.FindOrAddByHash(Keys[Index].Hash, Keys[Index].Id);
 
-		LoadedObjectsById.Add(id, CloneContainer);
+		// The object is shared with a package that is already loaded
+		if (LoadedObject.RefCount++ > 0)
+			continue;
 
-		if (!ArticyObject->GetTechnicalName().ToString().IsEmpty())
-		{
-			LoadedObjectsByName.FindOrAdd(ArticyObject->GetTechnicalName()).Objects.Add(CloneContainer);
-		}
+		LoadedObject.Asset = Assets[Index];
 	}
 
 	LoadedPackages.Add(PackageName);
+	BumpGeneration();
+
+	// Only the string tables of loaded packages are kept in memory
+	if (UArticyLocalizerSystem* LocalizerSystem = UArticyLocalizerSystem::Get())
+		LocalizerSystem->LoadStringTable(GetStringTableName(PackageName));
 	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s loaded successfully."), *PackageName);
 }
 
@@ -467,6 +396,8 @@ void UArticyDatabase::LoadPackage(FString PackageName)
  */
 bool UArticyDatabase::UnloadPackage(const FString PackageName, const bool bQuickUnload)
 {
+	ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyUnloadPackage);
+
 	if (!LoadedPackages.Contains(PackageName))
 	{
 		UE_LOG(LogArticyRuntime, Log, TEXT("Package %s can't be unloaded due to not being loaded in the first place."), *PackageName);
@@ -484,7 +415,13 @@ bool UArticyDatabase::UnloadPackage(const FString PackageName, const bool bQuick
 	for (auto ArticyObject : Package->GetAssets())
 	{
 		FArticyId ArticyId = ArticyObject->GetId();
-		FName TechnicalName = ArticyObject->GetTechnicalName();
+
+		FLoadedObject* LoadedObject = LoadedObjects.Find(ArticyId);
+		if (!LoadedObject)
+		{
+			// Already removed by a quick unload of another package
+			continue;
+		}
 
 		bool bShouldUnload = false;
 		if (bQuickUnload)
@@ -495,45 +432,328 @@ bool UArticyDatabase::UnloadPackage(const FString PackageName, const bool bQuick
 		{
 			/*
 			 *	An exported object can exist multiple times in different packages
-			 *  In the database, there can only be one object with the same Id, so if we are unloading slowly, check if the object is contained in another package first
-			 *  Only unload if it is not contained in any other package
+			 *  In the database, there can only be one object with the same Id, so if we are unloading slowly, only unload it
+			 *  once no other loaded package contains it anymore
 			*/
-			bool bIsAssetContained = false;
-			for (const FString& LoadedPackageName : LoadedPackages)
-			{
-				if (!LoadedPackageName.Equals(Package->Name))
-				{
-					bIsAssetContained = bIsAssetContained || ImportedPackages[LoadedPackageName]->GetAssetsDict().Contains(TechnicalName);
-				}
-			}
-
-			if (!bIsAssetContained)
-			{
-				bShouldUnload = true;
-			}
+			bShouldUnload = --LoadedObject->RefCount <= 0;
 		}
 
 		if (bShouldUnload)
 		{
-			LoadedObjectsById.FindAndRemoveChecked(ArticyId);
-			LoadedObjectsByName.FindAndRemoveChecked(TechnicalName);
+			LoadedObjects.Remove(ArticyId);
+			LoadedObjectsById.Remove(ArticyId);
+			ObjectClones.Remove(ArticyId);
 		}
 	}
 
 	LoadedPackages.Remove(Package->Name);
+	BumpGeneration();
+
+	if (UArticyLocalizerSystem* LocalizerSystem = UArticyLocalizerSystem::Get())
+		LocalizerSystem->UnloadStringTable(GetStringTableName(PackageName));
 	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s unloaded successfully."), *PackageName);
 
 	return true;
 }
 
+/**
+ * Mounts packages that are not part of the import.
+ * @param MountName The name to unmount the packages by.
+ * @param Packages The packages to mount.
+ * @return False if the name is mounted already or a package name is taken.
+ */
+bool UArticyDatabase::MountPackages(const FString& MountName, const TArray<UArticyPackage*>& Packages)
+{
+	if (MountedPackageNames.Contains(MountName))
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Packages are mounted as %s already."), *MountName);
+		return false;
+	}
+
+	if (IsInShadowState())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Can't mount %s while in a shadow state!"), *MountName);
+		return false;
+	}
+
+	for (const UArticyPackage* Package : Packages)
+	{
+		if (!Package || ImportedPackages.Contains(Package->Name))
+		{
+			UE_LOG(LogArticyRuntime, Error, TEXT("Can't mount %s, package %s is missing or its name is taken!"), *MountName, Package ? *Package->Name : TEXT("None"));
+			return false;
+		}
+	}
+
+	TArray<FString>& Names = MountedPackageNames.Add(MountName);
+	for (UArticyPackage* Package : Packages)
+	{
+		ImportedPackages.Add(Package->Name, Package);
+		Names.Add(Package->Name);
+	}
+
+	// Loading only adds the package's own objects, those loaded already are left as they are
+	for (UArticyPackage* Package : Packages)
+	{
+		if (Package->bIsDefaultPackage)
+			LoadPackage(Package->Name);
+	}
+
+	UE_LOG(LogArticyRuntime, Log, TEXT("Mounted %d packages as %s."), Packages.Num(), *MountName);
+	return true;
+}
+
+/**
+ * Unloads and forgets the packages of a mount.
+ * @param MountName The name the packages were mounted by.
+ * @return False if nothing is mounted by that name.
+ */
+bool UArticyDatabase::UnmountPackages(const FString& MountName)
+{
+	TArray<FString> Names;
+	if (!MountedPackageNames.RemoveAndCopyValue(MountName, Names))
+	{
+		UE_LOG(LogArticyRuntime, Log, TEXT("Nothing is mounted as %s."), *MountName);
+		return false;
+	}
+
+	for (const FString& PackageName : Names)
+	{
+		if (LoadedPackages.Contains(PackageName))
+			UnloadPackage(PackageName, false);
+		ImportedPackages.Remove(PackageName);
+	}
+
+	UE_LOG(LogArticyRuntime, Log, TEXT("Unmounted %s."), *MountName);
+	return true;
+}
+
 /**
  * Unloads all currently loaded packages, clearing object maps.
  */
 void UArticyDatabase::UnloadAllPackages()
 {
+	if (UArticyLocalizerSystem* LocalizerSystem = UArticyLocalizerSystem::Get())
+	{
+		for (const FString& PackageName : LoadedPackages)
+			LocalizerSystem->UnloadStringTable(GetStringTableName(PackageName));
+	}
+
 	LoadedPackages.Reset();
 	LoadedObjectsById.Reset();
-	LoadedObjectsByName.Reset();
+	ObjectClones.Reset();
+	LoadedObjects.Reset();
+	BumpGeneration();
+}
+
+/**
+ * Gets the name of the string table of a package.
+ * @param PackageName The name of the package.
+ * @return The table name, the package name with underscores instead of spaces.
+ */
+FName UArticyDatabase::GetStringTableName(const FString& PackageName)
+{
+	return FName(*PackageName.Replace(TEXT(" "), TEXT("_")));
+}
+
+/**
+ * Gets the index of the objects of all imported packages, building it on first use.
+ * @return The object index.
+ */
+namespace
+{
+	/**
+	 * Numbers the objects depth-first along their parents, so each one's descendants follow it.
+	 * @param Objects The indexed objects.
+	 * @param Ids The IDs of the indexed objects.
+	 * @param OutHierarchy The map to fill with the range of every object reachable from a root.
+	 */
+	void BuildHierarchy(const TArray<const UArticyObject*>& Objects, const TSet<FArticyId>& Ids, TMap<FArticyId, FArticyHierarchyRange>& OutHierarchy)
+	{
+		// Objects whose parent is not indexed are roots
+		TMap<FArticyId, TArray<FArticyId>> WalkChildren;
+		TArray<TPair<FArticyId, int32>> Stack;
+		for (const UArticyObject* Object : Objects)
+		{
+			const FArticyId ParentId = Object->GetParentID();
+			if (ParentId != Object->GetId() && Ids.Contains(ParentId))
+				WalkChildren.FindOrAdd(ParentId).Add(Object->GetId());
+			else
+				Stack.Emplace(Object->GetId(), INDEX_NONE);
+		}
+
+		// Walk without recursing, with the position of each object's parent
+		TArray<FArticyId> Order;
+		TArray<int32> ParentOrder;
+		Order.Reserve(Objects.Num());
+		ParentOrder.Reserve(Objects.Num());
+		while (Stack.Num() > 0)
+		{
+#if ENGINE_MAJOR_VERSION > 5 || (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4)
+			const TPair<FArticyId, int32> Entry = Stack.Pop(EAllowShrinking::No);
+#else
+			const TPair<FArticyId, int32> Entry = Stack.Pop(false);
+#endif
+			const int32 Position = Order.Add(Entry.Key);
+			ParentOrder.Add(Entry.Value);
+
+			if (const TArray<FArticyId>* Children = WalkChildren.Find(Entry.Key))
+				for (const FArticyId& ChildId : *Children)
+					Stack.Emplace(ChildId, Position);
+		}
+
+		// A subtree is its root and the objects numbered right after it, sizes add up from the leaves
+		TArray<int32> Sizes;
+		Sizes.Init(1, Order.Num());
+		for (int32 i = Order.Num() - 1; i > 0; --i)
+			if (ParentOrder[i] != INDEX_NONE)
+				Sizes[ParentOrder[i]] += Sizes[i];
+
+		OutHierarchy.Reserve(Order.Num());
+		for (int32 i = 0; i < Order.Num(); ++i)
+			OutHierarchy.Add(Order[i], FArticyHierarchyRange{ i, i + Sizes[i] - 1 });
+	}
+}
+
+const UArticyDatabase::FObjectIndex& UArticyDatabase::GetObjectIndex() const
+{
+	if (!ObjectIndex.IsValid())
+	{
+		TSharedRef<FObjectIndex> Index = MakeShared<FObjectIndex>();
+		TSet<FArticyId> IndexedIds;
+		TArray<const UArticyObject*> IndexedObjects;
+		for (const TPair<FString, UArticyPackage*>& Package : ImportedPackages)
+		{
+			if (!Package.Value)
+				continue;
+
+			for (UArticyObject* ArticyObject : Package.Value->GetAssets())
+			{
+				// Objects exported to several packages are listed once, under any of their assets
+				bool bAlreadyIndexed = false;
+				IndexedIds.Add(ArticyObject->GetId(), &bAlreadyIndexed);
+				if (bAlreadyIndexed)
+					continue;
+
+				IndexedObjects.Add(ArticyObject);
+				if (!ArticyObject->GetTechnicalName().IsNone())
+					Index->ByName.FindOrAdd(ArticyObject->GetTechnicalName()).Add(ArticyObject);
+
+				for (const UClass* Class = ArticyObject->GetClass(); Class; Class = Class->GetSuperClass())
+				{
+					Index->ByClass.FindOrAdd(Class).Add(ArticyObject);
+					if (Class == UArticyObject::StaticClass())
+						break;
+				}
+			}
+		}
+		BuildHierarchy(IndexedObjects, IndexedIds, Index->Hierarchy);
+		ObjectIndex = Index;
+	}
+
+	return *ObjectIndex;
+}
+
+/**
+ * Checks whether an object of the index is loaded.
+ * @param Asset The object in its package asset.
+ * @return True if the object's ID is loaded, from any package.
+ */
+bool UArticyDatabase::IsLoadedAsset(const UArticyObject* Asset) const
+{
+	return Asset && LoadedObjects.Contains(Asset->GetId());
+}
+
+/**
+ * Gets a clone of a loaded object, making its runtime copy on first use.
+ * @param Id The ID of the object.
+ * @param CloneId The ID of the clone, 0 for the runtime copy.
+ * @return The clone, or nullptr if the object is not loaded or has no such clone.
+ */
+UArticyObject* UArticyDatabase::FindRuntimeObject(FArticyId Id, int32 CloneId) const
+{
+	if (CloneId != 0)
+	{
+		// clones are only made from the runtime copy, so an object without one has no clones either
+		const FArticyCloneList* CloneList = ObjectClones.Find(Id);
+		const FArticyShadowableObject* Clone = CloneList ? CloneList->Clones.Find(CloneId) : nullptr;
+		return Clone ? Clone->Get(this) : nullptr;
+	}
+
+	if (UArticyObject* const* Copy = LoadedObjectsById.Find(Id))
+		return *Copy;
+
+	const FLoadedObject* LoadedObject = LoadedObjects.Find(Id);
+	if (!LoadedObject || !LoadedObject->Asset)
+		return nullptr;
+
+	// Runtime copies are accounted to the packages of their objects
+	LLM_SCOPE_BYTAG(Articy_Packages);
+	UArticyObject* Copy = DuplicateObject<UArticyObject>(LoadedObject->Asset, const_cast<UArticyDatabase*>(this));
+	FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::ObjectsDuplicated);
+	Copy->SetCloneID(0);
+	LoadedObjectsById.Add(Id, Copy);
+	BumpGeneration();
+	return Copy;
+}
+
+/**
+ * Clones a loaded object.
+ * @param Id The ID of the object.
+ * @param CloneId The ID of the clone, -1 for the first free one.
+ * @param bFailIfExists Return nullptr instead of the clone if it already exists.
+ * @return The clone, or nullptr if the object is not loaded or the clone exists and bFailIfExists is set.
+ */
+UArticyObject* UArticyDatabase::CloneRuntimeObject(FArticyId Id, int32 CloneId, bool bFailIfExists) const
+{
+	if (CloneId != -1)
+	{
+		if (UArticyObject* Existing = FindRuntimeObject(Id, CloneId))
+			return bFailIfExists ? nullptr : Existing;
+	}
+
+	//clones are made from the runtime copy
+	UArticyObject* Original = FindRuntimeObject(Id);
+	if (!Original)
+		return nullptr;
+
+	LLM_SCOPE_BYTAG(Articy_Packages);
+	UArticyObject* Clone = DuplicateObject(Original, Original);
+	FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::ObjectsDuplicated);
+
+	// looked up after duplicating, which may have cloned other objects
+	FArticyCloneList& CloneList = ObjectClones.FindOrAdd(Id);
+	if (CloneId == -1)
+	{
+		//find the first free clone id
+		while (CloneList.Clones.Contains(CloneList.FirstFreeCloneId))
+			++CloneList.FirstFreeCloneId;
+
+		CloneId = CloneList.FirstFreeCloneId++;
+	}
+
+	CloneList.Clones.Add(CloneId, FArticyShadowableObject{ Clone, CloneId });
+	BumpGeneration();
+	return Clone;
+}
+
+/**
+ * Gets the first loaded object with a name.
+ * @param TechnicalName The technical name of the object.
+ * @return The object in its package asset, or nullptr if none is loaded.
+ */
+const UArticyObject* UArticyDatabase::FindLoadedAssetByName(FName TechnicalName) const
+{
+	const TArray<UArticyObject*>* Assets = GetObjectIndex().ByName.Find(TechnicalName);
+	if (!Assets)
+		return nullptr;
+
+	for (const UArticyObject* Asset : *Assets)
+	{
+		if (IsLoadedAsset(Asset))
+			return Asset;
+	}
+	return nullptr;
 }
 
 /**
@@ -545,6 +765,136 @@ void UArticyDatabase::SetExpressoScriptsClass(TSubclassOf<UArticyExpressoScripts
 	ExpressoScriptsClass = NewClass;
 }
 
+/**
+ * Gathers the state of this database for the articy.stats console command.
+ * @param bIncludeMemory Whether to estimate the memory of the loaded packages, which visits all of their objects.
+ * @return The state of the database.
+ */
+UArticyDatabase::FRuntimeStats UArticyDatabase::GetRuntimeStats(bool bIncludeMemory) const
+{
+	FRuntimeStats Stats;
+	for (const FString& PackageName : LoadedPackages)
+	{
+		const UArticyPackage* const* Package = ImportedPackages.Find(PackageName);
+		if (!Package || !*Package)
+			continue;
+
+		FRuntimeStats::FPackage& Entry = Stats.Packages.AddDefaulted_GetRef();
+		Entry.Name = PackageName;
+		Entry.NumObjects = (*Package)->GetAssets().Num();
+		if (bIncludeMemory)
+			Entry.Bytes = GetPackageResidentBytes(PackageName);
+	}
+
+	Stats.NumObjects = LoadedObjects.Num();
+	Stats.NumRuntimeCopies = LoadedObjectsById.Num();
+	Stats.NumClones = LoadedObjectsById.Num();
+	for (const auto& Pair : ObjectClones)
+		Stats.NumClones += Pair.Value.Clones.Num();
+
+	Stats.ShadowLevel = GetShadowLevel();
+	Stats.NumShadowedValues = PropertyShadows.Num();
+	return Stats;
+}
+
+/**
+ * Estimates the memory a loaded package keeps resident.
+ * @param PackageName The name of the package.
+ * @return The estimated size in bytes, 0 if the package is not loaded.
+ */
+int64 UArticyDatabase::GetPackageResidentBytes(const FString& PackageName) const
+{
+	UArticyPackage* const* Package = ImportedPackages.Find(PackageName);
+	if (!Package || !*Package || !LoadedPackages.Contains(PackageName))
+		return 0;
+
+	int64 Bytes = (*Package)->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	for (UArticyObject* Asset : (*Package)->GetAssets())
+	{
+		if (!Asset)
+			continue;
+
+		Bytes += Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		if (UArticyObject* const* Copy = LoadedObjectsById.Find(Asset->GetId()))
+		{
+			if (*Copy)
+				Bytes += (*Copy)->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+		if (const FArticyCloneList* CloneList = ObjectClones.Find(Asset->GetId()))
+		{
+			for (const auto& Pair : CloneList->Clones)
+			{
+				if (UArticyObject* Clone = Pair.Value.Get(nullptr))
+					Bytes += Clone->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+			}
+		}
+	}
+
+	if (UArticyLocalizerSystem* LocalizerSystem = UArticyLocalizerSystem::Get())
+		Bytes += LocalizerSystem->GetStringTableResourceSize(GetStringTableName(PackageName));
+	return Bytes;
+}
+
+/**
+ * Writes the clone table to a snapshot: the IDs of all objects with clones and their clone IDs.
+ * @param Ar The archive to write to.
+ */
+void UArticyDatabase::SaveCloneTable(FArchive& Ar) const
+{
+	// three flat arrays, so the archive copies each of them at once
+	TArray<uint64> Ids;
+	TArray<int32> NumClones;
+	TArray<int32> CloneIds;
+	for (const auto& Pair : ObjectClones)
+	{
+		if (Pair.Value.Clones.Num() == 0)
+			continue;
+
+		for (const auto& Clone : Pair.Value.Clones)
+			CloneIds.Add(Clone.Key);
+		Ids.Add(Pair.Key.Get());
+		NumClones.Add(Pair.Value.Clones.Num());
+	}
+
+	Ar << Ids << NumClones << CloneIds;
+}
+
+/**
+ * Recreates the clones of a clone table written by SaveCloneTable.
+ * @param Ar The archive to read from.
+ * @return False if the table could not be read.
+ */
+bool UArticyDatabase::LoadCloneTable(FArchive& Ar)
+{
+	TArray<uint64> Ids;
+	TArray<int32> NumClones;
+	TArray<int32> CloneIds;
+	Ar << Ids << NumClones << CloneIds;
+	if (Ar.IsError() || Ids.Num() != NumClones.Num())
+		return false;
+
+	LLM_SCOPE_BYTAG(Articy_Packages);
+
+	int32 Next = 0;
+	for (int32 i = 0; i < Ids.Num(); ++i)
+	{
+		if (NumClones[i] < 0 || Next + NumClones[i] > CloneIds.Num())
+			return false;
+
+		if (!FindRuntimeObject(Ids[i]))
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Snapshot: object %llu is not loaded, its clones are skipped."), Ids[i]);
+			Next += NumClones[i];
+			continue;
+		}
+
+		for (const int32 End = Next + NumClones[i]; Next < End; ++Next)
+			CloneRuntimeObject(Ids[i], CloneIds[Next], false);
+	}
+
+	return true;
+}
+
 /**
  * Retrieves the original database asset, optionally loading all packages.
  * @param bLoadAllPackages If true, loads all packages.
@@ -678,6 +1028,57 @@ UArticyObject* UArticyDatabase::GetObjectUnshadowed(FArticyId Id, int32 CloneId)
 	return GetObjectInternal(Id, CloneId, true);
 }
 
+/**
+ * Records the value of an object property before it is written in a shadowed operation.
+ * @param Object The object or feature that is written.
+ * @param Property The property that is written.
+ */
+void UArticyDatabase::ShadowProperty(UObject* Object, const FProperty* Property)
+{
+	const uint32 Level = GetShadowLevel();
+	if (Level == 0 || !Object || !Property)
+		return;
+
+	bool bLevelHasShadows = false;
+	for (int32 i = PropertyShadows.Num() - 1; i >= 0 && PropertyShadows[i].ShadowLevel == Level; --i)
+	{
+		bLevelHasShadows = true;
+		if (PropertyShadows[i].Object == Object && PropertyShadows[i].Property == Property)
+			return;
+	}
+
+	LLM_SCOPE_BYTAG(Articy_Shadows);
+	void* Value = FMemory::Malloc(Property->GetSize(), Property->GetMinAlignment());
+	Property->InitializeValue(Value);
+	Property->CopyCompleteValue(Value, Property->ContainerPtrToValuePtr<void>(Object));
+	PropertyShadows.Add({ Level, Object, Property, Value });
+
+	// One restore per level, it restores everything recorded at the level
+	if (!bLevelHasShadows)
+	{
+		RegisterUndo(this, [](void* Target, uint32 ShadowLevel) { static_cast<UArticyDatabase*>(Target)->RestorePropertyShadows(ShadowLevel); });
+	}
+}
+
+/**
+ * Restores the properties recorded at a shadow level, the latest first.
+ * @param ShadowLevel The shadow level that is popped.
+ */
+void UArticyDatabase::RestorePropertyShadows(uint32 ShadowLevel)
+{
+	while (PropertyShadows.Num() > 0 && PropertyShadows.Last().ShadowLevel == ShadowLevel)
+	{
+		FPropertyShadow Shadow = PropertyShadows.Pop(false);
+		if (UObject* Object = Shadow.Object.Get())
+			Shadow.Property->CopyCompleteValue(Shadow.Property->ContainerPtrToValuePtr<void>(Object), Shadow.Value);
+
+		Shadow.Property->DestroyValue(Shadow.Value);
+		FMemory::Free(Shadow.Value);
+	}
+
+	ensureMsgf(PropertyShadows.Num() == 0 || PropertyShadows.Last().ShadowLevel < ShadowLevel, TEXT("Property shadows of level %d were not restored!"), ShadowLevel);
+}
+
 /**
  * Retrieves an Articy object by its ID and clone ID, with optional unshadowing.
  * @param Id The ID of the object to retrieve.
@@ -687,8 +1088,7 @@ UArticyObject* UArticyDatabase::GetObjectUnshadowed(FArticyId Id, int32 CloneId)
  */
 UArticyObject* UArticyDatabase::GetObjectInternal(FArticyId Id, int32 CloneId, bool bForceUnshadowed) const
 {
-	UArticyCloneableObject* const* info = LoadedObjectsById.Find(Id);
-	return info && (*info) ? (*info)->Get(this, CloneId, bForceUnshadowed) : nullptr;
+	return FindRuntimeObject(Id, CloneId);
 }
 
 /**
@@ -700,12 +1100,8 @@ UArticyObject* UArticyDatabase::GetObjectInternal(FArticyId Id, int32 CloneId, b
  */
 UArticyObject* UArticyDatabase::GetObjectByName(FName TechnicalName, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
 {
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
-	if (!arr || arr->Objects.Num() <= 0)
-		return nullptr;
-
-	auto info = arr->Objects[0];
-	return info ? Cast<UArticyObject>(info->Get(this, CloneId)) : nullptr;
+	const UArticyObject* Asset = FindLoadedAssetByName(TechnicalName);
+	return Asset ? FindRuntimeObject(Asset->GetId(), CloneId) : nullptr;
 }
 
 /**
@@ -716,11 +1112,14 @@ UArticyObject* UArticyDatabase::GetObjectByName(FName TechnicalName, int32 Clone
  */
 UArticyObject* UArticyDatabase::GetObjectFromStringRepresentation(FString StringID_CloneID, TSubclassOf<class UArticyObject> CastTo) const
 {
-	FString StringId, CloneId;
-	StringID_CloneID.Split(TEXT("_"), &StringId, &CloneId, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
-	uint64 id = FCString::Strtoui64(*StringId, NULL, 10);
-
-	return GetObjectInternal(id, FCString::Atoi(*CloneId));
+	// parsed in place, UI code turns IDs back into objects often
+	const FStringView Representation = StringID_CloneID;
+	int32 Separator;
+	if (!Representation.FindLastChar(TEXT('_'), Separator))
+		return GetObjectInternal(ArticyHelpers::DecToUint64(Representation), 0);
+
+	const uint64 id = ArticyHelpers::DecToUint64(Representation.Left(Separator));
+	return GetObjectInternal(id, static_cast<int32>(ArticyHelpers::DecToUint64(Representation.RightChop(Separator + 1))));
 }
 
 /**
@@ -744,14 +1143,19 @@ TArray<UArticyObject*> UArticyDatabase::GetObjects(FName TechnicalName, int32 Cl
 TArray<UArticyObject*> UArticyDatabase::GetObjectsOfClass(TSubclassOf<class UArticyObject> Type, int32 CloneId) const
 {
 	TArray<UArticyObject*> arr;
-	TArray<UArticyCloneableObject*> Objects;
-	LoadedObjectsById.GenerateValueArray(Objects);
+	const TArray<UArticyObject*>* Objects = Type ? GetObjectIndex().ByClass.Find(Type.Get()) : nullptr;
+	if (!Objects)
+		return arr;
 
-	for (auto ClonableObject : Objects)
+	arr.Reserve(Objects->Num());
+	for (const UArticyObject* Asset : *Objects)
 	{
-		auto obj = ClonableObject->Get(this, CloneId, /*bForceUnshadowed = */ true);
-		if (obj && (obj->GetCloneId() == CloneId) && obj->IsA(Type))
-			arr.Add(Cast<UArticyObject>(obj));
+		if (!IsLoadedAsset(Asset))
+			continue;
+
+		auto obj = FindRuntimeObject(Asset->GetId(), CloneId);
+		if (obj && (obj->GetCloneId() == CloneId))
+			arr.Add(obj);
 	}
 
 	return arr;
@@ -764,11 +1168,10 @@ TArray<UArticyObject*> UArticyDatabase::GetObjectsOfClass(TSubclassOf<class UArt
 TArray<UArticyObject*> UArticyDatabase::GetAllObjects() const
 {
 	TArray<UArticyObject*> arr;
-	TArray<UArticyCloneableObject*> Objects;
-	LoadedObjectsById.GenerateValueArray(Objects);
-	for (auto ClonableObject : Objects)
+	arr.Reserve(LoadedObjects.Num());
+	for (const auto& LoadedObject : LoadedObjects)
 	{
-		auto obj = ClonableObject->Get(this, 0, /*bForceUnshadowed = */ true);
+		auto obj = FindRuntimeObject(LoadedObject.Key);
 		arr.Add(obj);
 	}
 	return arr;
@@ -785,8 +1188,7 @@ TArray<UArticyObject*> UArticyDatabase::GetAllObjects() const
  */
 UArticyObject* UArticyDatabase::CloneFrom(FArticyId Id, int32 NewCloneId, TSubclassOf<class UArticyObject> CastTo)
 {
-	auto info = LoadedObjectsById.Find(Id);
-	return info ? (*info)->Clone(this, NewCloneId, true) : nullptr;
+	return CloneRuntimeObject(Id, NewCloneId, true);
 }
 
 /**
@@ -798,12 +1200,90 @@ UArticyObject* UArticyDatabase::CloneFrom(FArticyId Id, int32 NewCloneId, TSubcl
  */
 UArticyObject* UArticyDatabase::CloneFromByName(FName TechnicalName, int32 NewCloneId, TSubclassOf<class UArticyObject> CastTo)
 {
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
-	if (!arr || arr->Objects.Num() <= 0)
-		return nullptr;
+	const UArticyObject* Asset = FindLoadedAssetByName(TechnicalName);
+	return Asset ? CloneRuntimeObject(Asset->GetId(), NewCloneId, true) : nullptr;
+}
+
+/**
+ * Clones many Articy objects at once, each clone getting the next free clone ID of its object.
+ * The runtime copies are looked up once per object, then all clones are duplicated and finally
+ * registered in one pass, reserving the clone slots of each object up front.
+ * Duplicating creates UObjects and runs their PostDuplicate, so it stays on the game thread.
+ * @param Ids The IDs of the objects to clone, an ID may appear several times.
+ * @param OutClones Receives a clone per ID in the same order, nullptr for the IDs of objects that are not loaded.
+ */
+void UArticyDatabase::CloneFromBatch(TConstArrayView<FArticyId> Ids, TArray<UArticyObject*>& OutClones)
+{
+	OutClones.Reset(Ids.Num());
 
-	auto info = arr->Objects[0];
-	return info ? Cast<UArticyObject>(info->Clone(this, NewCloneId, true)) : nullptr;
+	// the runtime copy and the number of clones of each object
+	TMap<FArticyId, TPair<UArticyObject*, int32>> Originals;
+	Originals.Reserve(Ids.Num());
+	for (const FArticyId& Id : Ids)
+	{
+		TPair<UArticyObject*, int32>* Original = Originals.Find(Id);
+		if (!Original)
+			Original = &Originals.Add(Id, TPair<UArticyObject*, int32>(FindRuntimeObject(Id), 0));
+		++Original->Value;
+	}
+
+	LLM_SCOPE_BYTAG(Articy_Packages);
+
+	int32 NumDuplicated = 0;
+	for (const FArticyId& Id : Ids)
+	{
+		UArticyObject* Original = Originals.FindChecked(Id).Key;
+		OutClones.Add(Original ? DuplicateObject(Original, Original) : nullptr);
+		NumDuplicated += Original ? 1 : 0;
+	}
+	FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::ObjectsDuplicated, NumDuplicated);
+
+	// registered after duplicating, which may have cloned other objects
+	for (TPair<FArticyId, TPair<UArticyObject*, int32>>& Pair : Originals)
+	{
+		if (Pair.Value.Key)
+		{
+			FArticyCloneList& CloneList = ObjectClones.FindOrAdd(Pair.Key);
+			CloneList.Clones.Reserve(CloneList.Clones.Num() + Pair.Value.Value);
+		}
+	}
+
+	FArticyCloneList* CloneList = nullptr;
+	FArticyId CloneListId;
+	for (int32 i = 0; i < Ids.Num(); ++i)
+	{
+		if (!OutClones[i])
+			continue;
+
+		// batches usually clone an object several times in a row
+		if (!CloneList || CloneListId != Ids[i])
+		{
+			CloneList = &ObjectClones.FindChecked(Ids[i]);
+			CloneListId = Ids[i];
+		}
+
+		//find the first free clone id
+		while (CloneList->Clones.Contains(CloneList->FirstFreeCloneId))
+			++CloneList->FirstFreeCloneId;
+
+		const int32 CloneId = CloneList->FirstFreeCloneId++;
+		CloneList->Clones.Add(CloneId, FArticyShadowableObject{ OutClones[i], CloneId });
+	}
+
+	if (NumDuplicated > 0)
+		BumpGeneration();
+}
+
+/**
+ * Clones many Articy objects at once, see CloneFromBatch.
+ * @param Ids The IDs of the objects to clone, an ID may appear several times.
+ * @return A clone per ID in the same order, nullptr for the IDs of objects that are not loaded.
+ */
+TArray<UArticyObject*> UArticyDatabase::CloneFromBatchBP(const TArray<FArticyId>& Ids)
+{
+	TArray<UArticyObject*> Clones;
+	CloneFromBatch(Ids, Clones);
+	return Clones;
 }
 
 //---------------------------------------------------------------------------//
@@ -816,8 +1296,7 @@ UArticyObject* UArticyDatabase::CloneFromByName(FName TechnicalName, int32 NewCl
  */
 UArticyObject* UArticyDatabase::GetOrClone(FArticyId Id, int32 NewCloneId)
 {
-	auto info = LoadedObjectsById.Find(Id);
-	return info ? (*info)->Clone(this, NewCloneId, false) : nullptr;
+	return CloneRuntimeObject(Id, NewCloneId, false);
 }
 
 /**
@@ -828,12 +1307,8 @@ UArticyObject* UArticyDatabase::GetOrClone(FArticyId Id, int32 NewCloneId)
  */
 UArticyObject* UArticyDatabase::GetOrCloneByName(const FName& TechnicalName, int32 NewCloneId)
 {
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
-	if (!arr || arr->Objects.Num() <= 0)
-		return nullptr;
-
-	auto info = arr->Objects[0];
-	return info ? Cast<UArticyObject>(info->Clone(this, NewCloneId, false)) : nullptr;
+	const UArticyObject* Asset = FindLoadedAssetByName(TechnicalName);
+	return Asset ? CloneRuntimeObject(Asset->GetId(), NewCloneId, false) : nullptr;
 }
 
 /**
@@ -877,3 +1352,4 @@ UArticyDatabase::FAssetId UArticyDatabase::ResolveIDs(const FString& articyAsset
 TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UArticyDatabase>> UArticyDatabase::Clones;
 /** Static persistent clone instance. */
 TWeakObjectPtr<UArticyDatabase> UArticyDatabase::PersistentClone;
+uint32 UArticyDatabase::Generation = 0;
@@ -4,40 +4,342 @@
 
 #include "ArticyExpressoScripts.h"
 #include "ArticyRuntimeModule.h"
+#include "ArticyRuntimeStats.h"
+#include "ArticyRandomStream.h"
 #include "ArticyFlowPlayer.h"
+#include "Misc/ScopeRWLock.h"
 #include <ArticyPins.h>
+#include "Interfaces/ArticyObjectWithSpeaker.h"
 
 TMap<FName, ExpressoType::Definition> ExpressoType::Definitions;
 
-ExpressoType::ExpressoType() {}
-ExpressoType::~ExpressoType() {}
+/**
+ * @brief Copy constructor, a viewed string is copied into an owned one.
+ *
+ * @param Other The value to copy.
+ */
+ExpressoType::ExpressoType(const ExpressoType& Other)
+{
+	*this = Other;
+}
+
+/**
+ * @brief Move constructor, keeps a viewed string a view.
+ *
+ * @param Other The value to move from, it is undefined afterwards.
+ */
+ExpressoType::ExpressoType(ExpressoType&& Other)
+{
+	*this = MoveTemp(Other);
+}
+
+/**
+ * @brief Copy assignment, a viewed string is copied into an owned one.
+ *
+ * @param Other The value to copy.
+ * @return This value.
+ */
+ExpressoType& ExpressoType::operator=(const ExpressoType& Other)
+{
+	if (this == &Other)
+		return *this;
+
+	if (Other.Type != String)
+	{
+		Reset();
+		IntValue = Other.IntValue; // copies the whole value, whichever member is active
+		Type = Other.Type;
+		return *this;
+	}
+
+	// Other might view our own string
+	FString copy = Other.GetString();
+	Reset();
+	new (&OwnedString) FString(MoveTemp(copy));
+	Type = String;
+	return *this;
+}
+
+/**
+ * @brief Move assignment, keeps a viewed string a view.
+ *
+ * @param Other The value to move from, it is undefined afterwards.
+ * @return This value.
+ */
+ExpressoType& ExpressoType::operator=(ExpressoType&& Other)
+{
+	if (this == &Other)
+		return *this;
+
+	Reset();
+	Type = Other.Type;
+	bStringView = Other.bStringView;
+	if (Type == String && !bStringView)
+		new (&OwnedString) FString(MoveTemp(*Other.OwnedString.GetTypedPtr()));
+	else
+		IntValue = Other.IntValue;
+
+	Other.Reset();
+	return *this;
+}
+
+/**
+ * @brief Releases an owned string and makes this value undefined.
+ */
+void ExpressoType::Reset()
+{
+	if (Type == String && !bStringView)
+		DestructItem(OwnedString.GetTypedPtr());
+
+	IntValue = 0;
+	Type = Undefined;
+	bStringView = false;
+}
+
+/**
+ * @brief Creates a string ExpressoType that references Value instead of copying it.
+ *
+ * @param Value The string to reference, it must outlive the returned temporary.
+ * @return The string view.
+ */
+ExpressoType ExpressoType::MakeStringView(const FString& Value)
+{
+	ExpressoType view;
+	view.StringView = &Value;
+	view.Type = String;
+	view.bStringView = true;
+	return view;
+}
+
+/**
+ * @brief Creates a string ExpressoType from a string literal.
+ *
+ * The literal is converted once and interned by its address.
+ *
+ * @param Value The string literal.
+ * @return A view of the interned literal.
+ */
+ExpressoType ExpressoType::Literal(const TCHAR* Value)
+{
+	static FRWLock Lock;
+	static TMap<const TCHAR*, TUniquePtr<FString>> Literals;
+
+	{
+		FReadScopeLock readLock(Lock);
+		if (const auto* literal = Literals.Find(Value))
+			return MakeStringView(**literal);
+	}
+
+	FWriteScopeLock writeLock(Lock);
+	auto& literal = Literals.FindOrAdd(Value);
+	if (!literal)
+		literal = MakeUnique<FString>(Value);
+	return MakeStringView(*literal);
+}
+
+/**
+ * @brief Returns the interned string of a name.
+ *
+ * @param Name The name.
+ * @return The string of the name, valid until shutdown.
+ */
+const FString& ExpressoType::InternName(const FName& Name)
+{
+	static FRWLock Lock;
+	static TMap<FName, TUniquePtr<FString>> Names;
+
+	{
+		FReadScopeLock readLock(Lock);
+		if (const auto* name = Names.Find(Name))
+			return **name;
+	}
+
+	FWriteScopeLock writeLock(Lock);
+	auto& name = Names.FindOrAdd(Name);
+	if (!name)
+		name = MakeUnique<FString>(Name.ToString());
+	return *name;
+}
+
+/**
+ * @brief Returns the string that non-string values view.
+ */
+const FString& ExpressoType::EmptyString()
+{
+	static const FString Empty;
+	return Empty;
+}
+
+/**
+ * @brief Retrieves the string value of the ExpressoType.
+ *
+ * A viewed string is copied first, and a value of another type becomes an empty string.
+ *
+ * @return The string value.
+ */
+FString& ExpressoType::GetString()
+{
+	if (Type != String || bStringView)
+		*this = ExpressoType(FString(static_cast<const ExpressoType*>(this)->GetString()));
+
+	return *OwnedString.GetTypedPtr();
+}
+
+/**
+ * @brief Compares the string value to a string, case insensitive like FString comparison.
+ *
+ * @param Literal The string to compare to.
+ * @return True if this is a string equal to Literal.
+ */
+bool ExpressoType::EqualsLiteral(const TCHAR* Literal) const
+{
+	return Type == String && FCString::Stricmp(*GetString(), Literal) == 0;
+}
+
+/**
+ * @brief Compares the string value to an ANSI string, case insensitive like FString comparison.
+ *
+ * @param Literal The string to compare to.
+ * @return True if this is a string equal to Literal.
+ */
+bool ExpressoType::EqualsLiteral(const ANSICHAR* Literal) const
+{
+	return Type == String && FPlatformString::Stricmp(*GetString(), Literal) == 0;
+}
 
 /**
  * @brief Constructs an ExpressoType from an object and a property name.
  *
  * This constructor initializes an ExpressoType instance based on the specified property of a given object.
+ * The property is resolved once per object class, see FArticyExpressoPropertyPath::Find.
  *
  * @param Object The object containing the property.
  * @param Property The name of the property.
  */
 ExpressoType::ExpressoType(UArticyBaseObject* Object, const FString& Property)
+	: ExpressoType(Object, FArticyExpressoPropertyPath::Find(Object, Property))
+{
+}
+
+/**
+ * @brief Constructs an ExpressoType from an object and a property resolved by a script call site.
+ *
+ * @param Object The object containing the property.
+ * @param Path The property path of the call site.
+ */
+ExpressoType::ExpressoType(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path)
 {
-	auto propName = Property;
-	Object = TryFeatureReroute(Object, propName);
+	FProperty* prop = nullptr;
+	const Definition* def = nullptr;
+	Object = Path.Resolve(Object, prop, def);
 
 	if (!Object)
 		return;
 
-	auto prop = Object->GetProperty(*propName);
 	if (!ensure(prop))
 		return;
 
-	FString itemType;
-	FName type = *prop->GetCPPType(&itemType);
+	if (ensureMsgf(def->Factory, TEXT("Property %s has unknown type %s!"), *Path.Path, *prop->GetCPPType()))
+		*this = def->Factory(Object, prop);
+}
+
+/**
+ * @brief Constructs a property path, splitting off the feature name once.
+ *
+ * @param InPath The property name, "Feature.Property" for a property of a feature.
+ */
+FArticyExpressoPropertyPath::FArticyExpressoPropertyPath(const TCHAR* InPath)
+	: Path(InPath)
+{
+	FString feature, property;
+	if (Path.Split(TEXT("."), &feature, &property))
+	{
+		FeatureName = *feature;
+		PropertyName = *property;
+	}
+	else
+	{
+		PropertyName = *Path;
+	}
+}
+
+/**
+ * @brief Finds the path of a property name on objects of the class of an object, adding it on first use.
+ *
+ * Names are kept per class, so a name used on objects of different classes is not resolved again
+ * every time the class changes.
+ *
+ * @param Object The object the property is accessed on, may be nullptr.
+ * @param InPath The property name, "Feature.Property" for a property of a feature.
+ * @return The path, valid until shutdown.
+ */
+FArticyExpressoPropertyPath& FArticyExpressoPropertyPath::Find(const UArticyBaseObject* Object, const FString& InPath)
+{
+	static TMap<FString, TMap<const UClass*, TUniquePtr<FArticyExpressoPropertyPath>>> Paths;
+
+	const UClass* objectClass = Object ? Object->GetObjectClass() : nullptr;
+
+	TMap<const UClass*, TUniquePtr<FArticyExpressoPropertyPath>>* classPaths = Paths.Find(InPath);
+	if (!classPaths)
+		classPaths = &Paths.Add(InPath);
+
+	TUniquePtr<FArticyExpressoPropertyPath>& path = classPaths->FindOrAdd(objectClass);
+	if (!path)
+		path = MakeUnique<FArticyExpressoPropertyPath>(*InPath);
+
+	return *path;
+}
+
+/**
+ * @brief Resolves the object holding the property and the property itself.
+ *
+ * The feature and property lookups are only repeated when the path is used on an object of another class.
+ *
+ * @param Object The object the property is accessed on.
+ * @param OutProperty The property, nullptr if it was not found.
+ * @param OutDefinition The type definition of the property, nullptr if it was not found.
+ * @return The object or its feature holding the property, nullptr if the feature was not found.
+ */
+UArticyBaseObject* FArticyExpressoPropertyPath::Resolve(UArticyBaseObject* Object, FProperty*& OutProperty,
+	const ExpressoType::Definition*& OutDefinition)
+{
+	OutProperty = nullptr;
+	OutDefinition = nullptr;
+
+	if (!Object)
+		return nullptr;
+
+	if (!FeatureName.IsNone())
+	{
+		const UClass* objectClass = Object->GetObjectClass();
+		if (objectClass != ObjectClass)
+		{
+			ObjectClass = objectClass;
+			FeatureProperty = CastField<FObjectPropertyBase>(Object->GetProperty(FeatureName));
+		}
 
-	auto factory = GetDefinition(type).Factory;
-	if (ensureMsgf(factory, TEXT("Property %s has unknown type %s!"), *propName, *type.ToString()))
-		*this = factory(Object, prop);
+		UArticyBaseFeature* Feature = FeatureProperty ? Cast<UArticyBaseFeature>(FeatureProperty->GetObjectPropertyValue_InContainer(Object)) : nullptr;
+		if (!ensure(Feature))
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Feature %s on Object %s is null, cannot access property %s!"),
+				*FeatureName.ToString(), *Object->GetName(), *PropertyName.ToString());
+			return nullptr;
+		}
+
+		Object = Feature;
+	}
+
+	const UClass* targetClass = Object->GetObjectClass();
+	if (targetClass != TargetClass)
+	{
+		TargetClass = targetClass;
+		TargetProperty = Object->GetProperty(PropertyName);
+		TargetDefinition = TargetProperty ? &ExpressoType::GetDefinition(TargetProperty) : nullptr;
+	}
+
+	OutProperty = TargetProperty;
+	OutDefinition = TargetDefinition;
+	return Object;
 }
 
 //---------------------------------------------------------------------------//
@@ -82,7 +384,18 @@ ExpressoType::ExpressoType(const double& Value)
  */
 ExpressoType::ExpressoType(const FString& Value)
 {
-	StringValue = Value;
+	new (&OwnedString) FString(Value);
+	Type = String;
+}
+
+/**
+ * @brief Constructs an ExpressoType from a string value, taking its memory.
+ *
+ * @param Value The string value to initialize the ExpressoType with.
+ */
+ExpressoType::ExpressoType(FString&& Value)
+{
+	new (&OwnedString) FString(MoveTemp(Value));
 	Type = String;
 }
 
@@ -97,17 +410,15 @@ ExpressoType::ExpressoType(const FString& Value)
  */
 ExpressoType::ExpressoType(const UArticyPrimitive* Object)
 {
-	Type = String;
-
 	if (!Object)
 	{
 		// Return "Null" ID to avoid crashes expecting this to be in the %11u_%d format
-		StringValue = "0_0";
+		*this = Literal(TEXT("0_0"));
 		return;
 	}
 
 	// Make sure to use the full 64-bit ID
-	StringValue = FString::Printf(TEXT("%llu_%d"), Object->GetId().Get(), Object->GetCloneId());
+	*this = ExpressoType(FString::Printf(TEXT("%llu_%d"), Object->GetId().Get(), Object->GetCloneId()));
 }
 
 /**
@@ -115,11 +426,7 @@ ExpressoType::ExpressoType(const UArticyPrimitive* Object)
  *
  * @param Value The ArticyString value to initialize the ExpressoType with.
  */
-ExpressoType::ExpressoType(const UArticyString& Value)
-{
-	Type = String;
-	StringValue = Value.Get();
-}
+ExpressoType::ExpressoType(const UArticyString& Value) : ExpressoType(Value.Get()) {}
 
 /**
  * @brief Constructs an ExpressoType from an ArticyInt value.
@@ -150,18 +457,16 @@ ExpressoType::ExpressoType(const UArticyBool& Value)
  */
 ExpressoType::ExpressoType(const FArticyId& Value)
 {
-	Type = String;
-
 	if (!Value)
 	{
 		// Return "Null" ID to avoid crashes expecting this to be in the %11u_%d format
-		StringValue = "0_0";
+		*this = Literal(TEXT("0_0"));
 		return;
 	}
 
 	// Make sure to use the full 64-bit ID
 	// > always 0 for clone ID... PB...
-	StringValue = FString::Printf(TEXT("%llu_0"), Value.Get());
+	*this = ExpressoType(FString::Printf(TEXT("%llu_0"), Value.Get()));
 }
 
 /**
@@ -758,6 +1063,35 @@ const ExpressoType::Definition& ExpressoType::GetDefinition(const FName& CppType
 	return Empty;
 }
 
+/**
+ * @brief Retrieves the definition matching the C++ type of a property.
+ *
+ * The C++ type name is only built the first time a property is accessed.
+ *
+ * @param Property The property.
+ * @return The definition of the property type, or an empty definition for unknown types.
+ */
+const ExpressoType::Definition& ExpressoType::GetDefinition(const FProperty* Property)
+{
+	static FRWLock Lock;
+	static TMap<const FProperty*, const Definition*> PropertyDefinitions;
+
+	{
+		FReadScopeLock readLock(Lock);
+		if (const auto* def = PropertyDefinitions.Find(Property))
+			return **def;
+	}
+
+	FString itemType;
+	const FName type = *Property->GetCPPType(&itemType);
+
+	FWriteScopeLock writeLock(Lock);
+	// the name lookup fills the definitions on first use, and never adds any afterwards
+	const Definition& def = ExpressoType{}.GetDefinition(type);
+	PropertyDefinitions.Add(Property, &def);
+	return def;
+}
+
 /**
  * @brief Sets the value of a property on an object.
  *
@@ -768,25 +1102,38 @@ const ExpressoType::Definition& ExpressoType::GetDefinition(const FName& CppType
  */
 void ExpressoType::SetValue(UArticyBaseObject* Object, FString Property) const
 {
-	Object = TryFeatureReroute(Object, Property);
+	SetValue(Object, FArticyExpressoPropertyPath::Find(Object, Property));
+}
+
+/**
+ * @brief Sets the value of a property resolved by a script call site on an object.
+ *
+ * @param Object The object containing the property.
+ * @param Path The property path of the call site.
+ */
+void ExpressoType::SetValue(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path) const
+{
+	FProperty* prop = nullptr;
+	const Definition* def = nullptr;
+	Object = Path.Resolve(Object, prop, def);
 
 	if (!Object)
 		return;
 
-	auto prop = Object->GetProperty(*Property);
 	if (!ensure(prop))
 	{
-		UE_LOG(LogArticyRuntime, Warning, TEXT("Property %s not found on Object %s!"), *Property, *Object->GetName());
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Property %s not found on Object %s!"), *Path.Path, *Object->GetName());
 		return;
 	}
 
-	FString itemType;
-	FName type = *prop->GetCPPType(&itemType);
-
-	auto setter = GetDefinition(type).Setter;
+	if (ensureMsgf(def->Setter, TEXT("Property %s has unknown type %s!"), *Path.Path, *prop->GetCPPType()))
+	{
+		// In a shadowed operation, keep the value the property has to be restored to
+		if (UArticyDatabase* Database = Object->GetTypedOuter<UArticyDatabase>())
+			Database->ShadowProperty(Object, prop);
 
-	if (ensureMsgf(setter, TEXT("Property %s has unknown type %s!"), *Property, *type.ToString()))
-		setter(Object, prop, *this);
+		def->Setter(Object, prop, *this);
+	}
 }
 
 /**
@@ -823,62 +1170,6 @@ UArticyBaseObject* ExpressoType::TryFeatureReroute(UArticyBaseObject* Object, FS
 	return Object;
 }
 
-/**
- * @brief Retrieves the boolean value of the ExpressoType.
- *
- * @return The boolean value.
- */
-bool& ExpressoType::GetBool() { return BoolValue; }
-
-/**
- * @brief Retrieves the boolean value of the ExpressoType.
- *
- * @return The boolean value.
- */
-const bool& ExpressoType::GetBool() const { return BoolValue; }
-
-/**
- * @brief Retrieves the int64 value of the ExpressoType.
- *
- * @return The int64 value.
- */
-int64& ExpressoType::GetInt() { return IntValue; }
-
-/**
- * @brief Retrieves the int64 value of the ExpressoType.
- *
- * @return The int64 value.
- */
-const int64& ExpressoType::GetInt() const { return IntValue; }
-
-/**
- * @brief Retrieves the double value of the ExpressoType.
- *
- * @return The double value.
- */
-double& ExpressoType::GetFloat() { return FloatValue; }
-
-/**
- * @brief Retrieves the double value of the ExpressoType.
- *
- * @return The double value.
- */
-const double& ExpressoType::GetFloat() const { return FloatValue; }
-
-/**
- * @brief Retrieves the string value of the ExpressoType.
- *
- * @return The string value.
- */
-FString& ExpressoType::GetString() { return StringValue; }
-
-/**
- * @brief Retrieves the string value of the ExpressoType.
- *
- * @return The string value.
- */
-const FString& ExpressoType::GetString() const { return StringValue; }
-
 /**
  * @brief Constructs an ExpressoType from an int32 value.
  *
@@ -947,7 +1238,7 @@ ExpressoType::ExpressoType(const FText& Value) : ExpressoType(Value.ToString())
  *
  * @param Value The FName value to initialize the ExpressoType with.
  */
-ExpressoType::ExpressoType(const FName& Value) : ExpressoType(Value.ToString()) {}
+ExpressoType::ExpressoType(const FName& Value) : ExpressoType(MakeStringView(InternName(Value))) {}
 
 /**
  * @brief Conversion operator to int8.
@@ -1083,16 +1374,35 @@ bool ExpressoType::operator>=(const ExpressoType& Other) const { return !(*this
 bool UArticyExpressoScripts::Evaluate(const int& ConditionFragmentHash, UArticyGlobalVariables* GV,
 	UObject* MethodProvider) const
 {
-	SetGV(GV);
-	UserMethodsProvider = MethodProvider;
+	return EvaluateAt(FindConditionIndex(ConditionFragmentHash), GV, MethodProvider);
+}
+
+/**
+ * @brief Evaluates a condition fragment by its dense index.
+ *
+ * @param ConditionIndex The index of the condition fragment.
+ * @param GV The global variables used in the evaluation.
+ * @param MethodProvider The method provider used in the evaluation.
+ * @return The result of the evaluation.
+ */
+bool UArticyExpressoScripts::EvaluateAt(int32 ConditionIndex, UArticyGlobalVariables* GV,
+	UObject* MethodProvider) const
+{
+	if (!ensure(Conditions.IsValidIndex(ConditionIndex)))
+		return false;
 
-	auto condition = Conditions.Find(ConditionFragmentHash);
-	bool result = ensure(condition) && (*condition)();
+	ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyEvaluate);
+	FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::ConditionsEvaluated);
 
-	// Clear methods provider
-	UserMethodsProvider = nullptr;
-	SetGV(nullptr);
-	return result;
+	// Only rebinds if the caller has not bound the same GV and methods provider already
+	FArticyExpressoEvaluationScope scope(this, GV, MethodProvider);
+
+	UArticyExpressoScripts* scripts = const_cast<UArticyExpressoScripts*>(this);
+	if (PendingNode && ConditionsUsingCurrentObject[ConditionIndex])
+		scripts->BindPendingNode();
+
+	// Fragments may call non-const helpers like random(), same as when they were lambdas capturing this
+	return Conditions[ConditionIndex](scripts);
 }
 
 /**
@@ -1108,21 +1418,198 @@ bool UArticyExpressoScripts::Evaluate(const int& ConditionFragmentHash, UArticyG
 bool UArticyExpressoScripts::Execute(const int& InstructionFragmentHash, UArticyGlobalVariables* GV,
 	UObject* MethodProvider) const
 {
-	SetGV(GV);
+	return ExecuteAt(FindInstructionIndex(InstructionFragmentHash), GV, MethodProvider);
+}
+
+/**
+ * @brief Executes an instruction fragment by its dense index.
+ *
+ * @param InstructionIndex The index of the instruction fragment.
+ * @param GV The global variables used in the execution.
+ * @param MethodProvider The method provider used in the execution.
+ * @return True if the execution was successful, false otherwise.
+ */
+bool UArticyExpressoScripts::ExecuteAt(int32 InstructionIndex, UArticyGlobalVariables* GV,
+	UObject* MethodProvider) const
+{
+	if (!ensure(Instructions.IsValidIndex(InstructionIndex)))
+		return false;
+
+	ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyExecute);
+
+	FArticyExpressoEvaluationScope scope(this, GV, MethodProvider);
+
+	UArticyExpressoScripts* scripts = const_cast<UArticyExpressoScripts*>(this);
+	if (PendingNode && InstructionsUsingCurrentObject[InstructionIndex])
+		scripts->BindPendingNode();
+
+	Instructions[InstructionIndex](scripts);
+	return true;
+}
+
+/**
+ * @brief Binds the global variables and methods provider the fragments run against.
+ *
+ * @param GV The global variables instance.
+ * @param MethodProvider The methods provider.
+ */
+void UArticyExpressoScripts::Bind(UArticyGlobalVariables* GV, UObject* MethodProvider) const
+{
+	if (BoundGV != GV)
+	{
+		SetGV(GV);
+		BoundGV = GV;
+	}
 	UserMethodsProvider = MethodProvider;
+}
+
+/**
+ * @brief Binds GV and MethodProvider to InScripts until the scope ends.
+ *
+ * @param InScripts The expresso scripts instance, may be nullptr.
+ * @param GV The global variables instance.
+ * @param MethodProvider The methods provider.
+ * @param RandomStream The stream random() draws from, nullptr keeps the one bound already.
+ */
+FArticyExpressoEvaluationScope::FArticyExpressoEvaluationScope(const UArticyExpressoScripts* InScripts,
+	UArticyGlobalVariables* GV, UObject* MethodProvider, FArticyRandomStream* RandomStream)
+	: Scripts(InScripts)
+{
+	if (!Scripts)
+		return;
 
-	bool result = false;
-	auto instruction = Instructions.Find(InstructionFragmentHash);
-	if (ensure(instruction))
+	PreviousGV = Scripts->BoundGV;
+	PreviousMethodProvider = Scripts->UserMethodsProvider;
+	PreviousRandomStream = Scripts->BoundRandomStream;
+	Scripts->Bind(GV, MethodProvider);
+	if (RandomStream)
+		Scripts->BoundRandomStream = RandomStream;
+}
+
+/**
+ * @brief Restores the binding that was active when the scope was entered.
+ */
+FArticyExpressoEvaluationScope::~FArticyExpressoEvaluationScope()
+{
+	if (!Scripts)
+		return;
+
+	Scripts->Bind(PreviousGV, PreviousMethodProvider);
+	Scripts->BoundRandomStream = PreviousRandomStream;
+}
+
+/**
+ * @brief Finds the dense index of a condition fragment.
+ *
+ * @param ConditionFragmentHash The hash of the condition fragment.
+ * @return The index of the condition, or INDEX_NONE if there is no such condition.
+ */
+int32 UArticyExpressoScripts::FindConditionIndex(const int& ConditionFragmentHash) const
+{
+	const int32* index = ConditionIndices.Find(ConditionFragmentHash);
+	if (!index)
+	{
+		const uint32* sharedHash = ConditionAliases.Find(ConditionFragmentHash);
+		index = sharedHash ? ConditionIndices.Find(*sharedHash) : nullptr;
+	}
+	return index ? *index : INDEX_NONE;
+}
+
+/**
+ * @brief Finds the dense index of an instruction fragment.
+ *
+ * @param InstructionFragmentHash The hash of the instruction fragment.
+ * @return The index of the instruction, or INDEX_NONE if there is no such instruction.
+ */
+int32 UArticyExpressoScripts::FindInstructionIndex(const int& InstructionFragmentHash) const
+{
+	const int32* index = InstructionIndices.Find(InstructionFragmentHash);
+	if (!index)
+	{
+		const uint32* sharedHash = InstructionAliases.Find(InstructionFragmentHash);
+		index = sharedHash ? InstructionIndices.Find(*sharedHash) : nullptr;
+	}
+	return index ? *index : INDEX_NONE;
+}
+
+/**
+ * @brief Registers a condition fragment under the next dense index.
+ *
+ * @param Hash The hash of the condition fragment.
+ * @param Function The generated function of the fragment.
+ * @param bUsesCurrentObject Whether the fragment needs the pending node bound before it runs.
+ */
+void UArticyExpressoScripts::AddCondition(uint32 Hash, FConditionFunction Function, bool bUsesCurrentObject)
+{
+	if (!ConditionIndices.Contains(Hash))
+	{
+		ConditionIndices.Add(Hash, Conditions.Add(Function));
+		ConditionsUsingCurrentObject.Add(bUsesCurrentObject);
+	}
+}
+
+/**
+ * @brief Registers an instruction fragment under the next dense index.
+ *
+ * @param Hash The hash of the instruction fragment.
+ * @param Function The generated function of the fragment.
+ * @param bUsesCurrentObject Whether the fragment needs the pending node bound before it runs.
+ */
+void UArticyExpressoScripts::AddInstruction(uint32 Hash, FInstructionFunction Function, bool bUsesCurrentObject)
+{
+	if (!InstructionIndices.Contains(Hash))
 	{
-		(*instruction)();
-		result = true;
+		InstructionIndices.Add(Hash, Instructions.Add(Function));
+		InstructionsUsingCurrentObject.Add(bUsesCurrentObject);
 	}
+}
+
+/**
+ * @brief Makes the pending node the current object and sets its speaker.
+ *
+ * A pin speaks with the voice of its owner. A node that is no articy primitive leaves the current object as it was.
+ */
+void UArticyExpressoScripts::BindPendingNode()
+{
+	UObject* node = PendingNode;
+	PendingNode = nullptr;
+
+	auto obj = Cast<UArticyPrimitive>(node);
+	if (!obj)
+		return;
 
-	// Clear methods provider
-	UserMethodsProvider = nullptr;
-	SetGV(nullptr);
-	return result;
+	self = obj;
+
+	IArticyObjectWithSpeaker* speakerProvider;
+	if (auto flowPin = Cast<UArticyFlowPin>(obj))
+		speakerProvider = Cast<IArticyObjectWithSpeaker>(flowPin->GetOwner(PendingDatabase));
+	else
+		speakerProvider = Cast<IArticyObjectWithSpeaker>(obj);
+
+	if (speakerProvider)
+		speaker = speakerProvider->GetSpeaker();
+}
+
+/**
+ * @brief Registers a condition fragment that shares the function of another one.
+ *
+ * @param Hash The hash of the condition fragment.
+ * @param SharedHash The hash of the fragment whose function it shares.
+ */
+void UArticyExpressoScripts::AddConditionAlias(uint32 Hash, uint32 SharedHash)
+{
+	ConditionAliases.Add(Hash, SharedHash);
+}
+
+/**
+ * @brief Registers an instruction fragment that shares the function of another one.
+ *
+ * @param Hash The hash of the instruction fragment.
+ * @param SharedHash The hash of the fragment whose function it shares.
+ */
+void UArticyExpressoScripts::AddInstructionAlias(uint32 Hash, uint32 SharedHash)
+{
+	InstructionAliases.Add(Hash, SharedHash);
 }
 
 /**
@@ -1139,11 +1626,23 @@ UArticyObject* UArticyExpressoScripts::getObj(const FString& NameOrId, const uin
 	if (NameOrId.StartsWith(TEXT("0x")))
 		return OwningDatabase->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::HexToUint64(NameOrId) }, CloneId);
 	if (NameOrId.IsNumeric())
-		return OwningDatabase->GetObject<UArticyObject>(FArticyId{ FCString::Strtoui64(*NameOrId, NULL, 10) }, CloneId);
+		return OwningDatabase->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::DecToUint64(NameOrId) }, CloneId);
 
 	return OwningDatabase->GetObjectByName(*NameOrId, CloneId);
 }
 
+/**
+ * @brief Retrieves an Articy object by an ID parsed when the script was generated.
+ *
+ * @param Id The ID of the object.
+ * @param CloneId The clone ID of the object.
+ * @return The Articy object.
+ */
+UArticyObject* UArticyExpressoScripts::getObj(const FArticyId& Id, const uint32& CloneId) const
+{
+	return OwningDatabase->GetObject<UArticyObject>(Id, CloneId);
+}
+
 /**
  * @brief Retrieves an Articy object by a compound ID.
  *
@@ -1278,6 +1777,55 @@ ExpressoType UArticyExpressoScripts::getProp(const ExpressoType& Id_CloneId, con
 	return getProp(getObjInternal(Id_CloneId), Property);
 }
 
+/**
+ * @brief Sets the value of a property resolved by the call site on an Articy object.
+ *
+ * @param Object The Articy object containing the property.
+ * @param Path The property path of the call site.
+ * @param Value The value to set.
+ */
+void UArticyExpressoScripts::setProp(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path, const ExpressoType& Value)
+{
+	Value.SetValue(Object, Path);
+}
+
+/**
+ * @brief Sets the value of a property resolved by the call site on an Articy object.
+ *
+ * @param Id_CloneId The compound ID of the object.
+ * @param Path The property path of the call site.
+ * @param Value The value to set.
+ */
+void UArticyExpressoScripts::setProp(const ExpressoType& Id_CloneId, FArticyExpressoPropertyPath& Path,
+	const ExpressoType& Value) const
+{
+	setProp(getObjInternal(Id_CloneId), Path, Value);
+}
+
+/**
+ * @brief Retrieves the value of a property resolved by the call site on an Articy object.
+ *
+ * @param Object The Articy object containing the property.
+ * @param Path The property path of the call site.
+ * @return The value of the property.
+ */
+ExpressoType UArticyExpressoScripts::getProp(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path)
+{
+	return ExpressoType{ Object, Path };
+}
+
+/**
+ * @brief Retrieves the value of a property resolved by the call site on an Articy object.
+ *
+ * @param Id_CloneId The compound ID of the object.
+ * @param Path The property path of the call site.
+ * @return The value of the property.
+ */
+ExpressoType UArticyExpressoScripts::getProp(const ExpressoType& Id_CloneId, FArticyExpressoPropertyPath& Path) const
+{
+	return getProp(getObjInternal(Id_CloneId), Path);
+}
+
 /**
  * @brief Generates a random integer between Min and Max.
  *
@@ -1289,7 +1837,7 @@ ExpressoType UArticyExpressoScripts::getProp(const ExpressoType& Id_CloneId, con
  */
 int UArticyExpressoScripts::random(int Min, int Max)
 {
-	return FMath::RandRange(Min, Max);
+	return BoundRandomStream ? int(BoundRandomStream->RandRange(Min, Max)) : FMath::RandRange(Min, Max);
 }
 
 /**
@@ -1302,7 +1850,7 @@ int UArticyExpressoScripts::random(int Min, int Max)
  */
 int UArticyExpressoScripts::random(int Max)
 {
-	return FMath::RandRange(0, Max);
+	return random(0, Max);
 }
 
 /**
@@ -1316,7 +1864,7 @@ int UArticyExpressoScripts::random(int Max)
  */
 float UArticyExpressoScripts::random(float Min, float Max)
 {
-	return FMath::FRandRange(Min, Max);
+	return BoundRandomStream ? BoundRandomStream->FRandRange(Min, Max) : FMath::FRandRange(Min, Max);
 }
 
 /**
@@ -1329,7 +1877,7 @@ float UArticyExpressoScripts::random(float Min, float Max)
  */
 float UArticyExpressoScripts::random(float Max)
 {
-	return FMath::FRandRange(0, Max);
+	return random(0.f, Max);
 }
 
 /**
@@ -1352,12 +1900,12 @@ ExpressoType UArticyExpressoScripts::random(const ExpressoType& Min, const Expre
 
 	if (Min.Type == Min.Int)
 	{
-		return FMath::RandRange(Min.GetInt(), Max.GetInt());
+		return BoundRandomStream ? BoundRandomStream->RandRange(Min.GetInt(), Max.GetInt()) : FMath::RandRange(Min.GetInt(), Max.GetInt());
 	}
 
 	if (Min.Type == Min.Float)
 	{
-		return FMath::RandRange((float)Min.GetFloat(), (float)Max.GetFloat());
+		return random((float)Min.GetFloat(), (float)Max.GetFloat());
 	}
 
 	if (Min.Type == Min.Bool || Min.Type == Min.String || Min.Type == Min.Undefined)
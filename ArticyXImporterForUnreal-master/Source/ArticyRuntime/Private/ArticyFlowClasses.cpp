@@ -4,19 +4,37 @@
 
 #include "ArticyFlowClasses.h"
 
+/**
+ * Drops the cached target and target pin if packages were loaded or unloaded since they were resolved.
+ *
+ * The targets are then resolved once per package change, instead of on every exploration step.
+ */
+void UArticyJump::ValidateTargetCache() const
+{
+    const uint32 Generation = UArticyDatabase::GetGeneration();
+    if (TargetGeneration != Generation)
+    {
+        TargetObj = nullptr;
+        TargetPinObj = nullptr;
+        TargetGeneration = Generation;
+    }
+}
+
 /**
  * Retrieves the target object of the jump.
  *
  * This function will return the target object if it has been resolved,
  * otherwise, it will attempt to resolve it from the Articy database.
  *
+ * @param Database The database to resolve the target in, looked up if null.
  * @return Pointer to the target UArticyPrimitive object.
  */
-UArticyPrimitive* UArticyJump::GetTarget() const
+UArticyPrimitive* UArticyJump::GetTarget(const UArticyDatabase* Database) const
 {
+    ValidateTargetCache();
     if (!TargetObj)
     {
-        auto db = UArticyDatabase::Get(this);
+        auto db = Database ? Database : UArticyDatabase::Get(this);
         TargetObj = db ? db->GetObject(Target) : nullptr;
     }
 
@@ -29,15 +47,17 @@ UArticyPrimitive* UArticyJump::GetTarget() const
  * This function will return the target pin object if it has been resolved,
  * otherwise, it will attempt to resolve it from the target object.
  *
+ * @param Database The database to resolve the target in, looked up if null.
  * @return Pointer to the target UArticyFlowPin object.
  */
-UArticyFlowPin* UArticyJump::GetTargetPin() const
+UArticyFlowPin* UArticyJump::GetTargetPin(const UArticyDatabase* Database) const
 {
+    ValidateTargetCache();
     if (!TargetPinObj)
     {
-        auto target = GetTarget();
+        auto target = GetTarget(Database);
         if (target)
-            TargetPinObj = Cast<UArticyFlowPin>(target->GetSubobject(TargetPin));
+            TargetPinObj = target->GetSubobject<UArticyFlowPin>(TargetPin);
     }
 
     return TargetPinObj;
@@ -50,20 +70,21 @@ UArticyFlowPin* UArticyJump::GetTargetPin() const
  * starting from the target pin.
  *
  * @param Player The flow player performing the exploration.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
  * @param OutBranches The array to store resulting branches.
  * @param Depth The current depth of exploration.
  */
-void UArticyJump::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+void UArticyJump::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
     // NOTE: Even though a Jump also has an OutputPins member because of inheritance,
     // it never really has output pins! Instead, the jump target is specified by the
     // TargetPin (and Target) member.
 
-    auto pin = GetTargetPin();
+    auto pin = GetTargetPin(Context.Database);
     if (pin)
     {
         const auto bShadowed = false;
-        OutBranches.Append(Player->Explore(pin, bShadowed, Depth + 1));
+        OutBranches.Append(Player->Explore(Context, pin, bShadowed, Depth + 1));
     }
     else
     {
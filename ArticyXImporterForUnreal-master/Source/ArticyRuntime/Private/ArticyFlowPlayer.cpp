@@ -5,12 +5,46 @@
 #include "ArticyFlowPlayer.h"
 #include "ArticyRuntimeModule.h"
 #include "Interfaces/ArticyFlowObject.h"
-#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithMenuText.h"
+#include "Interfaces/ArticyObjectWithText.h"
 #include "ArticyExpressoScripts.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Interfaces/ArticyInputPinsProvider.h"
 #include "Interfaces/ArticyOutputPinsProvider.h"
 #include "Engine/Texture2D.h"
+#include "ArticyAssetPrefetcher.h"
+#include "ArticyFlowRecording.h"
+#include "ArticyScriptProfiler.h"
+#include "ArticySnapshot.h"
+#include "Dom/JsonObject.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+
+/**
+ * What the slow exploration watchdog collects about one update of the available branches.
+ */
+struct FArticyExploreWatch
+{
+    /** Time spent exploring, summed over the slices of a sliced exploration. */
+    uint64 Cycles = 0;
+
+    /** Nodes and pins visited, and the visits of each of them. */
+    int32 NumNodes = 0;
+    TMap<const UObject*, int32> NodeVisits;
+
+    /** The scripts the exploration ran. */
+    FArticyScriptCapture Scripts;
+
+    void Reset()
+    {
+        Cycles = 0;
+        NumNodes = 0;
+        NodeVisits.Reset();
+        Scripts.Reset();
+    }
+};
 
 /**
  * Retrieves the target of this branch.
@@ -29,11 +63,15 @@ void UArticyFlowPlayer::BeginPlay()
 {
     Super::BeginPlay();
 
+    // seeded before the first exploration, which may already call random()
+    RandomStream.Initialize(RandomSeed != 0 ? RandomSeed : FMath::Rand());
+
     //update Cursor to object referenced by StartOn
     SetCursorToStartNode();
 
-    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
-        FTickerDelegate::CreateUObject(this, &UArticyFlowPlayer::OnTick), 0.0f);
+    // branches played before BeginPlay wait for it
+    if (!BranchQueue.IsEmpty())
+        QueueForDispatch();
 }
 
 /**
@@ -41,7 +79,14 @@ void UArticyFlowPlayer::BeginPlay()
  */
 void UArticyFlowPlayer::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    if (bQueuedForDispatch)
+    {
+        QueuedPlayers.Remove(TWeakObjectPtr<UArticyFlowPlayer>(this));
+        bQueuedForDispatch = false;
+    }
+    BranchQueue.Empty();
+    SliceLevels.Reset();
+    bExplorationSuspended = false;
     Super::EndPlay(EndPlayReason);
 }
 
@@ -94,6 +139,13 @@ void UArticyFlowPlayer::SetCursorTo(TScriptInterface<IArticyFlowObject> Node)
         return;
     }
 
+    if (Recording)
+    {
+        const auto* primitive = Cast<UArticyPrimitive>(Node.GetObject());
+        if (primitive)
+            Recording->AddStep(FArticyFlowRecording::EStepType::SetCursor, primitive->GetCloneId(), primitive->GetId().Get());
+    }
+
     Cursor = Node;
     UpdateAvailableBranchesInternal(true);
 }
@@ -105,34 +157,34 @@ void UArticyFlowPlayer::SetCursorTo(TScriptInterface<IArticyFlowObject> Node)
  */
 void UArticyFlowPlayer::Play(int BranchIndex)
 {
-    static const TArray<FArticyBranch>* branchesPtr = &AvailableBranches;
-
+    // Find the branch in place, branch indices only count valid branches when invalid ones are ignored.
+    // No static scratch state here, players may be updated from several threads.
+    const FArticyBranch* branch = nullptr;
     if (IgnoresInvalidBranches())
     {
-        // Only create a new array if filtering is needed
-        static TArray<FArticyBranch> ValidBranches;
-        ValidBranches.Reset(); // Clear the array without reallocating memory
-
-        // Filter valid branches
-        for (const auto& branch : AvailableBranches)
+        int validIndex = 0;
+        for (const auto& candidate : AvailableBranches)
         {
-            if (branch.bIsValid)
+            if (candidate.bIsValid && validIndex++ == BranchIndex)
             {
-                ValidBranches.Add(branch);
+                branch = &candidate;
+                break;
             }
         }
-
-        branchesPtr = &ValidBranches;
+    }
+    else if (AvailableBranches.IsValidIndex(BranchIndex))
+    {
+        branch = &AvailableBranches[BranchIndex];
     }
 
-    // Use branchesPtr instead of branches
-    if (!branchesPtr->IsValidIndex(BranchIndex))
+    if (!branch)
     {
         UE_LOG(LogArticyRuntime, Error, TEXT("Branch with index %d does not exist!"), BranchIndex);
         return;
     }
 
-    PlayBranch((*branchesPtr)[BranchIndex]);
+    // PlayBranch queues a copy of the branch
+    PlayBranch(*branch);
 }
 
 /**
@@ -142,11 +194,16 @@ void UArticyFlowPlayer::Play(int BranchIndex)
  */
 void UArticyFlowPlayer::FinishCurrentPausedObject(int PinIndex)
 {
+    if (Recording)
+        Recording->AddStep(FArticyFlowRecording::EStepType::FinishPausedObject, PinIndex);
+
     IArticyOutputPinsProvider* outputPinOwner = Cast<IArticyOutputPinsProvider>(Cursor.GetObject());
     if (outputPinOwner)
     {
         auto outputPins = outputPinOwner->GetOutputPinsPtr();
 
+        FArticyExpressoEvaluationScope evaluationScope(GetDB()->GetExpressoInstance(), GetGVs(), GetMethodsProvider(), &RandomStream);
+
         int numPins = outputPins->Num();
         if (numPins > 0 && PinIndex < numPins)
         {
@@ -196,6 +253,21 @@ UArticyDatabase* UArticyFlowPlayer::GetDB() const
     return UArticyDatabase::Get(this);
 }
 
+/**
+ * Resolves what the objects visited by an exploration share.
+ *
+ * @return The database, global variables, expresso scripts and methods provider of this flow player.
+ */
+FArticyExploreContext UArticyFlowPlayer::MakeExploreContext()
+{
+    FArticyExploreContext Context;
+    Context.Database = GetDB();
+    Context.GVs = GetGVs();
+    Context.Scripts = Context.Database ? Context.Database->GetExpressoInstance() : nullptr;
+    Context.MethodProvider = GetMethodsProvider();
+    return Context;
+}
+
 /**
  * Retrieves the global variables used by this flow player.
  *
@@ -212,6 +284,67 @@ UArticyGlobalVariables* UArticyFlowPlayer::GetGVs() const
     return UArticyGlobalVariables::GetDefault(this);
 }
 
+/**
+ * Restarts the random stream of scripts with a seed.
+ *
+ * @param Seed The seed, the same seed and the same choices draw the same numbers.
+ */
+void UArticyFlowPlayer::SetRandomSeed(int32 Seed)
+{
+    if (Recording)
+        Recording->AddStep(FArticyFlowRecording::EStepType::SetRandomSeed, Seed);
+
+    RandomSeed = Seed;
+    RandomStream.Initialize(Seed);
+}
+
+/**
+ * Restarts the random stream of scripts with a seed and skips a number of draws.
+ *
+ * @param Seed The seed of the stream.
+ * @param Draws The number of values already drawn, see GetRandomDraws.
+ */
+void UArticyFlowPlayer::SetRandomState(int32 Seed, uint64 Draws)
+{
+    RandomSeed = Seed;
+    RandomStream.Initialize(Seed);
+    RandomStream.SetCounter(Draws);
+}
+
+/**
+ * Starts recording this player, replacing a recording in progress.
+ */
+void UArticyFlowPlayer::StartRecording()
+{
+    TSharedPtr<FArticyFlowRecording> newRecording = MakeShared<FArticyFlowRecording>();
+    if (!newRecording->Begin(this))
+    {
+        UE_LOG(LogArticyRuntime, Error, TEXT("Flow player %s could not start recording."), *GetName());
+        return;
+    }
+    Recording = MoveTemp(newRecording);
+}
+
+/**
+ * Stops recording and writes the recording to a file.
+ *
+ * @param Filename The file to write.
+ * @return False if the player was not recording or the file could not be written.
+ */
+bool UArticyFlowPlayer::StopRecording(const FString& Filename)
+{
+    if (!Recording)
+        return false;
+
+    const TSharedPtr<FArticyFlowRecording> finished = MoveTemp(Recording);
+    if (!finished->SaveToFile(Filename))
+    {
+        UE_LOG(LogArticyRuntime, Error, TEXT("Failed to write the flow recording to %s."), *Filename);
+        return false;
+    }
+    return true;
+}
+
 /**
  * Retrieves the user methods provider for this flow player.
  *
@@ -270,62 +403,101 @@ UObject* UArticyFlowPlayer::GetMethodsProvider()
     return UserMethodsProvider;
 }
 
+//---------------------------------------------------------------------------//
+
+/**
+ * Explores the flow starting from a specified node.
+ *
+ * @param Node The node to start exploring from.
+ * @param bShadowed Whether the exploration should be shadowed.
+ * @param Depth The current depth of exploration.
+ * @param IncludeCurrent Whether to include the current node in the exploration.
+ * @return An array of branches resulting from the exploration.
+ */
+TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent)
+{
+    return Explore(MakeExploreContext(), Node, bShadowed, Depth, IncludeCurrent);
+}
+
 /**
- * Retrieves the unshadowed node for a specified node.
+ * Explores the flow starting from a specified node, within an exploration already started.
  *
- * @param Node The node to unshadow.
- * @return A pointer to the unshadowed IArticyFlowObject.
+ * The objects visited are handed the context instead of each looking up the database.
+ * In a sliced exploration, the calls are made in the same order in every slice, so a call an earlier slice
+ * completed is answered with its branches. Once the slice's time is spent, calls return no branches until
+ * the exploration unwound, and the calls still running continue in the next slice.
+ *
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
+ * @param Node The node to start exploring from.
+ * @param bShadowed Whether the exploration should be shadowed.
+ * @param Depth The current depth of exploration.
+ * @param IncludeCurrent Whether to include the current node in the exploration.
+ * @return An array of branches resulting from the exploration.
  */
-IArticyFlowObject* UArticyFlowPlayer::GetUnshadowedNode(IArticyFlowObject* Node)
+TArray<FArticyBranch> UArticyFlowPlayer::Explore(const FArticyExploreContext& Context, IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent)
 {
-    auto db = UArticyDatabase::Get(this);
-    UArticyPrimitive* UnshadowedObject = db->GetObjectUnshadowed(Cast<UArticyPrimitive>(Node)->GetId());
+    if (SliceDeadline == 0.0)
+        return ExploreNode(Context, Node, bShadowed, Depth, IncludeCurrent);
 
-    // Handle pins, because we can not request them directly from the db 
-    if (!UnshadowedObject)
+    const int32 level = SliceLevel;
+    if (level > 0)
     {
-        auto pinOwner = db->GetObjectUnshadowed(Cast<UArticyFlowPin>(Node)->GetOwner()->GetId());
+        auto& caller = SliceLevels[level - 1];
+        const int32 call = caller.NextCall++;
+        if (call < caller.Completed.Num())
+            return caller.Completed[call];
+    }
 
-        TArray<UArticyFlowPin*> pins;
-        auto inputPinsOwner = Cast<IArticyInputPinsProvider>(pinOwner);
-        if (inputPinsOwner)
-        {
-            pins.Append(*inputPinsOwner->GetInputPinsPtr());
-        }
-        auto outputPinsOwner = Cast<IArticyOutputPinsProvider>(pinOwner);
-        if (outputPinsOwner)
-        {
-            pins.Append(*outputPinsOwner->GetOutputPinsPtr());
-        }
+    // every slice completes at least one call, so the exploration always gets on
+    if (bSliceSuspended || (bSliceProgressed && FPlatformTime::Seconds() >= SliceDeadline))
+    {
+        bSliceSuspended = true;
+        return {};
+    }
 
-        auto targetId = Cast<UArticyPrimitive>(Node)->GetId();
-        for (auto pin : pins)
-        {
-            if (pin->GetId() == targetId)
-            {
-                UnshadowedObject = pin;
-                break;
-            }
-        }
+    // the call continued from the last slice keeps what its calls completed, a new one starts without
+    if (SliceLevels.Num() <= level)
+        SliceLevels.AddDefaulted();
+    SliceLevels[level].NextCall = 0;
+
+    TArray<FArticyBranch> branches;
+    {
+        TGuardValue<int32> levelGuard(SliceLevel, level + 1);
+        branches = ExploreNode(Context, Node, bShadowed, Depth, IncludeCurrent);
     }
 
-    return Cast<IArticyFlowObject>(UnshadowedObject);
-}
+    if (bSliceSuspended)
+        return {};
 
-//---------------------------------------------------------------------------//
+    bSliceProgressed = true;
+    SliceLevels[level].Completed.Reset();
+    if (level > 0)
+        SliceLevels[level - 1].Completed.Add(branches);
+
+    return branches;
+}
 
 /**
- * Explores the flow starting from a specified node.
+ * Explores a node, see Explore.
  *
- * @param Node The node to start exploring from.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
+ * @param Node The node to explore.
  * @param bShadowed Whether the exploration should be shadowed.
  * @param Depth The current depth of exploration.
- * @param IncludeCurrent Whether to include the current node in the exploration.
- * @return An array of branches resulting from the exploration.
+ * @param IncludeCurrent Whether to include the node in the branches.
+ * @return The branches continuing from the node.
  */
-TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent)
+TArray<FArticyBranch> UArticyFlowPlayer::ExploreNode(const FArticyExploreContext& Context, IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent)
 {
     TArray<FArticyBranch> OutBranches;
+    FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::NodesVisited);
+
+    if (ActiveExploreWatch)
+    {
+        ++ActiveExploreWatch->NumNodes;
+        if (Node)
+            ++ActiveExploreWatch->NodeVisits.FindOrAdd(Node->_getUObject());
+    }
 
     //check stop condition
     if ((Depth > ExploreLimit || !Node || (Node != Cursor.GetInterface() && ShouldPauseOn(Node))))
@@ -335,12 +507,14 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
         if (!Node)
             UE_LOG(LogArticyRuntime, Warning, TEXT("Found a nullptr Node when exploring a branch!"));
 
-        /* TODO where should I put this?
-        if(OutBranches.Num() >= BranchLimit)
+        if (BranchLimit > 0 && NumExploredBranches >= BranchLimit)
         {
-            UE_LOG(LogArticyRuntime, Warning, TEXT("BranchLimit (%d) reached, cannot add another branch!"), BranchLimit);
-            return;
-        }*/
+            if (!bBranchesPartial)
+                UE_LOG(LogArticyRuntime, Warning, TEXT("BranchLimit (%d) reached, cannot add another branch!"), BranchLimit);
+            bBranchesPartial = true;
+            return OutBranches;
+        }
+        ++NumExploredBranches;
 
         //target reached, create a branch
         auto branch = FArticyBranch{};
@@ -351,11 +525,10 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
             * with invalid condition, instead of just UP TO that node.
             branch.bIsValid = Node->Execute(this); */
 
-            auto unshadowedNode = GetUnshadowedNode(Node);
-
+            //shadowed operations work on the objects themselves, so the node is the unshadowed one
             TScriptInterface<IArticyFlowObject> ptr;
-            ptr.SetObject(unshadowedNode->_getUObject());
-            ptr.SetInterface(unshadowedNode);
+            ptr.SetObject(Node->_getUObject());
+            ptr.SetInterface(Node);
             branch.Path.Add(ptr);
         }
 
@@ -363,25 +536,10 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
     }
     else
     {
-        //set speaker on expresso scripts
-        auto xp = GetDB()->GetExpressoInstance();
+        //the node becomes the current object and sets the speaker once a script referring to them runs
+        auto xp = Context.Scripts;
         if (ensure(xp))
-        {
-            auto obj = Cast<UArticyPrimitive>(Node);
-            if (obj)
-            {
-                xp->SetCurrentObject(obj);
-
-                IArticyObjectWithSpeaker* speaker;
-                if (auto flowPin = Cast<UArticyFlowPin>(Node))
-                    speaker = Cast<IArticyObjectWithSpeaker>(flowPin->GetOwner());
-                else
-                    speaker = Cast<IArticyObjectWithSpeaker>(obj);
-
-                if (speaker)
-                    xp->SetSpeaker(speaker->GetSpeaker());
-            }
-        }
+            xp->SetPendingNode(Node->_getUObject(), Context.Database);
 
         //if this is the first node, try to submerge
         bool bSubmerged = false;
@@ -389,21 +547,27 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
         {
             auto inputPinProvider = Cast<IArticyInputPinsProvider>(Node);
             if (inputPinProvider)
-                bSubmerged = inputPinProvider->TrySubmerge(this, OutBranches, Depth + 1, bShadowed); //NOTE: bShadowed will always be true if Depth == 0
+                bSubmerged = inputPinProvider->TrySubmerge(this, Context, OutBranches, Depth + 1, bShadowed); //NOTE: bShadowed will always be true if Depth == 0
         }
 
         //explore this node
         if (!bSubmerged)
         {
-            if (bShadowed)
+            //an object without side-effects leaves nothing to roll back, so it hands the shadow
+            //request on to the objects it continues at instead of opening a shadow state itself
+            const bool bShadow = bShadowed || bShadowPending;
+            const bool bOpenShadow = bShadow && Node->HasSideEffects();
+            TGuardValue<bool> pendingGuard(bShadowPending, bShadow && !bOpenShadow);
+
+            if (bOpenShadow)
             {
                 //explore the node inside a shadowed operation
-                ShadowedOperation([&] { Node->Explore(this, OutBranches, Depth + 1); });
+                ShadowedOperation([&] { Node->Explore(this, Context, OutBranches, Depth + 1); });
             }
             else
             {
                 //non-shadowed explore
-                Node->Explore(this, OutBranches, Depth + 1);
+                Node->Explore(this, Context, OutBranches, Depth + 1);
             }
         }
 
@@ -413,15 +577,12 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
         // See https://github.com/ArticySoftware/ArticyImporterForUnreal/issues/50
         if (IncludeCurrent)
         {
-            for (auto& branch : OutBranches)
-            {
-                auto unshadowedNode = GetUnshadowedNode(Node);
-                TScriptInterface<IArticyFlowObject> ptr;
-                ptr.SetObject(unshadowedNode->_getUObject());
-                ptr.SetInterface(unshadowedNode);
+            TScriptInterface<IArticyFlowObject> ptr;
+            ptr.SetObject(Node->_getUObject());
+            ptr.SetInterface(Node);
 
+            for (auto& branch : OutBranches)
                 branch.Path.Insert(ptr, 0); //TODO inserting at front is not ideal performance wise
-            }
         }
     }
 
@@ -457,6 +618,9 @@ void UArticyFlowPlayer::UpdateAvailableBranches()
 
 bool UArticyFlowPlayer::OnTick(float DeltaTime)
 {
+    // anything played or updated now replaces the exploration of the last frame
+    const bool bContinueExploration = bExplorationSuspended && BranchQueue.IsEmpty() && !bBranchesUpdatePending;
+
     FArticyBranch Branch;
     while (BranchQueue.Dequeue(Branch))
     {
@@ -466,22 +630,192 @@ bool UArticyFlowPlayer::OnTick(float DeltaTime)
                 return true;
         }
 
-        for (auto& node : Branch.Path)
+        CommitBranch(Branch);
+
+        Cursor = Branch.Path.Last();
+        if (bDeferFlowEvents)
+            bBranchesUpdatePending = true;
+        else
+            UpdateAvailableBranches();
+    }
+
+    // one exploration and broadcast for everything that happened since the last dispatch
+    if (bBranchesUpdatePending)
+    {
+        const bool bStartup = bPendingStartupUpdate;
+        bBranchesUpdatePending = false;
+        bPendingStartupUpdate = false;
+
+        TGuardValue<bool> dispatchingGuard(bDispatchingFlowEvents, true);
+        UpdateAvailableBranchesInternal(bStartup);
+    }
+
+    if (bContinueExploration && bExplorationSuspended)
+        ExploreAvailableBranches(bExplorationStartup);
+    return true;
+}
+
+/**
+ * Executes the nodes of a branch and counts them as seen.
+ * The variables and the methods provider are resolved and bound once for the whole path.
+ *
+ * @param Branch The branch to commit.
+ */
+void UArticyFlowPlayer::CommitBranch(const FArticyBranch& Branch)
+{
+    auto* GVs = GetGVs();
+    auto* methodsProvider = GetMethodsProvider();
+    FArticyExpressoEvaluationScope evaluationScope(GetDB()->GetExpressoInstance(), GVs, methodsProvider, &RandomStream);
+
+    // scripts further down the path may read the seen counters of the nodes before them,
+    // so each node is counted right after it ran, only the lookups are done up front
+    TArray<const UArticyPrimitive*, TInlineAllocator<16>> seenNodes;
+    seenNodes.Reserve(Branch.Path.Num());
+    for (const auto& node : Branch.Path)
+        seenNodes.Add(Cast<UArticyPrimitive>(node.GetObject()));
+
+    if (GVs)
+        GVs->ReserveSeenCounters(seenNodes.Num());
+
+    for (int32 i = 0; i < Branch.Path.Num(); ++i)
+    {
+        Branch.Path[i]->Execute(GVs, methodsProvider);
+
+        // update nodes visited
+        if (GVs && seenNodes[i])
+            GVs->IncrementSeenCounter(seenNodes[i]->GetId());
+    }
+}
+
+/**
+ * Resolves the texts and menu texts of the branches' targets ahead of display.
+ *
+ * @param Branches The branches whose targets' texts are prepared.
+ * @param OnPrepared Called on the game thread with the texts of each branch.
+ */
+void UArticyFlowPlayer::PrepareBranchTexts(const TArray<FArticyBranch>& Branches, TFunction<void(TArray<FArticyPreparedBranchTexts>&&)> OnPrepared) const
+{
+    static const FName TextName = TEXT("Text");
+    static const FName MenuTextName = TEXT("MenuText");
+    static const FText MenuBackupText = FText::FromString(TEXT("..."));
+
+    // Index of each branch's text and menu text among the texts to prepare
+    TArray<FArticyTextToPrepare> Texts;
+    TArray<TPair<int32, int32>> TextIndices;
+    TextIndices.Init(TPair<int32, int32>(INDEX_NONE, INDEX_NONE), Branches.Num());
+
+    for (int32 BranchIndex = 0; BranchIndex < Branches.Num(); ++BranchIndex)
+    {
+        UObject* Target = Branches[BranchIndex].GetTarget().GetObject();
+
+        const IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Target);
+        const FText* Text = WithText ? WithText->GetPropPtr<FText>(TextName) : nullptr;
+        if (Text)
+        {
+            TextIndices[BranchIndex].Key = Texts.Num();
+            Texts.Add(FArticyTextToPrepare{ Target, *Text });
+        }
+
+        const IArticyObjectWithMenuText* WithMenuText = Cast<IArticyObjectWithMenuText>(Target);
+        const FText* MenuText = WithMenuText ? WithMenuText->GetPropPtr<FText>(MenuTextName) : nullptr;
+        if (MenuText)
+        {
+            TextIndices[BranchIndex].Value = Texts.Num();
+            Texts.Add(FArticyTextToPrepare{ Target, *MenuText, MenuBackupText });
+        }
+    }
+
+    UArticyTextExtension::Get()->PrepareTexts(MoveTemp(Texts), [TextIndices = MoveTemp(TextIndices), OnPrepared = MoveTemp(OnPrepared)](TArray<FText>&& Resolved)
+    {
+        TArray<FArticyPreparedBranchTexts> Prepared;
+        Prepared.SetNum(TextIndices.Num());
+        for (int32 BranchIndex = 0; BranchIndex < TextIndices.Num(); ++BranchIndex)
+        {
+            Prepared[BranchIndex].BranchIndex = BranchIndex;
+            if (TextIndices[BranchIndex].Key != INDEX_NONE)
+                Prepared[BranchIndex].Text = MoveTemp(Resolved[TextIndices[BranchIndex].Key]);
+            if (TextIndices[BranchIndex].Value != INDEX_NONE)
+                Prepared[BranchIndex].MenuText = MoveTemp(Resolved[TextIndices[BranchIndex].Value]);
+        }
+        OnPrepared(MoveTemp(Prepared));
+    });
+}
+
+/**
+ * Gets the dialogues and dialogue fragments reachable within the next pause points.
+ *
+ * @param Pauses The number of pause points to look ahead, 1 only looks at the available branches.
+ * @return The reachable dialogue nodes, each one once.
+ */
+TArray<TScriptInterface<IArticyFlowObject>> UArticyFlowPlayer::PredictUpcoming(int32 Pauses)
+{
+    TArray<TScriptInterface<IArticyFlowObject>> nodes;
+    if (Pauses <= 0 || !Cursor || PauseOn == 0 || !GetGVs())
+        return nodes;
+
+    FArticyExpressoEvaluationScope evaluationScope(GetDB()->GetExpressoInstance(), GetGVs(), GetMethodsProvider(), &RandomStream);
+
+    // predictions don't count towards the limit of the available branches
+    TGuardValue<int32> branchesGuard(NumExploredBranches, 0);
+    TGuardValue<bool> partialGuard(bBranchesPartial, bBranchesPartial);
+
+    TMap<UObject*, int32> expanded;
+    TSet<UObject*> collected;
+    PredictBranches(AvailableBranches, Pauses, expanded, collected, nodes);
+    return nodes;
+}
+
+/**
+ * Collects the dialogue nodes along branches and follows their targets to the next pause points.
+ *
+ * @param Branches The branches to collect from.
+ * @param Pauses The number of pause points left, including the targets of Branches.
+ * @param Expanded The largest number of pauses left each target was already followed with.
+ * @param Collected The nodes already in OutNodes.
+ * @param OutNodes The collected dialogue nodes.
+ */
+void UArticyFlowPlayer::PredictBranches(const TArray<FArticyBranch>& Branches, int32 Pauses, TMap<UObject*, int32>& Expanded,
+    TSet<UObject*>& Collected, TArray<TScriptInterface<IArticyFlowObject>>& OutNodes)
+{
+    for (const auto& branch : Branches)
+    {
+        // invalid branches can't be played
+        if (!branch.bIsValid)
+            continue;
+
+        for (const auto& node : branch.Path)
         {
-            node->Execute(GetGVs(), GetMethodsProvider());
+            if (!node || Collected.Contains(node.GetObject()))
+                continue;
 
-            // update nodes visited
-            auto* GVs = GetGVs();
-            if (GVs)
+            const auto type = node->GetType();
+            if (type == EArticyPausableType::Dialogue || type == EArticyPausableType::DialogueFragment)
             {
-                GVs->IncrementSeenCounter(Cast<IArticyFlowObject>(node.GetObject()));
+                Collected.Add(node.GetObject());
+                OutNodes.Add(node);
             }
         }
 
-        Cursor = Branch.Path.Last();
-        UpdateAvailableBranches();
+        // a target reached again with as many pauses left leads to the same nodes, as far as prefetching cares
+        auto target = branch.GetTarget();
+        if (Pauses <= 1 || !target)
+            continue;
+
+        int32& expandedPauses = Expanded.FindOrAdd(target.GetObject(), 0);
+        if (expandedPauses >= Pauses)
+            continue;
+        expandedPauses = Pauses;
+
+        // play the branch as if it was picked and look at where its target leads, then roll it back
+        ShadowedOperation([&]
+        {
+            CommitBranch(branch);
+
+            TGuardValue<TScriptInterface<IArticyFlowObject>> cursorGuard(Cursor, target);
+            auto next = Explore(&*target, true, 0, false);
+            PredictBranches(next, Pauses - 1, Expanded, Collected, OutNodes);
+        });
     }
-    return true;
 }
 
 //---------------------------------------------------------------------------//
@@ -493,45 +827,261 @@ bool UArticyFlowPlayer::OnTick(float DeltaTime)
  */
 void UArticyFlowPlayer::UpdateAvailableBranchesInternal(bool Startup)
 {
+    // collapsed into a single update on the next dispatch, see OnTick
+    if (bDeferFlowEvents && !bDispatchingFlowEvents && HasBegunPlay())
+    {
+        bBranchesUpdatePending = true;
+        bPendingStartupUpdate |= Startup;
+        QueueForDispatch();
+        return;
+    }
+
+    // a new update replaces the exploration still running
     AvailableBranches.Reset();
+    SliceLevels.Reset();
+    bExplorationSuspended = false;
+    bBranchesPartial = false;
+    NumExploredBranches = 0;
+
+    // one watch spans all slices of the update
+    if (SlowExploreMicroseconds > 0 || SlowExploreNodes > 0)
+    {
+        if (!ExploreWatch)
+            ExploreWatch = MakeShared<FArticyExploreWatch>();
+        ExploreWatch->Reset();
+    }
+    else
+        ExploreWatch.Reset();
 
     if (PauseOn == 0)
         UE_LOG(LogArticyRuntime, Warning, TEXT("PauseOn is not set, not exploring the Flow as it would not pause on any node."))
     else if (!Cursor)
         UE_LOG(LogArticyRuntime, Warning, TEXT("Cannot explore flow, cursor is not set!"))
     else
+        ExploreAvailableBranches(Startup);
+}
+
+/**
+ * Explores the available branches from the cursor and broadcasts them.
+ * With an ExploreBudgetMicroseconds, the exploration stops once it is spent and continues from OnTick in the next frame.
+ *
+ * @param Startup Whether this is a startup update.
+ */
+void UArticyFlowPlayer::ExploreAvailableBranches(bool Startup)
+{
+    ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyExplore);
+
+    // bind the variables once for the whole pass instead of on every evaluated fragment
+    auto* GVs = GetGVs();
+    FArticyExpressoEvaluationScope evaluationScope(GetDB()->GetExpressoInstance(), GVs, GetMethodsProvider(), &RandomStream);
+
+    if (!bExplorationSuspended)
+        ExplorationFallbackQueries = GVs ? GVs->GetFallbackQueryCount() : 0;
+
+    // the watchdog counts the nodes and times the scripts of this exploration only
+    FArticyExploreWatch* watch = ExploreWatch.Get();
+    TGuardValue<FArticyExploreWatch*> watchGuard(ActiveExploreWatch, watch);
+    FArticyScriptCaptureScope captureScope(watch ? &watch->Scripts : nullptr);
+    const uint64 watchStartCycles = watch ? FPlatformTime::Cycles64() : 0;
+
+    const bool bMustBeShadowed = true;
     {
-        const bool bMustBeShadowed = true;
+        const bool bSliced = ExploreBudgetMicroseconds > 0 && HasBegunPlay();
+        TGuardValue<double> deadlineGuard(SliceDeadline, bSliced ? FPlatformTime::Seconds() + ExploreBudgetMicroseconds * 1e-6 : 0.0);
+        bSliceSuspended = false;
+        bSliceProgressed = false;
         AvailableBranches = Explore(&*Cursor, bMustBeShadowed, 0, Startup);
+    }
 
-        // Prune empty branches
-        AvailableBranches.RemoveAllSwap([](const FArticyBranch& branch) { return branch.Path.Num() == 0; });
+    bExplorationSuspended = bSliceSuspended;
+    if (bExplorationSuspended)
+    {
+        // nothing can be played until the exploration completes
+        AvailableBranches.Reset();
+        bExplorationStartup = Startup;
+        if (watch)
+            watch->Cycles += FPlatformTime::Cycles64() - watchStartCycles;
+        QueueForDispatch();
+        return;
+    }
+    SliceLevels.Reset();
 
-        if (AvailableBranches.IsEmpty())
-        {
-            // no valid branches, check for fallback
-            auto* GVs = GetGVs();
-            GVs->SetFallbackEvaluation(&*Cursor, true);
-            auto WithFallback = Explore(&*Cursor, bMustBeShadowed, 0, Startup);
-            GVs->SetFallbackEvaluation(&*Cursor, false);
-            AvailableBranches = WithFallback;
-        }
+    // Prune empty branches
+    AvailableBranches.RemoveAllSwap([](const FArticyBranch& branch) { return branch.Path.Num() == 0; });
+
+    // no valid branches, check for fallback
+    // The shadowed pass left no state behind, so exploring again only differs if a condition asked for the fallback flag
+    if (AvailableBranches.IsEmpty() && GVs && GVs->GetFallbackQueryCount() != ExplorationFallbackQueries)
+    {
+        GVs->SetFallbackEvaluation(&*Cursor, true);
+        auto WithFallback = Explore(&*Cursor, bMustBeShadowed, 0, Startup);
+        GVs->SetFallbackEvaluation(&*Cursor, false);
+        AvailableBranches = WithFallback;
+    }
 
-        // NP: Every branch needs the index so that Play() can actually take a branch as input
-        for (int32 i = 0; i < AvailableBranches.Num(); i++)
-            AvailableBranches[i].Index = i;
+    if (watch)
+    {
+        watch->Cycles += FPlatformTime::Cycles64() - watchStartCycles;
+        CheckSlowExploration(*watch, Startup);
+    }
 
-        // If we're just starting up, check if we should fast-forward
-        if (Startup && FastForwardToPause())
-        {
-            //fast-forwarding will call UpdateAvailableBranches again, can abort here
-            return;
-        }
+    // NP: Every branch needs the index so that Play() can actually take a branch as input
+    for (int32 i = 0; i < AvailableBranches.Num(); i++)
+        AvailableBranches[i].Index = i;
+
+    FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::BranchesProduced, AvailableBranches.Num());
+
+    // If we're just starting up, check if we should fast-forward
+    if (Startup && FastForwardToPause())
+    {
+        //fast-forwarding will call UpdateAvailableBranches again, can abort here
+        return;
+    }
 
-        //broadcast and return result
+    // start streaming in what the next lines will need before anyone reacts to this one
+    if (PrefetchPauses > 0)
+    {
+        if (auto* Prefetcher = UArticyAssetPrefetcher::Get(this))
+            Prefetcher->PrefetchNodes(PredictUpcoming(PrefetchPauses));
+    }
+
+#if ARTICY_FLOW_TRACE
+    if (UE_TRACE_CHANNELEXPR_IS_ENABLED(ArticyFlowChannel))
+    {
+        FArticyFlowTrace::CursorMoved(this, Cursor.GetObject());
+        for (const FArticyBranch& Branch : AvailableBranches)
+            FArticyFlowTrace::BranchEvaluated(this, Branch.Index, Branch.bIsValid, Branch.GetTarget().GetObject());
+    }
+#endif
+
+    //broadcast and return result, natively first; the dynamic events are skipped without Blueprint listeners
+    OnPlayerPausedNative.Broadcast(Cursor);
+    if (OnPlayerPaused.IsBound())
         OnPlayerPaused.Broadcast(Cursor);
+    OnBranchesUpdatedNative.Broadcast(AvailableBranches);
+    if (OnBranchesUpdated.IsBound())
         OnBranchesUpdated.Broadcast(AvailableBranches);
+}
+
+/**
+ * Dumps a completed exploration that exceeded SlowExploreMicroseconds or SlowExploreNodes.
+ *
+ * Writes ArticySlowExplore-<Time>.json to the profiling directory with the cursor, the most visited nodes,
+ * the most expensive scripts and the variables, and next to it an .arec flow recording that sets the cursor
+ * again, so Articy.ReplayFlow times the same exploration. The shadowed exploration left the dialogue state
+ * and the random stream as they were before it, so the recording starts on the state that was explored.
+ * At most one dump is written per SlowExploreDumpInterval across all players.
+ *
+ * @param Watch What the watchdog collected about the exploration.
+ * @param Startup Whether the exploration was a startup one.
+ */
+void UArticyFlowPlayer::CheckSlowExploration(const FArticyExploreWatch& Watch, bool Startup)
+{
+    const double Microseconds = FPlatformTime::ToMilliseconds64(Watch.Cycles) * 1000.0;
+    const bool bTooSlow = SlowExploreMicroseconds > 0 && Microseconds > SlowExploreMicroseconds;
+    const bool bTooLarge = SlowExploreNodes > 0 && Watch.NumNodes > SlowExploreNodes;
+    if (!bTooSlow && !bTooLarge)
+        return;
+
+    const double Now = FPlatformTime::Seconds();
+    if (Now - LastSlowExploreDump < SlowExploreDumpInterval)
+    {
+        UE_LOG(LogArticyRuntime, Verbose, TEXT("Slow exploration of %.0f us and %d nodes not dumped, the last dump was written recently."), Microseconds, Watch.NumNodes);
+        return;
+    }
+    LastSlowExploreDump = Now;
+
+    const FString BasePath = FPaths::ProfilingDir() / FString::Printf(TEXT("ArticySlowExplore-%s"), *FDateTime::Now().ToString());
+    const UArticyPrimitive* CursorObject = Cast<UArticyPrimitive>(Cursor.GetObject());
+    const UArticyObject* CursorArticyObject = Cast<UArticyObject>(CursorObject);
+
+    // the replay restores the state and explores from the cursor again
+    FString RecordingPath = BasePath + TEXT(".arec");
+    FArticyFlowRecording Repro;
+    if (Repro.Begin(this) && CursorObject)
+    {
+        Repro.AddStep(FArticyFlowRecording::EStepType::SetCursor, CursorObject->GetCloneId(), CursorObject->GetId().Get());
+        if (!Repro.SaveToFile(RecordingPath))
+            RecordingPath.Reset();
+    }
+    else
+        RecordingPath.Reset();
+
+    TSharedRef<FJsonObject> DumpJson = MakeShared<FJsonObject>();
+    DumpJson->SetStringField(TEXT("player"), GetOwner() ? GetOwner()->GetName() : GetName());
+    DumpJson->SetStringField(TEXT("cursor"), CursorObject ? CursorObject->GetId().ToString() : FString());
+    DumpJson->SetStringField(TEXT("cursorName"), CursorArticyObject ? CursorArticyObject->GetTechnicalName().ToString() : FString());
+    DumpJson->SetNumberField(TEXT("cursorClone"), CursorObject ? CursorObject->GetCloneId() : 0);
+    DumpJson->SetBoolField(TEXT("startup"), Startup);
+    DumpJson->SetNumberField(TEXT("microseconds"), Microseconds);
+    DumpJson->SetNumberField(TEXT("nodesVisited"), Watch.NumNodes);
+    DumpJson->SetNumberField(TEXT("branches"), AvailableBranches.Num());
+    DumpJson->SetBoolField(TEXT("branchesPartial"), bBranchesPartial);
+    DumpJson->SetNumberField(TEXT("slowExploreMicroseconds"), SlowExploreMicroseconds);
+    DumpJson->SetNumberField(TEXT("slowExploreNodes"), SlowExploreNodes);
+    DumpJson->SetStringField(TEXT("recording"), RecordingPath);
+
+    // the nodes the exploration ran through most often, where the paths fan out and meet again
+    TArray<TPair<const UObject*, int32>> Visits = Watch.NodeVisits.Array();
+    Visits.Sort([](const TPair<const UObject*, int32>& A, const TPair<const UObject*, int32>& B) { return A.Value > B.Value; });
+    TArray<TSharedPtr<FJsonValue>> NodesJson;
+    for (int32 i = 0; i < FMath::Min(Visits.Num(), 32); ++i)
+    {
+        const UArticyPrimitive* Primitive = Cast<UArticyPrimitive>(Visits[i].Key);
+        const UArticyObject* Object = Cast<UArticyObject>(Primitive);
+        if (const UArticyFlowPin* Pin = Cast<UArticyFlowPin>(Primitive))
+            Object = Pin->GetOwner(GetDB());
+
+        TSharedRef<FJsonObject> NodeJson = MakeShared<FJsonObject>();
+        NodeJson->SetStringField(TEXT("id"), Primitive ? Primitive->GetId().ToString() : FString());
+        NodeJson->SetStringField(TEXT("name"), Object ? Object->GetTechnicalName().ToString() : FString());
+        NodeJson->SetStringField(TEXT("type"), Visits[i].Key->GetClass()->GetName());
+        NodeJson->SetNumberField(TEXT("visits"), Visits[i].Value);
+        NodesJson.Add(MakeShared<FJsonValueObject>(NodeJson));
+    }
+    DumpJson->SetArrayField(TEXT("nodes"), NodesJson);
+
+    TArray<TSharedPtr<FJsonValue>> ScriptsJson;
+    for (const FArticyScriptProfiler::FRecord& Record : Watch.Scripts.GetSortedRecords(16))
+    {
+        TSharedRef<FJsonObject> ScriptJson = MakeShared<FJsonObject>();
+        ScriptJson->SetStringField(TEXT("owner"), Record.Owner);
+        ScriptJson->SetStringField(TEXT("expression"), Record.Expression);
+        ScriptJson->SetBoolField(TEXT("instruction"), Record.bInstruction);
+        ScriptJson->SetNumberField(TEXT("calls"), Record.Calls);
+        ScriptJson->SetNumberField(TEXT("totalMicroseconds"), Record.TotalSeconds * 1000000.0);
+        ScriptJson->SetNumberField(TEXT("maxMicroseconds"), Record.MaxSeconds * 1000000.0);
+        ScriptsJson.Add(MakeShared<FJsonValueObject>(ScriptJson));
+    }
+    DumpJson->SetArrayField(TEXT("scripts"), ScriptsJson);
+
+    TSharedRef<FJsonObject> VariablesJson = MakeShared<FJsonObject>();
+    if (const UArticyGlobalVariables* GVs = GetGVs())
+    {
+        TArray<UArticyVariable*> Variables;
+        GVs->GetAllVariables(Variables);
+        for (const UArticyVariable* Variable : Variables)
+        {
+            if (const UArticyBool* Bool = Cast<UArticyBool>(Variable))
+                VariablesJson->SetBoolField(Variable->GetGVName().ToString(), Bool->Get());
+            else if (const UArticyInt* Int = Cast<UArticyInt>(Variable))
+                VariablesJson->SetNumberField(Variable->GetGVName().ToString(), Int->Get());
+            else if (const UArticyString* String = Cast<UArticyString>(Variable))
+                VariablesJson->SetStringField(Variable->GetGVName().ToString(), String->Get());
+        }
+    }
+    DumpJson->SetObjectField(TEXT("variables"), VariablesJson);
+
+    const FString DumpPath = BasePath + TEXT(".json");
+    FString DumpString;
+    FJsonSerializer::Serialize(DumpJson, TJsonWriterFactory<>::Create(&DumpString));
+    if (!FFileHelper::SaveStringToFile(DumpString, *DumpPath))
+    {
+        UE_LOG(LogArticyRuntime, Error, TEXT("Failed to write the slow exploration dump to %s."), *DumpPath);
+        return;
     }
+    UE_LOG(LogArticyRuntime, Warning, TEXT("Exploring from %s took %.0f us and visited %d nodes, dumped to %s."),
+        CursorObject ? *CursorObject->GetId().ToString() : TEXT("no cursor"), Microseconds, Watch.NumNodes, *DumpPath);
 }
 
 /**
@@ -630,7 +1180,64 @@ bool UArticyFlowPlayer::FastForwardToPause()
  */
 void UArticyFlowPlayer::PlayBranch(const FArticyBranch& Branch)
 {
+    if (Recording)
+        Recording->AddStep(FArticyFlowRecording::EStepType::PlayBranch, Branch.Index);
+
     BranchQueue.Enqueue(Branch);
+
+    if (HasBegunPlay())
+        QueueForDispatch();
+}
+
+TArray<TWeakObjectPtr<UArticyFlowPlayer>> UArticyFlowPlayer::QueuedPlayers;
+double UArticyFlowPlayer::LastSlowExploreDump = -DBL_MAX;
+FTSTicker::FDelegateHandle UArticyFlowPlayer::DispatchHandle;
+
+/**
+ * Queues this player to play its branches on the next frame.
+ * Idle players are not known to the ticker at all.
+ */
+void UArticyFlowPlayer::QueueForDispatch()
+{
+    if (bQueuedForDispatch)
+        return;
+
+    bQueuedForDispatch = true;
+    QueuedPlayers.Add(this);
+
+    if (!DispatchHandle.IsValid())
+    {
+        DispatchHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateStatic(&UArticyFlowPlayer::DispatchQueuedBranches), 0.0f);
+    }
+}
+
+/**
+ * Plays the queued branches of all players that played a branch since the last frame.
+ *
+ * @param DeltaTime The time since the last tick.
+ * @return True to stay registered, if players were queued while dispatching.
+ */
+bool UArticyFlowPlayer::DispatchQueuedBranches(float DeltaTime)
+{
+    // players queued by the callbacks of this dispatch are played on the next one
+    TArray<TWeakObjectPtr<UArticyFlowPlayer>> players = MoveTemp(QueuedPlayers);
+    QueuedPlayers.Reset();
+
+    for (const auto& weakPlayer : players)
+    {
+        if (auto* player = weakPlayer.Get())
+        {
+            player->bQueuedForDispatch = false;
+            player->OnTick(DeltaTime);
+        }
+    }
+
+    if (QueuedPlayers.Num() > 0)
+        return true;
+
+    DispatchHandle.Reset();
+    return false;
 }
 
 /**
@@ -0,0 +1,206 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowRecording.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyPrimitive.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticySnapshot.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** The first bytes of every recording, "AREC". */
+	constexpr uint32 RecordingMagic = 0x43455241;
+}
+
+FArchive& operator<<(FArchive& Ar, FArticyFlowRecording::FStep& Step)
+{
+	uint8 Type = static_cast<uint8>(Step.Type);
+	Ar << Type << Step.Value << Step.Id;
+	Step.Type = static_cast<FArticyFlowRecording::EStepType>(Type);
+	return Ar;
+}
+
+/**
+ * @brief Starts over on the current state of a flow player.
+ *
+ * @param Player The player to record.
+ * @return False if the state can't be saved now.
+ */
+bool FArticyFlowRecording::Begin(UArticyFlowPlayer* Player)
+{
+	Steps.Reset();
+	InitialState.Reset();
+	if (!Player)
+		return false;
+
+	RandomSeed = Player->GetRandomSeed();
+	RandomDraws = Player->GetRandomDraws();
+	PauseOn = Player->PauseOn;
+	bIgnoreInvalidBranches = Player->IgnoresInvalidBranches();
+
+	const UArticyPrimitive* Cursor = Cast<UArticyPrimitive>(Player->GetCursor().GetObject());
+	StartId = Cursor ? Cursor->GetId().Get() : 0;
+
+	UArticyFlowPlayer* const Players[] = { Player };
+	return FArticySnapshot::Save(InitialState, Player->GetGVs(), UArticyDatabase::Get(Player), Players);
+}
+
+/**
+ * @brief Writes the recording to a byte buffer.
+ *
+ * @param OutBytes The buffer to write to.
+ * @return False if writing failed.
+ */
+bool FArticyFlowRecording::Save(TArray<uint8>& OutBytes) const
+{
+	OutBytes.Reset();
+	FMemoryWriter Ar(OutBytes);
+
+	uint32 Magic = RecordingMagic;
+	int32 Version = static_cast<int32>(EVersion::Latest);
+	Ar << Magic << Version;
+
+	// the archive takes the fields by reference, writing leaves them as they are
+	FArticyFlowRecording& Recording = const_cast<FArticyFlowRecording&>(*this);
+	Ar << Recording.RandomSeed << Recording.RandomDraws << Recording.StartId << Recording.PauseOn << Recording.bIgnoreInvalidBranches;
+	Ar << Recording.InitialState << Recording.Steps;
+
+	return !Ar.IsError();
+}
+
+/**
+ * @brief Reads a recording written by Save.
+ *
+ * @param Bytes The recording.
+ * @return False if the data is no recording of a supported version.
+ */
+bool FArticyFlowRecording::Load(const TArray<uint8>& Bytes)
+{
+	FMemoryReader Ar(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Ar << Magic << Version;
+	if (Ar.IsError() || Magic != RecordingMagic)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Flow recording: the data is not a flow recording."));
+		return false;
+	}
+	if (Version < static_cast<int32>(EVersion::Initial) || Version > static_cast<int32>(EVersion::Latest))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Flow recording: version %d is not supported, the latest is %d."), Version, static_cast<int32>(EVersion::Latest));
+		return false;
+	}
+
+	Ar << RandomSeed << RandomDraws << StartId << PauseOn << bIgnoreInvalidBranches;
+	Ar << InitialState << Steps;
+	if (Ar.IsError())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Flow recording: failed to read the recording."));
+		return false;
+	}
+	return true;
+}
+
+bool FArticyFlowRecording::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Bytes;
+	return Save(Bytes) && FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FArticyFlowRecording::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Flow recording: failed to read %s."), *Filename);
+		return false;
+	}
+	return Load(Bytes);
+}
+
+/**
+ * @brief Restores the initial state of a recording and applies all of its steps.
+ *
+ * Every played branch is committed by ticking the player right away, so a step is timed with the scripts
+ * it executes and the exploration of the next branches.
+ *
+ * @param Recording The recording to replay.
+ * @param Player The player to replay on.
+ * @return False if the initial state could not be restored.
+ */
+bool FArticyFlowReplay::Run(const FArticyFlowRecording& Recording, UArticyFlowPlayer* Player)
+{
+	StepMicroseconds.Reset(Recording.Steps.Num());
+	NumMismatches = 0;
+
+	if (!Player)
+		return false;
+
+	// the setup decides the branches explored when the snapshot restores the cursor
+	Player->PauseOn = Recording.PauseOn;
+	Player->SetIgnoreInvalidBranches(Recording.bIgnoreInvalidBranches);
+
+	UArticyDatabase* Database = UArticyDatabase::Get(Player);
+	UArticyFlowPlayer* const Players[] = { Player };
+	if (!FArticySnapshot::Load(Recording.InitialState, Player->GetGVs(), Database, Players))
+		return false;
+
+	Player->SetRandomState(Recording.RandomSeed, Recording.RandomDraws);
+
+	for (const FArticyFlowRecording::FStep& Step : Recording.Steps)
+	{
+		const uint64 CyclesBefore = FPlatformTime::Cycles64();
+		bool bApplied = true;
+
+		switch (Step.Type)
+		{
+		case FArticyFlowRecording::EStepType::SetCursor:
+		{
+			UArticyObject* Object = Database ? Database->GetObject(Step.Id, Step.Value) : nullptr;
+			bApplied = Object != nullptr;
+			if (bApplied)
+				Player->SetCursorTo(Object);
+			break;
+		}
+
+		case FArticyFlowRecording::EStepType::PlayBranch:
+		{
+			const FArticyBranch* Branch = Player->GetAvailableBranches().FindByPredicate([&Step](const FArticyBranch& Candidate)
+			{
+				return Candidate.Index == Step.Value;
+			});
+			bApplied = Branch != nullptr;
+			if (bApplied)
+			{
+				Player->PlayBranch(*Branch);
+				Player->OnTick(0.f);
+			}
+			break;
+		}
+
+		case FArticyFlowRecording::EStepType::FinishPausedObject:
+			Player->FinishCurrentPausedObject(Step.Value);
+			break;
+
+		case FArticyFlowRecording::EStepType::SetRandomSeed:
+			Player->SetRandomSeed(Step.Value);
+			break;
+		}
+
+		StepMicroseconds.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CyclesBefore) * 1000.0);
+		if (!bApplied)
+		{
+			++NumMismatches;
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Flow replay: step %d does not fit the flow, it is skipped."), StepMicroseconds.Num() - 1);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,143 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowTrace.h"
+
+#if ARTICY_FLOW_TRACE
+#include "ArticyPrimitive.h"
+#include "GameFramework/Actor.h"
+#include "Components/ActorComponent.h"
+
+UE_TRACE_CHANNEL_DEFINE(ArticyFlowChannel);
+
+UE_TRACE_EVENT_BEGIN(ArticyFlow, FlowPlayer)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PlayerId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Name)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(ArticyFlow, CursorMove)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PlayerId)
+	UE_TRACE_EVENT_FIELD(uint64, ObjectId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(ArticyFlow, BranchState)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PlayerId)
+	UE_TRACE_EVENT_FIELD(int32, Index)
+	UE_TRACE_EVENT_FIELD(bool, Valid)
+	UE_TRACE_EVENT_FIELD(uint64, TargetId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(ArticyFlow, ConditionResult)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, ObjectId)
+	UE_TRACE_EVENT_FIELD(bool, Result)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(ArticyFlow, VariableWrite)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Name)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Value)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(ArticyFlow, ShadowState)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PlayerId)
+	UE_TRACE_EVENT_FIELD(int32, Level)
+	UE_TRACE_EVENT_FIELD(bool, Pushed)
+UE_TRACE_EVENT_END()
+
+namespace
+{
+	/** Players whose name was traced already, by unique ID */
+	TSet<uint32> TracedPlayers;
+
+	/**
+	 * @brief Gets the ID of a flow player, tracing its name the first time.
+	 *
+	 * @param Player The flow player.
+	 * @return The unique ID of the player object.
+	 */
+	uint32 GetPlayerId(const UObject* Player)
+	{
+		if (!Player)
+			return 0;
+
+		const uint32 Id = Player->GetUniqueID();
+		bool bAlreadyTraced = false;
+		TracedPlayers.Add(Id, &bAlreadyTraced);
+		if (!bAlreadyTraced)
+		{
+			const UActorComponent* Component = Cast<UActorComponent>(Player);
+			const FString Name = Component && Component->GetOwner() ? Component->GetOwner()->GetName() : Player->GetName();
+			UE_TRACE_LOG(ArticyFlow, FlowPlayer, ArticyFlowChannel)
+				<< FlowPlayer.Cycle(FPlatformTime::Cycles64())
+				<< FlowPlayer.PlayerId(Id)
+				<< FlowPlayer.Name(*Name, Name.Len());
+		}
+		return Id;
+	}
+
+	/**
+	 * @brief Gets the articy ID of a node or pin.
+	 *
+	 * @param Object The object.
+	 * @return The ID of the object, 0 if it is no articy object.
+	 */
+	uint64 GetObjectId(const UObject* Object)
+	{
+		const UArticyPrimitive* Primitive = Cast<UArticyPrimitive>(Object);
+		return Primitive ? Primitive->GetId().Get() : 0;
+	}
+}
+
+void FArticyFlowTrace::CursorMoved(const UObject* Player, const UObject* Cursor)
+{
+	const uint32 PlayerId = GetPlayerId(Player);
+	UE_TRACE_LOG(ArticyFlow, CursorMove, ArticyFlowChannel)
+		<< CursorMove.Cycle(FPlatformTime::Cycles64())
+		<< CursorMove.PlayerId(PlayerId)
+		<< CursorMove.ObjectId(GetObjectId(Cursor));
+}
+
+void FArticyFlowTrace::BranchEvaluated(const UObject* Player, int32 Index, bool bIsValid, const UObject* Target)
+{
+	const uint32 PlayerId = GetPlayerId(Player);
+	UE_TRACE_LOG(ArticyFlow, BranchState, ArticyFlowChannel)
+		<< BranchState.Cycle(FPlatformTime::Cycles64())
+		<< BranchState.PlayerId(PlayerId)
+		<< BranchState.Index(Index)
+		<< BranchState.Valid(bIsValid)
+		<< BranchState.TargetId(GetObjectId(Target));
+}
+
+void FArticyFlowTrace::ConditionEvaluated(const UObject* Object, bool bResult)
+{
+	UE_TRACE_LOG(ArticyFlow, ConditionResult, ArticyFlowChannel)
+		<< ConditionResult.Cycle(FPlatformTime::Cycles64())
+		<< ConditionResult.ObjectId(GetObjectId(Object))
+		<< ConditionResult.Result(bResult);
+}
+
+void FArticyFlowTrace::VariableWritten(FName Variable, const FString& Value)
+{
+	const FString Name = Variable.ToString();
+	UE_TRACE_LOG(ArticyFlow, VariableWrite, ArticyFlowChannel)
+		<< VariableWrite.Cycle(FPlatformTime::Cycles64())
+		<< VariableWrite.Name(*Name, Name.Len())
+		<< VariableWrite.Value(*Value, Value.Len());
+}
+
+void FArticyFlowTrace::ShadowChanged(const UObject* Player, int32 Level, bool bPushed)
+{
+	const uint32 PlayerId = GetPlayerId(Player);
+	UE_TRACE_LOG(ArticyFlow, ShadowState, ArticyFlowChannel)
+		<< ShadowState.Cycle(FPlatformTime::Cycles64())
+		<< ShadowState.PlayerId(PlayerId)
+		<< ShadowState.Level(Level)
+		<< ShadowState.Pushed(bPushed);
+}
+#endif
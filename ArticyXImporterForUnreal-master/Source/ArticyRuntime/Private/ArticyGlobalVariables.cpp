@@ -112,10 +112,66 @@ uint32 UArticyVariable::GetStoreShadowLevel() const
     return Store->GetShadowLevel();
 }
 
+#if ARTICY_GV_LOGGING
+/**
+ * Logs the new value of a write to layer zero, called by the setters while the ArticyVariables channel is enabled.
+ */
+void UArticyVariable::LogWrite() const
+{
+    if (const UArticyBool* Bool = Cast<UArticyBool>(this))
+        UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s = %s"), *GVName.ToString(), Bool->Get() ? TEXT("True") : TEXT("False"));
+    else if (const UArticyInt* Int = Cast<UArticyInt>(this))
+        UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s = %d"), *GVName.ToString(), Int->Get());
+    else if (const UArticyString* String = Cast<UArticyString>(this))
+        UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s = %s"), *GVName.ToString(), *String->Get());
+}
+#endif
+
+#if ARTICY_FLOW_TRACE
+/**
+ * Traces the new value of a write to layer zero, called by the setters while the ArticyFlow channel is enabled.
+ */
+void UArticyVariable::TraceWrite() const
+{
+    if (const UArticyBool* Bool = Cast<UArticyBool>(this))
+        FArticyFlowTrace::VariableWritten(GVName, Bool->Get() ? TEXT("True") : TEXT("False"));
+    else if (const UArticyInt* Int = Cast<UArticyInt>(this))
+        FArticyFlowTrace::VariableWritten(GVName, FString::FromInt(Int->Get()));
+    else if (const UArticyString* String = Cast<UArticyString>(this))
+        FArticyFlowTrace::VariableWritten(GVName, String->Get());
+}
+#endif
+
 /**
  * Broadcasts a notification that a variable has changed.
  * @param Variable The variable that changed.
  */
+const TArray<UArticyVariable*>& UArticyBaseVariableSet::GetVariablesOfType(TSubclassOf<UArticyVariable> Type)
+{
+    if (const TArray<UArticyVariable*>* Cached = VariablesByType.Find(Type))
+        return *Cached;
+
+    TArray<UArticyVariable*>& TypedVariables = VariablesByType.Add(Type);
+    for (UArticyVariable* Var : Variables)
+    {
+        if (Var && Type && Var->IsA(Type))
+            TypedVariables.Add(Var);
+    }
+    return TypedVariables;
+}
+
+void UArticyBaseVariableSet::IndexVariables()
+{
+    VariablesByType.Reset();
+
+    GetVariablesOfType(UArticyVariable::StaticClass());
+    for (const UArticyVariable* Var : Variables)
+    {
+        if (Var)
+            GetVariablesOfType(Var->GetClass());
+    }
+}
+
 void UArticyBaseVariableSet::BroadcastOnVariableChanged(UArticyVariable* Variable)
 {
     OnVariableChanged.Broadcast(Variable);
@@ -172,14 +228,14 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetDefault(const UObject* WorldC
 
         if (keepBetweenWorlds)
         {
-            Clone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world->GetGameInstance()), TEXT("Persistent Runtime GV"));
+            Clone = CreateClone(assetPtr, Cast<UObject>(world->GetGameInstance()), TEXT("Persistent Runtime GV"));
 #if !WITH_EDITOR
             Clone->AddToRoot();
 #endif
         }
         else
         {
-            Clone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world), *FString::Printf(TEXT("%s GV"), *world->GetName()));
+            Clone = CreateClone(assetPtr, Cast<UObject>(world), *FString::Printf(TEXT("%s GV"), *world->GetName()));
         }
 
         ensureMsgf(Clone.IsValid(), TEXT("Cloning GV asset failed!"));
@@ -226,10 +282,13 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetMutableOriginal()
 }
 
 /**
- * Retrieves a runtime clone of non-default global variables.
+ * Retrieves the runtime instance of non-default global variables.
+ * All alternative sets share one clone of the asset, each of them is an overlay of the values it overrides,
+ * so a set costs memory proportional to these values. The overlay of GVs is bound to the shared clone
+ * before it is returned, which reverts the values of the previously bound set.
  * @param WorldContext The context within which the object is retrieved.
- * @param GVs Alternative global variables to clone.
- * @return A pointer to the cloned UArticyGlobalVariables object.
+ * @param GVs Alternative global variables to resolve.
+ * @return A pointer to the shared UArticyGlobalVariables object holding the values of GVs.
  */
 UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* WorldContext, UArticyAlternativeGlobalVariables* GVs)
 {
@@ -237,54 +296,236 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* W
     if (GVs == nullptr) { return GetDefault(WorldContext); }
 
     // Get unique name of GV set
-    const FString Name = GVs->GetFullName();
-    const FName Key = FName(*Name);
+    const FName Key = FName(*GVs->GetFullName());
 
-    // Check if we already have a clone
-    const auto& Existing = OtherClones.Find(Key);
-    if (Existing && Existing->IsValid())
+    // Check if we already have the shared clone
+    if (!AlternativeBase.IsValid())
     {
-        // If so, return it
-        return Existing->Get();
-    }
+        UE_LOG(LogArticyRuntime, Log, TEXT("Cloning GVs for alternative sets."));
 
-    UE_LOG(LogTemp, Warning, TEXT("Cloning Override GVs %s"), *GVs->GetFullName());
-
-    // Get world context
-    auto world = GEngine->GetWorldFromContextObjectChecked(WorldContext);
-    ensureMsgf(world, TEXT("Getting world for GV cloning failed!"));
+        // Get world context
+        auto world = GEngine->GetWorldFromContextObjectChecked(WorldContext);
+        ensureMsgf(world, TEXT("Getting world for GV cloning failed!"));
 
-    // Get global variable asset to clone
-    UArticyGlobalVariables* asset = UArticyGlobalVariables::GetMutableOriginal();
+        // Get global variable asset to clone
+        UArticyGlobalVariables* asset = UArticyGlobalVariables::GetMutableOriginal();
+        if (!asset)
+            return nullptr;
 
-    // Check if we're keeping global variable objects between worlds
-    bool keepBetweenWorlds = UArticyPluginSettings::Get()->bKeepGlobalVariablesBetweenWorlds;
+        // Check if we're keeping global variable objects between worlds
+        bool keepBetweenWorlds = UArticyPluginSettings::Get()->bKeepGlobalVariablesBetweenWorlds;
 
-    // If so, duplicate and add to root
-    UArticyGlobalVariables* NewClone = nullptr;
+        // If so, duplicate and add to root
+        UArticyGlobalVariables* NewClone = nullptr;
 
 #if ENGINE_MAJOR_VERSION >= 5
-    TObjectPtr<UArticyGlobalVariables> assetPtr = asset;
+        TObjectPtr<UArticyGlobalVariables> assetPtr = asset;
 #else
-    UArticyGlobalVariables* assetPtr = asset;
+        UArticyGlobalVariables* assetPtr = asset;
 #endif        
 
-    if (keepBetweenWorlds)
-    {
-        FString NewName = TEXT("Persistent Runtime GV Clone of ") + Name;
-        NewClone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world->GetGameInstance()), *NewName);
+        if (keepBetweenWorlds)
+        {
+            NewClone = CreateClone(assetPtr, Cast<UObject>(world->GetGameInstance()), TEXT("Persistent Runtime Alternative GV"));
 #if !WITH_EDITOR
-        NewClone->AddToRoot();
+            NewClone->AddToRoot();
 #endif
+        }
+        else
+        {
+            // Otherwise, add it to the active world
+            NewClone = CreateClone(assetPtr, Cast<UObject>(world), *FString::Printf(TEXT("%s Alternative GV"), *world->GetName()));
+        }
+
+        if (!ensureMsgf(NewClone, TEXT("Cloning GV asset failed!")))
+            return nullptr;
+
+        NewClone->InitOverlays(asset);
+        AlternativeBase = NewClone;
     }
-    else
+
+    AlternativeBase->BindOverlay(Key);
+    return AlternativeBase.Get();
+}
+
+/**
+ * Checks whether this instance holds the values of an alternative set.
+ * @param GVs The alternative set.
+ * @return True if this is the shared instance of the alternative sets and the overlay of GVs is bound.
+ */
+bool UArticyGlobalVariables::IsOverlayBound(const UArticyAlternativeGlobalVariables* GVs) const
+{
+    return GVs && AlternativeBase.Get() == this && BoundOverlay == FName(*GVs->GetFullName());
+}
+
+namespace
+{
+    bool EqualsBaseValue(const UArticyVariable* Variable, const UArticyVariable* Other)
     {
-        // Otherwise, add it to the active world
-        NewClone = DuplicateObject(assetPtr, Cast<UObject>(world), *FString::Printf(TEXT("%s %s GV"), *world->GetName(), *Name));
+        if (!Variable || !Other || Variable->GetClass() != Other->GetClass())
+            return false;
+        if (const UArticyBool* Bool = Cast<UArticyBool>(Variable))
+            return Bool->Get() == static_cast<const UArticyBool*>(Other)->Get();
+        if (const UArticyInt* Int = Cast<UArticyInt>(Variable))
+            return Int->Get() == static_cast<const UArticyInt*>(Other)->Get();
+        if (const UArticyString* String = Cast<UArticyString>(Variable))
+            return String->Get().Equals(static_cast<const UArticyString*>(Other)->Get(), ESearchCase::CaseSensitive);
+        return false;
+    }
+}
+
+/**
+ * Prepares this clone to be the shared instance of the alternative sets.
+ * Indexes the variables of this instance and of Base by slot, and starts recording the writes of the variables.
+ * @param Base The asset the overlays are applied on.
+ */
+void UArticyGlobalVariables::InitOverlays(const UArticyGlobalVariables* Base)
+{
+    LLM_SCOPE_BYTAG(Articy_GlobalVariables);
+
+    OverlayBase = Base;
+    GetAllVariables(OverlaySlots);
+    Base->GetAllVariables(BaseSlots);
+
+    // a write to a variable the asset does not have is always an override
+    if (BaseSlots.Num() != OverlaySlots.Num())
+        BaseSlots.Reset();
+
+    SlotByVariable.Reserve(OverlaySlots.Num());
+    for (int32 Slot = 0; Slot < OverlaySlots.Num(); ++Slot)
+    {
+        if (OverlaySlots[Slot])
+            SlotByVariable.Add(OverlaySlots[Slot], Slot);
+    }
+
+    for (UArticyBaseVariableSet* Set : VariableSets)
+    {
+        if (Set)
+            Set->OnVariableChanged.AddDynamic(this, &UArticyGlobalVariables::RecordOverlayWrite);
+    }
+}
+
+/**
+ * Makes this instance hold the values of an overlay.
+ * The overridden values of the previously bound overlay are reverted to the ones of the asset, then
+ * the ones of the new overlay are set, both without notifying listeners. The seen counters and fallback
+ * flags are swapped along. This only touches the overridden values, not every variable.
+ * @param Key The full name of the alternative set.
+ */
+void UArticyGlobalVariables::BindOverlay(const FName Key)
+{
+    if (BoundOverlay == Key)
+        return;
+
+    // the values of a shadow state would be popped into the wrong set
+    if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Cannot switch to the alternative GV set %s while %s is in a shadow state!"), *Key.ToString(), *BoundOverlay.ToString()))
+        return;
+
+    const bool bHasBase = OverlayBase.IsValid() && BaseSlots.Num() == OverlaySlots.Num();
+    if (FOverlay* Previous = Overlays.Find(BoundOverlay))
+    {
+        for (TConstSetBitIterator<> It(Previous->Overridden); It; ++It)
+        {
+            UArticyVariable* Variable = OverlaySlots[It.GetIndex()];
+            if (Variable && bHasBase)
+                Variable->CopyValue(BaseSlots[It.GetIndex()]);
+        }
+
+        Previous->VisitedNodes = MoveTemp(VisitedNodes);
+        Previous->bIsFallbackEvaluation = MoveTemp(bIsFallbackEvaluation);
+    }
+
+    LLM_SCOPE_BYTAG(Articy_GlobalVariables);
+    FOverlay& Overlay = Overlays.FindOrAdd(Key);
+    for (TConstSetBitIterator<> It(Overlay.Overridden); It; ++It)
+    {
+        UArticyVariable* Variable = OverlaySlots.IsValidIndex(It.GetIndex()) ? OverlaySlots[It.GetIndex()] : nullptr;
+        if (UArticyBool* Bool = Cast<UArticyBool>(Variable))
+            Bool->SetValueSilently(Overlay.Numbers.FindRef(It.GetIndex()) != 0);
+        else if (UArticyInt* Int = Cast<UArticyInt>(Variable))
+            Int->SetValueSilently(Overlay.Numbers.FindRef(It.GetIndex()));
+        else if (UArticyString* String = Cast<UArticyString>(Variable))
+            String->SetValueSilently(Overlay.Strings.FindRef(It.GetIndex()));
+    }
+
+    VisitedNodes = MoveTemp(Overlay.VisitedNodes);
+    bIsFallbackEvaluation = MoveTemp(Overlay.bIsFallbackEvaluation);
+    BoundOverlay = Key;
+}
+
+/**
+ * Records a write of a variable in the bound overlay.
+ * Only writes of layer zero are broadcast, so shadowed writes never reach the overlay. A value that is
+ * written back to the one of the asset stops being overridden.
+ * @param Variable The variable that was written.
+ */
+void UArticyGlobalVariables::RecordOverlayWrite(UArticyVariable* Variable)
+{
+    FOverlay* Overlay = BoundOverlay.IsNone() ? nullptr : Overlays.Find(BoundOverlay);
+    const int32* FoundSlot = SlotByVariable.Find(Variable);
+    if (!Overlay || !FoundSlot)
+        return;
+
+    const int32 Slot = *FoundSlot;
+    const bool bHasBase = OverlayBase.IsValid() && BaseSlots.Num() == OverlaySlots.Num();
+    if (bHasBase && EqualsBaseValue(Variable, BaseSlots[Slot]))
+    {
+        if (Overlay->IsOverridden(Slot))
+        {
+            Overlay->Overridden[Slot] = false;
+            Overlay->Numbers.Remove(Slot);
+            Overlay->Strings.Remove(Slot);
+        }
+        return;
+    }
+
+    LLM_SCOPE_BYTAG(Articy_GlobalVariables);
+    if (Overlay->Overridden.Num() <= Slot)
+        Overlay->Overridden.Add(false, Slot + 1 - Overlay->Overridden.Num());
+    Overlay->Overridden[Slot] = true;
+
+    if (const UArticyBool* Bool = Cast<UArticyBool>(Variable))
+        Overlay->Numbers.Add(Slot, Bool->Get() ? 1 : 0);
+    else if (const UArticyInt* Int = Cast<UArticyInt>(Variable))
+        Overlay->Numbers.Add(Slot, Int->Get());
+    else if (const UArticyString* String = Cast<UArticyString>(Variable))
+        Overlay->Strings.Add(Slot, String->Get());
+}
+
+/**
+ * Creates a runtime copy of a global variables asset.
+ * Constructing the copy creates and initializes its variables, only their values are copied
+ * from the asset afterwards.
+ * @param Source The asset to copy.
+ * @param Outer The outer of the copy.
+ * @param Name The name of the copy.
+ * @return The copy, or nullptr if Source is nullptr.
+ */
+UArticyGlobalVariables* UArticyGlobalVariables::CreateClone(const UArticyGlobalVariables* Source, UObject* Outer, const FName Name)
+{
+    if (!Source)
+        return nullptr;
+
+    LLM_SCOPE_BYTAG(Articy_GlobalVariables);
+    UArticyGlobalVariables* NewClone = NewObject<UArticyGlobalVariables>(Outer, Source->GetClass(), Name);
+
+    // the sets and their variables are created in the same order for every instance of the class
+    const int32 NumSets = FMath::Min(NewClone->VariableSets.Num(), Source->VariableSets.Num());
+    for (int32 i = 0; i < NumSets; ++i)
+    {
+        UArticyBaseVariableSet* Set = NewClone->VariableSets[i];
+        const UArticyBaseVariableSet* SourceSet = Source->VariableSets[i];
+        if (!Set || !SourceSet)
+            continue;
+
+        const int32 NumVariables = FMath::Min(Set->Variables.Num(), SourceSet->Variables.Num());
+        for (int32 j = 0; j < NumVariables; ++j)
+        {
+            if (Set->Variables[j])
+                Set->Variables[j]->CopyValue(SourceSet->Variables[j]);
+        }
     }
 
-    // Store and return
-    OtherClones.FindOrAdd(Key) = NewClone;
     return NewClone;
 }
 
@@ -311,10 +552,7 @@ UArticyBaseVariableSet* UArticyGlobalVariables::GetNamespace(const FName Namespa
     auto set = GetProp<UArticyBaseVariableSet*>(Namespace);
     if (!set)
     {
-        if (bLogVariableAccess)
-        {
-            UE_LOG(LogArticyRuntime, Error, TEXT("GV Namespace %s not found!"), *Namespace.ToString());
-        }
+        ARTICY_GV_LOG(Error, TEXT("GV Namespace %s not found!"), *Namespace.ToString());
         return nullptr;
     }
 
@@ -322,51 +560,34 @@ UArticyBaseVariableSet* UArticyGlobalVariables::GetNamespace(const FName Namespa
 }
 
 /**
- * Prints the value of a global variable.
+ * Prints the value of a global variable, does nothing in Shipping builds.
  * @param GvName The name of the global variable.
  */
 void UArticyGlobalVariables::PrintGlobalVariable(FArticyGvName GvName)
 {
-    bool bTmpLogVariableAccess = bLogVariableAccess;
-    bool bPrintSuccessful = false;
-    // turn off variable access logging for this function so that the result only prints once
-    bLogVariableAccess = false;
+#if ARTICY_GV_LOGGING
+    // the variable is read directly, so access logging does not print it a second time
+    UArticyBaseVariableSet* set = GetProp<UArticyBaseVariableSet*>(GvName.GetNamespace());
+    UArticyVariable** basePtr = set ? set->GetPropPtr<UArticyVariable*>(GvName.GetVariable()) : nullptr;
+    const UArticyVariable* variable = basePtr ? *basePtr : nullptr;
 
-    auto set = GetNamespace(GvName.GetNamespace());
-    if (set)
+    if (const UArticyBool* boolVariable = Cast<UArticyBool>(variable))
     {
-        UArticyVariable** basePtr = set->GetPropPtr<UArticyVariable*>(GvName.GetVariable());
-
-        if (Cast<UArticyBool>(*basePtr))
-        {
-            bool boolSucceeded = false;
-            auto boolValue = GetBoolVariable(GvName, boolSucceeded);
-            UE_LOG(LogArticyRuntime, Display, TEXT("%s::%s = %s"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString(), boolValue ? *FString("True") : *FString("False"));
-            bPrintSuccessful = true;
-        }
-        else if (Cast<UArticyInt>(*basePtr))
-        {
-            bool intSucceeded = false;
-            auto intValue = GetIntVariable(GvName, intSucceeded);
-            UE_LOG(LogArticyRuntime, Display, TEXT("%s::%s = %d"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString(), intValue);
-            bPrintSuccessful = true;
-        }
-        else if (Cast<UArticyString>(*basePtr))
-        {
-            bool stringSucceeded = false;
-            auto stringValue = GetStringVariable(GvName, stringSucceeded);
-            UE_LOG(LogArticyRuntime, Display, TEXT("%s::%s = %s"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString(), *stringValue);
-            bPrintSuccessful = true;
-        }
+        UE_LOG(LogArticyRuntime, Display, TEXT("%s::%s = %s"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString(), boolVariable->Get() ? TEXT("True") : TEXT("False"));
     }
-
-    if (!bPrintSuccessful)
+    else if (const UArticyInt* intVariable = Cast<UArticyInt>(variable))
+    {
+        UE_LOG(LogArticyRuntime, Display, TEXT("%s::%s = %d"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString(), intVariable->Get());
+    }
+    else if (const UArticyString* stringVariable = Cast<UArticyString>(variable))
+    {
+        UE_LOG(LogArticyRuntime, Display, TEXT("%s::%s = %s"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString(), *stringVariable->Get());
+    }
+    else
     {
         UE_LOG(LogArticyRuntime, Error, TEXT("Unable to find variable: %s::%s"), *GvName.GetNamespace().ToString(), *GvName.GetVariable().ToString());
     }
-
-    // restore prior logging mode
-    bLogVariableAccess = bTmpLogVariableAccess;
+#endif
 }
 
 /**
@@ -433,19 +654,24 @@ void UArticyGlobalVariables::SetStringVariable(FArticyGvName GvName, const FStri
 }
 
 /**
- * Enables debug logging for global variable access.
+ * Enables debug logging for global variable access by enabling the ArticyVariables trace channel.
+ * The channel is global, so this enables the logging of every instance. Does nothing in Shipping builds.
  */
 void UArticyGlobalVariables::EnableDebugLogging()
 {
-    bLogVariableAccess = true;
+#if ARTICY_GV_LOGGING && UE_TRACE_ENABLED
+    UE::Trace::ToggleChannel(TEXT("ArticyVariables"), true);
+#endif
 }
 
 /**
- * Disables debug logging for global variable access.
+ * Disables debug logging for global variable access by disabling the ArticyVariables trace channel.
  */
 void UArticyGlobalVariables::DisableDebugLogging()
 {
-    bLogVariableAccess = false;
+#if ARTICY_GV_LOGGING && UE_TRACE_ENABLED
+    UE::Trace::ToggleChannel(TEXT("ArticyVariables"), false);
+#endif
 }
 
 /**
@@ -454,8 +680,13 @@ void UArticyGlobalVariables::DisableDebugLogging()
 void UArticyGlobalVariables::ResetVisited()
 {
     VisitedNodes.Reset();
-    TMap<FArticyId, int> Empty;
-    VisitedNodes.Add(Empty);
+
+    // popping a shadow state must not bring back the counters from before the reset
+    for (FSeenChange& Change : SeenJournal)
+    {
+        if (!Change.bIsFallback)
+            Change.bHadValue = false;
+    }
 }
 
 /**
@@ -468,13 +699,7 @@ int UArticyGlobalVariables::GetSeenCounter(const IArticyFlowObject* Object) cons
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (VisitedNodes.IsEmpty())
-            return 0;
-
-        if (auto* counter = VisitedNodes.Top().Find(targetId))
+        if (auto* counter = VisitedNodes.Find(Obj->GetId()))
         {
             return *counter;
         }
@@ -493,23 +718,9 @@ int UArticyGlobalVariables::SetSeenCounter(const IArticyFlowObject* Object, int
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (VisitedNodes.IsEmpty())
-        {
-            TMap<FArticyId, int> Empty;
-            VisitedNodes.Add(Empty);
-        }
-
-        // update if already tracked
-        if (auto* counter = VisitedNodes.Top().Find(targetId))
-        {
-            return *counter = Value;
-        }
-
-        // add and return
-        VisitedNodes.Top().Add(targetId, Value);
+        const FArticyId targetId = Obj->GetId();
+        RecordSeenChange(targetId, false);
+        VisitedNodes.Add(targetId, Value);
         return Value;
     }
     return 0;
@@ -525,27 +736,22 @@ int UArticyGlobalVariables::IncrementSeenCounter(const IArticyFlowObject* Object
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (VisitedNodes.IsEmpty())
-        {
-            TMap<FArticyId, int> Empty;
-            VisitedNodes.Add(Empty);
-        }
-
-        // update if already tracked
-        if (auto* counter = VisitedNodes.Top().Find(targetId))
-        {
-            return ++(*counter);
-        }
-        // add and return
-        VisitedNodes.Top().Add(targetId, 1);
-        return 1;
+        return IncrementSeenCounter(Obj->GetId());
     }
     return 0;
 }
 
+/**
+ * Increments the seen counter of the node with the given ID.
+ * @param Id The ID of the node.
+ * @return The updated seen counter value.
+ */
+int UArticyGlobalVariables::IncrementSeenCounter(const FArticyId& Id)
+{
+    RecordSeenChange(Id, false);
+    return ++VisitedNodes.FindOrAdd(Id, 0);
+}
+
 /**
  * Checks if a fallback evaluation is active for a specific object.
  * @param Object The object to query.
@@ -553,30 +759,23 @@ int UArticyGlobalVariables::IncrementSeenCounter(const IArticyFlowObject* Object
  */
 bool UArticyGlobalVariables::Fallback(const IArticyFlowObject* Object)
 {
+    ++FallbackQueryCount;
+
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (bIsFallbackEvaluation.IsEmpty())
-            return false;
-
-        if (auto* state = bIsFallbackEvaluation.Top().Find(targetId))
+        if (auto* state = bIsFallbackEvaluation.Find(Obj->GetId()))
         {
             return *state;
         }
     }
     else
     {
-        if (!bIsFallbackEvaluation.IsEmpty())
+        for (const auto& Elem : bIsFallbackEvaluation)
         {
-            for (const auto& Elem : bIsFallbackEvaluation.Top())
+            if (Elem.Value)
             {
-                if (Elem.Value)
-                {
-                    return true;
-                }
+                return true;
             }
         }
     }
@@ -594,55 +793,295 @@ void UArticyGlobalVariables::SetFallbackEvaluation(const IArticyFlowObject* Obje
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
+        const FArticyId targetId = Obj->GetId();
+        RecordSeenChange(targetId, true);
+        bIsFallbackEvaluation.Add(targetId, Value);
+    }
+}
 
-        if (bIsFallbackEvaluation.IsEmpty())
+/**
+ * Records the current seen counter or fallback flag of a node before it is changed inside a shadow state.
+ * @param Id The ID of the node.
+ * @param bIsFallback True for the fallback flag, false for the seen counter.
+ */
+void UArticyGlobalVariables::RecordSeenChange(const FArticyId& Id, bool bIsFallback)
+{
+    if (SeenJournalMarks.IsEmpty())
+        return;
+
+    FSeenChange& Change = SeenJournal.AddDefaulted_GetRef();
+    Change.Id = Id;
+    Change.bIsFallback = bIsFallback;
+
+    if (bIsFallback)
+    {
+        if (const bool* state = bIsFallbackEvaluation.Find(Id))
         {
-            TMap<FArticyId, bool> Empty;
-            bIsFallbackEvaluation.Add(Empty);
+            Change.OldValue = *state;
+            Change.bHadValue = true;
         }
+    }
+    else if (const int* counter = VisitedNodes.Find(Id))
+    {
+        Change.OldValue = *counter;
+        Change.bHadValue = true;
+    }
+}
+
+/**
+ * Pushes the current seen state onto the stack.
+ * Only the position in the change journal is kept, changes are recorded as they are made.
+ */
+void UArticyGlobalVariables::PushSeen()
+{
+    SeenJournalMarks.Push(SeenJournal.Num());
+}
 
-        // update if already tracked
-        if (auto* state = bIsFallbackEvaluation.Top().Find(targetId))
+/**
+ * Pops the current seen state from the stack, undoing the changes made since the matching PushSeen.
+ */
+void UArticyGlobalVariables::PopSeen()
+{
+    if (SeenJournalMarks.IsEmpty())
+        return;
+
+    const int32 Mark = SeenJournalMarks.Pop();
+    for (int32 i = SeenJournal.Num() - 1; i >= Mark; --i)
+    {
+        const FSeenChange& Change = SeenJournal[i];
+        if (Change.bIsFallback)
         {
-            *state = Value;
+            if (Change.bHadValue)
+                bIsFallbackEvaluation.Add(Change.Id, Change.OldValue != 0);
+            else
+                bIsFallbackEvaluation.Remove(Change.Id);
         }
         else
         {
-            bIsFallbackEvaluation.Top().Add(targetId, Value);
+            if (Change.bHadValue)
+                VisitedNodes.Add(Change.Id, Change.OldValue);
+            else
+                VisitedNodes.Remove(Change.Id);
         }
     }
-    return;
+    SeenJournal.SetNum(Mark);
 }
 
 /**
- * Pushes the current seen state onto the stack.
+ * Appends the variables of all sets, in the order of the sets.
+ *
+ * @param OutVariables The array the variables are appended to.
  */
-void UArticyGlobalVariables::PushSeen()
+void UArticyGlobalVariables::GetAllVariables(TArray<UArticyVariable*>& OutVariables) const
 {
-    if (!VisitedNodes.IsEmpty())
+    for (const UArticyBaseVariableSet* Set : VariableSets)
     {
-        TMap<FArticyId, int> Copy(VisitedNodes.Top());
-        VisitedNodes.Push(Copy);
+        if (Set)
+            OutVariables.Append(Set->GetVariables());
     }
-    if (!bIsFallbackEvaluation.IsEmpty())
+}
+
+namespace
+{
+    /** The type of a variable in the name table of a snapshot */
+    enum class ESnapshotVariableType : uint8
     {
-        TMap<FArticyId, bool> Copy(bIsFallbackEvaluation.Top());
-        bIsFallbackEvaluation.Push(Copy);
+        Bool,
+        Int,
+        String,
+        Unknown
+    };
+
+    ESnapshotVariableType GetSnapshotType(const UArticyVariable* Variable)
+    {
+        if (Variable->IsA<UArticyBool>())
+            return ESnapshotVariableType::Bool;
+        if (Variable->IsA<UArticyInt>())
+            return ESnapshotVariableType::Int;
+        if (Variable->IsA<UArticyString>())
+            return ESnapshotVariableType::String;
+        return ESnapshotVariableType::Unknown;
+    }
+
+    /** The variables of all sets that can be written to a snapshot */
+    TArray<UArticyVariable*> GatherSnapshotVariables(const UArticyGlobalVariables* GlobalVariables)
+    {
+        TArray<UArticyVariable*> Variables;
+        GlobalVariables->GetAllVariables(Variables);
+        Variables.RemoveAll([](const UArticyVariable* Variable) { return !Variable || GetSnapshotType(Variable) == ESnapshotVariableType::Unknown; });
+        return Variables;
     }
 }
 
 /**
- * Pops the current seen state from the stack.
+ * Writes the variable values, seen counters and fallback flags to a snapshot.
+ * The name table comes first, followed by the values packed per type and the counters as flat arrays,
+ * so none of it goes through reflection.
+ *
+ * @param Ar The archive to write to.
  */
-void UArticyGlobalVariables::PopSeen()
+void UArticyGlobalVariables::SaveSnapshot(FArchive& Ar) const
+{
+    const TArray<UArticyVariable*> Variables = GatherSnapshotVariables(this);
+
+    TArray<FName> Names;
+    TArray<uint8> Types;
+    TBitArray<> Bools;
+    TArray<int32> Ints;
+    TArray<FString> Strings;
+    Names.Reserve(Variables.Num());
+    Types.Reserve(Variables.Num());
+    for (const UArticyVariable* Variable : Variables)
+    {
+        const ESnapshotVariableType Type = GetSnapshotType(Variable);
+        Names.Add(Variable->GetGVName());
+        Types.Add(static_cast<uint8>(Type));
+
+        if (Type == ESnapshotVariableType::Bool)
+            Bools.Add(static_cast<const UArticyBool*>(Variable)->Get());
+        else if (Type == ESnapshotVariableType::Int)
+            Ints.Add(static_cast<const UArticyInt*>(Variable)->Get());
+        else
+            Strings.Add(static_cast<const UArticyString*>(Variable)->Get());
+    }
+
+    Ar << Names << Types << Bools << Ints << Strings;
+
+    TArray<uint64> SeenIds;
+    TArray<int32> SeenCounts;
+    SeenIds.Reserve(VisitedNodes.Num());
+    SeenCounts.Reserve(VisitedNodes.Num());
+    for (const auto& Pair : VisitedNodes)
+    {
+        SeenIds.Add(Pair.Key.Get());
+        SeenCounts.Add(Pair.Value);
+    }
+
+    TArray<uint64> FallbackIds;
+    TBitArray<> Fallbacks;
+    FallbackIds.Reserve(bIsFallbackEvaluation.Num());
+    for (const auto& Pair : bIsFallbackEvaluation)
+    {
+        FallbackIds.Add(Pair.Key.Get());
+        Fallbacks.Add(Pair.Value);
+    }
+
+    Ar << SeenIds << SeenCounts << FallbackIds << Fallbacks;
+}
+
+/**
+ * Reads a snapshot written by SaveSnapshot.
+ * If the variables are the same as when it was written, the values are assigned in order,
+ * otherwise each entry of the name table is looked up by its (renamed) name.
+ *
+ * @param Ar The archive to read from.
+ * @param RenamedVariables Maps old full variable names to their new ones.
+ * @return False if the snapshot could not be read, nothing is changed then.
+ */
+bool UArticyGlobalVariables::LoadSnapshot(FArchive& Ar, const TMap<FName, FName>& RenamedVariables)
 {
-    if (!bIsFallbackEvaluation.IsEmpty())
-        bIsFallbackEvaluation.Pop();
-    if (!VisitedNodes.IsEmpty())
-        VisitedNodes.Pop();
+    TArray<FName> Names;
+    TArray<uint8> Types;
+    TBitArray<> Bools;
+    TArray<int32> Ints;
+    TArray<FString> Strings;
+    TArray<uint64> SeenIds;
+    TArray<int32> SeenCounts;
+    TArray<uint64> FallbackIds;
+    TBitArray<> Fallbacks;
+    Ar << Names << Types << Bools << Ints << Strings;
+    Ar << SeenIds << SeenCounts << FallbackIds << Fallbacks;
+
+    // read everything before changing anything, a broken snapshot must not leave half of the values changed
+    if (Ar.IsError() || Names.Num() != Types.Num() || SeenIds.Num() != SeenCounts.Num() || FallbackIds.Num() != Fallbacks.Num())
+        return false;
+
+    int32 NumOfType[static_cast<uint8>(ESnapshotVariableType::Unknown)] = {};
+    for (const uint8 Type : Types)
+    {
+        if (Type >= static_cast<uint8>(ESnapshotVariableType::Unknown))
+            return false;
+        ++NumOfType[Type];
+    }
+    if (NumOfType[0] != Bools.Num() || NumOfType[1] != Ints.Num() || NumOfType[2] != Strings.Num())
+        return false;
+
+    TArray<UArticyVariable*> Variables = GatherSnapshotVariables(this);
+
+    bool bSameLayout = Variables.Num() == Names.Num();
+    for (int32 i = 0; bSameLayout && i < Variables.Num(); ++i)
+        bSameLayout = Variables[i]->GetGVName() == Names[i] && static_cast<uint8>(GetSnapshotType(Variables[i])) == Types[i];
+
+    if (!bSameLayout)
+    {
+        // the variables were changed since the snapshot was written
+        TMap<FName, UArticyVariable*> VariablesByName;
+        VariablesByName.Reserve(Variables.Num());
+        for (UArticyVariable* Variable : Variables)
+            VariablesByName.Add(Variable->GetGVName(), Variable);
+
+        Variables.Reset(Names.Num());
+        for (int32 i = 0; i < Names.Num(); ++i)
+        {
+            const FName* NewName = RenamedVariables.Find(Names[i]);
+            UArticyVariable* Variable = VariablesByName.FindRef(NewName ? *NewName : Names[i]);
+            if (!Variable)
+            {
+                UE_LOG(LogArticyRuntime, Warning, TEXT("Snapshot: variable %s does not exist anymore, its value is skipped."), *Names[i].ToString());
+            }
+            else if (static_cast<uint8>(GetSnapshotType(Variable)) != Types[i])
+            {
+                UE_LOG(LogArticyRuntime, Warning, TEXT("Snapshot: the type of variable %s changed, its value is skipped."), *Names[i].ToString());
+                Variable = nullptr;
+            }
+            Variables.Add(Variable);
+        }
+    }
+
+    int32 NextBool = 0, NextInt = 0, NextString = 0;
+    for (int32 i = 0; i < Names.Num(); ++i)
+    {
+        UArticyVariable* Variable = Variables[i];
+        switch (static_cast<ESnapshotVariableType>(Types[i]))
+        {
+        case ESnapshotVariableType::Bool:
+        {
+            const bool Value = Bools[NextBool++];
+            if (Variable && static_cast<UArticyBool*>(Variable)->Get() != Value)
+                static_cast<UArticyBool*>(Variable)->Set(Value);
+            break;
+        }
+        case ESnapshotVariableType::Int:
+        {
+            const int32 Value = Ints[NextInt++];
+            if (Variable && static_cast<UArticyInt*>(Variable)->Get() != Value)
+                static_cast<UArticyInt*>(Variable)->Set(Value);
+            break;
+        }
+        case ESnapshotVariableType::String:
+        {
+            FString& Value = Strings[NextString++];
+            if (Variable && static_cast<UArticyString*>(Variable)->Get() != Value)
+                static_cast<UArticyString*>(Variable)->Set(MoveTemp(Value));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    VisitedNodes.Reset();
+    VisitedNodes.Reserve(SeenIds.Num());
+    for (int32 i = 0; i < SeenIds.Num(); ++i)
+        VisitedNodes.Add(SeenIds[i], SeenCounts[i]);
+
+    bIsFallbackEvaluation.Reset();
+    bIsFallbackEvaluation.Reserve(FallbackIds.Num());
+    for (int32 i = 0; i < FallbackIds.Num(); ++i)
+        bIsFallbackEvaluation.Add(FallbackIds[i], Fallbacks[i]);
+
+    return true;
 }
 
 TWeakObjectPtr<UArticyGlobalVariables> UArticyGlobalVariables::Clone;
-TMap<FName, TWeakObjectPtr< UArticyGlobalVariables>> UArticyGlobalVariables::OtherClones;
+TWeakObjectPtr<UArticyGlobalVariables> UArticyGlobalVariables::AlternativeBase;
@@ -0,0 +1,215 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyHelpers.h"
+
+namespace
+{
+	/** A folded value, ints and bools mix like they do in the generated C++. */
+	struct FConstantValue
+	{
+		int64 Value = 0;
+		bool bIsBool = false;
+	};
+
+	/** Folds a condition by recursive descent, failing on anything that is not a literal or an operator. */
+	class FConstantFolder
+	{
+	public:
+		explicit FConstantFolder(const FString& InScript) : Script(InScript) {}
+
+		/**
+		 * @brief Folds the whole condition.
+		 *
+		 * @param OutValue Receives the value of the condition.
+		 * @return False if the condition is not constant.
+		 */
+		bool Fold(FConstantValue& OutValue)
+		{
+			if (!ParseBinary(0, OutValue))
+				return false;
+			SkipSpace();
+			return Pos == Script.Len();
+		}
+
+	private:
+		static int32 GetPrecedence(const FString& Op)
+		{
+			if (Op == TEXT("||")) return 1;
+			if (Op == TEXT("&&")) return 2;
+			if (Op == TEXT("==") || Op == TEXT("!=")) return 3;
+			if (Op == TEXT("<") || Op == TEXT("<=") || Op == TEXT(">") || Op == TEXT(">=")) return 4;
+			if (Op == TEXT("+") || Op == TEXT("-")) return 5;
+			if (Op == TEXT("*") || Op == TEXT("/") || Op == TEXT("%")) return 6;
+			return -1;
+		}
+
+		/** Skips whitespace and line comments. */
+		void SkipSpace()
+		{
+			while (Pos < Script.Len())
+			{
+				if (FChar::IsWhitespace(Script[Pos]))
+					++Pos;
+				else if (Script[Pos] == TEXT('/') && Pos + 1 < Script.Len() && Script[Pos + 1] == TEXT('/'))
+				{
+					while (Pos < Script.Len() && Script[Pos] != TEXT('\n'))
+						++Pos;
+				}
+				else
+					break;
+			}
+		}
+
+		/** The binary operator at the current position, empty if there is none. */
+		FString PeekOperator()
+		{
+			SkipSpace();
+			if (Pos >= Script.Len())
+				return FString();
+
+			const FString two = Script.Mid(Pos, 2);
+			if (GetPrecedence(two) > 0)
+				return two;
+			const FString one = Script.Mid(Pos, 1);
+			return GetPrecedence(one) > 0 ? one : FString();
+		}
+
+		bool ParseBinary(int32 MinPrecedence, FConstantValue& OutValue)
+		{
+			if (!ParseUnary(OutValue))
+				return false;
+
+			for (;;)
+			{
+				const FString op = PeekOperator();
+				const int32 precedence = GetPrecedence(op);
+				if (precedence <= MinPrecedence)
+					return true;
+				Pos += op.Len();
+
+				FConstantValue right;
+				if (!ParseBinary(precedence, right) || !Apply(op, OutValue, right))
+					return false;
+			}
+		}
+
+		bool ParseUnary(FConstantValue& OutValue)
+		{
+			SkipSpace();
+			if (Pos < Script.Len() && (Script[Pos] == TEXT('!') || Script[Pos] == TEXT('-')) && Script.Mid(Pos, 2) != TEXT("!="))
+			{
+				const bool bIsNot = Script[Pos++] == TEXT('!');
+				if (!ParseUnary(OutValue))
+					return false;
+				OutValue = bIsNot ? FConstantValue{ OutValue.Value == 0, true } : FConstantValue{ -OutValue.Value, false };
+				return true;
+			}
+			return ParsePrimary(OutValue);
+		}
+
+		bool ParsePrimary(FConstantValue& OutValue)
+		{
+			SkipSpace();
+			if (Pos >= Script.Len())
+				return false;
+
+			if (Script[Pos] == TEXT('('))
+			{
+				++Pos;
+				if (!ParseBinary(0, OutValue))
+					return false;
+				SkipSpace();
+				return Pos < Script.Len() && Script[Pos++] == TEXT(')');
+			}
+
+			const int32 start = Pos;
+			while (Pos < Script.Len() && (FChar::IsAlnum(Script[Pos]) || Script[Pos] == TEXT('_')))
+				++Pos;
+			const FString word = Script.Mid(start, Pos - start);
+
+			if (word == TEXT("true") || word == TEXT("false"))
+			{
+				OutValue = FConstantValue{ word == TEXT("true"), true };
+				return true;
+			}
+
+			// variables, methods, seen and the like depend on the state, and C++ reads a leading 0 as octal
+			if (word.IsEmpty() || !word.IsNumeric() || word.Len() > 9 || (word.Len() > 1 && word[0] == TEXT('0')))
+				return false;
+			OutValue = FConstantValue{ FCString::Atoi(*word), false };
+			return true;
+		}
+
+		static bool Apply(const FString& Op, FConstantValue& InOutLeft, const FConstantValue& Right)
+		{
+			const int64 l = InOutLeft.Value;
+			const int64 r = Right.Value;
+			if (Op == TEXT("||")) InOutLeft = { l != 0 || r != 0, true };
+			else if (Op == TEXT("&&")) InOutLeft = { l != 0 && r != 0, true };
+			else if (Op == TEXT("==")) InOutLeft = { l == r, true };
+			else if (Op == TEXT("!=")) InOutLeft = { l != r, true };
+			else if (Op == TEXT("<")) InOutLeft = { l < r, true };
+			else if (Op == TEXT("<=")) InOutLeft = { l <= r, true };
+			else if (Op == TEXT(">")) InOutLeft = { l > r, true };
+			else if (Op == TEXT(">=")) InOutLeft = { l >= r, true };
+			else if (Op == TEXT("+")) InOutLeft = { l + r, false };
+			else if (Op == TEXT("-")) InOutLeft = { l - r, false };
+			else if (Op == TEXT("*")) InOutLeft = { l * r, false };
+			// a division by zero is left to fail where the script runs
+			else if (r == 0)
+				return false;
+			else if (Op == TEXT("/")) InOutLeft = { l / r, false };
+			else InOutLeft = { l % r, false };
+
+			// stay in the range of the ints the generated code computes with
+			return InOutLeft.Value >= MIN_int32 && InOutLeft.Value <= MAX_int32;
+		}
+
+		const FString& Script;
+		int32 Pos = 0;
+	};
+
+	/**
+	 * @brief Checks that a script has nothing but whitespace and line comments.
+	 *
+	 * @param Script The script to check.
+	 * @param bAllowSemicolons Whether empty statements are allowed as well.
+	 * @return True if the script has no code.
+	 */
+	bool HasNoCode(const FString& Script, bool bAllowSemicolons)
+	{
+		bool bInComment = false;
+		for (int32 i = 0; i < Script.Len(); ++i)
+		{
+			const TCHAR c = Script[i];
+			if (bInComment)
+				bInComment = c != TEXT('\n');
+			else if (c == TEXT('/') && i + 1 < Script.Len() && Script[i + 1] == TEXT('/'))
+				bInComment = true;
+			else if (!FChar::IsWhitespace(c) && !(bAllowSemicolons && c == TEXT(';')))
+				return false;
+		}
+		return true;
+	}
+}
+
+bool ArticyHelpers::FoldConstantScript(const FString& Script, bool bIsInstruction, bool& bOutResult)
+{
+	bOutResult = true;
+
+	// an instruction without statements does nothing, a condition of only comments is true like ConditionOrTrue()
+	if (HasNoCode(Script, bIsInstruction))
+		return true;
+	if (bIsInstruction)
+		return false;
+
+	FConstantFolder folder(Script);
+	FConstantValue value;
+	if (!folder.Fold(value))
+		return false;
+
+	bOutResult = value.bIsBool ? value.Value != 0 : value.Value > 0;
+	return true;
+}
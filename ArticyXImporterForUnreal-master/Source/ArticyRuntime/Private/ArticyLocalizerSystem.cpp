@@ -0,0 +1,247 @@
+//  
+// Copyright (c) 2024 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyLocalizerSystem.h"
+#include "ArticyRuntimeStats.h"
+#include "Async/Async.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
+#include "Misc/Paths.h"
+
+void UArticyLocalizerSystem::LoadStringTable(const FName TableName)
+{
+	if (!bDataLoaded)
+	{
+		Reload();
+	}
+
+	int32* Users = LoadedStringTables.Find(TableName);
+	if (Users)
+	{
+		++(*Users);
+		return;
+	}
+
+	// Loaded by code generated before the tables were loaded on demand
+	if (!StringTableFiles.Contains(TableName))
+		return;
+
+	if (RegisterStringTable(TableName))
+		LoadedStringTables[TableName] = 1;
+}
+
+void UArticyLocalizerSystem::UnloadStringTable(const FName TableName)
+{
+	int32* Users = LoadedStringTables.Find(TableName);
+	if (!Users || --(*Users) > 0)
+		return;
+
+	FStringTableRegistry::Get().UnregisterStringTable(TableName);
+	LoadedStringTables.Remove(TableName);
+	CachedEntries.Reset();
+}
+
+int64 UArticyLocalizerSystem::GetStringTableResourceSize(const FName TableName) const
+{
+	FStringTableConstPtr Table = FStringTableRegistry::Get().FindStringTable(TableName);
+	if (!Table.IsValid())
+		return 0;
+
+	int64 Bytes = 0;
+	Table->EnumerateSourceStrings([&Bytes](const FString& Key, const FString& SourceString)
+	{
+		Bytes += Key.GetAllocatedSize() + SourceString.GetAllocatedSize();
+		return true;
+	});
+	return Bytes;
+}
+
+void UArticyLocalizerSystem::SwitchCulture()
+{
+	bLoadTablesAsync = true;
+	Reload();
+	bLoadTablesAsync = false;
+}
+
+void UArticyLocalizerSystem::ResetStringTables()
+{
+	StringTableFiles.Reset();
+	CachedEntries.Reset();
+}
+
+void UArticyLocalizerSystem::AddStringTable(const FName TableName, const FString& FilePath)
+{
+	StringTableFiles.Add(TableName, FilePath);
+}
+
+void UArticyLocalizerSystem::LoadStringTables()
+{
+	if (bLoadTablesAsync)
+	{
+		LoadStringTablesAsync();
+		return;
+	}
+
+	// The users of a table outlive the culture change, its file is replaced by the one of the new culture
+	TMap<FName, int32> PreviousTables = MoveTemp(LoadedStringTables);
+	LoadedStringTables.Reset();
+	for (const TPair<FName, int32>& Table : PreviousTables)
+	{
+		FStringTableRegistry::Get().UnregisterStringTable(Table.Key);
+		if (RegisterStringTable(Table.Key))
+			LoadedStringTables[Table.Key] = Table.Value;
+	}
+
+	// The object definitions' texts are used by all packages
+	if (!LoadedStringTables.Contains(TEXT("ARTICY")))
+		RegisterStringTable(TEXT("ARTICY"));
+
+	OnStringTablesChanged();
+}
+
+void UArticyLocalizerSystem::LoadStringTablesAsync()
+{
+	// Only the tables in use are read, the others are registered from the new files once they are used
+	TArray<TPair<FName, FString>> Files;
+	for (const TPair<FName, int32>& Table : LoadedStringTables)
+	{
+		const FString* FilePath = StringTableFiles.Find(Table.Key);
+		Files.Emplace(Table.Key, FilePath ? FPaths::ProjectContentDir() / *FilePath : FString());
+	}
+
+	// The object definitions' texts are used by all packages
+	const FName ArticyTable(TEXT("ARTICY"));
+	if (!LoadedStringTables.Contains(ArticyTable))
+	{
+		const FString* FilePath = StringTableFiles.Find(ArticyTable);
+		if (FilePath)
+		{
+			LoadedStringTables.Add(ArticyTable, 0);
+			Files.Emplace(ArticyTable, FPaths::ProjectContentDir() / *FilePath);
+		}
+	}
+
+	const uint32 Request = ++CultureSwitchRequest;
+	bSwitchingCulture = true;
+
+	TWeakObjectPtr<UArticyLocalizerSystem> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Request, Files = MoveTemp(Files)]()
+	{
+		LLM_SCOPE_BYTAG(Articy_Text);
+
+		// Tables that are not registered yet can be filled off the game thread
+		TArray<TPair<FName, FStringTablePtr>> Tables;
+		Tables.Reserve(Files.Num());
+		for (const TPair<FName, FString>& File : Files)
+		{
+			FStringTablePtr Table;
+			if (!File.Value.IsEmpty())
+			{
+				Table = FStringTable::NewStringTable();
+				Table->SetNamespace(File.Key.ToString());
+				Table->ImportStrings(File.Value);
+			}
+			Tables.Emplace(File.Key, MoveTemp(Table));
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Request, Tables = MoveTemp(Tables)]()
+		{
+			if (UArticyLocalizerSystem* Localizer = WeakThis.Get())
+				Localizer->SwapStringTables(Request, Tables);
+		});
+	});
+}
+
+void UArticyLocalizerSystem::SwapStringTables(const uint32 Request, const TArray<TPair<FName, FStringTablePtr>>& Tables)
+{
+	if (Request != CultureSwitchRequest)
+		return;
+
+	bSwitchingCulture = false;
+
+	LLM_SCOPE_BYTAG(Articy_Text);
+	for (const TPair<FName, FStringTablePtr>& Table : Tables)
+	{
+		// Tables unloaded while they were read stay unloaded
+		if (!LoadedStringTables.Contains(Table.Key))
+			continue;
+
+		if (Table.Value.IsValid())
+		{
+			FStringTableRegistry::Get().RegisterStringTable(Table.Key, Table.Value.ToSharedRef());
+		}
+		else
+		{
+			FStringTableRegistry::Get().UnregisterStringTable(Table.Key);
+			LoadedStringTables.Remove(Table.Key);
+		}
+	}
+
+	OnStringTablesChanged();
+}
+
+void UArticyLocalizerSystem::OnStringTablesChanged()
+{
+	CachedEntries.Reset();
+	UArticyTextExtension::Get()->InvalidateResolvedTexts();
+	OnStringTablesSwapped.Broadcast();
+}
+
+bool UArticyLocalizerSystem::RegisterStringTable(const FName TableName)
+{
+	const FString* FilePath = StringTableFiles.Find(TableName);
+	if (!FilePath)
+		return false;
+
+	LLM_SCOPE_BYTAG(Articy_Text);
+	FStringTableRegistry::Get().UnregisterStringTable(TableName);
+	FStringTableRegistry::Get().Internal_LocTableFromFile(TableName, TableName.ToString(), *FilePath, FPaths::ProjectContentDir());
+	LoadedStringTables.FindOrAdd(TableName);
+	CachedEntries.Reset();
+	return true;
+}
+
+const FStringTableEntry* UArticyLocalizerSystem::FindStringTableEntry(const FString& TableName, const FString& Key)
+{
+	LLM_SCOPE_BYTAG(Articy_Text);
+
+	// Reload registers the tables of the new culture when it changes
+	const FString& Culture = FInternationalization::Get().GetCurrentCulture()->GetName();
+	if (!CachedEntriesCulture.Equals(Culture, ESearchCase::CaseSensitive))
+	{
+		CachedEntries.Reset();
+		CachedEntriesCulture = Culture;
+	}
+
+	TMap<FString, FStringTableEntryConstPtr>* TableEntries = CachedEntries.Find(TableName);
+	if (TableEntries)
+	{
+		// Entries that were removed from their table are disowned
+		const FStringTableEntryConstPtr* Cached = TableEntries->Find(Key);
+		if (Cached && (!Cached->IsValid() || (*Cached)->IsOwned()))
+			return Cached->Get();
+	}
+	else
+	{
+		TableEntries = &CachedEntries.Add(TableName);
+	}
+
+	// Find the table, tables of packages that are not loaded are loaded now
+	const FName TableId(*TableName);
+	FStringTableConstPtr TablePtr = FStringTableRegistry::Get().FindStringTable(TableId);
+	if (!TablePtr.IsValid() && RegisterStringTable(TableId))
+	{
+		TablePtr = FStringTableRegistry::Get().FindStringTable(TableId);
+
+		// Registering reset the cache
+		TableEntries = &CachedEntries.Add(TableName);
+	}
+
+	FStringTableEntryConstPtr Entry;
+	if (TablePtr.IsValid())
+		Entry = TablePtr->FindEntry(FTextKey(Key));
+
+	TableEntries->Add(Key, Entry);
+	return Entry.Get();
+}
@@ -12,11 +12,18 @@
 #include "AssetRegistryModule.h"
 #endif
 #include "ArticyPackage.h"
+#include "Misc/PackageName.h"
 
 #if WITH_EDITOR
-TSet<TWeakObjectPtr<UArticyPackage>> UArticyObject::CachedPackages;
-TMap<FArticyId, TWeakObjectPtr<UArticyObject>> UArticyObject::ArticyIdCache;
-TMap<FName, TWeakObjectPtr<UArticyObject>> UArticyObject::ArticyNameCache;
+TMap<FArticyId, UArticyObject::FIndexedAsset> UArticyObject::AssetIndexById;
+TMap<FName, UArticyObject::FIndexedAsset> UArticyObject::AssetIndexByName;
+TMap<FName, UArticyObject::FIndexedPackage> UArticyObject::IndexedPackages;
+TSet<FName> UArticyObject::PendingPackages;
+bool UArticyObject::bAssetIndexBuilt = false;
+FDelegateHandle UArticyObject::OnAssetAddedHandle;
+FDelegateHandle UArticyObject::OnAssetRemovedHandle;
+FDelegateHandle UArticyObject::OnAssetRenamedHandle;
+FDelegateHandle UArticyObject::OnAssetUpdatedHandle;
 #endif
 
 /**
@@ -58,29 +65,68 @@ FName UArticyObject::GetTechnicalName() const
  */
 UArticyObject* UArticyObject::GetParent() const
 {
-	return UArticyDatabase::Get(this)->GetObject<UArticyObject>(Parent);
+	const uint32 Generation = UArticyDatabase::GetGeneration();
+	if (CachedParentGeneration != Generation)
+	{
+		CachedParent = UArticyDatabase::Get(this)->GetObject<UArticyObject>(Parent);
+		CachedParentGeneration = Generation;
+	}
+
+	return CachedParent.Get();
 }
 
 /**
  * Gets the children of this Articy object.
  *
- * @return An array of weak pointers to the child Articy objects.
+ * @return An array of weak pointers to the child Articy objects, valid until the object is destroyed.
  */
-TArray<TWeakObjectPtr<UArticyObject>> UArticyObject::GetChildren() const
+const TArray<TWeakObjectPtr<UArticyObject>>& UArticyObject::GetChildren() const
 {
-	if (CachedChildren.Num() != Children.Num())
+	const uint32 Generation = UArticyDatabase::GetGeneration();
+	if (CachedChildrenGeneration != Generation)
 	{
 		auto db = UArticyDatabase::Get(this);
-		CachedChildren.Empty(Children.Num());
+		CachedChildren.Reset(Children.Num());
 
 		for (auto childId : Children)
 			if (auto child = db->GetObject<UArticyObject>(childId))
 				CachedChildren.Add(child);
+
+		CachedChildrenGeneration = Generation;
 	}
 
 	return CachedChildren;
 }
 
+/**
+ * Checks whether this object is below another one in the object hierarchy.
+ * Compares the positions numbered when the object index was built instead of walking up the parents.
+ *
+ * @param Ancestor The object to check against.
+ * @return True if Ancestor is a direct or indirect parent of this object.
+ */
+bool UArticyObject::IsDescendantOf(const UArticyObject* Ancestor) const
+{
+	return Ancestor && Ancestor->GetHierarchyRange().Contains(GetHierarchyRange());
+}
+
+/**
+ * Gets the position of this object in the hierarchy, cached until the generation changes.
+ *
+ * @return The range of the object and its descendants.
+ */
+const FArticyHierarchyRange& UArticyObject::GetHierarchyRange() const
+{
+	const uint32 Generation = UArticyDatabase::GetGeneration();
+	if (CachedHierarchyGeneration != Generation)
+	{
+		CachedHierarchyRange = UArticyDatabase::Get(this)->GetHierarchyRange(GetId());
+		CachedHierarchyGeneration = Generation;
+	}
+
+	return CachedHierarchyRange;
+}
+
 /**
  * Gets the ID of the parent Articy object.
  *
@@ -96,7 +142,7 @@ FArticyId UArticyObject::GetParentID() const
  *
  * @return An array of IDs for the children Articy objects.
  */
-TArray<FArticyId> UArticyObject::GetChildrenIDs() const
+const TArray<FArticyId>& UArticyObject::GetChildrenIDs() const
 {
 	return Children;
 }
@@ -124,162 +170,226 @@ TArray<FArticyId> UArticyObject::GetArticyObjectChildrenIDs() const
 }
 
 /**
- * Finds an Articy object by its ID. Caches and refreshes packages if necessary.
+ * Finds an Articy object by its ID in the asset index of all packages.
  *
  * @param Id The ID of the Articy object to find.
  * @return Pointer to the Articy object if found, or nullptr if not found.
  */
 UArticyObject* UArticyObject::FindAsset(const FArticyId& Id)
 {
-	if (ArticyIdCache.Contains(Id) && ArticyIdCache[Id].IsValid())
-	{
-		return ArticyIdCache[Id].Get();
-	}
+	UpdateAssetIndex();
 
-	bool bRefreshPackages = false;
+	const FIndexedAsset* IndexedAsset = AssetIndexById.Find(Id);
+	UArticyObject* ArticyObject = IndexedAsset ? IndexedAsset->Asset.Get() : nullptr;
 
-	if (CachedPackages.Num() >= 1)
-	{
-		for (auto& Package : CachedPackages)
-		{
-			bRefreshPackages = !Package.IsValid();
+	return ArticyObject && ArticyObject->WasLoaded() ? ArticyObject : nullptr;
+}
 
-			if (bRefreshPackages)
-			{
-				break;
-			}
-		}
-	}
-	else if (CachedPackages.Num() == 0)
+/**
+ * Finds an Articy object by its technical name in the asset index of all packages.
+ *
+ * @param TechnicalName The technical name of the Articy object to find.
+ * @return Pointer to the Articy object if found, or nullptr if not found.
+ */
+UArticyObject* UArticyObject::FindAsset(const FString& TechnicalName)// MM_CHANGE
+{
+	UpdateAssetIndex();
+
+	const FIndexedAsset* IndexedAsset = AssetIndexByName.Find(FName(*TechnicalName));
+	UArticyObject* ArticyObject = IndexedAsset ? IndexedAsset->Asset.Get() : nullptr;
+
+	return ArticyObject && ArticyObject->WasLoaded() ? ArticyObject : nullptr;
+}
+
+/**
+ * Drops the asset index and unregisters from the asset registry events.
+ */
+void UArticyObject::ResetAssetIndex()
+{
+	if (bAssetIndexBuilt && FModuleManager::Get().IsModuleLoaded(AssetRegistryConstants::ModuleName))
 	{
-		bRefreshPackages = true;
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName).Get();
+		AssetRegistry.OnAssetAdded().Remove(OnAssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(OnAssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(OnAssetRenamedHandle);
+		AssetRegistry.OnAssetUpdated().Remove(OnAssetUpdatedHandle);
 	}
 
-	// refresh packages if needed 
-	if (bRefreshPackages)
+	AssetIndexById.Empty();
+	AssetIndexByName.Empty();
+	IndexedPackages.Empty();
+	PendingPackages.Empty();
+	bAssetIndexBuilt = false;
+}
+
+/**
+ * Builds the asset index from all packages on first use and indexes the packages that
+ * were added or changed since the last call.
+ */
+void UArticyObject::UpdateAssetIndex()
+{
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName);
+
+	if (!bAssetIndexBuilt)
 	{
-		CachedPackages.Empty();
+		bAssetIndexBuilt = true;
 
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName);
-		TArray<FAssetData> AssetData;
+		// packages the registry discovers from now on are reported through these
+		IAssetRegistry& AssetRegistry = AssetRegistryModule.Get();
+		OnAssetAddedHandle = AssetRegistry.OnAssetAdded().AddStatic(&UArticyObject::OnAssetAdded);
+		OnAssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddStatic(&UArticyObject::OnAssetRemoved);
+		OnAssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddStatic(&UArticyObject::OnAssetRenamed);
+		OnAssetUpdatedHandle = AssetRegistry.OnAssetUpdated().AddStatic(&UArticyObject::OnAssetAdded);
 
+		TArray<FAssetData> AssetData;
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), AssetData, true);
+		AssetRegistry.GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), AssetData, true);
 #else
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), AssetData, true);
+		AssetRegistry.GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), AssetData, true);
 #endif
-
 		for (const auto& ArticyPackage : AssetData)
 		{
-			const auto& Package = Cast<UArticyPackage>(ArticyPackage.GetAsset());
-
-			if (Package != nullptr)
-			{
-				CachedPackages.Add(Package);
-			}
+			PendingPackages.Add(ArticyPackage.PackageName);
 		}
 	}
 
-	for (TWeakObjectPtr<UArticyPackage> ArticyPackage : CachedPackages)
+	if (PendingPackages.Num() == 0)
+		return;
+
+	// loading a package may report further assets, so work on a copy
+	TSet<FName> Packages = MoveTemp(PendingPackages);
+	PendingPackages.Empty();
+
+	for (const FName& PackageName : Packages)
 	{
-		if (ArticyPackage.IsValid())
+		TArray<FAssetData> AssetData;
+		AssetRegistryModule.Get().GetAssetsByPackageName(PackageName, AssetData);
+
+		UArticyPackage* Package = nullptr;
+		for (const auto& Asset : AssetData)
 		{
-			UArticyObject* ArticyObject = ArticyPackage->GetAssetById(Id);
-			if (ArticyObject && ArticyObject->WasLoaded())
+			if (IsPackageAsset(Asset))
 			{
-				ArticyIdCache.Add(Id, ArticyObject);
-				ArticyNameCache.Add(ArticyObject->GetTechnicalName(), ArticyObject);
-				return ArticyObject;
+				Package = Cast<UArticyPackage>(Asset.GetAsset());
+				break;
 			}
 		}
-	}
 
-	// if the object wasn't found in any package but exists in the object map, remove it
-	if (ArticyIdCache.Contains(Id))
-	{
-		ArticyIdCache.Remove(Id);
+		IndexPackage(PackageName, Package);
 	}
-
-	return nullptr;
 }
 
 /**
- * Finds an Articy object by its technical name. Caches and refreshes packages if necessary.
+ * Replaces the index entries of a package with its current objects.
  *
- * @param TechnicalName The technical name of the Articy object to find.
- * @return Pointer to the Articy object if found, or nullptr if not found.
+ * @param PackageName The name of the package the articy package asset is in.
+ * @param Package The articy package asset, nullptr to only remove the entries.
  */
-UArticyObject* UArticyObject::FindAsset(const FString& TechnicalName)// MM_CHANGE
+void UArticyObject::IndexPackage(FName PackageName, UArticyPackage* Package)
 {
-	const FName Name(*TechnicalName);
-	if (ArticyNameCache.Contains(Name) && ArticyNameCache[Name].IsValid())
-	{
-		return ArticyNameCache[Name].Get();
-	}
+	UnindexPackage(PackageName);
 
-	bool bRefreshPackages = false;
+	if (!Package)
+		return;
 
-	if (CachedPackages.Num() >= 1)
-	{
-		for (auto& Package : CachedPackages)
-		{
-			bRefreshPackages = !Package.IsValid();
+	const TArray<UArticyObject*>& Assets = Package->GetAssets();
+	FIndexedPackage& IndexedPackage = IndexedPackages.Add(PackageName);
+	IndexedPackage.Ids.Reserve(Assets.Num());
+	IndexedPackage.TechnicalNames.Reserve(Assets.Num());
 
-			if (bRefreshPackages)
-			{
-				break;
-			}
-		}
-	}
-	else if (CachedPackages.Num() == 0)
+	for (UArticyObject* Asset : Assets)
 	{
-		bRefreshPackages = true;
+		if (!Asset)
+			continue;
+
+		const FIndexedAsset IndexedAsset{ Asset, PackageName };
+		AssetIndexById.Add(Asset->GetId(), IndexedAsset);
+		AssetIndexByName.Add(Asset->GetTechnicalName(), IndexedAsset);
+		IndexedPackage.Ids.Add(Asset->GetId());
+		IndexedPackage.TechnicalNames.Add(Asset->GetTechnicalName());
 	}
+}
 
-	// refresh packages if needed 
-	if (bRefreshPackages)
+/**
+ * Removes the index entries of a package, leaving those another package has indexed since.
+ *
+ * @param PackageName The name of the package the articy package asset is in.
+ */
+void UArticyObject::UnindexPackage(FName PackageName)
+{
+	FIndexedPackage IndexedPackage;
+	if (!IndexedPackages.RemoveAndCopyValue(PackageName, IndexedPackage))
+		return;
+
+	for (const FArticyId& Id : IndexedPackage.Ids)
 	{
-		CachedPackages.Empty();
+		const FIndexedAsset* IndexedAsset = AssetIndexById.Find(Id);
+		if (IndexedAsset && IndexedAsset->Package == PackageName)
+			AssetIndexById.Remove(Id);
+	}
 
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName);
-		TArray<FAssetData> AssetData;
+	for (const FName& TechnicalName : IndexedPackage.TechnicalNames)
+	{
+		const FIndexedAsset* IndexedAsset = AssetIndexByName.Find(TechnicalName);
+		if (IndexedAsset && IndexedAsset->Package == PackageName)
+			AssetIndexByName.Remove(TechnicalName);
+	}
+}
 
+/**
+ * Checks whether an asset registry entry is an articy package.
+ *
+ * @param AssetData The asset registry entry.
+ * @return True if the asset is an articy package.
+ */
+bool UArticyObject::IsPackageAsset(const FAssetData& AssetData)
+{
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), AssetData, true);
+	return AssetData.AssetClassPath == UArticyPackage::StaticClass()->GetClassPathName();
 #else
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), AssetData, true);
+	return AssetData.AssetClass == UArticyPackage::StaticClass()->GetFName();
 #endif
-		for (const auto& ArticyPackage : AssetData)
-		{
-			const auto& Package = Cast<UArticyPackage>(ArticyPackage.GetAsset());
+}
 
-			if (Package != nullptr)
-			{
-				CachedPackages.Add(Package);
-			}
-		}
-	}
+/**
+ * Queues an added or updated articy package for indexing on the next lookup.
+ *
+ * @param AssetData The asset registry entry of the asset.
+ */
+void UArticyObject::OnAssetAdded(const FAssetData& AssetData)
+{
+	if (IsPackageAsset(AssetData))
+		PendingPackages.Add(AssetData.PackageName);
+}
 
-	for (TWeakObjectPtr<UArticyPackage> ArticyPackage : CachedPackages)
-	{
-		if (ArticyPackage.IsValid())
-		{
-			UArticyObject* ArticyObject = ArticyPackage->GetAssetByTechnicalName(Name);
-			if (ArticyObject && ArticyObject->WasLoaded())
-			{
-				ArticyNameCache.Add(Name, ArticyObject);
-				ArticyIdCache.Add(ArticyObject->GetId(), ArticyObject);
-				return ArticyObject;
-			}
-		}
-	}
+/**
+ * Removes the objects of a removed articy package from the index.
+ *
+ * @param AssetData The asset registry entry of the asset.
+ */
+void UArticyObject::OnAssetRemoved(const FAssetData& AssetData)
+{
+	if (!IsPackageAsset(AssetData))
+		return;
 
-	// if the object wasn't found in any package but exists in the object map, remove it
-	if (ArticyNameCache.Contains(Name))
-	{
-		ArticyNameCache.Remove(Name);
-	}
+	PendingPackages.Remove(AssetData.PackageName);
+	UnindexPackage(AssetData.PackageName);
+}
+
+/**
+ * Moves the objects of a renamed articy package to its new name in the index.
+ *
+ * @param AssetData The asset registry entry of the asset under its new name.
+ * @param OldObjectPath The object path of the asset before it was renamed.
+ */
+void UArticyObject::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	if (!IsPackageAsset(AssetData))
+		return;
 
-	return nullptr;
+	const FName OldPackageName(*FPackageName::ObjectPathToPackageName(OldObjectPath));
+	PendingPackages.Remove(OldPackageName);
+	UnindexPackage(OldPackageName);
+	PendingPackages.Add(AssetData.PackageName);
 }
 #endif
@@ -5,6 +5,10 @@
 #include "ArticyObjectNotificationManager.h"
 #include "ArticyBaseObject.h"
 #include "ArticyDatabase.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyPrimitive.h"
+
+int32 UArticyObjectNotificationManager::NumListeners = 0;
 
 /**
  * Gets the singleton instance of the notification manager.
@@ -17,12 +21,31 @@ UArticyObjectNotificationManager* UArticyObjectNotificationManager::Get()
 
     if (!ArticyObjectNotificationManager.IsValid())
     {
+        // the listeners live in the manager, it must not be collected while they are registered
         ArticyObjectNotificationManager = TWeakObjectPtr<UArticyObjectNotificationManager>(NewObject<UArticyObjectNotificationManager>());
+        ArticyObjectNotificationManager->AddToRoot();
     }
 
     return ArticyObjectNotificationManager.Get();
 }
 
+/**
+ * Unregisters the dispatch ticker and forgets the listeners of the instance.
+ */
+void UArticyObjectNotificationManager::BeginDestroy()
+{
+    if (DispatchHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(DispatchHandle);
+        DispatchHandle.Reset();
+    }
+
+    if (!HasAnyFlags(RF_ClassDefaultObject))
+        NumListeners = 0;
+
+    Super::BeginDestroy();
+}
+
 /**
  * Splits a string into an object name and instance number based on angle brackets.
  * @param InString The input string to split.
@@ -57,97 +80,419 @@ void UArticyObjectNotificationManager::SplitInstance(const FString& InString, FS
 }
 
 /**
- * Adds a listener for changes to Articy objects matching the given filter.
- * Resolves the object based on the filter and adds the listener.
- * @param Filter The filter string for identifying Articy objects.
- * @param ChangedFunction The function to call when a property changes.
+ * Parses a filter string into the key its listeners are indexed by.
+ * Objects given by technical name are resolved here, so changes never need to parse or look up names.
+ * @param Filter The filter string.
+ * @param bIsType Whether the filter names a type instead of an object.
+ * @return The parsed filter, of kind Invalid if the object is unknown.
  */
-void UArticyObjectNotificationManager::AddListener(const FString& Filter, FArticyPropertyChangedFunction ChangedFunction)
+UArticyObjectNotificationManager::FFilter UArticyObjectNotificationManager::ParseFilter(const FString& Filter, bool bIsType)
 {
+    FFilter Parsed;
+
+    FString Target = Filter, Property;
+    Filter.Split(TEXT("."), &Target, &Property);
+    if (!Property.IsEmpty() && Property != TEXT("*"))
+        Parsed.Property = *Property;
+
+    if (Target.IsEmpty() || Target == TEXT("*"))
+    {
+        Parsed.Kind = FFilter::EKind::Any;
+        return Parsed;
+    }
+
+    if (bIsType)
+    {
+        Parsed.Kind = FFilter::EKind::Type;
+        Parsed.Type = *Target;
+        return Parsed;
+    }
+
     FString ObjectName, ObjectInstance;
-    SplitInstance(Filter, ObjectName, ObjectInstance);
-    UArticyObject* Object;
-    auto DB = UArticyDatabase::Get(this);
-    if (Filter.StartsWith(TEXT("0x")))
+    SplitInstance(Target, ObjectName, ObjectInstance);
+    const uint32 CloneId = FCString::Atoi(*ObjectInstance);
+
+    FArticyId Id;
+    if (ObjectName.StartsWith(TEXT("0x")))
     {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::HexToUint64(ObjectName) }, FCString::Atod(*ObjectInstance));
+        Id = FArticyId{ ArticyHelpers::HexToUint64(ObjectName) };
     }
-    else if (Filter.IsNumeric())
+    else if (ObjectName.IsNumeric())
     {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ FCString::Strtoui64(*ObjectName, nullptr, 10) }, FCString::Atod(*ObjectInstance));
+        Id = FArticyId{ ArticyHelpers::DecToUint64(ObjectName) };
     }
     else
     {
-        Object = DB->GetObjectByName(*ObjectName, FCString::Atod(*ObjectInstance));
+        auto DB = UArticyDatabase::Get(this);
+        UArticyObject* Object = DB ? DB->GetObjectByName(*ObjectName, CloneId) : nullptr;
+        if (!Object)
+            return Parsed;
+
+        Id = Object->GetId();
     }
 
-    if (Object)
+    Parsed.Kind = FFilter::EKind::Object;
+    Parsed.Object = FObjectKey(Id, CloneId);
+    return Parsed;
+}
+
+/**
+ * Gets the listener list of a filter.
+ * @param Filter The parsed filter.
+ * @param bAdd Whether to add the list if there is none.
+ * @return The list, or null if there is none and bAdd is false.
+ */
+TArray<UArticyObjectNotificationManager::FListener>* UArticyObjectNotificationManager::FindListeners(const FFilter& Filter, bool bAdd)
+{
+    switch (Filter.Kind)
     {
-        AddListener(Object, ChangedFunction);
+    case FFilter::EKind::Object:
+        return bAdd ? &ObjectListeners.FindOrAdd(Filter.Object) : ObjectListeners.Find(Filter.Object);
+    case FFilter::EKind::Type:
+        return bAdd ? &TypeListeners.FindOrAdd(Filter.Type) : TypeListeners.Find(Filter.Type);
+    case FFilter::EKind::Any:
+        // a property without an object or type is looked up by its name
+        if (Filter.Property.IsNone())
+            return &GlobalListeners;
+        return bAdd ? &PropertyListeners.FindOrAdd(Filter.Property) : PropertyListeners.Find(Filter.Property);
+    default:
+        return nullptr;
     }
 }
 
+void UArticyObjectNotificationManager::AddListener(const FFilter& Filter, const FListener& Listener)
+{
+    TArray<FListener>* Listeners = FindListeners(Filter, true);
+    if (!Listeners || !Listener.Function)
+        return;
+
+    Listeners->Add(Listener);
+    ++NumListeners;
+}
+
 /**
- * Adds a listener for changes to Articy objects matching the given filter and property flags.
+ * Adds a listener for changes to Articy objects matching the given filter.
  * @param Filter The filter string for identifying Articy objects.
- * @param Flags The types of properties to include in notifications.
+ * @param ChangedFunction The function to call when a property changes.
+ */
+void UArticyObjectNotificationManager::AddListener(const FString& Filter, FArticyPropertyChangedFunction ChangedFunction)
+{
+    const FFilter Parsed = ParseFilter(Filter, false);
+    AddListener(Parsed, FListener{ ChangedFunction, Parsed.Property, EArticyTypeProperties::All });
+}
+
+/**
+ * Adds a listener for changes to Articy objects of the type named by the filter.
+ * @param Filter The filter string for identifying the Articy type.
+ * @param Flags The types of properties to include in notifications, IncludeBaseType also matches derived types.
  * @param ChangedFunction The function to call when a property changes.
  */
 void UArticyObjectNotificationManager::AddListener(const FString& Filter, EArticyTypeProperties Flags, FArticyPropertyChangedFunction ChangedFunction)
 {
-    // Implementation can be added here if required.
+    const FFilter Parsed = ParseFilter(Filter, true);
+    AddListener(Parsed, FListener{ ChangedFunction, Parsed.Property, Flags });
 }
 
 /**
  * Adds a listener for changes to a specific Articy object.
- * Registers a lambda function to handle property changes.
+ * Changes of its template features are reported to it as well.
  * @param Object The Articy object to listen to.
  * @param ChangedFunction The function to call when a property changes.
  */
 void UArticyObjectNotificationManager::AddListener(UArticyBaseObject* Object, FArticyPropertyChangedFunction ChangedFunction)
 {
-    Object->ReportChanged.AddLambda([ChangedFunction](FArticyChangedProperty ChangedProperty)
-        {
-            ChangedFunction(ChangedProperty);
-        });
+    const UArticyPrimitive* Owner = GetOwner(Object);
+    if (!Owner)
+        return;
+
+    FFilter Parsed;
+    Parsed.Kind = FFilter::EKind::Object;
+    Parsed.Object = FObjectKey(Owner->GetId(), Owner->GetCloneId());
+    AddListener(Parsed, FListener{ ChangedFunction, NAME_None, EArticyTypeProperties::All });
 }
 
 /**
  * Removes listeners for Articy objects matching the given filter.
- * Resolves the object based on the filter and removes its listeners.
+ * If the filter names a property, only the listeners of that property are removed.
  * @param Filter The filter string for identifying Articy objects.
  */
 void UArticyObjectNotificationManager::RemoveListeners(const FString& Filter)
 {
-    FString ObjectName, ObjectInstance;
-    SplitInstance(Filter, ObjectName, ObjectInstance);
-    UArticyObject* Object;
-    auto DB = UArticyDatabase::Get(this);
-    if (Filter.StartsWith(TEXT("0x")))
+    const FFilter Parsed = ParseFilter(Filter, false);
+    const FFilter Type = ParseFilter(Filter, true);
+
+    for (const FFilter& Candidate : { Parsed, Type })
     {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::HexToUint64(ObjectName) }, FCString::Atod(*ObjectInstance));
+        TArray<FListener>* Listeners = FindListeners(Candidate, false);
+        if (!Listeners)
+            continue;
+
+        NumListeners -= Listeners->RemoveAll([&Candidate](const FListener& Listener)
+            {
+                return Candidate.Property.IsNone() || Listener.Property == Candidate.Property;
+            });
+
+        // both parse to the same list for "*" filters
+        if (Candidate.Kind == FFilter::EKind::Any)
+            break;
     }
-    else if (Filter.IsNumeric())
+}
+
+/**
+ * Removes listeners from a specific Articy object.
+ * @param Object The Articy object to remove listeners from.
+ */
+void UArticyObjectNotificationManager::RemoveListeners(UArticyBaseObject* Object)
+{
+    const UArticyPrimitive* Owner = GetOwner(Object);
+    if (!Owner)
+        return;
+
+    TArray<FListener> Removed;
+    if (ObjectListeners.RemoveAndCopyValue(FObjectKey(Owner->GetId(), Owner->GetCloneId()), Removed))
+        NumListeners -= Removed.Num();
+}
+
+/**
+ * Gets the object a property belongs to, the owner for template features.
+ * @param Object The object whose property changed.
+ * @return The owning primitive, or null if there is none.
+ */
+const UArticyPrimitive* UArticyObjectNotificationManager::GetOwner(const UArticyBaseObject* Object)
+{
+    for (const UObject* Outer = Object; Outer; Outer = Outer->GetOuter())
     {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ FCString::Strtoui64(*ObjectName, nullptr, 10) }, FCString::Atod(*ObjectInstance));
+        if (const UArticyPrimitive* Primitive = Cast<UArticyPrimitive>(Outer))
+            return Primitive;
     }
-    else
+
+    return nullptr;
+}
+
+/**
+ * Reports a property written by IArticyReflectable::SetProp to its ReportChanged delegate and the listeners.
+ * Both are served on the next dispatch, so repeated writes within a frame are reported once.
+ * @param Reflectable The object whose property was written.
+ * @param Property The property that has changed.
+ */
+void UArticyObjectNotificationManager::ReportChange(IArticyReflectable* Reflectable, FName Property)
+{
+    UObject* Object = Reflectable ? Reflectable->_getUObject() : nullptr;
+    // shadowed writes are undone when the operation ends, nobody must hear of them
+    if (!Object || IsShadowed(Object))
+        return;
+
+    if (Reflectable->ReportChanged.IsBound())
     {
-        Object = DB->GetObjectByName(*ObjectName, FCString::Atod(*ObjectInstance));
+        UArticyObjectNotificationManager* Manager = Get();
+        bool bAlreadyQueued = false;
+        Manager->PendingReportKeys.Add(TPair<const UObject*, FName>(Object, Property), &bAlreadyQueued);
+        if (!bAlreadyQueued)
+        {
+            Manager->PendingReports.Add(FPendingReport{ Object, Property });
+            Manager->ScheduleDispatch();
+        }
     }
 
-    if (Object)
+    if (HasListeners())
     {
-        RemoveListeners(Object);
+        FArticyChangedProperty ChangedProperty;
+        ChangedProperty.Property = Property;
+        ChangedProperty.SetObjectReference(Reflectable);
+        QueueChange(ChangedProperty);
     }
 }
 
 /**
- * Removes listeners from a specific Articy object.
- * Clears all change notifications for the given object.
- * @param Object The Articy object to remove listeners from.
+ * Queues a change for the next dispatch if anybody listens to the object, its type or the property.
+ * @param ChangedProperty The property that has changed.
  */
-void UArticyObjectNotificationManager::RemoveListeners(UArticyBaseObject* Object)
+void UArticyObjectNotificationManager::QueueChange(const FArticyChangedProperty& ChangedProperty)
+{
+    UArticyObjectNotificationManager* Manager = Get();
+    UArticyBaseObject* Object = ChangedProperty.ObjectReference;
+    if (!Manager || !Object || !Manager->IsObserved(GetOwner(Object), ChangedProperty.Property))
+        return;
+
+    bool bAlreadyQueued = false;
+    Manager->PendingKeys.Add(TPair<const UArticyBaseObject*, FName>(Object, ChangedProperty.Property), &bAlreadyQueued);
+    if (bAlreadyQueued)
+        return;
+
+    Manager->PendingChanges.Add(FPendingChange{ Object, ChangedProperty.Property });
+    Manager->ScheduleDispatch();
+}
+
+/**
+ * Registers the dispatch ticker if it is not registered, it unregisters itself once nothing is queued.
+ */
+void UArticyObjectNotificationManager::ScheduleDispatch()
+{
+    if (!DispatchHandle.IsValid())
+    {
+        DispatchHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateUObject(this, &UArticyObjectNotificationManager::DispatchChanges), 0.0f);
+    }
+}
+
+/**
+ * Checks if the database or global variables an object belongs to are in a shadowed operation.
+ * @param Object The object whose property was written.
+ * @return True if the first database or global variables among the outers of the object are shadowed.
+ */
+bool UArticyObjectNotificationManager::IsShadowed(const UObject* Object)
+{
+    for (const UObject* Outer = Object; Outer; Outer = Outer->GetOuter())
+    {
+        if (const UArticyDatabase* Database = Cast<UArticyDatabase>(Outer))
+            return Database->GetShadowLevel() > 0;
+        if (const UArticyGlobalVariables* GlobalVariables = Cast<UArticyGlobalVariables>(Outer))
+            return GlobalVariables->GetShadowLevel() > 0;
+    }
+
+    return false;
+}
+
+/**
+ * Checks if any listener may be interested in a change, without looking at its flags.
+ * Type listeners are matched against the class chain, which stays cheap as only few types are listened to.
+ * @param Owner The object the changed property belongs to, or the owner of its feature.
+ * @param Property The changed property.
+ * @return True if the change has to be queued.
+ */
+bool UArticyObjectNotificationManager::IsObserved(const UArticyPrimitive* Owner, FName Property) const
 {
-    Object->ReportChanged.Clear();
+    if (GlobalListeners.Num() > 0 || PropertyListeners.Contains(Property))
+        return true;
+
+    if (!Owner)
+        return false;
+
+    if (ObjectListeners.Contains(FObjectKey(Owner->GetId(), Owner->GetCloneId())))
+        return true;
+
+    if (TypeListeners.Num() == 0)
+        return false;
+
+    if (TypeListeners.Contains(*Owner->ArticyType.TechnicalName))
+        return true;
+
+    for (const UClass* Class = Owner->GetClass(); Class; Class = Class->GetSuperClass())
+    {
+        if (TypeListeners.Contains(Class->GetFName()))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Collects the functions of the listeners matching a change.
+ * Changes of template features count as template properties, properties declared by the runtime
+ * classes as articy object properties and all others as general properties.
+ * @param Change The change to match.
+ * @param OutFunctions Receives the functions to call.
+ */
+void UArticyObjectNotificationManager::CollectListeners(const FPendingChange& Change, TArray<FArticyPropertyChangedFunction>& OutFunctions) const
+{
+    const UArticyBaseObject* Object = Change.Object.Get();
+    const UArticyPrimitive* Owner = GetOwner(Object);
+
+    EArticyTypeProperties Kind = EArticyTypeProperties::General;
+    if (Object != Owner)
+    {
+        Kind = EArticyTypeProperties::Template;
+    }
+    else if (const FProperty* Property = Object->GetClass()->FindPropertyByName(Change.Property))
+    {
+        if (Property->GetOwnerClass() && Property->GetOwnerClass()->GetOutermost() == UArticyBaseObject::StaticClass()->GetOutermost())
+            Kind = EArticyTypeProperties::ArticyObject;
+    }
+
+    auto Collect = [&](const TArray<FListener>* Listeners, bool bBaseType)
+    {
+        if (!Listeners)
+            return;
+
+        for (const FListener& Listener : *Listeners)
+        {
+            if (!Listener.Property.IsNone() && Listener.Property != Change.Property)
+                continue;
+            if (!EnumHasAnyFlags(Listener.Flags, Kind))
+                continue;
+            if (bBaseType && !EnumHasAnyFlags(Listener.Flags, EArticyTypeProperties::IncludeBaseType))
+                continue;
+
+            OutFunctions.Add(Listener.Function);
+        }
+    };
+
+    Collect(&GlobalListeners, false);
+    Collect(PropertyListeners.Find(Change.Property), false);
+
+    if (!Owner)
+        return;
+
+    Collect(ObjectListeners.Find(FObjectKey(Owner->GetId(), Owner->GetCloneId())), false);
+
+    if (TypeListeners.Num() == 0)
+        return;
+
+    Collect(TypeListeners.Find(*Owner->ArticyType.TechnicalName), false);
+
+    // listeners of a base class only hear of derived types with IncludeBaseType
+    for (const UClass* Class = Owner->GetClass(); Class; Class = Class->GetSuperClass())
+        Collect(TypeListeners.Find(Class->GetFName()), Class != Owner->GetClass());
+}
+
+/**
+ * Delivers the changes queued since the last frame.
+ * @param DeltaTime The time since the last tick.
+ * @return True to stay registered, if changes were queued while dispatching.
+ */
+bool UArticyObjectNotificationManager::DispatchChanges(float DeltaTime)
+{
+    // changes made by the listeners of this dispatch are delivered on the next one
+    TArray<FPendingReport> Reports = MoveTemp(PendingReports);
+    PendingReports.Reset();
+    PendingReportKeys.Reset();
+    TArray<FPendingChange> Changes = MoveTemp(PendingChanges);
+    PendingChanges.Reset();
+    PendingKeys.Reset();
+
+    for (const FPendingReport& Report : Reports)
+    {
+        IArticyReflectable* Reflectable = Cast<IArticyReflectable>(Report.Object.Get());
+        if (!Reflectable)
+            continue;
+
+        FArticyChangedProperty ChangedProperty;
+        ChangedProperty.Property = Report.Property;
+        ChangedProperty.SetObjectReference(Reflectable);
+        Reflectable->ReportChanged.Broadcast(ChangedProperty);
+    }
+
+    TArray<FArticyPropertyChangedFunction> Functions;
+    for (const FPendingChange& Change : Changes)
+    {
+        UArticyBaseObject* Object = Change.Object.Get();
+        if (!Object)
+            continue;
+
+        Functions.Reset();
+        CollectListeners(Change, Functions);
+
+        FArticyChangedProperty ChangedProperty;
+        ChangedProperty.ObjectReference = Object;
+        ChangedProperty.Property = Change.Property;
+
+        for (FArticyPropertyChangedFunction Function : Functions)
+            Function(ChangedProperty);
+    }
+
+    if (PendingChanges.Num() > 0 || PendingReports.Num() > 0)
+        return true;
+
+    DispatchHandle.Reset();
+    return false;
 }
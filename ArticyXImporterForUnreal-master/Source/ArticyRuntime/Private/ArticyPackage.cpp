@@ -0,0 +1,116 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPackage.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyPins.h"
+#include "Interfaces/ArticyInputPinsProvider.h"
+#include "Interfaces/ArticyOutputPinsProvider.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithText.h"
+
+#if WITH_EDITOR
+/**
+ * Joins IDs to the value of a list tag.
+ *
+ * @param Ids The IDs to join.
+ * @return The IDs as hex, separated by spaces.
+ */
+static FString JoinArticyIds(const TArray<uint64>& Ids)
+{
+	FString Result;
+	Result.Reserve(Ids.Num() * 19);
+	for (const uint64 Id : Ids)
+	{
+		if (!Result.IsEmpty())
+			Result.AppendChar(TEXT(' '));
+		Result += FString::Printf(TEXT("0x%016llX"), Id);
+	}
+	return Result;
+}
+
+/**
+ * Adds the counts, speakers and references of the objects, see ArticyPackageTags.
+ *
+ * @param OutTags The array to fill with asset registry tags.
+ */
+void UArticyPackage::GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const
+{
+	PRAGMA_DISABLE_DEPRECATION_WARNINGS
+		Super::GetAssetRegistryTags(OutTags);
+	PRAGMA_ENABLE_DEPRECATION_WARNINGS
+
+	TArray<uint64> ObjectIds;
+	ObjectIds.Reserve(Assets.Num());
+	TMap<const UClass*, int32> ClassCounts;
+	TSet<uint64> Speakers;
+	TSet<uint64> Targets;
+	int64 TextLength = 0;
+
+	auto AddTargets = [&Targets](const auto& Pins)
+	{
+		for (const UArticyFlowPin* Pin : Pins)
+		{
+			if (!Pin)
+				continue;
+			for (const FArticyPinConnection& Connection : Pin->OutgoingConnections)
+				Targets.Add(Connection.Target.Get());
+		}
+	};
+
+	for (const UArticyObject* Asset : Assets)
+	{
+		if (!Asset)
+			continue;
+
+		ObjectIds.Add(Asset->GetId().Get());
+		++ClassCounts.FindOrAdd(Asset->GetClass());
+
+		if (const IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Asset))
+			TextLength += WithText->GetText().ToString().Len();
+		if (const IArticyObjectWithSpeaker* WithSpeaker = Cast<IArticyObjectWithSpeaker>(Asset))
+		{
+			if (!WithSpeaker->GetSpeakerId().IsNull())
+				Speakers.Add(WithSpeaker->GetSpeakerId().Get());
+		}
+
+		if (const UArticyJump* Jump = Cast<UArticyJump>(Asset))
+			Targets.Add(Jump->GetTargetID().Get());
+		if (const IArticyInputPinsProvider* InputPins = Cast<IArticyInputPinsProvider>(Asset))
+		{
+			if (const TArray<UArticyInputPin*>* Pins = InputPins->GetInputPinsPtr())
+				AddTargets(*Pins);
+		}
+		if (const IArticyOutputPinsProvider* OutputPins = Cast<IArticyOutputPinsProvider>(Asset))
+		{
+			if (const TArray<UArticyOutputPin*>* Pins = OutputPins->GetOutputPinsPtr())
+				AddTargets(*Pins);
+		}
+	}
+
+	// Only the targets outside the package reference other packages
+	for (const uint64 Id : ObjectIds)
+		Targets.Remove(Id);
+	Targets.Remove(0);
+
+	TArray<FString> Classes;
+	for (const TPair<const UClass*, int32>& ClassCount : ClassCounts)
+		Classes.Add(FString::Printf(TEXT("%s=%d"), *ClassCount.Key->GetPathName(), ClassCount.Value));
+	Classes.Sort();
+
+	TArray<uint64> SortedSpeakers = Speakers.Array();
+	SortedSpeakers.Sort();
+	TArray<uint64> SortedTargets = Targets.Array();
+	SortedTargets.Sort();
+
+	OutTags.Add(FAssetRegistryTag(ArticyPackageTags::NumObjects, LexToString(ObjectIds.Num()), FAssetRegistryTag::TT_Numerical));
+	OutTags.Add(FAssetRegistryTag(ArticyPackageTags::TextLength, LexToString(TextLength), FAssetRegistryTag::TT_Numerical));
+
+	// The lists are for queries, not for the content browser's columns
+	OutTags.Add(FAssetRegistryTag(ArticyPackageTags::ObjectClasses, FString::Join(Classes, TEXT(" ")), FAssetRegistryTag::TT_Hidden));
+	OutTags.Add(FAssetRegistryTag(ArticyPackageTags::Speakers, JoinArticyIds(SortedSpeakers), FAssetRegistryTag::TT_Hidden));
+	OutTags.Add(FAssetRegistryTag(ArticyPackageTags::ObjectIds, JoinArticyIds(ObjectIds), FAssetRegistryTag::TT_Hidden));
+	OutTags.Add(FAssetRegistryTag(ArticyPackageTags::ExternalTargets, JoinArticyIds(SortedTargets), FAssetRegistryTag::TT_Hidden));
+}
+#endif
@@ -6,6 +6,8 @@
 #include "ArticyBaseTypes.h"
 #include "ArticyBuiltinTypes.h"
 #include "ArticyExpressoScripts.h"
+#include "ArticyFlowTrace.h"
+#include "ArticyScriptProfiler.h"
 
 void UArticyFlowPin::InitFromJson(TSharedPtr<FJsonValue> Json) 
 {
@@ -16,6 +18,8 @@ void UArticyFlowPin::InitFromJson(TSharedPtr<FJsonValue> Json)
 
 	auto obj = Json->AsObject();
 	JSON_TRY_FNAME(obj, Text);
+	bHasSideEffects = ArticyHelpers::ScriptHasSideEffects(Text);
+	bIsConstant = ArticyHelpers::FoldConstantScript(Text, IsA<UArticyOutputPin>(), bConstantResult);
 
 	auto id = obj->TryGetField(TEXT("Owner"));
 	Owner = FArticyId{id};
@@ -23,20 +27,84 @@ void UArticyFlowPin::InitFromJson(TSharedPtr<FJsonValue> Json)
 	const TArray<TSharedPtr<FJsonValue>>* items;
 	if (obj->TryGetArrayField(TEXT("Connections"), items))
 	{
-		for (int i = 0; i < items->Num(); ++i)
-		{
-			auto item = (*items)[i];
-			auto conn = NewObject<UArticyOutgoingConnection>(this, *FString::Printf(TEXT("Connection_%d'"), i));
-			conn->InitFromJson(item);
-			Connections.Add(conn);
-		}
+		OutgoingConnections.Reserve(items->Num());
+		for (const auto& item : *items)
+			OutgoingConnections.AddDefaulted_GetRef().InitFromJson(item);
+	}
+}
+
+void UArticyFlowPin::PostLoad()
+{
+	Super::PostLoad();
+
+	// Packages imported before connections were stored inline; the objects are not saved again
+	for (auto conn : LegacyConnections)
+	{
+		if (!conn)
+			continue;
+
+		FArticyPinConnection& connection = OutgoingConnections.AddDefaulted_GetRef();
+		connection.Target = conn->GetTargetID();
+		connection.TargetPin = conn->GetTargetPinID();
+		connection.Label = conn->Label;
+		connection.Color = conn->Color;
+		conn->SetFlags(RF_Transient);
 	}
+	LegacyConnections.Empty();
+}
+
+UArticyFlowPin* UArticyFlowPin::GetConnectionTarget(int32 ConnectionIndex)
+{
+	return OutgoingConnections.IsValidIndex(ConnectionIndex) ? OutgoingConnections[ConnectionIndex].GetTargetPin(UArticyDatabase::Get(this)) : nullptr;
 }
 
 UArticyObject* UArticyFlowPin::GetOwner()
 {
-	auto db = UArticyDatabase::Get(this);
-	return ensure(db) ? db->GetObject<UArticyObject>(Owner) : nullptr;
+	return GetOwner(UArticyDatabase::Get(this));
+}
+
+UArticyObject* UArticyFlowPin::GetOwner(const UArticyDatabase* Database) const
+{
+	return ensure(Database) ? Database->GetObject<UArticyObject>(Owner) : nullptr;
+}
+
+int32 UArticyFlowPin::GetScriptIndex(const UArticyExpressoScripts* Scripts, bool bInstruction) const
+{
+	if(CachedScripts != Scripts)
+	{
+		const int hash = GetTypeHash(Text);
+		CachedScriptIndex = bInstruction ? Scripts->FindInstructionIndex(hash) : Scripts->FindConditionIndex(hash);
+		CachedScripts = Scripts;
+	}
+
+	return CachedScriptIndex;
+}
+
+//---------------------------------------------------------------------------//
+
+void FArticyPinConnection::InitFromJson(TSharedPtr<FJsonValue> Json)
+{
+	if (!Json.IsValid() || !ensure(Json->Type == EJson::Object))
+		return;
+
+	auto obj = Json->AsObject();
+	JSON_TRY_HEX_ID(obj, Target);
+	JSON_TRY_HEX_ID(obj, TargetPin);
+	JSON_TRY_STRING(obj, Label);
+	Color = ArticyHelpers::ParseColorFromJson(obj->TryGetField(TEXT("Color")));
+}
+
+UArticyFlowPin* FArticyPinConnection::GetTargetPin(const UArticyDatabase* Database) const
+{
+	const uint32 Generation = UArticyDatabase::GetGeneration();
+	if (TargetGeneration != Generation || !TargetPinObj.IsValid())
+	{
+		auto target = Database ? Database->GetObject(Target) : nullptr;
+		TargetPinObj = target ? target->GetSubobject<UArticyFlowPin>(TargetPin) : nullptr;
+		TargetGeneration = Generation;
+	}
+
+	return TargetPinObj.Get();
 }
 
 //---------------------------------------------------------------------------//
@@ -44,41 +112,55 @@ UArticyObject* UArticyFlowPin::GetOwner()
 bool UArticyInputPin::Evaluate(class UArticyGlobalVariables* GV, class UObject* MethodProvider)
 {
 	auto db = UArticyDatabase::Get(this);
-	return db->GetExpressoInstance()->Evaluate(GetTypeHash(Text), GV ? GV : db->GetGVs(), MethodProvider);
+	return Evaluate(FArticyExploreContext{ db, GV ? GV : db->GetGVs(), db->GetExpressoInstance(), MethodProvider });
 }
 
-void UArticyInputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+bool UArticyInputPin::Evaluate(const FArticyExploreContext& Context)
+{
+	if (bIsConstant)
+	{
+		ARTICY_FLOW_TRACE_EVENT(ConditionEvaluated, this, bConstantResult);
+		return bConstantResult;
+	}
+
+	FArticyScriptProfileScope profileScope(this, false);
+	const bool bResult = Context.Scripts->EvaluateAt(GetScriptIndex(Context.Scripts, false), Context.GVs, Context.MethodProvider);
+	ARTICY_FLOW_TRACE_EVENT(ConditionEvaluated, this, bResult);
+	return bResult;
+}
+
+void UArticyInputPin::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
 	//evaluate first, as the evaluate method could have side-effects
-	bool bIsValid = Evaluate(Player->GetGVs(), Player->GetMethodsProvider());
+	bool bIsValid = Evaluate(Context);
 
 	//we can stop here if the branch is invalid and should be ignored
 	if(!bIsValid && Player->IgnoresInvalidBranches())
 		return;
 
-	IArticyFlowObject* owner = Cast<IArticyFlowObject>(GetOwner());
+	IArticyFlowObject* owner = Cast<IArticyFlowObject>(GetOwner(Context.Database));
 
 	if(Depth > 3 && Player->ShouldPauseOn(owner))
 	{
 		// if the owner of this input pin is a stop node, we directly continue with it instead of submerging
-		OutBranches.Append(Player->Explore(owner, false, Depth + 1));
+		OutBranches.Append(Player->Explore(Context, owner, false, Depth + 1));
 	}
-	else if(Connections.Num() > 0)
+	else if(OutgoingConnections.Num() > 0)
 	{
 		//shadow needed?
-		const auto bShadowed = Connections.Num() > 1;
+		const auto bShadowed = OutgoingConnections.Num() > 1;
 
 		//submerge
-		for(auto conn : Connections)
+		for(const auto& conn : OutgoingConnections)
 		{
-			auto target = conn->GetTargetPin();
-			OutBranches.Append( Player->Explore(target, bShadowed, Depth + 1) );
+			auto target = conn.GetTargetPin(Context.Database);
+			OutBranches.Append( Player->Explore(Context, target, bShadowed, Depth + 1) );
 		}
 	}
 	else
 	{
 		//no connections, so continue with the owner itself
-		OutBranches.Append( Player->Explore(owner, false, Depth+1) );
+		OutBranches.Append( Player->Explore(Context, owner, false, Depth+1) );
 	}
 
 	/**
@@ -98,23 +180,32 @@ void UArticyInputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>&
 void UArticyOutputPin::Execute(class UArticyGlobalVariables* GV, class UObject* MethodProvider)
 {
 	auto db = UArticyDatabase::Get(this);
-	db->GetExpressoInstance()->Execute(GetTypeHash(Text), GV ? GV : db->GetGVs(), MethodProvider);
+	Execute(FArticyExploreContext{ db, GV ? GV : db->GetGVs(), db->GetExpressoInstance(), MethodProvider });
+}
+
+void UArticyOutputPin::Execute(const FArticyExploreContext& Context)
+{
+	if (bIsConstant)
+		return;
+
+	FArticyScriptProfileScope profileScope(this, true);
+	Context.Scripts->ExecuteAt(GetScriptIndex(Context.Scripts, true), Context.GVs, Context.MethodProvider);
 }
 
-void UArticyOutputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+void UArticyOutputPin::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
-	Execute(Player->GetGVs(), Player->GetMethodsProvider());
+	Execute(Context);
 
-	if(Connections.Num() > 0)
+	if(OutgoingConnections.Num() > 0)
 	{
 		//shadow needed?
-		const auto bShadowed = Connections.Num() > 1;
+		const auto bShadowed = OutgoingConnections.Num() > 1;
 
 		//branch out
-		for(auto conn : Connections)
+		for(const auto& conn : OutgoingConnections)
 		{
-			auto target = conn->GetTargetPin();
-			OutBranches.Append( Player->Explore(target, bShadowed, Depth+1) );
+			auto target = conn.GetTargetPin(Context.Database);
+			OutBranches.Append( Player->Explore(Context, target, bShadowed, Depth+1) );
 		}
 	}
 	else
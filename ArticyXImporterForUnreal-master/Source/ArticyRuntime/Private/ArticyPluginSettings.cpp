@@ -18,10 +18,14 @@ UArticyPluginSettings::UArticyPluginSettings()
 	bKeepDatabaseBetweenWorlds = true;
 	bKeepGlobalVariablesBetweenWorlds = true;
 	bConvertUnityToUnrealRichText = false;
+	PrefetchMemoryBudgetMB = 64;
 	bVerifyArticyReferenceBeforeImport = true;
 	bUseLegacyImporter = false;
+	bReimportOnExportChange = false;
+	ExportChangeDelay = 1.f;
 
 	bSortChildrenAtGeneration = false;
+	MaxScriptFragmentsPerFile = 500;
 	ArticyDirectory.Path = TEXT("/Game");
 	// update package load settings after all files have been loaded
 	FAssetRegistryModule& AssetRegistry = FModuleManager::Get().GetModuleChecked<FAssetRegistryModule>("AssetRegistry");
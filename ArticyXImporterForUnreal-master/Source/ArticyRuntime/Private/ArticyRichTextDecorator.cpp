@@ -6,6 +6,8 @@
 #include "Blueprint/WidgetTree.h"
 #include "Components/RichTextBlock.h"
 #include "Components/PanelWidget.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
 #include "Widgets/Input/SHyperlink.h"
 #include "Interfaces/ArticyHyperlinkHandler.h"
 #include "Internationalization/Regex.h"
@@ -97,6 +99,9 @@ protected:
 		// If this isn't a link, don't use this behavior 
 		if (Reference == nullptr) { return nullptr; }
 
+		// Resolve all links while the block is populated, not when one is clicked
+		Decorator->PreResolveLink(Owner, *Reference);
+
 		// Create delegate
 		FSimpleDelegate onNavigate;
 		onNavigate.BindUObject(Decorator, &UArticyRichTextDecorator::OnArticyLinkNavigated, Owner, *Reference);
@@ -153,6 +158,14 @@ TSharedPtr<ITextDecorator> UArticyRichTextDecorator::CreateDecorator(URichTextBl
  */
 UObject* UArticyRichTextDecorator::GetHyperlinkHandler(URichTextBlock* RichTextBlock)
 {
+	const TWeakObjectPtr<URichTextBlock> Key = RichTextBlock;
+	if (const TWeakObjectPtr<UObject>* Cached = HyperlinkHandlers.Find(Key))
+	{
+		// The handler is looked up again once it was destroyed, a block without one keeps checking
+		if (Cached->IsValid())
+			return Cached->Get();
+	}
+
 	UWidget* Widget = RichTextBlock;
 	while (Widget != nullptr && !Widget->GetClass()->ImplementsInterface(UArticyHyperlinkHandler::StaticClass()))
 	{
@@ -171,6 +184,8 @@ UObject* UArticyRichTextDecorator::GetHyperlinkHandler(URichTextBlock* RichTextB
 	// No widget in the hierarchy implements the handler interface.
 	if (Widget == nullptr) { return nullptr; }
 
+	HyperlinkHandlers.Add(Key, Widget);
+
 	// Return interface
 	return Widget;
 }
@@ -184,18 +199,53 @@ UObject* UArticyRichTextDecorator::GetHyperlinkHandler(URichTextBlock* RichTextB
  */
 UArticyObject* UArticyRichTextDecorator::GetLinkDestination(URichTextBlock* Owner, const FString& Link)
 {
-	static FRegexPattern Pattern(TEXT("articy:\\/\\/localhost\\/view\\/~\\/(\\d+)"));
-	FRegexMatcher myMatcher(Pattern, Link);
+	FResolvedLink* Resolved = ResolvedLinks.Find(Link);
+	if (!Resolved)
+	{
+		Resolved = &ResolvedLinks.Add(Link);
+
+		static FRegexPattern Pattern(TEXT("articy:\\/\\/localhost\\/view\\/~\\/(\\d+)"));
+		FRegexMatcher myMatcher(Pattern, Link);
+
+		// If the link matches the expected format, get the numeric id
+		if (myMatcher.FindNext())
+		{
+			FString Id = myMatcher.GetCaptureGroup(1);
+			Resolved->Id = FCString::Strtoui64(*Id, nullptr, 10);
+			Resolved->bIsArticyLink = true;
+		}
+	}
 
 	// If the link doesn't match the expected format, abort.
-	if (!myMatcher.FindNext()) { return nullptr; }
+	if (!Resolved->bIsArticyLink) { return nullptr; }
 
-	// Get numeric id
-	FString Id = myMatcher.GetCaptureGroup(1);
-	uint64 id = FCString::Strtoui64(*Id, nullptr, 10);
+	// Database clones and loaded packages change what an id resolves to
+	const UObject* World = GEngine->GetWorldFromContextObject(Owner, EGetWorldErrorMode::ReturnNull);
+	if (Resolved->Object.IsValid() && Resolved->World.Get() == World && Resolved->Generation == UArticyDatabase::GetGeneration())
+		return Resolved->Object.Get();
 
 	// Resolve
-	return UArticyDatabase::Get(Owner)->GetObject(id);
+	UArticyObject* Object = UArticyDatabase::Get(Owner)->GetObject(Resolved->Id);
+	Resolved->Object = Object;
+	Resolved->World = World;
+	Resolved->Generation = UArticyDatabase::GetGeneration();
+	return Object;
+}
+
+/**
+ * Resolves a link and the hyperlink handler of a rich text block ahead of navigation.
+ *
+ * @param Owner The owning rich text block.
+ * @param Link The URL to resolve.
+ */
+void UArticyRichTextDecorator::PreResolveLink(URichTextBlock* Owner, const FString& Link)
+{
+	// The designer previews blocks without a database
+	const UWorld* World = GEngine->GetWorldFromContextObject(Owner, EGetWorldErrorMode::ReturnNull);
+	if (!World || !World->IsGameWorld()) { return; }
+
+	GetHyperlinkHandler(Owner);
+	GetLinkDestination(Owner, Link);
 }
 
 /**
@@ -0,0 +1,346 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyRuntimeConsoleCommands.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyFlowRecording.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyRuntimeStats.h"
+#include "ArticySnapshot.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+#define LOCTEXT_NAMESPACE "ArticyRuntime"
+
+namespace
+{
+	/** Seconds between two CSV rows if not given. */
+	constexpr float DefaultCsvInterval = 10.0f;
+
+	/** The numbers of all worlds added up, one CSV row. */
+	struct FStatsSample
+	{
+		int32 NumDatabases = 0;
+		int32 NumPackages = 0;
+		int32 NumObjects = 0;
+		int32 NumRuntimeCopies = 0;
+		int32 NumClones = 0;
+		int64 PackageBytes = 0;
+		int32 NumGlobalVariables = 0;
+		int32 NumVariableSets = 0;
+		int32 NumVariables = 0;
+		int64 VariableBytes = 0;
+		int32 NumShadowedValues = 0;
+		int32 NumFlowPlayers = 0;
+	};
+
+	/** The original assets and class defaults are never played, only their copies. */
+	bool IsRuntimeInstance(const UObject* Object)
+	{
+		return IsValid(Object) && !Object->IsTemplate() && !Object->IsAsset();
+	}
+
+	FString FormatHitRate(FArticyRuntimeStats::ECounter Hits, FArticyRuntimeStats::ECounter Misses)
+	{
+		const int64 NumHits = FArticyRuntimeStats::GetTotal(Hits);
+		const int64 NumLookups = NumHits + FArticyRuntimeStats::GetTotal(Misses);
+		if (NumLookups == 0)
+			return TEXT("no lookups");
+		return FString::Printf(TEXT("%.1f%% of %lld lookups"), 100.0 * NumHits / NumLookups, NumLookups);
+	}
+
+	const TCHAR* GetStepName(FArticyFlowRecording::EStepType Type)
+	{
+		switch (Type)
+		{
+		case FArticyFlowRecording::EStepType::SetCursor: return TEXT("SetCursor");
+		case FArticyFlowRecording::EStepType::PlayBranch: return TEXT("PlayBranch");
+		case FArticyFlowRecording::EStepType::FinishPausedObject: return TEXT("FinishPausedObject");
+		case FArticyFlowRecording::EStepType::SetRandomSeed: return TEXT("SetRandomSeed");
+		}
+		return TEXT("Unknown");
+	}
+
+	/**
+	 * Gathers the state of all runtime databases, variable sets and flow players.
+	 * @param Ar If set, the state of each of them is printed to it.
+	 * @return The numbers added up.
+	 */
+	FStatsSample GatherStats(FOutputDevice* Ar)
+	{
+		FStatsSample Sample;
+
+		for (TObjectIterator<UArticyDatabase> It; It; ++It)
+		{
+			const UArticyDatabase* Database = *It;
+			if (!IsRuntimeInstance(Database))
+				continue;
+
+			const UArticyDatabase::FRuntimeStats Stats = Database->GetRuntimeStats(true);
+			++Sample.NumDatabases;
+			Sample.NumPackages += Stats.Packages.Num();
+			Sample.NumObjects += Stats.NumObjects;
+			Sample.NumRuntimeCopies += Stats.NumRuntimeCopies;
+			Sample.NumClones += Stats.NumClones;
+			Sample.NumShadowedValues += Stats.NumShadowedValues;
+
+			if (Ar)
+			{
+				Ar->Logf(TEXT("Database of %s: %d packages, %d objects, %d runtime copies, %d clones, shadow level %u, %d shadowed properties"),
+					*GetNameSafe(Database->GetWorld()), Stats.Packages.Num(), Stats.NumObjects, Stats.NumRuntimeCopies, Stats.NumClones,
+					Stats.ShadowLevel, Stats.NumShadowedValues);
+			}
+
+			for (const UArticyDatabase::FRuntimeStats::FPackage& Package : Stats.Packages)
+			{
+				Sample.PackageBytes += Package.Bytes;
+				if (Ar)
+					Ar->Logf(TEXT("    %s: %d objects, %.1f KB"), *Package.Name, Package.NumObjects, Package.Bytes / 1024.0);
+			}
+		}
+
+		for (TObjectIterator<UArticyGlobalVariables> It; It; ++It)
+		{
+			UArticyGlobalVariables* GlobalVariables = *It;
+			if (!IsRuntimeInstance(GlobalVariables))
+				continue;
+
+			const TArray<UArticyBaseVariableSet*> Sets = GlobalVariables->GetVariableSets();
+			int32 NumVariables = 0;
+			for (const UArticyBaseVariableSet* Set : Sets)
+			{
+				if (Set)
+					NumVariables += Set->GetVariables().Num();
+			}
+			const int64 Bytes = GlobalVariables->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+
+			++Sample.NumGlobalVariables;
+			Sample.NumVariableSets += Sets.Num();
+			Sample.NumVariables += NumVariables;
+			Sample.VariableBytes += Bytes;
+			Sample.NumShadowedValues += GlobalVariables->GetNumUndos();
+
+			if (Ar)
+			{
+				Ar->Logf(TEXT("Global variables %s: %d sets, %d variables, %.1f KB, shadow level %u, %d shadowed values"),
+					*GlobalVariables->GetName(), Sets.Num(), NumVariables, Bytes / 1024.0, GlobalVariables->GetShadowLevel(), GlobalVariables->GetNumUndos());
+			}
+		}
+
+		for (TObjectIterator<UArticyFlowPlayer> It; It; ++It)
+		{
+			if (IsRuntimeInstance(*It) && It->GetWorld())
+				++Sample.NumFlowPlayers;
+		}
+
+		if (Ar)
+		{
+			Ar->Logf(TEXT("Flow players: %d"), Sample.NumFlowPlayers);
+			Ar->Logf(TEXT("Text cache: %s"), *FormatHitRate(FArticyRuntimeStats::ECounter::TextCacheHits, FArticyRuntimeStats::ECounter::TextCacheMisses));
+			Ar->Logf(TEXT("Ref cache: %s"), *FormatHitRate(FArticyRuntimeStats::ECounter::RefCacheHits, FArticyRuntimeStats::ECounter::RefCacheMisses));
+		}
+
+		return Sample;
+	}
+}
+
+/**
+ * Registers the console commands and starts CSV logging if requested on the command line.
+ * @param InModule The ArticyRuntimeModule instance for which console commands are defined.
+ */
+FArticyRuntimeConsoleCommands::FArticyRuntimeConsoleCommands(const FArticyRuntimeModule& InModule)
+	: Module(InModule)
+
+	, StatsCommand(
+		TEXT("Articy.Stats"),
+		*LOCTEXT("CommandText_Stats", "Prints the loaded packages, objects, global variables, shadow state, cache hit rates and flow players. \"csv [Seconds]\" logs them to a CSV file periodically, \"csv off\" stops.").ToString(),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateRaw(this, &FArticyRuntimeConsoleCommands::Stats))
+
+	, ReplayFlowCommand(
+		TEXT("Articy.ReplayFlow"),
+		*LOCTEXT("CommandText_ReplayFlow", "Replays a flow recording on a new flow player and prints the time of each step. Arguments: <File> [Repeat]").ToString(),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateRaw(this, &FArticyRuntimeConsoleCommands::ReplayFlow))
+{
+	float Interval = DefaultCsvInterval;
+	if (FParse::Value(FCommandLine::Get(), TEXT("csvDialogueStats="), Interval) || FParse::Param(FCommandLine::Get(), TEXT("csvDialogueStats")))
+		StartCsv(Interval);
+}
+
+FArticyRuntimeConsoleCommands::~FArticyRuntimeConsoleCommands()
+{
+	StopCsv();
+}
+
+/**
+ * Prints the state of the runtime, or starts or stops CSV logging.
+ * @param Args Empty to print, "csv [Seconds]" to start CSV logging, "csv off" to stop it.
+ * @param World The world the command was run in, unused as all worlds are reported.
+ * @param Ar The device to print to.
+ */
+void FArticyRuntimeConsoleCommands::Stats(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+	if (Args.Num() == 0)
+	{
+		GatherStats(&Ar);
+		return;
+	}
+
+	if (!Args[0].Equals(TEXT("csv"), ESearchCase::IgnoreCase))
+	{
+		Ar.Logf(TEXT("Usage: Articy.Stats [csv [Seconds|off]]"));
+		return;
+	}
+
+	if (Args.Num() > 1 && Args[1].Equals(TEXT("off"), ESearchCase::IgnoreCase))
+	{
+		StopCsv();
+		return;
+	}
+
+	StopCsv();
+	StartCsv(Args.Num() > 1 ? FCString::Atof(*Args[1]) : DefaultCsvInterval);
+	Ar.Logf(TEXT("Logging articy stats to %s"), *CsvPath);
+}
+
+/**
+ * Replays a flow recording on a new flow player and prints the median and maximum time of each step.
+ * @param Args The recording file and optionally the number of times to replay it.
+ * @param World The world whose database and global variables are replayed on.
+ * @param Ar The device to print to.
+ */
+void FArticyRuntimeConsoleCommands::ReplayFlow(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+	if (Args.Num() == 0)
+	{
+		Ar.Logf(TEXT("Usage: Articy.ReplayFlow <File> [Repeat]"));
+		return;
+	}
+
+	FArticyFlowRecording Recording;
+	if (!World || !World->GetWorldSettings() || !Recording.LoadFromFile(Args[0]))
+	{
+		Ar.Logf(TEXT("Could not replay %s"), *Args[0]);
+		return;
+	}
+	const int32 Repeat = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1;
+
+	// the player is never registered, so it doesn't tick and the replay commits its branches
+	UArticyFlowPlayer* Player = NewObject<UArticyFlowPlayer>(World->GetWorldSettings(), NAME_None, RF_Transient);
+	UArticyDatabase* Database = UArticyDatabase::Get(Player);
+	UArticyGlobalVariables* GlobalVariables = Player->GetGVs();
+
+	TArray<uint8> WorldState;
+	if (!FArticySnapshot::Save(WorldState, GlobalVariables, Database, {}))
+	{
+		Ar.Logf(TEXT("Could not save the dialogue state of %s"), *World->GetName());
+		return;
+	}
+
+	const int32 NumSteps = Recording.Steps.Num();
+	TArray<double> Samples;
+	Samples.Reserve(NumSteps * Repeat);
+	int32 NumMismatches = 0;
+
+	FArticyFlowReplay Replay;
+	for (int32 i = 0; i < Repeat; ++i)
+	{
+		if (!Replay.Run(Recording, Player))
+		{
+			Ar.Logf(TEXT("Could not restore the initial state of %s"), *Args[0]);
+			break;
+		}
+		Samples.Append(Replay.StepMicroseconds);
+		NumMismatches += Replay.NumMismatches;
+	}
+
+	FArticySnapshot::Load(WorldState, GlobalVariables, Database, {});
+
+	const int32 NumRuns = NumSteps > 0 ? Samples.Num() / NumSteps : 0;
+	if (NumRuns == 0)
+		return;
+
+	double Total = 0.0;
+	TArray<double> StepSamples;
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		StepSamples.Reset(NumRuns);
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+			StepSamples.Add(Samples[Run * NumSteps + Step]);
+		StepSamples.Sort();
+
+		Total += StepSamples[NumRuns / 2];
+		Ar.Logf(TEXT("%4d %-18s median %8.1f us, max %8.1f us"), Step, GetStepName(Recording.Steps[Step].Type), StepSamples[NumRuns / 2], StepSamples.Last());
+	}
+	Ar.Logf(TEXT("%d steps replayed %d times, %.1f us per replay, %d mismatched steps"), NumSteps, NumRuns, Total, NumMismatches / NumRuns);
+}
+
+/**
+ * Starts appending a row to a new CSV file every Interval seconds.
+ * @param Interval Seconds between two rows.
+ */
+void FArticyRuntimeConsoleCommands::StartCsv(float Interval)
+{
+	if (Interval <= 0.0f)
+		Interval = DefaultCsvInterval;
+
+	CsvPath = FPaths::ProfilingDir() / FString::Printf(TEXT("ArticyStats-%s.csv"), *FDateTime::Now().ToString());
+	const FString Header = TEXT("Seconds,Databases,Packages,Objects,RuntimeCopies,Clones,PackageKB,GlobalVariables,VariableSets,Variables,VariableKB,ShadowedValues,FlowPlayers,TextCacheHits,TextCacheMisses,RefCacheHits,RefCacheMisses\n");
+	if (!FFileHelper::SaveStringToFile(Header, *CsvPath))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to create the stats file %s"), *CsvPath);
+		CsvPath.Reset();
+		return;
+	}
+
+	CsvHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FArticyRuntimeConsoleCommands::WriteCsvRow), Interval);
+	UE_LOG(LogArticyRuntime, Log, TEXT("Logging articy stats every %.1f seconds to %s"), Interval, *CsvPath);
+}
+
+void FArticyRuntimeConsoleCommands::StopCsv()
+{
+	if (CsvHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(CsvHandle);
+		CsvHandle.Reset();
+	}
+	CsvPath.Reset();
+}
+
+/**
+ * Appends a row to the CSV file.
+ * @param DeltaTime Seconds since the last row.
+ * @return True to keep logging.
+ */
+bool FArticyRuntimeConsoleCommands::WriteCsvRow(float DeltaTime)
+{
+	using ECounter = FArticyRuntimeStats::ECounter;
+
+	const FStatsSample Sample = GatherStats(nullptr);
+	const FString Row = FString::Printf(TEXT("%.1f,%d,%d,%d,%d,%d,%.1f,%d,%d,%d,%.1f,%d,%d,%lld,%lld,%lld,%lld\n"),
+		FPlatformTime::Seconds() - GStartTime, Sample.NumDatabases, Sample.NumPackages, Sample.NumObjects, Sample.NumRuntimeCopies,
+		Sample.NumClones, Sample.PackageBytes / 1024.0, Sample.NumGlobalVariables, Sample.NumVariableSets, Sample.NumVariables,
+		Sample.VariableBytes / 1024.0, Sample.NumShadowedValues, Sample.NumFlowPlayers,
+		FArticyRuntimeStats::GetTotal(ECounter::TextCacheHits), FArticyRuntimeStats::GetTotal(ECounter::TextCacheMisses),
+		FArticyRuntimeStats::GetTotal(ECounter::RefCacheHits), FArticyRuntimeStats::GetTotal(ECounter::RefCacheMisses));
+
+	// The file is kept closed between rows, so a crashed soak test still leaves every row written
+	if (!FFileHelper::SaveStringToFile(Row, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to write to the stats file %s, logging stopped"), *CsvPath);
+		CsvHandle.Reset();
+		CsvPath.Reset();
+		return false;
+	}
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
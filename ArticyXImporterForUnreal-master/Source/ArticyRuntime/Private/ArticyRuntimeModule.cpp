@@ -3,6 +3,7 @@
 //
 
 #include "ArticyRuntimeModule.h"
+#include "ArticyRuntimeConsoleCommands.h"
 #include "Internationalization/StringTableRegistry.h"
 #include "Misc/Paths.h"
 #include "HAL/PlatformFileManager.h"
@@ -12,6 +13,7 @@
 
 #if WITH_EDITOR
 #include "Editor.h"
+#include "ArticyObject.h"
 #endif
 
 DEFINE_LOG_CATEGORY(LogArticyRuntime)
@@ -19,19 +21,29 @@ DEFINE_LOG_CATEGORY(LogArticyRuntime)
 /**
  * Called when the module is loaded into memory.
  * This is where you should initialize any resources or set up any state necessary for your module.
- * Currently, this method does not perform any actions.
+ * Registers the console commands of the runtime.
  */
 void FArticyRuntimeModule::StartupModule()
 {
+	ConsoleCommands = new FArticyRuntimeConsoleCommands(*this);
 }
 
 /**
  * Called when the module is unloaded from memory.
  * This is where you should clean up any resources or state that was initialized in StartupModule.
- * Currently, this method does not perform any actions.
+ * Drops the editor's asset index of articy objects and the console commands.
  */
 void FArticyRuntimeModule::ShutdownModule()
 {
+	if (ConsoleCommands != nullptr)
+	{
+		delete ConsoleCommands;
+		ConsoleCommands = nullptr;
+	}
+
+#if WITH_EDITOR
+	UArticyObject::ResetAssetIndex();
+#endif
 }
 
 IMPLEMENT_MODULE(FArticyRuntimeModule, ArticyRuntime)
@@ -0,0 +1,114 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyRuntimeStats.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(ArticyRuntimeChannel);
+#if ARTICY_GV_LOGGING
+UE_TRACE_CHANNEL_DEFINE(ArticyVariablesChannel);
+#endif
+
+// Children are named and parented after their unique name, Articy_Packages is Articy/Packages
+LLM_DEFINE_TAG(Articy);
+LLM_DEFINE_TAG(Articy_Database);
+LLM_DEFINE_TAG(Articy_Packages);
+LLM_DEFINE_TAG(Articy_GlobalVariables);
+LLM_DEFINE_TAG(Articy_Shadows);
+LLM_DEFINE_TAG(Articy_Text);
+
+DEFINE_STAT(STAT_ArticyExplore);
+DEFINE_STAT(STAT_ArticyShadowedOperation);
+DEFINE_STAT(STAT_ArticyEvaluate);
+DEFINE_STAT(STAT_ArticyExecute);
+DEFINE_STAT(STAT_ArticyResolveText);
+DEFINE_STAT(STAT_ArticyLoadPackage);
+DEFINE_STAT(STAT_ArticyUnloadPackage);
+
+DEFINE_STAT(STAT_ArticyNodesVisited);
+DEFINE_STAT(STAT_ArticyConditionsEvaluated);
+DEFINE_STAT(STAT_ArticyShadowPushes);
+DEFINE_STAT(STAT_ArticyObjectsDuplicated);
+DEFINE_STAT(STAT_ArticyBranchesProduced);
+DEFINE_STAT(STAT_ArticyTextCacheHits);
+DEFINE_STAT(STAT_ArticyTextCacheMisses);
+DEFINE_STAT(STAT_ArticyRefCacheHits);
+DEFINE_STAT(STAT_ArticyRefCacheMisses);
+
+TRACE_DECLARE_INT_COUNTER(ArticyNodesVisited, TEXT("Articy/NodesVisited"));
+TRACE_DECLARE_INT_COUNTER(ArticyConditionsEvaluated, TEXT("Articy/ConditionsEvaluated"));
+TRACE_DECLARE_INT_COUNTER(ArticyShadowPushes, TEXT("Articy/ShadowPushes"));
+TRACE_DECLARE_INT_COUNTER(ArticyObjectsDuplicated, TEXT("Articy/ObjectsDuplicated"));
+TRACE_DECLARE_INT_COUNTER(ArticyBranchesProduced, TEXT("Articy/BranchesProduced"));
+TRACE_DECLARE_INT_COUNTER(ArticyTextCacheHits, TEXT("Articy/TextCacheHits"));
+TRACE_DECLARE_INT_COUNTER(ArticyTextCacheMisses, TEXT("Articy/TextCacheMisses"));
+TRACE_DECLARE_INT_COUNTER(ArticyRefCacheHits, TEXT("Articy/RefCacheHits"));
+TRACE_DECLARE_INT_COUNTER(ArticyRefCacheMisses, TEXT("Articy/RefCacheMisses"));
+
+namespace
+{
+	int64 Totals[(int32)FArticyRuntimeStats::ECounter::Num] = {};
+}
+
+/**
+ * Adds to a counter of stat Articy and its running total in Unreal Insights.
+ * @param Counter The counter to add to.
+ * @param Delta The amount to add.
+ */
+void FArticyRuntimeStats::AddCount(ECounter Counter, int64 Delta)
+{
+	switch (Counter)
+	{
+	case ECounter::NodesVisited:
+		INC_DWORD_STAT_BY(STAT_ArticyNodesVisited, Delta);
+		TRACE_COUNTER_ADD(ArticyNodesVisited, Delta);
+		break;
+	case ECounter::ConditionsEvaluated:
+		INC_DWORD_STAT_BY(STAT_ArticyConditionsEvaluated, Delta);
+		TRACE_COUNTER_ADD(ArticyConditionsEvaluated, Delta);
+		break;
+	case ECounter::ShadowPushes:
+		INC_DWORD_STAT_BY(STAT_ArticyShadowPushes, Delta);
+		TRACE_COUNTER_ADD(ArticyShadowPushes, Delta);
+		break;
+	case ECounter::ObjectsDuplicated:
+		INC_DWORD_STAT_BY(STAT_ArticyObjectsDuplicated, Delta);
+		TRACE_COUNTER_ADD(ArticyObjectsDuplicated, Delta);
+		break;
+	case ECounter::BranchesProduced:
+		INC_DWORD_STAT_BY(STAT_ArticyBranchesProduced, Delta);
+		TRACE_COUNTER_ADD(ArticyBranchesProduced, Delta);
+		break;
+	case ECounter::TextCacheHits:
+		INC_DWORD_STAT_BY(STAT_ArticyTextCacheHits, Delta);
+		TRACE_COUNTER_ADD(ArticyTextCacheHits, Delta);
+		break;
+	case ECounter::TextCacheMisses:
+		INC_DWORD_STAT_BY(STAT_ArticyTextCacheMisses, Delta);
+		TRACE_COUNTER_ADD(ArticyTextCacheMisses, Delta);
+		break;
+	case ECounter::RefCacheHits:
+		INC_DWORD_STAT_BY(STAT_ArticyRefCacheHits, Delta);
+		TRACE_COUNTER_ADD(ArticyRefCacheHits, Delta);
+		break;
+	case ECounter::RefCacheMisses:
+		INC_DWORD_STAT_BY(STAT_ArticyRefCacheMisses, Delta);
+		TRACE_COUNTER_ADD(ArticyRefCacheMisses, Delta);
+		break;
+	default:
+		return;
+	}
+
+	Totals[(int32)Counter] += Delta;
+}
+
+/**
+ * Gets the running total of a counter since the module was loaded.
+ * @param Counter The counter to get.
+ * @return The sum of everything added to the counter.
+ */
+int64 FArticyRuntimeStats::GetTotal(ECounter Counter)
+{
+	return Counter < ECounter::Num ? Totals[(int32)Counter] : 0;
+}
@@ -4,6 +4,9 @@
 
 #include "ArticyScriptFragment.h"
 #include "ArticyExpressoScripts.h"
+#include "ArticyHelpers.h"
+#include "ArticyFlowTrace.h"
+#include "ArticyScriptProfiler.h"
 
 /**
  * Computes and returns a hash of the expression.
@@ -19,6 +22,25 @@ int UArticyScriptFragment::GetExpressionHash() const
     return CachedExpressionHash;
 }
 
+/**
+ * Returns the index of the expression in the jump table of the expresso scripts.
+ * The index is looked up by the expression hash once per expresso scripts instance.
+ *
+ * @param Scripts The expresso scripts instance that runs the expression.
+ * @param bInstruction Whether to look the expression up as an instruction or as a condition.
+ * @return The index of the expression, or INDEX_NONE if it was not generated.
+ */
+int32 UArticyScriptFragment::GetScriptIndex(const UArticyExpressoScripts* Scripts, bool bInstruction) const
+{
+    if (CachedScripts != Scripts)
+    {
+        CachedScriptIndex = bInstruction ? Scripts->FindInstructionIndex(GetExpressionHash()) : Scripts->FindConditionIndex(GetExpressionHash());
+        CachedScripts = Scripts;
+    }
+
+    return CachedScriptIndex;
+}
+
 /**
  * Initializes the script fragment from a JSON value.
  * This method parses the JSON value and sets the expression if the JSON is valid.
@@ -36,6 +58,8 @@ void UArticyScriptFragment::InitFromJson(TSharedPtr<FJsonValue> Json)
     auto exp = Json->AsString();
     if (!exp.IsEmpty())
         Expression = *exp;
+
+    bHasSideEffects = ArticyHelpers::ScriptHasSideEffects(Expression);
 }
 
 //---------------------------------------------------------------------------//
@@ -51,7 +75,20 @@ void UArticyScriptFragment::InitFromJson(TSharedPtr<FJsonValue> Json)
 bool UArticyScriptCondition::Evaluate(class UArticyGlobalVariables* GV, class UObject* MethodProvider)
 {
     auto db = UArticyDatabase::Get(this);
-    return db->GetExpressoInstance()->Evaluate(GetExpressionHash(), GV ? GV : db->GetGVs(), MethodProvider);
+    return Evaluate(FArticyExploreContext{ db, GV ? GV : db->GetGVs(), db->GetExpressoInstance(), MethodProvider });
+}
+
+/**
+ * Evaluates the script condition with the scripts, GVs and methods provider of an exploration,
+ * without looking up the database.
+ *
+ * @param Context The context of the exploration.
+ * @return True if the condition evaluates to true, false otherwise.
+ */
+bool UArticyScriptCondition::Evaluate(const FArticyExploreContext& Context)
+{
+    FArticyScriptProfileScope profileScope(this, false);
+    return Context.Scripts->EvaluateAt(GetScriptIndex(Context.Scripts, false), Context.GVs, Context.MethodProvider);
 }
 
 /**
@@ -72,24 +109,27 @@ bool UArticyCondition::Evaluate(UArticyGlobalVariables* GV, UObject* MethodProvi
  * The exploration follows the output pins based on the condition evaluation result.
  *
  * @param Player A pointer to the flow player handling the exploration.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
  * @param OutBranches An array to which the resulting branches are appended.
  * @param Depth The current depth of exploration.
  */
-void UArticyCondition::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+void UArticyCondition::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
     auto pins = GetOutputPinsPtr();
     if (!pins || !ensure(pins->Num() == 2))
     {
         // Conditions MUST have 2 output pins!
         // Continue on output pins, will also handle the case where pins are not valid
-        Super::Explore(Player, OutBranches, Depth);
+        Super::Explore(Player, Context, OutBranches, Depth);
         return;
     }
 
-    if (Evaluate(Player->GetGVs(), Player->GetMethodsProvider()))
-        OutBranches.Append(Player->Explore((*pins)[0], false, Depth + 1)); // TRUE
+    const bool bResult = !GetCondition() || GetCondition()->Evaluate(Context);
+    ARTICY_FLOW_TRACE_EVENT(ConditionEvaluated, this, bResult);
+    if (bResult)
+        OutBranches.Append(Player->Explore(Context, (*pins)[0], false, Depth + 1)); // TRUE
     else
-        OutBranches.Append(Player->Explore((*pins)[1], false, Depth + 1)); // FALSE
+        OutBranches.Append(Player->Explore(Context, (*pins)[1], false, Depth + 1)); // FALSE
 }
 
 //---------------------------------------------------------------------------//
@@ -104,7 +144,19 @@ void UArticyCondition::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>&
 void UArticyScriptInstruction::Execute(class UArticyGlobalVariables* GV, class UObject* MethodProvider)
 {
     auto db = UArticyDatabase::Get(this);
-    db->GetExpressoInstance()->Execute(GetExpressionHash(), GV ? GV : db->GetGVs(), MethodProvider);
+    Execute(FArticyExploreContext{ db, GV ? GV : db->GetGVs(), db->GetExpressoInstance(), MethodProvider });
+}
+
+/**
+ * Executes the script instruction with the scripts, GVs and methods provider of an exploration,
+ * without looking up the database.
+ *
+ * @param Context The context of the exploration.
+ */
+void UArticyScriptInstruction::Execute(const FArticyExploreContext& Context)
+{
+    FArticyScriptProfileScope profileScope(this, true);
+    Context.Scripts->ExecuteAt(GetScriptIndex(Context.Scripts, true), Context.GVs, Context.MethodProvider);
 }
 
 /**
@@ -159,13 +211,15 @@ void UArticyInstruction::Execute(UArticyGlobalVariables* GV, UObject* MethodProv
  * The exploration continues on the output pins after executing the instruction.
  *
  * @param Player A pointer to the flow player handling the exploration.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
  * @param OutBranches An array to which the resulting branches are appended.
  * @param Depth The current depth of exploration.
  */
-void UArticyInstruction::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+void UArticyInstruction::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
-    Execute(Player->GetGVs(), Player->GetMethodsProvider());
+    if (GetInstruction())
+        GetInstruction()->Execute(Context);
 
     // Continue on output pins
-    Super::Explore(Player, OutBranches, Depth);
+    Super::Explore(Player, Context, OutBranches, Depth);
 }
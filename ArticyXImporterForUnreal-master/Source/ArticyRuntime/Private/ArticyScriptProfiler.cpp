@@ -0,0 +1,206 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyScriptProfiler.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyObject.h"
+#include "ArticyPins.h"
+#include "ArticyScriptFragment.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+bool FArticyScriptProfiler::bEnabled = false;
+TMap<uint64, FArticyScriptProfiler::FRecord> FArticyScriptProfiler::Records;
+FArticyScriptCapture* FArticyScriptProfiler::Capture = nullptr;
+
+namespace
+{
+	/** Gets the expression of a fragment or pin. */
+	const FString* GetExpression(const UObject* Site)
+	{
+		if (const UArticyScriptFragment* Fragment = Cast<UArticyScriptFragment>(Site))
+			return &Fragment->GetExpression();
+		if (const UArticyFlowPin* Pin = Cast<UArticyFlowPin>(Site))
+			return &Pin->Text;
+		return nullptr;
+	}
+
+	FString DescribeOwner(const UObject* Site)
+	{
+		const UArticyObject* Owner = nullptr;
+		if (const UArticyFlowPin* Pin = Cast<UArticyFlowPin>(Site))
+			Owner = const_cast<UArticyFlowPin*>(Pin)->GetOwner();
+
+		// Fragments are subobjects of the node they belong to
+		for (const UObject* Outer = Site; Outer && !Owner; Outer = Outer->GetOuter())
+			Owner = Cast<UArticyObject>(Outer);
+
+		if (!Owner)
+			return Site->GetName();
+
+		return FString::Printf(TEXT("%s (%s)"), *Owner->GetTechnicalName().ToString(), *Owner->GetId().ToString());
+	}
+
+	FString EscapeCsv(const FString& Value)
+	{
+		return TEXT("\"") + Value.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+	}
+
+	FAutoConsoleCommand StartCommand(
+		TEXT("Articy.ScriptProfiler.Start"),
+		TEXT("Starts timing the expresso script fragments."),
+		FConsoleCommandDelegate::CreateLambda([] { FArticyScriptProfiler::SetEnabled(true); }));
+
+	FAutoConsoleCommand StopCommand(
+		TEXT("Articy.ScriptProfiler.Stop"),
+		TEXT("Stops timing the expresso script fragments, the records are kept."),
+		FConsoleCommandDelegate::CreateLambda([] { FArticyScriptProfiler::SetEnabled(false); }));
+
+	FAutoConsoleCommand ResetCommand(
+		TEXT("Articy.ScriptProfiler.Reset"),
+		TEXT("Forgets the records of the script profiler."),
+		FConsoleCommandDelegate::CreateLambda([] { FArticyScriptProfiler::Reset(); }));
+
+	FAutoConsoleCommand DumpCommand(
+		TEXT("Articy.ScriptProfiler.Dump"),
+		TEXT("Logs the most expensive script fragments and writes all records as CSV. Optional argument: the file to write."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const TArray<FArticyScriptProfiler::FRecord> Sorted = FArticyScriptProfiler::GetSortedRecords();
+			for (int32 i = 0; i < FMath::Min(Sorted.Num(), 10); ++i)
+			{
+				const FArticyScriptProfiler::FRecord& Record = Sorted[i];
+				UE_LOG(LogArticyRuntime, Display, TEXT("%8.3fms total %8.3fms max x%lld  %s: %s"), Record.TotalSeconds * 1000.0,
+					Record.MaxSeconds * 1000.0, Record.Calls, *Record.Owner, *Record.Expression);
+			}
+
+			const FString Path = FArticyScriptProfiler::DumpCsv(Args.Num() > 0 ? Args[0] : FString());
+			if (!Path.IsEmpty())
+				UE_LOG(LogArticyRuntime, Display, TEXT("Wrote %d script profiler records to %s"), Sorted.Num(), *Path);
+		}));
+}
+
+/**
+ * Forgets all records.
+ */
+void FArticyScriptProfiler::Reset()
+{
+	Records.Reset();
+}
+
+/**
+ * Records one run of a fragment in the active capture and, while enabled, in the profiler.
+ * The expression and owner are only looked up on its first run.
+ * @param Site The script fragment or pin that ran.
+ * @param bInstruction Whether the fragment ran as an instruction.
+ * @param Seconds The time the run took.
+ */
+void FArticyScriptProfiler::Record(const UObject* Site, bool bInstruction, double Seconds)
+{
+	if (Capture)
+	{
+		FArticyScriptCapture::FSite& CapturedSite = Capture->Sites.FindOrAdd(Site);
+		CapturedSite.bInstruction = bInstruction;
+		++CapturedSite.Calls;
+		CapturedSite.TotalSeconds += Seconds;
+		CapturedSite.MaxSeconds = FMath::Max(CapturedSite.MaxSeconds, Seconds);
+	}
+
+	if (!bEnabled)
+		return;
+
+	const FString* Expression = GetExpression(Site);
+	if (!Expression)
+		return;
+
+	const uint32 Hash = GetTypeHash(*Expression);
+	const uint64 Key = static_cast<uint64>(Hash) | (bInstruction ? 1ull << 32 : 0);
+
+	FRecord* Record = Records.Find(Key);
+	if (!Record)
+	{
+		Record = &Records.Add(Key);
+		Record->Expression = *Expression;
+		Record->Owner = DescribeOwner(Site);
+		Record->Hash = Hash;
+		Record->bInstruction = bInstruction;
+	}
+
+	++Record->Calls;
+	Record->TotalSeconds += Seconds;
+	Record->MaxSeconds = FMath::Max(Record->MaxSeconds, Seconds);
+}
+
+/**
+ * Gets the records, most expensive in total first.
+ * @return The records.
+ */
+TArray<FArticyScriptProfiler::FRecord> FArticyScriptProfiler::GetSortedRecords()
+{
+	TArray<FRecord> Sorted;
+	Records.GenerateValueArray(Sorted);
+	Sorted.Sort([](const FRecord& A, const FRecord& B) { return A.TotalSeconds > B.TotalSeconds; });
+	return Sorted;
+}
+
+/**
+ * Gets the most expensive sites of a capture in total first, described like the records of the profiler.
+ * @param MaxRecords The number of sites to return at most.
+ * @return The records.
+ */
+TArray<FArticyScriptProfiler::FRecord> FArticyScriptCapture::GetSortedRecords(int32 MaxRecords) const
+{
+	TArray<TPair<const UObject*, FSite>> Sorted = Sites.Array();
+	Sorted.Sort([](const TPair<const UObject*, FSite>& A, const TPair<const UObject*, FSite>& B) { return A.Value.TotalSeconds > B.Value.TotalSeconds; });
+
+	TArray<FArticyScriptProfiler::FRecord> Result;
+	for (const TPair<const UObject*, FSite>& Entry : Sorted)
+	{
+		const FString* Expression = GetExpression(Entry.Key);
+		if (!Expression)
+			continue;
+		if (Result.Num() >= MaxRecords)
+			break;
+
+		FArticyScriptProfiler::FRecord& Record = Result.AddDefaulted_GetRef();
+		Record.Expression = *Expression;
+		Record.Owner = DescribeOwner(Entry.Key);
+		Record.Hash = GetTypeHash(*Expression);
+		Record.bInstruction = Entry.Value.bInstruction;
+		Record.Calls = Entry.Value.Calls;
+		Record.TotalSeconds = Entry.Value.TotalSeconds;
+		Record.MaxSeconds = Entry.Value.MaxSeconds;
+	}
+	return Result;
+}
+
+/**
+ * Writes the records as CSV, most expensive in total first.
+ * @param Path The file to write, empty for a timestamped file in the profiling directory.
+ * @return The path written to, empty if writing failed.
+ */
+FString FArticyScriptProfiler::DumpCsv(const FString& Path)
+{
+	const FString FilePath = Path.IsEmpty()
+		? FPaths::ProfilingDir() / FString::Printf(TEXT("ArticyScripts-%s.csv"), *FDateTime::Now().ToString())
+		: Path;
+
+	FString Csv = TEXT("Kind,Hash,Calls,TotalMs,MaxMs,AverageUs,Owner,Expression\n");
+	for (const FRecord& Record : GetSortedRecords())
+	{
+		Csv += FString::Printf(TEXT("%s,%u,%lld,%.4f,%.4f,%.3f,%s,%s\n"), Record.bInstruction ? TEXT("Instruction") : TEXT("Condition"),
+			Record.Hash, Record.Calls, Record.TotalSeconds * 1000.0, Record.MaxSeconds * 1000.0,
+			Record.Calls > 0 ? Record.TotalSeconds * 1000000.0 / Record.Calls : 0.0, *EscapeCsv(Record.Owner), *EscapeCsv(Record.Expression));
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *FilePath))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to write the script profiler records to %s"), *FilePath);
+		return FString();
+	}
+
+	return FilePath;
+}
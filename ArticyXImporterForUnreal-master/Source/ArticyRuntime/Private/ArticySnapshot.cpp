@@ -0,0 +1,168 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticySnapshot.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyPrimitive.h"
+#include "ArticyRuntimeModule.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** The first bytes of every snapshot, "ASNP". */
+	constexpr uint32 SnapshotMagic = 0x504E5341;
+
+	bool IsShadowed(const UArticyGlobalVariables* GlobalVariables, const UArticyDatabase* Database)
+	{
+		return GlobalVariables->GetShadowLevel() > 0 || (Database && Database->GetShadowLevel() > 0);
+	}
+}
+
+/**
+ * Writes a snapshot of the dialogue state.
+ * @param OutBytes The buffer the snapshot is written to.
+ * @param GlobalVariables The variables to write.
+ * @param Database The database whose clone table is written, can be null.
+ * @param FlowPlayers The flow players whose cursors are written.
+ * @return False if the snapshot can't be taken now.
+ */
+bool FArticySnapshot::Save(TArray<uint8>& OutBytes, const UArticyGlobalVariables* GlobalVariables, const UArticyDatabase* Database, TArrayView<UArticyFlowPlayer* const> FlowPlayers)
+{
+	OutBytes.Reset();
+	if (!ensure(GlobalVariables))
+		return false;
+
+	// the state of a shadowed operation is undone when it ends, it must not end up in a save game
+	if (IsShadowed(GlobalVariables, Database))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: can't save during a shadowed operation."));
+		return false;
+	}
+
+	FMemoryWriter Ar(OutBytes);
+
+	uint32 Magic = SnapshotMagic;
+	int32 Version = static_cast<int32>(EVersion::Latest);
+	Ar << Magic << Version;
+
+	GlobalVariables->SaveSnapshot(Ar);
+
+	bool bHasCloneTable = Database != nullptr;
+	Ar << bHasCloneTable;
+	if (Database)
+		Database->SaveCloneTable(Ar);
+
+	TArray<uint64> CursorIds;
+	TArray<int32> CursorCloneIds;
+	CursorIds.Reserve(FlowPlayers.Num());
+	CursorCloneIds.Reserve(FlowPlayers.Num());
+	for (const UArticyFlowPlayer* FlowPlayer : FlowPlayers)
+	{
+		const UArticyPrimitive* Cursor = FlowPlayer ? Cast<UArticyPrimitive>(FlowPlayer->GetCursor().GetObject()) : nullptr;
+		CursorIds.Add(Cursor ? Cursor->GetId().Get() : 0);
+		CursorCloneIds.Add(Cursor ? Cursor->GetCloneId() : 0);
+	}
+	Ar << CursorIds << CursorCloneIds;
+
+	return !Ar.IsError();
+}
+
+/**
+ * Restores the dialogue state of a snapshot written by Save.
+ * @param Bytes The snapshot.
+ * @param GlobalVariables The variables to restore.
+ * @param Database The database to recreate the clones in, can be null.
+ * @param FlowPlayers The flow players to restore the cursors of.
+ * @param RenamedVariables Maps full variable names at the time of the snapshot to their current ones.
+ * @return False if the snapshot could not be read or can't be loaded now.
+ */
+bool FArticySnapshot::Load(const TArray<uint8>& Bytes, UArticyGlobalVariables* GlobalVariables, UArticyDatabase* Database, TArrayView<UArticyFlowPlayer* const> FlowPlayers, const TMap<FName, FName>& RenamedVariables)
+{
+	if (!ensure(GlobalVariables))
+		return false;
+
+	if (IsShadowed(GlobalVariables, Database))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: can't load during a shadowed operation."));
+		return false;
+	}
+
+	FMemoryReader Ar(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Ar << Magic << Version;
+	if (Ar.IsError() || Magic != SnapshotMagic)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: the data is not a snapshot."));
+		return false;
+	}
+	if (Version < static_cast<int32>(EVersion::Initial) || Version > static_cast<int32>(EVersion::Latest))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: version %d is not supported, the latest is %d."), Version, static_cast<int32>(EVersion::Latest));
+		return false;
+	}
+
+	if (!GlobalVariables->LoadSnapshot(Ar, RenamedVariables))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: failed to read the global variables."));
+		return false;
+	}
+
+	bool bHasCloneTable = false;
+	Ar << bHasCloneTable;
+	if (bHasCloneTable)
+	{
+		if (Database)
+		{
+			if (!Database->LoadCloneTable(Ar))
+			{
+				UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: failed to read the clone table."));
+				return false;
+			}
+		}
+		else
+		{
+			// skip the table
+			TArray<uint64> Ids;
+			TArray<int32> NumClones;
+			TArray<int32> CloneIds;
+			Ar << Ids << NumClones << CloneIds;
+		}
+	}
+
+	TArray<uint64> CursorIds;
+	TArray<int32> CursorCloneIds;
+	Ar << CursorIds << CursorCloneIds;
+	if (Ar.IsError() || CursorIds.Num() != CursorCloneIds.Num())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Snapshot: failed to read the flow player cursors."));
+		return false;
+	}
+
+	for (int32 i = 0; i < FlowPlayers.Num() && i < CursorIds.Num(); ++i)
+	{
+		UArticyFlowPlayer* FlowPlayer = FlowPlayers[i];
+		if (!FlowPlayer || CursorIds[i] == 0)
+			continue;
+
+		const UArticyDatabase* CursorDatabase = Database ? Database : UArticyDatabase::Get(FlowPlayer);
+		UArticyObject* Object = CursorDatabase ? CursorDatabase->GetObject(CursorIds[i], CursorCloneIds[i]) : nullptr;
+		if (!Object || !Object->Implements<UArticyFlowObject>())
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Snapshot: the cursor %llu of flow player %s is not loaded, it is not restored."), CursorIds[i], *FlowPlayer->GetName());
+			continue;
+		}
+
+		TScriptInterface<IArticyFlowObject> Cursor;
+		Cursor.SetObject(Object);
+		Cursor.SetInterface(Cast<IArticyFlowObject>(Object));
+		FlowPlayer->SetCursorTo(Cursor);
+	}
+
+	return true;
+}
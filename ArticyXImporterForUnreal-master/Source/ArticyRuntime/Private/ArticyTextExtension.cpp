@@ -7,6 +7,11 @@
 #include "ArticyGlobalVariables.h"
 #include "ArticyTypeSystem.h"
 #include "ArticyHelpers.h"
+#include "ArticyLocalizerSystem.h"
+#include "ArticyRuntimeStats.h"
+#include "Async/Async.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
 
 UArticyTextExtension* UArticyTextExtension::Get()
 {
@@ -20,124 +25,706 @@ UArticyTextExtension* UArticyTextExtension::Get()
 	return ArticyTextExtension.Get();
 }
 
-// Retrieve string from specified source
-FString UArticyTextExtension::GetSource(UObject* Outer, const FString& SourceName) const
+const FArticyTextTemplate& UArticyTextExtension::GetTemplate(const FString& Format) const
 {
-	// Split the SourceName by dots
-	TArray<FString> SourceParts;
-	SourceName.ParseIntoArray(SourceParts, TEXT("."));
-	FString RemValue = TEXT("");
-	FString Result = TEXT("");
-	bool bSuccess = false;
+	return *FindOrAddTemplate(Format);
+}
+
+TSharedRef<const FArticyTextTemplate> UArticyTextExtension::FindOrAddTemplate(const FString& Format) const
+{
+	if (const TSharedRef<const FArticyTextTemplate>* Cached = Templates.Find(Format))
+	{
+		return *Cached;
+	}
 
-	if (SourceParts.Num() > 0)
+	const TSharedRef<FArticyTextTemplate> Template = MakeShared<FArticyTextTemplate>();
+
+	// Split a literal span on its {N} placeholders
+	auto AddLiteral = [&Template](const FString& Text)
 	{
-		FString MethodName = SourceParts[0];
-        
-		FString Parameters;
-		for (int32 Index = 1; Index < SourceParts.Num(); ++Index)
+		int32 LiteralStart = 0;
+		for (int32 Index = 0; Index < Text.Len(); ++Index)
 		{
-			if (!Parameters.IsEmpty())
+			if (Text[Index] != TEXT('{'))
+				continue;
+
+			int32 DigitsEnd = Index + 1;
+			while (DigitsEnd < Text.Len() && FChar::IsDigit(Text[DigitsEnd]))
+				DigitsEnd++;
+
+			// Only the placeholders as Resolve writes them, without leading zeros
+			const int32 NumDigits = DigitsEnd - Index - 1;
+			if (NumDigits == 0 || NumDigits > 9 || DigitsEnd >= Text.Len() || Text[DigitsEnd] != TEXT('}') || (NumDigits > 1 && Text[Index + 1] == TEXT('0')))
+				continue;
+
+			if (Index > LiteralStart)
 			{
-				Parameters += TEXT(",");
+				FArticyTextTemplate::FSegment& Literal = Template->Segments.AddDefaulted_GetRef();
+				Literal.Text = Text.Mid(LiteralStart, Index - LiteralStart);
+				Template->LiteralLength += Literal.Text.Len();
 			}
-			Parameters += SourceParts[Index];
+
+			FArticyTextTemplate::FSegment& Argument = Template->Segments.AddDefaulted_GetRef();
+			Argument.Kind = FArticyTextTemplate::FSegment::EKind::Argument;
+			Argument.Text = Text.Mid(Index, DigitsEnd - Index + 1);
+			Argument.ArgumentIndex = FCString::Atoi(*Text.Mid(Index + 1, NumDigits));
+
+			LiteralStart = DigitsEnd + 1;
+			Index = DigitsEnd;
 		}
-        
-		if (Parameters.Contains(TEXT("(")) && Parameters.Contains(TEXT(")")))
+
+		if (LiteralStart < Text.Len())
 		{
-			FString Method;
-			FString ArgsString;
-			Parameters.Split(TEXT("("), &Method, &ArgsString);
+			FArticyTextTemplate::FSegment& Literal = Template->Segments.AddDefaulted_GetRef();
+			Literal.Text = Text.Mid(LiteralStart);
+			Template->LiteralLength += Literal.Text.Len();
+		}
+	};
 
-			ArgsString.RemoveFromEnd(TEXT(")"));
-			TArray<FString> Args;
-			ArgsString.ParseIntoArray(Args, TEXT(","), true);
+	// Tokens are found the same way ResolveUncompiled finds them
+	int32 Position = 0;
+	while (true)
+	{
+		const int32 TokenStartIndex = Format.Find(TEXT("["), ESearchCase::CaseSensitive, ESearchDir::FromStart, Position);
+		if (TokenStartIndex == INDEX_NONE)
+			break;
 
-			// Execute the method
-			return ExecuteMethod(Outer, FText::FromString(Method), Args);
+		const int32 TokenEndIndex = Format.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, TokenStartIndex);
+		if (TokenEndIndex == INDEX_NONE)
+			break;
+
+		AddLiteral(Format.Mid(Position, TokenStartIndex - Position));
+
+		const FString Token = Format.Mid(TokenStartIndex + 1, TokenEndIndex - TokenStartIndex - 1);
+		if (Token.Contains(TEXT("{")))
+		{
+			Template->bHasArgumentsInTokens = true;
+		}
+
+		FString SourceName, Formatting;
+		Token.Split(TEXT(":"), &SourceName, &Formatting);
+		if (SourceName.IsEmpty())
+		{
+			SourceName = Token;
 		}
+
+		FArticyTextTemplate::FSegment& Segment = Template->Segments.AddDefaulted_GetRef();
+		Segment.Kind = FArticyTextTemplate::FSegment::EKind::Token;
+		CompileSource(SourceName, Segment.Source);
+		BindMethod(Segment.Source);
+		if (!Formatting.IsEmpty())
+		{
+			CompileNumberFormat(Formatting, Segment.Format);
+		}
+
+		Position = TokenEndIndex + 1;
 	}
-	else
+	AddLiteral(Format.Mid(Position));
+
+	Templates.Add(Format, Template);
+	return Template;
+}
+
+FText UArticyTextExtension::ResolveCached(UObject* Outer, const FText& Format) const
+{
+	ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyResolveText);
+
+	const FString& FormatString = Format.ToString();
+
+	// Texts resolved while resolving another text are part of that text
+	if (ActiveRecord)
 	{
-		// No source
+		ActiveRecord->bCacheable = false;
+		return FText::FromString(ResolveTemplate(Outer, FormatString, {}));
+	}
+
+	// Boolean values are resolved to localized strings, while a culture switch reads its tables the previous ones are used
+	const FString& Culture = FInternationalization::Get().GetCurrentCulture()->GetName();
+	if (!ResolvedTextsCulture.Equals(Culture, ESearchCase::CaseSensitive))
+	{
+		const UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get();
+		if (!Localizer || !Localizer->IsSwitchingCulture())
+		{
+			InvalidateResolvedTexts();
+			ResolvedTextsCulture = Culture;
+		}
+	}
+
+	const UObject* World = GEngine->GetWorldFromContextObject(Outer, EGetWorldErrorMode::ReturnNull);
+	if (const FResolvedText* Cached = ResolvedTexts.Find(FormatString))
+	{
+		if (IsResolvedTextCurrent(Outer, *Cached, World))
+		{
+			FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::TextCacheHits);
+			return Cached->Result;
+		}
+	}
+	FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::TextCacheMisses);
+
+	FResolveRecord Record;
+	ActiveRecord = &Record;
+	const FText Result = FText::FromString(ResolveTemplate(Outer, FormatString, {}));
+	ActiveRecord = nullptr;
+
+	if (!Record.bCacheable)
+	{
+		ResolvedTexts.Remove(FormatString);
 		return Result;
 	}
 
-	if (SourceParts.Num() > 1)
+	LLM_SCOPE_BYTAG(Articy_Text);
+	FResolvedText& Entry = ResolvedTexts.FindOrAdd(FormatString);
+	Entry.Result = Result;
+	Entry.World = World;
+	Entry.Store = Record.Store;
+	Entry.DatabaseGeneration = UArticyDatabase::GetGeneration();
+	Entry.TextsGeneration = ResolvedTextsGeneration;
+	Entry.Dependencies = MoveTemp(Record.Dependencies);
+	return Result;
+}
+
+bool UArticyTextExtension::IsResolvedTextCurrent(UObject* Outer, const FResolvedText& Entry, const UObject* World) const
+{
+	// Loaded packages and clones change which objects the text finds
+	if (Entry.World.Get() != World || Entry.DatabaseGeneration != UArticyDatabase::GetGeneration())
+	{
+		return false;
+	}
+
+	// The string tables changed since the text was resolved
+	if (Entry.TextsGeneration != ResolvedTextsGeneration)
+	{
+		return false;
+	}
+
+	if (Entry.Dependencies.Num() == 0)
+	{
+		return true;
+	}
+
+	// The variables have to be the ones of the current store, and still hold their values
+	const UArticyDatabase* DB = UArticyDatabase::Get(Outer);
+	if (!DB || DB->GetGVs() != Entry.Store.Get())
+	{
+		return false;
+	}
+
+	for (const FResolvedTextDependency& Dependency : Entry.Dependencies)
 	{
-		for (int32 Index = 1; Index < SourceParts.Num(); ++Index)
+		if (!IsDependencyCurrent(Dependency))
 		{
-			if (!RemValue.IsEmpty())
+			return false;
+		}
+	}
+	return true;
+}
+
+UArticyTextExtension::FResolvedTextDependency UArticyTextExtension::MakeDependency(const UArticyVariable* Variable)
+{
+	FResolvedTextDependency Dependency;
+	Dependency.Variable = Variable;
+	if (const UArticyInt* Int = Cast<UArticyInt>(Variable))
+	{
+		Dependency.IntValue = Int->Get();
+	}
+	else if (const UArticyBool* Bool = Cast<UArticyBool>(Variable))
+	{
+		Dependency.IntValue = Bool->Get() ? 1 : 0;
+	}
+	else if (const UArticyString* String = Cast<UArticyString>(Variable))
+	{
+		Dependency.StringValue = String->Get();
+	}
+	return Dependency;
+}
+
+// Values are compared instead of listening to OnVariableChanged, which is not broadcast for shadowed changes
+bool UArticyTextExtension::IsDependencyCurrent(const FResolvedTextDependency& Dependency)
+{
+	const UArticyVariable* Variable = Dependency.Variable.Get();
+	if (const UArticyInt* Int = Cast<UArticyInt>(Variable))
+	{
+		return Int->Get() == Dependency.IntValue;
+	}
+	if (const UArticyBool* Bool = Cast<UArticyBool>(Variable))
+	{
+		return (Bool->Get() ? 1 : 0) == Dependency.IntValue;
+	}
+	if (const UArticyString* String = Cast<UArticyString>(Variable))
+	{
+		return String->Get().Equals(Dependency.StringValue, ESearchCase::CaseSensitive);
+	}
+	return false;
+}
+
+void UArticyTextExtension::ResetResolvedTexts()
+{
+	ResolvedTexts.Reset();
+}
+
+void UArticyTextExtension::InvalidateResolvedTexts()
+{
+	// Stale entries are overwritten when their text is resolved again
+	++ResolvedTextsGeneration;
+}
+
+namespace
+{
+	/** The texts of one PrepareTexts call, shared by the game thread and the worker */
+	struct FArticyPrepareTextsJob
+	{
+		TArray<FArticyTextToPrepare> Texts;
+
+		/** The localized text to resolve, with its template */
+		TArray<FString> Formats;
+		TArray<TSharedPtr<const FArticyTextTemplate>> Templates;
+
+		/** The values of the global variables the texts show, not changed once the worker started */
+		TMap<FString, FString> Variables;
+
+		TArray<FText> Results;
+		TArray<bool> Resolved;
+	};
+}
+
+void UArticyTextExtension::PrepareTexts(TArray<FArticyTextToPrepare> Texts, TFunction<void(TArray<FText>&&)> OnPrepared)
+{
+	check(IsInGameThread());
+
+	const TSharedRef<FArticyPrepareTextsJob> Job = MakeShared<FArticyPrepareTextsJob>();
+	Job->Texts = MoveTemp(Texts);
+	const int32 NumTexts = Job->Texts.Num();
+	Job->Formats.SetNum(NumTexts);
+	Job->Templates.SetNum(NumTexts);
+	Job->Results.SetNum(NumTexts);
+	Job->Resolved.Init(false, NumTexts);
+
+	// Localizing may load string tables and capturing reads the variables, both need the game thread
+	UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get();
+	for (int32 Index = 0; Index < NumTexts; ++Index)
+	{
+		const FArticyTextToPrepare& Text = Job->Texts[Index];
+		FText Source;
+		if (!Localizer || !Localizer->LocalizeSource(Text.Key, Source))
+		{
+			// Preview texts are not resolved, like in LocalizeString
+			if (Text.Key.ToString().EndsWith(TEXT(".PreviewText")))
 			{
-				RemValue += TEXT(".");
+				Job->Results[Index] = Text.BackupText.IsSet() ? Text.BackupText.GetValue() : Text.Key;
+				Job->Resolved[Index] = true;
+				continue;
 			}
-			RemValue += SourceParts[Index];
+			Source = Text.Key;
 		}
+
+		Job->Formats[Index] = Source.ToString();
+		Job->Templates[Index] = FindOrAddTemplate(Job->Formats[Index]);
+		CaptureVariables(Text.Outer.Get(), *Job->Templates[Index], Job->Variables);
 	}
 
-	// Process types
-	if (SourceParts[0].StartsWith(TEXT("$Type.")))
+	TWeakObjectPtr<UArticyTextExtension> WeakThis(this);
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Job, OnPrepared = MoveTemp(OnPrepared)]() mutable
 	{
-		const FString TypeName = SourceParts[0].Mid(6);
-		GetTypeProperty(TypeName, RemValue, Result, bSuccess);
-		
+		LLM_SCOPE_BYTAG(Articy_Text);
+		for (int32 Index = 0; Index < Job->Texts.Num(); ++Index)
+		{
+			FString Result;
+			if (!Job->Resolved[Index] && ResolveFromSnapshot(*Job->Templates[Index], Job->Variables, Result))
+			{
+				Job->Results[Index] = FText::FromString(MoveTemp(Result));
+				Job->Resolved[Index] = true;
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Job, OnPrepared = MoveTemp(OnPrepared)]() mutable
+		{
+			// The texts the snapshot cannot resolve are resolved as usual
+			const UArticyTextExtension* TextExtension = WeakThis.Get();
+			for (int32 Index = 0; Index < Job->Texts.Num(); ++Index)
+			{
+				if (Job->Resolved[Index])
+				{
+					continue;
+				}
+
+				const FText Format = FText::FromString(Job->Formats[Index]);
+				Job->Results[Index] = TextExtension ? TextExtension->Resolve(Job->Texts[Index].Outer.Get(), &Format) : Format;
+			}
+
+			OnPrepared(MoveTemp(Job->Results));
+		});
+	});
+}
+
+void UArticyTextExtension::CaptureVariables(UObject* Outer, const FArticyTextTemplate& Template, TMap<FString, FString>& OutValues) const
+{
+	for (const FArticyTextTemplate::FSegment& Segment : Template.Segments)
+	{
+		const FArticyTextSource& Source = Segment.Source;
+		if (Segment.Kind != FArticyTextTemplate::FSegment::EKind::Token || Source.Kind != FArticyTextSource::EKind::Property || OutValues.Contains(Source.SourceName))
+		{
+			continue;
+		}
+
+		FArticyGvName GvName;
+		GvName.Namespace = Source.Namespace;
+		GvName.Variable = Source.Variable;
+		GvName.FullName = Source.VariableFullName;
+
+		FString Value;
+		bool bSuccess = false;
+		GetGlobalVariable(Outer, Source.SourceName, GvName, Value, bSuccess);
 		if (bSuccess)
 		{
-			return Result;
+			OutValues.Add(Source.SourceName, MoveTemp(Value));
+		}
+	}
+}
+
+bool UArticyTextExtension::ResolveFromSnapshot(const FArticyTextTemplate& Template, const TMap<FString, FString>& Values, FString& OutResult)
+{
+	FString Result;
+	Result.Reserve(Template.LiteralLength);
+
+	for (const FArticyTextTemplate::FSegment& Segment : Template.Segments)
+	{
+		switch (Segment.Kind)
+		{
+		case FArticyTextTemplate::FSegment::EKind::Literal:
+		case FArticyTextTemplate::FSegment::EKind::Argument:
+			Result += Segment.Text;
+			break;
+		case FArticyTextTemplate::FSegment::EKind::Token:
+			{
+				if (Segment.Source.SourceName.IsEmpty() || Segment.Source.Kind == FArticyTextSource::EKind::None)
+					break;
+
+				// Only global variables were captured, objects, types and methods are read on the game thread
+				const FString* Value = Segment.Source.Kind == FArticyTextSource::EKind::Property ? Values.Find(Segment.Source.SourceName) : nullptr;
+				if (!Value)
+					return false;
+
+				// Values with tokens of their own are resolved again by the uncompiled path
+				if (Value->Contains(TEXT("[")))
+					return false;
+
+				Result += Segment.Format.IsEmpty() ? *Value : FormatNumber(*Value, Segment.Format);
+				break;
+			}
 		}
+	}
+
+	OutResult = MoveTemp(Result);
+	return true;
+}
 
-		return SourceName;
+bool UArticyTextExtension::CanUseTemplate(const FArticyTextTemplate& Template, const TArray<FString>& ArgumentValues)
+{
+	if (Template.bHasArgumentsInTokens && ArgumentValues.Num() > 0)
+	{
+		return false;
 	}
 
-	// Process Global Variables
-	const FArticyGvName GvName = FArticyGvName(FName(SourceParts[0]), FName(RemValue));
-	GetGlobalVariable(Outer, SourceName, GvName, Result, bSuccess);
-	if (bSuccess)
+	// Arguments that add tokens or placeholders change how the text is split
+	for (const FString& Value : ArgumentValues)
 	{
-		return Result;
+		if (Value.Contains(TEXT("[")) || Value.Contains(TEXT("]")) || Value.Contains(TEXT("{")))
+		{
+			return false;
+		}
 	}
 
-	// Type for object
-	bool bRequestType = false;
-	if (RemValue.EndsWith(TEXT(".$Type")))
+	return true;
+}
+
+FString UArticyTextExtension::ResolveTemplate(UObject* Outer, const FString& Format, const TArray<FString>& ArgumentValues) const
+{
+	ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyResolveText);
+
+	const FArticyTextTemplate& Template = GetTemplate(Format);
+	if (CanUseTemplate(Template, ArgumentValues))
 	{
-		RemValue = RemValue.Left(RemValue.Len() - 6);
-		bRequestType = true;
+		FString Result;
+		Result.Reserve(Template.LiteralLength);
+
+		bool bValueHasTokens = false;
+		for (const FArticyTextTemplate::FSegment& Segment : Template.Segments)
+		{
+			switch (Segment.Kind)
+			{
+			case FArticyTextTemplate::FSegment::EKind::Literal:
+				Result += Segment.Text;
+				break;
+			case FArticyTextTemplate::FSegment::EKind::Argument:
+				Result += ArgumentValues.IsValidIndex(Segment.ArgumentIndex) ? ArgumentValues[Segment.ArgumentIndex] : Segment.Text;
+				break;
+			case FArticyTextTemplate::FSegment::EKind::Token:
+				{
+					// Remove invalid token if source name is empty
+					if (Segment.Source.SourceName.IsEmpty())
+						break;
+
+					const FString SourceValue = Segment.Format.IsEmpty()
+						? ResolveSource(Outer, Segment.Source)
+						: FormatNumber(ResolveSource(Outer, Segment.Source), Segment.Format);
+					bValueHasTokens |= SourceValue.Contains(TEXT("["));
+					Result += SourceValue;
+					break;
+				}
+			}
+		}
+
+		if (!bValueHasTokens)
+		{
+			return Result;
+		}
 	}
 
-	// Process Objects & Script Properties
-	GetObjectProperty(Outer, SourceName, SourceParts[0], RemValue, bRequestType, Result, bSuccess);
-	if (bSuccess)
+	// Values with tokens of their own are resolved again by the uncompiled path
+	if (ActiveRecord)
 	{
-		return Result;
+		ActiveRecord->bCacheable = false;
 	}
-	
-	return SourceName;
+	return ResolveUncompiled(Outer, Format, ArgumentValues);
 }
 
-// Process SourceValue with NumberFormat according to C# Custom Number Formatting rules
-FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FString& NumberFormat) const
+FString UArticyTextExtension::ResolveUncompiled(UObject* Outer, FString FormattedString, const TArray<FString>& ArgumentValues) const
 {
-	double Value;
-	// Handle booleans
-	if (SourceValue.Equals(TEXT("true")))
+	// Regular placeholder replacement
+	for (int32 ArgIndex = 0; ArgIndex < ArgumentValues.Num(); ++ArgIndex)
 	{
-		Value = 1.f;
+		const FString Placeholder = FString::Printf(TEXT("{%d}"), ArgIndex);
+		FormattedString = FormattedString.Replace(*Placeholder, *ArgumentValues[ArgIndex]);
 	}
-	else if (SourceValue.Equals(TEXT("false")))
+
+	// Token replacement
+	while (true)
 	{
-		Value = 0.f;
+		const int32 TokenStartIndex = FormattedString.Find(TEXT("["), ESearchCase::CaseSensitive);
+		if (TokenStartIndex == INDEX_NONE)
+			break;
+
+		const int32 TokenEndIndex = FormattedString.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, TokenStartIndex);
+		if (TokenEndIndex == INDEX_NONE)
+			break;
+
+		FString Token = FormattedString.Mid(TokenStartIndex + 1, TokenEndIndex - TokenStartIndex - 1);
+		FString FullToken = FormattedString.Mid(TokenStartIndex, TokenEndIndex - TokenStartIndex + 1);
+		FString SourceName, Formatting;
+		
+		Token.Split(TEXT(":"), &SourceName, &Formatting);
+		if (SourceName.IsEmpty())
+		{
+			SourceName = Token;
+		}
+		
+		if (!SourceName.IsEmpty())
+		{
+			// Get value from source
+			FString SourceValue = GetSource(Outer, SourceName);
+            
+			if (!Formatting.IsEmpty())
+			{
+				// Custom format the SourceValue based on the rules of C#'s custom numeric format strings
+				FString FormattedValue = FormatNumber(SourceValue, Formatting);
+				FormattedString = FormattedString.Replace(*FullToken, *FormattedValue);
+			}
+			else
+			{
+				FormattedString = FormattedString.Replace(*FullToken, *SourceValue);
+			}
+		}
+		else
+		{
+			// Remove invalid token if source name is empty
+			FormattedString = FormattedString.Replace(*FullToken, TEXT(""));
+		}
+	}
+
+	return FormattedString;
+}
+
+// Retrieve string from specified source
+FString UArticyTextExtension::GetSource(UObject* Outer, const FString& SourceName) const
+{
+	FArticyTextSource Source;
+	CompileSource(SourceName, Source);
+	BindMethod(Source);
+	return ResolveSource(Outer, Source);
+}
+
+// Parse a source into what it resolves to
+void UArticyTextExtension::CompileSource(const FString& SourceName, FArticyTextSource& OutSource)
+{
+	OutSource = FArticyTextSource();
+	OutSource.SourceName = SourceName;
+
+	// Split the SourceName by dots
+	TArray<FString> SourceParts;
+	SourceName.ParseIntoArray(SourceParts, TEXT("."));
+	if (SourceParts.Num() == 0)
+	{
+		// No source
+		return;
+	}
+
+	FString Parameters;
+	FString RemValue;
+	for (int32 Index = 1; Index < SourceParts.Num(); ++Index)
+	{
+		if (!Parameters.IsEmpty())
+		{
+			Parameters += TEXT(",");
+			RemValue += TEXT(".");
+		}
+		Parameters += SourceParts[Index];
+		RemValue += SourceParts[Index];
+	}
+
+	if (Parameters.Contains(TEXT("(")) && Parameters.Contains(TEXT(")")))
+	{
+		FString Method;
+		FString ArgsString;
+		Parameters.Split(TEXT("("), &Method, &ArgsString);
+
+		ArgsString.RemoveFromEnd(TEXT(")"));
+		ArgsString.ParseIntoArray(OutSource.Arguments, TEXT(","), true);
+
+		OutSource.Kind = FArticyTextSource::EKind::Method;
+		OutSource.Method = Method;
+		if (Method == TEXT("if"))
+		{
+			OutSource.BuiltinMethod = FArticyTextSource::EMethod::If;
+		}
+		else if (Method == TEXT("not"))
+		{
+			OutSource.BuiltinMethod = FArticyTextSource::EMethod::Not;
+		}
+		return;
+	}
+
+	// Process types, $Type.TypeName.Property
+	if (SourceParts[0].Equals(TEXT("$Type")) && SourceParts.Num() > 1)
+	{
+		OutSource.Kind = FArticyTextSource::EKind::Type;
+		OutSource.TypeName = FName(*SourceParts[1]);
+		for (int32 Index = 2; Index < SourceParts.Num(); ++Index)
+		{
+			if (!OutSource.PropertyName.IsEmpty())
+			{
+				OutSource.PropertyName += TEXT(".");
+			}
+			OutSource.PropertyName += SourceParts[Index];
+		}
+		return;
+	}
+
+	OutSource.Kind = FArticyTextSource::EKind::Property;
+
+	// Global Variables
+	const FArticyGvName GvName = FArticyGvName(FName(SourceParts[0]), FName(RemValue));
+	OutSource.Namespace = GvName.Namespace;
+	OutSource.Variable = GvName.Variable;
+	OutSource.VariableFullName = GvName.FullName;
+
+	// Type for object
+	OutSource.PropertyName = RemValue;
+	if (RemValue.EndsWith(TEXT(".$Type")))
+	{
+		OutSource.PropertyName = RemValue.Left(RemValue.Len() - 6);
+		OutSource.bRequestType = true;
+	}
+
+	// Objects & Script Properties
+	const FString& NameOrId = SourceParts[0];
+	FString ObjectName, ObjectInstance;
+	SplitInstance(NameOrId, ObjectName, ObjectInstance);
+	OutSource.ObjectInstance = static_cast<int32>(FCString::Atod(*ObjectInstance));
+	if (NameOrId.StartsWith(TEXT("0x")))
+	{
+		OutSource.bObjectById = true;
+		OutSource.ObjectId = ArticyHelpers::HexToUint64(ObjectName);
+	}
+	else if (NameOrId.IsNumeric())
+	{
+		OutSource.bObjectById = true;
+		OutSource.ObjectId = ArticyHelpers::DecToUint64(ObjectName);
 	}
 	else
 	{
-		Value = FCString::Atof(*SourceValue);
+		OutSource.ObjectName = FName(*ObjectName);
 	}
-	
-	FString FormattedValue;
+}
 
-	int32 FormatIndex = 0;
+FString UArticyTextExtension::ResolveSource(UObject* Outer, const FArticyTextSource& Source) const
+{
+	FString Result = TEXT("");
+	bool bSuccess = false;
 
+	switch (Source.Kind)
+	{
+	case FArticyTextSource::EKind::Method:
+		{
+			// Methods may return anything
+			if (ActiveRecord)
+			{
+				ActiveRecord->bCacheable = false;
+			}
+
+			// Execute the method
+			return ExecuteMethod(Outer, Source);
+		}
+	case FArticyTextSource::EKind::Type:
+		{
+			GetTypeProperty(Source.TypeName, Source.PropertyName, Result, bSuccess);
+			if (bSuccess)
+			{
+				return Result;
+			}
+			return Source.SourceName;
+		}
+	case FArticyTextSource::EKind::Property:
+		{
+			// Process Global Variables
+			FArticyGvName GvName;
+			GvName.Namespace = Source.Namespace;
+			GvName.Variable = Source.Variable;
+			GvName.FullName = Source.VariableFullName;
+			GetGlobalVariable(Outer, Source.SourceName, GvName, Result, bSuccess);
+			if (bSuccess)
+			{
+				return Result;
+			}
+
+			// Process Objects & Script Properties
+			GetObjectProperty(Outer, Source, Result, bSuccess);
+			if (bSuccess)
+			{
+				return Result;
+			}
+			return Source.SourceName;
+		}
+	default:
+		{
+			// No source
+			return Result;
+		}
+	}
+}
+
+// Process SourceValue with NumberFormat according to C# Custom Number Formatting rules
+FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FString& NumberFormat) const
+{
+	FArticyNumberFormat Format;
+	CompileNumberFormat(NumberFormat, Format);
+	return FormatNumber(SourceValue, Format);
+}
+
+void UArticyTextExtension::CompileNumberFormat(const FString& NumberFormat, FArticyNumberFormat& OutFormat)
+{
+	OutFormat.Ops.Reset();
+
+	int32 FormatIndex = 0;
 	while (FormatIndex < NumberFormat.Len())
 	{
 		const TCHAR CurrentChar = NumberFormat[FormatIndex];
@@ -147,7 +734,7 @@ FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FSt
 			while (FormatIndex + ZeroCount < NumberFormat.Len() && NumberFormat[FormatIndex + ZeroCount] == '0')
 				ZeroCount++;
 
-			FormattedValue += FString::Printf(TEXT("%0*lld"), ZeroCount, FMath::RoundToInt(Value));
+			OutFormat.Ops.Add({ FArticyNumberFormat::EOp::Integer, ZeroCount });
 			FormatIndex += ZeroCount;
 		}
 		else if (CurrentChar == '#')
@@ -156,7 +743,7 @@ FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FSt
 			while (FormatIndex + DigitCount < NumberFormat.Len() && NumberFormat[FormatIndex + DigitCount] == '#')
 				DigitCount++;
 
-			FormattedValue += FString::Printf(TEXT("%.*f"), DigitCount, Value);
+			OutFormat.Ops.Add({ FArticyNumberFormat::EOp::Fixed, DigitCount });
 			FormatIndex += DigitCount;
 		}
 		else if (CurrentChar == '.')
@@ -165,15 +752,55 @@ FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FSt
 			while (FormatIndex + FractionalPartCount < NumberFormat.Len() && NumberFormat[FormatIndex + FractionalPartCount] == '#')
 				FractionalPartCount++;
 
-			FormattedValue += FString::Printf(TEXT("%.*f"), FractionalPartCount, Value);
+			OutFormat.Ops.Add({ FArticyNumberFormat::EOp::Fixed, FractionalPartCount });
 			FormatIndex += FractionalPartCount;
 		}
 		else
 		{
-			FormattedValue += CurrentChar;
+			// Consecutive literal characters are copied in one run
+			if (OutFormat.Ops.Num() == 0 || OutFormat.Ops.Last().Op != FArticyNumberFormat::EOp::Literal)
+			{
+				OutFormat.Ops.Add({ FArticyNumberFormat::EOp::Literal, 0 });
+			}
+			OutFormat.Ops.Last().Text += CurrentChar;
 			FormatIndex++;
 		}
 	}
+}
+
+FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FArticyNumberFormat& NumberFormat)
+{
+	double Value;
+	// Handle booleans
+	if (SourceValue.Equals(TEXT("true")))
+	{
+		Value = 1.f;
+	}
+	else if (SourceValue.Equals(TEXT("false")))
+	{
+		Value = 0.f;
+	}
+	else
+	{
+		Value = FCString::Atof(*SourceValue);
+	}
+	
+	FString FormattedValue;
+	for (const FArticyNumberFormat::FOp& Op : NumberFormat.Ops)
+	{
+		switch (Op.Op)
+		{
+		case FArticyNumberFormat::EOp::Integer:
+			FormattedValue += FString::Printf(TEXT("%0*lld"), Op.Count, FMath::RoundToInt(Value));
+			break;
+		case FArticyNumberFormat::EOp::Fixed:
+			FormattedValue += FString::Printf(TEXT("%.*f"), Op.Count, Value);
+			break;
+		case FArticyNumberFormat::EOp::Literal:
+			FormattedValue += Op.Text;
+			break;
+		}
+	}
 
 	return FormattedValue;
 }
@@ -227,10 +854,19 @@ void UArticyTextExtension::GetGlobalVariable(UObject* Outer, const FString& Sour
 			break;
 		}
 	}
+
+	if (OutSuccess && ActiveRecord)
+	{
+		ActiveRecord->Store = GlobalVariables;
+		ActiveRecord->Dependencies.Add(MakeDependency(*Variable));
+	}
 }
 
-void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& SourceName, const FString& NameOrId, const FString& PropertyName, const bool bRequestType, FString& OutString, bool& OutSuccess) const
+void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FArticyTextSource& Source, FString& OutString, bool& OutSuccess) const
 {
+	const FString& SourceName = Source.SourceName;
+	const FString& PropertyName = Source.PropertyName;
+
 	const auto& WorldContext = GEngine->GetWorldFromContextObject(Outer, EGetWorldErrorMode::ReturnNull);
 	if (!WorldContext)
 	{
@@ -243,20 +879,13 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 	// Get the object
 	const auto& DB = UArticyDatabase::Get(this);
 	UArticyObject* Object;
-
-	FString ObjectName, ObjectInstance;
-	SplitInstance(NameOrId, ObjectName, ObjectInstance);
-	if (NameOrId.StartsWith(TEXT("0x")))
+	if (Source.bObjectById)
 	{
-		Object = DB->GetObject<UArticyObject>(FArticyId{ArticyHelpers::HexToUint64(ObjectName)}, FCString::Atod(*ObjectInstance));
-	}
-	else if (NameOrId.IsNumeric())
-	{
-		Object = DB->GetObject<UArticyObject>(FArticyId{FCString::Strtoui64(*ObjectName, nullptr, 10)}, FCString::Atod(*ObjectInstance));
+		Object = DB->GetObject<UArticyObject>(FArticyId{Source.ObjectId}, Source.ObjectInstance);
 	}
 	else
 	{
-		Object = DB->GetObjectByName(*ObjectName, FCString::Atod(*ObjectInstance));
+		Object = DB->GetObjectByName(Source.ObjectName, Source.ObjectInstance);
 	}
 
 	if (!Object)
@@ -265,7 +894,13 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 		return;
 	}
 
-	if (bRequestType)
+	// Object properties are not tracked, texts that show them are resolved every time
+	if (ActiveRecord)
+	{
+		ActiveRecord->bCacheable = false;
+	}
+
+	if (Source.bRequestType)
 	{
 		OutString = Object->ArticyType.GetProperty(PropertyName).PropertyType;
 		OutSuccess = true;
@@ -273,7 +908,7 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 	}
 
 	// Handle based on data type
-	ExpressoType PropertyType {Object, PropertyName};
+	const ExpressoType PropertyType {Object, PropertyName};
 	switch (PropertyType.Type) {
 	case ExpressoType::Bool:
 		{
@@ -306,37 +941,29 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 	}
 }
 
-void UArticyTextExtension::GetTypeProperty(const FString& TypeName, const FString& PropertyName, FString& OutString,
+void UArticyTextExtension::GetTypeProperty(FName TypeName, const FString& PropertyName, FString& OutString,
 	bool& OutSuccess)
 {
-	UArticyTypeSystem* TypeSystem = UArticyTypeSystem::Get();
-	FArticyType TypeData = TypeSystem->GetArticyType(TypeName);
-	FArticyPropertyInfo PropertyInfo{};
-	bool bFoundProperty = false;
-	
-	for (const auto& Property : TypeData.Properties)
+	const FArticyType& TypeData = UArticyTypeSystem::Get()->GetArticyType(TypeName);
+	const FArticyPropertyInfo* PropertyInfo = TypeData.Properties.FindByPredicate([&PropertyName](const FArticyPropertyInfo& Property)
 	{
-		if (Property.TechnicalName.Equals(PropertyName))
-		{
-			PropertyInfo = Property;
-			bFoundProperty = true;
-			break;
-		}
-	}
+		return Property.TechnicalName.Equals(PropertyName);
+	});
 
-	if (!bFoundProperty)
+	if (!PropertyInfo)
 	{
 		OutSuccess = false;
 		return;
 	}
 
-	OutString = PropertyInfo.PropertyType;
+	OutString = PropertyInfo->PropertyType;
 	OutSuccess = true;
 }
 
-FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FText& Method, const TArray<FString>& Args) const
+FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FArticyTextSource& Source) const
 {
-	if (Method.ToString() == TEXT("if"))
+	const TArray<FString>& Args = Source.Arguments;
+	if (Source.BuiltinMethod == FArticyTextSource::EMethod::If)
 	{
 		if (Args.Num() >= 3)
 		{
@@ -350,7 +977,7 @@ FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FText& Method,
 			return Args[3];
 		}
 	}
-	else if (Method.ToString() == TEXT("not"))
+	else if (Source.BuiltinMethod == FArticyTextSource::EMethod::Not)
 	{
 		if (Args.Num() >= 3)
 		{
@@ -366,10 +993,24 @@ FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FText& Method,
 	}
 	else
 	{
-		if (UserMethodMap.Contains(Method.ToString()))
+		// Sources compiled without the text extension are found by name
+		const int32 Handle = Source.MethodHandle != INDEX_NONE ? Source.MethodHandle : FindUserMethod(Source.Method);
+		if (UserMethods.IsValidIndex(Handle))
 		{
-			const FArticyUserMethodCallback Callback = UserMethodMap[Method.ToString()];
-			return Callback(Args);
+			const FUserMethod& UserMethod = UserMethods[Handle];
+			if (UserMethod.ViewCallback)
+			{
+				TArray<FStringView, TInlineAllocator<8>> ArgViews;
+				for (const FString& Arg : Args)
+				{
+					ArgViews.Add(Arg);
+				}
+				return UserMethod.ViewCallback(ArgViews);
+			}
+			if (UserMethod.Callback)
+			{
+				return UserMethod.Callback(Args);
+			}
 		}
 	}
     
@@ -378,6 +1019,11 @@ FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FText& Method,
 
 EArticyObjectType UArticyTextExtension::GetObjectType(UArticyVariable** Object) const
 {
+	if (!Object)
+	{
+		return EArticyObjectType::Other;
+	}
+
 	// TODO: Use type system
 	if (Cast<UArticyBool>(*Object))
 	{
@@ -470,8 +1116,47 @@ void UArticyTextExtension::SplitInstance(const FString& InString, FString& OutNa
 	}
 }
 
-void UArticyTextExtension::AddUserMethod(const FString& MethodName, const FArticyUserMethodCallback Callback)
+int32 UArticyTextExtension::AddUserMethod(const FString& MethodName, const FArticyUserMethodCallback Callback)
+{
+	// Templates bound to the handle call the new callback
+	const int32 Handle = FindOrAddUserMethod(MethodName);
+	UserMethods[Handle].Callback = Callback;
+	UserMethods[Handle].ViewCallback = nullptr;
+	return Handle;
+}
+
+int32 UArticyTextExtension::AddUserMethodView(const FString& MethodName, FArticyUserMethodViewCallback Callback)
+{
+	const int32 Handle = FindOrAddUserMethod(MethodName);
+	UserMethods[Handle].Callback = nullptr;
+	UserMethods[Handle].ViewCallback = MoveTemp(Callback);
+	return Handle;
+}
+
+int32 UArticyTextExtension::FindUserMethod(const FString& MethodName) const
 {
-	// Add the callback to the user method map
-	UserMethodMap.Add(MethodName, Callback);
+	const int32* Handle = UserMethodHandles.Find(MethodName);
+	return Handle ? *Handle : INDEX_NONE;
+}
+
+int32 UArticyTextExtension::FindOrAddUserMethod(const FString& MethodName) const
+{
+	if (const int32* Handle = UserMethodHandles.Find(MethodName))
+	{
+		return *Handle;
+	}
+
+	const int32 Handle = UserMethods.Num();
+	UserMethods.AddDefaulted_GetRef().Name = MethodName;
+	UserMethodHandles.Add(MethodName, Handle);
+	return Handle;
+}
+
+void UArticyTextExtension::BindMethod(FArticyTextSource& Source) const
+{
+	// Methods called before they are registered get their handle now, registering them later fills it in
+	if (Source.Kind == FArticyTextSource::EKind::Method && Source.BuiltinMethod == FArticyTextSource::EMethod::User)
+	{
+		Source.MethodHandle = FindOrAddUserMethod(Source.Method);
+	}
 }
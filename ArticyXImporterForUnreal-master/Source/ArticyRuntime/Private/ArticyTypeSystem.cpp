@@ -19,12 +19,15 @@ UArticyTypeSystem* UArticyTypeSystem::Get()
 	return ArticyTypeSystem.Get();
 }
 
-FArticyType UArticyTypeSystem::GetArticyType(const FString& TypeName) const
+const FArticyType& UArticyTypeSystem::GetArticyType(FName TypeName) const
 {
-	if (Types.Contains(TypeName))
-	{
-		return Types[TypeName];
-	}
+	static const FArticyType EmptyType;
 
-	return {};
+	const FArticyType* Type = Types.Find(TypeName);
+	return Type ? *Type : EmptyType;
+}
+
+const FArticyType& UArticyTypeSystem::GetArticyType(const FString& TypeName) const
+{
+	return GetArticyType(FName(*TypeName, FNAME_Find));
 }
@@ -0,0 +1,344 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyVariableReplicator.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyRuntimeModule.h"
+#include "Net/UnrealNetwork.h"
+
+namespace
+{
+	/** Maps small negative ints to small varints as well. */
+	uint32 ZigZagEncode(int32 Value)
+	{
+		return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+	}
+
+	int32 ZigZagDecode(uint32 Value)
+	{
+		return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+	}
+
+	bool GetReplicatedType(const UArticyVariable* Variable, EArticyReplicatedVariableType& OutType)
+	{
+		if (Variable->IsA<UArticyBool>())
+			OutType = EArticyReplicatedVariableType::Bool;
+		else if (Variable->IsA<UArticyInt>())
+			OutType = EArticyReplicatedVariableType::Int;
+		else if (Variable->IsA<UArticyString>())
+			OutType = EArticyReplicatedVariableType::String;
+		else
+			return false;
+		return true;
+	}
+
+	/** Whether two variables of the same type have the same value. */
+	bool HasSameValue(const UArticyVariable* A, const UArticyVariable* B)
+	{
+		if (const UArticyBool* Bool = Cast<UArticyBool>(A))
+			return Bool->Get() == CastChecked<UArticyBool>(B)->Get();
+		if (const UArticyInt* Int = Cast<UArticyInt>(A))
+			return Int->Get() == CastChecked<UArticyInt>(B)->Get();
+		if (const UArticyString* String = Cast<UArticyString>(A))
+			return String->Get().Equals(CastChecked<UArticyString>(B)->Get(), ESearchCase::CaseSensitive);
+		return true;
+	}
+}
+
+//---------------------------------------------------------------------------//
+
+void FArticyReplicatedVariable::PostReplicatedAdd(const FArticyReplicatedVariables& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->OnVariableReceived(*this);
+}
+
+void FArticyReplicatedVariable::PostReplicatedChange(const FArticyReplicatedVariables& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->OnVariableReceived(*this);
+}
+
+/**
+ * Packs the slot as a varint, followed by the type in 2 bits and the value:
+ * one bit for a bool, a zigzag varint for an int and a varint string table index for a string.
+ *
+ * @param Ar The archive to write to or read from.
+ * @param Map Unused, no objects are referenced.
+ * @param bOutSuccess Set to whether the archive is still valid.
+ * @return Always true, the value is fully serialized here.
+ */
+bool FArticyReplicatedVariable::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 PackedSlot = static_cast<uint32>(Slot);
+	Ar.SerializeIntPacked(PackedSlot);
+	Slot = static_cast<int32>(PackedSlot);
+
+	Ar.SerializeBits(&Type, 2);
+
+	if (Type == static_cast<uint8>(EArticyReplicatedVariableType::Bool))
+	{
+		uint8 Bit = Value != 0 ? 1 : 0;
+		Ar.SerializeBits(&Bit, 1);
+		Value = Bit;
+	}
+	else if (Type == static_cast<uint8>(EArticyReplicatedVariableType::Int))
+	{
+		uint32 Packed = ZigZagEncode(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = ZigZagDecode(Packed);
+	}
+	else
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FArticyReplicatedString::PostReplicatedAdd(const FArticyReplicatedStrings& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+		InArraySerializer.Owner->OnStringReceived(*this);
+}
+
+//---------------------------------------------------------------------------//
+
+UArticyVariableReplicator::UArticyVariableReplicator()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+
+	Variables.Owner = this;
+	Strings.Owner = this;
+}
+
+void UArticyVariableReplicator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UArticyVariableReplicator, Strings);
+	DOREPLIFETIME(UArticyVariableReplicator, Variables);
+}
+
+/**
+ * On the server, starts listening to the variables and queues every variable that differs from the asset,
+ * which is what a joining client receives.
+ */
+void UArticyVariableReplicator::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!GetOwner() || !GetOwner()->HasAuthority() || !ResolveVariables())
+		return;
+
+	for (UArticyBaseVariableSet* Set : GlobalVariables->GetVariableSets())
+	{
+		if (Set)
+			Set->OnVariableChanged.AddDynamic(this, &UArticyVariableReplicator::HandleVariableChanged);
+	}
+
+	// clients start with the values of the asset, the default variables are a clone of the original one
+	TArray<UArticyVariable*> AssetSlots;
+	const UArticyGlobalVariables* Asset = OverrideGV ? nullptr : UArticyGlobalVariables::GetMutableOriginal();
+	if (Asset && Asset != GlobalVariables)
+		Asset->GetAllVariables(AssetSlots);
+
+	for (int32 Slot = 0; Slot < Slots.Num(); ++Slot)
+	{
+		if (!Slots[Slot])
+			continue;
+
+		const UArticyVariable* AssetVariable = AssetSlots.Num() == Slots.Num() ? AssetSlots[Slot] : nullptr;
+		if (!AssetVariable || AssetVariable->GetClass() != Slots[Slot]->GetClass() || !HasSameValue(Slots[Slot], AssetVariable))
+			UpdateSlot(Slot);
+	}
+}
+
+void UArticyVariableReplicator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (GlobalVariables && GetOwner() && GetOwner()->HasAuthority())
+	{
+		for (UArticyBaseVariableSet* Set : GlobalVariables->GetVariableSets())
+		{
+			if (Set)
+				Set->OnVariableChanged.RemoveDynamic(this, &UArticyVariableReplicator::HandleVariableChanged);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Resolves the replicated global variables and their slots.
+ *
+ * @return False if there are no global variables.
+ */
+bool UArticyVariableReplicator::ResolveVariables()
+{
+	if (GlobalVariables)
+	{
+		// alternative sets share one instance, which has to hold the values of ours before they are written
+		if (OverrideGV)
+			UArticyGlobalVariables::GetRuntimeClone(this, OverrideGV);
+		return true;
+	}
+
+	GlobalVariables = OverrideGV ? UArticyGlobalVariables::GetRuntimeClone(this, OverrideGV) : UArticyGlobalVariables::GetDefault(this);
+	if (!GlobalVariables)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("ArticyVariableReplicator on %s: no global variables to replicate."), *GetNameSafe(GetOwner()));
+		return false;
+	}
+
+	GlobalVariables->GetAllVariables(Slots);
+	SlotByVariable.Reserve(Slots.Num());
+	for (int32 Slot = 0; Slot < Slots.Num(); ++Slot)
+	{
+		if (Slots[Slot])
+			SlotByVariable.Add(Slots[Slot], Slot);
+	}
+	return true;
+}
+
+/**
+ * Sends the current value of a slot, unless it is the value that was sent last.
+ *
+ * @param Slot The slot of the variable.
+ */
+void UArticyVariableReplicator::UpdateSlot(int32 Slot)
+{
+	const UArticyVariable* Variable = Slots[Slot];
+	EArticyReplicatedVariableType Type;
+	if (!GetReplicatedType(Variable, Type))
+		return;
+
+	int32 Value = 0;
+	if (Type == EArticyReplicatedVariableType::Bool)
+	{
+		Value = static_cast<const UArticyBool*>(Variable)->Get() ? 1 : 0;
+	}
+	else if (Type == EArticyReplicatedVariableType::Int)
+	{
+		Value = static_cast<const UArticyInt*>(Variable)->Get();
+	}
+	else
+	{
+		const FString& String = static_cast<const UArticyString*>(Variable)->Get();
+		if (const int32* Index = StringIndices.Find(String))
+		{
+			Value = *Index;
+		}
+		else
+		{
+			Value = Strings.Items.Num();
+			StringIndices.Add(String, Value);
+
+			FArticyReplicatedString& Item = Strings.Items.AddDefaulted_GetRef();
+			Item.Index = Value;
+			Item.Value = String;
+			Strings.MarkItemDirty(Item);
+		}
+	}
+
+	if (const int32* ItemIndex = ItemBySlot.Find(Slot))
+	{
+		FArticyReplicatedVariable& Item = Variables.Items[*ItemIndex];
+		if (Item.Value == Value)
+			return;
+
+		Item.Value = Value;
+		Variables.MarkItemDirty(Item);
+		return;
+	}
+
+	ItemBySlot.Add(Slot, Variables.Items.Num());
+	FArticyReplicatedVariable& Item = Variables.Items.AddDefaulted_GetRef();
+	Item.Slot = Slot;
+	Item.Type = static_cast<uint8>(Type);
+	Item.Value = Value;
+	Variables.MarkItemDirty(Item);
+}
+
+void UArticyVariableReplicator::HandleVariableChanged(UArticyVariable* Variable)
+{
+	// the instance is shared with the other alternative sets, their writes are not ours
+	if (OverrideGV && !GlobalVariables->IsOverlayBound(OverrideGV))
+		return;
+
+	if (const int32* Slot = SlotByVariable.Find(Variable))
+		UpdateSlot(*Slot);
+}
+
+/**
+ * Applies a received variable, only listeners of variables whose value changed are notified.
+ *
+ * @param Item The received variable.
+ */
+void UArticyVariableReplicator::OnVariableReceived(const FArticyReplicatedVariable& Item)
+{
+	if (!ResolveVariables())
+		return;
+
+	UArticyVariable* Variable = Slots.IsValidIndex(Item.Slot) ? Slots[Item.Slot] : nullptr;
+	EArticyReplicatedVariableType Type;
+	if (!Variable || !GetReplicatedType(Variable, Type) || static_cast<uint8>(Type) != Item.Type)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("ArticyVariableReplicator: received variable %d does not match the local global variables, are server and client built from the same export?"), Item.Slot);
+		return;
+	}
+
+	if (Type == EArticyReplicatedVariableType::Bool)
+	{
+		UArticyBool* Bool = static_cast<UArticyBool*>(Variable);
+		if (Bool->Get() != (Item.Value != 0))
+			Bool->Set(Item.Value != 0);
+	}
+	else if (Type == EArticyReplicatedVariableType::Int)
+	{
+		UArticyInt* Int = static_cast<UArticyInt*>(Variable);
+		if (Int->Get() != Item.Value)
+			Int->Set(Item.Value);
+	}
+	else
+	{
+		const FString* String = ReceivedStrings.Find(Item.Value);
+		if (!String)
+		{
+			// applied when the string arrives
+			PendingStrings.Add(Item.Slot, Item.Value);
+			return;
+		}
+
+		PendingStrings.Remove(Item.Slot);
+		UArticyString* StringVariable = static_cast<UArticyString*>(Variable);
+		if (!StringVariable->Get().Equals(*String, ESearchCase::CaseSensitive))
+			StringVariable->Set(*String);
+	}
+}
+
+/**
+ * Stores a received string and applies the variables that were waiting for it.
+ *
+ * @param Item The received string.
+ */
+void UArticyVariableReplicator::OnStringReceived(const FArticyReplicatedString& Item)
+{
+	ReceivedStrings.Add(Item.Index, Item.Value);
+	if (!ResolveVariables())
+		return;
+
+	for (auto It = PendingStrings.CreateIterator(); It; ++It)
+	{
+		if (It->Value != Item.Index)
+			continue;
+
+		if (UArticyString* StringVariable = Cast<UArticyString>(Slots[It->Key]))
+			StringVariable->Set(Item.Value);
+		It.RemoveCurrent();
+	}
+}
@@ -4,48 +4,67 @@
 
 #include "Interfaces/ArticyInputPinsProvider.h"
 
+/**
+ * @brief Collects the pins to submerge into.
+ *
+ * Pins with no connections are skipped, since non-submergeable pins should not exist if at least one of
+ * the other pins can be submerged. If none of the pins has connections, submerging fails and the owner
+ * is explored instead.
+ *
+ * @param InputPins The input pins of the object, nothing is collected if null.
+ */
+void FArticySubmergeTargets::Build(const TArray<UArticyInputPin*>* InputPins)
+{
+	Pins.Reset();
+	bShadowed = false;
+	if (!ensure(InputPins) || InputPins->Num() == 0)
+		return;
+
+	// If there is more than one pin or the single pin has more connections,
+	// it must be a shadowed explore
+	bShadowed = InputPins->Num() > 1
+		|| ((*InputPins)[0] && (*InputPins)[0]->OutgoingConnections.Num() > 1);
+
+	for (auto pin : *InputPins)
+	{
+		if (ensure(pin) && pin->OutgoingConnections.Num() > 0)
+			Pins.Add(pin);
+	}
+}
+
 /**
  * @brief Tries to submerge into InputPins and explore connections.
  *
  * This method attempts to explore input pins of a flow node by checking for any
  * connected pins and exploring them using the provided player. It is used primarily
- * when starting an exploration at a flow node.
+ * when starting an exploration at a flow node. The pins are taken from GetSubmergeTargets
+ * if the object caches them.
  *
  * @param Player A pointer to the ArticyFlowPlayer instance managing the exploration.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
  * @param OutBranches An array to store the resulting branches from the exploration.
  * @param Depth The current depth of exploration.
  * @param bForceShadowed A boolean flag indicating whether to force shadowed exploration.
  *
  * @return Returns true if successful in submerging into InputPins; otherwise, false.
  */
-bool IArticyInputPinsProvider::TrySubmerge(class UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth, const bool bForceShadowed)
+bool IArticyInputPinsProvider::TrySubmerge(class UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth, const bool bForceShadowed)
 {
-	bool bSubmerged = false;
-
-	auto inPins = GetInputPinsPtr();
-	if (ensure(inPins) && inPins->Num() > 0)
+	FArticySubmergeTargets uncached;
+	const FArticySubmergeTargets* targets = GetSubmergeTargets();
+	if (!targets)
 	{
-		// If there is more than one pin or the single pin has more connections,
-		// it must be a shadowed explore
-		const auto bShadowed = bForceShadowed
-			|| inPins->Num() > 1
-			|| ((*inPins)[0] && (*inPins)[0]->Connections.Num() > 1);
-
-		// Submerge!
-		for (auto pin : *inPins)
-		{
-			// Skip pins with no connections, since non-submergeable pins should not exist if
-			// at least one of the other pins can be submerged.
-			// If none of the pins has connections, TrySubmerge will fail anyways, and the owner will be explored instead.
-			if (ensure(pin) && pin->Connections.Num() > 0)
-			{
-				bSubmerged = true;
-				OutBranches.Append(Player->Explore(pin, bShadowed, Depth + 1));
-			}
-		}
+		uncached.Build(GetInputPinsPtr());
+		targets = &uncached;
 	}
 
-	return bSubmerged;
+	const bool bShadowed = bForceShadowed || targets->bShadowed;
+
+	// Submerge!
+	for (auto pin : targets->Pins)
+		OutBranches.Append(Player->Explore(Context, pin, bShadowed, Depth + 1));
+
+	return targets->Pins.Num() > 0;
 }
 
 /**
@@ -3,6 +3,7 @@
 //
 
 #include "Interfaces/ArticyNode.h"
+#include "ArticyDatabase.h"
 
 /**
  * @brief Explores the node's output pins.
@@ -11,11 +12,31 @@
  * ArticyFlowPlayer to explore the connected branches.
  *
  * @param Player A pointer to the ArticyFlowPlayer managing the exploration.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
  * @param OutBranches An array to store the resulting branches from the exploration.
  * @param Depth The current depth of exploration.
  */
-void UArticyNode::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+void UArticyNode::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
 	// Default implementation: continue on output pins
-	IArticyOutputPinsProvider::Explore(Player, OutBranches, Depth + 1);
+	IArticyOutputPinsProvider::Explore(Player, Context, OutBranches, Depth + 1);
+}
+
+/**
+ * @brief Retrieves the input pins submerging into the node explores.
+ *
+ * The pins are subobjects of the node and keep their connections, so they are only collected again
+ * in a new database generation, like the targets of the connections.
+ *
+ * @return The cached targets.
+ */
+const FArticySubmergeTargets* UArticyNode::GetSubmergeTargets() const
+{
+	const uint32 Generation = UArticyDatabase::GetGeneration();
+	if (SubmergeGeneration != Generation)
+	{
+		SubmergeTargets.Build(GetInputPinsPtr());
+		SubmergeGeneration = Generation;
+	}
+	return &SubmergeTargets;
 }
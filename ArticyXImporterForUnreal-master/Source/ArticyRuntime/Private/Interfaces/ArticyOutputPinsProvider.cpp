@@ -11,10 +11,11 @@
  * to explore the connected branches. If there are no output pins, it adds a dead-end branch.
  *
  * @param Player A pointer to the ArticyFlowPlayer managing the exploration.
+ * @param Context The database, global variables, scripts and methods provider of the exploration.
  * @param OutBranches An array to store the resulting branches from the exploration.
  * @param Depth The current depth of exploration.
  */
-void IArticyOutputPinsProvider::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
+void IArticyOutputPinsProvider::Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
 {
 	auto pins = GetOutputPinsPtr();
 	if (ensure(pins) && pins->Num() > 0)
@@ -23,7 +24,7 @@ void IArticyOutputPinsProvider::Explore(UArticyFlowPlayer* Player, TArray<FArtic
 		const auto bShadowed = pins->Num() > 1;
 
 		for (auto pin : *pins)
-			OutBranches.Append(Player->Explore(pin, bShadowed, Depth + 1));
+			OutBranches.Append(Player->Explore(Context, pin, bShadowed, Depth + 1));
 	}
 	else
 	{
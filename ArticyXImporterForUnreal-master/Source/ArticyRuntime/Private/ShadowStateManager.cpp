@@ -4,14 +4,23 @@
 
 
 #include "ShadowStateManager.h"
+#include "ArticyRuntimeStats.h"
 
 void IShadowStateManager::UnregisterOnPopState(FDelegateHandle Delegate)
 {
 	OnPopStateDelegates.Last().Remove(Delegate);
 }
 
+void IShadowStateManager::RegisterUndo(void* Target, FUndoFunction Undo)
+{
+	LLM_SCOPE_BYTAG(Articy_Shadows);
+	UndoStack.Add({ Target, Undo, ShadowLevel });
+}
+
 void IShadowStateManager::PushState(uint32 NewShadowLevel)
 {
+	LLM_SCOPE_BYTAG(Articy_Shadows);
+
 	//create a new delegate just for this new shadow state
 	OnPopStateDelegates.Emplace();
 	++ShadowLevel;
@@ -23,6 +32,17 @@ void IShadowStateManager::PopState(uint32 CurrShadowLevel)
 {
 	ensureMsgf(ShadowLevel == CurrShadowLevel, TEXT("ShadowLevels do not match in PopState!"));
 
+	//undo the writes of THIS operation, the latest first
+	while(UndoStack.Num() > 0 && UndoStack.Last().ShadowLevel == ShadowLevel)
+	{
+#if ENGINE_MAJOR_VERSION > 5 || (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4)
+		const FUndoRecord Record = UndoStack.Pop(EAllowShrinking::No);
+#else
+		const FUndoRecord Record = UndoStack.Pop(false);
+#endif
+		Record.Undo(Record.Target, Record.ShadowLevel);
+	}
+
 	if(ensureMsgf(OnPopStateDelegates.Num() > 0, TEXT("InPopStateDelegates empty while popping a state!")))
 	{
 		//notify only the variables that registered during THIS operation
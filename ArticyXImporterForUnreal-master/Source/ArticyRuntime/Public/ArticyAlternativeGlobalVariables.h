@@ -13,6 +13,8 @@
  *
  * This class provides a blueprint-accessible data asset for storing and managing alternative global variables
  * within the Articy runtime environment.
+ * At runtime all alternative sets share one instance of the global variables, each set only stores the values
+ * it overrides, see UArticyGlobalVariables::GetRuntimeClone.
  */
 UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyAlternativeGlobalVariables : public UDataAsset
@@ -84,6 +84,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Load Asset")
 	UFileMediaSource* LoadAsFileMediaSource() const;
 
+	/**
+	 * Gets the path of the referenced asset without loading it.
+	 *
+	 * @return The soft object path of the referenced asset, null if there is no reference.
+	 */
+	FSoftObjectPath GetAssetPath() const;
+
 	/** The relative path of the referenced asset. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Meta Data")
 	FString AssetRef;
@@ -0,0 +1,88 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyAssetPrefetcher.generated.h"
+
+class IArticyFlowObject;
+class UArticyAsset;
+
+/**
+ * Streams in the assets of upcoming dialogue lines before they are shown.
+ *
+ * Flow players with PrefetchPauses set pass the lines reachable from their available branches here
+ * whenever the branches are updated. Their voice-over, preview images and speaker portraits are
+ * loaded asynchronously and kept loaded until they are the least recently requested ones and the
+ * prefetched assets exceed the memory budget of the plugin settings.
+ */
+UCLASS()
+class ARTICYRUNTIME_API UArticyAssetPrefetcher : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** The prefetcher of a world context, null without a world. */
+	static UArticyAssetPrefetcher* Get(const UObject* WorldContext);
+
+	/**
+	 * Starts loading the assets of these nodes and marks them as recently used.
+	 *
+	 * @param Nodes The nodes whose voice-over, preview image and speaker preview image are loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void PrefetchNodes(const TArray<TScriptInterface<IArticyFlowObject>>& Nodes);
+
+	/**
+	 * Starts loading an asset and marks it as recently used.
+	 *
+	 * @param Asset The asset to load.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void PrefetchAsset(const UArticyAsset* Asset);
+
+	/** Releases all prefetched assets. */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void ReleaseAll();
+
+	/** The estimated memory of the loaded prefetched assets, in bytes. */
+	int64 GetPrefetchedBytes() const { return PrefetchedBytes; }
+
+private:
+	struct FPrefetchedAsset
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		/** Estimated memory once loaded, 0 while loading. */
+		int64 Bytes = 0;
+		/** Request the asset was last part of, the least recent ones are evicted first. */
+		uint64 LastRequest = 0;
+	};
+
+	/** Adds an asset by ID to the current request. */
+	void PrefetchAssetId(const FArticyId& Id);
+
+	/** Adds an asset to the current request, starting to load it if it isn't yet. */
+	void RequestAsset(const UArticyAsset* Asset);
+
+	/** Measures a loaded asset and evicts others if the budget is exceeded. */
+	void OnAssetLoaded(FSoftObjectPath Path);
+
+	/** Evicts the least recently requested assets until the budget is met, the current request's assets are kept. */
+	void EnforceBudget();
+
+	FStreamableManager StreamableManager;
+
+	TMap<FSoftObjectPath, FPrefetchedAsset> Prefetched;
+
+	int64 PrefetchedBytes = 0;
+
+	/** Incremented with every prefetch call. */
+	uint64 CurrentRequest = 0;
+};
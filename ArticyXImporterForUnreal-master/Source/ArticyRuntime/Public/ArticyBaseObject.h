@@ -35,11 +35,28 @@ public:
 
 	/**
 	 * Retrieves a subobject of this Articy object using its unique identifier.
+	 * The subobjects are kept by ID, so this is a hash lookup, inlined as flow traversal calls it for every pin it resolves.
 	 *
 	 * @param Id The unique identifier of the subobject to retrieve.
 	 * @return A pointer to the UArticyPrimitive subobject if found, otherwise nullptr.
 	 */
-	UArticyPrimitive* GetSubobject(FArticyId Id) const;
+	UArticyPrimitive* GetSubobject(FArticyId Id) const
+	{
+		UArticyPrimitive* const* Obj = Subobjects.Find(Id);
+		return Obj ? *Obj : nullptr;
+	}
+
+	/**
+	 * Retrieves a subobject of this Articy object by ID if it is of the given class.
+	 *
+	 * @param Id The unique identifier of the subobject to retrieve.
+	 * @return A pointer to the subobject if found and of class T, otherwise nullptr.
+	 */
+	template<typename T>
+	T* GetSubobject(FArticyId Id) const
+	{
+		return Cast<T>(GetSubobject(Id));
+	}
 
 	/**
 	 * Gets the Articy type of this object.
@@ -55,10 +55,11 @@ class ARTICYRUNTIME_API UArticyOutgoingConnection : public UArticyConnection
 	
 public:
 
-	UArticyPrimitive* GetTarget() const;
+	/** Database may be passed by callers that already resolved it, it is only needed the first time. */
+	UArticyPrimitive* GetTarget(const UArticyDatabase* Database = nullptr) const;
 	FArticyId GetTargetID() const { return Target;  }
 	/** Can be an InputPin (next node) or an OutputPin (emerge to parent node). */
-	UArticyFlowPin* GetTargetPin() const;
+	UArticyFlowPin* GetTargetPin(const UArticyDatabase* Database = nullptr) const;
 	FArticyId GetTargetPinID() const { return TargetPin;  }
 	
 protected:
@@ -60,7 +60,9 @@ private:
 };
 
 /**
- * Represents a shadowable Articy object, capable of managing multiple shadows.
+ * Represents a shadowable Articy object.
+ * Shadowed operations work on the object itself, the properties they write are restored by the database when they end,
+ * see UArticyDatabase::ShadowProperty.
  */
 USTRUCT(BlueprintType)
 struct ARTICYRUNTIME_API FArticyShadowableObject
@@ -79,89 +81,39 @@ public:
 	explicit FArticyShadowableObject(UArticyObject* Object, int32 CloneId, UObject* Outer = nullptr);
 
 	/**
-	 * Returns the requested shadow.
+	 * Returns the object, which is the same at every shadow level.
 	 * @param ShadowManager The manager for shadow states.
 	 * @param ForceUnshadowed Force retrieval of the unshadowed version.
-	 * @return A pointer to the shadowed or unshadowed UArticyObject.
+	 * @return A pointer to the UArticyObject.
 	 */
 	UArticyObject* Get(const IShadowStateManager* ShadowManager, bool ForceUnshadowed = false) const;
 
 private:
 
-	/**
-	 * The original [0] object and its shadows.
-	 * Shadows are guaranteed to be stored in ascending order, but
-	 * the array index is not the shadow level (except for 0)!
-	 */
+	/** The object at shadow level 0. */
 	UPROPERTY(VisibleAnywhere, Category = "Articy")
-	mutable TArray<FArticyObjectShadow> ShadowCopies;
+	mutable FArticyObjectShadow Original;
 };
 
 /**
- * Contains a reference to a UArticyObject, and to its clones if any.
+ * The clones made of a loaded object, apart from its runtime copy.
+ * Most objects are never cloned, so only those that are have a clone list.
  */
-UCLASS(BlueprintType)
-class ARTICYRUNTIME_API UArticyCloneableObject : public UObject
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyCloneList
 {
 	GENERATED_BODY()
 
 public:
-	/**
-	 * Initializes the cloneable object with the initial clone.
-	 * @param InitialClone The initial clone to add.
-	 */
-	void Init(UArticyObject* InitialClone) { AddClone(InitialClone, 0); }
-
-	//========================================//
-
-	/**
-	 * Get the clone of this object with a certain CloneId.
-	 * Returns nullptr if the clone does not exist.
-	 * @param ShadowManager The manager for shadow states.
-	 * @param CloneId The clone ID to retrieve.
-	 * @param bForceUnshadowed Force retrieval of the unshadowed version.
-	 * @return A pointer to the clone or nullptr if not found.
-	 */
-	UArticyObject* Get(const IShadowStateManager* ShadowManager, int32 CloneId = 0, bool bForceUnshadowed = false) const;
-	/**
-	 * Clone the original object and assign it the id CloneId.
-	 * If bFailIfExists is true, nullptr is returned if the clone already exists.
-	 * Otherwise, the existing clone is returned.
-	 * @param ShadowManager The manager for shadow states.
-	 * @param CloneId The clone ID for the new clone.
-	 * @param bFailIfExists Fails if the clone already exists.
-	 * @return A pointer to the newly created clone or nullptr if creation failed.
-	 */
-	UArticyObject* Clone(const IShadowStateManager* ShadowManager, int32 CloneId, bool bFailIfExists = true);
-
-private:
-
-	/**
-	 * The copied instances of the same object.
-	 * Clones[0] is the one that is created at startup from the object assets.
-	 */
+	/** The clones by clone ID, the runtime copy with clone ID 0 is not among them. */
 	UPROPERTY(VisibleAnywhere, Category = "Articy")
 	TMap<int32, FArticyShadowableObject> Clones;
 
 	/**
-	 * Adds a clone to the Clones map.
-	 * @param Clone The clone to add.
-	 * @param CloneId The ID for the clone.
+	 * No clone ID below this one is free.
+	 * Clones are never removed, so searching for a free ID continues from here and all searches together are linear.
 	 */
-	void AddClone(UArticyObject* Clone, int32 CloneId);
-};
-
-/**
- * Contains an array of FArticyDatabaseObjects.
- */
-USTRUCT(BlueprintType)
-struct ARTICYRUNTIME_API FArticyDatabaseObjectArray
-{
-	GENERATED_BODY()
-
-public:
-	UPROPERTY()
-	TArray<UArticyCloneableObject*> Objects; /**< The array of Articy cloneable objects. */
+	int32 FirstFreeCloneId = 1;
 };
 
 /**
@@ -206,6 +158,17 @@ public:
 	 */
 	static UArticyDatabase* Get(const UObject* WorldContext);
 
+	/**
+	 * Get the generation of the loaded objects of all databases.
+	 * It changes whenever objects are loaded, unloaded or cloned, so cached object lookups
+	 * are still valid as long as it stays the same.
+	 * @return The current generation.
+	 */
+	static uint32 GetGeneration() { return Generation; }
+
+	/** Invalidates all cached object lookups, see GetGeneration. */
+	static void BumpGeneration() { ++Generation; }
+
 	/**
 	 * Get the current GVs instance.
 	 * @return A pointer to the current UArticyGlobalVariables instance.
@@ -290,6 +253,34 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	virtual bool UnloadPackage(const FString PackageName, const bool bQuickUnload);
 
+	/**
+	 * Makes packages that are not part of the import available under a mount name, e.g. those of a DLC.
+	 * Their objects are merged into the loaded ones without initializing the database again, the default packages
+	 * among them are loaded and the others load by name like imported ones. Global variables are generated code,
+	 * the packages can only use the namespaces of the import.
+	 * @param MountName The name to unmount the packages by.
+	 * @param Packages The packages to mount.
+	 * @return False if the name is mounted already or a package name is taken.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool MountPackages(const FString& MountName, const TArray<UArticyPackage*>& Packages);
+
+	/**
+	 * Unloads and forgets the packages of a mount.
+	 * @param MountName The name the packages were mounted by.
+	 * @return False if nothing is mounted by that name.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool UnmountPackages(const FString& MountName);
+
+	/**
+	 * Checks whether packages are mounted by a name.
+	 * @param MountName The name the packages were mounted by.
+	 * @return True if MountPackages mounted packages by that name.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Articy")
+	bool IsMounted(const FString& MountName) const { return MountedPackageNames.Contains(MountName); }
+
 	//---------------------------------------------------------------------------//
 
 	/**
@@ -316,6 +307,14 @@ public:
 	 */
 	UArticyObject* GetObjectUnshadowed(FArticyId Id, int32 CloneId = 0) const;
 
+	/**
+	 * Records the value of an object property before it is written in a shadowed operation, it is restored when the operation ends.
+	 * Does nothing at shadow level 0, or if the property was already recorded at the current level.
+	 * @param Object The object or feature that is written, it has to be loaded by this database.
+	 * @param Property The property that is written.
+	 */
+	void ShadowProperty(UObject* Object, const FProperty* Property);
+
 	/**
 	 * Get an object by its TechnicalName.
 	 * If a CloneId other than 0 is provided, a copy of the object with this index must exist,
@@ -407,6 +406,13 @@ public:
 	template<typename T = UArticyObject>
 	void GetObjects(TArray<T*>& Array, FName TechnicalName, int32 CloneId = 0) const;
 
+	/**
+	 * Get the position of an object in the object hierarchy of the imported packages.
+	 * @param Id The ID of the object.
+	 * @return The range of the object and its descendants, with Enter INDEX_NONE if it is not imported.
+	 */
+	FArticyHierarchyRange GetHierarchyRange(FArticyId Id) const { return GetObjectIndex().Hierarchy.FindRef(Id); }
+
 	//---------------------------------------------------------------------------//
 
 	/**
@@ -437,6 +443,23 @@ public:
 	template<typename T>
 	T* CloneFrom(FName TechnicalName, int32 NewCloneId = -1) { return Cast<T>(CloneFromByName(TechnicalName, NewCloneId)); }
 
+	/**
+	 * Clone many objects at once, each clone getting the next free clone Id of its object.
+	 * An ID may appear several times to get several clones of the same object.
+	 * Each object is looked up once and all clones are registered together, which is faster than a CloneFrom per clone.
+	 * @param Ids The IDs of the objects to clone.
+	 * @param OutClones Receives a clone per ID in the same order, nullptr for the IDs of objects that are not loaded.
+	 */
+	void CloneFromBatch(TConstArrayView<FArticyId> Ids, TArray<UArticyObject*>& OutClones);
+
+	/**
+	 * Clone many objects at once, each clone getting the next free clone Id of its object.
+	 * @param Ids The IDs of the objects to clone, an ID may appear several times.
+	 * @return A clone per ID in the same order, nullptr for the IDs of objects that are not loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy", meta = (DisplayName = "Clone From Batch"))
+	TArray<UArticyObject*> CloneFromBatchBP(const TArray<FArticyId>& Ids);
+
 	/**
 	 * Clone an existing object, and assign the NewCloneId to it.
 	 * @param Id The ID of the object to retrieve or clone.
@@ -483,29 +506,165 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	void SetExpressoScriptsClass(TSubclassOf<UArticyExpressoScripts> NewClass);
 
+	/** The state of a database reported by the articy.stats console command. */
+	struct FRuntimeStats
+	{
+		/** A loaded package. */
+		struct FPackage
+		{
+			FString Name;
+			int32 NumObjects = 0;
+
+			/** Estimated resident memory of the package, see GetPackageResidentBytes, 0 if not requested. */
+			int64 Bytes = 0;
+		};
+
+		TArray<FPackage> Packages;
+
+		/** Objects of all loaded packages, an object exported to several packages counts once. */
+		int32 NumObjects = 0;
+
+		/** Objects a runtime copy was made of because they were requested. */
+		int32 NumRuntimeCopies = 0;
+
+		/** Clones of the runtime copies, including the copies themselves. */
+		int32 NumClones = 0;
+
+		uint32 ShadowLevel = 0;
+
+		/** Property values saved by shadowed writes, restored when the shadow state is popped. */
+		int32 NumShadowedValues = 0;
+	};
+
+	/**
+	 * Gathers the state of this database for the articy.stats console command.
+	 * @param bIncludeMemory Whether to estimate the memory of the loaded packages, which visits all of their objects.
+	 * @return The state of the database.
+	 */
+	FRuntimeStats GetRuntimeStats(bool bIncludeMemory) const;
+
+	/**
+	 * Estimates the memory a loaded package keeps resident: its object assets, the runtime copies and clones
+	 * made of them and its string table entries. Objects exported to several packages count for each of them.
+	 * Visits all objects of the package, so it is meant for budgets and reports rather than every frame.
+	 * @param PackageName The name of the package.
+	 * @return The estimated size in bytes, 0 if the package is not loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	int64 GetPackageResidentBytes(const FString& PackageName) const;
+
+	/**
+	 * Writes the clone table to a snapshot, see FArticySnapshot: the IDs of all objects with clones and their clone IDs.
+	 * @param Ar The archive to write to.
+	 */
+	void SaveCloneTable(FArchive& Ar) const;
+
+	/**
+	 * Recreates the clones of a clone table written by SaveCloneTable.
+	 * Clones are never removed, so clones made since the snapshot was taken remain.
+	 * Objects whose package is not loaded are skipped.
+	 * @param Ar The archive to read from.
+	 * @return False if the table could not be read.
+	 */
+	bool LoadCloneTable(FArchive& Ar);
+
 protected:
 
 	/** A list of all packages that were imported from articy:draft. */
 	UPROPERTY(VisibleAnywhere, Category = "Articy")
 	TMap<FString, UArticyPackage*> ImportedPackages;
 
-	UPROPERTY(VisibleAnywhere, transient, Category = "Articy")
+	/** Names of the packages of each mount, they are part of ImportedPackages until they are unmounted. */
+	TMap<FString, TArray<FString>> MountedPackageNames;
+
+	/** Loaded state is never duplicated, every clone loads its own packages. */
+	UPROPERTY(VisibleAnywhere, transient, DuplicateTransient, Category = "Articy")
 	TArray<FString> LoadedPackages;
 
-	UPROPERTY()
-	TMap<FArticyId, UArticyCloneableObject*> LoadedObjectsById;
-	UPROPERTY()
-	TMap<FName, FArticyDatabaseObjectArray> LoadedObjectsByName;
+	/**
+	 * The runtime copies of loaded objects, with clone ID 0.
+	 * A copy is only made when the object is first requested, untouched objects are only referenced by their package asset.
+	 */
+	UPROPERTY(DuplicateTransient)
+	mutable TMap<FArticyId, UArticyObject*> LoadedObjectsById;
+
+	/** The further clones of the loaded objects that were cloned. */
+	UPROPERTY(DuplicateTransient)
+	mutable TMap<FArticyId, FArticyCloneList> ObjectClones;
+
+	/** A loaded object. */
+	struct FLoadedObject
+	{
+		/** The object in its package asset, shared by the databases of all worlds. */
+		UArticyObject* Asset = nullptr;
+
+		/** Number of loaded packages containing the object, an object can be exported to several packages. */
+		int32 RefCount = 0;
+	};
+
+	/** All loaded objects by ID, whether a runtime copy was made or not. */
+	TMap<FArticyId, FLoadedObject> LoadedObjects;
+
+	/** Packages with fewer assets are indexed on the calling thread only. */
+	static constexpr int32 MinParallelLoadAssets = 4096;
+
+	/** The objects of all imported packages by name and class, it does not change when packages are loaded or unloaded. */
+	struct FObjectIndex
+	{
+		TMap<FName, TArray<UArticyObject*>> ByName;
+
+		/** Every object is also listed under all of its super classes up to UArticyObject. */
+		TMap<const UClass*, TArray<UArticyObject*>> ByClass;
+
+		/** The position of every object reachable from a root of the parent hierarchy. */
+		TMap<FArticyId, FArticyHierarchyRange> Hierarchy;
+	};
+
+	/** Built on first use, clones share the index of the original asset. */
+	mutable TSharedPtr<const FObjectIndex> ObjectIndex;
+
+	const FObjectIndex& GetObjectIndex() const;
+
+	/** Whether an object of the index is the one that is loaded under its ID. */
+	bool IsLoadedAsset(const UArticyObject* Asset) const;
+
+	/**
+	 * Get a clone of a loaded object, making its runtime copy on first use.
+	 * @param Id The ID of the object.
+	 * @param CloneId The ID of the clone, 0 for the runtime copy.
+	 * @return The clone, or nullptr if the object is not loaded or has no such clone.
+	 */
+	UArticyObject* FindRuntimeObject(FArticyId Id, int32 CloneId = 0) const;
+
+	/**
+	 * Clone a loaded object.
+	 * @param Id The ID of the object.
+	 * @param CloneId The ID of the clone, -1 for the first free one.
+	 * @param bFailIfExists Return nullptr instead of the clone if it already exists.
+	 * @return The clone, or nullptr if the object is not loaded or the clone exists and bFailIfExists is set.
+	 */
+	UArticyObject* CloneRuntimeObject(FArticyId Id, int32 CloneId, bool bFailIfExists) const;
+
+	/**
+	 * Get the first loaded object with a name.
+	 * @param TechnicalName The technical name of the object.
+	 * @return The object in its package asset, or nullptr if none is loaded.
+	 */
+	const UArticyObject* FindLoadedAssetByName(FName TechnicalName) const;
 
 	UPROPERTY(Transient)
 	bool bIsInitialized = false;
 
 	void UnloadAllPackages();
 
+	/** The string table of a package, loaded and unloaded with the package */
+	static FName GetStringTableName(const FString& PackageName);
+
 private:
 
 	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UArticyDatabase>> Clones;
 	static TWeakObjectPtr<UArticyDatabase> PersistentClone;
+	static uint32 Generation;
 
 	UPROPERTY()
 	mutable UArticyExpressoScripts* CachedExpressoScripts;
@@ -516,6 +675,25 @@ private:
 
 	UArticyObject* GetObjectInternal(FArticyId Id, int32 CloneId = 0, bool bForceUnshadowed = false) const;
 
+	/** The value of an object property before it was first written at a shadow level. */
+	struct FPropertyShadow
+	{
+		uint32 ShadowLevel;
+		TWeakObjectPtr<UObject> Object;
+		const FProperty* Property;
+		/** Initialized with the property, destroyed when the value is restored. */
+		void* Value;
+	};
+
+	/**
+	 * Recorded property values in ascending order of their shadow level.
+	 * Not visible to the garbage collector, objects they reference are kept alive by the written property until it is restored.
+	 */
+	TArray<FPropertyShadow> PropertyShadows;
+
+	/** Restores the properties recorded at a shadow level when it is popped. */
+	void RestorePropertyShadows(uint32 ShadowLevel);
+
 	/** Get the original asset (on disk) of the database.
 	 * @param bLoadDefaultPackages If true, loads all packages.
 	 * @return A pointer to the original UArticyDatabase asset.
@@ -553,24 +731,25 @@ TArray<T*> UArticyDatabase::GetObjectsOfClass(int32 CloneId) const
 {
 	TArray<T*> arr;
 
-	TArray<UArticyCloneableObject*> ArticyObjects;
-	LoadedObjectsById.GenerateValueArray(ArticyObjects);
+	const TArray<UArticyObject*>* ArticyObjects = GetObjectIndex().ByClass.Find(T::StaticClass());
+	if (!ArticyObjects)
+	{
+		return arr;
+	}
 
-	for (auto obj : ArticyObjects)
+	arr.Reserve(ArticyObjects->Num());
+	for (const UArticyObject* Asset : *ArticyObjects)
 	{
-		/*if (obj->GetCloneId() == CloneId && Cast<T>(obj))
+		if (!IsLoadedAsset(Asset))
 		{
-			arr.Add(obj);
-		}*/
+			continue;
+		}
 
-		UArticyObject* Object = obj->Get(this, CloneId, false);
+		// The class index guarantees the type, clones share the class of their original
+		UArticyObject* Object = FindRuntimeObject(Asset->GetId(), CloneId);
 		if (Object)
 		{
-			T* TypedObject = Cast<T>(Object);
-			if (TypedObject)
-			{
-				arr.Add(TypedObject);
-			}
+			arr.Add(static_cast<T*>(Object));
 		}
 	}
 	return arr;
@@ -580,12 +759,15 @@ template<typename T>
 void UArticyDatabase::GetObjects(TArray<T*>& Array, FName TechnicalName, int32 CloneId) const
 {
 	//find all objects with this name
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
+	auto arr = GetObjectIndex().ByName.Find(TechnicalName);
 	if (arr)
 	{
-		for (auto obj : arr->Objects)
+		for (const UArticyObject* Asset : *arr)
 		{
-			auto clone = Cast<T>(obj->Clone(this, CloneId));
+			if (!IsLoadedAsset(Asset))
+				continue;
+
+			auto clone = Cast<T>(CloneRuntimeObject(Asset->GetId(), CloneId, true));
 			if (clone)
 				Array.Add(clone);
 		}
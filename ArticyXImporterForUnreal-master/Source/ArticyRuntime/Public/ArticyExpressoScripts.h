@@ -15,12 +15,19 @@ class UArticyInt;
 class UArticyBool;
 class UArticyExpressoScripts;
 struct ExpressoType;
+struct FArticyExpressoEvaluationScope;
+struct FArticyRandomStream;
+struct FArticyExpressoPropertyPath;
 
 /**
  * @brief The ExpressoType struct represents a flexible data type used in the Articy runtime.
  *
  * The ExpressoType struct is designed to handle various types of data within the Articy runtime, such as booleans, integers, floats, and strings.
  * It provides implicit conversion operators for different data types, allowing seamless interactions with properties in Articy objects.
+ *
+ * ExpressoType is a tagged union: booleans, integers and floats never allocate. A string is either owned, or a view of
+ * a string that outlives the value, like an interned string or a string property of an Articy object. Copying a view
+ * makes an owned copy, so only the temporary created for the view references the viewed string.
  */
 struct ARTICYRUNTIME_API ExpressoType
 {
@@ -29,72 +36,85 @@ struct ARTICYRUNTIME_API ExpressoType
         bool BoolValue;   ///< Boolean value of the ExpressoType
         int64 IntValue = 0;   ///< Integer value of the ExpressoType
         double FloatValue;   ///< Float value of the ExpressoType
+        const FString* StringView;   ///< Viewed string value of the ExpressoType, if bStringView is set
+        TTypeCompatibleBytes<FString> OwnedString;   ///< Owned string value of the ExpressoType, if bStringView is not set
     };
-    FString StringValue;   ///< String value of the ExpressoType
 
     /**
      * @brief Enumeration for the type of the ExpressoType.
      */
-    enum EType
+    enum EType : uint8
     {
         Undefined, Bool, Int, Float, String
     } Type = Undefined;   ///< The type of the ExpressoType
 
+    /**
+     * @brief Whether a string value is a view and not owned.
+     */
+    bool bStringView = false;
+
     /**
      * @brief Retrieves the boolean value of the ExpressoType.
      *
      * @return The boolean value.
      */
-    virtual bool& GetBool();
+    FORCEINLINE bool& GetBool() { return BoolValue; }
 
     /**
      * @brief Retrieves the boolean value of the ExpressoType.
      *
      * @return The boolean value.
      */
-    virtual const bool& GetBool() const;
+    FORCEINLINE const bool& GetBool() const { return BoolValue; }
 
     /**
      * @brief Retrieves the int64 value of the ExpressoType.
      *
      * @return The int64 value.
      */
-    virtual int64& GetInt();
+    FORCEINLINE int64& GetInt() { return IntValue; }
 
     /**
      * @brief Retrieves the int64 value of the ExpressoType.
      *
      * @return The int64 value.
      */
-    virtual const int64& GetInt() const;
+    FORCEINLINE const int64& GetInt() const { return IntValue; }
 
     /**
      * @brief Retrieves the double value of the ExpressoType.
      *
      * @return The double value.
      */
-    virtual double& GetFloat();
+    FORCEINLINE double& GetFloat() { return FloatValue; }
 
     /**
      * @brief Retrieves the double value of the ExpressoType.
      *
      * @return The double value.
      */
-    virtual const double& GetFloat() const;
+    FORCEINLINE const double& GetFloat() const { return FloatValue; }
 
     /**
      * @brief Retrieves the string value of the ExpressoType.
      *
+     * A viewed string is copied first, and a value of another type becomes an empty string.
+     *
      * @return The string value.
      */
-    virtual FString& GetString();
+    FString& GetString();
 
     /**
      * @brief Retrieves the string value of the ExpressoType.
      *
-     * @return The string value.
+     * @return The string value, or an empty string if this is not a string.
      */
-    virtual const FString& GetString() const;
+    FORCEINLINE const FString& GetString() const
+    {
+        if (Type != String)
+            return EmptyString();
+        return bStringView ? *StringView : *OwnedString.GetTypedPtr();
+    }
 
     /**
      * @brief Converts the ExpressoType instance to a string representation.
@@ -109,12 +129,52 @@ struct ARTICYRUNTIME_API ExpressoType
     /**
      * @brief Default constructor for ExpressoType.
      */
-    ExpressoType();
+    ExpressoType() {}
+
+    /**
+     * @brief Destructor for ExpressoType, releases an owned string.
+     */
+    ~ExpressoType() { Reset(); }
+
+    /**
+     * @brief Copy constructor, a viewed string is copied into an owned one.
+     */
+    ExpressoType(const ExpressoType& Other);
+
+    /**
+     * @brief Move constructor, keeps a viewed string a view.
+     */
+    ExpressoType(ExpressoType&& Other);
+
+    /**
+     * @brief Copy assignment, a viewed string is copied into an owned one.
+     */
+    ExpressoType& operator=(const ExpressoType& Other);
+
+    /**
+     * @brief Move assignment, keeps a viewed string a view.
+     */
+    ExpressoType& operator=(ExpressoType&& Other);
 
     /**
-     * @brief Virtual destructor for ExpressoType.
+     * @brief Creates a string ExpressoType that references Value instead of copying it.
+     *
+     * Value must outlive the returned temporary, copies of it own their string.
+     *
+     * @param Value The string to reference.
+     * @return The string view.
+     */
+    static ExpressoType MakeStringView(const FString& Value);
+
+    /**
+     * @brief Creates a string ExpressoType from a string literal without allocating after the first call.
+     *
+     * The literal is interned by its address, so Value must have static storage duration.
+     *
+     * @param Value The string literal.
+     * @return A view of the interned literal.
      */
-    virtual ~ExpressoType();
+    static ExpressoType Literal(const TCHAR* Value);
 
     /**
      * @brief Constructs an ExpressoType from an object and a property name.
@@ -126,6 +186,14 @@ struct ARTICYRUNTIME_API ExpressoType
      */
     ExpressoType(UArticyBaseObject* Object, const FString& Property);
 
+    /**
+     * @brief Constructs an ExpressoType from an object and a property resolved by a script call site.
+     *
+     * @param Object The object containing the property.
+     * @param Path The property path of the call site.
+     */
+    ExpressoType(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path);
+
     // ReSharper disable CppNonExplicitConvertingConstructor
 
     //implicit conversion from value type
@@ -214,6 +282,13 @@ struct ARTICYRUNTIME_API ExpressoType
      */
     ExpressoType(const FString& Value);
 
+    /**
+     * @brief Constructs an ExpressoType from a string value, taking its memory.
+     *
+     * @param Value The string value to initialize the ExpressoType with.
+     */
+    ExpressoType(FString&& Value);
+
     /**
      * @brief Constructs an ExpressoType from an FText value.
      *
@@ -589,6 +664,17 @@ struct ARTICYRUNTIME_API ExpressoType
      */
     const Definition& GetDefinition(const FName& CppType) const;
 
+    /**
+     * @brief Retrieves the definition matching the C++ type of a property.
+     *
+     * The definition is resolved once per property and cached, so accessing a property
+     * does not build its C++ type name every time.
+     *
+     * @param Property The property.
+     * @return The definition of the property type, or an empty definition for unknown types.
+     */
+    static const Definition& GetDefinition(const FProperty* Property);
+
     /**
      * @brief Adds a type definition for ExpressoType.
      *
@@ -612,6 +698,14 @@ struct ARTICYRUNTIME_API ExpressoType
      */
     void SetValue(UArticyBaseObject* Object, FString Property) const;
 
+    /**
+     * @brief Sets the value of a property resolved by a script call site on an object.
+     *
+     * @param Object The object containing the property.
+     * @param Path The property path of the call site.
+     */
+    void SetValue(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path) const;
+
     /**
      * @brief Attempts to reroute a property to a feature object.
      *
@@ -623,8 +717,58 @@ struct ARTICYRUNTIME_API ExpressoType
      * @return The feature object, if rerouted, or the original object if not rerouted.
      */
     static UArticyBaseObject* TryFeatureReroute(UArticyBaseObject* Object, FString& Property);
+
+    /**
+     * @brief Compares the string value to a string, case insensitive like FString comparison.
+     *
+     * @param Literal The string to compare to.
+     * @return True if this is a string equal to Literal.
+     */
+    bool EqualsLiteral(const TCHAR* Literal) const;
+
+    /**
+     * @brief Compares the string value to an ANSI string, case insensitive like FString comparison.
+     *
+     * @param Literal The string to compare to.
+     * @return True if this is a string equal to Literal.
+     */
+    bool EqualsLiteral(const ANSICHAR* Literal) const;
+
+private:
+    /**
+     * @brief Releases an owned string and makes this value undefined.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns the string that non-string values view.
+     */
+    static const FString& EmptyString();
+
+    /**
+     * @brief Returns the interned string of a name, so FName values don't allocate once they were seen.
+     */
+    static const FString& InternName(const FName& Name);
 };
 
+/**
+ * @brief Compares a string ExpressoType to a string literal without converting the literal.
+ *
+ * Only binds to character arrays, so comparisons with 0 still compare numbers.
+ * Like FString comparison, this is case insensitive.
+ */
+template <typename CharType, SIZE_T N>
+FORCEINLINE bool operator==(const ExpressoType& Lhs, const CharType (&Rhs)[N]) { return Lhs.EqualsLiteral(Rhs); }
+
+template <typename CharType, SIZE_T N>
+FORCEINLINE bool operator!=(const ExpressoType& Lhs, const CharType (&Rhs)[N]) { return !Lhs.EqualsLiteral(Rhs); }
+
+template <typename CharType, SIZE_T N>
+FORCEINLINE bool operator==(const CharType (&Lhs)[N], const ExpressoType& Rhs) { return Rhs.EqualsLiteral(Lhs); }
+
+template <typename CharType, SIZE_T N>
+FORCEINLINE bool operator!=(const CharType (&Lhs)[N], const ExpressoType& Rhs) { return !Rhs.EqualsLiteral(Lhs); }
+
 /**
  * @brief The Definition struct represents a type definition for ExpressoType.
  *
@@ -635,12 +779,12 @@ struct ExpressoType::Definition
     /**
      * @brief Factory function to create an ExpressoType from a property.
      */
-    TFunction<ExpressoType(UArticyBaseObject*, FProperty*)> Factory;
+    ExpressoType(*Factory)(UArticyBaseObject*, FProperty*) = nullptr;
 
     /**
      * @brief Setter function to set a property from an ExpressoType value.
      */
-    TFunction<void(UArticyBaseObject*, FProperty*, const ExpressoType&)> Setter;
+    void(*Setter)(UArticyBaseObject*, FProperty*, const ExpressoType&) = nullptr;
 };
 
 /**
@@ -662,7 +806,15 @@ void ExpressoType::AddDefinition(const FName& CppType)
             {
                 T* ptr = Property->ContainerPtrToValuePtr<T>(Object);
                 if (ptr)
-                    return ExpressoType(*ptr);
+                {
+                    // strings are read in place, the property outlives the temporary
+                    if constexpr (std::is_same_v<T, FString>)
+                        return ExpressoType::MakeStringView(*ptr);
+                    else if constexpr (std::is_same_v<T, FText>)
+                        return ExpressoType::MakeStringView(ptr->ToString());
+                    else
+                        return ExpressoType(*ptr);
+                }
             }
 
             return ExpressoType{};
@@ -681,6 +833,64 @@ void ExpressoType::AddDefinition(const FName& CppType)
     Definitions.Add(CppType, def);
 }
 
+/**
+ * @brief A property name used by a script, resolved once per object class.
+ *
+ * Generated scripts keep one for every getProp and setProp call with a literal property name,
+ * so the name is neither split nor looked up again while the objects keep their class.
+ * Property names only known at runtime use the path of their object class, see Find.
+ * Like the database, paths are only used from the game thread and do not lock their cache.
+ */
+struct ARTICYRUNTIME_API FArticyExpressoPropertyPath
+{
+    /**
+     * @brief Constructs a property path.
+     *
+     * @param InPath The property name, "Feature.Property" for a property of a feature.
+     */
+    explicit FArticyExpressoPropertyPath(const TCHAR* InPath);
+
+    /**
+     * @brief Finds the path of a property name on objects of the class of an object, adding it on first use.
+     *
+     * @param Object The object the property is accessed on, may be nullptr.
+     * @param InPath The property name, "Feature.Property" for a property of a feature.
+     * @return The path, valid until shutdown.
+     */
+    static FArticyExpressoPropertyPath& Find(const UArticyBaseObject* Object, const FString& InPath);
+
+    /**
+     * @brief Resolves the object holding the property and the property itself.
+     *
+     * @param Object The object the property is accessed on.
+     * @param OutProperty The property, nullptr if it was not found.
+     * @param OutDefinition The type definition of the property, nullptr if it was not found.
+     * @return The object or its feature holding the property, nullptr if the feature was not found.
+     */
+    UArticyBaseObject* Resolve(UArticyBaseObject* Object, FProperty*& OutProperty, const ExpressoType::Definition*& OutDefinition);
+
+    /** The property name as written in the script */
+    FString Path;
+
+private:
+    FName FeatureName;
+    FName PropertyName;
+
+    /** Lookups of the last classes the path was resolved on */
+    const UClass* ObjectClass = nullptr;
+    FObjectPropertyBase* FeatureProperty = nullptr;
+    const UClass* TargetClass = nullptr;
+    FProperty* TargetProperty = nullptr;
+    const ExpressoType::Definition* TargetDefinition = nullptr;
+};
+
+/**
+ * @brief The property path of a script call site, constructed on its first evaluation.
+ *
+ * @param Path The literal property name.
+ */
+#define ARTICY_PROPERTY_PATH(Path) ([]() -> FArticyExpressoPropertyPath& { static FArticyExpressoPropertyPath PropertyPath{ Path }; return PropertyPath; }())
+
 /**
  * @brief Addition operator for int and ExpressoType.
  *
@@ -821,14 +1031,20 @@ class ARTICYRUNTIME_API UArticyExpressoScripts : public UObject
 
 public:
 
+    /** A generated condition fragment, called on the expresso scripts instance it belongs to. */
+    using FConditionFunction = bool(*)(UArticyExpressoScripts* Scripts);
+
+    /** A generated instruction fragment, called on the expresso scripts instance it belongs to. */
+    using FInstructionFunction = void(*)(UArticyExpressoScripts* Scripts);
+
     /**
      * @brief Default constructor for UArticyExpressoScripts.
      */
     UArticyExpressoScripts()
     {
-        //add empty condition and instruction
-        Conditions.Add(GetTypeHash(FString{ "" }), [&] { return true; });
-        Instructions.Add(GetTypeHash(FString{ "" }), [&] { return; });
+        //add empty condition and instruction, they get index 0
+        AddCondition(GetTypeHash(FString{ "" }), [](UArticyExpressoScripts*) { return true; });
+        AddInstruction(GetTypeHash(FString{ "" }), [](UArticyExpressoScripts*) { return; });
     }
 
     /**
@@ -866,7 +1082,7 @@ public:
      *
      * @param Object The current object.
      */
-    void SetCurrentObject(UArticyPrimitive* Object) { self = Object; }
+    void SetCurrentObject(UArticyPrimitive* Object) { self = Object; PendingNode = nullptr; }
 
     /**
      * @brief Sets the speaker for dialog fragments.
@@ -875,7 +1091,19 @@ public:
      *
      * @param Speaker The speaker object.
      */
-    void SetSpeaker(UArticyObject* Speaker) { speaker = Speaker; }
+    void SetSpeaker(UArticyObject* Speaker) { speaker = Speaker; PendingNode = nullptr; }
+
+    /**
+     * @brief Sets the node the scripts run next belong to, without resolving it yet.
+     *
+     * Only a fragment that refers to self, speaker or the seen counter of self makes the node the current object
+     * and its speaker, or the speaker of the pin's owner, the speaker. Most fragments don't, so exploring the flow
+     * doesn't pay for the casts and the lookup of the owner on every node it visits.
+     *
+     * @param Node The node or pin being explored.
+     * @param Database The database to look the owner of a pin up in.
+     */
+    void SetPendingNode(UObject* Node, const UArticyDatabase* Database) { PendingNode = Node; PendingDatabase = Database; }
 
     /**
      * @brief Evaluates the condition and returns the result.
@@ -903,6 +1131,45 @@ public:
      */
     bool Execute(const int& InstructionFragmentHash, UArticyGlobalVariables* GV, UObject* MethodProvider) const;
 
+    /**
+     * @brief Finds the dense index of a condition fragment.
+     *
+     * Indices are assigned by the code generator and do not change until the next import,
+     * so fragments look theirs up once and evaluate by index from then on.
+     *
+     * @param ConditionFragmentHash The hash of the condition fragment.
+     * @return The index of the condition, or INDEX_NONE if there is no such condition.
+     */
+    int32 FindConditionIndex(const int& ConditionFragmentHash) const;
+
+    /**
+     * @brief Finds the dense index of an instruction fragment.
+     *
+     * @param InstructionFragmentHash The hash of the instruction fragment.
+     * @return The index of the instruction, or INDEX_NONE if there is no such instruction.
+     */
+    int32 FindInstructionIndex(const int& InstructionFragmentHash) const;
+
+    /**
+     * @brief Evaluates the condition at an index returned by FindConditionIndex.
+     *
+     * @param ConditionIndex The index of the condition fragment.
+     * @param GV The global variables used in the evaluation.
+     * @param MethodProvider The method provider used in the evaluation.
+     * @return The result of the evaluation.
+     */
+    bool EvaluateAt(int32 ConditionIndex, UArticyGlobalVariables* GV, UObject* MethodProvider) const;
+
+    /**
+     * @brief Executes the instruction at an index returned by FindInstructionIndex.
+     *
+     * @param InstructionIndex The index of the instruction fragment.
+     * @param GV The global variables used in the execution.
+     * @param MethodProvider The method provider used in the execution.
+     * @return True if the execution was successful, false otherwise.
+     */
+    bool ExecuteAt(int32 InstructionIndex, UArticyGlobalVariables* GV, UObject* MethodProvider) const;
+
     /**
      * @brief Sets a default method provider for script evaluation and execution.
      *
@@ -931,6 +1198,30 @@ public:
      */
     UObject* GetUserMethodsProviderObject() const;
 
+    /**
+     * @brief Retrieves the native interface of a user methods provider implemented in C++.
+     *
+     * Generated user methods call native providers through it with a virtual call, instead of the Execute_ thunk
+     * that finds the method by name and calls it through ProcessEvent. The result is cached for the last provider.
+     *
+     * @param MethodProvider The user methods provider object.
+     * @return The interface, or nullptr if the provider is a Blueprint, whose methods have to be called through Execute_.
+     */
+    template<typename InterfaceType>
+    InterfaceType* GetNativeUserMethodsProvider(UObject* MethodProvider) const
+    {
+        const UClass* ProviderClass = MethodProvider->GetClass();
+        if (MethodProvider != NativeProviderObject || ProviderClass != NativeProviderClass)
+        {
+            // Blueprint classes, including those derived from a native provider, may override the methods
+            NativeProviderObject = MethodProvider;
+            NativeProviderClass = ProviderClass;
+            NativeProvider = ProviderClass->HasAnyClassFlags(CLASS_Native) ? MethodProvider->GetNativeInterfaceAddress(InterfaceType::UClassType::StaticClass()) : nullptr;
+        }
+
+        return static_cast<InterfaceType*>(NativeProvider);
+    }
+
     /**
      * @brief Retrieves the active global variables instance.
      *
@@ -952,6 +1243,19 @@ protected:
      */
     virtual void SetGV(UArticyGlobalVariables* GV) const { }
 
+    /**
+     * @brief Binds the global variables and methods provider the fragments run against.
+     *
+     * SetGV is only called if the global variables change, so evaluating many fragments
+     * against the same binding does not rebind the generated namespace references every time.
+     *
+     * @param GV The global variables instance.
+     * @param MethodProvider The methods provider.
+     */
+    void Bind(UArticyGlobalVariables* GV, UObject* MethodProvider) const;
+
+    friend struct FArticyExpressoEvaluationScope;
+
     //========================================//
 
     /**
@@ -969,18 +1273,76 @@ protected:
     UArticyObject* speaker = nullptr;
 
     /**
-     * @brief Map of condition fragments.
+     * @brief Registers a condition fragment under the next dense index.
+     *
+     * Called by the generated constructor. A hash that is already registered keeps its function.
+     *
+     * @param Hash The hash of the condition fragment.
+     * @param Function The generated function of the fragment.
+     * @param bUsesCurrentObject False if the code generator found no reference to self or speaker, see SetPendingNode.
+     */
+    void AddCondition(uint32 Hash, FConditionFunction Function, bool bUsesCurrentObject = true);
+
+    /**
+     * @brief Registers an instruction fragment under the next dense index.
+     *
+     * @param Hash The hash of the instruction fragment.
+     * @param Function The generated function of the fragment.
+     * @param bUsesCurrentObject False if the code generator found no reference to self or speaker, see SetPendingNode.
+     */
+    void AddInstruction(uint32 Hash, FInstructionFunction Function, bool bUsesCurrentObject = true);
+
+    /**
+     * @brief Registers a condition fragment that compiles to the same code as another one and shares its index.
      *
-     * This map contains condition fragments identified by their hash values, represented as lambda functions.
+     * @param Hash The hash of the condition fragment.
+     * @param SharedHash The hash of the fragment whose function it shares, which may be registered later.
      */
-    TMap<uint32, TFunction<bool()>> Conditions;
+    void AddConditionAlias(uint32 Hash, uint32 SharedHash);
 
     /**
-     * @brief Map of instruction fragments.
+     * @brief Registers an instruction fragment that compiles to the same code as another one and shares its index.
      *
-     * This map contains instruction fragments identified by their hash values, represented as lambda functions.
+     * @param Hash The hash of the instruction fragment.
+     * @param SharedHash The hash of the fragment whose function it shares, which may be registered later.
+     */
+    void AddInstructionAlias(uint32 Hash, uint32 SharedHash);
+
+    /**
+     * @brief Jump table of condition fragments, indexed by the dense index of the fragment.
+     */
+    TArray<FConditionFunction> Conditions;
+
+    /**
+     * @brief Jump table of instruction fragments, indexed by the dense index of the fragment.
+     */
+    TArray<FInstructionFunction> Instructions;
+
+    /**
+     * @brief A bit per entry of Conditions and Instructions, set if the fragment needs the pending node bound.
      */
-    TMap<uint32, TFunction<void()>> Instructions;
+    TBitArray<> ConditionsUsingCurrentObject;
+    TBitArray<> InstructionsUsingCurrentObject;
+
+    /**
+     * @brief Dense index of every condition fragment by its hash, only used to resolve the indices.
+     */
+    TMap<uint32, int32> ConditionIndices;
+
+    /**
+     * @brief Dense index of every instruction fragment by its hash, only used to resolve the indices.
+     */
+    TMap<uint32, int32> InstructionIndices;
+
+    /**
+     * @brief Hash of the fragment whose function a shared condition fragment uses, by the hash of the shared fragment.
+     */
+    TMap<uint32, uint32> ConditionAliases;
+
+    /**
+     * @brief Hash of the fragment whose function a shared instruction fragment uses, by the hash of the shared fragment.
+     */
+    TMap<uint32, uint32> InstructionAliases;
 
     /**
      * @brief Retrieves an Articy object by name or ID.
@@ -993,6 +1355,15 @@ protected:
      */
     UArticyObject* getObj(const FString& NameOrId, const uint32& CloneId = 0) const;
 
+    /**
+     * @brief Retrieves an Articy object by an ID parsed when the script was generated.
+     *
+     * @param Id The ID of the object.
+     * @param CloneId The clone ID of the object.
+     * @return The Articy object.
+     */
+    UArticyObject* getObj(const FArticyId& Id, const uint32& CloneId = 0) const;
+
     /**
      * @brief Sets the value of a property on an Articy object.
      *
@@ -1015,6 +1386,24 @@ protected:
      */
     void setProp(const ExpressoType& Id_CloneId, const FString& Property, const ExpressoType& Value) const;
 
+    /**
+     * @brief Sets the value of a property resolved by the call site on an Articy object.
+     *
+     * @param Object The Articy object containing the property.
+     * @param Path The property path of the call site.
+     * @param Value The value to set.
+     */
+    static void setProp(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path, const ExpressoType& Value);
+
+    /**
+     * @brief Sets the value of a property resolved by the call site on an Articy object.
+     *
+     * @param Id_CloneId The compound ID of the object.
+     * @param Path The property path of the call site.
+     * @param Value The value to set.
+     */
+    void setProp(const ExpressoType& Id_CloneId, FArticyExpressoPropertyPath& Path, const ExpressoType& Value) const;
+
     /**
      * @brief Retrieves the value of a property on an Articy object.
      *
@@ -1037,10 +1426,28 @@ protected:
      */
     ExpressoType getProp(const ExpressoType& Id_CloneId, const FString& Property) const;
 
+    /**
+     * @brief Retrieves the value of a property resolved by the call site on an Articy object.
+     *
+     * @param Object The Articy object containing the property.
+     * @param Path The property path of the call site.
+     * @return The value of the property.
+     */
+    static ExpressoType getProp(UArticyBaseObject* Object, FArticyExpressoPropertyPath& Path);
+
+    /**
+     * @brief Retrieves the value of a property resolved by the call site on an Articy object.
+     *
+     * @param Id_CloneId The compound ID of the object.
+     * @param Path The property path of the call site.
+     * @return The value of the property.
+     */
+    ExpressoType getProp(const ExpressoType& Id_CloneId, FArticyExpressoPropertyPath& Path) const;
+
     /**
      * @brief Generates a random integer between Min and Max.
      *
-     * This method returns a random integer between the specified minimum and maximum values.
+     * This method returns a random integer between the specified minimum and maximum values. It draws from the bound random stream, if any.
      *
      * @param Min The minimum value.
      * @param Max The maximum value.
@@ -1051,7 +1458,7 @@ protected:
     /**
      * @brief Generates a random integer between 0 and Max.
      *
-     * This method returns a random integer between 0 and the specified maximum value.
+     * This method returns a random integer between 0 and the specified maximum value. It draws from the bound random stream, if any.
      *
      * @param Max The maximum value.
      * @return The random integer.
@@ -1061,7 +1468,7 @@ protected:
     /**
      * @brief Generates a random float between Min and Max.
      *
-     * This method returns a random float between the specified minimum and maximum values.
+     * This method returns a random float between the specified minimum and maximum values. It draws from the bound random stream, if any.
      *
      * @param Min The minimum value.
      * @param Max The maximum value.
@@ -1072,7 +1479,7 @@ protected:
     /**
      * @brief Generates a random float between 0 and Max.
      *
-     * This method returns a random float between 0 and the specified maximum value.
+     * This method returns a random float between 0 and the specified maximum value. It draws from the bound random stream, if any.
      *
      * @param Max The maximum value.
      * @return The random float.
@@ -1371,6 +1778,36 @@ protected:
      */
     mutable UObject* UserMethodsProvider = nullptr;
 
+    /**
+     * @brief The provider GetNativeUserMethodsProvider was last called with, its class and its native interface.
+     */
+    mutable const UObject* NativeProviderObject = nullptr;
+    mutable const UClass* NativeProviderClass = nullptr;
+    mutable void* NativeProvider = nullptr;
+
+    /**
+     * @brief The global variables instance last passed to SetGV.
+     */
+    mutable UArticyGlobalVariables* BoundGV = nullptr;
+
+    /**
+     * @brief The random stream random() draws from, bound by the flow player evaluating the scripts.
+     *
+     * If none is bound, random() draws from FMath's global generator.
+     */
+    mutable FArticyRandomStream* BoundRandomStream = nullptr;
+
+    /**
+     * @brief The node set by SetPendingNode that is not the current object yet, and the database to resolve it in.
+     */
+    UObject* PendingNode = nullptr;
+    const UArticyDatabase* PendingDatabase = nullptr;
+
+    /**
+     * @brief Makes the pending node the current object and sets its speaker, called before a fragment needing them runs.
+     */
+    void BindPendingNode();
+
     /**
      * @brief Default methods provider for script evaluation.
      *
@@ -1408,6 +1845,41 @@ private:
     static void PrintInternal(const FString& msg);
 };
 
+/**
+ * @brief Binds global variables and a methods provider to an expresso scripts instance for the lifetime of the scope.
+ *
+ * Evaluate and Execute calls with the same global variables and methods provider inside the scope
+ * run without rebinding. The previous binding is restored when the scope ends, so scopes can be nested.
+ * A random stream bound by an outer scope stays bound in inner scopes that pass none.
+ */
+struct ARTICYRUNTIME_API FArticyExpressoEvaluationScope
+{
+    /**
+     * @brief Binds GV and MethodProvider to InScripts.
+     *
+     * @param InScripts The expresso scripts instance, may be nullptr.
+     * @param GV The global variables instance.
+     * @param MethodProvider The methods provider.
+     * @param RandomStream The stream random() draws from, nullptr keeps the one bound already.
+     */
+    FArticyExpressoEvaluationScope(const UArticyExpressoScripts* InScripts, UArticyGlobalVariables* GV, UObject* MethodProvider,
+        FArticyRandomStream* RandomStream = nullptr);
+
+    /**
+     * @brief Restores the previous binding.
+     */
+    ~FArticyExpressoEvaluationScope();
+
+    FArticyExpressoEvaluationScope(const FArticyExpressoEvaluationScope&) = delete;
+    FArticyExpressoEvaluationScope& operator=(const FArticyExpressoEvaluationScope&) = delete;
+
+private:
+    const UArticyExpressoScripts* Scripts;
+    UArticyGlobalVariables* PreviousGV = nullptr;
+    UObject* PreviousMethodProvider = nullptr;
+    FArticyRandomStream* PreviousRandomStream = nullptr;
+};
+
 /**
  * @brief Prints a formatted message to the log.
  *
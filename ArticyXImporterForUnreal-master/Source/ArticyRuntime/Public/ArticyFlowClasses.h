@@ -95,9 +95,10 @@ public:
 
     /**
      * Retrieves the target object of the jump.
+     * @param Database The database to resolve the target in, looked up if null.
      * @return Pointer to the target UArticyPrimitive object.
      */
-    UArticyPrimitive* GetTarget() const;
+    UArticyPrimitive* GetTarget(const UArticyDatabase* Database = nullptr) const;
 
     /**
      * Retrieves the ID of the target.
@@ -107,9 +108,10 @@ public:
 
     /**
      * Retrieves the target pin of the jump.
+     * @param Database The database to resolve the target in, looked up if null.
      * @return Pointer to the target UArticyFlowPin object.
      */
-    UArticyFlowPin* GetTargetPin() const;
+    UArticyFlowPin* GetTargetPin(const UArticyDatabase* Database = nullptr) const;
 
     /**
      * Retrieves the ID of the target pin.
@@ -120,10 +122,11 @@ public:
     /**
      * Explores the flow from this jump to its target pin.
      * @param Player The flow player performing the exploration.
+     * @param Context The database, global variables, scripts and methods provider of the exploration.
      * @param OutBranches The array to store resulting branches.
      * @param Depth The current depth of exploration.
      */
-    void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+    void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
 
 protected:
 
@@ -144,4 +147,10 @@ private:
     /** Cached pointer to the target object. */
     UPROPERTY(VisibleAnywhere, Transient, Category = "Articy")
     mutable UArticyPrimitive* TargetObj;
+
+    /** Database generation the cached pointers were resolved in, see UArticyDatabase::GetGeneration. */
+    mutable uint32 TargetGeneration = 0;
+
+    /** Drops the cached pointers if packages were loaded or unloaded since they were resolved. */
+    void ValidateTargetCache() const;
 };
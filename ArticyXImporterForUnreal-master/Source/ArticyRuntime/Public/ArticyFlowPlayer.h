@@ -5,8 +5,10 @@
 #pragma once
 
 #include "ArticyRuntimeModule.h"
+#include "ArticyRuntimeStats.h"
 #include "ArticyDatabase.h"
 #include "ArticyGlobalVariables.h"
+#include "ArticyRandomStream.h"
 #include "ArticyRef.h"
 #include "Components/BillboardComponent.h"
 #include "Containers/Queue.h"
@@ -14,6 +16,9 @@
 
 class IArticyNode;
 class IArticyFlowObject;
+class UArticyExpressoScripts;
+struct FArticyFlowRecording;
+struct FArticyExploreWatch;
 
 /**
  * Enum representing the various types of Articy flow nodes that can be paused on.
@@ -59,6 +64,33 @@ public:
     TScriptInterface<IArticyFlowObject> GetTarget() const;
 };
 
+/**
+ * The texts of a branch's target, resolved ahead of display by UArticyFlowPlayer::PrepareBranchTexts.
+ */
+struct ARTICYRUNTIME_API FArticyPreparedBranchTexts
+{
+    /** Index of the branch in the array the texts were prepared for. */
+    int32 BranchIndex = -1;
+
+    /** The text of the target, empty if it has none. */
+    FText Text;
+
+    /** The menu text of the target, empty if it has none. */
+    FText MenuText;
+};
+
+/**
+ * What all objects visited by one exploration share, resolved once when the exploration starts
+ * instead of for every pin it visits.
+ */
+struct FArticyExploreContext
+{
+    const UArticyDatabase* Database = nullptr;
+    UArticyGlobalVariables* GVs = nullptr;
+    UArticyExpressoScripts* Scripts = nullptr;
+    UObject* MethodProvider = nullptr;
+};
+
 /**
  * This component handles traversal of the flow, starting and halting at specific nodes.
  * The GlobalVariables instance and the UserMethodProvider used for this flow player
@@ -144,6 +176,12 @@ public:
      */
     TArray<FArticyBranch> Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent = true);
 
+    /** Explore within an exploration already started, sharing its context. */
+    TArray<FArticyBranch> Explore(const FArticyExploreContext& Context, IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent = true);
+
+    /** Resolve the database, GVs, scripts and methods provider an exploration started now uses. */
+    FArticyExploreContext MakeExploreContext();
+
     void SetPauseOn(EArticyPausableType Types);
     /** Returns true if Node is one of the PauseOn types. */
     bool ShouldPauseOn(IArticyFlowObject* Node) const;
@@ -173,6 +211,67 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Flow")
     const TArray<FArticyBranch>& GetAvailableBranches() const { return AvailableBranches; }
 
+    /** Whether BranchLimit cut the available branches short. */
+    UFUNCTION(BlueprintPure, Category = "Flow")
+    bool AreBranchesPartial() const { return bBranchesPartial; }
+
+    /** Whether an exploration spread over several frames is still running, see ExploreBudgetMicroseconds. There are no available branches until it completes. */
+    UFUNCTION(BlueprintPure, Category = "Flow")
+    bool IsExploring() const { return bExplorationSuspended; }
+
+    /**
+     * Get the dialogues and dialogue fragments reachable within the next Pauses pause points along the
+     * available branches, e.g. to start streaming their voice-over before a branch is picked.
+     * The branches are played and explored in shadow states, nothing the player or the variables see changes.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    TArray<TScriptInterface<IArticyFlowObject>> PredictUpcoming(int32 Pauses = 1);
+
+    /**
+     * Localize and resolve the texts and menu texts of the branches' targets ahead of display, on a worker thread
+     * where possible, see UArticyTextExtension::PrepareTexts. The variables are captured when this is called,
+     * OnPrepared is called on the game thread with one entry per branch, widgets only need to swap in the texts.
+     */
+    void PrepareBranchTexts(const TArray<FArticyBranch>& Branches, TFunction<void(TArray<FArticyPreparedBranchTexts>&&)> OnPrepared) const;
+
+    //---------------------------------------------------------------------------//
+
+    /**
+     * Restart the stream random() in scripts draws from with a seed, the same seed and choices replay the same numbers.
+     * The available branches are not explored again.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Setup")
+    void SetRandomSeed(int32 Seed);
+
+    /** Get the seed the random stream of scripts was started with. */
+    UFUNCTION(BlueprintPure, Category = "Setup")
+    int32 GetRandomSeed() const { return RandomStream.GetSeed(); }
+
+    /** Get the number of values drawn from the random stream of scripts, with the seed it restores the stream. */
+    uint64 GetRandomDraws() const { return RandomStream.GetCounter(); }
+
+    /** Restart the random stream of scripts with a seed after a number of draws, e.g. to continue a recorded session. */
+    void SetRandomState(int32 Seed, uint64 Draws);
+
+    //---------------------------------------------------------------------------//
+
+    /**
+     * Record every SetCursorTo, PlayBranch, FinishCurrentPausedObject and SetRandomSeed from now on, starting
+     * from the current dialogue state and random stream, for FArticyFlowReplay to play back.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Recording")
+    void StartRecording();
+
+    /** Stop recording and write the recording to a file, false if the player was not recording or the file could not be written. */
+    UFUNCTION(BlueprintCallable, Category = "Recording")
+    bool StopRecording(const FString& Filename);
+
+    UFUNCTION(BlueprintPure, Category = "Recording")
+    bool IsRecording() const { return Recording.IsValid(); }
+
+    /** Get the recording in progress, nullptr if not recording. */
+    const FArticyFlowRecording* GetRecording() const { return Recording.Get(); }
+
     //---------------------------------------------------------------------------//
 
     /** Wether bIgnoreInvalidBranches is set. */
@@ -186,6 +285,9 @@ public:
     DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPlayerPaused, TScriptInterface<IArticyFlowObject>, PausedOn);
     DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBranchesUpdated, const TArray<FArticyBranch>&, AvailableBranches);
 
+    DECLARE_MULTICAST_DELEGATE(FOnShadowOpNative);
+    DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlayerPausedNative, TScriptInterface<IArticyFlowObject>);
+    DECLARE_MULTICAST_DELEGATE_OneParam(FOnBranchesUpdatedNative, const TArray<FArticyBranch>&);
 
     /** This event is broadcast whenever a new ShadowedOperation starts. */
     UPROPERTY(BlueprintAssignable, Category = "Flow")
@@ -208,23 +310,54 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "Flow")
     FOnBranchesUpdated OnBranchesUpdated;
 
+    /** Native versions of the events above for C++ listeners, broadcast before them without going through reflection. */
+    FOnShadowOpNative OnShadowOpStartNative;
+    FOnShadowOpNative OnShadowOpEndNative;
+    FOnPlayerPausedNative OnPlayerPausedNative;
+    FOnBranchesUpdatedNative OnBranchesUpdatedNative;
+
 protected:
 
     //========================================//
 
     /**
-     * If this number of branches is reached, no more branches will be added.
+     * If this number of branches is reached, no more branches will be added, 0 for no limit.
+     * The branches are flagged partial then, see AreBranchesPartial.
      */
-     // [Alewinn] : no valid reference in code, limit most probably set at Articy side.
-     //UPROPERTY(EditAnywhere, Category = "Setup", meta=(ClampMin=0))
-     //int32 BranchLimit = 32;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+    int32 BranchLimit = 0;
 
-     /**
-      * If a branch reaches this length, exploration on it is aborted.
-      */
+    /**
+     * If a branch reaches this length, exploration on it is aborted.
+     */
     UPROPERTY(EditAnywhere, Category = "Setup", meta = (ClampMin = 0))
     int32 ExploreLimit = 128;
 
+    /**
+     * Time in microseconds exploring may take per frame, 0 to always explore in one go.
+     * Once it is spent, the exploration continues on the next frame and OnBranchesUpdated is broadcast when it completes.
+     * The parts of the flow explored in earlier frames are not explored again, the variables are read as they are in each frame.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+    int32 ExploreBudgetMicroseconds = 0;
+
+    /**
+     * Updates of the available branches exploring longer than this many microseconds are dumped to the profiling
+     * directory, 0 to not time them. A dump holds the cursor, the nodes visited, the most expensive scripts and the variables,
+     * with a flow recording that Articy.ReplayFlow times the same exploration with.
+     * While the watchdog is armed, every node and script of an exploration is counted and timed.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (ClampMin = 0))
+    int32 SlowExploreMicroseconds = 0;
+
+    /** Updates of the available branches visiting more nodes and pins than this are dumped like slow ones, 0 to not count them. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (ClampMin = 0))
+    int32 SlowExploreNodes = 0;
+
+    /** Seconds that pass at least between two dumps of slow explorations, shared by all flow players. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (ClampMin = 0))
+    float SlowExploreDumpInterval = 60.f;
+
     /**
      * If more than this amount of ShadowLevels are needed at the same time,
      * branch exploration will abort.
@@ -238,9 +371,38 @@ protected:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
     bool bIgnoreInvalidBranches = true;
 
+    /**
+     * Whether OnShadowOpStart and OnShadowOpEnd are broadcast. Exploration starts a ShadowedOperation for
+     * every branch, so they are only broadcast if something listens to them.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bBroadcastShadowOps = false;
+
+    /**
+     * Explore and broadcast OnPlayerPaused and OnBranchesUpdated once at the next dispatch of queued branches
+     * instead of right away. All updates until then are collapsed into one, and handlers calling Play don't
+     * explore again inside the broadcast. AvailableBranches are only updated by the dispatch then.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bDeferFlowEvents = false;
+
+    /**
+     * How many pauses ahead the assets of upcoming nodes are streamed in whenever the branches are updated.
+     * 0 disables prefetching. See UArticyAssetPrefetcher.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+    int32 PrefetchPauses = 0;
+
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Setup", meta = (ArticyClassRestriction = "ArticyNode"))
     FArticyRef StartOn;
 
+    /**
+     * The seed of the stream random() in scripts draws from, each flow player has its own stream.
+     * 0 picks a random seed on BeginPlay.
+     */
+    UPROPERTY(EditAnywhere, Category = "Setup")
+    int32 RandomSeed = 0;
+
     /** All the branches available at the current flow position. */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Flow")
     TArray<FArticyBranch> AvailableBranches;
@@ -272,11 +434,83 @@ private:
     UPROPERTY(Transient, VisibleAnywhere, Category = "Debug")
     mutable uint32 ShadowLevel = 0;
 
+    /**
+     * The stream random() in scripts draws from while this player evaluates them.
+     * Shadowed operations restore its counter, so a draw while exploring repeats when the branch is played.
+     */
+    mutable FArticyRandomStream RandomStream;
+
+    /** The recording in progress, see StartRecording. */
+    TSharedPtr<FArticyFlowRecording> Recording;
+
+    /** A shadow request that a side-effect-free object passed on to the objects it continues at. */
+    bool bShadowPending = false;
+
     TQueue<FArticyBranch> BranchQueue;
-    FTSTicker::FDelegateHandle TickerHandle;
+
+    /** Whether this player is waiting in QueuedPlayers. */
+    bool bQueuedForDispatch = false;
+
+    /** Whether an update of the branches is deferred to the next dispatch, see bDeferFlowEvents, and if it is a startup one. */
+    bool bBranchesUpdatePending = false;
+    bool bPendingStartupUpdate = false;
+
+    /** Set while the dispatch explores, so the update isn't deferred again. */
+    bool bDispatchingFlowEvents = false;
+
+    /** Players with queued branches, all of them are played in one core ticker callback on the next frame. */
+    static TArray<TWeakObjectPtr<UArticyFlowPlayer>> QueuedPlayers;
+    static FTSTicker::FDelegateHandle DispatchHandle;
+
+    /** Queue this player for the next dispatch, registering the ticker if no other player did. */
+    void QueueForDispatch();
+
+    /** Play the branches of all queued players, the ticker only stays registered while players are queued. */
+    static bool DispatchQueuedBranches(float DeltaTime);
 
     UArticyExpressoScripts* CachedExpressoInstance = nullptr;
 
+    /** Set if BranchLimit cut AvailableBranches short. */
+    bool bBranchesPartial = false;
+
+    /** Branches the exploration in progress ended so far, for BranchLimit. */
+    int32 NumExploredBranches = 0;
+
+    /** An Explore call still running in a sliced exploration, see ExploreBudgetMicroseconds. */
+    struct FExploreSliceLevel
+    {
+        /** Branches of the Explore calls this one made that already completed, in call order. */
+        TArray<TArray<FArticyBranch>> Completed;
+
+        /** Explore calls this one made in the current slice. */
+        int32 NextCall = 0;
+    };
+
+    /** The calls of the sliced exploration still running, by level of nesting. */
+    TArray<FExploreSliceLevel> SliceLevels;
+    int32 SliceLevel = 0;
+
+    /** FPlatformTime::Seconds the current slice ends at, 0 while not slicing. */
+    double SliceDeadline = 0.0;
+
+    /** Set once the deadline passed in a slice and after a call completed in it. */
+    bool bSliceSuspended = false;
+    bool bSliceProgressed = false;
+
+    /** Whether an exploration continues on the next frame, if it is a startup one, and the fallback queries when it started. */
+    bool bExplorationSuspended = false;
+    bool bExplorationStartup = false;
+    uint32 ExplorationFallbackQueries = 0;
+
+    /** What the slow exploration watchdog collected about the update in progress, see SlowExploreMicroseconds. Kept to reuse its memory. */
+    TSharedPtr<FArticyExploreWatch> ExploreWatch;
+
+    /** The watch while ExploreAvailableBranches runs with the watchdog armed, null otherwise. */
+    FArticyExploreWatch* ActiveExploreWatch = nullptr;
+
+    /** FPlatformTime::Seconds of the last slow exploration dump of any player. */
+    static double LastSlowExploreDump;
+
 private:
     /**
      * Updates the list of available branches.
@@ -286,6 +520,22 @@ private:
      */
     void UpdateAvailableBranchesInternal(bool Startup);
 
+    /** Explore from the cursor and publish the branches, or continue the exploration of the last frame. */
+    void ExploreAvailableBranches(bool Startup);
+
+    /** Dump the completed exploration if it exceeded SlowExploreMicroseconds or SlowExploreNodes and no dump was written recently. */
+    void CheckSlowExploration(const FArticyExploreWatch& Watch, bool Startup);
+
+    /** The part of Explore that explores a node, Explore answers the calls of a sliced exploration earlier slices completed. */
+    TArray<FArticyBranch> ExploreNode(const FArticyExploreContext& Context, IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent);
+
+    /** Execute the nodes of a branch and count them as seen, with the variables bound once for the path. */
+    void CommitBranch(const FArticyBranch& Branch);
+
+    /** Collect the dialogue nodes of Branches, following each branch for Pauses - 1 more pauses. Expanded keeps the pauses left at each target already followed. */
+    void PredictBranches(const TArray<FArticyBranch>& Branches, int32 Pauses, TMap<UObject*, int32>& Expanded,
+        TSet<UObject*>& Collected, TArray<TScriptInterface<IArticyFlowObject>>& OutNodes);
+
     /** The current position in the flow. */
     UPROPERTY(Transient)
     TScriptInterface<IArticyFlowObject> Cursor = nullptr;
@@ -299,9 +549,6 @@ private:
      */
     bool FastForwardToPause();
 
-    /** Returns a ptr to the unshadowed object of this node */
-    IArticyFlowObject* GetUnshadowedNode(IArticyFlowObject* Node);
-
     UArticyDatabase* GetDB() const;
 };
 
@@ -331,23 +578,40 @@ void UArticyFlowPlayer::ShadowedOperation(Lambda Operation) const
         return;
     }
 
+    ARTICY_SCOPE_CYCLE_COUNTER(STAT_ArticyShadowedOperation);
+    FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::ShadowPushes);
+
     //push shadow state
     ++ShadowLevel;
+    const uint64 committedDraws = RandomStream.GetCounter();
+    ARTICY_FLOW_TRACE_EVENT(ShadowChanged, this, ShadowLevel, true);
 
     //notify on push
     GetGVs()->PushState(ShadowLevel);
     GetGVs()->PushSeen();
     UArticyDatabase::Get(this)->PushState(ShadowLevel);
-    OnShadowOpStart.Broadcast();
+    if (bBroadcastShadowOps)
+    {
+        OnShadowOpStartNative.Broadcast();
+        if (OnShadowOpStart.IsBound())
+            OnShadowOpStart.Broadcast();
+    }
 
     //execute the operation
     Operation();
 
     //notify on pop
-    OnShadowOpEnd.Broadcast();
+    if (bBroadcastShadowOps)
+    {
+        OnShadowOpEndNative.Broadcast();
+        if (OnShadowOpEnd.IsBound())
+            OnShadowOpEnd.Broadcast();
+    }
     UArticyDatabase::Get(this)->PopState(ShadowLevel);
     GetGVs()->PopSeen();
     GetGVs()->PopState(ShadowLevel);
+    RandomStream.SetCounter(committedDraws);
+    ARTICY_FLOW_TRACE_EVENT(ShadowChanged, this, ShadowLevel, false);
 
     //pop shadow state
     if (ensure(ShadowLevel > 0))
@@ -356,6 +620,7 @@ void UArticyFlowPlayer::ShadowedOperation(Lambda Operation) const
 
 /**
  * Represents an actor for debugging Articy flows.
+ * To debug without changing the frame, e.g. on devkits, trace the ArticyFlow channel instead, see ArticyFlowTrace.h.
  */
 UCLASS(BlueprintType, HideCategories = (Replication, Physics, Rendering, Input, Collision, Actor, LOD, Cooking))
 class AArticyFlowDebugger : public AActor
@@ -0,0 +1,116 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UArticyFlowPlayer;
+
+/**
+ * @brief A trace of a flow player for replaying a play session.
+ *
+ * Holds the dialogue state when recording started as an FArticySnapshot, the state of the player's random
+ * stream and every call that moved the player, in one versioned byte buffer. Recorded by
+ * UArticyFlowPlayer::StartRecording and played back by FArticyFlowReplay.
+ */
+struct ARTICYRUNTIME_API FArticyFlowRecording
+{
+	/** Versions of the recording format, recordings of all older versions can be loaded. */
+	enum class EVersion : int32
+	{
+		Initial = 1,
+
+		// add new versions above this line
+		VersionPlusOne,
+		Latest = VersionPlusOne - 1
+	};
+
+	enum class EStepType : uint8
+	{
+		/** SetCursorTo the object Id with clone Value. */
+		SetCursor,
+		/** PlayBranch the available branch whose FArticyBranch::Index is Value. */
+		PlayBranch,
+		/** FinishCurrentPausedObject on pin Value. */
+		FinishPausedObject,
+		/** SetRandomSeed with seed Value. */
+		SetRandomSeed
+	};
+
+	struct FStep
+	{
+		EStepType Type = EStepType::SetCursor;
+		int32 Value = 0;
+		uint64 Id = 0;
+	};
+
+	/** Seed and draws of the player's random stream when recording started. */
+	int32 RandomSeed = 0;
+	uint64 RandomDraws = 0;
+
+	/** ID of the cursor when recording started, 0 if there was none. */
+	uint64 StartId = 0;
+
+	/** Setup of the recorded player, the replay plays with the same one. */
+	uint8 PauseOn = 0;
+	bool bIgnoreInvalidBranches = false;
+
+	/** The dialogue state when recording started. */
+	TArray<uint8> InitialState;
+
+	TArray<FStep> Steps;
+
+	/**
+	 * @brief Starts over on the current state of a flow player.
+	 *
+	 * @param Player The player to record.
+	 * @return False if the state can't be saved now, e.g. during a shadowed operation.
+	 */
+	bool Begin(UArticyFlowPlayer* Player);
+
+	void AddStep(EStepType Type, int32 Value, uint64 Id = 0) { Steps.Add({ Type, Value, Id }); }
+
+	/**
+	 * @brief Writes the recording to a byte buffer, replacing its contents.
+	 *
+	 * @param OutBytes The buffer to write to.
+	 * @return False if writing failed.
+	 */
+	bool Save(TArray<uint8>& OutBytes) const;
+
+	/**
+	 * @brief Reads a recording written by Save.
+	 *
+	 * @param Bytes The recording.
+	 * @return False if the data is no recording of a supported version.
+	 */
+	bool Load(const TArray<uint8>& Bytes);
+
+	bool SaveToFile(const FString& Filename) const;
+	bool LoadFromFile(const FString& Filename);
+};
+
+/**
+ * @brief Plays a recording back on a flow player, timing every step.
+ *
+ * Branches are committed right away instead of on the next frame, so the player needs no world.
+ */
+struct ARTICYRUNTIME_API FArticyFlowReplay
+{
+	/** Time of each step of the last Run in microseconds, in the order of the recording. */
+	TArray<double> StepMicroseconds;
+
+	/** Steps of the last Run that did not fit the flow, e.g. a branch no longer available; they are skipped. */
+	int32 NumMismatches = 0;
+
+	/**
+	 * @brief Restores the initial state of a recording and applies all of its steps.
+	 *
+	 * @param Recording The recording to replay.
+	 * @param Player The player to replay on, its setup, database and variables are restored too.
+	 * @return False if the initial state could not be restored.
+	 */
+	bool Run(const FArticyFlowRecording& Recording, UArticyFlowPlayer* Player);
+};
@@ -0,0 +1,77 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+
+/**
+ * Flow events for remote debugging, compiled out of Shipping builds. They are only written while the ArticyFlow
+ * channel is enabled (-trace=ArticyFlow or Trace.Enable ArticyFlow), so a flow player only tests the channel
+ * while nobody is listening. The ArticyFlowTrace commandlet of the editor rebuilds the flow timeline from a trace.
+ */
+#ifndef ARTICY_FLOW_TRACE
+#define ARTICY_FLOW_TRACE (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+#endif
+
+#if ARTICY_FLOW_TRACE
+UE_TRACE_CHANNEL_EXTERN(ArticyFlowChannel, ARTICYRUNTIME_API);
+
+/**
+ * Writes the events of the ArticyFlow channel.
+ * Flow players, scripts and variables only run on the game thread, so players are named on first use without locking.
+ */
+struct ARTICYRUNTIME_API FArticyFlowTrace
+{
+	/**
+	 * @brief Traces the node a flow player paused at.
+	 *
+	 * @param Player The flow player.
+	 * @param Cursor The node the player paused at.
+	 */
+	static void CursorMoved(const UObject* Player, const UObject* Cursor);
+
+	/**
+	 * @brief Traces a branch a flow player offers at its cursor.
+	 *
+	 * @param Player The flow player.
+	 * @param Index The index of the branch.
+	 * @param bIsValid False if a condition on the branch failed.
+	 * @param Target The object the branch ends at.
+	 */
+	static void BranchEvaluated(const UObject* Player, int32 Index, bool bIsValid, const UObject* Target);
+
+	/**
+	 * @brief Traces the result of a condition node or an input pin's condition.
+	 *
+	 * @param Object The node or pin.
+	 * @param bResult The result of the condition.
+	 */
+	static void ConditionEvaluated(const UObject* Object, bool bResult);
+
+	/**
+	 * @brief Traces a committed variable write.
+	 *
+	 * @param Variable The name of the variable in the form Namespace.Variable.
+	 * @param Value The value written.
+	 */
+	static void VariableWritten(FName Variable, const FString& Value);
+
+	/**
+	 * @brief Traces a flow player entering or leaving a shadowed operation.
+	 *
+	 * @param Player The flow player.
+	 * @param Level The shadow level entered, or left when bPushed is false.
+	 * @param bPushed True when the level is entered.
+	 */
+	static void ShadowChanged(const UObject* Player, int32 Level, bool bPushed);
+};
+
+/** Calls an FArticyFlowTrace method if the ArticyFlow channel is enabled */
+#define ARTICY_FLOW_TRACE_EVENT(Event, ...) \
+	do { if (UE_TRACE_CHANNELEXPR_IS_ENABLED(ArticyFlowChannel)) { FArticyFlowTrace::Event(__VA_ARGS__); } } while (0)
+#else
+#define ARTICY_FLOW_TRACE_EVENT(Event, ...) do { } while (0)
+#endif
@@ -12,6 +12,8 @@
 #include "AssetRegistryModule.h"
 #endif
 #include "ShadowStateManager.h"
+#include "ArticyRuntimeStats.h"
+#include "ArticyFlowTrace.h"
 #include "ArticyExpressoScripts.h"
 #include "ArticyGlobalVariables.generated.h"
 
@@ -54,11 +56,24 @@ template<typename Type>
 struct ArticyShadowState
 {
 	ArticyShadowState(const uint32& level, const Type& value) : Level(level), Value(value) { }
+	ArticyShadowState(const uint32& level, Type&& value) : Level(level), Value(MoveTemp(value)) { }
 
 	uint32 Level = 0;
 	Type Value;
 };
 
+/**
+ * A slot of the generated global variables, see the generated <Project>GlobalVariableSlots namespace.
+ * Index is the variable's position in GetAllVariables, known at compile time so accessing a slot
+ * through the generated Get<Slot>() is a single load from the slot table of the global variables.
+ */
+template<typename InVariableType, int32 InIndex>
+struct TArticyGvSlot
+{
+	typedef InVariableType VariableType;
+	static constexpr int32 Index = InIndex;
+};
+
 USTRUCT(BlueprintType)
 struct ARTICYRUNTIME_API FArticyGvName
 {
@@ -103,6 +118,9 @@ public:
 	/** Returns the name of this variable in the form Namespace.Variable */
 	const FName& GetGVName() const { return GVName; }
 
+	/** Copies the value of a variable of the same type, without shadowing it or notifying listeners */
+	virtual void CopyValue(const UArticyVariable* Source) {}
+
 protected:
 	virtual ~UArticyVariable() {}
 
@@ -119,7 +137,12 @@ protected:
 		const auto& shadowLevel = GetShadowLevel(Instance);
 		if(storeLevel > shadowLevel)
 		{																						
-			Instance->Shadows.Push(ArticyShadowState<ValueType>{storeLevel, Instance->Value});
+			LLM_SCOPE_BYTAG(Articy_Shadows);
+			//the old value is overwritten below, so strings can move their characters into the shadow
+			if(&NewValue == &Instance->Value)
+				Instance->Shadows.Push(ArticyShadowState<ValueType>{storeLevel, Instance->Value});
+			else
+				Instance->Shadows.Push(ArticyShadowState<ValueType>{storeLevel, MoveTemp(Instance->Value)});
 
 			//get notified when the state is popped again
 			RegisterOnStorePop(Instance);												
@@ -132,7 +155,17 @@ protected:
 		
 		Instance->Value = NewValue;															
 		if(storeLevel == 0)
+		{
+#if ARTICY_GV_LOGGING
+			if(UE_TRACE_CHANNELEXPR_IS_ENABLED(ArticyVariablesChannel))
+				LogWrite();
+#endif
+#if ARTICY_FLOW_TRACE
+			if(UE_TRACE_CHANNELEXPR_IS_ENABLED(ArticyFlowChannel))
+				TraceWrite();
+#endif
 			OnVariableChanged.Broadcast(this);
+		}
 
 		return Instance->Value;
 	}																							
@@ -141,13 +174,26 @@ protected:
 	void PopState(Type* Instance)
 	{
 		if(ensure(GetStoreShadowLevel() == GetShadowLevel(Instance)))
-			Instance->Value = Instance->Shadows.Pop().Value;
+		{
+			Instance->Value = MoveTemp(Instance->Shadows.Last().Value);
+			Instance->Shadows.Pop(false);
+		}
 	}
 
 	template<typename Type>
 	static uint32 GetShadowLevel(Type* Instance);
 	uint32 GetStoreShadowLevel() const;
 
+#if ARTICY_GV_LOGGING
+	/** Logs the new value of a write to layer zero, out of line so the setters stay small */
+	void LogWrite() const;
+#endif
+
+#if ARTICY_FLOW_TRACE
+	/** Traces the new value of a write to layer zero on the ArticyFlow channel, out of line like LogWrite */
+	void TraceWrite() const;
+#endif
+
 	/** The name of this variable in the form Namespace.Variable */
 	UPROPERTY(BlueprintReadOnly, Category = "Articy")
 	FName GVName;
@@ -248,6 +294,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ValueAccess")
 	int Set(int NewValue) { return *this = NewValue; }
 
+	void CopyValue(const UArticyVariable* Source) override
+	{
+		if (const UArticyInt* Typed = Cast<UArticyInt>(Source))
+			Value = Typed->Value;
+	}
+
+	/** Sets the value without shadowing it or notifying listeners */
+	void SetValueSilently(int NewValue) { Value = NewValue; }
+
 protected:
 	/** The current value of this variable (i.e. the value of a shadow state, if any is active). */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Articy")
@@ -342,6 +397,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ValueAccess")
 	bool Set(bool NewValue) { return *this = NewValue; }
 
+	void CopyValue(const UArticyVariable* Source) override
+	{
+		if (const UArticyBool* Typed = Cast<UArticyBool>(Source))
+			Value = Typed->Value;
+	}
+
+	/** Sets the value without shadowing it or notifying listeners */
+	void SetValueSilently(bool NewValue) { Value = NewValue; }
+
 protected:
 
 	/** The current value of this variable (i.e. the value of a shadow state, if any is active). */
@@ -386,7 +450,7 @@ public:
 	bool operator !=(const FString& text) const { return !this->operator==(text); }
 	bool operator ==(const FString&& text) const { return Value.Equals(text); }
 	bool operator !=(const FString&& text) const { return !this->operator==(text); }
-	bool operator ==(const char* const text) const { return Value.Equals(text); }
+	bool operator ==(const char* const text) const { return FPlatformString::Stricmp(*Value, text) == 0; }
 	bool operator !=(const char* const text) const { return !this->operator==(text); }
 
 	/**
@@ -396,6 +460,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ValueAccess")
 	FString Set(FString NewValue) { return *this = NewValue; }
 
+	void CopyValue(const UArticyVariable* Source) override
+	{
+		if (const UArticyString* Typed = Cast<UArticyString>(Source))
+			Value = Typed->Value;
+	}
+
+	/** Sets the value without shadowing it or notifying listeners */
+	void SetValueSilently(const FString& NewValue) { Value = NewValue; }
+
 protected:
 	/** The current value of this variable (i.e. the value of a shadow state, if any is active). */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Articy")
@@ -424,49 +497,39 @@ public:
 	FOnGVChanged OnVariableChanged;
 
 	UFUNCTION(BlueprintCallable, Category = "ArticyGlobalVariables", meta = (keywords = "global variables"))
-	const TArray<UArticyVariable*> GetVariables() const { return Variables; }
+	const TArray<UArticyVariable*>& GetVariables() const { return Variables; }
 	
+	/**
+	 * @brief Returns the variables of this set that are of the given type.
+	 *
+	 * The list of a type is built on its first request and kept until the set is initialized again.
+	 *
+	 * @param Type The class of the variables to return.
+	 * @return The variables of the type, in the order of Variables.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "ArticyGlobalVariables", meta =(DeterminesOutputType = "Type", keywords = "global variables"))
-	const TArray<UArticyVariable*> GetVariablesOfType(TSubclassOf<UArticyVariable> Type)
-	{
-		TArray<UObject*> subobjects;
-		GetDefaultSubobjects(subobjects);
-		TArray<UArticyVariable*> articyVars;
-		for (int i = 0; i < subobjects.Num(); i++)
-		{
-			const bool bIsA = subobjects[i]->IsA(Type);
-			if (bIsA)
-			{
-				UArticyVariable* Var = Cast<UArticyVariable>(subobjects[i]);
-				articyVars.Add(Var);
-			}
-		}
-		
-		return articyVars;
-	}
+	const TArray<UArticyVariable*>& GetVariablesOfType(TSubclassOf<UArticyVariable> Type);
 
 	template<class T>
-	const TArray<T*> GetVariables()
+	const TArray<T*>& GetVariables()
 	{
-		TArray<UObject*> subobjects;
-		GetDefaultSubobjects(subobjects);
-		TArray<T*> articyVars;
-		for (int i = 0; i < subobjects.Num(); i++)
-		{
-			T* isT = Cast<T>(subobjects[i]);
-			if (isT != nullptr)
-			{
-				articyVars.Add(isT);
-			}
-		}
-		return articyVars;
+		//the list only holds variables that are a T
+		return reinterpret_cast<const TArray<T*>&>(GetVariablesOfType(T::StaticClass()));
 	}
+
+protected:
+
+	/** Builds the variable lists of the types in this set, called after Variables was filled */
+	void IndexVariables();
 	
 private:
 
 	UFUNCTION()
 	void BroadcastOnVariableChanged(UArticyVariable* Variable);
 
+	/** The variables by every type they were requested with, they are kept alive by Variables */
+	TMap<const UClass*, TArray<UArticyVariable*>> VariablesByType;
+
 	template <typename Type>
 	friend void UArticyVariable::Init(UArticyBaseVariableSet* Set, UArticyGlobalVariables* const NewStore, const FName& Name, const typename Type::UnderlyingType& NewValue);
 };
@@ -492,11 +555,16 @@ public:
 	static UArticyGlobalVariables* GetMutableOriginal();
 
 	/**
-	 * Returns a runtime clone of a non-default global variable set.
-	 * Used by ArticyFlowPlayer if OverrideGV is set (this way we're not modifying the asset itself)
+	 * Returns the runtime instance of a non-default global variable set.
+	 * Used by ArticyFlowPlayer if OverrideGV is set (this way we're not modifying the asset itself).
+	 * All alternative sets share one instance, each set only keeps the values it overrides on the asset,
+	 * which are swapped in by this call. Resolve the set again before each use instead of keeping the result.
 	 */
 	static UArticyGlobalVariables* GetRuntimeClone(const UObject* WorldContext, UArticyAlternativeGlobalVariables* GVs);
 
+	/** Returns true if this is the shared instance of the alternative sets and it holds the values of GVs */
+	bool IsOverlayBound(const UArticyAlternativeGlobalVariables* GVs) const;
+
 	/* Unloads the global variables, which causes that all changes get removed. */
 	UFUNCTION(BlueprintCallable, Category = "Packages")
 	void UnloadGlobalVariables();
@@ -507,6 +575,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Getter")
 	const TArray<UArticyBaseVariableSet*> GetVariableSets() const { return VariableSets; }
 
+	/**
+	 * Appends the variables of all sets, in the order of the sets.
+	 * The order only depends on the generated class, so an index into it identifies a variable in every instance.
+	 */
+	void GetAllVariables(TArray<UArticyVariable*>& OutVariables) const;
+
 	/* Exec functions are only supported by a couple singleton classes
 	 * To make this exec compatible, one of those exec classes has to forward the call
 	 * See https://wiki.unrealengine.com/Exec_Functions for reference*/
@@ -527,6 +601,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Setter")
 	void SetStringVariable(FArticyGvName GvName, const FString Value);
 
+	/** Logs variable access and writes of all instances through the ArticyVariables trace channel, not in Shipping builds */
 	UFUNCTION(BlueprintCallable, Category="Debug")
 	void EnableDebugLogging();
 	UFUNCTION(BlueprintCallable, Category="Debug")
@@ -536,29 +611,108 @@ public:
 	int GetSeenCounter(const IArticyFlowObject* Object) const;
 	int SetSeenCounter(const IArticyFlowObject* Object, int Value);
 	int IncrementSeenCounter(const IArticyFlowObject* Object);
+	int IncrementSeenCounter(const FArticyId& Id);
+	/** Make room for counting this many more nodes as seen without growing the counters on each */
+	void ReserveSeenCounters(int32 Num) { VisitedNodes.Reserve(VisitedNodes.Num() + Num); }
 	bool Fallback(const IArticyFlowObject* Object);
 	void SetFallbackEvaluation(const IArticyFlowObject* Object, bool Value);
+	/** Number of times a script asked for the fallback flag, an exploration that didn't ask gives the same result with fallback */
+	uint32 GetFallbackQueryCount() const { return FallbackQueryCount; }
 
 	void PushSeen();
 	void PopSeen();
 
+	/**
+	 * Writes the variable values, seen counters and fallback flags to a snapshot, see FArticySnapshot.
+	 * The values are written as a name table followed by a packed block per type.
+	 */
+	void SaveSnapshot(FArchive& Ar) const;
+	/**
+	 * Reads a snapshot written by SaveSnapshot, only listeners of variables whose value changed are notified.
+	 * If the variables are not the ones of the snapshot, they are matched by name: RenamedVariables maps
+	 * old full names to new ones, removed variables and variables whose type changed are skipped.
+	 * @return False if the snapshot could not be read, nothing is changed then.
+	 */
+	bool LoadSnapshot(FArchive& Ar, const TMap<FName, FName>& RenamedVariables);
+
 protected:
 
 	UPROPERTY()
 	TArray<UArticyBaseVariableSet*> VariableSets;
 
-	UPROPERTY()
-	bool bLogVariableAccess = false;
-
 private:
 
 	static TWeakObjectPtr<UArticyGlobalVariables> Clone;
 
-	// Runtime clones of non-default global variable assets managed by GetRuntimeClone
-	static TMap<FName, TWeakObjectPtr<UArticyGlobalVariables>> OtherClones;
+	// Runtime instance shared by the non-default global variable sets, managed by GetRuntimeClone
+	static TWeakObjectPtr<UArticyGlobalVariables> AlternativeBase;
+
+	/**
+	 * Creates a runtime copy of a global variables asset.
+	 * The copy is constructed, which creates and initializes its variables, and then takes over the
+	 * values of the asset, instead of duplicating the asset and each of its variables through serialization.
+	 */
+	static UArticyGlobalVariables* CreateClone(const UArticyGlobalVariables* Source, UObject* Outer, const FName Name);
+
+	/** The values an alternative set overrides on the asset, see GetRuntimeClone */
+	struct FOverlay
+	{
+		/** A bit per slot of GetAllVariables, set if the slot is overridden; slots past its end are not */
+		TBitArray<> Overridden;
+		/** The overridden bool and int values by slot */
+		TMap<int32, int32> Numbers;
+		/** The overridden string values by slot */
+		TMap<int32, FString> Strings;
+		/** The seen counters and fallback flags of the set while it is not bound */
+		TMap<FArticyId, int> VisitedNodes;
+		TMap<FArticyId, bool> bIsFallbackEvaluation;
+
+		bool IsOverridden(int32 Slot) const { return Slot < Overridden.Num() && Overridden[Slot]; }
+	};
+
+	/** Prepares this clone to be the shared instance of the alternative sets on top of Base */
+	void InitOverlays(const UArticyGlobalVariables* Base);
+
+	/** Makes this instance hold the values of the overlay of Key, reverting the overridden values of the previous one */
+	void BindOverlay(const FName Key);
+
+	/** Records a write of a variable in the bound overlay, bound to OnVariableChanged of every set */
+	UFUNCTION()
+	void RecordOverlayWrite(UArticyVariable* Variable);
+
+	/** The overlays of the alternative sets by the full name of the set, only used by AlternativeBase */
+	TMap<FName, FOverlay> Overlays;
+	/** The key of the overlay whose values are held, None if only the values of the asset are held */
+	FName BoundOverlay;
+	/** The asset the overlays are applied on, and its variables by slot */
+	TWeakObjectPtr<const UArticyGlobalVariables> OverlayBase;
+	TArray<UArticyVariable*> BaseSlots;
+	/** The variables of this instance by slot, and the other way around */
+	TArray<UArticyVariable*> OverlaySlots;
+	TMap<const UArticyVariable*, int32> SlotByVariable;
+
+	/** Seen counters of the current shadow state */
+	TMap<FArticyId, int> VisitedNodes;
+	/** Fallback evaluation flags of the current shadow state */
+	TMap<FArticyId, bool> bIsFallbackEvaluation;
+	/** Incremented by every Fallback query */
+	uint32 FallbackQueryCount = 0;
+
+	/** A change of a seen counter or fallback flag inside a shadow state, undone by PopSeen */
+	struct FSeenChange
+	{
+		FArticyId Id;
+		int OldValue = 0;
+		bool bHadValue = false;
+		bool bIsFallback = false;
+	};
+
+	/** Changes made since the first PushSeen that was not popped yet, so pushing does not copy the maps */
+	TArray<FSeenChange> SeenJournal;
+	/** Length of SeenJournal at each PushSeen */
+	TArray<int32> SeenJournalMarks;
 
-	TArray<TMap<FArticyId, int>> VisitedNodes;
-	TArray<TMap<FArticyId, bool>> bIsFallbackEvaluation;
+	void RecordSeenChange(const FArticyId& Id, bool bIsFallback);
 
 	template <typename ArticyVariableType, typename VariablePayloadType>
 	void SetVariableValue(const FName Namespace, const FName Variable, const VariablePayloadType Value);
@@ -600,11 +754,7 @@ uint32 UArticyVariable::GetShadowLevel(Type* Instance)
 template <typename Type>
 void UArticyVariable::RegisterOnStorePop(Type* Instance)
 {
-#if __cplusplus >= 202002L
-	Store->RegisterOnPopState([=, this] { this->PopState(Instance); });
-#else
-	Store->RegisterOnPopState([=] { this->PopState(Instance); });
-#endif
+	Store->RegisterUndo(Instance, [](void* Target, uint32) { static_cast<Type*>(Target)->PopState(static_cast<Type*>(Target)); });
 }
 
 template <typename ArticyVariableType, typename VariablePayloadType>
@@ -623,20 +773,14 @@ void UArticyGlobalVariables::SetVariableValue(const FName Namespace, const FName
 				auto& propValue = (*typedPtr);
 				propValue = Value;
 
-				if (bLogVariableAccess)
-				{
-					UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
-				}
+				ARTICY_GV_LOG(Display, TEXT("Set variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
 
 				return;
 			}
 		}
 	}
 
-	if (bLogVariableAccess)
-	{
-		UE_LOG(LogArticyRuntime, Error, TEXT("Unable to find variable: %s::%s. Variable does not exist or wrong type assumed."), *Namespace.ToString(), *Variable.ToString());
-	}
+	ARTICY_GV_LOG(Error, TEXT("Unable to find variable: %s::%s. Variable does not exist or wrong type assumed."), *Namespace.ToString(), *Variable.ToString());
 }
 
 template<typename ArticyVariableType, typename VariablePayloadType>
@@ -654,19 +798,13 @@ const VariablePayloadType& UArticyGlobalVariables::GetVariableValue(const FName
 			auto& propValue = (*typedPtr);
 			bSucceeded = true;
 
-			if (bLogVariableAccess)
-			{
-				UE_LOG(LogArticyRuntime, Display, TEXT("Get variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
-			}
+			ARTICY_GV_LOG(Display, TEXT("Get variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
 
 			return propValue.Get();
 		}
 	}
 
-	if(bLogVariableAccess)
-	{
-		UE_LOG(LogArticyRuntime, Error, TEXT("Unable to find variable: %s::%s"), *Namespace.ToString(), *Variable.ToString());
-	}
+	ARTICY_GV_LOG(Error, TEXT("Unable to find variable: %s::%s"), *Namespace.ToString(), *Variable.ToString());
 
 	bSucceeded = false;
 	static VariablePayloadType empty = VariablePayloadType();
@@ -99,7 +99,35 @@ namespace ArticyHelpers
 		return GetArticyFolder() / TEXT("ArticyContent") / TEXT("Generated");
 	}
 
-	inline uint64 HexToUint64(FString str) { return FCString::Strtoui64(*str, nullptr, 16); }
+	/** Parses the hex digits a string starts with, after an optional "0x", without allocating. */
+	inline uint64 HexToUint64(FStringView Str)
+	{
+		if (Str.StartsWith(TEXT("0x"), ESearchCase::IgnoreCase))
+			Str.RightChopInline(2);
+
+		uint64 Value = 0;
+		for (const TCHAR Char : Str)
+		{
+			if (!FChar::IsHexDigit(Char))
+				break;
+			Value = Value << 4 | (Char <= TEXT('9') ? Char - TEXT('0') : (Char | 0x20) - TEXT('a') + 10);
+		}
+		return Value;
+	}
+
+	/** Parses the decimal digits a string starts with, without allocating. */
+	inline uint64 DecToUint64(FStringView Str)
+	{
+		uint64 Value = 0;
+		for (const TCHAR Char : Str)
+		{
+			if (!FChar::IsDigit(Char))
+				break;
+			Value = Value * 10 + (Char - TEXT('0'));
+		}
+		return Value;
+	}
+
 	inline FString Uint64ToHex(uint64 id)
 	{
 		std::stringstream stream;
@@ -181,6 +209,75 @@ namespace ArticyHelpers
 		return ArticyLocalizerSystem->LocalizeString(Outer, Key, ResolveTextExtension, BackupText);
 	}
 
+	/**
+	 * Conservatively checks whether an expresso script may change any state: it does if it
+	 * contains an assignment, an increment or decrement, or a method call (which includes
+	 * setProp and setSeenCounter). Scripts that only read variables are side-effect-free.
+	 */
+	inline bool ScriptHasSideEffects(const FString& Script)
+	{
+		TCHAR quote = 0;
+		TCHAR prev = 0;
+		for (int32 i = 0; i < Script.Len(); ++i)
+		{
+			const TCHAR c = Script[i];
+			const TCHAR next = i + 1 < Script.Len() ? Script[i + 1] : 0;
+
+			//string literals can contain anything
+			if (quote)
+			{
+				if (c == TEXT('\\'))
+					++i;
+				else if (c == quote)
+					quote = 0;
+				continue;
+			}
+			if (c == TEXT('"') || c == TEXT('\''))
+			{
+				quote = c;
+				prev = c;
+				continue;
+			}
+
+			if (c == TEXT('='))
+			{
+				if (next == TEXT('='))
+				{
+					//comparison
+					++i;
+					prev = next;
+					continue;
+				}
+				if (prev != TEXT('!') && prev != TEXT('<') && prev != TEXT('>'))
+					return true;
+			}
+			else if ((c == TEXT('+') || c == TEXT('-')) && next == c)
+			{
+				return true;
+			}
+			else if (c == TEXT('(') && (FChar::IsAlnum(prev) || prev == TEXT('_')))
+			{
+				return true;
+			}
+
+			if (!FChar::IsWhitespace(c))
+				prev = c;
+		}
+		return false;
+	}
+
+	/**
+	 * Folds an expresso script that does the same whatever the state: an instruction without statements, or a
+	 * condition of only literals, !, -, arithmetic, comparisons, && and ||. Conditions are read like the generated
+	 * code reads them, so an empty one is true and an int result is true if it is greater than 0.
+	 *
+	 * @param Script The script as exported.
+	 * @param bIsInstruction Whether the script is an instruction.
+	 * @param bOutResult Receives the result of a constant condition, true for instructions.
+	 * @return True if the script is constant and never needs to run.
+	 */
+	ARTICYRUNTIME_API bool FoldConstantScript(const FString& Script, bool bIsInstruction, bool& bOutResult);
+
 }
 
 
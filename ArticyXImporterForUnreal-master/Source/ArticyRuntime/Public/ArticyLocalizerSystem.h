@@ -59,44 +59,14 @@ public:
 
 	inline FText LocalizeString(UObject* Outer, const FText& Key, bool ResolveTextExtension = true, const FText* BackupText = nullptr)
 	{
-		if (!bDataLoaded)
-		{
-			Reload();
-		}
-
-		const FText MissingEntry = FText::FromString("<MISSING STRING TABLE ENTRY>");
-
-		// Default to key
-		FText SourceString = Key;
-
-		// Look up entry in specified string table
-		TOptional<FString> TableName = FTextInspector::GetNamespace(Key);
-		if (!TableName.IsSet())
-		{
-			TableName = TEXT("ARTICY");
-		}
-
-		// Find the table
-		FStringTableConstPtr TablePtr = FStringTableRegistry::Get().FindStringTable(FName(TableName.GetValue()));
-		if (TablePtr.IsValid())
-		{
-			// Find the entry
-			const FStringTable* Table = TablePtr.Get();
-			FStringTableEntryConstPtr EntryPtr = Table->FindEntry(FTextKey(Key.ToString()));
-			if (EntryPtr.IsValid())
-			{
-				const FStringTableEntry* TableEntry = EntryPtr.Get();
-				SourceString = FText::FromString(TableEntry->GetSourceString());
-			}
-		}
-
-		if (!SourceString.IsEmpty() && !SourceString.EqualTo(MissingEntry) && !SourceString.EqualTo(Key))
+		FText SourceString;
+		if (LocalizeSource(Key, SourceString))
 		{
 			if (ResolveTextExtension)
 			{
 				return ResolveText(Outer, &SourceString);
 			}
-			return FText(SourceString);
+			return SourceString;
 		}
 
 		// By default, return via the key
@@ -114,7 +84,153 @@ public:
 		return Key;
 	}
 
+	/**
+	 * @brief Looks up the string table entry of a key without resolving the text extension.
+	 *
+	 * @param Key The localization key, its namespace names the table.
+	 * @param OutSource Receives the source string of the entry if it was found.
+	 * @return False if the table has no entry for the key.
+	 */
+	inline bool LocalizeSource(const FText& Key, FText& OutSource)
+	{
+		if (!bDataLoaded)
+		{
+			Reload();
+
+			// Resolved texts and cached entries may be those of the previous tables
+			UArticyTextExtension::Get()->ResetResolvedTexts();
+			CachedEntries.Reset();
+		}
+
+		const FString& KeyString = Key.ToString();
+
+		// Look up entry in specified string table
+		TOptional<FString> TableName = FTextInspector::GetNamespace(Key);
+		if (!TableName.IsSet())
+		{
+			TableName = TEXT("ARTICY");
+		}
+
+		const FStringTableEntry* TableEntry = FindStringTableEntry(TableName.GetValue(), KeyString);
+		if (!TableEntry)
+		{
+			return false;
+		}
+
+		const FString& EntryString = TableEntry->GetSourceString();
+		if (EntryString.IsEmpty() || EntryString.Equals(TEXT("<MISSING STRING TABLE ENTRY>")) || EntryString.Equals(KeyString))
+		{
+			return false;
+		}
+
+		OutSource = FText::FromString(EntryString);
+		return true;
+	}
+
+	/**
+	 * @brief Loads a string table of the current culture, until it is unloaded as often as it was loaded.
+	 *
+	 * The database loads the table of a package with the package.
+	 *
+	 * @param TableName The name of the table, the package name with underscores instead of spaces.
+	 */
+	void LoadStringTable(const FName TableName);
+
+	/**
+	 * @brief Unloads a string table loaded with LoadStringTable once it has no other users.
+	 *
+	 * @param TableName The name of the table.
+	 */
+	void UnloadStringTable(const FName TableName);
+
+	/**
+	 * @brief Estimates the memory of the keys and source strings of a registered string table.
+	 *
+	 * @param TableName The name of the table.
+	 * @return The estimated size in bytes, 0 if the table is not registered.
+	 */
+	int64 GetStringTableResourceSize(const FName TableName) const;
+
+	/**
+	 * @brief Switches the string tables in use to the current culture without blocking the game thread.
+	 *
+	 * Bound to the culture change by the generated Reload. Reload records the files of the new culture, the tables
+	 * in use are then read on a worker thread while those of the previous culture stay registered, and all of them
+	 * are swapped in at once on the game thread. A newer switch discards the tables of an older one.
+	 */
+	void SwitchCulture();
+
+	/** Whether the tables of a culture switch are still being read */
+	bool IsSwitchingCulture() const { return bSwitchingCulture; }
+
+	DECLARE_MULTICAST_DELEGATE(FOnStringTablesSwapped);
+
+	/**
+	 * Broadcast once the tables of a new culture are in use. Resolved texts are only relocalized when they are
+	 * requested again, so listeners should refresh the texts they show and leave the others to their next use.
+	 */
+	FOnStringTablesSwapped OnStringTablesSwapped;
+
 protected:
+	/** Forgets the table files of the previous culture, called by Reload before it adds those of the current culture */
+	void ResetStringTables();
+
+	/**
+	 * @brief Sets the file of a table for the current culture, the table is only loaded once it is used.
+	 *
+	 * @param TableName The name of the table.
+	 * @param FilePath The CSV file of the table, relative to the content directory.
+	 */
+	void AddStringTable(const FName TableName, const FString& FilePath);
+
+	/** Loads the ARTICY table and the tables that were loaded before the culture changed, called at the end of Reload */
+	void LoadStringTables();
+
+	/** Registers a table from the file of the current culture, returns false if it has none */
+	bool RegisterStringTable(const FName TableName);
+
+	/** Reads the files of the tables in use on a worker thread, called by LoadStringTables during SwitchCulture */
+	void LoadStringTablesAsync();
+
+	/**
+	 * @brief Registers the tables read for a culture switch in place of those of the previous culture.
+	 *
+	 * @param Request The switch the tables were read for, they are dropped if a newer one was started.
+	 * @param Tables The tables by name, null for tables the culture has no file for.
+	 */
+	void SwapStringTables(const uint32 Request, const TArray<TPair<FName, FStringTablePtr>>& Tables);
+
+	/** Drops the cached entries and resolved texts of the previous tables and tells the listeners */
+	void OnStringTablesChanged();
+
+	/**
+	 * @brief Finds the entry of a key in a string table, the entries are cached until the culture or the tables change.
+	 *
+	 * @param TableName The namespace of the text, the name of its table.
+	 * @param Key The key of the entry.
+	 * @return The entry, nullptr if the table or the key does not exist.
+	 */
+	const FStringTableEntry* FindStringTableEntry(const FString& TableName, const FString& Key);
+
 	bool bDataLoaded = false;
 	bool bListenerSet = false;
+
+private:
+	/** The files of the tables of the current culture */
+	TMap<FName, FString> StringTableFiles;
+
+	/** The registered tables and their number of LoadStringTable users */
+	TMap<FName, int32> LoadedStringTables;
+
+	/** The entries found so far by table and key, nullptr for keys that were not found */
+	TMap<FString, TMap<FString, FStringTableEntryConstPtr>> CachedEntries;
+	FString CachedEntriesCulture;
+
+	/** Set while SwitchCulture reloads, LoadStringTables then reads the tables asynchronously */
+	bool bLoadTablesAsync = false;
+
+	bool bSwitchingCulture = false;
+
+	/** The latest culture switch, only its tables are swapped in */
+	uint32 CultureSwitchRequest = 0;
 };
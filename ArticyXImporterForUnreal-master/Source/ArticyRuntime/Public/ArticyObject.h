@@ -11,6 +11,21 @@
 #include "Dom/JsonValue.h"
 #include "ArticyObject.generated.h"
 
+/**
+ * Position of an object in a depth-first walk of the object hierarchy of the imported packages.
+ * The descendants of an object are entered after it, up to its Exit.
+ */
+struct FArticyHierarchyRange
+{
+	int32 Enter = INDEX_NONE;
+
+	/** The largest Enter of the object and its descendants. */
+	int32 Exit = INDEX_NONE;
+
+	/** Whether the object of Other is below this one. */
+	bool Contains(const FArticyHierarchyRange& Other) const { return Other.Enter > Enter && Other.Enter <= Exit; }
+};
+
 /**
  * Base UCLASS for all articy objects.
  */
@@ -24,11 +39,16 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	UArticyObject* GetParent() const;
-	TArray<TWeakObjectPtr<UArticyObject>> GetChildren() const;
+	/** The loaded children, looked up again only after objects were loaded, unloaded or cloned */
+	const TArray<TWeakObjectPtr<UArticyObject>>& GetChildren() const;
 	
 	FArticyId GetParentID() const;
 	/** Includes all children IDs regardless of type (including pins etc.) */
-	TArray<FArticyId> GetChildrenIDs() const;
+	const TArray<FArticyId>& GetChildrenIDs() const;
+
+	/** Whether this object is below Ancestor in the object hierarchy, e.g. a dialogue fragment inside a dialogue */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool IsDescendantOf(const UArticyObject* Ancestor) const;
 
 #if WITH_EDITOR
 	/** Includes all children IDs that map to articy objects (excluding pins etc.) */
@@ -38,10 +58,45 @@ public:
 	static UArticyObject* FindAsset(const FArticyId& Id);
 	static UArticyObject* FindAsset(const FString& TechnicalName);// MM_CHANGE
 
+	/** Drops the asset index and stops following the asset registry, called on module shutdown */
+	static void ResetAssetIndex();
+
 private:
-	static TSet<TWeakObjectPtr<class UArticyPackage>> CachedPackages;
-	static TMap<FArticyId, TWeakObjectPtr<UArticyObject>> ArticyIdCache;
-	static TMap<FName, TWeakObjectPtr<UArticyObject>> ArticyNameCache;
+	struct FIndexedAsset
+	{
+		TSoftObjectPtr<UArticyObject> Asset;
+		/** Name of the package asset the object was indexed from */
+		FName Package;
+	};
+
+	struct FIndexedPackage
+	{
+		TArray<FArticyId> Ids;
+		TArray<FName> TechnicalNames;
+	};
+
+	/** Index of the objects of all packages, built once on first use and kept up to date with the asset registry */
+	static TMap<FArticyId, FIndexedAsset> AssetIndexById;
+	static TMap<FName, FIndexedAsset> AssetIndexByName;
+	static TMap<FName, FIndexedPackage> IndexedPackages;
+
+	/** Packages added or changed since the last lookup, indexed on the next one */
+	static TSet<FName> PendingPackages;
+
+	static bool bAssetIndexBuilt;
+	static FDelegateHandle OnAssetAddedHandle;
+	static FDelegateHandle OnAssetRemovedHandle;
+	static FDelegateHandle OnAssetRenamedHandle;
+	static FDelegateHandle OnAssetUpdatedHandle;
+
+	static void UpdateAssetIndex();
+	static void IndexPackage(FName PackageName, class UArticyPackage* Package);
+	static void UnindexPackage(FName PackageName);
+	static bool IsPackageAsset(const struct FAssetData& AssetData);
+
+	static void OnAssetAdded(const struct FAssetData& AssetData);
+	static void OnAssetRemoved(const struct FAssetData& AssetData);
+	static void OnAssetRenamed(const struct FAssetData& AssetData, const FString& OldObjectPath);
 #endif
 
 protected:
@@ -58,5 +113,14 @@ protected:
 
 private:
 
+	/** The position of the object in the hierarchy, with Enter INDEX_NONE if it is not part of it. */
+	const FArticyHierarchyRange& GetHierarchyRange() const;
+
+	/** Lookups cached until the generation of the loaded objects changes, see UArticyDatabase::GetGeneration. */
+	mutable TWeakObjectPtr<UArticyObject> CachedParent;
+	mutable uint32 CachedParentGeneration = MAX_uint32;
 	mutable TArray<TWeakObjectPtr<UArticyObject>> CachedChildren;
+	mutable uint32 CachedChildrenGeneration = MAX_uint32;
+	mutable FArticyHierarchyRange CachedHierarchyRange;
+	mutable uint32 CachedHierarchyGeneration = MAX_uint32;
 };
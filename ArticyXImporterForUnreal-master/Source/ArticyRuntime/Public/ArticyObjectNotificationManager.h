@@ -5,9 +5,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "ArticyBaseTypes.h"
 #include "ArticyChangedProperty.h"
 #include "ArticyObjectNotificationManager.generated.h"
 
+class UArticyPrimitive;
+class IArticyReflectable;
+
 /**
  * Function pointer type for handling changes in Articy properties.
  * @param ChangedProperty The property that has changed.
@@ -24,9 +29,19 @@ enum class EArticyTypeProperties : uint8 {
     ArticyObject = 8,        ///< Includes Articy object-specific properties.
     All = 15                 ///< Includes all types of properties.
 };
+ENUM_CLASS_FLAGS(EArticyTypeProperties);
 
 /**
  * Manager class for handling notifications about changes in Articy objects.
+ *
+ * Listeners are indexed by object (ID and clone), by type and by property name, changes of objects
+ * nobody listens to are dropped in SetProp. All other changes are delivered once per frame,
+ * a property changed several times within a frame is reported once. The object's own ReportChanged
+ * delegate is served the same way, and writes of shadowed operations are never reported.
+ *
+ * Filters have the form Object[<Clone>][.Property], where Object is a hex ID ("0x..."), a decimal ID,
+ * a technical name or "*" for all objects and Property may be left out or "*" for all properties.
+ * Type filters name the articy type or the class (without prefix) in place of the object.
  */
 UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyObjectNotificationManager : public UObject
@@ -40,6 +55,26 @@ public:
      */
     static UArticyObjectNotificationManager* Get();
 
+    /**
+     * Reports a property written by IArticyReflectable::SetProp, called only if its ReportChanged is bound or HasListeners is true.
+     * Writes made while the object's database or global variables are shadowed are undone later and not reported.
+     * @param Object The object whose property was written.
+     * @param Property The property that has changed.
+     */
+    static void ReportChange(IArticyReflectable* Object, FName Property);
+
+    /**
+     * Queues a change for the next dispatch if anybody listens to the object, its type or the property.
+     * @param ChangedProperty The property that has changed.
+     */
+    static void QueueChange(const FArticyChangedProperty& ChangedProperty);
+
+    /**
+     * Checks if any listener is registered, so setting properties can skip the lookup while nobody listens.
+     * @return True if at least one listener is registered.
+     */
+    static bool HasListeners() { return NumListeners > 0; }
+
     /**
      * Adds a listener for changes to Articy objects matching the given filter.
      * @param Filter The filter string for identifying Articy objects.
@@ -48,9 +83,9 @@ public:
     void AddListener(const FString& Filter, FArticyPropertyChangedFunction ChangedFunction);
 
     /**
-     * Adds a listener for changes to Articy objects matching the given filter and property flags.
-     * @param Filter The filter string for identifying Articy objects.
-     * @param Flags The types of properties to include in notifications.
+     * Adds a listener for changes to Articy objects of the type named by the filter.
+     * @param Filter The filter string for identifying the Articy type.
+     * @param Flags The types of properties to include in notifications, IncludeBaseType also matches derived types.
      * @param ChangedFunction The function to call when a property changes.
      */
     void AddListener(const FString& Filter, EArticyTypeProperties Flags, FArticyPropertyChangedFunction ChangedFunction);
@@ -74,6 +109,8 @@ public:
      */
     void RemoveListeners(UArticyBaseObject* Object);
 
+    virtual void BeginDestroy() override;
+
 protected:
     /**
      * Splits a string into an object name and instance number.
@@ -82,4 +119,99 @@ protected:
      * @param OutInstanceNumber The resulting instance number.
      */
     void SplitInstance(const FString& InString, FString& OutName, FString& OutInstanceNumber);
+
+private:
+    using FObjectKey = TPair<FArticyId, uint32>;
+
+    struct FListener
+    {
+        FArticyPropertyChangedFunction Function = nullptr;
+
+        /** The property listened to, None for all. */
+        FName Property;
+
+        EArticyTypeProperties Flags = EArticyTypeProperties::All;
+    };
+
+    /** A filter string parsed once when the listener is added. */
+    struct FFilter
+    {
+        enum class EKind : uint8 { Invalid, Any, Object, Type };
+
+        EKind Kind = EKind::Invalid;
+        FObjectKey Object;
+        FName Type;
+        FName Property;
+    };
+
+    struct FPendingChange
+    {
+        TWeakObjectPtr<UArticyBaseObject> Object;
+        FName Property;
+    };
+
+    /** A change to broadcast on the ReportChanged delegate of its object. */
+    struct FPendingReport
+    {
+        TWeakObjectPtr<UObject> Object;
+        FName Property;
+    };
+
+    /**
+     * Parses a filter string.
+     * @param Filter The filter string.
+     * @param bIsType Whether the filter names a type instead of an object.
+     * @return The parsed filter, of kind Invalid if the object is unknown.
+     */
+    FFilter ParseFilter(const FString& Filter, bool bIsType);
+
+    void AddListener(const FFilter& Filter, const FListener& Listener);
+
+    /**
+     * Gets the listener list of a filter.
+     * @param Filter The parsed filter.
+     * @param bAdd Whether to add the list if there is none.
+     * @return The list, or null if there is none and bAdd is false.
+     */
+    TArray<FListener>* FindListeners(const FFilter& Filter, bool bAdd);
+
+    /**
+     * Checks if any listener may be interested in a change, without looking at its flags.
+     * @param Owner The object the changed property belongs to, or the owner of its feature.
+     * @param Property The changed property.
+     */
+    bool IsObserved(const UArticyPrimitive* Owner, FName Property) const;
+
+    /**
+     * Collects the functions of the listeners matching a change.
+     * @param Change The change to match.
+     * @param OutFunctions Receives the functions to call.
+     */
+    void CollectListeners(const FPendingChange& Change, TArray<FArticyPropertyChangedFunction>& OutFunctions) const;
+
+    /** Delivers the changes queued since the last frame, the ticker only stays registered while changes are queued. */
+    bool DispatchChanges(float DeltaTime);
+
+    /** Registers the dispatch ticker if it is not registered. */
+    void ScheduleDispatch();
+
+    /** Checks if the database or global variables an object belongs to are in a shadowed operation. */
+    static bool IsShadowed(const UObject* Object);
+
+    /** Gets the object a property belongs to, the owner for template features. */
+    static const UArticyPrimitive* GetOwner(const UArticyBaseObject* Object);
+
+    TMap<FObjectKey, TArray<FListener>> ObjectListeners;
+    TMap<FName, TArray<FListener>> TypeListeners;
+    TMap<FName, TArray<FListener>> PropertyListeners;
+    TArray<FListener> GlobalListeners;
+
+    TArray<FPendingChange> PendingChanges;
+    TSet<TPair<const UArticyBaseObject*, FName>> PendingKeys;
+    TArray<FPendingReport> PendingReports;
+    TSet<TPair<const UObject*, FName>> PendingReportKeys;
+    FTSTicker::FDelegateHandle DispatchHandle;
+
+    /** Number of listeners of the singleton, checked by SetProp before doing any lookup. */
+    static int32 NumListeners;
 };
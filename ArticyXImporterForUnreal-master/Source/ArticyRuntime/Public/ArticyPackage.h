@@ -9,6 +9,32 @@
 #include "UObject/UObjectHash.h"
 #include "ArticyPackage.generated.h"
 
+/**
+ * @brief Tags articy packages save to the asset registry, so tools can inspect packages without loading them.
+ *
+ * See FArticyPackageQuery in the editor module. Lists of IDs are hex IDs separated by spaces.
+ */
+namespace ArticyPackageTags
+{
+	/** The number of objects. */
+	inline const TCHAR* const NumObjects = TEXT("NumObjects");
+
+	/** The number of objects by class, "<Class path>=<Count>" separated by spaces. */
+	inline const TCHAR* const ObjectClasses = TEXT("ObjectClasses");
+
+	/** The characters in the texts of the objects. */
+	inline const TCHAR* const TextLength = TEXT("TextLength");
+
+	/** The IDs of the speakers of the objects, sorted. */
+	inline const TCHAR* const Speakers = TEXT("Speakers");
+
+	/** The IDs of all objects. */
+	inline const TCHAR* const ObjectIds = TEXT("ObjectIds");
+
+	/** The IDs of the objects in other packages that connections and jumps lead to, sorted. */
+	inline const TCHAR* const ExternalTargets = TEXT("ExternalTargets");
+}
+
 
 UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyPackage : public UDataAsset
@@ -25,10 +51,33 @@ protected:
 
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Articy")
 	TMap<FArticyId, TSoftObjectPtr<UArticyObject>> AssetsById;
+
+	/** The assets by ID and technical name as resolved pointers, so lookups do not resolve the soft pointers every time. Assets keeps them alive. */
+	TMap<FArticyId, UArticyObject*> ResolvedAssetsById;
+	TMap<FName, UArticyObject*> ResolvedAssetsByTechnicalName;
+
+	/** Fills the resolved lookups from Assets. */
+	void ResolveAssets();
 public: 
 
 	virtual FPrimaryAssetId GetPrimaryAssetId() const override { return FPrimaryAssetId(FName(TEXT("ArticyPackage")), GetFName()); }
 
+	/**
+	 * @brief Loaded packages and their assets form one GC cluster, so garbage collection does not trace them one by one.
+	 *
+	 * The assets are never changed at runtime, the database clones them before they are written to.
+	 */
+	virtual bool CanBeClusterRoot() const override { return true; }
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	/**
+	 * @brief Adds the counts, speakers and references of the objects, see ArticyPackageTags.
+	 */
+	virtual void GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const override;
+#endif
+
 	void AddAsset(UArticyObject* ArticyObject);
 
 	UFUNCTION()
@@ -37,11 +86,14 @@ public:
 	UFUNCTION()
 	void Clear();
 
-	UFUNCTION()
-	const TArray<UArticyObject*> GetAssets();
+	/** The objects of the package, by reference to not copy them on every call */
+	const TArray<UArticyObject*>& GetAssets() const;
 
-	UFUNCTION()
-	const TMap<FName, TSoftObjectPtr<UArticyObject>> GetAssetsDict();
+	/** The objects of the package by technical name */
+	const TMap<FName, TSoftObjectPtr<UArticyObject>>& GetAssetsDict() const;
+
+	/** The objects of the package by ID */
+	const TMap<FArticyId, TSoftObjectPtr<UArticyObject>>& GetAssetsById() const;
 
 	UFUNCTION()
 	UArticyObject* GetAssetById(const FArticyId& Id) const;
@@ -53,7 +105,7 @@ public:
 
 	const bool IsAssetContained(const FArticyId& Id) const;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category = "Package")
 	FString Name;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
 	FString Description;
@@ -75,18 +127,48 @@ inline void UArticyPackage::Clear()
 	Assets.Empty();
 	AssetsById.Empty();
 	AssetsByTechnicalName.Empty();
+	ResolvedAssetsById.Empty();
+	ResolvedAssetsByTechnicalName.Empty();
+}
+
+inline void UArticyPackage::PostLoad()
+{
+	Super::PostLoad();
+	ResolveAssets();
+}
+
+inline void UArticyPackage::ResolveAssets()
+{
+	ResolvedAssetsById.Reset();
+	ResolvedAssetsByTechnicalName.Reset();
+	ResolvedAssetsById.Reserve(Assets.Num());
+	ResolvedAssetsByTechnicalName.Reserve(Assets.Num());
+
+	for (UArticyObject* Asset : Assets)
+	{
+		if (!Asset)
+			continue;
+
+		ResolvedAssetsById.Add(Asset->GetId(), Asset);
+		ResolvedAssetsByTechnicalName.Add(Asset->GetTechnicalName(), Asset);
+	}
 }
 
-inline const TArray<UArticyObject*> UArticyPackage::GetAssets()
+inline const TArray<UArticyObject*>& UArticyPackage::GetAssets() const
 {
 	return Assets;
 }
 
-inline const TMap<FName, TSoftObjectPtr<UArticyObject>> UArticyPackage::GetAssetsDict()
+inline const TMap<FName, TSoftObjectPtr<UArticyObject>>& UArticyPackage::GetAssetsDict() const
 {
 	return AssetsByTechnicalName;
 }
 
+inline const TMap<FArticyId, TSoftObjectPtr<UArticyObject>>& UArticyPackage::GetAssetsById() const
+{
+	return AssetsById;
+}
+
 inline const bool UArticyPackage::IsAssetContained(FName TechnicalName) const
 {	
 	return AssetsByTechnicalName.Contains(TechnicalName);
@@ -99,22 +181,12 @@ inline const bool UArticyPackage::IsAssetContained(const FArticyId &Id) const
 
 inline UArticyObject* UArticyPackage::GetAssetById(const FArticyId& Id) const
 {
-	if(AssetsById.Contains(Id))
-	{
-		return AssetsById[Id].Get();
-	}
-
-	return nullptr;
+	return ResolvedAssetsById.FindRef(Id);
 }
 
 inline UArticyObject* UArticyPackage::GetAssetByTechnicalName(const FName& TechnicalName) const
 {
-	if (AssetsByTechnicalName.Contains(TechnicalName))
-	{
-		return AssetsByTechnicalName[TechnicalName].Get();
-	}
-
-	return nullptr;
+	return ResolvedAssetsByTechnicalName.FindRef(TechnicalName);
 }
 
 inline TArray<UObject*> UArticyPackage::GetInnerObjects() const
@@ -134,5 +206,7 @@ inline void UArticyPackage::AddAsset(UArticyObject* ArticyObject)
 		Assets.Add(ArticyObject);
 		AssetsByTechnicalName.Add(ArticyObject->GetTechnicalName(), ArticyObject);
 		AssetsById.Add(ArticyId, ArticyObject);
+		ResolvedAssetsByTechnicalName.Add(ArticyObject->GetTechnicalName(), ArticyObject);
+		ResolvedAssetsById.Add(ArticyId, ArticyObject);
 	}
 }
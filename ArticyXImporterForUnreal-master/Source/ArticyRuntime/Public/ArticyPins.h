@@ -14,6 +14,44 @@
 #include "ArticyPins.generated.h"
 
 class UArticyOutgoingConnection;
+class UArticyExpressoScripts;
+class UArticyFlowPin;
+
+/**
+ * A connection from a flow pin to the pin it leads to, stored inline in the pin.
+ */
+USTRUCT(BlueprintType)
+struct ARTICYRUNTIME_API FArticyPinConnection
+{
+	GENERATED_BODY()
+
+public:
+	/** The ID of the target object. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	FArticyId Target;
+
+	/** The ID of the target pin, an InputPin (next node) or an OutputPin (emerge to parent node). */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	FArticyId TargetPin;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	FString Label;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	FLinearColor Color = FLinearColor::White;
+
+	void InitFromJson(TSharedPtr<FJsonValue> Json);
+
+	/** Resolves the target pin in Database, looked up once per database generation. */
+	UArticyFlowPin* GetTargetPin(const UArticyDatabase* Database) const;
+
+private:
+	mutable TWeakObjectPtr<UArticyFlowPin> TargetPinObj;
+
+	/** Database generation TargetPinObj was resolved in, see UArticyDatabase::GetGeneration. */
+	mutable uint32 TargetGeneration = 0;
+};
+
 /**
  * A flow fragment input- or output pin.
  */
@@ -33,19 +71,56 @@ public:
 
 	/** All outgoing connections. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
-	TArray<UArticyOutgoingConnection*> Connections;
+	TArray<FArticyPinConnection> OutgoingConnections;
+
+	/** Connection objects of packages imported before connections were stored inline, moved to OutgoingConnections on load. */
+	UPROPERTY()
+	TArray<UArticyOutgoingConnection*> LegacyConnections;
+
+	/** Whether the script fragment may change any state, computed on import. */
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	bool bHasSideEffects = true;
+
+	/** Whether the script fragment does the same in any state, so exploring the pin never runs it. Computed on import. */
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	bool bIsConstant = false;
+
+	/** The result of a constant condition, true for instructions. */
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	bool bConstantResult = true;
 
 	void InitFromJson(TSharedPtr<FJsonValue> Json) override;
 
+	void PostLoad() override;
+
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	UArticyObject* GetOwner();
 
+	/** The target pin of a connection, replacing GetTargetPin of the connection objects pins used to have. */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	UArticyFlowPin* GetConnectionTarget(int32 ConnectionIndex);
+
+	/** Look up the owner in Database, which the caller already resolved. */
+	UArticyObject* GetOwner(const UArticyDatabase* Database) const;
+
 	//---------------------------------------------------------------------------//
 
 	EArticyPausableType GetType() override { return EArticyPausableType::Pin; }
 
 	//stub implementation
-	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override { ensure(false); }
+	void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override { ensure(false); }
+
+	bool HasSideEffects() const override { return bHasSideEffects; }
+
+protected:
+	/** Index of the script fragment in the jump table of Scripts, looked up on first use. */
+	int32 GetScriptIndex(const UArticyExpressoScripts* Scripts, bool bInstruction) const;
+
+private:
+	/** The expresso scripts instance CachedScriptIndex was looked up in. */
+	mutable TWeakObjectPtr<const UArticyExpressoScripts> CachedScripts;
+
+	mutable int32 CachedScriptIndex = INDEX_NONE;
 };
 
 /**
@@ -64,7 +139,10 @@ public:
 
 	bool Evaluate(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
 
-	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+	/** Evaluate the condition with the scripts, GVs and methods provider of an exploration. */
+	bool Evaluate(const FArticyExploreContext& Context);
+
+	void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
 };
 
 /**
@@ -83,5 +161,8 @@ public:
 
 	void Execute(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
 
-	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+	/** Execute the instruction with the scripts, GVs and methods provider of an exploration. */
+	void Execute(const FArticyExploreContext& Context);
+
+	void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
 };
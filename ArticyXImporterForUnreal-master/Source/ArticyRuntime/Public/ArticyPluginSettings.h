@@ -40,6 +40,13 @@ public:
 	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Sort children when importing"))
 	bool bSortChildrenAtGeneration;
 
+	/**
+	 * Packages with more script fragments than this have their generated expresso scripts split
+	 * into several source files, so they compile in parallel and no single file gets too big.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Max script fragments per generated source file", ClampMin = "1"))
+	int32 MaxScriptFragmentsPerFile;
+
 	/**
 	 * If true, the importer will try to parse the Source/<ProjectName>/<ProjectName>.Build.cs file
 	 * to find a reference to the ArticyRuntime inside it before importing.
@@ -54,6 +61,20 @@ public:
 	UPROPERTY(EditAnywhere, Config, Category = ImportSettings, meta = (DisplayName = "Use legacy importer (prev. Articy 3.2.3)"))
 	bool bUseLegacyImporter;
 
+	/**
+	 * If true, the changes of the .articyue file in the Articy directory are reimported as soon as articy:draft
+	 * has finished writing it. The export is read and parsed in the background, only changed packages are applied.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Reimport when the export changes"))
+	bool bReimportOnExportChange;
+
+	/**
+	 * Seconds without further changes to the export before it is reimported,
+	 * so the several writes of one export only cause one reimport.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Export change delay (seconds)", ClampMin = "0.1", EditCondition = "bReimportOnExportChange"))
+	float ExportChangeDelay;
+
 	/**
 	 * The directory where ArticyContent will be generated and assets are looked for
 	 * (when using ArticyAsset). Also used to search for the .articyue file to regenerate
@@ -82,6 +103,20 @@ public:
 	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Convert Unity formatting to Unreal Rich Text"))
 	bool bConvertUnityToUnrealRichText;
 
+	/**
+	 * Memory the asset prefetcher may keep loaded for upcoming dialogue lines, in megabytes.
+	 * The least recently requested assets are released first when it is exceeded.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Prefetch memory budget (MB)", ClampMin = "0"))
+	int32 PrefetchMemoryBudgetMB;
+
+	/**
+	 * Chunks to cook Articy packages into by package name, so the packages of a chapter end up in the same pak or IoStore container.
+	 * Packages not listed go to the chunks of the assets referencing them.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = CookSettings, meta = (DisplayName = "Package chunk IDs", ClampMin = "0"))
+	TMap<FString, int32> PackageChunkIds;
+
 	/**
 	 * Internal cached data for data consistency between imports (setting restoration etc.).
 	 */
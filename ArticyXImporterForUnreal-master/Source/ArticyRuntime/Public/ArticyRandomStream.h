@@ -0,0 +1,101 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief A seedable, counter-based random number stream for script evaluation.
+ *
+ * Every draw hashes the seed together with the number of draws so far, so the whole state of the stream
+ * is the seed and one counter. Restoring the counter replays the same numbers, which is how shadowed
+ * operations draw without advancing the committed stream, and two streams with the same seed and counter
+ * always produce the same numbers, independent of any other stream or of FMath's global generator.
+ */
+struct FArticyRandomStream
+{
+	FArticyRandomStream() { Initialize(0); }
+
+	/**
+	 * @brief Creates a stream that starts with the first draw of Seed.
+	 *
+	 * @param InSeed The seed of the stream.
+	 */
+	explicit FArticyRandomStream(int32 InSeed) { Initialize(InSeed); }
+
+	/**
+	 * @brief Restarts the stream with the first draw of Seed.
+	 *
+	 * @param InSeed The seed of the stream.
+	 */
+	void Initialize(int32 InSeed)
+	{
+		Seed = InSeed;
+		Key = Mix(uint64(uint32(InSeed)) ^ 0xA0761D6478BD642FULL);
+		Counter = 0;
+	}
+
+	/** @return The seed the stream was initialized with. */
+	int32 GetSeed() const { return Seed; }
+
+	/** @return The number of draws so far. */
+	uint64 GetCounter() const { return Counter; }
+
+	/**
+	 * @brief Moves the stream to a number of draws, e.g. to restore a saved state or roll back shadowed draws.
+	 *
+	 * @param InCounter The number of draws.
+	 */
+	void SetCounter(uint64 InCounter) { Counter = InCounter; }
+
+	/** @return The next 64 random bits. */
+	uint64 Next() { return Mix(Key + Counter++ * 0x9E3779B97F4A7C15ULL); }
+
+	/**
+	 * @brief Draws an integer in the inclusive range [Min, Max].
+	 *
+	 * @param Min The smallest value.
+	 * @param Max The largest value.
+	 * @return The random integer, Min if Max is not larger than Min.
+	 */
+	int64 RandRange(int64 Min, int64 Max)
+	{
+		if (Max <= Min)
+			return Min;
+
+		// a range covering all of int64 wraps to 0, then any value is in it
+		const uint64 range = uint64(Max) - uint64(Min) + 1;
+		const uint64 bits = Next();
+		return range ? int64(uint64(Min) + bits % range) : int64(bits);
+	}
+
+	/**
+	 * @brief Draws a float in the range [Min, Max).
+	 *
+	 * @param Min The smallest value.
+	 * @param Max The upper bound.
+	 * @return The random float.
+	 */
+	float FRandRange(float Min, float Max)
+	{
+		// the top 24 bits fill a float mantissa exactly
+		const float fraction = float(Next() >> 40) * (1.0f / 16777216.0f);
+		return Min + (Max - Min) * fraction;
+	}
+
+private:
+
+	/** Finalizer of SplitMix64, every input bit affects every output bit. */
+	static uint64 Mix(uint64 Z)
+	{
+		Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBULL;
+		return Z ^ (Z >> 31);
+	}
+
+	int32 Seed = 0;
+	uint64 Key = 0;
+	uint64 Counter = 0;
+};
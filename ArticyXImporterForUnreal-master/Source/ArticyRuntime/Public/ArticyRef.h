@@ -6,6 +6,8 @@
 
 #include "ArticyBaseTypes.h"
 #include "ArticyObject.h"
+#include "ArticyDatabase.h"
+#include "ArticyRuntimeStats.h"
 #include "ArticyRef.generated.h"
 
 USTRUCT(BlueprintType)
@@ -119,6 +121,8 @@ private:
 	mutable TWeakObjectPtr<UArticyObject> CachedObject = nullptr;
 	mutable FArticyId CachedId = 0;
 	mutable int32 CachedCloneId = 0;
+	/** Database generation CachedObject was looked up in, see UArticyDatabase::GetGeneration */
+	mutable uint32 CachedGeneration = 0;
 
 	UArticyObject* GetObjectInternal(const UObject* WorldContext) const;
 
@@ -140,13 +144,23 @@ private:
 template<typename T>
 T* FArticyRef::GetObject(const UObject* WorldContext) const
 {
-	if (!CachedObject.IsValid() || CachedId != Id || CloneId != CachedCloneId)
+	if (CachedGeneration == UArticyDatabase::GetGeneration() && CachedId == Id && CloneId == CachedCloneId)
 	{
-		CachedId = Id;
-		CachedCloneId = CloneId;
-		CachedObject = GetObjectInternal(WorldContext);
+		if (UArticyObject* Object = CachedObject.Get())
+		{
+			FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::RefCacheHits);
+			return Cast<T>(Object);
+		}
 	}
 
+	FArticyRuntimeStats::AddCount(FArticyRuntimeStats::ECounter::RefCacheMisses);
+	CachedObject = GetObjectInternal(WorldContext);
+
+	// after the lookup, which may reset the clone ID or create the clone or the database
+	CachedId = Id;
+	CachedCloneId = CloneId;
+	CachedGeneration = UArticyDatabase::GetGeneration();
+
 	return Cast<T>(CachedObject.Get());
 }
 
@@ -68,7 +68,33 @@ public:
      */
     UArticyObject* GetLinkDestination(URichTextBlock* Owner, const FString& Link);
 
+    /**
+     * Resolves a link and the hyperlink handler of a rich text block ahead of navigation.
+     * Called for every link when the rich text block creates its link widgets.
+     *
+     * @param Owner The owning rich text block.
+     * @param Link The URL to resolve.
+     */
+    void PreResolveLink(URichTextBlock* Owner, const FString& Link);
+
     /** Hyperlink style */
     UPROPERTY(EditAnywhere, Category = "articy")
     FHyperlinkStyle HyperlinkStyle;
+
+private:
+    /** A link resolved to an object, valid while the database generation it was resolved in is current */
+    struct FResolvedLink
+    {
+        uint64 Id = 0;
+        bool bIsArticyLink = false;
+        TWeakObjectPtr<UArticyObject> Object;
+        TWeakObjectPtr<const UObject> World;
+        uint32 Generation = 0;
+    };
+
+    /** Links by URL */
+    TMap<FString, FResolvedLink> ResolvedLinks;
+
+    /** Hyperlink handlers by rich text block, nullptr if none of its parents implements the interface */
+    TMap<TWeakObjectPtr<URichTextBlock>, TWeakObjectPtr<UObject>> HyperlinkHandlers;
 };
@@ -0,0 +1,81 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/Ticker.h"
+
+class FArticyRuntimeModule;
+
+/**
+ * @class FArticyRuntimeConsoleCommands
+ * @brief Provides console commands reporting the live state of the Articy runtime.
+ *
+ * Articy.Stats prints the loaded packages, objects, global variables, shadow state, cache hit rates
+ * and flow players of all worlds. With -csvDialogueStats[=Seconds] on the command line, or
+ * "Articy.Stats csv [Seconds]", a row of the same numbers is appended to a CSV file periodically.
+ * Articy.ReplayFlow plays a recording of UArticyFlowPlayer::StartRecording back and prints the time of every step.
+ */
+class FArticyRuntimeConsoleCommands
+{
+public:
+
+	/**
+	 * @brief Constructor that registers the console commands and starts CSV logging if requested on the command line.
+	 *
+	 * @param InModule The ArticyRuntimeModule instance for which console commands are defined.
+	 */
+	explicit FArticyRuntimeConsoleCommands(const FArticyRuntimeModule& InModule);
+
+	~FArticyRuntimeConsoleCommands();
+
+	/**
+	 * @brief Prints the state of the runtime, or starts or stops CSV logging.
+	 *
+	 * @param Args Empty to print, "csv [Seconds]" to start CSV logging, "csv off" to stop it.
+	 * @param World The world the command was run in, unused as all worlds are reported.
+	 * @param Ar The device to print to.
+	 */
+	void Stats(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar);
+
+	/**
+	 * @brief Replays a flow recording on a new flow player and prints the median and maximum time of each step.
+	 *
+	 * The dialogue state of the world is saved before and restored after the replay.
+	 *
+	 * @param Args The recording file and optionally the number of times to replay it.
+	 * @param World The world whose database and global variables are replayed on.
+	 * @param Ar The device to print to.
+	 */
+	void ReplayFlow(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar);
+
+private:
+
+	/**
+	 * Starts appending a row to a new CSV file every Interval seconds.
+	 * @param Interval Seconds between two rows.
+	 */
+	void StartCsv(float Interval);
+
+	void StopCsv();
+
+	/** Appends a row to the CSV file, called by the ticker. */
+	bool WriteCsvRow(float DeltaTime);
+
+	/** Reference to the ArticyRuntimeModule instance associated with these console commands. */
+	const FArticyRuntimeModule& Module;
+
+	/** Console command for printing the runtime state. */
+	FAutoConsoleCommand StatsCommand;
+
+	/** Console command for replaying a flow recording. */
+	FAutoConsoleCommand ReplayFlowCommand;
+
+	/** The CSV file written to, empty while not logging. */
+	FString CsvPath;
+
+	FTSTicker::FDelegateHandle CsvHandle;
+};
@@ -9,6 +9,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogArticyRuntime, Log, All)
 
+class FArticyRuntimeConsoleCommands;
+
 /**
  * Module for the Articy Runtime.
  *
@@ -30,4 +32,7 @@ public:
 	 * This method is called when the module is unloaded from memory.
 	 */
 	virtual void ShutdownModule() override;
+
+private:
+	FArticyRuntimeConsoleCommands* ConsoleCommands = nullptr;
 };
@@ -0,0 +1,102 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/** Unreal Insights channel of the runtime, enable with -trace=cpu,ArticyRuntime */
+UE_TRACE_CHANNEL_EXTERN(ArticyRuntimeChannel, ARTICYRUNTIME_API);
+
+/**
+ * Global variable access logging, compiled out of Shipping builds. Otherwise it is switched on with the
+ * ArticyVariables channel (-trace=ArticyVariables, Trace.Enable ArticyVariables or EnableDebugLogging),
+ * so a variable write only tests the channel while nobody is listening.
+ */
+#ifndef ARTICY_GV_LOGGING
+#define ARTICY_GV_LOGGING !UE_BUILD_SHIPPING
+#endif
+
+#if ARTICY_GV_LOGGING
+UE_TRACE_CHANNEL_EXTERN(ArticyVariablesChannel, ARTICYRUNTIME_API);
+
+/** Logs to LogArticyRuntime if the ArticyVariables channel is enabled */
+#define ARTICY_GV_LOG(Verbosity, Format, ...) \
+	do { if (UE_TRACE_CHANNELEXPR_IS_ENABLED(ArticyVariablesChannel)) { UE_LOG(LogArticyRuntime, Verbosity, Format, ##__VA_ARGS__); } } while (0)
+#else
+#define ARTICY_GV_LOG(Verbosity, Format, ...) do { } while (0)
+#endif
+
+/** Memory of the runtime in the Low-Level Memory tracker, reported under Articy with -llm */
+LLM_DECLARE_TAG_API(Articy, ARTICYRUNTIME_API);
+LLM_DECLARE_TAG_API(Articy_Database, ARTICYRUNTIME_API);
+LLM_DECLARE_TAG_API(Articy_Packages, ARTICYRUNTIME_API);
+LLM_DECLARE_TAG_API(Articy_GlobalVariables, ARTICYRUNTIME_API);
+LLM_DECLARE_TAG_API(Articy_Shadows, ARTICYRUNTIME_API);
+LLM_DECLARE_TAG_API(Articy_Text, ARTICYRUNTIME_API);
+
+/** Shown with stat Articy */
+DECLARE_STATS_GROUP(TEXT("Articy"), STATGROUP_Articy, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Explore"), STAT_ArticyExplore, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shadowed operation"), STAT_ArticyShadowedOperation, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate condition"), STAT_ArticyEvaluate, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute instruction"), STAT_ArticyExecute, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve text"), STAT_ArticyResolveText, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load package"), STAT_ArticyLoadPackage, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Unload package"), STAT_ArticyUnloadPackage, STATGROUP_Articy, ARTICYRUNTIME_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes visited"), STAT_ArticyNodesVisited, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Conditions evaluated"), STAT_ArticyConditionsEvaluated, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shadow pushes"), STAT_ArticyShadowPushes, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Objects duplicated"), STAT_ArticyObjectsDuplicated, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Branches produced"), STAT_ArticyBranchesProduced, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Text cache hits"), STAT_ArticyTextCacheHits, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Text cache misses"), STAT_ArticyTextCacheMisses, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ref cache hits"), STAT_ArticyRefCacheHits, STATGROUP_Articy, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ref cache misses"), STAT_ArticyRefCacheMisses, STATGROUP_Articy, ARTICYRUNTIME_API);
+
+/** Counts a scope to its stat and traces it on ArticyRuntimeChannel. */
+#define ARTICY_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, ArticyRuntimeChannel)
+
+/**
+ * Counters of the runtime, per frame in stat Articy and as running totals in Unreal Insights and articy.stats.
+ * The flow player, scripts and database only run on the game thread, so the counters are not locked.
+ */
+struct ARTICYRUNTIME_API FArticyRuntimeStats
+{
+	enum class ECounter : uint8
+	{
+		NodesVisited,
+		ConditionsEvaluated,
+		ShadowPushes,
+		ObjectsDuplicated,
+		BranchesProduced,
+		TextCacheHits,
+		TextCacheMisses,
+		RefCacheHits,
+		RefCacheMisses,
+		Num
+	};
+
+	/**
+	 * Adds to a counter.
+	 * @param Counter The counter to add to.
+	 * @param Delta The amount to add.
+	 */
+	static void AddCount(ECounter Counter, int64 Delta = 1);
+
+	/**
+	 * Gets the running total of a counter since the module was loaded.
+	 * @param Counter The counter to get.
+	 * @return The sum of everything added to the counter.
+	 */
+	static int64 GetTotal(ECounter Counter);
+};
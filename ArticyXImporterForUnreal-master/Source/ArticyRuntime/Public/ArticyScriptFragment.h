@@ -10,6 +10,8 @@
 #include "Interfaces/ArticyInstructionProvider.h"
 #include "ArticyScriptFragment.generated.h"
 
+class UArticyExpressoScripts;
+
 /**
  * Base class for the script fragments (ArticyScriptCondition or ArticyScriptInstruction).
  *
@@ -27,6 +29,13 @@ public:
      * @return A constant reference to the expression string.
      */
     const FString& GetExpression() const { return Expression; }
+
+    /**
+     * Whether running the expression may change any state.
+     *
+     * @return True if the expression may write variables or call methods.
+     */
+    bool HasSideEffects() const { return bHasSideEffects; }
 protected:
 
     /**
@@ -35,6 +44,12 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
     FString Expression = "";
 
+    /**
+     * Whether the expression may change any state, computed on import.
+     */
+    UPROPERTY(VisibleAnywhere, Category = "Articy")
+    bool bHasSideEffects = true;
+
     /**
      * Returns a cached hash of the expression.
      *
@@ -42,6 +57,16 @@ protected:
      */
     int GetExpressionHash() const;
 
+    /**
+     * Returns the index of the expression in the jump table of the expresso scripts.
+     * The index is looked up on first use and cached per expresso scripts instance.
+     *
+     * @param Scripts The expresso scripts instance that runs the expression.
+     * @param bInstruction Whether to look the expression up as an instruction or as a condition.
+     * @return The index of the expression, or INDEX_NONE if it was not generated.
+     */
+    int32 GetScriptIndex(const UArticyExpressoScripts* Scripts, bool bInstruction) const;
+
     template<typename Type, typename PropType>
     friend struct ArticyObjectTypeInfo;
 
@@ -58,6 +83,16 @@ private:
      * Cached hash of the expression to optimize performance.
      */
     mutable int CachedExpressionHash;
+
+    /**
+     * The expresso scripts instance the cached index was looked up in.
+     */
+    mutable TWeakObjectPtr<const UArticyExpressoScripts> CachedScripts;
+
+    /**
+     * Cached index of the expression in the jump table of CachedScripts.
+     */
+    mutable int32 CachedScriptIndex = INDEX_NONE;
 };
 
 /** -------------------------------------------------------------------------------- */
@@ -80,6 +115,14 @@ public:
      * @return True if the condition evaluates to true, false otherwise.
      */
     bool Evaluate(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
+
+    /**
+     * Evaluates the script condition with the scripts, GVs and methods provider of an exploration.
+     *
+     * @param Context The context of the exploration.
+     * @return True if the condition evaluates to true, false otherwise.
+     */
+    bool Evaluate(const FArticyExploreContext& Context);
 };
 
 /**
@@ -119,10 +162,18 @@ public:
      * Explores the condition node and appends the resulting branches to the output array.
      *
      * @param Player A pointer to the flow player handling the exploration.
+     * @param Context The database, global variables, scripts and methods provider of the exploration.
      * @param OutBranches An array to which the resulting branches are appended.
      * @param Depth The current depth of exploration.
      */
-    void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+    void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+
+    /**
+     * Whether evaluating the condition may change any state.
+     *
+     * @return True if the condition script has side-effects.
+     */
+    bool HasSideEffects() const override { return GetCondition() && GetCondition()->HasSideEffects(); }
 
 private:
 
@@ -152,6 +203,13 @@ public:
      * @param MethodProvider A pointer to the method provider object.
      */
     void Execute(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
+
+    /**
+     * Executes the script instruction with the scripts, GVs and methods provider of an exploration.
+     *
+     * @param Context The context of the exploration.
+     */
+    void Execute(const FArticyExploreContext& Context);
 };
 
 /**
@@ -190,10 +248,18 @@ public:
      * Explores the instruction node and appends the resulting branches to the output array.
      *
      * @param Player A pointer to the flow player handling the exploration.
+     * @param Context The database, global variables, scripts and methods provider of the exploration.
      * @param OutBranches An array to which the resulting branches are appended.
      * @param Depth The current depth of exploration.
      */
-    void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+    void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+
+    /**
+     * Whether executing the instruction may change any state.
+     *
+     * @return True if the instruction script has side-effects.
+     */
+    bool HasSideEffects() const override { return GetInstruction() && GetInstruction()->HasSideEffects(); }
 
 private:
 
@@ -0,0 +1,156 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FArticyScriptCapture;
+
+/**
+ * Opt-in profiler of the expresso script fragments.
+ *
+ * While enabled, every condition and instruction run by a script fragment or pin is timed and
+ * recorded by its expression hash, together with the expression text and the object it was first
+ * run for. Identical expressions share a hash and therefore one record.
+ * Controlled with the Articy.ScriptProfiler.Start/Stop/Reset/Dump console commands.
+ */
+struct ARTICYRUNTIME_API FArticyScriptProfiler
+{
+	struct FRecord
+	{
+		FString Expression;
+		FString Owner;
+		uint32 Hash = 0;
+		bool bInstruction = false;
+		int64 Calls = 0;
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+	};
+
+	/**
+	 * Checks if fragments are profiled.
+	 * @return True while the profiler records.
+	 */
+	static bool IsEnabled() { return bEnabled; }
+
+	/**
+	 * Starts or stops recording, the records are kept until Reset.
+	 * @param bInEnabled Whether to record.
+	 */
+	static void SetEnabled(bool bInEnabled) { bEnabled = bInEnabled; }
+
+	/** Forgets all records. */
+	static void Reset();
+
+	/**
+	 * Records one run of a fragment.
+	 * @param Site The script fragment or pin that ran.
+	 * @param bInstruction Whether the fragment ran as an instruction.
+	 * @param Seconds The time the run took.
+	 */
+	static void Record(const UObject* Site, bool bInstruction, double Seconds);
+
+	/**
+	 * Gets the records, most expensive in total first.
+	 * @return The records.
+	 */
+	static TArray<FRecord> GetSortedRecords();
+
+	/**
+	 * Writes the records as CSV, most expensive in total first.
+	 * @param Path The file to write, empty for a timestamped file in the profiling directory.
+	 * @return The path written to, empty if writing failed.
+	 */
+	static FString DumpCsv(const FString& Path = FString());
+
+	/**
+	 * Gets the capture the fragments run now are timed for, independent of whether the profiler records.
+	 * @return The active capture, null if there is none.
+	 */
+	static FArticyScriptCapture* GetCapture() { return Capture; }
+
+	/**
+	 * Makes a capture the active one, see FArticyScriptCaptureScope.
+	 * @param InCapture The capture to time the fragments for, null to stop capturing.
+	 */
+	static void SetCapture(FArticyScriptCapture* InCapture) { Capture = InCapture; }
+
+private:
+	static bool bEnabled;
+	static TMap<uint64, FRecord> Records;
+	static FArticyScriptCapture* Capture;
+};
+
+/**
+ * The fragments run while a capture is active, timed per fragment, e.g. for a single exploration.
+ * A capture is kept apart from the records of the profiler, so it also works while the profiler is stopped.
+ */
+struct ARTICYRUNTIME_API FArticyScriptCapture
+{
+	struct FSite
+	{
+		bool bInstruction = false;
+		int32 Calls = 0;
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+	};
+
+	/** The fragments and pins that ran, by the site passed to the profiler. */
+	TMap<const UObject*, FSite> Sites;
+
+	void Reset() { Sites.Reset(); }
+
+	/**
+	 * Gets the most expensive sites in total first, described like the records of the profiler.
+	 * @param MaxRecords The number of sites to return at most.
+	 * @return The records.
+	 */
+	TArray<FArticyScriptProfiler::FRecord> GetSortedRecords(int32 MaxRecords) const;
+};
+
+/**
+ * Makes a capture the active one for its scope, null leaves the active capture as it is.
+ */
+struct FArticyScriptCaptureScope
+{
+	explicit FArticyScriptCaptureScope(FArticyScriptCapture* InCapture)
+		: Previous(FArticyScriptProfiler::GetCapture())
+	{
+		if (InCapture)
+			FArticyScriptProfiler::SetCapture(InCapture);
+	}
+
+	~FArticyScriptCaptureScope()
+	{
+		FArticyScriptProfiler::SetCapture(Previous);
+	}
+
+private:
+	FArticyScriptCapture* Previous;
+};
+
+/**
+ * Times the script run in its scope if the profiler is enabled or a capture is active.
+ */
+struct FArticyScriptProfileScope
+{
+	FArticyScriptProfileScope(const UObject* InSite, bool bInInstruction)
+		: Site(FArticyScriptProfiler::IsEnabled() || FArticyScriptProfiler::GetCapture() ? InSite : nullptr)
+		, bInstruction(bInInstruction)
+		, StartCycles(Site ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FArticyScriptProfileScope()
+	{
+		if (Site)
+			FArticyScriptProfiler::Record(Site, bInstruction, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+
+private:
+	const UObject* Site;
+	bool bInstruction;
+	uint64 StartCycles;
+};
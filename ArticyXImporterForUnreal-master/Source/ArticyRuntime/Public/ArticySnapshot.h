@@ -0,0 +1,63 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UArticyDatabase;
+class UArticyFlowPlayer;
+class UArticyGlobalVariables;
+
+/**
+ * @brief Compact binary snapshots of the dialogue state for save games.
+ *
+ * A snapshot holds the values of the global variables, the seen counters and fallback flags,
+ * the clone table of the database and the cursors of flow players (ID and clone ID) in one byte buffer.
+ * Variables are stored with a name table, so a snapshot written by an older export can be loaded
+ * after variables were renamed (see RenamedVariables) or removed.
+ * Writing a snapshot does not use reflection and does not look up any variable by name, which makes
+ * it cheap enough for frequent autosaves.
+ */
+struct ARTICYRUNTIME_API FArticySnapshot
+{
+	/** Versions of the snapshot format, snapshots of all older versions can be loaded. */
+	enum class EVersion : int32
+	{
+		Initial = 1,
+
+		// add new versions above this line
+		VersionPlusOne,
+		Latest = VersionPlusOne - 1
+	};
+
+	/**
+	 * @brief Writes a snapshot of the dialogue state.
+	 *
+	 * Snapshots can only be taken outside of a shadowed operation, when both shadow levels are 0.
+	 *
+	 * @param OutBytes The buffer the snapshot is written to, its previous contents are replaced.
+	 * @param GlobalVariables The variables to write.
+	 * @param Database The database whose clone table is written, can be null.
+	 * @param FlowPlayers The flow players whose cursors are written, in the order they are loaded.
+	 * @return False if the snapshot can't be taken now.
+	 */
+	static bool Save(TArray<uint8>& OutBytes, const UArticyGlobalVariables* GlobalVariables, const UArticyDatabase* Database, TArrayView<UArticyFlowPlayer* const> FlowPlayers);
+
+	/**
+	 * @brief Restores the dialogue state of a snapshot written by Save.
+	 *
+	 * The variables are restored first, then the clones are recreated and the flow players are moved to their cursors,
+	 * which explores the branches with the restored variables.
+	 * Flow players are matched by their order, a cursor whose object is not loaded keeps its flow player where it is.
+	 *
+	 * @param Bytes The snapshot.
+	 * @param GlobalVariables The variables to restore.
+	 * @param Database The database to recreate the clones in, can be null to skip them.
+	 * @param FlowPlayers The flow players to restore the cursors of, in the order they were written.
+	 * @param RenamedVariables Maps full variable names (Namespace.Variable) at the time of the snapshot to their current ones.
+	 * @return False if the snapshot could not be read or can't be loaded now.
+	 */
+	static bool Load(const TArray<uint8>& Bytes, UArticyGlobalVariables* GlobalVariables, UArticyDatabase* Database, TArrayView<UArticyFlowPlayer* const> FlowPlayers, const TMap<FName, FName>& RenamedVariables = TMap<FName, FName>());
+};
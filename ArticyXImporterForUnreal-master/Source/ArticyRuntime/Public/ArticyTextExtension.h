@@ -10,6 +10,9 @@
 
 using FArticyUserMethodCallback = TFunction<FString(const TArray<FString>&)>;
 
+/** A user method reading its arguments as views into the compiled text, without copying them */
+using FArticyUserMethodViewCallback = TFunction<FString(TConstArrayView<FStringView>)>;
+
 struct FArticyGvName;
 class UArticyVariable;
 
@@ -22,6 +25,141 @@ enum class EArticyObjectType : uint8
 	Other
 };
 
+/**
+ * A C# style custom numeric format string, split into the runs it is applied by.
+ */
+struct ARTICYRUNTIME_API FArticyNumberFormat
+{
+	enum class EOp : uint8
+	{
+		/** The rounded value, padded with zeros to Count digits */
+		Integer,
+		/** The value with Count fractional digits */
+		Fixed,
+		/** Text copied as is */
+		Literal
+	};
+
+	struct FOp
+	{
+		EOp Op;
+		int32 Count;
+		FString Text;
+	};
+
+	TArray<FOp> Ops;
+
+	bool IsEmpty() const { return Ops.Num() == 0; }
+};
+
+/**
+ * A source of a [...] token, parsed into what it resolves to.
+ */
+struct ARTICYRUNTIME_API FArticyTextSource
+{
+	enum class EKind : uint8
+	{
+		/** Resolves to an empty string */
+		None,
+		/** A built-in or user method, resolves to its result */
+		Method,
+		/** $Type.TypeName.Property, resolves to the type of the property */
+		Type,
+		/** A global variable, or else a property or type of an object */
+		Property
+	};
+
+	/** The methods of the text extension, all others are user methods */
+	enum class EMethod : uint8
+	{
+		User,
+		If,
+		Not
+	};
+
+	EKind Kind = EKind::None;
+
+	/** The source as written, the result if it cannot be resolved */
+	FString SourceName;
+
+	FString Method;
+	TArray<FString> Arguments;
+
+	EMethod BuiltinMethod = EMethod::User;
+
+	/** The handle of the user method once the text extension bound the source, INDEX_NONE before */
+	int32 MethodHandle = INDEX_NONE;
+
+	FName TypeName;
+
+	/** The global variable, namespace and variable */
+	FName Namespace;
+	FName Variable;
+	FName VariableFullName;
+
+	/** The object, by ID or by technical name */
+	bool bObjectById = false;
+	uint64 ObjectId = 0;
+	FName ObjectName;
+	int32 ObjectInstance = 0;
+
+	/** The property of the type or object */
+	FString PropertyName;
+
+	/** Whether the type of the object's property is requested instead of its value */
+	bool bRequestType = false;
+};
+
+/**
+ * A text split into literal spans, {N} argument placeholders and [...] tokens.
+ * Resolving it only appends the spans and the values of the placeholders and tokens.
+ */
+struct ARTICYRUNTIME_API FArticyTextTemplate
+{
+	struct FSegment
+	{
+		enum class EKind : uint8
+		{
+			Literal,
+			Argument,
+			Token
+		};
+
+		EKind Kind = EKind::Literal;
+
+		/** The literal text, or the argument placeholder as written */
+		FString Text;
+
+		int32 ArgumentIndex = INDEX_NONE;
+
+		FArticyTextSource Source;
+		FArticyNumberFormat Format;
+	};
+
+	TArray<FSegment> Segments;
+
+	/** Whether a token contains a '{', it can only be parsed after the arguments were inserted */
+	bool bHasArgumentsInTokens = false;
+
+	/** Length of all literal spans */
+	int32 LiteralLength = 0;
+};
+
+/**
+ * A text to localize and resolve ahead of display, see UArticyTextExtension::PrepareTexts.
+ */
+struct ARTICYRUNTIME_API FArticyTextToPrepare
+{
+	/** The object the text belongs to, the variables and objects it shows are found in its database */
+	TWeakObjectPtr<UObject> Outer;
+
+	/** The localization key of the text, as its text property holds it */
+	FText Key;
+
+	/** Returned for preview texts that are not localized, like the BackupText of LocalizeString */
+	TOptional<FText> BackupText;
+};
+
 UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyTextExtension : public UObject
 {
@@ -46,21 +184,164 @@ public:
 		Types... Args
 	) const;
 
-	void AddUserMethod(const FString& MethodName, FArticyUserMethodCallback Callback);
+	/**
+	 * @brief Registers a method texts call as [Source.Method(a,b)], replacing a method of the same name.
+	 *
+	 * @param MethodName The name texts call the method by.
+	 * @param Callback The method, called with the arguments as written.
+	 * @return The handle of the method, the same for every registration of the name.
+	 */
+	int32 AddUserMethod(const FString& MethodName, FArticyUserMethodCallback Callback);
+
+	/**
+	 * @brief Registers a method that reads its arguments as string views, replacing a method of the same name.
+	 *
+	 * @param MethodName The name texts call the method by.
+	 * @param Callback The method, called with views into the compiled text that are only valid during the call.
+	 * @return The handle of the method, the same for every registration of the name.
+	 */
+	int32 AddUserMethodView(const FString& MethodName, FArticyUserMethodViewCallback Callback);
+
+	/**
+	 * @brief Finds the handle of a user method.
+	 *
+	 * @param MethodName The name of the method.
+	 * @return The handle, INDEX_NONE if the method was neither registered nor called by a text.
+	 */
+	int32 FindUserMethod(const FString& MethodName) const;
+
+	/**
+	 * @brief Splits a text into a template, the template of a text is built once and then cached.
+	 *
+	 * @param Format The text with {N} placeholders and [...] tokens.
+	 * @return The template of the text.
+	 */
+	const FArticyTextTemplate& GetTemplate(const FString& Format) const;
+
+	static void CompileSource(const FString& SourceName, FArticyTextSource& OutSource);
+	static void CompileNumberFormat(const FString& NumberFormat, FArticyNumberFormat& OutFormat);
+
+	/** Drops all cached resolved texts, e.g. after the string tables were reloaded */
+	void ResetResolvedTexts();
+
+	/** Marks all cached resolved texts as stale, each one is resolved again only when it is requested */
+	void InvalidateResolvedTexts();
+
+	/**
+	 * @brief Localizes and resolves texts ahead of display, resolving them on a worker thread.
+	 *
+	 * The texts are localized and compiled, and the global variables they show are captured into an immutable
+	 * snapshot on the game thread, a worker then resolves them from the templates and the snapshot alone.
+	 * Texts that call methods or show object or type properties need the game thread, they are resolved
+	 * right before the results are delivered.
+	 *
+	 * @param Texts The texts to prepare.
+	 * @param OnPrepared Called on the game thread with the resolved texts, in the order of Texts.
+	 */
+	void PrepareTexts(TArray<FArticyTextToPrepare> Texts, TFunction<void(TArray<FText>&&)> OnPrepared);
 
 protected:
+	/** A global variable a resolved text depends on, with the value the text was resolved with */
+	struct FResolvedTextDependency
+	{
+		TWeakObjectPtr<const UArticyVariable> Variable;
+		int32 IntValue = 0;
+		FString StringValue;
+	};
+
+	/** A text resolved without arguments */
+	struct FResolvedText
+	{
+		FText Result;
+		TWeakObjectPtr<const UObject> World;
+		TWeakObjectPtr<const UObject> Store;
+		uint32 DatabaseGeneration = 0;
+		uint32 TextsGeneration = 0;
+		TArray<FResolvedTextDependency> Dependencies;
+	};
+
+	/** What the text that is resolved right now depends on */
+	struct FResolveRecord
+	{
+		const UObject* Store = nullptr;
+		TArray<FResolvedTextDependency> Dependencies;
+		bool bCacheable = true;
+	};
+
+	/**
+	 * @brief Resolves a text without arguments, reusing the last result while nothing it depends on changed.
+	 *
+	 * Texts that call methods or read object properties are resolved every time.
+	 */
+	FText ResolveCached(UObject* Outer, const FText& Format) const;
+	bool IsResolvedTextCurrent(UObject* Outer, const FResolvedText& Entry, const UObject* World) const;
+	static FResolvedTextDependency MakeDependency(const UArticyVariable* Variable);
+	static bool IsDependencyCurrent(const FResolvedTextDependency& Dependency);
+
 	FString GetSource(UObject* Outer, const FString &SourceName) const;
+	FString ResolveSource(UObject* Outer, const FArticyTextSource& Source) const;
 	FString FormatNumber(const FString &SourceValue, const FString &NumberFormat) const;
+	static FString FormatNumber(const FString &SourceValue, const FArticyNumberFormat& NumberFormat);
+	FString ResolveTemplate(UObject* Outer, const FString& Format, const TArray<FString>& ArgumentValues) const;
+	FString ResolveUncompiled(UObject* Outer, FString FormattedString, const TArray<FString>& ArgumentValues) const;
+	static bool CanUseTemplate(const FArticyTextTemplate& Template, const TArray<FString>& ArgumentValues);
 	void GetGlobalVariable(UObject* Outer, const FString& SourceName, const FArticyGvName GvName, FString& OutString, bool& OutSuccess) const;
-	void GetObjectProperty(UObject* Outer, const FString& SourceName, const FString& NameOrId, const FString& PropertyName, const bool bRequestType, FString& OutString, bool& OutSuccess) const;
-	static void GetTypeProperty(const FString& TypeName, const FString& PropertyName, FString& OutString, bool& OutSuccess);
-	FString ExecuteMethod(UObject* Outer, const FText& Method, const TArray<FString>& Args) const;
+	void GetObjectProperty(UObject* Outer, const FArticyTextSource& Source, FString& OutString, bool& OutSuccess) const;
+	static void GetTypeProperty(FName TypeName, const FString& PropertyName, FString& OutString, bool& OutSuccess);
+	FString ExecuteMethod(UObject* Outer, const FArticyTextSource& Source) const;
 	EArticyObjectType GetObjectType(UArticyVariable** Object) const;
 	FString ResolveBoolean(UObject* Outer, const FString &SourceName, const bool Value) const;
 	FString LocalizeString(UObject* Outer, const FString &Input) const;
 	static void SplitInstance(const FString& InString, FString& OutName, FString& OutInstanceNumber);
 
-	TMap<FString, FArticyUserMethodCallback> UserMethodMap;
+	/** The user methods by handle, and their handles by name */
+	mutable TArray<FUserMethod> UserMethods;
+	mutable TMap<FString, int32> UserMethodHandles;
+
+	/** The templates of all texts resolved so far, by text */
+	mutable TMap<FString, TSharedRef<const FArticyTextTemplate>> Templates;
+
+	/** The texts resolved without arguments, by text, those of an older ResolvedTextsGeneration are stale */
+	mutable TMap<FString, FResolvedText> ResolvedTexts;
+	mutable FString ResolvedTextsCulture;
+	mutable uint32 ResolvedTextsGeneration = 1;
+
+	/** Finds or compiles the template of a text, templates are never changed once compiled */
+	TSharedRef<const FArticyTextTemplate> FindOrAddTemplate(const FString& Format) const;
+
+	/**
+	 * @brief Captures the values of the global variables a template shows, as the tokens resolve them.
+	 *
+	 * @param Outer The object the text belongs to.
+	 * @param Template The template whose tokens are captured.
+	 * @param OutValues Receives the values by source name, sources that are no global variable are left out.
+	 */
+	void CaptureVariables(UObject* Outer, const FArticyTextTemplate& Template, TMap<FString, FString>& OutValues) const;
+
+	/**
+	 * @brief Resolves a template from captured variable values only, safe to call on any thread.
+	 *
+	 * @param Template The template of the text.
+	 * @param Values The values of the global variables by source name.
+	 * @param OutResult Receives the resolved text.
+	 * @return False if a token needs anything but the values, the text must then be resolved on the game thread.
+	 */
+	static bool ResolveFromSnapshot(const FArticyTextTemplate& Template, const TMap<FString, FString>& Values, FString& OutResult);
+
+	/** A user method, methods called by a text before they were registered have no callback yet */
+	struct FUserMethod
+	{
+		FString Name;
+		FArticyUserMethodCallback Callback;
+		FArticyUserMethodViewCallback ViewCallback;
+	};
+
+	/** Binds a compiled method source to its handle, so resolving it needs no lookup by name */
+	void BindMethod(FArticyTextSource& Source) const;
+	int32 FindOrAddUserMethod(const FString& MethodName) const;
+
+	/** Set while a cached text is resolved */
+	mutable FResolveRecord* ActiveRecord = nullptr;
 };
 
 template<typename ... Types>
@@ -72,71 +353,59 @@ FText UArticyTextExtension::Resolve(UObject* Outer, const FText* Format, Types..
 		return FText::GetEmpty();
 	}
 
-	TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
-    
-	FString FormattedString = Format->ToString();
-
-	// Regular placeholder replacement
-	for (int32 ArgIndex = 0; ArgIndex < ArgumentValues.Num(); ++ArgIndex)
+	if (sizeof...(Args) == 0)
 	{
-		const FString Placeholder = FString::Printf(TEXT("{%d}"), ArgIndex);
-		FormattedString = FormattedString.Replace(*Placeholder, *ArgumentValues[ArgIndex]);
+		return ResolveCached(Outer, *Format);
 	}
 
-	// Token replacement
-	while (true)
-	{
-		const int32 TokenStartIndex = FormattedString.Find(TEXT("["), ESearchCase::CaseSensitive);
-		if (TokenStartIndex == INDEX_NONE)
-			break;
+	const TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
+	return FText::FromString(ResolveTemplate(Outer, Format->ToString(), ArgumentValues));
+}
 
-		const int32 TokenEndIndex = FormattedString.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, TokenStartIndex);
-		if (TokenEndIndex == INDEX_NONE)
-			break;
+template<typename ... Types>
+FText UArticyTextExtension::ResolveAdvance(const FText& Format, TMap<FString, TFunction<FString(Types...)>> CallbackMap, Types... Args) const
+{
+	TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
+    
+	FString FormattedString = Format.ToString();
 
-		FString Token = FormattedString.Mid(TokenStartIndex + 1, TokenEndIndex - TokenStartIndex - 1);
-		FString FullToken = FormattedString.Mid(TokenStartIndex, TokenEndIndex - TokenStartIndex + 1);
-		FString SourceName, Formatting;
-		
-		Token.Split(TEXT(":"), &SourceName, &Formatting);
-		if (SourceName.IsEmpty())
-		{
-			SourceName = Token;
-		}
-		
-		if (!SourceName.IsEmpty())
+	const FArticyTextTemplate& Template = GetTemplate(FormattedString);
+	if (CanUseTemplate(Template, ArgumentValues))
+	{
+		FString Result;
+		Result.Reserve(Template.LiteralLength);
+
+		bool bValueHasTokens = false;
+		for (const FArticyTextTemplate::FSegment& Segment : Template.Segments)
 		{
-			// Get value from source
-			FString SourceValue = GetSource(Outer, SourceName);
-            
-			if (!Formatting.IsEmpty())
+			switch (Segment.Kind)
 			{
-				// Custom format the SourceValue based on the rules of C#'s custom numeric format strings
-				FString FormattedValue = FormatNumber(SourceValue, Formatting);
-				FormattedString = FormattedString.Replace(*FullToken, *FormattedValue);
-			}
-			else
-			{
-				FormattedString = FormattedString.Replace(*FullToken, *SourceValue);
+			case FArticyTextTemplate::FSegment::EKind::Literal:
+				Result += Segment.Text;
+				break;
+			case FArticyTextTemplate::FSegment::EKind::Argument:
+				Result += ArgumentValues.IsValidIndex(Segment.ArgumentIndex) ? ArgumentValues[Segment.ArgumentIndex] : Segment.Text;
+				break;
+			case FArticyTextTemplate::FSegment::EKind::Token:
+				if (Segment.Source.SourceName.IsEmpty())
+					break;
+				if (const TFunction<FString(Types...)>* Callback = CallbackMap.Find(Segment.Source.SourceName))
+				{
+					const FString ReplacementValue = (*Callback)(Args...);
+					bValueHasTokens |= ReplacementValue.Contains(TEXT("["));
+					Result += ReplacementValue;
+				}
+				break;
 			}
 		}
-		else
+
+		// Values with tokens of their own are resolved again below
+		if (!bValueHasTokens)
 		{
-			// Remove invalid token if source name is empty
-			FormattedString = FormattedString.Replace(*FullToken, TEXT(""));
+			return FText::FromString(Result);
 		}
 	}
 
-	return FText::FromString(FormattedString);
-}
-
-template<typename ... Types>
-FText UArticyTextExtension::ResolveAdvance(const FText& Format, TMap<FString, TFunction<FString(Types...)>> CallbackMap, Types... Args) const
-{
-	TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
-    
-	FString FormattedString = Format.ToString();
-
 	// Regular placeholder replacement
 	for (int32 ArgIndex = 0; ArgIndex < ArgumentValues.Num(); ++ArgIndex)
 	{
@@ -15,6 +15,17 @@ class ARTICYRUNTIME_API UArticyTypeSystem : public UObject
 
 public:
 	static UArticyTypeSystem* Get();
-	FArticyType GetArticyType(const FString& TypeName) const;
-	TMap<FString, FArticyType> Types;
+
+	/**
+	 * Gets the type with a technical name.
+	 * @param TypeName The technical name of the type.
+	 * @return The type, or an empty one if there is none with the name.
+	 */
+	const FArticyType& GetArticyType(FName TypeName) const;
+
+	/** Gets the type with a technical name, without adding the name to the name table if no type has it. */
+	const FArticyType& GetArticyType(const FString& TypeName) const;
+
+	/** The types by technical name. */
+	TMap<FName, FArticyType> Types;
 };
@@ -0,0 +1,195 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ArticyVariableReplicator.generated.h"
+
+class UArticyAlternativeGlobalVariables;
+class UArticyGlobalVariables;
+class UArticyVariable;
+class UArticyVariableReplicator;
+
+/** The type of a replicated variable, which decides how its value is packed. */
+enum class EArticyReplicatedVariableType : uint8
+{
+	Bool,
+	Int,
+	String
+};
+
+/**
+ * The latest value of a variable that was changed on the server.
+ * Packed by NetSerialize: the slot and ints as varints, a bool as a single bit and a string as its index in the string table.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyReplicatedVariable : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** Index of the variable in UArticyGlobalVariables::GetAllVariables, the same on the server and the clients. */
+	int32 Slot = INDEX_NONE;
+
+	/** An EArticyReplicatedVariableType. */
+	uint8 Type = 0;
+
+	/** The value of a bool or int, or the index of a string in the string table. */
+	int32 Value = 0;
+
+	void PostReplicatedAdd(const struct FArticyReplicatedVariables& InArraySerializer);
+	void PostReplicatedChange(const struct FArticyReplicatedVariables& InArraySerializer);
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FArticyReplicatedVariable> : public TStructOpsTypeTraitsBase2<FArticyReplicatedVariable>
+{
+	enum { WithNetSerializer = true };
+};
+
+/** The variables that differ from the asset, only the items that changed since the last update are sent. */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyReplicatedVariables : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FArticyReplicatedVariable> Items;
+
+	/** The component replicating this array, receives the changes on clients. Not a property, so it is never copied from the archetype. */
+	UArticyVariableReplicator* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FArticyReplicatedVariable, FArticyReplicatedVariables>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FArticyReplicatedVariables> : public TStructOpsTypeTraitsBase2<FArticyReplicatedVariables>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/** A string value, sent once no matter how many variables are set to it. */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyReplicatedString : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+
+	UPROPERTY()
+	FString Value;
+
+	void PostReplicatedAdd(const struct FArticyReplicatedStrings& InArraySerializer);
+};
+
+/** The string table of string variables, strings are only ever added. */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyReplicatedStrings : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FArticyReplicatedString> Items;
+
+	/** The component replicating this array, receives the strings on clients. */
+	UArticyVariableReplicator* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FArticyReplicatedString, FArticyReplicatedStrings>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FArticyReplicatedStrings> : public TStructOpsTypeTraitsBase2<FArticyReplicatedStrings>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/**
+ * Replicates the global variables from the server to all clients.
+ *
+ * Add it to a replicated actor that exists on every client, like the game state.
+ * On the server, the component listens to the change notifications of the variables and only sends
+ * the variables that changed since the last net update, so the bandwidth depends on the number of changes
+ * rather than the number of variables. A joining client receives every variable that differs from the asset.
+ * Changes made inside shadowed operations (branch exploration) are not notified and thus never sent.
+ * Clients should not write the variables themselves, their changes are overwritten by the next change on the server.
+ */
+UCLASS(ClassGroup = (Articy), meta = (BlueprintSpawnableComponent))
+class ARTICYRUNTIME_API UArticyVariableReplicator : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Default constructor. Initializes the component as replicated and without ticking. */
+	UArticyVariableReplicator();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * The global variables to replicate, the same as on the flow players using them.
+	 * Keep as nullptr to replicate the default shared global variables.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Setup")
+	UArticyAlternativeGlobalVariables* OverrideGV = nullptr;
+
+	/** Applies a received variable on a client. */
+	void OnVariableReceived(const FArticyReplicatedVariable& Item);
+
+	/** Stores a received string on a client, and applies the variables that were waiting for it. */
+	void OnStringReceived(const FArticyReplicatedString& Item);
+
+private:
+
+	UPROPERTY(Replicated)
+	FArticyReplicatedStrings Strings;
+
+	/** Replicated after Strings, so the strings of a net update are usually known when its variables arrive. */
+	UPROPERTY(Replicated)
+	FArticyReplicatedVariables Variables;
+
+	/** The replicated global variables, resolved on first use. */
+	UPROPERTY(Transient)
+	UArticyGlobalVariables* GlobalVariables = nullptr;
+
+	/** All variables by their slot, see UArticyGlobalVariables::GetAllVariables. */
+	UPROPERTY(Transient)
+	TArray<UArticyVariable*> Slots;
+
+	/** Server: the slot of each variable. */
+	TMap<const UArticyVariable*, int32> SlotByVariable;
+
+	/** Server: the index of the item in Variables of each slot that was sent. */
+	TMap<int32, int32> ItemBySlot;
+
+	/** Server: the index of each string in the string table. */
+	TMap<FString, int32> StringIndices;
+
+	/** Client: the received strings by their index. */
+	TMap<int32, FString> ReceivedStrings;
+
+	/** Client: string variables by slot whose string was not received yet, with the index of the string. */
+	TMap<int32, int32> PendingStrings;
+
+	/** Resolves GlobalVariables and Slots, returns false if there are no global variables. */
+	bool ResolveVariables();
+
+	/** Server: sends the current value of a slot if it is not the one that was last sent. */
+	void UpdateSlot(int32 Slot);
+
+	UFUNCTION()
+	void HandleVariableChanged(UArticyVariable* Variable);
+};
@@ -22,9 +22,15 @@ class IArticyFlowObject : public IArticyReflectable
 public:
 	virtual EArticyPausableType GetType() = 0;
 
-	/** Gather all branches that start at this node. */
-	virtual void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) = 0;
+	/** Gather all branches that start at this node, continuing the exploration Context was made for. */
+	virtual void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) = 0;
 
 	/** Executes any script fragments found on this node. */
 	virtual void Execute(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) { }
+
+	/**
+	 * Whether exploring this object may change the state (variables, seen counters or object properties).
+	 * Objects without side-effects are explored without a shadow state of their own.
+	 */
+	virtual bool HasSideEffects() const { return true; }
 };
@@ -8,6 +8,28 @@
 #include "ArticyFlowObject.h"
 #include "ArticyInputPinsProvider.generated.h"
 
+/**
+ * @brief The input pins submerging into an object explores, with whether the submerge must be shadowed.
+ *
+ * Only depends on the pins and their connections, so objects that keep their pins compute it once, see
+ * IArticyInputPinsProvider::GetSubmergeTargets.
+ */
+struct ARTICYRUNTIME_API FArticySubmergeTargets
+{
+	/** The input pins with connections, in the order of InputPins. */
+	TArray<UArticyInputPin*, TInlineAllocator<2>> Pins;
+
+	/** Set if there is more than one input pin or the single pin has more than one connection. */
+	bool bShadowed = false;
+
+	/**
+	 * @brief Collects the pins to submerge into.
+	 *
+	 * @param InputPins The input pins of the object, nothing is collected if null.
+	 */
+	void Build(const TArray<UArticyInputPin*>* InputPins);
+};
+
 /**
  * @class UArticyInputPinsProvider
  * @brief Interface for objects with input pins.
@@ -40,13 +62,21 @@ public:
 	 * when starting an exploration at a flow node.
 	 *
 	 * @param Player A pointer to the ArticyFlowPlayer instance managing the exploration.
+	 * @param Context The database, global variables, scripts and methods provider of the exploration.
 	 * @param OutBranches An array to store the resulting branches from the exploration.
 	 * @param Depth The current depth of exploration.
 	 * @param bForceShadowed A boolean flag indicating whether to force shadowed exploration.
 	 *
 	 * @return Returns true if successful in submerging into InputPins; otherwise, false.
 	 */
-	bool TrySubmerge(class UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth, const bool bForceShadowed);
+	bool TrySubmerge(class UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth, const bool bForceShadowed);
+
+	/**
+	 * @brief Retrieves the input pins TrySubmerge explores, if the object caches them.
+	 *
+	 * @return The cached targets, or nullptr to have TrySubmerge collect them on every call.
+	 */
+	virtual const FArticySubmergeTargets* GetSubmergeTargets() const { return nullptr; }
 
 	/**
 	 * @brief Retrieves a pointer to the InputPins array.
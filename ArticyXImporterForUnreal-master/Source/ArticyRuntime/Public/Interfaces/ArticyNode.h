@@ -43,8 +43,35 @@ public:
 	 * ArticyFlowPlayer to explore the connected branches.
 	 *
 	 * @param Player A pointer to the ArticyFlowPlayer managing the exploration.
+	 * @param Context The database, global variables, scripts and methods provider of the exploration.
 	 * @param OutBranches An array to store the resulting branches from the exploration.
 	 * @param Depth The current depth of exploration.
 	 */
-	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+	void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+
+	/**
+	 * @brief Whether exploring the node may change any state.
+	 *
+	 * Plain nodes only continue on their pins, which have their own scripts. Nodes that run
+	 * scripts of their own override this.
+	 *
+	 * @return False for plain nodes.
+	 */
+	bool HasSideEffects() const override { return false; }
+
+	/**
+	 * @brief Retrieves the input pins submerging into the node explores.
+	 *
+	 * Collected the first time the node is entered and again only after objects were loaded, unloaded
+	 * or cloned, so entering nested containers doesn't look the pins up by reflection on every level.
+	 *
+	 * @return The cached targets.
+	 */
+	const FArticySubmergeTargets* GetSubmergeTargets() const override;
+
+private:
+	mutable FArticySubmergeTargets SubmergeTargets;
+
+	/** Database generation SubmergeTargets were collected in, see UArticyDatabase::GetGeneration, MAX_uint32 before. */
+	mutable uint32 SubmergeGeneration = MAX_uint32;
 };
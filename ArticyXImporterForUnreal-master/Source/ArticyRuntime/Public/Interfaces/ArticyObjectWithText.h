@@ -48,6 +48,33 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "ArticyObjectWithText")
 	virtual USoundWave* GetVOAsset(UObject* WorldContext)
+	{
+		const FArticyId AssetId = GetVOAssetId(WorldContext);
+		if (AssetId.IsNull())
+		{
+			return nullptr;
+		}
+
+		const UArticyDatabase* Database = UArticyDatabase::Get(WorldContext);
+		if (!Database)
+		{
+			return nullptr;
+		}
+		const UArticyObject* AssetObject = Database->GetObject(AssetId);
+		if (!AssetObject)
+		{
+			return nullptr;
+		}
+		return (Cast<UArticyAsset>(AssetObject))->LoadAsSoundWave();
+	}
+
+	/**
+	 * Resolves the ID of the voice-over asset of the text without loading it.
+	 *
+	 * @param WorldContext The context used to resolve the string table entry.
+	 * @return The ID of the voice-over asset, or an invalid ID if the text has none.
+	 */
+	virtual FArticyId GetVOAssetId(UObject* WorldContext)
 	{
 		static const auto& PropName = FName("Text");
 		FText& Key = GetProperty<FText>(PropName);
@@ -65,7 +92,7 @@ public:
 		FStringTableConstPtr TablePtr = FStringTableRegistry::Get().FindStringTable(FName(TableName.GetValue()));
 		if (!TablePtr.IsValid())
 		{
-			return nullptr;
+			return AssetId;
 		}
 
 		// Find the entry
@@ -73,7 +100,7 @@ public:
 		FStringTableEntryConstPtr EntryPtr = Table->FindEntry(FTextKey(Key.ToString() + ".VOAsset"));
 		if (!EntryPtr.IsValid())
 		{
-			return nullptr;
+			return AssetId;
 		}
 
 		const FStringTableEntry* TableEntry = EntryPtr.Get();
@@ -88,18 +115,7 @@ public:
 			const auto& AssetString = FText::FromString(Key.ToString() + ".VOAsset");
 			AssetId = FArticyId{ ResolveText(WorldContext, &AssetString).ToString() };
 		}
-
-		const UArticyDatabase* Database = UArticyDatabase::Get(WorldContext);
-		if (!Database)
-		{
-			return nullptr;
-		}
-		const UArticyObject* AssetObject = Database->GetObject(AssetId);
-		if (!AssetObject)
-		{
-			return nullptr;
-		}
-		return (Cast<UArticyAsset>(AssetObject))->LoadAsSoundWave();
+		return AssetId;
 	}
 
 	virtual FText ResolveText(UObject* Outer, const FText* SourceText)
@@ -38,10 +38,11 @@ public:
 	 * to explore the connected branches. If there are no output pins, it adds a dead-end branch.
 	 *
 	 * @param Player A pointer to the ArticyFlowPlayer managing the exploration.
+	 * @param Context The database, global variables, scripts and methods provider of the exploration.
 	 * @param OutBranches An array to store the resulting branches from the exploration.
 	 * @param Depth The current depth of exploration.
 	 */
-	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
+	void Explore(UArticyFlowPlayer* Player, const FArticyExploreContext& Context, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
 
 	/**
 	 * @brief Retrieves the output pins of the provider.
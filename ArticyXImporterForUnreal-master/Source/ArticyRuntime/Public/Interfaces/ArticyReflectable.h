@@ -8,6 +8,7 @@
 #include "Runtime/CoreUObject/Public/UObject/Interface.h"
 #include "Runtime/Launch/Resources/Version.h"
 #include "ArticyChangedProperty.h"
+#include "ArticyObjectNotificationManager.h"
 #include "ArticyReflectable.generated.h"
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FReportChangedDelegate, FArticyChangedProperty&);
@@ -46,7 +47,7 @@ public:
 	TValue* GetPropPtr(FName Property, int32 ArrayIndex = 0) const
 	{
 		//look up the (hopefully already cached) property pointers
-		auto propPointers = GetPropertyPointers();
+		const auto& propPointers = GetPropertyPointers();
 		auto prop = propPointers.Find(Property);
 		if(prop)
 			return (*prop)->ContainerPtrToValuePtr<TValue>(_getUObject(), ArrayIndex);
@@ -58,7 +59,7 @@ public:
 	FProperty* GetProperty(FName Property) const
 	{
 		//look up the (hopefully already cached) property pointers
-		auto propPointers = GetPropertyPointers();
+		const auto& propPointers = GetPropertyPointers();
 		auto prop = propPointers.Find(Property);
 		if(prop)
 			return *prop;
@@ -110,13 +111,11 @@ TValue IArticyReflectable::SetProp(FName Property, TValue Value, int32 ArrayInde
 	TValue* valPtr = GetPropPtr<TValue>(Property, ArrayIndex);
 	if(valPtr)
 	{
-		FArticyChangedProperty ChangedProperty;
-		ChangedProperty.Property = Property;
-		ChangedProperty.SetObjectReference(this);
-
 		(*valPtr) = Value;
 
-		ReportChanged.Broadcast(ChangedProperty);
+		//only reported if anybody may listen, once per frame
+		if(ReportChanged.IsBound() || UArticyObjectNotificationManager::HasListeners())
+			UArticyObjectNotificationManager::ReportChange(this, Property);
 		return (*valPtr);
 	}
 
@@ -19,6 +19,8 @@ class UShadowStateManager : public UInterface
  * states. It provides PushState and PopState methods, which push/pop on an array
  * of FOnPopState delegates, where interested objects can register themselves to
  * know when a state they were cloned in is destroyed.
+ * Writes that are shadowed often register a plain undo record with RegisterUndo instead,
+ * which needs neither a delegate nor a lambda allocation.
  */
 class IShadowStateManager
 {
@@ -33,8 +35,17 @@ public:
 	FDelegateHandle RegisterOnPopState(LambdaType Lambda);
 	void UnregisterOnPopState(FDelegateHandle Delegate);
 
+	/** Undoes the changes of Target for the state at ShadowLevel that is popped */
+	typedef void (*FUndoFunction)(void* Target, uint32 ShadowLevel);
+
+	/** Registers an undo for the current shadow state, PopState calls them in reverse order of registration */
+	void RegisterUndo(void* Target, FUndoFunction Undo);
+
 	uint32 GetShadowLevel() const { return ShadowLevel; }
 
+	/** Number of undos registered for the pushed states, one per value saved by a shadowed write. */
+	int32 GetNumUndos() const { return UndoStack.Num(); }
+
 private:
 
 	/** The current shadow level of this GV instance. */
@@ -43,6 +54,16 @@ private:
 	/** A stack of OnPopState delegates. The last one is the one for the current shadow level. */
 	TArray<FOnPopState> OnPopStateDelegates;
 
+	struct FUndoRecord
+	{
+		void* Target;
+		FUndoFunction Undo;
+		uint32 ShadowLevel;
+	};
+
+	/** Undos of all pushed states, the latest last. Its allocation is kept between shadow operations. */
+	TArray<FUndoRecord> UndoStack;
+
 	friend class UArticyFlowPlayer;
 
 	void PushState(uint32 NewShadowLevel);
@@ -7,11 +7,23 @@
 #include "DialogueNode.h"
 #include "DialoguePin.h"
 #include "DialogueCharacter.h"
+#include "DialogueFlowGraph.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueScriptCompiler.h"
+#include "DialogueScripts.h"
+#include "DialogueNativeScriptGenerator.h"
 #include "DialogueEditorModule.h"
+#include "DialogueImportStats.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "UObject/SavePackage.h"
 #include "Misc/PackageName.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
 #include "FileHelpers.h"
+#include "Async/ParallelFor.h"
+#include "UObject/GarbageCollection.h"
+#include "UObject/ObjectSaveContext.h"
+#include "UObject/UObjectHash.h"
 
 FDialogueAssetGenerator::FDialogueAssetGenerator()
 {
@@ -28,6 +40,19 @@ bool FDialogueAssetGenerator::GenerateAssets(UDialogueImportData* ImportData)
 	GeneratedAssetsBasePath = ImportData->Settings.GeneratedAssetsFolder;
 	ObjectsById.Empty();
 	GeneratedPackages.Empty();
+	Saves.Reset();
+	GeneratedGlobalVariables = nullptr;
+	bGenerateNativeScripts = ImportData->Settings.bGenerateNativeScripts;
+	NativeScripts.Reset();
+	NativeIndexByHash.Reset();
+	TextPool.Reset();
+
+	// Generate global variables before any script is compiled against them
+	if (!GenerateGlobalVariables(ImportData))
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to generate dialogue global variables"));
+		return false;
+	}
 
 	// Generate characters first
 	for (const FDialogueCharacterDef& CharDef : ImportData->Characters)
@@ -39,28 +64,185 @@ bool FDialogueAssetGenerator::GenerateAssets(UDialogueImportData* ImportData)
 		}
 	}
 
-	// Generate packages and their objects
-	for (const FDialoguePackageDef& PackageDef : ImportData->Packages)
+	// Scripts are bound to variable slots, a different layout invalidates all of them
+	VariablesHash = 0;
+	for (const FDialogueVariableNamespaceDef& NamespaceDef : ImportData->GlobalVariables)
 	{
-		UDialoguePackage* Package = GeneratePackage(PackageDef, ImportData);
-		if (Package)
+		VariablesHash = FCrc::StrCrc32(*NamespaceDef.Name, VariablesHash);
+		for (const FDialogueVariableDef& VariableDef : NamespaceDef.Variables)
 		{
-			GeneratedPackages.Add(Package);
+			VariablesHash = FCrc::StrCrc32(*VariableDef.Name, VariablesHash);
+			VariablesHash = FCrc::StrCrc32(*VariableDef.Type, VariablesHash);
+		}
+	}
 
-			// Process connections for this package
-			ProcessConnections(PackageDef.Connections, Package);
+	// A package is connected once the packages its connections lead into are generated, then saved while the game thread goes on
+	const int32 NumPackages = ImportData->Packages.Num();
+	TMap<FString, int32> PackageByObject;
+	for (int32 PackageIndex = 0; PackageIndex < NumPackages; ++PackageIndex)
+	{
+		for (const FDialogueObjectDef& ObjectDef : ImportData->Packages[PackageIndex].Objects)
+		{
+			PackageByObject.Add(ObjectDef.Id, PackageIndex);
 		}
 	}
 
-	// Generate the database
-	if (!GenerateDatabase(ImportData))
+	TArray<TArray<int32>> ConnectablePackages;
+	ConnectablePackages.SetNum(NumPackages);
+	for (int32 PackageIndex = 0; PackageIndex < NumPackages; ++PackageIndex)
+	{
+		int32 LastTarget = PackageIndex;
+		for (const FDialogueConnectionDef& ConnDef : ImportData->Packages[PackageIndex].Connections)
+		{
+			if (const int32* TargetPackage = PackageByObject.Find(ConnDef.TargetId))
+			{
+				LastTarget = FMath::Max(LastTarget, *TargetPackage);
+			}
+		}
+		ConnectablePackages[LastTarget].Add(PackageIndex);
+	}
+	PackageByObject.Empty();
+
+	TArray<FDialoguePreparedPackage> PreparedPackages;
+	PreparedPackages.SetNum(NumPackages);
+	TArray<UDialoguePackage*> Packages;
+	Packages.SetNumZeroed(NumPackages);
+	TArray<TSet<FString>> RegeneratedObjects;
+	RegeneratedObjects.SetNum(NumPackages);
+	TArray<bool> ModifiedPackages;
+	ModifiedPackages.SetNumZeroed(NumPackages);
+
+	TMap<FString, uint32> ObjectHashes;
+	TMap<FString, uint32> ConnectionHashes;
+	int32 NumPrepared = 0;
+	int32 NumScripts = 0;
+	int32 NumSaved = 0;
+	for (int32 PackageIndex = 0; PackageIndex < NumPackages; ++PackageIndex)
+	{
+		const FDialoguePackageDef& PackageDef = ImportData->Packages[PackageIndex];
+		FDialoguePreparedPackage& Prepared = PreparedPackages[PackageIndex];
+		{
+			FDialogueImportStageScope ObjectsScope(Stats, TEXT("GenerateObjects"));
+
+			// Parse and compile the changed objects of the next packages while this one is generated
+			for (; NumPrepared < FMath::Min(PackageIndex + PipelineDepth, NumPackages); ++NumPrepared)
+			{
+				StartPreparePackage(ImportData, ImportData->Packages[NumPrepared], PreparedPackages[NumPrepared], ObjectHashes);
+			}
+
+			Prepared.Task.Wait();
+			for (const FDialoguePreparedObject& PreparedObject : Prepared.Objects)
+			{
+				NumScripts += !PreparedObject.Existing && !PreparedObject.Script.Expression.IsEmpty() ? 1 : 0;
+			}
+
+			bool bModified = false;
+			Packages[PackageIndex] = GeneratePackage(PackageDef, Prepared.Objects, Prepared.Existing, RegeneratedObjects[PackageIndex], bModified);
+			ModifiedPackages[PackageIndex] = bModified || Packages[PackageIndex] != Prepared.Existing;
+			if (Packages[PackageIndex])
+			{
+				GeneratedPackages.Add(Packages[PackageIndex]);
+			}
+
+			// Memory stays bounded by the packages in flight, the definitions are kept by the import data
+			Prepared.Objects.Empty();
+		}
+
+		for (const int32 ConnectableIndex : ConnectablePackages[PackageIndex])
+		{
+			UDialoguePackage* Package = Packages[ConnectableIndex];
+			if (!Package)
+			{
+				continue;
+			}
+
+			const FDialoguePackageDef& ConnectableDef = ImportData->Packages[ConnectableIndex];
+			{
+				FDialogueImportStageScope ConnectionsScope(Stats, TEXT("Connections"));
+
+				uint32 ConnectionsHash = 0;
+				for (const FDialogueConnectionDef& ConnDef : ConnectableDef.Connections)
+				{
+					ConnectionsHash = FCrc::StrCrc32(*ConnDef.SourceId, ConnectionsHash);
+					ConnectionsHash = FCrc::MemCrc32(&ConnDef.SourcePin, sizeof(ConnDef.SourcePin), ConnectionsHash);
+					ConnectionsHash = FCrc::StrCrc32(*ConnDef.TargetId, ConnectionsHash);
+					ConnectionsHash = FCrc::MemCrc32(&ConnDef.TargetPin, sizeof(ConnDef.TargetPin), ConnectionsHash);
+				}
+				ConnectionHashes.Add(ConnectableDef.Name, ConnectionsHash);
+
+				// Kept objects keep their connections unless the package's connections changed
+				const uint32* PreviousHash = ImportData->GeneratedConnectionHashes.Find(ConnectableDef.Name);
+				if (Package != PreparedPackages[ConnectableIndex].Existing || !PreviousHash || *PreviousHash != ConnectionsHash)
+				{
+					for (UDialogueObject* Object : Package->Objects)
+					{
+						if (UDialogueNode* Node = Cast<UDialogueNode>(Object))
+						{
+							for (UDialogueOutputPin* OutputPin : Node->OutputPins)
+							{
+								if (OutputPin)
+								{
+									OutputPin->Edges.Reset();
+								}
+							}
+						}
+					}
+					ProcessConnections(ConnectableDef.Connections, Package);
+					ModifiedPackages[ConnectableIndex] = true;
+				}
+				else if (RegeneratedObjects[ConnectableIndex].Num() > 0)
+				{
+					ProcessConnections(ConnectableDef.Connections, Package, &RegeneratedObjects[ConnectableIndex]);
+				}
+
+				// Regenerated targets replace the pins kept connections and jumps point at
+				ModifiedPackages[ConnectableIndex] |= Package->ResolveTargetPins();
+			}
+			RegeneratedObjects[ConnectableIndex].Empty();
+
+			// Nothing writes to a connected package anymore, it is saved while the next ones are generated
+			if (ModifiedPackages[ConnectableIndex])
+			{
+				SaveAsset(Package);
+				++NumSaved;
+			}
+		}
+	}
+	PreparedPackages.Empty();
+
+	if (Stats)
+	{
+		Stats->AddCount(FDialogueImportStats::ECounter::ScriptsCompiled, NumScripts);
+	}
+
+	ImportData->GeneratedObjectHashes = MoveTemp(ObjectHashes);
+	ImportData->GeneratedConnectionHashes = MoveTemp(ConnectionHashes);
+	ImportData->MarkPackageDirty();
+
+	ReportFlowCycles();
+
+	// Scripts keep running on the VM if the code could not be written
+	if (bGenerateNativeScripts && !GenerateNativeScripts(ImportData))
+	{
+		UE_LOG(LogDialogueEditor, Warning, TEXT("Failed to generate native dialogue scripts"));
+	}
+
+	// Generate the database, then wait for the saves still running
+	const bool bDatabaseGenerated = GenerateDatabase(ImportData);
+	const bool bSaved = FinishSaves();
+	if (!bDatabaseGenerated)
 	{
 		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to generate dialogue database"));
 		return false;
 	}
+	if (!bSaved)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to save generated dialogue assets"));
+		return false;
+	}
 
-	UE_LOG(LogDialogueEditor, Log, TEXT("Generated %d packages with %d objects"),
-		GeneratedPackages.Num(), ObjectsById.Num());
+	UE_LOG(LogDialogueEditor, Log, TEXT("Generated %d packages with %d objects, %d packages changed"),
+		GeneratedPackages.Num(), ObjectsById.Num(), NumSaved);
 
 	return true;
 }
@@ -82,119 +264,385 @@ bool FDialogueAssetGenerator::GenerateDatabase(UDialogueImportData* ImportData)
 		return false;
 	}
 
-	// Add packages to database
-	// Note: The actual implementation would set up the ImportedPackages map
-	
-	return SaveAsset(GeneratedDatabase);
+	for (UDialoguePackage* DialoguePackage : GeneratedPackages)
+	{
+		if (DialoguePackage)
+		{
+			GeneratedDatabase->ImportedPackages.Add(DialoguePackage->Name, TSoftObjectPtr<UDialoguePackage>(DialoguePackage));
+			if (DialoguePackage->bIsDefaultPackage)
+			{
+				GeneratedDatabase->DefaultPackageNames.Add(DialoguePackage->Name);
+			}
+		}
+	}
+
+	// Connections and jumps may lead into other packages, the database streams those in ahead of the flow
+	TMap<FDialogueId, TArray<const UDialoguePackage*, TInlineAllocator<1>>> PackagesById;
+	for (const UDialoguePackage* DialoguePackage : GeneratedPackages)
+	{
+		for (const UDialogueObject* Object : DialoguePackage->Objects)
+		{
+			if (Object)
+			{
+				PackagesById.FindOrAdd(Object->Id).AddUnique(DialoguePackage);
+			}
+		}
+	}
+
+	for (const UDialoguePackage* DialoguePackage : GeneratedPackages)
+	{
+		TSet<FString> Referenced;
+		const auto AddTarget = [&](const FDialogueId& TargetId)
+		{
+			const TArray<const UDialoguePackage*, TInlineAllocator<1>>* Targets = PackagesById.Find(TargetId);
+			if (Targets && !Targets->Contains(DialoguePackage))
+			{
+				Referenced.Add((*Targets)[0]->Name);
+			}
+		};
+
+		for (const UDialogueObject* Object : DialoguePackage->Objects)
+		{
+			if (const UDialogueJump* Jump = Cast<UDialogueJump>(Object))
+			{
+				AddTarget(Jump->TargetNodeId);
+			}
+
+			const UDialogueNode* Node = Cast<UDialogueNode>(Object);
+			if (!Node)
+			{
+				continue;
+			}
+
+			for (const UDialogueOutputPin* OutputPin : Node->OutputPins)
+			{
+				if (!OutputPin)
+				{
+					continue;
+				}
+
+				for (const FDialogueConnection& Connection : OutputPin->Edges)
+				{
+					AddTarget(Connection.TargetNodeId);
+				}
+			}
+		}
+
+		if (Referenced.Num() > 0)
+		{
+			TArray<FString>& Packages = GeneratedDatabase->PackageReferences.Add(DialoguePackage->Name).Packages;
+			Packages = Referenced.Array();
+			Packages.Sort();
+		}
+	}
+
+	// Characters are not part of any package, the database keeps them loaded
+	for (const TPair<FString, UDialogueObject*>& Pair : ObjectsById)
+	{
+		if (UDialogueCharacter* Character = Cast<UDialogueCharacter>(Pair.Value))
+		{
+			GeneratedDatabase->Characters.Add(Character);
+		}
+	}
+
+	GeneratedDatabase->DefaultGlobalVariables = GeneratedGlobalVariables;
+
+	SaveAsset(GeneratedDatabase);
+	return true;
 }
 
-UDialoguePackage* FDialogueAssetGenerator::GeneratePackage(const FDialoguePackageDef& PackageDef, UDialogueImportData* ImportData)
+bool FDialogueAssetGenerator::GenerateGlobalVariables(UDialogueImportData* ImportData)
 {
-	FString AssetPath = GetAssetPath(PackageDef.Name + TEXT("Package"), TEXT("Packages"));
+	FString AssetPath = GetAssetPath(ImportData->Project.TechnicalName + TEXT("GlobalVariables"));
 	UPackage* Package = CreateAssetPackage(AssetPath);
 	if (!Package)
 	{
-		return nullptr;
+		return false;
 	}
 
 	FString AssetName = FPackageName::GetShortName(AssetPath);
-	UDialoguePackage* DialoguePackage = NewObject<UDialoguePackage>(Package, *AssetName, RF_Public | RF_Standalone);
+	GeneratedGlobalVariables = NewObject<UDialogueGlobalVariables>(Package, *AssetName, RF_Public | RF_Standalone);
 
-	if (!DialoguePackage)
+	if (!GeneratedGlobalVariables)
 	{
-		return nullptr;
+		return false;
 	}
 
-	DialoguePackage->Name = PackageDef.Name;
-	DialoguePackage->bIsDefaultPackage = PackageDef.bIsDefaultPackage;
-
-	// Generate objects in this package
-	for (const FDialogueObjectDef& ObjectDef : PackageDef.Objects)
+	for (const FDialogueVariableNamespaceDef& NamespaceDef : ImportData->GlobalVariables)
 	{
-		UDialogueObject* Object = GenerateObject(ObjectDef, DialoguePackage);
-		if (Object)
+		for (const FDialogueVariableDef& VariableDef : NamespaceDef.Variables)
 		{
-			DialoguePackage->Objects.Add(Object);
-			ObjectsById.Add(ObjectDef.Id, Object);
+			EDialogueVariableType Type;
+			if (VariableDef.Type.Equals(TEXT("boolean")) || VariableDef.Type.Equals(TEXT("bool")))
+			{
+				Type = EDialogueVariableType::Boolean;
+			}
+			else if (VariableDef.Type.Equals(TEXT("integer")) || VariableDef.Type.Equals(TEXT("int")) || VariableDef.Type.Equals(TEXT("number")))
+			{
+				Type = EDialogueVariableType::Integer;
+			}
+			else if (VariableDef.Type.Equals(TEXT("string")))
+			{
+				Type = EDialogueVariableType::String;
+			}
+			else
+			{
+				UE_LOG(LogDialogueEditor, Warning, TEXT("Variable %s.%s has unknown type '%s'"),
+					*NamespaceDef.Name, *VariableDef.Name, *VariableDef.Type);
+				continue;
+			}
+
+			GeneratedGlobalVariables->AddVariable(NamespaceDef.Name, VariableDef.Name, Type, VariableDef.DefaultValue);
 		}
 	}
 
-	SaveAsset(DialoguePackage);
-	return DialoguePackage;
+	SaveAsset(GeneratedGlobalVariables);
+	return true;
 }
 
-UDialogueObject* FDialogueAssetGenerator::GenerateObject(const FDialogueObjectDef& ObjectDef, UDialoguePackage* Package)
+UDialoguePackage* FDialogueAssetGenerator::GeneratePackage(const FDialoguePackageDef& PackageDef, TArrayView<FDialoguePreparedObject> PreparedObjects,
+	UDialoguePackage* ExistingPackage, TSet<FString>& OutRegenerated, bool& bOutModified)
 {
-	if (!Package)
+	UDialoguePackage* DialoguePackage = ExistingPackage;
+	if (!DialoguePackage)
 	{
-		return nullptr;
+		FString AssetPath = GetAssetPath(PackageDef.Name + TEXT("Package"), TEXT("Packages"));
+		UPackage* Package = CreateAssetPackage(AssetPath);
+		if (!Package)
+		{
+			return nullptr;
+		}
+
+		FString AssetName = FPackageName::GetShortName(AssetPath);
+		DialoguePackage = NewObject<UDialoguePackage>(Package, *AssetName, RF_Public | RF_Standalone);
+
+		if (!DialoguePackage)
+		{
+			return nullptr;
+		}
+		bOutModified = true;
 	}
 
-	UDialogueObject* Object = nullptr;
+	if (DialoguePackage->Name != PackageDef.Name || DialoguePackage->bIsDefaultPackage != PackageDef.bIsDefaultPackage)
+	{
+		DialoguePackage->Name = PackageDef.Name;
+		DialoguePackage->bIsDefaultPackage = PackageDef.bIsDefaultPackage;
+		bOutModified = true;
+	}
 
-	// Create appropriate node type based on Type string
-	if (ObjectDef.Type == TEXT("Dialogue"))
+	// Objects of the last import that are not reused below are discarded
+	TSet<UDialogueObject*> Previous(DialoguePackage->Objects);
+	TArray<UDialogueObject*> Objects;
+	Objects.Reserve(PreparedObjects.Num());
+
+	// Generate objects in this package
+	for (FDialoguePreparedObject& Prepared : PreparedObjects)
 	{
-		UDialogueDialogue* Dialogue = NewObject<UDialogueDialogue>(Package);
-		
-		// Parse properties from JSON
-		if (ObjectDef.Properties.IsValid())
+		UDialogueObject* Object = Prepared.Existing;
+		if (Object)
 		{
-			const TSharedPtr<FJsonObject>& Props = ObjectDef.Properties;
-			if (const TSharedPtr<FJsonObject>* Data = nullptr; Props->TryGetObjectField(TEXT("data"), Data))
+			Previous.Remove(Object);
+
+			// Native indices follow object order, so a kept script may still move
+			UDialogueCondition* Condition = Cast<UDialogueCondition>(Object);
+			UDialogueInstruction* Instruction = Cast<UDialogueInstruction>(Object);
+			if (FDialogueScript* Script = Condition ? &Condition->Script : Instruction ? &Instruction->Script : nullptr)
 			{
-				FString SpeakerId;
-				if ((*Data)->TryGetStringField(TEXT("speaker"), SpeakerId))
+				const int32 NativeIndex = Script->NativeIndex;
+				Script->NativeIndex = INDEX_NONE;
+				if (bGenerateNativeScripts)
 				{
-					Dialogue->SpeakerId = SpeakerId;
+					AddNativeScript(*Script);
 				}
+				bOutModified |= Script->NativeIndex != NativeIndex;
+			}
+		}
+		else
+		{
+			Object = GenerateObject(Prepared, DialoguePackage);
+			OutRegenerated.Add(Prepared.Def->Id);
+			bOutModified = true;
+		}
 
-				FString Text;
-				if ((*Data)->TryGetStringField(TEXT("text"), Text))
-				{
-					Dialogue->Text = FText::FromString(Text);
-				}
+		if (Object)
+		{
+			Objects.Add(Object);
+			ObjectsById.Add(Prepared.Def->Id, Object);
+		}
+	}
 
-				FString MenuText;
-				if ((*Data)->TryGetStringField(TEXT("menuText"), MenuText))
-				{
-					Dialogue->MenuText = FText::FromString(MenuText);
-				}
+	for (UDialogueObject* Object : Previous)
+	{
+		DiscardObject(Object);
+		bOutModified = true;
+	}
 
-				bool bAutoTransition = false;
-				if ((*Data)->TryGetBoolField(TEXT("autoTransition"), bAutoTransition))
-				{
-					Dialogue->bAutoTransition = bAutoTransition;
-				}
+	bOutModified |= Objects != DialoguePackage->Objects;
+	DialoguePackage->Objects = MoveTemp(Objects);
+	DialoguePackage->InvalidateObjectsByClass();
+
+	// Packages of one import share their texts while the editor keeps them loaded
+	TextPool.InternPackage(DialoguePackage);
+
+	return DialoguePackage;
+}
+
+void FDialogueAssetGenerator::StartPreparePackage(const UDialogueImportData* ImportData, const FDialoguePackageDef& PackageDef,
+	FDialoguePreparedPackage& OutPrepared, TMap<FString, uint32>& OutObjectHashes)
+{
+	// Find the objects of the last import that are still up to date
+	OutPrepared.Existing = ImportData->GeneratedObjectHashes.Num() > 0 ? FindExistingPackage(PackageDef) : nullptr;
+	TMap<FString, UDialogueObject*> ExistingObjects;
+	if (OutPrepared.Existing)
+	{
+		for (UDialogueObject* Object : OutPrepared.Existing->Objects)
+		{
+			if (Object)
+			{
+				ExistingObjects.Add(Object->ImportId, Object);
 			}
 		}
+	}
 
-		Object = Dialogue;
+	OutPrepared.Objects.Reserve(PackageDef.Objects.Num());
+	for (const FDialogueObjectDef& ObjectDef : PackageDef.Objects)
+	{
+		FDialoguePreparedObject& Prepared = OutPrepared.Objects.AddDefaulted_GetRef();
+		Prepared.Def = &ObjectDef;
+		Prepared.Hash = GetGenerationHash(ObjectDef);
+		OutObjectHashes.Add(ObjectDef.Id, Prepared.Hash);
+
+		const uint32* PreviousHash = ImportData->GeneratedObjectHashes.Find(ObjectDef.Id);
+		UDialogueObject** Existing = ExistingObjects.Find(ObjectDef.Id);
+		if (Existing && PreviousHash && *PreviousHash == Prepared.Hash)
+		{
+			Prepared.Existing = *Existing;
+		}
 	}
-	else if (ObjectDef.Type == TEXT("DialogueFragment"))
+
+	// Parse and compile the changed objects in parallel, this only reads the definitions and the global variables
+	TArray<FDialoguePreparedObject>* Objects = &OutPrepared.Objects;
+	OutPrepared.Task = UE::Tasks::Launch(TEXT("DialoguePreparePackage"), [this, Objects]()
 	{
-		UDialogueFragment* Fragment = NewObject<UDialogueFragment>(Package);
-		
-		// Parse properties similar to Dialogue
-		if (ObjectDef.Properties.IsValid())
+		ParallelFor(Objects->Num(), [this, Objects](int32 Index)
 		{
-			const TSharedPtr<FJsonObject>& Props = ObjectDef.Properties;
-			if (const TSharedPtr<FJsonObject>* Data = nullptr; Props->TryGetObjectField(TEXT("data"), Data))
+			FDialoguePreparedObject& Prepared = (*Objects)[Index];
+			if (!Prepared.Existing)
 			{
-				FString SpeakerId;
-				if ((*Data)->TryGetStringField(TEXT("speaker"), SpeakerId))
-				{
-					Fragment->SpeakerId = SpeakerId;
-				}
-
-				FString Text;
-				if ((*Data)->TryGetStringField(TEXT("text"), Text))
-				{
-					Fragment->Text = FText::FromString(Text);
-				}
+				PrepareObject(*Prepared.Def, Prepared);
 			}
+		});
+	});
+}
+
+UDialoguePackage* FDialogueAssetGenerator::FindExistingPackage(const FDialoguePackageDef& PackageDef) const
+{
+	const FString AssetPath = GetAssetPath(PackageDef.Name + TEXT("Package"), TEXT("Packages"));
+	const FString PackageName = FPackageName::ObjectPathToPackageName(AssetPath);
+	if (!FindPackage(nullptr, *PackageName) && !FPackageName::DoesPackageExist(PackageName))
+	{
+		return nullptr;
+	}
+
+	const FString ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(AssetPath);
+	return LoadObject<UDialoguePackage>(nullptr, *ObjectPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+}
+
+uint32 FDialogueAssetGenerator::GetGenerationHash(const FDialogueObjectDef& ObjectDef) const
+{
+	uint32 Hash = ObjectDef.ContentHash;
+	if (ObjectDef.Type == TEXT("Condition") || ObjectDef.Type == TEXT("Instruction"))
+	{
+		Hash = HashCombine(Hash, VariablesHash);
+	}
+	return Hash;
+}
+
+void FDialogueAssetGenerator::DiscardObject(UDialogueObject* Object) const
+{
+	if (Object)
+	{
+		// Out of the package so the freed name and the stale object are never saved
+		Object->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_NonTransactional);
+		Object->MarkAsGarbage();
+	}
+}
+
+void FDialogueAssetGenerator::PrepareObject(const FDialogueObjectDef& ObjectDef, FDialoguePreparedObject& OutPrepared) const
+{
+	OutPrepared.Def = &ObjectDef;
+	OutPrepared.Id = FDialogueId::FromImportId(ObjectDef.Id);
+
+	const FDialogueObjectPropertiesDef& Properties = ObjectDef.Properties;
+	if (ObjectDef.Type == TEXT("Dialogue") || ObjectDef.Type == TEXT("DialogueFragment"))
+	{
+		OutPrepared.SpeakerId = FDialogueId::FromImportId(Properties.Speaker);
+		OutPrepared.Text = FText::FromString(Properties.Text);
+
+		// Only dialogues have a menu text and auto transition
+		if (ObjectDef.Type == TEXT("Dialogue"))
+		{
+			OutPrepared.MenuText = FText::FromString(Properties.MenuText);
+			OutPrepared.bAutoTransition = Properties.bAutoTransition;
+		}
+	}
+	else if (ObjectDef.Type == TEXT("Condition") || ObjectDef.Type == TEXT("Instruction"))
+	{
+		if (!Properties.ScriptExpression.IsEmpty())
+		{
+			OutPrepared.Script.Expression = Properties.ScriptExpression;
+			OutPrepared.Script.bIsCondition = ObjectDef.Type == TEXT("Condition");
+			CompileScript(OutPrepared.Script, ObjectDef);
 		}
+	}
+	else if (ObjectDef.Type == TEXT("Jump"))
+	{
+		OutPrepared.TargetNodeId = FDialogueId::FromImportId(Properties.TargetNodeId);
+		OutPrepared.TargetPinIndex = Properties.TargetPinIndex;
+	}
+	else if (ObjectDef.Type == TEXT("FlowFragment"))
+	{
+		OutPrepared.DisplayName = Properties.DisplayName;
+	}
+
+	OutPrepared.InputPinIds.Reserve(ObjectDef.InputPinIds.Num());
+	for (const FString& PinId : ObjectDef.InputPinIds)
+	{
+		OutPrepared.InputPinIds.Add(FDialogueId::FromImportId(PinId));
+	}
+
+	OutPrepared.OutputPinIds.Reserve(ObjectDef.OutputPinIds.Num());
+	for (const FString& PinId : ObjectDef.OutputPinIds)
+	{
+		OutPrepared.OutputPinIds.Add(FDialogueId::FromImportId(PinId));
+	}
+}
+
+UDialogueObject* FDialogueAssetGenerator::GenerateObject(FDialoguePreparedObject& Prepared, UDialoguePackage* Package)
+{
+	if (!Package)
+	{
+		return nullptr;
+	}
+
+	const FDialogueObjectDef& ObjectDef = *Prepared.Def;
+	UDialogueObject* Object = nullptr;
 
+	// Create appropriate node type based on Type string
+	if (ObjectDef.Type == TEXT("Dialogue"))
+	{
+		UDialogueDialogue* Dialogue = NewObject<UDialogueDialogue>(Package);
+		Dialogue->SpeakerId = Prepared.SpeakerId;
+		Dialogue->Text = Prepared.Text;
+		Dialogue->MenuText = Prepared.MenuText;
+		Dialogue->bAutoTransition = Prepared.bAutoTransition;
+		Object = Dialogue;
+	}
+	else if (ObjectDef.Type == TEXT("DialogueFragment"))
+	{
+		UDialogueFragment* Fragment = NewObject<UDialogueFragment>(Package);
+		Fragment->SpeakerId = Prepared.SpeakerId;
+		Fragment->Text = Prepared.Text;
 		Object = Fragment;
 	}
 	else if (ObjectDef.Type == TEXT("Hub"))
@@ -205,91 +653,26 @@ UDialogueObject* FDialogueAssetGenerator::GenerateObject(const FDialogueObjectDe
 	else if (ObjectDef.Type == TEXT("Condition"))
 	{
 		UDialogueCondition* Condition = NewObject<UDialogueCondition>(Package);
-		
-		if (ObjectDef.Properties.IsValid())
-		{
-			const TSharedPtr<FJsonObject>& Props = ObjectDef.Properties;
-			if (const TSharedPtr<FJsonObject>* Data = nullptr; Props->TryGetObjectField(TEXT("data"), Data))
-			{
-				if (const TSharedPtr<FJsonObject>* Script = nullptr; (*Data)->TryGetObjectField(TEXT("script"), Script))
-				{
-					FString Expression;
-					if ((*Script)->TryGetStringField(TEXT("expression"), Expression))
-					{
-						Condition->Script.Expression = Expression;
-						Condition->Script.bIsCondition = true;
-					}
-				}
-			}
-		}
-
+		Condition->Script = MoveTemp(Prepared.Script);
 		Object = Condition;
 	}
 	else if (ObjectDef.Type == TEXT("Instruction"))
 	{
 		UDialogueInstruction* Instruction = NewObject<UDialogueInstruction>(Package);
-		
-		if (ObjectDef.Properties.IsValid())
-		{
-			const TSharedPtr<FJsonObject>& Props = ObjectDef.Properties;
-			if (const TSharedPtr<FJsonObject>* Data = nullptr; Props->TryGetObjectField(TEXT("data"), Data))
-			{
-				if (const TSharedPtr<FJsonObject>* Script = nullptr; (*Data)->TryGetObjectField(TEXT("script"), Script))
-				{
-					FString Expression;
-					if ((*Script)->TryGetStringField(TEXT("expression"), Expression))
-					{
-						Instruction->Script.Expression = Expression;
-						Instruction->Script.bIsCondition = false;
-					}
-				}
-			}
-		}
-
+		Instruction->Script = MoveTemp(Prepared.Script);
 		Object = Instruction;
 	}
 	else if (ObjectDef.Type == TEXT("Jump"))
 	{
 		UDialogueJump* Jump = NewObject<UDialogueJump>(Package);
-		
-		if (ObjectDef.Properties.IsValid())
-		{
-			const TSharedPtr<FJsonObject>& Props = ObjectDef.Properties;
-			if (const TSharedPtr<FJsonObject>* Data = nullptr; Props->TryGetObjectField(TEXT("data"), Data))
-			{
-				FString TargetId;
-				if ((*Data)->TryGetStringField(TEXT("targetNodeId"), TargetId))
-				{
-					Jump->TargetNodeId = TargetId;
-				}
-
-				int32 TargetPin = 0;
-				if ((*Data)->TryGetNumberField(TEXT("targetPinIndex"), TargetPin))
-				{
-					Jump->TargetPinIndex = TargetPin;
-				}
-			}
-		}
-
+		Jump->TargetNodeId = Prepared.TargetNodeId;
+		Jump->TargetPinIndex = Prepared.TargetPinIndex;
 		Object = Jump;
 	}
 	else if (ObjectDef.Type == TEXT("FlowFragment"))
 	{
 		UDialogueFlowFragment* FlowFragment = NewObject<UDialogueFlowFragment>(Package);
-		
-		if (ObjectDef.Properties.IsValid())
-		{
-			const TSharedPtr<FJsonObject>& Props = ObjectDef.Properties;
-			if (const TSharedPtr<FJsonObject>* Data = nullptr; Props->TryGetObjectField(TEXT("data"), Data))
-			{
-				FString DisplayName;
-				if ((*Data)->TryGetStringField(TEXT("displayName"), DisplayName))
-				{
-					FlowFragment->DisplayName = DisplayName;
-				}
-			}
-		}
-
+		FlowFragment->DisplayName = Prepared.DisplayName;
 		Object = FlowFragment;
 	}
 	else
@@ -298,9 +681,23 @@ UDialogueObject* FDialogueAssetGenerator::GenerateObject(const FDialogueObjectDe
 		Object = NewObject<UDialogueObject>(Package);
 	}
 
+	// Native indices follow object order, so they are the same as on a serial import
+	if (bGenerateNativeScripts)
+	{
+		if (UDialogueCondition* Condition = Cast<UDialogueCondition>(Object))
+		{
+			AddNativeScript(Condition->Script);
+		}
+		else if (UDialogueInstruction* Instruction = Cast<UDialogueInstruction>(Object))
+		{
+			AddNativeScript(Instruction->Script);
+		}
+	}
+
 	if (Object)
 	{
-		Object->Id = ObjectDef.Id;
+		Object->Id = Prepared.Id;
+		Object->ImportId = ObjectDef.Id;
 		Object->TechnicalName = ObjectDef.TechnicalName;
 
 		// Create pins for nodes
@@ -310,7 +707,8 @@ UDialogueObject* FDialogueAssetGenerator::GenerateObject(const FDialogueObjectDe
 			for (int32 i = 0; i < ObjectDef.InputPinIds.Num(); ++i)
 			{
 				UDialogueInputPin* Pin = NewObject<UDialogueInputPin>(Node);
-				Pin->Id = ObjectDef.InputPinIds[i];
+				Pin->Id = Prepared.InputPinIds[i];
+				Pin->ImportId = ObjectDef.InputPinIds[i];
 				Pin->OwnerId = Node->Id;
 				Pin->Index = i;
 				Node->InputPins.Add(Pin);
@@ -320,7 +718,8 @@ UDialogueObject* FDialogueAssetGenerator::GenerateObject(const FDialogueObjectDe
 			for (int32 i = 0; i < ObjectDef.OutputPinIds.Num(); ++i)
 			{
 				UDialogueOutputPin* Pin = NewObject<UDialogueOutputPin>(Node);
-				Pin->Id = ObjectDef.OutputPinIds[i];
+				Pin->Id = Prepared.OutputPinIds[i];
+				Pin->ImportId = ObjectDef.OutputPinIds[i];
 				Pin->OwnerId = Node->Id;
 				Pin->Index = i;
 				Node->OutputPins.Add(Pin);
@@ -331,6 +730,61 @@ UDialogueObject* FDialogueAssetGenerator::GenerateObject(const FDialogueObjectDe
 	return Object;
 }
 
+void FDialogueAssetGenerator::CompileScript(FDialogueScript& Script, const FDialogueObjectDef& ObjectDef) const
+{
+	FString Error;
+	if (!FDialogueScriptCompiler::Compile(Script, &Error))
+	{
+		UE_LOG(LogDialogueEditor, Warning, TEXT("Script of %s '%s' failed to compile: %s"),
+			*ObjectDef.Type, *ObjectDef.Id, *Error);
+		return;
+	}
+
+	// Resolve variable names now so the VM works with slots only
+	if (FDialogueScriptCompiler::BindVariables(Script.Program, GeneratedGlobalVariables) > 0)
+	{
+		UE_LOG(LogDialogueEditor, Warning, TEXT("Script of %s '%s' references unknown variables"),
+			*ObjectDef.Type, *ObjectDef.Id);
+	}
+}
+
+void FDialogueAssetGenerator::AddNativeScript(FDialogueScript& Script)
+{
+	if (!Script.Program.IsCompiled())
+	{
+		return;
+	}
+
+	const uint32 Hash = UDialogueScripts::HashScript(Script);
+	if (const int32* Index = NativeIndexByHash.Find(Hash))
+	{
+		if (NativeScripts[*Index].Expression.Equals(Script.Expression, ESearchCase::CaseSensitive))
+		{
+			Script.NativeIndex = *Index;
+			return;
+		}
+	}
+
+	Script.NativeIndex = NativeScripts.Add(Script);
+	NativeIndexByHash.FindOrAdd(Hash, Script.NativeIndex);
+}
+
+bool FDialogueAssetGenerator::GenerateNativeScripts(UDialogueImportData* ImportData)
+{
+	const FString ModuleName = ImportData->Settings.NativeScriptsModule.IsEmpty() ? FString(FApp::GetProjectName()) : ImportData->Settings.NativeScriptsModule;
+	const FString Directory = FPaths::Combine(FPaths::GameSourceDir(), ModuleName, TEXT("DialogueGenerated"));
+	const FString ClassName = ImportData->Project.TechnicalName + TEXT("DialogueScripts");
+
+	if (!FDialogueNativeScriptGenerator::WriteScriptsClass(ClassName, Directory, NativeScripts))
+	{
+		return false;
+	}
+
+	UE_LOG(LogDialogueEditor, Log, TEXT("Generated %d native scripts into %s, they are used once the module is compiled"),
+		NativeScripts.Num(), *Directory);
+	return true;
+}
+
 UDialogueCharacter* FDialogueAssetGenerator::GenerateCharacter(const FDialogueCharacterDef& CharacterDef)
 {
 	FString AssetPath = GetAssetPath(CharacterDef.TechnicalName, TEXT("Characters"));
@@ -348,7 +802,8 @@ UDialogueCharacter* FDialogueAssetGenerator::GenerateCharacter(const FDialogueCh
 		return nullptr;
 	}
 
-	Character->Id = CharacterDef.Id;
+	Character->Id = FDialogueId::FromImportId(CharacterDef.Id);
+	Character->ImportId = CharacterDef.Id;
 	Character->TechnicalName = CharacterDef.TechnicalName;
 	Character->DisplayName = FText::FromString(CharacterDef.DisplayName);
 
@@ -363,10 +818,15 @@ UDialogueCharacter* FDialogueAssetGenerator::GenerateCharacter(const FDialogueCh
 	return Character;
 }
 
-void FDialogueAssetGenerator::ProcessConnections(const TArray<FDialogueConnectionDef>& Connections, UDialoguePackage* Package)
+void FDialogueAssetGenerator::ProcessConnections(const TArray<FDialogueConnectionDef>& Connections, UDialoguePackage* Package, const TSet<FString>* OnlySources)
 {
 	for (const FDialogueConnectionDef& ConnDef : Connections)
 	{
+		if (OnlySources && !OnlySources->Contains(ConnDef.SourceId))
+		{
+			continue;
+		}
+
 		UDialogueObject** SourcePtr = ObjectsById.Find(ConnDef.SourceId);
 		UDialogueObject** TargetPtr = ObjectsById.Find(ConnDef.TargetId);
 
@@ -389,16 +849,48 @@ void FDialogueAssetGenerator::ProcessConnections(const TArray<FDialogueConnectio
 			UDialogueOutputPin* OutputPin = SourceNode->OutputPins[ConnDef.SourcePin];
 			if (OutputPin)
 			{
-				// Create connection
-				UDialogueConnection* Connection = NewObject<UDialogueConnection>(OutputPin);
-				Connection->TargetNodeId = ConnDef.TargetId;
-				Connection->TargetPinIndex = ConnDef.TargetPin;
-				OutputPin->Connections.Add(Connection);
+				FDialogueConnection& Connection = OutputPin->Edges.AddDefaulted_GetRef();
+				Connection.TargetNodeId = TargetNode->Id;
+				Connection.TargetPinIndex = ConnDef.TargetPin;
 			}
 		}
 	}
 }
 
+void FDialogueAssetGenerator::ReportFlowCycles() const
+{
+	TMap<FDialogueId, UDialogueObject*> Objects;
+	Objects.Reserve(ObjectsById.Num());
+	for (const TPair<FString, UDialogueObject*>& Pair : ObjectsById)
+	{
+		Objects.Add(Pair.Value->Id, Pair.Value);
+	}
+
+	FDialogueFlowGraph Graph;
+	Graph.Build(Objects);
+
+	for (const FDialogueFlowGraphCycle& Cycle : Graph.PauselessCycles)
+	{
+		FString Names;
+		for (int32 Node : Cycle.Nodes)
+		{
+			const UDialogueNode* Object = Graph.Nodes[Node].Object;
+			Names += Names.IsEmpty() ? TEXT("") : TEXT(", ");
+			Names += Object->TechnicalName.IsEmpty() ? Object->GetName() : Object->TechnicalName;
+		}
+
+		// A condition may leave the loop, only a loop without one is certain to hit the explore limit
+		if (Cycle.bHasCondition)
+		{
+			UE_LOG(LogDialogueEditor, Log, TEXT("Loop without a pause relies on a condition to be left: %s"), *Names);
+		}
+		else
+		{
+			UE_LOG(LogDialogueEditor, Warning, TEXT("Loop without a pause can never be left, exploring it stops at the explore limit: %s"), *Names);
+		}
+	}
+}
+
 FString FDialogueAssetGenerator::GetAssetPath(const FString& AssetName, const FString& SubFolder) const
 {
 	if (SubFolder.IsEmpty())
@@ -422,35 +914,116 @@ UPackage* FDialogueAssetGenerator::CreateAssetPackage(const FString& AssetPath)
 	return Package;
 }
 
-bool FDialogueAssetGenerator::SaveAsset(UObject* Asset)
+void FDialogueAssetGenerator::SaveAsset(UObject* Asset)
 {
-	if (!Asset)
+	if (!Asset || !Asset->GetOutermost())
 	{
-		return false;
+		return;
 	}
 
 	UPackage* Package = Asset->GetOutermost();
-	if (!Package)
+	for (const FDialogueRunningSave& Save : Saves)
 	{
-		return false;
+		if (Save.Asset->GetOutermost() == Package)
+		{
+			return;
+		}
 	}
-
 	Package->MarkPackageDirty();
 
-	FString PackageFilename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
-	
-	FSavePackageArgs SaveArgs;
-	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
-	
-	FSavePackageResultStruct Result = UPackage::Save(Package, Asset, *PackageFilename, SaveArgs);
-	
-	if (Result.Result == ESavePackageResult::Success)
+	FDialogueRunningSave& Save = Saves.AddDefaulted_GetRef();
+	Save.Asset = Asset;
+	Save.Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+	if (Saves.Num() == 1)
+	{
+		SaveStartTime = FPlatformTime::Seconds();
+	}
+
+	// Concurrent saves leave PreSave to the caller, it must run on the game thread
+	FObjectSaveContextData SaveContext(Package, nullptr, *Save.Filename, SAVE_Concurrent);
+	ForEachObjectWithPackage(Package, [&SaveContext](UObject* Object)
+	{
+		Object->PreSave(FObjectPreSaveContext(SaveContext));
+		return true;
+	});
+
+	// Each running save holds its serialized package in memory
+	WaitForSaves(MaxConcurrentSaves - 1);
+
+	Save.Task = UE::Tasks::Launch(TEXT("DialogueSavePackage"), [Asset, Package, Filename = Save.Filename]()
+	{
+		// Garbage must not be collected while the package is serialized
+		FGCScopeGuard GCGuard;
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.SaveFlags = SAVE_Concurrent | SAVE_NoError;
+		return UPackage::Save(Package, Asset, *Filename, SaveArgs).Result == ESavePackageResult::Success;
+	});
+}
+
+void FDialogueAssetGenerator::WaitForSaves(int32 MaxRunning)
+{
+	int32 NumRunning = 0;
+	for (const FDialogueRunningSave& Save : Saves)
+	{
+		NumRunning += Save.Task.IsValid() && !Save.Task.IsCompleted() ? 1 : 0;
+	}
+
+	for (FDialogueRunningSave& Save : Saves)
+	{
+		if (NumRunning <= MaxRunning)
+		{
+			break;
+		}
+
+		if (Save.Task.IsValid() && !Save.Task.IsCompleted())
+		{
+			Save.Task.Wait();
+			--NumRunning;
+		}
+	}
+}
+
+bool FDialogueAssetGenerator::FinishSaves()
+{
+	if (Saves.Num() == 0)
 	{
-		// Notify asset registry
-		FAssetRegistryModule::AssetCreated(Asset);
 		return true;
 	}
 
-	UE_LOG(LogDialogueEditor, Warning, TEXT("Failed to save asset: %s"), *Asset->GetName());
-	return false;
+	WaitForSaves(0);
+
+	// The saves overlap the generation, the stage spans from the first save to the last
+	if (Stats)
+	{
+		Stats->Add(TEXT("Save"), FPlatformTime::Seconds() - SaveStartTime);
+	}
+
+	bool bAllSaved = true;
+	TArray<FString> SavedFilenames;
+	for (FDialogueRunningSave& Save : Saves)
+	{
+		if (Save.Task.GetResult())
+		{
+			Save.Asset->GetOutermost()->SetDirtyFlag(false);
+			SavedFilenames.Add(Save.Filename);
+		}
+		else
+		{
+			UE_LOG(LogDialogueEditor, Warning, TEXT("Failed to save asset: %s"), *Save.Asset->GetName());
+			bAllSaved = false;
+		}
+	}
+	Saves.Reset();
+
+	// One notification for all files instead of one per asset
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+	AssetRegistryModule.Get().ScanModifiedAssetFiles(SavedFilenames);
+
+	if (Stats)
+	{
+		Stats->AddCount(FDialogueImportStats::ECounter::AssetsSaved, SavedFilenames.Num());
+	}
+	return bAllSaved;
 }
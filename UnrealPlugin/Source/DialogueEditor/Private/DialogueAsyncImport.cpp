@@ -0,0 +1,173 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueAsyncImport.h"
+#include "DialogueAssetGenerator.h"
+#include "DialogueEditorModule.h"
+#include "Async/Async.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "DialogueAsyncImport"
+
+TMap<TWeakObjectPtr<UDialogueImportData>, TSharedPtr<FDialogueAsyncImport>> FDialogueAsyncImport::RunningImports;
+
+void FDialogueAsyncImport::Start(UDialogueImportData* ImportData, const FString& Filename)
+{
+	check(IsInGameThread());
+
+	if (const TSharedPtr<FDialogueAsyncImport>* Running = RunningImports.Find(ImportData))
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("Cancelling the running import of %s, it is imported again"), *(*Running)->Filename);
+		(*Running)->Cancel();
+	}
+
+	TSharedRef<FDialogueAsyncImport> Import = MakeShareable(new FDialogueAsyncImport(ImportData, Filename));
+	RunningImports.Add(ImportData, Import);
+	Import->Run();
+}
+
+bool FDialogueAsyncImport::IsRunning(const UDialogueImportData* ImportData)
+{
+	return RunningImports.Contains(ImportData);
+}
+
+void FDialogueAsyncImport::CancelAll()
+{
+	for (const TPair<TWeakObjectPtr<UDialogueImportData>, TSharedPtr<FDialogueAsyncImport>>& Running : RunningImports)
+	{
+		Running.Value->Cancel();
+	}
+}
+
+FDialogueAsyncImport::FDialogueAsyncImport(UDialogueImportData* InImportData, const FString& InFilename)
+	: ImportData(InImportData)
+	, Filename(InFilename)
+{
+	// Created on the game thread, only its plain data is touched by the worker
+	Staging = NewObject<UDialogueImportData>(GetTransientPackage());
+	Staging->AddToRoot();
+}
+
+FDialogueAsyncImport::~FDialogueAsyncImport()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+
+	if (Staging && UObjectInitialized())
+	{
+		Staging->RemoveFromRoot();
+	}
+}
+
+void FDialogueAsyncImport::Run()
+{
+	FNotificationInfo Info(FText::Format(LOCTEXT("Parsing", "Importing {0}"), FText::FromString(FPaths::GetCleanFilename(Filename))));
+	Info.bFireAndForget = false;
+	Info.ExpireDuration = 3.0f;
+	Info.ButtonDetails.Add(FNotificationButtonInfo(LOCTEXT("Cancel", "Cancel"), LOCTEXT("CancelTooltip", "Stop the import, all assets stay as they are"),
+		FSimpleDelegate::CreateSP(this, &FDialogueAsyncImport::Cancel), SNotificationItem::CS_Pending));
+	Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Notification.IsValid())
+	{
+		Notification->SetCompletionState(SNotificationItem::CS_Pending);
+	}
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FDialogueAsyncImport::Tick), 0.1f);
+
+	// The import keeps itself alive until it finished on the game thread
+	TSharedRef<FDialogueAsyncImport> This = AsShared();
+	Async(EAsyncExecution::ThreadPool, [This]()
+	{
+		const bool bParsed = This->Staging->ImportFromFile(This->Filename, &This->Stats, &This->Progress);
+		AsyncTask(ENamedThreads::GameThread, [This, bParsed]()
+		{
+			This->Finish(bParsed);
+		});
+	});
+}
+
+void FDialogueAsyncImport::Cancel()
+{
+	Progress.Cancel();
+	if (Notification.IsValid())
+	{
+		Notification->SetText(FText::Format(LOCTEXT("Cancelling", "Cancelling import of {0}"), FText::FromString(FPaths::GetCleanFilename(Filename))));
+	}
+}
+
+bool FDialogueAsyncImport::Tick(float DeltaTime)
+{
+	if (Notification.IsValid() && !Progress.IsCancelRequested())
+	{
+		Notification->SetText(FText::Format(LOCTEXT("ParsingProgress", "Importing {0} ({1})"), FText::FromString(FPaths::GetCleanFilename(Filename)),
+			FText::AsPercent(Progress.GetFraction())));
+	}
+	return true;
+}
+
+void FDialogueAsyncImport::Finish(bool bParsed)
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	// Only the newest import of the data may write to it
+	TSharedPtr<FDialogueAsyncImport> Self = AsShared();
+	if (RunningImports.FindRef(ImportData) == Self)
+	{
+		RunningImports.Remove(ImportData);
+	}
+
+	UDialogueImportData* Target = ImportData.Get();
+	const bool bCancelled = Progress.IsCancelRequested();
+	bool bSucceeded = false;
+	if (bParsed && !bCancelled && Target)
+	{
+		FScopedSlowTask SlowTask(1.0f, FText::Format(LOCTEXT("Generating", "Generating dialogue assets of {0}"), FText::FromString(FPaths::GetCleanFilename(Filename))));
+		SlowTask.MakeDialogDelayed(0.5f);
+		SlowTask.EnterProgressFrame();
+
+		Target->Modify();
+		Target->TakeParsedData(*Staging);
+		Target->SourceFilePath = Filename;
+		Target->ImportTimestamp = FDateTime::Now();
+
+		FDialogueAssetGenerator Generator;
+		Generator.SetStats(&Stats);
+		bSucceeded = Generator.GenerateAssets(Target);
+		if (!bSucceeded)
+		{
+			UE_LOG(LogDialogueEditor, Warning, TEXT("Asset generation had issues for: %s"), *Filename);
+		}
+		Stats.LogSummary(Filename);
+	}
+	else if (!bCancelled)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to import dialogue from: %s"), *Filename);
+	}
+
+	Staging->RemoveFromRoot();
+	Staging = nullptr;
+
+	if (Notification.IsValid())
+	{
+		const FString CleanFilename = FPaths::GetCleanFilename(Filename);
+		if (bCancelled)
+		{
+			Notification->SetText(FText::Format(LOCTEXT("Cancelled", "Import of {0} cancelled"), FText::FromString(CleanFilename)));
+			Notification->SetCompletionState(SNotificationItem::CS_None);
+		}
+		else
+		{
+			Notification->SetText(FText::Format(bSucceeded ? LOCTEXT("Succeeded", "Imported {0}") : LOCTEXT("Failed", "Import of {0} failed, see the output log"),
+				FText::FromString(CleanFilename)));
+			Notification->SetCompletionState(bSucceeded ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+		}
+		Notification->ExpireAndFadeout();
+		Notification.Reset();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
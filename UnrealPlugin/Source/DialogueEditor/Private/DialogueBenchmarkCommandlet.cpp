@@ -0,0 +1,474 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueBenchmarkCommandlet.h"
+#include "DialogueDatabase.h"
+#include "DialoguePackage.h"
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueFlowRecording.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueScriptCompiler.h"
+#include "DialogueEditorModule.h"
+#include "Math/RandomStream.h"
+#include "HAL/MallocBase.h"
+#include <atomic>
+
+namespace
+{
+	/** Forwards to the real allocator and counts allocations while installed as GMalloc */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Allocations.fetch_add(1, std::memory_order_relaxed);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Allocations.fetch_add(1, std::memory_order_relaxed);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("DialogueBenchmark"); }
+
+		uint64 GetAllocations() const { return Allocations.load(std::memory_order_relaxed); }
+
+	private:
+		FMalloc* Inner;
+		std::atomic<uint64> Allocations{ 0 };
+	};
+
+	/** Timings and allocations of one operation */
+	struct FOperationStats
+	{
+		const TCHAR* Name;
+		TArray<double> Microseconds;
+		uint64 Allocations = 0;
+
+		explicit FOperationStats(const TCHAR* InName) : Name(InName) {}
+
+		template<typename Lambda>
+		void Measure(const FCountingMalloc& Counter, Lambda Operation)
+		{
+			const uint64 AllocationsBefore = Counter.GetAllocations();
+			const uint64 CyclesBefore = FPlatformTime::Cycles64();
+
+			Operation();
+
+			const uint64 Cycles = FPlatformTime::Cycles64() - CyclesBefore;
+			Allocations += Counter.GetAllocations() - AllocationsBefore;
+			Microseconds.Add(FPlatformTime::ToMilliseconds64(Cycles) * 1000.0);
+		}
+
+		void Report()
+		{
+			if (Microseconds.Num() == 0)
+			{
+				UE_LOG(LogDialogueEditor, Display, TEXT("%-24s no samples"), Name);
+				return;
+			}
+
+			Microseconds.Sort();
+
+			auto Percentile = [this](double P)
+			{
+				const int32 Index = FMath::Clamp(FMath::CeilToInt(P * Microseconds.Num()) - 1, 0, Microseconds.Num() - 1);
+				return Microseconds[Index];
+			};
+
+			double Total = 0.0;
+			for (double Sample : Microseconds)
+			{
+				Total += Sample;
+			}
+
+			UE_LOG(LogDialogueEditor, Display, TEXT("%-24s n=%-6d mean=%8.2fus p50=%8.2fus p90=%8.2fus p99=%8.2fus max=%8.2fus allocs/op=%.1f"),
+				Name, Microseconds.Num(), Total / Microseconds.Num(), Percentile(0.5), Percentile(0.9), Percentile(0.99),
+				Microseconds.Last(), (double)Allocations / Microseconds.Num());
+		}
+	};
+
+	enum class EBenchmarkNodeType : uint8
+	{
+		Fragment,
+		Hub,
+		Condition,
+		Instruction,
+		Jump
+	};
+
+	void CompileBenchmarkScript(FDialogueScript& Script, const FString& Expression, bool bIsCondition, const UDialogueGlobalVariables* GV)
+	{
+		Script.Expression = Expression;
+		Script.bIsCondition = bIsCondition;
+
+		FString Error;
+		if (!FDialogueScriptCompiler::Compile(Script, &Error))
+		{
+			UE_LOG(LogDialogueEditor, Warning, TEXT("Benchmark script '%s' failed to compile: %s"), *Expression, *Error);
+			return;
+		}
+		FDialogueScriptCompiler::BindVariables(Script.Program, GV);
+	}
+}
+
+UDialogueBenchmarkCommandlet::UDialogueBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UDialogueBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Cmd = *Params;
+	FParse::Value(Cmd, TEXT("Nodes="), NumNodes);
+	FParse::Value(Cmd, TEXT("Branching="), Branching);
+	FParse::Value(Cmd, TEXT("HubDensity="), HubDensity);
+	FParse::Value(Cmd, TEXT("ConditionDensity="), ConditionDensity);
+	FParse::Value(Cmd, TEXT("InstructionDensity="), InstructionDensity);
+	FParse::Value(Cmd, TEXT("JumpDensity="), JumpDensity);
+	FParse::Value(Cmd, TEXT("Flags="), NumFlags);
+	FParse::Value(Cmd, TEXT("Iterations="), Iterations);
+	FParse::Value(Cmd, TEXT("Seed="), Seed);
+	bUseFlowGraph = !FParse::Param(Cmd, TEXT("NoFlowGraph"));
+	bUseExplorationCache = FParse::Param(Cmd, TEXT("Cache"));
+	FParse::Value(Cmd, TEXT("Repeat="), Repeat);
+
+	FString ReplayPath;
+	if (FParse::Value(Cmd, TEXT("Replay="), ReplayPath))
+	{
+		return RunReplay(ReplayPath);
+	}
+
+	NumNodes = FMath::Max(NumNodes, 2);
+	Branching = FMath::Max(Branching, 1);
+	NumFlags = FMath::Max(NumFlags, 1);
+
+	UE_LOG(LogDialogueEditor, Display, TEXT("Dialogue benchmark: %d nodes, branching %d, hubs %.2f, conditions %.2f, instructions %.2f, jumps %.2f, %d iterations, seed %d, flow graph %s, cache %s"),
+		NumNodes, Branching, HubDensity, ConditionDensity, InstructionDensity, JumpDensity, Iterations, Seed,
+		bUseFlowGraph ? TEXT("on") : TEXT("off"), bUseExplorationCache ? TEXT("on") : TEXT("off"));
+
+	UDialogueObject* StartNode = nullptr;
+	UDialogueDatabase* Database = BuildSyntheticDatabase(StartNode);
+	if (!Database || !StartNode)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to build the benchmark database"));
+		return 1;
+	}
+
+	// Objects without a world resolve the persistent instance
+	const TWeakObjectPtr<UDialogueDatabase> PreviousInstance = UDialogueDatabase::PersistentInstance;
+	UDialogueDatabase::PersistentInstance = Database;
+
+	UDialogueFlowPlayer* Player = NewObject<UDialogueFlowPlayer>(GetTransientPackage());
+	Player->bUseFlowGraph = bUseFlowGraph;
+	Player->bUseExplorationCache = bUseExplorationCache;
+
+	FOperationStats SetCursorStats(TEXT("SetCursorTo"));
+	FOperationStats UpdateStats(TEXT("UpdateAvailableBranches"));
+	FOperationStats PlayStats(TEXT("Play"));
+
+	FMalloc* PreviousMalloc = GMalloc;
+	FCountingMalloc* Counter = new FCountingMalloc(PreviousMalloc);
+	GMalloc = Counter;
+
+	FRandomStream Random(Seed);
+	SetCursorStats.Measure(*Counter, [&] { Player->SetCursorTo(StartNode); });
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		UpdateStats.Measure(*Counter, [&] { Player->UpdateAvailableBranches(); });
+
+		int32 NumValid = 0;
+		for (const FDialogueBranch& Branch : Player->GetAvailableBranches())
+		{
+			NumValid += Branch.bIsValid || !Player->bIgnoreInvalidBranches ? 1 : 0;
+		}
+
+		if (NumValid == 0)
+		{
+			// Dead end, start over
+			SetCursorStats.Measure(*Counter, [&] { Player->SetCursorTo(StartNode); });
+			continue;
+		}
+
+		const int32 BranchIndex = Random.RandRange(0, NumValid - 1);
+		PlayStats.Measure(*Counter, [&] { Player->Play(BranchIndex); });
+	}
+
+	// The proxy stays alive, other threads may still be inside it
+	GMalloc = PreviousMalloc;
+
+	SetCursorStats.Report();
+	UpdateStats.Report();
+	PlayStats.Report();
+
+	UDialogueDatabase::PersistentInstance = PreviousInstance;
+	Database->Deinitialize();
+
+	return 0;
+}
+
+int32 UDialogueBenchmarkCommandlet::RunReplay(const FString& Filename) const
+{
+	FDialogueFlowRecording Recording;
+	if (!Recording.LoadFromFile(Filename))
+	{
+		return 1;
+	}
+
+	// Without a world the player resolves the persistent instance of the project's database
+	UDialogueDatabase* Database = UDialogueDatabase::Get(nullptr);
+	if (!Database)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("No dialogue database to replay %s on"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogDialogueEditor, Display, TEXT("Dialogue replay: %s, %d steps from %s, %d repeats, flow graph %s, cache %s"),
+		*Filename, Recording.Steps.Num(), *Recording.StartId.ToString(), Repeat,
+		bUseFlowGraph ? TEXT("on") : TEXT("off"), bUseExplorationCache ? TEXT("on") : TEXT("off"));
+
+	UDialogueFlowPlayer* Player = NewObject<UDialogueFlowPlayer>(GetTransientPackage());
+	Player->bUseFlowGraph = bUseFlowGraph;
+	Player->bUseExplorationCache = bUseExplorationCache;
+
+	FOperationStats StepStats(TEXT("Replay step"));
+	TArray<TArray<double>> StepSamples;
+	StepSamples.SetNum(Recording.Steps.Num());
+	int32 NumMismatches = 0;
+
+	FMalloc* PreviousMalloc = GMalloc;
+	FCountingMalloc* Counter = new FCountingMalloc(PreviousMalloc);
+	GMalloc = Counter;
+
+	FDialogueFlowReplay Replay;
+	for (int32 i = 0; i < FMath::Max(Repeat, 1); ++i)
+	{
+		// Restoring the initial state is counted in, it is small next to a session's steps
+		const uint64 AllocationsBefore = Counter->GetAllocations();
+		if (!Replay.Run(Recording, Player))
+		{
+			GMalloc = PreviousMalloc;
+			UE_LOG(LogDialogueEditor, Error, TEXT("Failed to restore the initial state of %s"), *Filename);
+			return 1;
+		}
+		StepStats.Allocations += Counter->GetAllocations() - AllocationsBefore;
+		StepStats.Microseconds.Append(Replay.StepMicroseconds);
+		NumMismatches = FMath::Max(NumMismatches, Replay.NumMismatches);
+
+		for (int32 Step = 0; Step < Replay.StepMicroseconds.Num(); ++Step)
+		{
+			StepSamples[Step].Add(Replay.StepMicroseconds[Step]);
+		}
+	}
+
+	// The proxy stays alive, other threads may still be inside it
+	GMalloc = PreviousMalloc;
+
+	static const TCHAR* const StepNames[] = { TEXT("SetCursor"), TEXT("PlayBranch"), TEXT("FinishPausedObject") };
+	for (int32 Step = 0; Step < StepSamples.Num(); ++Step)
+	{
+		TArray<double>& Samples = StepSamples[Step];
+		if (Samples.Num() == 0)
+		{
+			continue;
+		}
+
+		Samples.Sort();
+		const FDialogueFlowRecording::FStep& RecordedStep = Recording.Steps[Step];
+		UE_LOG(LogDialogueEditor, Display, TEXT("Step %4d %-18s %6d p50=%8.2fus max=%8.2fus"),
+			Step, StepNames[(int32)RecordedStep.Type], RecordedStep.Value, Samples[Samples.Num() / 2], Samples.Last());
+	}
+	StepStats.Report();
+
+	if (NumMismatches > 0)
+	{
+		UE_LOG(LogDialogueEditor, Warning, TEXT("%d steps did not fit the current flow, the recording is out of date"), NumMismatches);
+	}
+	return 0;
+}
+
+UDialogueDatabase* UDialogueBenchmarkCommandlet::BuildSyntheticDatabase(UDialogueObject*& OutStartNode) const
+{
+	FRandomStream Random(Seed);
+	UPackage* Outer = GetTransientPackage();
+
+	UDialogueGlobalVariables* GV = NewObject<UDialogueGlobalVariables>(Outer, TEXT("DialogueBenchmarkVariables"));
+	for (int32 i = 0; i < NumFlags; ++i)
+	{
+		GV->AddVariable(TEXT("Bench"), FString::Printf(TEXT("Flag%d"), i), EDialogueVariableType::Boolean, i % 2 ? TEXT("true") : TEXT("false"));
+	}
+	GV->AddVariable(TEXT("Bench"), TEXT("Counter"), EDialogueVariableType::Integer, TEXT("0"));
+
+	UDialoguePackage* Package = NewObject<UDialoguePackage>(Outer, TEXT("DialogueBenchmarkPackage"));
+	Package->Name = TEXT("Benchmark");
+	Package->bIsDefaultPackage = true;
+
+	// Node types first, so that jumps can target fragments
+	TArray<EBenchmarkNodeType> Types;
+	TArray<int32> Fragments;
+	Types.Reserve(NumNodes);
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		EBenchmarkNodeType Type = EBenchmarkNodeType::Fragment;
+		const float Roll = Random.FRand();
+		if (i > 0)
+		{
+			if (Roll < HubDensity)
+			{
+				Type = EBenchmarkNodeType::Hub;
+			}
+			else if (Roll < HubDensity + ConditionDensity)
+			{
+				Type = EBenchmarkNodeType::Condition;
+			}
+			else if (Roll < HubDensity + ConditionDensity + InstructionDensity)
+			{
+				Type = EBenchmarkNodeType::Instruction;
+			}
+			else if (Roll < HubDensity + ConditionDensity + InstructionDensity + JumpDensity)
+			{
+				Type = EBenchmarkNodeType::Jump;
+			}
+		}
+
+		if (Type == EBenchmarkNodeType::Fragment)
+		{
+			Fragments.Add(i);
+		}
+		Types.Add(Type);
+	}
+
+	auto RandomFlag = [&Random, this]() { return Random.RandRange(0, NumFlags - 1); };
+
+	TArray<UDialogueNode*> Nodes;
+	Nodes.Reserve(NumNodes);
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		UDialogueNode* Node = nullptr;
+		int32 NumOutputPins = 1;
+
+		switch (Types[i])
+		{
+		case EBenchmarkNodeType::Hub:
+			Node = NewObject<UDialogueHub>(Package);
+			break;
+
+		case EBenchmarkNodeType::Condition:
+		{
+			UDialogueCondition* Condition = NewObject<UDialogueCondition>(Package);
+			CompileBenchmarkScript(Condition->Script, FString::Printf(TEXT("Bench.Flag%d == true"), RandomFlag()), true, GV);
+			Node = Condition;
+			NumOutputPins = 2;
+			break;
+		}
+
+		case EBenchmarkNodeType::Instruction:
+		{
+			UDialogueInstruction* Instruction = NewObject<UDialogueInstruction>(Package);
+			const int32 Flag = RandomFlag();
+			CompileBenchmarkScript(Instruction->Script, FString::Printf(TEXT("Bench.Flag%d = !Bench.Flag%d; Bench.Counter += 1"), Flag, Flag), false, GV);
+			Node = Instruction;
+			break;
+		}
+
+		case EBenchmarkNodeType::Jump:
+		{
+			UDialogueJump* Jump = NewObject<UDialogueJump>(Package);
+			// Jump back to a fragment to create cycles that still pause
+			const int32 Target = Fragments.Num() > 0 ? Fragments[Random.RandRange(0, Fragments.Num() - 1)] : 0;
+			Jump->TargetNodeId = FDialogueId(Target + 1, 0);
+			Jump->TargetPinIndex = 0;
+			Node = Jump;
+			NumOutputPins = 0;
+			break;
+		}
+
+		default:
+			Node = NewObject<UDialogueFragment>(Package);
+			break;
+		}
+
+		Node->Id = FDialogueId(i + 1, 0);
+		Node->TechnicalName = FString::Printf(TEXT("Bench_%d"), i);
+
+		UDialogueInputPin* InputPin = NewObject<UDialogueInputPin>(Node);
+		InputPin->Id = FDialogueId(i + 1, 1);
+		InputPin->OwnerId = Node->Id;
+		if (Types[i] == EBenchmarkNodeType::Fragment && Random.FRand() < ConditionDensity)
+		{
+			CompileBenchmarkScript(InputPin->Script, FString::Printf(TEXT("Bench.Flag%d || Bench.Counter < 100"), RandomFlag()), true, GV);
+		}
+		Node->InputPins.Add(InputPin);
+
+		for (int32 PinIndex = 0; PinIndex < NumOutputPins; ++PinIndex)
+		{
+			UDialogueOutputPin* OutputPin = NewObject<UDialogueOutputPin>(Node);
+			OutputPin->Id = FDialogueId(i + 1, 2 + PinIndex);
+			OutputPin->OwnerId = Node->Id;
+			OutputPin->Index = PinIndex;
+			Node->OutputPins.Add(OutputPin);
+		}
+
+		Nodes.Add(Node);
+		Package->Objects.Add(Node);
+	}
+
+	// Connect forward within a window, the last nodes become dead ends
+	const int32 Window = 32;
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		const int32 LastTarget = FMath::Min(i + Window, NumNodes - 1);
+		if (LastTarget <= i)
+		{
+			continue;
+		}
+
+		for (UDialogueOutputPin* OutputPin : Nodes[i]->OutputPins)
+		{
+			int32 NumConnections = 1;
+			if (Types[i] == EBenchmarkNodeType::Hub)
+			{
+				NumConnections = Branching * 2;
+			}
+			else if (Types[i] != EBenchmarkNodeType::Condition)
+			{
+				NumConnections = Branching;
+			}
+
+			for (int32 c = 0; c < NumConnections; ++c)
+			{
+				FDialogueConnection& Connection = OutputPin->Edges.AddDefaulted_GetRef();
+				Connection.TargetNodeId = Nodes[Random.RandRange(i + 1, LastTarget)]->Id;
+				Connection.TargetPinIndex = 0;
+			}
+		}
+	}
+
+	// Resolve jumps and connections like the importer does
+	Package->ResolveTargetPins();
+
+	UDialogueDatabase* Database = NewObject<UDialogueDatabase>(Outer, TEXT("DialogueBenchmarkDatabase"));
+	Database->ImportedPackages.Add(Package->Name, TSoftObjectPtr<UDialoguePackage>(Package));
+	Database->DefaultPackageNames.Add(Package->Name);
+	Database->DefaultGlobalVariables = GV;
+	Database->Initialize();
+
+	OutStartNode = Nodes[0];
+	return Database;
+}
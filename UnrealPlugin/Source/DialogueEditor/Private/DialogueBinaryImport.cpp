@@ -0,0 +1,361 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueBinaryFormat.h"
+#include "DialogueImportData.h"
+#include "DialogueEditorModule.h"
+#include "DialogueImportStats.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	using namespace DialogueBinaryFormat;
+
+	/** The bytes of an export, mapped if the platform file supports it and loaded otherwise */
+	struct FDialogueBinaryFile
+	{
+		TUniquePtr<IMappedFileHandle> MappedFile;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+		TArray<uint8> Loaded;
+		TArrayView<const uint8> Bytes;
+
+		bool Open(const FString& Filename)
+		{
+			MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+			if (MappedFile && MappedFile->GetFileSize() > 0)
+			{
+				MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+			}
+			if (MappedRegion)
+			{
+				Bytes = TArrayView<const uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+				return true;
+			}
+
+			MappedFile.Reset();
+			if (!FFileHelper::LoadFileToArray(Loaded, *Filename))
+			{
+				return false;
+			}
+			Bytes = Loaded;
+			return true;
+		}
+	};
+
+	/** Bounds-checked access to the sections and strings of an export, any bad offset or index sets the error */
+	class FDialogueBinaryReader
+	{
+	public:
+		explicit FDialogueBinaryReader(TArrayView<const uint8> InBytes)
+			: Bytes(InBytes)
+		{
+		}
+
+		bool ReadHeader(FString& OutError)
+		{
+			if (Bytes.Num() < (int32)sizeof(FHeader))
+			{
+				OutError = TEXT("the file is too small for a binary export");
+				return false;
+			}
+			FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(FHeader));
+			if (Header.Magic != Magic)
+			{
+				OutError = TEXT("the file is not a binary export");
+				return false;
+			}
+			if (Header.Version < (uint32)EVersion::Initial || Header.Version > (uint32)EVersion::Latest)
+			{
+				OutError = FString::Printf(TEXT("version %u is not supported, the latest is %u"), Header.Version, (uint32)EVersion::Latest);
+				return false;
+			}
+			return true;
+		}
+
+		/** Records of a section, empty with the error set if it does not lie within the file */
+		template<typename RecordType>
+		TConstArrayView<RecordType> GetRecords(const FSection& Section, const TCHAR* Name)
+		{
+			const uint64 End = (uint64)Section.Offset + (uint64)Section.Num * sizeof(RecordType);
+			if (Section.Offset % alignof(RecordType) != 0 || End > (uint64)Bytes.Num())
+			{
+				SetError(FString::Printf(TEXT("the %s section lies outside the file"), Name));
+				return TConstArrayView<RecordType>();
+			}
+			return TConstArrayView<RecordType>(reinterpret_cast<const RecordType*>(Bytes.GetData() + Section.Offset), Section.Num);
+		}
+
+		/** Decode every string once, records only copy them */
+		bool ReadStrings()
+		{
+			if (Header.Strings.Num == MAX_uint32)
+			{
+				SetError(TEXT("the string section lies outside the file"));
+				return false;
+			}
+			const TConstArrayView<uint32> Offsets = GetRecords<uint32>({ Header.Strings.Offset, Header.Strings.Num + 1 }, TEXT("string"));
+			const TConstArrayView<uint8> Data = GetRecords<uint8>(Header.StringData, TEXT("string data"));
+			if (bError)
+			{
+				return false;
+			}
+
+			Strings.SetNum(Header.Strings.Num);
+			for (uint32 Index = 0; Index < Header.Strings.Num; ++Index)
+			{
+				const uint32 Start = Offsets[Index];
+				const uint32 End = Offsets[Index + 1];
+				if (Start > End || End > (uint32)Data.Num())
+				{
+					SetError(FString::Printf(TEXT("string %u lies outside the string data"), Index));
+					return false;
+				}
+				if (End > Start)
+				{
+					const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Data.GetData() + Start), End - Start);
+					Strings[Index] = FString(Converter.Length(), Converter.Get());
+				}
+			}
+			return true;
+		}
+
+		const FString& GetString(uint32 Index)
+		{
+			if (Index == NoString)
+			{
+				return EmptyString;
+			}
+			if (!Strings.IsValidIndex(Index))
+			{
+				SetError(FString::Printf(TEXT("string %u does not exist"), Index));
+				return EmptyString;
+			}
+			return Strings[Index];
+		}
+
+		/** Records [First, First + Num) of a section, empty with the error set if they are not all in it */
+		template<typename RecordType>
+		TConstArrayView<RecordType> GetRange(TConstArrayView<RecordType> Records, uint32 First, uint32 Num, const TCHAR* Name)
+		{
+			if ((uint64)First + Num > (uint64)Records.Num())
+			{
+				SetError(FString::Printf(TEXT("%s %u to %u do not exist"), Name, First, First + Num));
+				return TConstArrayView<RecordType>();
+			}
+			return Records.Slice(First, Num);
+		}
+
+		void SetError(FString InError)
+		{
+			if (!bError)
+			{
+				bError = true;
+				Error = MoveTemp(InError);
+			}
+		}
+
+		bool HasError() const { return bError; }
+		const FString& GetError() const { return Error; }
+		const FHeader& GetHeader() const { return Header; }
+
+	private:
+		TArrayView<const uint8> Bytes;
+		FHeader Header = {};
+		TArray<FString> Strings;
+		const FString EmptyString;
+		FString Error;
+		bool bError = false;
+	};
+
+	/** Stand-in for the editor's hash of an object, only used if the export has none */
+	uint32 HashObjectDef(const FDialogueObjectDef& Object, uint32 Flags)
+	{
+		const FDialogueObjectPropertiesDef& Properties = Object.Properties;
+		uint32 Crc = 0;
+		for (const FString* Field : { &Object.TechnicalName, &Object.Type, &Properties.Speaker, &Properties.Text, &Properties.MenuText,
+			&Properties.ScriptExpression, &Properties.TargetNodeId, &Properties.DisplayName })
+		{
+			Crc = FCrc::StrCrc32(**Field, Crc);
+		}
+		for (const TArray<FString>* PinIds : { &Object.InputPinIds, &Object.OutputPinIds })
+		{
+			Crc = FCrc::TypeCrc32(PinIds->Num(), Crc);
+			for (const FString& PinId : *PinIds)
+			{
+				Crc = FCrc::StrCrc32(*PinId, Crc);
+			}
+		}
+		Crc = FCrc::TypeCrc32(Properties.TargetPinIndex, Crc);
+		return FCrc::TypeCrc32(Flags, Crc);
+	}
+}
+
+bool UDialogueImportData::IsBinaryFile(const FString& Filename)
+{
+	TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*Filename));
+	uint32 FileMagic = 0;
+	if (!FileReader || FileReader->TotalSize() < (int64)sizeof(FileMagic))
+	{
+		return false;
+	}
+	FileReader->Serialize(&FileMagic, sizeof(FileMagic));
+	return FileMagic == Magic;
+}
+
+bool UDialogueImportData::ImportFromBinaryFile(const FString& Filename, FDialogueImportStats* Stats, FDialogueImportProgress* Progress)
+{
+	FDialogueBinaryFile File;
+	{
+		FDialogueImportStageScope ReadScope(Stats, TEXT("Read"));
+		if (!File.Open(Filename))
+		{
+			UE_LOG(LogDialogueEditor, Error, TEXT("Failed to read file: %s"), *Filename);
+			return false;
+		}
+	}
+	const int64 FileSize = File.Bytes.Num();
+	if (Progress)
+	{
+		Progress->TotalBytes.store(FileSize, std::memory_order_relaxed);
+	}
+
+	FDialogueImportStageScope ParseScope(Stats, TEXT("Parse"));
+
+	FDialogueBinaryReader Reader(File.Bytes);
+	FString HeaderError;
+	if (!Reader.ReadHeader(HeaderError))
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to import %s: %s"), *Filename, *HeaderError);
+		return false;
+	}
+	const FHeader& Header = Reader.GetHeader();
+
+	const TConstArrayView<FNamespaceRecord> NamespaceRecords = Reader.GetRecords<FNamespaceRecord>(Header.Namespaces, TEXT("namespace"));
+	const TConstArrayView<FVariableRecord> VariableRecords = Reader.GetRecords<FVariableRecord>(Header.Variables, TEXT("variable"));
+	const TConstArrayView<FCharacterRecord> CharacterRecords = Reader.GetRecords<FCharacterRecord>(Header.Characters, TEXT("character"));
+	const TConstArrayView<FPackageRecord> PackageRecords = Reader.GetRecords<FPackageRecord>(Header.Packages, TEXT("package"));
+	const TConstArrayView<FObjectRecord> ObjectRecords = Reader.GetRecords<FObjectRecord>(Header.Objects, TEXT("object"));
+	const TConstArrayView<uint32> PinRecords = Reader.GetRecords<uint32>(Header.Pins, TEXT("pin"));
+	const TConstArrayView<FConnectionRecord> ConnectionRecords = Reader.GetRecords<FConnectionRecord>(Header.Connections, TEXT("connection"));
+	if (Reader.HasError() || !Reader.ReadStrings())
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to import %s: %s"), *Filename, *Reader.GetError());
+		return false;
+	}
+
+	Project.Name = Reader.GetString(Header.ProjectName);
+	Project.TechnicalName = Reader.GetString(Header.ProjectTechnicalName);
+	Project.Guid = Reader.GetString(Header.ProjectGuid);
+
+	GlobalVariables.Empty(NamespaceRecords.Num());
+	for (const FNamespaceRecord& NamespaceRecord : NamespaceRecords)
+	{
+		FDialogueVariableNamespaceDef& Namespace = GlobalVariables.AddDefaulted_GetRef();
+		Namespace.Name = Reader.GetString(NamespaceRecord.Name);
+		Namespace.Description = Reader.GetString(NamespaceRecord.Description);
+
+		const TConstArrayView<FVariableRecord> Variables = Reader.GetRange(VariableRecords, NamespaceRecord.FirstVariable, NamespaceRecord.NumVariables, TEXT("variables"));
+		Namespace.Variables.Reserve(Variables.Num());
+		for (const FVariableRecord& VariableRecord : Variables)
+		{
+			FDialogueVariableDef& Variable = Namespace.Variables.AddDefaulted_GetRef();
+			Variable.Name = Reader.GetString(VariableRecord.Name);
+			Variable.Type = Reader.GetString(VariableRecord.Type);
+			Variable.DefaultValue = Reader.GetString(VariableRecord.DefaultValue);
+			Variable.Description = Reader.GetString(VariableRecord.Description);
+		}
+	}
+
+	Characters.Empty(CharacterRecords.Num());
+	for (const FCharacterRecord& CharacterRecord : CharacterRecords)
+	{
+		FDialogueCharacterDef& Character = Characters.AddDefaulted_GetRef();
+		Character.Id = Reader.GetString(CharacterRecord.Id);
+		Character.TechnicalName = Reader.GetString(CharacterRecord.TechnicalName);
+		Character.DisplayName = Reader.GetString(CharacterRecord.DisplayName);
+		Character.Color = Reader.GetString(CharacterRecord.Color);
+	}
+
+	Packages.Empty(PackageRecords.Num());
+	int64 NumObjectsRead = 0;
+	for (const FPackageRecord& PackageRecord : PackageRecords)
+	{
+		if (Progress && Progress->IsCancelRequested())
+		{
+			UE_LOG(LogDialogueEditor, Display, TEXT("Import of %s was cancelled"), *Filename);
+			return false;
+		}
+
+		FDialoguePackageDef& Package = Packages.AddDefaulted_GetRef();
+		Package.Name = Reader.GetString(PackageRecord.Name);
+		Package.bIsDefaultPackage = (PackageRecord.Flags & PackageFlag_Default) != 0;
+
+		const TConstArrayView<FObjectRecord> Objects = Reader.GetRange(ObjectRecords, PackageRecord.FirstObject, PackageRecord.NumObjects, TEXT("objects"));
+		Package.Objects.Reserve(Objects.Num());
+		for (const FObjectRecord& ObjectRecord : Objects)
+		{
+			FDialogueObjectDef& Object = Package.Objects.AddDefaulted_GetRef();
+			Object.Id = Reader.GetString(ObjectRecord.Id);
+			Object.TechnicalName = Reader.GetString(ObjectRecord.TechnicalName);
+			Object.Type = Reader.GetString(ObjectRecord.Type);
+
+			FDialogueObjectPropertiesDef& Properties = Object.Properties;
+			Properties.Speaker = Reader.GetString(ObjectRecord.Speaker);
+			Properties.Text = Reader.GetString(ObjectRecord.Text);
+			Properties.MenuText = Reader.GetString(ObjectRecord.MenuText);
+			Properties.bAutoTransition = (ObjectRecord.Flags & ObjectFlag_AutoTransition) != 0;
+			Properties.ScriptExpression = Reader.GetString(ObjectRecord.Script);
+			Properties.TargetNodeId = Reader.GetString(ObjectRecord.TargetNodeId);
+			Properties.TargetPinIndex = ObjectRecord.TargetPinIndex;
+			Properties.DisplayName = Reader.GetString(ObjectRecord.DisplayName);
+
+			for (uint32 PinId : Reader.GetRange(PinRecords, ObjectRecord.FirstInputPin, ObjectRecord.NumInputPins, TEXT("pins")))
+			{
+				Object.InputPinIds.Add(Reader.GetString(PinId));
+			}
+			for (uint32 PinId : Reader.GetRange(PinRecords, ObjectRecord.FirstOutputPin, ObjectRecord.NumOutputPins, TEXT("pins")))
+			{
+				Object.OutputPinIds.Add(Reader.GetString(PinId));
+			}
+
+			Object.ContentHash = ObjectRecord.ContentHash != 0 ? ObjectRecord.ContentHash : HashObjectDef(Object, ObjectRecord.Flags);
+		}
+
+		const TConstArrayView<FConnectionRecord> Connections = Reader.GetRange(ConnectionRecords, PackageRecord.FirstConnection, PackageRecord.NumConnections, TEXT("connections"));
+		Package.Connections.Reserve(Connections.Num());
+		for (const FConnectionRecord& ConnectionRecord : Connections)
+		{
+			FDialogueConnectionDef& Connection = Package.Connections.AddDefaulted_GetRef();
+			Connection.Id = Reader.GetString(ConnectionRecord.Id);
+			Connection.SourceId = Reader.GetString(ConnectionRecord.SourceId);
+			Connection.SourcePin = ConnectionRecord.SourcePin;
+			Connection.TargetId = Reader.GetString(ConnectionRecord.TargetId);
+			Connection.TargetPin = ConnectionRecord.TargetPin;
+		}
+
+		NumObjectsRead += Objects.Num();
+		if (Progress && ObjectRecords.Num() > 0)
+		{
+			Progress->BytesRead.store(FileSize * NumObjectsRead / ObjectRecords.Num(), std::memory_order_relaxed);
+		}
+	}
+
+	if (Reader.HasError())
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to import %s: %s"), *Filename, *Reader.GetError());
+		return false;
+	}
+
+	if (Stats)
+	{
+		Stats->AddCount(FDialogueImportStats::ECounter::BytesRead, FileSize);
+		Stats->AddCount(FDialogueImportStats::ECounter::ObjectsParsed, NumObjectsRead);
+	}
+
+	UE_LOG(LogDialogueEditor, Log, TEXT("Imported project '%s': %d namespaces, %d characters, %d packages"),
+		*Project.Name, GlobalVariables.Num(), Characters.Num(), Packages.Num());
+
+	return true;
+}
@@ -5,6 +5,11 @@
 #include "IAssetTools.h"
 #include "DialogueDatabaseAssetTypeActions.h"
 #include "DialoguePackageAssetTypeActions.h"
+#include "DialogueAsyncImport.h"
+#include "DialoguePackageQuery.h"
+#include "DialogueDatabase.h"
+#include "DialoguePackage.h"
+#include "Engine/AssetManager.h"
 
 DEFINE_LOG_CATEGORY(LogDialogueEditor);
 
@@ -15,13 +20,26 @@ void FDialogueEditorModule::StartupModule()
 	UE_LOG(LogDialogueEditor, Log, TEXT("DialogueEditor module started"));
 
 	RegisterAssetTypeActions();
+	RegisterPackageChunkRules();
 }
 
 void FDialogueEditorModule::ShutdownModule()
 {
 	UE_LOG(LogDialogueEditor, Log, TEXT("DialogueEditor module shutdown"));
 
+	FDialogueAsyncImport::CancelAll();
+
 	UnregisterAssetTypeActions();
+	PackageQuery.Reset();
+}
+
+FDialoguePackageQuery& FDialogueEditorModule::GetPackageQuery()
+{
+	if (!PackageQuery)
+	{
+		PackageQuery = MakeUnique<FDialoguePackageQuery>();
+	}
+	return *PackageQuery;
 }
 
 void FDialogueEditorModule::RegisterAssetTypeActions()
@@ -53,6 +71,37 @@ void FDialogueEditorModule::UnregisterAssetTypeActions()
 	RegisteredAssetTypeActions.Empty();
 }
 
+void FDialogueEditorModule::RegisterPackageChunkRules()
+{
+	UAssetManager::CallOrRegister_OnAssetManagerCreated(FSimpleMulticastDelegate::FDelegate::CreateLambda([]()
+	{
+		const TMap<FString, int32>& ChunkIds = GetDefault<UDialogueDatabase>()->PackageChunkIds;
+		if (ChunkIds.Num() == 0)
+		{
+			return;
+		}
+
+		// The packages become primary assets so the cook assigns them and what only they reference to their chunks
+		UAssetManager& AssetManager = UAssetManager::Get();
+		AssetManager.ScanPathsForPrimaryAssets(UDialoguePackage::PrimaryAssetType, { TEXT("/Game") }, UDialoguePackage::StaticClass(), false);
+
+		TArray<FAssetData> Packages;
+		AssetManager.GetPrimaryAssetDataList(UDialoguePackage::PrimaryAssetType, Packages);
+		for (const FAssetData& Package : Packages)
+		{
+			const int32* ChunkId = ChunkIds.Find(Package.GetTagValueRef<FString>(GET_MEMBER_NAME_CHECKED(UDialoguePackage, Name)));
+			if (!ChunkId)
+			{
+				continue;
+			}
+
+			FPrimaryAssetRules Rules;
+			Rules.ChunkId = *ChunkId;
+			AssetManager.SetPrimaryAssetRules(FPrimaryAssetId(UDialoguePackage::PrimaryAssetType, Package.AssetName), Rules);
+		}
+	}));
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FDialogueEditorModule, DialogueEditor)
@@ -0,0 +1,186 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueImportCommandlet.h"
+#include "DialogueBinaryFormat.h"
+#include "DialogueImportData.h"
+#include "DialogueImportStats.h"
+#include "DialogueAssetGenerator.h"
+#include "DialogueEditorModule.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/SavePackage.h"
+#include "Misc/PackageName.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** Outcome of importing one file */
+	struct FFileImport
+	{
+		FString Filename;
+		UDialogueImportData* ImportData = nullptr;
+		FDialogueImportStats Stats;
+		bool bParsed = false;
+		bool bGenerated = false;
+	};
+}
+
+UDialogueImportCommandlet::UDialogueImportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UDialogueImportCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	ParseCommandLine(*Params, Tokens, Switches);
+
+	const TCHAR* Cmd = *Params;
+	FParse::Value(Cmd, TEXT("Dest="), DestinationPath);
+	FString ReportPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("DialogueImport-%s.json"), *FDateTime::Now().ToString());
+	FParse::Value(Cmd, TEXT("Report="), ReportPath);
+
+	TArray<FFileImport> Imports;
+	for (const FString& Token : Tokens)
+	{
+		const FString Extension = FPaths::GetExtension(Token);
+		if (Extension.Equals(TEXT("json"), ESearchCase::IgnoreCase) || Extension.Equals(DialogueBinaryFormat::Extension, ESearchCase::IgnoreCase))
+		{
+			Imports.AddDefaulted_GetRef().Filename = FPaths::ConvertRelativePathToFull(Token);
+		}
+	}
+
+	if (Imports.Num() == 0)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("No .json or .dlgbin files given, usage: -run=DialogueImport <File.json|File.dlgbin>... [-Dest=/Game/Dialogue/Imports] [-Report=<Path>]"));
+		return 1;
+	}
+
+	// Objects are created and loaded on the game thread only
+	for (FFileImport& Import : Imports)
+	{
+		Import.ImportData = FindOrCreateImportData(Import.Filename);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Each file only fills its own import data
+	ParallelFor(Imports.Num(), [&Imports](int32 Index)
+	{
+		FFileImport& Import = Imports[Index];
+		if (Import.ImportData)
+		{
+			Import.bParsed = Import.ImportData->ImportFromFile(Import.Filename, &Import.Stats);
+		}
+	});
+
+	// Files may write to the same generated folder, so they are generated one after the other
+	for (FFileImport& Import : Imports)
+	{
+		if (!Import.bParsed)
+		{
+			UE_LOG(LogDialogueEditor, Error, TEXT("Failed to import dialogue from: %s"), *Import.Filename);
+			continue;
+		}
+
+		Import.ImportData->SourceFilePath = Import.Filename;
+		Import.ImportData->ImportTimestamp = FDateTime::Now();
+
+		FDialogueAssetGenerator Generator;
+		Generator.SetStats(&Import.Stats);
+		Import.bGenerated = Generator.GenerateAssets(Import.ImportData);
+
+		FDialogueImportStageScope SaveScope(&Import.Stats, TEXT("Save"));
+		Import.bGenerated &= SaveImportData(Import.ImportData);
+	}
+
+	const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TArray<TSharedPtr<FJsonValue>> FilesJson;
+	int32 NumFailed = 0;
+	for (const FFileImport& Import : Imports)
+	{
+		NumFailed += Import.bGenerated ? 0 : 1;
+
+		TSharedRef<FJsonObject> FileJson = MakeShared<FJsonObject>();
+		FileJson->SetStringField(TEXT("file"), Import.Filename);
+		FileJson->SetBoolField(TEXT("succeeded"), Import.bGenerated);
+		FileJson->SetNumberField(TEXT("seconds"), Import.Stats.GetTotalSeconds());
+		FileJson->SetObjectField(TEXT("stages"), Import.Stats.ToJson());
+		FilesJson.Add(MakeShared<FJsonValueObject>(FileJson));
+
+		Import.Stats.LogSummary(FPaths::GetCleanFilename(Import.Filename));
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	TSharedRef<FJsonObject> ReportJson = MakeShared<FJsonObject>();
+	ReportJson->SetArrayField(TEXT("files"), FilesJson);
+	ReportJson->SetNumberField(TEXT("seconds"), TotalSeconds);
+	ReportJson->SetNumberField(TEXT("peakMemory"), (double)MemoryStats.PeakUsedPhysical);
+	ReportJson->SetNumberField(TEXT("failed"), NumFailed);
+
+	FString Report;
+	FJsonSerializer::Serialize(ReportJson, TJsonWriterFactory<>::Create(&Report));
+	if (FFileHelper::SaveStringToFile(Report, *ReportPath))
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("Imported %d of %d files in %.3fs, report written to %s"),
+			Imports.Num() - NumFailed, Imports.Num(), TotalSeconds, *ReportPath);
+	}
+	else
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to write import report to %s"), *ReportPath);
+	}
+
+	return NumFailed > 0 ? 1 : 0;
+}
+
+UDialogueImportData* UDialogueImportCommandlet::FindOrCreateImportData(const FString& Filename) const
+{
+	const FString AssetName = FPaths::GetBaseFilename(Filename);
+	const FString PackageName = DestinationPath / AssetName;
+	if (!FPackageName::IsValidLongPackageName(PackageName))
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Invalid import data package %s for %s"), *PackageName, *Filename);
+		return nullptr;
+	}
+
+	// Reuse the last import, its hashes let the generator skip unchanged objects
+	if (FPackageName::DoesPackageExist(PackageName))
+	{
+		if (UDialogueImportData* Existing = LoadObject<UDialogueImportData>(nullptr, *(PackageName + TEXT(".") + AssetName)))
+		{
+			return Existing;
+		}
+	}
+
+	UPackage* Package = CreatePackage(*PackageName);
+	Package->FullyLoad();
+	return NewObject<UDialogueImportData>(Package, *AssetName, RF_Public | RF_Standalone);
+}
+
+bool UDialogueImportCommandlet::SaveImportData(UDialogueImportData* ImportData) const
+{
+	UPackage* Package = ImportData->GetOutermost();
+	Package->MarkPackageDirty();
+
+	const FString PackageFilename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	if (UPackage::Save(Package, ImportData, *PackageFilename, SaveArgs).Result != ESavePackageResult::Success)
+	{
+		UE_LOG(LogDialogueEditor, Warning, TEXT("Failed to save import data: %s"), *ImportData->GetName());
+		return false;
+	}
+
+	FAssetRegistryModule::AssetCreated(ImportData);
+	return true;
+}
@@ -2,82 +2,548 @@
 
 #include "DialogueImportData.h"
 #include "DialogueEditorModule.h"
+#include "DialogueImportStats.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 
-bool UDialogueImportData::ImportFromJson(const TSharedPtr<FJsonObject>& JsonData)
+namespace
 {
-	if (!JsonData.IsValid())
+	/**
+	 * Presents a UTF-8 file to TJsonReader as a stream of TCHARs, decoding one chunk at a time
+	 * so the file never has to be in memory as a whole.
+	 */
+	class FDialogueUtf8Archive : public FArchive
 	{
-		return false;
+	public:
+		FDialogueUtf8Archive(FArchive& InInner, FDialogueImportProgress* InProgress)
+			: Inner(InInner)
+			, Progress(InProgress)
+		{
+			SetIsLoading(true);
+			SetIsPersistent(true);
+
+			// Skip the byte order mark
+			uint8 Bom[3];
+			if (Inner.TotalSize() >= 3)
+			{
+				Inner.Serialize(Bom, 3);
+				if (Bom[0] != 0xEF || Bom[1] != 0xBB || Bom[2] != 0xBF)
+				{
+					Buffer.Append(Bom, 3);
+				}
+			}
+		}
+
+		virtual void Serialize(void* Data, int64 Num) override
+		{
+			TCHAR* Out = static_cast<TCHAR*>(Data);
+			for (int64 i = 0; i < Num / (int64)sizeof(TCHAR); ++i)
+			{
+				if (PendingPos == NumPending && !DecodeNext())
+				{
+					SetError();
+					Out[i] = TCHAR(0);
+					continue;
+				}
+				Out[i] = Pending[PendingPos++];
+			}
+		}
+
+		virtual bool AtEnd() override
+		{
+			return PendingPos == NumPending && BufferPos == Buffer.Num() && Inner.AtEnd();
+		}
+
+		virtual FString GetArchiveName() const override
+		{
+			return Inner.GetArchiveName();
+		}
+
+		/** Time spent reading the file so far, the rest is decoding and parsing */
+		double GetReadSeconds() const { return ReadSeconds; }
+
+	private:
+		static constexpr int32 ChunkSize = 64 * 1024;
+
+		bool ReadByte(uint8& OutByte)
+		{
+			if (BufferPos == Buffer.Num())
+			{
+				const int64 Remaining = Inner.TotalSize() - Inner.Tell();
+				if (Remaining <= 0)
+				{
+					return false;
+				}
+
+				// Ends the import as if the file were cut off here
+				if (Progress && Progress->IsCancelRequested())
+				{
+					return false;
+				}
+
+				Buffer.SetNum((int32)FMath::Min<int64>(Remaining, ChunkSize), false);
+				const double StartTime = FPlatformTime::Seconds();
+				Inner.Serialize(Buffer.GetData(), Buffer.Num());
+				ReadSeconds += FPlatformTime::Seconds() - StartTime;
+				BufferPos = 0;
+
+				if (Progress)
+				{
+					Progress->BytesRead.store(Inner.Tell(), std::memory_order_relaxed);
+				}
+			}
+
+			OutByte = Buffer[BufferPos++];
+			return true;
+		}
+
+		/** Decode the next code point into Pending */
+		bool DecodeNext()
+		{
+			uint8 Lead;
+			if (!ReadByte(Lead))
+			{
+				return false;
+			}
+
+			uint32 CodePoint = 0xFFFD;
+			int32 NumTrail = 0;
+			if (Lead < 0x80)
+			{
+				CodePoint = Lead;
+			}
+			else if ((Lead & 0xE0) == 0xC0)
+			{
+				CodePoint = Lead & 0x1F;
+				NumTrail = 1;
+			}
+			else if ((Lead & 0xF0) == 0xE0)
+			{
+				CodePoint = Lead & 0x0F;
+				NumTrail = 2;
+			}
+			else if ((Lead & 0xF8) == 0xF0)
+			{
+				CodePoint = Lead & 0x07;
+				NumTrail = 3;
+			}
+
+			for (int32 i = 0; i < NumTrail; ++i)
+			{
+				uint8 Trail;
+				if (!ReadByte(Trail) || (Trail & 0xC0) != 0x80)
+				{
+					CodePoint = 0xFFFD;
+					break;
+				}
+				CodePoint = (CodePoint << 6) | (Trail & 0x3F);
+			}
+
+			PendingPos = 0;
+			if constexpr (sizeof(TCHAR) == 2)
+			{
+				if (CodePoint > 0xFFFF)
+				{
+					CodePoint -= 0x10000;
+					Pending[0] = TCHAR(0xD800 + (CodePoint >> 10));
+					Pending[1] = TCHAR(0xDC00 + (CodePoint & 0x3FF));
+					NumPending = 2;
+					return true;
+				}
+			}
+			Pending[0] = TCHAR(CodePoint);
+			NumPending = 1;
+			return true;
+		}
+
+		FArchive& Inner;
+		TArray<uint8> Buffer;
+		int32 BufferPos = 0;
+		TCHAR Pending[2];
+		int32 NumPending = 0;
+		int32 PendingPos = 0;
+
+		double ReadSeconds = 0.0;
+
+		FDialogueImportProgress* Progress;
+	};
+
+	using FDialogueJsonReader = TJsonReader<TCHAR>;
+
+	/** Count what an import read and parsed */
+	void CountImport(FDialogueImportStats* Stats, const TArray<FDialoguePackageDef>& Packages, int64 FileSize)
+	{
+		if (!Stats)
+		{
+			return;
+		}
+
+		int32 NumObjects = 0;
+		for (const FDialoguePackageDef& PackageDef : Packages)
+		{
+			NumObjects += PackageDef.Objects.Num();
+		}
+		Stats->AddCount(FDialogueImportStats::ECounter::BytesRead, FileSize);
+		Stats->AddCount(FDialogueImportStats::ECounter::ObjectsParsed, NumObjects);
 	}
 
-	// Parse format version
-	FString FormatVersion;
-	JsonData->TryGetStringField(TEXT("formatVersion"), FormatVersion);
-	UE_LOG(LogDialogueEditor, Log, TEXT("Importing dialogue format version: %s"), *FormatVersion);
+	/** Build the value the reader just started, consuming all of its tokens */
+	TSharedPtr<FJsonValue> ReadValue(FDialogueJsonReader& Reader, EJsonNotation Notation)
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::String:
+			return MakeShared<FJsonValueString>(Reader.GetValueAsString());
+		case EJsonNotation::Number:
+			return MakeShared<FJsonValueNumber>(Reader.GetValueAsNumber());
+		case EJsonNotation::Boolean:
+			return MakeShared<FJsonValueBoolean>(Reader.GetValueAsBoolean());
+		case EJsonNotation::Null:
+			return MakeShared<FJsonValueNull>();
+		case EJsonNotation::ObjectStart:
+		{
+			TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+			EJsonNotation Next;
+			while (Reader.ReadNext(Next) && Next != EJsonNotation::ObjectEnd)
+			{
+				const FString Field = Reader.GetIdentifier();
+				TSharedPtr<FJsonValue> Value = ReadValue(Reader, Next);
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+				Object->SetField(Field, Value);
+			}
+			return Next == EJsonNotation::ObjectEnd ? MakeShared<FJsonValueObject>(Object) : nullptr;
+		}
+		case EJsonNotation::ArrayStart:
+		{
+			TArray<TSharedPtr<FJsonValue>> Array;
+			EJsonNotation Next;
+			while (Reader.ReadNext(Next) && Next != EJsonNotation::ArrayEnd)
+			{
+				TSharedPtr<FJsonValue> Value = ReadValue(Reader, Next);
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+				Array.Add(Value);
+			}
+			return Next == EJsonNotation::ArrayEnd ? MakeShared<FJsonValueArray>(Array) : nullptr;
+		}
+		default:
+			return nullptr;
+		}
+	}
 
-	// Parse project info
-	if (const TSharedPtr<FJsonObject>* ProjectObj = nullptr; JsonData->TryGetObjectField(TEXT("project"), ProjectObj))
+	/** Consume the value the reader just started without building it */
+	bool SkipValue(FDialogueJsonReader& Reader, EJsonNotation Notation)
 	{
-		(*ProjectObj)->TryGetStringField(TEXT("name"), Project.Name);
-		(*ProjectObj)->TryGetStringField(TEXT("technicalName"), Project.TechnicalName);
-		(*ProjectObj)->TryGetStringField(TEXT("guid"), Project.Guid);
+		int32 Depth = 0;
+		do
+		{
+			if (Notation == EJsonNotation::ObjectStart || Notation == EJsonNotation::ArrayStart)
+			{
+				++Depth;
+			}
+			else if (Notation == EJsonNotation::ObjectEnd || Notation == EJsonNotation::ArrayEnd)
+			{
+				--Depth;
+			}
+			else if (Notation == EJsonNotation::Error)
+			{
+				return false;
+			}
+
+			if (Depth == 0)
+			{
+				return true;
+			}
+		}
+		while (Reader.ReadNext(Notation));
+
+		return false;
 	}
 
-	// Parse global variables
-	GlobalVariables.Empty();
-	if (const TArray<TSharedPtr<FJsonValue>>* VariablesArray = nullptr; JsonData->TryGetArrayField(TEXT("globalVariables"), VariablesArray))
+	/** Call OnElement for every element of the array the reader just started, each element has to consume its tokens */
+	template <typename FunctorType>
+	bool ReadArray(FDialogueJsonReader& Reader, EJsonNotation Notation, FunctorType&& OnElement)
 	{
-		for (const TSharedPtr<FJsonValue>& NamespaceValue : *VariablesArray)
+		if (Notation != EJsonNotation::ArrayStart)
+		{
+			return SkipValue(Reader, Notation);
+		}
+
+		EJsonNotation Next;
+		while (Reader.ReadNext(Next) && Next != EJsonNotation::ArrayEnd)
 		{
-			const TSharedPtr<FJsonObject>* NamespaceObj = nullptr;
-			if (!NamespaceValue->TryGetObject(NamespaceObj))
+			if (!OnElement(Next))
 			{
-				continue;
+				return false;
+			}
+		}
+		return Next == EJsonNotation::ArrayEnd;
+	}
+
+	/** Call OnElement with every object element of the array the reader just started, built one at a time */
+	template <typename FunctorType>
+	bool ReadObjectArray(FDialogueJsonReader& Reader, EJsonNotation Notation, FunctorType&& OnObject)
+	{
+		return ReadArray(Reader, Notation, [&Reader, &OnObject](EJsonNotation Element)
+		{
+			TSharedPtr<FJsonValue> Value = ReadValue(Reader, Element);
+			if (!Value.IsValid())
+			{
+				return false;
 			}
 
-			FDialogueVariableNamespaceDef Namespace;
-			(*NamespaceObj)->TryGetStringField(TEXT("name"), Namespace.Name);
-			(*NamespaceObj)->TryGetStringField(TEXT("description"), Namespace.Description);
+			if (const TSharedPtr<FJsonObject>* Object = nullptr; Value->TryGetObject(Object))
+			{
+				OnObject(**Object);
+			}
+			return true;
+		});
+	}
+
+	void ParseProject(const FJsonObject& ProjectObj, FDialogueProjectDef& Project)
+	{
+		ProjectObj.TryGetStringField(TEXT("name"), Project.Name);
+		ProjectObj.TryGetStringField(TEXT("technicalName"), Project.TechnicalName);
+		ProjectObj.TryGetStringField(TEXT("guid"), Project.Guid);
+	}
+
+	FDialogueVariableNamespaceDef ParseVariableNamespace(const FJsonObject& NamespaceObj)
+	{
+		FDialogueVariableNamespaceDef Namespace;
+		NamespaceObj.TryGetStringField(TEXT("name"), Namespace.Name);
+		NamespaceObj.TryGetStringField(TEXT("description"), Namespace.Description);
 
-			if (const TArray<TSharedPtr<FJsonValue>>* VarsArray = nullptr; (*NamespaceObj)->TryGetArrayField(TEXT("variables"), VarsArray))
+		if (const TArray<TSharedPtr<FJsonValue>>* VarsArray = nullptr; NamespaceObj.TryGetArrayField(TEXT("variables"), VarsArray))
+		{
+			for (const TSharedPtr<FJsonValue>& VarValue : *VarsArray)
 			{
-				for (const TSharedPtr<FJsonValue>& VarValue : *VarsArray)
+				const TSharedPtr<FJsonObject>* VarObj = nullptr;
+				if (!VarValue->TryGetObject(VarObj))
+				{
+					continue;
+				}
+
+				FDialogueVariableDef Variable;
+				(*VarObj)->TryGetStringField(TEXT("name"), Variable.Name);
+				(*VarObj)->TryGetStringField(TEXT("type"), Variable.Type);
+				(*VarObj)->TryGetStringField(TEXT("description"), Variable.Description);
+
+				// Get default value as string
+				if (const TSharedPtr<FJsonValue> DefaultValue = (*VarObj)->TryGetField(TEXT("defaultValue")); DefaultValue.IsValid())
 				{
-					const TSharedPtr<FJsonObject>* VarObj = nullptr;
-					if (!VarValue->TryGetObject(VarObj))
+					if (DefaultValue->Type == EJson::Boolean)
+					{
+						Variable.DefaultValue = DefaultValue->AsBool() ? TEXT("true") : TEXT("false");
+					}
+					else if (DefaultValue->Type == EJson::Number)
 					{
-						continue;
+						Variable.DefaultValue = FString::Printf(TEXT("%d"), (int32)DefaultValue->AsNumber());
 					}
+					else if (DefaultValue->Type == EJson::String)
+					{
+						Variable.DefaultValue = DefaultValue->AsString();
+					}
+				}
+
+				Namespace.Variables.Add(Variable);
+			}
+		}
+
+		return Namespace;
+	}
 
-					FDialogueVariableDef Variable;
-					(*VarObj)->TryGetStringField(TEXT("name"), Variable.Name);
-					(*VarObj)->TryGetStringField(TEXT("type"), Variable.Type);
-					(*VarObj)->TryGetStringField(TEXT("description"), Variable.Description);
+	FDialogueCharacterDef ParseCharacter(const FJsonObject& CharObj)
+	{
+		FDialogueCharacterDef Character;
+		CharObj.TryGetStringField(TEXT("id"), Character.Id);
+		CharObj.TryGetStringField(TEXT("technicalName"), Character.TechnicalName);
+		CharObj.TryGetStringField(TEXT("displayName"), Character.DisplayName);
+		CharObj.TryGetStringField(TEXT("color"), Character.Color);
+		return Character;
+	}
 
-					// Get default value as string
-					if (const TSharedPtr<FJsonValue>* DefaultValue = nullptr; (*VarObj)->TryGetField(TEXT("defaultValue"), *DefaultValue))
+	void ParsePinIds(const FJsonObject& ObjObj, const TCHAR* Field, TArray<FString>& OutPinIds)
+	{
+		if (const TArray<TSharedPtr<FJsonValue>>* PinsArray = nullptr; ObjObj.TryGetArrayField(Field, PinsArray))
+		{
+			for (const TSharedPtr<FJsonValue>& PinValue : *PinsArray)
+			{
+				const TSharedPtr<FJsonObject>* PinObj = nullptr;
+				if (PinValue->TryGetObject(PinObj))
+				{
+					FString PinId;
+					if ((*PinObj)->TryGetStringField(TEXT("id"), PinId))
 					{
-						if ((*DefaultValue)->Type == EJson::Boolean)
-						{
-							Variable.DefaultValue = (*DefaultValue)->AsBool() ? TEXT("true") : TEXT("false");
-						}
-						else if ((*DefaultValue)->Type == EJson::Number)
-						{
-							Variable.DefaultValue = FString::Printf(TEXT("%d"), (int32)(*DefaultValue)->AsNumber());
-						}
-						else if ((*DefaultValue)->Type == EJson::String)
-						{
-							Variable.DefaultValue = (*DefaultValue)->AsString();
-						}
+						OutPinIds.Add(PinId);
 					}
+				}
+			}
+		}
+	}
 
-					Namespace.Variables.Add(Variable);
+	uint32 HashJsonObject(const FJsonObject& Object, uint32 Crc);
+
+	uint32 HashJsonValue(const FJsonValue& Value, uint32 Crc)
+	{
+		Crc = FCrc::MemCrc32(&Value.Type, sizeof(Value.Type), Crc);
+		switch (Value.Type)
+		{
+		case EJson::String:
+			return FCrc::StrCrc32(*Value.AsString(), Crc);
+		case EJson::Number:
+		{
+			const double Number = Value.AsNumber();
+			return FCrc::MemCrc32(&Number, sizeof(Number), Crc);
+		}
+		case EJson::Boolean:
+		{
+			const bool bValue = Value.AsBool();
+			return FCrc::MemCrc32(&bValue, sizeof(bValue), Crc);
+		}
+		case EJson::Array:
+			for (const TSharedPtr<FJsonValue>& Element : Value.AsArray())
+			{
+				Crc = HashJsonValue(*Element, Crc);
+			}
+			return Crc;
+		case EJson::Object:
+			return HashJsonObject(*Value.AsObject(), Crc);
+		default:
+			return Crc;
+		}
+	}
+
+	/** Hash of an object's fields and values, without formatting it as text first */
+	uint32 HashJsonObject(const FJsonObject& Object, uint32 Crc)
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object.Values)
+		{
+			Crc = FCrc::StrCrc32(*Field.Key, Crc);
+			if (Field.Value.IsValid())
+			{
+				Crc = HashJsonValue(*Field.Value, Crc);
+			}
+		}
+		return Crc;
+	}
+
+	FDialogueObjectDef ParseObject(const FJsonObject& ObjObj)
+	{
+		FDialogueObjectDef Object;
+		ObjObj.TryGetStringField(TEXT("id"), Object.Id);
+		ObjObj.TryGetStringField(TEXT("technicalName"), Object.TechnicalName);
+		ObjObj.TryGetStringField(TEXT("type"), Object.Type);
+
+		// Only the typed values are kept, the JSON is released with the object
+		const TSharedPtr<FJsonObject>* PropsObj = nullptr;
+		const TSharedPtr<FJsonObject>* Data = nullptr;
+		if (ObjObj.TryGetObjectField(TEXT("properties"), PropsObj) && (*PropsObj)->TryGetObjectField(TEXT("data"), Data))
+		{
+			FDialogueObjectPropertiesDef& Properties = Object.Properties;
+			(*Data)->TryGetStringField(TEXT("speaker"), Properties.Speaker);
+			(*Data)->TryGetStringField(TEXT("text"), Properties.Text);
+			(*Data)->TryGetStringField(TEXT("menuText"), Properties.MenuText);
+			(*Data)->TryGetBoolField(TEXT("autoTransition"), Properties.bAutoTransition);
+			(*Data)->TryGetStringField(TEXT("targetNodeId"), Properties.TargetNodeId);
+			(*Data)->TryGetNumberField(TEXT("targetPinIndex"), Properties.TargetPinIndex);
+			(*Data)->TryGetStringField(TEXT("displayName"), Properties.DisplayName);
+
+			if (const TSharedPtr<FJsonObject>* Script = nullptr; (*Data)->TryGetObjectField(TEXT("script"), Script))
+			{
+				(*Script)->TryGetStringField(TEXT("expression"), Properties.ScriptExpression);
+			}
+		}
+
+		ParsePinIds(ObjObj, TEXT("inputPins"), Object.InputPinIds);
+		ParsePinIds(ObjObj, TEXT("outputPins"), Object.OutputPinIds);
+		Object.ContentHash = HashJsonObject(ObjObj, 0);
+		return Object;
+	}
+
+	FDialogueConnectionDef ParseConnection(const FJsonObject& ConnObj)
+	{
+		FDialogueConnectionDef Connection;
+		ConnObj.TryGetStringField(TEXT("id"), Connection.Id);
+		ConnObj.TryGetStringField(TEXT("sourceId"), Connection.SourceId);
+		ConnObj.TryGetNumberField(TEXT("sourcePin"), Connection.SourcePin);
+		ConnObj.TryGetStringField(TEXT("targetId"), Connection.TargetId);
+		ConnObj.TryGetNumberField(TEXT("targetPin"), Connection.TargetPin);
+		return Connection;
+	}
+
+	/** Read a package object field by field, building only one object or connection at a time */
+	bool ReadPackage(FDialogueJsonReader& Reader, FDialoguePackageDef& Package)
+	{
+		EJsonNotation Notation;
+		while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+		{
+			const FString Field = Reader.GetIdentifier();
+			if (Field == TEXT("name") && Notation == EJsonNotation::String)
+			{
+				Package.Name = Reader.GetValueAsString();
+			}
+			else if (Field == TEXT("isDefaultPackage") && Notation == EJsonNotation::Boolean)
+			{
+				Package.bIsDefaultPackage = Reader.GetValueAsBoolean();
+			}
+			else if (Field == TEXT("objects"))
+			{
+				if (!ReadObjectArray(Reader, Notation, [&Package](const FJsonObject& ObjObj) { Package.Objects.Add(ParseObject(ObjObj)); }))
+				{
+					return false;
+				}
+			}
+			else if (Field == TEXT("connections"))
+			{
+				if (!ReadObjectArray(Reader, Notation, [&Package](const FJsonObject& ConnObj) { Package.Connections.Add(ParseConnection(ConnObj)); }))
+				{
+					return false;
 				}
 			}
+			else if (!SkipValue(Reader, Notation))
+			{
+				return false;
+			}
+		}
+		return Notation == EJsonNotation::ObjectEnd;
+	}
+}
+
+bool UDialogueImportData::ImportFromJson(const TSharedPtr<FJsonObject>& JsonData)
+{
+	if (!JsonData.IsValid())
+	{
+		return false;
+	}
+
+	// Parse format version
+	FString FormatVersion;
+	JsonData->TryGetStringField(TEXT("formatVersion"), FormatVersion);
+	UE_LOG(LogDialogueEditor, Log, TEXT("Importing dialogue format version: %s"), *FormatVersion);
+
+	// Parse project info
+	if (const TSharedPtr<FJsonObject>* ProjectObj = nullptr; JsonData->TryGetObjectField(TEXT("project"), ProjectObj))
+	{
+		ParseProject(**ProjectObj, Project);
+	}
 
-			GlobalVariables.Add(Namespace);
+	// Parse global variables
+	GlobalVariables.Empty();
+	if (const TArray<TSharedPtr<FJsonValue>>* VariablesArray = nullptr; JsonData->TryGetArrayField(TEXT("globalVariables"), VariablesArray))
+	{
+		for (const TSharedPtr<FJsonValue>& NamespaceValue : *VariablesArray)
+		{
+			if (const TSharedPtr<FJsonObject>* NamespaceObj = nullptr; NamespaceValue->TryGetObject(NamespaceObj))
+			{
+				GlobalVariables.Add(ParseVariableNamespace(**NamespaceObj));
+			}
 		}
 	}
 
@@ -87,19 +553,10 @@ bool UDialogueImportData::ImportFromJson(const TSharedPtr<FJsonObject>& JsonData
 	{
 		for (const TSharedPtr<FJsonValue>& CharValue : *CharactersArray)
 		{
-			const TSharedPtr<FJsonObject>* CharObj = nullptr;
-			if (!CharValue->TryGetObject(CharObj))
+			if (const TSharedPtr<FJsonObject>* CharObj = nullptr; CharValue->TryGetObject(CharObj))
 			{
-				continue;
+				Characters.Add(ParseCharacter(**CharObj));
 			}
-
-			FDialogueCharacterDef Character;
-			(*CharObj)->TryGetStringField(TEXT("id"), Character.Id);
-			(*CharObj)->TryGetStringField(TEXT("technicalName"), Character.TechnicalName);
-			(*CharObj)->TryGetStringField(TEXT("displayName"), Character.DisplayName);
-			(*CharObj)->TryGetStringField(TEXT("color"), Character.Color);
-
-			Characters.Add(Character);
 		}
 	}
 
@@ -115,7 +572,7 @@ bool UDialogueImportData::ImportFromJson(const TSharedPtr<FJsonObject>& JsonData
 				continue;
 			}
 
-			FDialoguePackageDef Package;
+			FDialoguePackageDef& Package = Packages.AddDefaulted_GetRef();
 			(*PackageObj)->TryGetStringField(TEXT("name"), Package.Name);
 			(*PackageObj)->TryGetBoolField(TEXT("isDefaultPackage"), Package.bIsDefaultPackage);
 
@@ -124,58 +581,10 @@ bool UDialogueImportData::ImportFromJson(const TSharedPtr<FJsonObject>& JsonData
 			{
 				for (const TSharedPtr<FJsonValue>& ObjValue : *ObjectsArray)
 				{
-					const TSharedPtr<FJsonObject>* ObjObj = nullptr;
-					if (!ObjValue->TryGetObject(ObjObj))
+					if (const TSharedPtr<FJsonObject>* ObjObj = nullptr; ObjValue->TryGetObject(ObjObj))
 					{
-						continue;
+						Package.Objects.Add(ParseObject(**ObjObj));
 					}
-
-					FDialogueObjectDef Object;
-					(*ObjObj)->TryGetStringField(TEXT("id"), Object.Id);
-					(*ObjObj)->TryGetStringField(TEXT("technicalName"), Object.TechnicalName);
-					(*ObjObj)->TryGetStringField(TEXT("type"), Object.Type);
-
-					// Store properties as-is for later processing
-					if (const TSharedPtr<FJsonObject>* PropsObj = nullptr; (*ObjObj)->TryGetObjectField(TEXT("properties"), PropsObj))
-					{
-						Object.Properties = *PropsObj;
-					}
-
-					// Parse input pins
-					if (const TArray<TSharedPtr<FJsonValue>>* InputPinsArray = nullptr; (*ObjObj)->TryGetArrayField(TEXT("inputPins"), InputPinsArray))
-					{
-						for (const TSharedPtr<FJsonValue>& PinValue : *InputPinsArray)
-						{
-							const TSharedPtr<FJsonObject>* PinObj = nullptr;
-							if (PinValue->TryGetObject(PinObj))
-							{
-								FString PinId;
-								if ((*PinObj)->TryGetStringField(TEXT("id"), PinId))
-								{
-									Object.InputPinIds.Add(PinId);
-								}
-							}
-						}
-					}
-
-					// Parse output pins
-					if (const TArray<TSharedPtr<FJsonValue>>* OutputPinsArray = nullptr; (*ObjObj)->TryGetArrayField(TEXT("outputPins"), OutputPinsArray))
-					{
-						for (const TSharedPtr<FJsonValue>& PinValue : *OutputPinsArray)
-						{
-							const TSharedPtr<FJsonObject>* PinObj = nullptr;
-							if (PinValue->TryGetObject(PinObj))
-							{
-								FString PinId;
-								if ((*PinObj)->TryGetStringField(TEXT("id"), PinId))
-								{
-									Object.OutputPinIds.Add(PinId);
-								}
-							}
-						}
-					}
-
-					Package.Objects.Add(Object);
 				}
 			}
 
@@ -184,29 +593,163 @@ bool UDialogueImportData::ImportFromJson(const TSharedPtr<FJsonObject>& JsonData
 			{
 				for (const TSharedPtr<FJsonValue>& ConnValue : *ConnectionsArray)
 				{
-					const TSharedPtr<FJsonObject>* ConnObj = nullptr;
-					if (!ConnValue->TryGetObject(ConnObj))
+					if (const TSharedPtr<FJsonObject>* ConnObj = nullptr; ConnValue->TryGetObject(ConnObj))
 					{
-						continue;
+						Package.Connections.Add(ParseConnection(**ConnObj));
 					}
-
-					FDialogueConnectionDef Connection;
-					(*ConnObj)->TryGetStringField(TEXT("id"), Connection.Id);
-					(*ConnObj)->TryGetStringField(TEXT("sourceId"), Connection.SourceId);
-					(*ConnObj)->TryGetNumberField(TEXT("sourcePin"), Connection.SourcePin);
-					(*ConnObj)->TryGetStringField(TEXT("targetId"), Connection.TargetId);
-					(*ConnObj)->TryGetNumberField(TEXT("targetPin"), Connection.TargetPin);
-
-					Package.Connections.Add(Connection);
 				}
 			}
+		}
+	}
+
+	UE_LOG(LogDialogueEditor, Log, TEXT("Imported project '%s': %d namespaces, %d characters, %d packages"),
+		*Project.Name, GlobalVariables.Num(), Characters.Num(), Packages.Num());
+
+	return true;
+}
+
+bool UDialogueImportData::ImportFromJsonFile(const FString& Filename, FDialogueImportStats* Stats, FDialogueImportProgress* Progress)
+{
+	TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*Filename));
+	if (!FileReader)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to read file: %s"), *Filename);
+		return false;
+	}
+
+	// UTF-16 exports are rare, they still go through the string and the DOM
+	uint8 Bom[2] = { 0, 0 };
+	if (FileReader->TotalSize() >= 2)
+	{
+		FileReader->Serialize(Bom, 2);
+		FileReader->Seek(0);
+	}
+	const int64 FileSize = FileReader->TotalSize();
+	if (Progress)
+	{
+		Progress->TotalBytes.store(FileSize, std::memory_order_relaxed);
+	}
+
+	if ((Bom[0] == 0xFF && Bom[1] == 0xFE) || (Bom[0] == 0xFE && Bom[1] == 0xFF))
+	{
+		FileReader.Reset();
+
+		FString FileContent;
+		bool bLoaded;
+		{
+			FDialogueImportStageScope ReadScope(Stats, TEXT("Read"));
+			bLoaded = FFileHelper::LoadFileToString(FileContent, *Filename);
+		}
 
-			Packages.Add(Package);
+		FDialogueImportStageScope ParseScope(Stats, TEXT("Parse"));
+		TSharedPtr<FJsonObject> JsonObject;
+		if (!bLoaded || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FileContent), JsonObject))
+		{
+			UE_LOG(LogDialogueEditor, Error, TEXT("Failed to parse JSON from: %s"), *Filename);
+			return false;
+		}
+
+		if (!ImportFromJson(JsonObject))
+		{
+			return false;
 		}
+		CountImport(Stats, Packages, FileSize);
+		return true;
 	}
 
+	const double StartTime = FPlatformTime::Seconds();
+	const uint64 StartMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+	FDialogueUtf8Archive Utf8Reader(*FileReader, Progress);
+	TSharedRef<FDialogueJsonReader> Reader = TJsonReaderFactory<TCHAR>::Create(&Utf8Reader);
+
+	FString FormatVersion;
+	GlobalVariables.Empty();
+	Characters.Empty();
+	Packages.Empty();
+
+	EJsonNotation Notation;
+	bool bSuccess = Reader->ReadNext(Notation) && Notation == EJsonNotation::ObjectStart;
+	while (bSuccess && Reader->ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+	{
+		const FString Field = Reader->GetIdentifier();
+		if (Field == TEXT("formatVersion") && Notation == EJsonNotation::String)
+		{
+			FormatVersion = Reader->GetValueAsString();
+			UE_LOG(LogDialogueEditor, Log, TEXT("Importing dialogue format version: %s"), *FormatVersion);
+		}
+		else if (Field == TEXT("project"))
+		{
+			const TSharedPtr<FJsonValue> Value = ReadValue(*Reader, Notation);
+			bSuccess = Value.IsValid();
+			if (const TSharedPtr<FJsonObject>* ProjectObj = nullptr; bSuccess && Value->TryGetObject(ProjectObj))
+			{
+				ParseProject(**ProjectObj, Project);
+			}
+		}
+		else if (Field == TEXT("globalVariables"))
+		{
+			bSuccess = ReadObjectArray(*Reader, Notation, [this](const FJsonObject& NamespaceObj) { GlobalVariables.Add(ParseVariableNamespace(NamespaceObj)); });
+		}
+		else if (Field == TEXT("characters"))
+		{
+			bSuccess = ReadObjectArray(*Reader, Notation, [this](const FJsonObject& CharObj) { Characters.Add(ParseCharacter(CharObj)); });
+		}
+		else if (Field == TEXT("packages"))
+		{
+			bSuccess = ReadArray(*Reader, Notation, [this, &Reader](EJsonNotation Element)
+			{
+				if (Element != EJsonNotation::ObjectStart)
+				{
+					return SkipValue(*Reader, Element);
+				}
+				return ReadPackage(*Reader, Packages.AddDefaulted_GetRef());
+			});
+		}
+		else
+		{
+			bSuccess = SkipValue(*Reader, Notation);
+		}
+	}
+
+	if (Progress && Progress->IsCancelRequested())
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("Import of %s was cancelled"), *Filename);
+		return false;
+	}
+
+	if (!bSuccess || Notation != EJsonNotation::ObjectEnd || Utf8Reader.IsError())
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to parse JSON from: %s (line %d: %s)"),
+			*Filename, Reader->GetLineNumber(), *Reader->GetErrorMessage());
+		return false;
+	}
+
+	// Reading and parsing are interleaved, the file reads are timed on their own
+	if (Stats)
+	{
+		const double ReadSeconds = Utf8Reader.GetReadSeconds();
+		Stats->Add(TEXT("Read"), ReadSeconds);
+		Stats->Add(TEXT("Parse"), FPlatformTime::Seconds() - StartTime - ReadSeconds,
+			(int64)FPlatformMemory::GetStats().UsedPhysical - (int64)StartMemory);
+	}
+	CountImport(Stats, Packages, FileSize);
+
 	UE_LOG(LogDialogueEditor, Log, TEXT("Imported project '%s': %d namespaces, %d characters, %d packages"),
 		*Project.Name, GlobalVariables.Num(), Characters.Num(), Packages.Num());
 
 	return true;
 }
+
+bool UDialogueImportData::ImportFromFile(const FString& Filename, FDialogueImportStats* Stats, FDialogueImportProgress* Progress)
+{
+	return IsBinaryFile(Filename) ? ImportFromBinaryFile(Filename, Stats, Progress) : ImportFromJsonFile(Filename, Stats, Progress);
+}
+
+void UDialogueImportData::TakeParsedData(UDialogueImportData& Source)
+{
+	Project = MoveTemp(Source.Project);
+	GlobalVariables = MoveTemp(Source.GlobalVariables);
+	Characters = MoveTemp(Source.Characters);
+	Packages = MoveTemp(Source.Packages);
+}
@@ -0,0 +1,161 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueImportStats.h"
+#include "DialogueEditorModule.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(DialogueImportChannel);
+
+TRACE_DECLARE_MEMORY_COUNTER(DialogueImportBytesRead, TEXT("DialogueImport/BytesRead"));
+TRACE_DECLARE_INT_COUNTER(DialogueImportObjectsParsed, TEXT("DialogueImport/ObjectsParsed"));
+TRACE_DECLARE_INT_COUNTER(DialogueImportScriptsCompiled, TEXT("DialogueImport/ScriptsCompiled"));
+TRACE_DECLARE_INT_COUNTER(DialogueImportAssetsSaved, TEXT("DialogueImport/AssetsSaved"));
+
+namespace
+{
+	/** Files may be imported in parallel, the trace counters are shared between them */
+	FCriticalSection TraceCountersLock;
+}
+
+void FDialogueImportStats::Add(const TCHAR* Stage, double Seconds, int64 MemoryDelta)
+{
+	FStage* Found = Stages.FindByPredicate([Stage](const FStage& Existing) { return Existing.Name == Stage; });
+	if (!Found)
+	{
+		Found = &Stages.AddDefaulted_GetRef();
+		Found->Name = Stage;
+	}
+
+	Found->Seconds += Seconds;
+	Found->MemoryDelta += MemoryDelta;
+	Found->PeakMemory = FPlatformMemory::GetStats().PeakUsedPhysical;
+	++Found->Count;
+}
+
+void FDialogueImportStats::AddCount(ECounter Counter, int64 Delta)
+{
+	Counters[(int32)Counter] += Delta;
+
+	FScopeLock Lock(&TraceCountersLock);
+	switch (Counter)
+	{
+	case ECounter::BytesRead:
+		TRACE_COUNTER_ADD(DialogueImportBytesRead, Delta);
+		break;
+	case ECounter::ObjectsParsed:
+		TRACE_COUNTER_ADD(DialogueImportObjectsParsed, Delta);
+		break;
+	case ECounter::ScriptsCompiled:
+		TRACE_COUNTER_ADD(DialogueImportScriptsCompiled, Delta);
+		break;
+	case ECounter::AssetsSaved:
+		TRACE_COUNTER_ADD(DialogueImportAssetsSaved, Delta);
+		break;
+	default:
+		break;
+	}
+}
+
+double FDialogueImportStats::GetTotalSeconds() const
+{
+	double Total = 0.0;
+	for (const FStage& Stage : Stages)
+	{
+		Total += Stage.Seconds;
+	}
+	return Total;
+}
+
+TSharedRef<FJsonObject> FDialogueImportStats::ToJson() const
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	for (const FStage& Stage : Stages)
+	{
+		TSharedRef<FJsonObject> StageJson = MakeShared<FJsonObject>();
+		StageJson->SetNumberField(TEXT("seconds"), Stage.Seconds);
+		StageJson->SetNumberField(TEXT("memoryDelta"), (double)Stage.MemoryDelta);
+		StageJson->SetNumberField(TEXT("peakMemory"), (double)Stage.PeakMemory);
+		StageJson->SetNumberField(TEXT("count"), Stage.Count);
+		Json->SetObjectField(Stage.Name, StageJson);
+	}
+
+	TSharedRef<FJsonObject> CountersJson = MakeShared<FJsonObject>();
+	for (int32 i = 0; i < (int32)ECounter::Num; ++i)
+	{
+		CountersJson->SetNumberField(GetCounterName((ECounter)i), (double)Counters[i]);
+	}
+	Json->SetObjectField(TEXT("counters"), CountersJson);
+	return Json;
+}
+
+void FDialogueImportStats::LogSummary(const FString& Source) const
+{
+	UE_LOG(LogDialogueEditor, Display, TEXT("Import of %s took %.3fs"), *Source, GetTotalSeconds());
+	for (const FStage& Stage : Stages)
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("    %-16s %8.3fs %+10.1fMB peak=%.1fMB x%d"), *Stage.Name, Stage.Seconds,
+			Stage.MemoryDelta / (1024.0 * 1024.0), Stage.PeakMemory / (1024.0 * 1024.0), Stage.Count);
+	}
+	for (int32 i = 0; i < (int32)ECounter::Num; ++i)
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("    %-16s %lld"), GetCounterName((ECounter)i), Counters[i]);
+	}
+}
+
+const TCHAR* FDialogueImportStats::GetCounterName(ECounter Counter)
+{
+	switch (Counter)
+	{
+	case ECounter::BytesRead:
+		return TEXT("bytesRead");
+	case ECounter::ObjectsParsed:
+		return TEXT("objectsParsed");
+	case ECounter::ScriptsCompiled:
+		return TEXT("scriptsCompiled");
+	case ECounter::AssetsSaved:
+		return TEXT("assetsSaved");
+	default:
+		return TEXT("");
+	}
+}
+
+FDialogueImportStageScope::FDialogueImportStageScope(FDialogueImportStats* InStats, const TCHAR* InStage)
+	: Stats(InStats)
+	, Stage(InStage)
+{
+#if CPUPROFILERTRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(DialogueImportChannel))
+	{
+		FCpuProfilerTrace::OutputBeginDynamicEvent(Stage);
+		bTraced = true;
+	}
+#endif
+
+	if (Stats)
+	{
+		StartMemory = FPlatformMemory::GetStats().UsedPhysical;
+		StartTime = FPlatformTime::Seconds();
+	}
+}
+
+FDialogueImportStageScope::~FDialogueImportStageScope()
+{
+	if (Stats)
+	{
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		const int64 MemoryDelta = (int64)FPlatformMemory::GetStats().UsedPhysical - (int64)StartMemory;
+		Stats->Add(Stage, Seconds, MemoryDelta);
+	}
+
+#if CPUPROFILERTRACE_ENABLED
+	if (bTraced)
+	{
+		FCpuProfilerTrace::OutputEndEvent();
+	}
+#endif
+}
@@ -1,12 +1,12 @@
 // Copyright Dialogue Editor Team. All Rights Reserved.
 
 #include "DialogueJSONFactory.h"
+#include "DialogueBinaryFormat.h"
 #include "DialogueImportData.h"
 #include "DialogueAssetGenerator.h"
 #include "DialogueEditorModule.h"
-#include "Misc/FileHelper.h"
-#include "Serialization/JsonReader.h"
-#include "Serialization/JsonSerializer.h"
+#include "DialogueImportStats.h"
+#include "DialogueAsyncImport.h"
 #include "EditorFramework/AssetImportData.h"
 
 #define LOCTEXT_NAMESPACE "DialogueJSONFactory"
@@ -20,13 +20,15 @@ UDialogueJSONFactory::UDialogueJSONFactory()
 
 	Formats.Add(TEXT("json;Dialogue JSON File"));
 	Formats.Add(TEXT("dialogue;Dialogue Export File"));
+	Formats.Add(FString::Printf(TEXT("%s;Dialogue Binary Export"), DialogueBinaryFormat::Extension));
 }
 
 bool UDialogueJSONFactory::FactoryCanImport(const FString& Filename)
 {
 	const FString Extension = FPaths::GetExtension(Filename);
 	return Extension.Equals(TEXT("json"), ESearchCase::IgnoreCase) ||
-	       Extension.Equals(TEXT("dialogue"), ESearchCase::IgnoreCase);
+	       Extension.Equals(TEXT("dialogue"), ESearchCase::IgnoreCase) ||
+	       Extension.Equals(DialogueBinaryFormat::Extension, ESearchCase::IgnoreCase);
 }
 
 UClass* UDialogueJSONFactory::ResolveSupportedClass()
@@ -46,7 +48,16 @@ UObject* UDialogueJSONFactory::FactoryCreateFile(
 {
 	UDialogueImportData* ImportData = NewObject<UDialogueImportData>(InParent, InName, Flags);
 
-	if (!ImportFromFile(Filename, ImportData))
+	// The asset exists right away, its data and the generated assets follow once the file is parsed
+	if (ShouldImportAsync())
+	{
+		ImportData->SourceFilePath = Filename;
+		FDialogueAsyncImport::Start(ImportData, Filename);
+		return ImportData;
+	}
+
+	FDialogueImportStats Stats;
+	if (!ImportFromFile(Filename, ImportData, &Stats))
 	{
 		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to import dialogue from: %s"), *Filename);
 		bOutOperationCanceled = true;
@@ -57,46 +68,29 @@ UObject* UDialogueJSONFactory::FactoryCreateFile(
 	ImportData->ImportTimestamp = FDateTime::Now();
 
 	// Process and generate assets
-	if (!ProcessImportData(ImportData))
+	if (!ProcessImportData(ImportData, &Stats))
 	{
 		UE_LOG(LogDialogueEditor, Warning, TEXT("Asset generation had issues for: %s"), *Filename);
 	}
+	Stats.LogSummary(Filename);
 
 	UE_LOG(LogDialogueEditor, Log, TEXT("Successfully imported dialogue from: %s"), *Filename);
 
 	return ImportData;
 }
 
-bool UDialogueJSONFactory::ImportFromFile(const FString& Filename, UDialogueImportData* ImportData)
+bool UDialogueJSONFactory::ImportFromFile(const FString& Filename, UDialogueImportData* ImportData, FDialogueImportStats* Stats)
 {
 	if (!ImportData)
 	{
 		return false;
 	}
 
-	// Read file content
-	FString FileContent;
-	if (!FFileHelper::LoadFileToString(FileContent, *Filename))
-	{
-		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to read file: %s"), *Filename);
-		return false;
-	}
-
-	// Parse JSON
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(FileContent);
-
-	if (!FJsonSerializer::Deserialize(JsonReader, JsonObject) || !JsonObject.IsValid())
-	{
-		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to parse JSON from: %s"), *Filename);
-		return false;
-	}
-
-	// Import the data
-	return ImportData->ImportFromJson(JsonObject);
+	// JSON is streamed and binary exports are mapped, exports can be far larger than their parsed data
+	return ImportData->ImportFromFile(Filename, Stats);
 }
 
-bool UDialogueJSONFactory::ProcessImportData(UDialogueImportData* ImportData)
+bool UDialogueJSONFactory::ProcessImportData(UDialogueImportData* ImportData, FDialogueImportStats* Stats)
 {
 	if (!ImportData)
 	{
@@ -104,6 +98,7 @@ bool UDialogueJSONFactory::ProcessImportData(UDialogueImportData* ImportData)
 	}
 
 	FDialogueAssetGenerator Generator;
+	Generator.SetStats(Stats);
 	return Generator.GenerateAssets(ImportData);
 }
 
@@ -142,14 +137,24 @@ EReimportResult::Type UDialogueJSONFactory::Reimport(UObject* Obj)
 		return EReimportResult::Failed;
 	}
 
-	if (!ImportFromFile(Filename, ImportData))
+	// Generated assets are updated once the file is parsed, until then everything stays as it is
+	if (ShouldImportAsync())
+	{
+		FDialogueAsyncImport::Start(ImportData, Filename);
+		return EReimportResult::Succeeded;
+	}
+
+	FDialogueImportStats Stats;
+	if (!ImportFromFile(Filename, ImportData, &Stats))
 	{
 		return EReimportResult::Failed;
 	}
 
 	ImportData->ImportTimestamp = FDateTime::Now();
 
-	if (!ProcessImportData(ImportData))
+	const bool bGenerated = ProcessImportData(ImportData, &Stats);
+	Stats.LogSummary(Filename);
+	if (!bGenerated)
 	{
 		return EReimportResult::Succeeded; // Partial success
 	}
@@ -157,4 +162,10 @@ EReimportResult::Type UDialogueJSONFactory::Reimport(UObject* Obj)
 	return EReimportResult::Succeeded;
 }
 
+bool UDialogueJSONFactory::ShouldImportAsync() const
+{
+	// Scripts and commandlets expect the assets to be there when the import returns
+	return GIsEditor && !IsRunningCommandlet() && !GIsRunningUnattendedScript && !IsAutomatedImport();
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,217 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueNativeScriptGenerator.h"
+#include "DialogueTypes.h"
+#include "DialogueScripts.h"
+#include "DialogueScriptVM.h"
+#include "DialogueEditorModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	FString Register(int32 Index)
+	{
+		return FString::Printf(TEXT("R[%d]"), Index);
+	}
+
+	/** Expression as a one-line comment */
+	FString CommentExpression(const FString& Expression)
+	{
+		FString Line = Expression.Replace(TEXT("\r"), TEXT(" ")).Replace(TEXT("\n"), TEXT(" "));
+		return TEXT("// ") + Line.TrimStartAndEnd();
+	}
+}
+
+FString FDialogueNativeScriptGenerator::GenerateFunctionBody(const FDialogueScriptProgram& Program)
+{
+	using namespace DialogueScript;
+
+	const int32 NumInstructions = Program.Code.Num();
+
+	// Only jump targets get a label, unused labels would warn
+	TSet<int32> Labels;
+	for (const uint32 I : Program.Code)
+	{
+		const EDialogueScriptOp Op = GetOp(I);
+		if (Op == EDialogueScriptOp::Jump || Op == EDialogueScriptOp::JumpIfFalse || Op == EDialogueScriptOp::JumpIfTrue)
+		{
+			Labels.Add(GetBx(I));
+		}
+	}
+
+	FString Body;
+	Body += FString::Printf(TEXT("\tFDialogueScriptValue R[%d];\n"), FMath::Max<int32>(Program.NumRegisters, 1));
+
+	for (int32 PC = 0; PC < NumInstructions; ++PC)
+	{
+		if (Labels.Contains(PC))
+		{
+			Body += FString::Printf(TEXT("L%d:\n"), PC);
+		}
+
+		const uint32 I = Program.Code[PC];
+		const FString A = Register(GetA(I));
+		const FString B = Register(GetB(I));
+		const FString C = Register(GetC(I));
+
+		FString Statement;
+		switch (GetOp(I))
+		{
+		case EDialogueScriptOp::LoadInt:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(%d);"), *A, Program.IntConstants[GetBx(I)]);
+			break;
+		case EDialogueScriptOp::LoadBool:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(%s);"), *A, GetB(I) != 0 ? TEXT("true") : TEXT("false"));
+			break;
+		case EDialogueScriptOp::LoadString:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeString(Context.GetString(%d));"), *A, GetBx(I));
+			break;
+		case EDialogueScriptOp::LoadVar:
+			Statement = FString::Printf(TEXT("%s = Context.ReadVariable(%d);"), *A, GetBx(I));
+			break;
+		case EDialogueScriptOp::StoreVar:
+			Statement = FString::Printf(TEXT("Context.WriteVariable(%d, %s);"), GetBx(I), *A);
+			break;
+		case EDialogueScriptOp::Move:
+			Statement = FString::Printf(TEXT("%s = %s;"), *A, *B);
+			break;
+		case EDialogueScriptOp::Not:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(!%s.AsBool());"), *A, *B);
+			break;
+		case EDialogueScriptOp::Negate:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(-%s.AsInt());"), *A, *B);
+			break;
+		case EDialogueScriptOp::Add:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(%s.AsInt() + %s.AsInt());"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Subtract:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(%s.AsInt() - %s.AsInt());"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Multiply:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(%s.AsInt() * %s.AsInt());"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Divide:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(DialogueScript::Divide(%s.AsInt(), %s.AsInt()));"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Modulo:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeInt(DialogueScript::Modulo(%s.AsInt(), %s.AsInt()));"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Equal:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(DialogueScript::ValuesEqual(%s, %s));"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::NotEqual:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(!DialogueScript::ValuesEqual(%s, %s));"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Less:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(DialogueScript::CompareValues(%s, %s) < 0);"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::LessEqual:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(DialogueScript::CompareValues(%s, %s) <= 0);"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::Greater:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(DialogueScript::CompareValues(%s, %s) > 0);"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::GreaterEqual:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(DialogueScript::CompareValues(%s, %s) >= 0);"), *A, *B, *C);
+			break;
+		case EDialogueScriptOp::ToBool:
+			Statement = FString::Printf(TEXT("%s = FDialogueScriptValue::MakeBool(%s.AsBool());"), *A, *B);
+			break;
+		case EDialogueScriptOp::Jump:
+			Statement = FString::Printf(TEXT("goto L%d;"), GetBx(I));
+			break;
+		case EDialogueScriptOp::JumpIfFalse:
+			Statement = FString::Printf(TEXT("if (!%s.AsBool()) { goto L%d; }"), *A, GetBx(I));
+			break;
+		case EDialogueScriptOp::JumpIfTrue:
+			Statement = FString::Printf(TEXT("if (%s.AsBool()) { goto L%d; }"), *A, GetBx(I));
+			break;
+		case EDialogueScriptOp::CallMethod:
+			Statement = FString::Printf(TEXT("%s = Context.CallMethod(%d, &R[%d], %d);"), *A, GetB(I), GetA(I) + 1, GetC(I));
+			break;
+		case EDialogueScriptOp::Return:
+			Statement = FString::Printf(TEXT("return %s;"), *A);
+			break;
+		case EDialogueScriptOp::ReturnNone:
+			Statement = TEXT("return FDialogueScriptValue();");
+			break;
+		default:
+			checkNoEntry();
+			break;
+		}
+
+		Body += TEXT("\t") + Statement + TEXT("\n");
+	}
+
+	// Falling off the end, or jumping past it, returns nothing like the VM
+	const EDialogueScriptOp LastOp = NumInstructions > 0 ? GetOp(Program.Code.Last()) : EDialogueScriptOp::Count;
+	if (Labels.Contains(NumInstructions))
+	{
+		Body += FString::Printf(TEXT("L%d:\n"), NumInstructions);
+		Body += TEXT("\treturn FDialogueScriptValue();\n");
+	}
+	else if (LastOp != EDialogueScriptOp::Return && LastOp != EDialogueScriptOp::ReturnNone)
+	{
+		Body += TEXT("\treturn FDialogueScriptValue();\n");
+	}
+
+	return Body;
+}
+
+bool FDialogueNativeScriptGenerator::WriteScriptsClass(const FString& ClassName, const FString& Directory, const TArray<FDialogueScript>& Scripts)
+{
+	const FString Banner = TEXT("// Generated by the dialogue importer from the bytecode of the project's scripts. Do not edit.\n\n");
+
+	FString Header = Banner;
+	Header += TEXT("#pragma once\n\n");
+	Header += TEXT("#include \"CoreMinimal.h\"\n");
+	Header += TEXT("#include \"DialogueScripts.h\"\n");
+	Header += FString::Printf(TEXT("#include \"%s.generated.h\"\n\n"), *ClassName);
+	Header += TEXT("UCLASS()\n");
+	Header += FString::Printf(TEXT("class U%s : public UDialogueScripts\n"), *ClassName);
+	Header += TEXT("{\n\tGENERATED_BODY()\n\npublic:\n");
+	Header += FString::Printf(TEXT("\tU%s();\n"), *ClassName);
+	Header += TEXT("};\n");
+
+	FString Source = Banner;
+	Source += FString::Printf(TEXT("#include \"%s.h\"\n"), *ClassName);
+	Source += TEXT("#include \"DialogueScriptVM.h\"\n\n");
+	Source += TEXT("namespace\n{\n");
+	for (int32 Index = 0; Index < Scripts.Num(); ++Index)
+	{
+		const FDialogueScript& Script = Scripts[Index];
+		Source += CommentExpression(Script.Expression) + TEXT("\n");
+		Source += FString::Printf(TEXT("FDialogueScriptValue Script%d(const FDialogueScriptContext& Context)\n{\n"), Index);
+		Source += GenerateFunctionBody(Script.Program);
+		Source += TEXT("}\n\n");
+	}
+	Source += TEXT("}\n\n");
+
+	Source += FString::Printf(TEXT("U%s::U%s()\n{\n"), *ClassName, *ClassName);
+	for (int32 Index = 0; Index < Scripts.Num(); ++Index)
+	{
+		Source += FString::Printf(TEXT("\tAddNative(&Script%d, 0x%08xu);\n"), Index, UDialogueScripts::HashScript(Scripts[Index]));
+	}
+	Source += TEXT("}\n");
+
+	const bool bWroteHeader = WriteFileIfChanged(FPaths::Combine(Directory, ClassName + TEXT(".h")), Header);
+	const bool bWroteSource = WriteFileIfChanged(FPaths::Combine(Directory, ClassName + TEXT(".cpp")), Source);
+	return bWroteHeader && bWroteSource;
+}
+
+bool FDialogueNativeScriptGenerator::WriteFileIfChanged(const FString& Filename, const FString& Content)
+{
+	FString Existing;
+	if (FFileHelper::LoadFileToString(Existing, *Filename) && Existing.Equals(Content, ESearchCase::CaseSensitive))
+	{
+		return true;
+	}
+
+	if (!FFileHelper::SaveStringToFile(Content, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to write generated scripts file %s"), *Filename);
+		return false;
+	}
+	return true;
+}
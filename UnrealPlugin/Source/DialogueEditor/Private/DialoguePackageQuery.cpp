@@ -0,0 +1,193 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialoguePackageQuery.h"
+#include "DialogueEditorModule.h"
+#include "DialoguePackage.h"
+#include "AssetRegistry/IAssetRegistry.h"
+
+FDialoguePackageQuery::FDialoguePackageQuery()
+{
+	IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	AddedHandle = AssetRegistry.OnAssetAdded().AddRaw(this, &FDialoguePackageQuery::OnAssetChanged);
+	RemovedHandle = AssetRegistry.OnAssetRemoved().AddRaw(this, &FDialoguePackageQuery::OnAssetChanged);
+	UpdatedHandle = AssetRegistry.OnAssetUpdated().AddRaw(this, &FDialoguePackageQuery::OnAssetChanged);
+	RenamedHandle = AssetRegistry.OnAssetRenamed().AddRaw(this, &FDialoguePackageQuery::OnAssetRenamed);
+}
+
+FDialoguePackageQuery::~FDialoguePackageQuery()
+{
+	if (IAssetRegistry* AssetRegistry = IAssetRegistry::Get())
+	{
+		AssetRegistry->OnAssetAdded().Remove(AddedHandle);
+		AssetRegistry->OnAssetRemoved().Remove(RemovedHandle);
+		AssetRegistry->OnAssetUpdated().Remove(UpdatedHandle);
+		AssetRegistry->OnAssetRenamed().Remove(RenamedHandle);
+	}
+}
+
+FDialoguePackageQuery& FDialoguePackageQuery::Get()
+{
+	return FDialogueEditorModule::Get().GetPackageQuery();
+}
+
+TArray<FAssetData> FDialoguePackageQuery::FindPackagesWithSpeaker(const FDialogueId& SpeakerId)
+{
+	Update();
+
+	TArray<int32> Indices;
+	PackagesBySpeaker.MultiFind(SpeakerId, Indices);
+
+	TArray<FAssetData> Result;
+	Result.Reserve(Indices.Num());
+	for (const int32 Index : Indices)
+	{
+		Result.Add(Packages[Index]);
+	}
+	return Result;
+}
+
+FAssetData FDialoguePackageQuery::FindPackageWithObject(const FDialogueId& Id)
+{
+	Update();
+
+	const int32* Index = PackageByObject.Find(Id);
+	return Index ? Packages[*Index] : FAssetData();
+}
+
+TArray<FAssetData> FDialoguePackageQuery::FindReferencingPackages(FName PackageName)
+{
+	Update();
+
+	TArray<FAssetData> Result;
+	const int32* Target = PackageByName.Find(PackageName);
+	if (!Target)
+	{
+		return Result;
+	}
+
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		bool bReferences = false;
+		ForEachId(Packages[Index], DialoguePackageTags::ExternalTargets, [this, Target, &bReferences](const FDialogueId& Id)
+		{
+			const int32* TargetPackage = PackageByObject.Find(Id);
+			bReferences |= TargetPackage && *TargetPackage == *Target;
+		});
+
+		if (bReferences && Index != *Target)
+		{
+			Result.Add(Packages[Index]);
+		}
+	}
+	return Result;
+}
+
+TArray<FAssetData> FDialoguePackageQuery::FindReferencedPackages(FName PackageName)
+{
+	Update();
+
+	TArray<FAssetData> Result;
+	const int32* Source = PackageByName.Find(PackageName);
+	if (!Source)
+	{
+		return Result;
+	}
+
+	TSet<int32> Referenced;
+	ForEachId(Packages[*Source], DialoguePackageTags::ExternalTargets, [this, &Referenced](const FDialogueId& Id)
+	{
+		if (const int32* TargetPackage = PackageByObject.Find(Id))
+		{
+			Referenced.Add(*TargetPackage);
+		}
+	});
+	Referenced.Remove(*Source);
+
+	for (const int32 Index : Referenced)
+	{
+		Result.Add(Packages[Index]);
+	}
+	return Result;
+}
+
+const TArray<FAssetData>& FDialoguePackageQuery::GetPackages()
+{
+	Update();
+	return Packages;
+}
+
+int64 FDialoguePackageQuery::GetCount(const FAssetData& Package, const TCHAR* Tag)
+{
+	int64 Value = INDEX_NONE;
+	Package.GetTagValue(FName(Tag), Value);
+	return Value;
+}
+
+void FDialoguePackageQuery::ForEachId(const FAssetData& Package, const TCHAR* Tag, TFunctionRef<void(const FDialogueId&)> Function)
+{
+	FString Value;
+	if (!Package.GetTagValue(FName(Tag), Value))
+	{
+		return;
+	}
+
+	FStringView Remaining(Value);
+	while (!Remaining.IsEmpty())
+	{
+		int32 Separator = INDEX_NONE;
+		if (!Remaining.FindChar(TEXT(' '), Separator))
+		{
+			Separator = Remaining.Len();
+		}
+
+		const FDialogueId Id = FDialogueId::FromString(Remaining.Left(Separator));
+		if (Id.IsValid())
+		{
+			Function(Id);
+		}
+		Remaining.RightChopInline(Separator + 1);
+	}
+}
+
+void FDialoguePackageQuery::Update()
+{
+	if (!bDirty)
+	{
+		return;
+	}
+	bDirty = false;
+
+	Packages.Reset();
+	PackageByObject.Reset();
+	PackagesBySpeaker.Reset();
+	PackageByName.Reset();
+
+	IAssetRegistry::GetChecked().GetAssetsByClass(UDialoguePackage::StaticClass()->GetClassPathName(), Packages);
+
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		PackageByName.Add(Packages[Index].PackageName, Index);
+
+		ForEachId(Packages[Index], DialoguePackageTags::ObjectIds, [this, Index](const FDialogueId& Id)
+		{
+			PackageByObject.Add(Id, Index);
+		});
+		ForEachId(Packages[Index], DialoguePackageTags::Speakers, [this, Index](const FDialogueId& Id)
+		{
+			PackagesBySpeaker.Add(Id, Index);
+		});
+	}
+}
+
+void FDialoguePackageQuery::OnAssetChanged(const FAssetData& Asset)
+{
+	if (Asset.AssetClassPath == UDialoguePackage::StaticClass()->GetClassPathName())
+	{
+		bDirty = true;
+	}
+}
+
+void FDialoguePackageQuery::OnAssetRenamed(const FAssetData& Asset, const FString& OldObjectPath)
+{
+	OnAssetChanged(Asset);
+}
@@ -0,0 +1,365 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueScaleBenchmarkCommandlet.h"
+#include "DialogueImportData.h"
+#include "DialogueImportStats.h"
+#include "DialogueAssetGenerator.h"
+#include "DialogueDatabase.h"
+#include "DialoguePackage.h"
+#include "DialogueEditorModule.h"
+#include "HAL/FileManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectHash.h"
+
+namespace
+{
+	/** Appends JSON text and writes it out as UTF-8 whenever enough has been gathered */
+	class FChunkedJsonWriter
+	{
+	public:
+		explicit FChunkedJsonWriter(FArchive& InAr) : Ar(InAr) {}
+		~FChunkedJsonWriter() { Flush(); }
+
+		FChunkedJsonWriter& operator<<(const FString& Text)
+		{
+			Chunk += Text;
+			if (Chunk.Len() >= ChunkSize)
+			{
+				Flush();
+			}
+			return *this;
+		}
+
+		FChunkedJsonWriter& operator<<(const TCHAR* Text)
+		{
+			return *this << FString(Text);
+		}
+
+		void Flush()
+		{
+			FTCHARToUTF8 Utf8(*Chunk, Chunk.Len());
+			Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+			Chunk.Reset(ChunkSize + 1024);
+		}
+
+	private:
+		static constexpr int32 ChunkSize = 1024 * 1024;
+
+		FArchive& Ar;
+		FString Chunk;
+	};
+
+	FString FormatId(uint64 Id)
+	{
+		return FString::Printf(TEXT("\"0x%016llX\""), Id);
+	}
+
+	/** Object IDs count up from 1, pin IDs are in their own range */
+	constexpr uint64 PinIdBase = 0x0100000000000000ull;
+
+	double ToMegabytes(uint64 Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+
+	/** Let the objects of generated packages be collected, so they have to be loaded from disk again */
+	void ReleasePackage(UObject* Asset)
+	{
+		if (!Asset)
+		{
+			return;
+		}
+
+		UPackage* Package = Asset->GetOutermost();
+		ForEachObjectWithPackage(Package, [](UObject* Object)
+		{
+			Object->ClearFlags(RF_Standalone);
+			return true;
+		});
+		ResetLoaders(Package);
+	}
+}
+
+UDialogueScaleBenchmarkCommandlet::UDialogueScaleBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UDialogueScaleBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Cmd = *Params;
+	FString SizesParam = TEXT("1000,10000,100000,1000000");
+	FParse::Value(Cmd, TEXT("Sizes="), SizesParam, false);
+	FParse::Value(Cmd, TEXT("Packages="), NumPackages);
+	FParse::Value(Cmd, TEXT("Pins="), NumPins);
+	FParse::Value(Cmd, TEXT("TextLength="), TextLength);
+	FParse::Value(Cmd, TEXT("ScriptDensity="), ScriptDensity);
+	FParse::Value(Cmd, TEXT("Flags="), NumFlags);
+	FParse::Value(Cmd, TEXT("Seed="), Seed);
+	FParse::Value(Cmd, TEXT("Dest="), DestinationPath);
+	FString ReportPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("DialogueScaleBenchmark-%s.csv"), *FDateTime::Now().ToString());
+	FParse::Value(Cmd, TEXT("Report="), ReportPath);
+	const bool bKeepFiles = FParse::Param(Cmd, TEXT("KeepFiles"));
+
+	NumPackages = FMath::Max(NumPackages, 1);
+	NumPins = FMath::Max(NumPins, 1);
+	NumFlags = FMath::Max(NumFlags, 1);
+	TextLength = FMath::Max(TextLength, 0);
+
+	TArray<FString> SizeStrings;
+	SizesParam.ParseIntoArray(SizeStrings, TEXT(","));
+	TArray<int32> Sizes;
+	for (const FString& SizeString : SizeStrings)
+	{
+		const int32 Size = FCString::Atoi(*SizeString);
+		if (Size > 0)
+		{
+			Sizes.Add(Size);
+		}
+	}
+	Sizes.Sort();
+
+	if (Sizes.Num() == 0)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("No sizes given, usage: -run=DialogueScaleBenchmark -Sizes=1000,10000"));
+		return 1;
+	}
+
+	FString Report = TEXT("objects,packages,fileBytes,writeSeconds,readSeconds,parseSeconds,generateSeconds,connectionsSeconds,saveSeconds,loadSeconds,usedMB,peakMB\n");
+	int32 NumFailed = 0;
+	for (const int32 Size : Sizes)
+	{
+		const FString ProjectName = FString::Printf(TEXT("Scale%d"), Size);
+		const FString Filename = FPaths::ProjectSavedDir() / TEXT("DialogueScaleBenchmark") / ProjectName + TEXT(".json");
+
+		UE_LOG(LogDialogueEditor, Display, TEXT("Scale benchmark: %d objects in %d packages, %d pins, text length %d, script density %.2f"),
+			Size, NumPackages, NumPins, TextLength, ScriptDensity);
+
+		double StartTime = FPlatformTime::Seconds();
+		if (!WriteSyntheticExport(Filename, ProjectName, Size))
+		{
+			UE_LOG(LogDialogueEditor, Error, TEXT("Failed to write %s"), *Filename);
+			++NumFailed;
+			continue;
+		}
+		const double WriteSeconds = FPlatformTime::Seconds() - StartTime;
+		const int64 FileBytes = IFileManager::Get().FileSize(*Filename);
+
+		// Transient, the benchmark never reuses hashes of an earlier run
+		UDialogueImportData* ImportData = NewObject<UDialogueImportData>(GetTransientPackage());
+		ImportData->AddToRoot();
+		ImportData->Settings.GeneratedAssetsFolder = DestinationPath / ProjectName;
+
+		FDialogueImportStats Stats;
+		bool bSucceeded = ImportData->ImportFromJsonFile(Filename, &Stats);
+
+		FSoftObjectPath DatabasePath;
+		TArray<FString> PackageNames;
+		if (bSucceeded)
+		{
+			FDialogueAssetGenerator Generator;
+			Generator.SetStats(&Stats);
+			bSucceeded = Generator.GenerateAssets(ImportData);
+
+			if (UDialogueDatabase* Database = Generator.GetGeneratedDatabase())
+			{
+				DatabasePath = FSoftObjectPath(Database);
+				Database->ImportedPackages.GetKeys(PackageNames);
+				ReleasePackage(Database);
+				ReleasePackage(Database->DefaultGlobalVariables);
+				for (UDialoguePackage* Package : Generator.GetGeneratedPackages())
+				{
+					ReleasePackage(Package);
+				}
+			}
+		}
+
+		ImportData->RemoveFromRoot();
+		ImportData = nullptr;
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		// Load everything back from disk like a game would
+		double LoadSeconds = 0.0;
+		if (bSucceeded)
+		{
+			StartTime = FPlatformTime::Seconds();
+			UDialogueDatabase* Database = Cast<UDialogueDatabase>(DatabasePath.TryLoad());
+			if (Database)
+			{
+				Database->Initialize();
+				for (const FString& PackageName : PackageNames)
+				{
+					Database->LoadPackage(PackageName);
+				}
+				LoadSeconds = FPlatformTime::Seconds() - StartTime;
+				Database->Deinitialize();
+			}
+			else
+			{
+				UE_LOG(LogDialogueEditor, Error, TEXT("Failed to load %s"), *DatabasePath.ToString());
+				bSucceeded = false;
+			}
+		}
+
+		auto StageSeconds = [&Stats](const TCHAR* Name)
+		{
+			const FDialogueImportStats::FStage* Stage = Stats.Stages.FindByPredicate([Name](const FDialogueImportStats::FStage& Existing) { return Existing.Name == Name; });
+			return Stage ? Stage->Seconds : 0.0;
+		};
+
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		Report += FString::Printf(TEXT("%d,%d,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f\n"),
+			Size, NumPackages, FileBytes, WriteSeconds, StageSeconds(TEXT("Read")), StageSeconds(TEXT("Parse")),
+			StageSeconds(TEXT("GenerateObjects")), StageSeconds(TEXT("Connections")), StageSeconds(TEXT("Save")), LoadSeconds,
+			ToMegabytes(MemoryStats.UsedPhysical), ToMegabytes(MemoryStats.PeakUsedPhysical));
+
+		Stats.LogSummary(Filename);
+		UE_LOG(LogDialogueEditor, Display, TEXT("    %-16s %8.3fs"), TEXT("Load"), LoadSeconds);
+		if (!bSucceeded)
+		{
+			UE_LOG(LogDialogueEditor, Error, TEXT("Scale benchmark of %d objects failed"), Size);
+			++NumFailed;
+		}
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		if (!bKeepFiles)
+		{
+			IFileManager::Get().Delete(*Filename);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Report, *ReportPath))
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to write scale report to %s"), *ReportPath);
+		return 1;
+	}
+
+	UE_LOG(LogDialogueEditor, Display, TEXT("Scale report written to %s"), *ReportPath);
+	return NumFailed > 0 ? 1 : 0;
+}
+
+bool UDialogueScaleBenchmarkCommandlet::WriteSyntheticExport(const FString& Filename, const FString& ProjectName, int32 NumObjects) const
+{
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!File)
+	{
+		return false;
+	}
+
+	FRandomStream Random(Seed);
+	FChunkedJsonWriter Writer(*File);
+
+	Writer << TEXT("{\"formatVersion\":\"1.0\",\"project\":{\"name\":\"") << ProjectName << TEXT("\",\"technicalName\":\"") << ProjectName << TEXT("\"},");
+
+	Writer << TEXT("\"globalVariables\":[{\"name\":\"Bench\",\"variables\":[");
+	for (int32 i = 0; i < NumFlags; ++i)
+	{
+		Writer << FString::Printf(TEXT("%s{\"name\":\"Flag%d\",\"type\":\"boolean\",\"defaultValue\":%s}"), i > 0 ? TEXT(",") : TEXT(""), i, i % 2 ? TEXT("true") : TEXT("false"));
+	}
+	Writer << TEXT(",{\"name\":\"Counter\",\"type\":\"integer\",\"defaultValue\":0}]}],");
+
+	Writer << TEXT("\"characters\":[{\"id\":\"0x00FF000000000001\",\"technicalName\":\"Narrator\",\"displayName\":\"Narrator\"}],");
+
+	auto RandomText = [&Random](int32 Length)
+	{
+		static const TCHAR Letters[] = TEXT("abcdefghijklmnopqrstuvwxyz     ");
+		FString Text;
+		Text.Reserve(Length);
+		for (int32 i = 0; i < Length; ++i)
+		{
+			Text.AppendChar(Letters[Random.RandRange(0, UE_ARRAY_COUNT(Letters) - 2)]);
+		}
+		return Text;
+	};
+
+	Writer << TEXT("\"packages\":[");
+	uint64 NextPinId = PinIdBase;
+	for (int32 PackageIndex = 0; PackageIndex < NumPackages; ++PackageIndex)
+	{
+		const int32 First = (int32)((int64)NumObjects * PackageIndex / NumPackages);
+		const int32 End = (int32)((int64)NumObjects * (PackageIndex + 1) / NumPackages);
+
+		// Loaded on demand, so the benchmark times every load
+		Writer << FString::Printf(TEXT("%s{\"name\":\"%s_%d\",\"isDefaultPackage\":false,\"objects\":["), PackageIndex > 0 ? TEXT(",") : TEXT(""), *ProjectName, PackageIndex);
+
+		// Pin IDs of every object, connections are written after all objects
+		TArray<uint64> FirstOutputPins;
+		TArray<int32> NumOutputPins;
+		FirstOutputPins.Reserve(End - First);
+		NumOutputPins.Reserve(End - First);
+
+		for (int32 i = First; i < End; ++i)
+		{
+			const uint64 Id = (uint64)i + 1;
+			FString Type = TEXT("DialogueFragment");
+			FString Data;
+			int32 Outputs = NumPins;
+
+			const float Roll = Random.FRand();
+			if (i > First && Roll < ScriptDensity * 0.5f)
+			{
+				Type = TEXT("Condition");
+				Data = FString::Printf(TEXT("\"script\":{\"expression\":\"Bench.Flag%d == true\"}"), Random.RandRange(0, NumFlags - 1));
+				Outputs = 2;
+			}
+			else if (i > First && Roll < ScriptDensity)
+			{
+				const int32 Flag = Random.RandRange(0, NumFlags - 1);
+				Type = TEXT("Instruction");
+				Data = FString::Printf(TEXT("\"script\":{\"expression\":\"Bench.Flag%d = !Bench.Flag%d; Bench.Counter += 1\"}"), Flag, Flag);
+				Outputs = 1;
+			}
+			else if (i > First && Roll < ScriptDensity + 0.05f)
+			{
+				Type = TEXT("Hub");
+				Outputs = 1;
+			}
+			else
+			{
+				Data = FString::Printf(TEXT("\"speaker\":\"0x00FF000000000001\",\"text\":\"%s\""), *RandomText(TextLength));
+			}
+
+			Writer << FString::Printf(TEXT("%s{\"id\":%s,\"technicalName\":\"Obj_%d\",\"type\":\"%s\",\"properties\":{\"data\":{%s}},\"inputPins\":[{\"id\":%s}],\"outputPins\":["),
+				i > First ? TEXT(",") : TEXT(""), *FormatId(Id), i, *Type, *Data, *FormatId(NextPinId++));
+
+			FirstOutputPins.Add(NextPinId);
+			NumOutputPins.Add(Outputs);
+			for (int32 Pin = 0; Pin < Outputs; ++Pin)
+			{
+				Writer << FString::Printf(TEXT("%s{\"id\":%s}"), Pin > 0 ? TEXT(",") : TEXT(""), *FormatId(NextPinId++));
+			}
+			Writer << TEXT("]}");
+		}
+
+		// Connect forward within a window, the last objects become dead ends
+		Writer << TEXT("],\"connections\":[");
+		const int32 Window = 32;
+		bool bFirstConnection = true;
+		for (int32 i = First; i < End; ++i)
+		{
+			const int32 LastTarget = FMath::Min(i + Window, End - 1);
+			if (LastTarget <= i)
+			{
+				continue;
+			}
+
+			for (int32 Pin = 0; Pin < NumOutputPins[i - First]; ++Pin)
+			{
+				const int32 Target = Random.RandRange(i + 1, LastTarget);
+				Writer << FString::Printf(TEXT("%s{\"sourceId\":%s,\"sourcePin\":%d,\"targetId\":%s,\"targetPin\":0}"),
+					bFirstConnection ? TEXT("") : TEXT(","), *FormatId((uint64)i + 1), Pin, *FormatId((uint64)Target + 1));
+				bFirstConnection = false;
+			}
+		}
+		Writer << TEXT("]}");
+	}
+	Writer << TEXT("]}");
+	Writer.Flush();
+
+	return File->Close() && !File->IsError();
+}
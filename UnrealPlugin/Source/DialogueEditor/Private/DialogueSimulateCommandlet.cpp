@@ -0,0 +1,212 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueSimulateCommandlet.h"
+#include "DialogueDatabase.h"
+#include "DialogueEditorModule.h"
+#include "DialogueFlowSimulator.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueNode.h"
+#include "DialogueObjectIndex.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UDialogueSimulateCommandlet::UDialogueSimulateCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UDialogueSimulateCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Cmd = *Params;
+
+	FDialogueSimulationSettings Settings;
+	FParse::Value(Cmd, TEXT("Playthroughs="), Settings.NumPlaythroughs);
+	FParse::Value(Cmd, TEXT("Steps="), Settings.MaxSteps);
+	FParse::Value(Cmd, TEXT("Seed="), Settings.Seed);
+	FParse::Value(Cmd, TEXT("Tasks="), Settings.NumTasks);
+	FParse::Value(Cmd, TEXT("ExploreLimit="), Settings.ExploreLimit);
+	Settings.bExhaustive = FParse::Param(Cmd, TEXT("Exhaustive"));
+
+	FString DatabasePath;
+	FString StartIds;
+	FString VariableNames;
+	FString ReportPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("DialogueSimulate-%s.json"), *FDateTime::Now().ToString());
+	FParse::Value(Cmd, TEXT("Database="), DatabasePath);
+	FParse::Value(Cmd, TEXT("Start="), StartIds, false);
+	FParse::Value(Cmd, TEXT("Variables="), VariableNames, false);
+	FParse::Value(Cmd, TEXT("Report="), ReportPath);
+	const bool bFailOnUnreached = FParse::Param(Cmd, TEXT("FailOnUnreached"));
+	const bool bFailOnExploreLimit = FParse::Param(Cmd, TEXT("FailOnExploreLimit"));
+
+	UDialogueDatabase* Database = LoadDatabase(DatabasePath);
+	UDialogueGlobalVariables* GV = Database ? Database->GetGlobalVariables() : nullptr;
+	if (!GV)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("No dialogue database with global variables to simulate"));
+		return 1;
+	}
+
+	if (FParse::Param(Cmd, TEXT("AllPackages")))
+	{
+		TArray<FString> PackageNames;
+		Database->ImportedPackages.GetKeys(PackageNames);
+		for (const FString& PackageName : PackageNames)
+		{
+			Database->LoadPackage(PackageName);
+		}
+	}
+
+	GV->PublishSnapshot();
+	const FDialogueVariableSnapshotPtr Snapshot = GV->GetSnapshot();
+	const TSharedRef<const FDialogueObjectIndex> Index = Database->GetObjectIndex();
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	if (!Snapshot || Graph.IsEmpty())
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Nothing to simulate, the database has no flow loaded"));
+		return 1;
+	}
+
+	if (StartIds.IsEmpty())
+	{
+		for (int32 i = 0; i < Graph.Nodes.Num(); ++i)
+		{
+			if (Cast<UDialogueDialogue>(Graph.Nodes[i].Object))
+			{
+				Settings.StartNodes.Add(i);
+			}
+		}
+	}
+	else
+	{
+		TArray<FString> Ids;
+		StartIds.ParseIntoArray(Ids, TEXT(","));
+		for (const FString& Id : Ids)
+		{
+			const FDialogueFlowGraph::FVertex Vertex = Graph.FindVertex(Database->GetObject(Id.TrimStartAndEnd()));
+			if (!Vertex.IsValid() || Vertex.bIsPin)
+			{
+				UE_LOG(LogDialogueEditor, Error, TEXT("Start %s is no node of the loaded flow"), *Id);
+				return 1;
+			}
+			Settings.StartNodes.Add(Vertex.Index);
+		}
+	}
+
+	TArray<FString> Variables;
+	VariableNames.ParseIntoArray(Variables, TEXT(","));
+	for (FString& Variable : Variables)
+	{
+		Variable.TrimStartAndEndInline();
+		const FDialogueVariableSlot Slot = Snapshot->FindSlot(Variable);
+		if (Slot.Type != EDialogueVariableType::Boolean && Slot.Type != EDialogueVariableType::Integer)
+		{
+			UE_LOG(LogDialogueEditor, Warning, TEXT("Variable %s is no bool or int variable, it gets no histogram"), *Variable);
+		}
+		Settings.HistogramSlots.Add(Slot);
+	}
+
+	UE_LOG(LogDialogueEditor, Display, TEXT("Simulating %s%lld playthroughs of up to %d lines from %d starts over %d nodes, seed %u"),
+		Settings.bExhaustive ? TEXT("up to ") : TEXT(""), Settings.NumPlaythroughs, Settings.MaxSteps, Settings.StartNodes.Num(), Graph.Nodes.Num(), Settings.Seed);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const FDialogueSimulationReport Report = FDialogueFlowSimulator::Run(Graph, Snapshot.ToSharedRef(), Settings);
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	TArray<TSharedPtr<FJsonValue>> NodesJson;
+	int32 NumLines = 0;
+	int32 NumUnreached = 0;
+	for (int32 i = 0; i < Graph.Nodes.Num(); ++i)
+	{
+		const bool bIsLine = (Graph.Nodes[i].PausableType & Settings.PauseOn) != 0;
+		const bool bUnreached = bIsLine && Report.NodeReaches[i] == 0;
+		NumLines += bIsLine ? 1 : 0;
+		NumUnreached += bUnreached ? 1 : 0;
+
+		const UDialogueNode* Node = Graph.Nodes[i].Object;
+		TSharedRef<FJsonObject> NodeJson = MakeShared<FJsonObject>();
+		NodeJson->SetStringField(TEXT("id"), Node ? Node->Id.ToString() : FString());
+		NodeJson->SetStringField(TEXT("technicalName"), Node ? Node->TechnicalName : FString());
+		NodeJson->SetStringField(TEXT("class"), Node ? Node->GetClass()->GetName() : FString());
+		NodeJson->SetBoolField(TEXT("line"), bIsLine);
+		NodeJson->SetNumberField(TEXT("reaches"), (double)Report.NodeReaches[i]);
+		NodeJson->SetNumberField(TEXT("choices"), (double)Report.LineChoices[i]);
+		NodeJson->SetNumberField(TEXT("deadEnds"), (double)Report.DeadEnds[i]);
+		NodeJson->SetNumberField(TEXT("exploreLimitHits"), (double)Report.ExploreLimitHits[i]);
+		NodesJson.Add(MakeShared<FJsonValueObject>(NodeJson));
+
+		if (bUnreached)
+		{
+			UE_LOG(LogDialogueEditor, Display, TEXT("Unreached line %s (%s)"), Node ? *Node->TechnicalName : TEXT("?"), Node ? *Node->Id.ToString() : TEXT("?"));
+		}
+	}
+
+	TSharedRef<FJsonObject> HistogramsJson = MakeShared<FJsonObject>();
+	for (int32 i = 0; i < Variables.Num(); ++i)
+	{
+		TSharedRef<FJsonObject> HistogramJson = MakeShared<FJsonObject>();
+		for (const TPair<int32, uint64>& Pair : Report.Histograms[i])
+		{
+			HistogramJson->SetNumberField(FString::FromInt(Pair.Key), (double)Pair.Value);
+		}
+		HistogramsJson->SetObjectField(Variables[i], HistogramJson);
+	}
+
+	TSharedRef<FJsonObject> ReportJson = MakeShared<FJsonObject>();
+	ReportJson->SetNumberField(TEXT("seconds"), Seconds);
+	ReportJson->SetBoolField(TEXT("exhaustive"), Settings.bExhaustive);
+	ReportJson->SetBoolField(TEXT("truncated"), Report.bTruncated);
+	ReportJson->SetNumberField(TEXT("playthroughs"), (double)Report.NumPlaythroughs);
+	ReportJson->SetNumberField(TEXT("steps"), (double)Report.NumSteps);
+	ReportJson->SetNumberField(TEXT("cutOff"), (double)Report.NumCutOff);
+	ReportJson->SetNumberField(TEXT("deadEnds"), (double)Report.GetTotalDeadEnds());
+	ReportJson->SetNumberField(TEXT("exploreLimitHits"), (double)Report.GetTotalExploreLimitHits());
+	ReportJson->SetNumberField(TEXT("lines"), NumLines);
+	ReportJson->SetNumberField(TEXT("unreachedLines"), NumUnreached);
+	ReportJson->SetObjectField(TEXT("histograms"), HistogramsJson);
+	ReportJson->SetArrayField(TEXT("nodes"), NodesJson);
+
+	UE_LOG(LogDialogueEditor, Display, TEXT("%llu playthroughs, %llu lines played in %.3fs: %d of %d lines unreached, %llu dead ends, %llu cut off, %llu explore limit hits%s"),
+		Report.NumPlaythroughs, Report.NumSteps, Seconds, NumUnreached, NumLines, Report.GetTotalDeadEnds(), Report.NumCutOff,
+		Report.GetTotalExploreLimitHits(), Report.bTruncated ? TEXT(", enumeration truncated") : TEXT(""));
+
+	FString ReportString;
+	FJsonSerializer::Serialize(ReportJson, TJsonWriterFactory<>::Create(&ReportString));
+	if (FFileHelper::SaveStringToFile(ReportString, *ReportPath))
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("Simulation report written to %s"), *ReportPath);
+	}
+	else
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to write simulation report to %s"), *ReportPath);
+		return 1;
+	}
+
+	const bool bFailed = (bFailOnUnreached && NumUnreached > 0) || (bFailOnExploreLimit && Report.GetTotalExploreLimitHits() > 0);
+	return bFailed ? 1 : 0;
+}
+
+UDialogueDatabase* UDialogueSimulateCommandlet::LoadDatabase(const FString& DatabasePath) const
+{
+	if (DatabasePath.IsEmpty())
+	{
+		return UDialogueDatabase::Get(nullptr);
+	}
+
+	UDialogueDatabase* Original = LoadObject<UDialogueDatabase>(nullptr, *DatabasePath);
+	if (!Original)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to load dialogue database %s"), *DatabasePath);
+		return nullptr;
+	}
+
+	// Simulate on a copy like the game does, the asset stays untouched
+	UDialogueDatabase* Database = DuplicateObject<UDialogueDatabase>(Original, GetTransientPackage());
+	Database->AddToRoot();
+	Database->Initialize();
+	return Database;
+}
@@ -0,0 +1,291 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueThreadStressCommandlet.h"
+#include "DialogueDatabase.h"
+#include "DialogueEditorModule.h"
+#include "DialogueFlowSimulator.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueNode.h"
+#include "DialogueObjectIndex.h"
+#include "DialogueSessionPool.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** The branch a session takes at a step, the same for every task count */
+	int32 PickBranch(uint32 Seed, int32 Session, int32 Step, int32 NumBranches)
+	{
+		return (int32)(HashCombine(HashCombine(Seed, (uint32)Session), (uint32)Step) % (uint32)NumBranches);
+	}
+
+	bool SessionsMatch(const FDialogueSession& A, const FDialogueSession& B)
+	{
+		if (A.Cursor != B.Cursor || A.Branches != B.Branches || A.Strings != B.Strings || A.Writes.Num() != B.Writes.Num() || A.Seen.Num() != B.Seen.Num())
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < A.Writes.Num(); ++i)
+		{
+			if (!(A.Writes[i].Slot == B.Writes[i].Slot) || A.Writes[i].Value != B.Writes[i].Value)
+			{
+				return false;
+			}
+		}
+
+		for (int32 i = 0; i < A.Seen.Num(); ++i)
+		{
+			if (A.Seen[i].Node != B.Seen[i].Node || A.Seen[i].Count != B.Seen[i].Count)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ReportsMatch(const FDialogueSimulationReport& A, const FDialogueSimulationReport& B)
+	{
+		return A.NodeReaches == B.NodeReaches && A.LineChoices == B.LineChoices && A.DeadEnds == B.DeadEnds
+			&& A.ExploreLimitHits == B.ExploreLimitHits && A.NumPlaythroughs == B.NumPlaythroughs
+			&& A.NumCutOff == B.NumCutOff && A.NumSteps == B.NumSteps;
+	}
+}
+
+UDialogueThreadStressCommandlet::UDialogueThreadStressCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UDialogueThreadStressCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Cmd = *Params;
+
+	int32 NumSessions = 256;
+	int32 NumSteps = 64;
+	int32 MaxTasks = 32;
+	uint32 Seed = 1;
+	FDialogueSimulationSettings Settings;
+	Settings.NumPlaythroughs = 20000;
+	FParse::Value(Cmd, TEXT("Sessions="), NumSessions);
+	FParse::Value(Cmd, TEXT("Steps="), NumSteps);
+	FParse::Value(Cmd, TEXT("MaxTasks="), MaxTasks);
+	FParse::Value(Cmd, TEXT("Seed="), Seed);
+	FParse::Value(Cmd, TEXT("Playthroughs="), Settings.NumPlaythroughs);
+	Settings.Seed = Seed;
+	MaxTasks = FMath::Max(MaxTasks, 1);
+
+	FString DatabasePath;
+	FString ReportPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("DialogueThreadStress-%s.json"), *FDateTime::Now().ToString());
+	FParse::Value(Cmd, TEXT("Database="), DatabasePath);
+	FParse::Value(Cmd, TEXT("Report="), ReportPath);
+
+	UDialogueDatabase* Database = LoadDatabase(DatabasePath);
+	UDialogueGlobalVariables* GV = Database ? Database->GetGlobalVariables() : nullptr;
+	if (!GV)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("No dialogue database with global variables to run"));
+		return 1;
+	}
+
+	if (FParse::Param(Cmd, TEXT("AllPackages")))
+	{
+		TArray<FString> PackageNames;
+		Database->ImportedPackages.GetKeys(PackageNames);
+		for (const FString& PackageName : PackageNames)
+		{
+			Database->LoadPackage(PackageName);
+		}
+	}
+
+	GV->PublishSnapshot();
+	const FDialogueVariableSnapshotPtr Snapshot = GV->GetSnapshot();
+	const TSharedRef<const FDialogueObjectIndex> Index = Database->GetObjectIndex();
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	if (!Snapshot || Graph.IsEmpty())
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Nothing to run, the database has no flow loaded"));
+		return 1;
+	}
+
+	for (int32 i = 0; i < Graph.Nodes.Num(); ++i)
+	{
+		if (Cast<UDialogueDialogue>(Graph.Nodes[i].Object))
+		{
+			Settings.StartNodes.Add(i);
+		}
+	}
+	if (Settings.StartNodes.Num() == 0)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Nothing to run, the loaded flow has no dialogues"));
+		return 1;
+	}
+
+	// Sessions take the same branches on every task count, only the tasks they are advanced on differ
+	auto RunSessions = [&](int32 NumTasks, TArray<FDialogueSession>& OutSessions, int64& OutAdvances)
+	{
+		FDialogueSessionPool Pool(Index, Snapshot.ToSharedRef());
+		Pool.MaxTasks = NumTasks;
+		Pool.MinParallelAdvances = NumTasks > 1 ? 1 : MAX_int32;
+
+		TArray<int32> Handles;
+		for (int32 i = 0; i < NumSessions; ++i)
+		{
+			Handles.Add(Pool.AddSession(Graph.Nodes[Settings.StartNodes[i % Settings.StartNodes.Num()]].Object));
+		}
+
+		OutAdvances = 0;
+		TArray<FDialogueSessionAdvance> Advances;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			Advances.Reset();
+			for (int32 i = 0; i < Handles.Num(); ++i)
+			{
+				const FDialogueSession* Session = Pool.GetSession(Handles[i]);
+				if (Session && Session->Branches.Num() > 0)
+				{
+					FDialogueSessionAdvance& Advance = Advances.AddDefaulted_GetRef();
+					Advance.Session = Handles[i];
+					Advance.Branch = PickBranch(Seed, i, Step, Session->Branches.Num());
+				}
+			}
+
+			if (Advances.Num() == 0)
+			{
+				break;
+			}
+			Pool.AdvanceSessions(Advances);
+			OutAdvances += Advances.Num();
+		}
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+		OutSessions.Reset();
+		for (const int32 Handle : Handles)
+		{
+			const FDialogueSession* Session = Pool.GetSession(Handle);
+			OutSessions.Add(Session ? *Session : FDialogueSession());
+		}
+		return Seconds;
+	};
+
+	TArray<int32> TaskCounts;
+	for (int32 NumTasks = 1; NumTasks < MaxTasks; NumTasks *= 2)
+	{
+		TaskCounts.Add(NumTasks);
+	}
+	TaskCounts.Add(MaxTasks);
+
+	UE_LOG(LogDialogueEditor, Display, TEXT("Running %d sessions for up to %d steps and %lld playthroughs from %d dialogues on 1 to %d tasks, %d worker threads"),
+		NumSessions, NumSteps, Settings.NumPlaythroughs, Settings.StartNodes.Num(), MaxTasks, FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+	TArray<FDialogueSession> ReferenceSessions;
+	FDialogueSimulationReport ReferenceReport;
+	double ReferenceSessionSeconds = 0.0;
+	double ReferenceSimulationSeconds = 0.0;
+	int32 NumMismatches = 0;
+
+	TArray<TSharedPtr<FJsonValue>> RunsJson;
+	for (const int32 NumTasks : TaskCounts)
+	{
+		TArray<FDialogueSession> Sessions;
+		int64 NumAdvances = 0;
+		const double SessionSeconds = RunSessions(NumTasks, Sessions, NumAdvances);
+
+		Settings.NumTasks = NumTasks;
+		const double SimulationStart = FPlatformTime::Seconds();
+		FDialogueSimulationReport Report = FDialogueFlowSimulator::Run(Graph, Snapshot.ToSharedRef(), Settings);
+		const double SimulationSeconds = FPlatformTime::Seconds() - SimulationStart;
+
+		int32 SessionMismatches = 0;
+		bool bReportMatches = true;
+		if (NumTasks == 1)
+		{
+			ReferenceSessions = MoveTemp(Sessions);
+			ReferenceReport = MoveTemp(Report);
+			ReferenceSessionSeconds = SessionSeconds;
+			ReferenceSimulationSeconds = SimulationSeconds;
+		}
+		else
+		{
+			for (int32 i = 0; i < Sessions.Num(); ++i)
+			{
+				SessionMismatches += SessionsMatch(Sessions[i], ReferenceSessions[i]) ? 0 : 1;
+			}
+			bReportMatches = ReportsMatch(Report, ReferenceReport);
+		}
+		NumMismatches += SessionMismatches + (bReportMatches ? 0 : 1);
+
+		const double AdvancesPerSecond = SessionSeconds > 0.0 ? NumAdvances / SessionSeconds : 0.0;
+		const double PlaythroughsPerSecond = SimulationSeconds > 0.0 ? Settings.NumPlaythroughs / SimulationSeconds : 0.0;
+		UE_LOG(LogDialogueEditor, Display, TEXT("%2d tasks: %.0f advances/s (x%.2f), %.0f playthroughs/s (x%.2f)%s%s"),
+			NumTasks, AdvancesPerSecond, SessionSeconds > 0.0 ? ReferenceSessionSeconds / SessionSeconds : 0.0,
+			PlaythroughsPerSecond, SimulationSeconds > 0.0 ? ReferenceSimulationSeconds / SimulationSeconds : 0.0,
+			SessionMismatches > 0 ? *FString::Printf(TEXT(", %d sessions differ from 1 task"), SessionMismatches) : TEXT(""),
+			bReportMatches ? TEXT("") : TEXT(", simulation counts differ from 1 task"));
+
+		TSharedRef<FJsonObject> RunJson = MakeShared<FJsonObject>();
+		RunJson->SetNumberField(TEXT("tasks"), NumTasks);
+		RunJson->SetNumberField(TEXT("advances"), (double)NumAdvances);
+		RunJson->SetNumberField(TEXT("sessionSeconds"), SessionSeconds);
+		RunJson->SetNumberField(TEXT("advancesPerSecond"), AdvancesPerSecond);
+		RunJson->SetNumberField(TEXT("simulationSeconds"), SimulationSeconds);
+		RunJson->SetNumberField(TEXT("playthroughsPerSecond"), PlaythroughsPerSecond);
+		RunJson->SetNumberField(TEXT("sessionMismatches"), SessionMismatches);
+		RunJson->SetBoolField(TEXT("simulationMatches"), bReportMatches);
+		RunsJson.Add(MakeShared<FJsonValueObject>(RunJson));
+	}
+
+	TSharedRef<FJsonObject> ReportJson = MakeShared<FJsonObject>();
+	ReportJson->SetNumberField(TEXT("sessions"), NumSessions);
+	ReportJson->SetNumberField(TEXT("steps"), NumSteps);
+	ReportJson->SetNumberField(TEXT("playthroughs"), (double)Settings.NumPlaythroughs);
+	ReportJson->SetNumberField(TEXT("workerThreads"), FTaskGraphInterface::Get().GetNumWorkerThreads());
+	ReportJson->SetNumberField(TEXT("mismatches"), NumMismatches);
+	ReportJson->SetArrayField(TEXT("runs"), RunsJson);
+
+	FString ReportString;
+	FJsonSerializer::Serialize(ReportJson, TJsonWriterFactory<>::Create(&ReportString));
+	if (FFileHelper::SaveStringToFile(ReportString, *ReportPath))
+	{
+		UE_LOG(LogDialogueEditor, Display, TEXT("Thread stress report written to %s"), *ReportPath);
+	}
+	else
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to write thread stress report to %s"), *ReportPath);
+		return 1;
+	}
+
+	if (NumMismatches > 0)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("%d results of the threaded runs differ from the run on 1 task"), NumMismatches);
+		return 1;
+	}
+	return 0;
+}
+
+UDialogueDatabase* UDialogueThreadStressCommandlet::LoadDatabase(const FString& DatabasePath) const
+{
+	if (DatabasePath.IsEmpty())
+	{
+		return UDialogueDatabase::Get(nullptr);
+	}
+
+	UDialogueDatabase* Original = LoadObject<UDialogueDatabase>(nullptr, *DatabasePath);
+	if (!Original)
+	{
+		UE_LOG(LogDialogueEditor, Error, TEXT("Failed to load dialogue database %s"), *DatabasePath);
+		return nullptr;
+	}
+
+	// Run on a copy like the game does, the asset stays untouched
+	UDialogueDatabase* Database = DuplicateObject<UDialogueDatabase>(Original, GetTransientPackage());
+	Database->AddToRoot();
+	Database->Initialize();
+	return Database;
+}
@@ -3,6 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DialogueTypes.h"
+#include "DialogueTextPool.h"
+#include "Tasks/Task.h"
 
 class UDialogueImportData;
 class UDialogueDatabase;
@@ -10,13 +13,65 @@ class UDialoguePackage;
 class UDialogueObject;
 class UDialogueNode;
 class UDialogueCharacter;
+class UDialogueGlobalVariables;
 struct FDialoguePackageDef;
 struct FDialogueObjectDef;
 struct FDialogueConnectionDef;
 struct FDialogueCharacterDef;
+struct FDialogueImportStats;
 
 /**
- * Generates Unreal assets from imported dialogue data
+ * An object definition parsed into plain values, prepared off the game thread
+ */
+struct FDialoguePreparedObject
+{
+	const FDialogueObjectDef* Def = nullptr;
+
+	/** Hash of everything the generated object depends on, see FDialogueAssetGenerator::GetGenerationHash */
+	uint32 Hash = 0;
+
+	/** Object of the previous import that is still up to date, nothing else is prepared if set */
+	UDialogueObject* Existing = nullptr;
+
+	FDialogueId Id;
+	FDialogueId SpeakerId;
+	FText Text;
+	FText MenuText;
+	bool bAutoTransition = false;
+
+	/** Compiled and bound script of conditions and instructions */
+	FDialogueScript Script;
+
+	FDialogueId TargetNodeId;
+	int32 TargetPinIndex = 0;
+	FString DisplayName;
+
+	TArray<FDialogueId> InputPinIds;
+	TArray<FDialogueId> OutputPinIds;
+};
+
+/**
+ * The objects of one package, prepared by a task while the packages before it are generated
+ */
+struct FDialoguePreparedPackage
+{
+	/** Package asset of the last import, null if there is none */
+	UDialoguePackage* Existing = nullptr;
+
+	TArray<FDialoguePreparedObject> Objects;
+
+	UE::Tasks::FTask Task;
+};
+
+/**
+ * Generates Unreal assets from imported dialogue data.
+ *
+ * On reimport, objects whose definition hashes the same as on the last generation are kept as they are
+ * and only packages with changes are saved again.
+ *
+ * Packages go through a pipeline: the objects of the next PipelineDepth packages are prepared on tasks while the
+ * game thread generates one, and a package is saved on a worker as soon as the packages its connections lead into
+ * are generated. Only the native scripts and the database wait for all packages.
  */
 class DIALOGUEEDITOR_API FDialogueAssetGenerator
 {
@@ -32,21 +87,64 @@ public:
 	/** Get generated packages */
 	const TArray<UDialoguePackage*>& GetGeneratedPackages() const { return GeneratedPackages; }
 
+	/** Time the GenerateObjects, Connections and Save stages of the next generations into Stats, null to stop */
+	void SetStats(FDialogueImportStats* InStats) { Stats = InStats; }
+
 private:
 	/** Generate the database asset */
 	bool GenerateDatabase(UDialogueImportData* ImportData);
 
-	/** Generate a package asset */
-	UDialoguePackage* GeneratePackage(const FDialoguePackageDef& PackageDef, UDialogueImportData* ImportData);
+	/** Generate the default global variables asset */
+	bool GenerateGlobalVariables(UDialogueImportData* ImportData);
+
+	/**
+	 * Generate a package asset from its prepared objects, or update the package of the last import in place.
+	 * It is saved once all connections are made.
+	 * @param OutRegenerated Import IDs of the objects that were created anew
+	 * @param bOutModified Set if the package differs from the saved one
+	 */
+	UDialoguePackage* GeneratePackage(const FDialoguePackageDef& PackageDef, TArrayView<FDialoguePreparedObject> PreparedObjects,
+		UDialoguePackage* ExistingPackage, TSet<FString>& OutRegenerated, bool& bOutModified);
+
+	/**
+	 * Find the objects of a package that are still up to date, then prepare the others on a task.
+	 * Loads the package of the last import, so it must be called on the game thread.
+	 */
+	void StartPreparePackage(const UDialogueImportData* ImportData, const FDialoguePackageDef& PackageDef,
+		FDialoguePreparedPackage& OutPrepared, TMap<FString, uint32>& OutObjectHashes);
+
+	/** Load the package asset generated by the last import, null if there is none */
+	UDialoguePackage* FindExistingPackage(const FDialoguePackageDef& PackageDef) const;
 
-	/** Generate a dialogue object */
-	UDialogueObject* GenerateObject(const FDialogueObjectDef& ObjectDef, UDialoguePackage* Package);
+	/** Hash of an object definition and of everything else its generated object depends on */
+	uint32 GetGenerationHash(const FDialogueObjectDef& ObjectDef) const;
+
+	/** Remove an object of the previous import from its package */
+	void DiscardObject(UDialogueObject* Object) const;
+
+	/** Parse an object definition and compile its script, safe to call from any thread */
+	void PrepareObject(const FDialogueObjectDef& ObjectDef, FDialoguePreparedObject& OutPrepared) const;
+
+	/** Generate a dialogue object from its prepared data */
+	UDialogueObject* GenerateObject(FDialoguePreparedObject& Prepared, UDialoguePackage* Package);
+
+	/** Compile a script's expression into bytecode, safe to call from any thread */
+	void CompileScript(FDialogueScript& Script, const FDialogueObjectDef& ObjectDef) const;
+
+	/** Give a compiled script its index in the generated scripts class */
+	void AddNativeScript(FDialogueScript& Script);
+
+	/** Write the scripts class with the native functions of all scripts */
+	bool GenerateNativeScripts(UDialogueImportData* ImportData);
 
 	/** Generate a character */
 	UDialogueCharacter* GenerateCharacter(const FDialogueCharacterDef& CharacterDef);
 
-	/** Connect objects based on connection definitions */
-	void ProcessConnections(const TArray<FDialogueConnectionDef>& Connections, UDialoguePackage* Package);
+	/** Bake the flow of all generated objects and warn about loops exploration can never leave */
+	void ReportFlowCycles() const;
+
+	/** Connect objects based on connection definitions, only those starting at OnlySources if given */
+	void ProcessConnections(const TArray<FDialogueConnectionDef>& Connections, UDialoguePackage* Package, const TSet<FString>* OnlySources = nullptr);
 
 	/** Get the asset save path */
 	FString GetAssetPath(const FString& AssetName, const FString& SubFolder = TEXT("")) const;
@@ -54,8 +152,26 @@ private:
 	/** Create or find a package for asset creation */
 	UPackage* CreateAssetPackage(const FString& AssetPath);
 
-	/** Save an asset */
-	bool SaveAsset(UObject* Asset);
+	/**
+	 * Start saving an asset's package with the engine's concurrent save, waiting while MaxConcurrentSaves run.
+	 * PreSave runs right away, nothing may write to the package until FinishSaves returns.
+	 */
+	void SaveAsset(UObject* Asset);
+
+	/** Wait for the oldest saves until no more than MaxRunning are running */
+	void WaitForSaves(int32 MaxRunning);
+
+	/**
+	 * Wait for all saves of this generation, the asset registry is told about the saved files once.
+	 * False if any package failed to save.
+	 */
+	bool FinishSaves();
+
+	/** Most packages saved at the same time, each save holds its serialized package in memory */
+	static constexpr int32 MaxConcurrentSaves = 8;
+
+	/** Packages prepared ahead, including the one being generated, each holds its prepared objects in memory */
+	static constexpr int32 PipelineDepth = 4;
 
 private:
 	/** Base path for generated assets */
@@ -64,9 +180,43 @@ private:
 	/** Generated database */
 	UDialogueDatabase* GeneratedDatabase = nullptr;
 
+	/** Generated default global variables, scripts are bound against these */
+	UDialogueGlobalVariables* GeneratedGlobalVariables = nullptr;
+
 	/** Generated packages */
 	TArray<UDialoguePackage*> GeneratedPackages;
 
+	struct FDialogueRunningSave
+	{
+		UObject* Asset = nullptr;
+		FString Filename;
+		UE::Tasks::TTask<bool> Task;
+	};
+
+	/** Saves started by SaveAsset, waited for by FinishSaves */
+	TArray<FDialogueRunningSave> Saves;
+
+	/** When the first save of this generation started */
+	double SaveStartTime = 0.0;
+
 	/** Object lookup by ID */
 	TMap<FString, UDialogueObject*> ObjectsById;
+
+	/** Hash of the global variable layout scripts are bound against */
+	uint32 VariablesHash = 0;
+
+	/** Whether scripts get native functions on this import */
+	bool bGenerateNativeScripts = false;
+
+	/** Distinct scripts of the generated scripts class, in NativeIndex order */
+	TArray<FDialogueScript> NativeScripts;
+
+	/** NativeIndex by UDialogueScripts::HashScript, identical scripts share a function */
+	TMap<uint32, int32> NativeIndexByHash;
+
+	/** Texts of the generated packages, identical ones share one instance */
+	FDialogueTextPool TextPool;
+
+	/** Receives stage timings if set */
+	FDialogueImportStats* Stats = nullptr;
 };
@@ -0,0 +1,61 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "DialogueImportData.h"
+#include "DialogueImportStats.h"
+
+class SNotificationItem;
+
+/**
+ * Imports a dialogue file without blocking the editor.
+ *
+ * The file is parsed on a worker thread into a staging object while a notification shows the progress
+ * and offers to cancel. Only once parsing succeeded are the results moved into the import data and the
+ * assets generated on the game thread, so a cancelled or failed import leaves all assets as they were.
+ */
+class DIALOGUEEDITOR_API FDialogueAsyncImport : public TSharedFromThis<FDialogueAsyncImport>
+{
+public:
+	/** Start importing a file into import data, an import still running for the same data is cancelled */
+	static void Start(UDialogueImportData* ImportData, const FString& Filename);
+
+	/** Whether an import into the import data is running */
+	static bool IsRunning(const UDialogueImportData* ImportData);
+
+	/** Cancel all running imports, they finish without changing anything */
+	static void CancelAll();
+
+	~FDialogueAsyncImport();
+
+	/** Stop parsing, the import finishes without changing anything */
+	void Cancel();
+
+private:
+	FDialogueAsyncImport(UDialogueImportData* InImportData, const FString& InFilename);
+
+	void Run();
+
+	/** Update the notification's progress while the file is parsed */
+	bool Tick(float DeltaTime);
+
+	/** Move the parsed data into the import data and generate assets, on the game thread */
+	void Finish(bool bParsed);
+
+	TWeakObjectPtr<UDialogueImportData> ImportData;
+
+	/** Parsed into on the worker, rooted until the import finished */
+	UDialogueImportData* Staging = nullptr;
+
+	FString Filename;
+	FDialogueImportProgress Progress;
+	FDialogueImportStats Stats;
+
+	TSharedPtr<SNotificationItem> Notification;
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	/** Running imports by the import data they write to */
+	static TMap<TWeakObjectPtr<UDialogueImportData>, TSharedPtr<FDialogueAsyncImport>> RunningImports;
+};
@@ -0,0 +1,53 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueBenchmarkCommandlet.generated.h"
+
+class UDialogueDatabase;
+class UDialogueObject;
+
+/**
+ * Measures flow player traversal on a generated dialogue graph.
+ *
+ * UnrealEditor-Cmd <Project> -run=DialogueBenchmark [-Nodes=2000] [-Branching=2] [-HubDensity=0.1]
+ *     [-ConditionDensity=0.2] [-InstructionDensity=0.1] [-JumpDensity=0.05] [-Iterations=5000]
+ *     [-Seed=1] [-NoFlowGraph] [-Cache]
+ * UnrealEditor-Cmd <Project> -run=DialogueBenchmark -Replay=<Recording> [-Repeat=10] [-NoFlowGraph] [-Cache]
+ *
+ * Reports latency percentiles and allocations per call of SetCursorTo, UpdateAvailableBranches and Play.
+ * With -Replay, plays a flow recording (see UDialogueFlowPlayer::StartRecording) on the project's database
+ * instead and reports the latency of every recorded step.
+ */
+UCLASS()
+class DIALOGUEEDITOR_API UDialogueBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Build a database with one package of generated nodes, returns the start node through OutStartNode */
+	UDialogueDatabase* BuildSyntheticDatabase(UDialogueObject*& OutStartNode) const;
+
+	/** Replay a flow recording Repeat times and report its steps */
+	int32 RunReplay(const FString& Filename) const;
+
+	int32 NumNodes = 2000;
+	int32 Branching = 2;
+	float HubDensity = 0.1f;
+	float ConditionDensity = 0.2f;
+	float InstructionDensity = 0.1f;
+	float JumpDensity = 0.05f;
+	int32 NumFlags = 16;
+	int32 Iterations = 5000;
+	int32 Seed = 1;
+	bool bUseFlowGraph = true;
+	bool bUseExplorationCache = false;
+	int32 Repeat = 10;
+};
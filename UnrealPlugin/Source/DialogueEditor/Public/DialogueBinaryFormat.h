@@ -0,0 +1,158 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Binary export of the dialogue editor, read by UDialogueImportData::ImportFromBinaryFile.
+ * Holds the same data as a JSON export but needs no parsing: large projects import from a memory-mapped file,
+ * JSON stays the format to keep in source control.
+ *
+ * All values are little endian. The file starts with an FHeader, followed by its sections at the offsets it gives,
+ * every offset aligned to 4 bytes:
+ *
+ *   Strings      NumStrings + 1 uint32 offsets into the string data, string I is the bytes [Offset I, Offset I + 1)
+ *   StringData   UTF-8 text of all strings, not terminated; equal strings are written once
+ *   Namespaces   FNamespaceRecord, each owning a range of Variables
+ *   Variables    FVariableRecord
+ *   Characters   FCharacterRecord
+ *   Packages     FPackageRecord, each owning a range of Objects and of Connections
+ *   Objects      FObjectRecord, each owning a range of input and of output Pins
+ *   Pins         uint32 string of the pin's ID
+ *   Connections  FConnectionRecord
+ *
+ * Strings are referred to by index, NoString stands for an empty one. Scripts are the strings of their
+ * objects' Script, so they are read like any other text.
+ */
+namespace DialogueBinaryFormat
+{
+	/** The first bytes of every export, "DBIN" */
+	constexpr uint32 Magic = 0x4E494244;
+
+	constexpr uint32 NoString = MAX_uint32;
+
+	/** File extension of binary exports */
+	inline const TCHAR* const Extension = TEXT("dlgbin");
+
+	/** Versions of the format, all older versions can be read */
+	enum class EVersion : uint32
+	{
+		Initial = 1,
+
+		// Add new versions above this line
+		VersionPlusOne,
+		Latest = VersionPlusOne - 1
+	};
+
+	struct FSection
+	{
+		/** Byte offset from the start of the file */
+		uint32 Offset;
+
+		/** Number of records */
+		uint32 Num;
+	};
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+
+		FSection Strings;
+		FSection StringData;
+		FSection Namespaces;
+		FSection Variables;
+		FSection Characters;
+		FSection Packages;
+		FSection Objects;
+		FSection Pins;
+		FSection Connections;
+
+		uint32 ProjectName;
+		uint32 ProjectTechnicalName;
+		uint32 ProjectGuid;
+	};
+
+	struct FNamespaceRecord
+	{
+		uint32 Name;
+		uint32 Description;
+		uint32 FirstVariable;
+		uint32 NumVariables;
+	};
+
+	struct FVariableRecord
+	{
+		uint32 Name;
+		uint32 Type;
+		uint32 DefaultValue;
+		uint32 Description;
+	};
+
+	struct FCharacterRecord
+	{
+		uint32 Id;
+		uint32 TechnicalName;
+		uint32 DisplayName;
+		uint32 Color;
+	};
+
+	enum EPackageFlags : uint32
+	{
+		PackageFlag_Default = 1 << 0
+	};
+
+	struct FPackageRecord
+	{
+		uint32 Name;
+		uint32 Flags;
+		uint32 FirstObject;
+		uint32 NumObjects;
+		uint32 FirstConnection;
+		uint32 NumConnections;
+	};
+
+	enum EObjectFlags : uint32
+	{
+		ObjectFlag_AutoTransition = 1 << 0
+	};
+
+	/** The fields of FDialogueObjectDef and its properties, which of them are used depends on Type */
+	struct FObjectRecord
+	{
+		uint32 Id;
+		uint32 TechnicalName;
+		uint32 Type;
+		uint32 Flags;
+
+		uint32 Speaker;
+		uint32 Text;
+		uint32 MenuText;
+		uint32 Script;
+		uint32 TargetNodeId;
+		int32 TargetPinIndex;
+		uint32 DisplayName;
+
+		uint32 FirstInputPin;
+		uint32 NumInputPins;
+		uint32 FirstOutputPin;
+		uint32 NumOutputPins;
+
+		/** Hash of the object's content as the editor exported it, 0 to have the reader hash the record */
+		uint32 ContentHash;
+	};
+
+	struct FConnectionRecord
+	{
+		uint32 Id;
+		uint32 SourceId;
+		int32 SourcePin;
+		uint32 TargetId;
+		int32 TargetPin;
+	};
+
+	static_assert(sizeof(FHeader) == 92, "The header is part of the file format");
+	static_assert(sizeof(FObjectRecord) == 64, "Object records are part of the file format");
+	static_assert(sizeof(FConnectionRecord) == 20, "Connection records are part of the file format");
+}
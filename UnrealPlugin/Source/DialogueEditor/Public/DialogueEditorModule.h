@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "DialoguePackageQuery.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDialogueEditor, Log, All);
 
@@ -23,9 +24,17 @@ public:
 		return FModuleManager::Get().IsModuleLoaded("DialogueEditor");
 	}
 
+	/** Answers questions about dialogue packages from the asset registry, created on first use */
+	FDialoguePackageQuery& GetPackageQuery();
+
 private:
 	void RegisterAssetTypeActions();
 	void UnregisterAssetTypeActions();
 
+	/** Assign dialogue packages to the chunks of UDialogueDatabase::PackageChunkIds once the asset manager exists */
+	void RegisterPackageChunkRules();
+
 	TArray<TSharedRef<class IAssetTypeActions>> RegisteredAssetTypeActions;
+
+	TUniquePtr<FDialoguePackageQuery> PackageQuery;
 };
@@ -0,0 +1,38 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueImportCommandlet.generated.h"
+
+class UDialogueImportData;
+
+/**
+ * Imports dialogue JSON files or binary exports without the editor UI.
+ *
+ * UnrealEditor-Cmd <Project> -run=DialogueImport <File.json|File.dlgbin>... [-Dest=/Game/Dialogue/Imports] [-Report=<Path>]
+ *
+ * The files are read and parsed in parallel, assets are then generated one file after the other.
+ * Writes a JSON report with the time and memory of every stage per file, to Saved/Logs by default.
+ */
+UCLASS()
+class DIALOGUEEDITOR_API UDialogueImportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueImportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Load the import data asset of a file's last import, or create a new one */
+	UDialogueImportData* FindOrCreateImportData(const FString& Filename) const;
+
+	/** Save an import data asset so the next import can skip unchanged objects */
+	bool SaveImportData(UDialogueImportData* ImportData) const;
+
+	/** Package folder of the import data assets */
+	FString DestinationPath = TEXT("/Game/Dialogue/Imports");
+};
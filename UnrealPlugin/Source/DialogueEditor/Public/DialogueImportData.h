@@ -4,8 +4,28 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include <atomic>
 #include "DialogueImportData.generated.h"
 
+/**
+ * Progress of an import running on another thread, and a way to cancel it
+ */
+struct FDialogueImportProgress
+{
+	std::atomic<int64> BytesRead{ 0 };
+	std::atomic<int64> TotalBytes{ 0 };
+	std::atomic<bool> bCancelRequested{ false };
+
+	float GetFraction() const
+	{
+		const int64 Total = TotalBytes.load(std::memory_order_relaxed);
+		return Total > 0 ? (float)((double)BytesRead.load(std::memory_order_relaxed) / Total) : 0.0f;
+	}
+
+	void Cancel() { bCancelRequested.store(true, std::memory_order_relaxed); }
+	bool IsCancelRequested() const { return bCancelRequested.load(std::memory_order_relaxed); }
+};
+
 /**
  * Settings for dialogue import
  */
@@ -29,6 +49,17 @@ struct FDialogueImportSettings
 	/** Overwrite existing assets on reimport */
 	UPROPERTY(EditAnywhere, Category = "Import")
 	bool bOverwriteOnReimport = true;
+
+	/**
+	 * Generate a UDialogueScripts class with a native function per script into the project's source.
+	 * Scripts run on the bytecode VM until the code is compiled, and again whenever it is stale.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Import")
+	bool bGenerateNativeScripts = false;
+
+	/** Game module the scripts class is generated into, the project's primary module if empty. It must depend on DialogueRuntime. */
+	UPROPERTY(EditAnywhere, Category = "Import", meta = (EditCondition = "bGenerateNativeScripts"))
+	FString NativeScriptsModule;
 };
 
 /**
@@ -109,6 +140,45 @@ struct FDialogueCharacterDef
 	FString Color;
 };
 
+/**
+ * The "data" properties of an object definition, parsed when the file is read so no JSON is kept.
+ * Which of them are used depends on the object's type.
+ */
+USTRUCT(BlueprintType)
+struct FDialogueObjectPropertiesDef
+{
+	GENERATED_BODY()
+
+	/** Dialogue and DialogueFragment */
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	FString Speaker;
+
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	FString Text;
+
+	/** Dialogue only */
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	FString MenuText;
+
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	bool bAutoTransition = false;
+
+	/** Condition and Instruction, empty if the object has no script */
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	FString ScriptExpression;
+
+	/** Jump */
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	FString TargetNodeId;
+
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	int32 TargetPinIndex = 0;
+
+	/** FlowFragment */
+	UPROPERTY(VisibleAnywhere, Category = "Properties")
+	FString DisplayName;
+};
+
 /**
  * Object definition from import
  */
@@ -127,13 +197,17 @@ struct FDialogueObjectDef
 	FString Type;
 
 	UPROPERTY(VisibleAnywhere, Category = "Object")
-	TSharedPtr<FJsonObject> Properties;
+	FDialogueObjectPropertiesDef Properties;
 
 	UPROPERTY(VisibleAnywhere, Category = "Object")
 	TArray<FString> InputPinIds;
 
 	UPROPERTY(VisibleAnywhere, Category = "Object")
 	TArray<FString> OutputPinIds;
+
+	/** Hash of the object's exported JSON, a reimport keeps the generated object while it is unchanged */
+	UPROPERTY(VisibleAnywhere, Category = "Object")
+	uint32 ContentHash = 0;
 };
 
 /**
@@ -218,9 +292,42 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "Import")
 	FDateTime ImportTimestamp;
 
+	/** Generation hash of every object by import ID as of the last generation, written by FDialogueAssetGenerator */
+	UPROPERTY()
+	TMap<FString, uint32> GeneratedObjectHashes;
+
+	/** Hash of every package's connections by package name as of the last generation */
+	UPROPERTY()
+	TMap<FString, uint32> GeneratedConnectionHashes;
+
 	/** Import from JSON data */
 	bool ImportFromJson(const TSharedPtr<FJsonObject>& JsonData);
 
+	/**
+	 * Import from a JSON file without loading it as a whole.
+	 * The file is decoded a chunk at a time and only one object or connection is held as JSON at once.
+	 * Only touches this object's data, so several files can be imported on worker threads at once.
+	 * @param Stats Receives the Read and Parse stages if given
+	 * @param Progress Receives the bytes read if given, a cancelled import returns false
+	 */
+	bool ImportFromJsonFile(const FString& Filename, struct FDialogueImportStats* Stats = nullptr, FDialogueImportProgress* Progress = nullptr);
+
+	/**
+	 * Import from a binary export, see DialogueBinaryFormat.h.
+	 * The file is memory-mapped and its records are copied straight into the definitions, nothing is parsed.
+	 * Like ImportFromJsonFile it only touches this object's data.
+	 */
+	bool ImportFromBinaryFile(const FString& Filename, struct FDialogueImportStats* Stats = nullptr, FDialogueImportProgress* Progress = nullptr);
+
+	/** Import from a binary export if the file is one, from JSON otherwise */
+	bool ImportFromFile(const FString& Filename, struct FDialogueImportStats* Stats = nullptr, FDialogueImportProgress* Progress = nullptr);
+
+	/** Whether a file starts like a binary export */
+	static bool IsBinaryFile(const FString& Filename);
+
+	/** Take the parsed project, variables, characters and packages of another import, keeping settings and generation hashes */
+	void TakeParsedData(UDialogueImportData& Source);
+
 	/** Get the source file for reimport */
 	FString GetSourceFile() const { return SourceFilePath; }
 };
@@ -0,0 +1,81 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+
+class FJsonObject;
+
+/** Unreal Insights channel of the import stages, enable with -trace=cpu,DialogueImport */
+UE_TRACE_CHANNEL_EXTERN(DialogueImportChannel, DIALOGUEEDITOR_API);
+
+/**
+ * Time and memory spent in the stages of importing one file.
+ * The importer and the asset generator fill it in when given one, see FDialogueImportStageScope.
+ */
+struct DIALOGUEEDITOR_API FDialogueImportStats
+{
+	struct FStage
+	{
+		FString Name;
+		double Seconds = 0.0;
+
+		/** Change of the process' used physical memory over the stage, other threads' allocations included */
+		int64 MemoryDelta = 0;
+
+		/** Peak used physical memory of the process at the end of the stage */
+		uint64 PeakMemory = 0;
+
+		/** Number of times the stage was entered */
+		int32 Count = 0;
+	};
+
+	enum class ECounter : uint8
+	{
+		BytesRead,
+		ObjectsParsed,
+		ScriptsCompiled,
+		AssetsSaved,
+		Num
+	};
+
+	/** Stages in the order they were first entered */
+	TArray<FStage> Stages;
+
+	int64 Counters[(int32)ECounter::Num] = {};
+
+	/** Add to a stage, entering it for the first time appends it */
+	void Add(const TCHAR* Stage, double Seconds, int64 MemoryDelta = 0);
+
+	/** Add to a counter, also adds to the counter of all imports in Unreal Insights */
+	void AddCount(ECounter Counter, int64 Delta);
+
+	double GetTotalSeconds() const;
+
+	/** Stages as an object of { "seconds", "memoryDelta", "peakMemory", "count" } by stage name, counters by name */
+	TSharedRef<FJsonObject> ToJson() const;
+
+	/** Log the stages and counters of importing Source */
+	void LogSummary(const FString& Source) const;
+
+	static const TCHAR* GetCounterName(ECounter Counter);
+};
+
+/**
+ * Adds the time and memory change of its scope to a stage and traces it on DialogueImportChannel.
+ * Scopes of one stats object must not nest, their times would be counted twice.
+ */
+class DIALOGUEEDITOR_API FDialogueImportStageScope
+{
+public:
+	FDialogueImportStageScope(FDialogueImportStats* InStats, const TCHAR* InStage);
+	~FDialogueImportStageScope();
+
+private:
+	FDialogueImportStats* Stats;
+	const TCHAR* Stage;
+	double StartTime = 0.0;
+	uint64 StartMemory = 0;
+	bool bTraced = false;
+};
@@ -30,9 +30,12 @@ public:
 	// End UFactory interface
 
 private:
-	/** Perform the actual import */
-	bool ImportFromFile(const FString& Filename, UDialogueImportData* ImportData);
+	/** Perform the actual import, timing the read and parse stages into Stats if given */
+	bool ImportFromFile(const FString& Filename, UDialogueImportData* ImportData, struct FDialogueImportStats* Stats = nullptr);
 
-	/** Process imported data and generate assets */
-	bool ProcessImportData(UDialogueImportData* ImportData);
+	/** Process imported data and generate assets, timing the generation stages into Stats if given */
+	bool ProcessImportData(UDialogueImportData* ImportData, struct FDialogueImportStats* Stats = nullptr);
+
+	/** Whether the file is parsed in the background, see FDialogueAsyncImport */
+	bool ShouldImportAsync() const;
 };
@@ -0,0 +1,30 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDialogueScript;
+struct FDialogueScriptProgram;
+
+/**
+ * Writes the UDialogueScripts subclass of a project: one native function per script,
+ * translated instruction by instruction from its compiled bytecode so that it behaves
+ * exactly like the VM.
+ */
+class DIALOGUEEDITOR_API FDialogueNativeScriptGenerator
+{
+public:
+	/**
+	 * Write <ClassName>.h and <ClassName>.cpp into Directory, ClassName without the U prefix.
+	 * Scripts are registered in order, so a script's index in the array is its NativeIndex.
+	 * Files whose content did not change are left alone to avoid needless rebuilds.
+	 */
+	static bool WriteScriptsClass(const FString& ClassName, const FString& Directory, const TArray<FDialogueScript>& Scripts);
+
+	/** C++ body of the native function of a program, statements only */
+	static FString GenerateFunctionBody(const FDialogueScriptProgram& Program);
+
+private:
+	static bool WriteFileIfChanged(const FString& Filename, const FString& Content);
+};
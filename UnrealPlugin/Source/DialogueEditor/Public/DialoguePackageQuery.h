@@ -0,0 +1,69 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "DialogueTypes.h"
+
+/**
+ * Answers questions about dialogue packages from the tags they save to the asset registry, see DialoguePackageTags,
+ * so tools need not load every package to find out which ones contain an object or speaker.
+ * The tags are parsed on the first query and again after the registry reported a change to a dialogue package.
+ * Packages saved before they had the tags are only found once they are saved again.
+ */
+class DIALOGUEEDITOR_API FDialoguePackageQuery
+{
+public:
+	FDialoguePackageQuery();
+	~FDialoguePackageQuery();
+
+	/** The query of the editor module */
+	static FDialoguePackageQuery& Get();
+
+	/** Packages with dialogues spoken by a character */
+	TArray<FAssetData> FindPackagesWithSpeaker(const FDialogueId& SpeakerId);
+
+	/** Package containing an object, invalid if none does */
+	FAssetData FindPackageWithObject(const FDialogueId& Id);
+
+	/** Packages whose connections or jumps lead into a package */
+	TArray<FAssetData> FindReferencingPackages(FName PackageName);
+
+	/** Packages that the connections and jumps of a package lead into */
+	TArray<FAssetData> FindReferencedPackages(FName PackageName);
+
+	/** Dialogue packages known to the asset registry */
+	const TArray<FAssetData>& GetPackages();
+
+	/** Value of a numerical tag such as DialoguePackageTags::NumDialogues, INDEX_NONE if the package was saved without it */
+	static int64 GetCount(const FAssetData& Package, const TCHAR* Tag);
+
+	/** Call a function for every ID of a list tag such as DialoguePackageTags::Speakers */
+	static void ForEachId(const FAssetData& Package, const TCHAR* Tag, TFunctionRef<void(const FDialogueId&)> Function);
+
+private:
+	/** Parse the tags of all packages, if they changed since the last query */
+	void Update();
+
+	void OnAssetChanged(const FAssetData& Asset);
+	void OnAssetRenamed(const FAssetData& Asset, const FString& OldObjectPath);
+
+	TArray<FAssetData> Packages;
+
+	/** Index in Packages of the package of every object */
+	TMap<FDialogueId, int32> PackageByObject;
+
+	/** Indices in Packages of the packages with dialogues of every speaker */
+	TMultiMap<FDialogueId, int32> PackagesBySpeaker;
+
+	/** Index in Packages by package name */
+	TMap<FName, int32> PackageByName;
+
+	bool bDirty = true;
+
+	FDelegateHandle AddedHandle;
+	FDelegateHandle RemovedHandle;
+	FDelegateHandle UpdatedHandle;
+	FDelegateHandle RenamedHandle;
+};
@@ -0,0 +1,42 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueScaleBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures how importing and loading scale with the size of a project.
+ *
+ * UnrealEditor-Cmd <Project> -run=DialogueScaleBenchmark [-Sizes=1000,10000,100000,1000000] [-Packages=10]
+ *     [-Pins=2] [-TextLength=80] [-ScriptDensity=0.2] [-Seed=1] [-Dest=/Game/Dialogue/ScaleBenchmark]
+ *     [-Report=<Path.csv>] [-KeepFiles]
+ *
+ * For every size, writes a synthetic export with that many objects, imports it, generates its assets,
+ * unloads them and loads every package through UDialogueDatabase::LoadPackage. Time and peak resident
+ * memory of each stage are written as one CSV row per size, to Saved/Logs by default.
+ * Sizes are run in ascending order since the peak of the process never goes down.
+ */
+UCLASS()
+class DIALOGUEEDITOR_API UDialogueScaleBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueScaleBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Write a synthetic export with NumObjects objects, returns false if the file could not be written */
+	bool WriteSyntheticExport(const FString& Filename, const FString& ProjectName, int32 NumObjects) const;
+
+	int32 NumPackages = 10;
+	int32 NumPins = 2;
+	int32 TextLength = 80;
+	float ScriptDensity = 0.2f;
+	int32 NumFlags = 16;
+	int32 Seed = 1;
+	FString DestinationPath = TEXT("/Game/Dialogue/ScaleBenchmark");
+};
@@ -0,0 +1,35 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueSimulateCommandlet.generated.h"
+
+class UDialogueDatabase;
+
+/**
+ * Plays the flows of a database headlessly with FDialogueFlowSimulator, for coverage and balancing in CI.
+ *
+ * UnrealEditor-Cmd <Project> -run=DialogueSimulate [-Database=<ObjectPath>] [-AllPackages] [-Start=<Id>,...]
+ *     [-Playthroughs=100000] [-Steps=256] [-Seed=1] [-Exhaustive] [-Variables=<Name>,...] [-Tasks=0]
+ *     [-ExploreLimit=128] [-Report=<Path.json>] [-FailOnUnreached] [-FailOnExploreLimit]
+ *
+ * Starts at every dialogue unless -Start names nodes by ID. Writes reach, choice, dead end and explore
+ * limit counts per node and the histograms of the -Variables as a JSON report, to Saved/Logs by default.
+ * Returns 1 if a line was never reached or the explore limit was hit and the matching -FailOn switch is given.
+ */
+UCLASS()
+class DIALOGUEEDITOR_API UDialogueSimulateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueSimulateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Load and initialize the database to simulate, the one of the project settings unless -Database is given */
+	UDialogueDatabase* LoadDatabase(const FString& DatabasePath) const;
+};
@@ -0,0 +1,38 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueThreadStressCommandlet.generated.h"
+
+class UDialogueDatabase;
+
+/**
+ * Checks that the threaded dialogue paths give the results of a single task and measures how they scale.
+ *
+ * UnrealEditor-Cmd <Project> -run=DialogueThreadStress [-Database=<ObjectPath>] [-AllPackages] [-Sessions=256]
+ *     [-Steps=64] [-Playthroughs=20000] [-MaxTasks=32] [-Seed=1] [-Report=<Path.json>]
+ *
+ * Many sessions of one FDialogueSessionPool advance over the shared flow graph and variable snapshot, and
+ * FDialogueFlowSimulator plays the same playthroughs, first on one task as the reference and then on 2, 4, ...
+ * up to -MaxTasks tasks. Every run has to end in exactly the reference's sessions and counts. Throughput per
+ * task count is logged and written as a JSON report, to Saved/Logs by default. Returns 1 on any mismatch.
+ *
+ * Flow player components only run on the game thread, the pool's sessions are what runs them concurrently.
+ * Build the editor with -EnableTSan or -EnableASan to run the commandlet under a sanitizer.
+ */
+UCLASS()
+class DIALOGUEEDITOR_API UDialogueThreadStressCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueThreadStressCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Load and initialize the database to run, the one of the project settings unless -Database is given */
+	UDialogueDatabase* LoadDatabase(const FString& DatabasePath) const;
+};
@@ -20,7 +20,15 @@ public class DialogueRuntime : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[]
 		{
 			"Slate",
-			"SlateCore"
+			"SlateCore",
+			"Sockets",
+			"Networking"
 		});
+
+		// Cooked package blobs are shared through the derived data cache
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+		}
 	}
 }
@@ -0,0 +1,317 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueBarkRunner.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeStats.h"
+#include "DialogueScriptVM.h"
+
+FDialogueBarkRunner::FDialogueBarkRunner(UDialogueObject* Start, uint32 Seed, EDialoguePausableType InPauseOn)
+	: Current(Start)
+	, RandomState(Seed ? Seed : 1)
+	, PauseOn((uint8)InPauseOn)
+{
+}
+
+uint32 FDialogueBarkRunner::NextRandom()
+{
+	RandomState ^= RandomState << 13;
+	RandomState ^= RandomState >> 17;
+	RandomState ^= RandomState << 5;
+	return RandomState;
+}
+
+bool FDialogueBarkExplorer::Advance(FDialogueBarkRunner& InRunner, const FDialogueFlowGraph& InGraph, UDialogueGlobalVariables* InGV, UObject* InMethodsProvider)
+{
+	UDialogueObject* Current = InRunner.GetCurrent();
+	const FVertex Start = Current ? InGraph.FindVertex(Current) : FVertex();
+	if (InRunner.bFinished || !Start.IsValid() || !InGV)
+	{
+		return false;
+	}
+
+	Graph = &InGraph;
+	GV = InGV;
+	Overlay = nullptr;
+	MethodsProvider = InMethodsProvider;
+	PauseOn = InRunner.PauseOn;
+	Run(Start, GV->GetShadowLevel());
+
+	if (Lines.Num() == 0)
+	{
+		InRunner.bFinished = true;
+		return false;
+	}
+
+	GatherPath(InRunner.NextRandom() % Lines.Num());
+
+	// Play the path like a flow player plays a branch
+	UDialogueObject* Line = nullptr;
+	for (int32 i = PathSegments.Num() - 1; i >= 0; --i)
+	{
+		Line = InGraph.GetObject(Segments[PathSegments[i]].Vertex);
+		if (IDialogueFlowObject* FlowObject = Cast<IDialogueFlowObject>(Line))
+		{
+			FlowObject->Execute(GV, MethodsProvider);
+		}
+	}
+
+	InRunner.Current = Line;
+	return true;
+}
+
+int32 FDialogueBarkExplorer::Explore(const FDialogueFlowGraph& InGraph, FVertex Start, uint8 InPauseOn, FDialogueVariableOverlay& InOverlay, UObject* InMethodsProvider)
+{
+	Graph = &InGraph;
+	GV = nullptr;
+	Overlay = &InOverlay;
+	MethodsProvider = InMethodsProvider;
+	PauseOn = InPauseOn;
+	Run(Start, 0);
+	return Lines.Num();
+}
+
+void FDialogueBarkExplorer::PlayLine(int32 Line, TArray<int32>* OutPathNodes)
+{
+	check(Overlay);
+	GatherPath(Line);
+
+	// Only instruction nodes and output pins run anything when a branch is played
+	for (int32 i = PathSegments.Num() - 1; i >= 0; --i)
+	{
+		const FVertex Vertex = Segments[PathSegments[i]].Vertex;
+		if (Vertex.bIsPin)
+		{
+			const FDialogueFlowGraphPin& Pin = Graph->Pins[Vertex.Index];
+			if (!Pin.bIsInput && Pin.Program)
+			{
+				ExecuteInstruction(*Pin.Program);
+			}
+			continue;
+		}
+
+		const FDialogueFlowGraphNode& Node = Graph->Nodes[Vertex.Index];
+		if (Node.Kind == EDialogueFlowNodeKind::Instruction && Node.Program)
+		{
+			ExecuteInstruction(*Node.Program);
+		}
+		if (OutPathNodes)
+		{
+			OutPathNodes->Add(Vertex.Index);
+		}
+	}
+}
+
+void FDialogueBarkExplorer::Run(FVertex Start, int32 InShadowLevel)
+{
+	StartVertex = Start;
+	ShadowLevel = BaseShadowLevel = InShadowLevel;
+	NumExploreLimitHits = 0;
+
+	Segments.Reset();
+	Lines.Reset();
+
+	// The start node is where the flow stands, the paths start after it
+	FFrame& Root = Stack.AddDefaulted_GetRef();
+	Root.Vertex = Start;
+	Root.bShadowed = true;
+	while (Stack.Num() > 0)
+	{
+		const FFrame Frame = Stack.Pop(false);
+		if (Frame.bEndShadow)
+		{
+			PopState();
+		}
+		else
+		{
+			Visit(Frame);
+		}
+	}
+}
+
+void FDialogueBarkExplorer::GatherPath(int32 Line)
+{
+	PathSegments.Reset();
+	for (int32 Segment = Lines[Line]; Segment != INDEX_NONE; Segment = Segments[Segment].Parent)
+	{
+		PathSegments.Add(Segment);
+	}
+}
+
+void FDialogueBarkExplorer::PushState()
+{
+	++ShadowLevel;
+	if (Overlay)
+	{
+		Overlay->PushState();
+	}
+	else
+	{
+		GV->PushState(ShadowLevel);
+	}
+}
+
+void FDialogueBarkExplorer::PopState()
+{
+	if (Overlay)
+	{
+		Overlay->PopState();
+	}
+	else
+	{
+		GV->PopState(ShadowLevel);
+	}
+	--ShadowLevel;
+}
+
+bool FDialogueBarkExplorer::EvaluateCondition(const FDialogueScriptProgram& Program) const
+{
+	return Overlay ? FDialogueScriptVM::EvaluateCondition(Program, *Overlay, MethodsProvider) : FDialogueScriptVM::EvaluateCondition(Program, GV, MethodsProvider);
+}
+
+void FDialogueBarkExplorer::ExecuteInstruction(const FDialogueScriptProgram& Program) const
+{
+	if (Overlay)
+	{
+		FDialogueScriptVM::ExecuteInstruction(Program, *Overlay, MethodsProvider);
+	}
+	else
+	{
+		FDialogueScriptVM::ExecuteInstruction(Program, GV, MethodsProvider);
+	}
+}
+
+void FDialogueBarkExplorer::Visit(const FFrame& InFrame)
+{
+	FFrame Frame = InFrame;
+	for (;;)
+	{
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::NodesVisited);
+		if (Frame.Depth > ExploreLimit)
+		{
+			++NumExploreLimitHits;
+			if (bWarnOnExploreLimit)
+			{
+				UE_LOG(LogDialogueRuntime, Warning, TEXT("ExploreLimit (%d) reached, stopping exploration!"), ExploreLimit);
+			}
+			return;
+		}
+
+		const bool bIsCurrent = Frame.Vertex.Index == StartVertex.Index && Frame.Vertex.bIsPin == StartVertex.bIsPin;
+		if (!bIsCurrent && (Graph->GetPausableType(Frame.Vertex) & PauseOn) != 0)
+		{
+			Lines.Add(Segments.Add({ Frame.Vertex, Frame.Parent }));
+			return;
+		}
+
+		const int32 Segment = Frame.Depth == 0 ? INDEX_NONE : Segments.Add({ Frame.Vertex, Frame.Parent });
+
+		// Corridors have nothing to run or choose from
+		const FVertex Next = Graph->GetCorridorNext(Frame.Vertex);
+		if (Next.IsValid())
+		{
+			Frame.Vertex = Next;
+			Frame.Parent = Segment;
+			Frame.Depth += 2;
+			continue;
+		}
+
+		if (Frame.bShadowed && !Graph->IsPure(Frame.Vertex))
+		{
+			if (ShadowLevel - BaseShadowLevel >= ShadowLevelLimit)
+			{
+				return;
+			}
+
+			PushState();
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ShadowPushes);
+			Stack.AddDefaulted_GetRef().bEndShadow = true;
+			Expand(Frame.Vertex, Segment, Frame.Depth + 1, false);
+		}
+		else
+		{
+			Expand(Frame.Vertex, Segment, Frame.Depth + 1, Frame.bShadowed);
+		}
+		return;
+	}
+}
+
+void FDialogueBarkExplorer::Push(FVertex Vertex, int32 Parent, int32 Depth, bool bShadowed)
+{
+	FFrame& Frame = Stack.AddDefaulted_GetRef();
+	Frame.Vertex = Vertex;
+	Frame.Parent = Parent;
+	Frame.Depth = Depth;
+	Frame.bShadowed = bShadowed;
+}
+
+void FDialogueBarkExplorer::Expand(FVertex Vertex, int32 Segment, int32 Depth, bool bShadowChildren)
+{
+	if (Vertex.bIsPin)
+	{
+		const FDialogueFlowGraphPin& Pin = Graph->Pins[Vertex.Index];
+		if (Pin.bIsInput)
+		{
+			if (!Pin.Program || EvaluateCondition(*Pin.Program))
+			{
+				Push(FVertex(Pin.OwnerNode, false), Segment, Depth + 1, bShadowChildren);
+			}
+			return;
+		}
+
+		if (Pin.Program)
+		{
+			ExecuteInstruction(*Pin.Program);
+		}
+
+		const bool bShadowed = bShadowChildren || Pin.NumEdges > 1;
+		for (int32 Edge = Pin.FirstEdge + Pin.NumEdges - 1; Edge >= Pin.FirstEdge; --Edge)
+		{
+			// Dead edges end the branch
+			if (Graph->Edges[Edge] != INDEX_NONE)
+			{
+				Push(FVertex(Graph->Edges[Edge], true), Segment, Depth + 1, bShadowed);
+			}
+		}
+		return;
+	}
+
+	const FDialogueFlowGraphNode& Node = Graph->Nodes[Vertex.Index];
+	switch (Node.Kind)
+	{
+	case EDialogueFlowNodeKind::Custom:
+		return;
+
+	case EDialogueFlowNodeKind::Condition:
+		if (Node.NumOutputPins == 2)
+		{
+			const bool bResult = !Node.Program || EvaluateCondition(*Node.Program);
+			Push(FVertex(Node.FirstOutputPin + (bResult ? 0 : 1), true), Segment, Depth + 1, bShadowChildren);
+			return;
+		}
+		break;
+
+	case EDialogueFlowNodeKind::Instruction:
+		if (Node.Program)
+		{
+			ExecuteInstruction(*Node.Program);
+		}
+		break;
+
+	case EDialogueFlowNodeKind::Jump:
+		if (Node.JumpTargetPin != INDEX_NONE)
+		{
+			Push(FVertex(Node.JumpTargetPin, true), Segment, Depth + 1, bShadowChildren);
+		}
+		return;
+
+	default:
+		break;
+	}
+
+	const bool bShadowed = bShadowChildren || Node.NumOutputPins > 1;
+	for (int32 PinIndex = Node.FirstOutputPin + Node.NumOutputPins - 1; PinIndex >= Node.FirstOutputPin; --PinIndex)
+	{
+		Push(FVertex(PinIndex, true), Segment, Depth + 1, bShadowed);
+	}
+}
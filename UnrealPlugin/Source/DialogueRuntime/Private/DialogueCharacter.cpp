@@ -0,0 +1,19 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueCharacter.h"
+#include "DialogueDatabase.h"
+
+void UDialogueCharacter::Serialize(FArchive& Ar)
+{
+	if (!Ar.IsSaving() || !Ar.IsCooking() || EnumHasAnyFlags(UDialogueDatabase::GetCookedEditorOnlyData(), EDialogueEditorOnlyData::CharacterColors))
+	{
+		Super::Serialize(Ar);
+		return;
+	}
+
+	// Equal to the default, the property is left out of the export
+	const FLinearColor SourceColor = Color;
+	Color = GetClass()->GetDefaultObject<UDialogueCharacter>()->Color;
+	Super::Serialize(Ar);
+	Color = SourceColor;
+}
@@ -0,0 +1,221 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueCompressedTexts.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeStats.h"
+#include "Algo/BinarySearch.h"
+#include "Containers/LruCache.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <atomic>
+
+namespace
+{
+	/** Serialized texts per block; the lines of a conversation end up in a few blocks, and a block in a few kilobytes */
+	constexpr int32 TargetBlockSize = 16 * 1024;
+
+	constexpr int32 DefaultCacheBlocks = 64;
+
+	using FCacheKey = TPair<uint64, int32>;
+
+	/** Decompressed blocks of all packages */
+	struct FTextBlockCache
+	{
+		FCriticalSection Lock;
+		TLruCache<FCacheKey, TArray<FText>> Blocks{ DefaultCacheBlocks };
+		int32 MaxBlocks = DefaultCacheBlocks;
+	};
+
+	FTextBlockCache& GetTextBlockCache()
+	{
+		static FTextBlockCache Cache;
+		return Cache;
+	}
+
+	std::atomic<uint64> NextCacheKey{ 1 };
+}
+
+FArchive& operator<<(FArchive& Ar, FDialogueCompressedTexts::FBlock& Block)
+{
+	return Ar << Block.Offset << Block.CompressedSize << Block.UncompressedSize << Block.FirstText << Block.NumTexts;
+}
+
+void FDialogueCompressedTexts::Build(const TArray<FText>& Texts)
+{
+	Reset();
+	Format = GetCompressionFormat();
+	NumTexts = Texts.Num();
+
+	TArray<uint8> Raw;
+	int32 FirstText = 0;
+	const auto FlushBlock = [this, &Raw, &FirstText](int32 EndText)
+	{
+		FBlock& Block = Blocks.AddDefaulted_GetRef();
+		Block.Offset = Data.Num();
+		Block.UncompressedSize = Raw.Num();
+		Block.FirstText = FirstText;
+		Block.NumTexts = EndText - FirstText;
+
+		int32 CompressedSize = FCompression::CompressMemoryBound(Format, Raw.Num());
+		Data.AddUninitialized(CompressedSize);
+		if (FCompression::CompressMemory(Format, Data.GetData() + Block.Offset, CompressedSize, Raw.GetData(), Raw.Num()) && CompressedSize < Raw.Num())
+		{
+			Block.CompressedSize = CompressedSize;
+		}
+		else
+		{
+			FMemory::Memcpy(Data.GetData() + Block.Offset, Raw.GetData(), Raw.Num());
+			Block.CompressedSize = Raw.Num();
+		}
+		Data.SetNum(Block.Offset + Block.CompressedSize, false);
+
+		Raw.Reset();
+		FirstText = EndText;
+	};
+
+	for (int32 i = 0; i < Texts.Num(); ++i)
+	{
+		// Persistent so texts are written as they are in a package
+		FMemoryWriter Writer(Raw, true, true);
+		FText Text = Texts[i];
+		Writer << Text;
+
+		if (Raw.Num() >= TargetBlockSize)
+		{
+			FlushBlock(i + 1);
+		}
+	}
+
+	if (FirstText < Texts.Num())
+	{
+		FlushBlock(Texts.Num());
+	}
+
+	Data.Shrink();
+}
+
+FText FDialogueCompressedTexts::Get(int32 Index) const
+{
+	FText Result;
+	VisitBlock(Index, [&Result](const TArray<FText>& Texts, int32 TextInBlock)
+	{
+		Result = Texts[TextInBlock];
+	});
+	return Result;
+}
+
+void FDialogueCompressedTexts::Prefetch(int32 Index) const
+{
+	VisitBlock(Index, [](const TArray<FText>&, int32) {});
+}
+
+void FDialogueCompressedTexts::Reset()
+{
+	Blocks.Empty();
+	Data.Empty();
+	Format = NAME_None;
+	NumTexts = 0;
+	RenewCacheKey();
+}
+
+FArchive& operator<<(FArchive& Ar, FDialogueCompressedTexts& Texts)
+{
+	Ar << Texts.Format << Texts.NumTexts << Texts.Blocks << Texts.Data;
+	if (Ar.IsLoading())
+	{
+		Texts.RenewCacheKey();
+	}
+	return Ar;
+}
+
+void FDialogueCompressedTexts::SetCacheSize(int32 NumBlocks)
+{
+	FTextBlockCache& Cache = GetTextBlockCache();
+	FScopeLock Lock(&Cache.Lock);
+
+	NumBlocks = FMath::Max(NumBlocks, 1);
+	if (Cache.MaxBlocks != NumBlocks)
+	{
+		Cache.Blocks.Empty(NumBlocks);
+		Cache.MaxBlocks = NumBlocks;
+	}
+}
+
+FName FDialogueCompressedTexts::GetCompressionFormat()
+{
+	return FCompression::IsFormatValid(NAME_Oodle) ? NAME_Oodle : NAME_Zlib;
+}
+
+void FDialogueCompressedTexts::VisitBlock(int32 Index, TFunctionRef<void(const TArray<FText>&, int32)> Visitor) const
+{
+	if (Index < 0 || Index >= NumTexts)
+	{
+		return;
+	}
+
+	const int32 BlockIndex = Algo::UpperBoundBy(Blocks, Index, &FBlock::FirstText) - 1;
+	if (!Blocks.IsValidIndex(BlockIndex))
+	{
+		return;
+	}
+
+	const FBlock& Block = Blocks[BlockIndex];
+	const FCacheKey Key(CacheKey, BlockIndex);
+	FTextBlockCache& Cache = GetTextBlockCache();
+	{
+		FScopeLock Lock(&Cache.Lock);
+		if (const TArray<FText>* Cached = Cache.Blocks.FindAndTouch(Key))
+		{
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::TextCacheHits);
+			Visitor(*Cached, Index - Block.FirstText);
+			return;
+		}
+	}
+
+	// Decompressed outside of the lock, another thread reading the same block just adds it again
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::TextCacheMisses);
+	TArray<FText> Texts;
+	if (!Decompress(Block, Texts))
+	{
+		return;
+	}
+
+	FScopeLock Lock(&Cache.Lock);
+	Cache.Blocks.Add(Key, Texts);
+	Visitor(Texts, Index - Block.FirstText);
+}
+
+bool FDialogueCompressedTexts::Decompress(const FBlock& Block, TArray<FText>& OutTexts) const
+{
+	LLM_SCOPE_BYTAG(Dialogue_Text);
+
+	TArray<uint8> Raw;
+	if (Block.CompressedSize == Block.UncompressedSize)
+	{
+		Raw.Append(Data.GetData() + Block.Offset, Block.CompressedSize);
+	}
+	else
+	{
+		Raw.SetNumUninitialized(Block.UncompressedSize);
+		if (!FCompression::UncompressMemory(Format, Raw.GetData(), Raw.Num(), Data.GetData() + Block.Offset, Block.CompressedSize))
+		{
+			UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to decompress %d dialogue texts with %s"), Block.NumTexts, *Format.ToString());
+			return false;
+		}
+	}
+
+	FMemoryReader Reader(Raw, true);
+	OutTexts.SetNum(Block.NumTexts);
+	for (FText& Text : OutTexts)
+	{
+		Reader << Text;
+	}
+	return !Reader.IsError();
+}
+
+void FDialogueCompressedTexts::RenewCacheKey()
+{
+	CacheKey = NextCacheKey.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,262 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueContentProbe.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueRuntimeStats.h"
+#include "DialogueScriptVM.h"
+#include "Algo/Unique.h"
+
+void FDialogueContentProbe::Run(const FDialogueFlowGraph& InGraph, FVertex Start, const FDialogueContentFilter& Filter, const TBitArray<>& InSeenNodes,
+	FDialogueVariableOverlay& InOverlay, UObject* InMethodsProvider, bool bInAllowMethods, FResult& OutResult)
+{
+	Graph = &InGraph;
+	SeenNodes = &InSeenNodes;
+	Overlay = &InOverlay;
+	MethodsProvider = InMethodsProvider;
+	Result = &OutResult;
+	StartVertex = Start;
+	PauseOn = Filter.PauseOn;
+	bUnseenOnly = Filter.bUnseenOnly;
+	bAllowMethods = bInAllowMethods;
+	ShadowLevel = 0;
+
+	OutResult = FResult();
+	if (Filter.bIncludeStart && !Start.bIsPin && (InGraph.Nodes[Start.Index].PausableType & PauseOn) != 0)
+	{
+		// A player starting on a line pauses there, whatever follows it
+		OutResult.bHasContent = IsContent(Start.Index);
+		return;
+	}
+
+	// The start node is where the flow stands, the walk starts after it
+	FFrame& Root = Stack.AddDefaulted_GetRef();
+	Root.Vertex = Start;
+	Root.bShadowed = true;
+	while (Stack.Num() > 0 && !OutResult.bHasContent && !OutResult.bNeedsGameThread)
+	{
+		const FFrame Frame = Stack.Pop(false);
+		if (Frame.bEndShadow)
+		{
+			Overlay->PopState();
+			--ShadowLevel;
+		}
+		else
+		{
+			Visit(Frame);
+		}
+	}
+
+	// A walk that stopped early leaves shadow levels open
+	for (; ShadowLevel > 0; --ShadowLevel)
+	{
+		Overlay->PopState();
+	}
+	Stack.Reset();
+
+	OutResult.Dependencies.Sort();
+	OutResult.Dependencies.SetNum(Algo::Unique(OutResult.Dependencies), false);
+}
+
+bool FDialogueContentProbe::IsContent(int32 Node) const
+{
+	return (Graph->Nodes[Node].PausableType & PauseOn) != 0 && (!bUnseenOnly || !(*SeenNodes)[Node]);
+}
+
+bool FDialogueContentProbe::CanRun(FVertex Vertex, const FDialogueScriptProgram& Program)
+{
+	if (Program.Methods.Num() > 0)
+	{
+		if (!bAllowMethods)
+		{
+			Result->bNeedsGameThread = true;
+			return false;
+		}
+		Result->bDependsOnAll = true;
+	}
+	Result->Dependencies.Add(Graph->GetVertexNumber(Vertex));
+	return true;
+}
+
+void FDialogueContentProbe::Visit(const FFrame& InFrame)
+{
+	FFrame Frame = InFrame;
+	for (;;)
+	{
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::NodesVisited);
+		if (Frame.Depth > ExploreLimit)
+		{
+			return;
+		}
+
+		const bool bIsStart = Frame.Vertex.Index == StartVertex.Index && Frame.Vertex.bIsPin == StartVertex.bIsPin;
+		if (!Frame.Vertex.bIsPin)
+		{
+			// A line ends the branch, whether it counts or not
+			if (!bIsStart && (Graph->Nodes[Frame.Vertex.Index].PausableType & PauseOn) != 0)
+			{
+				Result->bHasContent = IsContent(Frame.Vertex.Index);
+				return;
+			}
+
+			// Pauses reached before any condition decides need nothing run to be found
+			bool bOnlyLines = true;
+			for (const int32 Pause : Graph->GetReachablePauses(Frame.Vertex.Index))
+			{
+				if ((Graph->Nodes[Pause].PausableType & PauseOn) == 0)
+				{
+					bOnlyLines = false;
+				}
+				else if (IsContent(Pause))
+				{
+					Result->bHasContent = true;
+					return;
+				}
+			}
+			if (bOnlyLines && Graph->Nodes[Frame.Vertex.Index].bReachesPausesUnconditionally)
+			{
+				// Every way on ends at a line that does not count
+				return;
+			}
+		}
+
+		// A fused corridor tests the conditions on its way at once
+		const FDialogueFlowGraph::FFusedCorridor* Corridor = Graph->GetFusedCorridor(Frame.Vertex);
+		if (Corridor && (Corridor->PausableTypes & PauseOn) == 0 && Frame.Depth + 2 * (Corridor->NumVertices - 1) <= ExploreLimit)
+		{
+			for (const FVertex& Vertex : Graph->GetCorridorVertices(*Corridor))
+			{
+				if (Vertex.bIsPin && Graph->Pins[Vertex.Index].Program && !CanRun(Vertex, *Graph->Pins[Vertex.Index].Program))
+				{
+					return;
+				}
+			}
+			if (!FDialogueScriptVM::EvaluateCondition(Corridor->Program, *Overlay, MethodsProvider))
+			{
+				return;
+			}
+
+			Frame.Vertex = Corridor->End;
+			Frame.Depth += 2 * Corridor->NumVertices;
+			continue;
+		}
+
+		// Corridors have nothing to run or choose from
+		const FVertex Next = Graph->GetCorridorNext(Frame.Vertex);
+		if (Next.IsValid())
+		{
+			Frame.Vertex = Next;
+			Frame.Depth += 2;
+			continue;
+		}
+
+		if (Frame.bShadowed && !Graph->IsPure(Frame.Vertex))
+		{
+			if (ShadowLevel >= ShadowLevelLimit)
+			{
+				return;
+			}
+
+			++ShadowLevel;
+			Overlay->PushState();
+			Stack.AddDefaulted_GetRef().bEndShadow = true;
+			Expand(Frame.Vertex, Frame.Depth + 1, false);
+		}
+		else
+		{
+			Expand(Frame.Vertex, Frame.Depth + 1, Frame.bShadowed);
+		}
+		return;
+	}
+}
+
+void FDialogueContentProbe::Push(FVertex Vertex, int32 Depth, bool bShadowed)
+{
+	FFrame& Frame = Stack.AddDefaulted_GetRef();
+	Frame.Vertex = Vertex;
+	Frame.Depth = Depth;
+	Frame.bShadowed = bShadowed;
+}
+
+void FDialogueContentProbe::Expand(FVertex Vertex, int32 Depth, bool bShadowChildren)
+{
+	if (Vertex.bIsPin)
+	{
+		const FDialogueFlowGraphPin& Pin = Graph->Pins[Vertex.Index];
+		if (Pin.bIsInput)
+		{
+			if (Pin.Program && (!CanRun(Vertex, *Pin.Program) || !FDialogueScriptVM::EvaluateCondition(*Pin.Program, *Overlay, MethodsProvider)))
+			{
+				return;
+			}
+			Push(FVertex(Pin.OwnerNode, false), Depth + 1, bShadowChildren);
+			return;
+		}
+
+		if (Pin.Program)
+		{
+			if (!CanRun(Vertex, *Pin.Program))
+			{
+				return;
+			}
+			FDialogueScriptVM::ExecuteInstruction(*Pin.Program, *Overlay, MethodsProvider);
+		}
+
+		const bool bShadowed = bShadowChildren || Pin.NumEdges > 1;
+		for (int32 Edge = Pin.FirstEdge + Pin.NumEdges - 1; Edge >= Pin.FirstEdge; --Edge)
+		{
+			if (Graph->Edges[Edge] != INDEX_NONE)
+			{
+				Push(FVertex(Graph->Edges[Edge], true), Depth + 1, bShadowed);
+			}
+		}
+		return;
+	}
+
+	const FDialogueFlowGraphNode& Node = Graph->Nodes[Vertex.Index];
+	switch (Node.Kind)
+	{
+	case EDialogueFlowNodeKind::Custom:
+		// Only a flow player can explore it, as for barks the branch ends there
+		return;
+
+	case EDialogueFlowNodeKind::Condition:
+		if (Node.NumOutputPins == 2)
+		{
+			if (Node.Program && !CanRun(Vertex, *Node.Program))
+			{
+				return;
+			}
+			const bool bResult = !Node.Program || FDialogueScriptVM::EvaluateCondition(*Node.Program, *Overlay, MethodsProvider);
+			Push(FVertex(Node.FirstOutputPin + (bResult ? 0 : 1), true), Depth + 1, bShadowChildren);
+			return;
+		}
+		break;
+
+	case EDialogueFlowNodeKind::Instruction:
+		if (Node.Program)
+		{
+			if (!CanRun(Vertex, *Node.Program))
+			{
+				return;
+			}
+			FDialogueScriptVM::ExecuteInstruction(*Node.Program, *Overlay, MethodsProvider);
+		}
+		break;
+
+	case EDialogueFlowNodeKind::Jump:
+		if (Node.JumpTargetPin != INDEX_NONE)
+		{
+			Push(FVertex(Node.JumpTargetPin, true), Depth + 1, bShadowChildren);
+		}
+		return;
+
+	default:
+		break;
+	}
+
+	const bool bShadowed = bShadowChildren || Node.NumOutputPins > 1;
+	for (int32 PinIndex = Node.FirstOutputPin + Node.NumOutputPins - 1; PinIndex >= Node.FirstOutputPin; --PinIndex)
+	{
+		Push(FVertex(PinIndex, true), Depth + 1, bShadowed);
+	}
+}
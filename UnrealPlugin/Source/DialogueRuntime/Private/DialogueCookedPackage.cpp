@@ -0,0 +1,431 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueCookedPackage.h"
+#include "DialogueObject.h"
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#include "DialoguePackage.h"
+#include "DialogueRuntimeModule.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FArchive& operator<<(FArchive& Ar, FDialogueCookedObject& Object)
+{
+	Ar << Object.Class << Object.TechnicalName << Object.Id << Object.ParentId;
+	Ar << Object.FirstChild << Object.NumChildren;
+	Ar << Object.FirstPin << Object.NumInputPins << Object.NumOutputPins;
+	Ar << Object.FirstEdge << Object.NumEdges;
+	Ar << Object.DataOffset << Object.DataSize;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FDialogueCookedEdge& Edge)
+{
+	return Ar << Edge.TargetNodeId << Edge.TargetPinIndex;
+}
+
+FArchive& operator<<(FArchive& Ar, FDialogueCookedPackage& Package)
+{
+	int32 Version = FDialogueCookedPackage::Version;
+	Ar << Version;
+	if (Ar.IsLoading() && Version != FDialogueCookedPackage::Version)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Dialogue package was cooked with format version %d instead of %d, cook it again"),
+			Version, FDialogueCookedPackage::Version);
+		Ar.SetError();
+		Package.Reset();
+		return Ar;
+	}
+
+	Ar << Package.Strings << Package.Objects << Package.Pins << Package.Edges << Package.ChildIds << Package.Data << Package.Texts;
+	return Ar;
+}
+
+namespace
+{
+	/** Only classes of this module are known to store all of their properties in SerializeCooked */
+	bool IsCookableClass(const UObject* Object)
+	{
+		return Object && Object->GetClass()->GetOutermost() == UDialogueObject::StaticClass()->GetOutermost();
+	}
+
+	FDialogueScript* FindScript(UDialogueObject* Object)
+	{
+		if (UDialogueCondition* Condition = Cast<UDialogueCondition>(Object))
+		{
+			return &Condition->Script;
+		}
+		if (UDialogueInstruction* Instruction = Cast<UDialogueInstruction>(Object))
+		{
+			return &Instruction->Script;
+		}
+		if (UDialogueInputPin* InputPin = Cast<UDialogueInputPin>(Object))
+		{
+			return &InputPin->Script;
+		}
+		if (UDialogueOutputPin* OutputPin = Cast<UDialogueOutputPin>(Object))
+		{
+			return &OutputPin->Script;
+		}
+		return nullptr;
+	}
+
+	/** Properties of an object changed while it is written, put back when the scope ends */
+	class FScopedCookedValues
+	{
+	public:
+		~FScopedCookedValues()
+		{
+			for (int32 i = Restores.Num() - 1; i >= 0; --i)
+			{
+				Restores[i]();
+			}
+		}
+
+		template<typename T>
+		void Replace(T& Value, T NewValue)
+		{
+			Restores.Add([&Value, Saved = MoveTemp(Value)]() mutable { Value = MoveTemp(Saved); });
+			Value = MoveTemp(NewValue);
+		}
+
+	private:
+		TArray<TFunction<void()>, TInlineAllocator<4>> Restores;
+	};
+
+	/** Empty the editor-only data of an object that is not kept */
+	void StripEditorOnlyData(UDialogueObject* Object, EDialogueEditorOnlyData Keep, FScopedCookedValues& Values)
+	{
+		UDialogueFlowFragment* Fragment = Cast<UDialogueFlowFragment>(Object);
+		if (Fragment && !EnumHasAnyFlags(Keep, EDialogueEditorOnlyData::FragmentDescriptions))
+		{
+			Values.Replace(Fragment->Description, FText());
+		}
+
+		UDialogueOutputPin* OutputPin = Cast<UDialogueOutputPin>(Object);
+		if (OutputPin && !EnumHasAnyFlags(Keep, EDialogueEditorOnlyData::PinLabels))
+		{
+			Values.Replace(OutputPin->Label, FString());
+		}
+
+		// Scripts that did not compile are compiled again on load and need their text
+		FDialogueScript* Script = FindScript(Object);
+		if (Script && Script->Program.IsCompiled() && !EnumHasAnyFlags(Keep, EDialogueEditorOnlyData::ScriptExpressions))
+		{
+			Values.Replace(Script->StrippedExpressionHash, Script->GetExpressionHash());
+			Values.Replace(Script->Expression, FString());
+		}
+	}
+}
+
+bool FDialogueCookedPackage::CanBuild(const TArray<UDialogueObject*>& InObjects)
+{
+	for (const UDialogueObject* Object : InObjects)
+	{
+		if (!IsCookableClass(Object))
+		{
+			return false;
+		}
+
+		const UDialogueNode* Node = Cast<UDialogueNode>(Object);
+		if (!Node)
+		{
+			continue;
+		}
+
+		// Owner and index of a pin follow from where it is stored
+		for (int32 i = 0; i < Node->InputPins.Num(); ++i)
+		{
+			const UDialogueInputPin* Pin = Node->InputPins[i];
+			if (!IsCookableClass(Pin) || Pin->OwnerId != Node->Id || Pin->Index != i)
+			{
+				return false;
+			}
+		}
+
+		for (int32 i = 0; i < Node->OutputPins.Num(); ++i)
+		{
+			const UDialogueOutputPin* Pin = Node->OutputPins[i];
+			if (!IsCookableClass(Pin) || Pin->OwnerId != Node->Id || Pin->Index != i)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool FDialogueCookedPackage::Build(const TArray<UDialogueObject*>& InObjects, EDialogueEditorOnlyData Keep, bool bCompressTexts)
+{
+	Reset();
+	if (!CanBuild(InObjects))
+	{
+		return false;
+	}
+
+	// Rows stay in object order, their data is laid out in the order the flow reaches the objects
+	Objects.SetNum(InObjects.Num());
+	for (const int32 i : GetTraversalOrder(InObjects))
+	{
+		AddObject(InObjects[i], Objects[i], Keep, bCompressTexts);
+
+		UDialogueNode* Node = Cast<UDialogueNode>(InObjects[i]);
+		if (!Node)
+		{
+			continue;
+		}
+
+		FDialogueCookedObject& Row = Objects[i];
+		Row.FirstPin = Pins.Num();
+		Row.NumInputPins = Node->InputPins.Num();
+		Row.NumOutputPins = Node->OutputPins.Num();
+		Pins.SetNum(Row.FirstPin + Row.NumInputPins + Row.NumOutputPins);
+
+		for (int32 PinIndex = 0; PinIndex < Row.NumInputPins; ++PinIndex)
+		{
+			AddObject(Node->InputPins[PinIndex], Pins[Row.FirstPin + PinIndex], Keep, bCompressTexts);
+		}
+
+		for (int32 PinIndex = 0; PinIndex < Row.NumOutputPins; ++PinIndex)
+		{
+			UDialogueOutputPin* Pin = Node->OutputPins[PinIndex];
+			FDialogueCookedObject& PinRow = Pins[Row.FirstPin + Row.NumInputPins + PinIndex];
+			AddObject(Pin, PinRow, Keep, bCompressTexts);
+
+			PinRow.FirstEdge = Edges.Num();
+			PinRow.NumEdges = Pin->Edges.Num();
+			for (const FDialogueConnection& Connection : Pin->Edges)
+			{
+				FDialogueCookedEdge& Edge = Edges.AddDefaulted_GetRef();
+				Edge.TargetNodeId = Connection.TargetNodeId;
+				Edge.TargetPinIndex = Connection.TargetPinIndex;
+			}
+		}
+	}
+
+	if (PendingTexts.Num() > 0)
+	{
+		Texts.Build(PendingTexts);
+	}
+
+	StringIndices.Empty();
+	PendingTexts.Empty();
+	return true;
+}
+
+TArray<int32> FDialogueCookedPackage::GetTraversalOrder(const TArray<UDialogueObject*>& InObjects)
+{
+	TMap<FDialogueId, int32> IndicesById;
+	IndicesById.Reserve(InObjects.Num());
+	for (int32 i = 0; i < InObjects.Num(); ++i)
+	{
+		IndicesById.Add(InObjects[i]->Id, i);
+	}
+
+	TArray<int32> Order;
+	Order.Reserve(InObjects.Num());
+	TBitArray<> Visited(false, InObjects.Num());
+	TArray<int32> Stack;
+	TArray<int32, TInlineAllocator<16>> Next;
+	for (int32 Root = 0; Root < InObjects.Num(); ++Root)
+	{
+		Stack.Push(Root);
+		while (Stack.Num() > 0)
+		{
+			const int32 Index = Stack.Pop(false);
+			if (Visited[Index])
+			{
+				continue;
+			}
+			Visited[Index] = true;
+			Order.Add(Index);
+
+			// Children come right after their parent, then the nodes its connections lead to
+			Next.Reset();
+			const UDialogueObject* Object = InObjects[Index];
+			for (const FDialogueId& ChildId : Object->ChildIds)
+			{
+				if (const int32* ChildIndex = IndicesById.Find(ChildId))
+				{
+					Next.Add(*ChildIndex);
+				}
+			}
+			if (const UDialogueNode* Node = Cast<UDialogueNode>(Object))
+			{
+				for (const UDialogueOutputPin* Pin : Node->OutputPins)
+				{
+					for (const FDialogueConnection& Connection : Pin->Edges)
+					{
+						if (const int32* TargetIndex = IndicesById.Find(Connection.TargetNodeId))
+						{
+							Next.Add(*TargetIndex);
+						}
+					}
+				}
+			}
+
+			for (int32 i = Next.Num() - 1; i >= 0; --i)
+			{
+				if (!Visited[Next[i]])
+				{
+					Stack.Push(Next[i]);
+				}
+			}
+		}
+	}
+	return Order;
+}
+
+void FDialogueCookedPackage::AddObject(UDialogueObject* Object, FDialogueCookedObject& OutRow, EDialogueEditorOnlyData Keep, bool bCompressTexts)
+{
+	OutRow.Class = AddString(Object->GetClass()->GetPathName());
+	OutRow.TechnicalName = Object->TechnicalName.IsEmpty() ? INDEX_NONE : AddString(Object->TechnicalName);
+	OutRow.Id = Object->Id;
+	OutRow.ParentId = Object->ParentId;
+
+	OutRow.FirstChild = ChildIds.Num();
+	OutRow.NumChildren = Object->ChildIds.Num();
+	ChildIds.Append(Object->ChildIds);
+
+	// Persistent so texts are written as they are in a package
+	FMemoryWriter Writer(Data, true, true);
+	OutRow.DataOffset = Data.Num();
+	{
+		FScopedCookedValues Values;
+		StripEditorOnlyData(Object, Keep, Values);
+
+		// The texts of a dialogue go to the compressed texts in this order, see UDialogueDialogue::CompressedTextIndex
+		UDialogueDialogue* Dialogue = Cast<UDialogueDialogue>(Object);
+		if (Dialogue && bCompressTexts)
+		{
+			Values.Replace(Dialogue->CompressedTextIndex, PendingTexts.Num());
+			PendingTexts.Add(Dialogue->Text);
+			PendingTexts.Add(Dialogue->MenuText);
+			PendingTexts.Add(Dialogue->StageDirections);
+			Values.Replace(Dialogue->Text, FText());
+			Values.Replace(Dialogue->MenuText, FText());
+			Values.Replace(Dialogue->StageDirections, FText());
+		}
+
+		Object->SerializeCooked(Writer);
+	}
+	OutRow.DataSize = Data.Num() - OutRow.DataOffset;
+}
+
+int32 FDialogueCookedPackage::AddString(const FString& String)
+{
+	if (const int32* Index = StringIndices.Find(String))
+	{
+		return *Index;
+	}
+	return StringIndices.Add(String, Strings.Add(String));
+}
+
+void FDialogueCookedPackage::Instantiate(UDialoguePackage* Package, TArray<UDialogueObject*>& OutObjects) const
+{
+	TArray<UClass*> Classes;
+	Classes.SetNumZeroed(Strings.Num());
+
+	FMemoryReader Reader(Data, true);
+
+	OutObjects.Reset(Objects.Num());
+	for (const FDialogueCookedObject& Row : Objects)
+	{
+		UDialogueObject* Object = CreateObject(Row, Package, Classes, Reader);
+		if (!Object)
+		{
+			continue;
+		}
+		OutObjects.Add(Object);
+
+		UDialogueNode* Node = Cast<UDialogueNode>(Object);
+		if (!Node)
+		{
+			continue;
+		}
+
+		Node->InputPins.Reserve(Row.NumInputPins);
+		for (int32 PinIndex = 0; PinIndex < Row.NumInputPins; ++PinIndex)
+		{
+			UDialogueInputPin* Pin = Cast<UDialogueInputPin>(CreateObject(Pins[Row.FirstPin + PinIndex], Node, Classes, Reader));
+			if (Pin)
+			{
+				Pin->OwnerId = Node->Id;
+				Pin->Index = PinIndex;
+			}
+			Node->InputPins.Add(Pin);
+		}
+
+		Node->OutputPins.Reserve(Row.NumOutputPins);
+		for (int32 PinIndex = 0; PinIndex < Row.NumOutputPins; ++PinIndex)
+		{
+			const FDialogueCookedObject& PinRow = Pins[Row.FirstPin + Row.NumInputPins + PinIndex];
+			UDialogueOutputPin* Pin = Cast<UDialogueOutputPin>(CreateObject(PinRow, Node, Classes, Reader));
+			if (Pin)
+			{
+				Pin->OwnerId = Node->Id;
+				Pin->Index = PinIndex;
+
+				Pin->Edges.Reserve(PinRow.NumEdges);
+				for (int32 EdgeIndex = PinRow.FirstEdge; EdgeIndex < PinRow.FirstEdge + PinRow.NumEdges; ++EdgeIndex)
+				{
+					FDialogueConnection& Connection = Pin->Edges.AddDefaulted_GetRef();
+					Connection.TargetNodeId = Edges[EdgeIndex].TargetNodeId;
+					Connection.TargetPinIndex = Edges[EdgeIndex].TargetPinIndex;
+				}
+			}
+			Node->OutputPins.Add(Pin);
+		}
+	}
+}
+
+UDialogueObject* FDialogueCookedPackage::CreateObject(const FDialogueCookedObject& Row, UObject* Outer, TArray<UClass*>& Classes, FArchive& Reader) const
+{
+	UClass*& Class = Classes[Row.Class];
+	if (!Class)
+	{
+		Class = FindObject<UClass>(nullptr, *Strings[Row.Class]);
+	}
+
+	if (!Class || !Class->IsChildOf(UDialogueObject::StaticClass()))
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Unknown dialogue class %s in cooked package %s, object %s skipped"),
+			*Strings[Row.Class], *Outer->GetPathName(), *Row.Id.ToString());
+		return nullptr;
+	}
+
+	UDialogueObject* Object = NewObject<UDialogueObject>(Outer, Class);
+	Object->Id = Row.Id;
+	Object->ParentId = Row.ParentId;
+	if (Row.TechnicalName != INDEX_NONE)
+	{
+		Object->TechnicalName = Strings[Row.TechnicalName];
+	}
+	Object->ChildIds.Append(ChildIds.GetData() + Row.FirstChild, Row.NumChildren);
+
+	Reader.Seek(Row.DataOffset);
+	Object->SerializeCooked(Reader);
+	ensureMsgf(Reader.Tell() == Row.DataOffset + Row.DataSize, TEXT("%s read %lld bytes of cooked data instead of %d"),
+		*Object->GetPathName(), Reader.Tell() - Row.DataOffset, Row.DataSize);
+
+	return Object;
+}
+
+FString FDialogueCookedPackage::GetDerivedDataKeySuffix(const FString& SourceHash, EDialogueEditorOnlyData Keep, bool bCompressTexts)
+{
+	const FString TextFormat = bCompressTexts ? FDialogueCompressedTexts::GetCompressionFormat().ToString() : TEXT("None");
+	return FString::Printf(TEXT("%s_V%d_K%d_%s"), *SourceHash, Version, static_cast<int32>(Keep), *TextFormat);
+}
+
+void FDialogueCookedPackage::Reset()
+{
+	Strings.Empty();
+	Objects.Empty();
+	Pins.Empty();
+	Edges.Empty();
+	ChildIds.Empty();
+	Data.Empty();
+	Texts.Reset();
+	StringIndices.Empty();
+	PendingTexts.Empty();
+}
@@ -0,0 +1,1106 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueDatabase.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueObject.h"
+#include "DialogueCharacter.h"
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#include "DialoguePackage.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeStats.h"
+#include "DialogueSubsystem.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Async/Async.h"
+#include "UObject/UObjectIterator.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
+
+TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UDialogueDatabase>> UDialogueDatabase::WorldInstances;
+TWeakObjectPtr<UDialogueDatabase> UDialogueDatabase::PersistentInstance;
+uint32 UDialogueDatabase::Generation = 1;
+
+UDialogueDatabase::UDialogueDatabase()
+{
+	DefaultGlobalVariables = nullptr;
+	CachedGlobalVariables = nullptr;
+	GlobalVariablesClass = UDialogueGlobalVariables::StaticClass();
+}
+
+UDialogueDatabase* UDialogueDatabase::Get(const UObject* WorldContext)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull) : nullptr;
+	if (World)
+	{
+		// Worlds without subsystems, e.g. inactive ones, fall back to the instance map
+		UDialogueSubsystem* Subsystem = World->GetSubsystem<UDialogueSubsystem>();
+		return Subsystem ? Subsystem->GetDatabase() : GetOrCreateForWorld(World);
+	}
+
+	// Dialogue assets have no world; use whichever instance is running
+	if (PersistentInstance.IsValid())
+	{
+		return PersistentInstance.Get();
+	}
+	for (const TPair<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UDialogueDatabase>>& Pair : WorldInstances)
+	{
+		if (Pair.Key.IsValid() && Pair.Value.IsValid())
+		{
+			return Pair.Value.Get();
+		}
+	}
+
+	UDialogueDatabase* Original = GetOriginal();
+	if (!Original)
+	{
+		return nullptr;
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue_Database);
+	UDialogueDatabase* Instance = DuplicateObject<UDialogueDatabase>(Original, GetTransientPackage());
+	FDialogueRuntimeStats::AddCount(FDialogueRuntimeStats::ECounter::ObjectsDuplicated, 1);
+	Instance->AddToRoot();
+	Instance->Initialize();
+	PersistentInstance = Instance;
+	return Instance;
+}
+
+void UDialogueDatabase::Initialize()
+{
+	if (bIsInitialized)
+	{
+		return;
+	}
+
+	bIsInitialized = true;
+	FDialogueCompressedTexts::SetCacheSize(CompressedTextCacheBlocks);
+	RebuildIndices();
+	LoadDefaultPackages();
+
+	UE_LOG(LogDialogueRuntime, Verbose, TEXT("DialogueDatabase %s initialized"), *GetName());
+}
+
+void UDialogueDatabase::Deinitialize()
+{
+	if (!bIsInitialized)
+	{
+		return;
+	}
+
+	WaitForIndexBuild();
+	while (PendingPackageLoads.Num() > 0)
+	{
+		CompletePendingPackageLoad(PendingPackageLoads[0].PackageName, false);
+	}
+
+	LoadedPackages.Reset();
+	PackageResidency.Reset();
+	RebuildIndices();
+	TextPool.Reset();
+	TextSearchIndex.Reset();
+	CachedGlobalVariables = nullptr;
+	ShadowLevel = 0;
+	bIsInitialized = false;
+
+	UE_LOG(LogDialogueRuntime, Verbose, TEXT("DialogueDatabase %s deinitialized"), *GetName());
+}
+
+// ==================== OBJECT ACCESS ====================
+
+UDialogueObject* UDialogueDatabase::GetObject(const FDialogueId& Id, TSubclassOf<UDialogueObject> Class) const
+{
+	UDialogueObject* const* Object = ObjectIndex->ObjectsById.Find(Id);
+	if (!Object || (Class && !(*Object)->IsA(Class)))
+	{
+		return nullptr;
+	}
+	return *Object;
+}
+
+UDialogueObject* UDialogueDatabase::GetObject(const FString& Id, TSubclassOf<UDialogueObject> Class) const
+{
+	UDialogueObject* Object = FindCached(IdLookups, Id, [&]() { return GetObject(FDialogueId::FromImportId(Id)); });
+	if (!Object || (Class && !Object->IsA(Class)))
+	{
+		return nullptr;
+	}
+	return Object;
+}
+
+UDialogueObject* UDialogueDatabase::GetObjectByName(const FString& TechnicalName, TSubclassOf<UDialogueObject> Class) const
+{
+	UDialogueObject* Object = FindCached(NameLookups, TechnicalName, [&]() { return ObjectIndex->ObjectsByName.FindRef(TechnicalName); });
+	if (!Object || (Class && !Object->IsA(Class)))
+	{
+		return nullptr;
+	}
+	return Object;
+}
+
+UDialogueDatabase::FLookupCache::FEntry& UDialogueDatabase::FLookupCache::GetEntry(const FString& Key)
+{
+	// Cheaper than hashing the whole key; IDs and names mostly differ in their length and last characters
+	const int32 Len = Key.Len();
+	const uint32 Hash = Len < 2 ? Len : Len * 31u + Key[Len - 1] * 17u + Key[Len - 2] * 7u + Key[Len / 2];
+	return Entries[Hash % NumEntries];
+}
+
+UDialogueObject* UDialogueDatabase::FindCached(FLookupCache& Cache, const FString& Key, TFunctionRef<UDialogueObject*()> Find) const
+{
+	// Workers exploring in parallel look objects up too
+	if (!IsInGameThread())
+	{
+		return Find();
+	}
+
+	FLookupCache::FEntry& Entry = Cache.GetEntry(Key);
+	if (Entry.Generation == Generation && Entry.Key.Equals(Key, ESearchCase::CaseSensitive))
+	{
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::LookupCacheHits);
+		return Entry.Object;
+	}
+
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::LookupCacheMisses);
+	Entry.Key = Key;
+	Entry.Object = Find();
+	Entry.Generation = Generation;
+	return Entry.Object;
+}
+
+TArray<UDialogueObject*> UDialogueDatabase::GetObjectsOfClass(TSubclassOf<UDialogueObject> Class) const
+{
+	return TArray<UDialogueObject*>(GetObjectsOfClassView(Class));
+}
+
+TArrayView<UDialogueObject* const> UDialogueDatabase::GetObjectsOfClassView(const UClass* Class) const
+{
+	return ObjectIndex->GetObjectsOfClass(Class ? Class : UDialogueObject::StaticClass());
+}
+
+TArray<UDialogueObject*> UDialogueDatabase::GetAllObjects() const
+{
+	TArray<UDialogueObject*> Result;
+	ObjectIndex->ObjectsById.GenerateValueArray(Result);
+	return Result;
+}
+
+TArray<FDialogueId> UDialogueDatabase::SearchText(const FString& Query, int32 Limit)
+{
+	if (TextSearchIndex.GetLanguage() != FInternationalization::Get().GetCurrentLanguage()->GetName())
+	{
+		RebuildTextSearchIndex();
+	}
+
+	// Streamed packages are indexed before their objects can be looked up
+	return TextSearchIndex.Search(Query, Limit, [this](const FDialogueId& Id) { return ObjectIndex->ObjectsById.Contains(Id); });
+}
+
+// ==================== CHARACTERS ====================
+
+UDialogueCharacter* UDialogueDatabase::GetCharacter(const FDialogueId& Id) const
+{
+	return CharactersById.FindRef(Id);
+}
+
+UDialogueCharacter* UDialogueDatabase::GetCharacter(const FString& Id) const
+{
+	return GetCharacter(FDialogueId::FromImportId(Id));
+}
+
+UDialogueCharacter* UDialogueDatabase::GetCharacterByName(const FString& TechnicalName) const
+{
+	return CharactersByName.FindRef(TechnicalName);
+}
+
+TArray<UDialogueCharacter*> UDialogueDatabase::GetAllCharacters() const
+{
+	return Characters;
+}
+
+// ==================== GLOBAL VARIABLES ====================
+
+UDialogueGlobalVariables* UDialogueDatabase::GetGlobalVariables() const
+{
+	if (!CachedGlobalVariables)
+	{
+		UObject* Outer = const_cast<UDialogueDatabase*>(this);
+		LLM_SCOPE_BYTAG(Dialogue_GlobalVariables);
+		if (DefaultGlobalVariables)
+		{
+			// Copies slots, views and default values in one go
+			CachedGlobalVariables = DuplicateObject<UDialogueGlobalVariables>(DefaultGlobalVariables, Outer);
+			FDialogueRuntimeStats::AddCount(FDialogueRuntimeStats::ECounter::ObjectsDuplicated, 1);
+		}
+		else
+		{
+			UClass* Class = GlobalVariablesClass ? GlobalVariablesClass.Get() : UDialogueGlobalVariables::StaticClass();
+			CachedGlobalVariables = NewObject<UDialogueGlobalVariables>(Outer, Class);
+		}
+	}
+	return CachedGlobalVariables;
+}
+
+// ==================== PACKAGES ====================
+
+void UDialogueDatabase::LoadPackage(const FString& PackageName)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueLoadPackage);
+	LLM_SCOPE_BYTAG(Dialogue_Packages);
+
+	if (LoadedPackages.Contains(PackageName))
+	{
+		UE_LOG(LogDialogueRuntime, Log, TEXT("Package %s already loaded."), *PackageName);
+		return;
+	}
+
+	const TSoftObjectPtr<UDialoguePackage>* SoftPackage = ImportedPackages.Find(PackageName);
+	UDialoguePackage* Package = SoftPackage ? SoftPackage->LoadSynchronous() : nullptr;
+	if (!Package)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to find package %s in imported packages!"), *PackageName);
+		return;
+	}
+
+	PreparePackage(Package);
+
+	FDialogueObjectIndex& Index = GetMutableObjectIndex();
+	Index.AddPackage(Package, true);
+	Index.BuildFlowGraph();
+	Index.BuildHierarchy();
+	BindJumpTargets();
+
+	LoadedPackages.Add(PackageName, Package);
+
+	// A synchronous load overtakes an asynchronous one
+	CompletePendingPackageLoad(PackageName, true);
+
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Package %s loaded successfully."), *PackageName);
+	OnPackageLoaded(PackageName);
+}
+
+void UDialogueDatabase::LoadPackageAsync(const FString& PackageName, const FOnDialoguePackageLoaded& OnLoaded)
+{
+	if (LoadedPackages.Contains(PackageName))
+	{
+		OnLoaded.ExecuteIfBound(PackageName, true);
+		return;
+	}
+
+	if (FPendingPackageLoad* Pending = PendingPackageLoads.FindByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; }))
+	{
+		Pending->Callbacks.Add(OnLoaded);
+		return;
+	}
+
+	const TSoftObjectPtr<UDialoguePackage>* SoftPackage = ImportedPackages.Find(PackageName);
+	if (!SoftPackage || SoftPackage->IsNull())
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to find package %s in imported packages!"), *PackageName);
+		OnLoaded.ExecuteIfBound(PackageName, false);
+		return;
+	}
+
+	FPendingPackageLoad& Pending = PendingPackageLoads.AddDefaulted_GetRef();
+	Pending.PackageName = PackageName;
+	Pending.Callbacks.Add(OnLoaded);
+
+	// Already loaded packages complete on the next tick, never from within this call
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(SoftPackage->ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &UDialogueDatabase::OnPackageStreamed, PackageName));
+	PendingPackageLoads.Last().Handle = Handle;
+}
+
+bool UDialogueDatabase::IsPackageLoading(const FString& PackageName) const
+{
+	return PendingPackageLoads.ContainsByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; });
+}
+
+bool UDialogueDatabase::UnloadPackage(const FString& PackageName)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueUnloadPackage);
+
+	// The worker may be reading objects of this package
+	WaitForIndexBuild();
+
+	UDialoguePackage* Package = nullptr;
+	if (!LoadedPackages.RemoveAndCopyValue(PackageName, Package))
+	{
+		UE_LOG(LogDialogueRuntime, Log, TEXT("Package %s can't be unloaded due to not being loaded in the first place."), *PackageName);
+		return false;
+	}
+	PackageResidency.RemoveLoaded(PackageName);
+
+	// Only this package's objects leave the index; shared ones stay referenced by the other packages
+	FDialogueObjectIndex& Index = GetMutableObjectIndex();
+	if (Package)
+	{
+		Index.RemovePackage(Package);
+	}
+	Index.BuildFlowGraph();
+	Index.BuildHierarchy();
+	BindJumpTargets();
+	RebuildTextPool();
+	if (TextSearchIndex.IsBuilt())
+	{
+		// Objects of other packages may be indexed under the released package's copies
+		RebuildTextSearchIndex();
+	}
+
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Package %s unloaded successfully."), *PackageName);
+	return true;
+}
+
+void UDialogueDatabase::LoadDefaultPackages()
+{
+	for (const FString& PackageName : DefaultPackageNames)
+	{
+		if (bLoadDefaultPackagesAsync)
+		{
+			LoadPackageAsync(PackageName, FOnDialoguePackageLoaded());
+		}
+		else
+		{
+			LoadPackage(PackageName);
+		}
+	}
+}
+
+TArray<FString> UDialogueDatabase::GetLoadedPackageNames() const
+{
+	TArray<FString> Names;
+	LoadedPackages.GenerateKeyArray(Names);
+	return Names;
+}
+
+int64 UDialogueDatabase::GetPackageResidentBytes(const FString& PackageName) const
+{
+	UDialoguePackage* Package = LoadedPackages.FindRef(PackageName);
+	if (!Package)
+	{
+		return 0;
+	}
+
+	// Objects are counted by serializing them, which includes their texts unless they are compressed
+	int64 Bytes = Package->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) + Package->GetCompressedTexts().GetAllocatedSize();
+	for (UDialogueObject* Object : Package->Objects)
+	{
+		if (Object)
+		{
+			Bytes += Object->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+	}
+	return Bytes;
+}
+
+void UDialogueDatabase::RequestPackage(const FString& PackageName, const FOnDialoguePackageLoaded& OnLoaded)
+{
+	PackageResidency.Touch(PackageName);
+	LoadPackageAsync(PackageName, OnLoaded);
+}
+
+void UDialogueDatabase::PinPackage(const FString& PackageName)
+{
+	PackageResidency.Pin(PackageName);
+}
+
+void UDialogueDatabase::UnpinPackage(const FString& PackageName)
+{
+	PackageResidency.Unpin(PackageName);
+}
+
+int32 UDialogueDatabase::EnforcePackageBudget()
+{
+	if (ResidentPackageBudget <= 0 || PackageResidency.GetResidentBytes() <= ResidentPackageBudget)
+	{
+		return 0;
+	}
+
+	// Packages being played are the most recently used ones
+	const TSet<FString> PlayedPackages = GatherPlayedPackages();
+	for (const FString& PackageName : PlayedPackages)
+	{
+		PackageResidency.Touch(PackageName);
+	}
+
+	const TArray<FString> Unloads = PackageResidency.SelectUnloads(ResidentPackageBudget, [this, &PlayedPackages](const FString& PackageName)
+	{
+		return !PlayedPackages.Contains(PackageName) && !DefaultPackageNames.Contains(PackageName);
+	});
+
+	for (const FString& PackageName : Unloads)
+	{
+		UE_LOG(LogDialogueRuntime, Verbose, TEXT("Unloading package %s to stay within the resident package budget"), *PackageName);
+		UnloadPackage(PackageName);
+	}
+
+	if (PackageResidency.GetResidentBytes() > ResidentPackageBudget)
+	{
+		UE_LOG(LogDialogueRuntime, Verbose, TEXT("Loaded packages take %lld bytes, over the budget of %lld; the rest is in use"),
+			PackageResidency.GetResidentBytes(), ResidentPackageBudget);
+	}
+	return Unloads.Num();
+}
+
+bool UDialogueDatabase::MountPackages(const FString& MountName, const TArray<UDialoguePackage*>& Packages, UDialogueGlobalVariables* Variables)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueLoadPackage);
+	LLM_SCOPE_BYTAG(Dialogue_Packages);
+
+	if (MountedPackageNames.Contains(MountName))
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Packages are mounted as %s already."), *MountName);
+		return false;
+	}
+
+	if (ShadowLevel > 0)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Can't mount %s while exploring in a shadow state!"), *MountName);
+		return false;
+	}
+
+	for (const UDialoguePackage* Package : Packages)
+	{
+		if (!Package || ImportedPackages.Contains(Package->Name))
+		{
+			UE_LOG(LogDialogueRuntime, Error, TEXT("Can't mount %s, package %s is missing or its name is taken!"), *MountName, Package ? *Package->Name : TEXT("None"));
+			return false;
+		}
+	}
+
+	// New variables are appended, the slots scripts and flow players already use stay valid
+	if (Variables)
+	{
+		const int32 NumAdded = GetGlobalVariables()->MergeVariables(*Variables);
+		if (DefaultGlobalVariables && DefaultGlobalVariables != CachedGlobalVariables)
+		{
+			// The runtime variables are copied from it again after Deinitialize
+			DefaultGlobalVariables->MergeVariables(*Variables);
+		}
+		UE_LOG(LogDialogueRuntime, Verbose, TEXT("Mounting %s added %d variables"), *MountName, NumAdded);
+	}
+
+	TArray<FString>& Names = MountedPackageNames.Add(MountName);
+	TArray<UDialoguePackage*> Loads;
+	for (UDialoguePackage* Package : Packages)
+	{
+		ImportedPackages.Add(Package->Name, Package);
+		MountedPackages.Add(Package);
+		Names.Add(Package->Name);
+		if (Package->bIsDefaultPackage)
+		{
+			Loads.Add(Package);
+		}
+	}
+
+	if (Loads.Num() > 0)
+	{
+		// Only the mounted objects are added, the graph is baked once for all of them
+		for (UDialoguePackage* Package : Loads)
+		{
+			PreparePackage(Package);
+		}
+
+		FDialogueObjectIndex& Index = GetMutableObjectIndex();
+		for (const UDialoguePackage* Package : Loads)
+		{
+			Index.AddPackage(Package, true);
+		}
+		Index.BuildFlowGraph();
+		Index.BuildHierarchy();
+		BindJumpTargets();
+
+		for (UDialoguePackage* Package : Loads)
+		{
+			LoadedPackages.Add(Package->Name, Package);
+		}
+		for (const UDialoguePackage* Package : Loads)
+		{
+			OnPackageLoaded(Package->Name);
+		}
+	}
+
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Mounted %d packages as %s, %d of them loaded."), Packages.Num(), *MountName, Loads.Num());
+	return true;
+}
+
+bool UDialogueDatabase::UnmountPackages(const FString& MountName)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueUnloadPackage);
+
+	const TArray<FString>* Found = MountedPackageNames.Find(MountName);
+	if (!Found)
+	{
+		UE_LOG(LogDialogueRuntime, Log, TEXT("Nothing is mounted as %s."), *MountName);
+		return false;
+	}
+
+	// Callbacks of cancelled loads may mount other packages
+	const TArray<FString> Names = *Found;
+	const TSet<FString> PlayedPackages = GatherPlayedPackages();
+	for (const FString& PackageName : Names)
+	{
+		if (PlayedPackages.Contains(PackageName))
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Can't unmount %s, a flow player is in package %s."), *MountName, *PackageName);
+			return false;
+		}
+	}
+
+	// The worker may be reading objects of these packages
+	WaitForIndexBuild();
+
+	bool bIndexChanged = false;
+	for (const FString& PackageName : Names)
+	{
+		// A build of a pending load may still be about to publish, replacing the index makes it start over
+		bIndexChanged |= IsPackageLoading(PackageName);
+		CompletePendingPackageLoad(PackageName, false);
+
+		UDialoguePackage* Package = nullptr;
+		if (LoadedPackages.RemoveAndCopyValue(PackageName, Package) && Package)
+		{
+			PackageResidency.RemoveLoaded(PackageName);
+			GetMutableObjectIndex().RemovePackage(Package);
+			bIndexChanged = true;
+		}
+		ImportedPackages.Remove(PackageName);
+	}
+
+	const TSet<FString> NameSet(Names);
+	MountedPackages.RemoveAll([&NameSet](const UDialoguePackage* Package) { return !Package || NameSet.Contains(Package->Name); });
+	MountedPackageNames.Remove(MountName);
+
+	if (bIndexChanged)
+	{
+		FDialogueObjectIndex& Index = GetMutableObjectIndex();
+		Index.BuildFlowGraph();
+		Index.BuildHierarchy();
+		BindJumpTargets();
+		RebuildTextPool();
+		if (TextSearchIndex.IsBuilt())
+		{
+			RebuildTextSearchIndex();
+		}
+	}
+
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Unmounted %s."), *MountName);
+	return true;
+}
+
+const TArray<FString>& UDialogueDatabase::GetReferencedPackages(const FString& PackageName) const
+{
+	static const TArray<FString> None;
+	const FDialoguePackageReferences* References = PackageReferences.Find(PackageName);
+	return References ? References->Packages : None;
+}
+
+void UDialogueDatabase::LoadReferencedPackages(const FString& PackageName)
+{
+	if (PredictiveLoadHops <= 0)
+	{
+		return;
+	}
+
+	TSet<FString> Visited;
+	Visited.Add(PackageName);
+	TArray<FString> Frontier;
+	Frontier.Add(PackageName);
+	for (int32 Hop = 0; Hop < PredictiveLoadHops && Frontier.Num() > 0; ++Hop)
+	{
+		TArray<FString> Next;
+		for (const FString& Name : Frontier)
+		{
+			for (const FString& Referenced : GetReferencedPackages(Name))
+			{
+				bool bAlreadyVisited = false;
+				Visited.Add(Referenced, &bAlreadyVisited);
+				if (bAlreadyVisited)
+				{
+					continue;
+				}
+				Next.Add(Referenced);
+
+				// Packages about to be needed count as used, the budget unloads others first
+				if (LoadedPackages.Contains(Referenced))
+				{
+					PackageResidency.Touch(Referenced);
+				}
+				else if (!IsPackageLoading(Referenced))
+				{
+					UE_LOG(LogDialogueRuntime, Verbose, TEXT("Loading package %s ahead, %s references it"), *Referenced, *Name);
+					LoadPackageAsync(Referenced, FOnDialoguePackageLoaded());
+				}
+			}
+		}
+		Frontier = MoveTemp(Next);
+	}
+}
+
+void UDialogueDatabase::OnPackageLoaded(const FString& PackageName)
+{
+	if (ResidentPackageBudget <= 0)
+	{
+		return;
+	}
+
+	PackageResidency.AddLoaded(PackageName, GetPackageResidentBytes(PackageName));
+
+	// The package just loaded is about to be played, keep it even before a flow player is in it
+	PackageResidency.Pin(PackageName);
+	EnforcePackageBudget();
+	PackageResidency.Unpin(PackageName);
+}
+
+TSet<FString> UDialogueDatabase::GatherPlayedPackages() const
+{
+	TMap<const UDialoguePackage*, const FString*> Names;
+	for (const TPair<FString, UDialoguePackage*>& Pair : LoadedPackages)
+	{
+		Names.Add(Pair.Value, &Pair.Key);
+	}
+
+	TSet<FString> Result;
+	const auto AddObject = [&Names, &Result](const UDialogueObject* Object)
+	{
+		const FString* const* Name = Object ? Names.Find(Object->GetTypedOuter<UDialoguePackage>()) : nullptr;
+		if (Name)
+		{
+			Result.Add(**Name);
+		}
+	};
+
+	for (TObjectIterator<UDialogueFlowPlayer> It; It; ++It)
+	{
+		if (!IsValid(*It) || It->IsTemplate() || !It->GetWorld() || UDialogueDatabase::Get(*It) != this)
+		{
+			continue;
+		}
+
+		AddObject(It->GetCursor());
+		for (const FDialogueBranch& Branch : It->GetAvailableBranches())
+		{
+			for (const UDialogueObject* Object : Branch.Path)
+			{
+				AddObject(Object);
+			}
+		}
+	}
+	return Result;
+}
+
+UDialogueDatabase::FRuntimeStats UDialogueDatabase::GetRuntimeStats(bool bIncludeMemory) const
+{
+	FRuntimeStats Stats;
+	for (const TPair<FString, UDialoguePackage*>& Pair : LoadedPackages)
+	{
+		if (!Pair.Value)
+		{
+			continue;
+		}
+
+		FRuntimeStats::FPackage& Entry = Stats.Packages.AddDefaulted_GetRef();
+		Entry.Name = Pair.Key;
+		Entry.NumObjects = Pair.Value->GetObjectCount();
+		if (bIncludeMemory)
+		{
+			Entry.Bytes = GetPackageResidentBytes(Pair.Key);
+		}
+	}
+
+	Stats.NumIndexedObjects = ObjectIndex->ObjectsById.Num();
+	Stats.NumPendingLoads = PendingPackageLoads.Num();
+	Stats.NumPooledTexts = TextPool.Num();
+	Stats.ResidentPackageBytes = PackageResidency.GetResidentBytes();
+	Stats.ResidentPackageBudget = ResidentPackageBudget;
+	Stats.NumSearchTokens = TextSearchIndex.NumTokens();
+	Stats.SearchIndexBytes = TextSearchIndex.GetAllocatedSize();
+	Stats.ShadowLevel = ShadowLevel;
+	Stats.GlobalVariables = CachedGlobalVariables;
+	return Stats;
+}
+
+void UDialogueDatabase::OnObjectsPatched(TConstArrayView<UDialogueObject*> Objects, bool bFlowChanged)
+{
+	TSet<const UDialogueObject*> PatchedSet;
+	for (UDialogueObject* Object : Objects)
+	{
+		PatchedSet.Add(Object);
+		if (UDialogueDialogue* Dialogue = Cast<UDialogueDialogue>(Object))
+		{
+			TextPool.Intern(Dialogue->Text);
+			TextPool.Intern(Dialogue->MenuText);
+			TextPool.Intern(Dialogue->StageDirections);
+		}
+		else if (UDialogueFlowFragment* FlowFragment = Cast<UDialogueFlowFragment>(Object))
+		{
+			TextPool.Intern(FlowFragment->Description);
+		}
+		TextSearchIndex.UpdateObject(Object);
+	}
+
+	if (bFlowChanged)
+	{
+		// A build in flight sees the index replaced and starts over on top of it
+		GetMutableObjectIndex().BuildFlowGraph();
+		BindJumpTargets();
+	}
+
+	for (TObjectIterator<UDialogueFlowPlayer> It; It; ++It)
+	{
+		UDialogueFlowPlayer* Player = *It;
+		if (!IsValid(Player) || Player->IsTemplate() || !Player->GetWorld() || UDialogueDatabase::Get(Player) != this)
+		{
+			continue;
+		}
+
+		bool bTouched = bFlowChanged || PatchedSet.Contains(Player->GetCursor());
+		for (int32 i = 0; i < Player->GetAvailableBranches().Num() && !bTouched; ++i)
+		{
+			for (const UDialogueObject* Object : Player->GetAvailableBranches()[i].Path)
+			{
+				if (PatchedSet.Contains(Object))
+				{
+					bTouched = true;
+					break;
+				}
+			}
+		}
+
+		if (bTouched && Player->GetCursor() && Player->GetShadowLevel() == 0)
+		{
+			Player->InvalidateExplorationCache();
+			Player->UpdateAvailableBranches();
+		}
+	}
+}
+
+void UDialogueDatabase::RebuildIndices()
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueRebuildIndices);
+	LLM_SCOPE_BYTAG(Dialogue_Packages);
+
+	// Readers and workers may still hold the old index
+	TSharedRef<FDialogueObjectIndex> Index = MakeShared<FDialogueObjectIndex>();
+
+	// Characters live outside of packages and are always available
+	CharactersById.Reset();
+	CharactersByName.Reset();
+	for (UDialogueCharacter* Character : Characters)
+	{
+		if (!Character)
+		{
+			continue;
+		}
+
+		Index->Add(Character);
+		CharactersById.Add(Character->Id, Character);
+		if (!Character->TechnicalName.IsEmpty())
+		{
+			CharactersByName.Add(Character->TechnicalName, Character);
+		}
+	}
+
+	for (const TPair<FString, UDialoguePackage*>& Pair : LoadedPackages)
+	{
+		if (Pair.Value)
+		{
+			Index->AddPackage(Pair.Value, false);
+		}
+	}
+
+	Index->BuildFlowGraph();
+	Index->BuildHierarchy();
+	ObjectIndex = Index;
+	++Generation;
+	BindJumpTargets();
+}
+
+FDialogueObjectIndex& UDialogueDatabase::GetMutableObjectIndex()
+{
+	if (!ObjectIndex.IsUnique())
+	{
+		ObjectIndex = MakeShared<FDialogueObjectIndex>(*ObjectIndex);
+	}
+	++Generation;
+	return *ObjectIndex;
+}
+
+void UDialogueDatabase::OnPackageStreamed(FString PackageName)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueLoadPackage);
+	LLM_SCOPE_BYTAG(Dialogue_Packages);
+
+	FPendingPackageLoad* Pending = PendingPackageLoads.FindByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; });
+	if (!Pending)
+	{
+		// Loaded synchronously in the meantime
+		return;
+	}
+
+	Pending->Package = ImportedPackages.FindRef(PackageName).Get();
+	if (!Pending->Package)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to stream package %s!"), *PackageName);
+		CompletePendingPackageLoad(PackageName, false);
+		return;
+	}
+
+	PreparePackage(Pending->Package);
+	StartIndexBuild();
+}
+
+void UDialogueDatabase::StartIndexBuild()
+{
+	if (IndexBuildTask.IsValid() && !IndexBuildTask.IsReady())
+	{
+		// Picked up once the running build is published
+		return;
+	}
+
+	const uint32 Build = LastIndexBuild + 1;
+
+	TArray<const UDialoguePackage*> Packages;
+	for (FPendingPackageLoad& Pending : PendingPackageLoads)
+	{
+		if (Pending.Package && Pending.IndexBuild == 0)
+		{
+			Pending.IndexBuild = Build;
+			Packages.Add(Pending.Package);
+		}
+	}
+
+	if (Packages.Num() == 0)
+	{
+		return;
+	}
+
+	LastIndexBuild = Build;
+	TSharedRef<const FDialogueObjectIndex> BaseIndex = ObjectIndex;
+	TWeakObjectPtr<UDialogueDatabase> WeakThis(this);
+
+	// The streamable handles keep the packages alive while the worker reads them
+	IndexBuildTask = Async(EAsyncExecution::ThreadPool, [WeakThis, Build, BaseIndex, Packages = MoveTemp(Packages)]()
+	{
+		// Tags are per thread, the worker does not inherit the scope of the game thread
+		LLM_SCOPE_BYTAG(Dialogue_Packages);
+		TSharedRef<FDialogueObjectIndex> NewIndex = MakeShared<FDialogueObjectIndex>(*BaseIndex);
+		for (const UDialoguePackage* Package : Packages)
+		{
+			NewIndex->AddPackage(Package, true);
+		}
+		NewIndex->BuildFlowGraph();
+		NewIndex->BuildHierarchy();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Build, NewIndex, BaseIndex]()
+		{
+			if (UDialogueDatabase* Database = WeakThis.Get())
+			{
+				Database->OnIndexBuilt(Build, NewIndex, BaseIndex);
+			}
+		});
+	});
+}
+
+void UDialogueDatabase::OnIndexBuilt(uint32 Build, TSharedRef<FDialogueObjectIndex> NewIndex, TSharedRef<const FDialogueObjectIndex> BaseIndex)
+{
+	if (ObjectIndex != BaseIndex)
+	{
+		// Packages were loaded or unloaded while building, index again on top of the current state
+		for (FPendingPackageLoad& Pending : PendingPackageLoads)
+		{
+			if (Pending.IndexBuild == Build)
+			{
+				Pending.IndexBuild = 0;
+			}
+		}
+		StartIndexBuild();
+		return;
+	}
+
+	ObjectIndex = NewIndex;
+	++Generation;
+	BindJumpTargets();
+
+	TArray<FString> Completed;
+	for (const FPendingPackageLoad& Pending : PendingPackageLoads)
+	{
+		if (Pending.IndexBuild == Build)
+		{
+			LoadedPackages.Add(Pending.PackageName, Pending.Package);
+			Completed.Add(Pending.PackageName);
+		}
+	}
+
+	for (const FString& PackageName : Completed)
+	{
+		UE_LOG(LogDialogueRuntime, Log, TEXT("Package %s loaded successfully."), *PackageName);
+		CompletePendingPackageLoad(PackageName, true);
+		OnPackageLoaded(PackageName);
+	}
+
+	StartIndexBuild();
+}
+
+void UDialogueDatabase::BindJumpTargets()
+{
+	// The graph resolved every jump already, across packages too; subclasses are custom nodes and resolve themselves
+	const FDialogueFlowGraph& Graph = ObjectIndex->FlowGraph;
+	for (const FDialogueFlowGraphNode& Node : Graph.Nodes)
+	{
+		if (Node.Kind == EDialogueFlowNodeKind::Jump)
+		{
+			UDialogueInputPin* Target = Node.JumpTargetPin != INDEX_NONE ? Cast<UDialogueInputPin>(Graph.Pins[Node.JumpTargetPin].Object) : nullptr;
+			CastChecked<UDialogueJump>(Node.Object)->BindTargetPin(Target);
+		}
+	}
+}
+
+void UDialogueDatabase::WaitForIndexBuild()
+{
+	if (IndexBuildTask.IsValid())
+	{
+		IndexBuildTask.Wait();
+	}
+}
+
+void UDialogueDatabase::CompletePendingPackageLoad(const FString& PackageName, bool bSuccess)
+{
+	const int32 Index = PendingPackageLoads.IndexOfByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Callbacks may start new loads
+	FPendingPackageLoad Pending = MoveTemp(PendingPackageLoads[Index]);
+	PendingPackageLoads.RemoveAt(Index);
+
+	for (const FOnDialoguePackageLoaded& Callback : Pending.Callbacks)
+	{
+		Callback.ExecuteIfBound(PackageName, bSuccess);
+	}
+}
+
+void UDialogueDatabase::RebuildTextPool()
+{
+	TextPool.Reset();
+	for (const TPair<FString, UDialoguePackage*>& Pair : LoadedPackages)
+	{
+		TextPool.InternPackage(Pair.Value);
+	}
+	for (const FPendingPackageLoad& Pending : PendingPackageLoads)
+	{
+		TextPool.InternPackage(Pending.Package);
+	}
+}
+
+void UDialogueDatabase::RebuildTextSearchIndex()
+{
+	TextSearchIndex.Reset(FInternationalization::Get().GetCurrentLanguage()->GetName());
+	for (const TPair<FString, UDialoguePackage*>& Pair : LoadedPackages)
+	{
+		TextSearchIndex.AddPackage(Pair.Value);
+	}
+	for (const FPendingPackageLoad& Pending : PendingPackageLoads)
+	{
+		TextSearchIndex.AddPackage(Pending.Package);
+	}
+}
+
+void UDialogueDatabase::PreparePackage(UDialoguePackage* Package)
+{
+	TextPool.InternPackage(Package);
+	TextSearchIndex.AddPackage(Package);
+
+	for (UDialogueObject* Object : Package->GetObjectsOfClass(UDialogueDialogue::StaticClass()))
+	{
+		static_cast<UDialogueDialogue*>(Object)->ResolveSpeaker(this);
+	}
+}
+
+void UDialogueDatabase::BeginDestroy()
+{
+	WaitForIndexBuild();
+	PendingPackageLoads.Reset();
+
+	Super::BeginDestroy();
+}
+
+// ==================== SHADOW STATE ====================
+
+void UDialogueDatabase::PushState(int32 Level)
+{
+	ShadowLevel = Level;
+	GetGlobalVariables()->PushState(Level);
+}
+
+void UDialogueDatabase::PopState(int32 Level)
+{
+	GetGlobalVariables()->PopState(Level);
+	ShadowLevel = Level - 1;
+}
+
+// ==================== INSTANCES ====================
+
+UDialogueDatabase* UDialogueDatabase::GetOrCreateForWorld(UWorld* World)
+{
+	if (const TWeakObjectPtr<UDialogueDatabase>* Existing = WorldInstances.Find(World))
+	{
+		if (Existing->IsValid())
+		{
+			return Existing->Get();
+		}
+	}
+
+	// Forget instances whose world died
+	for (auto It = WorldInstances.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || !It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	UDialogueDatabase* Original = GetOriginal();
+	if (!Original)
+	{
+		return nullptr;
+	}
+
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Cloning DialogueDatabase for world %s."), *World->GetName());
+
+	LLM_SCOPE_BYTAG(Dialogue_Database);
+	UDialogueDatabase* Instance = DuplicateObject<UDialogueDatabase>(Original, World);
+	FDialogueRuntimeStats::AddCount(FDialogueRuntimeStats::ECounter::ObjectsDuplicated, 1);
+	WorldInstances.Add(World, Instance);
+	Instance->Initialize();
+	return Instance;
+}
+
+UDialogueDatabase* UDialogueDatabase::GetOriginal()
+{
+	static TWeakObjectPtr<UDialogueDatabase> Original;
+	if (Original.IsValid())
+	{
+		return Original.Get();
+	}
+
+	TArray<FAssetData> Assets;
+	IAssetRegistry::GetChecked().GetAssetsByClass(UDialogueDatabase::StaticClass()->GetClassPathName(), Assets);
+	if (Assets.Num() == 0)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("No DialogueDatabase asset found, import a dialogue project first."));
+		return nullptr;
+	}
+
+	if (Assets.Num() > 1)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Found %d DialogueDatabase assets, using %s."), Assets.Num(), *Assets[0].GetObjectPathString());
+	}
+
+	Original = Cast<UDialogueDatabase>(Assets[0].GetAsset());
+	return Original.Get();
+}
@@ -0,0 +1,511 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueFlowGraph.h"
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#include "DialogueScriptCompiler.h"
+#include "DialogueRuntimeModule.h"
+
+namespace
+{
+	EDialogueFlowNodeKind GetNodeKind(const UDialogueNode* Node)
+	{
+		// Only the stock classes are known not to customize Explore
+		const UClass* Class = Node->GetClass();
+		if (Class == UDialogueCondition::StaticClass())
+		{
+			return EDialogueFlowNodeKind::Condition;
+		}
+		if (Class == UDialogueInstruction::StaticClass())
+		{
+			return EDialogueFlowNodeKind::Instruction;
+		}
+		if (Class == UDialogueJump::StaticClass())
+		{
+			return EDialogueFlowNodeKind::Jump;
+		}
+		if (Class == UDialogueNode::StaticClass() || Class == UDialogueDialogue::StaticClass() || Class == UDialogueFragment::StaticClass()
+			|| Class == UDialogueFlowFragment::StaticClass() || Class == UDialogueHub::StaticClass())
+		{
+			return EDialogueFlowNodeKind::Default;
+		}
+		return EDialogueFlowNodeKind::Custom;
+	}
+
+	const FDialogueScriptProgram* GetProgram(const FDialogueScript& Script)
+	{
+		// Scripts folded to passing or doing nothing are left out, like empty ones
+		return Script.CanSkip() ? nullptr : &Script.Program;
+	}
+
+	bool IsPure(const FDialogueScriptProgram* Program)
+	{
+		return !Program || Program->bIsPure;
+	}
+}
+
+void FDialogueFlowGraph::Build(const TMap<FDialogueId, UDialogueObject*>& ObjectsById)
+{
+	Reset();
+
+	// Nodes and their pins first, so that connections can be resolved by index
+	for (const TPair<FDialogueId, UDialogueObject*>& Pair : ObjectsById)
+	{
+		UDialogueNode* Node = Cast<UDialogueNode>(Pair.Value);
+		if (!Node)
+		{
+			continue;
+		}
+
+		const int32 NodeIndex = Nodes.AddDefaulted();
+		VertexByObject.Add(Node, FVertex(NodeIndex, false));
+
+		FDialogueFlowGraphNode& GraphNode = Nodes[NodeIndex];
+		GraphNode.Object = Node;
+		GraphNode.PausableType = (uint8)Node->GetPausableType();
+		GraphNode.Kind = GetNodeKind(Node);
+
+		if (const UDialogueCondition* Condition = Cast<UDialogueCondition>(Node))
+		{
+			GraphNode.Program = GetProgram(Condition->Script);
+		}
+		else if (const UDialogueInstruction* Instruction = Cast<UDialogueInstruction>(Node))
+		{
+			GraphNode.Program = GetProgram(Instruction->Script);
+		}
+
+		// Custom classes may do anything in Explore
+		GraphNode.bIsPure = GraphNode.Kind != EDialogueFlowNodeKind::Custom && IsPure(GraphNode.Program);
+
+		for (UDialogueInputPin* Pin : Node->InputPins)
+		{
+			FDialogueFlowGraphPin& GraphPin = Pins.AddDefaulted_GetRef();
+			GraphPin.Object = Pin;
+			GraphPin.OwnerNode = NodeIndex;
+			GraphPin.bIsInput = true;
+			GraphPin.Program = Pin ? GetProgram(Pin->Script) : nullptr;
+			GraphPin.bIsPure = IsPure(GraphPin.Program);
+			if (Pin)
+			{
+				VertexByObject.Add(Pin, FVertex(Pins.Num() - 1, true));
+			}
+		}
+
+		GraphNode.FirstOutputPin = Pins.Num();
+		GraphNode.NumOutputPins = Node->OutputPins.Num();
+		for (UDialogueOutputPin* Pin : Node->OutputPins)
+		{
+			FDialogueFlowGraphPin& GraphPin = Pins.AddDefaulted_GetRef();
+			GraphPin.Object = Pin;
+			GraphPin.OwnerNode = NodeIndex;
+			GraphPin.Program = Pin ? GetProgram(Pin->Script) : nullptr;
+			GraphPin.bIsPure = IsPure(GraphPin.Program);
+			if (Pin)
+			{
+				VertexByObject.Add(Pin, FVertex(Pins.Num() - 1, true));
+			}
+		}
+	}
+
+	auto FindInputPin = [this, &ObjectsById](const UDialogueInputPin* Resolved, const FDialogueId& NodeId, int32 PinIndex) -> int32
+	{
+		// Targets resolved at import need no lookup by ID
+		if (FDialogueConnection::IsTargetPin(Resolved, NodeId, PinIndex))
+		{
+			const FVertex* Vertex = VertexByObject.Find(Resolved);
+			return Vertex ? Vertex->Index : INDEX_NONE;
+		}
+
+		UDialogueObject* const* Target = ObjectsById.Find(NodeId);
+		UDialogueNode* TargetNode = Target ? Cast<UDialogueNode>(*Target) : nullptr;
+		if (!TargetNode || !TargetNode->InputPins.IsValidIndex(PinIndex))
+		{
+			return INDEX_NONE;
+		}
+		const FVertex* Vertex = VertexByObject.Find(TargetNode->InputPins[PinIndex]);
+		return Vertex ? Vertex->Index : INDEX_NONE;
+	};
+
+	// Resolve connections and jumps
+	for (FDialogueFlowGraphNode& GraphNode : Nodes)
+	{
+		if (GraphNode.Kind == EDialogueFlowNodeKind::Jump)
+		{
+			const UDialogueJump* Jump = CastChecked<UDialogueJump>(GraphNode.Object);
+			GraphNode.JumpTargetPin = FindInputPin(Jump->TargetPin, Jump->TargetNodeId, Jump->TargetPinIndex);
+		}
+
+		for (int32 i = 0; i < GraphNode.NumOutputPins; ++i)
+		{
+			FDialogueFlowGraphPin& GraphPin = Pins[GraphNode.FirstOutputPin + i];
+			const UDialogueOutputPin* Pin = Cast<UDialogueOutputPin>(GraphPin.Object);
+
+			GraphPin.FirstEdge = Edges.Num();
+			if (Pin)
+			{
+				for (const FDialogueConnection& Connection : Pin->Edges)
+				{
+					// Unresolved targets stay in as dead edges, like a connection to a missing node
+					Edges.Add(FindInputPin(Connection.TargetPin, Connection.TargetNodeId, Connection.TargetPinIndex));
+				}
+			}
+			GraphPin.NumEdges = Edges.Num() - GraphPin.FirstEdge;
+		}
+	}
+
+	Analyze();
+	IndexVariableUsers();
+}
+
+void FDialogueFlowGraph::Analyze()
+{
+	// Nodes and pins share one numbering here, pins follow the nodes
+	const int32 NumNodes = Nodes.Num();
+	const int32 NumVertices = NumNodes + Pins.Num();
+
+	// Where each vertex continues, in one array
+	TArray<int32> FirstSuccessor;
+	TArray<int32> Successors;
+	FirstSuccessor.SetNumUninitialized(NumVertices + 1);
+	Successors.Reserve(Edges.Num() + Pins.Num());
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		FDialogueFlowGraphNode& Node = Nodes[i];
+		FirstSuccessor[i] = Successors.Num();
+		switch (Node.Kind)
+		{
+		case EDialogueFlowNodeKind::Jump:
+			if (Node.JumpTargetPin != INDEX_NONE)
+			{
+				Successors.Add(NumNodes + Node.JumpTargetPin);
+			}
+			Node.CorridorNext = Node.JumpTargetPin;
+			break;
+
+		case EDialogueFlowNodeKind::Custom:
+			// Where custom classes continue is up to them
+			break;
+
+		default:
+			for (int32 Pin = Node.FirstOutputPin; Pin < Node.FirstOutputPin + Node.NumOutputPins; ++Pin)
+			{
+				Successors.Add(NumNodes + Pin);
+			}
+			if (Node.Kind == EDialogueFlowNodeKind::Default && Node.NumOutputPins == 1)
+			{
+				Node.CorridorNext = Node.FirstOutputPin;
+			}
+			break;
+		}
+	}
+	for (int32 i = 0; i < Pins.Num(); ++i)
+	{
+		FDialogueFlowGraphPin& Pin = Pins[i];
+		FirstSuccessor[NumNodes + i] = Successors.Num();
+		if (Pin.bIsInput)
+		{
+			Successors.Add(Pin.OwnerNode);
+			Pin.CorridorNext = Pin.Program ? INDEX_NONE : Pin.OwnerNode;
+			continue;
+		}
+
+		for (int32 Edge = Pin.FirstEdge; Edge < Pin.FirstEdge + Pin.NumEdges; ++Edge)
+		{
+			if (Edges[Edge] != INDEX_NONE)
+			{
+				Successors.Add(NumNodes + Edges[Edge]);
+			}
+		}
+		// A dead edge ends the branch with a warning, explore it in full
+		Pin.CorridorNext = !Pin.Program && Pin.NumEdges == 1 ? Edges[Pin.FirstEdge] : INDEX_NONE;
+	}
+	FirstSuccessor[NumVertices] = Successors.Num();
+
+	FuseCorridors();
+
+	// Exploration stops at nodes that can pause, loops through them are fine
+	auto IsPauseCandidate = [this, NumNodes](int32 Vertex)
+	{
+		return Vertex < NumNodes && Nodes[Vertex].PausableType != 0;
+	};
+
+	// Tarjan's strongly connected components, with an explicit stack and without leaving pause candidates
+	PauselessCycles.Reset();
+	{
+		struct FVisit
+		{
+			int32 Vertex;
+			int32 NextSuccessor;
+		};
+
+		TArray<int32> Order;
+		TArray<int32> LowLink;
+		TBitArray<> OnStack(false, NumVertices);
+		Order.Init(INDEX_NONE, NumVertices);
+		LowLink.SetNumUninitialized(NumVertices);
+		TArray<int32> Component;
+		TArray<FVisit> Visits;
+		int32 NextOrder = 0;
+
+		auto Discover = [&](int32 Vertex)
+		{
+			Order[Vertex] = LowLink[Vertex] = NextOrder++;
+			Component.Add(Vertex);
+			OnStack[Vertex] = true;
+			Visits.Add({ Vertex, IsPauseCandidate(Vertex) ? FirstSuccessor[Vertex + 1] : FirstSuccessor[Vertex] });
+		};
+
+		for (int32 Root = 0; Root < NumVertices; ++Root)
+		{
+			if (Order[Root] != INDEX_NONE)
+			{
+				continue;
+			}
+
+			Discover(Root);
+			while (Visits.Num() > 0)
+			{
+				FVisit& Visit = Visits.Last();
+				const int32 Vertex = Visit.Vertex;
+				if (Visit.NextSuccessor < FirstSuccessor[Vertex + 1])
+				{
+					const int32 Successor = Successors[Visit.NextSuccessor++];
+					if (Order[Successor] == INDEX_NONE)
+					{
+						Discover(Successor);
+					}
+					else if (OnStack[Successor])
+					{
+						LowLink[Vertex] = FMath::Min(LowLink[Vertex], Order[Successor]);
+					}
+					continue;
+				}
+
+				Visits.Pop(false);
+				if (Visits.Num() > 0)
+				{
+					const int32 Parent = Visits.Last().Vertex;
+					LowLink[Parent] = FMath::Min(LowLink[Parent], LowLink[Vertex]);
+				}
+
+				if (LowLink[Vertex] != Order[Vertex])
+				{
+					continue;
+				}
+
+				// Vertex is the root of a component, a lone vertex is no loop as nothing continues at itself
+				const int32 ComponentStart = Component.FindLast(Vertex);
+				if (Component.Num() - ComponentStart > 1)
+				{
+					FDialogueFlowGraphCycle& Cycle = PauselessCycles.AddDefaulted_GetRef();
+					for (int32 i = ComponentStart; i < Component.Num(); ++i)
+					{
+						const int32 Member = Component[i];
+						if (Member < NumNodes)
+						{
+							Cycle.Nodes.Add(Member);
+							Cycle.bHasCondition |= Nodes[Member].Kind == EDialogueFlowNodeKind::Condition;
+						}
+						else
+						{
+							const FDialogueFlowGraphPin& Pin = Pins[Member - NumNodes];
+							Cycle.bHasCondition |= Pin.bIsInput && Pin.Program;
+						}
+					}
+				}
+				for (int32 i = ComponentStart; i < Component.Num(); ++i)
+				{
+					OnStack[Component[i]] = false;
+				}
+				Component.SetNum(ComponentStart, false);
+			}
+		}
+	}
+
+	// Pause candidates each node reaches before any condition decides the way
+	ReachablePauses.Reset();
+	{
+		TArray<int32> VisitedBy;
+		VisitedBy.Init(INDEX_NONE, NumVertices);
+		TArray<int32> Queue;
+
+		for (int32 Start = 0; Start < NumNodes; ++Start)
+		{
+			FDialogueFlowGraphNode& Node = Nodes[Start];
+			Node.FirstReachablePause = ReachablePauses.Num();
+			bool bUnconditional = true;
+
+			Queue.Reset();
+			Queue.Add(Start);
+			VisitedBy[Start] = Start;
+			for (int32 i = 0; i < Queue.Num(); ++i)
+			{
+				const int32 Vertex = Queue[i];
+				if (Vertex != Start && IsPauseCandidate(Vertex))
+				{
+					ReachablePauses.Add(Vertex);
+					continue;
+				}
+
+				const bool bDecides = Vertex < NumNodes
+					? Nodes[Vertex].Kind == EDialogueFlowNodeKind::Condition || Nodes[Vertex].Kind == EDialogueFlowNodeKind::Custom
+					: Pins[Vertex - NumNodes].bIsInput && Pins[Vertex - NumNodes].Program;
+				if (bDecides)
+				{
+					bUnconditional = false;
+					continue;
+				}
+
+				if (Queue.Num() > MaxReachSearch)
+				{
+					bUnconditional = false;
+					break;
+				}
+
+				for (int32 Successor = FirstSuccessor[Vertex]; Successor < FirstSuccessor[Vertex + 1]; ++Successor)
+				{
+					if (VisitedBy[Successors[Successor]] != Start)
+					{
+						VisitedBy[Successors[Successor]] = Start;
+						Queue.Add(Successors[Successor]);
+					}
+				}
+			}
+
+			Node.NumReachablePauses = ReachablePauses.Num() - Node.FirstReachablePause;
+			Node.bReachesPausesUnconditionally = bUnconditional;
+		}
+	}
+
+	UE_LOG(LogDialogueRuntime, Verbose, TEXT("Flow graph of %d nodes has %d loops without a pause and %d fused corridors"), NumNodes, PauselessCycles.Num(), FusedCorridors.Num());
+}
+
+void FDialogueFlowGraph::FuseCorridors()
+{
+	FusedCorridors.Reset();
+	CorridorVertices.Reset();
+
+	// Nodes showing content end a corridor, players usually pause on them
+	constexpr uint8 StopTypes = (uint8)(EDialoguePausableType::Dialogue | EDialoguePausableType::DialogueFragment
+		| EDialoguePausableType::FlowFragment | EDialoguePausableType::Hub);
+
+	TArray<FVertex, TInlineAllocator<16>> Walk;
+	TArray<const FDialogueScriptProgram*, TInlineAllocator<8>> Conditions;
+	for (int32 Start = 0; Start < Pins.Num(); ++Start)
+	{
+		if (!Pins[Start].bIsInput || !Pins[Start].Program || !Pins[Start].bIsPure)
+		{
+			continue;
+		}
+
+		Walk.Reset();
+		Conditions.Reset();
+		FFusedCorridor Corridor;
+		FVertex Vertex(Start, true);
+		while (Walk.Num() < MaxFusedCorridor && GetObject(Vertex))
+		{
+			FVertex Next;
+			if (Vertex.bIsPin)
+			{
+				const FDialogueFlowGraphPin& Pin = Pins[Vertex.Index];
+				if (!Pin.bIsPure)
+				{
+					break;
+				}
+				if (Pin.bIsInput && Pin.Program)
+				{
+					Conditions.Add(Pin.Program);
+				}
+				Next = Pin.bIsInput ? FVertex(Pin.OwnerNode, false) : GetCorridorNext(Vertex);
+			}
+			else if ((Nodes[Vertex.Index].PausableType & StopTypes) == 0)
+			{
+				Next = GetCorridorNext(Vertex);
+			}
+
+			if (!Next.IsValid())
+			{
+				break;
+			}
+			if (Walk.Num() > 0)
+			{
+				Corridor.PausableTypes |= GetPausableType(Vertex);
+			}
+			Walk.Add(Vertex);
+			Vertex = Next;
+		}
+
+		// A single condition gains nothing from fusing
+		if (Conditions.Num() < 2 || !FDialogueScriptCompiler::FuseConditions(Conditions, Corridor.Program))
+		{
+			continue;
+		}
+
+		Corridor.FirstVertex = CorridorVertices.Num();
+		Corridor.NumVertices = Walk.Num();
+		Corridor.End = Vertex;
+		CorridorVertices.Append(Walk);
+		Pins[Start].FusedCorridor = FusedCorridors.Add(MoveTemp(Corridor));
+	}
+}
+
+void FDialogueFlowGraph::IndexVariableUsers()
+{
+	TMap<FDialogueVariableSlot, TArray<FVertex>> UsersBySlot;
+	auto AddUses = [&UsersBySlot](const FDialogueScriptProgram* Program, const FVertex& Vertex)
+	{
+		if (Program)
+		{
+			for (const FDialogueVariableSlot& Slot : Program->VariableSlots)
+			{
+				UsersBySlot.FindOrAdd(Slot).Add(Vertex);
+			}
+		}
+	};
+
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+	{
+		AddUses(Nodes[i].Program, FVertex(i, false));
+	}
+	for (int32 i = 0; i < Pins.Num(); ++i)
+	{
+		AddUses(Pins[i].Program, FVertex(i, true));
+	}
+
+	// One array for all variables, so looking up the users of a write touches a single range
+	VariableUserRanges.Reserve(UsersBySlot.Num());
+	for (const TPair<FDialogueVariableSlot, TArray<FVertex>>& Pair : UsersBySlot)
+	{
+		VariableUserRanges.Add(Pair.Key, TPair<int32, int32>(VariableUsers.Num(), Pair.Value.Num()));
+		VariableUsers.Append(Pair.Value);
+	}
+}
+
+void FDialogueFlowGraph::Reset()
+{
+	Nodes.Reset();
+	Pins.Reset();
+	Edges.Reset();
+	ReachablePauses.Reset();
+	PauselessCycles.Reset();
+	FusedCorridors.Reset();
+	CorridorVertices.Reset();
+	VariableUsers.Reset();
+	VariableUserRanges.Reset();
+	VertexByObject.Reset();
+}
+
+FDialogueFlowGraph::FVertex FDialogueFlowGraph::FindVertex(const UDialogueObject* Object) const
+{
+	const FVertex* Vertex = VertexByObject.Find(Object);
+	return Vertex ? *Vertex : FVertex();
+}
+
+UDialogueObject* FDialogueFlowGraph::GetObject(const FVertex& Vertex) const
+{
+	if (!Vertex.IsValid())
+	{
+		return nullptr;
+	}
+	return Vertex.bIsPin ? (UDialogueObject*)Pins[Vertex.Index].Object : (UDialogueObject*)Nodes[Vertex.Index].Object;
+}
@@ -0,0 +1,1654 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueFlowPlayer.h"
+#include "DialogueDatabase.h"
+#include "DialogueCharacter.h"
+#include "DialogueFlowRecording.h"
+#include "DialogueFlowWorldSubsystem.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueNode.h"
+#include "DialoguePackage.h"
+#include "DialogueObjectIndex.h"
+#include "DialogueScriptVM.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeStats.h"
+#include "Engine/AssetManager.h"
+
+UDialogueFlowPlayer::UDialogueFlowPlayer()
+{
+	// Only ticks while a sliced exploration is in progress
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	OverrideGlobalVariables = nullptr;
+	UserMethodsProvider = nullptr;
+}
+
+void UDialogueFlowPlayer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetCursorToStartNode();
+}
+
+void UDialogueFlowPlayer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UDialogueFlowWorldSubsystem* Subsystem = World->GetSubsystem<UDialogueFlowWorldSubsystem>())
+		{
+			Subsystem->RemoveDirtyPlayer(this);
+		}
+	}
+
+	BindExplorationCache(nullptr);
+	ExplorationCache.Empty();
+	BindVariableWatch(nullptr);
+
+	// Nothing follows anymore, waiting code must not hang
+	ResolveAwaiters(PauseAwaiters, TWeakObjectPtr<UDialogueObject>());
+	ResolveAwaiters(ChoiceAwaiters, TOptional<FDialogueBranch>());
+	CancelPrewarm();
+	SlicedExplore.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// ==================== FLOW CONTROL ====================
+
+void UDialogueFlowPlayer::SetStartNode(FDialogueRef NewStartNode)
+{
+	StartOn = NewStartNode;
+	SetCursorToStartNode();
+}
+
+void UDialogueFlowPlayer::SetStartNodeById(const FString& NodeId)
+{
+	StartOn.Id = FDialogueId::FromImportId(NodeId);
+	SetCursorToStartNode();
+}
+
+void UDialogueFlowPlayer::SetCursorTo(UDialogueObject* Node)
+{
+	if (!Cast<IDialogueFlowObject>(Node))
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Could not set cursor in flow player of %s: invalid node"), *GetNameSafe(GetOwner()));
+		return;
+	}
+
+	if (Recording)
+	{
+		Recording->AddStep(FDialogueFlowRecording::EStepType::SetCursor, 0, Node->Id);
+	}
+
+	Cursor = Node;
+	UpdateAvailableBranchesInternal(true);
+}
+
+void UDialogueFlowPlayer::Play(int32 BranchIndex)
+{
+	// Branch indices count only the branches that can be played
+	FDialogueBranch* Branch = nullptr;
+	int32 ValidIndex = 0;
+	for (FDialogueBranch& Candidate : AvailableBranches)
+	{
+		if (bIgnoreInvalidBranches && !Candidate.bIsValid)
+		{
+			continue;
+		}
+
+		if (ValidIndex++ == BranchIndex)
+		{
+			Branch = &Candidate;
+			break;
+		}
+	}
+
+	if (!Branch)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Branch with index %d does not exist!"), BranchIndex);
+		return;
+	}
+
+	// PlayBranch replaces AvailableBranches, move the branch out instead of copying its path
+	const FDialogueBranch BranchToPlay = MoveTemp(*Branch);
+	PlayBranch(BranchToPlay);
+}
+
+void UDialogueFlowPlayer::PlayBranch(const FDialogueBranch& Branch)
+{
+	if (!ensure(ShadowLevel == 0))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("PlayBranch was called inside a ShadowedOperation! Aborting Play."));
+		return;
+	}
+
+	if (Branch.Path.Num() == 0)
+	{
+		return;
+	}
+
+	if (Recording)
+	{
+		Recording->AddStep(FDialogueFlowRecording::EStepType::PlayBranch, Branch.Index);
+	}
+
+	if (ChoiceAwaiters.Num() > 0)
+	{
+		ResolveAwaiters(ChoiceAwaiters, TOptional<FDialogueBranch>(Branch));
+	}
+
+	UDialogueGlobalVariables* GV = GetGlobalVariables();
+	UObject* MethodsProvider = GetMethodsProvider();
+
+	for (UDialogueObject* Object : Branch.Path)
+	{
+		if (IDialogueFlowObject* FlowObject = Cast<IDialogueFlowObject>(Object))
+		{
+			FlowObject->Execute(GV, MethodsProvider);
+		}
+	}
+
+	Cursor = Branch.Path.Last();
+
+	// Lines the player stops at are seen, for the markers of UDialogueFlowWorldSubsystem::HasAvailableContent
+	UWorld* World = GetWorld();
+	UDialogueFlowWorldSubsystem* Subsystem = World ? World->GetSubsystem<UDialogueFlowWorldSubsystem>() : nullptr;
+	if (Subsystem && ShouldPauseOn(Cursor))
+	{
+		Subsystem->MarkSeen(Cursor);
+	}
+
+	UpdateAvailableBranches();
+}
+
+TArray<UDialogueDialogue*> UDialogueFlowPlayer::PredictUpcoming(int32 Pauses)
+{
+	TSet<UDialogueDialogue*> Nodes;
+	if (Pauses > 0 && Cursor && PauseOn != 0 && GetGlobalVariables())
+	{
+		TMap<UDialogueObject*, int32> Expanded;
+		PredictBranches(AvailableBranches, Pauses, Expanded, Nodes);
+	}
+
+	// Their texts are displayed next, decompress them while the current line is shown
+	for (const UDialogueDialogue* Dialogue : Nodes)
+	{
+		Dialogue->PrefetchTexts();
+	}
+	return Nodes.Array();
+}
+
+void UDialogueFlowPlayer::PredictBranches(const TArray<FDialogueBranch>& Branches, int32 Pauses, TMap<UDialogueObject*, int32>& Expanded, TSet<UDialogueDialogue*>& OutNodes)
+{
+	UDialogueGlobalVariables* GV = GetGlobalVariables();
+	UObject* MethodsProvider = GetMethodsProvider();
+
+	for (const FDialogueBranch& Branch : Branches)
+	{
+		// Invalid branches can't be played
+		if (!Branch.bIsValid)
+		{
+			continue;
+		}
+
+		for (UDialogueObject* Object : Branch.Path)
+		{
+			if (UDialogueDialogue* Dialogue = Cast<UDialogueDialogue>(Object))
+			{
+				OutNodes.Add(Dialogue);
+			}
+		}
+
+		// A target reached again with as many pauses left leads to the same nodes, as far as prefetching cares
+		UDialogueObject* Target = Branch.GetTarget();
+		if (Pauses <= 1 || !Target)
+		{
+			continue;
+		}
+
+		int32& ExpandedPauses = Expanded.FindOrAdd(Target, 0);
+		if (ExpandedPauses >= Pauses)
+		{
+			continue;
+		}
+		ExpandedPauses = Pauses;
+
+		// Play the branch as if it was picked and explore from its target, then roll it back
+		ShadowedOperation([&]
+		{
+			for (UDialogueObject* Object : Branch.Path)
+			{
+				if (IDialogueFlowObject* FlowObject = Cast<IDialogueFlowObject>(Object))
+				{
+					FlowObject->Execute(GV, MethodsProvider);
+				}
+			}
+
+			TGuardValue<UDialogueObject*> CursorGuard(Cursor, Target);
+			TArray<FDialogueBranch> Next = Explore(Cast<IDialogueFlowObject>(Target), true, 0, false);
+			PredictBranches(Next, Pauses - 1, Expanded, OutNodes);
+		});
+	}
+}
+
+void UDialogueFlowPlayer::FinishCurrentPausedObject(int32 PinIndex)
+{
+	UDialogueNode* Node = Cast<UDialogueNode>(Cursor);
+	if (!Node || Node->OutputPins.Num() == 0)
+	{
+		return;
+	}
+
+	if (Recording)
+	{
+		Recording->AddStep(FDialogueFlowRecording::EStepType::FinishPausedObject, PinIndex);
+	}
+
+	if (Node->OutputPins.IsValidIndex(PinIndex))
+	{
+		Node->OutputPins[PinIndex]->Execute(GetGlobalVariables(), GetMethodsProvider());
+	}
+	else
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("FinishCurrentPausedObject: The index was out of bounds: Index: %d, PinCount: %d"), PinIndex, Node->OutputPins.Num());
+	}
+}
+
+void UDialogueFlowPlayer::StartRecording(int32 Seed)
+{
+	TSharedPtr<FDialogueFlowRecording> NewRecording = MakeShared<FDialogueFlowRecording>();
+	if (!NewRecording->Begin(this, Seed))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Flow player of %s could not start recording"), *GetNameSafe(GetOwner()));
+		return;
+	}
+	Recording = MoveTemp(NewRecording);
+}
+
+bool UDialogueFlowPlayer::StopRecording(const FString& Filename)
+{
+	if (!Recording)
+	{
+		return false;
+	}
+
+	const TSharedPtr<FDialogueFlowRecording> Finished = MoveTemp(Recording);
+	if (!Finished->SaveToFile(Filename))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to write the flow recording to %s"), *Filename);
+		return false;
+	}
+	return true;
+}
+
+UE::Tasks::TTask<TWeakObjectPtr<UDialogueObject>> UDialogueFlowPlayer::AwaitNextPause()
+{
+	return AddAwaiter(PauseAwaiters);
+}
+
+UE::Tasks::TTask<TOptional<FDialogueBranch>> UDialogueFlowPlayer::AwaitChoice()
+{
+	return AddAwaiter(ChoiceAwaiters);
+}
+
+template<typename ResultType>
+UE::Tasks::TTask<ResultType> UDialogueFlowPlayer::AddAwaiter(TArray<TSharedRef<TAwaiter<ResultType>>>& Awaiters)
+{
+	check(IsInGameThread());
+
+	// Inline, the task completes on the thread triggering the event instead of waking a worker
+	TSharedRef<TAwaiter<ResultType>> Awaiter = Awaiters.Add_GetRef(MakeShared<TAwaiter<ResultType>>());
+	return UE::Tasks::Launch(TEXT("DialogueFlowAwait"), [Awaiter]() { return Awaiter->Result; },
+		UE::Tasks::Prerequisites(Awaiter->Event), UE::Tasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::Inline);
+}
+
+template<typename ResultType>
+void UDialogueFlowPlayer::ResolveAwaiters(TArray<TSharedRef<TAwaiter<ResultType>>>& Awaiters, const ResultType& Result)
+{
+	const TArray<TSharedRef<TAwaiter<ResultType>>> Resolved = MoveTemp(Awaiters);
+	Awaiters.Reset();
+	for (const TSharedRef<TAwaiter<ResultType>>& Awaiter : Resolved)
+	{
+		Awaiter->Result = Result;
+		Awaiter->Event.Trigger();
+	}
+}
+
+void UDialogueFlowPlayer::UpdateAvailableBranches()
+{
+	UpdateAvailableBranchesInternal(false);
+}
+
+void UDialogueFlowPlayer::RequestAvailableBranchesUpdate()
+{
+	UWorld* World = GetWorld();
+	UDialogueFlowWorldSubsystem* Subsystem = World ? World->GetSubsystem<UDialogueFlowWorldSubsystem>() : nullptr;
+	if (Subsystem)
+	{
+		Subsystem->AddDirtyPlayer(this);
+	}
+	else
+	{
+		UpdateAvailableBranches();
+	}
+}
+
+bool UDialogueFlowPlayer::ShouldPauseOn(UDialogueObject* Node) const
+{
+	return ShouldPauseOn(Cast<IDialogueFlowObject>(Node));
+}
+
+bool UDialogueFlowPlayer::ShouldPauseOn(IDialogueFlowObject* Node) const
+{
+	return Node && ((uint8)Node->GetPausableType() & PauseOn) != 0;
+}
+
+// ==================== GLOBAL VARIABLES ====================
+
+UDialogueGlobalVariables* UDialogueFlowPlayer::GetGlobalVariables() const
+{
+	if (OverrideGlobalVariables)
+	{
+		return OverrideGlobalVariables;
+	}
+
+	UDialogueDatabase* Database = GetDatabase();
+	return Database ? Database->GetGlobalVariables() : nullptr;
+}
+
+UObject* UDialogueFlowPlayer::GetMethodsProvider() const
+{
+	// Scripts call user methods on the owning actor unless told otherwise
+	return UserMethodsProvider ? UserMethodsProvider : GetOwner();
+}
+
+void UDialogueFlowPlayer::PushVariableState() const
+{
+	if (BatchOverlay)
+	{
+		BatchOverlay->PushState();
+	}
+	else
+	{
+		GetGlobalVariables()->PushState(ShadowLevel);
+	}
+}
+
+void UDialogueFlowPlayer::PopVariableState() const
+{
+	if (BatchOverlay)
+	{
+		BatchOverlay->PopState();
+	}
+	else
+	{
+		GetGlobalVariables()->PopState(ShadowLevel);
+	}
+}
+
+bool UDialogueFlowPlayer::BeginShadow() const
+{
+	if (!BatchOverlay && !GetGlobalVariables())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FlowPlayer cannot get GlobalVariables!"));
+		return false;
+	}
+
+	if (ShadowLevel >= ShadowLevelLimit)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Too many nested ShadowedOperations, possible infinite loop!"));
+		return false;
+	}
+
+	// Push shadow state
+	++ShadowLevel;
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ShadowPushes);
+
+	// Notify
+	PushVariableState();
+	if (bBroadcastShadowOps)
+	{
+		OnShadowOpStartNative.Broadcast();
+		if (OnShadowOpStart.IsBound())
+		{
+			const_cast<UDialogueFlowPlayer*>(this)->OnShadowOpStart.Broadcast();
+		}
+	}
+	return true;
+}
+
+void UDialogueFlowPlayer::EndShadow() const
+{
+	// Pop shadow state
+	if (bBroadcastShadowOps)
+	{
+		OnShadowOpEndNative.Broadcast();
+		if (OnShadowOpEnd.IsBound())
+		{
+			const_cast<UDialogueFlowPlayer*>(this)->OnShadowOpEnd.Broadcast();
+		}
+	}
+	PopVariableState();
+
+	if (ShadowLevel > 0)
+	{
+		--ShadowLevel;
+	}
+}
+
+// ==================== EXPLORATION ====================
+
+bool UDialogueFlowPlayer::FGraphExploreContext::EvaluateCondition(const FDialogueScriptProgram& Program) const
+{
+	return Overlay ? FDialogueScriptVM::EvaluateCondition(Program, *Overlay, MethodsProvider) : FDialogueScriptVM::EvaluateCondition(Program, GlobalVariables, MethodsProvider);
+}
+
+void UDialogueFlowPlayer::FGraphExploreContext::ExecuteInstruction(const FDialogueScriptProgram& Program) const
+{
+	if (Overlay)
+	{
+		FDialogueScriptVM::ExecuteInstruction(Program, *Overlay, MethodsProvider);
+	}
+	else
+	{
+		FDialogueScriptVM::ExecuteInstruction(Program, GlobalVariables, MethodsProvider);
+	}
+}
+
+TArray<FDialogueBranch> UDialogueFlowPlayer::Explore(IDialogueFlowObject* Node, bool bShadowed, int32 Depth, bool bIncludeCurrent)
+{
+	TArray<FDialogueBranch> OutBranches;
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::NodesVisited);
+
+	UDialogueObject* Object = Cast<UDialogueObject>(Node ? Node->_getUObject() : nullptr);
+
+	if (Depth == 0)
+	{
+		NumExploredBranches = 0;
+		bReachedBranchLimit = false;
+	}
+
+	// Check stop condition
+	if (Depth > ExploreLimit || !Node || (Object != Cursor && ShouldPauseOn(Node)))
+	{
+		if (BranchLimit > 0 && NumExploredBranches >= BranchLimit)
+		{
+			bReachedBranchLimit = true;
+			return OutBranches;
+		}
+		++NumExploredBranches;
+
+		if (Depth > ExploreLimit)
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("ExploreLimit (%d) reached, stopping exploration!"), ExploreLimit);
+		}
+		if (!Node)
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Found a nullptr node when exploring a branch!"));
+		}
+
+		// Target reached, create a branch. The last node never affects the validity of the branch,
+		// only nodes the branch runs through do.
+		FDialogueBranch Branch;
+		if (Object)
+		{
+			Branch.Path.Add(Object);
+		}
+		OutBranches.Add(Branch);
+	}
+	else
+	{
+		// A pure node leaves nothing to roll back, the objects it continues at open the shadow state where they need it
+		const bool bShadow = bShadowed || bShadowPending;
+		const bool bOpenShadow = bShadow && Node->HasSideEffects();
+		TGuardValue<bool> PendingGuard(bShadowPending, bShadow && !bOpenShadow);
+
+		if (bOpenShadow)
+		{
+			ShadowedOperation([&] { Node->Explore(this, OutBranches, Depth + 1); });
+		}
+		else
+		{
+			Node->Explore(this, OutBranches, Depth + 1);
+		}
+
+		// Add this node to the head of all the branches
+		if (bIncludeCurrent)
+		{
+			for (FDialogueBranch& Branch : OutBranches)
+			{
+				Branch.Path.Insert(Object, 0);
+			}
+		}
+	}
+
+	return OutBranches;
+}
+
+void UDialogueFlowPlayer::ExploreGraph(const FGraphExploreContext& Context, FDialogueFlowGraph::FVertex Vertex, bool bShadowed, int32 Depth, int32 Parent, bool bIsValid, bool bIncludeCurrent)
+{
+	// Custom nodes may explore back into a flow graph, only work off the frames of this call
+	const int32 Base = GraphExploreStack.Num();
+
+	FGraphExploreFrame& Start = GraphExploreStack.AddDefaulted_GetRef();
+	Start.Vertex = Vertex;
+	Start.Parent = Parent;
+	Start.Depth = Depth;
+	Start.bShadowed = bShadowed;
+	Start.bIsValid = bIsValid;
+	Start.bIncludeCurrent = bIncludeCurrent;
+
+	RunGraphFrames(Context, Base);
+}
+
+void UDialogueFlowPlayer::RunGraphFrames(const FGraphExploreContext& Context, int32 Base)
+{
+	// Every slice visits at least one frame, so the exploration always gets on
+	bool bVisited = false;
+	while (GraphExploreStack.Num() > Base)
+	{
+		if (bVisited && Context.Deadline > 0.0 && !GraphExploreStack.Last().bEndShadow && FPlatformTime::Seconds() >= Context.Deadline)
+		{
+			Context.bSuspended = true;
+			return;
+		}
+
+		const FGraphExploreFrame Frame = GraphExploreStack.Pop(false);
+		if (Frame.bEndShadow)
+		{
+			EndShadow();
+		}
+		else if (!Context.bNeedsGameThread)
+		{
+			// Once a worker gives up or the limit is reached, the rest only unwinds the shadow levels still open
+			if (BranchLimit > 0 && BranchArena.Leaves.Num() >= BranchLimit)
+			{
+				Context.bReachedBranchLimit = true;
+			}
+			else
+			{
+				VisitGraphFrame(Context, Frame);
+				bVisited = true;
+			}
+		}
+	}
+}
+
+void UDialogueFlowPlayer::VisitGraphFrame(const FGraphExploreContext& Context, const FGraphExploreFrame& InFrame)
+{
+	FGraphExploreFrame Frame = InFrame;
+	for (;;)
+	{
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::NodesVisited);
+		UDialogueObject* Object = Context.Graph.GetObject(Frame.Vertex);
+
+		// Check stop condition
+		if (Frame.Depth > ExploreLimit || !Object || (Object != Cursor && (Context.Graph.GetPausableType(Frame.Vertex) & PauseOn) != 0))
+		{
+			if (Frame.Depth > ExploreLimit)
+			{
+				UE_LOG(LogDialogueRuntime, Warning, TEXT("ExploreLimit (%d) reached, stopping exploration!"), ExploreLimit);
+			}
+			if (!Object)
+			{
+				UE_LOG(LogDialogueRuntime, Warning, TEXT("Found a nullptr node when exploring a branch!"));
+			}
+
+			BranchArena.AddLeaf(Object ? BranchArena.Push(Object, Frame.Parent) : Frame.Parent, Frame.bIsValid);
+			return;
+		}
+
+		const int32 Segment = Frame.bIncludeCurrent ? BranchArena.Push(Object, Frame.Parent) : Frame.Parent;
+
+		// A fused corridor tests the conditions on its way at once, only its vertices are left to add to the path
+		if (const FDialogueFlowGraph::FFusedCorridor* Corridor = GetFusedCorridor(Context, Frame.Vertex, Frame.Depth))
+		{
+			if (!Context.CanRun(&Corridor->Program))
+			{
+				return;
+			}
+
+			const TArrayView<const FDialogueFlowGraph::FVertex> Vertices = Context.Graph.GetCorridorVertices(*Corridor);
+			for (const FDialogueFlowGraph::FVertex& Vertex : Vertices)
+			{
+				Context.AddDependency(Vertex, Vertex.bIsPin ? Context.Graph.Pins[Vertex.Index].Program : nullptr);
+			}
+
+			const bool bPassed = Frame.PinCondition >= 0 ? Frame.PinCondition != 0 : Context.EvaluateCondition(Corridor->Program);
+			if (!bPassed && bIgnoreInvalidBranches)
+			{
+				return;
+			}
+
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::NodesVisited, Vertices.Num() - 1);
+			int32 Tail = Segment;
+			for (int32 i = 1; i < Vertices.Num(); ++i)
+			{
+				Tail = BranchArena.Push(Context.Graph.GetObject(Vertices[i]), Tail);
+			}
+
+			Frame.Vertex = Corridor->End;
+			Frame.Parent = Tail;
+			Frame.Depth += 2 * Vertices.Num();
+			Frame.bIsValid = Frame.bIsValid && bPassed;
+			Frame.bIncludeCurrent = true;
+			Frame.PinCondition = -1;
+			continue;
+		}
+
+		// A corridor vertex has nothing to run, roll back or choose from, walk on without exploring it in full
+		const FDialogueFlowGraph::FVertex Next = Context.Graph.GetCorridorNext(Frame.Vertex);
+		if (Next.IsValid())
+		{
+			Frame.Vertex = Next;
+			Frame.Parent = Segment;
+			Frame.Depth += 2;
+			Frame.bIncludeCurrent = true;
+			Frame.PinCondition = -1;
+			continue;
+		}
+
+		if (Frame.bShadowed && !Context.Graph.IsPure(Frame.Vertex))
+		{
+			if (BeginShadow())
+			{
+				// Below the children, so the shadow level ends once all of them are explored
+				GraphExploreStack.AddDefaulted_GetRef().bEndShadow = true;
+				ExploreGraphVertex(Context, Frame.Vertex, Segment, Frame.bIsValid, Frame.Depth + 1, false, Frame.PinCondition);
+			}
+		}
+		else
+		{
+			// A pure vertex leaves nothing to roll back, its children open the shadow state where they need it
+			ExploreGraphVertex(Context, Frame.Vertex, Segment, Frame.bIsValid, Frame.Depth + 1, Frame.bShadowed, Frame.PinCondition);
+		}
+		return;
+	}
+}
+
+void UDialogueFlowPlayer::PushGraphFrame(FDialogueFlowGraph::FVertex Vertex, bool bShadowed, int32 Depth, int32 Parent, bool bIsValid, int8 PinCondition)
+{
+	FGraphExploreFrame& Frame = GraphExploreStack.AddDefaulted_GetRef();
+	Frame.Vertex = Vertex;
+	Frame.Parent = Parent;
+	Frame.Depth = Depth;
+	Frame.bShadowed = bShadowed;
+	Frame.bIsValid = bIsValid;
+	Frame.PinCondition = PinCondition;
+}
+
+const FDialogueFlowGraph::FFusedCorridor* UDialogueFlowPlayer::GetFusedCorridor(const FGraphExploreContext& Context, FDialogueFlowGraph::FVertex Vertex, int32 Depth) const
+{
+	// Each vertex walked is two levels deeper, the vertex by vertex walk stops at the same depth or pause
+	const FDialogueFlowGraph::FFusedCorridor* Corridor = Context.Graph.GetFusedCorridor(Vertex);
+	if (!Corridor || (Corridor->PausableTypes & PauseOn) != 0 || Depth + 2 * (Corridor->NumVertices - 1) > ExploreLimit)
+	{
+		return nullptr;
+	}
+	return Corridor;
+}
+
+bool UDialogueFlowPlayer::EvaluateHubConditions(const FGraphExploreContext& Context, const FDialogueFlowGraphPin& Pin, int32 Depth)
+{
+	// Workers run on overlays, passing conditions on between frames is only worth it for the menus of the game thread
+	if (Context.Overlay || Pin.NumEdges < 2)
+	{
+		return false;
+	}
+
+	HubPrograms.Reset();
+	int32 NumBatched = 0;
+	for (int32 Edge = Pin.FirstEdge; Edge < Pin.FirstEdge + Pin.NumEdges; ++Edge)
+	{
+		// A condition with side effects changes what the siblings after it see, it runs when its pin is explored
+		const int32 Target = Context.Graph.Edges[Edge];
+		const FDialogueFlowGraph::FFusedCorridor* Corridor = Target != INDEX_NONE ? GetFusedCorridor(Context, FDialogueFlowGraph::FVertex(Target, true), Depth) : nullptr;
+		const FDialogueScriptProgram* Program = Corridor ? &Corridor->Program : Target != INDEX_NONE ? Context.Graph.Pins[Target].Program : nullptr;
+		const bool bBatch = Program && Program->IsCompiled() && Program->bIsPure;
+		HubPrograms.Add(bBatch ? Program : nullptr);
+		NumBatched += bBatch ? 1 : 0;
+	}
+
+	if (NumBatched < 2)
+	{
+		return false;
+	}
+
+	HubConditions.SetNumUninitialized(HubPrograms.Num());
+	FDialogueScriptVM::EvaluateConditions(HubPrograms, Context.GlobalVariables, Context.MethodsProvider, HubConditions);
+	return true;
+}
+
+void UDialogueFlowPlayer::ExploreGraphVertex(const FGraphExploreContext& Context, FDialogueFlowGraph::FVertex Vertex, int32 Segment, bool bIsValid, int32 Depth, bool bShadowChildren, int8 PinCondition)
+{
+	using FVertex = FDialogueFlowGraph::FVertex;
+	const FDialogueFlowGraph& Graph = Context.Graph;
+
+	if (Vertex.bIsPin)
+	{
+		const FDialogueFlowGraphPin& Pin = Graph.Pins[Vertex.Index];
+		if (Pin.bIsInput)
+		{
+			if (!Context.CanRun(Pin.Program))
+			{
+				return;
+			}
+			Context.AddDependency(Vertex, Pin.Program);
+
+			// Evaluate first, the condition could have side effects
+			const bool bPinIsValid = PinCondition >= 0 ? PinCondition != 0 : !Pin.Program || Context.EvaluateCondition(*Pin.Program);
+			if (!bPinIsValid && bIgnoreInvalidBranches)
+			{
+				return;
+			}
+
+			PushGraphFrame(FVertex(Pin.OwnerNode, false), bShadowChildren, Depth + 1, Segment, bIsValid && bPinIsValid);
+		}
+		else
+		{
+			if (!Context.CanRun(Pin.Program))
+			{
+				return;
+			}
+			Context.AddDependency(Vertex, Pin.Program);
+
+			if (Pin.Program)
+			{
+				Context.ExecuteInstruction(*Pin.Program);
+			}
+
+			if (Pin.NumEdges > 0)
+			{
+				const bool bShadowed = bShadowChildren || Pin.NumEdges > 1;
+				const bool bBatched = EvaluateHubConditions(Context, Pin, Depth + 1);
+				for (int32 Edge = Pin.FirstEdge + Pin.NumEdges - 1; Edge >= Pin.FirstEdge; --Edge)
+				{
+					const int32 Offset = Edge - Pin.FirstEdge;
+					const int8 Condition = bBatched && HubPrograms[Offset] ? (HubConditions[Offset] ? 1 : 0) : -1;
+					PushGraphFrame(FVertex(Graph.Edges[Edge], true), bShadowed, Depth + 1, Segment, bIsValid, Condition);
+				}
+			}
+			else
+			{
+				// Dead end
+				BranchArena.AddLeaf(Segment, bIsValid);
+			}
+		}
+		return;
+	}
+
+	const FDialogueFlowGraphNode& Node = Graph.Nodes[Vertex.Index];
+	if (!Context.CanRun(Node.Program))
+	{
+		return;
+	}
+	Context.AddDependency(Vertex, Node.Program);
+
+	switch (Node.Kind)
+	{
+	case EDialogueFlowNodeKind::Custom:
+	{
+		// Custom classes may do anything in Explore
+		if (Context.Overlay)
+		{
+			Context.bNeedsGameThread = true;
+			return;
+		}
+
+		// Custom nodes explore themselves, append their branches to the current path
+		if (Context.Dependencies)
+		{
+			Context.Dependencies->bDependsOnAll = true;
+		}
+		TArray<FDialogueBranch> CustomBranches;
+		Node.Object->Explore(this, CustomBranches, Depth);
+		for (const FDialogueBranch& Branch : CustomBranches)
+		{
+			int32 Tail = Segment;
+			for (UDialogueObject* Object : Branch.Path)
+			{
+				Tail = BranchArena.Push(Object, Tail);
+			}
+			BranchArena.AddLeaf(Tail, bIsValid && Branch.bIsValid);
+		}
+		return;
+	}
+
+	case EDialogueFlowNodeKind::Condition:
+		if (Node.NumOutputPins == 2)
+		{
+			const bool bResult = !Node.Program || Context.EvaluateCondition(*Node.Program);
+			PushGraphFrame(FVertex(Node.FirstOutputPin + (bResult ? 0 : 1), true), bShadowChildren, Depth + 1, Segment, bIsValid);
+			return;
+		}
+		break;
+
+	case EDialogueFlowNodeKind::Instruction:
+		if (Node.Program)
+		{
+			Context.ExecuteInstruction(*Node.Program);
+		}
+		break;
+
+	case EDialogueFlowNodeKind::Jump:
+		if (Node.JumpTargetPin != INDEX_NONE)
+		{
+			PushGraphFrame(FVertex(Node.JumpTargetPin, true), bShadowChildren, Depth + 1, Segment, bIsValid);
+		}
+		else
+		{
+			// Dead end
+			BranchArena.AddLeaf(Segment, bIsValid);
+		}
+		return;
+
+	default:
+		break;
+	}
+
+	// Continue on output pins
+	if (Node.NumOutputPins > 0)
+	{
+		const bool bShadowed = bShadowChildren || Node.NumOutputPins > 1;
+		for (int32 PinIndex = Node.FirstOutputPin + Node.NumOutputPins - 1; PinIndex >= Node.FirstOutputPin; --PinIndex)
+		{
+			PushGraphFrame(FVertex(PinIndex, true), bShadowed, Depth + 1, Segment, bIsValid);
+		}
+	}
+	else
+	{
+		// Dead end
+		BranchArena.AddLeaf(Segment, bIsValid);
+	}
+}
+
+void FDialogueBranchArena::Materialize(TArray<FDialogueBranch>& OutBranches) const
+{
+	int32 NumBranches = 0;
+	for (const FLeaf& Leaf : Leaves)
+	{
+		if (Leaf.Segment == INDEX_NONE)
+		{
+			continue;
+		}
+
+		int32 Length = 0;
+		for (int32 Segment = Leaf.Segment; Segment != INDEX_NONE; Segment = Segments[Segment].Parent)
+		{
+			++Length;
+		}
+
+		if (NumBranches == OutBranches.Num())
+		{
+			OutBranches.AddDefaulted();
+		}
+		FDialogueBranch& Branch = OutBranches[NumBranches];
+		Branch.bIsValid = Leaf.bIsValid;
+		Branch.Index = NumBranches++;
+
+		// Segments link backwards, fill the path from its end
+		Branch.Path.SetNumUninitialized(Length, false);
+		for (int32 Segment = Leaf.Segment; Segment != INDEX_NONE; Segment = Segments[Segment].Parent)
+		{
+			Branch.Path[--Length] = Segments[Segment].Object;
+		}
+	}
+
+	OutBranches.SetNum(NumBranches, false);
+}
+
+void UDialogueFlowPlayer::UpdateAvailableBranchesInternal(bool bIsStartup)
+{
+	// A new update replaces the sliced exploration in progress
+	SlicedExplore.Reset();
+	bBranchesPartial = false;
+
+	// AvailableBranches is kept until it is overwritten by the exploration, so its path buffers get reused
+	if (PauseOn == 0)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("PauseOn is not set, not exploring the flow as it would not pause on any node."));
+		AvailableBranches.Reset();
+		return;
+	}
+
+	if (!Cursor)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Cannot explore flow, cursor is not set!"));
+		AvailableBranches.Reset();
+		return;
+	}
+
+	// Stream in the packages the flow may continue into before it gets there
+	const UDialoguePackage* Package = Cursor->GetTypedOuter<UDialoguePackage>();
+	if (Package != CursorPackage.Get())
+	{
+		CursorPackage = Package;
+		UDialogueDatabase* Database = Package ? GetDatabase() : nullptr;
+		if (Database)
+		{
+			Database->LoadReferencedPackages(Package->Name);
+		}
+	}
+
+	if (ExploreFromCursor(bIsStartup))
+	{
+		FinishBranchesUpdate(bIsStartup);
+	}
+}
+
+void UDialogueFlowPlayer::FinishBranchesUpdate(bool bIsStartup)
+{
+	// If we're just starting up, check if we should fast-forward
+	if (bIsStartup && FastForwardToPause())
+	{
+		// Fast-forwarding calls UpdateAvailableBranches again
+		return;
+	}
+
+	BroadcastPaused();
+}
+
+void UDialogueFlowPlayer::BroadcastPaused()
+{
+	OnPlayerPausedNative.Broadcast(Cursor);
+	if (OnPlayerPaused.IsBound())
+	{
+		OnPlayerPaused.Broadcast(Cursor);
+	}
+
+	OnBranchesUpdatedNative.Broadcast(AvailableBranches);
+	if (OnBranchesUpdated.IsBound())
+	{
+		OnBranchesUpdated.Broadcast(AvailableBranches);
+	}
+
+	if (PauseAwaiters.Num() > 0)
+	{
+		ResolveAwaiters(PauseAwaiters, TWeakObjectPtr<UDialogueObject>(Cursor));
+	}
+}
+
+bool UDialogueFlowPlayer::ExploreFromCursor(bool bIncludeCurrent, bool bAllowSlicing)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueExplore);
+
+	UDialogueGlobalVariables* GV = bUseExplorationCache ? GetGlobalVariables() : nullptr;
+	if (GV)
+	{
+		BindExplorationCache(GV);
+
+		const FDialogueExplorationCacheEntry* Entry = ExplorationCache.Find(Cursor);
+		if (Entry && Entry->PauseOn == PauseOn && Entry->bIgnoreInvalidBranches == bIgnoreInvalidBranches && Entry->bIncludeCurrent == bIncludeCurrent)
+		{
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ExplorationCacheHits);
+			AvailableBranches = Entry->Branches;
+
+			// The entry was explored without untracked reads, what it read is all the branches depend on
+			ResetBranchDependencies(nullptr);
+			BranchDependencies.Slots = Entry->ReadSlots;
+			BranchDependencies.bDependsOnAll = !bUpdateOnVariableChange;
+			WatchBranchDependencies();
+			return true;
+		}
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ExplorationCacheMisses);
+	}
+
+	// Record every variable the scripts read while exploring
+	FDialogueVariableReadSet ReadSet;
+	if (GV)
+	{
+		GV->SetReadRecorder(&ReadSet);
+	}
+
+	// Keep the index alive, scripts may load or unload packages while exploring
+	UDialogueDatabase* Database = bUseFlowGraph ? GetDatabase() : nullptr;
+	TSharedPtr<const FDialogueObjectIndex> Index;
+	if (Database)
+	{
+		Index = Database->GetObjectIndex();
+	}
+	const FDialogueFlowGraph::FVertex Start = Index ? Index->FlowGraph.FindVertex(Cursor) : FDialogueFlowGraph::FVertex();
+	ResetBranchDependencies(Start.IsValid() ? Index : nullptr);
+	bool bExplored = false;
+	if (Start.IsValid() && bAllowSlicing && !GV && CanExploreSliced())
+	{
+		BeginSlicedExplore(Index, Start, bIncludeCurrent);
+		const ESliceResult Result = RunExploreSlice();
+		if (Result == ESliceResult::Suspended)
+		{
+			// Continued by TickComponent, nothing can be played until it completes
+			AvailableBranches.Reset();
+			SetComponentTickEnabled(true);
+			return false;
+		}
+
+		bExplored = Result == ESliceResult::Complete;
+		if (!bExplored)
+		{
+			ResetBranchDependencies(Index);
+		}
+	}
+
+	if (!bExplored && Start.IsValid())
+	{
+		FGraphExploreContext Context{ Index->FlowGraph, GetGlobalVariables(), GetMethodsProvider() };
+		Context.Dependencies = bUpdateOnVariableChange ? &BranchDependencies : nullptr;
+		BranchArena.Reset();
+		ExploreGraph(Context, Start, true, 0, INDEX_NONE, true, bIncludeCurrent);
+		bBranchesPartial = Context.bReachedBranchLimit;
+
+		// Empty branches are skipped while materializing
+		BranchArena.Materialize(AvailableBranches);
+	}
+	else if (!bExplored)
+	{
+		AvailableBranches = Explore(Cast<IDialogueFlowObject>(Cursor), true, 0, bIncludeCurrent);
+		bBranchesPartial = bReachedBranchLimit;
+
+		// Prune empty branches
+		AvailableBranches.RemoveAllSwap([](const FDialogueBranch& Branch) { return Branch.Path.Num() == 0; });
+	}
+
+	if (GV)
+	{
+		GV->SetReadRecorder(nullptr);
+	}
+
+	PublishExploredBranches();
+
+	// Cut short, the branches depend on more than the exploration read
+	if (!GV || ReadSet.bHasUntrackedReads || bBranchesPartial)
+	{
+		return true;
+	}
+
+	if (ExplorationCache.Num() >= ExplorationCacheSize && !ExplorationCache.Contains(Cursor))
+	{
+		ExplorationCache.Reset();
+	}
+
+	FDialogueExplorationCacheEntry& NewEntry = ExplorationCache.FindOrAdd(Cursor);
+	NewEntry.Branches = AvailableBranches;
+	NewEntry.ReadSlots = MoveTemp(ReadSet.Slots);
+	NewEntry.PauseOn = PauseOn;
+	NewEntry.bIgnoreInvalidBranches = bIgnoreInvalidBranches;
+	NewEntry.bIncludeCurrent = bIncludeCurrent;
+	return true;
+}
+
+void UDialogueFlowPlayer::PublishExploredBranches()
+{
+	if (bBranchesPartial)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("BranchLimit (%d) reached, stopping exploration!"), BranchLimit);
+	}
+
+	// Every branch needs its index so that Play() can take a branch as input
+	for (int32 i = 0; i < AvailableBranches.Num(); ++i)
+	{
+		AvailableBranches[i].Index = i;
+	}
+
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::BranchesProduced, AvailableBranches.Num());
+	FDialogueRuntimeStats::Flush();
+	WatchBranchDependencies();
+}
+
+// ==================== SLICED EXPLORATION ====================
+
+struct UDialogueFlowPlayer::FSlicedExplore
+{
+	explicit FSlicedExplore(FDialogueVariableSnapshotRef Snapshot)
+		: Overlay(MoveTemp(Snapshot))
+	{
+	}
+
+	/** Keeps the flow graph alive between slices */
+	TSharedPtr<const FDialogueObjectIndex> Index;
+
+	/** Writes of the exploration, over the variables as they were when it started */
+	FDialogueVariableOverlay Overlay;
+
+	UObject* MethodsProvider = nullptr;
+	bool bIncludeCurrent = false;
+
+	/** Frames, branches and open shadow levels between slices; the player's own are swapped in while a slice runs */
+	TArray<FGraphExploreFrame> Stack;
+	FDialogueBranchArena Arena;
+	uint32 ShadowLevel = 0;
+
+	bool bReachedBranchLimit = false;
+};
+
+bool UDialogueFlowPlayer::CanExploreSliced() const
+{
+	// The shadow levels of a slice outlive it, so it explores against a snapshot and does not fire shadow events
+	const UDialogueGlobalVariables* GV = GetGlobalVariables();
+	return ExploreBudgetMicroseconds > 0 && HasBegunPlay() && !bPrewarming && !bBroadcastShadowOps && ShadowLevel == 0 && GV && GV->GetShadowLevel() == 0;
+}
+
+void UDialogueFlowPlayer::BeginSlicedExplore(const TSharedPtr<const FDialogueObjectIndex>& Index, FDialogueFlowGraph::FVertex Start, bool bIncludeCurrent)
+{
+	UDialogueGlobalVariables* GV = GetGlobalVariables();
+	GV->PublishSnapshot();
+
+	SlicedExplore = MakeShared<FSlicedExplore>(GV->GetSnapshot().ToSharedRef());
+	SlicedExplore->Index = Index;
+	SlicedExplore->MethodsProvider = GetMethodsProvider();
+	SlicedExplore->bIncludeCurrent = bIncludeCurrent;
+
+	FGraphExploreFrame& Frame = SlicedExplore->Stack.AddDefaulted_GetRef();
+	Frame.Vertex = Start;
+	Frame.bShadowed = true;
+	Frame.bIncludeCurrent = bIncludeCurrent;
+}
+
+UDialogueFlowPlayer::ESliceResult UDialogueFlowPlayer::RunExploreSlice()
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueExplore);
+
+	FSlicedExplore& Sliced = *SlicedExplore;
+	FGraphExploreContext Context{ Sliced.Index->FlowGraph, nullptr, Sliced.MethodsProvider };
+	Context.Overlay = &Sliced.Overlay;
+	Context.Dependencies = bUpdateOnVariableChange ? &BranchDependencies : nullptr;
+	Context.Deadline = FPlatformTime::Seconds() + ExploreBudgetMicroseconds * 1e-6;
+
+	// Explorations between slices, e.g. predictions, work on the player's stack and arena as usual
+	Swap(GraphExploreStack, Sliced.Stack);
+	Swap(BranchArena, Sliced.Arena);
+	Swap(ShadowLevel, Sliced.ShadowLevel);
+	BatchOverlay = &Sliced.Overlay;
+
+	RunGraphFrames(Context, 0);
+
+	BatchOverlay = nullptr;
+	Swap(ShadowLevel, Sliced.ShadowLevel);
+	Swap(BranchArena, Sliced.Arena);
+	Swap(GraphExploreStack, Sliced.Stack);
+
+	Sliced.bReachedBranchLimit |= Context.bReachedBranchLimit;
+	if (Context.bSuspended)
+	{
+		return ESliceResult::Suspended;
+	}
+
+	const TSharedPtr<FSlicedExplore> Finished = MoveTemp(SlicedExplore);
+	if (Context.bNeedsGameThread)
+	{
+		return ESliceResult::Abandoned;
+	}
+
+	bBranchesPartial = Finished->bReachedBranchLimit;
+	Finished->Arena.Materialize(AvailableBranches);
+	return ESliceResult::Complete;
+}
+
+void UDialogueFlowPlayer::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!SlicedExplore)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	const bool bIsStartup = SlicedExplore->bIncludeCurrent;
+	const ESliceResult Result = RunExploreSlice();
+	if (Result == ESliceResult::Suspended)
+	{
+		return;
+	}
+
+	SetComponentTickEnabled(false);
+	if (Result == ESliceResult::Complete)
+	{
+		PublishExploredBranches();
+	}
+	else
+	{
+		ExploreFromCursor(bIsStartup, false);
+	}
+	FinishBranchesUpdate(bIsStartup);
+}
+
+// ==================== BATCHED UPDATES ====================
+
+bool UDialogueFlowPlayer::PrepareBatchedExplore(FDialogueBatchedExplore& OutExplore) const
+{
+	// The exploration cache and shadow events are game thread only, a sliced exploration is replaced there
+	if (!bUseFlowGraph || bUseExplorationCache || PauseOn == 0 || !Cursor || ShadowLevel > 0 || bBroadcastShadowOps || SlicedExplore)
+	{
+		return false;
+	}
+
+	UDialogueDatabase* Database = GetDatabase();
+	UDialogueGlobalVariables* GV = GetGlobalVariables();
+	if (!Database || !GV)
+	{
+		return false;
+	}
+
+	OutExplore.Index = Database->GetObjectIndex();
+	OutExplore.Start = OutExplore.Index->FlowGraph.FindVertex(Cursor);
+	OutExplore.Variables = GV;
+	OutExplore.MethodsProvider = GetMethodsProvider();
+	OutExplore.bNeedsGameThread = false;
+	return OutExplore.Start.IsValid();
+}
+
+void UDialogueFlowPlayer::RunBatchedExplore(FDialogueBatchedExplore& Explore, FDialogueVariableOverlay& Overlay)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueExploreBatched);
+
+	FGraphExploreContext Context{ Explore.Index->FlowGraph, nullptr, Explore.MethodsProvider };
+	Context.Overlay = &Overlay;
+
+	// Only this player's worker touches its dependencies
+	ResetBranchDependencies(Explore.Index);
+	Context.Dependencies = bUpdateOnVariableChange ? &BranchDependencies : nullptr;
+
+	BatchOverlay = &Overlay;
+	BranchArena.Reset();
+	ExploreGraph(Context, Explore.Start, true, 0, INDEX_NONE, true, false);
+	BatchOverlay = nullptr;
+
+	Explore.bNeedsGameThread = Context.bNeedsGameThread;
+	if (!Explore.bNeedsGameThread)
+	{
+		bBranchesPartial = Context.bReachedBranchLimit;
+		BranchArena.Materialize(AvailableBranches);
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::BranchesProduced, AvailableBranches.Num());
+	}
+
+	// Runs on a worker, its counts are only flushed here
+	FDialogueRuntimeStats::Flush();
+}
+
+void UDialogueFlowPlayer::FinishBatchedExplore(const FDialogueBatchedExplore& Explore)
+{
+	if (Explore.bNeedsGameThread)
+	{
+		UpdateAvailableBranches();
+		return;
+	}
+
+	WatchBranchDependencies();
+	BroadcastPaused();
+}
+
+void UDialogueFlowPlayer::InvalidateExplorationCache()
+{
+	ExplorationCache.Reset();
+}
+
+void UDialogueFlowPlayer::BindExplorationCache(UDialogueGlobalVariables* GV)
+{
+	if (ExplorationCacheGlobalVariables.Get() == GV && (ExplorationCacheHandle.IsValid() || !GV))
+	{
+		return;
+	}
+
+	if (UDialogueGlobalVariables* OldGV = ExplorationCacheGlobalVariables.Get())
+	{
+		OldGV->OnSlotChanged.Remove(ExplorationCacheHandle);
+	}
+	ExplorationCacheHandle.Reset();
+
+	// Results explored against another variable set are meaningless now
+	ExplorationCache.Reset();
+	ExplorationCacheGlobalVariables = GV;
+
+	if (GV)
+	{
+		ExplorationCacheHandle = GV->OnSlotChanged.AddUObject(this, &UDialogueFlowPlayer::OnCachedVariableChanged);
+	}
+}
+
+void UDialogueFlowPlayer::OnCachedVariableChanged(const FDialogueVariableSlot& Slot)
+{
+	for (auto It = ExplorationCache.CreateIterator(); It; ++It)
+	{
+		if (It.Value().ReadSlots.Contains(Slot))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+// ==================== VARIABLE DEPENDENCIES ====================
+
+bool UDialogueFlowPlayer::DependsOnVariable(FDialogueVariableSlot Slot) const
+{
+	if (BranchDependencies.bDependsOnAll || BranchDependencies.Slots.Contains(Slot))
+	{
+		return true;
+	}
+
+	// Vertices are only meaningful in the graph they were explored in, once that is gone nothing is known
+	if (BranchDependencies.Vertices.Num() == 0)
+	{
+		return false;
+	}
+	const TSharedPtr<const FDialogueObjectIndex> Index = BranchDependencies.Index.Pin();
+	if (!Index)
+	{
+		return true;
+	}
+
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	for (const FDialogueFlowGraph::FVertex& User : Graph.GetVariableUsers(Slot))
+	{
+		if (BranchDependencies.Vertices[Graph.GetVertexNumber(User)])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UDialogueFlowPlayer::ResetBranchDependencies(const TSharedPtr<const FDialogueObjectIndex>& Index)
+{
+	BranchDependencies.Slots.Reset();
+	if (!bUpdateOnVariableChange || !Index)
+	{
+		BranchDependencies.Index.Reset();
+		BranchDependencies.Vertices.Empty();
+		BranchDependencies.bDependsOnAll = true;
+		return;
+	}
+
+	BranchDependencies.Index = Index;
+	BranchDependencies.Vertices.Init(false, Index->FlowGraph.GetNumVertices());
+	BranchDependencies.bDependsOnAll = false;
+}
+
+void UDialogueFlowPlayer::WatchBranchDependencies()
+{
+	// The branches of a prewarm are not the player's, its own stay watched
+	if (bPrewarming)
+	{
+		return;
+	}
+
+	BindVariableWatch(bUpdateOnVariableChange ? GetGlobalVariables() : nullptr);
+	if (!bUpdateOnVariableChange)
+	{
+		return;
+	}
+
+	// The branches already see every write queued so far, e.g. the instructions of the branch just played
+	if (UWorld* World = GetWorld())
+	{
+		if (UDialogueFlowWorldSubsystem* Subsystem = World->GetSubsystem<UDialogueFlowWorldSubsystem>())
+		{
+			Subsystem->RemoveDirtyPlayer(this);
+		}
+	}
+}
+
+void UDialogueFlowPlayer::BindVariableWatch(UDialogueGlobalVariables* GV)
+{
+	if (WatchedGlobalVariables.Get() == GV && (VariableWatchHandle.IsValid() || !GV))
+	{
+		return;
+	}
+
+	if (UDialogueGlobalVariables* OldGV = WatchedGlobalVariables.Get())
+	{
+		OldGV->OnSlotChanged.Remove(VariableWatchHandle);
+	}
+	VariableWatchHandle.Reset();
+	WatchedGlobalVariables = GV;
+
+	if (GV)
+	{
+		VariableWatchHandle = GV->OnSlotChanged.AddUObject(this, &UDialogueFlowPlayer::OnWatchedVariableChanged);
+	}
+}
+
+void UDialogueFlowPlayer::OnWatchedVariableChanged(const FDialogueVariableSlot& Slot)
+{
+	if (!bUpdateOnVariableChange || !Cursor || !DependsOnVariable(Slot))
+	{
+		return;
+	}
+
+	// Never explore from inside a write, e.g. while a branch is being played; the batched update runs at the end of the frame
+	UWorld* World = GetWorld();
+	if (UDialogueFlowWorldSubsystem* Subsystem = World ? World->GetSubsystem<UDialogueFlowWorldSubsystem>() : nullptr)
+	{
+		Subsystem->AddDirtyPlayer(this);
+	}
+}
+
+// ==================== PREWARMING ====================
+
+void UDialogueFlowPlayer::PrewarmConversation(FDialogueRef StartRef, const FString& PackageName, int32 Pauses, const FOnDialogueConversationPrewarmed& OnReady)
+{
+	CancelPrewarm();
+
+	UDialogueDatabase* Database = GetDatabase();
+	if (!Database || !StartRef.IsValid())
+	{
+		OnReady.ExecuteIfBound(false);
+		return;
+	}
+
+	Prewarm = MakeShared<FPrewarm>();
+	Prewarm->StartRef = StartRef;
+	Prewarm->PackageName = PackageName;
+	Prewarm->Pauses = Pauses;
+	Prewarm->OnReady = OnReady;
+
+	if (PackageName.IsEmpty())
+	{
+		OnPrewarmPackageLoaded(PackageName, true);
+		return;
+	}
+
+	// Calls back right away if the package is loaded
+	FOnDialoguePackageLoaded OnLoaded;
+	OnLoaded.BindUFunction(this, GET_FUNCTION_NAME_CHECKED(UDialogueFlowPlayer, OnPrewarmPackageLoaded));
+	Database->RequestPackage(PackageName, OnLoaded);
+}
+
+void UDialogueFlowPlayer::OnPrewarmPackageLoaded(const FString& PackageName, bool bSuccess)
+{
+	if (!Prewarm || Prewarm->bPackageLoaded || Prewarm->PackageName != PackageName)
+	{
+		return;
+	}
+	Prewarm->bPackageLoaded = true;
+
+	UDialogueDatabase* Database = GetDatabase();
+	UDialogueObject* Start = bSuccess && Database ? Database->GetObject(Prewarm->StartRef.Id) : nullptr;
+	if (!Start)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Cannot prewarm conversation, start node %s was not found."), *Prewarm->StartRef.Id.ToString());
+		FinishPrewarm(false);
+		return;
+	}
+
+	// Jump targets are bound when the package is indexed, what is left is streaming in where the flow may continue
+	if (const UDialoguePackage* Package = Start->GetTypedOuter<UDialoguePackage>())
+	{
+		Database->LoadReferencedPackages(Package->Name);
+	}
+
+	TSet<UDialogueDialogue*> Nodes;
+	const TArray<FDialogueBranch> StartBranches = ExplorePrewarmStart(Start);
+	if (Prewarm->Pauses > 0 && GetGlobalVariables())
+	{
+		TMap<UDialogueObject*, int32> Expanded;
+		PredictBranches(StartBranches, Prewarm->Pauses, Expanded, Nodes);
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	for (const UDialogueDialogue* Dialogue : Nodes)
+	{
+		Dialogue->PrefetchTexts();
+		Dialogue->ResolveSpeaker(Database);
+
+		const UDialogueCharacter* Speaker = Dialogue->GetSpeaker();
+		if (!Speaker)
+		{
+			continue;
+		}
+
+		if (!Speaker->PreviewImage.IsNull() && !Speaker->PreviewImage.IsValid())
+		{
+			Assets.AddUnique(Speaker->PreviewImage.ToSoftObjectPath());
+		}
+		if (!Speaker->VoiceAsset.IsNull() && !Speaker->VoiceAsset.IsValid())
+		{
+			Assets.AddUnique(Speaker->VoiceAsset.ToSoftObjectPath());
+		}
+	}
+
+	if (Assets.Num() == 0)
+	{
+		FinishPrewarm(true);
+		return;
+	}
+
+	// The handle is kept by the player, the delegate may only run once the request returns
+	TSharedPtr<FPrewarm> Loading = Prewarm;
+	PrewarmedAssets = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Assets),
+		FStreamableDelegate::CreateUObject(this, &UDialogueFlowPlayer::OnPrewarmAssetsLoaded, TWeakPtr<FPrewarm>(Loading)));
+}
+
+void UDialogueFlowPlayer::OnPrewarmAssetsLoaded(TWeakPtr<FPrewarm> Loaded)
+{
+	if (Prewarm && Prewarm == Loaded.Pin())
+	{
+		FinishPrewarm(true);
+	}
+}
+
+TArray<FDialogueBranch> UDialogueFlowPlayer::ExplorePrewarmStart(UDialogueObject* Start)
+{
+	// Without pauses there is nothing to explore, and nothing would be cached
+	if (PauseOn == 0)
+	{
+		return TArray<FDialogueBranch>();
+	}
+
+	// Explore as the conversation's start would, then hand the player back its branches
+	TGuardValue<UDialogueObject*> CursorGuard(Cursor, Start);
+	TGuardValue<bool> PrewarmingGuard(bPrewarming, true);
+	TArray<FDialogueBranch> PlayedBranches = MoveTemp(AvailableBranches);
+	FBranchDependencies PlayedDependencies = MoveTemp(BranchDependencies);
+	TGuardValue<bool> PartialGuard(bBranchesPartial, bBranchesPartial);
+
+	ExploreFromCursor(true);
+
+	TArray<FDialogueBranch> StartBranches = MoveTemp(AvailableBranches);
+	AvailableBranches = MoveTemp(PlayedBranches);
+	BranchDependencies = MoveTemp(PlayedDependencies);
+	return StartBranches;
+}
+
+void UDialogueFlowPlayer::FinishPrewarm(bool bSuccess)
+{
+	// OnReady may start the next prewarm
+	TSharedPtr<FPrewarm> Finished = MoveTemp(Prewarm);
+	if (Finished)
+	{
+		Finished->OnReady.ExecuteIfBound(bSuccess);
+	}
+}
+
+void UDialogueFlowPlayer::CancelPrewarm()
+{
+	if (PrewarmedAssets)
+	{
+		PrewarmedAssets->CancelHandle();
+		PrewarmedAssets.Reset();
+	}
+	FinishPrewarm(false);
+}
+
+// ==================== INTERNAL ====================
+
+UDialogueDatabase* UDialogueFlowPlayer::GetDatabase() const
+{
+	return UDialogueDatabase::Get(this);
+}
+
+void UDialogueFlowPlayer::SetCursorToStartNode()
+{
+	// Allows constructing the player without a start node, e.g. from C++
+	if (!StartOn.IsValid())
+	{
+		return;
+	}
+
+	UDialogueDatabase* Database = GetDatabase();
+	if (!Database)
+	{
+		return;
+	}
+
+	SetCursorTo(Database->GetObject(StartOn.Id));
+}
+
+bool UDialogueFlowPlayer::FastForwardToPause()
+{
+	checkNoRecursion();
+
+	if (AvailableBranches.Num() <= 0)
+	{
+		return false;
+	}
+
+	const TArray<UDialogueObject*>& FirstPath = AvailableBranches[0].Path;
+	if (!ensure(FirstPath.Num() > 0))
+	{
+		return false;
+	}
+
+	int32 FastForwardIndex;
+	for (FastForwardIndex = 0; FastForwardIndex < FirstPath.Num(); ++FastForwardIndex)
+	{
+		UDialogueObject* Node = FirstPath[FastForwardIndex];
+		if (ShouldPauseOn(Node))
+		{
+			// Pause on this node
+			break;
+		}
+
+		bool bSplitFound = false;
+		for (int32 b = 1; b < AvailableBranches.Num(); ++b)
+		{
+			const TArray<UDialogueObject*>& Path = AvailableBranches[b].Path;
+			if (!ensure(Path.IsValidIndex(FastForwardIndex)) || Path[FastForwardIndex] != Node)
+			{
+				bSplitFound = true;
+				break;
+			}
+		}
+
+		if (bSplitFound)
+		{
+			// Pause on the node before
+			--FastForwardIndex;
+			break;
+		}
+	}
+
+	if (FastForwardIndex < 0 || FastForwardIndex >= FirstPath.Num())
+	{
+		// No need to fast-forward
+		return false;
+	}
+
+	FDialogueBranch FastForwardBranch;
+	FastForwardBranch.bIsValid = AvailableBranches[0].bIsValid;
+	FastForwardBranch.Path.Append(FirstPath.GetData(), FastForwardIndex + 1);
+
+	// This calls UpdateAvailableBranches again
+	PlayBranch(FastForwardBranch);
+
+	return true;
+}
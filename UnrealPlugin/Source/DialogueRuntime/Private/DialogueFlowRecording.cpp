@@ -0,0 +1,162 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueFlowRecording.h"
+#include "DialogueDatabase.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueObject.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueStateSnapshot.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** The first bytes of every recording, "DREC" */
+	constexpr uint32 RecordingMagic = 0x43455244;
+}
+
+FArchive& operator<<(FArchive& Ar, FDialogueFlowRecording::FStep& Step)
+{
+	uint8 Type = (uint8)Step.Type;
+	Ar << Type << Step.Value << Step.Id;
+	Step.Type = (FDialogueFlowRecording::EStepType)Type;
+	return Ar;
+}
+
+bool FDialogueFlowRecording::Begin(UDialogueFlowPlayer* Player, int32 InSeed)
+{
+	Steps.Reset();
+	Seed = InSeed;
+
+	const UDialogueObject* Cursor = Player ? Player->GetCursor() : nullptr;
+	StartId = Cursor ? Cursor->Id : FDialogueId();
+
+	UDialogueFlowPlayer* const Players[] = { Player };
+	return Player && FDialogueStateSnapshot::Save(InitialState, Player->GetGlobalVariables(), Players);
+}
+
+bool FDialogueFlowRecording::Save(TArray<uint8>& OutBytes) const
+{
+	OutBytes.Reset();
+	FMemoryWriter Ar(OutBytes);
+
+	uint32 Magic = RecordingMagic;
+	int32 Version = static_cast<int32>(EVersion::Latest);
+	Ar << Magic << Version;
+
+	// Saving leaves the recording as it is, the archive only takes it by reference
+	FDialogueFlowRecording& Recording = const_cast<FDialogueFlowRecording&>(*this);
+	Ar << Recording.Seed << Recording.StartId << Recording.InitialState << Recording.Steps;
+
+	return !Ar.IsError();
+}
+
+bool FDialogueFlowRecording::Load(const TArray<uint8>& Bytes)
+{
+	FMemoryReader Ar(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Ar << Magic << Version;
+	if (Ar.IsError() || Magic != RecordingMagic)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Flow recording: the data is not a flow recording"));
+		return false;
+	}
+	if (Version < static_cast<int32>(EVersion::Initial) || Version > static_cast<int32>(EVersion::Latest))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Flow recording: version %d is not supported, the latest is %d"), Version, static_cast<int32>(EVersion::Latest));
+		return false;
+	}
+
+	Ar << Seed << StartId << InitialState << Steps;
+	if (Ar.IsError())
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Flow recording: failed to read the recording"));
+		return false;
+	}
+	return true;
+}
+
+bool FDialogueFlowRecording::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Bytes;
+	return Save(Bytes) && FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FDialogueFlowRecording::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Flow recording: failed to read %s"), *Filename);
+		return false;
+	}
+	return Load(Bytes);
+}
+
+bool FDialogueFlowReplay::Run(const FDialogueFlowRecording& Recording, UDialogueFlowPlayer* Player)
+{
+	StepMicroseconds.Reset(Recording.Steps.Num());
+	NumMismatches = 0;
+
+	UDialogueFlowPlayer* const Players[] = { Player };
+	if (!Player || !FDialogueStateSnapshot::Load(Recording.InitialState, Player->GetGlobalVariables(), Players))
+	{
+		return false;
+	}
+
+	// User methods drawing random numbers draw the recorded ones
+	FMath::RandInit(Recording.Seed);
+	FMath::SRandInit(Recording.Seed);
+
+	const UDialogueDatabase* Database = UDialogueDatabase::Get(Player);
+	for (const FDialogueFlowRecording::FStep& Step : Recording.Steps)
+	{
+		const uint64 CyclesBefore = FPlatformTime::Cycles64();
+		bool bApplied = true;
+
+		switch (Step.Type)
+		{
+		case FDialogueFlowRecording::EStepType::SetCursor:
+		{
+			UDialogueObject* Object = Database ? Database->GetObject(Step.Id) : nullptr;
+			bApplied = Object != nullptr;
+			if (bApplied)
+			{
+				Player->SetCursorTo(Object);
+			}
+			break;
+		}
+
+		case FDialogueFlowRecording::EStepType::PlayBranch:
+		{
+			const FDialogueBranch* Branch = Player->GetAvailableBranches().FindByPredicate([&Step](const FDialogueBranch& Candidate)
+			{
+				return Candidate.Index == Step.Value;
+			});
+			bApplied = Branch != nullptr;
+			if (bApplied)
+			{
+				// PlayBranch replaces the available branches
+				const FDialogueBranch BranchToPlay = *Branch;
+				Player->PlayBranch(BranchToPlay);
+			}
+			break;
+		}
+
+		case FDialogueFlowRecording::EStepType::FinishPausedObject:
+			Player->FinishCurrentPausedObject(Step.Value);
+			break;
+		}
+
+		StepMicroseconds.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CyclesBefore) * 1000.0);
+		if (!bApplied)
+		{
+			++NumMismatches;
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Flow replay: step %d does not fit the flow, skipped"), StepMicroseconds.Num() - 1);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,339 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueFlowSimulator.h"
+#include "DialogueBarkRunner.h"
+#include "DialogueRuntimeStats.h"
+#include "Async/ParallelFor.h"
+#include "Math/RandomStream.h"
+#include <atomic>
+
+namespace
+{
+	/** Random playthroughs a task takes at once */
+	constexpr int64 PlaythroughsPerChunk = 256;
+
+	/** Writes an overlay collects before a playthrough compacts it */
+	constexpr int32 MaxOverlayWrites = 64;
+
+	using FVertex = FDialogueFlowGraph::FVertex;
+
+	/** A subtree of the exhaustive enumeration: the playthroughs starting at a node with a given first line */
+	struct FExhaustiveRoot
+	{
+		int32 StartNode = INDEX_NONE;
+		int32 FirstLine = 0;
+	};
+
+	/** Scratch memory and counts of one worker */
+	struct FSimulationTask
+	{
+		FSimulationTask(const FDialogueFlowGraph& InGraph, FDialogueVariableSnapshotRef InSnapshot, const FDialogueSimulationSettings& InSettings)
+			: Graph(InGraph)
+			, Snapshot(InSnapshot)
+			, Settings(InSettings)
+			, Overlay(MoveTemp(InSnapshot))
+		{
+			Explorer.ExploreLimit = Settings.ExploreLimit;
+			Explorer.ShadowLevelLimit = Settings.ShadowLevelLimit;
+			Explorer.bWarnOnExploreLimit = false;
+			Report.Init(Graph.Nodes.Num(), Settings.HistogramSlots.Num());
+		}
+
+		const FDialogueFlowGraph& Graph;
+		FDialogueVariableSnapshotRef Snapshot;
+		const FDialogueSimulationSettings& Settings;
+
+		FDialogueBarkExplorer Explorer;
+		FDialogueVariableOverlay Overlay;
+		FDialogueSimulationReport Report;
+		TArray<int32> PathNodes;
+
+		/** Explore from a node, counting the explore limit hits if asked to */
+		int32 Explore(int32 Node, bool bCountHits)
+		{
+			const int32 NumLines = Explorer.Explore(Graph, FVertex(Node, false), Settings.PauseOn, Overlay, nullptr);
+			if (bCountHits)
+			{
+				Report.ExploreLimitHits[Node] += Explorer.GetNumExploreLimitHits();
+			}
+			return NumLines;
+		}
+
+		/** Play a line of the last exploration, returns the node of the line */
+		int32 Play(int32 Line)
+		{
+			const int32 LineNode = Explorer.GetLineNode(Line);
+			++Report.LineChoices[LineNode];
+			++Report.NumSteps;
+
+			PathNodes.Reset();
+			Explorer.PlayLine(Line, &PathNodes);
+			for (int32 Node : PathNodes)
+			{
+				++Report.NodeReaches[Node];
+			}
+			return LineNode;
+		}
+
+		void EndPlaythrough()
+		{
+			++Report.NumPlaythroughs;
+			for (int32 i = 0; i < Settings.HistogramSlots.Num(); ++i)
+			{
+				const FDialogueVariableSlot& Slot = Settings.HistogramSlots[i];
+				if (!Overlay.IsValidSlot(Slot))
+				{
+					continue;
+				}
+				if (Slot.Type == EDialogueVariableType::Boolean)
+				{
+					++Report.Histograms[i].FindOrAdd(Overlay.GetBool(Slot) ? 1 : 0);
+				}
+				else if (Slot.Type == EDialogueVariableType::Integer)
+				{
+					++Report.Histograms[i].FindOrAdd(Overlay.GetInt(Slot));
+				}
+			}
+		}
+
+		void RunRandom(int64 Playthrough)
+		{
+			Overlay.Reset(Snapshot);
+			FRandomStream Random((int32)HashCombine(Settings.Seed, GetTypeHash(Playthrough)));
+
+			int32 Node = Settings.StartNodes[Playthrough % Settings.StartNodes.Num()];
+			++Report.NodeReaches[Node];
+
+			for (int32 Step = 0; Step < Settings.MaxSteps; ++Step)
+			{
+				const int32 NumLines = Explore(Node, true);
+				if (NumLines == 0)
+				{
+					++Report.DeadEnds[Node];
+					EndPlaythrough();
+					return;
+				}
+
+				Node = Play(Random.RandHelper(NumLines));
+				if (Overlay.GetNumWrites() > MaxOverlayWrites)
+				{
+					Overlay.Compact();
+				}
+			}
+
+			++Report.NumCutOff;
+			EndPlaythrough();
+		}
+
+		/**
+		 * Enumerate the playthroughs below a root depth first. Every line is played in a shadow level of the overlay,
+		 * so going back to try the next line of a node only pops it. Returns false if the budget ran out.
+		 */
+		bool RunExhaustive(const FExhaustiveRoot& Root, int64 Budget)
+		{
+			struct FChoice
+			{
+				int32 Node;
+				int32 NextLine;
+				int32 EndLine;
+				/** Lines of the explorer are the ones of this node */
+				bool bExplored;
+			};
+
+			Overlay.Reset(Snapshot);
+			TArray<FChoice> Choices;
+			Choices.Add({ Root.StartNode, Root.FirstLine, Root.FirstLine + 1, false });
+
+			const uint64 PlaythroughsBefore = Report.NumPlaythroughs;
+			while (Choices.Num() > 0)
+			{
+				const int32 ChoiceIndex = Choices.Num() - 1;
+				if (Choices[ChoiceIndex].NextLine >= Choices[ChoiceIndex].EndLine)
+				{
+					Choices.Pop(false);
+					if (Choices.Num() > 0)
+					{
+						Overlay.PopState();
+					}
+					continue;
+				}
+
+				if ((int64)(Report.NumPlaythroughs - PlaythroughsBefore) >= Budget)
+				{
+					return false;
+				}
+
+				// The explorer only keeps the lines of its last exploration, explore again from the restored state
+				if (!Choices[ChoiceIndex].bExplored)
+				{
+					Explore(Choices[ChoiceIndex].Node, false);
+					Choices[ChoiceIndex].bExplored = true;
+				}
+
+				Overlay.PushState();
+				const int32 Node = Play(Choices[ChoiceIndex].NextLine++);
+
+				const int32 NumLines = Explore(Node, true);
+				if (NumLines == 0 || Choices.Num() >= Settings.MaxSteps)
+				{
+					if (NumLines == 0)
+					{
+						++Report.DeadEnds[Node];
+					}
+					else
+					{
+						++Report.NumCutOff;
+					}
+					EndPlaythrough();
+					Overlay.PopState();
+
+					// The explorer now holds the lines of Node
+					Choices[ChoiceIndex].bExplored = false;
+					continue;
+				}
+
+				Choices.Add({ Node, 0, NumLines, true });
+				Choices[ChoiceIndex].bExplored = false;
+			}
+			return true;
+		}
+	};
+}
+
+void FDialogueSimulationReport::Init(int32 NumNodes, int32 NumHistograms)
+{
+	NodeReaches.Init(0, NumNodes);
+	LineChoices.Init(0, NumNodes);
+	DeadEnds.Init(0, NumNodes);
+	ExploreLimitHits.Init(0, NumNodes);
+	Histograms.Reset();
+	Histograms.SetNum(NumHistograms);
+	NumPlaythroughs = 0;
+	NumCutOff = 0;
+	NumSteps = 0;
+	bTruncated = false;
+}
+
+void FDialogueSimulationReport::Merge(const FDialogueSimulationReport& Other)
+{
+	check(Other.NodeReaches.Num() == NodeReaches.Num() && Other.Histograms.Num() == Histograms.Num());
+
+	for (int32 i = 0; i < NodeReaches.Num(); ++i)
+	{
+		NodeReaches[i] += Other.NodeReaches[i];
+		LineChoices[i] += Other.LineChoices[i];
+		DeadEnds[i] += Other.DeadEnds[i];
+		ExploreLimitHits[i] += Other.ExploreLimitHits[i];
+	}
+	for (int32 i = 0; i < Histograms.Num(); ++i)
+	{
+		for (const TPair<int32, uint64>& Pair : Other.Histograms[i])
+		{
+			Histograms[i].FindOrAdd(Pair.Key) += Pair.Value;
+		}
+	}
+
+	NumPlaythroughs += Other.NumPlaythroughs;
+	NumCutOff += Other.NumCutOff;
+	NumSteps += Other.NumSteps;
+	bTruncated |= Other.bTruncated;
+}
+
+uint64 FDialogueSimulationReport::GetTotalDeadEnds() const
+{
+	uint64 Total = 0;
+	for (uint64 Count : DeadEnds)
+	{
+		Total += Count;
+	}
+	return Total;
+}
+
+uint64 FDialogueSimulationReport::GetTotalExploreLimitHits() const
+{
+	uint64 Total = 0;
+	for (uint64 Count : ExploreLimitHits)
+	{
+		Total += Count;
+	}
+	return Total;
+}
+
+FDialogueSimulationReport FDialogueFlowSimulator::Run(const FDialogueFlowGraph& Graph, FDialogueVariableSnapshotRef Snapshot, const FDialogueSimulationSettings& InSettings)
+{
+	FDialogueSimulationSettings Settings = InSettings;
+	Settings.StartNodes.RemoveAll([&Graph](int32 Node) { return !Graph.Nodes.IsValidIndex(Node); });
+	Settings.MaxSteps = FMath::Max(Settings.MaxSteps, 1);
+
+	FDialogueSimulationReport Result;
+	Result.Init(Graph.Nodes.Num(), Settings.HistogramSlots.Num());
+	if (Settings.StartNodes.Num() == 0 || Settings.NumPlaythroughs <= 0)
+	{
+		return Result;
+	}
+
+	// The first choices of the exhaustive enumeration are spread over the tasks, starts without a line end right away
+	TArray<FExhaustiveRoot> Roots;
+	if (Settings.bExhaustive)
+	{
+		FSimulationTask RootTask(Graph, Snapshot, Settings);
+		for (int32 StartNode : Settings.StartNodes)
+		{
+			++RootTask.Report.NodeReaches[StartNode];
+			const int32 NumLines = RootTask.Explore(StartNode, true);
+			if (NumLines == 0)
+			{
+				++RootTask.Report.DeadEnds[StartNode];
+				RootTask.EndPlaythrough();
+			}
+			for (int32 Line = 0; Line < NumLines; ++Line)
+			{
+				Roots.Add({ StartNode, Line });
+			}
+		}
+		Result.Merge(RootTask.Report);
+	}
+
+	const int64 NumWorkItems = Settings.bExhaustive ? Roots.Num() : FMath::DivideAndRoundUp(Settings.NumPlaythroughs, PlaythroughsPerChunk);
+	if (NumWorkItems == 0)
+	{
+		return Result;
+	}
+
+	const int32 MaxTasks = Settings.NumTasks > 0 ? Settings.NumTasks : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumTasks = (int32)FMath::Min<int64>(MaxTasks, NumWorkItems);
+	const int64 BudgetPerRoot = FMath::Max<int64>(Settings.NumPlaythroughs / FMath::Max<int64>(NumWorkItems, 1), 1);
+
+	TArray<FDialogueSimulationReport> Reports;
+	Reports.SetNum(NumTasks);
+	std::atomic<int64> NextWorkItem{ 0 };
+
+	// Work items are taken one by one, subtrees of the enumeration differ a lot in size
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		FSimulationTask Task(Graph, Snapshot, Settings);
+		for (int64 Item = NextWorkItem++; Item < NumWorkItems; Item = NextWorkItem++)
+		{
+			if (Settings.bExhaustive)
+			{
+				Task.Report.bTruncated |= !Task.RunExhaustive(Roots[(int32)Item], BudgetPerRoot);
+				continue;
+			}
+
+			const int64 End = FMath::Min((Item + 1) * PlaythroughsPerChunk, Settings.NumPlaythroughs);
+			for (int64 Playthrough = Item * PlaythroughsPerChunk; Playthrough < End; ++Playthrough)
+			{
+				Task.RunRandom(Playthrough);
+			}
+		}
+
+		Reports[TaskIndex] = MoveTemp(Task.Report);
+		FDialogueRuntimeStats::Flush();
+	}, NumTasks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	for (const FDialogueSimulationReport& Report : Reports)
+	{
+		Result.Merge(Report);
+	}
+	return Result;
+}
@@ -0,0 +1,486 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueFlowWorldSubsystem.h"
+#include "DialogueDatabase.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueObjectIndex.h"
+#include "DialogueRuntimeStats.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+void UDialogueFlowWorldSubsystem::Deinitialize()
+{
+	DirtyPlayers.Empty();
+	DeferredPlayers.Empty();
+	SnapshotSources.Empty();
+	TaskOverlays.Empty();
+	Batch.Empty();
+
+	if (UDialogueGlobalVariables* GV = ContentCacheVariables.Get())
+	{
+		GV->OnSlotChanged.Remove(ContentCacheHandle);
+	}
+	ContentCacheHandle.Reset();
+	ContentCache.Empty();
+	ContentQueries.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDialogueFlowWorldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = FPlatformTime::Seconds();
+	if (DeferredPlayers.Num() > 0 && Now >= NextSignificanceCheck)
+	{
+		NextSignificanceCheck = Now + SignificanceInterval;
+		for (const TWeakObjectPtr<UDialogueFlowPlayer>& Player : DeferredPlayers)
+		{
+			DirtyPlayers.AddUnique(Player);
+		}
+		DeferredPlayers.Reset();
+	}
+
+	if (DirtyPlayers.Num() > 0)
+	{
+		UpdatePlayers(false);
+	}
+
+	PublishSnapshots();
+}
+
+TStatId UDialogueFlowWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDialogueFlowWorldSubsystem, STATGROUP_Tickables);
+}
+
+void UDialogueFlowWorldSubsystem::AdvanceBarkRunners(TArrayView<FDialogueBarkRunner> Runners, UObject* MethodsProvider)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueAdvanceBarks);
+
+	UDialogueDatabase* Database = UDialogueDatabase::Get(this);
+	UDialogueGlobalVariables* GV = Database ? Database->GetGlobalVariables() : nullptr;
+	if (!GV)
+	{
+		return;
+	}
+
+	// Keep the index alive, scripts may load or unload packages while the runners play
+	const TSharedRef<const FDialogueObjectIndex> Index = Database->GetObjectIndex();
+	for (FDialogueBarkRunner& Runner : Runners)
+	{
+		if (Runner.Tier == EDialogueUpdateTier::Dormant)
+		{
+			continue;
+		}
+		BarkExplorer.Advance(Runner, Index->FlowGraph, GV, MethodsProvider);
+	}
+
+	FDialogueRuntimeStats::Flush();
+}
+
+bool UDialogueFlowWorldSubsystem::HasAvailableContent(FDialogueRef StartRef, FDialogueContentFilter Filter, UObject* MethodsProvider)
+{
+	bool bHasContent = false;
+	HasAvailableContentBatch(MakeArrayView(&StartRef, 1), Filter, MakeArrayView(&bHasContent, 1), MethodsProvider);
+	return bHasContent;
+}
+
+void UDialogueFlowWorldSubsystem::HasAvailableContentBatch(TConstArrayView<FDialogueRef> StartRefs, const FDialogueContentFilter& Filter, TArrayView<bool> OutResults, UObject* MethodsProvider)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueQueryContent);
+	check(StartRefs.Num() == OutResults.Num());
+
+	for (bool& bHasContent : OutResults)
+	{
+		bHasContent = false;
+	}
+
+	UDialogueDatabase* Database = UDialogueDatabase::Get(this);
+	UDialogueGlobalVariables* GV = Database ? Database->GetGlobalVariables() : nullptr;
+	if (!GV)
+	{
+		return;
+	}
+
+	// Keep the index alive while the probes walk it
+	const TSharedRef<const FDialogueObjectIndex> Index = Database->GetObjectIndex();
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	BindContentCache(Database, Index, GV);
+
+	// Answers found inside a shadow operation see its values, they are not kept
+	const bool bCanCache = GV->GetShadowLevel() == 0;
+	if (bCanCache)
+	{
+		AddSnapshotSource(GV);
+	}
+	const FDialogueVariableSnapshotPtr Snapshot = GV->GetSnapshot();
+	if (!Snapshot)
+	{
+		return;
+	}
+
+	ContentQueries.Reset();
+	for (int32 i = 0; i < StartRefs.Num(); ++i)
+	{
+		const UDialogueObject* Start = StartRefs[i].GetObject(this);
+		const FDialogueFlowGraph::FVertex Vertex = Start ? Graph.FindVertex(Start) : FDialogueFlowGraph::FVertex();
+		if (!Vertex.IsValid() || Vertex.bIsPin)
+		{
+			continue;
+		}
+
+		const uint64 Key = (uint64)Graph.GetVertexNumber(Vertex) << 32 | Filter.GetKey();
+		const FContentCacheEntry* Entry = bCanCache ? ContentCache.Find(Key) : nullptr;
+		if (Entry)
+		{
+			OutResults[i] = Entry->bHasContent;
+			continue;
+		}
+
+		FContentQuery& Query = ContentQueries.AddDefaulted_GetRef();
+		Query.Output = i;
+		Query.Start = Vertex;
+		Query.Key = Key;
+	}
+
+	if (ContentQueries.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 NumTasks = ContentQueries.Num() < MinParallelPlayers ? 1 : FMath::Min(ContentQueries.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	while (TaskOverlays.Num() < NumTasks)
+	{
+		TaskOverlays.Add(MakeUnique<FDialogueVariableOverlay>(Snapshot.ToSharedRef()));
+	}
+	if (ContentProbes.Num() < NumTasks)
+	{
+		ContentProbes.SetNum(NumTasks);
+	}
+
+	// User methods only run on the game thread, a single task runs there
+	ParallelFor(NumTasks, [this, NumTasks, &Graph, &Filter, &Snapshot, MethodsProvider](int32 Task)
+	{
+		const int32 Begin = ContentQueries.Num() * Task / NumTasks;
+		const int32 End = ContentQueries.Num() * (Task + 1) / NumTasks;
+
+		FDialogueVariableOverlay& Overlay = *TaskOverlays[Task];
+		for (int32 i = Begin; i < End; ++i)
+		{
+			FContentQuery& Query = ContentQueries[i];
+			Overlay.Reset(Snapshot.ToSharedRef());
+			ContentProbes[Task].Run(Graph, Query.Start, Filter, SeenNodes, Overlay, MethodsProvider, NumTasks == 1, Query.Result);
+		}
+	}, NumTasks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	for (FContentQuery& Query : ContentQueries)
+	{
+		if (Query.Result.bNeedsGameThread)
+		{
+			TaskOverlays[0]->Reset(Snapshot.ToSharedRef());
+			ContentProbes[0].Run(Graph, Query.Start, Filter, SeenNodes, *TaskOverlays[0], MethodsProvider, true, Query.Result);
+		}
+
+		OutResults[Query.Output] = Query.Result.bHasContent;
+		if (bCanCache)
+		{
+			FContentCacheEntry& Entry = ContentCache.Add(Query.Key);
+			Entry.bHasContent = Query.Result.bHasContent;
+			Entry.bUnseenOnly = Filter.bUnseenOnly;
+			Entry.bDependsOnAll = Query.Result.bDependsOnAll;
+			Entry.Dependencies = MoveTemp(Query.Result.Dependencies);
+		}
+	}
+	ContentQueries.Reset();
+}
+
+void UDialogueFlowWorldSubsystem::MarkSeen(const UDialogueObject* Node)
+{
+	if (!Node || SeenCounters.FindOrAdd(Node->Id)++ > 0)
+	{
+		return;
+	}
+
+	// Only the first pause turns the node from unseen to seen
+	const TSharedPtr<const FDialogueObjectIndex> Index = ContentCacheIndex.Pin();
+	const FDialogueFlowGraph::FVertex Vertex = Index ? Index->FlowGraph.FindVertex(Node) : FDialogueFlowGraph::FVertex();
+	if (!Vertex.IsValid() || Vertex.bIsPin || !SeenNodes.IsValidIndex(Vertex.Index))
+	{
+		return;
+	}
+	SeenNodes[Vertex.Index] = true;
+
+	// Answers without content stay without, those with content may have counted the node
+	for (auto It = ContentCache.CreateIterator(); It; ++It)
+	{
+		if (It.Value().bUnseenOnly && It.Value().bHasContent)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+int32 UDialogueFlowWorldSubsystem::GetSeenCounter(const UDialogueObject* Node) const
+{
+	const int32* Count = Node ? SeenCounters.Find(Node->Id) : nullptr;
+	return Count ? *Count : 0;
+}
+
+void UDialogueFlowWorldSubsystem::BindContentCache(const UDialogueDatabase* Database, const TSharedRef<const FDialogueObjectIndex>& Index, UDialogueGlobalVariables* GV)
+{
+	if (ContentCacheIndex.Pin().Get() != &Index.Get())
+	{
+		// Vertex numbers are only meaningful in the graph they were found in
+		ContentCache.Reset();
+		ContentCacheIndex = Index;
+
+		SeenNodes.Init(false, Index->FlowGraph.Nodes.Num());
+		for (const TPair<FDialogueId, int32>& Seen : SeenCounters)
+		{
+			const FDialogueFlowGraph::FVertex Vertex = Index->FlowGraph.FindVertex(Database->GetObject(Seen.Key));
+			if (Vertex.IsValid() && !Vertex.bIsPin)
+			{
+				SeenNodes[Vertex.Index] = true;
+			}
+		}
+	}
+
+	if (ContentCacheVariables.Get() == GV && ContentCacheHandle.IsValid())
+	{
+		return;
+	}
+
+	if (UDialogueGlobalVariables* OldGV = ContentCacheVariables.Get())
+	{
+		OldGV->OnSlotChanged.Remove(ContentCacheHandle);
+	}
+
+	// Answers found against another variable set are meaningless now
+	ContentCache.Reset();
+	ContentCacheVariables = GV;
+	ContentCacheHandle = GV->OnSlotChanged.AddUObject(this, &UDialogueFlowWorldSubsystem::OnContentVariableChanged);
+}
+
+void UDialogueFlowWorldSubsystem::OnContentVariableChanged(const FDialogueVariableSlot& Slot)
+{
+	const TSharedPtr<const FDialogueObjectIndex> Index = ContentCacheIndex.Pin();
+	if (!Index)
+	{
+		ContentCache.Reset();
+		return;
+	}
+
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	const TArrayView<const FDialogueFlowGraph::FVertex> Users = Graph.GetVariableUsers(Slot);
+	for (auto It = ContentCache.CreateIterator(); It; ++It)
+	{
+		const FContentCacheEntry& Entry = It.Value();
+		bool bAffected = Entry.bDependsOnAll;
+		for (int32 i = 0; i < Users.Num() && !bAffected; ++i)
+		{
+			bAffected = Algo::BinarySearch(Entry.Dependencies, Graph.GetVertexNumber(Users[i])) != INDEX_NONE;
+		}
+		if (bAffected)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UDialogueFlowWorldSubsystem::UpdateBarkRunnerTiers(TArrayView<FDialogueBarkRunner> Runners, TConstArrayView<FVector> Locations)
+{
+	check(Runners.Num() == Locations.Num());
+	for (int32 i = 0; i < Runners.Num(); ++i)
+	{
+		Runners[i].Tier = GetSignificanceTier(Locations[i]);
+	}
+}
+
+void UDialogueFlowWorldSubsystem::CacheViewpoints() const
+{
+	if (ViewpointFrame == GFrameCounter)
+	{
+		return;
+	}
+	ViewpointFrame = GFrameCounter;
+
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* Controller = It->Get();
+		if (Controller && Controller->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			Controller->GetPlayerViewPoint(Location, Rotation);
+			Viewpoints.Add(Location);
+		}
+	}
+}
+
+EDialogueUpdateTier UDialogueFlowWorldSubsystem::GetSignificanceTier(const FVector& Location, const AActor* Actor) const
+{
+	CacheViewpoints();
+	if (Viewpoints.Num() == 0)
+	{
+		return EDialogueUpdateTier::Full;
+	}
+
+	float MinDistSquared = MAX_flt;
+	for (const FVector& Viewpoint : Viewpoints)
+	{
+		MinDistSquared = FMath::Min(MinDistSquared, (float)FVector::DistSquared(Viewpoint, Location));
+	}
+
+	const bool bVisible = Actor && Actor->WasRecentlyRendered(SignificanceInterval);
+	const bool bInReducedRange = MinDistSquared <= FMath::Square(ReducedDistance);
+	if (MinDistSquared <= FMath::Square(FullDistance) || (bVisible && bInReducedRange))
+	{
+		return EDialogueUpdateTier::Full;
+	}
+	return bInReducedRange || bVisible ? EDialogueUpdateTier::Reduced : EDialogueUpdateTier::Dormant;
+}
+
+bool UDialogueFlowWorldSubsystem::IsUpdateDue(UDialogueFlowPlayer& Player, double Now) const
+{
+	const AActor* Owner = Player.GetOwner();
+	Player.UpdateTier = Owner ? GetSignificanceTier(Owner->GetActorLocation(), Owner) : EDialogueUpdateTier::Full;
+	switch (Player.UpdateTier)
+	{
+	case EDialogueUpdateTier::Full:
+		return true;
+	case EDialogueUpdateTier::Reduced:
+		return Now - Player.LastBatchedUpdateTime >= ReducedUpdateInterval;
+	default:
+		return false;
+	}
+}
+
+void UDialogueFlowWorldSubsystem::AddDirtyPlayer(UDialogueFlowPlayer* Player)
+{
+	if (Player)
+	{
+		DirtyPlayers.AddUnique(Player);
+	}
+}
+
+void UDialogueFlowWorldSubsystem::RemoveDirtyPlayer(UDialogueFlowPlayer* Player)
+{
+	DirtyPlayers.Remove(Player);
+	DeferredPlayers.Remove(Player);
+}
+
+void UDialogueFlowWorldSubsystem::AddSnapshotSource(UDialogueGlobalVariables* Variables)
+{
+	if (Variables)
+	{
+		SnapshotSources.AddUnique(Variables);
+		Variables->PublishSnapshot();
+	}
+}
+
+void UDialogueFlowWorldSubsystem::PublishSnapshots()
+{
+	SnapshotSources.RemoveAllSwap([](const TWeakObjectPtr<UDialogueGlobalVariables>& Source) { return !Source.IsValid(); });
+	for (const TWeakObjectPtr<UDialogueGlobalVariables>& Source : SnapshotSources)
+	{
+		// Never publish values of a shadow operation that is still running
+		if (Source->GetShadowLevel() == 0)
+		{
+			Source->PublishSnapshot();
+		}
+	}
+}
+
+void UDialogueFlowWorldSubsystem::FlushDirtyPlayers()
+{
+	for (const TWeakObjectPtr<UDialogueFlowPlayer>& Player : DeferredPlayers)
+	{
+		DirtyPlayers.AddUnique(Player);
+	}
+	DeferredPlayers.Reset();
+
+	UpdatePlayers(true);
+}
+
+void UDialogueFlowWorldSubsystem::UpdatePlayers(bool bIgnoreSignificance)
+{
+	// Players may queue themselves again from their events
+	TArray<TWeakObjectPtr<UDialogueFlowPlayer>> Players = MoveTemp(DirtyPlayers);
+	DirtyPlayers.Reset();
+
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<UDialogueFlowPlayer*> GameThreadPlayers;
+	Batch.Reset();
+	for (const TWeakObjectPtr<UDialogueFlowPlayer>& WeakPlayer : Players)
+	{
+		UDialogueFlowPlayer* Player = WeakPlayer.Get();
+		if (!Player)
+		{
+			continue;
+		}
+
+		if (Player->bScaleUpdatesBySignificance && !bIgnoreSignificance && !IsUpdateDue(*Player, Now))
+		{
+			// Changes queued meanwhile end in this one entry
+			DeferredPlayers.AddUnique(WeakPlayer);
+			continue;
+		}
+		Player->LastBatchedUpdateTime = Now;
+
+		FDialogueBatchedExplore& Explore = Batch.AddDefaulted_GetRef();
+		Explore.Player = Player;
+		if (!Player->PrepareBatchedExplore(Explore) || Explore.Variables->GetShadowLevel() > 0)
+		{
+			Batch.Pop(false);
+			GameThreadPlayers.Add(Player);
+			continue;
+		}
+
+		// Explore against the values committed so far this frame
+		AddSnapshotSource(Explore.Variables);
+		Explore.Snapshot = Explore.Variables->GetSnapshot();
+	}
+
+	if (Batch.Num() > 0)
+	{
+		const int32 NumTasks = Batch.Num() < MinParallelPlayers ? 1 : FMath::Min(Batch.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+		while (TaskOverlays.Num() < NumTasks)
+		{
+			TaskOverlays.Add(MakeUnique<FDialogueVariableOverlay>(Batch[0].Snapshot.ToSharedRef()));
+		}
+
+		ParallelFor(NumTasks, [this, NumTasks](int32 Task)
+		{
+			const int32 Begin = Batch.Num() * Task / NumTasks;
+			const int32 End = Batch.Num() * (Task + 1) / NumTasks;
+
+			FDialogueVariableOverlay& Overlay = *TaskOverlays[Task];
+			for (int32 i = Begin; i < End; ++i)
+			{
+				FDialogueBatchedExplore& Explore = Batch[i];
+				Overlay.Reset(Explore.Snapshot.ToSharedRef());
+				Explore.Player->RunBatchedExplore(Explore, Overlay);
+			}
+		}, NumTasks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+		for (const FDialogueBatchedExplore& Explore : Batch)
+		{
+			Explore.Player->FinishBatchedExplore(Explore);
+		}
+
+		// Don't hold on to the flow graph until the next update
+		Batch.Reset();
+	}
+
+	for (UDialogueFlowPlayer* Player : GameThreadPlayers)
+	{
+		Player->UpdateAvailableBranches();
+	}
+}
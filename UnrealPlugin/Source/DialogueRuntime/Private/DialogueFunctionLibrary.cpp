@@ -0,0 +1,207 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueFunctionLibrary.h"
+#include "DialogueCharacter.h"
+#include "DialogueDatabase.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueObject.h"
+#include "DialogueSubsystem.h"
+
+// ==================== DATABASE ACCESS ====================
+
+UDialogueDatabase* UDialogueFunctionLibrary::GetDialogueDatabase(const UObject* WorldContext)
+{
+	UDialogueSubsystem* Subsystem = UDialogueSubsystem::Get(WorldContext);
+	return Subsystem ? Subsystem->GetDatabase() : UDialogueDatabase::Get(WorldContext);
+}
+
+UDialogueObject* UDialogueFunctionLibrary::GetDialogueObject(const UObject* WorldContext, const FString& Id, TSubclassOf<UDialogueObject> Class)
+{
+	UDialogueDatabase* Database = GetDialogueDatabase(WorldContext);
+	return Database ? Database->GetObject(Id, Class) : nullptr;
+}
+
+UDialogueObject* UDialogueFunctionLibrary::GetDialogueObjectFromRef(const UObject* WorldContext, const FDialogueRef& Ref, TSubclassOf<UDialogueObject> Class)
+{
+	UDialogueObject* Object = Ref.GetObject(WorldContext);
+	if (!Object || (Class && !Object->IsA(Class)))
+	{
+		return nullptr;
+	}
+	return Object;
+}
+
+// ==================== GLOBAL VARIABLES ====================
+
+UDialogueGlobalVariables* UDialogueFunctionLibrary::GetGlobalVariables(const UObject* WorldContext)
+{
+	if (UDialogueSubsystem* Subsystem = UDialogueSubsystem::Get(WorldContext))
+	{
+		return Subsystem->GetGlobalVariables();
+	}
+
+	UDialogueDatabase* Database = UDialogueDatabase::Get(WorldContext);
+	return Database ? Database->GetGlobalVariables() : nullptr;
+}
+
+bool UDialogueFunctionLibrary::GetBoolVariable(const UObject* WorldContext, const FString& FullName)
+{
+	UDialogueGlobalVariables* Variables = GetGlobalVariables(WorldContext);
+	return Variables && Variables->GetBool(FullName);
+}
+
+void UDialogueFunctionLibrary::SetBoolVariable(const UObject* WorldContext, const FString& FullName, bool Value)
+{
+	if (UDialogueGlobalVariables* Variables = GetGlobalVariables(WorldContext))
+	{
+		Variables->SetBool(FullName, Value);
+	}
+}
+
+int32 UDialogueFunctionLibrary::GetIntVariable(const UObject* WorldContext, const FString& FullName)
+{
+	UDialogueGlobalVariables* Variables = GetGlobalVariables(WorldContext);
+	return Variables ? Variables->GetInt(FullName) : 0;
+}
+
+void UDialogueFunctionLibrary::SetIntVariable(const UObject* WorldContext, const FString& FullName, int32 Value)
+{
+	if (UDialogueGlobalVariables* Variables = GetGlobalVariables(WorldContext))
+	{
+		Variables->SetInt(FullName, Value);
+	}
+}
+
+FString UDialogueFunctionLibrary::GetStringVariable(const UObject* WorldContext, const FString& FullName)
+{
+	UDialogueGlobalVariables* Variables = GetGlobalVariables(WorldContext);
+	return Variables ? Variables->GetString(FullName) : FString();
+}
+
+void UDialogueFunctionLibrary::SetStringVariable(const UObject* WorldContext, const FString& FullName, const FString& Value)
+{
+	if (UDialogueGlobalVariables* Variables = GetGlobalVariables(WorldContext))
+	{
+		Variables->SetString(FullName, Value);
+	}
+}
+
+// ==================== ID UTILITIES ====================
+
+FDialogueId UDialogueFunctionLibrary::MakeDialogueId(int64 Low, int64 High)
+{
+	return FDialogueId(Low, High);
+}
+
+FDialogueRef UDialogueFunctionLibrary::MakeDialogueRef(FDialogueId Id, int32 CloneId)
+{
+	FDialogueRef Ref;
+	Ref.Id = Id;
+	Ref.CloneId = CloneId;
+	Ref.bReferenceBaseObject = CloneId == 0;
+	return Ref;
+}
+
+bool UDialogueFunctionLibrary::IsDialogueIdValid(const FDialogueId& Id)
+{
+	return Id.IsValid();
+}
+
+bool UDialogueFunctionLibrary::IsDialogueRefValid(const FDialogueRef& Ref)
+{
+	return Ref.IsValid();
+}
+
+FString UDialogueFunctionLibrary::DialogueIdToString(const FDialogueId& Id)
+{
+	return Id.ToString();
+}
+
+FDialogueId UDialogueFunctionLibrary::StringToDialogueId(const FString& Str)
+{
+	return FDialogueId::FromString(Str);
+}
+
+// ==================== INTERFACE QUERIES ====================
+
+FText UDialogueFunctionLibrary::GetDialogueText(UDialogueObject* Object)
+{
+	const IDialogueObjectWithText* WithText = Cast<IDialogueObjectWithText>(Object);
+	return WithText ? WithText->GetText() : FText::GetEmpty();
+}
+
+UDialogueCharacter* UDialogueFunctionLibrary::GetDialogueSpeaker(const UObject* WorldContext, UDialogueObject* Object)
+{
+	const IDialogueObjectWithSpeaker* WithSpeaker = Cast<IDialogueObjectWithSpeaker>(Object);
+	if (!WithSpeaker)
+	{
+		return nullptr;
+	}
+
+	// The object resolves through its own database, only fall back to the caller's world
+	if (UDialogueCharacter* Speaker = WithSpeaker->GetSpeaker())
+	{
+		return Speaker;
+	}
+
+	UDialogueDatabase* Database = GetDialogueDatabase(WorldContext);
+	return Database ? Database->GetCharacter(WithSpeaker->GetSpeakerId()) : nullptr;
+}
+
+bool UDialogueFunctionLibrary::IsFlowObject(UDialogueObject* Object)
+{
+	return Cast<IDialogueFlowObject>(Object) != nullptr;
+}
+
+EDialoguePausableType UDialogueFunctionLibrary::GetPausableType(UDialogueObject* Object)
+{
+	const IDialogueFlowObject* FlowObject = Cast<IDialogueFlowObject>(Object);
+	return FlowObject ? FlowObject->GetPausableType() : EDialoguePausableType::None;
+}
+
+// ==================== BRANCHES ====================
+
+void UDialogueFunctionLibrary::GetBranchPresentations(const UObject* WorldContext, const TArray<FDialogueBranch>& Branches, TArray<FDialogueBranchPresentation>& OutPresentations)
+{
+	OutPresentations.Reset(Branches.Num());
+
+	// Only looked up for a speaker its object can't resolve, and then once for all branches
+	UDialogueDatabase* Database = nullptr;
+	bool bDatabaseResolved = false;
+
+	for (const FDialogueBranch& Branch : Branches)
+	{
+		FDialogueBranchPresentation& Presentation = OutPresentations.AddDefaulted_GetRef();
+		Presentation.Index = Branch.Index;
+		Presentation.bIsValid = Branch.bIsValid;
+
+		UDialogueObject* Target = Branch.GetTarget();
+		if (!Target)
+		{
+			continue;
+		}
+
+		Presentation.Target = Target;
+		Presentation.TargetId = Target->Id;
+
+		if (const IDialogueObjectWithText* WithText = Cast<IDialogueObjectWithText>(Target))
+		{
+			Presentation.MenuText = WithText->GetMenuText();
+			Presentation.Text = WithText->GetText();
+		}
+
+		if (const IDialogueObjectWithSpeaker* WithSpeaker = Cast<IDialogueObjectWithSpeaker>(Target))
+		{
+			Presentation.Speaker = WithSpeaker->GetSpeaker();
+			if (!Presentation.Speaker)
+			{
+				if (!bDatabaseResolved)
+				{
+					Database = GetDialogueDatabase(WorldContext);
+					bDatabaseResolved = true;
+				}
+				Presentation.Speaker = Database ? Database->GetCharacter(WithSpeaker->GetSpeakerId()) : nullptr;
+			}
+		}
+	}
+}
@@ -0,0 +1,883 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueGlobalVariables.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeStats.h"
+
+// ==================== VARIABLES ====================
+
+UDialogueGlobalVariables* UDialogueVariable::GetGlobalVariables() const
+{
+	return OwningGlobalVariables;
+}
+
+void UDialogueVariable::BroadcastChanged() const
+{
+	OnVariableChangedNative.Broadcast(VariableName);
+	if (OnVariableChanged.IsBound())
+	{
+		OnVariableChanged.Broadcast(VariableName);
+	}
+}
+
+void UDialogueBoolVariable::SetValue(bool NewValue)
+{
+	if (OwningGlobalVariables)
+	{
+		OwningGlobalVariables->SetBool(Slot, NewValue);
+	}
+}
+
+bool UDialogueBoolVariable::GetValue() const
+{
+	return OwningGlobalVariables && OwningGlobalVariables->GetBool(Slot);
+}
+
+void UDialogueIntVariable::SetValue(int32 NewValue)
+{
+	if (OwningGlobalVariables)
+	{
+		OwningGlobalVariables->SetInt(Slot, NewValue);
+	}
+}
+
+int32 UDialogueIntVariable::GetValue() const
+{
+	return OwningGlobalVariables ? OwningGlobalVariables->GetInt(Slot) : 0;
+}
+
+void UDialogueStringVariable::SetValue(const FString& NewValue)
+{
+	if (OwningGlobalVariables)
+	{
+		OwningGlobalVariables->SetString(Slot, NewValue);
+	}
+}
+
+FString UDialogueStringVariable::GetValue() const
+{
+	return OwningGlobalVariables ? OwningGlobalVariables->GetString(Slot) : FString();
+}
+
+// ==================== OVERLAY ====================
+
+void FDialogueVariableOverlay::Reset(FDialogueVariableSnapshotRef InSnapshot)
+{
+	Snapshot = MoveTemp(InSnapshot);
+	Writes.Reset();
+	Strings.Reset();
+	Markers.Reset();
+}
+
+const FDialogueVariableOverlay::FWrite* FDialogueVariableOverlay::FindWrite(const FDialogueVariableSlot& Slot) const
+{
+	// Few variables are written while exploring, newest first
+	for (int32 i = Writes.Num() - 1; i >= 0; --i)
+	{
+		if (Writes[i].Slot == Slot)
+		{
+			return &Writes[i];
+		}
+	}
+	return nullptr;
+}
+
+bool FDialogueVariableOverlay::GetBool(const FDialogueVariableSlot& Slot) const
+{
+	check(Slot.Type == EDialogueVariableType::Boolean);
+	const FWrite* Write = FindWrite(Slot);
+	return Write ? Write->Value != 0 : Snapshot->Store.GetBool(Slot.Index);
+}
+
+int32 FDialogueVariableOverlay::GetInt(const FDialogueVariableSlot& Slot) const
+{
+	check(Slot.Type == EDialogueVariableType::Integer);
+	const FWrite* Write = FindWrite(Slot);
+	return Write ? Write->Value : Snapshot->Store.Ints[Slot.Index];
+}
+
+const FString& FDialogueVariableOverlay::GetString(const FDialogueVariableSlot& Slot) const
+{
+	check(Slot.Type == EDialogueVariableType::String);
+	const FWrite* Write = FindWrite(Slot);
+	return Write ? Strings[Write->Value] : Snapshot->Store.Strings[Slot.Index];
+}
+
+void FDialogueVariableOverlay::SetBool(const FDialogueVariableSlot& Slot, bool Value)
+{
+	if (GetBool(Slot) != Value)
+	{
+		LLM_SCOPE_BYTAG(Dialogue_Shadows);
+		Writes.Add({ Slot, Value ? 1 : 0 });
+	}
+}
+
+void FDialogueVariableOverlay::SetInt(const FDialogueVariableSlot& Slot, int32 Value)
+{
+	if (GetInt(Slot) != Value)
+	{
+		LLM_SCOPE_BYTAG(Dialogue_Shadows);
+		Writes.Add({ Slot, Value });
+	}
+}
+
+void FDialogueVariableOverlay::SetString(const FDialogueVariableSlot& Slot, const FString& Value)
+{
+	if (!GetString(Slot).Equals(Value, ESearchCase::CaseSensitive))
+	{
+		LLM_SCOPE_BYTAG(Dialogue_Shadows);
+		Writes.Add({ Slot, Strings.Add(new FString(Value)) });
+	}
+}
+
+void FDialogueVariableOverlay::PushState()
+{
+	LLM_SCOPE_BYTAG(Dialogue_Shadows);
+	Markers.Emplace(Writes.Num(), Strings.Num());
+}
+
+void FDialogueVariableOverlay::PopState()
+{
+	if (!ensure(Markers.Num() > 0))
+	{
+		return;
+	}
+
+	const TPair<int32, int32> Marker = Markers.Pop(false);
+	Writes.SetNum(Marker.Key, false);
+	Strings.RemoveAt(Marker.Value, Strings.Num() - Marker.Value);
+}
+
+void FDialogueVariableOverlay::Compact()
+{
+	if (!ensure(Markers.Num() == 0))
+	{
+		return;
+	}
+
+	// Written strings stay until the next Reset, the kept writes index into them
+	int32 NumKept = 0;
+	for (int32 i = 0; i < Writes.Num(); ++i)
+	{
+		bool bOverwritten = false;
+		for (int32 j = i + 1; j < Writes.Num() && !bOverwritten; ++j)
+		{
+			bOverwritten = Writes[j].Slot == Writes[i].Slot;
+		}
+		if (!bOverwritten)
+		{
+			Writes[NumKept++] = Writes[i];
+		}
+	}
+	Writes.SetNum(NumKept, false);
+}
+
+void FDialogueVariableOverlay::ForEachLatestWrite(TFunctionRef<void(const FDialogueVariableSlot& Slot, int32 Value, const FString* String)> Visitor) const
+{
+	for (int32 i = Writes.Num() - 1; i >= 0; --i)
+	{
+		// Few writes, a slot written again is found among the newer ones
+		const FWrite& Write = Writes[i];
+		bool bOverwritten = false;
+		for (int32 j = i + 1; j < Writes.Num() && !bOverwritten; ++j)
+		{
+			bOverwritten = Writes[j].Slot == Write.Slot;
+		}
+
+		if (!bOverwritten)
+		{
+			Visitor(Write.Slot, Write.Value, Write.Slot.Type == EDialogueVariableType::String ? &Strings[Write.Value] : nullptr);
+		}
+	}
+}
+
+// ==================== NAMESPACE ====================
+
+UDialogueBoolVariable* UDialogueVariableNamespace::GetBool(const FString& VarName) const
+{
+	UDialogueVariable* const* Variable = Variables.Find(VarName);
+	return Variable ? Cast<UDialogueBoolVariable>(*Variable) : nullptr;
+}
+
+UDialogueIntVariable* UDialogueVariableNamespace::GetInt(const FString& VarName) const
+{
+	UDialogueVariable* const* Variable = Variables.Find(VarName);
+	return Variable ? Cast<UDialogueIntVariable>(*Variable) : nullptr;
+}
+
+UDialogueStringVariable* UDialogueVariableNamespace::GetString(const FString& VarName) const
+{
+	UDialogueVariable* const* Variable = Variables.Find(VarName);
+	return Variable ? Cast<UDialogueStringVariable>(*Variable) : nullptr;
+}
+
+// ==================== GLOBAL VARIABLES ====================
+
+UDialogueVariableNamespace* UDialogueGlobalVariables::GetNamespace(const FString& Name) const
+{
+	UDialogueVariableNamespace* const* Namespace = Namespaces.Find(Name);
+	return Namespace ? *Namespace : nullptr;
+}
+
+UDialogueVariable* UDialogueGlobalVariables::GetVariable(const FString& FullName) const
+{
+	return GetVariable(FindSlot(FullName));
+}
+
+UDialogueVariable* UDialogueGlobalVariables::GetVariable(const FDialogueVariableSlot& Slot) const
+{
+	if (!IsValidSlot(Slot))
+	{
+		return nullptr;
+	}
+
+	switch (Slot.Type)
+	{
+	case EDialogueVariableType::Boolean: return BoolVariables[Slot.Index];
+	case EDialogueVariableType::Integer: return IntVariables[Slot.Index];
+	case EDialogueVariableType::String: return StringVariables[Slot.Index];
+	default: return nullptr;
+	}
+}
+
+FDialogueVariableSlot UDialogueGlobalVariables::FindSlot(const FString& FullName) const
+{
+	const FDialogueVariableSlot* Slot = SlotsByName.Find(FullName);
+	return Slot ? *Slot : FDialogueVariableSlot();
+}
+
+bool UDialogueGlobalVariables::GetBool(const FString& FullName) const
+{
+	return GetBoolBySlot(FindSlot(FullName));
+}
+
+void UDialogueGlobalVariables::SetBool(const FString& FullName, bool Value)
+{
+	const FDialogueVariableSlot Slot = FindSlot(FullName);
+	if (IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::Boolean)
+	{
+		SetBool(Slot, Value);
+	}
+	else
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Boolean variable '%s' not found"), *FullName);
+	}
+}
+
+int32 UDialogueGlobalVariables::GetInt(const FString& FullName) const
+{
+	return GetIntBySlot(FindSlot(FullName));
+}
+
+void UDialogueGlobalVariables::SetInt(const FString& FullName, int32 Value)
+{
+	const FDialogueVariableSlot Slot = FindSlot(FullName);
+	if (IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::Integer)
+	{
+		SetInt(Slot, Value);
+	}
+	else
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Integer variable '%s' not found"), *FullName);
+	}
+}
+
+FString UDialogueGlobalVariables::GetString(const FString& FullName) const
+{
+	return GetStringBySlot(FindSlot(FullName));
+}
+
+void UDialogueGlobalVariables::SetString(const FString& FullName, const FString& Value)
+{
+	const FDialogueVariableSlot Slot = FindSlot(FullName);
+	if (IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::String)
+	{
+		SetString(Slot, Value);
+	}
+	else
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("String variable '%s' not found"), *FullName);
+	}
+}
+
+// ==================== SLOTS ====================
+
+void UDialogueGlobalVariables::SetBool(const FDialogueVariableSlot& Slot, bool Value)
+{
+	check(Slot.Type == EDialogueVariableType::Boolean);
+	if (Store.GetBool(Slot.Index) != Value)
+	{
+		RecordWrite(Slot);
+		Store.SetBool(Slot.Index, Value);
+		AddToStateChecksum(Slot);
+		NotifyChanged(Slot);
+	}
+}
+
+void UDialogueGlobalVariables::SetInt(const FDialogueVariableSlot& Slot, int32 Value)
+{
+	check(Slot.Type == EDialogueVariableType::Integer);
+	int32& Current = Store.Ints[Slot.Index];
+	if (Current != Value)
+	{
+		RecordWrite(Slot);
+		Current = Value;
+		AddToStateChecksum(Slot);
+		NotifyChanged(Slot);
+	}
+}
+
+void UDialogueGlobalVariables::SetString(const FDialogueVariableSlot& Slot, const FString& Value)
+{
+	check(Slot.Type == EDialogueVariableType::String);
+	FString& Current = Store.Strings[Slot.Index];
+	if (!Current.Equals(Value, ESearchCase::CaseSensitive))
+	{
+		RecordWrite(Slot);
+		Current = Value;
+		AddToStateChecksum(Slot);
+		NotifyChanged(Slot);
+	}
+}
+
+int32 UDialogueGlobalVariables::GetNumVariables(EDialogueVariableType Type) const
+{
+	switch (Type)
+	{
+	case EDialogueVariableType::Boolean: return Store.NumBools;
+	case EDialogueVariableType::Integer: return Store.Ints.Num();
+	case EDialogueVariableType::String: return Store.Strings.Num();
+	default: return 0;
+	}
+}
+
+FDialogueVariableSlot UDialogueGlobalVariables::AddVariable(const FString& NamespaceName, const FString& VariableName, EDialogueVariableType Type, const FString& DefaultValue)
+{
+	const FString FullName = NamespaceName + TEXT(".") + VariableName;
+	if (const FDialogueVariableSlot* Existing = SlotsByName.Find(FullName))
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Variable '%s' is defined more than once"), *FullName);
+		return *Existing;
+	}
+
+	UDialogueVariableNamespace* Namespace = GetNamespace(NamespaceName);
+	if (!Namespace)
+	{
+		Namespace = NewObject<UDialogueVariableNamespace>(this, *NamespaceName);
+		Namespace->Name = NamespaceName;
+		RegisterNamespace(Namespace);
+	}
+
+	FDialogueVariableSlot Slot;
+	Slot.Type = Type;
+
+	UDialogueVariable* Variable = nullptr;
+	switch (Type)
+	{
+	case EDialogueVariableType::Boolean:
+		Slot.Index = Store.AddBool(DefaultValue.ToBool());
+		Variable = NewObject<UDialogueBoolVariable>(this);
+		BoolVariables.Add(Variable);
+		break;
+
+	case EDialogueVariableType::Integer:
+		Slot.Index = Store.Ints.Add(FCString::Atoi(*DefaultValue));
+		Variable = NewObject<UDialogueIntVariable>(this);
+		IntVariables.Add(Variable);
+		break;
+
+	case EDialogueVariableType::String:
+		Slot.Index = Store.Strings.Add(DefaultValue);
+		Variable = NewObject<UDialogueStringVariable>(this);
+		StringVariables.Add(Variable);
+		break;
+
+	default:
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Variable '%s' has an unsupported type"), *FullName);
+		return FDialogueVariableSlot();
+	}
+
+	Variable->VariableName = FullName;
+	Variable->Slot = Slot;
+	Variable->OwningGlobalVariables = this;
+
+	Namespace->Variables.Add(VariableName, Variable);
+	SlotsByName.Add(FullName, Slot);
+	AddToStateChecksum(Slot);
+
+	SnapshotSlotsByName.Reset();
+	bSnapshotDirty = true;
+
+	return Slot;
+}
+
+int32 UDialogueGlobalVariables::MergeVariables(const UDialogueGlobalVariables& Other)
+{
+	if (!ensure(ShadowLevel == 0))
+	{
+		return 0;
+	}
+
+	int32 NumAdded = 0;
+	for (const TPair<FString, FDialogueVariableSlot>& Pair : Other.SlotsByName)
+	{
+		FString NamespaceName;
+		FString VariableName;
+		if (SlotsByName.Contains(Pair.Key) || !Pair.Key.Split(TEXT("."), &NamespaceName, &VariableName))
+		{
+			continue;
+		}
+
+		const FDialogueVariableSlot& Slot = Pair.Value;
+		FString Value;
+		switch (Slot.Type)
+		{
+		case EDialogueVariableType::Boolean: Value = Other.Store.GetBool(Slot.Index) ? TEXT("true") : TEXT("false"); break;
+		case EDialogueVariableType::Integer: Value = FString::FromInt(Other.Store.Ints[Slot.Index]); break;
+		case EDialogueVariableType::String: Value = Other.Store.Strings[Slot.Index]; break;
+		default: continue;
+		}
+
+		if (AddVariable(NamespaceName, VariableName, Slot.Type, Value).IsValid())
+		{
+			++NumAdded;
+		}
+	}
+	return NumAdded;
+}
+
+// ==================== SNAPSHOTS ====================
+
+void UDialogueGlobalVariables::PublishSnapshot()
+{
+	check(IsInGameThread());
+	if (!ensure(ShadowLevel == 0) || !bSnapshotDirty)
+	{
+		return;
+	}
+
+	if (!SnapshotSlotsByName)
+	{
+		SnapshotSlotsByName = MakeShared<TMap<FString, FDialogueVariableSlot>, ESPMode::ThreadSafe>(SlotsByName);
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue_GlobalVariables);
+	const uint64 Version = Snapshot ? Snapshot->Version + 1 : 1;
+	FDialogueVariableSnapshotPtr NewSnapshot = MakeShared<FDialogueVariableSnapshot, ESPMode::ThreadSafe>(Store, SnapshotSlotsByName.ToSharedRef(), Version);
+
+	// Readers only hold the lock to copy the pointer; the old snapshot lives on with them
+	{
+		FWriteScopeLock Lock(SnapshotLock);
+		Swap(Snapshot, NewSnapshot);
+	}
+	bSnapshotDirty = false;
+}
+
+FDialogueVariableSnapshotPtr UDialogueGlobalVariables::GetSnapshot() const
+{
+	FReadScopeLock Lock(SnapshotLock);
+	return Snapshot;
+}
+
+// ==================== SAVE STATE ====================
+
+namespace
+{
+	/** Full names of the slots of each type, by slot index */
+	struct FDialogueSlotNames
+	{
+		TArray<FString> Bools;
+		TArray<FString> Ints;
+		TArray<FString> Strings;
+
+		bool operator==(const FDialogueSlotNames& Other) const
+		{
+			return Bools == Other.Bools && Ints == Other.Ints && Strings == Other.Strings;
+		}
+
+		friend FArchive& operator<<(FArchive& Ar, FDialogueSlotNames& Names)
+		{
+			return Ar << Names.Bools << Names.Ints << Names.Strings;
+		}
+	};
+
+	FDialogueSlotNames GatherSlotNames(const TMap<FString, FDialogueVariableSlot>& SlotsByName, const FDialogueVariableStore& Store)
+	{
+		FDialogueSlotNames Names;
+		Names.Bools.SetNum(Store.NumBools);
+		Names.Ints.SetNum(Store.Ints.Num());
+		Names.Strings.SetNum(Store.Strings.Num());
+		for (const TPair<FString, FDialogueVariableSlot>& Pair : SlotsByName)
+		{
+			TArray<FString>* Array = nullptr;
+			switch (Pair.Value.Type)
+			{
+			case EDialogueVariableType::Boolean: Array = &Names.Bools; break;
+			case EDialogueVariableType::Integer: Array = &Names.Ints; break;
+			case EDialogueVariableType::String: Array = &Names.Strings; break;
+			default: break;
+			}
+			if (Array && Array->IsValidIndex(Pair.Value.Index))
+			{
+				(*Array)[Pair.Value.Index] = Pair.Key;
+			}
+		}
+		return Names;
+	}
+}
+
+void UDialogueGlobalVariables::SaveState(FArchive& Ar) const
+{
+	FDialogueSlotNames Names = GatherSlotNames(SlotsByName, Store);
+	FDialogueVariableStore& Values = const_cast<FDialogueVariableStore&>(Store);
+	Ar << Names << Values.BoolBits << Values.Ints << Values.Strings;
+}
+
+bool UDialogueGlobalVariables::LoadState(FArchive& Ar, const TMap<FString, FString>& RenamedVariables)
+{
+	FDialogueSlotNames Names;
+	FDialogueVariableStore Values;
+	Ar << Names << Values.BoolBits << Values.Ints << Values.Strings;
+	Values.NumBools = Names.Bools.Num();
+
+	// Read everything before changing anything, a broken save must not leave half of the values changed
+	if (Ar.IsError() || Values.BoolBits.Num() < (Values.NumBools + 63) / 64
+		|| Values.Ints.Num() != Names.Ints.Num() || Values.Strings.Num() != Names.Strings.Num())
+	{
+		return false;
+	}
+
+	// Same variables as when saving, the slots are the indices
+	if (Names == GatherSlotNames(SlotsByName, Store))
+	{
+		for (int32 Index = 0; Index < Values.NumBools; ++Index)
+		{
+			SetBool(FDialogueVariableSlot(EDialogueVariableType::Boolean, Index), Values.GetBool(Index));
+		}
+		for (int32 Index = 0; Index < Values.Ints.Num(); ++Index)
+		{
+			SetInt(FDialogueVariableSlot(EDialogueVariableType::Integer, Index), Values.Ints[Index]);
+		}
+		for (int32 Index = 0; Index < Values.Strings.Num(); ++Index)
+		{
+			SetString(FDialogueVariableSlot(EDialogueVariableType::String, Index), Values.Strings[Index]);
+		}
+		return true;
+	}
+
+	// The variables changed since saving, look up each of them by its (renamed) name
+	auto FindSlot = [this, &RenamedVariables](const FString& SavedName, EDialogueVariableType Type) -> FDialogueVariableSlot
+	{
+		if (SavedName.IsEmpty())
+		{
+			return FDialogueVariableSlot();
+		}
+
+		const FString* NewName = RenamedVariables.Find(SavedName);
+		const FDialogueVariableSlot* Slot = SlotsByName.Find(NewName ? *NewName : SavedName);
+		if (!Slot)
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Save state: variable %s does not exist anymore, its value is skipped"), *SavedName);
+			return FDialogueVariableSlot();
+		}
+		if (Slot->Type != Type)
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Save state: the type of variable %s changed, its value is skipped"), *SavedName);
+			return FDialogueVariableSlot();
+		}
+		return *Slot;
+	};
+
+	for (int32 Index = 0; Index < Values.NumBools; ++Index)
+	{
+		const FDialogueVariableSlot Slot = FindSlot(Names.Bools[Index], EDialogueVariableType::Boolean);
+		if (Slot.IsValid())
+		{
+			SetBool(Slot, Values.GetBool(Index));
+		}
+	}
+	for (int32 Index = 0; Index < Values.Ints.Num(); ++Index)
+	{
+		const FDialogueVariableSlot Slot = FindSlot(Names.Ints[Index], EDialogueVariableType::Integer);
+		if (Slot.IsValid())
+		{
+			SetInt(Slot, Values.Ints[Index]);
+		}
+	}
+	for (int32 Index = 0; Index < Values.Strings.Num(); ++Index)
+	{
+		const FDialogueVariableSlot Slot = FindSlot(Names.Strings[Index], EDialogueVariableType::String);
+		if (Slot.IsValid())
+		{
+			SetString(Slot, Values.Strings[Index]);
+		}
+	}
+	return true;
+}
+
+// ==================== CHECKSUM ====================
+
+namespace
+{
+	/** Spreads the bits of a slot's key and value over the whole hash, so sums of hashes rarely collide */
+	uint64 MixChecksumHash(uint64 Value)
+	{
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+}
+
+uint64 UDialogueGlobalVariables::HashSlotValue(const FDialogueVariableSlot& Slot) const
+{
+	uint32 ValueHash = 0;
+	switch (Slot.Type)
+	{
+	case EDialogueVariableType::Boolean: ValueHash = Store.GetBool(Slot.Index) ? 1 : 0; break;
+	case EDialogueVariableType::Integer: ValueHash = (uint32)Store.Ints[Slot.Index]; break;
+	// Hashes characters the same on every platform, peers may not share one
+	case EDialogueVariableType::String: ValueHash = FCrc::StrCrc32(*Store.Strings[Slot.Index]); break;
+	default: break;
+	}
+	return MixChecksumHash(((uint64)(uint8)Slot.Type << 56) | ((uint64)(uint32)Slot.Index << 32) | ValueHash);
+}
+
+void UDialogueGlobalVariables::ComputeStateChecksum() const
+{
+	if (bStateChecksumValid || !ensure(ShadowLevel == 0))
+	{
+		return;
+	}
+
+	StateChecksum = 0;
+	for (int32 Index = 0; Index < Store.NumBools; ++Index)
+	{
+		StateChecksum += HashSlotValue(FDialogueVariableSlot(EDialogueVariableType::Boolean, Index));
+	}
+	for (int32 Index = 0; Index < Store.Ints.Num(); ++Index)
+	{
+		StateChecksum += HashSlotValue(FDialogueVariableSlot(EDialogueVariableType::Integer, Index));
+	}
+	for (int32 Index = 0; Index < Store.Strings.Num(); ++Index)
+	{
+		StateChecksum += HashSlotValue(FDialogueVariableSlot(EDialogueVariableType::String, Index));
+	}
+	bStateChecksumValid = true;
+}
+
+uint64 UDialogueGlobalVariables::GetStateChecksum() const
+{
+	ComputeStateChecksum();
+	return StateChecksum;
+}
+
+TArray<uint32> UDialogueGlobalVariables::GetSlotHashes() const
+{
+	ensure(ShadowLevel == 0);
+
+	TArray<uint32> Hashes;
+	Hashes.Reserve(Store.NumBools + Store.Ints.Num() + Store.Strings.Num());
+	for (int32 Index = 0; Index < Store.NumBools; ++Index)
+	{
+		Hashes.Add((uint32)HashSlotValue(FDialogueVariableSlot(EDialogueVariableType::Boolean, Index)));
+	}
+	for (int32 Index = 0; Index < Store.Ints.Num(); ++Index)
+	{
+		Hashes.Add((uint32)HashSlotValue(FDialogueVariableSlot(EDialogueVariableType::Integer, Index)));
+	}
+	for (int32 Index = 0; Index < Store.Strings.Num(); ++Index)
+	{
+		Hashes.Add((uint32)HashSlotValue(FDialogueVariableSlot(EDialogueVariableType::String, Index)));
+	}
+	return Hashes;
+}
+
+FDialogueVariableSlot UDialogueGlobalVariables::FindDivergingSlot(TConstArrayView<uint32> PeerHashes) const
+{
+	const TArray<uint32> Hashes = GetSlotHashes();
+	int32 Position = 0;
+	while (Position < Hashes.Num() && Position < PeerHashes.Num() && Hashes[Position] == PeerHashes[Position])
+	{
+		++Position;
+	}
+
+	if (Position == Hashes.Num())
+	{
+		if (Position < PeerHashes.Num())
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("The peer has %d variables more than the %d of this set"), PeerHashes.Num() - Position, Position);
+		}
+		return FDialogueVariableSlot();
+	}
+
+	FDialogueVariableSlot Slot;
+	if (Position < Store.NumBools)
+	{
+		Slot = FDialogueVariableSlot(EDialogueVariableType::Boolean, Position);
+	}
+	else if (Position < Store.NumBools + Store.Ints.Num())
+	{
+		Slot = FDialogueVariableSlot(EDialogueVariableType::Integer, Position - Store.NumBools);
+	}
+	else
+	{
+		Slot = FDialogueVariableSlot(EDialogueVariableType::String, Position - Store.NumBools - Store.Ints.Num());
+	}
+
+	const UDialogueVariable* Variable = GetVariable(Slot);
+	UE_LOG(LogDialogueRuntime, Warning, TEXT("Variables diverge first at '%s'%s"), Variable ? *Variable->VariableName : TEXT("unknown variable"),
+		Position < PeerHashes.Num() ? TEXT("") : TEXT(", the peer has fewer variables"));
+	return Slot;
+}
+
+// ==================== SHADOW STATE ====================
+
+void UDialogueGlobalVariables::PushState(int32 Level)
+{
+	LLM_SCOPE_BYTAG(Dialogue_Shadows);
+
+	// The store holds speculative values from now on, the checksum has to be of the committed ones
+	if (ShadowLevel == 0)
+	{
+		ComputeStateChecksum();
+	}
+
+	JournalMarkers.Push(Journal.Num());
+	ShadowLevel = Level;
+}
+
+void UDialogueGlobalVariables::PopState(int32 Level)
+{
+	if (!ensure(Level == ShadowLevel && JournalMarkers.Num() > 0))
+	{
+		return;
+	}
+
+	// Rewind writes made at this level, newest first
+	const int32 Marker = JournalMarkers.Pop(false);
+	for (int32 i = Journal.Num() - 1; i >= Marker; --i)
+	{
+		FDialogueVariableJournalEntry& Entry = Journal[i];
+		switch (Entry.Slot.Type)
+		{
+		case EDialogueVariableType::Boolean: Store.SetBool(Entry.Slot.Index, Entry.OldValue != 0); break;
+		case EDialogueVariableType::Integer: Store.Ints[Entry.Slot.Index] = Entry.OldValue; break;
+		case EDialogueVariableType::String: Store.Strings[Entry.Slot.Index] = MoveTemp(Entry.OldString); break;
+		default: break;
+		}
+	}
+	Journal.SetNum(Marker, false);
+
+	ShadowLevel = Level - 1;
+}
+
+// ==================== NOTIFICATIONS ====================
+
+void UDialogueGlobalVariables::FlushVariableNotifications()
+{
+	if (DirtySlots.Num() == 0)
+	{
+		return;
+	}
+
+	// Listeners may write variables again, those changes go to the next flush
+	const TArray<FDialogueVariableSlot> ChangedSlots = DirtySlots.Array();
+	DirtySlots.Reset();
+
+	if (bDeferVariableNotifications)
+	{
+		for (const FDialogueVariableSlot& Slot : ChangedSlots)
+		{
+			if (UDialogueVariable* Variable = GetVariable(Slot))
+			{
+				Variable->BroadcastChanged();
+			}
+		}
+	}
+
+	OnVariablesChanged.Broadcast(ChangedSlots);
+}
+
+void UDialogueGlobalVariables::BeginDestroy()
+{
+	if (NotificationTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(NotificationTickerHandle);
+		NotificationTickerHandle.Reset();
+	}
+
+	Super::BeginDestroy();
+}
+
+// ==================== INTERNAL ====================
+
+void UDialogueGlobalVariables::RegisterNamespace(UDialogueVariableNamespace* Namespace)
+{
+	if (Namespace)
+	{
+		Namespaces.Add(Namespace->Name, Namespace);
+	}
+}
+
+void UDialogueGlobalVariables::RecordWrite(const FDialogueVariableSlot& Slot)
+{
+	if (ShadowLevel == 0)
+	{
+		RemoveFromStateChecksum(Slot);
+		bSnapshotDirty = true;
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue_Shadows);
+	FDialogueVariableJournalEntry& Entry = Journal.AddDefaulted_GetRef();
+	Entry.Slot = Slot;
+	switch (Slot.Type)
+	{
+	case EDialogueVariableType::Boolean: Entry.OldValue = Store.GetBool(Slot.Index) ? 1 : 0; break;
+	case EDialogueVariableType::Integer: Entry.OldValue = Store.Ints[Slot.Index]; break;
+	// Callers overwrite the value next, so the old string moves into the journal without copying
+	case EDialogueVariableType::String: Entry.OldString = MoveTemp(Store.Strings[Slot.Index]); break;
+	default: break;
+	}
+}
+
+void UDialogueGlobalVariables::NotifyChanged(const FDialogueVariableSlot& Slot)
+{
+	// Speculative changes are rolled back, so listeners only hear about committed ones
+	if (ShadowLevel > 0)
+	{
+		return;
+	}
+
+	if (!bDeferVariableNotifications)
+	{
+		if (UDialogueVariable* Variable = GetVariable(Slot))
+		{
+			Variable->BroadcastChanged();
+		}
+	}
+
+	// The exploration cache has to hear about every write right away
+	OnSlotChanged.Broadcast(Slot);
+
+	if (!bDeferVariableNotifications && !OnVariablesChanged.IsBound())
+	{
+		return;
+	}
+
+	DirtySlots.Add(Slot);
+	if (!NotificationTickerHandle.IsValid())
+	{
+		NotificationTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float)
+		{
+			NotificationTickerHandle.Reset();
+			FlushVariableNotifications();
+			return false;
+		}));
+	}
+}
+
+bool UDialogueGlobalVariables::ParseVariableName(const FString& FullName, FString& OutNamespace, FString& OutVariable)
+{
+	return FullName.Split(TEXT("."), &OutNamespace, &OutVariable) && !OutNamespace.IsEmpty() && !OutVariable.IsEmpty();
+}
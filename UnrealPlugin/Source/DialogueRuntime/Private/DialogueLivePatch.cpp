@@ -0,0 +1,501 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueLivePatch.h"
+#include "DialogueDatabase.h"
+#include "DialogueNode.h"
+#include "DialoguePackage.h"
+#include "DialoguePin.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueScriptCompiler.h"
+#include "Common/TcpListener.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Serialization/JsonSerializer.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	/** A connection sending more than this without a newline is dropped */
+	constexpr int32 MaxMessageBytes = 1024 * 1024;
+
+	const TCHAR* GetOperationName(FDialogueLivePatch::EOperation Operation)
+	{
+		switch (Operation)
+		{
+		case FDialogueLivePatch::EOperation::SetText: return TEXT("setText");
+		case FDialogueLivePatch::EOperation::SetScript: return TEXT("setScript");
+		case FDialogueLivePatch::EOperation::Connect: return TEXT("connect");
+		case FDialogueLivePatch::EOperation::Disconnect: return TEXT("disconnect");
+		}
+		return TEXT("unknown");
+	}
+
+	bool ParsePatch(const FJsonObject& Json, FDialogueLivePatch& OutPatch, FString& OutError)
+	{
+		FString Operation;
+		Json.TryGetStringField(TEXT("op"), Operation);
+		if (Operation == TEXT("setText"))
+		{
+			OutPatch.Operation = FDialogueLivePatch::EOperation::SetText;
+		}
+		else if (Operation == TEXT("setScript"))
+		{
+			OutPatch.Operation = FDialogueLivePatch::EOperation::SetScript;
+		}
+		else if (Operation == TEXT("connect"))
+		{
+			OutPatch.Operation = FDialogueLivePatch::EOperation::Connect;
+		}
+		else if (Operation == TEXT("disconnect"))
+		{
+			OutPatch.Operation = FDialogueLivePatch::EOperation::Disconnect;
+		}
+		else
+		{
+			OutError = FString::Printf(TEXT("unknown op '%s'"), *Operation);
+			return false;
+		}
+
+		if (!Json.TryGetStringField(TEXT("id"), OutPatch.Id) || OutPatch.Id.IsEmpty())
+		{
+			OutError = FString::Printf(TEXT("%s without an id"), *Operation);
+			return false;
+		}
+
+		Json.TryGetStringField(TEXT("field"), OutPatch.Field);
+		Json.TryGetStringField(TEXT("value"), OutPatch.Value);
+		Json.TryGetNumberField(TEXT("inputPin"), OutPatch.InputPin);
+		Json.TryGetNumberField(TEXT("outputPin"), OutPatch.OutputPin);
+		Json.TryGetStringField(TEXT("target"), OutPatch.TargetId);
+		Json.TryGetNumberField(TEXT("targetPin"), OutPatch.TargetPin);
+
+		const bool bIsConnection = OutPatch.Operation == FDialogueLivePatch::EOperation::Connect || OutPatch.Operation == FDialogueLivePatch::EOperation::Disconnect;
+		if (bIsConnection && (OutPatch.OutputPin < 0 || OutPatch.TargetId.IsEmpty()))
+		{
+			OutError = FString::Printf(TEXT("%s needs an outputPin and a target"), *Operation);
+			return false;
+		}
+		return true;
+	}
+
+	/** A text with the value written by the editor, keeping the localization key of the text it replaces */
+	FText MakePatchedText(const FText& Old, const FString& Value)
+	{
+		const FText Text = FText::FromString(Value);
+		const TOptional<FString> Namespace = FTextInspector::GetNamespace(Old);
+		const TOptional<FString> Key = FTextInspector::GetKey(Old);
+		return Namespace.IsSet() && Key.IsSet() ? FText::ChangeKey(Namespace.GetValue(), Key.GetValue(), Text) : Text;
+	}
+
+	bool SetText(UDialogueObject* Object, const FDialogueLivePatch& Patch, FString& OutError)
+	{
+		const FString& Field = Patch.Field;
+		if (UDialogueDialogue* Dialogue = Cast<UDialogueDialogue>(Object))
+		{
+			FText* Text = Field == TEXT("text") ? &Dialogue->Text
+				: Field == TEXT("menuText") ? &Dialogue->MenuText
+				: Field == TEXT("stageDirections") ? &Dialogue->StageDirections
+				: nullptr;
+			if (Text)
+			{
+				// Texts set on the object take precedence over compressed ones
+				*Text = MakePatchedText(*Text, Patch.Value);
+				return true;
+			}
+		}
+		else if (UDialogueFlowFragment* FlowFragment = Cast<UDialogueFlowFragment>(Object))
+		{
+			if (Field == TEXT("description"))
+			{
+				FlowFragment->Description = MakePatchedText(FlowFragment->Description, Patch.Value);
+				return true;
+			}
+			if (Field == TEXT("displayName"))
+			{
+				FlowFragment->DisplayName = Patch.Value;
+				return true;
+			}
+		}
+		else if (UDialogueHub* Hub = Cast<UDialogueHub>(Object))
+		{
+			if (Field == TEXT("displayName"))
+			{
+				Hub->DisplayName = Patch.Value;
+				return true;
+			}
+		}
+
+		OutError = FString::Printf(TEXT("%s has no text '%s'"), *Object->GetClass()->GetName(), *Field);
+		return false;
+	}
+
+	bool SetScript(UDialogueObject* Object, const FDialogueLivePatch& Patch, const UDialogueDatabase* Database, FString& OutError)
+	{
+		UDialogueNode* Node = Cast<UDialogueNode>(Object);
+		FDialogueScript* Script = nullptr;
+		bool bIsCondition = false;
+		if (Patch.InputPin != INDEX_NONE)
+		{
+			UDialogueInputPin* Pin = Node && Node->InputPins.IsValidIndex(Patch.InputPin) ? Node->InputPins[Patch.InputPin] : nullptr;
+			Script = Pin ? &Pin->Script : nullptr;
+			bIsCondition = true;
+		}
+		else if (Patch.OutputPin != INDEX_NONE)
+		{
+			UDialogueOutputPin* Pin = Node && Node->OutputPins.IsValidIndex(Patch.OutputPin) ? Node->OutputPins[Patch.OutputPin] : nullptr;
+			Script = Pin ? &Pin->Script : nullptr;
+		}
+		else if (UDialogueCondition* Condition = Cast<UDialogueCondition>(Object))
+		{
+			Script = &Condition->Script;
+			bIsCondition = true;
+		}
+		else if (UDialogueInstruction* Instruction = Cast<UDialogueInstruction>(Object))
+		{
+			Script = &Instruction->Script;
+		}
+
+		if (!Script)
+		{
+			OutError = FString::Printf(TEXT("%s has no such script"), *Object->GetClass()->GetName());
+			return false;
+		}
+
+		// Compile aside, a script with a syntax error keeps running the old program
+		FDialogueScriptProgram Program;
+		if (!Patch.Value.IsEmpty() && !FDialogueScriptCompiler::Compile(Patch.Value, bIsCondition, Program, &OutError))
+		{
+			return false;
+		}
+		FDialogueScriptCompiler::BindVariables(Program, Database->GetGlobalVariables());
+
+		// The generated code was made for the old expression
+		Script->Expression = Patch.Value;
+		Script->bIsCondition = bIsCondition;
+		Script->Program = MoveTemp(Program);
+		Script->NativeIndex = INDEX_NONE;
+		Script->StrippedExpressionHash = 0;
+		return true;
+	}
+
+	bool SetConnection(UDialogueObject* Object, const FDialogueLivePatch& Patch, const UDialogueDatabase* Database, FString& OutError)
+	{
+		UDialogueNode* Node = Cast<UDialogueNode>(Object);
+		UDialogueOutputPin* Pin = Node && Node->OutputPins.IsValidIndex(Patch.OutputPin) ? Node->OutputPins[Patch.OutputPin] : nullptr;
+		if (!Pin)
+		{
+			OutError = FString::Printf(TEXT("there is no output pin %d"), Patch.OutputPin);
+			return false;
+		}
+
+		const FDialogueId TargetNodeId = FDialogueId::FromImportId(Patch.TargetId);
+		const auto IsTarget = [&](const FDialogueConnection& Connection)
+		{
+			return Connection.TargetNodeId == TargetNodeId && Connection.TargetPinIndex == Patch.TargetPin;
+		};
+
+		if (Patch.Operation == FDialogueLivePatch::EOperation::Disconnect)
+		{
+			if (Pin->Edges.RemoveAll(IsTarget) == 0)
+			{
+				OutError = TEXT("there is no such connection");
+				return false;
+			}
+			return true;
+		}
+
+		if (Pin->Edges.ContainsByPredicate(IsTarget))
+		{
+			return true;
+		}
+
+		FDialogueConnection Connection;
+		Connection.TargetNodeId = TargetNodeId;
+		Connection.TargetPinIndex = Patch.TargetPin;
+
+		// Like the importer, only targets in the same package are resolved on the connection
+		const UDialogueNode* Target = Cast<UDialogueNode>(Database->GetObject(TargetNodeId));
+		if (Target && Target->InputPins.IsValidIndex(Patch.TargetPin) && Target->GetTypedOuter<UDialoguePackage>() == Pin->GetTypedOuter<UDialoguePackage>())
+		{
+			Connection.TargetPin = Target->InputPins[Patch.TargetPin];
+		}
+		Pin->Edges.Add(Connection);
+		return true;
+	}
+}
+
+bool FDialogueLivePatch::Parse(const FString& Message, TArray<FDialogueLivePatch>& OutPatches, FString& OutError)
+{
+	OutPatches.Reset();
+
+	TSharedPtr<FJsonValue> Json;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Message), Json) || !Json.IsValid())
+	{
+		OutError = TEXT("the message is no JSON");
+		return false;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Values;
+	if (Json->Type == EJson::Array)
+	{
+		Values = Json->AsArray();
+	}
+	else
+	{
+		Values.Add(Json);
+	}
+
+	for (const TSharedPtr<FJsonValue>& Value : Values)
+	{
+		const TSharedPtr<FJsonObject>* Object = nullptr;
+		if (!Value.IsValid() || !Value->TryGetObject(Object) || !ParsePatch(**Object, OutPatches.AddDefaulted_GetRef(), OutError))
+		{
+			if (OutError.IsEmpty())
+			{
+				OutError = TEXT("a patch is no JSON object");
+			}
+			OutPatches.Reset();
+			return false;
+		}
+	}
+	return true;
+}
+
+int32 FDialogueLivePatch::Apply(TConstArrayView<FDialogueLivePatch> Patches, TArray<FString>& OutErrors)
+{
+	// Packages and their objects are shared by the database instances of all worlds
+	TArray<UDialogueDatabase*> Databases;
+	for (TObjectIterator<UDialogueDatabase> It; It; ++It)
+	{
+		if (IsValid(*It) && !It->IsTemplate() && !It->IsAsset())
+		{
+			Databases.Add(*It);
+		}
+	}
+
+	TArray<UDialogueObject*> Patched;
+	TSet<UDialogueObject*> FlowPatched;
+	int32 NumApplied = 0;
+	for (const FDialogueLivePatch& Patch : Patches)
+	{
+		UDialogueObject* Object = nullptr;
+		const UDialogueDatabase* Database = nullptr;
+		for (const UDialogueDatabase* Candidate : Databases)
+		{
+			Object = Candidate->GetObject(Patch.Id);
+			if (Object)
+			{
+				Database = Candidate;
+				break;
+			}
+		}
+
+		FString Error = TEXT("the object is not loaded");
+		bool bApplied = false;
+		if (Object)
+		{
+			switch (Patch.Operation)
+			{
+			case EOperation::SetText:
+				bApplied = SetText(Object, Patch, Error);
+				break;
+			case EOperation::SetScript:
+				bApplied = SetScript(Object, Patch, Database, Error);
+				break;
+			case EOperation::Connect:
+			case EOperation::Disconnect:
+				bApplied = SetConnection(Object, Patch, Database, Error);
+				break;
+			}
+		}
+
+		if (!bApplied)
+		{
+			OutErrors.Add(FString::Printf(TEXT("%s %s: %s"), GetOperationName(Patch.Operation), *Patch.Id, *Error));
+			continue;
+		}
+
+		++NumApplied;
+		Patched.AddUnique(Object);
+		if (Patch.Operation != EOperation::SetText)
+		{
+			FlowPatched.Add(Object);
+		}
+	}
+
+	for (UDialogueDatabase* Database : Databases)
+	{
+		TArray<UDialogueObject*> Contained;
+		bool bFlowChanged = false;
+		for (UDialogueObject* Object : Patched)
+		{
+			if (Database->GetObject(Object->Id) == Object)
+			{
+				Contained.Add(Object);
+				bFlowChanged |= FlowPatched.Contains(Object);
+			}
+		}
+
+		if (Contained.Num() > 0)
+		{
+			Database->OnObjectsPatched(Contained, bFlowChanged);
+		}
+	}
+	return NumApplied;
+}
+
+// ==================== SERVER ====================
+
+FDialogueLivePatchServer::FDialogueLivePatchServer(uint16 InPort)
+	: Port(InPort)
+{
+	// Bound here rather than on the listener thread, so a port in use is known right away
+	ListenSocket = FTcpSocketBuilder(TEXT("DialogueLivePatch"))
+		.AsReusable()
+		.BoundToEndpoint(FIPv4Endpoint(FIPv4Address::InternalLoopback, Port))
+		.Listening(4);
+	if (!ListenSocket)
+	{
+		return;
+	}
+
+	Listener = MakeUnique<FTcpListener>(*ListenSocket, FTimespan::FromMilliseconds(100));
+	Listener->OnConnectionAccepted().BindRaw(this, &FDialogueLivePatchServer::OnConnectionAccepted);
+
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FDialogueLivePatchServer::Tick), 0.0f);
+}
+
+FDialogueLivePatchServer::~FDialogueLivePatchServer()
+{
+	// Stops the listener thread before the queue goes
+	Listener.Reset();
+	DestroySocket(ListenSocket);
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+	FSocket* Socket = nullptr;
+	while (AcceptedSockets.Dequeue(Socket))
+	{
+		DestroySocket(Socket);
+	}
+	for (const FConnection& Connection : Connections)
+	{
+		DestroySocket(Connection.Socket);
+	}
+}
+
+bool FDialogueLivePatchServer::IsListening() const
+{
+	return Listener.IsValid();
+}
+
+bool FDialogueLivePatchServer::OnConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint)
+{
+	AcceptedSockets.Enqueue(Socket);
+	return true;
+}
+
+bool FDialogueLivePatchServer::Tick(float DeltaTime)
+{
+	FSocket* Socket = nullptr;
+	while (AcceptedSockets.Dequeue(Socket))
+	{
+		UE_LOG(LogDialogueRuntime, Log, TEXT("Live patch: editor connected"));
+		Connections.Add({ Socket });
+	}
+
+	for (int32 i = Connections.Num() - 1; i >= 0; --i)
+	{
+		if (!ReceiveMessages(Connections[i]))
+		{
+			UE_LOG(LogDialogueRuntime, Log, TEXT("Live patch: editor disconnected"));
+			DestroySocket(Connections[i].Socket);
+			Connections.RemoveAtSwap(i);
+		}
+	}
+	return true;
+}
+
+bool FDialogueLivePatchServer::ReceiveMessages(FConnection& Connection)
+{
+	uint8 Buffer[4096];
+	while (Connection.Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::Zero()))
+	{
+		// Readable without data means the editor closed the connection
+		int32 Read = 0;
+		if (!Connection.Socket->Recv(Buffer, sizeof(Buffer), Read) || Read == 0)
+		{
+			return false;
+		}
+		Connection.Pending.Append(Buffer, Read);
+		if (Connection.Pending.Num() > MaxMessageBytes)
+		{
+			break;
+		}
+	}
+
+	int32 Start = 0;
+	for (int32 i = 0; i < Connection.Pending.Num(); ++i)
+	{
+		if (Connection.Pending[i] != '\n')
+		{
+			continue;
+		}
+
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Connection.Pending.GetData() + Start), i - Start);
+		FString Message(Converted.Length(), Converted.Get());
+		Message.TrimStartAndEndInline();
+		if (!Message.IsEmpty())
+		{
+			HandleMessage(Connection.Socket, Message);
+		}
+		Start = i + 1;
+	}
+	Connection.Pending.RemoveAt(0, Start, false);
+
+	if (Connection.Pending.Num() > MaxMessageBytes)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Live patch: a message exceeds %d bytes, dropping the connection"), MaxMessageBytes);
+		return false;
+	}
+	return true;
+}
+
+void FDialogueLivePatchServer::HandleMessage(FSocket* Socket, const FString& Message)
+{
+	TArray<FDialogueLivePatch> Patches;
+	FString Reply;
+	FString Error;
+	if (!FDialogueLivePatch::Parse(Message, Patches, Error))
+	{
+		Reply = FString::Printf(TEXT("error %s"), *Error);
+	}
+	else
+	{
+		TArray<FString> Errors;
+		const int32 NumApplied = FDialogueLivePatch::Apply(Patches, Errors);
+		Reply = Errors.Num() == 0 ? FString::Printf(TEXT("ok %d"), NumApplied) : FString::Printf(TEXT("error %s"), *FString::Join(Errors, TEXT("; ")));
+		UE_LOG(LogDialogueRuntime, Log, TEXT("Live patch: applied %d of %d patches"), NumApplied, Patches.Num());
+	}
+
+	if (Reply.StartsWith(TEXT("error")))
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Live patch: %s"), *Reply);
+	}
+
+	Reply.AppendChar(TEXT('\n'));
+	const FTCHARToUTF8 Converted(*Reply);
+	int32 Sent = 0;
+	Socket->Send(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length(), Sent);
+}
+
+void FDialogueLivePatchServer::DestroySocket(FSocket* Socket)
+{
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+	}
+}
@@ -0,0 +1,256 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#include "DialogueCharacter.h"
+#include "DialogueDatabase.h"
+#include "DialogueFlowPlayer.h"
+#include "DialoguePackage.h"
+#include "DialogueRuntimeStats.h"
+#include "DialogueScriptVM.h"
+
+// ==================== NODE ====================
+
+void UDialogueNode::Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth)
+{
+	// Default implementation: continue on output pins
+	if (OutputPins.Num() > 0)
+	{
+		const bool bShadowed = OutputPins.Num() > 1;
+
+		for (UDialogueOutputPin* Pin : OutputPins)
+		{
+			OutBranches.Append(Player->Explore(Pin, bShadowed, Depth + 1));
+		}
+	}
+	else
+	{
+		// Dead end
+		OutBranches.Add(FDialogueBranch());
+	}
+}
+
+// ==================== DIALOGUE ====================
+
+UDialogueCharacter* UDialogueDialogue::GetSpeaker() const
+{
+	UDialogueDatabase* Database = GetDatabase();
+	if (!Database || !SpeakerId.IsValid())
+	{
+		return nullptr;
+	}
+
+	// SpeakerId may be changed from Blueprints
+	if (CachedSpeakerId != SpeakerId || CachedSpeakerDatabase.Get() != Database)
+	{
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::SpeakerCacheMisses);
+		ResolveSpeaker(Database);
+	}
+	else
+	{
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::SpeakerCacheHits);
+	}
+	return CachedSpeaker.Get();
+}
+
+void UDialogueDialogue::ResolveSpeaker(const UDialogueDatabase* Database) const
+{
+	CachedSpeaker = Database && SpeakerId.IsValid() ? Database->GetCharacter(SpeakerId) : nullptr;
+	CachedSpeakerDatabase = Database;
+	CachedSpeakerId = SpeakerId;
+}
+
+void UDialogueDialogue::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	Ar << SpeakerId << Text << MenuText << StageDirections << bAutoTransition << CompressedTextIndex;
+}
+
+void UDialogueDialogue::PrefetchTexts() const
+{
+	if (CompressedTextIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (const UDialoguePackage* Package = GetTypedOuter<UDialoguePackage>())
+	{
+		Package->GetCompressedTexts().Prefetch(CompressedTextIndex);
+	}
+}
+
+FText UDialogueDialogue::GetCompressedText(const FText& InPlace, int32 Offset) const
+{
+	// Texts set from Blueprints after loading take precedence
+	if (CompressedTextIndex == INDEX_NONE || !InPlace.IsEmpty())
+	{
+		return InPlace;
+	}
+
+	const UDialoguePackage* Package = GetTypedOuter<UDialoguePackage>();
+	return Package ? Package->GetCompressedTexts().Get(CompressedTextIndex + Offset) : InPlace;
+}
+
+// ==================== FLOW FRAGMENT ====================
+
+void UDialogueFlowFragment::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	Ar << DisplayName << Description;
+}
+
+// ==================== HUB ====================
+
+void UDialogueHub::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	Ar << DisplayName;
+}
+
+// ==================== CONDITION ====================
+
+void UDialogueCondition::PostLoad()
+{
+	Super::PostLoad();
+
+	// Assets imported before bytecode existed only carry the expression text
+	Script.EnsureCompiled();
+}
+
+void UDialogueCondition::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	Ar << Script;
+	if (Ar.IsLoading())
+	{
+		Script.EnsureCompiled();
+	}
+}
+
+bool UDialogueCondition::Evaluate(UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	return FDialogueScriptVM::EvaluateCondition(Script.Program, GV, MethodProvider);
+}
+
+void UDialogueCondition::Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth)
+{
+	if (OutputPins.Num() != 2)
+	{
+		// Conditions must have a true and a false pin, treat anything else as a plain node
+		Super::Explore(Player, OutBranches, Depth);
+		return;
+	}
+
+	UDialogueOutputPin* Pin = Evaluate(Player->GetGlobalVariables(), Player->GetMethodsProvider()) ? OutputPins[0] : OutputPins[1];
+	OutBranches.Append(Player->Explore(Pin, false, Depth + 1));
+}
+
+// ==================== INSTRUCTION ====================
+
+void UDialogueInstruction::PostLoad()
+{
+	Super::PostLoad();
+
+	Script.EnsureCompiled();
+}
+
+void UDialogueInstruction::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	Ar << Script;
+	if (Ar.IsLoading())
+	{
+		Script.EnsureCompiled();
+	}
+}
+
+void UDialogueInstruction::Execute(UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	FDialogueScriptVM::ExecuteInstruction(Script.Program, GV, MethodProvider);
+}
+
+void UDialogueInstruction::Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth)
+{
+	Execute(Player->GetGlobalVariables(), Player->GetMethodsProvider());
+
+	Super::Explore(Player, OutBranches, Depth);
+}
+
+// ==================== JUMP ====================
+
+void UDialogueJump::PostLoad()
+{
+	Super::PostLoad();
+
+	// The target may have been edited since it was resolved
+	if (TargetPin && !FDialogueConnection::IsTargetPin(TargetPin, TargetNodeId, TargetPinIndex))
+	{
+		TargetPin = nullptr;
+	}
+}
+
+void UDialogueJump::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	// TargetPin is resolved again once the package's objects exist
+	Ar << TargetNodeId << TargetPinIndex;
+}
+
+void UDialogueJump::BindTargetPin(UDialogueInputPin* Pin)
+{
+	BoundTargetPin = Pin;
+	BoundNodeId = TargetNodeId;
+	BoundPinIndex = TargetPinIndex;
+}
+
+UDialogueNode* UDialogueJump::GetTargetNode() const
+{
+	if (UDialoguePin* Pin = GetTargetPin())
+	{
+		return Pin->GetOwner();
+	}
+
+	UDialogueDatabase* Database = GetDatabase();
+	return Database ? Cast<UDialogueNode>(Database->GetObject(TargetNodeId)) : nullptr;
+}
+
+UDialoguePin* UDialogueJump::GetTargetPin() const
+{
+	// Bound unless the target was changed since, or the pin went away with its package
+	if (BoundPinIndex == TargetPinIndex && BoundNodeId == TargetNodeId)
+	{
+		if (UDialogueInputPin* Pin = BoundTargetPin.Get())
+		{
+			return Pin;
+		}
+	}
+
+	if (TargetPin && FDialogueConnection::IsTargetPin(TargetPin, TargetNodeId, TargetPinIndex))
+	{
+		return TargetPin;
+	}
+
+	UDialogueDatabase* Database = GetDatabase();
+	UDialogueNode* Target = Database ? Cast<UDialogueNode>(Database->GetObject(TargetNodeId)) : nullptr;
+	return Target && Target->InputPins.IsValidIndex(TargetPinIndex) ? Target->InputPins[TargetPinIndex] : nullptr;
+}
+
+void UDialogueJump::Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth)
+{
+	// A jump never has output pins of its own, it continues at its target pin
+	if (UDialoguePin* Pin = GetTargetPin())
+	{
+		OutBranches.Append(Player->Explore(Pin, false, Depth + 1));
+	}
+	else
+	{
+		// Dead end
+		OutBranches.Add(FDialogueBranch());
+	}
+}
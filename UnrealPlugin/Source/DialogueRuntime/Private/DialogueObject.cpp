@@ -0,0 +1,52 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueObject.h"
+#include "DialogueDatabase.h"
+#include "DialogueObjectIndex.h"
+#include "DialoguePackage.h"
+
+UDialogueObject* UDialogueObject::GetParent() const
+{
+	UDialogueDatabase* Database = GetDatabase();
+	return Database && ParentId.IsValid() ? Database->GetObject(ParentId) : nullptr;
+}
+
+TArray<UDialogueObject*> UDialogueObject::GetChildren() const
+{
+	return TArray<UDialogueObject*>(GetChildrenView());
+}
+
+TArrayView<UDialogueObject* const> UDialogueObject::GetChildrenView() const
+{
+	UDialogueDatabase* Database = GetDatabase();
+	return Database ? Database->GetObjectIndex()->GetChildren(Id) : TArrayView<UDialogueObject* const>();
+}
+
+bool UDialogueObject::IsDescendantOf(const UDialogueObject* Ancestor) const
+{
+	UDialogueDatabase* Database = GetDatabase();
+	if (!Database || !Ancestor)
+	{
+		return false;
+	}
+
+	const FDialogueObjectIndex& Index = *Database->GetObjectIndex();
+	return Index.GetHierarchyRange(Ancestor->Id).Contains(Index.GetHierarchyRange(Id));
+}
+
+UDialogueDatabase* UDialogueObject::GetDatabase() const
+{
+	if (!CachedDatabase.IsValid())
+	{
+		CachedDatabase = UDialogueDatabase::Get(this);
+	}
+	return CachedDatabase.Get();
+}
+
+#if WITH_EDITOR
+bool UDialogueObject::NeedsLoadForTargetPlatform(const ITargetPlatform* TargetPlatform) const
+{
+	const UDialoguePackage* Package = GetTypedOuter<UDialoguePackage>();
+	return !(Package && Package->WillCookCompact()) && Super::NeedsLoadForTargetPlatform(TargetPlatform);
+}
+#endif
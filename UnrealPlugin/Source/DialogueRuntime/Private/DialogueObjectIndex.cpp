@@ -0,0 +1,193 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueObjectIndex.h"
+#include "DialogueObject.h"
+#include "DialoguePackage.h"
+
+bool FDialogueObjectIndex::Add(UDialogueObject* Object)
+{
+	if (!Object)
+	{
+		return false;
+	}
+
+	if (UDialogueObject* const* Existing = ObjectsById.Find(Object->Id))
+	{
+		if (*Existing != Object)
+		{
+			return false;
+		}
+		++RefCounts.FindChecked(Object->Id);
+		return true;
+	}
+
+	ObjectsById.Add(Object->Id, Object);
+	RefCounts.Add(Object->Id, 1);
+	if (!Object->TechnicalName.IsEmpty())
+	{
+		ObjectsByName.Add(Object->TechnicalName, Object);
+	}
+
+	for (const UClass* Class = Object->GetClass(); Class; Class = Class->GetSuperClass())
+	{
+		ObjectsByClass.FindOrAdd(Class).Add(Object);
+		if (Class == UDialogueObject::StaticClass())
+		{
+			break;
+		}
+	}
+	return true;
+}
+
+void FDialogueObjectIndex::Remove(const UDialogueObject* Object)
+{
+	if (ReleaseReference(Object))
+	{
+		RemoveFromClassLists({ Object });
+	}
+}
+
+bool FDialogueObjectIndex::ReleaseReference(const UDialogueObject* Object)
+{
+	if (!Object)
+	{
+		return false;
+	}
+
+	// Only the indexed object, not a duplicate that was skipped when added
+	UDialogueObject* const* Existing = ObjectsById.Find(Object->Id);
+	if (!Existing || *Existing != Object)
+	{
+		return false;
+	}
+
+	int32& RefCount = RefCounts.FindChecked(Object->Id);
+	if (--RefCount > 0)
+	{
+		return false;
+	}
+
+	RefCounts.Remove(Object->Id);
+	ObjectsById.Remove(Object->Id);
+	if (!Object->TechnicalName.IsEmpty() && ObjectsByName.FindRef(Object->TechnicalName) == Object)
+	{
+		ObjectsByName.Remove(Object->TechnicalName);
+	}
+
+	return true;
+}
+
+void FDialogueObjectIndex::AddPackage(const UDialoguePackage* Package, bool bWarnDuplicates)
+{
+	ObjectsById.Reserve(ObjectsById.Num() + Package->Objects.Num());
+
+	for (UDialogueObject* Object : Package->Objects)
+	{
+		if (Object && !Add(Object) && bWarnDuplicates)
+		{
+			ensureMsgf(false, TEXT("Object with id %s already in list!"), *Object->Id.ToString());
+		}
+	}
+}
+
+void FDialogueObjectIndex::RemovePackage(const UDialoguePackage* Package)
+{
+	TSet<const UDialogueObject*> Removed;
+	for (const UDialogueObject* Object : Package->Objects)
+	{
+		if (ReleaseReference(Object))
+		{
+			Removed.Add(Object);
+		}
+	}
+
+	if (Removed.Num() > 0)
+	{
+		RemoveFromClassLists(Removed);
+	}
+}
+
+void FDialogueObjectIndex::RemoveFromClassLists(const TSet<const UDialogueObject*>& Objects)
+{
+	for (auto It = ObjectsByClass.CreateIterator(); It; ++It)
+	{
+		It.Value().RemoveAllSwap([&Objects](const UDialogueObject* Object) { return Objects.Contains(Object); });
+		if (It.Value().Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+TArrayView<UDialogueObject* const> FDialogueObjectIndex::GetObjectsOfClass(const UClass* Class) const
+{
+	const TArray<UDialogueObject*>* Objects = Class ? ObjectsByClass.Find(Class) : nullptr;
+	return Objects ? TArrayView<UDialogueObject* const>(*Objects) : TArrayView<UDialogueObject* const>();
+}
+
+void FDialogueObjectIndex::BuildHierarchy()
+{
+	Hierarchy.Reset();
+	ChildrenById.Reset();
+
+	// Children as the objects list them; the walk follows the parents the objects name, so every object is below its parent
+	TMap<FDialogueId, TArray<FDialogueId>> WalkChildren;
+	TArray<TPair<FDialogueId, int32>> Stack;
+	for (const TPair<FDialogueId, UDialogueObject*>& Pair : ObjectsById)
+	{
+		const UDialogueObject* Object = Pair.Value;
+		for (const FDialogueId& ChildId : Object->ChildIds)
+		{
+			if (UDialogueObject* const* Child = ObjectsById.Find(ChildId))
+			{
+				ChildrenById.FindOrAdd(Pair.Key).Add(*Child);
+			}
+		}
+
+		if (Object->ParentId.IsValid() && Object->ParentId != Pair.Key && ObjectsById.Contains(Object->ParentId))
+		{
+			WalkChildren.FindOrAdd(Object->ParentId).Add(Pair.Key);
+		}
+		else
+		{
+			Stack.Emplace(Pair.Key, INDEX_NONE);
+		}
+	}
+
+	// Number the objects depth-first from the roots without recursing, with the position of each one's parent
+	TArray<FDialogueId> Order;
+	TArray<int32> ParentOrder;
+	Order.Reserve(ObjectsById.Num());
+	ParentOrder.Reserve(ObjectsById.Num());
+	while (Stack.Num() > 0)
+	{
+		const TPair<FDialogueId, int32> Entry = Stack.Pop(false);
+		const int32 Position = Order.Add(Entry.Key);
+		ParentOrder.Add(Entry.Value);
+
+		if (const TArray<FDialogueId>* Children = WalkChildren.Find(Entry.Key))
+		{
+			for (const FDialogueId& ChildId : *Children)
+			{
+				Stack.Emplace(ChildId, Position);
+			}
+		}
+	}
+
+	// A subtree is its root and the objects numbered right after it, sizes add up from the leaves
+	TArray<int32> Sizes;
+	Sizes.Init(1, Order.Num());
+	for (int32 i = Order.Num() - 1; i > 0; --i)
+	{
+		if (ParentOrder[i] != INDEX_NONE)
+		{
+			Sizes[ParentOrder[i]] += Sizes[i];
+		}
+	}
+
+	Hierarchy.Reserve(Order.Num());
+	for (int32 i = 0; i < Order.Num(); ++i)
+	{
+		Hierarchy.Add(Order[i], FDialogueHierarchyRange{ i, i + Sizes[i] - 1 });
+	}
+}
@@ -0,0 +1,306 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialoguePackage.h"
+#include "DialogueDatabase.h"
+#include "DialogueObject.h"
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#include "Misc/PackageName.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** Change to invalidate the cached blobs when building them changes without a new format version */
+	const TCHAR* const CookedObjectsDerivedDataVersion = TEXT("D27B9E40C61A4F8B93E5A0C4B7F21D6E");
+}
+#endif
+
+const FPrimaryAssetType UDialoguePackage::PrimaryAssetType(TEXT("DialoguePackage"));
+
+const TArray<UDialogueObject*>& UDialoguePackage::GetObjectsOfClass(const UClass* Class) const
+{
+	if (ObjectsByClassCount != Objects.Num())
+	{
+		// Objects only change on import, build the class lists on the first query after that
+		ObjectsByClass.Reset();
+		for (UDialogueObject* Object : Objects)
+		{
+			for (const UClass* ObjectClass = Object ? Object->GetClass() : nullptr; ObjectClass; ObjectClass = ObjectClass->GetSuperClass())
+			{
+				ObjectsByClass.FindOrAdd(ObjectClass).Add(Object);
+				if (ObjectClass == UDialogueObject::StaticClass())
+				{
+					break;
+				}
+			}
+		}
+		ObjectsByClassCount = Objects.Num();
+	}
+
+	static const TArray<UDialogueObject*> Empty;
+	const TArray<UDialogueObject*>* Result = ObjectsByClass.Find(Class);
+	return Result ? *Result : Empty;
+}
+
+void UDialoguePackage::Serialize(FArchive& Ar)
+{
+	// Only cooked data uses the compact format
+	if (!Ar.IsFilterEditorOnly())
+	{
+		Super::Serialize(Ar);
+		return;
+	}
+
+	bool bCompact = Ar.IsSaving() && WillCookCompact();
+	TArray<UDialogueObject*> SourceObjects;
+	if (bCompact)
+	{
+		// The objects are left out of the export table, see UDialogueObject::NeedsLoadForTargetPlatform
+		BuildCookedObjects(UDialogueDatabase::GetCookedEditorOnlyData());
+		SourceObjects = MoveTemp(Objects);
+		Objects.Reset();
+	}
+
+	Super::Serialize(Ar);
+
+	Ar << bCompact;
+	if (bCompact)
+	{
+		Ar << CookedObjects;
+	}
+
+	if (Ar.IsSaving() && bCompact)
+	{
+		Objects = MoveTemp(SourceObjects);
+		CookedObjects.Reset();
+	}
+}
+
+void UDialoguePackage::PostLoad()
+{
+	Super::PostLoad();
+
+	if (!CookedObjects.IsEmpty())
+	{
+		CookedObjects.Instantiate(this, Objects);
+		CompressedTexts = MoveTemp(CookedObjects.Texts);
+		CookedObjects.Reset();
+		ResolveTargetPins();
+		InvalidateObjectsByClass();
+	}
+}
+
+void UDialoguePackage::BuildCookedObjects(EDialogueEditorOnlyData Keep)
+{
+#if WITH_EDITOR
+	// The blob only depends on the saved package, so cooks of it on other machines fetch it instead of building it again
+	const UPackage* Package = GetOutermost();
+	FString Filename;
+	if (!Package->IsDirty() && FPackageName::DoesPackageExist(Package->GetName(), &Filename))
+	{
+		const FMD5Hash SourceHash = FMD5Hash::HashFile(*Filename);
+		if (SourceHash.IsValid())
+		{
+			const FString CacheKey = FDerivedDataCacheInterface::BuildCacheKey(TEXT("DIALOGUEPACKAGE"), CookedObjectsDerivedDataVersion,
+				*FDialogueCookedPackage::GetDerivedDataKeySuffix(LexToString(SourceHash), Keep, bCookCompressedTexts));
+
+			TArray<uint8> CachedData;
+			if (GetDerivedDataCacheRef().GetSynchronous(*CacheKey, CachedData, GetPathName()))
+			{
+				FMemoryReader Reader(CachedData, true);
+				Reader << CookedObjects;
+				if (!Reader.IsError() && !CookedObjects.IsEmpty())
+				{
+					return;
+				}
+				CookedObjects.Reset();
+			}
+
+			if (CookedObjects.Build(Objects, Keep, bCookCompressedTexts))
+			{
+				TArray<uint8> Data;
+				FMemoryWriter Writer(Data, true);
+				Writer << CookedObjects;
+				GetDerivedDataCacheRef().Put(*CacheKey, Data, GetPathName());
+			}
+			return;
+		}
+	}
+#endif
+
+	CookedObjects.Build(Objects, Keep, bCookCompressedTexts);
+}
+
+#if WITH_EDITOR
+void UDialoguePackage::GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const
+{
+	PRAGMA_DISABLE_DEPRECATION_WARNINGS
+	Super::GetAssetRegistryTags(OutTags);
+	PRAGMA_ENABLE_DEPRECATION_WARNINGS
+
+	int32 NumDialogues = 0;
+	int32 NumFlowFragments = 0;
+	int32 NumHubs = 0;
+	int32 NumConditions = 0;
+	int32 NumInstructions = 0;
+	int32 NumJumps = 0;
+	int32 NumPins = 0;
+	int64 TextLength = 0;
+
+	TArray<FDialogueId> ObjectIds;
+	ObjectIds.Reserve(Objects.Num());
+	TSet<FDialogueId> Speakers;
+	TSet<FDialogueId> Targets;
+
+	for (const UDialogueObject* Object : Objects)
+	{
+		if (!Object)
+		{
+			continue;
+		}
+		ObjectIds.Add(Object->Id);
+
+		if (const UDialogueDialogue* Dialogue = Cast<UDialogueDialogue>(Object))
+		{
+			++NumDialogues;
+			TextLength += Dialogue->Text.ToString().Len() + Dialogue->MenuText.ToString().Len() + Dialogue->StageDirections.ToString().Len();
+			if (Dialogue->SpeakerId.IsValid())
+			{
+				Speakers.Add(Dialogue->SpeakerId);
+			}
+		}
+		else if (const UDialogueFlowFragment* FlowFragment = Cast<UDialogueFlowFragment>(Object))
+		{
+			++NumFlowFragments;
+			TextLength += FlowFragment->Description.ToString().Len();
+		}
+		else if (Object->IsA<UDialogueHub>())
+		{
+			++NumHubs;
+		}
+		else if (Object->IsA<UDialogueCondition>())
+		{
+			++NumConditions;
+		}
+		else if (Object->IsA<UDialogueInstruction>())
+		{
+			++NumInstructions;
+		}
+		else if (const UDialogueJump* Jump = Cast<UDialogueJump>(Object))
+		{
+			++NumJumps;
+			Targets.Add(Jump->TargetNodeId);
+		}
+		else if (Object->IsA<UDialoguePin>())
+		{
+			++NumPins;
+		}
+
+		if (const UDialogueOutputPin* OutputPin = Cast<UDialogueOutputPin>(Object))
+		{
+			for (const FDialogueConnection& Connection : OutputPin->Edges)
+			{
+				Targets.Add(Connection.TargetNodeId);
+			}
+		}
+	}
+
+	// Only the targets outside the package reference other packages
+	for (const FDialogueId& Id : ObjectIds)
+	{
+		Targets.Remove(Id);
+	}
+	Targets.Remove(FDialogueId());
+
+	auto JoinIds = [](TArray<FDialogueId> Ids, bool bSort)
+	{
+		if (bSort)
+		{
+			Ids.Sort([](const FDialogueId& A, const FDialogueId& B)
+			{
+				return A.High != B.High ? A.High < B.High : A.Low < B.Low;
+			});
+		}
+		return FString::JoinBy(Ids, TEXT(" "), [](const FDialogueId& Id) { return Id.ToString(); });
+	};
+
+	auto AddCount = [&OutTags](const TCHAR* Tag, int64 Value)
+	{
+		OutTags.Add(FAssetRegistryTag(Tag, LexToString(Value), FAssetRegistryTag::TT_Numerical));
+	};
+	AddCount(DialoguePackageTags::NumObjects, ObjectIds.Num());
+	AddCount(DialoguePackageTags::NumDialogues, NumDialogues);
+	AddCount(DialoguePackageTags::NumFlowFragments, NumFlowFragments);
+	AddCount(DialoguePackageTags::NumHubs, NumHubs);
+	AddCount(DialoguePackageTags::NumConditions, NumConditions);
+	AddCount(DialoguePackageTags::NumInstructions, NumInstructions);
+	AddCount(DialoguePackageTags::NumJumps, NumJumps);
+	AddCount(DialoguePackageTags::NumPins, NumPins);
+	AddCount(DialoguePackageTags::TextLength, TextLength);
+
+	// The ID lists are for queries, not for the content browser's columns
+	OutTags.Add(FAssetRegistryTag(DialoguePackageTags::Speakers, JoinIds(Speakers.Array(), true), FAssetRegistryTag::TT_Hidden));
+	OutTags.Add(FAssetRegistryTag(DialoguePackageTags::ObjectIds, JoinIds(MoveTemp(ObjectIds), false), FAssetRegistryTag::TT_Hidden));
+	OutTags.Add(FAssetRegistryTag(DialoguePackageTags::ExternalTargets, JoinIds(Targets.Array(), true), FAssetRegistryTag::TT_Hidden));
+}
+#endif
+
+bool UDialoguePackage::WillCookCompact() const
+{
+	if (CookCompactCount != Objects.Num())
+	{
+		bWillCookCompact = bCookCompact && FDialogueCookedPackage::CanBuild(Objects);
+		CookCompactCount = Objects.Num();
+	}
+	return bWillCookCompact;
+}
+
+bool UDialoguePackage::ResolveTargetPins()
+{
+	TMap<FDialogueId, UDialogueNode*> NodesById;
+	for (UDialogueObject* Object : Objects)
+	{
+		if (UDialogueNode* Node = Cast<UDialogueNode>(Object))
+		{
+			NodesById.Add(Node->Id, Node);
+		}
+	}
+
+	auto FindTargetPin = [&NodesById](const FDialogueId& NodeId, int32 PinIndex) -> UDialogueInputPin*
+	{
+		UDialogueNode* const* Target = NodesById.Find(NodeId);
+		return Target && (*Target)->InputPins.IsValidIndex(PinIndex) ? (*Target)->InputPins[PinIndex] : nullptr;
+	};
+
+	bool bChanged = false;
+	for (const TPair<FDialogueId, UDialogueNode*>& Pair : NodesById)
+	{
+		if (UDialogueJump* Jump = Cast<UDialogueJump>(Pair.Value))
+		{
+			UDialogueInputPin* TargetPin = FindTargetPin(Jump->TargetNodeId, Jump->TargetPinIndex);
+			bChanged |= Jump->TargetPin != TargetPin;
+			Jump->TargetPin = TargetPin;
+		}
+
+		for (UDialogueOutputPin* OutputPin : Pair.Value->OutputPins)
+		{
+			if (!OutputPin)
+			{
+				continue;
+			}
+
+			for (FDialogueConnection& Connection : OutputPin->Edges)
+			{
+				UDialogueInputPin* TargetPin = FindTargetPin(Connection.TargetNodeId, Connection.TargetPinIndex);
+				bChanged |= Connection.TargetPin != TargetPin;
+				Connection.TargetPin = TargetPin;
+			}
+		}
+	}
+
+	return bChanged;
+}
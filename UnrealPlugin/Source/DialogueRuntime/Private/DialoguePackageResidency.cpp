@@ -0,0 +1,104 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialoguePackageResidency.h"
+
+void FDialoguePackageResidency::Touch(const FString& PackageName)
+{
+	if (FEntry* Entry = Entries.Find(PackageName))
+	{
+		Entry->LastUse = ++UseClock;
+	}
+}
+
+void FDialoguePackageResidency::AddLoaded(const FString& PackageName, int64 Bytes)
+{
+	FEntry& Entry = Entries.FindOrAdd(PackageName);
+	if (Entry.bLoaded)
+	{
+		ResidentBytes -= Entry.Bytes;
+	}
+
+	Entry.Bytes = Bytes;
+	Entry.bLoaded = true;
+	Entry.LastUse = ++UseClock;
+	ResidentBytes += Bytes;
+}
+
+void FDialoguePackageResidency::RemoveLoaded(const FString& PackageName)
+{
+	FEntry* Entry = Entries.Find(PackageName);
+	if (!Entry || !Entry->bLoaded)
+	{
+		return;
+	}
+
+	ResidentBytes -= Entry->Bytes;
+	if (Entry->Pins > 0)
+	{
+		Entry->Bytes = 0;
+		Entry->bLoaded = false;
+	}
+	else
+	{
+		Entries.Remove(PackageName);
+	}
+}
+
+void FDialoguePackageResidency::Pin(const FString& PackageName)
+{
+	++Entries.FindOrAdd(PackageName).Pins;
+}
+
+void FDialoguePackageResidency::Unpin(const FString& PackageName)
+{
+	FEntry* Entry = Entries.Find(PackageName);
+	if (!Entry || Entry->Pins == 0)
+	{
+		return;
+	}
+
+	if (--Entry->Pins == 0 && !Entry->bLoaded)
+	{
+		Entries.Remove(PackageName);
+	}
+}
+
+bool FDialoguePackageResidency::IsPinned(const FString& PackageName) const
+{
+	const FEntry* Entry = Entries.Find(PackageName);
+	return Entry && Entry->Pins > 0;
+}
+
+TArray<FString> FDialoguePackageResidency::SelectUnloads(int64 Budget, TFunctionRef<bool(const FString&)> CanUnload) const
+{
+	TArray<FString> Result;
+	if (ResidentBytes <= Budget)
+	{
+		return Result;
+	}
+
+	TArray<TPair<uint64, const FString*>> Candidates;
+	for (const TPair<FString, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.bLoaded && Pair.Value.Pins == 0 && CanUnload(Pair.Key))
+		{
+			Candidates.Emplace(Pair.Value.LastUse, &Pair.Key);
+		}
+	}
+	Candidates.Sort([](const TPair<uint64, const FString*>& A, const TPair<uint64, const FString*>& B) { return A.Key < B.Key; });
+
+	int64 Bytes = ResidentBytes;
+	for (int32 i = 0; i < Candidates.Num() && Bytes > Budget; ++i)
+	{
+		Bytes -= Entries.FindChecked(*Candidates[i].Value).Bytes;
+		Result.Add(*Candidates[i].Value);
+	}
+	return Result;
+}
+
+void FDialoguePackageResidency::Reset()
+{
+	Entries.Reset();
+	UseClock = 0;
+	ResidentBytes = 0;
+}
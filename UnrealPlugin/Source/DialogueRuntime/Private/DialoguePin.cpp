@@ -0,0 +1,195 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialoguePin.h"
+#include "DialogueNode.h"
+#include "DialogueDatabase.h"
+#include "DialoguePackage.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueScriptVM.h"
+#include "DialogueRuntimeModule.h"
+
+// ==================== PIN ====================
+
+UDialogueNode* UDialoguePin::GetOwner() const
+{
+	// Pins are created inside their node
+	if (UDialogueNode* Owner = GetTypedOuter<UDialogueNode>())
+	{
+		return Owner;
+	}
+
+	UDialogueDatabase* Database = GetDatabase();
+	return Database ? Cast<UDialogueNode>(Database->GetObject(OwnerId)) : nullptr;
+}
+
+void UDialoguePin::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	// Owner and index follow from where the pin is stored
+	Ar << Text;
+}
+
+// ==================== INPUT PIN ====================
+
+void UDialogueInputPin::PostLoad()
+{
+	Super::PostLoad();
+
+	Script.EnsureCompiled();
+}
+
+void UDialogueInputPin::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	Ar << Script;
+	if (Ar.IsLoading())
+	{
+		Script.EnsureCompiled();
+	}
+}
+
+bool UDialogueInputPin::Evaluate(UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	if (Script.Program.bIsConstant)
+	{
+		return Script.Program.bConstantResult;
+	}
+	return FDialogueScriptVM::EvaluateCondition(Script.Program, GV, MethodProvider);
+}
+
+void UDialogueInputPin::Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth)
+{
+	// Evaluate first, the condition could have side effects
+	const bool bIsValid = Evaluate(Player->GetGlobalVariables(), Player->GetMethodsProvider());
+
+	if (!bIsValid && Player->bIgnoreInvalidBranches)
+	{
+		return;
+	}
+
+	OutBranches.Append(Player->Explore(GetOwner(), false, Depth + 1));
+
+	// Branches running through this pin are invalid, a branch stopping at it is not
+	if (!bIsValid)
+	{
+		for (FDialogueBranch& Branch : OutBranches)
+		{
+			Branch.bIsValid = false;
+		}
+	}
+}
+
+// ==================== OUTPUT PIN ====================
+
+void UDialogueOutputPin::PostLoad()
+{
+	Super::PostLoad();
+
+	Script.EnsureCompiled();
+
+	// Packages imported before connections were stored inline; the objects are not saved again
+	for (UDialogueConnection* Connection : LegacyConnections)
+	{
+		if (Connection)
+		{
+			FDialogueConnection& Edge = Edges.AddDefaulted_GetRef();
+			Edge.TargetNodeId = Connection->TargetNodeId;
+			Edge.TargetPinIndex = Connection->TargetPinIndex;
+			Edge.TargetPin = Connection->TargetPin;
+			Connection->SetFlags(RF_Transient);
+		}
+	}
+	LegacyConnections.Empty();
+
+	for (FDialogueConnection& Connection : Edges)
+	{
+		if (Connection.TargetPin && !FDialogueConnection::IsTargetPin(Connection.TargetPin, Connection.TargetNodeId, Connection.TargetPinIndex))
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("%s: resolved target does not match %s pin %d, looking it up instead"),
+				*GetPathName(), *Connection.TargetNodeId.ToString(), Connection.TargetPinIndex);
+			Connection.TargetPin = nullptr;
+		}
+	}
+}
+
+void UDialogueOutputPin::SerializeCooked(FArchive& Ar)
+{
+	Super::SerializeCooked(Ar);
+
+	// Connections are stored by FDialogueCookedPackage
+	Ar << Script << Label;
+	if (Ar.IsLoading())
+	{
+		Script.EnsureCompiled();
+	}
+}
+
+void UDialogueOutputPin::Execute(UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	if (Script.CanSkip())
+	{
+		return;
+	}
+	FDialogueScriptVM::ExecuteInstruction(Script.Program, GV, MethodProvider);
+}
+
+void UDialogueOutputPin::Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth)
+{
+	Execute(Player->GetGlobalVariables(), Player->GetMethodsProvider());
+
+	if (Edges.Num() > 0)
+	{
+		const bool bShadowed = Edges.Num() > 1;
+
+		for (const FDialogueConnection& Connection : Edges)
+		{
+			OutBranches.Append(Player->Explore(Connection.GetTargetPin(GetDatabase()), bShadowed, Depth + 1));
+		}
+	}
+	else
+	{
+		// Dead end
+		OutBranches.Add(FDialogueBranch());
+	}
+}
+
+UDialogueInputPin* UDialogueOutputPin::GetConnectionTarget(int32 ConnectionIndex) const
+{
+	return Edges.IsValidIndex(ConnectionIndex) ? Edges[ConnectionIndex].GetTargetPin(GetDatabase()) : nullptr;
+}
+
+// ==================== CONNECTION ====================
+
+UDialogueNode* FDialogueConnection::GetTargetNode(const UDialogueDatabase* Database) const
+{
+	if (TargetPin)
+	{
+		return TargetPin->GetOwner();
+	}
+
+	return Database ? Cast<UDialogueNode>(Database->GetObject(TargetNodeId)) : nullptr;
+}
+
+UDialogueInputPin* FDialogueConnection::GetTargetPin(const UDialogueDatabase* Database) const
+{
+	if (TargetPin)
+	{
+		return TargetPin;
+	}
+
+	UDialogueNode* Target = GetTargetNode(Database);
+	return Target && Target->InputPins.IsValidIndex(TargetPinIndex) ? Target->InputPins[TargetPinIndex] : nullptr;
+}
+
+bool FDialogueConnection::IsTargetPin(const UDialogueInputPin* Pin, const FDialogueId& NodeId, int32 PinIndex)
+{
+	if (!Pin || Pin->OwnerId != NodeId || Pin->Index != PinIndex)
+	{
+		return false;
+	}
+
+	const UDialogueNode* Owner = Pin->GetTypedOuter<UDialogueNode>();
+	return Owner && Owner->InputPins.IsValidIndex(PinIndex) && Owner->InputPins[PinIndex] == Pin;
+}
@@ -0,0 +1,296 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueRuntimeConsoleCommands.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueDatabase.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueLivePatch.h"
+#include "DialogueRuntimeStats.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+#define LOCTEXT_NAMESPACE "FDialogueRuntimeModule"
+
+namespace
+{
+	/** Seconds between two CSV rows if not given */
+	constexpr float DefaultCsvInterval = 10.0f;
+
+	/** Numbers of all worlds added up, one CSV row */
+	struct FStatsSample
+	{
+		int32 NumDatabases = 0;
+		int32 NumPackages = 0;
+		int32 NumObjects = 0;
+		int32 NumPendingLoads = 0;
+		int64 PackageBytes = 0;
+		int32 NumPooledTexts = 0;
+		int64 SearchIndexBytes = 0;
+		int32 NumNamespaces = 0;
+		int32 NumVariables = 0;
+		int64 VariableBytes = 0;
+		int32 NumShadowedValues = 0;
+		int32 NumFlowPlayers = 0;
+		int32 NumCachedExplorations = 0;
+	};
+
+	using ECounter = FDialogueRuntimeStats::ECounter;
+
+	FString FormatHitRate(ECounter Hits, ECounter Misses)
+	{
+		const int64 NumHits = FDialogueRuntimeStats::GetTotal(Hits);
+		const int64 NumLookups = NumHits + FDialogueRuntimeStats::GetTotal(Misses);
+		if (NumLookups == 0)
+		{
+			return TEXT("no lookups");
+		}
+		return FString::Printf(TEXT("%.1f%% of %lld lookups"), 100.0 * NumHits / NumLookups, NumLookups);
+	}
+
+	/** Gather the state of all runtime databases and flow players, printing each of them to Ar if set */
+	FStatsSample GatherStats(FOutputDevice* Ar)
+	{
+		// Counts of the game thread would otherwise wait for its next exploration
+		FDialogueRuntimeStats::Flush();
+
+		FStatsSample Sample;
+		for (TObjectIterator<UDialogueDatabase> It; It; ++It)
+		{
+			// The original asset is never played, only its copies
+			const UDialogueDatabase* Database = *It;
+			if (!IsValid(Database) || Database->IsTemplate() || Database->IsAsset())
+			{
+				continue;
+			}
+
+			const UDialogueDatabase::FRuntimeStats Stats = Database->GetRuntimeStats(true);
+			++Sample.NumDatabases;
+			Sample.NumPackages += Stats.Packages.Num();
+			Sample.NumObjects += Stats.NumIndexedObjects;
+			Sample.NumPendingLoads += Stats.NumPendingLoads;
+			Sample.NumPooledTexts += Stats.NumPooledTexts;
+			Sample.SearchIndexBytes += Stats.SearchIndexBytes;
+
+			if (Ar)
+			{
+				Ar->Logf(TEXT("Database of %s: %d packages, %d objects, %d loading, %d pooled texts, shadow level %d"),
+					*GetNameSafe(Database->GetWorld()), Stats.Packages.Num(), Stats.NumIndexedObjects, Stats.NumPendingLoads,
+					Stats.NumPooledTexts, Stats.ShadowLevel);
+				if (Stats.ResidentPackageBudget > 0)
+				{
+					Ar->Logf(TEXT("    Package budget: %.1f of %.1f KB"), Stats.ResidentPackageBytes / 1024.0, Stats.ResidentPackageBudget / 1024.0);
+				}
+				if (Stats.NumSearchTokens > 0)
+				{
+					Ar->Logf(TEXT("    Text search: %d words, %.1f KB"), Stats.NumSearchTokens, Stats.SearchIndexBytes / 1024.0);
+				}
+			}
+
+			for (const UDialogueDatabase::FRuntimeStats::FPackage& Package : Stats.Packages)
+			{
+				Sample.PackageBytes += Package.Bytes;
+				if (Ar)
+				{
+					Ar->Logf(TEXT("    %s: %d objects, %.1f KB"), *Package.Name, Package.NumObjects, Package.Bytes / 1024.0);
+				}
+			}
+
+			if (const UDialogueGlobalVariables* GV = Stats.GlobalVariables)
+			{
+				const int32 NumVariables = GV->GetNumVariables(EDialogueVariableType::Boolean)
+					+ GV->GetNumVariables(EDialogueVariableType::Integer) + GV->GetNumVariables(EDialogueVariableType::String);
+				const int64 Bytes = const_cast<UDialogueGlobalVariables*>(GV)->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+
+				Sample.NumNamespaces += GV->GetNumNamespaces();
+				Sample.NumVariables += NumVariables;
+				Sample.VariableBytes += Bytes;
+				Sample.NumShadowedValues += GV->GetNumShadowedValues();
+
+				if (Ar)
+				{
+					Ar->Logf(TEXT("    Variables: %d namespaces, %d variables, %.1f KB, %d shadowed values"),
+						GV->GetNumNamespaces(), NumVariables, Bytes / 1024.0, GV->GetNumShadowedValues());
+				}
+			}
+		}
+
+		for (TObjectIterator<UDialogueFlowPlayer> It; It; ++It)
+		{
+			if (IsValid(*It) && !It->IsTemplate() && It->GetWorld())
+			{
+				++Sample.NumFlowPlayers;
+				Sample.NumCachedExplorations += It->GetNumCachedExplorations();
+			}
+		}
+
+		if (Ar)
+		{
+			Ar->Logf(TEXT("Flow players: %d, %d cached explorations"), Sample.NumFlowPlayers, Sample.NumCachedExplorations);
+			Ar->Logf(TEXT("Exploration cache: %s"), *FormatHitRate(ECounter::ExplorationCacheHits, ECounter::ExplorationCacheMisses));
+			Ar->Logf(TEXT("Text pool: %s"), *FormatHitRate(ECounter::TextPoolHits, ECounter::TextPoolMisses));
+			Ar->Logf(TEXT("Speaker cache: %s"), *FormatHitRate(ECounter::SpeakerCacheHits, ECounter::SpeakerCacheMisses));
+			Ar->Logf(TEXT("Compressed text cache: %s"), *FormatHitRate(ECounter::TextCacheHits, ECounter::TextCacheMisses));
+			Ar->Logf(TEXT("Object lookup cache: %s"), *FormatHitRate(ECounter::LookupCacheHits, ECounter::LookupCacheMisses));
+		}
+
+		return Sample;
+	}
+}
+
+FDialogueRuntimeConsoleCommands::FDialogueRuntimeConsoleCommands(const FDialogueRuntimeModule& InModule)
+	: Module(InModule)
+	, StatsCommand(
+		TEXT("Dialogue.Stats"),
+		*LOCTEXT("CommandText_Stats", "Prints the loaded packages, objects, variables, shadow state, cache hit rates and flow players. \"csv [Seconds]\" logs them to a CSV file periodically, \"csv off\" stops.").ToString(),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateRaw(this, &FDialogueRuntimeConsoleCommands::Stats))
+#if !UE_BUILD_SHIPPING
+	, LivePatchCommand(
+		TEXT("Dialogue.LivePatch"),
+		*LOCTEXT("CommandText_LivePatch", "Accepts text, script and connection patches from the dialogue editor on a local port. "[Port]" starts, "off" stops.").ToString(),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateRaw(this, &FDialogueRuntimeConsoleCommands::LivePatch))
+#endif
+{
+#if !UE_BUILD_SHIPPING
+	int32 LivePatchPort = FDialogueLivePatchServer::DefaultPort;
+	if (FParse::Value(FCommandLine::Get(), TEXT("DialogueLivePatch="), LivePatchPort) || FParse::Param(FCommandLine::Get(), TEXT("DialogueLivePatch")))
+	{
+		StartLivePatch((uint16)LivePatchPort);
+	}
+#endif
+
+	float Interval = DefaultCsvInterval;
+	if (FParse::Value(FCommandLine::Get(), TEXT("csvDialogueStats="), Interval) || FParse::Param(FCommandLine::Get(), TEXT("csvDialogueStats")))
+	{
+		StartCsv(Interval);
+	}
+}
+
+FDialogueRuntimeConsoleCommands::~FDialogueRuntimeConsoleCommands()
+{
+	StopCsv();
+}
+
+void FDialogueRuntimeConsoleCommands::Stats(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+	if (Args.Num() == 0)
+	{
+		GatherStats(&Ar);
+		return;
+	}
+
+	if (!Args[0].Equals(TEXT("csv"), ESearchCase::IgnoreCase))
+	{
+		Ar.Logf(TEXT("Usage: Dialogue.Stats [csv [Seconds|off]]"));
+		return;
+	}
+
+	StopCsv();
+	if (Args.Num() > 1 && Args[1].Equals(TEXT("off"), ESearchCase::IgnoreCase))
+	{
+		return;
+	}
+
+	StartCsv(Args.Num() > 1 ? FCString::Atof(*Args[1]) : DefaultCsvInterval);
+	Ar.Logf(TEXT("Logging dialogue stats to %s"), *CsvPath);
+}
+
+void FDialogueRuntimeConsoleCommands::LivePatch(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+#if UE_BUILD_SHIPPING
+	Ar.Logf(TEXT("Live patching is not available in shipping builds"));
+#else
+	if (Args.Num() > 0 && Args[0].Equals(TEXT("off"), ESearchCase::IgnoreCase))
+	{
+		LivePatchServer.Reset();
+		Ar.Logf(TEXT("Live patching stopped"));
+		return;
+	}
+
+	const int32 Port = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : FDialogueLivePatchServer::DefaultPort;
+	if (Port <= 0 || Port > MAX_uint16)
+	{
+		Ar.Logf(TEXT("Usage: Dialogue.LivePatch [Port|off]"));
+		return;
+	}
+
+	StartLivePatch((uint16)Port);
+	Ar.Logf(LivePatchServer ? TEXT("Accepting live patches on port %d") : TEXT("Could not listen on port %d"), Port);
+#endif
+}
+
+#if !UE_BUILD_SHIPPING
+void FDialogueRuntimeConsoleCommands::StartLivePatch(uint16 Port)
+{
+	// The old server has to release the port first
+	LivePatchServer.Reset();
+	LivePatchServer = MakeUnique<FDialogueLivePatchServer>(Port);
+	if (!LivePatchServer->IsListening())
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Live patch: could not listen on port %d"), Port);
+		LivePatchServer.Reset();
+		return;
+	}
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Live patch: accepting patches on port %d"), Port);
+}
+#endif
+
+void FDialogueRuntimeConsoleCommands::StartCsv(float Interval)
+{
+	if (Interval <= 0.0f)
+	{
+		Interval = DefaultCsvInterval;
+	}
+
+	CsvPath = FPaths::ProfilingDir() / FString::Printf(TEXT("DialogueStats-%s.csv"), *FDateTime::Now().ToString());
+	const FString Header = TEXT("Seconds,Databases,Packages,Objects,PendingLoads,PackageKB,PooledTexts,Namespaces,Variables,VariableKB,ShadowedValues,FlowPlayers,CachedExplorations,ExplorationCacheHits,ExplorationCacheMisses,TextPoolHits,TextPoolMisses,SpeakerCacheHits,SpeakerCacheMisses,SearchIndexKB\n");
+	if (!FFileHelper::SaveStringToFile(Header, *CsvPath))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to create the stats file %s"), *CsvPath);
+		CsvPath.Reset();
+		return;
+	}
+
+	CsvHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FDialogueRuntimeConsoleCommands::WriteCsvRow), Interval);
+	UE_LOG(LogDialogueRuntime, Log, TEXT("Logging dialogue stats every %.1f seconds to %s"), Interval, *CsvPath);
+}
+
+void FDialogueRuntimeConsoleCommands::StopCsv()
+{
+	if (CsvHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(CsvHandle);
+		CsvHandle.Reset();
+	}
+	CsvPath.Reset();
+}
+
+bool FDialogueRuntimeConsoleCommands::WriteCsvRow(float DeltaTime)
+{
+	const FStatsSample Sample = GatherStats(nullptr);
+	const FString Row = FString::Printf(TEXT("%.1f,%d,%d,%d,%d,%.1f,%d,%d,%d,%.1f,%d,%d,%d,%lld,%lld,%lld,%lld,%lld,%lld,%.1f\n"),
+		FPlatformTime::Seconds() - GStartTime, Sample.NumDatabases, Sample.NumPackages, Sample.NumObjects, Sample.NumPendingLoads,
+		Sample.PackageBytes / 1024.0, Sample.NumPooledTexts, Sample.NumNamespaces, Sample.NumVariables, Sample.VariableBytes / 1024.0,
+		Sample.NumShadowedValues, Sample.NumFlowPlayers, Sample.NumCachedExplorations,
+		FDialogueRuntimeStats::GetTotal(ECounter::ExplorationCacheHits), FDialogueRuntimeStats::GetTotal(ECounter::ExplorationCacheMisses),
+		FDialogueRuntimeStats::GetTotal(ECounter::TextPoolHits), FDialogueRuntimeStats::GetTotal(ECounter::TextPoolMisses),
+		FDialogueRuntimeStats::GetTotal(ECounter::SpeakerCacheHits), FDialogueRuntimeStats::GetTotal(ECounter::SpeakerCacheMisses),
+		Sample.SearchIndexBytes / 1024.0);
+
+	// Closed between rows, so a crashed soak test still leaves every row written
+	if (!FFileHelper::SaveStringToFile(Row, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to write to the stats file %s, logging stopped"), *CsvPath);
+		CsvHandle.Reset();
+		CsvPath.Reset();
+		return false;
+	}
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -1,6 +1,8 @@
 // Copyright Dialogue Editor Team. All Rights Reserved.
 
 #include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeConsoleCommands.h"
+#include "UObject/CoreRedirects.h"
 
 DEFINE_LOG_CATEGORY(LogDialogueRuntime);
 
@@ -9,10 +11,19 @@ DEFINE_LOG_CATEGORY(LogDialogueRuntime);
 void FDialogueRuntimeModule::StartupModule()
 {
 	UE_LOG(LogDialogueRuntime, Log, TEXT("DialogueRuntime module started"));
+	ConsoleCommands = new FDialogueRuntimeConsoleCommands(*this);
+
+	// Output pins of older packages saved their connections as objects, UDialogueOutputPin::PostLoad moves them inline
+	TArray<FCoreRedirect> Redirects;
+	Redirects.Emplace(ECoreRedirectFlags::Type_Property, TEXT("/Script/DialogueRuntime.DialogueOutputPin.Connections"), TEXT("/Script/DialogueRuntime.DialogueOutputPin.LegacyConnections"));
+	FCoreRedirects::AddRedirectList(Redirects, TEXT("DialogueRuntime"));
 }
 
 void FDialogueRuntimeModule::ShutdownModule()
 {
+	delete ConsoleCommands;
+	ConsoleCommands = nullptr;
+
 	UE_LOG(LogDialogueRuntime, Log, TEXT("DialogueRuntime module shutdown"));
 }
 
@@ -0,0 +1,211 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueRuntimeStats.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(DialogueRuntimeChannel);
+
+// Named and parented after the unique name, Dialogue_Packages is Dialogue/Packages
+LLM_DEFINE_TAG(Dialogue);
+LLM_DEFINE_TAG(Dialogue_Database);
+LLM_DEFINE_TAG(Dialogue_Packages);
+LLM_DEFINE_TAG(Dialogue_GlobalVariables);
+LLM_DEFINE_TAG(Dialogue_Shadows);
+LLM_DEFINE_TAG(Dialogue_Text);
+
+DEFINE_STAT(STAT_DialogueExplore);
+DEFINE_STAT(STAT_DialogueExploreBatched);
+DEFINE_STAT(STAT_DialogueAdvanceBarks);
+DEFINE_STAT(STAT_DialogueAdvanceSessions);
+DEFINE_STAT(STAT_DialogueQueryContent);
+DEFINE_STAT(STAT_DialogueEvaluate);
+DEFINE_STAT(STAT_DialogueExecute);
+DEFINE_STAT(STAT_DialogueLoadPackage);
+DEFINE_STAT(STAT_DialogueUnloadPackage);
+DEFINE_STAT(STAT_DialogueRebuildIndices);
+DEFINE_STAT(STAT_DialogueSearchText);
+
+DEFINE_STAT(STAT_DialogueNodesVisited);
+DEFINE_STAT(STAT_DialogueConditionsEvaluated);
+DEFINE_STAT(STAT_DialogueShadowPushes);
+DEFINE_STAT(STAT_DialogueObjectsDuplicated);
+DEFINE_STAT(STAT_DialogueBranchesProduced);
+DEFINE_STAT(STAT_DialogueExplorationCacheHits);
+DEFINE_STAT(STAT_DialogueExplorationCacheMisses);
+DEFINE_STAT(STAT_DialogueTextPoolHits);
+DEFINE_STAT(STAT_DialogueTextPoolMisses);
+DEFINE_STAT(STAT_DialogueSpeakerCacheHits);
+DEFINE_STAT(STAT_DialogueSpeakerCacheMisses);
+DEFINE_STAT(STAT_DialogueTextCacheHits);
+DEFINE_STAT(STAT_DialogueTextCacheMisses);
+DEFINE_STAT(STAT_DialogueLookupCacheHits);
+DEFINE_STAT(STAT_DialogueLookupCacheMisses);
+
+TRACE_DECLARE_INT_COUNTER(DialogueNodesVisited, TEXT("Dialogue/NodesVisited"));
+TRACE_DECLARE_INT_COUNTER(DialogueConditionsEvaluated, TEXT("Dialogue/ConditionsEvaluated"));
+TRACE_DECLARE_INT_COUNTER(DialogueShadowPushes, TEXT("Dialogue/ShadowPushes"));
+TRACE_DECLARE_INT_COUNTER(DialogueObjectsDuplicated, TEXT("Dialogue/ObjectsDuplicated"));
+TRACE_DECLARE_INT_COUNTER(DialogueBranchesProduced, TEXT("Dialogue/BranchesProduced"));
+TRACE_DECLARE_INT_COUNTER(DialogueExplorationCacheHits, TEXT("Dialogue/ExplorationCacheHits"));
+TRACE_DECLARE_INT_COUNTER(DialogueExplorationCacheMisses, TEXT("Dialogue/ExplorationCacheMisses"));
+TRACE_DECLARE_INT_COUNTER(DialogueTextPoolHits, TEXT("Dialogue/TextPoolHits"));
+TRACE_DECLARE_INT_COUNTER(DialogueTextPoolMisses, TEXT("Dialogue/TextPoolMisses"));
+TRACE_DECLARE_INT_COUNTER(DialogueSpeakerCacheHits, TEXT("Dialogue/SpeakerCacheHits"));
+TRACE_DECLARE_INT_COUNTER(DialogueSpeakerCacheMisses, TEXT("Dialogue/SpeakerCacheMisses"));
+TRACE_DECLARE_INT_COUNTER(DialogueTextCacheHits, TEXT("Dialogue/TextCacheHits"));
+TRACE_DECLARE_INT_COUNTER(DialogueTextCacheMisses, TEXT("Dialogue/TextCacheMisses"));
+TRACE_DECLARE_INT_COUNTER(DialogueLookupCacheHits, TEXT("Dialogue/LookupCacheHits"));
+TRACE_DECLARE_INT_COUNTER(DialogueLookupCacheMisses, TEXT("Dialogue/LookupCacheMisses"));
+
+namespace
+{
+	FCriticalSection TraceCountersLock;
+
+	/** Guarded by TraceCountersLock */
+	int64 Totals[(int32)FDialogueRuntimeStats::ECounter::Num] = {};
+}
+
+void FDialogueRuntimeStats::AddCount(ECounter Counter, int64 Delta)
+{
+	if (Delta == 0)
+	{
+		return;
+	}
+
+	switch (Counter)
+	{
+	case ECounter::NodesVisited:
+		INC_DWORD_STAT_BY(STAT_DialogueNodesVisited, Delta);
+		break;
+	case ECounter::ConditionsEvaluated:
+		INC_DWORD_STAT_BY(STAT_DialogueConditionsEvaluated, Delta);
+		break;
+	case ECounter::ShadowPushes:
+		INC_DWORD_STAT_BY(STAT_DialogueShadowPushes, Delta);
+		break;
+	case ECounter::ObjectsDuplicated:
+		INC_DWORD_STAT_BY(STAT_DialogueObjectsDuplicated, Delta);
+		break;
+	case ECounter::BranchesProduced:
+		INC_DWORD_STAT_BY(STAT_DialogueBranchesProduced, Delta);
+		break;
+	case ECounter::ExplorationCacheHits:
+		INC_DWORD_STAT_BY(STAT_DialogueExplorationCacheHits, Delta);
+		break;
+	case ECounter::ExplorationCacheMisses:
+		INC_DWORD_STAT_BY(STAT_DialogueExplorationCacheMisses, Delta);
+		break;
+	case ECounter::TextPoolHits:
+		INC_DWORD_STAT_BY(STAT_DialogueTextPoolHits, Delta);
+		break;
+	case ECounter::TextPoolMisses:
+		INC_DWORD_STAT_BY(STAT_DialogueTextPoolMisses, Delta);
+		break;
+	case ECounter::SpeakerCacheHits:
+		INC_DWORD_STAT_BY(STAT_DialogueSpeakerCacheHits, Delta);
+		break;
+	case ECounter::SpeakerCacheMisses:
+		INC_DWORD_STAT_BY(STAT_DialogueSpeakerCacheMisses, Delta);
+		break;
+	case ECounter::TextCacheHits:
+		INC_DWORD_STAT_BY(STAT_DialogueTextCacheHits, Delta);
+		break;
+	case ECounter::TextCacheMisses:
+		INC_DWORD_STAT_BY(STAT_DialogueTextCacheMisses, Delta);
+		break;
+	case ECounter::LookupCacheHits:
+		INC_DWORD_STAT_BY(STAT_DialogueLookupCacheHits, Delta);
+		break;
+	case ECounter::LookupCacheMisses:
+		INC_DWORD_STAT_BY(STAT_DialogueLookupCacheMisses, Delta);
+		break;
+	default:
+		return;
+	}
+
+	FScopeLock Lock(&TraceCountersLock);
+	switch (Counter)
+	{
+	case ECounter::NodesVisited:
+		TRACE_COUNTER_ADD(DialogueNodesVisited, Delta);
+		break;
+	case ECounter::ConditionsEvaluated:
+		TRACE_COUNTER_ADD(DialogueConditionsEvaluated, Delta);
+		break;
+	case ECounter::ShadowPushes:
+		TRACE_COUNTER_ADD(DialogueShadowPushes, Delta);
+		break;
+	case ECounter::ObjectsDuplicated:
+		TRACE_COUNTER_ADD(DialogueObjectsDuplicated, Delta);
+		break;
+	case ECounter::BranchesProduced:
+		TRACE_COUNTER_ADD(DialogueBranchesProduced, Delta);
+		break;
+	case ECounter::ExplorationCacheHits:
+		TRACE_COUNTER_ADD(DialogueExplorationCacheHits, Delta);
+		break;
+	case ECounter::ExplorationCacheMisses:
+		TRACE_COUNTER_ADD(DialogueExplorationCacheMisses, Delta);
+		break;
+	case ECounter::TextPoolHits:
+		TRACE_COUNTER_ADD(DialogueTextPoolHits, Delta);
+		break;
+	case ECounter::TextPoolMisses:
+		TRACE_COUNTER_ADD(DialogueTextPoolMisses, Delta);
+		break;
+	case ECounter::SpeakerCacheHits:
+		TRACE_COUNTER_ADD(DialogueSpeakerCacheHits, Delta);
+		break;
+	case ECounter::SpeakerCacheMisses:
+		TRACE_COUNTER_ADD(DialogueSpeakerCacheMisses, Delta);
+		break;
+	case ECounter::TextCacheHits:
+		TRACE_COUNTER_ADD(DialogueTextCacheHits, Delta);
+		break;
+	case ECounter::TextCacheMisses:
+		TRACE_COUNTER_ADD(DialogueTextCacheMisses, Delta);
+		break;
+	case ECounter::LookupCacheHits:
+		TRACE_COUNTER_ADD(DialogueLookupCacheHits, Delta);
+		break;
+	case ECounter::LookupCacheMisses:
+		TRACE_COUNTER_ADD(DialogueLookupCacheMisses, Delta);
+		break;
+	default:
+		break;
+	}
+	Totals[(int32)Counter] += Delta;
+}
+
+int64* FDialogueRuntimeStats::GetPendingCounts()
+{
+	static thread_local int64 PendingCounts[(int32)ECounter::Num] = {};
+	return PendingCounts;
+}
+
+void FDialogueRuntimeStats::Count(ECounter Counter, int64 Delta)
+{
+	GetPendingCounts()[(int32)Counter] += Delta;
+}
+
+void FDialogueRuntimeStats::Flush()
+{
+	int64* PendingCounts = GetPendingCounts();
+	for (int32 i = 0; i < (int32)ECounter::Num; ++i)
+	{
+		AddCount((ECounter)i, PendingCounts[i]);
+		PendingCounts[i] = 0;
+	}
+}
+
+int64 FDialogueRuntimeStats::GetTotal(ECounter Counter)
+{
+	if (Counter >= ECounter::Num)
+	{
+		return 0;
+	}
+
+	FScopeLock Lock(&TraceCountersLock);
+	return Totals[(int32)Counter];
+}
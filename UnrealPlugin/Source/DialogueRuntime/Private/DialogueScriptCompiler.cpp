@@ -0,0 +1,1213 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueScriptCompiler.h"
+#include "DialogueScriptVM.h"
+#include "DialogueScripts.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueRuntimeModule.h"
+
+namespace
+{
+	enum class ETokenType : uint8
+	{
+		End,
+		Identifier,
+		Int,
+		String,
+		Operator,
+		LeftParen,
+		RightParen,
+		Comma,
+		Semicolon
+	};
+
+	struct FToken
+	{
+		ETokenType Type = ETokenType::End;
+		FString Text;
+		int32 IntValue = 0;
+		int32 Position = 0;
+	};
+
+	/** Splits an expression into tokens */
+	class FLexer
+	{
+	public:
+		explicit FLexer(const FString& InSource) : Source(InSource) {}
+
+		bool Tokenize(TArray<FToken>& OutTokens, FString& OutError)
+		{
+			while (true)
+			{
+				SkipWhitespace();
+
+				FToken Token;
+				Token.Position = Pos;
+
+				if (Pos >= Source.Len())
+				{
+					OutTokens.Add(Token);
+					return true;
+				}
+
+				const TCHAR Ch = Source[Pos];
+
+				if (FChar::IsAlpha(Ch) || Ch == TEXT('_'))
+				{
+					// Identifiers may contain dots (Namespace.Variable)
+					const int32 Start = Pos;
+					while (Pos < Source.Len() && (FChar::IsAlnum(Source[Pos]) || Source[Pos] == TEXT('_') || Source[Pos] == TEXT('.')))
+					{
+						++Pos;
+					}
+					Token.Type = ETokenType::Identifier;
+					Token.Text = Source.Mid(Start, Pos - Start);
+				}
+				else if (FChar::IsDigit(Ch))
+				{
+					int64 Value = 0;
+					while (Pos < Source.Len() && FChar::IsDigit(Source[Pos]))
+					{
+						Value = Value * 10 + (Source[Pos] - TEXT('0'));
+						if (Value > MAX_int32)
+						{
+							OutError = FString::Printf(TEXT("Integer literal out of range at %d"), Token.Position);
+							return false;
+						}
+						++Pos;
+					}
+					Token.Type = ETokenType::Int;
+					Token.IntValue = (int32)Value;
+				}
+				else if (Ch == TEXT('"') || Ch == TEXT('\''))
+				{
+					const TCHAR Quote = Ch;
+					++Pos;
+					while (Pos < Source.Len() && Source[Pos] != Quote)
+					{
+						if (Source[Pos] == TEXT('\\') && Pos + 1 < Source.Len())
+						{
+							++Pos;
+						}
+						Token.Text.AppendChar(Source[Pos++]);
+					}
+					if (Pos >= Source.Len())
+					{
+						OutError = FString::Printf(TEXT("Unterminated string literal at %d"), Token.Position);
+						return false;
+					}
+					++Pos;
+					Token.Type = ETokenType::String;
+				}
+				else if (Ch == TEXT('('))
+				{
+					Token.Type = ETokenType::LeftParen;
+					++Pos;
+				}
+				else if (Ch == TEXT(')'))
+				{
+					Token.Type = ETokenType::RightParen;
+					++Pos;
+				}
+				else if (Ch == TEXT(','))
+				{
+					Token.Type = ETokenType::Comma;
+					++Pos;
+				}
+				else if (Ch == TEXT(';'))
+				{
+					Token.Type = ETokenType::Semicolon;
+					++Pos;
+				}
+				else
+				{
+					static const TCHAR* TwoCharOperators[] = { TEXT("=="), TEXT("!="), TEXT("<="), TEXT(">="), TEXT("&&"), TEXT("||"), TEXT("+="), TEXT("-="), TEXT("*="), TEXT("/=") };
+					static const TCHAR* OneCharOperators = TEXT("=<>+-*/%!");
+
+					Token.Type = ETokenType::Operator;
+					for (const TCHAR* Op : TwoCharOperators)
+					{
+						if (Pos + 1 < Source.Len() && Source[Pos] == Op[0] && Source[Pos + 1] == Op[1])
+						{
+							Token.Text = Op;
+							Pos += 2;
+							break;
+						}
+					}
+					if (Token.Text.IsEmpty())
+					{
+						if (!FCString::Strchr(OneCharOperators, Ch))
+						{
+							OutError = FString::Printf(TEXT("Unexpected character '%c' at %d"), Ch, Token.Position);
+							return false;
+						}
+						Token.Text.AppendChar(Ch);
+						++Pos;
+					}
+				}
+
+				OutTokens.Add(MoveTemp(Token));
+			}
+		}
+
+	private:
+		void SkipWhitespace()
+		{
+			while (Pos < Source.Len() && FChar::IsWhitespace(Source[Pos]))
+			{
+				++Pos;
+			}
+		}
+
+		const FString& Source;
+		int32 Pos = 0;
+	};
+
+	/** Recursive descent parser emitting register code */
+	class FCodeGen
+	{
+	public:
+		FCodeGen(const TArray<FToken>& InTokens, FDialogueScriptProgram& InProgram)
+			: Tokens(InTokens), Program(InProgram) {}
+
+		bool CompileCondition()
+		{
+			const uint8 Result = AllocRegister();
+			CompileExpression(0, Result);
+			Accept(ETokenType::Semicolon);
+			Expect(ETokenType::End, TEXT("end of condition"));
+			Emit(DialogueScript::Encode(EDialogueScriptOp::Return, Result));
+			return Error.IsEmpty();
+		}
+
+		bool CompileInstruction()
+		{
+			while (Error.IsEmpty() && Peek().Type != ETokenType::End)
+			{
+				if (Accept(ETokenType::Semicolon))
+				{
+					continue;
+				}
+				CompileStatement();
+				if (Peek().Type != ETokenType::End)
+				{
+					Expect(ETokenType::Semicolon, TEXT("';'"));
+				}
+			}
+			Emit(DialogueScript::Encode(EDialogueScriptOp::ReturnNone));
+			return Error.IsEmpty();
+		}
+
+		FString Error;
+
+	private:
+		void CompileStatement()
+		{
+			const FToken& First = Peek();
+			const FToken& Second = Peek(1);
+
+			if (First.Type == ETokenType::Identifier && Second.Type == ETokenType::Operator &&
+				(Second.Text == TEXT("=") || Second.Text == TEXT("+=") || Second.Text == TEXT("-=") || Second.Text == TEXT("*=") || Second.Text == TEXT("/=")))
+			{
+				Advance();
+				Advance();
+
+				const uint16 Variable = AddVariable(First.Text);
+				const uint8 Value = AllocRegister();
+				CompileExpression(0, Value);
+
+				if (Second.Text != TEXT("="))
+				{
+					const uint8 Current = AllocRegister();
+					Emit(DialogueScript::EncodeBx(EDialogueScriptOp::LoadVar, Current, Variable));
+
+					EDialogueScriptOp Op = EDialogueScriptOp::Add;
+					if (Second.Text == TEXT("-=")) Op = EDialogueScriptOp::Subtract;
+					else if (Second.Text == TEXT("*=")) Op = EDialogueScriptOp::Multiply;
+					else if (Second.Text == TEXT("/=")) Op = EDialogueScriptOp::Divide;
+
+					Emit(DialogueScript::Encode(Op, Value, Current, Value));
+					FreeRegister(Current);
+				}
+
+				Emit(DialogueScript::EncodeBx(EDialogueScriptOp::StoreVar, Value, Variable));
+				FreeRegister(Value);
+			}
+			else
+			{
+				// Expression statement, typically a method call
+				const uint8 Discard = AllocRegister();
+				CompileExpression(0, Discard);
+				FreeRegister(Discard);
+			}
+		}
+
+		static int32 GetBinaryPrecedence(const FToken& Token)
+		{
+			if (Token.Type != ETokenType::Operator) return -1;
+			if (Token.Text == TEXT("||")) return 1;
+			if (Token.Text == TEXT("&&")) return 2;
+			if (Token.Text == TEXT("==") || Token.Text == TEXT("!=")) return 3;
+			if (Token.Text == TEXT("<") || Token.Text == TEXT("<=") || Token.Text == TEXT(">") || Token.Text == TEXT(">=")) return 4;
+			if (Token.Text == TEXT("+") || Token.Text == TEXT("-")) return 5;
+			if (Token.Text == TEXT("*") || Token.Text == TEXT("/") || Token.Text == TEXT("%")) return 6;
+			return -1;
+		}
+
+		static EDialogueScriptOp GetBinaryOp(const FString& Text)
+		{
+			if (Text == TEXT("==")) return EDialogueScriptOp::Equal;
+			if (Text == TEXT("!=")) return EDialogueScriptOp::NotEqual;
+			if (Text == TEXT("<")) return EDialogueScriptOp::Less;
+			if (Text == TEXT("<=")) return EDialogueScriptOp::LessEqual;
+			if (Text == TEXT(">")) return EDialogueScriptOp::Greater;
+			if (Text == TEXT(">=")) return EDialogueScriptOp::GreaterEqual;
+			if (Text == TEXT("+")) return EDialogueScriptOp::Add;
+			if (Text == TEXT("-")) return EDialogueScriptOp::Subtract;
+			if (Text == TEXT("*")) return EDialogueScriptOp::Multiply;
+			if (Text == TEXT("/")) return EDialogueScriptOp::Divide;
+			return EDialogueScriptOp::Modulo;
+		}
+
+		/** Compile an expression whose operators bind tighter than MinPrecedence into Dest */
+		void CompileExpression(int32 MinPrecedence, uint8 Dest)
+		{
+			const int32 Start = Program.Code.Num();
+			CompileUnary(Dest);
+
+			while (Error.IsEmpty())
+			{
+				const FToken& Op = Peek();
+				const int32 Precedence = GetBinaryPrecedence(Op);
+				if (Precedence <= MinPrecedence)
+				{
+					break;
+				}
+				Advance();
+
+				FDialogueScriptValue Left;
+				const bool bConstantLeft = GetConstant(Start, Dest, Left);
+				if (bConstantLeft && (Op.Text == TEXT("&&") || Op.Text == TEXT("||")))
+				{
+					// A constant left side decides at compile time whether the right side runs
+					const bool bIsAnd = Op.Text == TEXT("&&");
+					Program.Code.SetNum(Start, false);
+					CompileExpression(Precedence, Dest);
+
+					FDialogueScriptValue Right;
+					if (Left.AsBool() != bIsAnd)
+					{
+						// false && ... and true || ..., the right side is dead
+						Program.Code.SetNum(Start, false);
+						EmitConstant(Dest, FDialogueScriptValue::MakeBool(!bIsAnd));
+					}
+					else if (GetConstant(Start, Dest, Right))
+					{
+						Program.Code.SetNum(Start, false);
+						EmitConstant(Dest, FDialogueScriptValue::MakeBool(Right.AsBool()));
+					}
+					else
+					{
+						Emit(DialogueScript::Encode(EDialogueScriptOp::ToBool, Dest, Dest));
+					}
+				}
+				else if (Op.Text == TEXT("&&") || Op.Text == TEXT("||"))
+				{
+					// Short-circuit: skip the right side once the result is known
+					const bool bIsAnd = Op.Text == TEXT("&&");
+					Emit(DialogueScript::Encode(EDialogueScriptOp::ToBool, Dest, Dest));
+					const int32 JumpIndex = Emit(DialogueScript::EncodeBx(bIsAnd ? EDialogueScriptOp::JumpIfFalse : EDialogueScriptOp::JumpIfTrue, Dest, 0));
+					CompileExpression(Precedence, Dest);
+					Emit(DialogueScript::Encode(EDialogueScriptOp::ToBool, Dest, Dest));
+					PatchJump(JumpIndex);
+				}
+				else
+				{
+					const uint8 Right = AllocRegister();
+					const int32 RightStart = Program.Code.Num();
+					CompileExpression(Precedence, Right);
+
+					FDialogueScriptValue RightValue;
+					FDialogueScriptValue Folded;
+					if (bConstantLeft && GetConstant(RightStart, Right, RightValue) && Fold(GetBinaryOp(Op.Text), Left, RightValue, Folded))
+					{
+						Program.Code.SetNum(Start, false);
+						EmitConstant(Dest, Folded);
+					}
+					else
+					{
+						Emit(DialogueScript::Encode(GetBinaryOp(Op.Text), Dest, Dest, Right));
+					}
+					FreeRegister(Right);
+				}
+			}
+		}
+
+		void CompileUnary(uint8 Dest)
+		{
+			const FToken& Token = Peek();
+			if (Token.Type == ETokenType::Operator && (Token.Text == TEXT("!") || Token.Text == TEXT("-")))
+			{
+				Advance();
+				const bool bIsNot = Token.Text == TEXT("!");
+				const int32 Start = Program.Code.Num();
+				CompileUnary(Dest);
+
+				FDialogueScriptValue Value;
+				if (GetConstant(Start, Dest, Value))
+				{
+					Program.Code.SetNum(Start, false);
+					EmitConstant(Dest, bIsNot ? FDialogueScriptValue::MakeBool(!Value.AsBool()) : FDialogueScriptValue::MakeInt(-Value.AsInt()));
+				}
+				else
+				{
+					Emit(DialogueScript::Encode(bIsNot ? EDialogueScriptOp::Not : EDialogueScriptOp::Negate, Dest, Dest));
+				}
+				return;
+			}
+			CompilePrimary(Dest);
+		}
+
+		void CompilePrimary(uint8 Dest)
+		{
+			const FToken& Token = Peek();
+
+			switch (Token.Type)
+			{
+			case ETokenType::Int:
+				Advance();
+				Emit(DialogueScript::EncodeBx(EDialogueScriptOp::LoadInt, Dest, AddIntConstant(Token.IntValue)));
+				break;
+
+			case ETokenType::String:
+				Advance();
+				Emit(DialogueScript::EncodeBx(EDialogueScriptOp::LoadString, Dest, AddStringConstant(Token.Text)));
+				break;
+
+			case ETokenType::LeftParen:
+				Advance();
+				CompileExpression(0, Dest);
+				Expect(ETokenType::RightParen, TEXT("')'"));
+				break;
+
+			case ETokenType::Identifier:
+				Advance();
+				if (Token.Text == TEXT("true") || Token.Text == TEXT("false"))
+				{
+					Emit(DialogueScript::Encode(EDialogueScriptOp::LoadBool, Dest, Token.Text == TEXT("true") ? 1 : 0));
+				}
+				else if (Peek().Type == ETokenType::LeftParen)
+				{
+					CompileCall(Token, Dest);
+				}
+				else
+				{
+					Emit(DialogueScript::EncodeBx(EDialogueScriptOp::LoadVar, Dest, AddVariable(Token.Text)));
+				}
+				break;
+
+			default:
+				Fail(Token, TEXT("expression"));
+				break;
+			}
+		}
+
+		void CompileCall(const FToken& Name, uint8 Dest)
+		{
+			Expect(ETokenType::LeftParen, TEXT("'('"));
+
+			// Arguments go into the registers directly above the call base
+			const uint8 Base = AllocRegister();
+			int32 NumArgs = 0;
+
+			if (!Accept(ETokenType::RightParen))
+			{
+				do
+				{
+					if (NumArgs >= DialogueScript::MaxMethodArgs)
+					{
+						Fail(Peek(), TEXT("fewer method arguments"));
+						return;
+					}
+					CompileExpression(0, AllocRegister());
+					++NumArgs;
+				}
+				while (Error.IsEmpty() && Accept(ETokenType::Comma));
+
+				Expect(ETokenType::RightParen, TEXT("')'"));
+			}
+
+			const int32 MethodIndex = Program.Methods.AddUnique(FName(*Name.Text));
+			if (MethodIndex > MAX_uint8)
+			{
+				Fail(Name, TEXT("fewer distinct methods"));
+				return;
+			}
+
+			Emit(DialogueScript::Encode(EDialogueScriptOp::CallMethod, Base, (uint8)MethodIndex, (uint8)NumArgs));
+			if (Dest != Base)
+			{
+				Emit(DialogueScript::Encode(EDialogueScriptOp::Move, Dest, Base));
+			}
+
+			NextRegister = Base;
+		}
+
+		// ---- Constant folding ----
+
+		/** The value the code from Start on loads into Register, false unless that code is a single bool or int constant */
+		bool GetConstant(int32 Start, uint8 Register, FDialogueScriptValue& OutValue) const
+		{
+			if (Program.Code.Num() != Start + 1 || DialogueScript::GetA(Program.Code[Start]) != Register)
+			{
+				return false;
+			}
+
+			const uint32 Instruction = Program.Code[Start];
+			switch (DialogueScript::GetOp(Instruction))
+			{
+			case EDialogueScriptOp::LoadBool:
+				OutValue = FDialogueScriptValue::MakeBool(DialogueScript::GetB(Instruction) != 0);
+				return true;
+
+			case EDialogueScriptOp::LoadInt:
+				OutValue = FDialogueScriptValue::MakeInt(Program.IntConstants[DialogueScript::GetBx(Instruction)]);
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+		void EmitConstant(uint8 Dest, const FDialogueScriptValue& Value)
+		{
+			if (Value.Type == FDialogueScriptValue::EType::Bool)
+			{
+				Emit(DialogueScript::Encode(EDialogueScriptOp::LoadBool, Dest, Value.Bool ? 1 : 0));
+			}
+			else
+			{
+				Emit(DialogueScript::EncodeBx(EDialogueScriptOp::LoadInt, Dest, AddIntConstant(Value.AsInt())));
+			}
+		}
+
+		/** Apply a binary operator to constants the way the VM would, false if it is left to run, e.g. a division by zero that warns */
+		static bool Fold(EDialogueScriptOp Op, const FDialogueScriptValue& Left, const FDialogueScriptValue& Right, FDialogueScriptValue& OutValue)
+		{
+			using namespace DialogueScript;
+			switch (Op)
+			{
+			case EDialogueScriptOp::Add: OutValue = FDialogueScriptValue::MakeInt(Left.AsInt() + Right.AsInt()); return true;
+			case EDialogueScriptOp::Subtract: OutValue = FDialogueScriptValue::MakeInt(Left.AsInt() - Right.AsInt()); return true;
+			case EDialogueScriptOp::Multiply: OutValue = FDialogueScriptValue::MakeInt(Left.AsInt() * Right.AsInt()); return true;
+			case EDialogueScriptOp::Divide:
+			case EDialogueScriptOp::Modulo:
+				if (Right.AsInt() == 0)
+				{
+					return false;
+				}
+				OutValue = FDialogueScriptValue::MakeInt(Op == EDialogueScriptOp::Divide ? Divide(Left.AsInt(), Right.AsInt()) : Modulo(Left.AsInt(), Right.AsInt()));
+				return true;
+			case EDialogueScriptOp::Equal: OutValue = FDialogueScriptValue::MakeBool(ValuesEqual(Left, Right)); return true;
+			case EDialogueScriptOp::NotEqual: OutValue = FDialogueScriptValue::MakeBool(!ValuesEqual(Left, Right)); return true;
+			case EDialogueScriptOp::Less: OutValue = FDialogueScriptValue::MakeBool(CompareValues(Left, Right) < 0); return true;
+			case EDialogueScriptOp::LessEqual: OutValue = FDialogueScriptValue::MakeBool(CompareValues(Left, Right) <= 0); return true;
+			case EDialogueScriptOp::Greater: OutValue = FDialogueScriptValue::MakeBool(CompareValues(Left, Right) > 0); return true;
+			case EDialogueScriptOp::GreaterEqual: OutValue = FDialogueScriptValue::MakeBool(CompareValues(Left, Right) >= 0); return true;
+			default: return false;
+			}
+		}
+
+		// ---- Program building ----
+
+		int32 Emit(uint32 Instruction)
+		{
+			return Program.Code.Add(Instruction);
+		}
+
+		void PatchJump(int32 JumpIndex)
+		{
+			const int32 Target = Program.Code.Num();
+			if (Target > MAX_uint16)
+			{
+				Error = TEXT("Script is too long");
+				return;
+			}
+			const uint32 Jump = Program.Code[JumpIndex];
+			Program.Code[JumpIndex] = DialogueScript::EncodeBx(DialogueScript::GetOp(Jump), DialogueScript::GetA(Jump), (uint16)Target);
+		}
+
+		uint8 AllocRegister()
+		{
+			if (NextRegister >= DialogueScript::MaxRegisters)
+			{
+				if (Error.IsEmpty())
+				{
+					Error = TEXT("Expression is too deeply nested");
+				}
+				return DialogueScript::MaxRegisters - 1;
+			}
+			const uint8 Register = (uint8)NextRegister++;
+			Program.NumRegisters = FMath::Max<uint8>(Program.NumRegisters, (uint8)NextRegister);
+			return Register;
+		}
+
+		void FreeRegister(uint8 Register)
+		{
+			NextRegister = FMath::Min<int32>(NextRegister, Register);
+		}
+
+		uint16 AddIntConstant(int32 Value)
+		{
+			return CheckIndex(Program.IntConstants.AddUnique(Value));
+		}
+
+		uint16 AddStringConstant(const FString& Value)
+		{
+			return CheckIndex(Program.StringConstants.AddUnique(Value));
+		}
+
+		uint16 AddVariable(const FString& Name)
+		{
+			if (!Name.Contains(TEXT(".")))
+			{
+				Error = FString::Printf(TEXT("Variable '%s' must be written as Namespace.Variable"), *Name);
+			}
+			return CheckIndex(Program.Variables.AddUnique(Name));
+		}
+
+		uint16 CheckIndex(int32 Index)
+		{
+			if (Index > MAX_uint16)
+			{
+				Error = TEXT("Too many constants in script");
+				return 0;
+			}
+			return (uint16)Index;
+		}
+
+		// ---- Token stream ----
+
+		const FToken& Peek(int32 Offset = 0) const
+		{
+			return Tokens[FMath::Min(Current + Offset, Tokens.Num() - 1)];
+		}
+
+		void Advance()
+		{
+			if (Current < Tokens.Num() - 1)
+			{
+				++Current;
+			}
+		}
+
+		bool Accept(ETokenType Type)
+		{
+			if (Peek().Type == Type)
+			{
+				Advance();
+				return true;
+			}
+			return false;
+		}
+
+		void Expect(ETokenType Type, const TCHAR* What)
+		{
+			if (!Accept(Type))
+			{
+				Fail(Peek(), What);
+			}
+		}
+
+		void Fail(const FToken& Token, const TCHAR* Expected)
+		{
+			if (Error.IsEmpty())
+			{
+				Error = FString::Printf(TEXT("Expected %s at %d"), Expected, Token.Position);
+			}
+		}
+
+		const TArray<FToken>& Tokens;
+		FDialogueScriptProgram& Program;
+		int32 Current = 0;
+		int32 NextRegister = 0;
+	};
+
+	/**
+	 * Lowers a condition of only variables, true, false, !, && and || to a disjunction of conjunctions of
+	 * variables or their negation, so it can be tested with masks on the packed bools. Runs on the tokens of
+	 * a condition that compiled, so it only has to recognize the supported subset and give up on the rest.
+	 */
+	class FBoolLowering
+	{
+	public:
+		/** Largest number of terms and of literals per term, larger conditions stay on the VM */
+		static constexpr int32 MaxTerms = 32;
+		static constexpr int32 MaxLiterals = 64;
+
+		FBoolLowering(const TArray<FToken>& InTokens, const FDialogueScriptProgram& InProgram)
+			: Tokens(InTokens), Program(InProgram) {}
+
+		bool Lower(TArray<int32>& OutTerms)
+		{
+			const int32 Root = ParseOr();
+			Accept(ETokenType::Semicolon);
+			if (Root == INDEX_NONE || Tokens[Current].Type != ETokenType::End)
+			{
+				return false;
+			}
+
+			TArray<FTerm> Terms;
+			if (!ToTerms(Root, false, Terms))
+			{
+				return false;
+			}
+
+			OutTerms.Reset();
+			for (const FTerm& Term : Terms)
+			{
+				OutTerms.Append(Term);
+				OutTerms.Add(INDEX_NONE);
+			}
+			return true;
+		}
+
+	private:
+		enum class ENodeKind : uint8
+		{
+			Variable,
+			Constant,
+			Not,
+			And,
+			Or
+		};
+
+		struct FNode
+		{
+			ENodeKind Kind = ENodeKind::Constant;
+			/** Variable index or constant value */
+			int32 Value = 0;
+			int32 Left = INDEX_NONE;
+			int32 Right = INDEX_NONE;
+		};
+
+		/** Sorted literals that must all hold */
+		using FTerm = TArray<int32, TInlineAllocator<8>>;
+
+		int32 ParseOr()
+		{
+			int32 Left = ParseAnd();
+			while (Left != INDEX_NONE && AcceptOperator(TEXT("||")))
+			{
+				Left = AddNode(ENodeKind::Or, 0, Left, ParseAnd());
+			}
+			return Left;
+		}
+
+		int32 ParseAnd()
+		{
+			int32 Left = ParseUnary();
+			while (Left != INDEX_NONE && AcceptOperator(TEXT("&&")))
+			{
+				Left = AddNode(ENodeKind::And, 0, Left, ParseUnary());
+			}
+			return Left;
+		}
+
+		int32 ParseUnary()
+		{
+			if (AcceptOperator(TEXT("!")))
+			{
+				return AddNode(ENodeKind::Not, 0, ParseUnary());
+			}
+
+			const FToken& Token = Tokens[Current];
+			if (Accept(ETokenType::LeftParen))
+			{
+				const int32 Inner = ParseOr();
+				return Accept(ETokenType::RightParen) ? Inner : INDEX_NONE;
+			}
+
+			if (Token.Type != ETokenType::Identifier || Tokens[Current + 1].Type == ETokenType::LeftParen)
+			{
+				return INDEX_NONE;
+			}
+			++Current;
+
+			if (Token.Text == TEXT("true") || Token.Text == TEXT("false"))
+			{
+				return AddNode(ENodeKind::Constant, Token.Text == TEXT("true") ? 1 : 0);
+			}
+			return AddNode(ENodeKind::Variable, Program.Variables.Find(Token.Text));
+		}
+
+		int32 AddNode(ENodeKind Kind, int32 Value, int32 Left = INDEX_NONE, int32 Right = INDEX_NONE)
+		{
+			// Any failed child fails the whole condition
+			const bool bNeedsLeft = Kind == ENodeKind::Not || Kind == ENodeKind::And || Kind == ENodeKind::Or;
+			const bool bNeedsRight = Kind == ENodeKind::And || Kind == ENodeKind::Or;
+			if ((bNeedsLeft && Left == INDEX_NONE) || (bNeedsRight && Right == INDEX_NONE) || (Kind == ENodeKind::Variable && Value == INDEX_NONE))
+			{
+				return INDEX_NONE;
+			}
+			return Nodes.Add(FNode{ Kind, Value, Left, Right });
+		}
+
+		/** The terms of a node, negated by pushing the negation down to the variables */
+		bool ToTerms(int32 NodeIndex, bool bNegate, TArray<FTerm>& OutTerms) const
+		{
+			const FNode& Node = Nodes[NodeIndex];
+			switch (Node.Kind)
+			{
+			case ENodeKind::Variable:
+				OutTerms.AddDefaulted_GetRef().Add(Node.Value * 2 + (bNegate ? 1 : 0));
+				return true;
+
+			case ENodeKind::Constant:
+				if ((Node.Value != 0) != bNegate)
+				{
+					// Always true, a term without literals
+					OutTerms.AddDefaulted();
+				}
+				return true;
+
+			case ENodeKind::Not:
+				return ToTerms(Node.Left, !bNegate, OutTerms);
+
+			default:
+				break;
+			}
+
+			TArray<FTerm> Left;
+			TArray<FTerm> Right;
+			if (!ToTerms(Node.Left, bNegate, Left) || !ToTerms(Node.Right, bNegate, Right))
+			{
+				return false;
+			}
+
+			// !(A && B) is !A || !B and !(A || B) is !A && !B
+			if ((Node.Kind == ENodeKind::Or) != bNegate)
+			{
+				OutTerms.Append(MoveTemp(Left));
+				OutTerms.Append(MoveTemp(Right));
+				return OutTerms.Num() <= MaxTerms;
+			}
+
+			for (const FTerm& LeftTerm : Left)
+			{
+				for (const FTerm& RightTerm : Right)
+				{
+					FTerm Term = LeftTerm;
+					bool bContradicts = false;
+					for (const int32 Literal : RightTerm)
+					{
+						// A variable and its negation never hold together
+						bContradicts |= Term.Contains(Literal ^ 1);
+						Term.AddUnique(Literal);
+					}
+					if (bContradicts)
+					{
+						continue;
+					}
+					if (Term.Num() > MaxLiterals || OutTerms.Num() >= MaxTerms)
+					{
+						return false;
+					}
+					OutTerms.Add(MoveTemp(Term));
+				}
+			}
+			return true;
+		}
+
+		bool Accept(ETokenType Type)
+		{
+			if (Tokens[Current].Type == Type)
+			{
+				++Current;
+				return true;
+			}
+			return false;
+		}
+
+		bool AcceptOperator(const TCHAR* Operator)
+		{
+			if (Tokens[Current].Type == ETokenType::Operator && Tokens[Current].Text == Operator)
+			{
+				++Current;
+				return true;
+			}
+			return false;
+		}
+
+		const TArray<FToken>& Tokens;
+		const FDialogueScriptProgram& Program;
+		TArray<FNode> Nodes;
+		int32 Current = 0;
+	};
+}
+
+bool FDialogueScriptCompiler::Compile(const FString& Expression, bool bIsCondition, FDialogueScriptProgram& OutProgram, FString* OutError)
+{
+	OutProgram.Reset();
+
+	if (Expression.TrimStartAndEnd().IsEmpty())
+	{
+		// Nothing to run: empty conditions pass, empty instructions do nothing
+		return true;
+	}
+
+	FString Error;
+	TArray<FToken> Tokens;
+	FLexer Lexer(Expression);
+
+	if (Lexer.Tokenize(Tokens, Error))
+	{
+		FCodeGen CodeGen(Tokens, OutProgram);
+		if (!(bIsCondition ? CodeGen.CompileCondition() : CodeGen.CompileInstruction()))
+		{
+			Error = CodeGen.Error;
+		}
+		else if (bIsCondition)
+		{
+			// Kept next to the code, which still runs wherever the masks can't be used
+			OutProgram.bHasBoolTerms = FBoolLowering(Tokens, OutProgram).Lower(OutProgram.BoolTerms);
+		}
+	}
+
+	if (!Error.IsEmpty())
+	{
+		OutProgram.Reset();
+		if (OutError)
+		{
+			*OutError = Error;
+		}
+		return false;
+	}
+
+	// A condition left with a constant load and its return, or an instruction left with nothing, need not run at all
+	if (bIsCondition && OutProgram.Code.Num() == 2 && DialogueScript::GetOp(OutProgram.Code[1]) == EDialogueScriptOp::Return
+		&& DialogueScript::GetA(OutProgram.Code[1]) == DialogueScript::GetA(OutProgram.Code[0]))
+	{
+		const uint32 Load = OutProgram.Code[0];
+		if (DialogueScript::GetOp(Load) == EDialogueScriptOp::LoadBool || DialogueScript::GetOp(Load) == EDialogueScriptOp::LoadInt)
+		{
+			OutProgram.bIsConstant = true;
+			OutProgram.bConstantResult = DialogueScript::GetOp(Load) == EDialogueScriptOp::LoadBool
+				? DialogueScript::GetB(Load) != 0
+				: OutProgram.IntConstants[DialogueScript::GetBx(Load)] != 0;
+		}
+	}
+	else if (!bIsCondition && OutProgram.Code.Num() == 1)
+	{
+		OutProgram.bIsConstant = true;
+	}
+
+	// Writes and user methods are the only ways a script can change state
+	OutProgram.bIsPure = true;
+	for (const uint32 Instruction : OutProgram.Code)
+	{
+		const EDialogueScriptOp Op = DialogueScript::GetOp(Instruction);
+		if (Op == EDialogueScriptOp::StoreVar || Op == EDialogueScriptOp::CallMethod)
+		{
+			OutProgram.bIsPure = false;
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool FDialogueScriptCompiler::Compile(FDialogueScript& Script, FString* OutError)
+{
+	return Compile(Script.Expression, Script.bIsCondition, Script.Program, OutError);
+}
+
+int32 FDialogueScriptCompiler::BindVariables(FDialogueScriptProgram& Program, const UDialogueGlobalVariables* GV)
+{
+	Program.VariableSlots.Reset(Program.Variables.Num());
+
+	int32 NumUnresolved = 0;
+	for (const FString& Name : Program.Variables)
+	{
+		const FDialogueVariableSlot Slot = GV ? GV->FindSlot(Name) : FDialogueVariableSlot();
+		if (!Slot.IsValid())
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Script references unknown variable '%s'"), *Name);
+			++NumUnresolved;
+		}
+		Program.VariableSlots.Add(Slot);
+	}
+
+	BuildBoolMasks(Program);
+	return NumUnresolved;
+}
+
+void FDialogueScriptCompiler::BuildBoolMasks(FDialogueScriptProgram& Program)
+{
+	Program.BoolMasks.Reset();
+	Program.bHasBoolMasks = false;
+	if (!Program.bHasBoolTerms)
+	{
+		return;
+	}
+
+	// Each term becomes one mask per word it reads, in word order
+	TSortedMap<int32, FDialogueBoolMask> TermMasks;
+	bool bTermContradicts = false;
+	for (const int32 Literal : Program.BoolTerms)
+	{
+		if (Literal != INDEX_NONE)
+		{
+			const int32 Variable = Literal >> 1;
+			const FDialogueVariableSlot Slot = Program.VariableSlots.IsValidIndex(Variable) ? Program.VariableSlots[Variable] : FDialogueVariableSlot();
+			if (!Slot.IsValid() || Slot.Type != EDialogueVariableType::Boolean)
+			{
+				// Ints and strings convert to bools differently, the VM handles them
+				Program.BoolMasks.Reset();
+				return;
+			}
+
+			FDialogueBoolMask& Mask = TermMasks.FindOrAdd(Slot.Index >> 6);
+			Mask.Word = Slot.Index >> 6;
+			(Literal & 1 ? Mask.MustClear : Mask.MustSet) |= 1ull << (Slot.Index & 63);
+			bTermContradicts |= (Mask.MustSet & Mask.MustClear) != 0;
+			continue;
+		}
+
+		// Two names bound to the same slot can still contradict each other
+		if (!bTermContradicts)
+		{
+			const int32 First = Program.BoolMasks.Num();
+			for (const TPair<int32, FDialogueBoolMask>& Pair : TermMasks)
+			{
+				Program.BoolMasks.Add(Pair.Value);
+			}
+			if (First == Program.BoolMasks.Num())
+			{
+				Program.BoolMasks.AddDefaulted();
+			}
+			Program.BoolMasks.Last().bEndsTerm = true;
+		}
+		TermMasks.Reset();
+		bTermContradicts = false;
+	}
+
+	Program.bHasBoolMasks = true;
+}
+
+namespace
+{
+	bool IsSameCondition(const FDialogueScriptProgram& Left, const FDialogueScriptProgram& Right)
+	{
+		return &Left == &Right || (Left.Code == Right.Code && Left.IntConstants == Right.IntConstants
+			&& Left.StringConstants == Right.StringConstants && Left.Variables == Right.Variables);
+	}
+
+	/** Most terms the bool terms of fused conditions multiply out to, beyond it only the code runs */
+	constexpr int32 MaxFusedTerms = 32;
+}
+
+bool FDialogueScriptCompiler::FuseConditions(TConstArrayView<const FDialogueScriptProgram*> Conditions, FDialogueScriptProgram& OutProgram)
+{
+	using namespace DialogueScript;
+	OutProgram.Reset();
+
+	TArray<const FDialogueScriptProgram*, TInlineAllocator<8>> Parts;
+	for (const FDialogueScriptProgram* Condition : Conditions)
+	{
+		// Empty conditions pass
+		if (!Condition || !Condition->IsCompiled())
+		{
+			continue;
+		}
+		if (!Condition->bIsPure)
+		{
+			return false;
+		}
+		if (!Parts.ContainsByPredicate([Condition](const FDialogueScriptProgram* Part) { return IsSameCondition(*Part, *Condition); }))
+		{
+			Parts.Add(Condition);
+		}
+	}
+
+	bool bBound = true;
+	OutProgram.bHasBoolTerms = true;
+	for (const FDialogueScriptProgram* Part : Parts)
+	{
+		bBound &= Part->VariableSlots.Num() == Part->Variables.Num();
+		OutProgram.bHasBoolTerms &= Part->bHasBoolTerms;
+	}
+
+	// The conjunction of the parts' terms, starting from a term without literals, which always holds
+	TArray<TArray<int32>> Terms;
+	Terms.AddDefaulted();
+
+	TArray<int32, TInlineAllocator<8>> FailJumps;
+	TArray<int32, TInlineAllocator<16>> IntMap;
+	TArray<int32, TInlineAllocator<16>> StringMap;
+	TArray<int32, TInlineAllocator<16>> VariableMap;
+	for (const FDialogueScriptProgram* Part : Parts)
+	{
+		IntMap.Reset();
+		for (const int32 Value : Part->IntConstants)
+		{
+			IntMap.Add(OutProgram.IntConstants.AddUnique(Value));
+		}
+		StringMap.Reset();
+		for (const FString& Value : Part->StringConstants)
+		{
+			StringMap.Add(OutProgram.StringConstants.AddUnique(Value));
+		}
+		VariableMap.Reset();
+		for (int32 i = 0; i < Part->Variables.Num(); ++i)
+		{
+			const int32 Index = OutProgram.Variables.AddUnique(Part->Variables[i]);
+			if (bBound && Index == OutProgram.VariableSlots.Num())
+			{
+				OutProgram.VariableSlots.Add(Part->VariableSlots[i]);
+			}
+			VariableMap.Add(Index);
+		}
+
+		// Instructions map one to one, so jumps inside the part only move by where it starts
+		const int32 Base = OutProgram.Code.Num();
+		for (int32 PC = 0; PC < Part->Code.Num(); ++PC)
+		{
+			const uint32 Instruction = Part->Code[PC];
+			const EDialogueScriptOp Op = GetOp(Instruction);
+			switch (Op)
+			{
+			case EDialogueScriptOp::LoadInt:
+				OutProgram.Code.Add(EncodeBx(Op, GetA(Instruction), (uint16)IntMap[GetBx(Instruction)]));
+				break;
+
+			case EDialogueScriptOp::LoadString:
+				OutProgram.Code.Add(EncodeBx(Op, GetA(Instruction), (uint16)StringMap[GetBx(Instruction)]));
+				break;
+
+			case EDialogueScriptOp::LoadVar:
+				OutProgram.Code.Add(EncodeBx(Op, GetA(Instruction), (uint16)VariableMap[GetBx(Instruction)]));
+				break;
+
+			case EDialogueScriptOp::Jump:
+			case EDialogueScriptOp::JumpIfFalse:
+			case EDialogueScriptOp::JumpIfTrue:
+				OutProgram.Code.Add(EncodeBx(Op, GetA(Instruction), (uint16)(Base + GetBx(Instruction))));
+				break;
+
+			case EDialogueScriptOp::Return:
+				// The compiler ends conditions with their only return, a failing part skips the rest
+				if (PC != Part->Code.Num() - 1)
+				{
+					OutProgram.Reset();
+					return false;
+				}
+				FailJumps.Add(OutProgram.Code.Num());
+				OutProgram.Code.Add(EncodeBx(EDialogueScriptOp::JumpIfFalse, GetA(Instruction), 0));
+				break;
+
+			case EDialogueScriptOp::StoreVar:
+			case EDialogueScriptOp::CallMethod:
+			case EDialogueScriptOp::ReturnNone:
+				OutProgram.Reset();
+				return false;
+
+			default:
+				OutProgram.Code.Add(Instruction);
+				break;
+			}
+		}
+		OutProgram.NumRegisters = FMath::Max(OutProgram.NumRegisters, Part->NumRegisters);
+
+		if (!OutProgram.bHasBoolTerms)
+		{
+			continue;
+		}
+
+		// (A || B) && (C || D) is A && C || A && D || B && C || B && D
+		TArray<TArray<int32>> Product;
+		TArray<int32> PartTerm;
+		for (const int32 Literal : Part->BoolTerms)
+		{
+			if (Literal != INDEX_NONE)
+			{
+				PartTerm.Add(VariableMap[Literal >> 1] * 2 + (Literal & 1));
+				continue;
+			}
+			for (const TArray<int32>& Term : Terms)
+			{
+				TArray<int32> Combined = Term;
+				bool bContradicts = false;
+				for (const int32 PartLiteral : PartTerm)
+				{
+					bContradicts |= Combined.Contains(PartLiteral ^ 1);
+					Combined.AddUnique(PartLiteral);
+				}
+				if (!bContradicts)
+				{
+					Product.Add(MoveTemp(Combined));
+				}
+			}
+			PartTerm.Reset();
+		}
+		Terms = MoveTemp(Product);
+		OutProgram.bHasBoolTerms = Terms.Num() <= MaxFusedTerms;
+	}
+
+	// Passing every part ends true, the failure end follows
+	OutProgram.Code.Add(Encode(EDialogueScriptOp::LoadBool, 0, 1));
+	OutProgram.Code.Add(Encode(EDialogueScriptOp::Return, 0));
+	const int32 Fail = OutProgram.Code.Num();
+	OutProgram.Code.Add(Encode(EDialogueScriptOp::LoadBool, 0, 0));
+	OutProgram.Code.Add(Encode(EDialogueScriptOp::Return, 0));
+
+	if (OutProgram.Code.Num() > MAX_uint16 || OutProgram.IntConstants.Num() > MAX_uint16
+		|| OutProgram.StringConstants.Num() > MAX_uint16 || OutProgram.Variables.Num() > MAX_uint16)
+	{
+		OutProgram.Reset();
+		return false;
+	}
+	for (const int32 Jump : FailJumps)
+	{
+		OutProgram.Code[Jump] = EncodeBx(EDialogueScriptOp::JumpIfFalse, GetA(OutProgram.Code[Jump]), (uint16)Fail);
+	}
+
+	OutProgram.NumRegisters = FMath::Max<uint8>(OutProgram.NumRegisters, 1);
+	OutProgram.bIsPure = true;
+
+	if (OutProgram.bHasBoolTerms)
+	{
+		for (const TArray<int32>& Term : Terms)
+		{
+			OutProgram.BoolTerms.Append(Term);
+			OutProgram.BoolTerms.Add(INDEX_NONE);
+		}
+	}
+	if (bBound)
+	{
+		BuildBoolMasks(OutProgram);
+	}
+	return true;
+}
+
+bool FDialogueScript::EnsureCompiled()
+{
+	if (IsEmpty())
+	{
+		return true;
+	}
+
+	if (!Program.IsCompiled())
+	{
+		FString Error;
+		if (!FDialogueScriptCompiler::Compile(*this, &Error))
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Failed to compile script '%s': %s"), *Expression, *Error);
+			return false;
+		}
+	}
+
+	// Stale generated code is skipped, the script then runs on the VM
+	Program.Native = UDialogueScripts::FindNative(*this);
+	return true;
+}
@@ -0,0 +1,156 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueScriptProfiler.h"
+#include "DialogueNode.h"
+#include "DialoguePin.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueScripts.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/UObjectIterator.h"
+
+std::atomic<bool> FDialogueScriptProfiler::bEnabled{ false };
+
+namespace
+{
+	FCriticalSection RecordsLock;
+	TMap<const FDialogueScriptProgram*, FDialogueScriptProfiler::FRecord> Records;
+
+	struct FScriptSite
+	{
+		const FDialogueScript* Script = nullptr;
+		const UDialogueObject* Object = nullptr;
+	};
+
+	template<typename ObjectType>
+	void AddSites(TMap<const FDialogueScriptProgram*, FScriptSite>& Sites)
+	{
+		for (TObjectIterator<ObjectType> It; It; ++It)
+		{
+			Sites.Add(&It->Script.Program, { &It->Script, *It });
+		}
+	}
+
+	FString DescribeOwner(const UDialogueObject* Object)
+	{
+		const UDialoguePin* Pin = Cast<UDialoguePin>(Object);
+		const UDialogueObject* Owner = Pin && Pin->GetOwner() ? Pin->GetOwner() : Object;
+		const FString Name = Owner->TechnicalName.IsEmpty() ? Owner->GetName() : Owner->TechnicalName;
+		return FString::Printf(TEXT("%s (%s)"), *Name, *Owner->Id.ToString());
+	}
+
+	FString EscapeCsv(const FString& Value)
+	{
+		return TEXT("\"") + Value.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+	}
+
+	FAutoConsoleCommand StartCommand(
+		TEXT("Dialogue.ScriptProfiler.Start"),
+		TEXT("Start timing dialogue script conditions and instructions."),
+		FConsoleCommandDelegate::CreateLambda([]() { FDialogueScriptProfiler::SetEnabled(true); }));
+
+	FAutoConsoleCommand StopCommand(
+		TEXT("Dialogue.ScriptProfiler.Stop"),
+		TEXT("Stop timing dialogue scripts, the records are kept."),
+		FConsoleCommandDelegate::CreateLambda([]() { FDialogueScriptProfiler::SetEnabled(false); }));
+
+	FAutoConsoleCommand ResetCommand(
+		TEXT("Dialogue.ScriptProfiler.Reset"),
+		TEXT("Forget the records of the dialogue script profiler."),
+		FConsoleCommandDelegate::CreateLambda([]() { FDialogueScriptProfiler::Reset(); }));
+
+	FAutoConsoleCommand DumpCommand(
+		TEXT("Dialogue.ScriptProfiler.Dump"),
+		TEXT("Log the most expensive dialogue scripts and write all records as CSV. Optional argument: the file to write."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const TArray<FDialogueScriptProfiler::FResolvedRecord> Resolved = FDialogueScriptProfiler::Resolve();
+			for (int32 i = 0; i < FMath::Min(Resolved.Num(), 10); ++i)
+			{
+				const FDialogueScriptProfiler::FResolvedRecord& Record = Resolved[i];
+				UE_LOG(LogDialogueRuntime, Display, TEXT("%8.3fms total %8.3fms max x%lld  %s: %s"), Record.TotalSeconds * 1000.0,
+					Record.MaxSeconds * 1000.0, Record.Calls, *Record.Owner, *Record.Expression);
+			}
+
+			const FString Path = FDialogueScriptProfiler::DumpCsv(Args.Num() > 0 ? Args[0] : FString());
+			if (!Path.IsEmpty())
+			{
+				UE_LOG(LogDialogueRuntime, Display, TEXT("Wrote %d script profiler records to %s"), Resolved.Num(), *Path);
+			}
+		}));
+}
+
+void FDialogueScriptProfiler::Reset()
+{
+	FScopeLock Lock(&RecordsLock);
+	Records.Reset();
+}
+
+void FDialogueScriptProfiler::Record(const FDialogueScriptProgram* Program, bool bInstruction, double Seconds)
+{
+	FScopeLock Lock(&RecordsLock);
+	FRecord& Record = Records.FindOrAdd(Program);
+	++Record.Calls;
+	Record.TotalSeconds += Seconds;
+	Record.MaxSeconds = FMath::Max(Record.MaxSeconds, Seconds);
+	Record.bInstruction = bInstruction;
+}
+
+TArray<FDialogueScriptProfiler::FResolvedRecord> FDialogueScriptProfiler::Resolve()
+{
+	check(IsInGameThread());
+
+	// Programs live in the scripts of these objects, a freed program's record has no site left
+	TMap<const FDialogueScriptProgram*, FScriptSite> Sites;
+	AddSites<UDialogueCondition>(Sites);
+	AddSites<UDialogueInstruction>(Sites);
+	AddSites<UDialogueInputPin>(Sites);
+	AddSites<UDialogueOutputPin>(Sites);
+
+	TArray<FResolvedRecord> Resolved;
+	{
+		FScopeLock Lock(&RecordsLock);
+		for (const TPair<const FDialogueScriptProgram*, FRecord>& Pair : Records)
+		{
+			const FScriptSite* Site = Sites.Find(Pair.Key);
+			if (!Site)
+			{
+				continue;
+			}
+
+			FResolvedRecord& Record = Resolved.AddDefaulted_GetRef();
+			static_cast<FRecord&>(Record) = Pair.Value;
+			Record.Expression = Site->Script->Expression;
+			Record.Owner = DescribeOwner(Site->Object);
+			Record.Hash = UDialogueScripts::HashScript(*Site->Script);
+		}
+	}
+
+	Resolved.Sort([](const FResolvedRecord& A, const FResolvedRecord& B) { return A.TotalSeconds > B.TotalSeconds; });
+	return Resolved;
+}
+
+FString FDialogueScriptProfiler::DumpCsv(const FString& Path)
+{
+	const FString FilePath = Path.IsEmpty()
+		? FPaths::ProfilingDir() / FString::Printf(TEXT("DialogueScripts-%s.csv"), *FDateTime::Now().ToString())
+		: Path;
+
+	FString Csv = TEXT("Kind,Hash,Calls,TotalMs,MaxMs,AverageUs,Owner,Expression\n");
+	for (const FResolvedRecord& Record : Resolve())
+	{
+		Csv += FString::Printf(TEXT("%s,%u,%lld,%.4f,%.4f,%.3f,%s,%s\n"), Record.bInstruction ? TEXT("Instruction") : TEXT("Condition"),
+			Record.Hash, Record.Calls, Record.TotalSeconds * 1000.0, Record.MaxSeconds * 1000.0,
+			Record.Calls > 0 ? Record.TotalSeconds * 1000000.0 / Record.Calls : 0.0, *EscapeCsv(Record.Owner), *EscapeCsv(Record.Expression));
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *FilePath))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Failed to write the script profiler records to %s"), *FilePath);
+		return FString();
+	}
+	return FilePath;
+}
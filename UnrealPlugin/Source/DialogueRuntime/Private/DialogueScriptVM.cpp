@@ -0,0 +1,490 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueScriptVM.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueRuntimeModule.h"
+#include "DialogueRuntimeStats.h"
+#include "DialogueScriptProfiler.h"
+#include "UObject/UnrealType.h"
+
+bool DialogueScript::ValuesEqual(const FDialogueScriptValue& Left, const FDialogueScriptValue& Right)
+{
+	if (Left.IsString() || Right.IsString())
+	{
+		return Left.AsString().Equals(Right.AsString(), ESearchCase::CaseSensitive);
+	}
+	return Left.AsInt() == Right.AsInt();
+}
+
+int32 DialogueScript::CompareValues(const FDialogueScriptValue& Left, const FDialogueScriptValue& Right)
+{
+	if (Left.IsString() || Right.IsString())
+	{
+		return Left.AsString().Compare(Right.AsString(), ESearchCase::CaseSensitive);
+	}
+	const int32 L = Left.AsInt();
+	const int32 R = Right.AsInt();
+	return L < R ? -1 : (L > R ? 1 : 0);
+}
+
+int32 DialogueScript::Divide(int32 Dividend, int32 Divisor)
+{
+	if (Divisor == 0)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Division by zero in dialogue script"));
+		return 0;
+	}
+	return Dividend / Divisor;
+}
+
+int32 DialogueScript::Modulo(int32 Dividend, int32 Divisor)
+{
+	if (Divisor == 0)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Division by zero in dialogue script"));
+		return 0;
+	}
+	return Dividend % Divisor;
+}
+
+namespace
+{
+	/** Slot of a program variable; bound slots are used as is, unbound ones are resolved by name */
+	template<typename VariablesType>
+	FDialogueVariableSlot ResolveSlot(const FDialogueScriptProgram& Program, VariablesType* GV, int32 Index)
+	{
+		if (Program.VariableSlots.IsValidIndex(Index) && GV->IsValidSlot(Program.VariableSlots[Index]))
+		{
+			return Program.VariableSlots[Index];
+		}
+		return GV->FindSlot(Program.Variables[Index]);
+	}
+
+	template<typename VariablesType>
+	FDialogueScriptValue ReadVariable(const FDialogueScriptProgram& Program, VariablesType* GV, int32 Index)
+	{
+		const FDialogueVariableSlot Slot = GV ? ResolveSlot(Program, GV, Index) : FDialogueVariableSlot();
+		if (GV && GV->IsValidSlot(Slot))
+		{
+			switch (Slot.Type)
+			{
+			case EDialogueVariableType::Boolean: return FDialogueScriptValue::MakeBool(GV->GetBool(Slot));
+			case EDialogueVariableType::Integer: return FDialogueScriptValue::MakeInt(GV->GetInt(Slot));
+			case EDialogueVariableType::String: return FDialogueScriptValue::MakeString(&GV->GetString(Slot));
+			default: break;
+			}
+		}
+
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Script reads unknown variable '%s'"), *Program.Variables[Index]);
+		return FDialogueScriptValue();
+	}
+
+	template<typename VariablesType>
+	void WriteVariable(const FDialogueScriptProgram& Program, VariablesType* GV, int32 Index, const FDialogueScriptValue& Value)
+	{
+		const FDialogueVariableSlot Slot = GV ? ResolveSlot(Program, GV, Index) : FDialogueVariableSlot();
+		if (GV && GV->IsValidSlot(Slot))
+		{
+			switch (Slot.Type)
+			{
+			case EDialogueVariableType::Boolean: GV->SetBool(Slot, Value.AsBool()); return;
+			case EDialogueVariableType::Integer: GV->SetInt(Slot, Value.AsInt()); return;
+			case EDialogueVariableType::String: GV->SetString(Slot, Value.AsString()); return;
+			default: break;
+			}
+		}
+
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Script writes unknown variable '%s'"), *Program.Variables[Index]);
+	}
+
+	void RecordUntrackedRead(UDialogueGlobalVariables* GV)
+	{
+		if (GV)
+		{
+			// The result depends on game state the variable set knows nothing about
+			GV->RecordUntrackedRead();
+		}
+	}
+
+	void RecordUntrackedRead(FDialogueVariableOverlay* Overlay)
+	{
+	}
+}
+
+FDialogueScriptValue FDialogueScriptContext::ReadVariable(int32 Index) const
+{
+	return Overlay ? ::ReadVariable(Program, Overlay, Index) : ::ReadVariable(Program, GV, Index);
+}
+
+void FDialogueScriptContext::WriteVariable(int32 Index, const FDialogueScriptValue& Value) const
+{
+	if (Overlay)
+	{
+		::WriteVariable(Program, Overlay, Index, Value);
+	}
+	else
+	{
+		::WriteVariable(Program, GV, Index, Value);
+	}
+}
+
+FDialogueScriptValue FDialogueScriptContext::CallMethod(int32 Method, const FDialogueScriptValue* Args, int32 NumArgs) const
+{
+	if (Overlay)
+	{
+		RecordUntrackedRead(Overlay);
+	}
+	else
+	{
+		RecordUntrackedRead(GV);
+	}
+	return FDialogueScriptVM::CallMethod(Program.Methods[Method], MethodProvider, Args, NumArgs);
+}
+
+FDialogueScriptValue FDialogueScriptVM::Run(const FDialogueScriptProgram& Program, UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	if (Program.Native)
+	{
+		return Program.Native(FDialogueScriptContext{ Program, GV, nullptr, MethodProvider });
+	}
+	return RunProgram(Program, GV, MethodProvider);
+}
+
+FDialogueScriptValue FDialogueScriptVM::Run(const FDialogueScriptProgram& Program, FDialogueVariableOverlay& Variables, UObject* MethodProvider)
+{
+	if (Program.Native)
+	{
+		return Program.Native(FDialogueScriptContext{ Program, nullptr, &Variables, MethodProvider });
+	}
+	return RunProgram(Program, &Variables, MethodProvider);
+}
+
+template<typename VariablesType>
+FDialogueScriptValue FDialogueScriptVM::RunProgram(const FDialogueScriptProgram& Program, VariablesType* GV, UObject* MethodProvider)
+{
+	using namespace DialogueScript;
+
+	if (!Program.IsCompiled() || !ensure(Program.NumRegisters <= MaxRegisters))
+	{
+		return FDialogueScriptValue();
+	}
+
+	FDialogueScriptValue R[MaxRegisters];
+
+	const uint32* Code = Program.Code.GetData();
+	const int32 NumInstructions = Program.Code.Num();
+	int32 PC = 0;
+
+	while (PC < NumInstructions)
+	{
+		const uint32 I = Code[PC++];
+		const uint8 A = GetA(I);
+
+		switch (GetOp(I))
+		{
+		case EDialogueScriptOp::LoadInt:
+			R[A] = FDialogueScriptValue::MakeInt(Program.IntConstants[GetBx(I)]);
+			break;
+
+		case EDialogueScriptOp::LoadBool:
+			R[A] = FDialogueScriptValue::MakeBool(GetB(I) != 0);
+			break;
+
+		case EDialogueScriptOp::LoadString:
+			R[A] = FDialogueScriptValue::MakeString(&Program.StringConstants[GetBx(I)]);
+			break;
+
+		case EDialogueScriptOp::LoadVar:
+			R[A] = ReadVariable(Program, GV, GetBx(I));
+			break;
+
+		case EDialogueScriptOp::StoreVar:
+			WriteVariable(Program, GV, GetBx(I), R[A]);
+			break;
+
+		case EDialogueScriptOp::Move:
+			R[A] = R[GetB(I)];
+			break;
+
+		case EDialogueScriptOp::Not:
+			R[A] = FDialogueScriptValue::MakeBool(!R[GetB(I)].AsBool());
+			break;
+
+		case EDialogueScriptOp::Negate:
+			R[A] = FDialogueScriptValue::MakeInt(-R[GetB(I)].AsInt());
+			break;
+
+		case EDialogueScriptOp::Add:
+			R[A] = FDialogueScriptValue::MakeInt(R[GetB(I)].AsInt() + R[GetC(I)].AsInt());
+			break;
+
+		case EDialogueScriptOp::Subtract:
+			R[A] = FDialogueScriptValue::MakeInt(R[GetB(I)].AsInt() - R[GetC(I)].AsInt());
+			break;
+
+		case EDialogueScriptOp::Multiply:
+			R[A] = FDialogueScriptValue::MakeInt(R[GetB(I)].AsInt() * R[GetC(I)].AsInt());
+			break;
+
+		case EDialogueScriptOp::Divide:
+			R[A] = FDialogueScriptValue::MakeInt(Divide(R[GetB(I)].AsInt(), R[GetC(I)].AsInt()));
+			break;
+
+		case EDialogueScriptOp::Modulo:
+			R[A] = FDialogueScriptValue::MakeInt(Modulo(R[GetB(I)].AsInt(), R[GetC(I)].AsInt()));
+			break;
+
+		case EDialogueScriptOp::Equal:
+			R[A] = FDialogueScriptValue::MakeBool(ValuesEqual(R[GetB(I)], R[GetC(I)]));
+			break;
+
+		case EDialogueScriptOp::NotEqual:
+			R[A] = FDialogueScriptValue::MakeBool(!ValuesEqual(R[GetB(I)], R[GetC(I)]));
+			break;
+
+		case EDialogueScriptOp::Less:
+			R[A] = FDialogueScriptValue::MakeBool(CompareValues(R[GetB(I)], R[GetC(I)]) < 0);
+			break;
+
+		case EDialogueScriptOp::LessEqual:
+			R[A] = FDialogueScriptValue::MakeBool(CompareValues(R[GetB(I)], R[GetC(I)]) <= 0);
+			break;
+
+		case EDialogueScriptOp::Greater:
+			R[A] = FDialogueScriptValue::MakeBool(CompareValues(R[GetB(I)], R[GetC(I)]) > 0);
+			break;
+
+		case EDialogueScriptOp::GreaterEqual:
+			R[A] = FDialogueScriptValue::MakeBool(CompareValues(R[GetB(I)], R[GetC(I)]) >= 0);
+			break;
+
+		case EDialogueScriptOp::ToBool:
+			R[A] = FDialogueScriptValue::MakeBool(R[GetB(I)].AsBool());
+			break;
+
+		case EDialogueScriptOp::Jump:
+			PC = GetBx(I);
+			break;
+
+		case EDialogueScriptOp::JumpIfFalse:
+			if (!R[A].AsBool())
+			{
+				PC = GetBx(I);
+			}
+			break;
+
+		case EDialogueScriptOp::JumpIfTrue:
+			if (R[A].AsBool())
+			{
+				PC = GetBx(I);
+			}
+			break;
+
+		case EDialogueScriptOp::CallMethod:
+			RecordUntrackedRead(GV);
+			R[A] = CallMethod(Program.Methods[GetB(I)], MethodProvider, &R[A + 1], GetC(I));
+			break;
+
+		case EDialogueScriptOp::Return:
+			return R[A];
+
+		case EDialogueScriptOp::ReturnNone:
+			return FDialogueScriptValue();
+
+		default:
+			checkNoEntry();
+			return FDialogueScriptValue();
+		}
+	}
+
+	return FDialogueScriptValue();
+}
+
+bool FDialogueScriptVM::EvaluateCondition(const FDialogueScriptProgram& Program, UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	if (!Program.IsCompiled())
+	{
+		return true;
+	}
+
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueEvaluate);
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ConditionsEvaluated);
+	FDialogueScriptProfileScope ProfileScope(Program, false);
+
+	bool bResult = false;
+	if (TestBoolMasks(Program, GV, bResult))
+	{
+		return bResult;
+	}
+	return Run(Program, GV, MethodProvider).AsBool();
+}
+
+void FDialogueScriptVM::EvaluateConditions(TArrayView<const FDialogueScriptProgram* const> Programs, UDialogueGlobalVariables* GV, UObject* MethodProvider, TArrayView<bool> OutResults)
+{
+	check(Programs.Num() == OutResults.Num());
+
+	// Mask tests first, in one pass over the bool words without the overhead of a run each
+	TBitArray<TInlineAllocator<4>> NeedsRun(false, Programs.Num());
+	if (!FDialogueScriptProfiler::IsEnabled())
+	{
+		DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueEvaluate);
+
+		int32 NumTested = 0;
+		for (int32 Index = 0; Index < Programs.Num(); ++Index)
+		{
+			const FDialogueScriptProgram* Program = Programs[Index];
+			if (!Program || !Program->IsCompiled())
+			{
+				OutResults[Index] = true;
+			}
+			else if (TestBoolMasks(*Program, GV, OutResults[Index]))
+			{
+				++NumTested;
+			}
+			else
+			{
+				NeedsRun[Index] = true;
+			}
+		}
+		FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ConditionsEvaluated, NumTested);
+	}
+	else
+	{
+		// Profiled one by one, so each condition gets its own record
+		NeedsRun.Init(true, Programs.Num());
+	}
+
+	// Masks only exist for conditions without side effects, so the others still run in order
+	for (TConstSetBitIterator<TInlineAllocator<4>> It(NeedsRun); It; ++It)
+	{
+		const FDialogueScriptProgram* Program = Programs[It.GetIndex()];
+		OutResults[It.GetIndex()] = !Program || EvaluateCondition(*Program, GV, MethodProvider);
+	}
+}
+
+bool FDialogueScriptVM::TestBoolMasks(const FDialogueScriptProgram& Program, const UDialogueGlobalVariables* GV, bool& bOutResult)
+{
+	if (!Program.bHasBoolMasks || !GV)
+	{
+		return false;
+	}
+
+	// Every term is tested, a branch per term would cost more than the few words they read
+	const TArrayView<const uint64> Words = GV->GetBoolWords();
+	bool bTermPasses = true;
+	bOutResult = false;
+	for (const FDialogueBoolMask& Mask : Program.BoolMasks)
+	{
+		if (Mask.Word != INDEX_NONE)
+		{
+			if (Mask.Word >= Words.Num())
+			{
+				// Bound to another variable set, the code resolves the variables by name
+				return false;
+			}
+			GV->RecordBoolReads(Mask.Word, Mask.MustSet | Mask.MustClear);
+			bTermPasses &= Mask.Test(Words[Mask.Word]);
+		}
+		if (Mask.bEndsTerm)
+		{
+			bOutResult |= bTermPasses;
+			bTermPasses = true;
+		}
+	}
+	return true;
+}
+
+void FDialogueScriptVM::ExecuteInstruction(const FDialogueScriptProgram& Program, UDialogueGlobalVariables* GV, UObject* MethodProvider)
+{
+	if (Program.IsCompiled())
+	{
+		DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueExecute);
+		FDialogueScriptProfileScope ProfileScope(Program, true);
+		Run(Program, GV, MethodProvider);
+	}
+}
+
+bool FDialogueScriptVM::EvaluateCondition(const FDialogueScriptProgram& Program, FDialogueVariableOverlay& Variables, UObject* MethodProvider)
+{
+	if (!Program.IsCompiled())
+	{
+		return true;
+	}
+
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueEvaluate);
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::ConditionsEvaluated);
+	FDialogueScriptProfileScope ProfileScope(Program, false);
+	return Run(Program, Variables, MethodProvider).AsBool();
+}
+
+void FDialogueScriptVM::ExecuteInstruction(const FDialogueScriptProgram& Program, FDialogueVariableOverlay& Variables, UObject* MethodProvider)
+{
+	if (Program.IsCompiled())
+	{
+		DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueExecute);
+		FDialogueScriptProfileScope ProfileScope(Program, true);
+		Run(Program, Variables, MethodProvider);
+	}
+}
+
+FDialogueScriptValue FDialogueScriptVM::CallMethod(FName Method, UObject* MethodProvider, const FDialogueScriptValue* Args, int32 NumArgs)
+{
+	UFunction* Function = MethodProvider ? MethodProvider->FindFunction(Method) : nullptr;
+	if (!Function)
+	{
+		UE_LOG(LogDialogueRuntime, Warning, TEXT("Script calls unknown method '%s'"), *Method.ToString());
+		return FDialogueScriptValue();
+	}
+
+	// Parameters live on the stack, same as a Blueprint call frame
+	uint8* Parms = (uint8*)FMemory_Alloca_Aligned(FMath::Max<int32>(Function->ParmsSize, 1), Function->GetMinAlignment());
+	FMemory::Memzero(Parms, Function->ParmsSize);
+
+	int32 ArgIndex = 0;
+	for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+	{
+		FProperty* Param = *It;
+		Param->InitializeValue_InContainer(Parms);
+
+		if (Param->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm) || ArgIndex >= NumArgs)
+		{
+			continue;
+		}
+
+		const FDialogueScriptValue& Arg = Args[ArgIndex++];
+		if (FBoolProperty* BoolParam = CastField<FBoolProperty>(Param))
+		{
+			BoolParam->SetPropertyValue_InContainer(Parms, Arg.AsBool());
+		}
+		else if (FIntProperty* IntParam = CastField<FIntProperty>(Param))
+		{
+			IntParam->SetPropertyValue_InContainer(Parms, Arg.AsInt());
+		}
+		else if (FStrProperty* StrParam = CastField<FStrProperty>(Param))
+		{
+			StrParam->SetPropertyValue_InContainer(Parms, Arg.AsString());
+		}
+	}
+
+	MethodProvider->ProcessEvent(Function, Parms);
+
+	FDialogueScriptValue Result;
+	if (FProperty* ReturnParam = Function->GetReturnProperty())
+	{
+		if (FBoolProperty* BoolReturn = CastField<FBoolProperty>(ReturnParam))
+		{
+			Result = FDialogueScriptValue::MakeBool(BoolReturn->GetPropertyValue_InContainer(Parms));
+		}
+		else if (FIntProperty* IntReturn = CastField<FIntProperty>(ReturnParam))
+		{
+			Result = FDialogueScriptValue::MakeInt(IntReturn->GetPropertyValue_InContainer(Parms));
+		}
+	}
+
+	for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+	{
+		It->DestroyValue_InContainer(Parms);
+	}
+
+	return Result;
+}
@@ -0,0 +1,52 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueScripts.h"
+#include "Misc/Crc.h"
+
+const UDialogueScripts* UDialogueScripts::Active = nullptr;
+
+UDialogueScripts::UDialogueScripts()
+{
+	// Native classes get their default object when their module loads, before any asset binds scripts
+	if (HasAnyFlags(RF_ClassDefaultObject) && !GetClass()->HasAnyClassFlags(CLASS_Abstract))
+	{
+		Active = this;
+	}
+}
+
+void UDialogueScripts::BeginDestroy()
+{
+	if (Active == this)
+	{
+		Active = nullptr;
+	}
+
+	Super::BeginDestroy();
+}
+
+FDialogueNativeScript UDialogueScripts::FindNative(const FDialogueScript& Script)
+{
+	if (!Active || !Active->Natives.IsValidIndex(Script.NativeIndex))
+	{
+		return nullptr;
+	}
+
+	const FNativeEntry& Entry = Active->Natives[Script.NativeIndex];
+	return Entry.Hash == HashScript(Script) ? Entry.Function : nullptr;
+}
+
+uint32 UDialogueScripts::HashScript(const FDialogueScript& Script)
+{
+	// Native code reads the program's tables by index, so the bytecode must match as well
+	const TArray<uint32>& Code = Script.Program.Code;
+	uint32 Hash = Script.GetExpressionHash();
+	Hash = FCrc::MemCrc32(Code.GetData(), Code.Num() * sizeof(uint32), Hash);
+	return HashCombine(Hash, Script.bIsCondition ? 1 : 0);
+}
+
+void UDialogueScripts::AddNative(FDialogueNativeScript Function, uint32 Hash)
+{
+	FNativeEntry& Entry = Natives.AddDefaulted_GetRef();
+	Entry.Function = Function;
+	Entry.Hash = Hash;
+}
@@ -0,0 +1,327 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueSessionPool.h"
+#include "DialogueObjectIndex.h"
+#include "DialogueRuntimeStats.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	/** Returned for a string slot that does not exist */
+	const FString EmptyString;
+
+	bool SlotLess(const FDialogueVariableSlot& A, const FDialogueVariableSlot& B)
+	{
+		return A.Type != B.Type ? (uint8)A.Type < (uint8)B.Type : A.Index < B.Index;
+	}
+}
+
+// ==================== SESSION ====================
+
+int32 FDialogueSession::GetSeenCounter(int32 Node) const
+{
+	const int32 Found = Algo::LowerBoundBy(Seen, Node, &FDialogueSessionSeen::Node);
+	return Seen.IsValidIndex(Found) && Seen[Found].Node == Node ? Seen[Found].Count : 0;
+}
+
+const FDialogueSessionWrite* FDialogueSession::FindWrite(const FDialogueVariableSlot& Slot) const
+{
+	const int32 Found = Algo::LowerBoundBy(Writes, Slot, &FDialogueSessionWrite::Slot, &SlotLess);
+	return Writes.IsValidIndex(Found) && Writes[Found].Slot == Slot ? &Writes[Found] : nullptr;
+}
+
+SIZE_T FDialogueSession::GetAllocatedSize() const
+{
+	SIZE_T Size = Branches.GetAllocatedSize() + Writes.GetAllocatedSize() + Strings.GetAllocatedSize() + Seen.GetAllocatedSize();
+	for (const FString& String : Strings)
+	{
+		Size += String.GetAllocatedSize();
+	}
+	return Size;
+}
+
+// ==================== POOL ====================
+
+FDialogueSessionPool::FDialogueSessionPool(TSharedRef<const FDialogueObjectIndex> InIndex, FDialogueVariableSnapshotRef InVariables, UObject* InMethodsProvider)
+	: Index(MoveTemp(InIndex))
+	, Variables(MoveTemp(InVariables))
+	, MethodsProvider(InMethodsProvider)
+{
+}
+
+void FDialogueSessionPool::Rebind(TSharedRef<const FDialogueObjectIndex> InIndex, FDialogueVariableSnapshotRef InVariables)
+{
+	const TSharedRef<const FDialogueObjectIndex> OldIndex = Index;
+	Index = MoveTemp(InIndex);
+	Variables = MoveTemp(InVariables);
+
+	const FDialogueFlowGraph& OldGraph = OldIndex->FlowGraph;
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	auto RemapNode = [&OldGraph, &Graph](int32 Node)
+	{
+		const UDialogueObject* Object = Node != INDEX_NONE ? OldGraph.GetObject(FDialogueFlowGraph::FVertex(Node, false)) : nullptr;
+		const FDialogueFlowGraph::FVertex Vertex = Object ? Graph.FindVertex(Object) : FDialogueFlowGraph::FVertex();
+		return Vertex.IsValid() && !Vertex.bIsPin ? Vertex.Index : INDEX_NONE;
+	};
+
+	for (int32 Handle = 0; Handle < Sessions.Num(); ++Handle)
+	{
+		FDialogueSession& Session = Sessions[Handle];
+		if (!Session.bInUse)
+		{
+			continue;
+		}
+
+		Session.Cursor = RemapNode(Session.Cursor);
+
+		for (FDialogueSessionSeen& Seen : Session.Seen)
+		{
+			Seen.Node = RemapNode(Seen.Node);
+		}
+		Session.Seen.RemoveAll([](const FDialogueSessionSeen& Seen) { return Seen.Node == INDEX_NONE; });
+		Session.Seen.Sort([](const FDialogueSessionSeen& A, const FDialogueSessionSeen& B) { return A.Node < B.Node; });
+	}
+
+	// The branches depend on the graph and the shared values, explore them again
+	TArray<FDialogueSessionAdvance> Refresh;
+	for (int32 Handle = 0; Handle < Sessions.Num(); ++Handle)
+	{
+		if (Sessions[Handle].bInUse)
+		{
+			Refresh.Add({ Handle, INDEX_NONE });
+		}
+	}
+	AdvanceSessions(Refresh);
+}
+
+int32 FDialogueSessionPool::AddSession(const UDialogueObject* Start, EDialoguePausableType PauseOn)
+{
+	const FDialogueFlowGraph::FVertex Vertex = Start ? Index->FlowGraph.FindVertex(Start) : FDialogueFlowGraph::FVertex();
+	if (!Vertex.IsValid() || Vertex.bIsPin)
+	{
+		return INDEX_NONE;
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue);
+	const int32 Handle = FreeSessions.Num() > 0 ? FreeSessions.Pop(false) : Sessions.AddDefaulted();
+	FDialogueSession& Session = Sessions[Handle];
+	Session = FDialogueSession();
+	Session.bInUse = true;
+	Session.Cursor = Vertex.Index;
+	Session.PauseOn = (uint8)PauseOn;
+
+	if (Scratches.Num() == 0)
+	{
+		Scratches.Add(MakeUnique<FTaskScratch>(Variables));
+	}
+	LoadWrites(Session, Scratches[0]->Overlay);
+	ExploreBranches(Session, *Scratches[0]);
+	return Handle;
+}
+
+void FDialogueSessionPool::RemoveSession(int32 Handle)
+{
+	if (FDialogueSession* Session = FindSession(Handle))
+	{
+		// Drop the memory, the slot itself is reused
+		*Session = FDialogueSession();
+		FreeSessions.Add(Handle);
+	}
+}
+
+const FDialogueSession* FDialogueSessionPool::GetSession(int32 Handle) const
+{
+	return Sessions.IsValidIndex(Handle) && Sessions[Handle].bInUse ? &Sessions[Handle] : nullptr;
+}
+
+FDialogueSession* FDialogueSessionPool::FindSession(int32 Handle)
+{
+	return Sessions.IsValidIndex(Handle) && Sessions[Handle].bInUse ? &Sessions[Handle] : nullptr;
+}
+
+UDialogueObject* FDialogueSessionPool::GetNodeObject(int32 Node) const
+{
+	return Index->FlowGraph.Nodes.IsValidIndex(Node) ? Index->FlowGraph.GetObject(FDialogueFlowGraph::FVertex(Node, false)) : nullptr;
+}
+
+bool FDialogueSessionPool::GetBool(int32 Handle, const FDialogueVariableSlot& Slot) const
+{
+	const FDialogueSession* Session = GetSession(Handle);
+	const FDialogueSessionWrite* Write = Session ? Session->FindWrite(Slot) : nullptr;
+	if (Write)
+	{
+		return Write->Value != 0;
+	}
+	return Variables->Store.IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::Boolean && Variables->Store.GetBool(Slot.Index);
+}
+
+int32 FDialogueSessionPool::GetInt(int32 Handle, const FDialogueVariableSlot& Slot) const
+{
+	const FDialogueSession* Session = GetSession(Handle);
+	const FDialogueSessionWrite* Write = Session ? Session->FindWrite(Slot) : nullptr;
+	if (Write)
+	{
+		return Write->Value;
+	}
+	return Variables->Store.IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::Integer ? Variables->Store.Ints[Slot.Index] : 0;
+}
+
+const FString& FDialogueSessionPool::GetString(int32 Handle, const FDialogueVariableSlot& Slot) const
+{
+	const FDialogueSession* Session = GetSession(Handle);
+	const FDialogueSessionWrite* Write = Session ? Session->FindWrite(Slot) : nullptr;
+	if (Write)
+	{
+		return Session->Strings[Write->Value];
+	}
+	return Variables->Store.IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::String ? Variables->Store.Strings[Slot.Index] : EmptyString;
+}
+
+bool FDialogueSessionPool::Advance(int32 Handle, int32 Branch)
+{
+	FDialogueSessionAdvance Single{ Handle, Branch };
+	AdvanceSessions(MakeArrayView(&Single, 1));
+	return Single.bSucceeded;
+}
+
+void FDialogueSessionPool::AdvanceSessions(TArrayView<FDialogueSessionAdvance> Advances)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueAdvanceSessions);
+
+	if (Advances.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 TaskLimit = MaxTasks > 0 ? MaxTasks : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumTasks = Advances.Num() < MinParallelAdvances ? 1 : FMath::Min(Advances.Num(), TaskLimit);
+	while (Scratches.Num() < NumTasks)
+	{
+		Scratches.Add(MakeUnique<FTaskScratch>(Variables));
+	}
+
+	ParallelFor(NumTasks, [this, Advances, NumTasks](int32 Task)
+	{
+		const int32 Begin = Advances.Num() * Task / NumTasks;
+		const int32 End = Advances.Num() * (Task + 1) / NumTasks;
+
+		FTaskScratch& Scratch = *Scratches[Task];
+		for (int32 i = Begin; i < End; ++i)
+		{
+			FDialogueSessionAdvance& Request = Advances[i];
+			FDialogueSession* Session = Sessions.IsValidIndex(Request.Session) && Sessions[Request.Session].bInUse ? &Sessions[Request.Session] : nullptr;
+			Request.bSucceeded = Session && AdvanceSession(*Session, Request.Branch, Scratch);
+		}
+
+		// Counts of the workers would otherwise wait for their next exploration
+		FDialogueRuntimeStats::Flush();
+	}, NumTasks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+bool FDialogueSessionPool::AdvanceSession(FDialogueSession& Session, int32 Branch, FTaskScratch& Scratch) const
+{
+	LoadWrites(Session, Scratch.Overlay);
+
+	// No branch taken, only refresh the branches
+	if (Branch == INDEX_NONE)
+	{
+		ExploreBranches(Session, Scratch);
+		return true;
+	}
+
+	if (!Session.Branches.IsValidIndex(Branch) || Session.Cursor == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// The lines of an exploration are the session's branches in the same order
+	const FDialogueFlowGraph& Graph = Index->FlowGraph;
+	const int32 NumLines = Scratch.Explorer.Explore(Graph, FDialogueFlowGraph::FVertex(Session.Cursor, false), Session.PauseOn, Scratch.Overlay, MethodsProvider);
+	if (!ensure(Branch < NumLines && Scratch.Explorer.GetLineNode(Branch) == Session.Branches[Branch]))
+	{
+		return false;
+	}
+
+	Scratch.PathNodes.Reset();
+	Scratch.Explorer.PlayLine(Branch, &Scratch.PathNodes);
+
+	for (const int32 Node : Scratch.PathNodes)
+	{
+		const int32 Found = Algo::LowerBoundBy(Session.Seen, Node, &FDialogueSessionSeen::Node);
+		if (Session.Seen.IsValidIndex(Found) && Session.Seen[Found].Node == Node)
+		{
+			++Session.Seen[Found].Count;
+		}
+		else
+		{
+			Session.Seen.Insert({ Node, 1 }, Found);
+		}
+	}
+
+	Session.Cursor = Session.Branches[Branch];
+	StoreWrites(Session, Scratch.Overlay);
+	ExploreBranches(Session, Scratch);
+	return true;
+}
+
+void FDialogueSessionPool::LoadWrites(const FDialogueSession& Session, FDialogueVariableOverlay& Overlay) const
+{
+	Overlay.Reset(Variables);
+	for (const FDialogueSessionWrite& Write : Session.Writes)
+	{
+		if (!Overlay.IsValidSlot(Write.Slot))
+		{
+			continue;
+		}
+
+		switch (Write.Slot.Type)
+		{
+		case EDialogueVariableType::Boolean: Overlay.SetBool(Write.Slot, Write.Value != 0); break;
+		case EDialogueVariableType::Integer: Overlay.SetInt(Write.Slot, Write.Value); break;
+		case EDialogueVariableType::String: Overlay.SetString(Write.Slot, Session.Strings[Write.Value]); break;
+		default: break;
+		}
+	}
+}
+
+void FDialogueSessionPool::StoreWrites(FDialogueSession& Session, const FDialogueVariableOverlay& Overlay)
+{
+	Session.Writes.Reset();
+	Session.Strings.Reset();
+	Overlay.ForEachLatestWrite([&Session](const FDialogueVariableSlot& Slot, int32 Value, const FString* String)
+	{
+		Session.Writes.Add({ Slot, String ? Session.Strings.Add(*String) : Value });
+	});
+	Session.Writes.Sort([](const FDialogueSessionWrite& A, const FDialogueSessionWrite& B) { return SlotLess(A.Slot, B.Slot); });
+
+	// Sessions live long, keep only what they use
+	Session.Writes.Shrink();
+	Session.Strings.Shrink();
+}
+
+void FDialogueSessionPool::ExploreBranches(FDialogueSession& Session, FTaskScratch& Scratch) const
+{
+	Session.Branches.Reset();
+	if (Session.Cursor == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 NumLines = Scratch.Explorer.Explore(Index->FlowGraph, FDialogueFlowGraph::FVertex(Session.Cursor, false), Session.PauseOn, Scratch.Overlay, MethodsProvider);
+	Session.Branches.Reserve(NumLines);
+	for (int32 Line = 0; Line < NumLines; ++Line)
+	{
+		Session.Branches.Add(Scratch.Explorer.GetLineNode(Line));
+	}
+}
+
+SIZE_T FDialogueSessionPool::GetAllocatedSize() const
+{
+	SIZE_T Size = Sessions.GetAllocatedSize() + FreeSessions.GetAllocatedSize() + Scratches.GetAllocatedSize();
+	for (const FDialogueSession& Session : Sessions)
+	{
+		Size += Session.GetAllocatedSize();
+	}
+	return Size + Scratches.Num() * sizeof(FTaskScratch);
+}
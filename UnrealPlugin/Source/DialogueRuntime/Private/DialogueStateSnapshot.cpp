@@ -0,0 +1,118 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueStateSnapshot.h"
+#include "DialogueDatabase.h"
+#include "DialogueFlowPlayer.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueObject.h"
+#include "DialogueRuntimeModule.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** The first bytes of every save state, "DSNP" */
+	constexpr uint32 SnapshotMagic = 0x504E5344;
+}
+
+bool FDialogueStateSnapshot::Save(TArray<uint8>& OutBytes, const UDialogueGlobalVariables* GlobalVariables, TArrayView<UDialogueFlowPlayer* const> FlowPlayers)
+{
+	OutBytes.Reset();
+	if (!ensure(GlobalVariables))
+	{
+		return false;
+	}
+
+	if (GlobalVariables->GetShadowLevel() > 0)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Save state: can't save inside a shadow operation"));
+		return false;
+	}
+
+	FMemoryWriter Ar(OutBytes);
+
+	uint32 Magic = SnapshotMagic;
+	int32 Version = static_cast<int32>(EVersion::Latest);
+	Ar << Magic << Version;
+
+	GlobalVariables->SaveState(Ar);
+
+	// Written as plain pairs, the ID has no serializer of its own
+	TArray<int64> CursorIds;
+	CursorIds.Reserve(FlowPlayers.Num() * 2);
+	for (const UDialogueFlowPlayer* FlowPlayer : FlowPlayers)
+	{
+		const UDialogueObject* Cursor = FlowPlayer ? FlowPlayer->GetCursor() : nullptr;
+		const FDialogueId Id = Cursor ? Cursor->Id : FDialogueId();
+		CursorIds.Add(Id.Low);
+		CursorIds.Add(Id.High);
+	}
+	Ar << CursorIds;
+
+	return !Ar.IsError();
+}
+
+bool FDialogueStateSnapshot::Load(const TArray<uint8>& Bytes, UDialogueGlobalVariables* GlobalVariables, TArrayView<UDialogueFlowPlayer* const> FlowPlayers, const TMap<FString, FString>& RenamedVariables)
+{
+	if (!ensure(GlobalVariables))
+	{
+		return false;
+	}
+
+	if (GlobalVariables->GetShadowLevel() > 0)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Save state: can't load inside a shadow operation"));
+		return false;
+	}
+
+	FMemoryReader Ar(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Ar << Magic << Version;
+	if (Ar.IsError() || Magic != SnapshotMagic)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Save state: the data is not a dialogue save state"));
+		return false;
+	}
+	if (Version < static_cast<int32>(EVersion::Initial) || Version > static_cast<int32>(EVersion::Latest))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Save state: version %d is not supported, the latest is %d"), Version, static_cast<int32>(EVersion::Latest));
+		return false;
+	}
+
+	if (!GlobalVariables->LoadState(Ar, RenamedVariables))
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Save state: failed to read the variables"));
+		return false;
+	}
+
+	TArray<int64> CursorIds;
+	Ar << CursorIds;
+	if (Ar.IsError() || CursorIds.Num() % 2 != 0)
+	{
+		UE_LOG(LogDialogueRuntime, Error, TEXT("Save state: failed to read the flow player cursors"));
+		return false;
+	}
+
+	for (int32 Index = 0; Index < FlowPlayers.Num() && Index * 2 < CursorIds.Num(); ++Index)
+	{
+		UDialogueFlowPlayer* FlowPlayer = FlowPlayers[Index];
+		const FDialogueId Id(CursorIds[Index * 2], CursorIds[Index * 2 + 1]);
+		if (!FlowPlayer || !Id.IsValid())
+		{
+			continue;
+		}
+
+		const UDialogueDatabase* Database = UDialogueDatabase::Get(FlowPlayer);
+		UDialogueObject* Cursor = Database ? Database->GetObject(Id) : nullptr;
+		if (!Cursor)
+		{
+			UE_LOG(LogDialogueRuntime, Warning, TEXT("Save state: the cursor of flow player %s is not loaded, it is not restored"), *FlowPlayer->GetName());
+			continue;
+		}
+		FlowPlayer->SetCursorTo(Cursor);
+	}
+
+	return true;
+}
@@ -0,0 +1,36 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueSubsystem.h"
+#include "DialogueDatabase.h"
+#include "DialogueGlobalVariables.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+void UDialogueSubsystem::Deinitialize()
+{
+	Database = nullptr;
+
+	Super::Deinitialize();
+}
+
+UDialogueSubsystem* UDialogueSubsystem::Get(const UObject* WorldContext)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UDialogueSubsystem>() : nullptr;
+}
+
+UDialogueDatabase* UDialogueSubsystem::GetDatabase()
+{
+	if (!Database)
+	{
+		Database = UDialogueDatabase::GetOrCreateForWorld(GetWorld());
+	}
+	return Database;
+}
+
+UDialogueGlobalVariables* UDialogueSubsystem::GetGlobalVariables()
+{
+	// The database keeps its variables, and recreates them after it was deinitialized
+	UDialogueDatabase* WorldDatabase = GetDatabase();
+	return WorldDatabase ? WorldDatabase->GetGlobalVariables() : nullptr;
+}
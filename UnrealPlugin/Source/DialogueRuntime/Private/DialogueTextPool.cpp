@@ -0,0 +1,85 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueTextPool.h"
+#include "DialogueNode.h"
+#include "DialoguePackage.h"
+#include "DialogueRuntimeStats.h"
+#include "Internationalization/TextHistory.h"
+
+namespace
+{
+	const FString& GetSourceString(const FText& Text)
+	{
+		const FString* Source = FTextInspector::GetSourceString(Text);
+		return Source ? *Source : Text.ToString();
+	}
+
+	/** Only texts that are no more than their ID and source string can stand in for each other, formatted ones are not */
+	bool CanIntern(const FText& Text)
+	{
+		return !Text.IsTransient() && FTextInspector::GetTextHistory(Text).GetType() == ETextHistoryType::Base;
+	}
+}
+
+void FDialogueTextPool::Intern(FText& Text)
+{
+	if (!CanIntern(Text))
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue_Text);
+	const FTextId Id = FTextInspector::GetTextId(Text);
+	const FString& Source = GetSourceString(Text);
+	const uint32 Hash = HashCombine(GetTypeHash(Id), GetTypeHash(Source));
+
+	TArray<FText, TInlineAllocator<1>>& Bucket = Texts.FindOrAdd(Hash);
+	for (const FText& Pooled : Bucket)
+	{
+		if (Pooled.IdenticalTo(Text))
+		{
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::TextPoolHits);
+			return;
+		}
+
+		if (FTextInspector::GetTextId(Pooled) == Id && GetSourceString(Pooled).Equals(Source, ESearchCase::CaseSensitive))
+		{
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::TextPoolHits);
+			Text = Pooled;
+			return;
+		}
+	}
+
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::TextPoolMisses);
+	Bucket.Add(Text);
+	++NumTexts;
+}
+
+void FDialogueTextPool::InternPackage(UDialoguePackage* Package)
+{
+	if (!Package)
+	{
+		return;
+	}
+
+	for (UDialogueObject* Object : Package->GetObjectsOfClass(UDialogueDialogue::StaticClass()))
+	{
+		UDialogueDialogue* Dialogue = static_cast<UDialogueDialogue*>(Object);
+		Intern(Dialogue->Text);
+		Intern(Dialogue->MenuText);
+		Intern(Dialogue->StageDirections);
+	}
+
+	for (UDialogueObject* Object : Package->GetObjectsOfClass(UDialogueFlowFragment::StaticClass()))
+	{
+		Intern(static_cast<UDialogueFlowFragment*>(Object)->Description);
+	}
+
+	FDialogueRuntimeStats::Flush();
+}
+
+void FDialogueTextPool::Reset()
+{
+	Texts.Reset();
+	NumTexts = 0;
+}
@@ -0,0 +1,250 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueTextSearchIndex.h"
+#include "DialogueNode.h"
+#include "DialoguePackage.h"
+#include "DialogueRuntimeStats.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	/** Words a prefix expands to at most; a one letter prefix would otherwise visit half the index */
+	constexpr int32 MaxPrefixMatches = 64;
+}
+
+void FDialogueTextSearchIndex::AddPackage(const UDialoguePackage* Package)
+{
+	if (!Package || !IsBuilt())
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue_Text);
+
+	TMap<FString, int32> Counts;
+	const auto IndexObject = [this, &Counts](const UDialogueObject* Object)
+	{
+		bool bAlreadyIndexed = false;
+		IndexedIds.Add(Object->Id, &bAlreadyIndexed);
+		if (bAlreadyIndexed || Counts.Num() == 0)
+		{
+			Counts.Reset();
+			return;
+		}
+
+		for (const TPair<FString, int32>& Count : Counts)
+		{
+			Postings.FindOrAdd(Count.Key).Add({ Object->Id, Count.Value });
+		}
+		Counts.Reset();
+		bSortedTokensDirty = true;
+	};
+
+	for (const UDialogueObject* Object : Package->GetObjectsOfClass(UDialogueDialogue::StaticClass()))
+	{
+		AddObjectTexts(Object, Counts);
+		IndexObject(Object);
+	}
+
+	for (const UDialogueObject* Object : Package->GetObjectsOfClass(UDialogueFlowFragment::StaticClass()))
+	{
+		AddObjectTexts(Object, Counts);
+		IndexObject(Object);
+	}
+}
+
+void FDialogueTextSearchIndex::UpdateObject(const UDialogueObject* Object)
+{
+	if (!Object || !IsBuilt() || !IndexedIds.Remove(Object->Id))
+	{
+		// Objects not indexed yet get their current texts when their package is added
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(Dialogue_Text);
+
+	// Postings are by word, the words the old texts had are not known anymore
+	for (auto It = Postings.CreateIterator(); It; ++It)
+	{
+		if (It->Value.RemoveAllSwap([&Object](const FPosting& Posting) { return Posting.Id == Object->Id; }) > 0 && It->Value.Num() == 0)
+		{
+			It.RemoveCurrent();
+			bSortedTokensDirty = true;
+		}
+	}
+
+	TMap<FString, int32> Counts;
+	AddObjectTexts(Object, Counts);
+	IndexedIds.Add(Object->Id);
+	for (const TPair<FString, int32>& Count : Counts)
+	{
+		TArray<FPosting>& List = Postings.FindOrAdd(Count.Key);
+		bSortedTokensDirty |= List.Num() == 0;
+		List.Add({ Object->Id, Count.Value });
+	}
+}
+
+void FDialogueTextSearchIndex::Reset(const FString& InLanguage)
+{
+	Postings.Reset();
+	SortedTokens.Reset();
+	bSortedTokensDirty = false;
+	IndexedIds.Reset();
+	Language = InLanguage;
+}
+
+TArray<FDialogueId> FDialogueTextSearchIndex::Search(const FString& Query, int32 Limit, TFunctionRef<bool(const FDialogueId&)> IsSearchable) const
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueSearchText);
+
+	TArray<FString> Words;
+	Tokenize(Query, Words);
+	if (Words.Num() == 0 || Limit <= 0)
+	{
+		return TArray<FDialogueId>();
+	}
+
+	// Scores of the objects containing all words so far
+	const float NumObjects = IndexedIds.Num();
+	TMap<FDialogueId, float> Scores;
+	for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+	{
+		TArray<const TArray<FPosting>*> WordPostings;
+		if (WordIndex == Words.Num() - 1)
+		{
+			FindPrefixed(Words[WordIndex], WordPostings);
+		}
+		else if (const TArray<FPosting>* Found = Postings.Find(Words[WordIndex]))
+		{
+			WordPostings.Add(Found);
+		}
+
+		TMap<FDialogueId, float> WordScores;
+		for (const TArray<FPosting>* List : WordPostings)
+		{
+			const float Weight = FMath::Loge(1.0f + NumObjects / List->Num());
+			for (const FPosting& Posting : *List)
+			{
+				const float* Previous = WordIndex > 0 ? Scores.Find(Posting.Id) : nullptr;
+				if (WordIndex == 0 || Previous)
+				{
+					float& Score = WordScores.FindOrAdd(Posting.Id, Previous ? *Previous : 0.0f);
+					Score += Posting.Count * Weight;
+				}
+			}
+		}
+
+		Scores = MoveTemp(WordScores);
+		if (Scores.Num() == 0)
+		{
+			return TArray<FDialogueId>();
+		}
+	}
+
+	TArray<TPair<FDialogueId, float>> Ranked = Scores.Array();
+	Ranked.Sort([](const TPair<FDialogueId, float>& A, const TPair<FDialogueId, float>& B)
+	{
+		// Ties by ID, so the same query always lists the same objects
+		if (A.Value != B.Value)
+		{
+			return A.Value > B.Value;
+		}
+		return A.Key.High != B.Key.High ? A.Key.High < B.Key.High : A.Key.Low < B.Key.Low;
+	});
+
+	TArray<FDialogueId> Result;
+	Result.Reserve(FMath::Min(Limit, Ranked.Num()));
+	for (int32 i = 0; i < Ranked.Num() && Result.Num() < Limit; ++i)
+	{
+		if (IsSearchable(Ranked[i].Key))
+		{
+			Result.Add(Ranked[i].Key);
+		}
+	}
+	return Result;
+}
+
+SIZE_T FDialogueTextSearchIndex::GetAllocatedSize() const
+{
+	SIZE_T Size = Postings.GetAllocatedSize() + SortedTokens.GetAllocatedSize() + IndexedIds.GetAllocatedSize() + Language.GetAllocatedSize();
+	for (const TPair<FString, TArray<FPosting>>& Pair : Postings)
+	{
+		Size += Pair.Key.GetAllocatedSize() + Pair.Value.GetAllocatedSize();
+	}
+	for (const FString& Token : SortedTokens)
+	{
+		Size += Token.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FDialogueTextSearchIndex::Tokenize(const FString& Text, TArray<FString>& OutTokens)
+{
+	FString Token;
+	for (const TCHAR Char : Text)
+	{
+		if (FChar::IsAlnum(Char))
+		{
+			Token.AppendChar(FChar::ToLower(Char));
+		}
+		else if (Token.Len() > 0)
+		{
+			OutTokens.Add(MoveTemp(Token));
+			Token.Reset();
+		}
+	}
+
+	if (Token.Len() > 0)
+	{
+		OutTokens.Add(MoveTemp(Token));
+	}
+}
+
+void FDialogueTextSearchIndex::AddText(const FText& Text, TMap<FString, int32>& InOutCounts) const
+{
+	if (Text.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<FString> Tokens;
+	Tokenize(Text.ToString(), Tokens);
+	for (FString& Token : Tokens)
+	{
+		++InOutCounts.FindOrAdd(MoveTemp(Token), 0);
+	}
+}
+
+void FDialogueTextSearchIndex::AddObjectTexts(const UDialogueObject* Object, TMap<FString, int32>& InOutCounts) const
+{
+	if (const UDialogueDialogue* Dialogue = Cast<UDialogueDialogue>(Object))
+	{
+		AddText(Dialogue->GetText(), InOutCounts);
+		AddText(Dialogue->GetMenuText(), InOutCounts);
+		AddText(Dialogue->GetStageDirections(), InOutCounts);
+	}
+	else if (const UDialogueFlowFragment* FlowFragment = Cast<UDialogueFlowFragment>(Object))
+	{
+		AddText(FlowFragment->Description, InOutCounts);
+	}
+}
+
+void FDialogueTextSearchIndex::FindPrefixed(const FString& Prefix, TArray<const TArray<FPosting>*>& OutPostings) const
+{
+	if (bSortedTokensDirty)
+	{
+		Postings.GenerateKeyArray(SortedTokens);
+		SortedTokens.Sort();
+		bSortedTokensDirty = false;
+	}
+
+	// Words are lowercase, so the case-insensitive order of FString is their order too
+	for (int32 i = Algo::LowerBound(SortedTokens, Prefix); i < SortedTokens.Num() && OutPostings.Num() < MaxPrefixMatches; ++i)
+	{
+		if (!SortedTokens[i].StartsWith(Prefix, ESearchCase::CaseSensitive))
+		{
+			break;
+		}
+		OutPostings.Add(&Postings.FindChecked(SortedTokens[i]));
+	}
+}
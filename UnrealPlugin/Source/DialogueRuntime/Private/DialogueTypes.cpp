@@ -0,0 +1,78 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#include "DialogueTypes.h"
+#include "DialogueDatabase.h"
+#include "DialogueObject.h"
+#include "DialogueRuntimeStats.h"
+#include "Hash/CityHash.h"
+#include "Misc/Crc.h"
+
+FDialogueId FDialogueId::FromImportId(const FString& Str)
+{
+	if (Str.IsEmpty())
+	{
+		return FDialogueId();
+	}
+
+	if (Str.StartsWith(TEXT("0x")))
+	{
+		const FStringView Hex = FStringView(Str).RightChop(2);
+		bool bIsHex = Hex.Len() > 0 && Hex.Len() <= 32;
+		for (int32 i = 0; bIsHex && i < Hex.Len(); ++i)
+		{
+			bIsHex = FChar::IsHexDigit(Hex[i]);
+		}
+
+		if (bIsHex)
+		{
+			const int32 HighLen = FMath::Max(0, Hex.Len() - 16);
+			FDialogueId Result;
+			Result.High = (int64)ParseHex(Hex.Left(HighLen));
+			Result.Low = (int64)ParseHex(Hex.RightChop(HighLen));
+			return Result;
+		}
+	}
+
+	const FTCHARToUTF8 Utf8(*Str);
+	const Uint128_64 Hash = CityHash128(Utf8.Get(), Utf8.Length());
+	return FDialogueId((int64)Hash.lo, (int64)Hash.hi);
+}
+
+UDialogueObject* FDialogueRef::GetObject(const UObject* WorldContext) const
+{
+	if (CachedGeneration == UDialogueDatabase::GetGeneration() && CachedId == Id)
+	{
+		if (UDialogueObject* Object = CachedObject.Get())
+		{
+			FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::LookupCacheHits);
+			return Object;
+		}
+	}
+
+	FDialogueRuntimeStats::Count(FDialogueRuntimeStats::ECounter::LookupCacheMisses);
+	UDialogueDatabase* Database = IsValid() ? UDialogueDatabase::Get(WorldContext) : nullptr;
+	CachedObject = Database ? Database->GetObject(Id) : nullptr;
+	CachedId = Id;
+	CachedGeneration = UDialogueDatabase::GetGeneration();
+	return CachedObject.Get();
+}
+
+uint32 FDialogueScript::GetExpressionHash() const
+{
+	return Expression.IsEmpty() ? StrippedExpressionHash : FCrc::StrCrc32(*Expression);
+}
+
+FArchive& operator<<(FArchive& Ar, FDialogueScript& Script)
+{
+	Ar << Script.Expression;
+	uint32 ExpressionHash = Script.GetExpressionHash();
+	Ar << ExpressionHash;
+	if (Ar.IsLoading())
+	{
+		Script.StrippedExpressionHash = Script.Expression.IsEmpty() ? ExpressionHash : 0;
+	}
+	Ar << Script.bIsCondition;
+	Ar << Script.NativeIndex;
+	FDialogueScriptProgram::StaticStruct()->SerializeBin(Ar, &Script.Program);
+	return Ar;
+}
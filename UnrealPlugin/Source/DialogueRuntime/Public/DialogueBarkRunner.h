@@ -0,0 +1,139 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueFlowGraph.h"
+#include "DialogueObject.h"
+
+class FDialogueVariableOverlay;
+class UDialogueGlobalVariables;
+
+/**
+ * A flow position for ambient lines, without the flow player's component, events and branches.
+ * Runners are plain data meant to be kept in arrays by the thousand and advanced in bulk through
+ * UDialogueFlowWorldSubsystem::AdvanceBarkRunners.
+ */
+struct DIALOGUERUNTIME_API FDialogueBarkRunner
+{
+	FDialogueBarkRunner() = default;
+
+	/** Start at a node, typically a hub the lines hang off. Seed makes the line choices repeatable. */
+	FDialogueBarkRunner(UDialogueObject* Start, uint32 Seed, EDialoguePausableType InPauseOn = EDialoguePausableType::DialogueFragment);
+
+	/** Node the runner is at, it explores on from here */
+	UDialogueObject* GetCurrent() const { return Current.Get(); }
+
+	/** Set once an advance found no valid line to move to */
+	bool IsFinished() const { return bFinished; }
+
+	/** Draw the next value of the runner's random stream */
+	uint32 NextRandom();
+
+	TWeakObjectPtr<UDialogueObject> Current;
+
+	/** xorshift state, never 0 */
+	uint32 RandomState = 1;
+
+	/** EDialoguePausableType the runner stops at */
+	uint8 PauseOn = (uint8)EDialoguePausableType::DialogueFragment;
+
+	/** Significance of the runner's speaker, see UDialogueFlowWorldSubsystem::UpdateBarkRunnerTiers. Dormant runners are not advanced. */
+	EDialogueUpdateTier Tier = EDialogueUpdateTier::Full;
+
+	bool bFinished = false;
+};
+
+/**
+ * Moves bark runners through the baked flow graph, with the same rules as the flow player's exploration:
+ * conditions decide the way, instructions on the way are shadowed, and the path to the chosen line is
+ * executed like UDialogueFlowPlayer::PlayBranch does. Only valid branches count. Custom nodes need a flow
+ * player to explore them, a branch ends there without a line.
+ * Holds the scratch memory of the explorations, so one explorer serves any number of runners.
+ * Explore and PlayLine do the same against a variable overlay, for flows evaluated off the game thread.
+ */
+class DIALOGUERUNTIME_API FDialogueBarkExplorer
+{
+public:
+	using FVertex = FDialogueFlowGraph::FVertex;
+
+	/**
+	 * Explore from the runner's node, move it to a random valid line it reaches and run the path there.
+	 * Returns false and marks the runner finished if there is no line, or leaves it if it is not on the graph.
+	 */
+	bool Advance(FDialogueBarkRunner& Runner, const FDialogueFlowGraph& Graph, UDialogueGlobalVariables* GV, UObject* MethodsProvider);
+
+	/**
+	 * Explore from a vertex against an overlay, without touching any UObject, and return the number of valid lines
+	 * reached: the nodes whose type is in the PauseOn mask. The lines stay valid until the next exploration.
+	 */
+	int32 Explore(const FDialogueFlowGraph& Graph, FVertex Start, uint8 PauseOn, FDialogueVariableOverlay& Overlay, UObject* MethodsProvider);
+
+	/** Node index of a line of the last Explore */
+	int32 GetLineNode(int32 Line) const { return Segments[Lines[Line]].Vertex.Index; }
+
+	/** Run the path to a line of the last Explore on its overlay, like the flow player plays a branch. OutPathNodes gets the nodes on the way. */
+	void PlayLine(int32 Line, TArray<int32>* OutPathNodes = nullptr);
+
+	/** Times the last exploration ran into ExploreLimit */
+	int32 GetNumExploreLimitHits() const { return NumExploreLimitHits; }
+
+	int32 ExploreLimit = 128;
+	int32 ShadowLevelLimit = 10;
+
+	/** Warn whenever ExploreLimit is reached, off for callers that count the hits themselves */
+	bool bWarnOnExploreLimit = true;
+
+private:
+	struct FFrame
+	{
+		FVertex Vertex;
+		int32 Parent = INDEX_NONE;
+		int32 Depth = 0;
+		bool bShadowed = false;
+		bool bEndShadow = false;
+	};
+
+	/** A vertex of the explored paths, linked back to the one before it */
+	struct FSegment
+	{
+		FVertex Vertex;
+		int32 Parent = INDEX_NONE;
+	};
+
+	/** Collect the lines reachable from Start into Lines */
+	void Run(FVertex Start, int32 InShadowLevel);
+
+	void Visit(const FFrame& InFrame);
+	void Expand(FVertex Vertex, int32 Segment, int32 Depth, bool bShadowChildren);
+	void Push(FVertex Vertex, int32 Parent, int32 Depth, bool bShadowed);
+
+	/** Script access of the exploration, on the overlay if there is one */
+	void PushState();
+	void PopState();
+	bool EvaluateCondition(const FDialogueScriptProgram& Program) const;
+	void ExecuteInstruction(const FDialogueScriptProgram& Program) const;
+
+	/** Fill PathSegments with the segments from the start to a line, the line first */
+	void GatherPath(int32 Line);
+
+	/** State of the exploration running right now */
+	const FDialogueFlowGraph* Graph = nullptr;
+	UDialogueGlobalVariables* GV = nullptr;
+	FDialogueVariableOverlay* Overlay = nullptr;
+	UObject* MethodsProvider = nullptr;
+	FVertex StartVertex;
+	uint8 PauseOn = 0;
+	int32 ShadowLevel = 0;
+	int32 BaseShadowLevel = 0;
+	int32 NumExploreLimitHits = 0;
+
+	TArray<FFrame> Stack;
+	TArray<FSegment> Segments;
+
+	/** Segments of the lines reached */
+	TArray<int32> Lines;
+
+	/** Segments of the path to the chosen line, the line first */
+	TArray<int32> PathSegments;
+};
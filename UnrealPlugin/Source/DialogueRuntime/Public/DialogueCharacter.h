@@ -42,4 +42,7 @@ public:
 	/** Get the preview image (loads if needed) */
 	UFUNCTION(BlueprintCallable, Category = "Character")
 	UTexture2D* GetPreviewImage() const;
+
+	/** Cooks Color as the default white unless UDialogueDatabase::CookedEditorOnlyData keeps it */
+	virtual void Serialize(FArchive& Ar) override;
 };
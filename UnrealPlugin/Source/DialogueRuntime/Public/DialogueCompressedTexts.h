@@ -0,0 +1,78 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Texts of a cooked package compressed in blocks of neighbouring lines, so short lines compress
+ * with the context of the lines around them. A block is decompressed into a cache shared by all
+ * packages when one of its texts is requested, and evicted again once it was not used for a while.
+ */
+struct DIALOGUERUNTIME_API FDialogueCompressedTexts
+{
+	/** Compress texts, replacing the ones stored before; a text's index is its position in Texts */
+	void Build(const TArray<FText>& Texts);
+
+	/** Get a text, decompressing its block if it is not cached */
+	FText Get(int32 Index) const;
+
+	/** Decompress the block of a text ahead of Get */
+	void Prefetch(int32 Index) const;
+
+	int32 Num() const { return NumTexts; }
+
+	bool IsEmpty() const { return NumTexts == 0; }
+
+	/** Memory of the compressed blocks, the cache is not included */
+	SIZE_T GetAllocatedSize() const { return Blocks.GetAllocatedSize() + Data.GetAllocatedSize(); }
+
+	void Reset();
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueCompressedTexts& Texts);
+
+	/** Number of decompressed blocks kept across all packages, evicting the least recently used ones */
+	static void SetCacheSize(int32 NumBlocks);
+
+	/** Format texts are compressed with, Oodle if available */
+	static FName GetCompressionFormat();
+
+private:
+	struct FBlock
+	{
+		/** Range of the block in Data */
+		int32 Offset = 0;
+		int32 CompressedSize = 0;
+
+		/** Size of the serialized texts; equal to CompressedSize if they did not compress */
+		int32 UncompressedSize = 0;
+
+		/** Texts of the block are stored contiguously from FirstText */
+		int32 FirstText = 0;
+		int32 NumTexts = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlock& Block);
+	};
+
+	/** Run Visitor on the decompressed texts of the block holding a text, under the cache lock */
+	void VisitBlock(int32 Index, TFunctionRef<void(const TArray<FText>&, int32)> Visitor) const;
+
+	/** Decompress and read the texts of a block */
+	bool Decompress(const FBlock& Block, TArray<FText>& OutTexts) const;
+
+	/** Assign a key nothing was cached under yet, after the blocks changed */
+	void RenewCacheKey();
+
+	TArray<FBlock> Blocks;
+
+	/** Compressed blocks */
+	TArray<uint8> Data;
+
+	/** Compression format of all blocks */
+	FName Format;
+
+	int32 NumTexts = 0;
+
+	/** Key of this instance's blocks in the cache */
+	uint64 CacheKey = 0;
+};
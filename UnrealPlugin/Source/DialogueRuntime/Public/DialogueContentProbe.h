@@ -0,0 +1,80 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueFlowGraph.h"
+
+class FDialogueVariableOverlay;
+
+/**
+ * Tells whether a flow reaches content a FDialogueContentFilter asks for, without building any branch: the walk
+ * follows the rules of the flow player's exploration and stops at the first unseen node it finds. Before a node is
+ * expanded its reachable pauses are checked, so flows whose lines follow without a condition never run a script,
+ * and fused corridors are tested with one evaluation. Scripts run on an overlay, instructions are shadowed.
+ * Holds the scratch memory of the walks, so one probe serves any number of them.
+ */
+class DIALOGUERUNTIME_API FDialogueContentProbe
+{
+public:
+	using FVertex = FDialogueFlowGraph::FVertex;
+
+	/** What a walk found and what it depends on */
+	struct FResult
+	{
+		bool bHasContent = false;
+
+		/** Set when a script calls user methods but the walk may not run them, nothing else is known then */
+		bool bNeedsGameThread = false;
+
+		/** Set when a script calls user methods, so any write may change the answer */
+		bool bDependsOnAll = false;
+
+		/** Vertices whose script ran, by FDialogueFlowGraph::GetVertexNumber, sorted */
+		TArray<int32> Dependencies;
+	};
+
+	/**
+	 * Walk from a vertex against an overlay. SeenNodes has a bit per node of the graph, set for the nodes the filter
+	 * skips when it only counts unseen ones. Without bAllowMethods, e.g. on a worker thread, the walk stops at the
+	 * first script calling user methods.
+	 */
+	void Run(const FDialogueFlowGraph& Graph, FVertex Start, const FDialogueContentFilter& Filter, const TBitArray<>& SeenNodes,
+		FDialogueVariableOverlay& Overlay, UObject* MethodsProvider, bool bAllowMethods, FResult& OutResult);
+
+	int32 ExploreLimit = 128;
+	int32 ShadowLevelLimit = 10;
+
+private:
+	struct FFrame
+	{
+		FVertex Vertex;
+		int32 Depth = 0;
+		bool bShadowed = false;
+		bool bEndShadow = false;
+	};
+
+	/** Whether a node is content the filter counts */
+	bool IsContent(int32 Node) const;
+
+	/** Run a script of a vertex, false if the walk has to stop because it may not */
+	bool CanRun(FVertex Vertex, const FDialogueScriptProgram& Program);
+
+	void Visit(const FFrame& InFrame);
+	void Expand(FVertex Vertex, int32 Depth, bool bShadowChildren);
+	void Push(FVertex Vertex, int32 Depth, bool bShadowed);
+
+	/** State of the walk running right now */
+	const FDialogueFlowGraph* Graph = nullptr;
+	const TBitArray<>* SeenNodes = nullptr;
+	FDialogueVariableOverlay* Overlay = nullptr;
+	UObject* MethodsProvider = nullptr;
+	FResult* Result = nullptr;
+	FVertex StartVertex;
+	uint8 PauseOn = 0;
+	bool bUnseenOnly = false;
+	bool bAllowMethods = false;
+	int32 ShadowLevel = 0;
+
+	TArray<FFrame> Stack;
+};
@@ -0,0 +1,136 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+#include "DialogueCompressedTexts.h"
+
+class UDialogueObject;
+class UDialoguePackage;
+
+/**
+ * An object or pin in the compact cooked format
+ */
+struct FDialogueCookedObject
+{
+	/** Class path in the string table */
+	int32 Class = INDEX_NONE;
+
+	/** Technical name in the string table, INDEX_NONE if empty */
+	int32 TechnicalName = INDEX_NONE;
+
+	FDialogueId Id;
+	FDialogueId ParentId;
+
+	/** Child IDs are stored contiguously from FirstChild */
+	int32 FirstChild = 0;
+	int32 NumChildren = 0;
+
+	/** Pins of a node are stored contiguously from FirstPin, input pins first */
+	int32 FirstPin = 0;
+	int32 NumInputPins = 0;
+	int32 NumOutputPins = 0;
+
+	/** Connections of an output pin are stored contiguously from FirstEdge */
+	int32 FirstEdge = 0;
+	int32 NumEdges = 0;
+
+	/** Range of the class specific properties in the data blob, see UDialogueObject::SerializeCooked */
+	int32 DataOffset = 0;
+	int32 DataSize = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueCookedObject& Object);
+};
+
+/**
+ * A connection in the compact cooked format
+ */
+struct FDialogueCookedEdge
+{
+	FDialogueId TargetNodeId;
+	int32 TargetPinIndex = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueCookedEdge& Edge);
+};
+
+/**
+ * The objects of a dialogue package in one compact blob instead of a UObject export per node, pin
+ * and connection. Cooked packages carry this instead of their objects; the objects are created from
+ * it when the package is loaded.
+ *
+ * Only objects of the classes in this module can be cooked this way, packages with other classes
+ * are cooked as regular exports.
+ */
+struct DIALOGUERUNTIME_API FDialogueCookedPackage
+{
+	/** Class paths and technical names */
+	TArray<FString> Strings;
+
+	/** Top level objects of the package in order */
+	TArray<FDialogueCookedObject> Objects;
+
+	/** Pins of all nodes */
+	TArray<FDialogueCookedObject> Pins;
+
+	/** Connections of all output pins */
+	TArray<FDialogueCookedEdge> Edges;
+
+	/** Child IDs of all objects and pins */
+	TArray<FDialogueId> ChildIds;
+
+	/** Class specific properties of all objects and pins, including their script programs */
+	TArray<uint8> Data;
+
+	/** Texts of the dialogues if they are cooked compressed, left out of Data */
+	FDialogueCompressedTexts Texts;
+
+	/** Whether all objects can be stored in the compact format */
+	static bool CanBuild(const TArray<UDialogueObject*>& InObjects);
+
+	/**
+	 * Store objects, returns false and stays empty if one of them cannot be stored.
+	 * Editor-only data not in Keep is stored empty; the objects themselves keep it.
+	 * With bCompressTexts the texts of dialogues are stored in Texts instead of with their objects.
+	 */
+	bool Build(const TArray<UDialogueObject*>& InObjects, EDialogueEditorOnlyData Keep, bool bCompressTexts);
+
+	/** Create the stored objects in a package */
+	void Instantiate(UDialoguePackage* Package, TArray<UDialogueObject*>& OutObjects) const;
+
+	void Reset();
+
+	bool IsEmpty() const { return Objects.Num() == 0; }
+
+	/**
+	 * Part of the derived data cache key that identifies a blob built from a source with Build, SourceHash being
+	 * the hash of the saved objects. Includes the format version, so blobs of other versions are never fetched.
+	 */
+	static FString GetDerivedDataKeySuffix(const FString& SourceHash, EDialogueEditorOnlyData Keep, bool bCompressTexts);
+
+	friend FArchive& operator<<(FArchive& Ar, FDialogueCookedPackage& Package);
+
+private:
+	/** Format version, packages cooked with another version fail to load */
+	static constexpr int32 Version = 5;
+
+	/**
+	 * Indices of the objects in the order the flow reaches them, children after their parent and connected
+	 * nodes after their source. Build writes the data in this order, so a conversation is read in one stretch.
+	 */
+	static TArray<int32> GetTraversalOrder(const TArray<UDialogueObject*>& InObjects);
+
+	/** Add an object's row, writing its properties to Data */
+	void AddObject(UDialogueObject* Object, FDialogueCookedObject& OutRow, EDialogueEditorOnlyData Keep, bool bCompressTexts);
+
+	int32 AddString(const FString& String);
+
+	/** Create an object from its row, Classes caches the classes resolved from the string table */
+	UDialogueObject* CreateObject(const FDialogueCookedObject& Row, UObject* Outer, TArray<UClass*>& Classes, FArchive& Reader) const;
+
+	/** String indices by value while building */
+	TMap<FString, int32> StringIndices;
+
+	/** Texts to compress into Texts at the end of building */
+	TArray<FText> PendingTexts;
+};
@@ -5,6 +5,12 @@
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
 #include "DialogueTypes.h"
+#include "DialogueObjectIndex.h"
+#include "DialoguePackageResidency.h"
+#include "DialogueTextPool.h"
+#include "DialogueTextSearchIndex.h"
+#include "Engine/StreamableManager.h"
+#include "Async/Future.h"
 #include "DialogueDatabase.generated.h"
 
 class UDialogueObject;
@@ -13,6 +19,20 @@ class UDialogueCharacter;
 class UDialoguePackage;
 class UDialogueGlobalVariables;
 
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnDialoguePackageLoaded, const FString&, PackageName, bool, bSuccess);
+
+/**
+ * Packages the objects of an imported package connect or jump to
+ */
+USTRUCT()
+struct DIALOGUERUNTIME_API FDialoguePackageReferences
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
+	TArray<FString> Packages;
+};
+
 /**
  * Central database for accessing all dialogue objects
  */
@@ -39,10 +59,20 @@ public:
 	// ==================== OBJECT ACCESS ====================
 
 	/** Get an object by ID */
+	UDialogueObject* GetObject(const FDialogueId& Id, TSubclassOf<UDialogueObject> Class = nullptr) const;
+
+	/** Get an object by ID */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (DeterminesOutputType = "Class"))
+	UDialogueObject* GetObjectById(const FDialogueId& Id, TSubclassOf<UDialogueObject> Class = nullptr) const { return GetObject(Id, Class); }
+
+	/**
+	 * Get an object by the ID string written by the dialogue editor.
+	 * Recent lookups on the game thread are cached, for Blueprints looking up the same IDs every frame.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (DeterminesOutputType = "Class"))
 	UDialogueObject* GetObject(const FString& Id, TSubclassOf<UDialogueObject> Class = nullptr) const;
 
-	/** Get an object by technical name */
+	/** Get an object by technical name, recent lookups on the game thread are cached like those by ID string */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (DeterminesOutputType = "Class"))
 	UDialogueObject* GetObjectByName(const FString& TechnicalName, TSubclassOf<UDialogueObject> Class = nullptr) const;
 
@@ -50,13 +80,30 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (DeterminesOutputType = "Class"))
 	TArray<UDialogueObject*> GetObjectsOfClass(TSubclassOf<UDialogueObject> Class) const;
 
+	/** Changes whenever the objects of any database change, so lookups cached along with it can tell they are stale */
+	static uint32 GetGeneration() { return Generation; }
+
+	/** Objects of a class and its subclasses without copying; only valid until packages are loaded or unloaded */
+	TArrayView<UDialogueObject* const> GetObjectsOfClassView(const UClass* Class) const;
+
 	/** Get all objects */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	TArray<UDialogueObject*> GetAllObjects() const;
 
+	/**
+	 * Find the loaded objects whose texts contain all words of Query, the most relevant first.
+	 * The last word matches as a prefix. The first search indexes the loaded packages in the current
+	 * language, packages loaded afterwards are added as they load; changing the language indexes again.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	TArray<FDialogueId> SearchText(const FString& Query, int32 Limit = 20);
+
 	// ==================== CHARACTERS ====================
 
 	/** Get a character by ID */
+	UDialogueCharacter* GetCharacter(const FDialogueId& Id) const;
+
+	/** Get a character by the ID string written by the dialogue editor */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	UDialogueCharacter* GetCharacter(const FString& Id) const;
 
@@ -80,6 +127,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	void LoadPackage(const FString& PackageName);
 
+	/**
+	 * Stream a package in and index its objects on a worker thread.
+	 * OnLoaded is called on the game thread once the objects can be looked up.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (AutoCreateRefTerm = "OnLoaded"))
+	void LoadPackageAsync(const FString& PackageName, const FOnDialoguePackageLoaded& OnLoaded);
+
+	/** Check if a package is being loaded asynchronously */
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsPackageLoading(const FString& PackageName) const;
+
 	/** Unload a package by name */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	bool UnloadPackage(const FString& PackageName);
@@ -92,6 +150,125 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	TArray<FString> GetLoadedPackageNames() const;
 
+	/**
+	 * Estimated memory a loaded package keeps resident: the package, its objects and their texts.
+	 * Texts shared through the text pool count for every package using them.
+	 * Visits all objects of the package, meant for budgets and reports rather than every frame.
+	 * Returns 0 if the package is not loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	int64 GetPackageResidentBytes(const FString& PackageName) const;
+
+	/**
+	 * Mark a package used, streaming it in if it is not loaded, e.g. because it was unloaded to stay within
+	 * ResidentPackageBudget. Call it before playing a package that is not loaded by default.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (AutoCreateRefTerm = "OnLoaded"))
+	void RequestPackage(const FString& PackageName, const FOnDialoguePackageLoaded& OnLoaded);
+
+	/** Keep a package loaded within ResidentPackageBudget until it is unpinned as often; it is not loaded by pinning */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void PinPackage(const FString& PackageName);
+
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void UnpinPackage(const FString& PackageName);
+
+	/**
+	 * Unload the least recently used packages while the loaded ones take more than ResidentPackageBudget.
+	 * Default packages, pinned packages and packages a flow player of this database is in are kept.
+	 * Runs after every load; returns the number of packages unloaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	int32 EnforcePackageBudget();
+
+	/** Packages an imported package connects or jumps to, computed at import */
+	const TArray<FString>& GetReferencedPackages(const FString& PackageName) const;
+
+	/**
+	 * Stream in the packages reachable from a package within PredictiveLoadHops references, so the flow
+	 * does not run into an unloaded package. Flow players call it whenever their cursor enters a package.
+	 */
+	void LoadReferencedPackages(const FString& PackageName);
+
+	// ==================== MOUNTED PACKAGES ====================
+
+	/**
+	 * Make packages that are not part of the import available under a mount name, e.g. those of a DLC.
+	 * Their objects are merged into the live index and the variables of Variables this database lacks are added,
+	 * without initializing again, so flow players keep running. The default packages among them are loaded, the
+	 * others load by name like imported ones. Returns false if the name is mounted or a package name is taken.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool MountPackages(const FString& MountName, const TArray<UDialoguePackage*>& Packages, UDialogueGlobalVariables* Variables);
+
+	/**
+	 * Unload and forget the packages of a mount, fails while a flow player of this database is in one of them.
+	 * Variables the mount added stay, so the slots of compiled scripts and save states keep their meaning.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool UnmountPackages(const FString& MountName);
+
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsMounted(const FString& MountName) const { return MountedPackageNames.Contains(MountName); }
+
+	/** The editor-only data cooking keeps, see CookedEditorOnlyData */
+	static EDialogueEditorOnlyData GetCookedEditorOnlyData() { return (EDialogueEditorOnlyData)GetDefault<UDialogueDatabase>()->CookedEditorOnlyData; }
+
+	/** Index of all loaded objects; hold on to it while iterating, it is replaced when packages change */
+	TSharedRef<const FDialogueObjectIndex> GetObjectIndex() const { return ObjectIndex; }
+
+	/** Baked flow graph of all loaded packages */
+	const FDialogueFlowGraph& GetFlowGraph() const { return ObjectIndex->FlowGraph; }
+
+	/** State of a database reported by the Dialogue.Stats console command */
+	struct FRuntimeStats
+	{
+		struct FPackage
+		{
+			FString Name;
+			int32 NumObjects = 0;
+
+			/** See GetPackageResidentBytes, 0 if not requested */
+			int64 Bytes = 0;
+		};
+
+		TArray<FPackage> Packages;
+
+		/** Objects of the published index, an object of several packages counts once */
+		int32 NumIndexedObjects = 0;
+
+		/** Packages being streamed in */
+		int32 NumPendingLoads = 0;
+
+		/** Distinct texts of the text pool */
+		int32 NumPooledTexts = 0;
+
+		/** Memory of the loaded packages as measured when they loaded, and the budget they are kept in, 0 if none */
+		int64 ResidentPackageBytes = 0;
+		int64 ResidentPackageBudget = 0;
+
+		/** Distinct words and memory of the text search index, 0 until the first search */
+		int32 NumSearchTokens = 0;
+		int64 SearchIndexBytes = 0;
+
+		int32 ShadowLevel = 0;
+
+		/** Null until the variables are first requested */
+		const UDialogueGlobalVariables* GlobalVariables = nullptr;
+	};
+
+	/** Gather the state of this database; estimating the memory of the packages visits all of their objects */
+	FRuntimeStats GetRuntimeStats(bool bIncludeMemory) const;
+
+	// ==================== LIVE PATCHING ====================
+
+	/**
+	 * Refresh what this database derived from objects patched in place, see FDialogueLivePatch: their texts in the
+	 * text pool and the search index, and the flow graph if bFlowChanged. Flow players of this database explore
+	 * their branches again if their cursor or branches touch a patched object, all of them if the flow changed.
+	 */
+	void OnObjectsPatched(TConstArrayView<UDialogueObject*> Objects, bool bFlowChanged);
+
 	// ==================== SHADOW STATE (for flow player) ====================
 
 	/** Push a shadow state (for speculative execution) */
@@ -108,26 +285,74 @@ public:
 	bool IsInShadowState() const { return ShadowLevel > 0; }
 
 protected:
-	/** Imported packages */
+	/** Imported packages, streamed in when loaded */
 	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
-	TMap<FString, UDialoguePackage*> ImportedPackages;
+	TMap<FString, TSoftObjectPtr<UDialoguePackage>> ImportedPackages;
+
+	/** Packages each imported package connects or jumps to, by name */
+	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
+	TMap<FString, FDialoguePackageReferences> PackageReferences;
+
+	/** Packages loaded by LoadDefaultPackages */
+	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
+	TArray<FString> DefaultPackageNames;
+
+	/** Stream default packages in asynchronously instead of blocking on Initialize */
+	UPROPERTY(Config, EditAnywhere, Category = "Dialogue")
+	bool bLoadDefaultPackagesAsync = false;
+
+	/**
+	 * Editor-only data cooked packages and characters keep, read from the class defaults when cooking.
+	 * Anything else is cooked empty, which shrinks the packages and the memory they take once loaded.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Cooking", meta = (Bitmask, BitmaskEnum = "/Script/DialogueRuntime.EDialogueEditorOnlyData", UseEnumValuesAsMaskValuesInEditor = "true"))
+	uint8 CookedEditorOnlyData = (uint8)EDialogueEditorOnlyData::CharacterColors;
+
+	/**
+	 * Chunks to cook packages into by package name, so the packages of a chapter end up in the same pak or
+	 * IoStore container. Packages not listed go to the chunks of the assets referencing them.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Cooking", meta = (ClampMin = "0"))
+	TMap<FString, int32> PackageChunkIds;
+
+	/**
+	 * Memory the loaded packages may take before the least recently used ones are unloaded, see
+	 * EnforcePackageBudget. 0 keeps all packages loaded until they are unloaded explicitly.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Dialogue", meta = (ClampMin = "0", Units = "Bytes"))
+	int64 ResidentPackageBudget = 0;
+
+	/** References followed by LoadReferencedPackages from the package of a flow player's cursor, 0 to load nothing ahead */
+	UPROPERTY(Config, EditAnywhere, Category = "Dialogue", meta = (ClampMin = "0"))
+	int32 PredictiveLoadHops = 1;
+
+	/** Blocks of compressed dialogue texts kept decompressed across all packages */
+	UPROPERTY(Config, EditAnywhere, Category = "Dialogue", meta = (ClampMin = "1"))
+	int32 CompressedTextCacheBlocks = 64;
 
 	/** Currently loaded packages */
 	UPROPERTY(VisibleAnywhere, Transient, Category = "Dialogue")
-	TArray<FString> LoadedPackageNames;
+	TMap<FString, UDialoguePackage*> LoadedPackages;
 
-	/** Objects indexed by ID */
+	/** Packages of all mounts, loaded or not; ImportedPackages only refers to them softly */
 	UPROPERTY(Transient)
-	TMap<FString, UDialogueObject*> ObjectsById;
+	TArray<UDialoguePackage*> MountedPackages;
 
-	/** Objects indexed by technical name */
-	UPROPERTY(Transient)
-	TMap<FString, UDialogueObject*> ObjectsByName;
+	/** Names of the packages of each mount */
+	TMap<FString, TArray<FString>> MountedPackageNames;
 
 	/** Characters */
 	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
 	TArray<UDialogueCharacter*> Characters;
 
+	/** Characters by ID and technical name, built with the indices */
+	TMap<FDialogueId, UDialogueCharacter*> CharactersById;
+	TMap<FString, UDialogueCharacter*> CharactersByName;
+
+	/** Default variable set generated on import; the runtime instance is a copy of it */
+	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
+	UDialogueGlobalVariables* DefaultGlobalVariables;
+
 	/** Global variables instance */
 	UPROPERTY(Transient)
 	mutable UDialogueGlobalVariables* CachedGlobalVariables;
@@ -144,7 +369,115 @@ protected:
 	UPROPERTY(Transient)
 	int32 ShadowLevel = 0;
 
+	/** Objects of the loaded packages; copied on write while shared with a reader or a worker */
+	TSharedRef<FDialogueObjectIndex> ObjectIndex = MakeShared<FDialogueObjectIndex>();
+
+	/** Rebuild object indices and the flow graph from the loaded packages */
+	void RebuildIndices();
+
+	/** Get the index for modification on the game thread */
+	FDialogueObjectIndex& GetMutableObjectIndex();
+
+	virtual void BeginDestroy() override;
+
 private:
+	/** A package requested through LoadPackageAsync */
+	struct FPendingPackageLoad
+	{
+		FString PackageName;
+		TArray<FOnDialoguePackageLoaded> Callbacks;
+		TSharedPtr<FStreamableHandle> Handle;
+
+		/** Set once streamed in */
+		UDialoguePackage* Package = nullptr;
+
+		/** Index build the package is part of, 0 if none */
+		uint32 IndexBuild = 0;
+	};
+
+	TArray<FPendingPackageLoad> PendingPackageLoads;
+
+	/** Last index build started */
+	uint32 LastIndexBuild = 0;
+
+	FStreamableManager StreamableManager;
+
+	/** Index build running on a worker thread */
+	TFuture<void> IndexBuildTask;
+
+	/** Texts of the loaded and streamed packages, identical texts share one instance */
+	FDialogueTextPool TextPool;
+
+	/** Intern the texts of all loaded and streamed packages again, dropping the texts of released ones */
+	void RebuildTextPool();
+
+	/** Words of the texts of the loaded and streamed packages, built by the first SearchText */
+	FDialogueTextSearchIndex TextSearchIndex;
+
+	/** Index the texts of all loaded and streamed packages again in the current language */
+	void RebuildTextSearchIndex();
+
+	/** Last use and memory of the loaded packages, for ResidentPackageBudget */
+	FDialoguePackageResidency PackageResidency;
+
+	/** Track a package that finished loading and unload others if it exceeds the budget */
+	void OnPackageLoaded(const FString& PackageName);
+
+	/** Names of the loaded packages the cursors and branches of this database's flow players are in */
+	TSet<FString> GatherPlayedPackages() const;
+
+	/** Intern the texts of a package about to be loaded and resolve its speakers */
+	void PreparePackage(UDialoguePackage* Package);
+
+	/** Bind every jump of the flow graph to the target pin the graph resolved, after the index changed */
+	void BindJumpTargets();
+
+	void OnPackageStreamed(FString PackageName);
+
+	/** Index all streamed packages on a worker thread, unless a build is already running */
+	void StartIndexBuild();
+
+	/** Publish an index built by StartIndexBuild */
+	void OnIndexBuilt(uint32 Build, TSharedRef<FDialogueObjectIndex> NewIndex, TSharedRef<const FDialogueObjectIndex> BaseIndex);
+
+	/** Wait for the index build in flight, so that no worker reads objects about to be released */
+	void WaitForIndexBuild();
+
+	/** Notify and forget a pending asynchronous load */
+	void CompletePendingPackageLoad(const FString& PackageName, bool bSuccess);
+
+	/** Direct-mapped cache of objects looked up by a string, including those not found */
+	struct FLookupCache
+	{
+		struct FEntry
+		{
+			FString Key;
+			UDialogueObject* Object = nullptr;
+
+			/** Generation the entry was looked up in, 0 if empty */
+			uint32 Generation = 0;
+		};
+
+		static constexpr int32 NumEntries = 64;
+		FEntry Entries[NumEntries];
+
+		/** The entry a key maps to, whichever key it holds */
+		FEntry& GetEntry(const FString& Key);
+	};
+
+	mutable FLookupCache IdLookups;
+	mutable FLookupCache NameLookups;
+
+	/** Look an object up through a cache on the game thread, Find is called on a miss */
+	UDialogueObject* FindCached(FLookupCache& Cache, const FString& Key, TFunctionRef<UDialogueObject*()> Find) const;
+
+	/** See GetGeneration */
+	static uint32 Generation;
+
+	friend class FDialogueAssetGenerator;
+	friend class UDialogueBenchmarkCommandlet;
+	friend class UDialogueSubsystem;
+
 	/** Static instances per world */
 	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UDialogueDatabase>> WorldInstances;
 
@@ -153,4 +486,7 @@ private:
 
 	/** Get or create the database for a world */
 	static UDialogueDatabase* GetOrCreateForWorld(UWorld* World);
+
+	/** Get the imported database asset the runtime instances are copied from */
+	static UDialogueDatabase* GetOriginal();
 };
@@ -0,0 +1,258 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+
+class UDialogueObject;
+class UDialogueNode;
+class UDialoguePin;
+
+/**
+ * How the flow player continues at a baked node
+ */
+enum class EDialogueFlowNodeKind : uint8
+{
+	/** Continue on all output pins */
+	Default,
+	/** Evaluate the program, continue on output pin 0 (true) or 1 (false) */
+	Condition,
+	/** Execute the program, then continue on all output pins */
+	Instruction,
+	/** Continue at JumpTargetPin */
+	Jump,
+	/** Class with its own Explore, walked through the UObject path */
+	Custom
+};
+
+/**
+ * A flow node baked into the graph
+ */
+struct FDialogueFlowGraphNode
+{
+	UDialogueNode* Object = nullptr;
+
+	/** Condition or instruction program, null if the node has none */
+	const FDialogueScriptProgram* Program = nullptr;
+
+	/** Output pins are stored contiguously from FirstOutputPin */
+	int32 FirstOutputPin = 0;
+	int32 NumOutputPins = 0;
+
+	/** Input pin a jump continues at */
+	int32 JumpTargetPin = INDEX_NONE;
+
+	/** EDialoguePausableType of the node */
+	uint8 PausableType = 0;
+
+	EDialogueFlowNodeKind Kind = EDialogueFlowNodeKind::Default;
+
+	/** Exploring the node never changes state, so it needs no shadow state of its own */
+	bool bIsPure = true;
+
+	/** Pin the node always continues at without running anything, INDEX_NONE if it branches, runs a script or is custom */
+	int32 CorridorNext = INDEX_NONE;
+
+	/** Pause candidates reachable from the node without crossing a condition, in FDialogueFlowGraph::ReachablePauses */
+	int32 FirstReachablePause = 0;
+	int32 NumReachablePauses = 0;
+
+	/** Every path from the node ends at one of its reachable pauses or a dead end, no condition or custom node decides */
+	bool bReachesPausesUnconditionally = false;
+};
+
+/**
+ * A pin baked into the graph
+ */
+struct FDialogueFlowGraphPin
+{
+	UDialoguePin* Object = nullptr;
+
+	/** Condition (input pin) or instruction (output pin), null if the pin has no script */
+	const FDialogueScriptProgram* Program = nullptr;
+
+	/** Node owning the pin */
+	int32 OwnerNode = INDEX_NONE;
+
+	/** Edges to target input pins, output pins only */
+	int32 FirstEdge = 0;
+	int32 NumEdges = 0;
+
+	bool bIsInput = false;
+
+	/** Exploring the pin never changes state, so it needs no shadow state of its own */
+	bool bIsPure = true;
+
+	/** Owner node (input pin) or single target pin (output pin) the pin always continues at without running anything, INDEX_NONE otherwise */
+	int32 CorridorNext = INDEX_NONE;
+
+	/** Fused corridor starting at the input pin in FDialogueFlowGraph::FusedCorridors, INDEX_NONE if there is none */
+	int32 FusedCorridor = INDEX_NONE;
+};
+
+/**
+ * A loop of the flow graph without a node that can pause, exploring into it runs until the explore limit
+ * unless a condition inside leaves it. Pins are not counted as pauses.
+ */
+struct FDialogueFlowGraphCycle
+{
+	/** Nodes in the loop */
+	TArray<int32> Nodes;
+
+	/** A condition node or input pin script in the loop may leave it */
+	bool bHasCondition = false;
+};
+
+/**
+ * Cache-friendly copy of the flow graph of all loaded packages, built by the database
+ * whenever packages are loaded or unloaded. Nodes, pins and connections live in
+ * contiguous arrays and refer to each other by index, so exploring a flow never
+ * resolves string IDs or chases connection objects.
+ */
+struct DIALOGUERUNTIME_API FDialogueFlowGraph
+{
+	/** Reference to a node or a pin of the graph */
+	struct FVertex
+	{
+		int32 Index = INDEX_NONE;
+		bool bIsPin = false;
+
+		FVertex() = default;
+		FVertex(int32 InIndex, bool bInIsPin) : Index(InIndex), bIsPin(bInIsPin) {}
+
+		bool IsValid() const { return Index != INDEX_NONE; }
+	};
+
+	/**
+	 * A way from an input pin through pure vertices with one way on, whose only scripts are the conditions of its input
+	 * pins. The conditions are fused into one program, so exploring the corridor evaluates it once and walks on to its end.
+	 */
+	struct FFusedCorridor
+	{
+		/** The conditions of the input pins on the way, see FDialogueScriptCompiler::FuseConditions */
+		FDialogueScriptProgram Program;
+
+		/** Vertices the corridor runs through in CorridorVertices, starting at its first input pin */
+		int32 FirstVertex = 0;
+		int32 NumVertices = 0;
+
+		/** Vertex explored as usual where the corridor ends */
+		FVertex End;
+
+		/** EDialoguePausableType of the vertices the corridor runs through after the first, a player pausing on one walks them one by one */
+		uint8 PausableTypes = 0;
+	};
+
+	TArray<FDialogueFlowGraphNode> Nodes;
+	TArray<FDialogueFlowGraphPin> Pins;
+
+	/** Target input pin of every connection */
+	TArray<int32> Edges;
+
+	/** Nodes of the reachable pauses of all nodes, see FDialogueFlowGraphNode::FirstReachablePause */
+	TArray<int32> ReachablePauses;
+
+	/** Loops without a pause found by the last build */
+	TArray<FDialogueFlowGraphCycle> PauselessCycles;
+
+	/** Corridors through conditions the player evaluates at once, see FDialogueFlowGraphPin::FusedCorridor */
+	TArray<FFusedCorridor> FusedCorridors;
+
+	/** Vertices of the fused corridors */
+	TArray<FVertex> CorridorVertices;
+
+	/** Vertices whose script uses a variable, grouped by variable, see GetVariableUsers */
+	TArray<FVertex> VariableUsers;
+
+	/** Most vertices visited looking for the reachable pauses of a node, nodes beyond it are not reached unconditionally */
+	static constexpr int32 MaxReachSearch = 256;
+
+	/** Most vertices a fused corridor runs through */
+	static constexpr int32 MaxFusedCorridor = 64;
+
+	/** Rebuild from a set of objects; connections and jumps are resolved through the set */
+	void Build(const TMap<FDialogueId, UDialogueObject*>& ObjectsById);
+
+	void Reset();
+
+	bool IsEmpty() const { return Nodes.Num() == 0; }
+
+	/** Find the vertex of a node or pin */
+	FVertex FindVertex(const UDialogueObject* Object) const;
+
+	UDialogueObject* GetObject(const FVertex& Vertex) const;
+
+	/** Number of nodes and pins, the range of GetVertexNumber */
+	int32 GetNumVertices() const { return Nodes.Num() + Pins.Num(); }
+
+	/** Number of a vertex among nodes and pins, pins follow the nodes */
+	int32 GetVertexNumber(const FVertex& Vertex) const { return Vertex.bIsPin ? Nodes.Num() + Vertex.Index : Vertex.Index; }
+
+	/**
+	 * Nodes and pins whose condition or instruction reads or writes a variable, by the slot the scripts were bound to.
+	 * A committed write to the variable can only change branches explored through one of them.
+	 */
+	TArrayView<const FVertex> GetVariableUsers(const FDialogueVariableSlot& Slot) const
+	{
+		const TPair<int32, int32>* Range = VariableUserRanges.Find(Slot);
+		return Range ? TArrayView<const FVertex>(VariableUsers.GetData() + Range->Key, Range->Value) : TArrayView<const FVertex>();
+	}
+
+	bool IsPure(const FVertex& Vertex) const
+	{
+		return Vertex.bIsPin ? Pins[Vertex.Index].bIsPure : Nodes[Vertex.Index].bIsPure;
+	}
+
+	uint8 GetPausableType(const FVertex& Vertex) const
+	{
+		return Vertex.bIsPin ? (uint8)EDialoguePausableType::Pin : Nodes[Vertex.Index].PausableType;
+	}
+
+	/**
+	 * The vertex a condition-free corridor continues at: the vertex is pure, runs no script and has exactly one
+	 * way on, so exploring it only adds it to the path. Invalid if the vertex has to be explored in full.
+	 */
+	FVertex GetCorridorNext(const FVertex& Vertex) const
+	{
+		if (!Vertex.bIsPin)
+		{
+			return FVertex(Nodes[Vertex.Index].CorridorNext, true);
+		}
+		const FDialogueFlowGraphPin& Pin = Pins[Vertex.Index];
+		return FVertex(Pin.CorridorNext, !Pin.bIsInput);
+	}
+
+	/** The fused corridor starting at a vertex, null if there is none */
+	const FFusedCorridor* GetFusedCorridor(const FVertex& Vertex) const
+	{
+		return Vertex.bIsPin && Pins[Vertex.Index].FusedCorridor != INDEX_NONE ? &FusedCorridors[Pins[Vertex.Index].FusedCorridor] : nullptr;
+	}
+
+	TArrayView<const FVertex> GetCorridorVertices(const FFusedCorridor& Corridor) const
+	{
+		return TArrayView<const FVertex>(CorridorVertices.GetData() + Corridor.FirstVertex, Corridor.NumVertices);
+	}
+
+	/** Pause candidates reachable from a node without crossing a condition */
+	TArrayView<const int32> GetReachablePauses(int32 NodeIndex) const
+	{
+		const FDialogueFlowGraphNode& Node = Nodes[NodeIndex];
+		return TArrayView<const int32>(ReachablePauses.GetData() + Node.FirstReachablePause, Node.NumReachablePauses);
+	}
+
+private:
+	/** Find corridors, pauseless cycles and reachable pauses once the connections are resolved */
+	void Analyze();
+
+	/** Fuse the conditions of the corridors through input pins, once their corridor links are known */
+	void FuseCorridors();
+
+	/** Group the vertices with scripts by the variables the scripts use into VariableUsers */
+	void IndexVariableUsers();
+
+	/** First index and number of the users of each variable in VariableUsers */
+	TMap<FDialogueVariableSlot, TPair<int32, int32>> VariableUserRanges;
+
+	TMap<const UDialogueObject*, FVertex> VertexByObject;
+};
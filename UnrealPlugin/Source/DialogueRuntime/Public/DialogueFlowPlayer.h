@@ -5,12 +5,21 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "DialogueTypes.h"
+#include "DialogueFlowGraph.h"
+#include "Tasks/Task.h"
 #include "DialogueFlowPlayer.generated.h"
 
+class UDialogueObject;
 class UDialogueNode;
+class UDialogueDialogue;
 class UDialogueDatabase;
 class UDialogueGlobalVariables;
 class IDialogueFlowObject;
+struct FDialogueBatchedExplore;
+struct FDialogueObjectIndex;
+class FDialogueVariableOverlay;
+struct FDialogueFlowRecording;
+struct FStreamableHandle;
 
 /**
  * Represents a branch in the dialogue flow
@@ -20,9 +29,9 @@ struct DIALOGUERUNTIME_API FDialogueBranch
 {
 	GENERATED_BODY()
 
-	/** The path of nodes in this branch */
+	/** The path of nodes and pins in this branch */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
-	TArray<UDialogueNode*> Path;
+	TArray<UDialogueObject*> Path;
 
 	/** Whether this branch is valid (all conditions passed) */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
@@ -33,16 +42,84 @@ struct DIALOGUERUNTIME_API FDialogueBranch
 	int32 Index = -1;
 
 	/** Get the target node (last in path) */
-	UDialogueNode* GetTarget() const
+	UDialogueObject* GetTarget() const
 	{
 		return Path.Num() > 0 ? Path.Last() : nullptr;
 	}
 };
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialoguePlayerPaused, UDialogueNode*, PausedOn);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialoguePlayerPaused, UDialogueObject*, PausedOn);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialogueBranchesUpdated, const TArray<FDialogueBranch>&, AvailableBranches);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDialogueShadowOpStart);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDialogueShadowOpEnd);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDialoguePlayerPausedNative, UDialogueObject* /*PausedOn*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDialogueBranchesUpdatedNative, const TArray<FDialogueBranch>& /*AvailableBranches*/);
+DECLARE_MULTICAST_DELEGATE(FOnDialogueShadowOpNative);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnDialogueConversationPrewarmed, bool, bSuccess);
+
+/**
+ * Exploration result cached for one cursor, together with the variables it depends on
+ */
+USTRUCT()
+struct FDialogueExplorationCacheEntry
+{
+	GENERATED_BODY()
+
+	/** Branches as they were published to AvailableBranches */
+	UPROPERTY()
+	TArray<FDialogueBranch> Branches;
+
+	/** Variables read while exploring; writing any of them invalidates the entry */
+	TSet<FDialogueVariableSlot> ReadSlots;
+
+	/** Settings the entry was explored with */
+	uint8 PauseOn = 0;
+	bool bIgnoreInvalidBranches = false;
+	bool bIncludeCurrent = false;
+};
+
+/**
+ * Branches of one exploration stored as parent-linked path segments.
+ * Kept by the player and reset between explorations, so its buffers are reused.
+ */
+struct DIALOGUERUNTIME_API FDialogueBranchArena
+{
+	struct FSegment
+	{
+		UDialogueObject* Object;
+		/** Previous segment of the path, INDEX_NONE for the first one */
+		int32 Parent;
+	};
+
+	struct FLeaf
+	{
+		/** Last segment of the branch, INDEX_NONE for an empty branch */
+		int32 Segment;
+		bool bIsValid;
+	};
+
+	TArray<FSegment> Segments;
+	TArray<FLeaf> Leaves;
+
+	void Reset()
+	{
+		Segments.Reset();
+		Leaves.Reset();
+	}
+
+	int32 Push(UDialogueObject* Object, int32 Parent)
+	{
+		return Segments.Add({ Object, Parent });
+	}
+
+	void AddLeaf(int32 Segment, bool bIsValid)
+	{
+		Leaves.Add({ Segment, bIsValid });
+	}
+
+	/** Write all non-empty branches to OutBranches in order, reusing the path buffers already in it */
+	void Materialize(TArray<FDialogueBranch>& OutBranches) const;
+};
 
 /**
  * Flow player component for traversing dialogue graphs
@@ -57,14 +134,15 @@ public:
 
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 	// ==================== SETUP ====================
 
 	/** Which node types to pause on (bitmask) */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (Bitmask, BitmaskEnum = "/Script/DialogueRuntime.EDialoguePausableType"))
-	uint8 PauseOn = (1 << (uint8)EDialoguePausableType::DialogueFragment) |
-	                (1 << (uint8)EDialoguePausableType::Dialogue) |
-	                (1 << (uint8)EDialoguePausableType::FlowFragment);
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (Bitmask, BitmaskEnum = "/Script/DialogueRuntime.EDialoguePausableType", UseEnumValuesAsMaskValuesInEditor = "true"))
+	uint8 PauseOn = (uint8)(EDialoguePausableType::DialogueFragment |
+	                        EDialoguePausableType::Dialogue |
+	                        EDialoguePausableType::FlowFragment);
 
 	/** The starting node reference */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Setup")
@@ -86,10 +164,60 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Setup", meta = (ClampMin = 1))
 	int32 ExploreLimit = 128;
 
+	/** Stop adding branches once this many are explored, 0 for no limit. The branches are flagged partial then, see AreBranchesPartial */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+	int32 BranchLimit = 0;
+
+	/**
+	 * Time in microseconds exploring the flow graph may take per frame, 0 to always explore in one go. Once it is spent the
+	 * exploration continues on the next tick against a snapshot of the variables taken when it started, and the branches
+	 * are broadcast when it completes. Flows calling user methods or running custom nodes are explored in one go.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+	int32 ExploreBudgetMicroseconds = 0;
+
 	/** Maximum shadow levels */
 	UPROPERTY(EditAnywhere, Category = "Setup")
 	uint8 ShadowLevelLimit = 10;
 
+	/** Explore the database's baked flow graph instead of following pin and connection objects */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+	bool bUseFlowGraph = true;
+
+	/**
+	 * Broadcast OnShadowOpStart and OnShadowOpEnd. Exploration shadows every branch it follows, so they are
+	 * only broadcast if something listens to them; batched updates always explore on the game thread then.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+	bool bBroadcastShadowOps = false;
+
+	/**
+	 * Reuse the branches of a previously explored cursor as long as none of the variables
+	 * its scripts read has changed. Scripts calling user methods are never cached.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+	bool bUseExplorationCache = false;
+
+	/** Maximum number of cursors kept in the exploration cache */
+	UPROPERTY(EditAnywhere, Category = "Setup", meta = (ClampMin = 1, EditCondition = "bUseExplorationCache"))
+	int32 ExplorationCacheSize = 64;
+
+	/**
+	 * Update the available branches with the next batched update of the world's UDialogueFlowWorldSubsystem whenever a
+	 * committed variable write could change them. Only writes to variables used by the scripts the current branches were
+	 * explored through count, see FDialogueFlowGraph::GetVariableUsers; scripts calling user methods count every write.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+	bool bUpdateOnVariableChange = false;
+
+	/**
+	 * Let the world's UDialogueFlowWorldSubsystem rate how significant the owner is to the viewers before a batched update,
+	 * for ambient NPCs: players further away update less often, those out of range and not rendered wait until they are
+	 * significant again. The changes collected meanwhile end in a single update.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+	bool bScaleUpdatesBySignificance = false;
+
 	// ==================== FLOW CONTROL ====================
 
 	/** Set the start node */
@@ -100,13 +228,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Flow")
 	void SetStartNodeById(const FString& NodeId);
 
-	/** Set cursor to a node */
+	/** Set cursor to a node or pin */
 	UFUNCTION(BlueprintCallable, Category = "Flow")
-	void SetCursorTo(UDialogueNode* Node);
+	void SetCursorTo(UDialogueObject* Node);
 
 	/** Get the current cursor position */
 	UFUNCTION(BlueprintPure, Category = "Flow")
-	UDialogueNode* GetCursor() const { return Cursor; }
+	UDialogueObject* GetCursor() const { return Cursor; }
 
 	/** Play a branch by index */
 	UFUNCTION(BlueprintCallable, Category = "Flow")
@@ -124,13 +252,107 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Flow")
 	void UpdateAvailableBranches();
 
+	/**
+	 * Update available branches with the next batched update of the world's UDialogueFlowWorldSubsystem,
+	 * which explores many players in parallel. Updates right away if there is no subsystem.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Flow")
+	void RequestAvailableBranchesUpdate();
+
 	/** Get currently available branches */
 	UFUNCTION(BlueprintPure, Category = "Flow")
 	const TArray<FDialogueBranch>& GetAvailableBranches() const { return AvailableBranches; }
 
+	/** Significance the subsystem rated the player with for its last batched update, see bScaleUpdatesBySignificance */
+	UFUNCTION(BlueprintPure, Category = "Flow")
+	EDialogueUpdateTier GetUpdateTier() const { return UpdateTier; }
+
+	/** Whether BranchLimit cut the available branches short */
+	UFUNCTION(BlueprintPure, Category = "Flow")
+	bool AreBranchesPartial() const { return bBranchesPartial; }
+
+	/** Whether an exploration spread over several frames is still running, see ExploreBudgetMicroseconds; there are no available branches until it completes */
+	UFUNCTION(BlueprintPure, Category = "Flow")
+	bool IsExploring() const { return SlicedExplore.IsValid(); }
+
+	/**
+	 * Dialogues and fragments reachable within the next Pauses pauses along the available branches, e.g. to
+	 * prefetch their voice-over before a branch is picked. Branches are played and explored in shadow states,
+	 * nothing the player or the variables see changes.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Flow")
+	TArray<UDialogueDialogue*> PredictUpcoming(int32 Pauses = 1);
+
 	/** Check if should pause on a node type */
 	UFUNCTION(BlueprintPure, Category = "Flow")
-	bool ShouldPauseOn(UDialogueNode* Node) const;
+	bool ShouldPauseOn(UDialogueObject* Node) const;
+
+	bool ShouldPauseOn(IDialogueFlowObject* Node) const;
+
+	/** Check whether a committed write to a variable could change the available branches; always true unless bUpdateOnVariableChange is set */
+	UFUNCTION(BlueprintPure, Category = "Flow")
+	bool DependsOnVariable(FDialogueVariableSlot Slot) const;
+
+	/** Drop all cached exploration results */
+	UFUNCTION(BlueprintCallable, Category = "Flow")
+	void InvalidateExplorationCache();
+
+	/** Number of cached exploration results */
+	int32 GetNumCachedExplorations() const { return ExplorationCache.Num(); }
+
+	/** Explore branches from a node; called back by the nodes and pins being explored */
+	TArray<FDialogueBranch> Explore(IDialogueFlowObject* Node, bool bShadowed, int32 Depth, bool bIncludeCurrent = true);
+
+	// ==================== RECORDING ====================
+
+	/**
+	 * Record every call that moves this player from now on, starting from its current cursor and variables, see FDialogueFlowRecording.
+	 * Seed is stored for the replay to initialize FMath's random stream with, pass the one the game's random numbers started from.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Recording")
+	void StartRecording(int32 Seed = 0);
+
+	/** Stop recording and write the recording to a file, false if the player was not recording or the file could not be written */
+	UFUNCTION(BlueprintCallable, Category = "Recording")
+	bool StopRecording(const FString& Filename);
+
+	UFUNCTION(BlueprintPure, Category = "Recording")
+	bool IsRecording() const { return Recording.IsValid(); }
+
+	/** The recording in progress, null if not recording */
+	const FDialogueFlowRecording* GetRecording() const { return Recording.Get(); }
+
+	// ==================== AWAITING ====================
+
+	/**
+	 * Task completed with the object the player pauses on next, for C++ that waits on the flow instead of binding
+	 * OnPlayerPaused. It completes on the game thread right when the pause is broadcast, so continuations launched
+	 * with it as prerequisite and EExtendedTaskPriority::Inline run there too. Completed with null if the player ends play first.
+	 */
+	UE::Tasks::TTask<TWeakObjectPtr<UDialogueObject>> AwaitNextPause();
+
+	/**
+	 * Task completed with the branch played next, by Play or PlayBranch, i.e. the choice made at the current pause.
+	 * Completed like AwaitNextPause, and without a branch if the player ends play first.
+	 */
+	UE::Tasks::TTask<TOptional<FDialogueBranch>> AwaitChoice();
+
+	int32 GetNumAwaiting() const { return PauseAwaiters.Num() + ChoiceAwaiters.Num(); }
+
+	// ==================== PREWARMING ====================
+
+	/**
+	 * Get a conversation ready to start without hitches: stream in the package StartRef is in and the packages it
+	 * references, explore the start into the exploration cache, decompress the texts and resolve the speakers of the
+	 * dialogues within Pauses pauses, and stream in those speakers' preview images and voice assets.
+	 * PackageName may be empty if the package of StartRef is loaded. OnReady is called on the game thread once all of it
+	 * is resident, with false if the start was not found. A new prewarm replaces the one in progress, which fails.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Flow", meta = (AutoCreateRefTerm = "OnReady"))
+	void PrewarmConversation(FDialogueRef StartRef, const FString& PackageName, int32 Pauses, const FOnDialogueConversationPrewarmed& OnReady);
+
+	UFUNCTION(BlueprintPure, Category = "Flow")
+	bool IsPrewarming() const { return Prewarm.IsValid(); }
 
 	// ==================== GLOBAL VARIABLES ====================
 
@@ -169,10 +391,16 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnDialogueShadowOpEnd OnShadowOpEnd;
 
+	/** The events above for C++ listeners, broadcast before them without going through reflection */
+	FOnDialoguePlayerPausedNative OnPlayerPausedNative;
+	FOnDialogueBranchesUpdatedNative OnBranchesUpdatedNative;
+	FOnDialogueShadowOpNative OnShadowOpStartNative;
+	FOnDialogueShadowOpNative OnShadowOpEndNative;
+
 protected:
 	/** Current position in the flow */
 	UPROPERTY(Transient)
-	UDialogueNode* Cursor = nullptr;
+	UDialogueObject* Cursor = nullptr;
 
 	/** Available branches from current position */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Flow")
@@ -183,9 +411,79 @@ protected:
 	mutable uint32 ShadowLevel = 0;
 
 private:
+	/** Shadow request a pure object passed on to the objects its Explore continues at */
+	bool bShadowPending = false;
+
+	/** Recording in progress, see StartRecording */
+	TSharedPtr<FDialogueFlowRecording> Recording;
+
+	/** A task waiting for the player, it completes with Result once Event is triggered */
+	template<typename ResultType>
+	struct TAwaiter
+	{
+		UE::Tasks::FTaskEvent Event{ TEXT("DialogueFlowAwait") };
+		ResultType Result{};
+	};
+
+	/** Tasks of AwaitNextPause and AwaitChoice not completed yet */
+	TArray<TSharedRef<TAwaiter<TWeakObjectPtr<UDialogueObject>>>> PauseAwaiters;
+	TArray<TSharedRef<TAwaiter<TOptional<FDialogueBranch>>>> ChoiceAwaiters;
+
+	template<typename ResultType>
+	static UE::Tasks::TTask<ResultType> AddAwaiter(TArray<TSharedRef<TAwaiter<ResultType>>>& Awaiters);
+
+	/** Complete all tasks waiting in Awaiters with Result; the tasks' continuations may await again */
+	template<typename ResultType>
+	static void ResolveAwaiters(TArray<TSharedRef<TAwaiter<ResultType>>>& Awaiters, const ResultType& Result);
+
+	/** A PrewarmConversation in progress */
+	struct FPrewarm
+	{
+		FDialogueRef StartRef;
+		FString PackageName;
+		int32 Pauses = 0;
+		FOnDialogueConversationPrewarmed OnReady;
+
+		/** Set once the package is resident, later callbacks of the request are ignored */
+		bool bPackageLoaded = false;
+	};
+
+	TSharedPtr<FPrewarm> Prewarm;
+
+	/** Assets of the last prewarm, kept loaded until the next one or until the player ends play */
+	TSharedPtr<FStreamableHandle> PrewarmedAssets;
+
+	/** Set while the start of a prewarm is explored, the branches it explores are not watched */
+	bool bPrewarming = false;
+
+	UFUNCTION()
+	void OnPrewarmPackageLoaded(const FString& PackageName, bool bSuccess);
+
+	void OnPrewarmAssetsLoaded(TWeakPtr<FPrewarm> Loaded);
+
+	/** Explore Start like the start of a conversation, leaving the branches of the cursor as they are */
+	TArray<FDialogueBranch> ExplorePrewarmStart(UDialogueObject* Start);
+
+	/** Report the prewarm in progress and forget it */
+	void FinishPrewarm(bool bSuccess);
+
+	/** Cancel the prewarm in progress, which fails, and release the assets of the last one */
+	void CancelPrewarm();
+
+	/** Package of the cursor its references were loaded for, see UDialogueDatabase::LoadReferencedPackages */
+	TWeakObjectPtr<const UDialoguePackage> CursorPackage;
+
 	/** Get the database */
 	UDialogueDatabase* GetDatabase() const;
 
+	/** Push or pop the shadow state of the variables at the current shadow level */
+	void PushVariableState() const;
+	void PopVariableState() const;
+
+	/** Enter a shadow level, false if there are no variables or the limit is reached; every true has to be matched with EndShadow */
+	bool BeginShadow() const;
+	void EndShadow() const;
+
 	/** Set cursor to start node */
 	void SetCursorToStartNode();
 
@@ -195,42 +493,249 @@ private:
 	/** Internal branch update */
 	void UpdateAvailableBranchesInternal(bool bIsStartup);
 
-	/** Explore branches from a node */
-	TArray<FDialogueBranch> Explore(IDialogueFlowObject* Node, bool bShadowed, int32 Depth, bool bIncludeCurrent = true);
-};
+	/** Fast-forward a startup update, or broadcast the explored branches */
+	void FinishBranchesUpdate(bool bIsStartup);
 
-// Template implementation
-template<typename Lambda>
-void UDialogueFlowPlayer::ShadowedOperation(Lambda Operation) const
-{
-	if (!GetGlobalVariables())
+	/**
+	 * Explore from the cursor, reusing or filling the exploration cache. False if the exploration goes on over the next
+	 * frames, see ExploreBudgetMicroseconds; bAllowSlicing is off to explore in one go regardless.
+	 */
+	bool ExploreFromCursor(bool bIncludeCurrent, bool bAllowSlicing = true);
+
+	/** Number the explored branches and count them */
+	void PublishExploredBranches();
+
+	/** Collect the dialogues of Branches and follow each target for Pauses - 1 more pauses. Expanded keeps the pauses left each target was followed with. */
+	void PredictBranches(const TArray<FDialogueBranch>& Branches, int32 Pauses, TMap<UDialogueObject*, int32>& Expanded, TSet<UDialogueDialogue*>& OutNodes);
+
+	/** What the available branches were explored through, to tell which variable writes can change them */
+	struct FBranchDependencies
 	{
-		UE_LOG(LogTemp, Warning, TEXT("FlowPlayer cannot get GlobalVariables!"));
-		return;
-	}
+		/** Flow graph the vertices are numbered in */
+		TWeakPtr<const FDialogueObjectIndex> Index;
 
-	if (ShadowLevel >= ShadowLevelLimit)
+		/** Vertices whose script the exploration ran, by FDialogueFlowGraph::GetVertexNumber */
+		TBitArray<> Vertices;
+
+		/** Variables read, for branches taken from the exploration cache */
+		TSet<FDialogueVariableSlot> Slots;
+
+		/** Something was explored that neither covers, e.g. a user method or a custom node, so any write may change the branches */
+		bool bDependsOnAll = true;
+	};
+
+	/** State shared by one exploration of the flow graph */
+	struct FGraphExploreContext
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Too many nested ShadowedOperations, possible infinite loop!"));
-		return;
-	}
+		const FDialogueFlowGraph& Graph;
+		UDialogueGlobalVariables* GlobalVariables;
+		UObject* MethodsProvider;
+
+		/** Set when exploring on a worker thread against a snapshot; user methods and custom nodes are off limits then */
+		FDialogueVariableOverlay* Overlay = nullptr;
+
+		/** Set when a worker found something it may not run, the exploration stops */
+		mutable bool bNeedsGameThread = false;
+
+		/** FPlatformTime::Seconds the exploration stops at to continue later, 0 to explore in one go */
+		double Deadline = 0.0;
+
+		/** Set when the deadline passed with frames left, they stay on GraphExploreStack */
+		mutable bool bSuspended = false;
+
+		/** Set when BranchLimit stopped the exploration */
+		mutable bool bReachedBranchLimit = false;
+
+		/** Filled with the vertices whose scripts run, null if the player does not track them */
+		FBranchDependencies* Dependencies = nullptr;
+
+		/** Note that the exploration runs the script of a vertex */
+		void AddDependency(FDialogueFlowGraph::FVertex Vertex, const FDialogueScriptProgram* Program) const
+		{
+			if (Dependencies && Program)
+			{
+				Dependencies->Vertices[Graph.GetVertexNumber(Vertex)] = true;
+				Dependencies->bDependsOnAll |= Program->Methods.Num() > 0;
+			}
+		}
+
+		/** Check that a program may run here, flags the exploration otherwise */
+		bool CanRun(const FDialogueScriptProgram* Program) const
+		{
+			if (Overlay && Program && Program->Methods.Num() > 0)
+			{
+				bNeedsGameThread = true;
+			}
+			return !bNeedsGameThread;
+		}
+
+		bool EvaluateCondition(const FDialogueScriptProgram& Program) const;
+		void ExecuteInstruction(const FDialogueScriptProgram& Program) const;
+	};
+
+	/** A vertex of the flow graph waiting to be explored, or the end of the shadow level a vertex opened */
+	struct FGraphExploreFrame
+	{
+		FDialogueFlowGraph::FVertex Vertex;
+		int32 Parent = INDEX_NONE;
+		int32 Depth = 0;
+		bool bShadowed = false;
+		bool bIsValid = true;
+		bool bIncludeCurrent = true;
+		bool bEndShadow = false;
+
+		/** Result of the condition of an input pin or its fused corridor evaluated together with its siblings, -1 if it was not */
+		int8 PinCondition = -1;
+	};
+
+	/**
+	 * Explore branches from a vertex of the flow graph into BranchArena, same rules as Explore. Parent is the segment the vertex follows.
+	 * Runs on GraphExploreStack instead of recursing, so deep graphs don't depend on the size of the thread's stack.
+	 */
+	void ExploreGraph(const FGraphExploreContext& Context, FDialogueFlowGraph::FVertex Vertex, bool bShadowed, int32 Depth, int32 Parent, bool bIsValid, bool bIncludeCurrent = true);
+
+	/** Visit the frames of GraphExploreStack above Base until it is empty, or until the context's deadline passed */
+	void RunGraphFrames(const FGraphExploreContext& Context, int32 Base);
+
+	/** Visit a frame taken from the stack: end the branch there, or open its shadow level and expand it. Corridors of the graph, fused ones included, are walked in place. */
+	void VisitGraphFrame(const FGraphExploreContext& Context, const FGraphExploreFrame& Frame);
+
+	/** Push a vertex to explore next, the last one pushed is explored first */
+	void PushGraphFrame(FDialogueFlowGraph::FVertex Vertex, bool bShadowed, int32 Depth, int32 Parent, bool bIsValid, int8 PinCondition = -1);
+
+	/**
+	 * Evaluate the conditions without side effects of the input pins an output pin connects to in one batch, they all see
+	 * the variables as the output pin left them. Pins starting a fused corridor the frames at Depth can walk are evaluated
+	 * with the whole corridor. Fills HubConditions per edge, false if there were not enough to batch.
+	 */
+	bool EvaluateHubConditions(const FGraphExploreContext& Context, const FDialogueFlowGraphPin& Pin, int32 Depth);
+
+	/** The fused corridor a frame at a vertex and depth walks at once, null if it has to walk the vertices one by one */
+	const FDialogueFlowGraph::FFusedCorridor* GetFusedCorridor(const FGraphExploreContext& Context, FDialogueFlowGraph::FVertex Vertex, int32 Depth) const;
+
+	/** Conditions of the last EvaluateHubConditions, null for edges that were not batched, and their results */
+	TArray<const FDialogueScriptProgram*> HubPrograms;
+	TArray<bool> HubConditions;
+
+	/**
+	 * Continue exploring from a vertex of the flow graph, the counterpart of IDialogueFlowObject::Explore. Segment ends the path up to the vertex.
+	 * bShadowChildren is set when the vertex is pure and passed its shadow request on to each of its children.
+	 * The children are pushed in reverse, so they are explored in pin order.
+	 */
+	void ExploreGraphVertex(const FGraphExploreContext& Context, FDialogueFlowGraph::FVertex Vertex, int32 Segment, bool bIsValid, int32 Depth, bool bShadowChildren, int8 PinCondition = -1);
+
+	/** Pending frames of ExploreGraph, kept to reuse its allocation */
+	TArray<FGraphExploreFrame> GraphExploreStack;
+
+	// ==================== SLICED EXPLORATION ====================
+
+	/** An exploration of the flow graph spread over several frames, defined with the player */
+	struct FSlicedExplore;
+
+	/** What a slice of a sliced exploration left */
+	enum class ESliceResult : uint8
+	{
+		/** The branches are in AvailableBranches */
+		Complete,
+
+		/** Time ran out, the exploration continues on the next tick */
+		Suspended,
+
+		/** The flow needs the game thread's variables, e.g. for user methods, it has to be explored in one go */
+		Abandoned
+	};
+
+	/** Whether an exploration from the cursor can be spread over several frames right now */
+	bool CanExploreSliced() const;
+
+	/** Start a sliced exploration from a vertex of the flow graph, replacing the one in progress */
+	void BeginSlicedExplore(const TSharedPtr<const FDialogueObjectIndex>& Index, FDialogueFlowGraph::FVertex Start, bool bIncludeCurrent);
+
+	/** Explore for up to ExploreBudgetMicroseconds, the exploration is dropped once it is complete or abandoned */
+	ESliceResult RunExploreSlice();
+
+	/** The sliced exploration in progress, null if there is none */
+	TSharedPtr<FSlicedExplore> SlicedExplore;
+
+	/** Set if BranchLimit cut AvailableBranches short */
+	bool bBranchesPartial = false;
+
+	/** Leaves the exploration through pin and connection objects added, for BranchLimit */
+	int32 NumExploredBranches = 0;
+	bool bReachedBranchLimit = false;
+
+	/** Make sure the cache listens to the current global variables */
+	void BindExplorationCache(UDialogueGlobalVariables* GV);
+
+	/** Called when a committed variable write happens */
+	void OnCachedVariableChanged(const FDialogueVariableSlot& Slot);
+
+	/** Branches of the last flow graph exploration */
+	FDialogueBranchArena BranchArena;
+
+	// ==================== VARIABLE DEPENDENCIES ====================
+
+	/** Dependencies of AvailableBranches */
+	FBranchDependencies BranchDependencies;
+
+	/** Start collecting the dependencies of an exploration of Index, or of one that is not tracked by vertex if Index is null */
+	void ResetBranchDependencies(const TSharedPtr<const FDialogueObjectIndex>& Index);
+
+	/** Once the branches are explored, listen to the writes that could change them */
+	void WatchBranchDependencies();
+
+	/** Broadcast the pause and the branches, the dynamic events only if Blueprints listen to them */
+	void BroadcastPaused();
 
-	// Push shadow state
-	++ShadowLevel;
+	/** Make sure the player listens to the committed writes of GV, or to no variables if GV is null */
+	void BindVariableWatch(UDialogueGlobalVariables* GV);
 
-	// Notify
-	GetGlobalVariables()->PushState(ShadowLevel);
-	const_cast<UDialogueFlowPlayer*>(this)->OnShadowOpStart.Broadcast();
+	/** Called when a committed variable write happens, queues an update if the write could change the branches */
+	void OnWatchedVariableChanged(const FDialogueVariableSlot& Slot);
 
-	// Execute operation
-	Operation();
+	/** Global variables the player listens to */
+	TWeakObjectPtr<UDialogueGlobalVariables> WatchedGlobalVariables;
 
-	// Pop shadow state
-	const_cast<UDialogueFlowPlayer*>(this)->OnShadowOpEnd.Broadcast();
-	GetGlobalVariables()->PopState(ShadowLevel);
+	FDelegateHandle VariableWatchHandle;
 
-	if (ShadowLevel > 0)
+	// ==================== BATCHED UPDATES ====================
+
+	/** Capture what a worker needs to explore from the cursor, false if the player has to update on the game thread */
+	bool PrepareBatchedExplore(FDialogueBatchedExplore& OutExplore) const;
+
+	/** Explore from the cursor on a worker thread, against the snapshot under Overlay */
+	void RunBatchedExplore(FDialogueBatchedExplore& Explore, FDialogueVariableOverlay& Overlay);
+
+	/** Back on the game thread, broadcast the result or update normally if the worker gave up */
+	void FinishBatchedExplore(const FDialogueBatchedExplore& Explore);
+
+	/** Overlay of the batched exploration running right now, shadow operations push and pop it instead of the global variables */
+	FDialogueVariableOverlay* BatchOverlay = nullptr;
+
+	EDialogueUpdateTier UpdateTier = EDialogueUpdateTier::Full;
+
+	/** Real time in seconds of the last batched update the subsystem let through, for the Reduced tier */
+	double LastBatchedUpdateTime = -MAX_dbl;
+
+	friend class UDialogueFlowWorldSubsystem;
+
+	/** Cached exploration results by cursor */
+	UPROPERTY(Transient)
+	TMap<UDialogueObject*, FDialogueExplorationCacheEntry> ExplorationCache;
+
+	/** Global variables the cache is bound to */
+	TWeakObjectPtr<UDialogueGlobalVariables> ExplorationCacheGlobalVariables;
+
+	FDelegateHandle ExplorationCacheHandle;
+};
+
+// Template implementation
+template<typename Lambda>
+void UDialogueFlowPlayer::ShadowedOperation(Lambda Operation) const
+{
+	if (BeginShadow())
 	{
-		--ShadowLevel;
+		Operation();
+		EndShadow();
 	}
 }
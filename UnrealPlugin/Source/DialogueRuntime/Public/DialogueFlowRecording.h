@@ -0,0 +1,80 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+
+class UDialogueFlowPlayer;
+
+/**
+ * Trace of a flow player for replaying a play session: its variables and cursor at the start as an
+ * FDialogueStateSnapshot, the seed the game's random numbers started from and every call that moved
+ * the player, in one versioned byte buffer. Recorded by UDialogueFlowPlayer::StartRecording.
+ */
+struct DIALOGUERUNTIME_API FDialogueFlowRecording
+{
+	/** Versions of the format, all older versions can be loaded */
+	enum class EVersion : int32
+	{
+		Initial = 1,
+
+		// Add new versions above this line
+		VersionPlusOne,
+		Latest = VersionPlusOne - 1
+	};
+
+	enum class EStepType : uint8
+	{
+		/** SetCursorTo the object Id */
+		SetCursor,
+		/** PlayBranch the available branch whose FDialogueBranch::Index is Value */
+		PlayBranch,
+		/** FinishCurrentPausedObject on pin Value */
+		FinishPausedObject
+	};
+
+	struct FStep
+	{
+		EStepType Type = EStepType::SetCursor;
+		int32 Value = 0;
+		FDialogueId Id;
+	};
+
+	/** Seed FMath's random stream is initialized with when replaying */
+	int32 Seed = 0;
+
+	/** Cursor of the player when recording started */
+	FDialogueId StartId;
+
+	/** Variables and cursor of the player when recording started */
+	TArray<uint8> InitialState;
+
+	TArray<FStep> Steps;
+
+	/** Start over on the current state of a player, false inside a shadow operation */
+	bool Begin(UDialogueFlowPlayer* Player, int32 InSeed);
+
+	void AddStep(EStepType Type, int32 Value, const FDialogueId& Id = FDialogueId()) { Steps.Add({ Type, Value, Id }); }
+
+	bool Save(TArray<uint8>& OutBytes) const;
+	bool Load(const TArray<uint8>& Bytes);
+
+	bool SaveToFile(const FString& Filename) const;
+	bool LoadFromFile(const FString& Filename);
+};
+
+/**
+ * Plays a recording back on a flow player, e.g. one created without a world, timing every step
+ */
+struct DIALOGUERUNTIME_API FDialogueFlowReplay
+{
+	/** Time of each step of the last Run in microseconds, in the order of the recording */
+	TArray<double> StepMicroseconds;
+
+	/** Steps of the last Run that did not fit the flow, e.g. a branch no longer available; they are skipped */
+	int32 NumMismatches = 0;
+
+	/** Restore the initial state of a recording into a player and its variables, seed FMath's random stream and apply all steps */
+	bool Run(const FDialogueFlowRecording& Recording, UDialogueFlowPlayer* Player);
+};
@@ -0,0 +1,93 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueFlowGraph.h"
+#include "DialogueGlobalVariables.h"
+
+/**
+ * What and how to simulate
+ */
+struct DIALOGUERUNTIME_API FDialogueSimulationSettings
+{
+	/** Nodes playthroughs start at, random playthroughs take turns through them */
+	TArray<int32> StartNodes;
+
+	/** Random playthroughs to run; in exhaustive mode, the most playthroughs to enumerate */
+	int64 NumPlaythroughs = 10000;
+
+	/** Lines a playthrough plays at most before it is cut off */
+	int32 MaxSteps = 256;
+
+	/** Enumerate every choice sequence instead of picking lines at random */
+	bool bExhaustive = false;
+
+	/** Seed of the random choices, a playthrough's choices only depend on it and the playthrough's number */
+	uint32 Seed = 1;
+
+	/** EDialoguePausableType mask of the nodes a playthrough stops at to choose */
+	uint8 PauseOn = (uint8)EDialoguePausableType::DialogueFragment;
+
+	int32 ExploreLimit = 128;
+	int32 ShadowLevelLimit = 10;
+
+	/** Bool and int variables whose values at the end of each playthrough are counted */
+	TArray<FDialogueVariableSlot> HistogramSlots;
+
+	/** Worker tasks, 0 for one per worker thread */
+	int32 NumTasks = 0;
+};
+
+/**
+ * Counts of a simulation, indexed like the nodes of the simulated graph
+ */
+struct DIALOGUERUNTIME_API FDialogueSimulationReport
+{
+	/** Times a playthrough passed through each node, the lines it stopped at included */
+	TArray<uint64> NodeReaches;
+
+	/** Times each line was chosen to play */
+	TArray<uint64> LineChoices;
+
+	/** Times a playthrough stopped at each node for lack of a valid line */
+	TArray<uint64> DeadEnds;
+
+	/** Times an exploration from each node ran into the explore limit */
+	TArray<uint64> ExploreLimitHits;
+
+	/** Values of each histogram slot at the end of the playthroughs, with how often they occurred */
+	TArray<TMap<int32, uint64>> Histograms;
+
+	uint64 NumPlaythroughs = 0;
+
+	/** Playthroughs cut off at MaxSteps */
+	uint64 NumCutOff = 0;
+
+	/** Lines played over all playthroughs */
+	uint64 NumSteps = 0;
+
+	/** In exhaustive mode, set if NumPlaythroughs ran out before all choice sequences were enumerated */
+	bool bTruncated = false;
+
+	void Init(int32 NumNodes, int32 NumHistograms);
+
+	/** Add the counts of another report of the same graph */
+	void Merge(const FDialogueSimulationReport& Other);
+
+	uint64 GetTotalDeadEnds() const;
+	uint64 GetTotalExploreLimitHits() const;
+};
+
+/**
+ * Plays flows headlessly on the baked flow graph: no flow players, actors or worlds, scripts run in the VM
+ * against a variable overlay per worker. Explores with the rules of FDialogueBarkExplorer, so custom nodes
+ * end a branch and user methods are not called. Meant for coverage and balancing runs over millions of
+ * playthroughs, see the DialogueSimulate commandlet.
+ */
+class DIALOGUERUNTIME_API FDialogueFlowSimulator
+{
+public:
+	/** Simulate from the start nodes of the settings against a snapshot of the variables; the graph must not change meanwhile */
+	static FDialogueSimulationReport Run(const FDialogueFlowGraph& Graph, FDialogueVariableSnapshotRef Snapshot, const FDialogueSimulationSettings& Settings);
+};
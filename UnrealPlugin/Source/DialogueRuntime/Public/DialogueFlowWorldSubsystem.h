@@ -0,0 +1,219 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DialogueBarkRunner.h"
+#include "DialogueContentProbe.h"
+#include "DialogueFlowGraph.h"
+#include "DialogueGlobalVariables.h"
+#include "DialogueFlowWorldSubsystem.generated.h"
+
+class UDialogueDatabase;
+class UDialogueFlowPlayer;
+struct FDialogueObjectIndex;
+
+/**
+ * One player's exploration in a batched update, prepared on the game thread
+ */
+struct FDialogueBatchedExplore
+{
+	UDialogueFlowPlayer* Player = nullptr;
+
+	/** Keeps the flow graph alive while the workers explore it */
+	TSharedPtr<const FDialogueObjectIndex> Index;
+
+	FDialogueFlowGraph::FVertex Start;
+
+	/** Variables the player explores against */
+	UDialogueGlobalVariables* Variables = nullptr;
+
+	/** Published snapshot of Variables the worker reads */
+	FDialogueVariableSnapshotPtr Snapshot;
+
+	UObject* MethodsProvider = nullptr;
+
+	/** Set by the worker when the flow needs something only the game thread can do, e.g. user methods */
+	bool bNeedsGameThread = false;
+};
+
+/**
+ * Refreshes the available branches of many flow players at once.
+ *
+ * Players queue themselves with UDialogueFlowPlayer::RequestAvailableBranchesUpdate. Once per tick
+ * the queued players explore the baked flow graph in parallel, reading a published snapshot of
+ * their global variables through a write overlay per worker task, and the results are published
+ * and broadcast on the game thread. Players that cannot explore off the game thread are updated
+ * there as before.
+ *
+ * Players with bScaleUpdatesBySignificance set are rated by distance to the viewers and whether their owner was
+ * rendered: Reduced players update at most every ReducedUpdateInterval, Dormant ones wait until they are
+ * significant again. Deferred players are rated again every SignificanceInterval and update once however
+ * many changes queued them meanwhile.
+ *
+ * HasAvailableContent answers whether a start node leads to content, e.g. unseen lines, with a FDialogueContentProbe
+ * instead of an exploration. Answers are cached until a write to a variable the probe's scripts used, or until a
+ * flow player pauses on a line it counted.
+ *
+ * The subsystem also publishes a new snapshot of every variable set it knows each tick, after the
+ * frame's writes are in, for other readers such as background planners.
+ */
+UCLASS()
+class DIALOGUERUNTIME_API UDialogueFlowWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue a player for the next batched update */
+	void AddDirtyPlayer(UDialogueFlowPlayer* Player);
+
+	/** Drop a queued player, e.g. when it ends play */
+	void RemoveDirtyPlayer(UDialogueFlowPlayer* Player);
+
+	/** Update all queued players now instead of on the next tick, including those deferred by their significance */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void FlushDirtyPlayers();
+
+	/**
+	 * Advance many bark runners against the world's database in one go, see FDialogueBarkRunner.
+	 * Runners whose node is not loaded are left where they are.
+	 */
+	void AdvanceBarkRunners(TArrayView<FDialogueBarkRunner> Runners, UObject* MethodsProvider = nullptr);
+
+	/** Rate the runners by the locations of their speakers, one per runner, so AdvanceBarkRunners skips the Dormant ones */
+	void UpdateBarkRunnerTiers(TArrayView<FDialogueBarkRunner> Runners, TConstArrayView<FVector> Locations);
+
+	/**
+	 * How significant something at a location is to the viewers of the local player controllers: Full within
+	 * FullDistance or when Actor was rendered within ReducedDistance, Reduced within ReducedDistance or when
+	 * rendered, else Dormant. Full while there are no viewers.
+	 */
+	EDialogueUpdateTier GetSignificanceTier(const FVector& Location, const AActor* Actor = nullptr) const;
+
+	/**
+	 * Whether a flow player starting at StartRef would find a node the filter counts, e.g. a line no flow player
+	 * paused on yet, without exploring any branch. Conditions and instructions run as in an exploration, against
+	 * the world's database variables. Cached until a write or a pause could change the answer.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool HasAvailableContent(FDialogueRef StartRef, FDialogueContentFilter Filter, UObject* MethodsProvider = nullptr);
+
+	/**
+	 * HasAvailableContent for many starts at once, e.g. the NPCs of a level. Starts not in the cache are probed in
+	 * parallel against a snapshot of the variables; those whose scripts call user methods are probed on the game thread.
+	 */
+	void HasAvailableContentBatch(TConstArrayView<FDialogueRef> StartRefs, const FDialogueContentFilter& Filter, TArrayView<bool> OutResults, UObject* MethodsProvider = nullptr);
+
+	/** Count a pause of a flow player on a node, for the filters that only count unseen nodes */
+	void MarkSeen(const UDialogueObject* Node);
+
+	/** How often flow players of the world paused on a node */
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	int32 GetSeenCounter(const UDialogueObject* Node) const;
+
+	/** Publish snapshots of a variable set every tick from now on */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void AddSnapshotSource(UDialogueGlobalVariables* Variables);
+
+	/** Fewer queued players than this are explored on the game thread without going wide */
+	int32 MinParallelPlayers = 8;
+
+	/** Distances to the nearest viewer of the significance tiers, in world units */
+	float FullDistance = 1500.f;
+	float ReducedDistance = 5000.f;
+
+	/** Seconds between two updates of a Reduced player */
+	float ReducedUpdateInterval = 1.f;
+
+	/** Seconds between two ratings of the deferred players */
+	float SignificanceInterval = 0.25f;
+
+private:
+	/** Publish new snapshots of all sources whose values changed */
+	void PublishSnapshots();
+
+	/** Update the queued players, deferring the insignificant ones unless bIgnoreSignificance */
+	void UpdatePlayers(bool bIgnoreSignificance);
+
+	/** Rate a player scaling its updates and tell whether it is due */
+	bool IsUpdateDue(UDialogueFlowPlayer& Player, double Now) const;
+
+	/** Gather the viewpoints of the local player controllers, once per frame */
+	void CacheViewpoints() const;
+
+	/** Drop the content answers if the flow graph or the variables changed since they were cached, and listen to the writes */
+	void BindContentCache(const UDialogueDatabase* Database, const TSharedRef<const FDialogueObjectIndex>& Index, UDialogueGlobalVariables* GV);
+
+	/** Called when a committed variable write happens, drops the answers it could change */
+	void OnContentVariableChanged(const FDialogueVariableSlot& Slot);
+
+	/** Players to update on the next tick */
+	TArray<TWeakObjectPtr<UDialogueFlowPlayer>> DirtyPlayers;
+
+	/** Queued players their significance holds back, each once whatever queued it */
+	TArray<TWeakObjectPtr<UDialogueFlowPlayer>> DeferredPlayers;
+
+	/** Real time the deferred players are rated again */
+	double NextSignificanceCheck = 0.0;
+
+	/** Viewer locations of ViewpointFrame */
+	mutable TArray<FVector> Viewpoints;
+	mutable uint64 ViewpointFrame = MAX_uint64;
+
+	/** Variable sets snapshots are published for */
+	TArray<TWeakObjectPtr<UDialogueGlobalVariables>> SnapshotSources;
+
+	/** Write overlays of the worker tasks, kept to reuse their memory */
+	TArray<TUniquePtr<FDialogueVariableOverlay>> TaskOverlays;
+
+	/** Explorations of the current update, kept to reuse its memory */
+	TArray<FDialogueBatchedExplore> Batch;
+
+	/** Scratch memory of AdvanceBarkRunners */
+	FDialogueBarkExplorer BarkExplorer;
+
+	/** A cached answer of HasAvailableContent */
+	struct FContentCacheEntry
+	{
+		bool bHasContent = false;
+
+		/** Found with FDialogueContentFilter::bUnseenOnly, a new seen node may change it */
+		bool bUnseenOnly = false;
+
+		/** See FDialogueContentProbe::FResult */
+		bool bDependsOnAll = false;
+		TArray<int32> Dependencies;
+	};
+
+	/** Answers by the start's vertex number in the high and FDialogueContentFilter::GetKey in the low half */
+	TMap<uint64, FContentCacheEntry> ContentCache;
+
+	/** Flow graph and variables the answers were found in */
+	TWeakPtr<const FDialogueObjectIndex> ContentCacheIndex;
+	TWeakObjectPtr<UDialogueGlobalVariables> ContentCacheVariables;
+	FDelegateHandle ContentCacheHandle;
+
+	/** Pauses of the world's flow players per node */
+	TMap<FDialogueId, int32> SeenCounters;
+
+	/** Bit per node of the graph of ContentCacheIndex, set for the nodes in SeenCounters */
+	TBitArray<> SeenNodes;
+
+	/** A start of HasAvailableContentBatch not in the cache */
+	struct FContentQuery
+	{
+		int32 Output = INDEX_NONE;
+		FDialogueFlowGraph::FVertex Start;
+		uint64 Key = 0;
+		FDialogueContentProbe::FResult Result;
+	};
+
+	/** Probes of the current batch and their scratch memory per task, kept to reuse it */
+	TArray<FContentQuery> ContentQueries;
+	TArray<FDialogueContentProbe> ContentProbes;
+};
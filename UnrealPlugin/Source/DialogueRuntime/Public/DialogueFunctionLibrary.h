@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "DialogueTypes.h"
+#include "DialogueFlowPlayer.h"
 #include "DialogueFunctionLibrary.generated.h"
 
 class UDialogueDatabase;
@@ -13,6 +14,43 @@ class UDialogueNode;
 class UDialogueCharacter;
 class UDialogueGlobalVariables;
 
+/**
+ * What a choice menu shows of a branch, gathered for all branches in one call
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUERUNTIME_API FDialogueBranchPresentation
+{
+	GENERATED_BODY()
+
+	/** Index of the branch, to play it with */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	int32 Index = -1;
+
+	/** Whether all conditions on the branch passed */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	bool bIsValid = false;
+
+	/** Menu text of the target, empty if it has no text */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	FText MenuText;
+
+	/** Text of the target, empty if it has no text */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	FText Text;
+
+	/** Speaker of the target, null if it has none */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	UDialogueCharacter* Speaker = nullptr;
+
+	/** The target node of the branch */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	UDialogueObject* Target = nullptr;
+
+	/** ID of the target node */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Branch")
+	FDialogueId TargetId;
+};
+
 /**
  * Blueprint function library for dialogue system
  */
@@ -32,7 +70,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (WorldContext = "WorldContext", DeterminesOutputType = "Class"))
 	static UDialogueObject* GetDialogueObject(const UObject* WorldContext, const FString& Id, TSubclassOf<UDialogueObject> Class = nullptr);
 
-	/** Get an object by reference */
+	/** Get an object by reference, the object is cached in the reference until packages are loaded or unloaded */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue", meta = (WorldContext = "WorldContext", DeterminesOutputType = "Class"))
 	static UDialogueObject* GetDialogueObjectFromRef(const UObject* WorldContext, const FDialogueRef& Ref, TSubclassOf<UDialogueObject> Class = nullptr);
 
@@ -109,4 +147,10 @@ public:
 	/** Get pausable type of a flow object */
 	UFUNCTION(BlueprintPure, Category = "Dialogue|Interfaces")
 	static EDialoguePausableType GetPausableType(UDialogueObject* Object);
+
+	// ==================== BRANCHES ====================
+
+	/** Get index, validity, texts, speaker and target of all branches at once, e.g. to build a choice menu */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue|Branches", meta = (WorldContext = "WorldContext"))
+	static void GetBranchPresentations(const UObject* WorldContext, const TArray<FDialogueBranch>& Branches, TArray<FDialogueBranchPresentation>& OutPresentations);
 };
@@ -4,13 +4,198 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Containers/Ticker.h"
 #include "DialogueTypes.h"
 #include "DialogueGlobalVariables.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialogueVariableChanged, const FString&, VariableName);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDialogueVariableChangedNative, const FString& /*VariableName*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDialogueVariableSlotChanged, const FDialogueVariableSlot& /*Slot*/);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialogueVariablesChanged, const TArray<FDialogueVariableSlot>&, ChangedSlots);
+
+class UDialogueGlobalVariables;
+
+/**
+ * Flat, typed storage for all variable values. Variables are addressed by
+ * FDialogueVariableSlot; booleans are packed into 64-bit words.
+ */
+USTRUCT()
+struct DIALOGUERUNTIME_API FDialogueVariableStore
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<uint64> BoolBits;
+
+	UPROPERTY()
+	int32 NumBools = 0;
+
+	UPROPERTY()
+	TArray<int32> Ints;
+
+	UPROPERTY()
+	TArray<FString> Strings;
+
+	bool IsValidSlot(const FDialogueVariableSlot& Slot) const
+	{
+		switch (Slot.Type)
+		{
+		case EDialogueVariableType::Boolean: return Slot.Index >= 0 && Slot.Index < NumBools;
+		case EDialogueVariableType::Integer: return Ints.IsValidIndex(Slot.Index);
+		case EDialogueVariableType::String: return Strings.IsValidIndex(Slot.Index);
+		default: return false;
+		}
+	}
+
+	bool GetBool(int32 Index) const
+	{
+		return (BoolBits[Index >> 6] & (1ull << (Index & 63))) != 0;
+	}
+
+	void SetBool(int32 Index, bool Value)
+	{
+		const uint64 Mask = 1ull << (Index & 63);
+		uint64& Word = BoolBits[Index >> 6];
+		Word = Value ? (Word | Mask) : (Word & ~Mask);
+	}
+
+	int32 AddBool(bool Value)
+	{
+		const int32 Index = NumBools++;
+		if ((Index >> 6) >= BoolBits.Num())
+		{
+			BoolBits.Add(0);
+		}
+		SetBool(Index, Value);
+		return Index;
+	}
+};
+
+/**
+ * Immutable copy of the committed values of a variable set, safe to read from any thread.
+ * A new snapshot with a higher version is published whenever committed values change.
+ */
+struct DIALOGUERUNTIME_API FDialogueVariableSnapshot
+{
+	FDialogueVariableSnapshot(const FDialogueVariableStore& InStore, TSharedRef<const TMap<FString, FDialogueVariableSlot>, ESPMode::ThreadSafe> InSlotsByName, uint64 InVersion)
+		: Store(InStore), SlotsByName(MoveTemp(InSlotsByName)), Version(InVersion)
+	{
+	}
+
+	const FDialogueVariableStore Store;
+
+	/** Slots by full variable name, shared by all snapshots with the same layout */
+	const TSharedRef<const TMap<FString, FDialogueVariableSlot>, ESPMode::ThreadSafe> SlotsByName;
+
+	const uint64 Version;
+
+	FDialogueVariableSlot FindSlot(const FString& FullName) const
+	{
+		const FDialogueVariableSlot* Slot = SlotsByName->Find(FullName);
+		return Slot ? *Slot : FDialogueVariableSlot();
+	}
+};
+
+using FDialogueVariableSnapshotPtr = TSharedPtr<const FDialogueVariableSnapshot, ESPMode::ThreadSafe>;
+using FDialogueVariableSnapshotRef = TSharedRef<const FDialogueVariableSnapshot, ESPMode::ThreadSafe>;
+
+/**
+ * Writable view of a snapshot for one thread. Writes are kept in the overlay, newest last,
+ * and PopState drops the ones of the level it ends; the snapshot itself never changes.
+ */
+class DIALOGUERUNTIME_API FDialogueVariableOverlay
+{
+public:
+	explicit FDialogueVariableOverlay(FDialogueVariableSnapshotRef InSnapshot) : Snapshot(MoveTemp(InSnapshot)) {}
+
+	/** Start over on another snapshot, keeping the memory of the overlay */
+	void Reset(FDialogueVariableSnapshotRef InSnapshot);
+
+	const FDialogueVariableSnapshot& GetSnapshot() const { return *Snapshot; }
+
+	bool IsValidSlot(const FDialogueVariableSlot& Slot) const { return Snapshot->Store.IsValidSlot(Slot); }
+
+	FDialogueVariableSlot FindSlot(const FString& FullName) const { return Snapshot->FindSlot(FullName); }
+
+	bool GetBool(const FDialogueVariableSlot& Slot) const;
+	int32 GetInt(const FDialogueVariableSlot& Slot) const;
+	const FString& GetString(const FDialogueVariableSlot& Slot) const;
+
+	void SetBool(const FDialogueVariableSlot& Slot, bool Value);
+	void SetInt(const FDialogueVariableSlot& Slot, int32 Value);
+	void SetString(const FDialogueVariableSlot& Slot, const FString& Value);
+
+	/** Begin a shadow level */
+	void PushState();
+
+	/** Drop all writes made since the matching PushState */
+	void PopState();
+
+	/** Number of writes on top of the snapshot */
+	int32 GetNumWrites() const { return Writes.Num(); }
+
+	/** Drop the writes newer writes to the same slot hide, outside of shadow levels only; for overlays living through many writes */
+	void Compact();
+
+	/** Visit the newest write of every written slot, String is set for string slots */
+	void ForEachLatestWrite(TFunctionRef<void(const FDialogueVariableSlot& Slot, int32 Value, const FString* String)> Visitor) const;
+
+private:
+	struct FWrite
+	{
+		FDialogueVariableSlot Slot;
+		/** Bool (0/1) or int value, index into Strings for strings */
+		int32 Value;
+	};
+
+	/** Newest write to a slot, null if it was not written */
+	const FWrite* FindWrite(const FDialogueVariableSlot& Slot) const;
+
+	FDialogueVariableSnapshotRef Snapshot;
+
+	TArray<FWrite> Writes;
+
+	/** Written strings; indirect, scripts hold pointers to them while they run */
+	TIndirectArray<FString> Strings;
+
+	/** Writes.Num() and Strings.Num() at each PushState */
+	TArray<TPair<int32, int32>> Markers;
+};
+
+/**
+ * Variables read while a recorder is installed on a global variable set
+ */
+struct FDialogueVariableReadSet
+{
+	TSet<FDialogueVariableSlot> Slots;
+
+	/** Something was read that cannot be tracked by slot, e.g. a user method */
+	bool bHasUntrackedReads = false;
+
+	void Reset()
+	{
+		Slots.Reset();
+		bHasUntrackedReads = false;
+	}
+};
+
+/**
+ * Old value of a variable written during a shadow operation
+ */
+struct FDialogueVariableJournalEntry
+{
+	FDialogueVariableSlot Slot;
+
+	/** Old bool (0/1) or int value */
+	int32 OldValue = 0;
+
+	/** Old string value */
+	FString OldString;
+};
 
 /**
- * Base class for a dialogue variable
+ * Base class for a dialogue variable. The value itself lives in the owning
+ * UDialogueGlobalVariables; this object is a view onto its slot.
  */
 UCLASS(BlueprintType, Abstract)
 class DIALOGUERUNTIME_API UDialogueVariable : public UObject
@@ -22,10 +207,17 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Variable")
 	FString VariableName;
 
+	/** Storage slot of this variable */
+	UPROPERTY(BlueprintReadOnly, Category = "Variable")
+	FDialogueVariableSlot Slot;
+
 	/** Called when the variable value changes */
 	UPROPERTY(BlueprintAssignable, Category = "Variable")
 	FOnDialogueVariableChanged OnVariableChanged;
 
+	/** OnVariableChanged for C++ listeners, broadcast before it without going through reflection */
+	FOnDialogueVariableChangedNative OnVariableChangedNative;
+
 	/** Get the containing global variables object */
 	UDialogueGlobalVariables* GetGlobalVariables() const;
 
@@ -33,6 +225,9 @@ protected:
 	UPROPERTY()
 	UDialogueGlobalVariables* OwningGlobalVariables;
 
+	/** Broadcast both change events, the dynamic one only if Blueprints listen to it */
+	void BroadcastChanged() const;
+
 	friend class UDialogueGlobalVariables;
 };
 
@@ -45,20 +240,11 @@ class DIALOGUERUNTIME_API UDialogueBoolVariable : public UDialogueVariable
 	GENERATED_BODY()
 
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
-	bool Value = false;
-
 	UFUNCTION(BlueprintCallable, Category = "Variable")
 	void SetValue(bool NewValue);
 
 	UFUNCTION(BlueprintPure, Category = "Variable")
-	bool GetValue() const { return Value; }
-
-protected:
-	/** Shadow stack for speculative execution */
-	TArray<bool> ShadowStack;
-
-	friend class UDialogueGlobalVariables;
+	bool GetValue() const;
 };
 
 /**
@@ -70,25 +256,17 @@ class DIALOGUERUNTIME_API UDialogueIntVariable : public UDialogueVariable
 	GENERATED_BODY()
 
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
-	int32 Value = 0;
-
 	UFUNCTION(BlueprintCallable, Category = "Variable")
 	void SetValue(int32 NewValue);
 
 	UFUNCTION(BlueprintPure, Category = "Variable")
-	int32 GetValue() const { return Value; }
+	int32 GetValue() const;
 
 	UFUNCTION(BlueprintCallable, Category = "Variable")
-	void Add(int32 Amount) { SetValue(Value + Amount); }
+	void Add(int32 Amount) { SetValue(GetValue() + Amount); }
 
 	UFUNCTION(BlueprintCallable, Category = "Variable")
-	void Subtract(int32 Amount) { SetValue(Value - Amount); }
-
-protected:
-	TArray<int32> ShadowStack;
-
-	friend class UDialogueGlobalVariables;
+	void Subtract(int32 Amount) { SetValue(GetValue() - Amount); }
 };
 
 /**
@@ -100,19 +278,11 @@ class DIALOGUERUNTIME_API UDialogueStringVariable : public UDialogueVariable
 	GENERATED_BODY()
 
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
-	FString Value;
-
 	UFUNCTION(BlueprintCallable, Category = "Variable")
 	void SetValue(const FString& NewValue);
 
 	UFUNCTION(BlueprintPure, Category = "Variable")
-	FString GetValue() const { return Value; }
-
-protected:
-	TArray<FString> ShadowStack;
-
-	friend class UDialogueGlobalVariables;
+	FString GetValue() const;
 };
 
 /**
@@ -186,6 +356,166 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Variables")
 	void SetString(const FString& FullName, const FString& Value);
 
+	// ==================== SLOTS ====================
+
+	/** Resolve a variable name (Namespace.Variable) to its slot; resolve once and keep the handle */
+	UFUNCTION(BlueprintCallable, Category = "Variables")
+	FDialogueVariableSlot FindSlot(const FString& FullName) const;
+
+	/** Check that a slot refers to a variable of this set */
+	bool IsValidSlot(const FDialogueVariableSlot& Slot) const { return Store.IsValidSlot(Slot); }
+
+	/** Get the variable view for a slot */
+	UDialogueVariable* GetVariable(const FDialogueVariableSlot& Slot) const;
+
+	bool GetBool(const FDialogueVariableSlot& Slot) const
+	{
+		check(Slot.Type == EDialogueVariableType::Boolean);
+		RecordRead(Slot);
+		return Store.GetBool(Slot.Index);
+	}
+
+	int32 GetInt(const FDialogueVariableSlot& Slot) const
+	{
+		check(Slot.Type == EDialogueVariableType::Integer);
+		RecordRead(Slot);
+		return Store.Ints[Slot.Index];
+	}
+
+	const FString& GetString(const FDialogueVariableSlot& Slot) const
+	{
+		check(Slot.Type == EDialogueVariableType::String);
+		RecordRead(Slot);
+		return Store.Strings[Slot.Index];
+	}
+
+	void SetBool(const FDialogueVariableSlot& Slot, bool Value);
+	void SetInt(const FDialogueVariableSlot& Slot, int32 Value);
+	void SetString(const FDialogueVariableSlot& Slot, const FString& Value);
+
+	/** The bools packed 64 to a word, bool slot N is bit N % 64 of word N / 64; for conditions lowered to mask tests */
+	TArrayView<const uint64> GetBoolWords() const { return Store.BoolBits; }
+
+	/** Note reads of the bools whose bits are set in Bits, for tests on a word of GetBoolWords */
+	void RecordBoolReads(int32 Word, uint64 Bits) const
+	{
+		if (ReadRecorder)
+		{
+			for (; Bits != 0; Bits &= Bits - 1)
+			{
+				ReadRecorder->Slots.Add(FDialogueVariableSlot(EDialogueVariableType::Boolean, Word * 64 + (int32)FMath::CountTrailingZeros64(Bits)));
+			}
+		}
+	}
+
+	/** Get a boolean variable by slot */
+	UFUNCTION(BlueprintPure, Category = "Variables", meta = (DisplayName = "Get Bool (Slot)"))
+	bool GetBoolBySlot(FDialogueVariableSlot Slot) const { return IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::Boolean && GetBool(Slot); }
+
+	/** Get an integer variable by slot */
+	UFUNCTION(BlueprintPure, Category = "Variables", meta = (DisplayName = "Get Int (Slot)"))
+	int32 GetIntBySlot(FDialogueVariableSlot Slot) const { return IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::Integer ? GetInt(Slot) : 0; }
+
+	/** Get a string variable by slot */
+	UFUNCTION(BlueprintPure, Category = "Variables", meta = (DisplayName = "Get String (Slot)"))
+	FString GetStringBySlot(FDialogueVariableSlot Slot) const { return IsValidSlot(Slot) && Slot.Type == EDialogueVariableType::String ? GetString(Slot) : FString(); }
+
+	/** Number of variables of a type */
+	int32 GetNumVariables(EDialogueVariableType Type) const;
+
+	/**
+	 * Add a variable, creating its namespace if needed.
+	 * Used by the importer to build the default variable set.
+	 */
+	FDialogueVariableSlot AddVariable(const FString& NamespaceName, const FString& VariableName, EDialogueVariableType Type, const FString& DefaultValue);
+
+	/**
+	 * Add the variables of another set this one lacks, with the other set's values, e.g. those of mounted packages.
+	 * Existing variables and their slots are left alone. Never inside a shadow operation; returns the number added.
+	 */
+	int32 MergeVariables(const UDialogueGlobalVariables& Other);
+
+	// ==================== SNAPSHOTS ====================
+
+	/**
+	 * Publish the committed values as a new snapshot if they changed since the last one.
+	 * Game thread only, and never inside a shadow operation.
+	 */
+	void PublishSnapshot();
+
+	/** Latest published snapshot, null before the first PublishSnapshot. Safe to call from any thread. */
+	FDialogueVariableSnapshotPtr GetSnapshot() const;
+
+	/** Called for every committed (unshadowed) variable change */
+	FOnDialogueVariableSlotChanged OnSlotChanged;
+
+	// ==================== CHECKSUM ====================
+
+	/**
+	 * Checksum of the committed values, for the peers of a lockstep or co-op session to compare instead of
+	 * serializing the variables. Updated on every committed write and free to query; only the first call after
+	 * loading visits all variables. Sets agree if they hold the same values in the same slots.
+	 */
+	uint64 GetStateChecksum() const;
+
+	/**
+	 * Hash of every committed value in slot order, booleans first, then integers, then strings.
+	 * Visits all variables, meant for finding where a mismatching checksum comes from, outside shadow operations.
+	 */
+	TArray<uint32> GetSlotHashes() const;
+
+	/** The first slot whose hash differs from a peer's GetSlotHashes, logged with its variable; invalid if none does */
+	FDialogueVariableSlot FindDivergingSlot(TConstArrayView<uint32> PeerHashes) const;
+
+	// ==================== SAVE STATE ====================
+
+	/**
+	 * Write the values to a save state, see FDialogueStateSnapshot: a name table per type followed by the
+	 * value arrays of the store as they are, without going through the variable objects.
+	 */
+	void SaveState(FArchive& Ar) const;
+
+	/**
+	 * Read a save state written by SaveState, only variables whose value changed are notified.
+	 * If the variables are not the ones of the save state, they are matched by name: RenamedVariables maps
+	 * old full names to new ones, removed variables and variables whose type changed are skipped.
+	 * Returns false if the data could not be read, nothing is changed then.
+	 */
+	bool LoadState(FArchive& Ar, const TMap<FString, FString>& RenamedVariables);
+
+	// ==================== NOTIFICATIONS ====================
+
+	/**
+	 * Collect committed changes and broadcast the OnVariableChanged of every changed variable only once,
+	 * at the end of the frame, instead of on each write.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variables")
+	bool bDeferVariableNotifications = false;
+
+	/** Called once per frame with all slots whose committed value changed */
+	UPROPERTY(BlueprintAssignable, Category = "Variables")
+	FOnDialogueVariablesChanged OnVariablesChanged;
+
+	/** Send the pending notifications now instead of at the end of the frame */
+	UFUNCTION(BlueprintCallable, Category = "Variables")
+	void FlushVariableNotifications();
+
+	virtual void BeginDestroy() override;
+
+	// ==================== READ TRACKING ====================
+
+	/** Install a recorder that collects every slot read until it is removed again (nullptr) */
+	void SetReadRecorder(FDialogueVariableReadSet* Recorder) { ReadRecorder = Recorder; }
+
+	/** Note a read that depends on state outside this variable set */
+	void RecordUntrackedRead() const
+	{
+		if (ReadRecorder)
+		{
+			ReadRecorder->bHasUntrackedReads = true;
+		}
+	}
+
 	// ==================== SHADOW STATE ====================
 
 	/** Push state for shadow operation */
@@ -197,18 +527,109 @@ public:
 	/** Get current shadow level */
 	int32 GetShadowLevel() const { return ShadowLevel; }
 
+	/** Old values saved by writes while shadowed, restored when the states are popped */
+	int32 GetNumShadowedValues() const { return Journal.Num(); }
+
+	/** Number of variable namespaces */
+	int32 GetNumNamespaces() const { return Namespaces.Num(); }
+
 protected:
 	/** All namespaces */
 	UPROPERTY()
 	TMap<FString, UDialogueVariableNamespace*> Namespaces;
 
+	/** Variable values */
+	UPROPERTY()
+	FDialogueVariableStore Store;
+
+	/** Slots by full variable name */
+	UPROPERTY()
+	TMap<FString, FDialogueVariableSlot> SlotsByName;
+
+	/** Variable views, indexed by slot */
+	UPROPERTY()
+	TArray<UDialogueVariable*> BoolVariables;
+
+	UPROPERTY()
+	TArray<UDialogueVariable*> IntVariables;
+
+	UPROPERTY()
+	TArray<UDialogueVariable*> StringVariables;
+
+	/** Old values of variables written while shadowed, newest last */
+	TArray<FDialogueVariableJournalEntry> Journal;
+
+	/** Journal length at each PushState, one per shadow level */
+	TArray<int32> JournalMarkers;
+
 	/** Current shadow level */
 	UPROPERTY(Transient)
 	int32 ShadowLevel = 0;
 
+	/** Active read recorder */
+	FDialogueVariableReadSet* ReadRecorder = nullptr;
+
+	/** Latest published snapshot, swapped under SnapshotLock */
+	FDialogueVariableSnapshotPtr Snapshot;
+
+	mutable FRWLock SnapshotLock;
+
+	/** Slot names of the published snapshots, reset when variables are added */
+	TSharedPtr<const TMap<FString, FDialogueVariableSlot>, ESPMode::ThreadSafe> SnapshotSlotsByName;
+
+	/** Committed values changed since the last snapshot */
+	bool bSnapshotDirty = true;
+
+	/** Slots changed since the last notification flush */
+	TSet<FDialogueVariableSlot> DirtySlots;
+
+	/** Pending flush at the end of the frame */
+	FTSTicker::FDelegateHandle NotificationTickerHandle;
+
+	/** Sum of the hashes of all committed values, see GetStateChecksum; only kept up to date once computed */
+	mutable uint64 StateChecksum = 0;
+	mutable bool bStateChecksumValid = false;
+
+	/** Hash of the value a slot holds in the store, see GetStateChecksum */
+	uint64 HashSlotValue(const FDialogueVariableSlot& Slot) const;
+
+	/** Compute StateChecksum from all variables if it is not, only valid outside shadow operations */
+	void ComputeStateChecksum() const;
+
+	/** Add a committed value to or remove it from StateChecksum, before and after it changes */
+	void AddToStateChecksum(const FDialogueVariableSlot& Slot)
+	{
+		if (bStateChecksumValid && ShadowLevel == 0)
+		{
+			StateChecksum += HashSlotValue(Slot);
+		}
+	}
+
+	void RemoveFromStateChecksum(const FDialogueVariableSlot& Slot)
+	{
+		if (bStateChecksumValid && ShadowLevel == 0)
+		{
+			StateChecksum -= HashSlotValue(Slot);
+		}
+	}
+
+	void RecordRead(const FDialogueVariableSlot& Slot) const
+	{
+		if (ReadRecorder)
+		{
+			ReadRecorder->Slots.Add(Slot);
+		}
+	}
+
 	/** Register a namespace */
 	void RegisterNamespace(UDialogueVariableNamespace* Namespace);
 
+	/** Move the current value of a slot to the journal before it is overwritten in a shadow operation, or note a committed change */
+	void RecordWrite(const FDialogueVariableSlot& Slot);
+
+	/** Broadcast the change event of the variable in a slot, or queue it for the next flush */
+	void NotifyChanged(const FDialogueVariableSlot& Slot);
+
 	/** Parse full variable name into namespace and variable */
 	static bool ParseVariableName(const FString& FullName, FString& OutNamespace, FString& OutVariable);
 
@@ -0,0 +1,123 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+
+class FSocket;
+class FTcpListener;
+struct FIPv4Endpoint;
+
+/**
+ * A small edit of loaded dialogue objects, sent by the dialogue editor while the game runs instead of a full
+ * export and re-import. Objects are patched in place, so the edit lasts until their package is loaded again.
+ * Each patch is a JSON object, a message is one patch or an array of patches applied together:
+ *
+ *   {"op": "setText", "id": "<Id>", "field": "text", "value": "..."}
+ *       field is text, menuText or stageDirections of a dialogue, description or displayName of a flow fragment,
+ *       displayName of a hub
+ *   {"op": "setScript", "id": "<Id>", "value": "Game.Gold >= 5"}
+ *       the script of a condition or instruction node, or with "inputPin": N or "outputPin": N that of a pin
+ *   {"op": "connect", "id": "<Id>", "outputPin": 0, "target": "<Id>", "targetPin": 0}
+ *   {"op": "disconnect", "id": "<Id>", "outputPin": 0, "target": "<Id>", "targetPin": 0}
+ *
+ * IDs are the ones the dialogue editor writes. Text patches only refresh the texts' caches, script and
+ * connection patches also rebuild the flow graph.
+ */
+struct DIALOGUERUNTIME_API FDialogueLivePatch
+{
+	enum class EOperation : uint8
+	{
+		SetText,
+		SetScript,
+		Connect,
+		Disconnect
+	};
+
+	EOperation Operation = EOperation::SetText;
+
+	/** Object to patch */
+	FString Id;
+
+	/** Property a SetText patch writes */
+	FString Field;
+
+	/** Text or script expression */
+	FString Value;
+
+	/** Pin of the object a script or connection patch is on, INDEX_NONE for the object itself */
+	int32 InputPin = INDEX_NONE;
+	int32 OutputPin = INDEX_NONE;
+
+	/** Node and input pin a connection patch connects to or disconnects from */
+	FString TargetId;
+	int32 TargetPin = 0;
+
+	/** Read the patches of a message, false with OutError set if one of them is malformed */
+	static bool Parse(const FString& Message, TArray<FDialogueLivePatch>& OutPatches, FString& OutError);
+
+	/**
+	 * Apply patches to the objects all running databases share, then refresh the caches of each database containing
+	 * a patched object once. Patches that fail are skipped and described in OutErrors; returns the number applied.
+	 */
+	static int32 Apply(TConstArrayView<FDialogueLivePatch> Patches, TArray<FString>& OutErrors);
+};
+
+/**
+ * Accepts connections on a local TCP port and applies the FDialogueLivePatch messages they send on the game
+ * thread. Messages are separated by newlines; every message is answered with a line "ok <Applied>" or
+ * "error <Description>". Only connections from this machine are accepted.
+ */
+class DIALOGUERUNTIME_API FDialogueLivePatchServer
+{
+public:
+	static constexpr uint16 DefaultPort = 9767;
+
+	explicit FDialogueLivePatchServer(uint16 InPort = DefaultPort);
+	~FDialogueLivePatchServer();
+
+	/** False if the port could not be opened */
+	bool IsListening() const;
+
+	uint16 GetPort() const { return Port; }
+
+	int32 GetNumConnections() const { return Connections.Num(); }
+
+private:
+	struct FConnection
+	{
+		FSocket* Socket = nullptr;
+
+		/** Received bytes of the message not yet terminated */
+		TArray<uint8> Pending;
+	};
+
+	/** Called on the listener thread */
+	bool OnConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint);
+
+	/** Take over accepted sockets and apply the messages received, called by the ticker */
+	bool Tick(float DeltaTime);
+
+	/** Read what a connection received and apply its complete messages, false once it is closed */
+	bool ReceiveMessages(FConnection& Connection);
+
+	void HandleMessage(FSocket* Socket, const FString& Message);
+
+	static void DestroySocket(FSocket* Socket);
+
+	uint16 Port;
+
+	FSocket* ListenSocket = nullptr;
+
+	/** Accepts connections on ListenSocket, null if the port could not be opened */
+	TUniquePtr<FTcpListener> Listener;
+
+	/** Sockets accepted by the listener thread, waiting for the game thread */
+	TQueue<FSocket*, EQueueMode::Mpsc> AcceptedSockets;
+
+	TArray<FConnection> Connections;
+
+	FTSTicker::FDelegateHandle TickHandle;
+};
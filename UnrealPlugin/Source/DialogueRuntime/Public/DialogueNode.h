@@ -30,6 +30,9 @@ public:
 	// IDialogueFlowObject interface
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::None; }
 	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override;
+
+	/** Plain nodes only continue on their pins. Subclasses whose Explore changes state must return true. */
+	virtual bool HasSideEffects() const override { return false; }
 };
 
 /**
@@ -43,7 +46,7 @@ class DIALOGUERUNTIME_API UDialogueDialogue : public UDialogueNode, public IDial
 public:
 	/** Speaker ID */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
-	FString SpeakerId;
+	FDialogueId SpeakerId;
 
 	/** Dialogue text */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
@@ -63,15 +66,37 @@ public:
 
 	// IDialogueFlowObject
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::Dialogue; }
+	virtual void SerializeCooked(FArchive& Ar) override;
 
 	// IDialogueObjectWithText
-	virtual FText GetText() const override { return Text; }
-	virtual FText GetMenuText() const override { return MenuText; }
-	virtual FText GetStageDirections() const override { return StageDirections; }
+	virtual FText GetText() const override { return GetCompressedText(Text, 0); }
+	virtual FText GetMenuText() const override { return GetCompressedText(MenuText, 1); }
+	virtual FText GetStageDirections() const override { return GetCompressedText(StageDirections, 2); }
+
+	/** Decompress the texts ahead of the Get functions, if they were cooked compressed */
+	void PrefetchTexts() const;
+
+	/**
+	 * Index of Text in the compressed texts of the package, followed by MenuText and StageDirections.
+	 * INDEX_NONE unless the package was cooked with compressed texts.
+	 */
+	int32 CompressedTextIndex = INDEX_NONE;
 
 	// IDialogueObjectWithSpeaker
-	virtual FString GetSpeakerId() const override { return SpeakerId; }
+	virtual FDialogueId GetSpeakerId() const override { return SpeakerId; }
 	virtual UDialogueCharacter* GetSpeaker() const override;
+
+	/** Look up the speaker in a database now instead of on the first GetSpeaker */
+	void ResolveSpeaker(const UDialogueDatabase* Database) const;
+
+private:
+	/** A text of the compressed texts unless it was set on the object */
+	FText GetCompressedText(const FText& InPlace, int32 Offset) const;
+
+	/** Speaker of CachedSpeakerId in CachedSpeakerDatabase, nodes are shared by the database instances of all worlds */
+	mutable TWeakObjectPtr<UDialogueCharacter> CachedSpeaker;
+	mutable TWeakObjectPtr<const UDialogueDatabase> CachedSpeakerDatabase;
+	mutable FDialogueId CachedSpeakerId;
 };
 
 /**
@@ -102,6 +127,7 @@ public:
 	FText Description;
 
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::FlowFragment; }
+	virtual void SerializeCooked(FArchive& Ar) override;
 };
 
 /**
@@ -117,6 +143,7 @@ public:
 	FString DisplayName;
 
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::Hub; }
+	virtual void SerializeCooked(FArchive& Ar) override;
 };
 
 /**
@@ -133,8 +160,15 @@ public:
 
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::Condition; }
 
+	virtual void PostLoad() override;
+	virtual void SerializeCooked(FArchive& Ar) override;
+
 	// IDialogueConditionProvider
 	virtual bool Evaluate(UDialogueGlobalVariables* GV = nullptr, UObject* MethodProvider = nullptr) override;
+
+	/** Continues on the first output pin if the condition holds, on the second otherwise */
+	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override;
+	virtual bool HasSideEffects() const override { return Script.HasSideEffects(); }
 };
 
 /**
@@ -151,8 +185,14 @@ public:
 
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::Instruction; }
 
+	virtual void PostLoad() override;
+	virtual void SerializeCooked(FArchive& Ar) override;
+
 	// IDialogueInstructionProvider
 	virtual void Execute(UDialogueGlobalVariables* GV = nullptr, UObject* MethodProvider = nullptr) override;
+
+	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override;
+	virtual bool HasSideEffects() const override { return Script.HasSideEffects(); }
 };
 
 /**
@@ -165,18 +205,34 @@ class DIALOGUERUNTIME_API UDialogueJump : public UDialogueNode
 
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jump")
-	FString TargetNodeId;
+	FDialogueId TargetNodeId;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jump")
 	int32 TargetPinIndex = 0;
 
+	/** Target pin resolved at import, null if it is in another package; see FDialogueConnection::TargetPin */
+	UPROPERTY(VisibleAnywhere, Category = "Jump")
+	UDialogueInputPin* TargetPin = nullptr;
+
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::Jump; }
 
+	virtual void PostLoad() override;
+	virtual void SerializeCooked(FArchive& Ar) override;
+
 	UFUNCTION(BlueprintCallable, Category = "Jump")
 	UDialogueNode* GetTargetNode() const;
 
 	UFUNCTION(BlueprintCallable, Category = "Jump")
 	UDialoguePin* GetTargetPin() const;
 
+	/** Bind the target pin for the current target, the database rebinds all jumps whenever packages are loaded or unloaded */
+	void BindTargetPin(UDialogueInputPin* Pin);
+
 	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override;
+
+private:
+	/** Target pin the database bound, only used while the target still is BoundNodeId and BoundPinIndex */
+	TWeakObjectPtr<UDialogueInputPin> BoundTargetPin;
+	FDialogueId BoundNodeId;
+	int32 BoundPinIndex = INDEX_NONE;
 };
@@ -21,7 +21,13 @@ class DIALOGUERUNTIME_API UDialogueObject : public UDataAsset
 public:
 	/** Unique identifier */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dialogue")
-	FString Id;
+	FDialogueId Id;
+
+#if WITH_EDITORONLY_DATA
+	/** ID as written by the dialogue editor */
+	UPROPERTY(VisibleAnywhere, Category = "Dialogue")
+	FString ImportId;
+#endif
 
 	/** Technical name for scripting */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dialogue")
@@ -29,11 +35,11 @@ public:
 
 	/** Parent object ID */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dialogue")
-	FString ParentId;
+	FDialogueId ParentId;
 
 	/** Child object IDs */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dialogue")
-	TArray<FString> ChildIds;
+	TArray<FDialogueId> ChildIds;
 
 	/** Get the parent object */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
@@ -43,6 +49,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	TArray<UDialogueObject*> GetChildren() const;
 
+	/** Loaded child objects in ChildIds order without copying; only valid until packages are loaded or unloaded */
+	TArrayView<UDialogueObject* const> GetChildrenView() const;
+
+	/**
+	 * Check whether the object is below Ancestor in the object hierarchy, e.g. a node inside a chapter.
+	 * Compares the positions the database numbered the loaded objects with instead of walking up the parents.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsDescendantOf(const UDialogueObject* Ancestor) const;
+
+	/**
+	 * Write or read the properties a class adds, for the compact cooked package format.
+	 * IDs, names and pins are stored by FDialogueCookedPackage itself. Overrides call Super first.
+	 */
+	virtual void SerializeCooked(FArchive& Ar) {}
+
+#if WITH_EDITOR
+	/** Objects of packages cooked in the compact format are stored in the package, see UDialoguePackage::WillCookCompact */
+	virtual bool NeedsLoadForTargetPlatform(const ITargetPlatform* TargetPlatform) const override;
+#endif
+
 protected:
 	/** Database reference for lookups */
 	UPROPERTY(Transient)
@@ -73,6 +100,9 @@ public:
 
 	/** Execute any script on this node */
 	virtual void Execute(class UDialogueGlobalVariables* GV = nullptr, UObject* MethodProvider = nullptr) {}
+
+	/** Whether exploring this object may change state, pure objects are explored without a shadow state of their own */
+	virtual bool HasSideEffects() const { return true; }
 };
 
 /**
@@ -108,7 +138,7 @@ class DIALOGUERUNTIME_API IDialogueObjectWithSpeaker
 	GENERATED_BODY()
 
 public:
-	virtual FString GetSpeakerId() const = 0;
+	virtual FDialogueId GetSpeakerId() const = 0;
 	virtual class UDialogueCharacter* GetSpeaker() const = 0;
 };
 
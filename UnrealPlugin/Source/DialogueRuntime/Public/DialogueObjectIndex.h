@@ -0,0 +1,92 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+#include "DialogueFlowGraph.h"
+
+class UDialogueObject;
+class UDialoguePackage;
+
+/**
+ * Position of an object in a depth-first walk of the object hierarchy: the descendants of an object
+ * are entered after it, up to its Exit
+ */
+struct FDialogueHierarchyRange
+{
+	int32 Enter = INDEX_NONE;
+
+	/** Largest Enter of the object and its descendants */
+	int32 Exit = INDEX_NONE;
+
+	/** Check whether the object of Other is below this one */
+	bool Contains(const FDialogueHierarchyRange& Other) const { return Other.Enter > Enter && Other.Enter <= Exit; }
+};
+
+/**
+ * Lookup tables of the loaded dialogue objects. The database publishes the index as an
+ * immutable shared instance, so a new one can be built off the game thread and swapped in.
+ * Objects are kept alive by the database, not by the index.
+ */
+struct DIALOGUERUNTIME_API FDialogueObjectIndex
+{
+	/** Objects indexed by ID */
+	TMap<FDialogueId, UDialogueObject*> ObjectsById;
+
+	/** Objects indexed by technical name */
+	TMap<FString, UDialogueObject*> ObjectsByName;
+
+	/** Objects by class, every object is also listed under all of its super classes up to UDialogueObject */
+	TMap<const UClass*, TArray<UDialogueObject*>> ObjectsByClass;
+
+	/** Number of loaded packages containing each object, an object can be part of several packages */
+	TMap<FDialogueId, int32> RefCounts;
+
+	/** Flow graph of the indexed objects */
+	FDialogueFlowGraph FlowGraph;
+
+	/** Position of every object reachable from a root in the parent hierarchy, see UDialogueObject::IsDescendantOf */
+	TMap<FDialogueId, FDialogueHierarchyRange> Hierarchy;
+
+	/** Indexed children of every object with children, in ChildIds order */
+	TMap<FDialogueId, TArray<UDialogueObject*>> ChildrenById;
+
+	/** Add an object or a reference to it, returns false if a different object with its ID is indexed */
+	bool Add(UDialogueObject* Object);
+
+	/** Release a reference to an object, it is removed with the last one */
+	void Remove(const UDialogueObject* Object);
+
+	/** Add all objects of a package */
+	void AddPackage(const UDialoguePackage* Package, bool bWarnDuplicates);
+
+	/** Remove the objects a package added, keeping those other loaded packages still contain */
+	void RemovePackage(const UDialoguePackage* Package);
+
+	/** Objects of a class and its subclasses, empty for a null class */
+	TArrayView<UDialogueObject* const> GetObjectsOfClass(const UClass* Class) const;
+
+	/** Rebuild the flow graph after objects were added or removed */
+	void BuildFlowGraph() { FlowGraph.Build(ObjectsById); }
+
+	/** Rebuild Hierarchy and ChildrenById after objects were added or removed */
+	void BuildHierarchy();
+
+	/** Indexed children of an object */
+	TArrayView<UDialogueObject* const> GetChildren(const FDialogueId& Id) const
+	{
+		const TArray<UDialogueObject*>* Children = ChildrenById.Find(Id);
+		return Children ? TArrayView<UDialogueObject* const>(*Children) : TArrayView<UDialogueObject* const>();
+	}
+
+	/** Position of an object in the hierarchy, with Enter INDEX_NONE if it is not part of it */
+	FDialogueHierarchyRange GetHierarchyRange(const FDialogueId& Id) const { return Hierarchy.FindRef(Id); }
+
+private:
+	/** Remove from the ID and name maps when the last reference goes, returns true if so */
+	bool ReleaseReference(const UDialogueObject* Object);
+
+	/** Remove objects from the class lists in one pass */
+	void RemoveFromClassLists(const TSet<const UDialogueObject*>& Objects);
+};
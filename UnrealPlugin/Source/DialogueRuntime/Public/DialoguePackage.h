@@ -4,12 +4,46 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "DialogueCookedPackage.h"
 #include "DialoguePackage.generated.h"
 
 class UDialogueObject;
 
 /**
- * A package containing dialogue objects (imported from editor)
+ * Tags dialogue packages save to the asset registry, so tools can inspect packages without loading them,
+ * see FDialoguePackageQuery in the editor module. Lists of IDs are written by FDialogueId::ToString and
+ * separated by spaces.
+ */
+namespace DialoguePackageTags
+{
+	/** Numbers of objects, of all of them and by type */
+	inline const TCHAR* const NumObjects = TEXT("NumObjects");
+	inline const TCHAR* const NumDialogues = TEXT("NumDialogues");
+	inline const TCHAR* const NumFlowFragments = TEXT("NumFlowFragments");
+	inline const TCHAR* const NumHubs = TEXT("NumHubs");
+	inline const TCHAR* const NumConditions = TEXT("NumConditions");
+	inline const TCHAR* const NumInstructions = TEXT("NumInstructions");
+	inline const TCHAR* const NumJumps = TEXT("NumJumps");
+	inline const TCHAR* const NumPins = TEXT("NumPins");
+
+	/** Characters in the texts, menu texts and stage directions of dialogues and the descriptions of flow fragments */
+	inline const TCHAR* const TextLength = TEXT("TextLength");
+
+	/** IDs of the characters speaking the dialogues, sorted */
+	inline const TCHAR* const Speakers = TEXT("Speakers");
+
+	/** IDs of all objects */
+	inline const TCHAR* const ObjectIds = TEXT("ObjectIds");
+
+	/** IDs of the nodes in other packages that connections and jumps lead to, sorted */
+	inline const TCHAR* const ExternalTargets = TEXT("ExternalTargets");
+}
+
+/**
+ * A package containing dialogue objects (imported from editor).
+ *
+ * Cooked packages store their objects in the compact FDialogueCookedPackage format by default
+ * and create them when loaded.
  */
 UCLASS(BlueprintType)
 class DIALOGUERUNTIME_API UDialoguePackage : public UDataAsset
@@ -18,7 +52,7 @@ class DIALOGUERUNTIME_API UDialoguePackage : public UDataAsset
 
 public:
 	/** Package name */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category = "Package")
 	FString Name;
 
 	/** Package description */
@@ -33,22 +67,89 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
 	TArray<UDialogueObject*> Objects;
 
+	/** Cook the objects into one compact blob instead of an export each, if all of them support it */
+	UPROPERTY(EditAnywhere, Category = "Package")
+	bool bCookCompact = true;
+
+	/**
+	 * Cook the texts of dialogues compressed, decompressing them when GetText and the like are first called.
+	 * Only packages cooked compact; the Text properties of their dialogues stay empty, read them through GetText.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Package", meta = (EditCondition = "bCookCompact"))
+	bool bCookCompressedTexts = true;
+
+	/** Primary asset type the chunk rules of UDialogueDatabase::PackageChunkIds are set up for */
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override { return FPrimaryAssetId(PrimaryAssetType, GetFName()); }
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	/** Counts, speakers and references of the objects, see DialoguePackageTags */
+	virtual void GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const override;
+#endif
+
+	/**
+	 * Loaded packages and their objects form one GC cluster, so garbage collection does not trace every pin and connection.
+	 * Their objects only change by live patches within the package; mutable state lives in the databases and flow players.
+	 */
+	virtual bool CanBeClusterRoot() const override { return true; }
+
 	/** Get all objects of a specific type */
 	template<typename T>
 	TArray<T*> GetObjectsOfType() const
 	{
+		const TArray<UDialogueObject*>& Typed = GetObjectsOfClass(T::StaticClass());
+
 		TArray<T*> Result;
-		for (UDialogueObject* Obj : Objects)
+		Result.Reserve(Typed.Num());
+		for (UDialogueObject* Obj : Typed)
 		{
-			if (T* Typed = Cast<T>(Obj))
-			{
-				Result.Add(Typed);
-			}
+			Result.Add(static_cast<T*>(Obj));
 		}
 		return Result;
 	}
 
+	/** Objects of a class and its subclasses */
+	const TArray<UDialogueObject*>& GetObjectsOfClass(const UClass* Class) const;
+
 	/** Get object count */
 	UFUNCTION(BlueprintPure, Category = "Package")
 	int32 GetObjectCount() const { return Objects.Num(); }
+
+	/** Rebuild the class lists on the next query, needed when Objects changed without changing its size */
+	void InvalidateObjectsByClass() { ObjectsByClassCount = INDEX_NONE; CookCompactCount = INDEX_NONE; }
+
+	/**
+	 * Resolve the target pins of jumps and connections that lie in this package, so the runtime follows
+	 * them without a lookup. Targets in other packages are left to the lookup by ID.
+	 * @return Whether any resolved target changed
+	 */
+	bool ResolveTargetPins();
+
+	/** Whether the objects are cooked in the compact format, they are then not cooked as exports of their own */
+	bool WillCookCompact() const;
+
+	/** Texts of the dialogues of a package cooked with compressed texts */
+	const FDialogueCompressedTexts& GetCompressedTexts() const { return CompressedTexts; }
+
+private:
+	FDialogueCompressedTexts CompressedTexts;
+
+	/** Objects of a cooked package until they are created on PostLoad */
+	FDialogueCookedPackage CookedObjects;
+
+	/** Build CookedObjects from Objects when cooking, fetching the blob from the derived data cache if it was built before */
+	void BuildCookedObjects(EDialogueEditorOnlyData Keep);
+
+	/** Cached result of WillCookCompact and the number of objects it was computed for */
+	mutable bool bWillCookCompact = false;
+	mutable int32 CookCompactCount = INDEX_NONE;
+
+	/** Objects by class including super classes, built on demand */
+	mutable TMap<const UClass*, TArray<UDialogueObject*>> ObjectsByClass;
+
+	/** Number of objects ObjectsByClass was built from, INDEX_NONE if never built */
+	mutable int32 ObjectsByClassCount = INDEX_NONE;
 };
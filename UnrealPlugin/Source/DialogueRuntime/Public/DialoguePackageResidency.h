@@ -0,0 +1,56 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Last use and resident memory of the loaded packages of a database, to pick the least recently used
+ * ones to unload once all of them take more than a budget. Pinned packages are never picked.
+ */
+struct DIALOGUERUNTIME_API FDialoguePackageResidency
+{
+	/** Mark a package used now */
+	void Touch(const FString& PackageName);
+
+	/** Track a loaded package with its resident memory, measured once as it loads; marks it used */
+	void AddLoaded(const FString& PackageName, int64 Bytes);
+
+	/** Stop tracking an unloaded package, its pins are kept for when it loads again */
+	void RemoveLoaded(const FString& PackageName);
+
+	/** Keep a package loaded, also if it is not loaded yet, until it is unpinned as often */
+	void Pin(const FString& PackageName);
+	void Unpin(const FString& PackageName);
+	bool IsPinned(const FString& PackageName) const;
+
+	/** Memory of all tracked packages */
+	int64 GetResidentBytes() const { return ResidentBytes; }
+
+	/** Unpinned packages to unload to get down to Budget, least recently used first; packages CanUnload rejects are skipped */
+	TArray<FString> SelectUnloads(int64 Budget, TFunctionRef<bool(const FString&)> CanUnload) const;
+
+	/** Forget all packages and pins */
+	void Reset();
+
+private:
+	struct FEntry
+	{
+		/** UseClock when last used */
+		uint64 LastUse = 0;
+
+		/** Resident memory, 0 while not loaded */
+		int64 Bytes = 0;
+
+		int32 Pins = 0;
+
+		bool bLoaded = false;
+	};
+
+	TMap<FString, FEntry> Entries;
+
+	/** Counts uses, orders packages by last use without reading the time */
+	uint64 UseClock = 0;
+
+	int64 ResidentBytes = 0;
+};
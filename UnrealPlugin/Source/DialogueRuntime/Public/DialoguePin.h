@@ -8,6 +8,38 @@
 
 class UDialogueConnection;
 class UDialogueNode;
+class UDialogueInputPin;
+class UDialogueDatabase;
+
+/**
+ * Connection from an output pin to an input pin, stored inline in the output pin.
+ *
+ * Targets in the same package are resolved at import and followed directly, others are looked up
+ * by TargetNodeId in the database.
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUERUNTIME_API FDialogueConnection
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connection")
+	FDialogueId TargetNodeId;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connection")
+	int32 TargetPinIndex = 0;
+
+	/** Target pin resolved at import, null if it is in another package */
+	UPROPERTY(VisibleAnywhere, Category = "Connection")
+	UDialogueInputPin* TargetPin = nullptr;
+
+	/** Get the target node, looked up in Database unless the target pin is resolved */
+	UDialogueNode* GetTargetNode(const UDialogueDatabase* Database) const;
+
+	UDialogueInputPin* GetTargetPin(const UDialogueDatabase* Database) const;
+
+	/** Whether Pin is the pin at NodeId and PinIndex */
+	static bool IsTargetPin(const UDialogueInputPin* Pin, const FDialogueId& NodeId, int32 PinIndex);
+};
 
 /**
  * Base class for dialogue pins
@@ -24,7 +56,7 @@ public:
 
 	/** Owner node ID */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pin")
-	FString OwnerId;
+	FDialogueId OwnerId;
 
 	/** Pin index */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pin")
@@ -34,9 +66,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Pin")
 	UDialogueNode* GetOwner() const;
 
+	virtual void SerializeCooked(FArchive& Ar) override;
+
 	// IDialogueFlowObject
 	virtual EDialoguePausableType GetPausableType() const override { return EDialoguePausableType::Pin; }
 	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override {}
+	virtual bool HasSideEffects() const override { return false; }
 };
 
 /**
@@ -52,10 +87,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Script")
 	FDialogueScript Script;
 
+	virtual void PostLoad() override;
+	virtual void SerializeCooked(FArchive& Ar) override;
+
 	// IDialogueConditionProvider
 	virtual bool Evaluate(UDialogueGlobalVariables* GV = nullptr, UObject* MethodProvider = nullptr) override;
 
 	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override;
+	virtual bool HasSideEffects() const override { return Script.HasSideEffects(); }
 };
 
 /**
@@ -69,7 +108,11 @@ class DIALOGUERUNTIME_API UDialogueOutputPin : public UDialoguePin, public IDial
 public:
 	/** Connections from this pin */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connections")
-	TArray<UDialogueConnection*> Connections;
+	TArray<FDialogueConnection> Edges;
+
+	/** Connection objects of packages imported before connections were stored in Edges, moved there on load */
+	UPROPERTY()
+	TArray<UDialogueConnection*> LegacyConnections;
 
 	/** Script to execute */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Script")
@@ -79,14 +122,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pin")
 	FString Label;
 
+	virtual void PostLoad() override;
+	virtual void SerializeCooked(FArchive& Ar) override;
+
 	// IDialogueInstructionProvider
 	virtual void Execute(UDialogueGlobalVariables* GV = nullptr, UObject* MethodProvider = nullptr) override;
 
 	virtual void Explore(UDialogueFlowPlayer* Player, TArray<FDialogueBranch>& OutBranches, int32 Depth) override;
+	virtual bool HasSideEffects() const override { return Script.HasSideEffects(); }
+
+	/** Number of connections, for Blueprints that read them like the connection objects pins used to have */
+	UFUNCTION(BlueprintPure, Category = "Connections")
+	int32 GetNumConnections() const { return Edges.Num(); }
+
+	/** Target pin of a connection, null if the index is out of range or the target is not loaded */
+	UFUNCTION(BlueprintCallable, Category = "Connections")
+	UDialogueInputPin* GetConnectionTarget(int32 ConnectionIndex) const;
 };
 
 /**
- * Connection between pins
+ * Connection of packages imported before connections were stored inline as FDialogueConnection.
+ * Output pins move these into their Edges on load, they are neither saved again nor cooked.
  */
 UCLASS(BlueprintType)
 class DIALOGUERUNTIME_API UDialogueConnection : public UObject
@@ -95,14 +151,15 @@ class DIALOGUERUNTIME_API UDialogueConnection : public UObject
 
 public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connection")
-	FString TargetNodeId;
+	FDialogueId TargetNodeId;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Connection")
 	int32 TargetPinIndex = 0;
 
-	UFUNCTION(BlueprintCallable, Category = "Connection")
-	UDialogueNode* GetTargetNode() const;
+	UPROPERTY(VisibleAnywhere, Category = "Connection")
+	UDialogueInputPin* TargetPin = nullptr;
 
-	UFUNCTION(BlueprintCallable, Category = "Connection")
-	UDialogueInputPin* GetTargetPin() const;
+#if WITH_EDITOR
+	virtual bool NeedsLoadForTargetPlatform(const ITargetPlatform* TargetPlatform) const override { return false; }
+#endif
 };
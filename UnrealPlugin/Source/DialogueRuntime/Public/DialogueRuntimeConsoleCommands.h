@@ -0,0 +1,59 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/Ticker.h"
+
+class FDialogueRuntimeModule;
+class FDialogueLivePatchServer;
+
+/**
+ * Console commands reporting the live state of the dialogue runtime.
+ * Dialogue.Stats prints the loaded packages, objects, variables, shadow state, cache hit rates and
+ * flow players of all worlds. With -csvDialogueStats[=Seconds] on the command line, or
+ * "Dialogue.Stats csv [Seconds]", a row of the same numbers is appended to a CSV file periodically.
+ * Dialogue.LivePatch, or -DialogueLivePatch[=Port] on the command line, accepts patches from the dialogue
+ * editor, see FDialogueLivePatchServer; not available in shipping builds.
+ */
+class FDialogueRuntimeConsoleCommands
+{
+public:
+	explicit FDialogueRuntimeConsoleCommands(const FDialogueRuntimeModule& InModule);
+	~FDialogueRuntimeConsoleCommands();
+
+	/** Print the state of the runtime; "csv [Seconds]" starts CSV logging, "csv off" stops it */
+	void Stats(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar);
+
+	/** Start accepting live patches on a port, the default one without arguments; "off" stops */
+	void LivePatch(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar);
+
+private:
+	/** Start appending a row to a new CSV file every Interval seconds */
+	void StartCsv(float Interval);
+
+	void StopCsv();
+
+	/** Append a row to the CSV file, called by the ticker */
+	bool WriteCsvRow(float DeltaTime);
+
+	const FDialogueRuntimeModule& Module;
+
+	FAutoConsoleCommand StatsCommand;
+
+	/** File written to, empty while not logging */
+	FString CsvPath;
+
+	FTSTicker::FDelegateHandle CsvHandle;
+
+#if !UE_BUILD_SHIPPING
+	FAutoConsoleCommand LivePatchCommand;
+
+	/** Null while not accepting live patches */
+	TUniquePtr<FDialogueLivePatchServer> LivePatchServer;
+
+	/** Start the server on a port, replacing a running one */
+	void StartLivePatch(uint16 Port);
+#endif
+};
@@ -7,6 +7,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDialogueRuntime, Log, All);
 
+class FDialogueRuntimeConsoleCommands;
+
 class FDialogueRuntimeModule : public IModuleInterface
 {
 public:
@@ -22,4 +24,7 @@ public:
 	{
 		return FModuleManager::Get().IsModuleLoaded("DialogueRuntime");
 	}
+
+private:
+	FDialogueRuntimeConsoleCommands* ConsoleCommands = nullptr;
 };
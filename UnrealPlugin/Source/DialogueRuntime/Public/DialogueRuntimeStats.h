@@ -0,0 +1,98 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/** Unreal Insights channel of the runtime, enable with -trace=cpu,DialogueRuntime */
+UE_TRACE_CHANNEL_EXTERN(DialogueRuntimeChannel, DIALOGUERUNTIME_API);
+
+/** Memory of the runtime in the Low-Level Memory tracker, reported under Dialogue with -llm */
+LLM_DECLARE_TAG_API(Dialogue, DIALOGUERUNTIME_API);
+LLM_DECLARE_TAG_API(Dialogue_Database, DIALOGUERUNTIME_API);
+LLM_DECLARE_TAG_API(Dialogue_Packages, DIALOGUERUNTIME_API);
+LLM_DECLARE_TAG_API(Dialogue_GlobalVariables, DIALOGUERUNTIME_API);
+LLM_DECLARE_TAG_API(Dialogue_Shadows, DIALOGUERUNTIME_API);
+LLM_DECLARE_TAG_API(Dialogue_Text, DIALOGUERUNTIME_API);
+
+/** Shown with stat Dialogue */
+DECLARE_STATS_GROUP(TEXT("Dialogue"), STATGROUP_Dialogue, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Explore"), STAT_DialogueExplore, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Explore (batched)"), STAT_DialogueExploreBatched, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Advance barks"), STAT_DialogueAdvanceBarks, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Advance sessions"), STAT_DialogueAdvanceSessions, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Query content"), STAT_DialogueQueryContent, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate condition"), STAT_DialogueEvaluate, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute instruction"), STAT_DialogueExecute, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load package"), STAT_DialogueLoadPackage, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Unload package"), STAT_DialogueUnloadPackage, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebuild indices"), STAT_DialogueRebuildIndices, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search text"), STAT_DialogueSearchText, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes visited"), STAT_DialogueNodesVisited, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Conditions evaluated"), STAT_DialogueConditionsEvaluated, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shadow pushes"), STAT_DialogueShadowPushes, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Objects duplicated"), STAT_DialogueObjectsDuplicated, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Branches produced"), STAT_DialogueBranchesProduced, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Exploration cache hits"), STAT_DialogueExplorationCacheHits, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Exploration cache misses"), STAT_DialogueExplorationCacheMisses, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Text pool hits"), STAT_DialogueTextPoolHits, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Text pool misses"), STAT_DialogueTextPoolMisses, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Speaker cache hits"), STAT_DialogueSpeakerCacheHits, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Speaker cache misses"), STAT_DialogueSpeakerCacheMisses, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Text cache hits"), STAT_DialogueTextCacheHits, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Text cache misses"), STAT_DialogueTextCacheMisses, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Lookup cache hits"), STAT_DialogueLookupCacheHits, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Lookup cache misses"), STAT_DialogueLookupCacheMisses, STATGROUP_Dialogue, DIALOGUERUNTIME_API);
+
+/** Count a scope to its stat and trace it on DialogueRuntimeChannel */
+#define DIALOGUE_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, DialogueRuntimeChannel)
+
+/**
+ * Counters of the runtime, per frame in stat Dialogue and as running totals in Unreal Insights and Dialogue.Stats.
+ * Hot paths Count into their thread's pending counts, which the operation they belong to flushes once at its end.
+ */
+struct DIALOGUERUNTIME_API FDialogueRuntimeStats
+{
+	enum class ECounter : uint8
+	{
+		NodesVisited,
+		ConditionsEvaluated,
+		ShadowPushes,
+		ObjectsDuplicated,
+		BranchesProduced,
+		ExplorationCacheHits,
+		ExplorationCacheMisses,
+		TextPoolHits,
+		TextPoolMisses,
+		SpeakerCacheHits,
+		SpeakerCacheMisses,
+		TextCacheHits,
+		TextCacheMisses,
+		LookupCacheHits,
+		LookupCacheMisses,
+		Num
+	};
+
+	/** Add to a counter right away, takes a lock as workers explore too */
+	static void AddCount(ECounter Counter, int64 Delta);
+
+	/** Add to the pending count of the calling thread */
+	static void Count(ECounter Counter, int64 Delta = 1);
+
+	/** Add the pending counts of the calling thread */
+	static void Flush();
+
+	/** Running total of a counter since the module was loaded, without the pending counts */
+	static int64 GetTotal(ECounter Counter);
+
+private:
+	static int64* GetPendingCounts();
+};
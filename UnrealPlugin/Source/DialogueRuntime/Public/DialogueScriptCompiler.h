@@ -0,0 +1,52 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+
+class UDialogueGlobalVariables;
+
+/**
+ * Compiles dialogue script expressions into FDialogueScriptProgram bytecode.
+ *
+ * Conditions are a single expression, e.g. "Game.Chapter >= 2 && !Quest.Done".
+ * Instructions are statements separated by ';', e.g. "Game.Gold += 5; Quest.Done = true".
+ * Supported: bool/int/string literals, Namespace.Variable reads and writes,
+ * = += -= *= /= assignments, ! - unary operators, arithmetic, comparisons,
+ * && || with short-circuiting and calls to user methods on the methods provider.
+ * Conditions of only bool variables, !, && and || are additionally lowered to mask tests on the packed bools.
+ */
+class DIALOGUERUNTIME_API FDialogueScriptCompiler
+{
+public:
+	/**
+	 * Compile an expression.
+	 * @return false on a syntax error, in which case OutError describes the problem and OutProgram is empty.
+	 */
+	static bool Compile(const FString& Expression, bool bIsCondition, FDialogueScriptProgram& OutProgram, FString* OutError = nullptr);
+
+	/** Compile a script in place */
+	static bool Compile(FDialogueScript& Script, FString* OutError = nullptr);
+
+	/**
+	 * Resolve the variables of a program to slots of a global variable set, so the VM
+	 * does not look them up by name. Unbound programs still run, resolving names on use.
+	 * @return the number of variables that could not be resolved.
+	 */
+	static int32 BindVariables(FDialogueScriptProgram& Program, const UDialogueGlobalVariables* GV);
+
+	/**
+	 * Lower the bool terms a condition was compiled to into mask tests on the words of its bound slots, see
+	 * FDialogueBoolMask. Called by BindVariables; conditions reading a variable that is not a bool get no masks.
+	 */
+	static void BuildBoolMasks(FDialogueScriptProgram& Program);
+
+	/**
+	 * Fuse pure conditions into one program that is true if all of them are, testing them in order and stopping at the
+	 * first that fails. Conditions equal to one fused before are tested once, and the fused program shares one table of
+	 * constants and variables, so each variable is bound once. Conditions of only bools keep their masks.
+	 * @return false if a condition is impure or the fused program would exceed the limits of the bytecode.
+	 */
+	static bool FuseConditions(TConstArrayView<const FDialogueScriptProgram*> Conditions, FDialogueScriptProgram& OutProgram);
+};
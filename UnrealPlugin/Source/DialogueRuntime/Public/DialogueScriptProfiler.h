@@ -0,0 +1,76 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+struct FDialogueScriptProgram;
+
+/**
+ * Opt-in profiler of the script VM.
+ * While enabled every condition and instruction run is timed by its program. Expressions and the
+ * objects they belong to are only looked up when the records are dumped, so recording stays cheap.
+ * Controlled with the Dialogue.ScriptProfiler.Start/Stop/Reset/Dump console commands.
+ */
+struct DIALOGUERUNTIME_API FDialogueScriptProfiler
+{
+	struct FRecord
+	{
+		int64 Calls = 0;
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+		bool bInstruction = false;
+	};
+
+	/** A record with the script it belongs to, as dumped */
+	struct FResolvedRecord : FRecord
+	{
+		FString Expression;
+		FString Owner;
+		uint32 Hash = 0;
+	};
+
+	static bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+
+	/** Start or stop recording, the records are kept until Reset */
+	static void SetEnabled(bool bInEnabled) { bEnabled.store(bInEnabled, std::memory_order_relaxed); }
+
+	static void Reset();
+
+	/** Record one run of a program, workers record as well */
+	static void Record(const FDialogueScriptProgram* Program, bool bInstruction, double Seconds);
+
+	/** Records mapped back to their scripts, most expensive in total first. Programs no loaded object holds are left out. */
+	static TArray<FResolvedRecord> Resolve();
+
+	/** Write the resolved records as CSV, to a timestamped file in the profiling directory if Path is empty. Returns the path written to, empty on failure. */
+	static FString DumpCsv(const FString& Path = FString());
+
+private:
+	static std::atomic<bool> bEnabled;
+};
+
+/** Times the program run in its scope if the profiler is enabled */
+struct FDialogueScriptProfileScope
+{
+	FDialogueScriptProfileScope(const FDialogueScriptProgram& InProgram, bool bInInstruction)
+		: Program(FDialogueScriptProfiler::IsEnabled() ? &InProgram : nullptr)
+		, bInstruction(bInInstruction)
+		, StartCycles(Program ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FDialogueScriptProfileScope()
+	{
+		if (Program)
+		{
+			FDialogueScriptProfiler::Record(Program, bInstruction, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+	}
+
+private:
+	const FDialogueScriptProgram* Program;
+	bool bInstruction;
+	uint64 StartCycles;
+};
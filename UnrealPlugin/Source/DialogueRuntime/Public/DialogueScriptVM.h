@@ -0,0 +1,215 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+
+class UDialogueGlobalVariables;
+class FDialogueVariableOverlay;
+
+/**
+ * Instruction set of the dialogue script VM.
+ *
+ * Every instruction is one uint32: the opcode in the low byte followed by
+ * three 8-bit operands A, B and C. Instructions taking a constant, variable
+ * or jump target use B and C together as a 16-bit operand (Bx).
+ */
+enum class EDialogueScriptOp : uint8
+{
+	LoadInt,          // R[A] = IntConstants[Bx]
+	LoadBool,         // R[A] = (bool)B
+	LoadString,       // R[A] = StringConstants[Bx]
+	LoadVar,          // R[A] = Variables[Bx]
+	StoreVar,         // Variables[Bx] = R[A]
+	Move,             // R[A] = R[B]
+	Not,              // R[A] = !R[B]
+	Negate,           // R[A] = -R[B]
+	Add,              // R[A] = R[B] + R[C]
+	Subtract,         // R[A] = R[B] - R[C]
+	Multiply,         // R[A] = R[B] * R[C]
+	Divide,           // R[A] = R[B] / R[C]
+	Modulo,           // R[A] = R[B] % R[C]
+	Equal,            // R[A] = R[B] == R[C]
+	NotEqual,         // R[A] = R[B] != R[C]
+	Less,             // R[A] = R[B] < R[C]
+	LessEqual,        // R[A] = R[B] <= R[C]
+	Greater,          // R[A] = R[B] > R[C]
+	GreaterEqual,     // R[A] = R[B] >= R[C]
+	ToBool,           // R[A] = (bool)R[B]
+	Jump,             // PC = Bx
+	JumpIfFalse,      // if (!R[A]) PC = Bx
+	JumpIfTrue,       // if (R[A]) PC = Bx
+	CallMethod,       // R[A] = Methods[B](R[A + 1] .. R[A + C])
+	Return,           // return R[A]
+	ReturnNone,       // return nothing (instructions)
+
+	Count
+};
+
+namespace DialogueScript
+{
+	/** Maximum number of registers a program may use */
+	static constexpr int32 MaxRegisters = 32;
+
+	/** Maximum number of arguments of a user method call */
+	static constexpr int32 MaxMethodArgs = 8;
+
+	FORCEINLINE uint32 Encode(EDialogueScriptOp Op, uint8 A = 0, uint8 B = 0, uint8 C = 0)
+	{
+		return (uint32)Op | ((uint32)A << 8) | ((uint32)B << 16) | ((uint32)C << 24);
+	}
+
+	FORCEINLINE uint32 EncodeBx(EDialogueScriptOp Op, uint8 A, uint16 Bx)
+	{
+		return (uint32)Op | ((uint32)A << 8) | ((uint32)Bx << 16);
+	}
+
+	FORCEINLINE EDialogueScriptOp GetOp(uint32 Instruction) { return (EDialogueScriptOp)(Instruction & 0xFF); }
+	FORCEINLINE uint8 GetA(uint32 Instruction) { return (Instruction >> 8) & 0xFF; }
+	FORCEINLINE uint8 GetB(uint32 Instruction) { return (Instruction >> 16) & 0xFF; }
+	FORCEINLINE uint8 GetC(uint32 Instruction) { return (Instruction >> 24) & 0xFF; }
+	FORCEINLINE uint16 GetBx(uint32 Instruction) { return (Instruction >> 16) & 0xFFFF; }
+}
+
+/**
+ * Value held in a VM register. Strings are never copied; they point either
+ * into the program's constant table or at a variable's storage.
+ */
+struct FDialogueScriptValue
+{
+	enum class EType : uint8
+	{
+		None,
+		Bool,
+		Int,
+		String
+	};
+
+	EType Type = EType::None;
+
+	union
+	{
+		bool Bool;
+		int32 Int;
+		const FString* String;
+	};
+
+	FDialogueScriptValue() : Int(0) {}
+
+	static FDialogueScriptValue MakeBool(bool Value) { FDialogueScriptValue V; V.Type = EType::Bool; V.Bool = Value; return V; }
+	static FDialogueScriptValue MakeInt(int32 Value) { FDialogueScriptValue V; V.Type = EType::Int; V.Int = Value; return V; }
+	static FDialogueScriptValue MakeString(const FString* Value) { FDialogueScriptValue V; V.Type = EType::String; V.String = Value; return V; }
+
+	bool IsString() const { return Type == EType::String; }
+
+	bool AsBool() const
+	{
+		switch (Type)
+		{
+		case EType::Bool: return Bool;
+		case EType::Int: return Int != 0;
+		case EType::String: return String && !String->IsEmpty();
+		default: return false;
+		}
+	}
+
+	int32 AsInt() const
+	{
+		switch (Type)
+		{
+		case EType::Bool: return Bool ? 1 : 0;
+		case EType::Int: return Int;
+		default: return 0;
+		}
+	}
+
+	const FString& AsString() const
+	{
+		return (Type == EType::String && String) ? *String : EmptyString();
+	}
+
+private:
+	static const FString& EmptyString()
+	{
+		static const FString Empty;
+		return Empty;
+	}
+};
+
+namespace DialogueScript
+{
+	/** Operators shared by the VM and generated native scripts */
+	DIALOGUERUNTIME_API bool ValuesEqual(const FDialogueScriptValue& Left, const FDialogueScriptValue& Right);
+	DIALOGUERUNTIME_API int32 CompareValues(const FDialogueScriptValue& Left, const FDialogueScriptValue& Right);
+
+	/** Integer division and remainder; dividing by zero warns and yields 0 */
+	DIALOGUERUNTIME_API int32 Divide(int32 Dividend, int32 Divisor);
+	DIALOGUERUNTIME_API int32 Modulo(int32 Dividend, int32 Divisor);
+}
+
+/**
+ * What a generated native script runs against. Variables, string constants and methods are
+ * those of the script's program, so native code and bytecode share one set of tables.
+ */
+struct DIALOGUERUNTIME_API FDialogueScriptContext
+{
+	const FDialogueScriptProgram& Program;
+
+	/** Exactly one of GV and Overlay is set */
+	UDialogueGlobalVariables* GV = nullptr;
+	FDialogueVariableOverlay* Overlay = nullptr;
+
+	UObject* MethodProvider = nullptr;
+
+	FDialogueScriptValue ReadVariable(int32 Index) const;
+	void WriteVariable(int32 Index, const FDialogueScriptValue& Value) const;
+	FDialogueScriptValue CallMethod(int32 Method, const FDialogueScriptValue* Args, int32 NumArgs) const;
+
+	const FString* GetString(int32 Index) const { return &Program.StringConstants[Index]; }
+};
+
+/**
+ * Executes compiled dialogue scripts.
+ *
+ * Running a program does not allocate: registers live on the stack and
+ * strings are referenced in place. Programs with a generated native function
+ * run that instead of their code.
+ */
+class DIALOGUERUNTIME_API FDialogueScriptVM
+{
+public:
+	/** Run a program and return the value of its Return instruction (None for instructions) */
+	static FDialogueScriptValue Run(const FDialogueScriptProgram& Program, UDialogueGlobalVariables* GV, UObject* MethodProvider);
+
+	/** Run a condition program; an empty program evaluates to true */
+	static bool EvaluateCondition(const FDialogueScriptProgram& Program, UDialogueGlobalVariables* GV, UObject* MethodProvider);
+
+	/** Run an instruction program */
+	static void ExecuteInstruction(const FDialogueScriptProgram& Program, UDialogueGlobalVariables* GV, UObject* MethodProvider);
+
+	/**
+	 * Evaluate conditions that all see the same variables, e.g. the input pins behind a hub, into OutResults.
+	 * Conditions lowered to mask tests are tested in one pass over the packed bools, the others run one by one.
+	 */
+	static void EvaluateConditions(TArrayView<const FDialogueScriptProgram* const> Programs, UDialogueGlobalVariables* GV, UObject* MethodProvider, TArrayView<bool> OutResults);
+
+	/**
+	 * Overloads running against a snapshot overlay, usable from any thread as long as the
+	 * program calls no user methods. Writes only go to the overlay.
+	 */
+	static FDialogueScriptValue Run(const FDialogueScriptProgram& Program, FDialogueVariableOverlay& Variables, UObject* MethodProvider);
+	static bool EvaluateCondition(const FDialogueScriptProgram& Program, FDialogueVariableOverlay& Variables, UObject* MethodProvider);
+	static void ExecuteInstruction(const FDialogueScriptProgram& Program, FDialogueVariableOverlay& Variables, UObject* MethodProvider);
+
+private:
+	template<typename VariablesType>
+	static FDialogueScriptValue RunProgram(const FDialogueScriptProgram& Program, VariablesType* GV, UObject* MethodProvider);
+
+	static FDialogueScriptValue CallMethod(FName Method, UObject* MethodProvider, const FDialogueScriptValue* Args, int32 NumArgs);
+
+	/** Test the bool masks of a condition, false if it has none or they don't fit the variables */
+	static bool TestBoolMasks(const FDialogueScriptProgram& Program, const UDialogueGlobalVariables* GV, bool& bOutResult);
+
+	friend struct FDialogueScriptContext;
+};
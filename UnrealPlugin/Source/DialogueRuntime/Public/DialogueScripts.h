@@ -0,0 +1,49 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "DialogueTypes.h"
+#include "DialogueScripts.generated.h"
+
+/**
+ * Base of the scripts class the importer generates when native scripts are enabled.
+ *
+ * The generated subclass holds one native function per distinct condition and instruction,
+ * translated from the script's bytecode. FDialogueScript::NativeIndex selects the function
+ * and every script binds it on load. The VM stays the fallback: scripts without a function,
+ * or whose expression changed since the code was generated, keep running on bytecode.
+ */
+UCLASS(Abstract)
+class DIALOGUERUNTIME_API UDialogueScripts : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueScripts();
+
+	virtual void BeginDestroy() override;
+
+	/** Native function of a script, null if there is none or it was generated for other code */
+	static FDialogueNativeScript FindNative(const FDialogueScript& Script);
+
+	/** Identifies the code a function is generated from, so stale functions are never bound */
+	static uint32 HashScript(const FDialogueScript& Script);
+
+protected:
+	/** Called by the generated constructor, functions are indexed in the order they are added */
+	void AddNative(FDialogueNativeScript Function, uint32 Hash);
+
+private:
+	struct FNativeEntry
+	{
+		FDialogueNativeScript Function = nullptr;
+		uint32 Hash = 0;
+	};
+
+	TArray<FNativeEntry> Natives;
+
+	/** Default object of the generated class, registered when its module loads */
+	static const UDialogueScripts* Active;
+};
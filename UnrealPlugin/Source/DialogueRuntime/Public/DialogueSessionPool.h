@@ -0,0 +1,172 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueBarkRunner.h"
+#include "DialogueGlobalVariables.h"
+
+struct FDialogueObjectIndex;
+
+/** A variable written by a session, on top of the shared variables */
+struct FDialogueSessionWrite
+{
+	FDialogueVariableSlot Slot;
+
+	/** Bool (0/1) or int value, index into FDialogueSession::Strings for strings */
+	int32 Value = 0;
+};
+
+/** How often a session played through a node */
+struct FDialogueSessionSeen
+{
+	int32 Node = INDEX_NONE;
+	int32 Count = 0;
+};
+
+/**
+ * The dialogue state of one player in a FDialogueSessionPool: where the flow is, the branches it can take
+ * and what it wrote. Plain data of a few dozen bytes plus its writes, no component or UObject of its own.
+ */
+struct DIALOGUERUNTIME_API FDialogueSession
+{
+	/** Node of the pool's flow graph the session is at, INDEX_NONE if it has none */
+	int32 Cursor = INDEX_NONE;
+
+	/** EDialoguePausableType mask of the nodes the session stops at */
+	uint8 PauseOn = (uint8)EDialoguePausableType::DialogueFragment;
+
+	/** Removed sessions are kept for the next AddSession */
+	bool bInUse = false;
+
+	/** Nodes the valid branches at the cursor lead to, refreshed by every advance */
+	TArray<int32> Branches;
+
+	/** Variables written by the session, sorted by slot */
+	TArray<FDialogueSessionWrite> Writes;
+
+	/** Values of the written strings */
+	TArray<FString> Strings;
+
+	/** Seen counters of the nodes the session played through, sorted by node */
+	TArray<FDialogueSessionSeen> Seen;
+
+	/** How often the session played through a node of the pool's flow graph */
+	int32 GetSeenCounter(int32 Node) const;
+
+	/** The session's write to a slot, null if it did not write it */
+	const FDialogueSessionWrite* FindWrite(const FDialogueVariableSlot& Slot) const;
+
+	SIZE_T GetAllocatedSize() const;
+};
+
+/** One advance of FDialogueSessionPool::AdvanceSessions */
+struct FDialogueSessionAdvance
+{
+	int32 Session = INDEX_NONE;
+
+	/** Index into the session's branches */
+	int32 Branch = 0;
+
+	/** Set by the pool */
+	bool bSucceeded = false;
+};
+
+/**
+ * Dialogue sessions of many players over one shared flow graph and one published snapshot of the variables,
+ * for servers evaluating dialogue for many players without a flow player per player.
+ *
+ * A session only stores its cursor, its branches, its own variable writes and seen counters. Advancing
+ * a session loads its writes into an overlay over the shared snapshot, explores and plays like the bark
+ * explorer does, and keeps the overlay's writes, so the shared snapshot is never changed. Sessions are
+ * independent of each other, AdvanceSessions advances many of them in parallel.
+ *
+ * The methods provider is called from worker threads by AdvanceSessions, its script methods have to be
+ * thread-safe. Custom nodes end a branch without a line, as for barks.
+ */
+class DIALOGUERUNTIME_API FDialogueSessionPool
+{
+public:
+	/** Use the flow graph of UDialogueDatabase::GetObjectIndex and a snapshot of UDialogueGlobalVariables::GetSnapshot */
+	FDialogueSessionPool(TSharedRef<const FDialogueObjectIndex> InIndex, FDialogueVariableSnapshotRef InVariables, UObject* InMethodsProvider = nullptr);
+
+	/**
+	 * Move all sessions to a new flow graph and snapshot, e.g. after packages were loaded or the shared variables changed.
+	 * Cursors and seen counters follow their objects, a session whose cursor is not in the new graph loses it.
+	 * Writes keep their slots, which stay the same as long as the variables are not imported again.
+	 */
+	void Rebind(TSharedRef<const FDialogueObjectIndex> InIndex, FDialogueVariableSnapshotRef InVariables);
+
+	/** Start a session at a node and explore its branches, returns its handle or INDEX_NONE if the node is not in the graph */
+	int32 AddSession(const UDialogueObject* Start, EDialoguePausableType PauseOn = EDialoguePausableType::DialogueFragment);
+
+	void RemoveSession(int32 Session);
+
+	/** The state of a session, null for a removed or invalid handle */
+	const FDialogueSession* GetSession(int32 Session) const;
+
+	/** Object of a node of the flow graph, e.g. a session's cursor or a branch */
+	UDialogueObject* GetNodeObject(int32 Node) const;
+
+	/** Value of a variable as the session sees it: its own write, or the shared value */
+	bool GetBool(int32 Session, const FDialogueVariableSlot& Slot) const;
+	int32 GetInt(int32 Session, const FDialogueVariableSlot& Slot) const;
+	const FString& GetString(int32 Session, const FDialogueVariableSlot& Slot) const;
+
+	/** Take a branch of a session: run the path to it, move the cursor there and explore the next branches */
+	bool Advance(int32 Session, int32 Branch);
+
+	/** Advance many sessions at once, in parallel. Each session may only be advanced once per call. */
+	void AdvanceSessions(TArrayView<FDialogueSessionAdvance> Advances);
+
+	int32 GetNumSessions() const { return Sessions.Num() - FreeSessions.Num(); }
+
+	/** Memory of the sessions and the scratch memory of the workers, the shared graph and variables are not counted */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Fewer advances than this are processed on the calling thread without going wide */
+	int32 MinParallelAdvances = 16;
+
+	/** Most tasks AdvanceSessions goes wide over, 0 for one per worker thread */
+	int32 MaxTasks = 0;
+
+private:
+	/** Scratch memory of one worker task */
+	struct FTaskScratch
+	{
+		explicit FTaskScratch(FDialogueVariableSnapshotRef Snapshot) : Overlay(MoveTemp(Snapshot)) {}
+
+		FDialogueBarkExplorer Explorer;
+		FDialogueVariableOverlay Overlay;
+		TArray<int32> PathNodes;
+	};
+
+	/** Advance a session with the scratch memory of the calling task */
+	bool AdvanceSession(FDialogueSession& Session, int32 Branch, FTaskScratch& Scratch) const;
+
+	/** Start the overlay on the shared snapshot with the session's writes */
+	void LoadWrites(const FDialogueSession& Session, FDialogueVariableOverlay& Overlay) const;
+
+	/** Keep the writes of the overlay in the session */
+	static void StoreWrites(FDialogueSession& Session, const FDialogueVariableOverlay& Overlay);
+
+	/** Refresh the branches of the session from the overlay holding its writes */
+	void ExploreBranches(FDialogueSession& Session, FTaskScratch& Scratch) const;
+
+	FDialogueSession* FindSession(int32 Session);
+
+	/** Keeps the flow graph alive */
+	TSharedRef<const FDialogueObjectIndex> Index;
+
+	FDialogueVariableSnapshotRef Variables;
+
+	UObject* MethodsProvider = nullptr;
+
+	TArray<FDialogueSession> Sessions;
+
+	/** Handles of removed sessions */
+	TArray<int32> FreeSessions;
+
+	/** Scratch memory per task, kept to reuse it */
+	TArray<TUniquePtr<FTaskScratch>> Scratches;
+};
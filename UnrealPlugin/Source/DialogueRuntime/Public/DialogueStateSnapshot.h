@@ -0,0 +1,40 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDialogueFlowPlayer;
+class UDialogueGlobalVariables;
+
+/**
+ * Compact binary save state of the dialogue runtime: the variable store and the cursors of flow players,
+ * in one versioned byte buffer. Variables are stored with a name table, so a save state of an older
+ * import can be loaded after variables were renamed or removed. Nothing goes through reflection,
+ * which keeps frequent autosaves cheap.
+ */
+struct DIALOGUERUNTIME_API FDialogueStateSnapshot
+{
+	/** Versions of the format, all older versions can be loaded */
+	enum class EVersion : int32
+	{
+		Initial = 1,
+
+		// Add new versions above this line
+		VersionPlusOne,
+		Latest = VersionPlusOne - 1
+	};
+
+	/**
+	 * Write the state of the variables and the cursors of the flow players to OutBytes, replacing its contents.
+	 * Fails inside a shadow operation, whose writes are rolled back when it ends.
+	 */
+	static bool Save(TArray<uint8>& OutBytes, const UDialogueGlobalVariables* GlobalVariables, TArrayView<UDialogueFlowPlayer* const> FlowPlayers);
+
+	/**
+	 * Restore a state written by Save. The variables are restored first, then the flow players, matched by
+	 * their order, are moved to their cursors. A cursor whose object is not loaded leaves its player where it is.
+	 * RenamedVariables maps full variable names (Namespace.Variable) at the time of saving to their current ones.
+	 */
+	static bool Load(const TArray<uint8>& Bytes, UDialogueGlobalVariables* GlobalVariables, TArrayView<UDialogueFlowPlayer* const> FlowPlayers, const TMap<FString, FString>& RenamedVariables = TMap<FString, FString>());
+};
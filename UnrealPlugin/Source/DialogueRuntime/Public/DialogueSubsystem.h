@@ -0,0 +1,40 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DialogueSubsystem.generated.h"
+
+class UDialogueDatabase;
+class UDialogueGlobalVariables;
+
+/**
+ * The dialogue database of a world and its global variables.
+ *
+ * Resolves the world's database once and keeps it, so UDialogueDatabase::Get and the Blueprint
+ * helpers of UDialogueFunctionLibrary don't look up the per-world instances on every call.
+ */
+UCLASS()
+class DIALOGUERUNTIME_API UDialogueSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** The subsystem of a world context, null without a world */
+	static UDialogueSubsystem* Get(const UObject* WorldContext);
+
+	/** The database of this world, created on first use */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	UDialogueDatabase* GetDatabase();
+
+	/** The global variables of this world's database */
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	UDialogueGlobalVariables* GetGlobalVariables();
+
+private:
+	UPROPERTY(Transient)
+	UDialogueDatabase* Database = nullptr;
+};
@@ -0,0 +1,32 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDialoguePackage;
+
+/**
+ * Identical texts of dialogue objects share one text instead of a copy each.
+ * Texts are equal when their localization ID and source string are; interning replaces a text
+ * with the pooled one of equal value, so the properties keep working as before.
+ */
+struct DIALOGUERUNTIME_API FDialogueTextPool
+{
+	/** Replace a text with the pooled one equal to it, adding it if there is none */
+	void Intern(FText& Text);
+
+	/** Intern the texts of all objects of a package */
+	void InternPackage(UDialoguePackage* Package);
+
+	void Reset();
+
+	/** Number of distinct texts */
+	int32 Num() const { return NumTexts; }
+
+private:
+	/** Pooled texts by hash of their ID and source string */
+	TMap<uint32, TArray<FText, TInlineAllocator<1>>> Texts;
+
+	int32 NumTexts = 0;
+};
@@ -0,0 +1,77 @@
+// Copyright Dialogue Editor Team. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueTypes.h"
+
+class UDialogueObject;
+class UDialoguePackage;
+
+/**
+ * Inverted index of the words in the texts of dialogue objects, in the language they are displayed in.
+ * Words are runs of letters and digits, lowercased; a query matches objects containing all of its
+ * words, the last one as a prefix so results show up while typing.
+ */
+struct DIALOGUERUNTIME_API FDialogueTextSearchIndex
+{
+	/** Index the texts of all objects of a package, objects already indexed are skipped; does nothing unless built */
+	void AddPackage(const UDialoguePackage* Package);
+
+	/** Index the current texts of an object again, e.g. after a live patch; visits every word, so not meant for every frame */
+	void UpdateObject(const UDialogueObject* Object);
+
+	/** Forget all objects; packages added afterwards are indexed if a language is given, the one their texts display in */
+	void Reset(const FString& InLanguage = FString());
+
+	/** Whether packages are indexed as they are added */
+	bool IsBuilt() const { return !Language.IsEmpty(); }
+
+	/** Language the texts were indexed in, empty if not built */
+	const FString& GetLanguage() const { return Language; }
+
+	/**
+	 * Objects whose texts contain all words of Query, the most relevant first.
+	 * Words found in few objects and words repeated in a text weigh more.
+	 * Objects IsSearchable returns false for are left out before counting towards Limit.
+	 */
+	TArray<FDialogueId> Search(const FString& Query, int32 Limit, TFunctionRef<bool(const FDialogueId&)> IsSearchable) const;
+
+	/** Number of distinct words */
+	int32 NumTokens() const { return Postings.Num(); }
+
+	/** Memory allocated by the index */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Split a text into lowercased words */
+	static void Tokenize(const FString& Text, TArray<FString>& OutTokens);
+
+private:
+	struct FPosting
+	{
+		FDialogueId Id;
+
+		/** Occurrences in the texts of the object */
+		int32 Count = 0;
+	};
+
+	/** Add the words of a text to the counts of one object */
+	void AddText(const FText& Text, TMap<FString, int32>& InOutCounts) const;
+
+	/** Add the words of all texts of a dialogue or flow fragment to the counts of one object */
+	void AddObjectTexts(const UDialogueObject* Object, TMap<FString, int32>& InOutCounts) const;
+
+	/** Postings of every word that starts with Prefix, at most a few so short prefixes stay fast */
+	void FindPrefixed(const FString& Prefix, TArray<const TArray<FPosting>*>& OutPostings) const;
+
+	/** Objects by word, each object at most once per word */
+	TMap<FString, TArray<FPosting>> Postings;
+
+	/** All words in order, for prefix queries; rebuilt on the first query after words were added */
+	mutable TArray<FString> SortedTokens;
+	mutable bool bSortedTokensDirty = false;
+
+	TSet<FDialogueId> IndexedIds;
+
+	FString Language;
+};
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "DialogueTypes.generated.h"
 
+class UDialogueObject;
+
 /**
  * 128-bit ID compatible with external dialogue editors
  */
@@ -39,25 +41,52 @@ struct DIALOGUERUNTIME_API FDialogueId
 		return HashCombine(GetTypeHash(Id.Low), GetTypeHash(Id.High));
 	}
 
+	friend FArchive& operator<<(FArchive& Ar, FDialogueId& Id)
+	{
+		return Ar << Id.Low << Id.High;
+	}
+
 	FString ToString() const
 	{
 		return FString::Printf(TEXT("0x%016llX%016llX"), High, Low);
 	}
 
-	static FDialogueId FromString(const FString& Str)
+	/** Parse a string written by ToString, in place so UI code can turn IDs back into objects often */
+	static FDialogueId FromString(FStringView Str)
 	{
 		FDialogueId Result;
-		// Parse hex string
-		FString Clean = Str.Replace(TEXT("0x"), TEXT(""));
-		if (Clean.Len() >= 32)
+		if (Str.StartsWith(TEXT("0x")))
 		{
-			FString HighStr = Clean.Left(16);
-			FString LowStr = Clean.Right(16);
-			Result.High = FCString::Strtoui64(*HighStr, nullptr, 16);
-			Result.Low = FCString::Strtoui64(*LowStr, nullptr, 16);
+			Str.RightChopInline(2);
+		}
+		if (Str.Len() >= 32)
+		{
+			Result.High = (int64)ParseHex(Str.Left(16));
+			Result.Low = (int64)ParseHex(Str.Right(16));
 		}
 		return Result;
 	}
+
+	/** Value of the hex digits a string starts with, without allocating */
+	static uint64 ParseHex(FStringView Hex)
+	{
+		uint64 Value = 0;
+		for (const TCHAR Char : Hex)
+		{
+			if (!FChar::IsHexDigit(Char))
+			{
+				break;
+			}
+			Value = Value << 4 | (Char <= TEXT('9') ? Char - TEXT('0') : (Char | 0x20) - TEXT('a') + 10);
+		}
+		return Value;
+	}
+
+	/**
+	 * Convert an ID written by the dialogue editor. Hex IDs ("0x...") keep their value,
+	 * any other string is hashed, so the same string always maps to the same ID.
+	 */
+	static FDialogueId FromImportId(const FString& Str);
 };
 
 /**
@@ -83,6 +112,30 @@ struct DIALOGUERUNTIME_API FDialogueRef
 	{
 		return bReferenceBaseObject ? 0 : CloneId;
 	}
+
+	/** Resolve the object in the database of a world, cached until packages are loaded or unloaded */
+	UDialogueObject* GetObject(const UObject* WorldContext) const;
+
+private:
+	mutable TWeakObjectPtr<UDialogueObject> CachedObject;
+	mutable FDialogueId CachedId;
+
+	/** See UDialogueDatabase::GetGeneration, 0 if not resolved */
+	mutable uint32 CachedGeneration = 0;
+};
+
+/**
+ * How often the world's UDialogueFlowWorldSubsystem updates an ambient flow player or bark runner, by how significant it is to the viewers
+ */
+UENUM(BlueprintType)
+enum class EDialogueUpdateTier : uint8
+{
+	/** Close to a viewer or in view nearby, updates with the next batched update */
+	Full,
+	/** Further away, updates at most every ReducedUpdateInterval of the subsystem */
+	Reduced,
+	/** Out of range and not rendered, updates wait until it is significant again */
+	Dormant
 };
 
 /**
@@ -103,6 +156,48 @@ enum class EDialoguePausableType : uint8
 };
 ENUM_CLASS_FLAGS(EDialoguePausableType);
 
+/**
+ * What counts as content for UDialogueFlowWorldSubsystem::HasAvailableContent, e.g. for the markers over NPCs with something to say
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUERUNTIME_API FDialogueContentFilter
+{
+	GENERATED_BODY()
+
+	/** Node types that count, the flow ends at them like a flow player's at its PauseOn types */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue", meta = (Bitmask, BitmaskEnum = "/Script/DialogueRuntime.EDialoguePausableType", UseEnumValuesAsMaskValuesInEditor = "true"))
+	uint8 PauseOn = (uint8)EDialoguePausableType::DialogueFragment;
+
+	/** Only count nodes no flow player of the world has paused on yet */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	bool bUnseenOnly = true;
+
+	/** Count the start node itself, a flow player starting there pauses on it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	bool bIncludeStart = true;
+
+	/** Packs the filter into 10 bits, for caches */
+	uint32 GetKey() const { return PauseOn | (bUnseenOnly ? 1u << 8 : 0u) | (bIncludeStart ? 1u << 9 : 0u); }
+};
+
+/**
+ * Data of dialogue objects that only the editor shows; cooked packages leave out what is not kept
+ */
+UENUM(BlueprintType, meta = (Bitflags))
+enum class EDialogueEditorOnlyData : uint8
+{
+	None = 0,
+	/** UDialogueFlowFragment::Description */
+	FragmentDescriptions = 1 << 0,
+	/** UDialogueOutputPin::Label */
+	PinLabels = 1 << 1,
+	/** FDialogueScript::Expression of scripts compiled to bytecode */
+	ScriptExpressions = 1 << 2,
+	/** UDialogueCharacter::Color */
+	CharacterColors = 1 << 3
+};
+ENUM_CLASS_FLAGS(EDialogueEditorOnlyData);
+
 /**
  * Variable types
  */
@@ -114,6 +209,166 @@ enum class EDialogueVariableType : uint8
 	String
 };
 
+/**
+ * Handle to a global variable's storage, resolved once from its name
+ */
+USTRUCT(BlueprintType)
+struct DIALOGUERUNTIME_API FDialogueVariableSlot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Variable")
+	EDialogueVariableType Type = EDialogueVariableType::Boolean;
+
+	/** Index into the storage array of Type */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Variable")
+	int32 Index = INDEX_NONE;
+
+	FDialogueVariableSlot() = default;
+	FDialogueVariableSlot(EDialogueVariableType InType, int32 InIndex) : Type(InType), Index(InIndex) {}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FDialogueVariableSlot& Other) const
+	{
+		return Type == Other.Type && Index == Other.Index;
+	}
+
+	friend uint32 GetTypeHash(const FDialogueVariableSlot& Slot)
+	{
+		return HashCombine(GetTypeHash((uint8)Slot.Type), GetTypeHash(Slot.Index));
+	}
+};
+
+struct FDialogueScriptValue;
+struct FDialogueScriptContext;
+
+/** Native function generated from a script, see UDialogueScripts */
+using FDialogueNativeScript = FDialogueScriptValue(*)(const FDialogueScriptContext& Context);
+
+/**
+ * One 64-bit word of a condition lowered to mask tests, see FDialogueScriptProgram::BoolMasks
+ */
+USTRUCT()
+struct DIALOGUERUNTIME_API FDialogueBoolMask
+{
+	GENERATED_BODY()
+
+	/** Index of the word in the packed bools of the variable set, INDEX_NONE for a term without variables */
+	UPROPERTY()
+	int32 Word = INDEX_NONE;
+
+	/** Bools of the word that must be set */
+	UPROPERTY()
+	uint64 MustSet = 0;
+
+	/** Bools of the word that must be clear */
+	UPROPERTY()
+	uint64 MustClear = 0;
+
+	/** The last word of a term; the condition is true if every word of any of its terms passes */
+	UPROPERTY()
+	bool bEndsTerm = false;
+
+	bool Test(uint64 Bits) const
+	{
+		return (Bits & MustSet) == MustSet && (Bits & MustClear) == 0;
+	}
+};
+
+/**
+ * Compiled form of a script fragment, executed by FDialogueScriptVM
+ */
+USTRUCT()
+struct DIALOGUERUNTIME_API FDialogueScriptProgram
+{
+	GENERATED_BODY()
+
+	/** Encoded instructions (see EDialogueScriptOp) */
+	UPROPERTY()
+	TArray<uint32> Code;
+
+	/** Integer constants referenced by the code */
+	UPROPERTY()
+	TArray<int32> IntConstants;
+
+	/** String constants referenced by the code */
+	UPROPERTY()
+	TArray<FString> StringConstants;
+
+	/** Variables referenced by the code, as Namespace.Variable */
+	UPROPERTY()
+	TArray<FString> Variables;
+
+	/** Slots the variables were bound to at import, parallel to Variables */
+	UPROPERTY()
+	TArray<FDialogueVariableSlot> VariableSlots;
+
+	/** User methods referenced by the code */
+	UPROPERTY()
+	TArray<FName> Methods;
+
+	/** Number of registers the code needs */
+	UPROPERTY()
+	uint8 NumRegisters = 0;
+
+	/**
+	 * True if the code neither writes variables nor calls user methods, so running it never
+	 * needs a shadow state. Set by the compiler; programs compiled before it tracked this are impure.
+	 */
+	UPROPERTY()
+	bool bIsPure = false;
+
+	/**
+	 * A condition of only bool variables, !, && and || as a disjunction of conjunctions: each literal is the index
+	 * of a variable times two, plus one if it is negated, and terms are separated by INDEX_NONE. Set by the compiler.
+	 */
+	UPROPERTY()
+	TArray<int32> BoolTerms;
+
+	/** The condition was lowered to BoolTerms; no terms at all is a condition that is always false */
+	UPROPERTY()
+	bool bHasBoolTerms = false;
+
+	/** BoolTerms as mask tests on the words of the bound bool slots, built by BindVariables if all variables are bools */
+	UPROPERTY()
+	TArray<FDialogueBoolMask> BoolMasks;
+
+	UPROPERTY()
+	bool bHasBoolMasks = false;
+
+	/** The compiler folded a condition to ConstantResult or an instruction to nothing, running it can be skipped */
+	UPROPERTY()
+	bool bIsConstant = false;
+
+	UPROPERTY()
+	bool bConstantResult = false;
+
+	/** Generated native function the VM runs instead of the code, bound on load */
+	FDialogueNativeScript Native = nullptr;
+
+	bool IsCompiled() const { return Code.Num() > 0; }
+
+	void Reset()
+	{
+		Code.Reset();
+		IntConstants.Reset();
+		StringConstants.Reset();
+		Variables.Reset();
+		VariableSlots.Reset();
+		Methods.Reset();
+		NumRegisters = 0;
+		bIsPure = false;
+		BoolTerms.Reset();
+		bHasBoolTerms = false;
+		BoolMasks.Reset();
+		bHasBoolMasks = false;
+		bIsConstant = false;
+		bConstantResult = false;
+		Native = nullptr;
+	}
+};
+
 /**
  * A script fragment (condition or instruction)
  */
@@ -127,4 +382,33 @@ struct DIALOGUERUNTIME_API FDialogueScript
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Script")
 	bool bIsCondition = false;
+
+	/** Bytecode compiled from Expression at import time */
+	UPROPERTY()
+	FDialogueScriptProgram Program;
+
+	/** Function of the generated UDialogueScripts class for this script, INDEX_NONE if none was generated */
+	UPROPERTY()
+	int32 NativeIndex = INDEX_NONE;
+
+	/** Hash of Expression if it was left out of a cooked package, so generated code still binds */
+	uint32 StrippedExpressionHash = 0;
+
+	/** True if there is nothing to evaluate */
+	bool IsEmpty() const { return Expression.IsEmpty() && !Program.IsCompiled(); }
+
+	/** Hash of Expression, also after it was stripped */
+	uint32 GetExpressionHash() const;
+
+	/** True if there is nothing to run: the script is empty, an instruction that does nothing or a condition that always passes */
+	bool CanSkip() const { return !Program.IsCompiled() || (Program.bIsConstant && (!bIsCondition || Program.bConstantResult)); }
+
+	/** True if running the script may write variables or call user methods */
+	bool HasSideEffects() const { return Program.IsCompiled() && !Program.bIsPure; }
+
+	/** Compile Expression into Program if that has not happened yet, and bind its native function if there is one */
+	bool EnsureCompiled();
+
+	/** Binary serialization for the compact cooked package format */
+	friend DIALOGUERUNTIME_API FArchive& operator<<(FArchive& Ar, FDialogueScript& Script);
 };